@@ -45,7 +45,11 @@ macro(findLibraries)
 
     pkg_search_module(CAPSTONE REQUIRED capstone)
 
+    find_package(ZLIB REQUIRED)
+    find_package(LibLZMA REQUIRED)
+
     find_package(OpenGL REQUIRED)
+    find_package(Threads REQUIRED)
 
     find_package(Python COMPONENTS Development REQUIRED)
     if(Python_VERSION LESS 3)
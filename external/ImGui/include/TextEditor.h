@@ -311,10 +311,25 @@ private:
 
 	typedef std::vector<UndoRecord> UndoBuffer;
 
+	// What carries over from the end of one line to the start of the next one while looking for comments, strings and preprocessor directives
+	struct LineState
+	{
+		bool mWithinComment = false;
+		bool mWithinString = false;
+		bool mConcatenate = false;
+		// Only meaningful while the line before ended in a backslash
+		bool mWithinSingleLineComment = false;
+		bool mWithinPreproc = false;
+		bool mFirstChar = true;
+
+		bool operator==(const LineState&) const = default;
+	};
+
 	void ProcessInputs();
 	void Colorize(int aFromLine = 0, int aCount = -1);
 	void ColorizeRange(int aFromLine = 0, int aToLine = 0);
 	void ColorizeInternal();
+	LineState ColorizeComments(Line& aLine, LineState aState, bool& aPreprocChanged) const;
 	float TextDistanceToLineStart(const Coordinates& aFrom) const;
 	void EnsureCursorVisible();
 	int GetPageSize() const;
@@ -377,7 +392,9 @@ private:
 	LanguageDefinition mLanguageDefinition;
 	RegexList mRegexList;
 
-	bool mCheckComments;
+	// State at the start of every line, lines from mCommentRangeMin up to mCommentRangeMax were modified since their comments were last looked for
+	std::vector<LineState> mLineStates;
+	int mCommentRangeMin, mCommentRangeMax;
 	Breakpoints mBreakpoints;
 	ErrorMarkers mErrorMarkers;
 	ImVec2 mCharAdvance;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <string>
 
 #include <imgui.h>
 
@@ -12,4 +13,8 @@ namespace ImGui {
 
     void UnderlinedText(const char* label, ImColor color, const ImVec2& size_arg = ImVec2(0, 0));
 
+    // Edit a std::string in place, growing it as needed instead of reserving a fixed sized buffer up front
+    bool InputText(const char* label, std::string &buffer, ImGuiInputTextFlags flags = 0);
+    bool InputTextMultiline(const char* label, std::string &buffer, const ImVec2& size = ImVec2(0, 0), ImGuiInputTextFlags flags = 0);
+
 }
\ No newline at end of file
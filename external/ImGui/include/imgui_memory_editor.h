@@ -90,6 +90,9 @@ struct MemoryEditor
     void            (*WriteFn)(ImU8* data, size_t off, ImU8 d); // = 0      // optional handler to write bytes.
     bool            (*HighlightFn)(const ImU8* data, size_t off, bool next);//= 0      // optional handler to return Highlight property (to support non-contiguous highlighting).
     void            (*HoverFn)(const ImU8 *data, size_t off);
+    void            (*FetchFn)(const ImU8* data, size_t off, ImU8* buffer, size_t size); // = 0 // optional handler to read all visible bytes at once. ReadFn is still used for bytes outside of the visible range.
+    void            (*SideColumnFn)(const ImU8* data, ImVec2 size);  // = 0  // optional handler to draw a column of SideColumnWidth to the right of the data, as high as the scrolling region.
+    float           SideColumnWidth;                            // = 0
 
     // [Internal State]
     bool            ContentsWidthChanged;
@@ -105,6 +108,8 @@ struct MemoryEditor
     size_t          HighlightMin, HighlightMax;
     int             PreviewEndianess;
     ImGuiDataType   PreviewDataType;
+    ImVector<ImU8>  VisibleData;
+    size_t          VisibleDataAddr;
 
     MemoryEditor()
     {
@@ -123,6 +128,9 @@ struct MemoryEditor
         WriteFn = NULL;
         HighlightFn = NULL;
         HoverFn = NULL;
+        FetchFn = NULL;
+        SideColumnFn = NULL;
+        SideColumnWidth = 0;
 
         // State/Internals
         ContentsWidthChanged = false;
@@ -133,6 +141,7 @@ struct MemoryEditor
         memset(AddrInputBuf, 0, sizeof(AddrInputBuf));
         GotoAddr = (size_t)-1;
         HighlightMin = HighlightMax = (size_t)-1;
+        VisibleDataAddr = 0;
         PreviewEndianess = 0;
         PreviewDataType = ImGuiDataType_S32;
     }
@@ -182,6 +191,8 @@ struct MemoryEditor
             s.PosAsciiEnd = s.PosAsciiStart + Cols * s.GlyphWidth;
         }
         s.WindowWidth = s.PosAsciiEnd + style.ScrollbarSize + style.WindowPadding.x * 2 + s.GlyphWidth;
+        if (SideColumnFn)
+            s.WindowWidth += SideColumnWidth + style.ItemSpacing.x;
     }
 
     // Standalone Memory Editor window
@@ -194,7 +205,7 @@ struct MemoryEditor
         {
             if (DataPreviewAddr != DataPreviewAddrOld || DataPreviewAddrEnd != DataPreviewAddrEndOld) {
                 hex::Region selectionRegion = { std::min(DataPreviewAddr, DataPreviewAddrEnd), std::max(DataPreviewAddr, DataPreviewAddrEnd) - std::min(DataPreviewAddr, DataPreviewAddrEnd) };
-                hex::View::postEvent(hex::Events::RegionSelected, selectionRegion);
+                hex::EventManager::postCoalesced(hex::Events::RegionSelected, selectionRegion);
             }
 
             DataPreviewAddrOld = DataPreviewAddr;
@@ -211,6 +222,15 @@ struct MemoryEditor
 
     }
 
+    // Read a byte from the data fetched for the visible rows, falling back to ReadFn
+    ImU8 GetByte(const ImU8* mem_data, size_t addr)
+    {
+        if (addr >= VisibleDataAddr && addr - VisibleDataAddr < (size_t)VisibleData.Size)
+            return VisibleData[addr - VisibleDataAddr];
+
+        return ReadFn ? ReadFn(mem_data, addr) : mem_data[addr];
+    }
+
     // Memory Editor contents only
     void DrawContents(void* mem_data_void, size_t mem_size, size_t base_display_addr = 0x0000)
     {
@@ -249,7 +269,7 @@ struct MemoryEditor
         }
         ImGui::EndChild();
 
-        ImGui::BeginChild("##scrolling", ImVec2(0, -footer_height), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
+        ImGui::BeginChild("##scrolling", ImVec2(SideColumnFn ? -(SideColumnWidth + style.ItemSpacing.x) : 0, -footer_height), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
 
         ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0, 0));
         ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
@@ -267,6 +287,14 @@ struct MemoryEditor
         const size_t visible_end_addr = clipper.DisplayEnd * Cols;
         const size_t visible_count = visible_end_addr - visible_start_addr;
 
+        // Fetch all visible bytes at once instead of reading them one by one
+        VisibleData.resize(0);
+        if (FetchFn) {
+            VisibleDataAddr = visible_start_addr;
+            VisibleData.resize((int)(std::min(visible_end_addr, mem_size) - visible_start_addr));
+            FetchFn(mem_data, VisibleDataAddr, VisibleData.Data, VisibleData.Size);
+        }
+
         bool data_next = false;
 
         if (DataEditingAddr >= mem_size)
@@ -386,7 +414,7 @@ struct MemoryEditor
                         ImGui::SetKeyboardFocusHere();
                         ImGui::CaptureKeyboardFromApp(true);
                         sprintf(AddrInputBuf, format_data, s.AddrDigitsCount, base_display_addr + addr);
-                        sprintf(DataInputBuf, format_byte, ReadFn ? ReadFn(mem_data, addr) : mem_data[addr]);
+                        sprintf(DataInputBuf, format_byte, GetByte(mem_data, addr));
                     }
                     ImGui::PushItemWidth(s.GlyphWidth * 2);
                     struct UserData
@@ -413,7 +441,7 @@ struct MemoryEditor
                     };
                     UserData user_data;
                     user_data.CursorPos = -1;
-                    sprintf(user_data.CurrentBufOverwrite, format_byte, ReadFn ? ReadFn(mem_data, addr) : mem_data[addr]);
+                    sprintf(user_data.CurrentBufOverwrite, format_byte, GetByte(mem_data, addr));
                     ImGuiInputTextFlags flags = ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_NoHorizontalScroll | ImGuiInputTextFlags_AlwaysInsertMode | ImGuiInputTextFlags_CallbackAlways;
                     if (ImGui::InputText("##data", DataInputBuf, 32, flags, UserData::Callback, &user_data))
                         data_write = data_next = true;
@@ -432,13 +460,16 @@ struct MemoryEditor
                             WriteFn(mem_data, addr, (ImU8)data_input_value);
                         else
                             mem_data[addr] = (ImU8)data_input_value;
+
+                        if (addr >= VisibleDataAddr && addr - VisibleDataAddr < (size_t)VisibleData.Size)
+                            VisibleData[addr - VisibleDataAddr] = ReadFn ? ReadFn(mem_data, addr) : mem_data[addr];
                     }
                     ImGui::PopID();
                 }
                 else
                 {
                     // NB: The trailing space is not visible but ensure there's no gap that the mouse cannot click on.
-                    ImU8 b = ReadFn ? ReadFn(mem_data, addr) : mem_data[addr];
+                    ImU8 b = GetByte(mem_data, addr);
 
                     if (OptShowHexII)
                     {
@@ -500,7 +531,7 @@ struct MemoryEditor
                         draw_list->AddRectFilled(pos, ImVec2(pos.x + s.GlyphWidth, pos.y + s.LineHeight), ImGui::GetColorU32(ImGuiCol_FrameBg));
                         draw_list->AddRectFilled(pos, ImVec2(pos.x + s.GlyphWidth, pos.y + s.LineHeight), ImGui::GetColorU32(ImGuiCol_TextSelectedBg));
                     }
-                    unsigned char c = ReadFn ? ReadFn(mem_data, addr) : mem_data[addr];
+                    unsigned char c = GetByte(mem_data, addr);
                     char display_c = (c < 32 || c >= 128) ? '.' : c;
                     draw_list->AddText(pos, (display_c == c) ? color_text : color_disabled, &display_c, &display_c + 1);
 
@@ -548,6 +579,12 @@ struct MemoryEditor
         ImGui::PopStyleVar(2);
         ImGui::EndChild();
 
+        if (SideColumnFn)
+        {
+            ImGui::SameLine();
+            SideColumnFn(mem_data, ImVec2(SideColumnWidth, ImGui::GetItemRectSize().y));
+        }
+
         if (data_next && DataEditingAddr < mem_size)
         {
             DataEditingAddr = DataPreviewAddr = DataEditingAddr + 1;
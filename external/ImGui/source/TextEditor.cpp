@@ -41,7 +41,8 @@ TextEditor::TextEditor()
 	, mColorRangeMin(0)
 	, mColorRangeMax(0)
 	, mSelectionMode(SelectionMode::Normal)
-	, mCheckComments(true)
+	, mCommentRangeMin(0)
+	, mCommentRangeMax(0)
 	, mLastClick(-1.0f)
 	, mHandleKeyboardInputs(true)
 	, mHandleMouseInputs(true)
@@ -50,8 +51,9 @@ TextEditor::TextEditor()
 	, mStartTime(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count())
 {
 	SetPalette(GetDarkPalette());
-	SetLanguageDefinition(LanguageDefinition::HLSL());
 	mLines.push_back(Line());
+	mLineStates.push_back(LineState());
+	SetLanguageDefinition(LanguageDefinition::HLSL());
 }
 
 TextEditor::~TextEditor()
@@ -598,8 +600,17 @@ void TextEditor::RemoveLine(int aStart, int aEnd)
 	mBreakpoints = std::move(btmp);
 
 	mLines.erase(mLines.begin() + aStart, mLines.begin() + aEnd);
+	mLineStates.erase(mLineStates.begin() + aStart, mLineStates.begin() + aEnd);
 	assert(!mLines.empty());
 
+	// The modified range moves with the lines after it
+	if (mCommentRangeMax >= aEnd)
+		mCommentRangeMax -= aEnd - aStart;
+	else if (mCommentRangeMax > aStart)
+		mCommentRangeMax = aStart;
+	mCommentRangeMin = std::min(mCommentRangeMin, aStart);
+	mCommentRangeMax = std::max(mCommentRangeMax, aStart + 1);
+
 	mTextChanged = true;
 }
 
@@ -628,8 +639,14 @@ void TextEditor::RemoveLine(int aIndex)
 	mBreakpoints = std::move(btmp);
 
 	mLines.erase(mLines.begin() + aIndex);
+	mLineStates.erase(mLineStates.begin() + aIndex);
 	assert(!mLines.empty());
 
+	if (mCommentRangeMax > aIndex)
+		mCommentRangeMax--;
+	mCommentRangeMin = std::min(mCommentRangeMin, aIndex);
+	mCommentRangeMax = std::max(mCommentRangeMax, aIndex + 1);
+
 	mTextChanged = true;
 }
 
@@ -638,6 +655,12 @@ TextEditor::Line& TextEditor::InsertLine(int aIndex)
 	assert(!mReadOnly);
 
 	auto& result = *mLines.insert(mLines.begin() + aIndex, Line());
+	mLineStates.insert(mLineStates.begin() + aIndex, LineState());
+
+	if (mCommentRangeMax > aIndex)
+		mCommentRangeMax++;
+	mCommentRangeMin = std::min(mCommentRangeMin, aIndex);
+	mCommentRangeMax = std::max(mCommentRangeMax, aIndex + 1);
 
 	ErrorMarkers etmp;
 	for (auto& i : mErrorMarkers)
@@ -1171,6 +1194,8 @@ void TextEditor::SetText(const std::string & aText)
 		}
 	}
 
+	mLineStates.assign(mLines.size(), LineState());
+
 	mTextChanged = true;
 	mScrollToTop = true;
 
@@ -1202,6 +1227,8 @@ void TextEditor::SetTextLines(const std::vector<std::string> & aLines)
 		}
 	}
 
+	mLineStates.assign(mLines.size(), LineState());
+
 	mTextChanged = true;
 	mScrollToTop = true;
 
@@ -2138,7 +2165,8 @@ void TextEditor::Colorize(int aFromLine, int aLines)
 	mColorRangeMax = std::max(mColorRangeMax, toLine);
 	mColorRangeMin = std::max(0, mColorRangeMin);
 	mColorRangeMax = std::max(mColorRangeMin, mColorRangeMax);
-	mCheckComments = true;
+	mCommentRangeMin = std::max(0, std::min(mCommentRangeMin, aFromLine));
+	mCommentRangeMax = std::max(mCommentRangeMax, toLine);
 }
 
 void TextEditor::ColorizeRange(int aFromLine, int aToLine)
@@ -2246,131 +2274,172 @@ void TextEditor::ColorizeRange(int aFromLine, int aToLine)
 	}
 }
 
-void TextEditor::ColorizeInternal()
+TextEditor::LineState TextEditor::ColorizeComments(Line& aLine, LineState aState, bool& aPreprocChanged) const
 {
-	if (mLines.empty() || !mColorizerEnabled)
-		return;
+	auto withinString = aState.mWithinString;
+	auto concatenate = aState.mConcatenate;		// '\' on the very end of the line before
+	auto withinSingleLineComment = concatenate && aState.mWithinSingleLineComment;
+	auto withinPreproc = concatenate && aState.mWithinPreproc;
+	auto firstChar = !concatenate || aState.mFirstChar;		// there is no other non-whitespace characters in the line before
+
+	// Index the current multi line comment started at in this line, -1 if it started before
+	auto commentStartIndex = aState.mWithinComment ? -1 : std::numeric_limits<int>::max();
 
-	if (mCheckComments)
+	if (aLine.empty())
+		concatenate = false;
+
+	// Glyphs skipped over below keep none of the flags they had before
+	for (auto& glyph : aLine)
+		glyph.mComment = glyph.mMultiLineComment = false;
+
+	auto preprocIndex = 0;
+	auto setPreproc = [&](int aIndex, bool aValue)
 	{
-		auto endLine = mLines.size();
-		auto endIndex = 0;
-		auto commentStartLine = endLine;
-		auto commentStartIndex = endIndex;
-		auto withinString = false;
-		auto withinSingleLineComment = false;
-		auto withinPreproc = false;
-		auto firstChar = true;			// there is no other non-whitespace characters in the line before
-		auto concatenate = false;		// '\' on the very end of the line
-		auto currentLine = 0;
-		auto currentIndex = 0;
-		while (currentLine < endLine || currentIndex < endIndex)
+		for (; preprocIndex <= aIndex; ++preprocIndex)
 		{
-			auto& line = mLines[currentLine];
+			auto value = preprocIndex == aIndex && aValue;
+			if (aLine[preprocIndex].mPreprocessor != value)
+				aPreprocChanged = true;
+			aLine[preprocIndex].mPreprocessor = value;
+		}
+	};
 
-			if (currentIndex == 0 && !concatenate)
-			{
-				withinSingleLineComment = false;
-				withinPreproc = false;
-				firstChar = true;
-			}
+	auto currentIndex = 0;
+	while (currentIndex < (int)aLine.size())
+	{
+		concatenate = false;
 
-			concatenate = false;
+		auto& g = aLine[currentIndex];
+		auto c = g.mChar;
 
-			if (!line.empty())
-			{
-				auto& g = line[currentIndex];
-				auto c = g.mChar;
+		if (c != mLanguageDefinition.mPreprocChar && !isspace(c))
+			firstChar = false;
 
-				if (c != mLanguageDefinition.mPreprocChar && !isspace(c))
-					firstChar = false;
+		if (currentIndex == (int)aLine.size() - 1 && aLine[aLine.size() - 1].mChar == '\\')
+			concatenate = true;
 
-				if (currentIndex == (int)line.size() - 1 && line[line.size() - 1].mChar == '\\')
-					concatenate = true;
+		bool inComment = commentStartIndex <= currentIndex;
 
-				bool inComment = (commentStartLine < currentLine || (commentStartLine == currentLine && commentStartIndex <= currentIndex));
+		if (withinString)
+		{
+			aLine[currentIndex].mMultiLineComment = inComment;
 
-				if (withinString)
+			if (c == '\"')
+			{
+				if (currentIndex + 1 < (int)aLine.size() && aLine[currentIndex + 1].mChar == '\"')
 				{
-					line[currentIndex].mMultiLineComment = inComment;
-
-					if (c == '\"')
-					{
-						if (currentIndex + 1 < (int)line.size() && line[currentIndex + 1].mChar == '\"')
-						{
-							currentIndex += 1;
-							if (currentIndex < (int)line.size())
-								line[currentIndex].mMultiLineComment = inComment;
-						}
-						else
-							withinString = false;
-					}
-					else if (c == '\\')
-					{
-						currentIndex += 1;
-						if (currentIndex < (int)line.size())
-							line[currentIndex].mMultiLineComment = inComment;
-					}
+					currentIndex += 1;
+					if (currentIndex < (int)aLine.size())
+						aLine[currentIndex].mMultiLineComment = inComment;
 				}
 				else
-				{
-					if (firstChar && c == mLanguageDefinition.mPreprocChar)
-						withinPreproc = true;
+					withinString = false;
+			}
+			else if (c == '\\')
+			{
+				currentIndex += 1;
+				if (currentIndex < (int)aLine.size())
+					aLine[currentIndex].mMultiLineComment = inComment;
+			}
+		}
+		else
+		{
+			if (firstChar && c == mLanguageDefinition.mPreprocChar)
+				withinPreproc = true;
 
-					if (c == '\"')
-					{
-						withinString = true;
-						line[currentIndex].mMultiLineComment = inComment;
-					}
-					else
-					{
-						auto pred = [](const char& a, const Glyph& b) { return a == b.mChar; };
-						auto from = line.begin() + currentIndex;
-						auto& startStr = mLanguageDefinition.mCommentStart;
-						auto& singleStartStr = mLanguageDefinition.mSingleLineComment;
-
-						if (singleStartStr.size() > 0 &&
-							currentIndex + singleStartStr.size() <= line.size() &&
-							equals(singleStartStr.begin(), singleStartStr.end(), from, from + singleStartStr.size(), pred))
-						{
-							withinSingleLineComment = true;
-						}
-						else if (!withinSingleLineComment && currentIndex + startStr.size() <= line.size() &&
-							equals(startStr.begin(), startStr.end(), from, from + startStr.size(), pred))
-						{
-							commentStartLine = currentLine;
-							commentStartIndex = currentIndex;
-						}
+			if (c == '\"')
+			{
+				withinString = true;
+				aLine[currentIndex].mMultiLineComment = inComment;
+			}
+			else
+			{
+				auto pred = [](const char& a, const Glyph& b) { return a == b.mChar; };
+				auto from = aLine.begin() + currentIndex;
+				auto& startStr = mLanguageDefinition.mCommentStart;
+				auto& singleStartStr = mLanguageDefinition.mSingleLineComment;
+
+				if (singleStartStr.size() > 0 &&
+					currentIndex + singleStartStr.size() <= aLine.size() &&
+					equals(singleStartStr.begin(), singleStartStr.end(), from, from + singleStartStr.size(), pred))
+				{
+					withinSingleLineComment = true;
+				}
+				else if (!withinSingleLineComment && currentIndex + startStr.size() <= aLine.size() &&
+					equals(startStr.begin(), startStr.end(), from, from + startStr.size(), pred))
+				{
+					commentStartIndex = currentIndex;
+				}
 
-						inComment = inComment = (commentStartLine < currentLine || (commentStartLine == currentLine && commentStartIndex <= currentIndex));
+				inComment = commentStartIndex <= currentIndex;
 
-						line[currentIndex].mMultiLineComment = inComment;
-						line[currentIndex].mComment = withinSingleLineComment;
+				aLine[currentIndex].mMultiLineComment = inComment;
+				aLine[currentIndex].mComment = withinSingleLineComment;
 
-						auto& endStr = mLanguageDefinition.mCommentEnd;
-						if (currentIndex + 1 >= (int)endStr.size() &&
-							equals(endStr.begin(), endStr.end(), from + 1 - endStr.size(), from + 1, pred))
-						{
-							commentStartIndex = endIndex;
-							commentStartLine = endLine;
-						}
-					}
-				}
-				line[currentIndex].mPreprocessor = withinPreproc;
-				currentIndex += UTF8CharLength(c);
-				if (currentIndex >= (int)line.size())
+				auto& endStr = mLanguageDefinition.mCommentEnd;
+				if (currentIndex + 1 >= (int)endStr.size() &&
+					equals(endStr.begin(), endStr.end(), from + 1 - endStr.size(), from + 1, pred))
 				{
-					currentIndex = 0;
-					++currentLine;
+					commentStartIndex = std::numeric_limits<int>::max();
 				}
 			}
-			else
+		}
+
+		// An escape at the very end of the line skips past it
+		if (currentIndex < (int)aLine.size())
+			setPreproc(currentIndex, withinPreproc);
+
+		currentIndex += UTF8CharLength(c);
+	}
+
+	if (!aLine.empty())
+		setPreproc((int)aLine.size() - 1, false);
+
+	LineState result;
+	result.mWithinComment = commentStartIndex != std::numeric_limits<int>::max();
+	result.mWithinString = withinString;
+	result.mConcatenate = concatenate;
+
+	if (concatenate)
+	{
+		result.mWithinSingleLineComment = withinSingleLineComment;
+		result.mWithinPreproc = withinPreproc;
+		result.mFirstChar = firstChar;
+	}
+
+	return result;
+}
+
+void TextEditor::ColorizeInternal()
+{
+	if (mLines.empty() || !mColorizerEnabled)
+		return;
+
+	// Lines only get looked at again from right before the first modified one until they start in the same state they did before, past the modified ones
+	if (mCommentRangeMin < (int)mLines.size())
+	{
+		int line = std::max(0, mCommentRangeMin - 1);
+		LineState state = line == 0 ? LineState() : mLineStates[line];
+
+		for (; line < (int)mLines.size(); ++line)
+		{
+			if (line >= mCommentRangeMax && mLineStates[line] == state)
+				break;
+
+			// Preprocessor directives change the colors of their tokens, everything else only depends on the flags set here
+			bool linePreprocChanged = false;
+			mLineStates[line] = state;
+			state = ColorizeComments(mLines[line], state, linePreprocChanged);
+
+			if (linePreprocChanged)
 			{
-				currentIndex = 0;
-				++currentLine;
+				mColorRangeMin = std::min(mColorRangeMin, line);
+				mColorRangeMax = std::max(mColorRangeMax, line + 1);
 			}
 		}
-		mCheckComments = false;
+
+		mCommentRangeMin = std::numeric_limits<int>::max();
+		mCommentRangeMax = 0;
 	}
 
 	if (mColorRangeMin < mColorRangeMax)
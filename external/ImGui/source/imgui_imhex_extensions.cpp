@@ -141,4 +141,23 @@ namespace ImGui {
         PopStyleColor();
     }
 
-}
\ No newline at end of file
+    static int UpdateStringSizeCallback(ImGuiInputTextCallbackData *data) {
+        if (data->EventFlag == ImGuiInputTextFlags_CallbackResize) {
+            auto &buffer = *static_cast<std::string*>(data->UserData);
+
+            buffer.resize(data->BufTextLen);
+            data->Buf = buffer.data();
+        }
+
+        return 0;
+    }
+
+    bool InputText(const char* label, std::string &buffer, ImGuiInputTextFlags flags) {
+        return ImGui::InputText(label, buffer.data(), buffer.size() + 1, ImGuiInputTextFlags_CallbackResize | flags, UpdateStringSizeCallback, &buffer);
+    }
+
+    bool InputTextMultiline(const char* label, std::string &buffer, const ImVec2& size, ImGuiInputTextFlags flags) {
+        return ImGui::InputTextMultiline(label, buffer.data(), buffer.size() + 1, size, ImGuiInputTextFlags_CallbackResize | flags, UpdateStringSizeCallback, &buffer);
+    }
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include "helpers/crypto.hpp"
+#include "helpers/pattern_exporter.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace hex {
+
+    class Task;
+    namespace lang { class CompiledPattern; }
+
+    struct BatchAnalysisSettings {
+        // Evaluated on every file if set, only the number of top level patterns and errors end up in the results
+        std::shared_ptr<const lang::CompiledPattern> pattern;
+        std::vector<crypt::HashSettings> hashes;
+        bool countStrings = false;
+        u32 minimumStringLength = 5;
+    };
+
+    struct BatchAnalysisResult {
+        std::string path;
+        u64 size = 0;
+        std::string error;
+
+        // Digests in the order of the requested hashes, as hex strings
+        std::vector<std::string> digests;
+        std::optional<u64> stringCount;
+        std::optional<u64> patternCount;
+        double seconds = 0;
+    };
+
+    /*
+     * Runs all analyses of the settings on a file, opening it only once. Hashes and the string count share a single pass over its data,
+     * the pattern gets evaluated afterwards while the file is still mapped. Returns nothing if the task got cancelled.
+     */
+    [[nodiscard]] std::optional<BatchAnalysisResult> analyzeFile(const std::string &path, const BatchAnalysisSettings &settings, Task &task);
+
+    // One row or object per file. Returns false if the file couldn't be written
+    bool exportBatchResults(const std::string &path, PatternExporter::Format format, const std::vector<std::string> &hashNames, const std::vector<BatchAnalysisResult> &results);
+
+}
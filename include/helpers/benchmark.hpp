@@ -0,0 +1,14 @@
+#pragma once
+
+namespace hex {
+
+    /*
+     * Measures the throughput of the core kernels on generated data without creating a window: provider reads with and without patches,
+     * hashing, string extraction, byte searches, entropy, the pattern language stages and a data processor graph.
+     * Usage: imhex --benchmark [--filter <text>] [--size <MiB>] [--iterations <count>] [--pattern <file>]... [--output <file.json>]
+     * Results are printed as a table, the output file uses the JSON format of Google Benchmark so existing comparison tools can be used on it.
+     * Returns the process exit code, failing if any of the benchmarks couldn't be run.
+     */
+    int runBenchmarks(int argc, char **argv);
+
+}
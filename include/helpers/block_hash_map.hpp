@@ -0,0 +1,42 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace hex {
+
+    namespace prv { class Provider; }
+    class Task;
+
+    /*
+     * Fast hash of every fixed size block of a provider's patched data. Comparing the hashes of two maps
+     * tells which blocks may differ, so only their bytes have to be compared to find the exact differences.
+     */
+    class BlockHashMap {
+    public:
+        constexpr static size_t BlockSize = 0x1000;
+
+        BlockHashMap() = default;
+
+        // Hashes all blocks on the workers of the task's priority. Returns false if the task got cancelled, leaving the map incomplete
+        bool build(prv::Provider *provider, Task &task);
+
+        // Rehashes the blocks a change of the data touched
+        void update(prv::Provider *provider, u64 address, size_t size);
+
+        [[nodiscard]] u64 getDataSize() const { return this->m_dataSize; }
+        [[nodiscard]] size_t getBlockCount() const { return this->m_hashes.size(); }
+
+        // Sorted, merged byte ranges of the blocks whose hashes differ, including blocks that only exist in one of the maps
+        [[nodiscard]] static std::vector<std::pair<u64, u64>> getDifferingRanges(const BlockHashMap &left, const BlockHashMap &right);
+
+    private:
+        static void hashBlocks(prv::Provider *provider, u64 dataSize, u64 firstBlock, u64 lastBlock, u64 *hashes, Task *task);
+
+        u64 m_dataSize = 0;
+        std::vector<u64> m_hashes;
+    };
+
+}
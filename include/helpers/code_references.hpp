@@ -0,0 +1,52 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <span>
+#include <vector>
+
+namespace hex {
+
+    enum class ReferenceType : u8 {
+        Call,
+        Jump
+    };
+
+    // Both ends are offsets of instructions in the code region, like the ones of the disassembly
+    struct CodeReference {
+        u64 from, to;
+        ReferenceType type;
+    };
+
+    /*
+     * Branch and call targets of a disassembly together with the function starts found in it. References are kept in one array sorted
+     * by where they come from plus an array of their indices sorted by where they go, so looking them up either way is a binary search.
+     */
+    class CodeReferences {
+    public:
+        CodeReferences() = default;
+        // References have to be sorted by where they come from, functions don't need to be sorted
+        CodeReferences(std::vector<CodeReference> references, std::vector<u64> functions);
+
+        // Sorted by where they come from
+        [[nodiscard]] const std::vector<CodeReference>& getReferences() const { return this->m_references; }
+        [[nodiscard]] std::span<const CodeReference> getReferencesFrom(u64 offset) const;
+        // Sorted by where they come from
+        [[nodiscard]] std::vector<CodeReference> getReferencesTo(u64 offset) const;
+        [[nodiscard]] size_t getReferenceCountTo(u64 offset) const;
+
+        // Sorted
+        [[nodiscard]] const std::vector<u64>& getFunctions() const { return this->m_functions; }
+        [[nodiscard]] bool isFunction(u64 offset) const;
+
+        [[nodiscard]] size_t getMemoryUsage() const;
+
+    private:
+        [[nodiscard]] std::span<const u32> findTargets(u64 offset) const;
+
+        std::vector<CodeReference> m_references;
+        std::vector<u32> m_byTarget;
+        std::vector<u64> m_functions;
+    };
+
+}
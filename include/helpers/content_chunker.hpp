@@ -0,0 +1,44 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace hex {
+
+    namespace prv { class Provider; }
+    class Task;
+
+    /*
+     * Content defined chunking. Chunk boundaries are placed where a rolling gear hash of the preceding bytes matches a pattern,
+     * so they only depend on the surrounding data and move along with it when bytes get inserted or removed.
+     * Identical data therefore ends up in identical chunks regardless of its position, which makes finding moved data
+     * a single linear pass over both sets of chunks.
+     */
+    class ContentChunker {
+    public:
+        constexpr static size_t MinChunkSize     = 0x800;
+        constexpr static size_t AverageChunkSize = 0x2000;
+        constexpr static size_t MaxChunkSize     = 0x1'0000;
+
+        struct Chunk {
+            u64 address;
+            size_t size;
+            u64 hash;
+        };
+
+        struct Match {
+            u64 address;
+            u64 matchAddress;
+            size_t size;
+        };
+
+        // Splits the patched data of the provider into chunks. Returns nothing if the task got cancelled
+        [[nodiscard]] static std::optional<std::vector<Chunk>> split(prv::Provider *provider, Task *task = nullptr);
+
+        // Finds the chunks that also appear in otherChunks. Consecutive matches with the same shift get merged into one
+        [[nodiscard]] static std::vector<Match> match(const std::vector<Chunk> &chunks, const std::vector<Chunk> &otherChunks);
+    };
+
+}
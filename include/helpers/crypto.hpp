@@ -1,19 +1,70 @@
 #pragma once
 
 #include <hex.hpp>
+#include <hex/providers/scan_pipeline.hpp>
 
 #include <array>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
-namespace hex::prv { class Provider; }
+namespace hex {
+    namespace prv { class Provider; class Snapshot; }
+    class Task;
+}
 
 namespace hex::crypt {
 
     void initialize();
     void exit();
 
+    enum class HashFunction : u8 { CRC16, CRC32, MD5, SHA1, SHA224, SHA256, SHA384, SHA512, XXH64, BLAKE3 };
+
+    struct HashSettings {
+        HashFunction function;
+        u32 polynomial = 0, init = 0;   // Only used by the CRCs
+    };
+
+    // Gets every chunk of the hashed data in order, on a thread of its own while the hashers work on the same chunk
+    using ChunkCallback = prv::ScanPipeline::Consumer;
+
+    class Hasher;
+
+    /*
+     * Hashes that get fed the data of a ScanPipeline pass, so they can be calculated alongside other analyses of the same data.
+     * Has to outlive the pass, the digests are the same ones hash() returns. Hashes that use more than one thread do so at the given priority
+     */
+    class HashPass {
+    public:
+        explicit HashPass(const std::vector<HashSettings> &hashes, TaskPriority priority = TaskPriority::Normal);
+        ~HashPass();
+
+        // One for each hash. They may run concurrently, but need the chunks in order
+        [[nodiscard]] std::vector<prv::ScanPipeline::Consumer> getConsumers() const;
+        // Only once the consumers got all chunks
+        [[nodiscard]] std::vector<std::vector<u8>> finish();
+
+    private:
+        // Only there for the priority, passes are cancelled through the consumers
+        std::unique_ptr<Task> m_task;
+        std::vector<std::unique_ptr<Hasher>> m_hashers;
+    };
+
+    /*
+     * Calculates all requested hashes in a single pass over the data. Every hash gets updated on its own thread
+     * while the next chunk is being read, chunks the provider keeps in memory unpatched are used without copying them.
+     * Other scans over the same data can share the pass through the chunk callback, the hashes may be empty then.
+     * Digests are returned in the order of the requested hashes, CRCs in big endian. Returns nothing if the task got cancelled
+     */
+    std::optional<std::vector<std::vector<u8>>> hash(prv::Provider *data, u64 offset, size_t size, const std::vector<HashSettings> &hashes, Task *task = nullptr, const ChunkCallback &onChunk = { });
+    // Same as above, but all hashes match the data as it was when the snapshot was taken. Returns nothing if the snapshot went stale
+    std::optional<std::vector<std::vector<u8>>> hash(const prv::Snapshot &data, u64 offset, size_t size, const std::vector<HashSettings> &hashes, Task *task = nullptr, const ChunkCallback &onChunk = { });
+
+    // Non-cryptographic hash of a buffer, for quick checks whether data is identical
+    u64 xxh64(const u8 *data, size_t size);
+
     u16 crc16(prv::Provider* &data, u64 offset, size_t size, u16 polynomial, u16 init);
     u32 crc32(prv::Provider* &data, u64 offset, size_t size, u32 polynomial, u32 init);
 
@@ -24,6 +75,7 @@ namespace hex::crypt {
     std::array<u8, 48> sha384(prv::Provider* &data, u64 offset, size_t size);
     std::array<u8, 64> sha512(prv::Provider* &data, u64 offset, size_t size);
 
+    // Thin wrappers around hex::decodeData and hex::encodeData. Decoding returns an empty vector if the input isn't valid Base64
     std::vector<u8> decode64(const std::vector<u8> &input);
     std::vector<u8> encode64(const std::vector<u8> &input);
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/providers/patch_store.hpp>
+
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace hex {
+
+    namespace prv { class Provider; class Snapshot; }
+    class Task;
+
+    enum class DeltaPatchFormat { BPS, UPS, VCDIFF };
+
+    // Target data an applied patch produced. Bytes within the size of the source are kept as the runs that differ from it, bytes past its end as they are
+    struct DeltaPatchResult {
+        u64 targetSize = 0;
+        prv::PatchStore::Runs differences;
+        std::vector<u8> appendedData;
+    };
+
+    // Range of the target that's the same as the source's data at sourceAddress
+    struct DeltaCopy {
+        u64 address;
+        u64 sourceAddress;
+        u64 size;
+    };
+
+    [[nodiscard]] std::optional<DeltaPatchFormat> detectDeltaPatchFormat(const std::vector<u8> &patch);
+
+    /*
+     * Applies a BPS, UPS or VCDIFF patch to the source. The target gets produced front to back and compared against the source as it's written,
+     * so only the bytes that actually changed are kept in memory. Returns a message describing the problem if the patch is invalid or belongs to a different file.
+     * VCDIFF patches with secondary compression or custom code tables aren't supported.
+     */
+    [[nodiscard]] std::variant<DeltaPatchResult, std::string> applyDeltaPatch(const std::vector<u8> &patch, const prv::Snapshot &source, Task &task);
+
+    // Writes the source with the result of applyDeltaPatch() applied. Returns false if writing failed or the task got cancelled
+    bool saveDeltaPatchResult(const std::string &path, const prv::Snapshot &source, const DeltaPatchResult &result, Task &task);
+
+    // Copies have to be sorted by address and must not overlap. Everything they don't cover is stored in the patch. Returns nothing if the task got cancelled
+    [[nodiscard]] std::optional<std::vector<u8>> createDeltaPatch(DeltaPatchFormat format, const prv::Snapshot &source, const prv::Snapshot &target, const std::vector<DeltaCopy> &copies, Task &task);
+
+    // Copies that make up the target: unchanged data found through block hashes first, data that moved through content defined chunks after that
+    [[nodiscard]] std::optional<std::vector<DeltaCopy>> findDeltaCopies(prv::Provider *source, prv::Provider *target, Task &task);
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace hex {
+
+    class Task;
+    namespace prv { class Snapshot; }
+
+    struct DigraphAnalysis {
+        // Bins per axis of the trigraph counts, every bin covers 256 / TrigraphBins byte values
+        constexpr static u32 TrigraphBins = 64;
+
+        // Number of times every byte is followed by every other one, indexed by first byte * 256 + second byte
+        std::vector<u64> digraphs;
+
+        // Number of times every three consecutive bytes fall into the bins, indexed by (first * TrigraphBins + second) * TrigraphBins + third
+        std::vector<u64> trigraphs;
+    };
+
+    /*
+     * Counts consecutive pairs and triples of bytes in a region. The region is split into slices counted on all cores into histograms
+     * of their own, which get summed up once all slices are done. Slices read the two bytes following them so no pair or triple gets lost
+     * at their borders. Returns nothing if the task got cancelled or the data couldn't be read.
+     */
+    [[nodiscard]] std::optional<DigraphAnalysis> analyzeDigraphs(const prv::Snapshot &snapshot, u64 address, u64 size, Task &task);
+
+}
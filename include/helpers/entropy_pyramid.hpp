@@ -0,0 +1,80 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include "helpers/persistent_analysis_cache.hpp"
+#include "helpers/region_classifier.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace hex {
+
+    namespace prv { class Provider; }
+    class Task;
+
+    /*
+     * Entropy of the data at multiple resolutions. The lowest level holds the entropy of every 256 byte block,
+     * every level above combines four blocks of the one below up to a single block covering all of the data.
+     * Levels starting at the chunk level additionally keep byte histograms so the levels above them can be aggregated
+     * without touching the data again. Blocks of the class level also get classified while their histogram is at hand.
+     * Chunks are independent of each other, they can be built in parallel and recomputed individually when data changes.
+     */
+    class EntropyPyramid {
+    public:
+        constexpr static size_t LeafSize = 0x100;
+        constexpr static size_t LevelFactor = 4;
+        constexpr static size_t ChunkLevel = 4;
+        constexpr static size_t ClassLevel = 2;
+        constexpr static size_t ChunkSize = LeafSize * LevelFactor * LevelFactor * LevelFactor * LevelFactor;
+
+        explicit EntropyPyramid(u64 dataSize);
+
+        [[nodiscard]] u64 getDataSize() const { return this->m_dataSize; }
+        [[nodiscard]] u64 getChunkCount() const { return this->m_levels[ChunkLevel].entropy.size(); }
+
+        // Computes the levels up to the chunk level for the given chunks. Disjoint ranges may be built from multiple threads at once
+        void buildChunks(prv::Provider *provider, u64 firstChunk, u64 lastChunk, Task *task = nullptr);
+
+        // Recomputes the levels above the chunk level from the given chunks
+        void aggregate(u64 firstChunk, u64 lastChunk);
+
+        // Recomputes everything covering the range after its data was modified
+        void update(prv::Provider *provider, u64 address, size_t size);
+
+        [[nodiscard]] size_t getLevelCount() const { return this->m_levels.size(); }
+        [[nodiscard]] u64 getBlockSize(size_t level) const { return this->m_levels[level].blockSize; }
+        [[nodiscard]] const std::vector<float>& getEntropy(size_t level) const { return this->m_levels[level].entropy; }
+        [[nodiscard]] const std::vector<RegionClass>& getBlockClasses() const { return this->m_blockClasses; }
+
+        // The lowest level that divides the given number of bytes into at most the given number of blocks
+        [[nodiscard]] size_t getLevelForResolution(u64 size, u64 maxBlocks) const;
+
+        [[nodiscard]] const std::array<u64, 256>& getValueCounts() const { return this->m_levels.back().histograms.front(); }
+        [[nodiscard]] float getTotalEntropy() const { return this->m_levels.back().entropy.front(); }
+
+        [[nodiscard]] size_t getMemoryUsage() const;
+
+        // Adds the entropy of every level, the histograms and the block classes as arrays of their own
+        void store(PersistentAnalysisCache::Writer &writer) const;
+        // Restores a pyramid stored starting at the given array, nothing if it doesn't match the data size
+        [[nodiscard]] static std::shared_ptr<EntropyPyramid> load(const PersistentAnalysisCache::Entry &entry, size_t firstArray, u64 dataSize);
+
+    private:
+        struct Level {
+            u64 blockSize;
+            std::vector<float> entropy;
+            std::vector<std::array<u64, 256>> histograms;
+        };
+
+        void computeChunk(const u8 *data, size_t size, u64 chunk);
+        void refineBlockClasses(u64 chunk, const std::array<u64, 256> &valueCounts, size_t numBytes);
+        [[nodiscard]] size_t getBlockByteCount(size_t level, u64 block) const;
+
+        u64 m_dataSize;
+        std::vector<Level> m_levels;
+        std::vector<RegionClass> m_blockClasses;
+    };
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#if defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace hex {
+
+    class Task;
+    namespace prv { class Snapshot; }
+
+    /*
+     * Notices when a file gets modified by someone else. Linux gets told about it by inotify, Windows by change notifications of the
+     * file's directory, which are filtered by the file's size and modification time. Everywhere else the size and modification time get polled.
+     */
+    class FileWatcher {
+    public:
+        explicit FileWatcher(std::string path);
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        // True if the file changed since the last call. Never blocks
+        [[nodiscard]] bool poll();
+        // Forgets about all changes so far, for changes made by whoever is watching the file
+        void ignoreChanges();
+
+        // The file at the path may have been replaced by a different one, which is watched from now on
+        void rewatch();
+
+    private:
+        [[nodiscard]] bool updateStats();
+
+        std::string m_path;
+
+        #if defined(OS_LINUX)
+        int m_notifications = -1;
+        int m_watch = -1;
+        #elif defined(OS_WINDOWS)
+        HANDLE m_notifications = INVALID_HANDLE_VALUE;
+        #endif
+
+        u64 m_size = 0;
+        s64 m_modificationTime = 0;
+    };
+
+    /*
+     * Hashes of fixed size blocks of raw data. Comparing the hashes taken before and after a file got modified finds the parts that actually changed,
+     * so only those have to be analyzed again. Blocks get hashed on all cores.
+     */
+    struct FileBlockHashes {
+        constexpr static size_t BlockSize = 0x1'0000;
+
+        u64 dataSize = 0;
+        std::vector<u64> hashes;
+
+        // Returns nothing if the task got cancelled or the snapshot went stale
+        [[nodiscard]] static std::optional<FileBlockHashes> compute(const prv::Snapshot &snapshot, Task &task);
+
+        // Hashes for data of the given size that get filled in by hashChunk, for hashing as part of a ScanPipeline pass
+        explicit FileBlockHashes(u64 dataSize = 0) : dataSize(dataSize), hashes((dataSize + BlockSize - 1) / BlockSize) { }
+        // Chunks have to start at a block boundary, but may come in any order
+        void hashChunk(u64 offset, const u8 *data, size_t size);
+
+        // Ranges of the new data that differ, merged where they touch. Appended data counts as changed, the block the old data ended in does as well
+        [[nodiscard]] std::vector<Region> getChangedRanges(const FileBlockHashes &after) const;
+    };
+
+}
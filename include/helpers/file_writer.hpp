@@ -0,0 +1,26 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <hex/providers/patch_store.hpp>
+#include <hex/providers/piece_table.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace hex {
+
+    namespace prv { class Provider; }
+    class Task;
+
+    /*
+     * Writes the provider's unpatched data with the given patch runs applied to a new file. If there are pieces, the file is made of them instead,
+     * with the patches applied to the parts taken from the raw data.
+     * Unmodified spans are copied by the kernel where possible, everything else is written in large chunks.
+     * The provider's raw data must not change while this runs, the patches and pieces are expected to be a snapshot.
+     * Progress is reported through the task and cancelling it stops the write, leaving a truncated file behind.
+     */
+    bool writePatchedFile(prv::Provider *provider, const prv::PatchStore::Runs &patches, const prv::PieceTable::Pieces *pieces, const std::string &path, Task &task);
+
+}
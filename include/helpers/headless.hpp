@@ -0,0 +1,13 @@
+#pragma once
+
+namespace hex {
+
+    /*
+     * Evaluates a pattern on a list of files without creating a window and exports the resulting patterns.
+     * Usage: imhex --headless --pattern <file> [--format json|csv] [--output <folder>] [--threads <count>] <files...>
+     * Without an output folder every file's patterns are written to stdout as one line of JSON, or as CSV with an added file column.
+     * Returns the process exit code, failing if any of the files couldn't be evaluated.
+     */
+    int runHeadless(int argc, char **argv);
+
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace hex {
+
+    /*
+     * Adds builtin functions hashing data of the provider to the pattern language. They live in the executable instead of the builtin plugin
+     * since they use the same hash implementations as the hashes view. Have to be registered before any pattern gets validated.
+     *   crc32(address, size)                      Standard CRC-32 of the data
+     *   md5/sha1/sha256(address, size, byte...)   True if the digest of the data equals the given bytes
+     */
+    void registerHashPatternLanguageFunctions();
+
+}
@@ -1,30 +1,61 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <string_view>
 
 struct _object;
 typedef struct _object PyObject;
+struct _ts;
+typedef struct _ts PyThreadState;
 
 namespace hex {
 
     namespace prv { class Provider; }
+    class Task;
 
+    /*
+     * Scripts run on a worker thread, the interpreter lock is only ever held by that thread while the main thread keeps drawing.
+     * Scripts read a snapshot of the data, everything they add is collected and applied on the main thread once they finished without an error,
+     * all patches together as a single undo step. Cancelled scripts get interrupted and don't change anything.
+     */
     class LoaderScript {
     public:
         LoaderScript() = delete;
 
+        // Main thread only. The interpreter is started by the first script and kept alive for all following ones, each script gets its own globals.
+        // Returns false if the script couldn't be started, only one script runs at a time
         static bool processFile(std::string_view scriptPath);
+        // Expects the task manager to be stopped already, which interrupts a script that's still running
+        static void shutdown();
 
         static void setFilePath(std::string_view filePath) { LoaderScript::s_filePath = filePath; }
         static void setDataProvider(prv::Provider* provider) { LoaderScript::s_dataProvider = provider; }
     private:
+        struct Run;
+
         static inline std::string s_filePath;
         static inline prv::Provider* s_dataProvider;
+        static inline bool s_initialized = false;
+        // State of the main thread while it doesn't hold the interpreter lock
+        static inline PyThreadState *s_mainThreadState = nullptr;
+        static inline std::shared_ptr<Task> s_task;
+        // Only accessed while holding the interpreter lock
+        static inline Run *s_run = nullptr;
+
+        static void initialize();
+        static void releaseDataViews(Run &run);
+        // Sets a Python error and returns false if the script got cancelled
+        static bool checkCancelled();
 
         static PyObject* Py_getFilePath(PyObject *self, PyObject *args);
+        static PyObject* Py_getData(PyObject *self, PyObject *args);
+        static PyObject* Py_read(PyObject *self, PyObject *args);
         static PyObject* Py_addPatch(PyObject *self, PyObject *args);
+        static PyObject* Py_addPatches(PyObject *self, PyObject *args);
         static PyObject* Py_addBookmark(PyObject *self, PyObject *args);
+        static PyObject* Py_addBookmarks(PyObject *self, PyObject *args);
+        static PyObject* Py_setProgress(PyObject *self, PyObject *args);
 
         static PyObject* Py_addStruct(PyObject *self, PyObject *args);
         static PyObject* Py_addUnion(PyObject *self, PyObject *args);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <string>
+
+namespace hex::prv { class Provider; }
+
+namespace hex::magic {
+
+    // libmagic only ever looks at the start of the data, nothing past this gets read from the provider
+    constexpr static size_t MaxInspectedSize = 0x10'0000;
+
+    enum class Format {
+        Description,    // Human readable description
+        MIME,           // MIME type including the encoding, e.g. "text/plain; charset=us-ascii"
+        MIMEType        // MIME type only, e.g. "text/plain"
+    };
+
+    /*
+     * Identifies the data at the start of the provider using the magic databases in the magic folder.
+     * The databases are loaded once and shared by all callers, identification may happen from any thread.
+     * Returns an empty string if no database could be loaded.
+     */
+    [[nodiscard]] std::string identify(prv::Provider *provider, Format format);
+
+    // Loads the databases ahead of time so the first identification doesn't have to wait for them
+    void preload();
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <hex.hpp>
+#include <hex/providers/patch_store.hpp>
 
 #include <map>
 #include <vector>
@@ -9,9 +10,12 @@ namespace hex {
 
     using Patches = std::map<u64, u8>;
 
-    std::vector<u8> generateIPSPatch(const Patches &patches);
-    std::vector<u8> generateIPS32Patch(const Patches &patches);
+    // Runs are split into records of at most 0xFFFF bytes, long sequences of the same byte become RLE records.
+    // Returns nothing if a patch can't be represented, like one starting at the address that reads as the end marker
+    std::vector<u8> generateIPSPatch(const prv::PatchStore::Runs &patches);
+    std::vector<u8> generateIPS32Patch(const prv::PatchStore::Runs &patches);
 
-    Patches loadIPSPatch(const std::vector<u8> &ipsPatch);
-    Patches loadIPS32Patch(const std::vector<u8> &ipsPatch);
-}
\ No newline at end of file
+    // Every record becomes a single run, records overwrite the ones before them
+    prv::PatchStore::Runs loadIPSPatch(const std::vector<u8> &ipsPatch);
+    prv::PatchStore::Runs loadIPS32Patch(const std::vector<u8> &ipsPatch);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hex::prv { class Provider; }
+namespace hex::lang { class PatternData; }
+
+namespace hex {
+
+    /*
+     * Converts evaluated patterns into formats other tools can process. Values are read from the provider the patterns were evaluated on.
+     * Every pattern becomes an object with its name, type, offset and size, values and nested patterns are added where there are any.
+     * The output is written to the stream while walking the patterns, nothing but the current path is kept in memory.
+     * Static arrays are exported through their single template pattern, so even huge tables don't need any more memory.
+     */
+    class PatternExporter {
+    public:
+        PatternExporter() = delete;
+
+        enum class Format { JSON, CSV };
+
+        static void writeJson(std::ostream &stream, prv::Provider *provider, const std::vector<lang::PatternData*> &patterns);
+
+        // One row per pattern with its full path, nested patterns come right after their parent. A non-empty file adds a column holding it
+        static void writeCsv(std::ostream &stream, prv::Provider *provider, const std::vector<lang::PatternData*> &patterns, bool writeHeader = true, const std::string &file = "");
+
+        // Returns false if the file couldn't be written
+        static bool exportToFile(const std::string &path, Format format, prv::Provider *provider, const std::vector<lang::PatternData*> &patterns);
+
+        // Quotes the field if it contains a separator, quote or line break
+        [[nodiscard]] static std::string escapeCsv(const std::string &field);
+    };
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <string>
+#include <vector>
+
+namespace hex::pattern_library {
+
+    /*
+     * Index of the MIME types declared by the pattern files in the patterns folder through their MIME pragmas.
+     * Only files that were added or modified since the last refresh get read and preprocessed again, all others are only looked up
+     * in the folder. The index is shared by all callers and may be used from any thread.
+     */
+    void refresh();
+
+    // Names of all pattern files declaring the MIME type, sorted by name. Brings the index up to date first
+    [[nodiscard]] std::vector<std::string> findForMimeType(const std::string &mimeType);
+
+}
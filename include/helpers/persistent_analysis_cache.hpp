@@ -0,0 +1,142 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace hex {
+
+    namespace prv { class Provider; class Snapshot; }
+    struct FileBlockHashes;
+    class Task;
+
+    /*
+     * Analysis results kept on disk, so opening a file that was analyzed before restores them instead of doing all the work again.
+     * Entries are keyed by a fingerprint of the unmodified data they were computed from plus a key naming the analysis and its parameters.
+     * Every entry is a file made up of a header followed by arrays of trivially copyable values, stored in host byte order and aligned
+     * so they can be used right out of the mapped file. The cache directory is trimmed to its budget by deleting the entries used the longest time ago.
+     */
+    class PersistentAnalysisCache {
+    public:
+        PersistentAnalysisCache() = delete;
+
+        constexpr static u64 DefaultBudget = 0x1'0000'0000;
+
+        struct Fingerprint {
+            u64 hash;
+            u64 dataSize;
+
+            bool operator==(const Fingerprint&) const = default;
+        };
+
+        // Covers every byte of the data
+        [[nodiscard]] static Fingerprint getFingerprint(const FileBlockHashes &hashes);
+        // Only looks at evenly spread samples of the data plus its modification time, for data too large to hash all of it
+        [[nodiscard]] static std::optional<Fingerprint> getSampledFingerprint(const prv::Snapshot &snapshot, s64 modificationTime, Task &task);
+
+        // Main thread only. Fingerprints are only handed out as long as the data of the provider didn't change, including its overlays.
+        // The data generation passed in has to be the one the fingerprinted data had
+        static void setFingerprint(prv::Provider *provider, const Fingerprint &fingerprint, u64 dataGeneration);
+        static void removeFingerprint(prv::Provider *provider);
+        [[nodiscard]] static std::optional<Fingerprint> getFingerprint(prv::Provider *provider);
+
+        class Writer {
+        public:
+            template<typename T> requires std::is_trivially_copyable_v<T>
+            void add(std::span<const T> values) {
+                const auto bytes = std::as_bytes(values);
+                this->m_arrays.push_back({ sizeof(T), std::vector<std::byte>(bytes.begin(), bytes.end()) });
+            }
+
+            template<typename T> requires std::is_trivially_copyable_v<T>
+            void add(const std::vector<T> &values) { this->add(std::span<const T>(values)); }
+
+            void add(std::string_view string) { this->add(std::span<const char>(string.data(), string.size())); }
+
+        private:
+            friend class PersistentAnalysisCache;
+
+            struct Array {
+                u32 elementSize;
+                std::vector<std::byte> data;
+            };
+
+            std::vector<Array> m_arrays;
+        };
+
+        // Arrays stay valid for as long as the entry is around
+        class Entry {
+        public:
+            Entry(const Entry&) = delete;
+            Entry& operator=(const Entry&) = delete;
+            ~Entry();
+
+            // Of the data the entry was computed from
+            [[nodiscard]] const Fingerprint& getFingerprint() const { return this->m_fingerprint; }
+            [[nodiscard]] size_t getArrayCount() const { return this->m_arrays.size(); }
+
+            // Empty if there's no such array or its values aren't of the given size
+            template<typename T> requires std::is_trivially_copyable_v<T>
+            [[nodiscard]] std::span<const T> get(size_t index) const {
+                if (index >= this->m_arrays.size() || this->m_arrays[index].elementSize != sizeof(T))
+                    return { };
+
+                const auto &array = this->m_arrays[index];
+                return { reinterpret_cast<const T*>(this->m_data + array.offset), size_t(array.size / sizeof(T)) };
+            }
+
+            [[nodiscard]] std::string_view getString(size_t index) const {
+                auto characters = this->get<char>(index);
+                return { characters.data(), characters.size() };
+            }
+
+        private:
+            friend class PersistentAnalysisCache;
+            Entry() = default;
+
+            struct Array {
+                u64 offset, size;
+                u32 elementSize;
+            };
+
+            const u8 *m_data = nullptr;
+            size_t m_size = 0;
+            Fingerprint m_fingerprint = { };
+            std::vector<Array> m_arrays;
+        };
+
+        // Writes the entry in the background, replacing the one with the same fingerprint and key. Does nothing with a budget of zero. Safe to call from any thread
+        static void store(const Fingerprint &fingerprint, const std::string &key, Writer writer);
+        // Nothing if there's no valid entry. Safe to call from any thread
+        [[nodiscard]] static std::unique_ptr<Entry> load(const Fingerprint &fingerprint, const std::string &key);
+
+        // Same format as the cached entries, for files outside of the cache that get exchanged with other tools.
+        // Mapping a file only checks that it's intact and was written with the given key, not which data it belongs to
+        static bool writeFile(const std::string &path, const Fingerprint &fingerprint, const std::string &key, const Writer &writer);
+        [[nodiscard]] static std::unique_ptr<Entry> mapFile(const std::string &path, const std::string &key);
+
+        static void setBudget(u64 budget);
+        [[nodiscard]] static u64 getBudget();
+
+    private:
+        [[nodiscard]] static std::string getDirectory();
+        [[nodiscard]] static std::string getPath(const Fingerprint &fingerprint, const std::string &key);
+        static void trim();
+
+        struct ProviderFingerprint {
+            Fingerprint fingerprint;
+            u64 dataGeneration;
+        };
+
+        static std::map<prv::Provider*, ProviderFingerprint> s_fingerprints;
+        static std::atomic<u64> s_budget;
+    };
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <bit>
+#include <optional>
+#include <vector>
+
+namespace hex {
+
+    class Task;
+    namespace prv { class Snapshot; }
+
+    struct PointerScanSettings {
+        u64 address, size;
+
+        // 4 or 8 bytes
+        u8 width = 4;
+        std::endian endian = std::endian::little;
+
+        // Pointers are only looked for at offsets from the start of the data that are a multiple of the alignment
+        u8 alignment = 4;
+
+        // Values between these two, both inclusive, count as pointers
+        u64 targetStart = 0, targetEnd = 0;
+    };
+
+    struct FoundPointer {
+        u64 offset;
+        u64 value;
+    };
+
+    struct PointerScanResult {
+        // Sorted by offset
+        std::vector<FoundPointer> pointers;
+
+        // Set if there were too many pointers to keep them all. Pointers are then only complete up to the last one in the list
+        bool truncated = false;
+    };
+
+    /*
+     * Finds all values in a region of the data that point into the target range. The data is split into slices scanned on all cores,
+     * comparing a whole vector of values against the range at once with AVX2 or NEON where available. Alignments smaller than the width
+     * get scanned in one pass per offset into a value, every pass then is a plain array of values the vectors can compare directly.
+     * Returns nothing if the task got cancelled or the data couldn't be read.
+     */
+    [[nodiscard]] std::optional<PointerScanResult> scanPointers(const prv::Snapshot &snapshot, const PointerScanSettings &settings, Task &task);
+
+}
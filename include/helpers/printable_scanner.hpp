@@ -0,0 +1,39 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace hex {
+
+    enum class StringEncoding : u8 {
+        ASCII,
+        UTF8,
+        UTF16LE,
+        UTF16BE,
+        UTF32LE,
+        UTF32BE
+    };
+
+    [[nodiscard]] constexpr bool isPrintable(u8 c) {
+        return c >= 0x20 && c <= 0x7E;
+    }
+
+    [[nodiscard]] size_t getCharacterSize(StringEncoding encoding);
+    [[nodiscard]] size_t getMaxCharacterLength(StringEncoding encoding);
+
+    /*
+     * Return the offset of the first printable or non-printable character in data, or size if there is none.
+     * UTF-8 additionally accepts any well-formed multi-byte sequence above the C1 controls, UTF-16 and UTF-32 only accept
+     * printable ASCII code points located at multiples of the character size. Data is classified
+     * 64 bytes at a time using the best vector extension the CPU supports at runtime.
+     */
+    [[nodiscard]] size_t findPrintable(const u8 *data, size_t size, StringEncoding encoding = StringEncoding::ASCII);
+    [[nodiscard]] size_t findNonPrintable(const u8 *data, size_t size, StringEncoding encoding = StringEncoding::ASCII);
+
+    [[nodiscard]] bool endsWithPrintable(const u8 *data, size_t size, StringEncoding encoding);
+    [[nodiscard]] size_t getCharacterCount(const u8 *data, size_t size, StringEncoding encoding);
+    [[nodiscard]] std::string decodeString(const u8 *data, size_t size, StringEncoding encoding);
+
+}
@@ -6,6 +6,7 @@
 
 #include "patches.hpp"
 #include <hex/api/imhex_api.hpp>
+#include <hex/providers/patch_store.hpp>
 
 namespace hex {
 
@@ -27,19 +28,23 @@ namespace hex {
         [[nodiscard]] static std::string getPattern()       { return ProjectFile::s_pattern; }
         static void setPattern(std::string_view pattern)    { ProjectFile::s_hasUnsavedChanged = true; ProjectFile::s_pattern = pattern; }
 
-        [[nodiscard]] static const Patches& getPatches()    { return ProjectFile::s_patches; }
-        static void setPatches(const Patches &patches)      { ProjectFile::s_hasUnsavedChanged = true; ProjectFile::s_patches = patches; }
+        [[nodiscard]] static const prv::PatchStore::Runs& getPatches()  { return ProjectFile::s_patches; }
+        static void setPatches(const prv::PatchStore::Runs &patches)    { ProjectFile::s_hasUnsavedChanged = true; ProjectFile::s_patches = patches; }
 
         [[nodiscard]] static const std::list<ImHexApi::Bookmarks::Entry>& getBookmarks()  { return ProjectFile::s_bookmarks; }
         static void setBookmarks(const std::list<ImHexApi::Bookmarks::Entry> &bookmarks)  { ProjectFile::s_hasUnsavedChanged = true; ProjectFile::s_bookmarks = bookmarks; }
 
     private:
+        // Patches are stored next to the project in a binary file, every patched byte being a JSON entry made large patches unusably slow
+        static bool loadPatchFile(const std::string &path);
+        static bool storePatchFile(const std::string &path);
+
         static inline std::string s_currProjectFilePath;
         static inline bool s_hasUnsavedChanged = false;
 
         static inline std::string s_filePath;
         static inline std::string s_pattern;
-        static inline Patches s_patches;
+        static inline prv::PatchStore::Runs s_patches;
         static inline std::list<ImHexApi::Bookmarks::Entry> s_bookmarks;
     };
 
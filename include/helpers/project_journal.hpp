@@ -0,0 +1,86 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/api/imhex_api.hpp>
+#include <hex/providers/patch_store.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Write-ahead journal of the patches and bookmarks of a file, so unsaved changes survive a crash.
+     * It starts with the full state followed by every change made since, recovering replays them and takes time proportional to the journal.
+     * Records are appended on a thread of its own, which writes them out in batches and syncs them to disk at most once per SyncInterval.
+     * Every record has a checksum, a record that was only partially written when ImHex crashed ends the journal.
+     */
+    class ProjectJournal {
+    public:
+        constexpr static auto BatchInterval = std::chrono::milliseconds(100);
+        constexpr static auto SyncInterval = std::chrono::seconds(1);
+
+        using Bookmarks = std::list<ImHexApi::Bookmarks::Entry>;
+
+        // The data size identifies the file the journal belongs to. Returns nullptr if the journal file can't be created
+        [[nodiscard]] static std::shared_ptr<ProjectJournal> create(const std::string &path, u64 dataSize, const prv::PatchStore::Runs &patches, const Bookmarks &bookmarks);
+        ~ProjectJournal();
+
+        ProjectJournal(const ProjectJournal&) = delete;
+        ProjectJournal& operator=(const ProjectJournal&) = delete;
+
+        // Thread safe, takes arguments as reported by PatchStore's change callback
+        void appendPatches(u64 address, u64 size, const std::vector<prv::PatchStore::Run> &runs);
+        void appendBookmarks(const Bookmarks &bookmarks);
+
+        // Starts over with the given state, for when the file got saved or the journal grew much larger than the state it describes
+        void reset(u64 dataSize, const prv::PatchStore::Runs &patches, const Bookmarks &bookmarks);
+        // Deletes the journal once everything that's pending got dropped. Nothing gets appended anymore afterwards
+        void discard();
+
+        // Size of the journal once everything pending is written
+        [[nodiscard]] u64 getSize() const;
+
+        struct Recovery {
+            prv::PatchStore::Runs patches;
+            Bookmarks bookmarks;
+            size_t recordCount = 0;
+        };
+
+        // Nothing if there's no journal or it belongs to data of a different size
+        [[nodiscard]] static std::optional<Recovery> recover(const std::string &path, u64 dataSize);
+        [[nodiscard]] static std::string getPath(const std::string &filePath) { return filePath + ".hexjournal"; }
+
+    private:
+        explicit ProjectJournal(std::string path);
+
+        [[nodiscard]] static std::vector<u8> createJournal(u64 dataSize, const prv::PatchStore::Runs &patches, const Bookmarks &bookmarks);
+        void append(std::vector<u8> record);
+        void writerLoop();
+        // Replaces the file with a new journal, only once the new one got synced. False if the old one is still the one open
+        bool startOver(const std::vector<u8> &contents);
+
+        std::string m_path;
+        FILE *m_file = nullptr;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        std::vector<u8> m_pending;
+        // Contents of a new journal that replaces the file, the pending records get appended after it
+        std::optional<std::vector<u8>> m_restart;
+        u64 m_size = 0;
+        bool m_discarded = false;
+        bool m_stopping = false;
+
+        std::thread m_writer;
+    };
+
+}
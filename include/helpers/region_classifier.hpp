@@ -0,0 +1,45 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <array>
+#include <vector>
+
+namespace hex {
+
+    enum class RegionClass : u8 {
+        Data,           // Anything that doesn't fit one of the other classes
+        Zero,
+        Text,
+        Code,
+        Compressed,
+        Encrypted
+    };
+
+    struct ClassifiedRegion {
+        u64 address;
+        u64 size;
+        RegionClass type;
+    };
+
+    /*
+     * Guesses what kind of data a block holds from its byte histogram and entropy scaled to [0, 1].
+     * Text is mostly printable ASCII, possibly interleaved with zeros for UTF-16. Compressed and encrypted data both have a very high entropy,
+     * encrypted data is told apart by its bytes being distributed evenly enough to pass a chi-square test for uniformity.
+     * Code has a medium entropy with a moderate amount of zeros and isn't mostly printable.
+     */
+    [[nodiscard]] RegionClass classifyBlock(const std::array<u64, 256> &valueCounts, u64 numBytes, float entropy);
+
+    // Compressed data can still pass the test in small blocks, the larger the block the more reliable the result
+    [[nodiscard]] bool isUniformlyDistributed(const std::array<u64, 256> &valueCounts, u64 numBytes);
+
+    /*
+     * Joins consecutive blocks of the same class into regions. Runs shorter than minimumBlocks become part of the region before them,
+     * so data mixing different classes doesn't get split up into countless tiny regions.
+     */
+    [[nodiscard]] std::vector<ClassifiedRegion> segmentRegions(const std::vector<RegionClass> &blockClasses, u64 blockSize, u64 dataSize, u64 minimumBlocks);
+
+    [[nodiscard]] const char* getRegionClassName(RegionClass type);
+    [[nodiscard]] u32 getRegionClassColor(RegionClass type);
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace hex {
+
+    enum class KeyOperation {
+        Xor,
+        Add,
+        Subtract
+    };
+
+    /*
+     * Transformations of a whole selection at once. They work on a copy of the selected data in memory, which the hex editor then writes
+     * back as a single patch. Repeating keys and patterns are tiled into a block that's a multiple of the vector width, so the kernels never
+     * have to track the key's position within a vector.
+     */
+
+    // Fills the data with the pattern over and over, starting with its first byte
+    void fillWithPattern(u8 *data, size_t size, const std::vector<u8> &pattern);
+
+    // Combines every byte with the byte of the repeating key at the same position
+    void combineWithKey(u8 *data, size_t size, const std::vector<u8> &key, KeyOperation operation);
+
+    // Reverses the order of all bytes
+    void reverseBytes(u8 *data, size_t size);
+
+    // Reverses the bytes of every value of the given width, bytes behind the last full value are left as they are
+    void swapByteOrder(u8 *data, size_t size, size_t width);
+
+    // Hex bytes like "DE AD BE EF", "0xDE, 0xAD" or "DEADBEEF". Returns nothing if anything else is part of the string
+    [[nodiscard]] std::optional<std::vector<u8>> parseHexBytes(std::string_view string);
+
+}
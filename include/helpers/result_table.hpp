@@ -0,0 +1,68 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include "helpers/persistent_analysis_cache.hpp"
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Regions found by an analysis, stored as columns instead of an array of structs: the offset and size of every result plus an optional label.
+     * Labels are indices into a pool of strings shared by all results, so results that have the same label only store it once.
+     * Tables are stored as five arrays of a PersistentAnalysisCache entry: offsets (u64), sizes (u64), label indices (u32, empty without labels),
+     * the characters of all labels back to back (char) and where every label starts in them followed by where the last one ends (u32).
+     * Tables restored from an entry use its arrays right out of the mapped file instead of copying them.
+     */
+    class ResultTable {
+    public:
+        constexpr static u32 NoLabel = 0xFFFF'FFFF;
+        constexpr static size_t ArrayCount = 5;
+
+        // Key of results exported to files of their own
+        constexpr static auto FileKey = "ResultTable";
+
+        ResultTable() = default;
+
+        // Tables restored from an entry can't be added to anymore
+        void add(u64 offset, u64 size, u32 label = NoLabel);
+        u32 addLabel(std::string_view label);
+
+        [[nodiscard]] size_t size() const { return this->getOffsets().size(); }
+        [[nodiscard]] bool empty() const { return this->size() == 0; }
+
+        [[nodiscard]] std::span<const u64> getOffsets() const { return this->m_entry != nullptr ? this->m_mappedOffsets : std::span<const u64>(this->m_offsets); }
+        [[nodiscard]] std::span<const u64> getSizes() const { return this->m_entry != nullptr ? this->m_mappedSizes : std::span<const u64>(this->m_sizes); }
+        [[nodiscard]] std::optional<std::string_view> getLabel(size_t index) const;
+
+        void store(PersistentAnalysisCache::Writer &writer) const;
+        // Nothing if the arrays starting at the given one aren't a valid table. The table keeps the entry alive
+        [[nodiscard]] static std::optional<ResultTable> load(std::shared_ptr<const PersistentAnalysisCache::Entry> entry, size_t firstArray = 0);
+
+        // Writes the table into a file of its own. Results of data that wasn't fingerprinted get a fingerprint with a hash of zero
+        [[nodiscard]] bool exportFile(const std::string &path, const PersistentAnalysisCache::Fingerprint &fingerprint) const;
+
+    private:
+        [[nodiscard]] std::span<const u32> getLabelIndices() const { return this->m_entry != nullptr ? this->m_mappedLabelIndices : std::span<const u32>(this->m_labelIndices); }
+        [[nodiscard]] std::string_view getLabelPool() const { return this->m_entry != nullptr ? this->m_mappedLabelPool : std::string_view(this->m_labelPool); }
+        [[nodiscard]] std::span<const u32> getLabelStarts() const { return this->m_entry != nullptr ? this->m_mappedLabelStarts : std::span<const u32>(this->m_labelStarts); }
+
+        std::vector<u64> m_offsets, m_sizes;
+        std::vector<u32> m_labelIndices;
+        std::string m_labelPool;
+        std::vector<u32> m_labelStarts = { 0 };
+
+        std::shared_ptr<const PersistentAnalysisCache::Entry> m_entry;
+        std::span<const u64> m_mappedOffsets, m_mappedSizes;
+        std::span<const u32> m_mappedLabelIndices;
+        std::string_view m_mappedLabelPool;
+        std::span<const u32> m_mappedLabelStarts;
+    };
+
+}
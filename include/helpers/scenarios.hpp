@@ -0,0 +1,14 @@
+#pragma once
+
+namespace hex {
+
+    /*
+     * Runs end-to-end scenarios on a generated large file without creating a window: opening and reading it, evaluating a pattern with
+     * a million array entries, extracting strings, hashing all of it and saving it with a hundred thousand scattered patches.
+     * Usage: imhex --scenarios [--filter <text>] [--size <MiB>] [--entries <count>] [--patches <count>] [--folder <path>] [--output <file.json>]
+     * Every scenario reports its wall time, peak resident memory and the allocations it made. The output file holds the same as JSON
+     * so results of different versions can be compared. Returns the process exit code, failing if any of the scenarios failed.
+     */
+    int runScenarios(int argc, char **argv);
+
+}
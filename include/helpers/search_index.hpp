@@ -0,0 +1,73 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include "helpers/persistent_analysis_cache.hpp"
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hex {
+
+    namespace prv { class Provider; }
+    class Task;
+
+    /*
+     * Index of the 3-grams contained in the provider's unpatched data, used to skip parts of the data
+     * that can't contain a searched byte sequence. Every block of data gets a one bit per hash filter of the 3-grams
+     * starting in it, so the index takes up a fixed fraction of the data size and can be built and stored block by block.
+     *
+     * A block is only reported as candidate if every 3-gram of the pattern is contained in it or the following block.
+     * Blocks that haven't been indexed yet are always candidates. Patched bytes are not part of the index,
+     * ranges containing them have to be searched separately.
+     */
+    class SearchIndex {
+    public:
+        constexpr static size_t BlockSize = 0x1000;
+        constexpr static size_t FilterBits = 0x2000;
+        constexpr static size_t GramSize = 3;
+
+        explicit SearchIndex(u64 dataSize);
+
+        // Indexes all blocks that aren't indexed yet. Blocks invalidated while they're being read stay unindexed
+        void build(prv::Provider *provider, Task &task);
+        void invalidate(u64 address, size_t size);
+
+        [[nodiscard]] u64 getDataSize() const { return this->m_dataSize; }
+        [[nodiscard]] bool isComplete() const;
+        [[nodiscard]] size_t getMemoryUsage() const;
+
+        // Returns the sorted, non-overlapping ranges within [from, to) that have to be searched to find all occurrences of pattern
+        [[nodiscard]] std::vector<std::pair<u64, u64>> getCandidateRanges(const std::vector<u8> &pattern, u64 from, u64 to) const;
+
+        // Patterns outside of this size range can't be looked up and need a full search
+        [[nodiscard]] static bool canFilter(size_t patternSize) { return patternSize >= GramSize && patternSize <= BlockSize; }
+
+        // The data version identifies the indexed data, usually the modification time of the file. Loading fails if it doesn't match
+        bool store(const std::string &path, u64 dataVersion) const;
+        [[nodiscard]] static std::shared_ptr<SearchIndex> load(const std::string &path, u64 dataSize, u64 dataVersion);
+
+        // Same as above for the persistent analysis cache, the filters get copied out of the entry since building keeps modifying them
+        void store(PersistentAnalysisCache::Writer &writer) const;
+        [[nodiscard]] static std::shared_ptr<SearchIndex> load(const PersistentAnalysisCache::Entry &entry, u64 dataSize);
+
+    private:
+        constexpr static size_t FilterWords = FilterBits / 64;
+
+        [[nodiscard]] static u32 hashGram(const u8 *gram);
+        [[nodiscard]] bool containsGram(u64 block, u32 hash) const;
+
+        u64 m_dataSize;
+        size_t m_blockCount;
+
+        std::vector<u64> m_filters;
+        std::vector<bool> m_indexed;
+        std::vector<u32> m_versions;    // Changed by every invalidation so builds don't store filters of outdated data
+
+        mutable std::shared_mutex m_mutex;
+    };
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <array>
+#include <span>
+#include <string>
+
+namespace hex::prv { class Snapshot; }
+
+namespace hex {
+
+    class Task;
+
+    /*
+     * Turns a range of bytes into one of the text formats selections can be copied and exported as. The data is passed in order
+     * with as many appendData calls as needed, so arbitrarily large ranges never have to be held in memory at once.
+     * Rows of the hex views are labelled with the addresses starting at the one passed in, chunks may end anywhere within a row.
+     */
+    class SelectionFormatter {
+    public:
+        enum class Format { Raw, Bytes, C, Cpp, CSharp, Rust, Python, Java, JavaScript, HexView, HTML };
+
+        SelectionFormatter(Format format, u64 address, u64 size);
+
+        void appendHeader(std::string &result) const;
+        void appendData(std::string &result, std::span<const u8> data);
+        void appendFooter(std::string &result) const;
+
+        // Formats all of the data at once
+        [[nodiscard]] static std::string format(Format format, u64 address, std::span<const u8> data);
+
+        /*
+         * Writes size bytes of the snapshot starting at offset to a file, reading and formatting them in chunks. Rows of the hex views start at address.
+         * Progress is reported through the task. Returns false if the file couldn't be written, the snapshot went stale or the task got cancelled,
+         * leaving a truncated file behind.
+         */
+        static bool exportToFile(const std::string &path, Format format, const prv::Snapshot &snapshot, u64 offset, u64 size, u64 address, Task &task);
+
+    private:
+        void appendRow(std::string &result, u64 rowAddress) const;
+
+        Format m_format;
+        u64 m_start, m_end;
+        u64 m_position;
+
+        // Bytes of the hex view row that's currently being filled, indexed by their address within the row
+        std::array<u8, 16> m_row = { };
+    };
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace hex {
+
+    class Task;
+    namespace prv { class Snapshot; }
+
+    struct StrideCandidate {
+        u64 stride;
+
+        // Average autocorrelation at all multiples of the stride up to the largest stride analyzed
+        double score;
+    };
+
+    struct StrideAnalysis {
+        // Autocorrelation of the byte values with their mean removed, indexed by lag and normalized to 1 at lag 0
+        std::vector<double> autocorrelation;
+
+        // Most likely record sizes, best first
+        std::vector<StrideCandidate> candidates;
+    };
+
+    /*
+     * Guesses the record size of tables from the autocorrelation of their bytes. Fields at the same offset of different records tend to
+     * hold similar values, so the data correlates with itself at the record size and all its multiples. Strides are scored by the average
+     * correlation over their multiples, which favors the record size over stray peaks. Multiples of a stride score about as well as the
+     * stride itself, so they're only reported if none of their divisors come close. Only strides up to a third of the largest one get reported.
+     *
+     * The correlation is calculated with FFTs over blocks of the region that each only overlap the next one by the largest stride, so memory
+     * usage doesn't depend on the size of the region and the blocks can be transformed on all cores. Returns nothing if the task got
+     * cancelled or the data couldn't be read.
+     */
+    [[nodiscard]] std::optional<StrideAnalysis> analyzeStrides(const prv::Snapshot &snapshot, u64 address, u64 size, u64 maxStride, Task &task);
+
+}
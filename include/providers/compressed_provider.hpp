@@ -0,0 +1,91 @@
+#pragma once
+
+#include <hex/providers/provider.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hex {
+
+    class Task;
+
+}
+
+namespace hex::prv {
+
+    class FileProvider;
+
+    /*
+     * Decompressed contents of a gzip or xz compressed file, read without decompressing the file to disk first.
+     * buildIndex() decompresses the whole file once and remembers checkpoints decompression can be restarted from: the deflate
+     * state every few MiB for gzip, the start of every block for xz. Reads decompress from the closest checkpoint before them,
+     * the block cache on top keeps the recently decompressed data around. The provider is empty until the index was built.
+     */
+    class CompressedProvider : public Provider {
+    public:
+        enum class Format { Unknown, GZip, XZ, Zstandard };
+
+        explicit CompressedProvider(std::string_view path);
+        ~CompressedProvider() override;
+
+        bool isAvailable() override;
+        bool isReadable() override;
+        bool isWritable() override;
+
+        void readRaw(u64 offset, void *buffer, size_t size) override;
+        void writeRaw(u64 offset, const void *buffer, size_t size) override;
+        size_t getRawSize() override;
+
+        std::vector<std::pair<std::string, std::string>> getDataInformation() override;
+        [[nodiscard]] std::string getName() const override;
+        [[nodiscard]] u32 getCapabilities() const override;
+
+        // Decompresses the entire file once, meant to be run as a background task. Returns false if the file is corrupt or the task was cancelled
+        bool buildIndex(Task &task);
+        [[nodiscard]] bool isIndexed() const { return this->m_indexed; }
+
+        [[nodiscard]] Format getFormat() const { return this->m_format; }
+        [[nodiscard]] const std::string& getPath() const { return this->m_path; }
+
+        [[nodiscard]] static Format detectFormat(const std::string &path);
+
+    private:
+        constexpr static size_t MinCheckpointSpacing = 0x10'0000;
+        constexpr static size_t InputBufferSize = 0x1'0000;
+
+        struct Checkpoint {
+            u64 uncompressedOffset;
+            u64 compressedOffset;
+            bool streamStart;       // Start of a gzip member or xz block, the decoder can be started there without any state
+            u8 bits;                // gzip: bits of the byte before compressedOffset that still belong to the next deflate block
+            u32 check;              // xz: integrity check type of the stream the block belongs to
+            std::vector<u8> window; // gzip: the last 32 KiB of data before the checkpoint
+        };
+
+        struct Decoder;
+
+        bool indexGZip(Task &task, std::vector<Checkpoint> &checkpoints, u64 &size);
+        bool indexXZ(Task &task, std::vector<Checkpoint> &checkpoints, u64 &size);
+
+        size_t readCompressed(u64 offset, u8 *buffer, size_t size);
+
+        bool startDecoder(size_t checkpoint);
+        size_t decode(u8 *buffer, size_t size);
+
+        std::string m_path;
+        std::unique_ptr<FileProvider> m_file;
+        Format m_format = Format::Unknown;
+
+        std::vector<Checkpoint> m_checkpoints;
+        std::atomic<u64> m_size = 0;
+        std::atomic<bool> m_indexed = false;
+
+        std::unique_ptr<Decoder> m_decoder;
+        std::mutex m_decoderMutex;
+    };
+
+}
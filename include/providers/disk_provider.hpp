@@ -0,0 +1,72 @@
+#pragma once
+
+#include <hex/providers/provider.hpp>
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace hex::prv {
+
+    /*
+     * Raw block devices and disks such as /dev/sda or \\.\PhysicalDrive0. Their size has to be queried from the device driver and
+     * they can't be mapped reliably, so all reads bypass the OS page cache and go straight to the device in whole, aligned sectors
+     * through a bounce buffer. The block cache on top is sized for scanning through the disk sequentially.
+     */
+    class DiskProvider : public Provider {
+    public:
+        explicit DiskProvider(std::string_view path);
+        ~DiskProvider() override;
+
+        // True if path refers to a device that has to be opened with a DiskProvider instead of a FileProvider
+        [[nodiscard]] static bool isDiskPath(const std::string &path);
+
+        bool isAvailable() override;
+        bool isReadable() override;
+        bool isWritable() override;
+
+        void readRaw(u64 offset, void *buffer, size_t size) override;
+        void writeRaw(u64 offset, const void *buffer, size_t size) override;
+        size_t getRawSize() override;
+
+        std::vector<std::pair<std::string, std::string>> getDataInformation() override;
+        [[nodiscard]] std::string getName() const override;
+        [[nodiscard]] u32 getCapabilities() const override;
+
+        [[nodiscard]] const std::string& getPath() const { return this->m_path; }
+        [[nodiscard]] size_t getSectorSize() const { return this->m_sectorSize; }
+
+    private:
+        constexpr static size_t BounceBufferSize = 0x10'0000;
+
+        // Reads or writes whole sectors, offset and size have to be multiples of the sector size and buffer has to be aligned to it
+        bool readSectors(u64 offset, void *buffer, size_t size);
+        bool writeSectors(u64 offset, const void *buffer, size_t size);
+
+        // Unbuffered transfers that aren't sector aligned have to go through the bounce buffer
+        [[nodiscard]] bool canTransferDirectly(u64 offset, const void *buffer, size_t size) const;
+
+        std::string m_path;
+
+        #if defined(OS_WINDOWS)
+        HANDLE m_disk = INVALID_HANDLE_VALUE;
+        #else
+        int m_disk = -1;
+        #endif
+
+        u64 m_diskSize = 0;
+        size_t m_sectorSize = 512;
+        bool m_unbuffered = false;
+
+        bool m_readable = false, m_writable = false;
+
+        u8 *m_bounceBuffer = nullptr;
+        std::mutex m_bounceBufferMutex;
+    };
+
+}
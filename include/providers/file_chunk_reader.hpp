@@ -0,0 +1,102 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/providers/chunk_reader.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(OS_WINDOWS)
+#include <windows.h>
+#else
+#include <sys/uio.h>
+#endif
+
+#if defined(OS_LINUX) && __has_include(<linux/io_uring.h>)
+#define FILE_CHUNK_READER_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+namespace hex::prv {
+
+    /*
+     * Reads large parts of a file with a fixed number of reads queued at the operating system at all times, so the drive never runs out of work.
+     * Linux queues them in an io_uring whose buffers are registered with the kernel once up front, Windows issues overlapped reads.
+     * The reader has its own handle of the file, the provider may map the file again or close it while the reader is still around.
+     */
+    class FileChunkReader : public ChunkReader {
+    public:
+        // Takes ownership of the file. Returns nullptr if there's no asynchronous I/O available, it's left to the caller to read the chunks then
+        #if defined(OS_WINDOWS)
+        [[nodiscard]] static std::unique_ptr<FileChunkReader> create(HANDLE file, u64 offset, u64 size, size_t chunkSize);
+        #else
+        [[nodiscard]] static std::unique_ptr<FileChunkReader> create(int file, u64 offset, u64 size, size_t chunkSize);
+        #endif
+
+        ~FileChunkReader() override;
+
+        FileChunkReader(const FileChunkReader&) = delete;
+        FileChunkReader& operator=(const FileChunkReader&) = delete;
+
+        [[nodiscard]] u8* next(size_t &size) override;
+
+    private:
+        FileChunkReader(u64 offset, u64 size, size_t chunkSize);
+
+        // Buffers of all queued reads together are never larger than this, but there are always enough to keep two chunks with the caller
+        constexpr static size_t BufferBudget = 0x400'0000;
+        constexpr static size_t MinQueueDepth = 3;
+        constexpr static size_t MaxQueueDepth = 16;
+
+        struct Slot {
+            u64 chunk;
+            bool pending = false;
+            s64 result = 0;
+
+            #if defined(OS_WINDOWS)
+            OVERLAPPED overlapped = { 0 };
+            #else
+            iovec vector = { nullptr, 0 };
+            #endif
+        };
+
+        [[nodiscard]] bool setup();
+        [[nodiscard]] bool submit(size_t slot, u64 chunk);
+        [[nodiscard]] bool wait(size_t slot);
+        void waitForAll();
+
+        [[nodiscard]] u8* getBuffer(size_t slot) { return this->m_buffers.data() + slot * this->m_chunkSize; }
+        [[nodiscard]] size_t getChunkSize(u64 chunk) const;
+
+        u64 m_offset, m_size;
+        size_t m_chunkSize;
+        u64 m_chunkCount;
+        u64 m_nextChunk = 0;
+        bool m_failed = false;
+
+        std::vector<u8> m_buffers;
+        std::vector<Slot> m_slots;
+
+        #if defined(OS_WINDOWS)
+        HANDLE m_file = INVALID_HANDLE_VALUE;
+        #else
+        int m_file = -1;
+        #endif
+
+        #if defined(FILE_CHUNK_READER_IO_URING)
+        int m_ring = -1;
+        bool m_fixedBuffers = false;
+
+        void *m_submissionRing = nullptr, *m_completionRing = nullptr;
+        size_t m_submissionRingSize = 0, m_completionRingSize = 0;
+        io_uring_sqe *m_submissions = nullptr;
+        size_t m_submissionsSize = 0;
+
+        u32 *m_submissionTail = nullptr, *m_submissionMask = nullptr, *m_submissionArray = nullptr;
+        u32 *m_completionHead = nullptr, *m_completionTail = nullptr, *m_completionMask = nullptr;
+        io_uring_cqe *m_completions = nullptr;
+        #endif
+    };
+
+}
@@ -2,7 +2,12 @@
 
 #include <hex/providers/provider.hpp>
 
+#include "helpers/file_watcher.hpp"
+
+#include <memory>
+#include <mutex>
 #include <string_view>
+#include <vector>
 
 #include <sys/stat.h>
 
@@ -25,16 +30,40 @@ namespace hex::prv {
         bool isReadable() override;
         bool isWritable() override;
 
-        void read(u64 offset, void *buffer, size_t size) override;
-        void write(u64 offset, const void *buffer, size_t size) override;
-
         void readRaw(u64 offset, void *buffer, size_t size) override;
         void writeRaw(u64 offset, const void *buffer, size_t size) override;
-        size_t getActualSize() override;
+        size_t getRawSize() override;
+        void hintRawAccess(u64 offset, size_t size, AccessHint hint) override;
+        [[nodiscard]] std::unique_ptr<ChunkReader> readRawChunks(u64 offset, u64 size, size_t chunkSize) override;
+
+        [[nodiscard]] const u8* getResidentData(u64 offset, size_t size) override;
 
         std::vector<std::pair<std::string, std::string>> getDataInformation() override;
+        [[nodiscard]] std::string getName() const override;
+        [[nodiscard]] u32 getCapabilities() const override;
+
+        [[nodiscard]] const std::string& getPath() const { return this->m_path; }
+
+        // Maps the file again if someone else modified it since the last call, data appended to it becomes part of the provider. All snapshots are stale afterwards
+        bool pollExternalChanges();
 
     private:
+        // Files larger than this only get mapped in a few fixed size windows at a time
+        constexpr static size_t FullMappingLimit = 0x4000'0000;
+        constexpr static size_t WindowSize = 0x0400'0000;
+        constexpr static size_t MaxWindows = 4;
+
+        struct MappedWindow {
+            u64 offset;
+            size_t size;
+            u8 *data;
+            u64 lastUse;
+        };
+
+        [[nodiscard]] u8* getMappedData(u64 offset, size_t &availableSize);
+        void unmapWindow(MappedWindow &window);
+        void remap();
+
         #if defined(OS_WINDOWS)
         HANDLE m_file;
         HANDLE m_mapping;
@@ -42,13 +71,20 @@ namespace hex::prv {
         int m_file;
         #endif
         std::string m_path;
-        void *m_mappedFile;
+        void *m_mappedFile = nullptr;
         size_t m_fileSize;
 
         bool m_fileStatsValid = false;
         struct stat m_fileStats = { 0 };
 
         bool m_readable, m_writable;
+
+        bool m_windowed = false;
+        std::vector<MappedWindow> m_windows;
+        u64 m_windowUseCounter = 0;
+        std::mutex m_windowMutex;
+
+        std::unique_ptr<FileWatcher> m_watcher;
     };
 
 }
\ No newline at end of file
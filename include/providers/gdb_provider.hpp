@@ -0,0 +1,90 @@
+#pragma once
+
+#include <hex/providers/provider.hpp>
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#if defined(OS_WINDOWS)
+#include <winsock2.h>
+#endif
+
+namespace hex::prv {
+
+    /*
+     * Memory of a target behind a GDB remote serial protocol server like a debug probe, OpenOCD or QEMU's gdbstub.
+     * Offsets are target addresses. Every round trip can take a long time on a slow link, so reads are split into the largest
+     * 'm' packets the server accepts and all of them are sent before waiting for the first reply. The block cache on top reads
+     * ahead generously so browsing turns into few large batches.
+     */
+    class GDBProvider : public Provider {
+    public:
+        GDBProvider(std::string host, u16 port, u64 size = 0x1'0000'0000);
+        ~GDBProvider() override;
+
+        bool isAvailable() override;
+        bool isReadable() override;
+        bool isWritable() override;
+
+        void readRaw(u64 offset, void *buffer, size_t size) override;
+        void writeRaw(u64 offset, const void *buffer, size_t size) override;
+        size_t getRawSize() override;
+
+        std::vector<std::pair<std::string, std::string>> getDataInformation() override;
+        [[nodiscard]] std::string getName() const override;
+        [[nodiscard]] u32 getCapabilities() const override;
+
+    private:
+        // Servers buffer requests they haven't answered yet, more than this could overflow small buffers on probes
+        constexpr static size_t MaxPipelinedRequests = 16;
+        constexpr static size_t DefaultPacketSize = 0x400;
+
+        #if defined(OS_WINDOWS)
+        using Socket = SOCKET;
+        constexpr static Socket InvalidSocket = INVALID_SOCKET;
+        #else
+        using Socket = int;
+        constexpr static Socket InvalidSocket = -1;
+        #endif
+
+        struct Request {
+            u64 address;
+            u8 *buffer;
+            size_t size;
+        };
+
+        bool connect();
+        void disconnect();
+
+        void negotiateFeatures();
+
+        bool sendPacket(const std::string &data);
+        [[nodiscard]] std::optional<std::string> receivePacket();
+        [[nodiscard]] std::optional<std::string> transact(const std::string &data);
+
+        bool sendAll(const char *data, size_t size);
+        [[nodiscard]] int receiveByte();
+
+        // Sends all requests before waiting for their replies, replies come back in the same order
+        void pipeline(const std::vector<Request> &requests, bool write);
+
+        std::string m_host;
+        u16 m_port;
+        u64 m_size;
+
+        Socket m_socket = InvalidSocket;
+        bool m_connected = false;
+        bool m_noAckMode = false;
+        size_t m_packetSize = DefaultPacketSize;
+
+        std::vector<char> m_receiveBuffer;
+        size_t m_receivePosition = 0;
+
+        u64 m_packets = 0;
+
+        std::mutex m_connectionMutex;
+    };
+
+}
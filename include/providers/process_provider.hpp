@@ -0,0 +1,80 @@
+#pragma once
+
+#include <hex/providers/provider.hpp>
+
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#if defined(OS_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace hex::prv {
+
+    /*
+     * Memory of a running process. All readable regions of its address space are laid out back to back, so the gaps between them
+     * don't take up any offsets. Reads are split along the regions and their pages and issued as a single batched system call where
+     * the OS has one, pages that can't be read stay zeroed. The block cache on top keeps the hex editor from reading byte by byte.
+     * Applied patches are written directly into the process.
+     */
+    class ProcessProvider : public Provider {
+    public:
+        struct MemoryRegion {
+            u64 address;
+            u64 size;
+            u64 offset;         // Where the region starts in the provider's data
+            std::string name;
+            bool writable;
+        };
+
+        explicit ProcessProvider(u32 processId);
+        ~ProcessProvider() override;
+
+        bool isAvailable() override;
+        bool isReadable() override;
+        bool isWritable() override;
+
+        void readRaw(u64 offset, void *buffer, size_t size) override;
+        void writeRaw(u64 offset, const void *buffer, size_t size) override;
+        size_t getRawSize() override;
+
+        std::vector<std::pair<std::string, std::string>> getDataInformation() override;
+        [[nodiscard]] std::string getName() const override;
+        [[nodiscard]] u32 getCapabilities() const override;
+
+        // The process keeps changing its memory while it's running. Reads the region list again and drops all cached data
+        void refresh();
+
+        [[nodiscard]] u32 getProcessId() const { return this->m_processId; }
+        [[nodiscard]] std::vector<MemoryRegion> getRegions() const;
+        [[nodiscard]] std::optional<u64> getOffsetOfAddress(u64 address) const;
+
+    private:
+        constexpr static size_t RemotePageSize = 0x1000;
+
+        struct Transfer {
+            u64 address;
+            u8 *buffer;
+            size_t size;
+        };
+
+        void updateRegions();
+
+        // Parts of [offset, offset + size) in process memory, split at region and page borders so an unreadable page doesn't take the rest of the read with it
+        [[nodiscard]] std::vector<Transfer> getTransfers(u64 offset, u8 *buffer, size_t size) const;
+
+        u32 m_processId;
+        #if defined(OS_WINDOWS)
+        HANDLE m_process = nullptr;
+        #endif
+
+        bool m_available = false, m_writable = false;
+
+        std::vector<MemoryRegion> m_regions;
+        u64 m_size = 0;
+        mutable std::shared_mutex m_regionMutex;
+    };
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <hex/providers/provider.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hex::prv {
+
+    class FileProvider;
+
+    /*
+     * Virtual address space of an ELF or PE executable or an Intel HEX or SREC firmware image. The file's segments are mapped to
+     * their addresses, the holes between them read as zeros. Offsets are relative to the lowest mapped address, which becomes the
+     * base address. Segments are kept sorted by offset so lookups are a binary search, reads inside a segment go straight to the
+     * mapped file or the decoded record data.
+     */
+    class SegmentedProvider : public Provider {
+    public:
+        enum class Format { Unknown, ELF, PE, IntelHex, SRecord };
+
+        struct Segment {
+            u64 offset;             // Start of the segment relative to the base address
+            u64 size;               // Size in the address space, may be larger than the data backing it
+            std::string name;
+
+            u64 fileOffset = 0;     // ELF and PE: where the segment's data starts in the file
+            u64 fileSize = 0;       // ELF and PE: bytes taken from the file, the rest of the segment reads as zeros
+            std::vector<u8> data;   // Intel HEX and SREC: decoded record data, it isn't stored in the file as is
+        };
+
+        explicit SegmentedProvider(std::string_view path);
+        ~SegmentedProvider() override;
+
+        bool isAvailable() override;
+        bool isReadable() override;
+        bool isWritable() override;
+
+        void readRaw(u64 offset, void *buffer, size_t size) override;
+        void writeRaw(u64 offset, const void *buffer, size_t size) override;
+        size_t getRawSize() override;
+
+        [[nodiscard]] const u8* getResidentData(u64 offset, size_t size) override;
+
+        std::vector<std::pair<std::string, std::string>> getDataInformation() override;
+        [[nodiscard]] std::string getName() const override;
+        [[nodiscard]] u32 getCapabilities() const override;
+
+        [[nodiscard]] Format getFormat() const { return this->m_format; }
+        [[nodiscard]] const std::string& getPath() const { return this->m_path; }
+        [[nodiscard]] const std::vector<Segment>& getSegments() const { return this->m_segments; }
+
+        // Segment the offset lies in, nullptr if it's in a hole
+        [[nodiscard]] const Segment* findSegment(u64 offset) const;
+
+        [[nodiscard]] static Format detectFormat(const std::string &path);
+
+    private:
+        bool loadELF(std::vector<Segment> &segments);
+        bool loadPE(std::vector<Segment> &segments);
+        bool loadIntelHex(std::vector<Segment> &segments);
+        bool loadSRecord(std::vector<Segment> &segments);
+
+        // The loaders store absolute addresses in the segments' offsets. Sorts them, trims overlaps and makes the offsets relative to the lowest address
+        void buildSegmentTable(std::vector<Segment> &&segments);
+
+        [[nodiscard]] std::vector<Segment>::const_iterator findSegmentAtOrAfter(u64 offset) const;
+        void readSegment(const Segment &segment, u64 segmentOffset, u8 *buffer, size_t size);
+
+        std::string m_path;
+        std::unique_ptr<FileProvider> m_file;
+        Format m_format = Format::Unknown;
+
+        std::vector<Segment> m_segments;
+        u64 m_size = 0;
+        bool m_available = false;
+    };
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+
+#include "helpers/batch_analysis.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+struct ImGuiTableSortSpecs;
+
+namespace hex {
+
+    /*
+     * Runs the same pattern, hashes and string count over a list of files and collates the results in a single table.
+     * Every file is a task of its own on the worker pool, the table fills up as they finish.
+     */
+    class ViewBatchAnalysis : public View {
+    public:
+        ViewBatchAnalysis();
+        ~ViewBatchAnalysis() override;
+
+        void drawContent() override;
+        void drawMenu() override;
+        bool isAvailable() override { return true; }
+
+    private:
+        static constexpr std::array<std::pair<const char*, crypt::HashSettings>, 7> HashFunctions = { {
+            { "CRC32",   { crypt::HashFunction::CRC32, 0xEDB8'8320, 0xFFFF'FFFF } },
+            { "MD5",     { crypt::HashFunction::MD5 } },
+            { "SHA-1",   { crypt::HashFunction::SHA1 } },
+            { "SHA-256", { crypt::HashFunction::SHA256 } },
+            { "SHA-512", { crypt::HashFunction::SHA512 } },
+            { "XXH64",   { crypt::HashFunction::XXH64 } },
+            { "BLAKE3",  { crypt::HashFunction::BLAKE3 } }
+        } };
+
+        std::vector<std::string> m_files;
+        std::string m_patternPath;
+        std::array<bool, HashFunctions.size()> m_selectedHashFunctions = { false, true, false, true, false, false, false };
+        bool m_countStrings = true;
+        int m_minimumStringLength = 5;
+
+        std::vector<TaskHandle> m_tasks;
+        size_t m_finishedTasks = 0;
+        // Results of a run that got cancelled or replaced by a new one are dropped
+        u64 m_run = 0;
+
+        // Hashes of the run the results belong to, the selection may change while it's going on
+        std::vector<std::string> m_hashNames;
+        std::vector<BatchAnalysisResult> m_results;
+        bool m_sortRequired = false;
+
+        void addFolder(const std::string &path);
+        void start();
+        void cancel();
+        [[nodiscard]] bool isRunning() const;
+        void sortResults(ImGuiTableSortSpecs *sortSpecs);
+        void drawResults();
+    };
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <hex/views/view.hpp>
+
+#include <array>
+#include <map>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Shows a region of the data as an image with a fixed number of pixels per row. The image is split into tiles of a few rows,
+     * each uploaded into a texture of its own once it becomes visible. Only a limited amount of data gets decoded per frame so scrolling
+     * stays smooth, tiles still missing show up over the next frames. Modified data only marks the tiles covering it to be decoded again.
+     */
+    class ViewBitmap : public View {
+    public:
+        explicit ViewBitmap();
+        ~ViewBitmap() override;
+
+        void drawContent() override;
+        void drawMenu() override;
+
+    private:
+        struct Tile {
+            u32 texture = 0;
+            u64 lastUsedFrame = 0;
+            bool dirty = false;
+        };
+
+        u64 m_region[2] = { 0 };
+        u32 m_width = 256;
+        int m_selectedDepth = 3, m_selectedPalette = 0;
+        int m_scale = 2;
+
+        std::array<u32, 256> m_palette = { 0 };
+        std::map<u64, Tile> m_tiles;
+
+        [[nodiscard]] u32 getBitsPerPixel() const;
+        [[nodiscard]] u64 getRowSize() const;
+        [[nodiscard]] u64 getRowCount() const;
+
+        void updatePalette();
+        void clearTiles();
+        void markDirty(u64 address, u64 size);
+        void uploadTile(u64 index, Tile &tile);
+        void evictTiles(u64 maxTiles);
+        void decodeRow(const u8 *data, u64 validBytes, u32 *pixels) const;
+    };
+
+}
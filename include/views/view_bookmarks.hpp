@@ -1,9 +1,11 @@
 #pragma once
 
 #include <hex/views/view.hpp>
+#include <hex/api/imhex_api.hpp>
 
-#include <vector>
 #include <list>
+#include <string>
+#include <vector>
 
 #include <hex/helpers/utils.hpp>
 
@@ -18,6 +20,20 @@ namespace hex {
 
         void drawContent() override;
         void drawMenu() override;
+
+    private:
+        ImHexApi::Bookmarks::Entry *m_selectedBookmark = nullptr;
+
+        // Only recomputed when the filter or the bookmarks changed
+        std::string m_filterText;
+        char m_filterStartAddress[17] = { 0 };
+        char m_filterEndAddress[17] = { 0 };
+        bool m_shouldUpdateFilter = true;
+        u64 m_filteredGeneration = -1;
+        std::vector<ImHexApi::Bookmarks::Entry*> m_filteredBookmarks;
+
+        void updateFilter();
+        void drawBookmarkDetails(ImHexApi::Bookmarks::Entry &bookmark);
     };
 
 }
\ No newline at end of file
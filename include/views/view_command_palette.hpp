@@ -2,13 +2,19 @@
 
 #include <hex.hpp>
 #include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
 
 #include <imgui.h>
 #include <hex/lang/pattern_data.hpp>
 
-#include <vector>
-#include <tuple>
+#include <chrono>
 #include <cstdio>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
 
 namespace hex {
 
@@ -30,12 +36,28 @@ namespace hex {
         ImVec2 getMaxSize() override { return ImVec2(400, 100); }
 
     private:
+        constexpr static auto CommandDebounceTime = std::chrono::milliseconds(150);
+        constexpr static size_t MaxFuzzyResults = 10;
+
         bool m_justOpened = false;
         std::vector<char> m_commandBuffer;
         std::vector<std::string> m_lastResults;
         std::string m_exactResult;
 
+        // Commands including the space following keyword commands, mapped to their entry. Rebuilt when commands got added
+        std::map<std::string, size_t> m_commandIndex;
+        std::set<size_t> m_commandLengths;
+        size_t m_indexedCommandCount = 0;
+
+        std::optional<size_t> m_matchedCommand;
+        std::string m_commandArgument;
+        std::chrono::steady_clock::time_point m_lastInputTime;
+        bool m_shouldRunCommand = false;
+        TaskHandle m_commandTask;
+
+        void updateCommandIndex();
         std::vector<std::string> getCommandResults(std::string_view command);
+        void runPendingCommand();
     };
 
 }
\ No newline at end of file
@@ -6,7 +6,9 @@
 
 #include <bit>
 #include <cstdio>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace hex {
 
@@ -28,7 +30,31 @@ namespace hex {
 
         u64 m_startAddress = 0;
         size_t m_validBytes = 0;
-        std::vector<std::pair<std::string, ContentRegistry::DataInspector::DisplayFunction>> m_cachedData;
+        size_t m_readSize = 0;
+        size_t m_validEntryCount = 0;
+
+        // Read once per refresh and shared by all entries, the generated values are kept so refreshing doesn't allocate
+        std::vector<u8> m_buffer;
+        std::vector<std::string> m_cachedValues;
+
+        // Decoding the selection as a column of one entry type. Larger selections only get decoded up to this size
+        constexpr static size_t MaxColumnSize = 0x400'0000;
+
+        struct ColumnStatistics {
+            size_t count;
+            double min, max, mean;
+        };
+
+        size_t m_selectionSize = 0;
+        size_t m_columnEntry = 0;
+        bool m_shouldUpdateColumn = true;
+        std::vector<u8> m_columnData;
+        std::vector<double> m_columnValues;
+        std::optional<ColumnStatistics> m_columnStatistics;
+        std::string m_columnValue;
+
+        void updateColumn();
+        void drawColumn();
     };
 
 }
\ No newline at end of file
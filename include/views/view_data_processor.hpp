@@ -6,8 +6,14 @@
 #include <hex/views/view.hpp>
 #include <hex/data_processor/node.hpp>
 #include <hex/data_processor/link.hpp>
+#include <hex/data_processor/executor.hpp>
+#include <hex/api/task.hpp>
+#include <hex/providers/overlay.hpp>
 
 #include <array>
+#include <atomic>
+#include <map>
+#include <memory>
 #include <string>
 
 namespace hex {
@@ -27,14 +33,34 @@ namespace hex {
         std::list<dp::Node*> m_nodes;
         std::list<dp::Link>  m_links;
 
+        dp::Executor m_executor;
+
         std::vector<prv::Overlay*> m_dataOverlays;
 
+        // Processing in the background writes into overlays of its own, the ones it changed replace the visible ones once it's done
+        struct StagedOverlay {
+            std::atomic<u64> generation = 0;
+            prv::Overlay overlay { &generation };
+        };
+
+        bool m_processInBackground = false;
+        bool m_overlaysStaged = false;
+        TaskHandle m_processingTask;
+        std::vector<std::unique_ptr<StagedOverlay>> m_stagedOverlays;
+        // Sizes of the node contents as they were last drawn, placeholders keep them while processing
+        std::map<u32, ImVec2> m_nodeContentSizes;
+
         int m_rightClickedId = -1;
         ImVec2 m_rightClickedCoords;
 
         void eraseLink(u32 id);
         void eraseNodes(const std::vector<int> &ids);
         void processNodes();
+        void processNodesInBackground();
+        // The graph must not be modified while it's being processed in the background
+        [[nodiscard]] bool isProcessing() const;
+
+        static void applyTheme();
     };
 
 }
\ No newline at end of file
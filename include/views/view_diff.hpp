@@ -0,0 +1,77 @@
+#pragma once
+
+#include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+
+#include "helpers/block_hash_map.hpp"
+#include "helpers/content_chunker.hpp"
+#include "helpers/delta_patches.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hex {
+
+    namespace prv { class Provider; }
+
+    class ViewDiff : public View {
+    public:
+        explicit ViewDiff();
+        ~ViewDiff() override;
+
+        void drawContent() override;
+        void drawMenu() override;
+
+    private:
+        struct Difference {
+            u64 address;
+            size_t size;
+        };
+
+        constexpr static size_t MaxDifferences = 0x10000;
+
+        std::string m_comparePath;
+        std::shared_ptr<prv::Provider> m_compareProvider;
+
+        // Maps are replaced instead of rebuilt in place as a cancelled task may still be using the old ones
+        std::shared_ptr<BlockHashMap> m_currentHashes, m_compareHashes;
+        bool m_currentHashesValid = false, m_compareHashesValid = false;
+
+        TaskHandle m_diffTask;
+        std::vector<Difference> m_differences;
+        u64 m_differingBytes = 0;
+        bool m_differencesTruncated = false;
+        bool m_shouldCompare = false;
+
+        // The compared file never changes, so its chunks are only calculated once
+        std::shared_ptr<const std::vector<ContentChunker::Chunk>> m_compareChunks;
+        TaskHandle m_movedDataTask;
+        std::vector<ContentChunker::Match> m_movedRegions;
+        bool m_movedRegionsOutdated = false;
+        bool m_onlyShowShifted = true;
+        std::vector<size_t> m_shownMovedRegions;   // Indices of the regions passing the filter, so the table can be clipped
+
+        TaskHandle m_patchTask;
+        DeltaPatchFormat m_patchFormat = DeltaPatchFormat::BPS;
+
+        void openCompareFile(const std::string &path);
+        void closeCompareFile();
+        [[nodiscard]] bool isComparing() const;
+
+        // Rebuilds the hash maps that are outdated and compares the bytes of all blocks whose hashes differ
+        void compare();
+
+        // Matches content defined chunks of both files to find data that moved
+        void findMovedData();
+        void updateShownMovedRegions();
+
+        // Creates a patch that turns the compared file into the current data
+        void createPatch(const std::string &path);
+
+        void drawDifferences(prv::Provider *provider);
+        void drawMovedData();
+        void drawCreatePatch();
+    };
+
+}
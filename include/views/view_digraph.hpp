@@ -0,0 +1,44 @@
+#pragma once
+
+#include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+
+#include "helpers/digraph_analysis.hpp"
+
+#include <memory>
+#include <string>
+
+namespace hex {
+
+    class ViewDigraph : public View {
+    public:
+        explicit ViewDigraph();
+        ~ViewDigraph() override;
+
+        void drawContent() override;
+        void drawMenu() override;
+
+    private:
+        u64 m_region[2] = { 0 };
+        bool m_shouldMatchSelection = true;
+
+        TaskHandle m_analysisTask;
+        std::shared_ptr<DigraphAnalysis> m_analysis;
+        std::string m_error;
+
+        u32 m_digraphTexture = 0, m_trigraphTexture = 0;
+
+        // Rotation of the trigraph cube in radians, first around the vertical axis and then around the horizontal one
+        float m_yaw = 0.6F, m_pitch = 0.5F;
+        bool m_trigraphOutdated = false;
+
+        void analyze();
+        [[nodiscard]] bool isAnalyzing() const;
+
+        void renderDigraphs();
+        void renderTrigraphs();
+        void drawDigraphPlot();
+        void drawTrigraphPlot();
+    };
+
+}
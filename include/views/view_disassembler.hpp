@@ -1,26 +1,49 @@
 #pragma once
 
 #include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+#include <hex/helpers/memory_budget.hpp>
+#include <hex/helpers/utils.hpp>
 
+#include "helpers/code_references.hpp"
 #include "helpers/disassembler.hpp"
+#include "helpers/persistent_analysis_cache.hpp"
 
 #include <cstdio>
+#include <list>
+#include <memory>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace hex {
 
     namespace prv { class Provider; }
 
+    // Only where instructions are is kept for the whole code region, their text gets produced again for the rows being drawn
     struct Disassembly {
-        u64 address;
         u64 offset;
-        size_t size;
+        u32 size;
+    };
+
+    struct DisassemblyText {
+        u64 address;
         std::string bytes;
         std::string mnemonic;
         std::string operators;
     };
 
+    struct DisassemblySettings {
+        Architecture architecture;
+        cs_mode mode;
+        u64 baseAddress;
+        u64 codeStart, codeEnd;
+        u64 pageAddress;        // The code region is relative to this page, so the disassembly stays valid while other pages are shown
+
+        bool operator==(const DisassemblySettings&) const = default;
+    };
+
     class ViewDisassembler : public View {
     public:
         explicit ViewDisassembler();
@@ -41,7 +64,46 @@ namespace hex {
         bool m_littleEndianMode = true, m_micoMode = false, m_sparcV9Mode = false;
 
         std::vector<Disassembly> m_disassembly;
+        DisassemblySettings m_disassemblySettings = { };  // Modified code gets disassembled again using the settings the rest was created with
+        TaskHandle m_disassemblyTask;
+
+        csh m_capstoneHandle = 0;
+        bool m_capstoneHandleOpen = false;
+        std::unordered_map<u64, DisassemblyText> m_textCache;  // Keyed by offset, cleared whenever the disassembly changes
+
+        // Recent disassemblies of the current provider, disassembling the same region of unchanged data again only restores them
+        struct CachedDisassembly {
+            DisassemblySettings settings;
+            u64 dataGeneration;
+            std::vector<Disassembly> disassembly;
+            std::shared_ptr<const CodeReferences> references;  // Null until they were found
+        };
+        constexpr static size_t MaxCachedDisassemblies = 8;
+        std::list<CachedDisassembly> m_disassemblyCache;
+        // Only the cached disassemblies can be evicted, the current one is in use
+        MemoryBudget::Registration m_disassemblyMemory, m_disassemblyCacheMemory;
+
+        // Found in the background for the current disassembly, null until that's done. Results of analyses of an older one get dropped
+        std::shared_ptr<const CodeReferences> m_references;
+        TaskHandle m_referenceTask;
+        u64 m_referenceGeneration = 0;
+        std::optional<size_t> m_scrollToRow;
+
+        void disassemble();
+        void updateDisassembly(const Region &region);
+        // References of the disassembly get looked for in the background unless they're already known
+        void setDisassembly(std::vector<Disassembly> disassembly, const DisassemblySettings &settings, std::shared_ptr<const CodeReferences> references = nullptr);
+        // References shared with the current disassembly are counted for that one
+        [[nodiscard]] size_t getMemoryUsage(const CachedDisassembly &cached) const;
+        const DisassemblyText& getText(const Disassembly &instruction);
 
+        void analyzeReferences();
+        // Disassemblies of unmodified data get stored on disk together with their references
+        bool loadDisassembly(prv::Provider *provider, const DisassemblySettings &settings);
+        void storeDisassembly(const PersistentAnalysisCache::Fingerprint &fingerprint) const;
+        void jumpTo(u64 offset);
+        void drawReferencesPopup(const Disassembly &instruction);
+        void drawFunctions();
 
     };
 
@@ -1,8 +1,17 @@
 #pragma once
 
 #include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
 
+#include "helpers/crypto.hpp"
+
+#include <array>
+#include <compare>
 #include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace hex {
 
@@ -17,12 +26,36 @@ namespace hex {
         void drawMenu() override;
 
     private:
+        static constexpr const char* HashFunctionNames[] = { "CRC16", "CRC32", "MD5", "SHA-1", "SHA-224", "SHA-256", "SHA-384", "SHA-512", "XXH64", "BLAKE3" };
+        static constexpr size_t HashFunctionCount = sizeof(HashFunctionNames) / sizeof(const char *);
+
         bool m_shouldInvalidate = true;
-        int m_currHashFunction = 0;
+        std::array<bool, HashFunctionCount> m_selectedHashFunctions = { false, true, true, true, false, true, false, false, false, false };
+        int m_crc16Polynomial = 0, m_crc16Init = 0;
+        int m_crc32Polynomial = 0, m_crc32Init = 0;
         u64 m_hashRegion[2] = { 0 };
         bool m_shouldMatchSelection = false;
 
-        static constexpr const char* HashFunctionNames[] = { "CRC16", "CRC32", "MD5", "SHA-1", "SHA-224", "SHA-256", "SHA-384", "SHA-512" };
+        struct CacheKey {
+            crypt::HashFunction function;
+            u32 polynomial, init;
+            u64 address;
+            size_t size;
+
+            auto operator<=>(const CacheKey&) const = default;
+        };
+
+        constexpr static size_t MaxCachedHashes = 0x100;
+
+        TaskHandle m_hashTask;
+        std::vector<std::pair<std::string, std::string>> m_hashResults;
+
+        // Digests of previous calculations. Entries are dropped when data inside their region changes
+        std::map<CacheKey, std::vector<u8>> m_hashCache;
+        u64 m_dataGeneration = 0;
+
+        // Calculates all selected hashes of the region in one pass
+        void calculate(prv::Provider *provider, u64 address, size_t size);
     };
 
 }
\ No newline at end of file
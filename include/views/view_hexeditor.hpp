@@ -1,27 +1,47 @@
 #pragma once
 
 #include <hex/helpers/utils.hpp>
+#include <hex/helpers/highlight_index.hpp>
+#include <hex/helpers/memory_budget.hpp>
+#include <hex/helpers/byte_searcher.hpp>
 #include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+
+#include "helpers/delta_patches.hpp"
+#include "helpers/entropy_pyramid.hpp"
+#include "helpers/file_watcher.hpp"
+#include "helpers/persistent_analysis_cache.hpp"
+#include "helpers/project_journal.hpp"
+#include "helpers/result_table.hpp"
+#include "helpers/search_index.hpp"
+#include "helpers/selection_formatter.hpp"
 
 #include <imgui_memory_editor.h>
 #include <ImGuiFileBrowser.h>
 
+#include <chrono>
+#include <functional>
 #include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <tuple>
 #include <random>
 #include <vector>
 
 #include <hex/lang/pattern_data.hpp>
+#include <hex/lang/pattern_index.hpp>
 
 namespace hex {
 
-    namespace prv { class Provider; }
+    namespace prv { class Provider; class CompressedProvider; class FileProvider; }
 
-    using SearchFunction = std::vector<std::pair<u64, u64>> (*)(prv::Provider* &provider, std::string string);
+    using SearchFunction = ByteSearcher (*)(std::string string);
 
     class ViewHexEditor : public View {
     public:
-        ViewHexEditor(std::vector<lang::PatternData*> &patternData);
+        ViewHexEditor(std::vector<lang::PatternData*> &patternData, lang::PatternIndex &patternIndex);
         ~ViewHexEditor() override;
 
         void drawContent() override;
@@ -32,41 +52,155 @@ namespace hex {
         MemoryEditor m_memoryEditor;
 
         std::vector<lang::PatternData*> &m_patternData;
+        lang::PatternIndex &m_patternIndex;
 
-        std::map<u64, u32> m_highlightedBytes;
+        HighlightIndex m_patternHighlights;
+        HighlightIndex m_bookmarkHighlights;
+        u64 m_bookmarkGeneration = -1;
 
         char m_searchStringBuffer[0xFFFF] = { 0 };
         char m_searchHexBuffer[0xFFFF] = { 0 };
+        char m_replaceStringBuffer[0xFFFF] = { 0 };
+        char m_replaceHexBuffer[0xFFFF] = { 0 };
+        char m_searchPatternBuffer[0xFFFF] = { 0 };
+        char m_searchSignaturesBuffer[0xFFFF] = { 0 };
+        char m_searchRegexBuffer[0xFFFF] = { 0 };
         SearchFunction m_searchFunction = nullptr;
-        std::vector<std::pair<u64, u64>> *m_lastSearchBuffer;
+
+        // Filled by the search task while it runs, matches are only ever appended
+        struct SearchResults {
+            std::mutex mutex;
+            std::vector<std::pair<u64, u64>> matches;
+
+            // Only used by signature searches, the signature that produced each match
+            std::vector<u32> patternIndices;
+            std::vector<std::string> patternNames;
+        };
 
         s64 m_lastSearchIndex = 0;
-        std::vector<std::pair<u64, u64>> m_lastStringSearch;
-        std::vector<std::pair<u64, u64>> m_lastHexSearch;
+        std::shared_ptr<SearchResults> m_lastStringSearch = std::make_shared<SearchResults>();
+        std::shared_ptr<SearchResults> m_lastHexSearch = std::make_shared<SearchResults>();
+        std::shared_ptr<SearchResults> m_lastPatternSearch = std::make_shared<SearchResults>();
+        std::shared_ptr<SearchResults> m_lastSignatureSearch = std::make_shared<SearchResults>();
+        std::shared_ptr<SearchResults> m_lastRegexSearch = std::make_shared<SearchResults>();
+        std::shared_ptr<SearchResults> *m_lastSearchBuffer = &this->m_lastStringSearch;
+        std::shared_ptr<SearchResults> m_pendingSearchJump;
+        TaskHandle m_searchTask;
+
+        std::shared_ptr<SearchIndex> m_searchIndex;
+        TaskHandle m_searchIndexTask;
+        MemoryBudget::Registration m_searchIndexMemory;
+
+        std::map<prv::Provider*, TaskHandle> m_compressedIndexTasks;
+
+        // Files as they were last seen, comparing them with the files after someone else changed them finds the parts that need to be analyzed again
+        std::map<prv::Provider*, std::shared_ptr<const FileBlockHashes>> m_fileBlockHashes;
+        TaskHandle m_fileHashTask;
+        std::chrono::steady_clock::time_point m_lastExternalChangeCheck;
+        bool m_providerTabsOutdated = false;
+
+        // Unsaved changes of every writable file, a journal that's left behind after a crash gets offered for recovery when the file is opened again
+        std::map<prv::Provider*, std::shared_ptr<ProjectJournal>> m_journals;
+        u64 m_journaledBookmarkGeneration = -1;
+
+        struct PendingRecovery {
+            prv::Provider *provider;
+            std::string path;
+            ProjectJournal::Recovery recovery;
+        };
+        std::optional<PendingRecovery> m_pendingRecovery;
 
         s64 m_gotoAddress = 0;
+        u32 m_processId = 0;
+
+        char m_gdbHostBuffer[0x100] = "localhost";
+        u16 m_gdbPort = 3333;
+        u64 m_gdbAddressSpaceSize = 0x1'0000'0000;
 
         char m_baseAddressBuffer[0x20] = { 0 };
 
+        // Operation and its hex key or pattern of the "Modify selection" popup
+        int m_selectionOperation = 0;
+        char m_selectionOperationBuffer[0x100] = { 0 };
+
+        // Bytes get inserted in front of the selection or behind it
+        char m_insertSizeBuffer[0x20] = { 0 };
+        bool m_insertBehindSelection = false;
+
         std::vector<u8> m_dataToSave;
 
         std::string m_loaderScriptScriptPath;
         std::string m_loaderScriptFilePath;
 
+        TaskHandle m_saveTask;
+        bool m_readOnlyBeforeSave = false;
+
+        TaskHandle m_patchTask;
+        TaskHandle m_exportTask;
+
+        // Overview of all of the data next to the editor, drawn from the entropy analysis of the Information view
+        std::shared_ptr<const EntropyPyramid> m_minimapEntropy;
+        u32 m_minimapTexture = 0;
+        bool m_minimapOutdated = false;
+
         void drawSearchPopup();
+        void startSearch(const char *input);
+        void startSignatureSearch();
+        void startRegexSearch();
+        void startReplaceAll(const char *input, const char *replacement);
+        void drawSignatureMatches();
+        [[nodiscard]] static ResultTable getResultTable(SearchResults &results);
+        [[nodiscard]] bool isSearching() const;
+        void gotoSearchResult(s64 index);
+        void buildSearchIndex();
+        void storeSearchIndex();
+        void loadSearchIndex();
+        [[nodiscard]] bool isBuildingSearchIndex() const;
         void drawGotoPopup();
         void drawEditPopup();
+        void drawSavePopup();
+        void updateMinimapTexture();
+        void drawMinimap(ImVec2 size);
 
+        [[nodiscard]] bool canChangeProvider() const;
+        void closeProvider(prv::Provider *provider);
+        void drawProviderTabs();
         void openFile(std::string path);
+        void openCompressedFile(std::string path);
+        void indexCompressedFile(prv::CompressedProvider *provider);
+        void hashFileBlocks(prv::FileProvider *provider);
+        void setFingerprint(prv::Provider *provider, const PersistentAnalysisCache::Fingerprint &fingerprint, u64 dataGeneration);
+        void checkForExternalChanges();
+        void startJournal(prv::Provider *provider, const std::string &path);
+        void stopJournal(prv::Provider *provider);
+        void updateJournals();
+        void drawRecoveryPopup();
+        void openMappedImage(std::string path);
+        void openProcess(u32 processId);
+        void drawOpenProcessPopup();
+        void connectGDB(const std::string &host, u16 port, u64 size);
+        void drawConnectGDBPopup();
+        void save();
+        void saveStructuralEdits();
+        void saveAs();
+        [[nodiscard]] bool isSaving() const;
+        void applyDeltaPatch(const std::string &path);
+        void exportDeltaPatch(DeltaPatchFormat format);
+        void drawPatchPopup();
+        [[nodiscard]] bool isPatching() const;
         bool saveToFile(std::string path, const std::vector<u8>& data);
         bool loadFromFile(std::string path, std::vector<u8>& data);
 
-        enum class Language { C, Cpp, CSharp, Rust, Python, Java, JavaScript };
-        void copyBytes();
-        void copyString();
-        void copyLanguageArray(Language language);
-        void copyHexView();
-        void copyHexViewHTML();
+        void undo();
+        void redo();
+
+        void copySelection(SelectionFormatter::Format format);
+        void exportSelection(SelectionFormatter::Format format);
+        void modifySelection(const std::function<void(u8 *data, size_t size)> &operation);
+        void pasteClipboard();
+        void drawModifySelectionPopup();
+        void drawExportSelectionPopup();
+        [[nodiscard]] bool isExportingSelection() const;
 
     };
 
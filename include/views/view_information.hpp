@@ -1,9 +1,18 @@
 #pragma once
 
 #include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+#include <hex/helpers/memory_budget.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include "helpers/entropy_pyramid.hpp"
+#include "helpers/persistent_analysis_cache.hpp"
+#include "helpers/region_classifier.hpp"
 
 #include <array>
 #include <cstdio>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -21,18 +30,39 @@ namespace hex {
 
     private:
         bool m_dataValid = false;
-        u32 m_blockSize = 0;
         float m_averageEntropy = 0;
         float m_highestBlockEntropy = 0;
-        std::vector<float> m_blockEntropy;
+        std::shared_ptr<EntropyPyramid> m_entropy;
+        MemoryBudget::Registration m_entropyMemory;
+        u64 m_entropyViewStart = 0, m_entropyViewEnd = 0;
+        std::vector<ClassifiedRegion> m_regions;
 
         std::array<float, 256> m_valueCounts = { 0 };
         bool m_shouldInvalidate = false;
+        std::vector<TaskHandle> m_analysisTasks;
+        std::vector<Region> m_pendingUpdates;
 
         std::pair<u64, u64> m_analyzedRegion = { 0, 0 };
 
         std::string m_fileDescription;
         std::string m_mimeType;
+
+        // Results kept in the analysis cache while a different provider is selected
+        struct CachedAnalysis {
+            std::shared_ptr<EntropyPyramid> entropy;
+            std::pair<u64, u64> analyzedRegion;
+            std::string fileDescription;
+            std::string mimeType;
+        };
+
+        void analyze();
+        bool loadAnalysis(prv::Provider *provider);
+        void storeAnalysis(const PersistentAnalysisCache::Fingerprint &fingerprint) const;
+        [[nodiscard]] bool isAnalyzing() const;
+        void updateAnalysis(const Region &region);
+        void updateStatistics();
+        void drawEntropyPlot();
+        void drawRegions();
     };
 
 }
\ No newline at end of file
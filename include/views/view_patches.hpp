@@ -6,6 +6,7 @@
 #include <hex/views/view.hpp>
 
 #include <optional>
+#include <vector>
 
 namespace hex {
 
@@ -20,7 +21,14 @@ namespace hex {
         void drawMenu() override;
 
     private:
-        u64 m_selectedPatch;
+        constexpr static size_t PreviewSize = 8;
+
+        Region m_selectedPatch = { 0, 0 };
+
+        // Start addresses of the runs of the provider's patches at the generation they got collected at
+        std::vector<u64> m_runAddresses;
+        prv::Provider *m_indexedProvider = nullptr;
+        u64 m_indexedGeneration = 0;
     };
 
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+#include <hex/helpers/memory_arena.hpp>
 #include <hex/lang/evaluator.hpp>
 #include <hex/lang/pattern_language.hpp>
 
@@ -8,6 +10,10 @@
 
 #include <cstring>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -33,9 +39,38 @@ namespace hex {
         TextEditor m_textEditor;
         std::vector<std::pair<lang::LogConsole::Level, std::string>> m_console;
 
+        // State shared with the task evaluating the pattern. Top level patterns are handed over as soon as they're done
+        struct Evaluation {
+            std::shared_ptr<MemoryArena> arena = std::make_shared<MemoryArena>();
+            std::mutex mutex;
+            std::optional<size_t> keptPatterns;     // Set once the code compiled, the current patterns after these get replaced
+            std::vector<lang::PatternData*> newPatterns;
+            std::optional<std::pair<u32, std::string>> error;
+            u64 dataGeneration = 0;                 // Set before the task starts, only read afterwards
+
+            ~Evaluation() {
+                for (auto &pattern : this->newPatterns)
+                    delete pattern;
+            }
+        };
+
+        TaskHandle m_parseTask;
+        TaskHandle m_detectionTask;
+        std::shared_ptr<Evaluation> m_evaluation;
+        std::vector<std::pair<size_t, std::shared_ptr<MemoryArena>>> m_patternArenas;    // Arenas holding the current patterns from the given index on
+        std::optional<std::string> m_pendingPattern;
+
+        // Data generation the runtime's last evaluation started on. It can only continue from the statements that didn't change if the data is still the same
+        std::optional<u64> m_resumableGeneration;
+
+        // Evaluation waits until typing paused for a bit instead of restarting on every keystroke
+        constexpr static double TextChangeDelay = 0.3;
+        std::optional<double> m_textChangeTime;
+
         void loadPatternFile(std::string path);
         void clearPatternData();
         void parsePattern(char *buffer);
+        void processEvaluation();
     };
 
 }
\ No newline at end of file
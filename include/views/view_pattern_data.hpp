@@ -4,11 +4,15 @@
 
 #include <imgui.h>
 #include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
 #include <hex/lang/pattern_data.hpp>
+#include <hex/lang/pattern_index.hpp>
 
+#include <optional>
 #include <vector>
 #include <tuple>
 #include <cstdio>
+#include <unordered_set>
 
 namespace hex {
 
@@ -16,16 +20,67 @@ namespace hex {
 
     class ViewPatternData : public View {
     public:
-        ViewPatternData(std::vector<lang::PatternData*> &patternData);
+        ViewPatternData(std::vector<lang::PatternData*> &patternData, lang::PatternIndex &patternIndex);
         ~ViewPatternData() override;
 
         void drawContent() override;
         void drawMenu() override;
 
     private:
+        /*
+         * The tree is drawn from a flat list of its visible rows, so only the rows that are actually on screen have to be drawn.
+         * Plain entries of static arrays are stored as a single row spanning all of their lines, expandable ones are split
+         * up into pages of at most PageSize rows. The list only gets rebuilt when the patterns, their order or the open rows change.
+         */
+        struct Row {
+            enum class Type { Pattern, Entries, Field, Page } type;
+            lang::PatternData *pattern;     // The static array for Entries and Page rows, the bitfield for Field rows
+            u32 parent;
+            u32 depth;
+            u64 id;                         // Identifies the row's open state, it stays the same as long as the path to the pattern does
+            bool isEntry;                   // Pattern is the template of the parent static array, it has to be moved to entry index first
+            u64 index;                      // Entry index, first entry of Entries and Page rows or field index
+            u64 count;                      // Number of entries in Entries and Page rows
+        };
+
+        constexpr static u32 NoParent = std::numeric_limits<u32>::max();
+        constexpr static u64 NoLine = std::numeric_limits<u64>::max();
+        constexpr static u64 PageSize = 0x100;
+
+        void buildRows();
+        void addPatternRows(lang::PatternData *pattern, u32 parent, u32 depth, u64 id, bool isEntry, u64 index);
+        void addEntryRows(lang::PatternDataStaticArray *array, u32 parent, u32 depth, u64 id, u64 firstEntry, u64 entryCount);
+
+        void selectPatternAt(u64 address);
+        void openEntryPages(lang::PatternDataStaticArray *array, u64 id, u64 entry);
+        void updateSelectedLine();
+
+        void prepareRow(u32 row);
+        void drawLine(prv::Provider *provider, u32 row, u64 line);
+        void drawPatternRow(prv::Provider *provider, lang::PatternData *pattern, const Row &row, u64 line, std::optional<u64> entry);
+        void drawFieldRow(prv::Provider *provider, const Row &row);
+        void drawPageRow(const Row &row);
+        bool drawTreeNode(const char *label, u64 id, bool selected);
 
         std::vector<lang::PatternData*> &m_patternData;
+        lang::PatternIndex &m_patternIndex;
         std::vector<lang::PatternData*> m_sortedPatternData;
+
+        std::vector<Row> m_rows;
+        std::vector<u64> m_rowLines;        // First line of every row
+        u64 m_lineCount = 0;
+        std::unordered_set<u64> m_openRows;
+        bool m_rowsDirty = true;
+
+        // The row of the innermost pattern at the byte selected in the hex editor. Plain static array entries share the row
+        // of their array, they're told apart by their entry index. Its line only changes when the rows get rebuilt
+        std::optional<u64> m_selectedId;
+        std::optional<u64> m_selectedEntry;
+        u64 m_selectedLine = NoLine;
+        u64 m_selectedAddress = -1;
+        bool m_scrollToSelection = false;
+
+        TaskHandle m_exportTask;
     };
 
-}
\ No newline at end of file
+}
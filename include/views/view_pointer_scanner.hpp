@@ -0,0 +1,50 @@
+#pragma once
+
+#include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+
+#include "helpers/pointer_scanner.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace hex {
+
+    class ViewPointerScanner : public View {
+    public:
+        explicit ViewPointerScanner();
+        ~ViewPointerScanner() override;
+
+        void drawContent() override;
+        void drawMenu() override;
+
+    private:
+        u64 m_region[2] = { 0 };
+        bool m_shouldMatchSelection = false;
+        int m_selectedWidth = 0, m_selectedEndian = 0, m_selectedAlignment = 2;
+        u64 m_target[2] = { 0 };
+
+        TaskHandle m_scanTask;
+        std::shared_ptr<PointerScanResult> m_result;
+        u64 m_scannedBaseAddress = 0;
+        u8 m_scannedWidth = 4;
+        bool m_outdated = false;
+        std::string m_error;
+
+        // Only pointers whose target lies in the selection, as indices into the results
+        bool m_onlyIntoSelection = false;
+        Region m_selection = { 0, 0 };
+        std::vector<size_t> m_filtered;
+
+        void scan();
+        void updateFilter();
+        void resetTargetRange();
+        [[nodiscard]] bool isScanning() const;
+
+        // Offset of the data a pointer points to, if it's inside the data at all
+        [[nodiscard]] std::optional<u64> getTargetOffset(const FoundPointer &pointer) const;
+    };
+
+}
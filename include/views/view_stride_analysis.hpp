@@ -0,0 +1,40 @@
+#pragma once
+
+#include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+
+#include "helpers/stride_analysis.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hex {
+
+    class ViewStrideAnalysis : public View {
+    public:
+        explicit ViewStrideAnalysis();
+        ~ViewStrideAnalysis() override;
+
+        void drawContent() override;
+        void drawMenu() override;
+
+    private:
+        u64 m_region[2] = { 0 };
+        bool m_shouldMatchSelection = true;
+        u64 m_maxStride = 0x400;
+
+        TaskHandle m_analysisTask;
+        std::shared_ptr<StrideAnalysis> m_analysis;
+        std::vector<float> m_plot;
+        u64 m_analyzedAddress = 0, m_analyzedSize = 0;
+        std::string m_error;
+
+        void analyze();
+        [[nodiscard]] bool isAnalyzing() const;
+
+        // Appends a struct with one field per 4 bytes of the stride, or a byte array if it isn't a multiple of 4, and an array of them covering the analyzed region
+        void createPatternSkeleton(u64 stride) const;
+    };
+
+}
@@ -1,20 +1,58 @@
 #pragma once
 
 #include <hex/views/view.hpp>
+#include <hex/api/task.hpp>
+#include <hex/helpers/memory_budget.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include "helpers/persistent_analysis_cache.hpp"
+#include "helpers/printable_scanner.hpp"
+#include "helpers/result_table.hpp"
 
 #include <cstdio>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace hex {
 
     namespace prv { class Provider; }
 
     struct FoundString {
-        std::string string;
         u64 offset;
         size_t size;
     };
 
+    /*
+     * Demangled names of all strings that are mangled symbols, sorted by the offset of their string.
+     * The names are stored back to back in a single buffer, strings that aren't symbols don't take up any space.
+     */
+    class DemangledNames {
+    public:
+        void add(u64 offset, std::string_view name);
+        void append(const DemangledNames &other);
+        void sort();
+
+        [[nodiscard]] std::optional<std::string_view> find(u64 offset) const;
+        [[nodiscard]] size_t size() const { return this->m_entries.size(); }
+        [[nodiscard]] size_t getMemoryUsage() const { return this->m_entries.size() * sizeof(Entry) + this->m_names.size(); }
+
+        // Copies all names whose string starts outside of [start, end)
+        [[nodiscard]] DemangledNames copyOutside(u64 start, u64 end) const;
+
+    private:
+        struct Entry {
+            u64 offset;
+            u32 nameOffset;
+            u32 nameSize;
+        };
+
+        std::vector<Entry> m_entries;
+        std::string m_names;
+    };
+
     class ViewStrings : public View {
     public:
         explicit ViewStrings();
@@ -24,15 +62,66 @@ namespace hex {
         void drawMenu() override;
 
     private:
+        constexpr static size_t ChunkSize = 0x40'0000;
+        constexpr static size_t FilterChunkSize = 0x4'0000;
+        constexpr static size_t DemangleChunkSize = 0x1'0000;
+
         bool m_shouldInvalidate = false;
+        bool m_sortRequired = false;
+        bool m_extracted = false;
+        std::vector<TaskHandle> m_extractionTasks;
+        size_t m_finishedExtractionTasks = 0;
+        std::vector<Region> m_pendingUpdates;
 
         std::vector<FoundString> m_foundStrings;
+        std::vector<FoundString> m_filteredStrings;
+        std::vector<TaskHandle> m_filterTasks;
+        size_t m_finishedFilterTasks = 0;
+        bool m_filteredSortRequired = false;
+        std::string m_currentFilter;
         int m_minimumLength = 5;
+        StringEncoding m_encoding = StringEncoding::ASCII;
+        StringEncoding m_foundStringsEncoding = StringEncoding::ASCII;
+        u32 m_foundStringsMinimumLength = 1;
         char *m_filter;
 
+        // Demangling runs in the background once all strings were extracted, the filter only matches the names after it's done
+        bool m_demangle = false;
+        std::shared_ptr<const DemangledNames> m_demangledNames;
+        DemangledNames m_pendingDemangledNames;
+        std::vector<TaskHandle> m_demangleTasks;
+        size_t m_finishedDemangleTasks = 0;
+
+        MemoryBudget::Registration m_stringsMemory;
+
+        // Results kept in the analysis cache while a different provider is selected
+        struct CachedStrings {
+            std::vector<FoundString> strings;
+            StringEncoding encoding;
+            u32 minimumLength;
+            std::shared_ptr<const DemangledNames> demangledNames;
+        };
+
+        // Fingerprint of the data a running extraction reads, its results only go to disk if the data is still the same once it's done
+        std::optional<PersistentAnalysisCache::Fingerprint> m_extractionFingerprint;
+
         std::string m_selectedString;
         std::string m_demangledName;
 
+        void extractStrings();
+        bool loadStrings(prv::Provider *provider);
+        void storeStrings(const PersistentAnalysisCache::Fingerprint &fingerprint) const;
+        // The strings currently shown, labeled with their demangled names if there are any
+        [[nodiscard]] ResultTable getResultTable() const;
+        void updateStrings(const Region &region);
+        void updateFilter();
+        void filterStrings(const std::vector<FoundString> &strings);
+        void cancelFiltering();
+        void demangleStrings();
+        void cancelDemangling();
+        void updateDemangledNames(u64 start, u64 end, const std::vector<FoundString> &strings);
+        void sortStrings(ImGuiTableSortSpecs *sortSpecs, std::vector<FoundString> &strings) const;
+        std::string readString(const FoundString &foundString) const;
         void createStringContextMenu(const FoundString &foundString);
     };
 
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/views/view.hpp>
+
+namespace hex {
+
+    class ViewTasks : public View {
+    public:
+        ViewTasks();
+        ~ViewTasks() override = default;
+
+        void drawContent() override;
+        void drawMenu() override;
+        bool isAvailable() override { return true; }
+    };
+
+}
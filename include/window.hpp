@@ -2,12 +2,16 @@
 
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <hex/helpers/utils.hpp>
 #include <hex/views/view.hpp>
 
+#include "helpers/persistent_analysis_cache.hpp"
+
 struct GLFWwindow;
 struct ImGuiSettingsHandler;
 
@@ -30,10 +34,13 @@ namespace hex {
         void initPlugins();
         void deinitPlugins();
     private:
+        // Sleeps until there's something to draw and keeps frames from being drawn faster than the frame rate limit
+        void waitForFrame();
         void frameBegin();
         void frameEnd();
 
         void drawWelcomeScreen();
+        void drawProfiler();
 
         void initGLFW();
         void initImGui();
@@ -44,11 +51,20 @@ namespace hex {
 
         float m_globalScale = 1.0f, m_fontScale = 1.0f;
         bool m_fpsVisible = false;
+        bool m_profilerVisible = false;
         bool m_demoWindowOpen = false;
 
+        bool m_redrawOnDemand = true;
+        u32 m_frameRateLimit = 60;
+        u32 m_remainingFrames = 0;
+        double m_lastFrameTime = 0;
+
         static inline std::tuple<int, int> s_currShortcut = { -1, -1 };
 
         std::list<std::string> m_recentFiles;
+
+        // Font atlas that was rasterized because it wasn't cached yet
+        std::optional<std::tuple<PersistentAnalysisCache::Fingerprint, std::string, PersistentAnalysisCache::Writer>> m_unstoredFontAtlas;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <cstddef>
+
+namespace hex {
+
+    enum class BufferOperation : u8 {
+        And,
+        Or,
+        Xor,
+        Add,
+        Subtract
+    };
+
+    /*
+     * Bulk operations on byte buffers used by the data processor. Data is processed as little endian elements that are 1, 2, 4 or 8 bytes wide,
+     * trailing bytes that don't form a whole element are left unchanged. The kernels use the best vector extension the CPU supports at runtime.
+     */
+
+    // Combines every element of data with the matching element of the operand, which gets repeated if it's shorter than data.
+    // Bitwise operations always work on single bytes. Operands shorter than one element leave data unchanged.
+    // The operand offset is where in the repeated operand the first element of data lines up, used when data is a chunk of a longer stream
+    void applyBufferOperation(BufferOperation operation, u8 *data, size_t size, const u8 *operand, size_t operandSize, u8 elementSize = 1, u64 operandOffset = 0);
+
+    void swapBufferBytes(u8 *data, size_t size, u8 elementSize);
+
+    // Rotates the bits of every element, positive amounts rotate towards the most significant bit
+    void rotateBufferBits(u8 *data, size_t size, u8 elementSize, s64 amount);
+
+}
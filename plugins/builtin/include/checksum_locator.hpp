@@ -0,0 +1,42 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <span>
+#include <vector>
+
+namespace hex {
+
+    class Task;
+    namespace prv { class Snapshot; }
+
+    enum class Checksum : u8 { Adler32, CRC32, CRC32C };
+
+    struct ChecksumMatch {
+        Checksum checksum;
+        u64 address, size;
+        u32 value;
+        u64 storedAt;
+        bool bigEndian;
+    };
+
+    struct ChecksumLocatorResult {
+        std::vector<ChecksumMatch> matches;
+        bool truncated = false;
+        bool readFailed = false;
+    };
+
+    /*
+     * Looks for blocks whose checksum is stored somewhere in the data. Every window of the given sizes starting at a multiple of alignment
+     * inside the region gets checked, the checksums are rolled from one offset to the next so each window only costs a few operations no
+     * matter its size. CRCs are rolled by adding the next byte and cancelling the first one's contribution through a table of what every byte
+     * turns into after passing through the whole window. Stored values are the 4 byte aligned 32 bit values of the entire data in both
+     * endiannesses, kept in a hash set so every checksum is looked up in constant time. 0 and 0xFFFFFFFF aren't considered stored values.
+     * Sizes are split into slices that get checked on all cores. Anything found up until then is returned if the task got cancelled.
+     */
+    [[nodiscard]] ChecksumLocatorResult locateChecksums(const prv::Snapshot &snapshot, u64 address, u64 size, std::span<const u64> windowSizes,
+                                                        u64 alignment, std::span<const Checksum> checksums, Task &task);
+
+    [[nodiscard]] const char* getChecksumName(Checksum checksum);
+
+}
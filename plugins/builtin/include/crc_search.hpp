@@ -0,0 +1,67 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <array>
+#include <span>
+#include <vector>
+
+namespace hex {
+
+    class Task;
+
+    // CRC parameters in the Rocksoft model, the polynomial and init value are in their normal, unreflected form
+    struct CrcParameters {
+        u8 width;
+        u32 polynomial, init, xorOut;
+        bool reflectIn, reflectOut;
+    };
+
+    /*
+     * Table driven CRC of any width up to 32 bits, processing eight bytes per step. Reflected CRCs keep their register in the low bits,
+     * shifting towards the least significant bit. Normal ones keep it in the high bits, so both only ever need to look at whole bytes.
+     * Registers passed in and out are in that internal representation, starting from a zero register makes the result linear in the data.
+     */
+    class CrcEngine {
+    public:
+        // Linear map on registers over GF(2), stored as the images of every single bit
+        using Operator = std::array<u32, 32>;
+
+        CrcEngine(u8 width, u32 polynomial, bool reflected);
+
+        [[nodiscard]] u32 process(u32 crc, const u8 *data, size_t size) const;
+
+        [[nodiscard]] u32 step(u32 crc, u8 byte) const {
+            return this->m_reflected ? (crc >> 8) ^ this->m_tables[0][(crc ^ byte) & 0xFF] : (crc << 8) ^ this->m_tables[0][(crc >> 24) ^ byte];
+        }
+
+        // Converts between a value in its normal form and the register representation
+        [[nodiscard]] u32 toRegister(u32 value) const;
+        [[nodiscard]] u32 fromRegister(u32 crc, bool reflectOut) const;
+
+        // Moves a register over count zero bytes, built by squaring the operator for a single zero byte
+        [[nodiscard]] Operator getZeroBytesOperator(u64 count) const;
+        [[nodiscard]] static u32 apply(const Operator &op, u32 crc);
+
+    private:
+        u8 m_width;
+        bool m_reflected;
+        std::array<std::array<u32, 256>, 8> m_tables;
+    };
+
+    // Polynomials of well known 8, 16 and 32 bit CRCs in their normal form
+    [[nodiscard]] std::span<const u32> getCommonCrcPolynomials(u8 width);
+
+    [[nodiscard]] u32 calculateCrc(const CrcParameters &parameters, std::span<const u8> data);
+
+    /*
+     * Finds all combinations of the given polynomials, init and xor out values and input and output reflection whose CRC of data is target.
+     * A CRC's register is linear in the init value, so the data only gets processed once per polynomial and input reflection with an
+     * init value of zero. The effect of every init value is then added by applying the matrix that moves a register over as many zero bytes
+     * as there is data, which takes no longer than a few dozen operations no matter how much data there is.
+     * Polynomials are distributed over all cores. Returns what was found so far if the task got cancelled.
+     */
+    [[nodiscard]] std::vector<CrcParameters> searchCrcParameters(std::span<const u8> data, u32 target, u8 width, std::span<const u32> polynomials,
+                                                                 std::span<const u32> initValues, std::span<const u32> xorOutValues, Task &task);
+
+}
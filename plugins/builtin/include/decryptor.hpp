@@ -0,0 +1,64 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <array>
+#include <span>
+
+#include <mbedtls/aes.h>
+
+namespace hex {
+
+    enum class CipherMode : u8 { AES_ECB, AES_CBC, AES_CTR, ChaCha20 };
+
+    /*
+     * Decrypts data in chunks of arbitrary size, keeping the chaining block of CBC, the counters of CTR and ChaCha20 and unused keystream
+     * between calls so a stream can be decrypted piece by piece. ECB and CBC only decrypt whole blocks, trailing partial blocks are dropped.
+     * Blocks don't depend on each other when decrypting in any of the modes, so large chunks get split into slices decrypted on the task manager's workers.
+     * AES uses AES-NI or the ARMv8 crypto extensions where available and mbedtls otherwise.
+     */
+    class Decryptor {
+    public:
+        Decryptor();
+        ~Decryptor();
+
+        Decryptor(const Decryptor&) = delete;
+        Decryptor& operator=(const Decryptor&) = delete;
+
+        // AES takes 128, 192 or 256 bit keys and a 128 bit IV, except for ECB which doesn't use one. ChaCha20 takes a 256 bit key and either
+        // a 96 bit nonce with the block counter starting at 0, or a 128 bit IV made of the initial counter in little endian followed by the nonce.
+        // Returns a message describing what's wrong with the key or IV, nullptr if they're fine
+        [[nodiscard]] const char* init(CipherMode mode, std::span<const u8> key, std::span<const u8> iv);
+
+        // Output needs room for size bytes and must not overlap the input. Returns the number of bytes written to it
+        size_t decrypt(const u8 *input, u8 *output, size_t size);
+
+    private:
+        enum class Backend : u8 { MbedTLS, AESNI, ARMv8 };
+
+        void cryptBlocks(bool decrypt, const u8 *input, u8 *output, size_t count) const;
+        void generateKeystream(u64 firstBlock, u8 *output, size_t count) const;
+        void advanceCounter(u64 blocks);
+        [[nodiscard]] size_t getKeystreamBlockSize() const { return this->m_mode == CipherMode::ChaCha20 ? 64 : 16; }
+
+        CipherMode m_mode = CipherMode::AES_CBC;
+        Backend m_backend = Backend::MbedTLS;
+
+        // Round keys for encryption and the equivalent inverse cipher, only filled in for the hardware backends
+        std::array<u8, 15 * 16> m_roundKeys = { 0 };
+        std::array<u8, 15 * 16> m_inverseRoundKeys = { 0 };
+        u8 m_rounds = 0;
+
+        mbedtls_aes_context m_encryptContext, m_decryptContext;
+
+        // CBC's previous ciphertext block or CTR's next counter block
+        std::array<u8, 16> m_iv = { 0 };
+
+        // Input state of ChaCha20's block function, word 12 is the next block counter
+        std::array<u32, 16> m_chachaState = { 0 };
+
+        std::array<u8, 64> m_keystream = { 0 };
+        size_t m_keystreamPosition = 0;
+    };
+
+}
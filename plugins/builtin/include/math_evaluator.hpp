@@ -59,30 +59,71 @@ namespace hex {
         Operator op;
         BracketType bracketType;
         std::string name;
-        std::vector<long double> arguments;
+        std::vector<std::string> arguments;     // Expressions of the function's arguments, they get compiled along with the call
     };
 
     class MathEvaluator {
     public:
+        using Function = std::function<std::optional<long double>(std::vector<long double>)>;
+
+        /*
+         * Postfix program of an expression, so it can be evaluated any number of times without parsing it again.
+         * Functions are resolved when compiling, variables when evaluating. A program can only be evaluated
+         * by the evaluator that compiled it, as long as none of the functions it calls get removed.
+         */
+        class Program {
+        public:
+            // Variable the result is assigned to when evaluating the input directly, "ans" if the input isn't an assignment
+            [[nodiscard]] const std::string& getResultVariable() const { return this->m_resultVariable; }
+
+        private:
+            friend class MathEvaluator;
+
+            enum class InstructionType : u8 { Push, Load, Call, Operator };
+
+            struct Instruction {
+                InstructionType type;
+                Operator op = Operator::Invalid;
+                u32 index = 0;                  // Variable for Load, function for Call
+                u32 argumentCount = 0;
+                long double value = 0;
+            };
+
+            std::vector<Instruction> m_instructions;
+            std::vector<std::string> m_variables;
+            std::vector<const Function*> m_functions;
+            std::string m_resultVariable = "ans";
+            size_t m_maxStackSize = 0;
+        };
+
         MathEvaluator() = default;
 
         std::optional<long double> evaluate(std::string input);
 
+        Program compile(const std::string &input);
+        std::optional<long double> evaluate(const Program &program);
+
+        // Evaluates the program once for every value of the variable. The variable itself doesn't have to exist and stays unchanged
+        std::vector<std::optional<long double>> evaluate(const Program &program, const std::string &variable, const std::vector<long double> &values);
+
         void registerStandardVariables();
         void registerStandardFunctions();
 
         void setVariable(std::string name, long double value);
-        void setFunction(std::string name, std::function<std::optional<long double>(std::vector<long double>)> function, size_t minNumArgs, size_t maxNumArgs);
+        void setFunction(std::string name, Function function, size_t minNumArgs, size_t maxNumArgs);
 
         std::unordered_map<std::string, long double>& getVariables() { return this->m_variables; }
 
     private:
         std::queue<Token> parseInput(const char *input);
         std::queue<Token> toPostfix(std::queue<Token> inputQueue);
-        std::optional<long double> evaluate(std::queue<Token> postfixTokens);
+        size_t compile(std::queue<Token> postfixTokens, Program &program, size_t stackBase);
+
+        std::vector<long double> getVariableValues(const Program &program, const std::string &ignoredVariable = "");
+        std::optional<long double> run(const Program &program, const std::vector<long double> &variables, std::vector<long double> &stack);
 
         std::unordered_map<std::string, long double> m_variables;
-        std::unordered_map<std::string, std::function<std::optional<long double>(std::vector<long double>)>> m_functions;
+        std::unordered_map<std::string, Function> m_functions;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <span>
+#include <vector>
+
+namespace hex {
+
+    class Task;
+
+    struct XorKeyCandidate {
+        std::vector<u8> key;
+
+        // 0x00 for binaries, where confidence is the average share of bytes that decrypt to 0x00,
+        // or a space for text, where it's the share of bytes that decrypt to printable characters
+        u8 assumedPlaintext;
+        double confidence;
+    };
+
+    struct XorKeyAnalysis {
+        // Share of bytes equal to the one the given number of bytes further, starting at a shift of 1
+        std::vector<double> coincidence;
+
+        size_t keyLength = 0;
+        std::vector<XorKeyCandidate> keys;
+    };
+
+    struct XorPlaintextMatch {
+        u64 address;
+
+        // Key that turns the data at the address into the plaintext, starting with the byte applied to the first plaintext byte
+        std::vector<u8> key;
+    };
+
+    struct XorPlaintextResult {
+        std::vector<XorPlaintextMatch> matches;
+        bool truncated = false;
+    };
+
+    /*
+     * Recovers the key of data obfuscated with a repeating XOR key. The key length is estimated through autocorrelation, bytes one key length
+     * apart are XORed with the same key byte, so they're equal exactly as often as the plaintext's bytes are. That happens far more often
+     * than in random data, and at multiples of the key length as well, so the shortest shift almost as correlated as the best one wins.
+     * A key length other than 0 skips the estimation. Every key byte then is the most common byte at its position XORed with the byte
+     * the plaintext most likely consists of, for binaries that's 0x00, while for text the key byte turning the most bytes into text is picked.
+     * One key is returned for each of the two assumptions, shortened if it's a shorter key repeated. Shifts are spread over all cores.
+     */
+    [[nodiscard]] XorKeyAnalysis analyzeXorKey(std::span<const u8> data, size_t maxKeyLength, size_t keyLength, Task &task);
+
+    /*
+     * Finds every place where data XORed with a repeating key of up to maxKeyLength bytes results in the plaintext. The key drops out when
+     * XORing the data with itself shifted by the key length, so instead of trying keys the XOR of every byte with the one a key length
+     * before is compared to the plaintext's, leaving the key to be read off the matches. Keys that repeat a shorter one are only reported
+     * with their shortest length, and plaintexts appearing as they are aren't reported at all. Key lengths need to be shorter than the
+     * plaintext by at least two bytes. Data is split into slices searched on all cores.
+     */
+    [[nodiscard]] XorPlaintextResult findXorPlaintext(std::span<const u8> data, u64 address, std::span<const u8> plaintext, size_t maxKeyLength, Task &task);
+
+}
@@ -0,0 +1,367 @@
+#include "buffer_operations.hpp"
+
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+    #define BUFFER_OPERATIONS_X86
+    #include <immintrin.h>
+#elif defined(__aarch64__)
+    #define BUFFER_OPERATIONS_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace hex {
+
+    // Largest vector any of the kernels loads at once
+    constexpr static size_t MaxVectorSize = 32;
+
+    template<u8 Size> struct Element;
+    template<> struct Element<1> { using Type = u8;  };
+    template<> struct Element<2> { using Type = u16; };
+    template<> struct Element<4> { using Type = u32; };
+    template<> struct Element<8> { using Type = u64; };
+
+    template<u8 Size>
+    static typename Element<Size>::Type loadElement(const u8 *data) {
+        typename Element<Size>::Type value;
+        std::memcpy(&value, data, Size);
+
+        return value;
+    }
+
+    template<u8 Size>
+    static void storeElement(u8 *data, typename Element<Size>::Type value) {
+        std::memcpy(data, &value, Size);
+    }
+
+    template<BufferOperation Operation, typename T>
+    static T combineScalar(T a, T b) {
+        if constexpr (Operation == BufferOperation::And)
+            return a & b;
+        else if constexpr (Operation == BufferOperation::Or)
+            return a | b;
+        else if constexpr (Operation == BufferOperation::Xor)
+            return a ^ b;
+        else if constexpr (Operation == BufferOperation::Add)
+            return a + b;
+        else
+            return a - b;
+    }
+
+    /*
+     * The kernels process size bytes, rounded down to whole vectors, and return how many bytes they processed.
+     * The operand is read starting at position, wrapping around at the period. It has to hold at least one more vector past the period.
+     */
+
+    #if defined(BUFFER_OPERATIONS_X86)
+
+    static bool hasAVX2() {
+        #if defined(__GNUC__)
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+        #else
+            return false;
+        #endif
+    }
+
+    template<BufferOperation Operation, u8 ElementSize>
+    static __m128i combineSSE2(__m128i a, __m128i b) {
+        if constexpr (Operation == BufferOperation::And)
+            return _mm_and_si128(a, b);
+        else if constexpr (Operation == BufferOperation::Or)
+            return _mm_or_si128(a, b);
+        else if constexpr (Operation == BufferOperation::Xor)
+            return _mm_xor_si128(a, b);
+        else if constexpr (Operation == BufferOperation::Add) {
+            if constexpr (ElementSize == 1)      return _mm_add_epi8(a, b);
+            else if constexpr (ElementSize == 2) return _mm_add_epi16(a, b);
+            else if constexpr (ElementSize == 4) return _mm_add_epi32(a, b);
+            else                                 return _mm_add_epi64(a, b);
+        } else {
+            if constexpr (ElementSize == 1)      return _mm_sub_epi8(a, b);
+            else if constexpr (ElementSize == 2) return _mm_sub_epi16(a, b);
+            else if constexpr (ElementSize == 4) return _mm_sub_epi32(a, b);
+            else                                 return _mm_sub_epi64(a, b);
+        }
+    }
+
+    template<BufferOperation Operation, u8 ElementSize>
+    static size_t combineKernelSSE2(u8 *data, size_t size, const u8 *operand, size_t period, size_t position) {
+        size_t offset = 0;
+
+        for (; offset + sizeof(__m128i) <= size; offset += sizeof(__m128i)) {
+            auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+            auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(operand + position));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + offset), combineSSE2<Operation, ElementSize>(a, b));
+
+            position += sizeof(__m128i);
+            if (position >= period)
+                position %= period;
+        }
+
+        return offset;
+    }
+
+    template<BufferOperation Operation, u8 ElementSize>
+    __attribute__((target("avx2"))) static __m256i combineAVX2(__m256i a, __m256i b) {
+        if constexpr (Operation == BufferOperation::And)
+            return _mm256_and_si256(a, b);
+        else if constexpr (Operation == BufferOperation::Or)
+            return _mm256_or_si256(a, b);
+        else if constexpr (Operation == BufferOperation::Xor)
+            return _mm256_xor_si256(a, b);
+        else if constexpr (Operation == BufferOperation::Add) {
+            if constexpr (ElementSize == 1)      return _mm256_add_epi8(a, b);
+            else if constexpr (ElementSize == 2) return _mm256_add_epi16(a, b);
+            else if constexpr (ElementSize == 4) return _mm256_add_epi32(a, b);
+            else                                 return _mm256_add_epi64(a, b);
+        } else {
+            if constexpr (ElementSize == 1)      return _mm256_sub_epi8(a, b);
+            else if constexpr (ElementSize == 2) return _mm256_sub_epi16(a, b);
+            else if constexpr (ElementSize == 4) return _mm256_sub_epi32(a, b);
+            else                                 return _mm256_sub_epi64(a, b);
+        }
+    }
+
+    template<BufferOperation Operation, u8 ElementSize>
+    __attribute__((target("avx2"))) static size_t combineKernelAVX2(u8 *data, size_t size, const u8 *operand, size_t period, size_t position) {
+        size_t offset = 0;
+
+        for (; offset + sizeof(__m256i) <= size; offset += sizeof(__m256i)) {
+            auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+            auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(operand + position));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + offset), combineAVX2<Operation, ElementSize>(a, b));
+
+            position += sizeof(__m256i);
+            if (position >= period)
+                position %= period;
+        }
+
+        return offset;
+    }
+
+    // There are no 8 bit shifts, the bits shifted over from the neighbouring byte get masked off instead
+    template<u8 ElementSize>
+    static size_t rotateKernelSSE2(u8 *data, size_t size, u32 amount) {
+        constexpr u32 Bits = ElementSize * 8;
+        size_t offset = 0;
+
+        const auto leftCount  = _mm_cvtsi32_si128(amount);
+        const auto rightCount = _mm_cvtsi32_si128(Bits - amount);
+        const auto leftMask   = _mm_set1_epi8(char(u8(0xFF << (amount % 8))));
+        const auto rightMask  = _mm_set1_epi8(char(u8(0xFF >> (8 - amount % 8))));
+
+        for (; offset + sizeof(__m128i) <= size; offset += sizeof(__m128i)) {
+            auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+
+            if constexpr (ElementSize == 1)
+                value = _mm_or_si128(_mm_and_si128(_mm_sll_epi16(value, leftCount), leftMask), _mm_and_si128(_mm_srl_epi16(value, rightCount), rightMask));
+            else if constexpr (ElementSize == 2)
+                value = _mm_or_si128(_mm_sll_epi16(value, leftCount), _mm_srl_epi16(value, rightCount));
+            else if constexpr (ElementSize == 4)
+                value = _mm_or_si128(_mm_sll_epi32(value, leftCount), _mm_srl_epi32(value, rightCount));
+            else
+                value = _mm_or_si128(_mm_sll_epi64(value, leftCount), _mm_srl_epi64(value, rightCount));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + offset), value);
+        }
+
+        return offset;
+    }
+
+    template<u8 ElementSize>
+    __attribute__((target("avx2"))) static size_t rotateKernelAVX2(u8 *data, size_t size, u32 amount) {
+        constexpr u32 Bits = ElementSize * 8;
+        size_t offset = 0;
+
+        const auto leftCount  = _mm_cvtsi32_si128(amount);
+        const auto rightCount = _mm_cvtsi32_si128(Bits - amount);
+        const auto leftMask   = _mm256_set1_epi8(char(u8(0xFF << (amount % 8))));
+        const auto rightMask  = _mm256_set1_epi8(char(u8(0xFF >> (8 - amount % 8))));
+
+        for (; offset + sizeof(__m256i) <= size; offset += sizeof(__m256i)) {
+            auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+
+            if constexpr (ElementSize == 1)
+                value = _mm256_or_si256(_mm256_and_si256(_mm256_sll_epi16(value, leftCount), leftMask), _mm256_and_si256(_mm256_srl_epi16(value, rightCount), rightMask));
+            else if constexpr (ElementSize == 2)
+                value = _mm256_or_si256(_mm256_sll_epi16(value, leftCount), _mm256_srl_epi16(value, rightCount));
+            else if constexpr (ElementSize == 4)
+                value = _mm256_or_si256(_mm256_sll_epi32(value, leftCount), _mm256_srl_epi32(value, rightCount));
+            else
+                value = _mm256_or_si256(_mm256_sll_epi64(value, leftCount), _mm256_srl_epi64(value, rightCount));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + offset), value);
+        }
+
+        return offset;
+    }
+
+    #elif defined(BUFFER_OPERATIONS_NEON)
+
+    template<BufferOperation Operation, u8 ElementSize>
+    static uint8x16_t combineNEON(uint8x16_t a, uint8x16_t b) {
+        if constexpr (Operation == BufferOperation::And)
+            return vandq_u8(a, b);
+        else if constexpr (Operation == BufferOperation::Or)
+            return vorrq_u8(a, b);
+        else if constexpr (Operation == BufferOperation::Xor)
+            return veorq_u8(a, b);
+        else if constexpr (Operation == BufferOperation::Add) {
+            if constexpr (ElementSize == 1)      return vaddq_u8(a, b);
+            else if constexpr (ElementSize == 2) return vreinterpretq_u8_u16(vaddq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+            else if constexpr (ElementSize == 4) return vreinterpretq_u8_u32(vaddq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+            else                                 return vreinterpretq_u8_u64(vaddq_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)));
+        } else {
+            if constexpr (ElementSize == 1)      return vsubq_u8(a, b);
+            else if constexpr (ElementSize == 2) return vreinterpretq_u8_u16(vsubq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+            else if constexpr (ElementSize == 4) return vreinterpretq_u8_u32(vsubq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+            else                                 return vreinterpretq_u8_u64(vsubq_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)));
+        }
+    }
+
+    template<BufferOperation Operation, u8 ElementSize>
+    static size_t combineKernelNEON(u8 *data, size_t size, const u8 *operand, size_t period, size_t position) {
+        size_t offset = 0;
+
+        for (; offset + sizeof(uint8x16_t) <= size; offset += sizeof(uint8x16_t)) {
+            vst1q_u8(data + offset, combineNEON<Operation, ElementSize>(vld1q_u8(data + offset), vld1q_u8(operand + position)));
+
+            position += sizeof(uint8x16_t);
+            if (position >= period)
+                position %= period;
+        }
+
+        return offset;
+    }
+
+    // Shifting by a negative amount shifts to the right
+    template<u8 ElementSize>
+    static size_t rotateKernelNEON(u8 *data, size_t size, u32 amount) {
+        constexpr s32 Bits = ElementSize * 8;
+        size_t offset = 0;
+
+        for (; offset + sizeof(uint8x16_t) <= size; offset += sizeof(uint8x16_t)) {
+            auto value = vld1q_u8(data + offset);
+
+            if constexpr (ElementSize == 1) {
+                value = vorrq_u8(vshlq_u8(value, vdupq_n_s8(amount)), vshlq_u8(value, vdupq_n_s8(s32(amount) - Bits)));
+            } else if constexpr (ElementSize == 2) {
+                auto elements = vreinterpretq_u16_u8(value);
+                value = vreinterpretq_u8_u16(vorrq_u16(vshlq_u16(elements, vdupq_n_s16(amount)), vshlq_u16(elements, vdupq_n_s16(s32(amount) - Bits))));
+            } else if constexpr (ElementSize == 4) {
+                auto elements = vreinterpretq_u32_u8(value);
+                value = vreinterpretq_u8_u32(vorrq_u32(vshlq_u32(elements, vdupq_n_s32(amount)), vshlq_u32(elements, vdupq_n_s32(s32(amount) - Bits))));
+            } else {
+                auto elements = vreinterpretq_u64_u8(value);
+                value = vreinterpretq_u8_u64(vorrq_u64(vshlq_u64(elements, vdupq_n_s64(amount)), vshlq_u64(elements, vdupq_n_s64(s64(amount) - Bits))));
+            }
+
+            vst1q_u8(data + offset, value);
+        }
+
+        return offset;
+    }
+
+    #endif
+
+    template<BufferOperation Operation, u8 ElementSize>
+    static void combineElements(u8 *data, size_t size, const u8 *operand, size_t operandSize, u64 operandOffset) {
+        const size_t period = operandSize - operandSize % ElementSize;
+        size = size - size % ElementSize;
+
+        if (period == 0 || size == 0)
+            return;
+
+        const size_t start = (operandOffset % period) - (operandOffset % period) % ElementSize;
+
+        // Operands that wrap around get repeated into a buffer that can be read a whole vector past any offset within the period
+        std::vector<u8> repeatedOperand;
+        if (start + size > period) {
+            repeatedOperand.resize(period + MaxVectorSize);
+            for (size_t i = 0; i < repeatedOperand.size(); i++)
+                repeatedOperand[i] = operand[i % period];
+
+            operand = repeatedOperand.data();
+        }
+
+        size_t offset = 0;
+        #if defined(BUFFER_OPERATIONS_X86)
+            offset = hasAVX2() ? combineKernelAVX2<Operation, ElementSize>(data, size, operand, period, start) : combineKernelSSE2<Operation, ElementSize>(data, size, operand, period, start);
+        #elif defined(BUFFER_OPERATIONS_NEON)
+            offset = combineKernelNEON<Operation, ElementSize>(data, size, operand, period, start);
+        #endif
+
+        for (size_t position = (start + offset) % period; offset < size; offset += ElementSize) {
+            storeElement<ElementSize>(data + offset, combineScalar<Operation>(loadElement<ElementSize>(data + offset), loadElement<ElementSize>(operand + position)));
+
+            position += ElementSize;
+            if (position >= period)
+                position = 0;
+        }
+    }
+
+    template<BufferOperation Operation>
+    static void combineElements(u8 elementSize, u8 *data, size_t size, const u8 *operand, size_t operandSize, u64 operandOffset) {
+        switch (elementSize) {
+            case 1: combineElements<Operation, 1>(data, size, operand, operandSize, operandOffset); break;
+            case 2: combineElements<Operation, 2>(data, size, operand, operandSize, operandOffset); break;
+            case 4: combineElements<Operation, 4>(data, size, operand, operandSize, operandOffset); break;
+            case 8: combineElements<Operation, 8>(data, size, operand, operandSize, operandOffset); break;
+            default: break;
+        }
+    }
+
+    void applyBufferOperation(BufferOperation operation, u8 *data, size_t size, const u8 *operand, size_t operandSize, u8 elementSize, u64 operandOffset) {
+        switch (operation) {
+            case BufferOperation::And:      combineElements<BufferOperation::And, 1>(data, size, operand, operandSize, operandOffset); break;
+            case BufferOperation::Or:       combineElements<BufferOperation::Or, 1>(data, size, operand, operandSize, operandOffset); break;
+            case BufferOperation::Xor:      combineElements<BufferOperation::Xor, 1>(data, size, operand, operandSize, operandOffset); break;
+            case BufferOperation::Add:      combineElements<BufferOperation::Add>(elementSize, data, size, operand, operandSize, operandOffset); break;
+            case BufferOperation::Subtract: combineElements<BufferOperation::Subtract>(elementSize, data, size, operand, operandSize, operandOffset); break;
+        }
+    }
+
+    void swapBufferBytes(u8 *data, size_t size, u8 elementSize) {
+        if (elementSize > 1)
+            hex::swapBytes(data, size / elementSize, elementSize);
+    }
+
+    template<u8 ElementSize>
+    static void rotateBits(u8 *data, size_t size, s64 amount) {
+        constexpr s64 Bits = ElementSize * 8;
+
+        // Right rotations are turned into the equivalent left rotation
+        const u32 leftAmount = ((amount % Bits) + Bits) % Bits;
+        size = size - size % ElementSize;
+
+        if (leftAmount == 0)
+            return;
+
+        size_t offset = 0;
+        #if defined(BUFFER_OPERATIONS_X86)
+            offset = hasAVX2() ? rotateKernelAVX2<ElementSize>(data, size, leftAmount) : rotateKernelSSE2<ElementSize>(data, size, leftAmount);
+        #elif defined(BUFFER_OPERATIONS_NEON)
+            offset = rotateKernelNEON<ElementSize>(data, size, leftAmount);
+        #endif
+
+        for (; offset < size; offset += ElementSize)
+            storeElement<ElementSize>(data + offset, std::rotl(loadElement<ElementSize>(data + offset), leftAmount));
+    }
+
+    void rotateBufferBits(u8 *data, size_t size, u8 elementSize, s64 amount) {
+        switch (elementSize) {
+            case 1: rotateBits<1>(data, size, amount); break;
+            case 2: rotateBits<2>(data, size, amount); break;
+            case 4: rotateBits<4>(data, size, amount); break;
+            case 8: rotateBits<8>(data, size, amount); break;
+            default: break;
+        }
+    }
+
+}
@@ -0,0 +1,387 @@
+#include "checksum_locator.hpp"
+#include "crc_search.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/providers/snapshot.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+namespace hex {
+
+    namespace {
+
+        constexpr u32 AdlerModulo = 65521;
+
+        // Number of bytes that can be summed up before Adler32's b exceeds 32 bits
+        constexpr size_t AdlerBlockSize = 5552;
+
+        constexpr size_t ReadChunkSize = 0x10'0000;
+        constexpr size_t MinSliceSize = 0x10'0000;
+        constexpr size_t MaxMatches = 0x1'0000;
+        constexpr size_t MaxLocationsPerValue = 16;
+
+        /*
+         * Open addressing set of 32 bit values. 0 marks empty slots, which is fine since 0 never gets stored.
+         * Once everything is inserted, finish builds a bitmap with a bit set for the hash of every value. It's small enough to mostly stay
+         * in the cache and rejects most values that aren't stored before they touch the slots, which rarely are in the cache in large sets.
+         * Lookups don't lock, so all values need to be inserted before any thread starts looking them up
+         */
+        class StoredValueSet {
+        public:
+            StoredValueSet() : m_slots(InitialCapacity, 0) { }
+
+            void insert(u32 value) {
+                if (value == 0)
+                    return;
+
+                if ((this->m_count + 1) * 2 > this->m_slots.size())
+                    this->grow();
+
+                for (size_t slot = this->getSlot(value); ; slot = (slot + 1) & (this->m_slots.size() - 1)) {
+                    if (this->m_slots[slot] == value)
+                        return;
+
+                    if (this->m_slots[slot] == 0) {
+                        this->m_slots[slot] = value;
+                        this->m_count++;
+                        return;
+                    }
+                }
+            }
+
+            void finish() {
+                size_t filterBits = 64;
+                while (filterBits < this->m_count * FilterBitsPerValue)
+                    filterBits <<= 1;
+
+                this->m_filter.assign(filterBits / 64, 0);
+                this->m_filterMask = filterBits - 1;
+
+                for (const u32 value : this->m_slots) {
+                    if (value != 0) {
+                        const u64 bit = getHash(value) & this->m_filterMask;
+                        this->m_filter[bit / 64] |= u64(1) << (bit % 64);
+                    }
+                }
+            }
+
+            [[nodiscard]] bool mayContain(u32 value) const {
+                const u64 bit = getHash(value) & this->m_filterMask;
+                return ((this->m_filter[bit / 64] >> (bit % 64)) & 1) != 0;
+            }
+
+            void prefetch(u32 value) const {
+                __builtin_prefetch(&this->m_slots[this->getSlot(value)]);
+            }
+
+            [[nodiscard]] bool contains(u32 value) const {
+                for (size_t slot = this->getSlot(value); ; slot = (slot + 1) & (this->m_slots.size() - 1)) {
+                    if (this->m_slots[slot] == value)
+                        return value != 0;
+
+                    if (this->m_slots[slot] == 0)
+                        return false;
+                }
+            }
+
+        private:
+            constexpr static size_t InitialCapacity = 0x1'0000;
+            constexpr static size_t FilterBitsPerValue = 8;
+
+            // Slots are picked by the high bits of the hash and filter bits by the low ones, so the two don't reject the same values
+            [[nodiscard]] static u64 getHash(u32 value) {
+                return u64(value) * 0x9E37'79B9'7F4A'7C15ULL;
+            }
+
+            [[nodiscard]] size_t getSlot(u32 value) const {
+                return (getHash(value) >> 32) & (this->m_slots.size() - 1);
+            }
+
+            void grow() {
+                auto oldSlots = std::move(this->m_slots);
+                this->m_slots.assign(oldSlots.size() * 2, 0);
+                this->m_count = 0;
+
+                for (const u32 value : oldSlots) {
+                    if (value != 0)
+                        this->insert(value);
+                }
+            }
+
+            std::vector<u32> m_slots;
+            size_t m_count = 0;
+
+            std::vector<u64> m_filter;
+            u64 m_filterMask = 0;
+        };
+
+        u32 calculateAdler32(const u8 *data, size_t size) {
+            u32 a = 1, b = 0;
+
+            while (size > 0) {
+                const size_t blockSize = std::min(size, AdlerBlockSize);
+                for (size_t i = 0; i < blockSize; i++) {
+                    a += data[i];
+                    b += a;
+                }
+
+                a %= AdlerModulo;
+                b %= AdlerModulo;
+                data += blockSize;
+                size -= blockSize;
+            }
+
+            return (b << 16) | a;
+        }
+
+        // Calls callback with the offset and value of every 4 byte aligned 32 bit value in the data, returns false if the data couldn't be read
+        template<typename T>
+        bool forEachStoredValue(const prv::Snapshot &snapshot, Task &task, T callback) {
+            std::vector<u8> buffer(ReadChunkSize);
+
+            const u64 endOffset = snapshot.getSize() & ~u64(3);
+            for (u64 offset = 0; offset < endOffset && !task.isCancelled(); offset += buffer.size()) {
+                const size_t readSize = std::min<u64>(buffer.size(), endOffset - offset);
+                if (!snapshot.read(offset, buffer.data(), readSize))
+                    return false;
+
+                for (size_t i = 0; i < readSize; i += 4) {
+                    u32 value = u32(buffer[i]) | u32(buffer[i + 1]) << 8 | u32(buffer[i + 2]) << 16 | u32(buffer[i + 3]) << 24;
+                    if (value != 0 && value != 0xFFFF'FFFF)
+                        callback(offset + i, value);
+                }
+            }
+
+            return true;
+        }
+
+        struct WindowSlice {
+            Checksum checksum;
+            u64 windowSize;
+            u64 begin, end;
+        };
+
+        /*
+         * Looks up checksums in batches, prefetching the slots of a whole batch that made it past the filter first. Those lookups
+         * mostly miss the cache, this way they wait for memory at the same time instead of one after the other
+         */
+        template<typename T>
+        class BatchedLookup {
+        public:
+            BatchedLookup(const StoredValueSet &storedValues, T &onMatch) : m_storedValues(storedValues), m_onMatch(onMatch) { }
+            ~BatchedLookup() { this->flush(); }
+
+            void push(u64 offset, u32 value) {
+                if (!this->m_storedValues.mayContain(value))
+                    return;
+
+                this->m_storedValues.prefetch(value);
+                this->m_pending[this->m_count++] = { offset, value };
+
+                if (this->m_count == this->m_pending.size())
+                    this->flush();
+            }
+
+            void flush() {
+                for (size_t i = 0; i < this->m_count; i++) {
+                    const auto &[offset, value] = this->m_pending[i];
+                    if (this->m_storedValues.contains(value))
+                        this->m_onMatch(offset, value);
+                }
+
+                this->m_count = 0;
+            }
+
+        private:
+            const StoredValueSet &m_storedValues;
+            T &m_onMatch;
+
+            std::array<std::pair<u64, u32>, 32> m_pending;
+            size_t m_count = 0;
+        };
+
+        // Checks every aligned window starting in the slice, calling onMatch with the start offset and checksum of any whose checksum is stored
+        template<typename T>
+        void checkSlice(const WindowSlice &slice, std::span<const u8> data, u64 address, u64 alignment, const StoredValueSet &storedValues, T onMatch) {
+            const u64 windowSize = slice.windowSize;
+            const u64 firstAligned = slice.begin + (alignment - (address + slice.begin) % alignment) % alignment;
+
+            BatchedLookup lookup(storedValues, onMatch);
+
+            if (slice.checksum == Checksum::Adler32) {
+                if (alignment >= windowSize) {
+                    for (u64 offset = firstAligned; offset < slice.end; offset += alignment)
+                        lookup.push(offset, calculateAdler32(&data[offset], windowSize));
+
+                    return;
+                }
+
+                const u32 windowModulo = windowSize % AdlerModulo;
+                const u32 value = calculateAdler32(&data[slice.begin], windowSize);
+                u32 a = value & 0xFFFF, b = value >> 16;
+
+                for (u64 offset = slice.begin, nextAligned = firstAligned; ; offset++) {
+                    if (offset == nextAligned) {
+                        lookup.push(offset, (b << 16) | a);
+                        nextAligned += alignment;
+                    }
+
+                    if (offset + 1 >= slice.end)
+                        break;
+
+                    // Both sums stay below twice the modulo before every reduction, so subtracting it once is enough
+                    const u8 removed = data[offset], added = data[offset + windowSize];
+                    a += AdlerModulo + added - removed;
+                    a = a >= AdlerModulo ? a - AdlerModulo : a;
+                    a = a >= AdlerModulo ? a - AdlerModulo : a;
+
+                    b += a + AdlerModulo - 1 - (windowModulo * removed) % AdlerModulo;
+                    b = b >= AdlerModulo ? b - AdlerModulo : b;
+                    b = b >= AdlerModulo ? b - AdlerModulo : b;
+                }
+            } else {
+                const CrcEngine engine(32, slice.checksum == Checksum::CRC32C ? 0x1EDC6F41 : 0x04C11DB7, true);
+
+                // Contribution of the all ones init value to a window's register, and of every byte once it passed through an entire window
+                const auto zeroBytes = engine.getZeroBytesOperator(windowSize);
+                const u32 initContribution = CrcEngine::apply(zeroBytes, engine.toRegister(0xFFFF'FFFF));
+
+                // Both CRCs reflect their input and output, so the register already holds the output value up to the final XOR
+                const u32 valueMask = initContribution ^ 0xFFFF'FFFF;
+
+                if (alignment >= windowSize) {
+                    for (u64 offset = firstAligned; offset < slice.end; offset += alignment)
+                        lookup.push(offset, engine.process(0, &data[offset], windowSize) ^ valueMask);
+
+                    return;
+                }
+
+                std::array<u32, 256> removedContribution;
+                for (u32 byte = 0; byte < 256; byte++)
+                    removedContribution[byte] = CrcEngine::apply(zeroBytes, engine.step(0, byte));
+
+                u32 crc = engine.process(0, &data[slice.begin], windowSize);
+                for (u64 offset = slice.begin, nextAligned = firstAligned; ; offset++) {
+                    if (offset == nextAligned) {
+                        lookup.push(offset, crc ^ valueMask);
+                        nextAligned += alignment;
+                    }
+
+                    if (offset + 1 >= slice.end)
+                        break;
+
+                    crc = engine.step(crc, data[offset + windowSize]) ^ removedContribution[data[offset]];
+                }
+            }
+        }
+
+    }
+
+    const char* getChecksumName(Checksum checksum) {
+        switch (checksum) {
+            case Checksum::Adler32: return "Adler32";
+            case Checksum::CRC32:   return "CRC32";
+            case Checksum::CRC32C:  return "CRC32C";
+            default:                return "???";
+        }
+    }
+
+    ChecksumLocatorResult locateChecksums(const prv::Snapshot &snapshot, u64 address, u64 size, std::span<const u64> windowSizes,
+                                          u64 alignment, std::span<const Checksum> checksums, Task &task) {
+        ChecksumLocatorResult result;
+        alignment = std::max<u64>(alignment, 1);
+
+        std::vector<u8> data(size);
+        if (!snapshot.read(address, data.data(), data.size())) {
+            result.readFailed = true;
+            return result;
+        }
+
+        StoredValueSet storedValues;
+        result.readFailed = !forEachStoredValue(snapshot, task, [&](u64, u32 value) {
+            storedValues.insert(value);
+            storedValues.insert(__builtin_bswap32(value));
+        });
+
+        if (result.readFailed || task.isCancelled())
+            return result;
+
+        storedValues.finish();
+
+        std::vector<WindowSlice> slices;
+        for (const auto checksum : checksums) {
+            for (const u64 windowSize : windowSizes) {
+                if (windowSize == 0 || windowSize > size)
+                    continue;
+
+                const u64 offsetCount = size - windowSize + 1;
+                const u64 sliceSize = std::max<u64>(MinSliceSize, windowSize);
+                for (u64 begin = 0; begin < offsetCount; begin += sliceSize)
+                    slices.push_back({ checksum, windowSize, begin, std::min(begin + sliceSize, offsetCount) });
+            }
+        }
+
+        std::mutex matchMutex;
+        std::atomic<size_t> doneSlices = 0;
+        std::atomic<bool> full = false;
+
+        TaskManager::parallelFor<std::vector<ChecksumMatch>>(task, slices.size(), [&](size_t index, std::vector<ChecksumMatch> &matches) {
+            if (full)
+                return;
+
+            const auto &slice = slices[index];
+            checkSlice(slice, data, address, alignment, storedValues, [&](u64 offset, u32 value) {
+                matches.push_back({ slice.checksum, address + offset, slice.windowSize, value, 0, false });
+            });
+
+            std::scoped_lock lock(matchMutex);
+            const size_t count = std::min(matches.size(), MaxMatches - result.matches.size());
+            result.matches.insert(result.matches.end(), matches.begin(), matches.begin() + count);
+            matches.clear();
+
+            task.setProgress(float(++doneSlices) / slices.size());
+
+            if (result.matches.size() >= MaxMatches) {
+                result.truncated = true;
+                full = true;
+            }
+        });
+
+        // Find where the matched checksums are stored, a checksum isn't stored anywhere else if its only occurrences are part of the window itself
+        std::unordered_map<u32, std::vector<std::pair<u64, bool>>> locations;
+        for (const auto &match : result.matches)
+            locations[match.value];
+
+        result.readFailed = !forEachStoredValue(snapshot, task, [&](u64 offset, u32 value) {
+            for (const bool bigEndian : { false, true }) {
+                auto it = locations.find(bigEndian ? __builtin_bswap32(value) : value);
+                if (it != locations.end() && it->second.size() < MaxLocationsPerValue)
+                    it->second.emplace_back(offset, bigEndian);
+            }
+        });
+
+        std::erase_if(result.matches, [&](auto &match) {
+            for (const auto &[offset, bigEndian] : locations[match.value]) {
+                if (offset + 4 <= match.address || offset >= match.address + match.size) {
+                    match.storedAt = offset;
+                    match.bigEndian = bigEndian;
+                    return false;
+                }
+            }
+
+            return true;
+        });
+
+        std::sort(result.matches.begin(), result.matches.end(), [](const auto &left, const auto &right) {
+            return std::tie(left.address, left.size, left.checksum) < std::tie(right.address, right.size, right.checksum);
+        });
+
+        return result;
+    }
+
+}
@@ -1,7 +1,11 @@
 #include <hex/plugin.hpp>
+#include <hex/helpers/data_encoding.hpp>
 
 #include "math_evaluator.hpp"
 
+#include <algorithm>
+#include <cctype>
+
 namespace hex::plugin::builtin {
 
     void registerCommandPaletteCommands() {
@@ -26,6 +30,31 @@ namespace hex::plugin::builtin {
                         return hex::format("#%s = ???", input.data());
                 });
 
+        // Decodes the text following the keyword. Results consisting of printable characters only are shown as text, everything else as hex bytes
+        auto addDecodeCommand = [](std::string_view command, DataEncoding encoding, std::string_view description) {
+            hex::ContentRegistry::CommandPaletteCommands::add(
+                    hex::ContentRegistry::CommandPaletteCommands::Type::KeywordCommand,
+                    command, description,
+                    [command = std::string(command), encoding](auto input) {
+                        auto decoded = hex::decodeData(encoding, { reinterpret_cast<const u8*>(input.data()), input.size() });
+                        if (!decoded.has_value())
+                            return hex::format("%s %s = ???", command.c_str(), input.c_str());
+
+                        std::string result;
+                        if (std::all_of(decoded->begin(), decoded->end(), [](u8 c) { return std::isprint(c); }))
+                            result.assign(decoded->begin(), decoded->end());
+                        else
+                            hex::appendHexBytes(result, *decoded, "", " ");
+
+                        return hex::format("%s %s = %s", command.c_str(), input.c_str(), result.c_str());
+                    });
+        };
+
+        addDecodeCommand("base64", DataEncoding::Base64, "Base64 Decoder");
+        addDecodeCommand("base32", DataEncoding::Base32, "Base32 Decoder");
+        addDecodeCommand("base16", DataEncoding::Base16, "Base16 Decoder");
+        addDecodeCommand("ascii85", DataEncoding::Ascii85, "Ascii85 Decoder");
+
     }
 
 }
\ No newline at end of file
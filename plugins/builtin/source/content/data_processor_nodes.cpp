@@ -1,6 +1,12 @@
 #include <hex/plugin.hpp>
+#include <hex/helpers/data_encoding.hpp>
 
 #include "math_evaluator.hpp"
+#include "buffer_operations.hpp"
+#include "decryptor.hpp"
+
+#include <zlib.h>
+#include <lzma.h>
 
 namespace hex::plugin::builtin {
 
@@ -16,10 +22,7 @@ namespace hex::plugin::builtin {
         }
 
         void process() override {
-            std::vector<u8> data(sizeof(this->m_value), 0);
-
-            std::memcpy(data.data(), &this->m_value, sizeof(u64));
-            this->setBufferOnOutput(0, data);
+            this->setIntegerOnOutput(0, this->m_value);
         }
 
     private:
@@ -37,11 +40,7 @@ namespace hex::plugin::builtin {
         }
 
         void process() override {
-            std::vector<u8> data;
-            data.resize(sizeof(this->m_value));
-
-            std::copy(&this->m_value, &this->m_value + 1, data.data());
-            this->setBufferOnOutput(0, data);
+            this->setFloatOnOutput(0, this->m_value);
         }
 
     private:
@@ -62,11 +61,10 @@ namespace hex::plugin::builtin {
         }
 
         void process() override {
-            this->setBufferOnOutput(0, hex::toBytes<u64>(this->m_color.Value.x * 0xFF));
-            this->setBufferOnOutput(1, hex::toBytes<u64>(this->m_color.Value.y * 0xFF));
-            this->setBufferOnOutput(2, hex::toBytes<u64>(this->m_color.Value.z * 0xFF));
-            this->setBufferOnOutput(3, hex::toBytes<u64>(this->m_color.Value.w * 0xFF));
-
+            this->setIntegerOnOutput(0, this->m_color.Value.x * 0xFF);
+            this->setIntegerOnOutput(1, this->m_color.Value.y * 0xFF);
+            this->setIntegerOnOutput(2, this->m_color.Value.z * 0xFF);
+            this->setIntegerOnOutput(3, this->m_color.Value.w * 0xFF);
         }
 
     private:
@@ -138,14 +136,15 @@ namespace hex::plugin::builtin {
         void process() override {
             auto input = this->getBufferOnInput(0);
 
-            if (!input.has_value())
+            if (input == nullptr)
                 return;
 
-            std::vector<u8> output = input.value();
-            for (auto &byte : output)
-                byte = ~byte;
+            constexpr static u8 Mask = 0xFF;
 
-            this->setBufferOnOutput(1, output);
+            std::vector<u8> output = *input;
+            applyBufferOperation(BufferOperation::Xor, output.data(), output.size(), &Mask, sizeof(Mask));
+
+            this->setBufferOnOutput(1, std::move(output));
         }
     };
 
@@ -157,15 +156,13 @@ namespace hex::plugin::builtin {
             auto inputA = this->getBufferOnInput(0);
             auto inputB = this->getBufferOnInput(1);
 
-            if (!inputA.has_value() || !inputB.has_value())
+            if (inputA == nullptr || inputB == nullptr)
                 return;
 
-            std::vector<u8> output(std::min(inputA->size(), inputB->size()), 0x00);
-
-            for (u32 i = 0; i < output.size(); i++)
-                output[i] = inputA.value()[i] & inputB.value()[i];
+            std::vector<u8> output(inputA->begin(), inputA->begin() + std::min(inputA->size(), inputB->size()));
+            applyBufferOperation(BufferOperation::And, output.data(), output.size(), inputB->data(), inputB->size());
 
-            this->setBufferOnOutput(2, output);
+            this->setBufferOnOutput(2, std::move(output));
         }
     };
 
@@ -177,15 +174,13 @@ namespace hex::plugin::builtin {
             auto inputA = this->getBufferOnInput(0);
             auto inputB = this->getBufferOnInput(1);
 
-            if (!inputA.has_value() || !inputB.has_value())
+            if (inputA == nullptr || inputB == nullptr)
                 return;
 
-            std::vector<u8> output(std::min(inputA->size(), inputB->size()), 0x00);
-
-            for (u32 i = 0; i < output.size(); i++)
-                output[i] = inputA.value()[i] | inputB.value()[i];
+            std::vector<u8> output(inputA->begin(), inputA->begin() + std::min(inputA->size(), inputB->size()));
+            applyBufferOperation(BufferOperation::Or, output.data(), output.size(), inputB->data(), inputB->size());
 
-            this->setBufferOnOutput(2, output);
+            this->setBufferOnOutput(2, std::move(output));
         }
     };
 
@@ -197,16 +192,155 @@ namespace hex::plugin::builtin {
             auto inputA = this->getBufferOnInput(0);
             auto inputB = this->getBufferOnInput(1);
 
-            if (!inputA.has_value() || !inputB.has_value())
+            if (inputA == nullptr || inputB == nullptr)
+                return;
+
+            std::vector<u8> output(inputA->begin(), inputA->begin() + std::min(inputA->size(), inputB->size()));
+            applyBufferOperation(BufferOperation::Xor, output.data(), output.size(), inputB->data(), inputB->size());
+
+            this->setBufferOnOutput(2, std::move(output));
+        }
+    };
+
+    // Element sizes the buffer operations can work on, returns true if the selection changed
+    static bool drawElementSizeCombo(u8 &elementSize, bool allowSingleBytes = true) {
+        constexpr static std::array ElementSizes = { 1, 2, 4, 8 };
+        constexpr static std::array ElementSizeNames = { "8 bits", "16 bits", "32 bits", "64 bits" };
+
+        const u32 first = allowSingleBytes ? 0 : 1;
+
+        bool changed = false;
+        ImGui::PushItemWidth(100);
+        if (ImGui::BeginCombo("##elementSize", ElementSizeNames[std::countr_zero(elementSize)])) {
+            for (u32 i = first; i < ElementSizes.size(); i++) {
+                if (ImGui::Selectable(ElementSizeNames[i], elementSize == ElementSizes[i])) {
+                    elementSize = ElementSizes[i];
+                    changed = true;
+                }
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::PopItemWidth();
+
+        return changed;
+    }
+
+    class NodeBufferXORKey : public dp::Node {
+    public:
+        NodeBufferXORKey() : Node("Repeating Key XOR", { dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Data"),
+                                                         dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Key"),
+                                                         dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Output") }) {}
+
+        void process() override {
+            auto data = this->getBufferOnInput(0);
+            auto key = this->getBufferOnInput(1);
+
+            if (data == nullptr || key == nullptr)
+                return;
+
+            // A key that isn't streamed itself has to continue where the previous chunk left off
+            const u64 keyOffset = this->isInputStreamed(1) ? 0 : this->getStreamOffset();
+
+            std::vector<u8> output = *data;
+            applyBufferOperation(BufferOperation::Xor, output.data(), output.size(), key->data(), key->size(), 1, keyOffset);
+
+            this->setBufferOnOutput(2, std::move(output));
+        }
+    };
+
+    class NodeBufferArithmetic : public dp::Node {
+    public:
+        NodeBufferArithmetic(BufferOperation operation, std::string_view title)
+            : Node(title, { dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Data"),
+                            dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Operand"),
+                            dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Output") }), m_operation(operation) {}
+
+        void drawNode() override {
+            if (drawElementSizeCombo(this->m_elementSize))
+                this->markDirty();
+        }
+
+        void process() override {
+            auto data = this->getBufferOnInput(0);
+            auto operand = this->getBufferOnInput(1);
+
+            if (data == nullptr || operand == nullptr)
+                return;
+
+            const u64 operandOffset = this->isInputStreamed(1) ? 0 : this->getStreamOffset();
+
+            std::vector<u8> output = *data;
+            applyBufferOperation(this->m_operation, output.data(), output.size(), operand->data(), operand->size(), this->m_elementSize, operandOffset);
+
+            this->setBufferOnOutput(2, std::move(output));
+        }
+
+    private:
+        BufferOperation m_operation;
+        u8 m_elementSize = 1;
+    };
+
+    class NodeBufferByteSwap : public dp::Node {
+    public:
+        NodeBufferByteSwap() : Node("Byte Swap", { dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Data"),
+                                                   dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Output") }) {}
+
+        void drawNode() override {
+            if (drawElementSizeCombo(this->m_elementSize, false))
+                this->markDirty();
+        }
+
+        void process() override {
+            auto data = this->getBufferOnInput(0);
+
+            if (data == nullptr)
+                return;
+
+            std::vector<u8> output = *data;
+            swapBufferBytes(output.data(), output.size(), this->m_elementSize);
+
+            this->setBufferOnOutput(1, std::move(output));
+        }
+
+    private:
+        u8 m_elementSize = 2;
+    };
+
+    class NodeBufferRotate : public dp::Node {
+    public:
+        NodeBufferRotate() : Node("Bit Rotate", { dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Data"),
+                                                  dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Integer, "Amount"),
+                                                  dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Output") }) {}
+
+        void drawNode() override {
+            if (drawElementSizeCombo(this->m_elementSize))
+                this->markDirty();
+
+            ImGui::PushItemWidth(100);
+            if (ImGui::Combo("##direction", &this->m_direction, "Left\0Right\0"))
+                this->markDirty();
+            ImGui::PopItemWidth();
+        }
+
+        void process() override {
+            auto data = this->getBufferOnInput(0);
+            auto amount = this->getIntegerOnInput(1);
+
+            if (data == nullptr || !amount.has_value())
                 return;
 
-            std::vector<u8> output(std::min(inputA->size(), inputB->size()), 0x00);
+            // Only the amount modulo the element width matters, so it can be reduced before flipping the direction
+            const s64 bits = s64(amount.value() % (this->m_elementSize * 8));
 
-            for (u32 i = 0; i < output.size(); i++)
-                output[i] = inputA.value()[i] ^ inputB.value()[i];
+            std::vector<u8> output = *data;
+            rotateBufferBits(output.data(), output.size(), this->m_elementSize, this->m_direction == 0 ? bits : -bits);
 
-            this->setBufferOnOutput(2, output);
+            this->setBufferOnOutput(2, std::move(output));
         }
+
+    private:
+        u8 m_elementSize = 1;
+        int m_direction = 0;
     };
 
     class NodeReadData : public dp::Node {
@@ -216,6 +350,16 @@ namespace hex::plugin::builtin {
                                              dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Data")
         }) { }
 
+        [[nodiscard]] bool readsProviderData() const override { return true; }
+
+        [[nodiscard]] bool isStreamSource() const override { return this->m_stream; }
+        [[nodiscard]] u64 getStreamSize() const override { return this->m_size; }
+
+        void drawNode() override {
+            if (ImGui::Checkbox("Stream", &this->m_stream))
+                this->markDirty();
+        }
+
         void process() override {
             auto address = this->getIntegerOnInput(0);
             auto size = this->getIntegerOnInput(1);
@@ -223,13 +367,26 @@ namespace hex::plugin::builtin {
             if (!address.has_value() || !size.has_value())
                 return;
 
+            this->m_size = size.value();
+
+            // Streamed regions only get read one chunk at a time
+            u64 offset = 0, readSize = size.value();
+            if (this->m_stream) {
+                offset = std::min(this->getStreamOffset(), readSize);
+                readSize = std::min(readSize - offset, StreamChunkSize);
+            }
+
             std::vector<u8> data;
-            data.resize(size.value());
+            data.resize(readSize);
 
-            SharedData::currentProvider->readRaw(address.value(), data.data(), size.value());
+            SharedData::currentProvider->readRaw(address.value() + offset, data.data(), readSize);
 
-            this->setBufferOnOutput(2, data);
+            this->setBufferOnOutput(2, std::move(data));
         }
+
+    private:
+        bool m_stream = false;
+        u64 m_size = 0;
     };
 
     class NodeWriteData : public dp::Node {
@@ -240,10 +397,10 @@ namespace hex::plugin::builtin {
             auto address = this->getIntegerOnInput(0);
             auto data = this->getBufferOnInput(1);
 
-            if (!address.has_value() || !data.has_value())
+            if (!address.has_value() || data == nullptr)
                 return;
 
-            this->setOverlayData(address.value(), data.value());
+            this->setOverlayData(address.value(), *data);
         }
     };
 
@@ -260,7 +417,7 @@ namespace hex::plugin::builtin {
             std::vector<u8> output(sizeof(u64), 0x00);
             std::memcpy(output.data(), &input.value(), sizeof(u64));
 
-            this->setBufferOnOutput(1, output);
+            this->setBufferOnOutput(1, std::move(output));
         }
     };
 
@@ -271,11 +428,11 @@ namespace hex::plugin::builtin {
         void process() override {
             auto input = this->getBufferOnInput(0);
 
-            if (!input.has_value())
+            if (input == nullptr)
                 return;
 
-            u64 output;
-            std::memcpy(&output, input->data(), sizeof(u64));
+            u64 output = 0;
+            std::memcpy(&output, input->data(), std::min(input->size(), sizeof(u64)));
 
             this->setIntegerOnOutput(1, output);
         }
@@ -293,14 +450,13 @@ namespace hex::plugin::builtin {
             auto trueData = this->getBufferOnInput(1);
             auto falseData = this->getBufferOnInput(2);
 
-            if (!cond.has_value() || !trueData.has_value() || !falseData.has_value())
+            if (!cond.has_value() || trueData == nullptr || falseData == nullptr)
                 return;
 
             if (cond.value() != 0)
-                this->setBufferOnOutput(3, trueData.value());
+                this->setBufferOnOutput(3, trueData);
             else
-                this->setBufferOnOutput(3, falseData.value());
-
+                this->setBufferOnOutput(3, falseData);
         }
     };
 
@@ -404,6 +560,244 @@ namespace hex::plugin::builtin {
         }
     };
 
+    /*
+     * Decoders keep their state between the chunks of a stream and start over whenever the first chunk comes in.
+     * Outside of streaming mode every input is the first chunk, so the whole buffer gets decoded at once.
+     */
+    class NodeDecompress : public dp::Node {
+    public:
+        enum class Format { Zlib, Deflate, LZMA };
+
+        NodeDecompress(Format format, std::string_view title) : Node(title, { dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Data"),
+                                                                                  dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Output") }), m_format(format) {}
+
+        ~NodeDecompress() override {
+            this->endDecoder();
+        }
+
+        void drawNode() override {
+            if (this->m_error != nullptr)
+                ImGui::TextUnformatted(this->m_error);
+        }
+
+        void process() override {
+            auto input = this->getBufferOnInput(0);
+
+            if (input == nullptr)
+                return;
+
+            if (this->getStreamOffset() == 0)
+                this->startDecoder();
+
+            std::vector<u8> output;
+            if (this->m_error == nullptr && !this->m_finished)
+                this->decode(*input, output);
+
+            this->setBufferOnOutput(1, std::move(output));
+        }
+
+    private:
+        constexpr static size_t OutputChunkSize = 0x10000;
+
+        Format m_format;
+        z_stream m_zlibStream = { };
+        lzma_stream m_lzmaStream = LZMA_STREAM_INIT;
+        bool m_running = false, m_finished = false;
+        const char *m_error = nullptr;
+
+        void startDecoder() {
+            this->endDecoder();
+
+            this->m_error = nullptr;
+            this->m_finished = false;
+
+            bool started;
+            if (this->m_format == Format::LZMA) {
+                this->m_lzmaStream = { };
+                started = lzma_auto_decoder(&this->m_lzmaStream, std::numeric_limits<u64>::max(), 0) == LZMA_OK;
+            } else {
+                // 15 + 32 detects zlib and gzip headers, negative window bits mean there's no header at all
+                this->m_zlibStream = { };
+                started = inflateInit2(&this->m_zlibStream, this->m_format == Format::Zlib ? 15 + 32 : -15) == Z_OK;
+            }
+
+            this->m_running = started;
+            if (!started)
+                this->m_error = "Failed to initialize decoder";
+        }
+
+        void endDecoder() {
+            if (!this->m_running)
+                return;
+
+            if (this->m_format == Format::LZMA)
+                lzma_end(&this->m_lzmaStream);
+            else
+                inflateEnd(&this->m_zlibStream);
+
+            this->m_running = false;
+        }
+
+        void decode(const std::vector<u8> &input, std::vector<u8> &output) {
+            if (this->m_format == Format::LZMA) {
+                auto &stream = this->m_lzmaStream;
+                stream.next_in  = input.data();
+                stream.avail_in = input.size();
+
+                do {
+                    output.resize(output.size() + OutputChunkSize);
+                    stream.next_out  = output.data() + output.size() - OutputChunkSize;
+                    stream.avail_out = OutputChunkSize;
+
+                    auto result = lzma_code(&stream, LZMA_RUN);
+                    output.resize(output.size() - stream.avail_out);
+
+                    // Running out of input is fine, the next chunk continues where this one stopped
+                    if (result == LZMA_STREAM_END) {
+                        this->m_finished = true;
+                        break;
+                    } else if (result == LZMA_BUF_ERROR) {
+                        break;
+                    } else if (result != LZMA_OK) {
+                        this->m_error = "Invalid LZMA data";
+                        break;
+                    }
+                } while (stream.avail_in > 0 || stream.avail_out == 0);
+            } else {
+                auto &stream = this->m_zlibStream;
+                stream.next_in  = const_cast<u8*>(input.data());
+                stream.avail_in = input.size();
+
+                do {
+                    output.resize(output.size() + OutputChunkSize);
+                    stream.next_out  = output.data() + output.size() - OutputChunkSize;
+                    stream.avail_out = OutputChunkSize;
+
+                    auto result = inflate(&stream, Z_NO_FLUSH);
+                    output.resize(output.size() - stream.avail_out);
+
+                    if (result == Z_STREAM_END) {
+                        this->m_finished = true;
+                        break;
+                    } else if (result == Z_BUF_ERROR) {
+                        break;
+                    } else if (result != Z_OK) {
+                        this->m_error = "Invalid Deflate data";
+                        break;
+                    }
+                } while (stream.avail_in > 0 || stream.avail_out == 0);
+            }
+        }
+    };
+
+    class NodeDecrypt : public dp::Node {
+    public:
+        NodeDecrypt() : Node("Decrypt", { dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Data"),
+                                          dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Key"),
+                                          dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "IV"),
+                                          dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Output") }) { }
+
+        void drawNode() override {
+            ImGui::PushItemWidth(100);
+            if (ImGui::Combo("##mode", &this->m_mode, "AES-ECB\0AES-CBC\0AES-CTR\0ChaCha20\0"))
+                this->markDirty();
+            ImGui::PopItemWidth();
+
+            if (this->m_error != nullptr)
+                ImGui::TextUnformatted(this->m_error);
+        }
+
+        void process() override {
+            auto data = this->getBufferOnInput(0);
+            auto key = this->getBufferOnInput(1);
+            auto iv = this->getBufferOnInput(2);
+
+            const auto mode = CipherMode(this->m_mode);
+            if (data == nullptr || key == nullptr || (mode != CipherMode::AES_ECB && iv == nullptr))
+                return;
+
+            // The chaining block and counters carry over between the chunks of a stream
+            if (this->getStreamOffset() == 0)
+                this->m_error = this->m_decryptor.init(mode, *key, iv != nullptr ? std::span<const u8>(*iv) : std::span<const u8>());
+
+            if (this->m_error != nullptr)
+                return;
+
+            std::vector<u8> output(data->size());
+            output.resize(this->m_decryptor.decrypt(data->data(), output.data(), data->size()));
+
+            this->setBufferOnOutput(3, std::move(output));
+        }
+
+    private:
+        int m_mode = int(CipherMode::AES_CBC);
+        const char *m_error = nullptr;
+
+        Decryptor m_decryptor;
+    };
+
+    class NodeDataDecode : public dp::Node {
+    public:
+        NodeDataDecode(DataEncoding encoding, std::string_view title) : Node(title, { dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Data"),
+                                                                                      dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Output") }), m_decoder(encoding) {}
+
+        void drawNode() override {
+            if (this->m_failed)
+                ImGui::TextUnformatted("Invalid input");
+        }
+
+        void process() override {
+            auto input = this->getBufferOnInput(0);
+
+            if (input == nullptr)
+                return;
+
+            if (this->getStreamOffset() == 0) {
+                this->m_decoder.reset();
+                this->m_failed = false;
+            }
+
+            // Groups may be split between chunks, the decoder keeps the incomplete ones until the next chunk arrives
+            std::vector<u8> output;
+            if (!this->m_decoder.update(*input, output))
+                this->m_failed = true;
+            if (this->isLastStreamChunk() && !this->m_decoder.finish(output))
+                this->m_failed = true;
+
+            this->setBufferOnOutput(1, std::move(output));
+        }
+
+    private:
+        DataDecoder m_decoder;
+        bool m_failed = false;
+    };
+
+    class NodeDataEncode : public dp::Node {
+    public:
+        NodeDataEncode(DataEncoding encoding, std::string_view title) : Node(title, { dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Data"),
+                                                                                      dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Output") }), m_encoder(encoding) {}
+
+        void process() override {
+            auto input = this->getBufferOnInput(0);
+
+            if (input == nullptr)
+                return;
+
+            if (this->getStreamOffset() == 0)
+                this->m_encoder.reset();
+
+            std::vector<u8> output;
+            this->m_encoder.update(*input, output);
+            if (this->isLastStreamChunk())
+                this->m_encoder.finish(output);
+
+            this->setBufferOnOutput(1, std::move(output));
+        }
+
+    private:
+        DataEncoder m_encoder;
+    };
+
     void registerDataProcessorNodes() {
         ContentRegistry::DataProcessorNode::add<NodeInteger>("Constants", "Integer");
         ContentRegistry::DataProcessorNode::add<NodeFloat>("Constants", "Float");
@@ -430,6 +824,26 @@ namespace hex::plugin::builtin {
         ContentRegistry::DataProcessorNode::add<NodeBitwiseOR>("Bitwise Operations", "OR");
         ContentRegistry::DataProcessorNode::add<NodeBitwiseXOR>("Bitwise Operations", "XOR");
         ContentRegistry::DataProcessorNode::add<NodeBitwiseNOT>("Bitwise Operations", "NOT");
+
+        ContentRegistry::DataProcessorNode::add<NodeBufferXORKey>("Buffer Operations", "Repeating Key XOR");
+        ContentRegistry::DataProcessorNode::add<NodeBufferArithmetic>("Buffer Operations", "Add", BufferOperation::Add, "Add");
+        ContentRegistry::DataProcessorNode::add<NodeBufferArithmetic>("Buffer Operations", "Subtract", BufferOperation::Subtract, "Subtract");
+        ContentRegistry::DataProcessorNode::add<NodeBufferByteSwap>("Buffer Operations", "Byte Swap");
+        ContentRegistry::DataProcessorNode::add<NodeBufferRotate>("Buffer Operations", "Bit Rotate");
+
+        ContentRegistry::DataProcessorNode::add<NodeDecompress>("Decoding", "Zlib / GZip Decompress", NodeDecompress::Format::Zlib, "Zlib Decompress");
+        ContentRegistry::DataProcessorNode::add<NodeDecompress>("Decoding", "Deflate Decompress", NodeDecompress::Format::Deflate, "Deflate Decompress");
+        ContentRegistry::DataProcessorNode::add<NodeDecompress>("Decoding", "LZMA / XZ Decompress", NodeDecompress::Format::LZMA, "LZMA Decompress");
+        ContentRegistry::DataProcessorNode::add<NodeDecrypt>("Decoding", "Decrypt");
+        ContentRegistry::DataProcessorNode::add<NodeDataDecode>("Decoding", "Base64 Decode", DataEncoding::Base64, "Base64 Decode");
+        ContentRegistry::DataProcessorNode::add<NodeDataDecode>("Decoding", "Base32 Decode", DataEncoding::Base32, "Base32 Decode");
+        ContentRegistry::DataProcessorNode::add<NodeDataDecode>("Decoding", "Base16 Decode", DataEncoding::Base16, "Base16 Decode");
+        ContentRegistry::DataProcessorNode::add<NodeDataDecode>("Decoding", "Ascii85 Decode", DataEncoding::Ascii85, "Ascii85 Decode");
+
+        ContentRegistry::DataProcessorNode::add<NodeDataEncode>("Encoding", "Base64 Encode", DataEncoding::Base64, "Base64 Encode");
+        ContentRegistry::DataProcessorNode::add<NodeDataEncode>("Encoding", "Base32 Encode", DataEncoding::Base32, "Base32 Encode");
+        ContentRegistry::DataProcessorNode::add<NodeDataEncode>("Encoding", "Base16 Encode", DataEncoding::Base16, "Base16 Encode");
+        ContentRegistry::DataProcessorNode::add<NodeDataEncode>("Encoding", "Ascii85 Encode", DataEncoding::Ascii85, "Ascii85 Encode");
     }
 
 }
\ No newline at end of file
@@ -5,7 +5,13 @@
 #include <hex/lang/evaluator.hpp>
 
 #include <hex/helpers/utils.hpp>
+#include <hex/helpers/byte_searcher.hpp>
 
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace hex::plugin::builtin {
@@ -13,46 +19,156 @@ namespace hex::plugin::builtin {
     #define LITERAL_COMPARE(literal, cond) std::visit([&](auto &&literal) { return (cond) != 0; }, literal)
     #define AS_TYPE(type, value) ctx.template asType<type>(value)
 
+    // Passes the address of every match within [from, to) to the callback in ascending order until it returns false.
+    // The data is searched in large blocks that overlap by the pattern size
+    static void findOccurrences(hex::lang::Evaluator &ctx, const ByteSearcher &searcher, u64 from, u64 to, const std::function<bool(u64)> &callback) {
+        auto provider = ctx.getProvider();
+        const size_t patternSize = searcher.getSize();
+        if (searcher.empty())
+            return;
+
+        to = std::min<u64>(to, provider->getActualSize());
+
+        std::vector<u8> buffer(std::max<size_t>(0x10'0000, patternSize), 0x00);
+        for (u64 offset = from; offset + patternSize <= to; offset += buffer.size() - (patternSize - 1)) {
+            ctx.throwIfCancelled();
+
+            size_t readSize = std::min<u64>(buffer.size(), to - offset);
+            provider->readAbsolute(offset, buffer.data(), readSize);
+
+            for (size_t i = searcher.find(buffer.data(), readSize); i < readSize; i += 1 + searcher.find(buffer.data() + i + 1, readSize - i - 1)) {
+                if (!callback(offset + i))
+                    return;
+            }
+
+            if (readSize < buffer.size())
+                break;
+        }
+    }
+
+    // Returns the address of the occurrenceIndex-th match in the whole data. Matches found by earlier calls with the same key aren't searched again
+    static std::optional<u64> findOccurrence(hex::lang::Evaluator &ctx, const std::string &cacheKey, const ByteSearcher &searcher, u64 occurrenceIndex) {
+        auto &cache = ctx.getSearchCache(cacheKey);
+
+        if (occurrenceIndex >= cache.occurrences.size() && !cache.complete) {
+            const u64 from = cache.occurrences.empty() ? 0 : cache.occurrences.back() + 1;
+
+            cache.complete = true;
+            findOccurrences(ctx, searcher, from, std::numeric_limits<u64>::max(), [&](u64 address) {
+                cache.occurrences.push_back(address);
+                cache.complete = occurrenceIndex >= cache.occurrences.size();
+
+                return cache.complete;
+            });
+        }
+
+        if (occurrenceIndex < cache.occurrences.size())
+            return cache.occurrences[occurrenceIndex];
+        else
+            return { };
+    }
+
+    // Returns the address of the occurrenceIndex-th match that lies entirely within [from, to)
+    static std::optional<u64> findOccurrenceInRange(hex::lang::Evaluator &ctx, const ByteSearcher &searcher, u64 occurrenceIndex, u64 from, u64 to) {
+        std::optional<u64> result;
+
+        findOccurrences(ctx, searcher, from, to, [&](u64 address) {
+            if (occurrenceIndex-- == 0) {
+                result = address;
+                return false;
+            }
+
+            return true;
+        });
+
+        return result;
+    }
+
     void registerPatternLanguageFunctions() {
         using namespace hex::lang;
 
+        auto getValue = [](auto &literal) { return std::visit([](auto &&value) { return u64(value); }, literal); };
+
+        auto getSequence = [](auto &ctx, auto &params, u32 firstByte) {
+            std::vector<u8> sequence;
+            for (u32 i = firstByte; i < params.size(); i++) {
+                sequence.push_back(std::visit([&](auto &&value) -> u8 {
+                    if (value <= 0xFF)
+                        return value;
+                    else
+                        ctx.getConsole().abortEvaluation("sequence bytes need to fit into 1 byte");
+                }, AS_TYPE(ASTNodeIntegerLiteral, params[i])->getValue()));
+            }
+
+            return sequence;
+        };
+
+        auto getMaskedSearcher = [](auto &ctx, const std::string &pattern) -> ByteSearcher {
+            auto searcher = ByteSearcher::parse(pattern);
+            if (!searcher.has_value())
+                ctx.getConsole().abortEvaluation(hex::format("invalid byte pattern \"%s\"", pattern.c_str()));
+
+            return std::move(*searcher);
+        };
+
         /* findSequence(occurrenceIndex, byte...) */
-        ContentRegistry::PatternLanguageFunctions::add("findSequence", ContentRegistry::PatternLanguageFunctions::MoreParametersThan | 1, [](auto &ctx, auto params) {
-           auto& occurrenceIndex = AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue();
-           std::vector<u8> sequence;
-           for (u32 i = 1; i < params.size(); i++) {
-               sequence.push_back(std::visit([&](auto &&value) -> u8 {
-                   if (value <= 0xFF)
-                       return value;
-                   else
-                       ctx.getConsole().abortEvaluation("sequence bytes need to fit into 1 byte");
-               }, AS_TYPE(ASTNodeIntegerLiteral, params[i])->getValue()));
-           }
-
-           std::vector<u8> bytes(sequence.size(), 0x00);
-           u32 occurrences = 0;
-           for (u64 offset = 0; offset < SharedData::currentProvider->getSize() - sequence.size(); offset++) {
-               SharedData::currentProvider->read(offset, bytes.data(), bytes.size());
-
-               if (bytes == sequence) {
-                   if (LITERAL_COMPARE(occurrenceIndex, occurrences < occurrenceIndex)) {
-                       occurrences++;
-                       continue;
-                   }
-
-                   return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit, offset });
-               }
-           }
-
-           ctx.getConsole().abortEvaluation("failed to find sequence");
-       });
+        ContentRegistry::PatternLanguageFunctions::add("findSequence", ContentRegistry::PatternLanguageFunctions::MoreParametersThan | 1, [=](auto &ctx, auto params) {
+            auto& occurrenceIndex = AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue();
+            auto sequence = getSequence(ctx, params, 1);
+
+            auto cacheKey = "sequence:" + std::string(sequence.begin(), sequence.end());
+            auto offset = findOccurrence(ctx, cacheKey, ByteSearcher(std::move(sequence)), getValue(occurrenceIndex));
+            if (!offset.has_value())
+                ctx.getConsole().abortEvaluation("failed to find sequence");
+
+            return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit, *offset });
+        });
+
+        /* findSequenceInRange(occurrenceIndex, from, to, byte...) */
+        ContentRegistry::PatternLanguageFunctions::add("findSequenceInRange", ContentRegistry::PatternLanguageFunctions::MoreParametersThan | 3, [=](auto &ctx, auto params) {
+            auto& occurrenceIndex = AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue();
+            auto& from = AS_TYPE(ASTNodeIntegerLiteral, params[1])->getValue();
+            auto& to = AS_TYPE(ASTNodeIntegerLiteral, params[2])->getValue();
+
+            auto offset = findOccurrenceInRange(ctx, ByteSearcher(getSequence(ctx, params, 3)), getValue(occurrenceIndex), getValue(from), getValue(to));
+            if (!offset.has_value())
+                ctx.getConsole().abortEvaluation("failed to find sequence");
+
+            return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit, *offset });
+        });
+
+        /* findMaskedSequence(occurrenceIndex, pattern) */
+        ContentRegistry::PatternLanguageFunctions::add("findMaskedSequence", 2, [=](auto &ctx, auto params) {
+            auto& occurrenceIndex = AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue();
+            auto pattern = std::string(AS_TYPE(ASTNodeStringLiteral, params[1])->getString());
+
+            auto offset = findOccurrence(ctx, "masked:" + pattern, getMaskedSearcher(ctx, pattern), getValue(occurrenceIndex));
+            if (!offset.has_value())
+                ctx.getConsole().abortEvaluation("failed to find sequence");
+
+            return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit, *offset });
+        });
+
+        /* findMaskedSequenceInRange(occurrenceIndex, from, to, pattern) */
+        ContentRegistry::PatternLanguageFunctions::add("findMaskedSequenceInRange", 4, [=](auto &ctx, auto params) {
+            auto& occurrenceIndex = AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue();
+            auto& from = AS_TYPE(ASTNodeIntegerLiteral, params[1])->getValue();
+            auto& to = AS_TYPE(ASTNodeIntegerLiteral, params[2])->getValue();
+            auto pattern = std::string(AS_TYPE(ASTNodeStringLiteral, params[3])->getString());
+
+            auto offset = findOccurrenceInRange(ctx, getMaskedSearcher(ctx, pattern), getValue(occurrenceIndex), getValue(from), getValue(to));
+            if (!offset.has_value())
+                ctx.getConsole().abortEvaluation("failed to find sequence");
+
+            return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit, *offset });
+        });
 
         /* readUnsigned(address, size) */
         ContentRegistry::PatternLanguageFunctions::add("readUnsigned", 2, [](auto &ctx, auto params) {
             auto address = AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue();
             auto size = AS_TYPE(ASTNodeIntegerLiteral, params[1])->getValue();
 
-            if (LITERAL_COMPARE(address, address >= SharedData::currentProvider->getActualSize()))
+            if (LITERAL_COMPARE(address, address >= ctx.getProvider()->getActualSize()))
                 ctx.getConsole().abortEvaluation("address out of range");
 
             return std::visit([&](auto &&address, auto &&size) {
@@ -60,7 +176,7 @@ namespace hex::plugin::builtin {
                     ctx.getConsole().abortEvaluation("invalid read size");
 
                 u8 value[(u8)size];
-                SharedData::currentProvider->read(address, value, size);
+                ctx.getProvider()->readAbsolute(address, value, size);
 
                 switch ((u8)size) {
                 case 1:  return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned8Bit,   *reinterpret_cast<u8*>(value)   });
@@ -78,7 +194,7 @@ namespace hex::plugin::builtin {
             auto address = AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue();
             auto size = AS_TYPE(ASTNodeIntegerLiteral, params[1])->getValue();
 
-            if (LITERAL_COMPARE(address, address >= SharedData::currentProvider->getActualSize()))
+            if (LITERAL_COMPARE(address, address >= ctx.getProvider()->getActualSize()))
                 ctx.getConsole().abortEvaluation("address out of range");
 
             return std::visit([&](auto &&address, auto &&size) {
@@ -86,7 +202,7 @@ namespace hex::plugin::builtin {
                     ctx.getConsole().abortEvaluation("invalid read size");
 
                 u8 value[(u8)size];
-                SharedData::currentProvider->read(address, value, size);
+                ctx.getProvider()->readAbsolute(address, value, size);
 
                 switch ((u8)size) {
                 case 1:  return new ASTNodeIntegerLiteral({ Token::ValueType::Signed8Bit,   *reinterpret_cast<s8*>(value)   });
@@ -111,7 +227,7 @@ namespace hex::plugin::builtin {
         });
 
         /* warnAssert(condition, message) */
-        ContentRegistry::PatternLanguageFunctions::add("warnAssert", 2, [](auto ctx, auto params) {
+        ContentRegistry::PatternLanguageFunctions::add("warnAssert", 2, [](auto &ctx, auto params) {
             auto condition = AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue();
             auto message = AS_TYPE(ASTNodeStringLiteral, params[1])->getString();
 
@@ -195,6 +311,39 @@ namespace hex::plugin::builtin {
 
             return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit, u64(result) });
         });
+
+        /* memcmp(address, byte...) */
+        ContentRegistry::PatternLanguageFunctions::add("memcmp", ContentRegistry::PatternLanguageFunctions::MoreParametersThan | 1, [=](auto &ctx, auto params) -> ASTNode* {
+            const u64 address = getValue(AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue());
+            auto sequence = getSequence(ctx, params, 1);
+
+            if (address > ctx.getProvider()->getActualSize() || sequence.size() > ctx.getProvider()->getActualSize() - address)
+                ctx.getConsole().abortEvaluation("address out of range");
+
+            std::vector<u8> data(sequence.size(), 0x00);
+            ctx.getProvider()->readAbsolute(address, data.data(), data.size());
+
+            const int result = std::memcmp(data.data(), sequence.data(), data.size());
+            return new ASTNodeIntegerLiteral({ Token::ValueType::Signed32Bit, s32(result < 0 ? -1 : result > 0 ? 1 : 0) });
+        });
+
+        /* count(address, size, byte...), overlapping occurrences are counted separately */
+        ContentRegistry::PatternLanguageFunctions::add("count", ContentRegistry::PatternLanguageFunctions::MoreParametersThan | 2, [=](auto &ctx, auto params) -> ASTNode* {
+            const u64 address = getValue(AS_TYPE(ASTNodeIntegerLiteral, params[0])->getValue());
+            const u64 size = getValue(AS_TYPE(ASTNodeIntegerLiteral, params[1])->getValue());
+            auto sequence = getSequence(ctx, params, 2);
+
+            if (address > ctx.getProvider()->getActualSize() || size > ctx.getProvider()->getActualSize() - address)
+                ctx.getConsole().abortEvaluation("address out of range");
+
+            u64 count = 0;
+            findOccurrences(ctx, ByteSearcher(std::move(sequence)), address, address + size, [&count](u64) {
+                count++;
+                return true;
+            });
+
+            return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit, count });
+        });
     }
 
 }
\ No newline at end of file
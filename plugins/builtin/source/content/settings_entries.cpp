@@ -4,6 +4,40 @@ namespace hex::plugin::builtin {
 
     void registerSettings() {
 
+        // Zero lets the task manager pick the number of workers depending on the number of cores. Changing the number replaces
+        // all workers, so it's only applied once the slider is let go
+        ContentRegistry::Settings::add("Tasks", "Worker threads", 0, [](nlohmann::json &setting) {
+            static int count = setting;
+            ImGui::SliderInt("##nolabel", &count, 0, 64, count == 0 ? "Automatic" : "%d");
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                setting = count;
+                return true;
+            }
+
+            return false;
+        });
+
+        ContentRegistry::Settings::add("Tasks", "Background worker threads", 0, [](nlohmann::json &setting) {
+            static int count = setting;
+            ImGui::SliderInt("##nolabel", &count, 0, 64, count == 0 ? "Automatic" : "%d");
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                setting = count;
+                return true;
+            }
+
+            return false;
+        });
+
+        ContentRegistry::Settings::add("Tasks", "Run background jobs at lower priority", 1, [](nlohmann::json &setting) {
+            static bool enabled = static_cast<int>(setting);
+            if (ImGui::Checkbox("##nolabel", &enabled)) {
+                setting = static_cast<int>(enabled);
+                return true;
+            }
+
+            return false;
+        });
+
     }
 
-}
\ No newline at end of file
+}
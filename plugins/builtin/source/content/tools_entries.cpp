@@ -1,9 +1,21 @@
 #include <hex/plugin.hpp>
 
+#include <hex/api/event.hpp>
+#include <hex/api/task.hpp>
+#include <hex/providers/provider.hpp>
+
+#include <cctype>
+#include <cerrno>
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
 #include <regex>
 
 #include <llvm/Demangle/Demangle.h>
+#include "checksum_locator.hpp"
+#include "crc_search.hpp"
 #include "math_evaluator.hpp"
+#include "xor_analysis.hpp"
 
 namespace hex::plugin::builtin {
 
@@ -133,7 +145,7 @@ namespace hex::plugin::builtin {
                     if (provider == nullptr || !provider->isReadable() || args[0] >= provider->getActualSize())
                         return { };
 
-                    provider->read(args[0], &value, sizeof(u8));
+                    provider->readAbsolute(args[0], &value, sizeof(u8));
 
                     return value;
                 }, 1, 1);
@@ -147,7 +159,7 @@ namespace hex::plugin::builtin {
                         return { };
 
                     u8 value = args[1];
-                    provider->write(args[0], &value, sizeof(u8));
+                    provider->writeAbsolute(args[0], &value, sizeof(u8));
 
                     return { };
                 }, 2, 2);
@@ -285,6 +297,450 @@ namespace hex::plugin::builtin {
             }
         }
 
+
+        // Parses a comma separated list of hex values, returns false if any of them isn't one
+        bool parseHexList(const char *input, std::vector<u32> &values) {
+            for (const auto &part : splitString(input, ",")) {
+                const auto first = part.find_first_not_of(" \t");
+                if (first == std::string::npos)
+                    continue;
+
+                const auto last = part.find_last_not_of(" \t");
+                const auto number = part.substr(first, last - first + 1);
+
+                char *end = nullptr;
+                errno = 0;
+                const auto value = std::strtoull(number.c_str(), &end, 16);
+                if (errno != 0 || *end != '\0' || value > 0xFFFF'FFFF)
+                    return false;
+
+                values.push_back(value);
+            }
+
+            return true;
+        }
+
+        void drawCrcSearch() {
+            constexpr std::array<u8, 3> CrcWidths = { 8, 16, 32 };
+
+            static u64 regionAddress = 0, regionSize = 0;
+            static u32 target = 0;
+            static int widthIndex = 2;
+            static bool commonPolynomials = true, allPolynomials = false;
+            static std::array<char, 0x400> polynomialInput = { 0 }, initInput = { 0 }, xorOutInput = { 0 };
+
+            static TaskHandle searchTask;
+            static auto results = std::make_shared<std::vector<CrcParameters>>();
+            static std::string searchError;
+
+            const bool searching = searchTask != nullptr && !searchTask->isFinished();
+            const u8 width = CrcWidths[widthIndex];
+
+            ImGui::InputScalar("Address", ImGuiDataType_U64, &regionAddress, nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("Size", ImGuiDataType_U64, &regionSize, nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("Target CRC", ImGuiDataType_U32, &target, nullptr, nullptr, "0x%08X", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::Combo("Width", &widthIndex, "8 bit\0" "16 bit\0" "32 bit\0");
+
+            ImGui::Checkbox("Common polynomials", &commonPolynomials);
+            if (width <= 16) {
+                ImGui::SameLine();
+                ImGui::Checkbox("All polynomials", &allPolynomials);
+            }
+
+            ImGui::InputText("Extra polynomials", polynomialInput.data(), polynomialInput.size());
+            ImGui::InputText("Extra init values", initInput.data(), initInput.size());
+            ImGui::InputText("Extra XOR out values", xorOutInput.data(), xorOutInput.size());
+            ImGui::TextDisabled("Comma separated hex values. Init and XOR out values of 0 and all ones are always tried");
+
+            if (searching) {
+                ImGui::ProgressBar(searchTask->getProgress(), ImVec2(300, 0));
+                ImGui::SameLine();
+                if (ImGui::Button("Cancel"))
+                    searchTask->cancel();
+            } else if (ImGui::Button("Search")) {
+                const u32 allOnes = width == 32 ? 0xFFFF'FFFF : (u32(1) << width) - 1;
+
+                std::vector<u32> polynomials, initValues = { 0, allOnes }, xorOutValues = { 0, allOnes };
+                searchError.clear();
+
+                if (allPolynomials && width <= 16) {
+                    for (u32 polynomial = 1; polynomial <= allOnes; polynomial++)
+                        polynomials.push_back(polynomial);
+                } else if (commonPolynomials) {
+                    const auto common = getCommonCrcPolynomials(width);
+                    polynomials.assign(common.begin(), common.end());
+                }
+
+                auto provider = SharedData::currentProvider;
+                if (!parseHexList(polynomialInput.data(), polynomials) || !parseHexList(initInput.data(), initValues) || !parseHexList(xorOutInput.data(), xorOutValues))
+                    searchError = "Invalid hex value in candidate list";
+                else if (polynomials.empty())
+                    searchError = "No polynomials to try";
+                else if (provider == nullptr || !provider->isReadable())
+                    searchError = "No readable data loaded";
+                else if (regionSize == 0 || regionAddress + regionSize < regionAddress || regionAddress + regionSize > provider->getActualSize())
+                    searchError = "Region lies outside of the loaded data";
+
+                if (searchError.empty()) {
+                    auto found = std::make_shared<std::vector<CrcParameters>>();
+                    auto readFailed = std::make_shared<bool>(false);
+
+                    searchTask = TaskManager::submit("Searching CRC parameters",
+                        [snapshot = provider->createSnapshot(), address = regionAddress, size = regionSize, target = target, width, polynomials = std::move(polynomials),
+                         initValues = std::move(initValues), xorOutValues = std::move(xorOutValues), found, readFailed](Task &task) {
+                            std::vector<u8> data(size);
+                            if (!snapshot.read(address, data.data(), data.size())) {
+                                *readFailed = true;
+                                return;
+                            }
+
+                            *found = searchCrcParameters(data, target, width, polynomials, initValues, xorOutValues, task);
+                        }, [found, readFailed] {
+                            results = found;
+                            if (*readFailed)
+                                searchError = "Data changed before it could be read";
+                            else if (found->empty())
+                                searchError = "No matching parameters found";
+                        });
+                }
+            }
+
+            if (!searchError.empty())
+                ImGui::TextUnformatted(searchError.c_str());
+
+            if (ImGui::BeginTable("##crcresults", 5, ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg, ImVec2(0, 300))) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Polynomial");
+                ImGui::TableSetupColumn("Init");
+                ImGui::TableSetupColumn("XOR out");
+                ImGui::TableSetupColumn("Reflect in");
+                ImGui::TableSetupColumn("Reflect out");
+                ImGui::TableHeadersRow();
+
+                const int digits = (results->empty() ? width : results->front().width) / 4;
+
+                ImGuiListClipper clipper;
+                clipper.Begin(results->size());
+                while (clipper.Step()) {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                        const auto &parameters = (*results)[i];
+
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::Text("0x%0*X", digits, parameters.polynomial);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("0x%0*X", digits, parameters.init);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("0x%0*X", digits, parameters.xorOut);
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(parameters.reflectIn ? "Yes" : "No");
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(parameters.reflectOut ? "Yes" : "No");
+                    }
+                }
+                clipper.End();
+
+                ImGui::EndTable();
+            }
+        }
+
+        void drawChecksumLocator() {
+            constexpr size_t MaxWindowSizes = 0x1000;
+
+            static u64 regionAddress = 0, regionSize = 0, alignment = 1;
+            static std::array<u64, 3> sizeRange = { 0 };
+            static std::array<char, 0x400> windowSizeInput = { 0 };
+            static bool useAdler32 = true, useCrc32 = true, useCrc32c = false;
+
+            static TaskHandle locateTask;
+            static auto results = std::make_shared<ChecksumLocatorResult>();
+            static std::string locateError;
+
+            const bool locating = locateTask != nullptr && !locateTask->isFinished();
+
+            ImGui::InputScalar("Address", ImGuiDataType_U64, &regionAddress, nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("Size", ImGuiDataType_U64, &regionSize, nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputText("Window sizes", windowSizeInput.data(), windowSizeInput.size());
+            ImGui::InputScalarN("Window size range", ImGuiDataType_U64, sizeRange.data(), sizeRange.size(), nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::TextDisabled("Comma separated hex values and sizes from the first to the second value of the range in steps of the third one");
+            ImGui::InputScalar("Alignment", ImGuiDataType_U64, &alignment, nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+
+            ImGui::Checkbox("Adler32", &useAdler32);
+            ImGui::SameLine();
+            ImGui::Checkbox("CRC32", &useCrc32);
+            ImGui::SameLine();
+            ImGui::Checkbox("CRC32C", &useCrc32c);
+
+            if (locating) {
+                ImGui::ProgressBar(locateTask->getProgress(), ImVec2(300, 0));
+                ImGui::SameLine();
+                if (ImGui::Button("Cancel"))
+                    locateTask->cancel();
+            } else if (ImGui::Button("Locate")) {
+                std::vector<u32> listedSizes;
+                std::vector<u64> windowSizes;
+                std::vector<Checksum> checksums;
+                locateError.clear();
+
+                if (useAdler32) checksums.push_back(Checksum::Adler32);
+                if (useCrc32)   checksums.push_back(Checksum::CRC32);
+                if (useCrc32c)  checksums.push_back(Checksum::CRC32C);
+
+                const bool validSizes = parseHexList(windowSizeInput.data(), listedSizes);
+                windowSizes.assign(listedSizes.begin(), listedSizes.end());
+
+                const auto [rangeBegin, rangeEnd, rangeStep] = sizeRange;
+                if (rangeBegin != 0 && rangeStep != 0) {
+                    for (u64 windowSize = rangeBegin; windowSize <= rangeEnd && windowSizes.size() <= MaxWindowSizes; windowSize += rangeStep)
+                        windowSizes.push_back(windowSize);
+                }
+
+                std::sort(windowSizes.begin(), windowSizes.end());
+                windowSizes.erase(std::unique(windowSizes.begin(), windowSizes.end()), windowSizes.end());
+                std::erase(windowSizes, 0);
+
+                auto provider = SharedData::currentProvider;
+                if (!validSizes)
+                    locateError = "Invalid hex value in window sizes";
+                else if (windowSizes.empty())
+                    locateError = "No window sizes to try";
+                else if (windowSizes.size() > MaxWindowSizes)
+                    locateError = "Too many window sizes";
+                else if (checksums.empty())
+                    locateError = "No checksums selected";
+                else if (provider == nullptr || !provider->isReadable())
+                    locateError = "No readable data loaded";
+                else if (regionSize == 0 || regionAddress + regionSize < regionAddress || regionAddress + regionSize > provider->getActualSize())
+                    locateError = "Region lies outside of the loaded data";
+
+                if (locateError.empty()) {
+                    auto found = std::make_shared<ChecksumLocatorResult>();
+
+                    locateTask = TaskManager::submit("Locating checksums",
+                        [snapshot = provider->createSnapshot(), address = regionAddress, size = regionSize, windowSizes = std::move(windowSizes),
+                         alignment = alignment, checksums = std::move(checksums), found](Task &task) {
+                            *found = locateChecksums(snapshot, address, size, windowSizes, alignment, checksums, task);
+                        }, [found] {
+                            results = found;
+                            if (found->readFailed)
+                                locateError = "Data changed before it could be read";
+                            else if (found->matches.empty())
+                                locateError = "No stored checksums found";
+                            else if (found->truncated)
+                                locateError = "Too many matches, only the first ones are shown";
+                        });
+                }
+            }
+
+            if (!locateError.empty())
+                ImGui::TextUnformatted(locateError.c_str());
+
+            if (ImGui::BeginTable("##checksumresults", 5, ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg, ImVec2(0, 300))) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Checksum");
+                ImGui::TableSetupColumn("Block");
+                ImGui::TableSetupColumn("Size");
+                ImGui::TableSetupColumn("Value");
+                ImGui::TableSetupColumn("Stored at");
+                ImGui::TableHeadersRow();
+
+                ImGuiListClipper clipper;
+                clipper.Begin(results->matches.size());
+                while (clipper.Step()) {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                        const auto &match = results->matches[i];
+
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::PushID(i);
+                        if (ImGui::Selectable(getChecksumName(match.checksum), false, ImGuiSelectableFlags_SpanAllColumns))
+                            EventManager::post(Events::SelectionChangeRequest, Region { match.address, match.size });
+                        ImGui::PopID();
+                        ImGui::TableNextColumn();
+                        ImGui::Text("0x%08llX", match.address);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("0x%llX", match.size);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("0x%08X", match.value);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("0x%08llX (%s)", match.storedAt, match.bigEndian ? "BE" : "LE");
+                    }
+                }
+                clipper.End();
+
+                ImGui::EndTable();
+            }
+        }
+
+        std::string formatKey(const std::vector<u8> &key) {
+            std::string result;
+            for (const u8 byte : key)
+                result += hex::format("%02X ", byte);
+
+            if (!result.empty())
+                result.pop_back();
+
+            return result;
+        }
+
+        // Parses hex digits into bytes, ignoring whitespace in between. Returns false if there's anything else or an odd number of digits
+        bool parseHexBytes(const char *input, std::vector<u8> &bytes) {
+            std::string digits;
+            for (; *input != '\0'; input++) {
+                if (std::isxdigit(static_cast<unsigned char>(*input)))
+                    digits += *input;
+                else if (!std::isspace(static_cast<unsigned char>(*input)))
+                    return false;
+            }
+
+            if (digits.size() % 2 != 0)
+                return false;
+
+            for (size_t i = 0; i < digits.size(); i += 2)
+                bytes.push_back(std::strtoul(digits.substr(i, 2).c_str(), nullptr, 16));
+
+            return true;
+        }
+
+        void drawXorAnalysis() {
+            static u64 regionAddress = 0, regionSize = 0;
+            static u32 maxKeyLength = 32, keyLength = 0;
+            static std::array<char, 0x400> plaintextInput = { "This program cannot be run in DOS mode" };
+            static bool plaintextIsHex = false;
+
+            static TaskHandle analysisTask;
+            static auto analysis = std::make_shared<XorKeyAnalysis>();
+            static auto plaintextResult = std::make_shared<XorPlaintextResult>();
+            static std::vector<float> coincidence;
+            static std::string analysisError;
+
+            const bool analyzing = analysisTask != nullptr && !analysisTask->isFinished();
+
+            ImGui::InputScalar("Address", ImGuiDataType_U64, &regionAddress, nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("Size", ImGuiDataType_U64, &regionSize, nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::InputScalar("Max key length", ImGuiDataType_U32, &maxKeyLength);
+            ImGui::InputScalar("Key length", ImGuiDataType_U32, &keyLength);
+            ImGui::TextDisabled("A key length of 0 estimates it from the data");
+            ImGui::InputText("Known plaintext", plaintextInput.data(), plaintextInput.size());
+            ImGui::SameLine();
+            ImGui::Checkbox("Hex", &plaintextIsHex);
+
+            // Both buttons read the region into memory on a task, then either recover the key or search for the plaintext
+            const auto startAnalysis = [](bool searchPlaintext) {
+                std::vector<u8> plaintext;
+                analysisError.clear();
+
+                auto provider = SharedData::currentProvider;
+                if (provider == nullptr || !provider->isReadable())
+                    analysisError = "No readable data loaded";
+                else if (regionSize == 0 || regionAddress + regionSize < regionAddress || regionAddress + regionSize > provider->getActualSize())
+                    analysisError = "Region lies outside of the loaded data";
+                else if (maxKeyLength == 0)
+                    analysisError = "Max key length needs to be at least 1";
+                else if (searchPlaintext) {
+                    if (!plaintextIsHex)
+                        plaintext.assign(plaintextInput.data(), plaintextInput.data() + std::strlen(plaintextInput.data()));
+                    else if (!parseHexBytes(plaintextInput.data(), plaintext))
+                        analysisError = "Invalid hex plaintext";
+
+                    if (analysisError.empty() && plaintext.size() < 3)
+                        analysisError = "Known plaintexts need to be at least 3 bytes long";
+                }
+
+                if (!analysisError.empty())
+                    return;
+
+                auto foundKey = std::make_shared<XorKeyAnalysis>();
+                auto foundPlaintext = std::make_shared<XorPlaintextResult>();
+                auto readFailed = std::make_shared<bool>(false);
+
+                analysisTask = TaskManager::submit(searchPlaintext ? "Searching XORed plaintext" : "Recovering XOR key",
+                    [snapshot = provider->createSnapshot(), address = regionAddress, size = regionSize, maxKeyLength = maxKeyLength, keyLength = keyLength,
+                     plaintext = std::move(plaintext), searchPlaintext, foundKey, foundPlaintext, readFailed](Task &task) {
+                        std::vector<u8> data(size);
+                        if (!snapshot.read(address, data.data(), data.size())) {
+                            *readFailed = true;
+                            return;
+                        }
+
+                        if (searchPlaintext)
+                            *foundPlaintext = findXorPlaintext(data, address, plaintext, maxKeyLength, task);
+                        else
+                            *foundKey = analyzeXorKey(data, maxKeyLength, keyLength, task);
+                    }, [searchPlaintext, foundKey, foundPlaintext, readFailed] {
+                        if (*readFailed) {
+                            analysisError = "Data changed before it could be read";
+                        } else if (searchPlaintext) {
+                            plaintextResult = foundPlaintext;
+                            if (foundPlaintext->matches.empty())
+                                analysisError = "Plaintext not found under any key";
+                            else if (foundPlaintext->truncated)
+                                analysisError = "Too many matches, only the first ones are shown";
+                        } else {
+                            analysis = foundKey;
+                            coincidence.assign(foundKey->coincidence.begin(), foundKey->coincidence.end());
+                        }
+                    });
+            };
+
+            if (analyzing) {
+                ImGui::ProgressBar(analysisTask->getProgress(), ImVec2(300, 0));
+                ImGui::SameLine();
+                if (ImGui::Button("Cancel"))
+                    analysisTask->cancel();
+            } else {
+                if (ImGui::Button("Recover key"))
+                    startAnalysis(false);
+                ImGui::SameLine();
+                if (ImGui::Button("Search plaintext"))
+                    startAnalysis(true);
+            }
+
+            if (!analysisError.empty())
+                ImGui::TextUnformatted(analysisError.c_str());
+
+            if (!coincidence.empty()) {
+                ImGui::NewLine();
+                ImGui::TextUnformatted("Coincidence by shift");
+                ImGui::PlotHistogram("##coincidence", coincidence.data(), coincidence.size(), 0, nullptr, 0.0F, FLT_MAX, ImVec2(0, 100));
+                ImGui::Text("Estimated key length: %zu", analysis->keyLength);
+
+                for (const auto &candidate : analysis->keys) {
+                    const auto key = formatKey(candidate.key);
+                    ImGui::Text("%s key (%.1f%%): %s", candidate.assumedPlaintext == 0x00 ? "Binary" : "Text", candidate.confidence * 100, key.c_str());
+                }
+            }
+
+            if (!plaintextResult->matches.empty() && ImGui::BeginTable("##xormatches", 3, ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg, ImVec2(0, 300))) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Address");
+                ImGui::TableSetupColumn("Key length");
+                ImGui::TableSetupColumn("Key");
+                ImGui::TableHeadersRow();
+
+                ImGuiListClipper clipper;
+                clipper.Begin(plaintextResult->matches.size());
+                while (clipper.Step()) {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                        const auto &match = plaintextResult->matches[i];
+
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::PushID(i);
+                        if (ImGui::Selectable(hex::format("0x%08llX", match.address).c_str(), false, ImGuiSelectableFlags_SpanAllColumns))
+                            EventManager::post(Events::SelectionChangeRequest, Region { match.address, 1 });
+                        ImGui::PopID();
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%zu", match.key.size());
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(formatKey(match.key).c_str());
+                    }
+                }
+                clipper.End();
+
+                ImGui::EndTable();
+            }
+        }
     }
 
     void registerToolEntries() {
@@ -293,6 +749,9 @@ namespace hex::plugin::builtin {
         ContentRegistry::Tools::add("Regex replacer",           drawRegexReplacer);
         ContentRegistry::Tools::add("Color picker",             drawColorPicker);
         ContentRegistry::Tools::add("Calculator",               drawMathEvaluator);
+        ContentRegistry::Tools::add("CRC parameter search",     drawCrcSearch);
+        ContentRegistry::Tools::add("Checksum locator",         drawChecksumLocator);
+        ContentRegistry::Tools::add("XOR key recovery",         drawXorAnalysis);
     }
 
 }
\ No newline at end of file
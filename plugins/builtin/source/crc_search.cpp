@@ -0,0 +1,195 @@
+#include "crc_search.hpp"
+
+#include <hex/api/task.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <tuple>
+
+namespace hex {
+
+    namespace {
+
+        constexpr std::array<u32, 8> CommonPolynomials8 = { 0x07, 0x1D, 0x2F, 0x31, 0x39, 0x49, 0x9B, 0xD5 };
+        constexpr std::array<u32, 10> CommonPolynomials16 = { 0x0589, 0x1021, 0x3D65, 0x5935, 0x6F63, 0x755B, 0x8005, 0x8BB7, 0xA097, 0xC867 };
+        constexpr std::array<u32, 7> CommonPolynomials32 = { 0x04C11DB7, 0x1EDC6F41, 0x32583499, 0x741B8CD7, 0x814141AB, 0xA833982B, 0x000000AF };
+
+        u32 reflect(u32 value, u8 width) {
+            u32 result = 0;
+            for (u8 i = 0; i < width; i++, value >>= 1)
+                result = (result << 1) | (value & 1);
+
+            return result;
+        }
+
+        CrcEngine::Operator multiply(const CrcEngine::Operator &left, const CrcEngine::Operator &right) {
+            CrcEngine::Operator result;
+            for (u8 bit = 0; bit < 32; bit++)
+                result[bit] = CrcEngine::apply(left, right[bit]);
+
+            return result;
+        }
+
+    }
+
+    CrcEngine::CrcEngine(u8 width, u32 polynomial, bool reflected) : m_width(width), m_reflected(reflected) {
+        auto &table = this->m_tables[0];
+
+        if (reflected) {
+            const u32 reflectedPolynomial = reflect(polynomial, width);
+
+            for (u32 i = 0; i < 256; i++) {
+                u32 crc = i;
+                for (u8 bit = 0; bit < 8; bit++)
+                    crc = (crc & 1) != 0 ? (crc >> 1) ^ reflectedPolynomial : crc >> 1;
+                table[i] = crc;
+            }
+
+            for (size_t k = 1; k < this->m_tables.size(); k++) {
+                for (u32 i = 0; i < 256; i++)
+                    this->m_tables[k][i] = (this->m_tables[k - 1][i] >> 8) ^ table[this->m_tables[k - 1][i] & 0xFF];
+            }
+        } else {
+            const u32 alignedPolynomial = polynomial << (32 - width);
+
+            for (u32 i = 0; i < 256; i++) {
+                u32 crc = i << 24;
+                for (u8 bit = 0; bit < 8; bit++)
+                    crc = (crc & 0x8000'0000) != 0 ? (crc << 1) ^ alignedPolynomial : crc << 1;
+                table[i] = crc;
+            }
+
+            for (size_t k = 1; k < this->m_tables.size(); k++) {
+                for (u32 i = 0; i < 256; i++)
+                    this->m_tables[k][i] = (this->m_tables[k - 1][i] << 8) ^ table[this->m_tables[k - 1][i] >> 24];
+            }
+        }
+    }
+
+    u32 CrcEngine::process(u32 crc, const u8 *data, size_t size) const {
+        const auto &t = this->m_tables;
+
+        if (this->m_reflected) {
+            for (; size >= 8; data += 8, size -= 8) {
+                const u32 low  = crc ^ (u32(data[0]) | u32(data[1]) << 8 | u32(data[2]) << 16 | u32(data[3]) << 24);
+                const u32 high = u32(data[4]) | u32(data[5]) << 8 | u32(data[6]) << 16 | u32(data[7]) << 24;
+
+                crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+                      t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+            }
+        } else {
+            for (; size >= 8; data += 8, size -= 8) {
+                const u32 high = crc ^ (u32(data[0]) << 24 | u32(data[1]) << 16 | u32(data[2]) << 8 | u32(data[3]));
+                const u32 low  = u32(data[4]) << 24 | u32(data[5]) << 16 | u32(data[6]) << 8 | u32(data[7]);
+
+                crc = t[7][high >> 24] ^ t[6][(high >> 16) & 0xFF] ^ t[5][(high >> 8) & 0xFF] ^ t[4][high & 0xFF] ^
+                      t[3][low >> 24] ^ t[2][(low >> 16) & 0xFF] ^ t[1][(low >> 8) & 0xFF] ^ t[0][low & 0xFF];
+            }
+        }
+
+        for (; size > 0; data++, size--)
+            crc = this->step(crc, *data);
+
+        return crc;
+    }
+
+    u32 CrcEngine::toRegister(u32 value) const {
+        return this->m_reflected ? reflect(value, this->m_width) : value << (32 - this->m_width);
+    }
+
+    u32 CrcEngine::fromRegister(u32 crc, bool reflectOut) const {
+        const u32 value = this->m_reflected ? reflect(crc, this->m_width) : crc >> (32 - this->m_width);
+        return reflectOut ? reflect(value, this->m_width) : value;
+    }
+
+    CrcEngine::Operator CrcEngine::getZeroBytesOperator(u64 count) const {
+        Operator power, result;
+        for (u8 bit = 0; bit < 32; bit++) {
+            power[bit] = this->step(u32(1) << bit, 0x00);
+            result[bit] = u32(1) << bit;
+        }
+
+        for (; count != 0; count >>= 1) {
+            if ((count & 1) != 0)
+                result = multiply(power, result);
+            power = multiply(power, power);
+        }
+
+        return result;
+    }
+
+    u32 CrcEngine::apply(const Operator &op, u32 crc) {
+        u32 result = 0;
+        for (u8 bit = 0; crc != 0; bit++, crc >>= 1) {
+            if ((crc & 1) != 0)
+                result ^= op[bit];
+        }
+
+        return result;
+    }
+
+    std::span<const u32> getCommonCrcPolynomials(u8 width) {
+        switch (width) {
+            case 8:  return CommonPolynomials8;
+            case 16: return CommonPolynomials16;
+            case 32: return CommonPolynomials32;
+            default: return { };
+        }
+    }
+
+    u32 calculateCrc(const CrcParameters &parameters, std::span<const u8> data) {
+        CrcEngine engine(parameters.width, parameters.polynomial, parameters.reflectIn);
+
+        const u32 crc = engine.process(engine.toRegister(parameters.init), data.data(), data.size());
+        return engine.fromRegister(crc, parameters.reflectOut) ^ parameters.xorOut;
+    }
+
+    std::vector<CrcParameters> searchCrcParameters(std::span<const u8> data, u32 target, u8 width, std::span<const u32> polynomials,
+                                                   std::span<const u32> initValues, std::span<const u32> xorOutValues, Task &task) {
+        const u32 mask = width == 32 ? 0xFFFF'FFFF : (u32(1) << width) - 1;
+        const size_t combinationCount = polynomials.size() * 2;
+
+        std::vector<CrcParameters> results;
+        std::mutex resultMutex;
+        std::atomic<size_t> doneCombinations = 0;
+
+        auto searchCombination = [&](size_t combination) {
+            const u32 polynomial = polynomials[combination / 2] & mask;
+            const bool reflectIn = (combination % 2) != 0;
+
+            CrcEngine engine(width, polynomial, reflectIn);
+            const u32 dataCrc = engine.process(0, data.data(), data.size());
+            const auto zeroBytes = engine.getZeroBytesOperator(data.size());
+
+            for (const u32 init : initValues) {
+                const u32 crc = dataCrc ^ CrcEngine::apply(zeroBytes, engine.toRegister(init & mask));
+
+                for (const bool reflectOut : { false, true }) {
+                    const u32 value = engine.fromRegister(crc, reflectOut);
+
+                    for (const u32 xorOut : xorOutValues) {
+                        if ((value ^ (xorOut & mask)) != (target & mask))
+                            continue;
+
+                        std::scoped_lock lock(resultMutex);
+                        results.push_back({ width, polynomial, init & mask, xorOut & mask, reflectIn, reflectOut });
+                    }
+                }
+            }
+        };
+
+        TaskManager::parallelFor(task, combinationCount, [&](size_t combination) {
+            searchCombination(combination);
+            task.setProgress(float(++doneCombinations) / combinationCount);
+        });
+
+        std::sort(results.begin(), results.end(), [](const auto &left, const auto &right) {
+            return std::tie(left.polynomial, left.reflectIn, left.reflectOut, left.init, left.xorOut) < std::tie(right.polynomial, right.reflectIn, right.reflectOut, right.init, right.xorOut);
+        });
+
+        return results;
+    }
+
+}
@@ -0,0 +1,396 @@
+#include "decryptor.hpp"
+
+#include <hex/api/task.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define DECRYPTOR_AESNI
+    #include <immintrin.h>
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+    #define DECRYPTOR_ARMV8
+    #include <arm_neon.h>
+#endif
+
+namespace hex {
+
+    // Smallest amount of data that gets a thread of its own, below it starting threads costs more than they save
+    constexpr static size_t MinSliceSize = 0x4'0000;
+
+    constexpr static std::array<u8, 256> SBox = {
+        0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+        0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+        0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+        0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+        0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+        0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+        0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+        0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+        0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+        0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+        0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+        0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+        0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+        0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+        0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+        0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+    };
+
+    // FIPS-197 key expansion, returns the number of rounds
+    static u8 expandKey(std::span<const u8> key, std::array<u8, 15 * 16> &roundKeys) {
+        const size_t keyWords = key.size() / 4;
+        const u8 rounds = keyWords + 6;
+
+        std::memcpy(roundKeys.data(), key.data(), key.size());
+
+        u8 roundConstant = 0x01;
+        for (size_t i = keyWords; i < 4 * (rounds + 1); i++) {
+            std::array<u8, 4> word;
+            std::memcpy(word.data(), &roundKeys[(i - 1) * 4], 4);
+
+            if (i % keyWords == 0) {
+                word = { u8(SBox[word[1]] ^ roundConstant), SBox[word[2]], SBox[word[3]], SBox[word[0]] };
+                roundConstant = u8(roundConstant << 1) ^ ((roundConstant & 0x80) != 0 ? 0x1B : 0x00);
+            } else if (keyWords > 6 && i % keyWords == 4) {
+                for (auto &byte : word)
+                    byte = SBox[byte];
+            }
+
+            for (size_t j = 0; j < 4; j++)
+                roundKeys[i * 4 + j] = roundKeys[(i - keyWords) * 4 + j] ^ word[j];
+        }
+
+        return rounds;
+    }
+
+    // Splits count elements into slices of consecutive elements and calls the callback with the first element and size of each, spread over the workers
+    // of the task the calling thread works on. Slices don't get skipped if that task gets cancelled, the output is always complete
+    template<typename Callback>
+    static void forEachSlice(size_t count, size_t elementSize, Callback &&callback) {
+        const size_t sliceCount = std::max<size_t>(count * elementSize / MinSliceSize, 1);
+        if (sliceCount == 1) {
+            callback(0, count);
+            return;
+        }
+
+        const auto currentTask = TaskManager::getCurrentTask();
+        Task slices("Decrypting", currentTask != nullptr ? currentTask->getPriority() : TaskPriority::Interactive);
+
+        const size_t elementsPerSlice = (count + sliceCount - 1) / sliceCount;
+        TaskManager::parallelFor(slices, sliceCount, [&](size_t slice) {
+            const size_t first = std::min(count, slice * elementsPerSlice);
+            callback(first, std::min(count - first, elementsPerSlice));
+        });
+    }
+
+    static void xorBytes(u8 *data, const u8 *operand, size_t size) {
+        for (size_t i = 0; i < size; i++)
+            data[i] ^= operand[i];
+    }
+
+    // Adds to a 128 bit big endian counter, wrapping around like mbedtls does
+    static void addToCounter(std::array<u8, 16> &counter, u64 value) {
+        for (size_t i = counter.size(); i > 0 && value != 0; i--) {
+            const u64 sum = counter[i - 1] + (value & 0xFF);
+            counter[i - 1] = u8(sum);
+            value = (value >> 8) + (sum >> 8);
+        }
+    }
+
+    #if defined(DECRYPTOR_AESNI)
+
+    static bool hasAESNI() {
+        static const bool supported = __builtin_cpu_supports("aes");
+        return supported;
+    }
+
+    __attribute__((target("aes"))) static void invertRoundKeysAESNI(const u8 *roundKeys, u8 *inverseRoundKeys, u8 rounds) {
+        std::memcpy(inverseRoundKeys, roundKeys + rounds * 16, 16);
+        for (u8 round = 1; round < rounds; round++) {
+            const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + (rounds - round) * 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(inverseRoundKeys + round * 16), _mm_aesimc_si128(key));
+        }
+        std::memcpy(inverseRoundKeys + rounds * 16, roundKeys, 16);
+    }
+
+    // Four blocks are in flight at once to hide the latency of the round instructions
+    template<bool Decrypt>
+    __attribute__((target("aes"))) static void cryptBlocksAESNI(const u8 *roundKeys, u8 rounds, const u8 *input, u8 *output, size_t count) {
+        __m128i keys[15];
+        for (u8 round = 0; round <= rounds; round++)
+            keys[round] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + round * 16));
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i blocks[4];
+            for (size_t j = 0; j < 4; j++)
+                blocks[j] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + (i + j) * 16)), keys[0]);
+
+            for (u8 r = 1; r < rounds; r++) {
+                for (auto &block : blocks)
+                    block = Decrypt ? _mm_aesdec_si128(block, keys[r]) : _mm_aesenc_si128(block, keys[r]);
+            }
+
+            for (size_t j = 0; j < 4; j++)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + (i + j) * 16), Decrypt ? _mm_aesdeclast_si128(blocks[j], keys[rounds]) : _mm_aesenclast_si128(blocks[j], keys[rounds]));
+        }
+
+        for (; i < count; i++) {
+            __m128i block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i * 16)), keys[0]);
+            for (u8 r = 1; r < rounds; r++)
+                block = Decrypt ? _mm_aesdec_si128(block, keys[r]) : _mm_aesenc_si128(block, keys[r]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i * 16), Decrypt ? _mm_aesdeclast_si128(block, keys[rounds]) : _mm_aesenclast_si128(block, keys[rounds]));
+        }
+    }
+
+    #elif defined(DECRYPTOR_ARMV8)
+
+    static void invertRoundKeysARMv8(const u8 *roundKeys, u8 *inverseRoundKeys, u8 rounds) {
+        vst1q_u8(inverseRoundKeys, vld1q_u8(roundKeys + rounds * 16));
+        for (u8 round = 1; round < rounds; round++)
+            vst1q_u8(inverseRoundKeys + round * 16, vaesimcq_u8(vld1q_u8(roundKeys + (rounds - round) * 16)));
+        vst1q_u8(inverseRoundKeys + rounds * 16, vld1q_u8(roundKeys));
+    }
+
+    // AESE and AESD add the round key before substituting, so the last key gets added on its own
+    template<bool Decrypt>
+    static void cryptBlocksARMv8(const u8 *roundKeys, u8 rounds, const u8 *input, u8 *output, size_t count) {
+        uint8x16_t keys[15];
+        for (u8 round = 0; round <= rounds; round++)
+            keys[round] = vld1q_u8(roundKeys + round * 16);
+
+        for (size_t i = 0; i < count; i++) {
+            uint8x16_t block = vld1q_u8(input + i * 16);
+
+            for (u8 r = 0; r < rounds - 1; r++)
+                block = Decrypt ? vaesimcq_u8(vaesdq_u8(block, keys[r])) : vaesmcq_u8(vaeseq_u8(block, keys[r]));
+            block = Decrypt ? vaesdq_u8(block, keys[rounds - 1]) : vaeseq_u8(block, keys[rounds - 1]);
+
+            vst1q_u8(output + i * 16, veorq_u8(block, keys[rounds]));
+        }
+    }
+
+    #endif
+
+    static u32 rotateLeft(u32 value, u32 amount) {
+        return (value << amount) | (value >> (32 - amount));
+    }
+
+    static void chachaQuarterRound(std::array<u32, 16> &x, size_t a, size_t b, size_t c, size_t d) {
+        x[a] += x[b]; x[d] = rotateLeft(x[d] ^ x[a], 16);
+        x[c] += x[d]; x[b] = rotateLeft(x[b] ^ x[c], 12);
+        x[a] += x[b]; x[d] = rotateLeft(x[d] ^ x[a], 8);
+        x[c] += x[d]; x[b] = rotateLeft(x[b] ^ x[c], 7);
+    }
+
+    // RFC 8439 block function, writes 64 bytes of keystream
+    static void chachaBlock(const std::array<u32, 16> &state, u8 *output) {
+        auto x = state;
+
+        for (u8 i = 0; i < 10; i++) {
+            chachaQuarterRound(x, 0, 4,  8, 12);
+            chachaQuarterRound(x, 1, 5,  9, 13);
+            chachaQuarterRound(x, 2, 6, 10, 14);
+            chachaQuarterRound(x, 3, 7, 11, 15);
+            chachaQuarterRound(x, 0, 5, 10, 15);
+            chachaQuarterRound(x, 1, 6, 11, 12);
+            chachaQuarterRound(x, 2, 7,  8, 13);
+            chachaQuarterRound(x, 3, 4,  9, 14);
+        }
+
+        for (size_t i = 0; i < 16; i++) {
+            const u32 word = x[i] + state[i];
+            for (size_t j = 0; j < 4; j++)
+                output[i * 4 + j] = u8(word >> (j * 8));
+        }
+    }
+
+    static u32 readLittleEndian32(const u8 *data) {
+        return u32(data[0]) | (u32(data[1]) << 8) | (u32(data[2]) << 16) | (u32(data[3]) << 24);
+    }
+
+    Decryptor::Decryptor() {
+        mbedtls_aes_init(&this->m_encryptContext);
+        mbedtls_aes_init(&this->m_decryptContext);
+    }
+
+    Decryptor::~Decryptor() {
+        mbedtls_aes_free(&this->m_encryptContext);
+        mbedtls_aes_free(&this->m_decryptContext);
+    }
+
+    const char* Decryptor::init(CipherMode mode, std::span<const u8> key, std::span<const u8> iv) {
+        this->m_mode = mode;
+        this->m_keystreamPosition = this->getKeystreamBlockSize();
+
+        if (mode == CipherMode::ChaCha20) {
+            if (key.size() != 32)
+                return "Key needs to be 256 bits";
+            if (iv.size() != 12 && iv.size() != 16)
+                return "Nonce needs to be 96 or 128 bits";
+
+            // "expand 32-byte k"
+            this->m_chachaState = { 0x6170'7865, 0x3320'646E, 0x7962'2D32, 0x6B20'6574 };
+            for (size_t i = 0; i < 8; i++)
+                this->m_chachaState[4 + i] = readLittleEndian32(key.data() + i * 4);
+
+            const size_t nonceOffset = iv.size() - 12;
+            this->m_chachaState[12] = nonceOffset == 0 ? 0 : readLittleEndian32(iv.data());
+            for (size_t i = 0; i < 3; i++)
+                this->m_chachaState[13 + i] = readLittleEndian32(iv.data() + nonceOffset + i * 4);
+
+            return nullptr;
+        }
+
+        if (key.size() != 16 && key.size() != 24 && key.size() != 32)
+            return "Key needs to be 128, 192 or 256 bits";
+        if (mode != CipherMode::AES_ECB && iv.size() != this->m_iv.size())
+            return "IV needs to be 128 bits";
+
+        if (mode != CipherMode::AES_ECB)
+            std::copy(iv.begin(), iv.end(), this->m_iv.begin());
+
+        this->m_backend = Backend::MbedTLS;
+
+        #if defined(DECRYPTOR_AESNI)
+        if (hasAESNI()) {
+            this->m_rounds = expandKey(key, this->m_roundKeys);
+            invertRoundKeysAESNI(this->m_roundKeys.data(), this->m_inverseRoundKeys.data(), this->m_rounds);
+            this->m_backend = Backend::AESNI;
+        }
+        #elif defined(DECRYPTOR_ARMV8)
+        this->m_rounds = expandKey(key, this->m_roundKeys);
+        invertRoundKeysARMv8(this->m_roundKeys.data(), this->m_inverseRoundKeys.data(), this->m_rounds);
+        this->m_backend = Backend::ARMv8;
+        #endif
+
+        if (this->m_backend == Backend::MbedTLS) {
+            mbedtls_aes_setkey_enc(&this->m_encryptContext, key.data(), key.size() * 8);
+            mbedtls_aes_setkey_dec(&this->m_decryptContext, key.data(), key.size() * 8);
+        }
+
+        return nullptr;
+    }
+
+    void Decryptor::cryptBlocks(bool decrypt, const u8 *input, u8 *output, size_t count) const {
+        switch (this->m_backend) {
+            #if defined(DECRYPTOR_AESNI)
+            case Backend::AESNI:
+                if (decrypt)
+                    cryptBlocksAESNI<true>(this->m_inverseRoundKeys.data(), this->m_rounds, input, output, count);
+                else
+                    cryptBlocksAESNI<false>(this->m_roundKeys.data(), this->m_rounds, input, output, count);
+                return;
+            #elif defined(DECRYPTOR_ARMV8)
+            case Backend::ARMv8:
+                if (decrypt)
+                    cryptBlocksARMv8<true>(this->m_inverseRoundKeys.data(), this->m_rounds, input, output, count);
+                else
+                    cryptBlocksARMv8<false>(this->m_roundKeys.data(), this->m_rounds, input, output, count);
+                return;
+            #endif
+            default: {
+                // Crypting a block only reads the context, so all threads can share it
+                auto context = const_cast<mbedtls_aes_context*>(decrypt ? &this->m_decryptContext : &this->m_encryptContext);
+                for (size_t i = 0; i < count; i++)
+                    mbedtls_aes_crypt_ecb(context, decrypt ? MBEDTLS_AES_DECRYPT : MBEDTLS_AES_ENCRYPT, input + i * 16, output + i * 16);
+                return;
+            }
+        }
+    }
+
+    void Decryptor::generateKeystream(u64 firstBlock, u8 *output, size_t count) const {
+        if (this->m_mode == CipherMode::ChaCha20) {
+            auto state = this->m_chachaState;
+            state[12] += u32(firstBlock);
+
+            for (size_t i = 0; i < count; i++, state[12]++)
+                chachaBlock(state, output + i * 64);
+        } else {
+            // CTR encrypts consecutive counter blocks
+            auto counter = this->m_iv;
+            addToCounter(counter, firstBlock);
+
+            for (size_t i = 0; i < count; i++) {
+                std::memcpy(output + i * 16, counter.data(), counter.size());
+                addToCounter(counter, 1);
+            }
+
+            this->cryptBlocks(false, output, output, count);
+        }
+    }
+
+    void Decryptor::advanceCounter(u64 blocks) {
+        if (this->m_mode == CipherMode::ChaCha20)
+            this->m_chachaState[12] += u32(blocks);
+        else
+            addToCounter(this->m_iv, blocks);
+    }
+
+    size_t Decryptor::decrypt(const u8 *input, u8 *output, size_t size) {
+        switch (this->m_mode) {
+            case CipherMode::AES_ECB: {
+                const size_t blocks = size / 16;
+
+                forEachSlice(blocks, 16, [&, this](size_t first, size_t count) {
+                    this->cryptBlocks(true, input + first * 16, output + first * 16, count);
+                });
+
+                return blocks * 16;
+            }
+            case CipherMode::AES_CBC: {
+                const size_t blocks = size / 16;
+                if (blocks == 0)
+                    return 0;
+
+                // Every block gets combined with the ciphertext block before it, which is still there as the input isn't overwritten
+                forEachSlice(blocks, 16, [&, this](size_t first, size_t count) {
+                    this->cryptBlocks(true, input + first * 16, output + first * 16, count);
+
+                    for (size_t i = first; i < first + count; i++)
+                        xorBytes(output + i * 16, i == 0 ? this->m_iv.data() : input + (i - 1) * 16, 16);
+                });
+
+                std::memcpy(this->m_iv.data(), input + (blocks - 1) * 16, 16);
+
+                return blocks * 16;
+            }
+            case CipherMode::AES_CTR:
+            case CipherMode::ChaCha20: {
+                const size_t blockSize = this->getKeystreamBlockSize();
+
+                // Keystream left over from the previous chunk gets used up first
+                size_t offset = 0;
+                for (; offset < size && this->m_keystreamPosition < blockSize; offset++)
+                    output[offset] = input[offset] ^ this->m_keystream[this->m_keystreamPosition++];
+
+                const size_t blocks = (size - offset) / blockSize;
+
+                forEachSlice(blocks, blockSize, [&, this](size_t first, size_t count) {
+                    u8 *sliceOutput = output + offset + first * blockSize;
+
+                    this->generateKeystream(first, sliceOutput, count);
+                    xorBytes(sliceOutput, input + offset + first * blockSize, count * blockSize);
+                });
+
+                this->advanceCounter(blocks);
+                offset += blocks * blockSize;
+
+                if (offset < size) {
+                    this->generateKeystream(0, this->m_keystream.data(), 1);
+                    this->advanceCounter(1);
+
+                    for (this->m_keystreamPosition = 0; offset < size; offset++)
+                        output[offset] = input[offset] ^ this->m_keystream[this->m_keystreamPosition++];
+                }
+
+                return size;
+            }
+        }
+
+        return 0;
+    }
+
+}
@@ -1,5 +1,6 @@
 #include "math_evaluator.hpp"
 
+#include <algorithm>
 #include <string>
 #include <queue>
 #include <stack>
@@ -116,14 +117,7 @@ namespace hex {
                             else if (expression == "")
                                 break;
 
-                            auto inputQueue = parseInput(expression.c_str());
-                            auto postfixTokens = toPostfix(inputQueue);
-                            auto result = evaluate(postfixTokens);
-
-                            if (!result.has_value())
-                                throw std::invalid_argument("Invalid argument for function!");
-
-                            token.arguments.push_back(result.value());
+                            token.arguments.push_back(expression);
                         }
 
                         token.type = TokenType::Function;
@@ -198,157 +192,273 @@ namespace hex {
         return outputQueue;
     }
 
-    std::optional<long double> MathEvaluator::evaluate(std::queue<Token> postfixTokens) {
-        std::stack<long double> evaluationStack;
+    static bool canBeUnary(Operator op) {
+        return op == Operator::Addition || op == Operator::Subtraction || op == Operator::Not || op == Operator::BitwiseNot;
+    }
+
+    static long double applyOperator(Operator op, long double leftOperand, long double rightOperand) {
+        long double result = std::numeric_limits<long double>::quiet_NaN();
+        switch (op) {
+            default:
+            case Operator::Invalid:
+                throw std::invalid_argument("Invalid operator!");
+            case Operator::And:
+                result = static_cast<s64>(leftOperand) && static_cast<s64>(rightOperand);
+                break;
+            case Operator::Or:
+                result = static_cast<s64>(leftOperand) && static_cast<s64>(rightOperand);
+                break;
+            case Operator::Xor:
+                result = (static_cast<s64>(leftOperand) ^ static_cast<s64>(rightOperand)) > 0;
+                break;
+            case Operator::GreaterThan:
+                result = leftOperand > rightOperand;
+                break;
+            case Operator::LessThan:
+                result = leftOperand < rightOperand;
+                break;
+            case Operator::GreaterThanOrEquals:
+                result = leftOperand >= rightOperand;
+                break;
+            case Operator::LessThanOrEquals:
+                result = leftOperand <= rightOperand;
+                break;
+            case Operator::Equals:
+                result = leftOperand == rightOperand;
+                break;
+            case Operator::NotEquals:
+                result = leftOperand != rightOperand;
+                break;
+            case Operator::Not:
+                result = !static_cast<s64>(rightOperand);
+                break;
+            case Operator::BitwiseOr:
+                result = static_cast<s64>(leftOperand) | static_cast<s64>(rightOperand);
+                break;
+            case Operator::BitwiseXor:
+                result = static_cast<s64>(leftOperand) ^ static_cast<s64>(rightOperand);
+                break;
+            case Operator::BitwiseAnd:
+                result = static_cast<s64>(leftOperand) & static_cast<s64>(rightOperand);
+                break;
+            case Operator::BitwiseNot:
+                result = ~static_cast<s64>(rightOperand);
+                break;
+            case Operator::ShiftLeft:
+                result = static_cast<s64>(leftOperand) << static_cast<s64>(rightOperand);
+                break;
+            case Operator::ShiftRight:
+                result = static_cast<s64>(leftOperand) >> static_cast<s64>(rightOperand);
+                break;
+            case Operator::Addition:
+                result = leftOperand + rightOperand;
+                break;
+            case Operator::Subtraction:
+                result = leftOperand - rightOperand;
+                break;
+            case Operator::Multiplication:
+                result = leftOperand * rightOperand;
+                break;
+            case Operator::Division:
+                result = leftOperand / rightOperand;
+                break;
+            case Operator::Modulus:
+                result = std::fmod(leftOperand, rightOperand);
+                break;
+            case Operator::Exponentiation:
+                result = std::pow(leftOperand, rightOperand);
+                break;
+            case Operator::Combine:
+                result = (static_cast<u64>(leftOperand) << (64 - __builtin_clzll(static_cast<u64>(rightOperand)))) | static_cast<u64>(rightOperand);
+                break;
+        }
+
+        return result;
+    }
+
+    size_t MathEvaluator::compile(std::queue<Token> postfixTokens, Program &program, size_t stackBase) {
+        size_t stackSize = 0;
+
+        auto pushValue = [&] {
+            stackSize++;
+            program.m_maxStackSize = std::max(program.m_maxStackSize, stackBase + stackSize);
+        };
 
         while (!postfixTokens.empty()) {
             auto front = postfixTokens.front();
             postfixTokens.pop();
 
-            if (front.type == TokenType::Number)
-                evaluationStack.push(front.number);
-            else if (front.type == TokenType::Operator) {
-                long double rightOperand, leftOperand;
-                if (evaluationStack.size() < 2) {
-                    if ((front.op == Operator::Addition || front.op == Operator::Subtraction || front.op == Operator::Not || front.op == Operator::BitwiseNot) && evaluationStack.size() == 1) {
-                        rightOperand = evaluationStack.top(); evaluationStack.pop();
-                        leftOperand = 0;
-                    }
-                    else throw std::invalid_argument("Not enough operands for operator!");
-                } else {
-                    rightOperand = evaluationStack.top(); evaluationStack.pop();
-                    leftOperand = evaluationStack.top(); evaluationStack.pop();
-                }
+            if (front.type == TokenType::Number) {
+                program.m_instructions.push_back({ .type = Program::InstructionType::Push, .value = front.number });
+                pushValue();
+            } else if (front.type == TokenType::Operator) {
+                if (front.op == Operator::Invalid)
+                    throw std::invalid_argument("Invalid operator!");
 
-                long double result = std::numeric_limits<long double>::quiet_NaN();
-                switch (front.op) {
-                    default:
-                    case Operator::Invalid:
-                        throw std::invalid_argument("Invalid operator!");
-                    case Operator::And:
-                        result = static_cast<s64>(leftOperand) && static_cast<s64>(rightOperand);
-                        break;
-                    case Operator::Or:
-                        result = static_cast<s64>(leftOperand) && static_cast<s64>(rightOperand);
-                        break;
-                    case Operator::Xor:
-                        result = (static_cast<s64>(leftOperand) ^ static_cast<s64>(rightOperand)) > 0;
-                        break;
-                    case Operator::GreaterThan:
-                        result = leftOperand > rightOperand;
-                        break;
-                    case Operator::LessThan:
-                        result = leftOperand < rightOperand;
-                        break;
-                    case Operator::GreaterThanOrEquals:
-                        result = leftOperand >= rightOperand;
-                        break;
-                    case Operator::LessThanOrEquals:
-                        result = leftOperand <= rightOperand;
-                        break;
-                    case Operator::Equals:
-                        result = leftOperand == rightOperand;
-                        break;
-                    case Operator::NotEquals:
-                        result = leftOperand != rightOperand;
-                        break;
-                    case Operator::Not:
-                        result = !static_cast<s64>(rightOperand);
-                        break;
-                    case Operator::BitwiseOr:
-                        result = static_cast<s64>(leftOperand) | static_cast<s64>(rightOperand);
-                        break;
-                    case Operator::BitwiseXor:
-                        result = static_cast<s64>(leftOperand) ^ static_cast<s64>(rightOperand);
-                        break;
-                    case Operator::BitwiseAnd:
-                        result = static_cast<s64>(leftOperand) & static_cast<s64>(rightOperand);
-                        break;
-                    case Operator::BitwiseNot:
-                        result = ~static_cast<s64>(rightOperand);
-                        break;
-                    case Operator::ShiftLeft:
-                        result = static_cast<s64>(leftOperand) << static_cast<s64>(rightOperand);
-                        break;
-                    case Operator::ShiftRight:
-                        result = static_cast<s64>(leftOperand) >> static_cast<s64>(rightOperand);
-                        break;
-                    case Operator::Addition:
-                        result = leftOperand + rightOperand;
-                        break;
-                    case Operator::Subtraction:
-                        result = leftOperand - rightOperand;
-                        break;
-                    case Operator::Multiplication:
-                        result = leftOperand * rightOperand;
-                        break;
-                    case Operator::Division:
-                        result = leftOperand / rightOperand;
-                        break;
-                    case Operator::Modulus:
-                        result = std::fmod(leftOperand, rightOperand);
-                        break;
-                    case Operator::Exponentiation:
-                        result = std::pow(leftOperand, rightOperand);
-                        break;
-                    case Operator::Combine:
-                        result = (static_cast<u64>(leftOperand) << (64 - __builtin_clzll(static_cast<u64>(rightOperand)))) | static_cast<u64>(rightOperand);
-                        break;
-                }
+                if (stackSize >= 2)
+                    stackSize--;
+                else if (!canBeUnary(front.op) || stackSize != 1)
+                    throw std::invalid_argument("Not enough operands for operator!");
 
-                evaluationStack.push(result);
+                program.m_instructions.push_back({ .type = Program::InstructionType::Operator, .op = front.op });
             } else if (front.type == TokenType::Variable) {
-                if (this->m_variables.contains(front.name))
-                    evaluationStack.push(this->m_variables.at(front.name));
-                else
-                    throw std::invalid_argument("Unknown variable!");
+                auto variable = std::find(program.m_variables.begin(), program.m_variables.end(), front.name);
+                if (variable == program.m_variables.end())
+                    variable = program.m_variables.insert(program.m_variables.end(), front.name);
+
+                program.m_instructions.push_back({ .type = Program::InstructionType::Load, .index = u32(variable - program.m_variables.begin()) });
+                pushValue();
             } else if (front.type == TokenType::Function) {
-                if (!this->m_functions[front.name])
+                auto function = this->m_functions.find(front.name);
+                if (function == this->m_functions.end() || !function->second)
                     throw std::invalid_argument("Unknown function called!");
 
-                auto result = this->m_functions[front.name](front.arguments);
+                // Arguments end up on the stack in order, right below where the result goes
+                for (const auto &argument : front.arguments) {
+                    auto valueCount = this->compile(this->toPostfix(this->parseInput(argument.c_str())), program, stackBase + stackSize);
 
-                if (result.has_value())
-                    evaluationStack.push(result.value());
+                    if (valueCount == 0)
+                        throw std::invalid_argument("Invalid argument for function!");
+                    else if (valueCount > 1)
+                        throw std::invalid_argument("Undigested input left!");
+
+                    pushValue();
+                }
+
+                program.m_functions.push_back(&function->second);
+                program.m_instructions.push_back({ .type = Program::InstructionType::Call, .index = u32(program.m_functions.size() - 1), .argumentCount = u32(front.arguments.size()) });
+
+                stackSize -= front.arguments.size();
+                pushValue();
             } else
                 throw std::invalid_argument("Parenthesis in postfix expression!");
-
         }
 
-        if (evaluationStack.empty())
-            return { };
-        else if (evaluationStack.size() > 1)
-            throw std::invalid_argument("Undigested input left!");
-        else
-            return evaluationStack.top();
+        return stackSize;
     }
 
-
-    std::optional<long double> MathEvaluator::evaluate(std::string input) {
+    MathEvaluator::Program MathEvaluator::compile(const std::string &input) {
         auto inputQueue = parseInput(input.c_str());
 
-        std::string resultVariable = "ans";
+        Program program;
 
-        {
+        if (inputQueue.size() >= 2) {
             std::queue<Token> queueCopy = inputQueue;
             if (queueCopy.front().type == TokenType::Variable) {
-                resultVariable = queueCopy.front().name;
+                auto resultVariable = queueCopy.front().name;
                 queueCopy.pop();
-                if (queueCopy.front().type != TokenType::Operator || queueCopy.front().op != Operator::Assign)
-                    resultVariable = "ans";
-                else {
+                if (queueCopy.front().type == TokenType::Operator && queueCopy.front().op == Operator::Assign) {
+                    program.m_resultVariable = resultVariable;
                     inputQueue.pop();
                     inputQueue.pop();
                 }
             }
         }
 
-        auto postfixTokens = toPostfix(inputQueue);
+        if (this->compile(toPostfix(inputQueue), program, 0) > 1)
+            throw std::invalid_argument("Undigested input left!");
+
+        return program;
+    }
+
+    std::vector<long double> MathEvaluator::getVariableValues(const Program &program, const std::string &ignoredVariable) {
+        std::vector<long double> values;
+        values.reserve(program.m_variables.size());
+
+        for (const auto &name : program.m_variables) {
+            if (name == ignoredVariable)
+                values.push_back(0);
+            else if (auto variable = this->m_variables.find(name); variable != this->m_variables.end())
+                values.push_back(variable->second);
+            else
+                throw std::invalid_argument("Unknown variable!");
+        }
+
+        return values;
+    }
+
+    std::optional<long double> MathEvaluator::run(const Program &program, const std::vector<long double> &variables, std::vector<long double> &stack) {
+        size_t stackSize = 0;
+
+        for (const auto &instruction : program.m_instructions) {
+            switch (instruction.type) {
+                case Program::InstructionType::Push:
+                    stack[stackSize++] = instruction.value;
+                    break;
+                case Program::InstructionType::Load:
+                    stack[stackSize++] = variables[instruction.index];
+                    break;
+                case Program::InstructionType::Call: {
+                    // Functions may not return anything, so the stack can hold less than what the program was compiled for
+                    if (stackSize < instruction.argumentCount)
+                        throw std::invalid_argument("Invalid argument for function!");
+
+                    stackSize -= instruction.argumentCount;
+                    auto result = (*program.m_functions[instruction.index])(std::vector<long double>(stack.begin() + stackSize, stack.begin() + stackSize + instruction.argumentCount));
+
+                    if (result.has_value())
+                        stack[stackSize++] = result.value();
+                    break;
+                }
+                case Program::InstructionType::Operator: {
+                    long double rightOperand, leftOperand;
+                    if (stackSize < 2) {
+                        if (canBeUnary(instruction.op) && stackSize == 1) {
+                            rightOperand = stack[--stackSize];
+                            leftOperand = 0;
+                        }
+                        else throw std::invalid_argument("Not enough operands for operator!");
+                    } else {
+                        rightOperand = stack[--stackSize];
+                        leftOperand = stack[--stackSize];
+                    }
+
+                    stack[stackSize++] = applyOperator(instruction.op, leftOperand, rightOperand);
+                    break;
+                }
+            }
+        }
+
+        if (stackSize == 0)
+            return { };
+        else if (stackSize > 1)
+            throw std::invalid_argument("Undigested input left!");
+        else
+            return stack[0];
+    }
+
+    std::optional<long double> MathEvaluator::evaluate(const Program &program) {
+        std::vector<long double> stack(program.m_maxStackSize);
+
+        return this->run(program, this->getVariableValues(program), stack);
+    }
+
+    std::vector<std::optional<long double>> MathEvaluator::evaluate(const Program &program, const std::string &variable, const std::vector<long double> &values) {
+        auto variables = this->getVariableValues(program, variable);
+        std::vector<long double> stack(program.m_maxStackSize);
+
+        auto slot = std::find(program.m_variables.begin(), program.m_variables.end(), variable);
+
+        std::vector<std::optional<long double>> results;
+        results.reserve(values.size());
+
+        for (long double value : values) {
+            if (slot != program.m_variables.end())
+                variables[slot - program.m_variables.begin()] = value;
+
+            results.push_back(this->run(program, variables, stack));
+        }
+
+        return results;
+    }
+
+    std::optional<long double> MathEvaluator::evaluate(std::string input) {
+        auto program = this->compile(input);
 
-        auto result = evaluate(postfixTokens);
+        auto result = this->evaluate(program);
 
         if (result.has_value()) {
-            this->setVariable(resultVariable, result.value());
+            this->setVariable(program.getResultVariable(), result.value());
         }
 
         return result;
@@ -358,7 +468,7 @@ namespace hex {
         this->m_variables[name] = value;
     }
 
-    void MathEvaluator::setFunction(std::string name, std::function<std::optional<long double>(std::vector<long double>)> function, size_t minNumArgs, size_t maxNumArgs) {
+    void MathEvaluator::setFunction(std::string name, Function function, size_t minNumArgs, size_t maxNumArgs) {
         this->m_functions[name] = [minNumArgs, maxNumArgs, function](auto args) {
             if (args.size() < minNumArgs || args.size() > maxNumArgs)
                 throw std::invalid_argument("Invalid number of function arguments!");
@@ -0,0 +1,296 @@
+#include "xor_analysis.hpp"
+
+#include <hex/api/task.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+    #define XOR_ANALYSIS_X86
+    #include <immintrin.h>
+#elif defined(__aarch64__)
+    #define XOR_ANALYSIS_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace hex {
+
+    namespace {
+
+        constexpr size_t MinSliceSize = 0x10'0000;
+        constexpr size_t MaxMatches = 0x1000;
+
+        // Share of the best shift's coincidence a shorter shift needs to be picked as the key length instead
+        constexpr double KeyLengthThreshold = 0.9;
+
+        size_t countEqualBytes(const u8 *a, const u8 *b, size_t size) {
+            size_t count = 0, i = 0;
+
+            #if defined(XOR_ANALYSIS_X86)
+
+                // Every equal byte subtracts -1 from its lane, the lanes get summed up before any of them can overflow
+                while (i + 16 <= size) {
+                    const size_t blockEnd = std::min(size, i + 255 * 16);
+
+                    __m128i counts = _mm_setzero_si128();
+                    for (; i + 16 <= blockEnd; i += 16) {
+                        const auto equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+                        counts = _mm_sub_epi8(counts, equal);
+                    }
+
+                    const auto sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+                    count += _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums));
+                }
+
+            #elif defined(XOR_ANALYSIS_NEON)
+
+                while (i + 16 <= size) {
+                    const size_t blockEnd = std::min(size, i + 255 * 16);
+
+                    uint8x16_t counts = vdupq_n_u8(0);
+                    for (; i + 16 <= blockEnd; i += 16)
+                        counts = vsubq_u8(counts, vceqq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+
+                    count += vaddlvq_u8(counts);
+                }
+
+            #endif
+
+            for (; i < size; i++)
+                count += a[i] == b[i];
+
+            return count;
+        }
+
+        /*
+         * Calls callback with every offset in [begin, end) at which the data XORed with itself a shift further matches the two expected bytes.
+         * The data needs to hold at least shift + 1 bytes past the end
+         */
+        template<typename T>
+        void findXorDifferences(const u8 *data, size_t begin, size_t end, size_t shift, u8 first, u8 second, T callback) {
+            size_t i = begin;
+
+            #if defined(XOR_ANALYSIS_X86)
+
+                const auto firstExpected = _mm_set1_epi8(first), secondExpected = _mm_set1_epi8(second);
+                for (; i + 16 <= end; i += 16) {
+                    const auto firstDifference  = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + shift)));
+                    const auto secondDifference = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + shift + 1)));
+
+                    u32 mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstDifference, firstExpected), _mm_cmpeq_epi8(secondDifference, secondExpected)));
+                    for (; mask != 0; mask &= mask - 1)
+                        callback(i + __builtin_ctz(mask));
+                }
+
+            #elif defined(XOR_ANALYSIS_NEON)
+
+                const auto firstExpected = vdupq_n_u8(first), secondExpected = vdupq_n_u8(second);
+                for (; i + 16 <= end; i += 16) {
+                    const auto firstDifference  = veorq_u8(vld1q_u8(data + i), vld1q_u8(data + i + shift));
+                    const auto secondDifference = veorq_u8(vld1q_u8(data + i + 1), vld1q_u8(data + i + shift + 1));
+
+                    // There's no cheap way to get a bit mask out of a vector, so the rare vectors with a match get checked again one by one
+                    if (vmaxvq_u8(vandq_u8(vceqq_u8(firstDifference, firstExpected), vceqq_u8(secondDifference, secondExpected))) == 0)
+                        continue;
+
+                    for (size_t j = i; j < i + 16; j++) {
+                        if ((data[j] ^ data[j + shift]) == first && (data[j + 1] ^ data[j + shift + 1]) == second)
+                            callback(j);
+                    }
+                }
+
+            #endif
+
+            for (; i < end; i++) {
+                if ((data[i] ^ data[i + shift]) == first && (data[i + 1] ^ data[i + shift + 1]) == second)
+                    callback(i);
+            }
+        }
+
+        // Weight of a byte when judging if it's text, spaces and lowercase letters make up most of it
+        u32 getTextWeight(u8 byte) {
+            if (byte == ' ' || (byte >= 'a' && byte <= 'z'))
+                return 2;
+            else if ((byte >= 0x21 && byte <= 0x7E) || byte == '\t' || byte == '\n' || byte == '\r')
+                return 1;
+            else
+                return 0;
+        }
+
+        bool isTextByte(u8 byte) {
+            return getTextWeight(byte) != 0;
+        }
+
+        // Length of the shortest key that repeated gives the key
+        size_t getKeyPeriod(std::span<const u8> key) {
+            for (size_t period = 1; period < key.size(); period++) {
+                if (key.size() % period != 0)
+                    continue;
+
+                bool repeats = true;
+                for (size_t i = period; i < key.size() && repeats; i++)
+                    repeats = key[i] == key[i - period];
+
+                if (repeats)
+                    return period;
+            }
+
+            return key.size();
+        }
+
+    }
+
+    XorKeyAnalysis analyzeXorKey(std::span<const u8> data, size_t maxKeyLength, size_t keyLength, Task &task) {
+        XorKeyAnalysis result;
+
+        // Shifts past half of the data compare too few bytes to mean anything
+        maxKeyLength = std::min(maxKeyLength, data.size() / 2);
+        result.coincidence.resize(maxKeyLength);
+
+        std::atomic<size_t> doneShifts = 0;
+
+        TaskManager::parallelFor(task, maxKeyLength, [&](size_t index) {
+            const size_t shift = index + 1;
+            const size_t compared = data.size() - shift;
+            result.coincidence[index] = double(countEqualBytes(data.data(), data.data() + shift, compared)) / compared;
+
+            task.setProgress(float(++doneShifts) / (maxKeyLength + 1));
+        });
+
+        if (task.isCancelled())
+            return result;
+
+        if (keyLength == 0 && !result.coincidence.empty()) {
+            const double best = *std::max_element(result.coincidence.begin(), result.coincidence.end());
+            keyLength = std::distance(result.coincidence.begin(), std::find_if(result.coincidence.begin(), result.coincidence.end(), [&](double coincidence) {
+                return coincidence >= best * KeyLengthThreshold;
+            })) + 1;
+        }
+
+        result.keyLength = std::min(keyLength, data.size());
+        if (result.keyLength == 0)
+            return result;
+
+        std::vector<std::array<u32, 256>> histograms(result.keyLength, std::array<u32, 256>{ 0 });
+        for (size_t i = 0, position = 0; i < data.size(); i++) {
+            histograms[position][data[i]]++;
+            position = position + 1 == result.keyLength ? 0 : position + 1;
+        }
+
+        XorKeyCandidate binaryKey = { { }, 0x00, 0 }, textKey = { { }, ' ', 0 };
+        for (size_t position = 0; position < result.keyLength; position++) {
+            const auto &histogram = histograms[position];
+            const size_t count = (data.size() - position + result.keyLength - 1) / result.keyLength;
+
+            const u8 mostCommon = std::distance(histogram.begin(), std::max_element(histogram.begin(), histogram.end()));
+            binaryKey.key.push_back(mostCommon ^ binaryKey.assumedPlaintext);
+            binaryKey.confidence += double(histogram[mostCommon]) / count;
+
+            // Instead of only looking at the most common byte, text keys are picked by how much of the data they turn into text
+            u32 bestWeight = 0;
+            u8 bestKey = mostCommon ^ textKey.assumedPlaintext;
+            for (u32 key = 0; key < 256; key++) {
+                u32 weight = 0;
+                for (u32 byte = 0; byte < 256; byte++)
+                    weight += histogram[byte] * getTextWeight(byte ^ key);
+
+                if (weight > bestWeight) {
+                    bestWeight = weight;
+                    bestKey = key;
+                }
+            }
+
+            u32 textBytes = 0;
+            for (u32 byte = 0; byte < 256; byte++)
+                textBytes += isTextByte(byte ^ bestKey) ? histogram[byte] : 0;
+
+            textKey.key.push_back(bestKey);
+            textKey.confidence += double(textBytes) / count;
+        }
+
+        binaryKey.confidence /= result.keyLength;
+        textKey.confidence /= result.keyLength;
+
+        // Plaintext can correlate more strongly at a multiple of the key length, in which case the recovered key repeats the real one
+        for (auto *candidate : { &binaryKey, &textKey })
+            candidate->key.resize(getKeyPeriod(candidate->key));
+
+        result.keys = { std::move(binaryKey), std::move(textKey) };
+
+        task.setProgress(1.0F);
+
+        return result;
+    }
+
+    XorPlaintextResult findXorPlaintext(std::span<const u8> data, u64 address, std::span<const u8> plaintext, size_t maxKeyLength, Task &task) {
+        XorPlaintextResult result;
+
+        const size_t plaintextSize = plaintext.size();
+        if (plaintextSize < 3 || data.size() < plaintextSize)
+            return result;
+
+        maxKeyLength = std::min(maxKeyLength, plaintextSize - 2);
+
+        // XOR of every plaintext byte with the one a key length before it, for every key length
+        std::vector<std::vector<u8>> differences(maxKeyLength + 1);
+        for (size_t keyLength = 1; keyLength <= maxKeyLength; keyLength++) {
+            for (size_t i = keyLength; i < plaintextSize; i++)
+                differences[keyLength].push_back(plaintext[i] ^ plaintext[i - keyLength]);
+        }
+
+        const size_t offsetCount = data.size() - plaintextSize + 1;
+        const size_t sliceCount = (offsetCount + MinSliceSize - 1) / MinSliceSize;
+
+        std::mutex matchMutex;
+        std::atomic<size_t> doneSlices = 0;
+        std::atomic<bool> full = false;
+
+        TaskManager::parallelFor<std::vector<XorPlaintextMatch>>(task, sliceCount, [&](size_t slice, std::vector<XorPlaintextMatch> &matches) {
+            if (full)
+                return;
+
+            const size_t begin = slice * MinSliceSize, end = std::min(begin + MinSliceSize, offsetCount);
+
+            for (size_t keyLength = 1; keyLength <= maxKeyLength; keyLength++) {
+                const auto &difference = differences[keyLength];
+
+                findXorDifferences(data.data(), begin, end, keyLength, difference[0], difference[1], [&](size_t offset) {
+                    for (size_t i = keyLength + 2; i < plaintextSize; i++) {
+                        if ((data[offset + i] ^ data[offset + i - keyLength]) != difference[i - keyLength])
+                            return;
+                    }
+
+                    std::vector<u8> key(keyLength);
+                    for (size_t i = 0; i < keyLength; i++)
+                        key[i] = data[offset + i] ^ plaintext[i];
+
+                    if (std::all_of(key.begin(), key.end(), [](u8 byte) { return byte == 0x00; }) || getKeyPeriod(key) != key.size())
+                        return;
+
+                    matches.push_back({ address + offset, std::move(key) });
+                });
+            }
+
+            std::scoped_lock lock(matchMutex);
+            const size_t count = std::min(matches.size(), MaxMatches - result.matches.size());
+            std::move(matches.begin(), matches.begin() + count, std::back_inserter(result.matches));
+            matches.clear();
+
+            if (result.matches.size() >= MaxMatches) {
+                result.truncated = true;
+                full = true;
+            }
+
+            task.setProgress(float(++doneSlices) / sliceCount);
+        });
+
+        std::sort(result.matches.begin(), result.matches.end(), [](const auto &left, const auto &right) {
+            return left.address != right.address ? left.address < right.address : left.key.size() < right.key.size();
+        });
+
+        return result;
+    }
+
+}
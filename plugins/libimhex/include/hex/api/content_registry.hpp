@@ -4,8 +4,11 @@
 
 #include <hex/helpers/utils.hpp>
 
+#include <any>
+#include <chrono>
 #include <functional>
 #include <map>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -18,6 +21,7 @@ namespace hex {
     namespace lang { class ASTNode; }
     namespace lang { class Evaluator; }
     namespace dp { class Node; }
+    namespace prv { class Provider; }
 
     /*
         The Content Registry is the heart of all features in ImHex that are in some way extendable by Plugins.
@@ -36,8 +40,23 @@ namespace hex {
                 std::function<bool(nlohmann::json&)> callback;
             };
 
+            // Carried by Events::SettingsChanged. Events without one may have changed every setting, like after loading them
+            struct Key {
+                std::string category, name;
+            };
+
+            // Changes get written to disk once they stopped coming in for this long
+            constexpr static auto StoreDelay = std::chrono::seconds(1);
+
             static void load();
             static void store();
+            // Main thread only. Writes the settings in the background once they didn't change for a while
+            static void storeLater();
+            // Called every frame, takes a snapshot of the settings once a delayed store is due
+            static void processPendingStore();
+
+            // Whether a Events::SettingsChanged concerns the given setting. Without a name all settings of the category match
+            [[nodiscard]] static bool changed(const std::any &userData, std::string_view category, std::string_view name = { });
 
             static void add(std::string_view category, std::string_view name, s64 defaultValue, const std::function<bool(nlohmann::json&)> &callback);
             static void add(std::string_view category, std::string_view name, std::string_view defaultValue, const std::function<bool(nlohmann::json&)> &callback);
@@ -77,6 +96,7 @@ namespace hex {
                 std::function<std::string(std::string)> callback;
             };
 
+            // The callback gets run on a worker thread, shortly after the input stopped changing
             static void add(Type type, std::string_view command, std::string_view description, const std::function<std::string(std::string)> &callback);
             static std::vector<Entry>& getEntries();
         };
@@ -92,10 +112,11 @@ namespace hex {
 
             struct Function {
                 u32 parameterCount;
-                std::function<hex::lang::ASTNode*(hex::lang::Evaluator&, std::vector<hex::lang::ASTNode*>)> func;
+                std::function<hex::lang::ASTNode*(hex::lang::Evaluator&, std::span<hex::lang::ASTNode*>)> func;
             };
 
-            static void add(std::string_view name, u32 parameterCount, const std::function<hex::lang::ASTNode*(hex::lang::Evaluator&, std::vector<hex::lang::ASTNode*>)> &func);
+            // Parameters are only valid for the duration of the call. Entries must not be removed, call sites keep pointers to them
+            static void add(std::string_view name, u32 parameterCount, const std::function<hex::lang::ASTNode*(hex::lang::Evaluator&, std::span<hex::lang::ASTNode*>)> &func);
             static std::map<std::string, ContentRegistry::PatternLanguageFunctions::Function>& getEntries();
         };
 
@@ -108,10 +129,17 @@ namespace hex {
                 return static_cast<T*>(add(new T(std::forward<Args>(args)...)));
             }
 
+            /* Adds a view that only gets constructed once it's opened for the first time. The name has to match the one of the view */
+            template<typename T, typename ... Args>
+            static void addDeferred(std::string name, Args ... args) {
+                addDeferred(std::move(name), [=]() -> View* { return new T(args...); });
+            }
+
             static std::vector<View*>& getEntries();
 
         private:
             static View* add(View *view);
+            static void addDeferred(std::string name, const std::function<View*()> &constructor);
 
 
         };
@@ -140,16 +168,22 @@ namespace hex {
                 Octal
             };
 
-            using DisplayFunction = std::function<void()>;
-            using GeneratorFunction = std::function<DisplayFunction(const std::vector<u8>&, std::endian, NumberDisplayStyle)>;
+            // Writes the text to display into value. The string is reused between refreshes, so assigning to it usually doesn't allocate
+            using GeneratorFunction = std::function<void(std::span<const u8> buffer, std::endian endian, NumberDisplayStyle style, std::string &value)>;
+            // Draws the entry every frame instead of displaying the generated text, for entries that aren't just text
+            using DisplayFunction = std::function<void(std::span<const u8> buffer, std::endian endian, const std::string &value)>;
+            // Decodes a whole run of values as numbers, entries that have one get statistics when a selection is inspected as a column of them
+            using ColumnFunction = std::function<void(std::span<const u8> data, std::endian endian, std::span<double> values)>;
 
             struct Entry {
                 std::string name;
                 size_t requiredSize;
                 GeneratorFunction generatorFunction;
+                DisplayFunction displayFunction;
+                ColumnFunction columnFunction;
             };
 
-            static void add(std::string_view name, size_t requiredSize, GeneratorFunction function);
+            static void add(std::string_view name, size_t requiredSize, GeneratorFunction generatorFunction, DisplayFunction displayFunction = { }, ColumnFunction columnFunction = { });
 
             static std::vector<Entry>& getEntries();
         };
@@ -164,7 +198,7 @@ namespace hex {
 
             template<hex::derived_from<dp::Node> T, typename ... Args>
             static void add(std::string_view category, std::string_view name, Args&& ... args) {
-                add(Entry{ category.data(), name.data(), [args...]{ return new T(std::forward<Args>(args)...); } });
+                add(Entry{ category.data(), name.data(), [args...]{ return new T(args...); } });
             }
 
             static void addSeparator();
@@ -173,6 +207,40 @@ namespace hex {
         private:
             static void add(const Entry &entry);
         };
+
+        /* Provider Registry. Allows adding of new providers that files can be opened with */
+        struct Providers {
+            Providers() = delete;
+
+            // Capabilities returned by Provider::getCapabilities, the core takes faster paths for providers that have them
+            constexpr static u32 NoCapabilities     = 0x0000'0000;
+            constexpr static u32 Mappable           = 0x0000'0001;  // All of the raw data is mapped, getResidentData never fails for a valid range
+            constexpr static u32 ChunkSpans         = 0x0000'0002;  // getResidentData hands out spans of at least some of the raw data
+            constexpr static u32 ThreadSafeReads    = 0x0000'0004;  // readRaw may be called from several threads at once, otherwise snapshot reads get serialized
+
+            // Whether the provider is able to open the path, checked before it gets created
+            using DetectorFunction = std::function<bool(const std::string &path)>;
+            using CreatorFunction = std::function<prv::Provider*(const std::string &path)>;
+
+            struct Entry {
+                std::string name;
+                DetectorFunction detectorFunction;
+                CreatorFunction creatorFunction;
+            };
+
+            template<hex::derived_from<prv::Provider> T>
+            static void add(std::string_view name, const DetectorFunction &detectorFunction) {
+                add(name, detectorFunction, [](const std::string &path) -> prv::Provider* { return new T(path); });
+            }
+
+            static void add(std::string_view name, const DetectorFunction &detectorFunction, const CreatorFunction &creatorFunction);
+
+            // Creates the provider for the path with the entry registered last that detects it, so plugins take precedence over the built-in providers.
+            // Returns nullptr if no entry detects the path. The provider may still not be available, e.g. if the file couldn't be opened
+            [[nodiscard]] static prv::Provider* create(const std::string &path);
+
+            static std::vector<Entry>& getEntries();
+        };
     };
 
 }
\ No newline at end of file
@@ -3,15 +3,18 @@
 #include <hex.hpp>
 
 #include <any>
+#include <atomic>
 #include <functional>
+#include <utility>
 #include <vector>
 
 namespace hex {
 
     enum class Events : u32 {
         FileLoaded,
-        DataChanged,
+        DataChanged,                // Carries the modified Region in absolute addresses if only a part of the data changed
         PatternChanged,
+        ProviderChanged,            // Carries the previously selected provider, nullptr if it was closed
         FileDropped,
         WindowClosing,
         RegionSelected,
@@ -29,21 +32,62 @@ namespace hex {
         OpenWindow,
         CloseImHex,
 
+        TaskFinished,
+        EntropyAnalysisChanged,     // Carries a std::shared_ptr<const EntropyPyramid> of the current data, nullptr if there's no analysis anymore
+        DataFingerprinted,          // Carries the provider whose data is now known to the PersistentAnalysisCache
+
         /* This is not a real event but a flag to show all events after this one are plugin ones */
         Events_BuiltinEnd
     };
 
     struct EventHandler {
         void *owner;
-        Events eventType;
         std::function<std::any(const std::any&)> callback;
     };
 
+    /*
+     * Handlers are kept per event type and may only be subscribed, unsubscribed and called on the main thread.
+     * Other threads post their events through postQueued(), they get delivered the next time the main thread processes the queue.
+     * Events that fire many times a frame can be posted through postCoalesced() instead, all posts of the same event until the queue
+     * gets processed are merged into a single delivery.
+     */
     class EventManager {
     public:
+        EventManager() = delete;
+
+        using Merger = std::function<std::any(const std::any &previous, const std::any &next)>;
+
         static std::vector<std::any> post(Events eventType, const std::any &userData);
+
+        // Same as post() but without collecting the handlers' results
+        static void notify(Events eventType, const std::any &userData = { });
+
+        // Safe to call from any thread, never blocks
+        static void postQueued(Events eventType, std::any userData = { });
+        static void processQueuedEvents();
+        [[nodiscard]] static bool hasQueuedEvents();
+
+        // Main thread only. Without a merger the payload of the latest post is delivered
+        static void postCoalesced(Events eventType, const std::any &userData = { }, const Merger &merge = { });
+
+        // Merges Region payloads into one covering both, an empty payload meaning everything changed wins over any region
+        static std::any mergeRegions(const std::any &previous, const std::any &next);
+
         static void subscribe(Events eventType, void *owner, std::function<std::any(const std::any&)> callback);
         static void unsubscribe(Events eventType, void *sender);
+
+    private:
+        struct QueuedEvent {
+            Events eventType;
+            std::any userData;
+            QueuedEvent *next;
+        };
+
+        // Posting threads push onto this stack, the main thread takes the whole stack at once and delivers it in posting order
+        static std::atomic<QueuedEvent*> s_queuedEvents;
+
+        // Kept in the order the events were first posted in
+        static std::vector<std::pair<Events, std::any>> s_coalescedEvents;
     };
 
-}
\ No newline at end of file
+}
@@ -3,28 +3,53 @@
 #include <hex.hpp>
 #include <hex/helpers/utils.hpp>
 
-#include <list>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace hex {
 
+    namespace prv { class Provider; }
+    class BookmarkStore;
+
     struct ImHexApi {
         ImHexApi() = delete;
 
+        struct Common {
+            Common() = delete;
+
+            // Safe to call from any thread. The main loop only redraws when something happened, this makes it draw another frame even while it's waiting for input
+            static void requestRedraw();
+        };
+
         struct Bookmarks {
             Bookmarks() = delete;
 
             struct Entry {
                 Region region;
 
-                std::vector<char> name;
-                std::vector<char> comment;
+                std::string name;
+                std::string comment;
                 u32 color;
             };
 
             static void add(Region region, std::string_view name, std::string_view comment, u32 color = 0x00000000);
             static void add(u64 addr, size_t size, std::string_view name, std::string_view comment, u32 color = 0x00000000);
 
-            static std::list<Entry>& getEntries();
+            static BookmarkStore& getEntries();
+        };
+
+        struct Provider {
+            Provider() = delete;
+
+            [[nodiscard]] static prv::Provider* get();
+            [[nodiscard]] static const std::vector<prv::Provider*>& getProviders();
+
+            // Takes ownership of the provider and selects it
+            static void add(prv::Provider *provider);
+            static void setCurrent(prv::Provider *provider);
+            // Waits for all background tasks, deletes the provider and everything cached about it. Another open provider gets selected
+            static void remove(prv::Provider *provider);
         };
     };
 
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace hex {
+
+    namespace prv { class Provider; class ScanPipeline; }
+
+    // Interactive jobs are what the user is waiting for right now, they're picked up before all other queued jobs.
+    // Background jobs run on workers of their own, which may run at a lower OS priority, so they can't hold up any job the user is waiting for
+    enum class TaskPriority : u8 {
+        Interactive,
+        Normal,
+        Background
+    };
+
+    /*
+     * State of a job submitted to the TaskManager, shared between the worker running it and whoever submitted it.
+     * Long running jobs should check isCancelled() regularly and return early once it's set.
+     */
+    class Task {
+    public:
+        explicit Task(std::string name, TaskPriority priority = TaskPriority::Normal, prv::Provider *provider = nullptr) : m_name(std::move(name)), m_priority(priority), m_provider(provider) { }
+
+        [[nodiscard]] const std::string& getName() const { return this->m_name; }
+        [[nodiscard]] TaskPriority getPriority() const { return this->m_priority; }
+        // The provider the job or its completion callback uses, if any
+        [[nodiscard]] prv::Provider* getProvider() const { return this->m_provider; }
+
+        void setProgress(float progress) { this->m_progress = progress; }
+        [[nodiscard]] float getProgress() const { return this->m_progress; }
+
+        void cancel() { this->m_cancelled = true; }
+        [[nodiscard]] bool isCancelled() const { return this->m_cancelled; }
+        [[nodiscard]] bool isFinished() const { return this->m_finished; }
+        // False while the job is still queued
+        [[nodiscard]] bool isRunning() const { return this->m_running; }
+
+    private:
+        friend class TaskManager;
+        friend class prv::ScanPipeline;
+
+        std::string m_name;
+        TaskPriority m_priority;
+        prv::Provider *m_provider;
+        std::atomic<float> m_progress = 0;
+        std::atomic<bool> m_cancelled = false;
+        std::atomic<bool> m_finished = false;
+        std::atomic<bool> m_running = false;
+    };
+
+    using TaskHandle = std::shared_ptr<Task>;
+
+    /*
+     * Runs jobs on a shared pool of worker threads. Completion callbacks of tasks that weren't cancelled
+     * are executed on the main thread followed by a TaskFinished event, so they may freely touch view state.
+     */
+    class TaskManager {
+    public:
+        TaskManager() = delete;
+
+        using Job = std::function<void(Task &task)>;
+        using Callback = std::function<void()>;
+
+        // Worker counts of zero pick one depending on the number of cores
+        struct PoolSettings {
+            u32 workerCount = 0;
+            u32 backgroundWorkerCount = 0;
+            bool lowerBackgroundPriority = true;
+
+            bool operator==(const PoolSettings&) const = default;
+        };
+
+        static TaskHandle submit(std::string name, Job job, Callback onFinished = { });
+        static TaskHandle submit(std::string name, TaskPriority priority, Job job, Callback onFinished = { });
+        // Jobs that read from the provider directly or whose callback uses it have to be bound to it, they get cancelled before it's closed
+        static TaskHandle submit(std::string name, prv::Provider *provider, Job job, Callback onFinished = { });
+        static TaskHandle submit(std::string name, TaskPriority priority, prv::Provider *provider, Job job, Callback onFinished = { });
+
+        static void processFinishedTasks();
+        static void cancelAll();
+        static void waitForAll();
+        // Cancels all tasks bound to the provider and waits until they're done, their completion callbacks don't run anymore
+        static void cancelAndWaitFor(prv::Provider *provider);
+        static void stop();
+
+        // Includes queued tasks, in the order they were submitted
+        [[nodiscard]] static std::vector<TaskHandle> getRunningTasks();
+
+        // Main thread only. Workers that are already running finish their current job first, the new ones pick up everything else
+        static void configure(const PoolSettings &settings);
+        [[nodiscard]] static u32 getWorkerCount(bool background = false);
+
+        // Calls the function with every index below count, spread over the workers of the task's priority. The calling thread works on indices as well,
+        // so it never waits for a worker that's busy with something else and jobs may call this from their own worker. Indices are handed out in increasing order,
+        // no more once the task got cancelled. Returns false if it got cancelled, an exception thrown by the function cancels the task and gets rethrown here.
+        // Work that isn't part of a job can pass a Task of its own
+        static bool parallelFor(Task &task, size_t count, const std::function<void(size_t index)> &function);
+
+        // Same with a state for every thread taking part, which only ever gets used by one thread at a time. At most as many threads as there are states are used,
+        // getParallelism tells how many of them are worth preparing. There has to be at least one
+        template<typename State>
+        static bool parallelFor(Task &task, size_t count, std::vector<State> &states, const std::type_identity_t<std::function<void(size_t index, State &state)>> &function) {
+            return TaskManager::runParallel(task, count, states.size(), [&](size_t index, u32 thread) { function(index, states[thread]); });
+        }
+
+        // Same with default constructed states, returned for merging the results. States of threads that didn't get any index stay untouched
+        template<typename State>
+        static std::vector<State> parallelFor(Task &task, size_t count, const std::type_identity_t<std::function<void(size_t index, State &state)>> &function) {
+            std::vector<State> states(TaskManager::getParallelism(task, count));
+            TaskManager::parallelFor(task, count, states, function);
+
+            return states;
+        }
+
+        // Number of threads parallelFor uses at most for the task, the calling one included
+        [[nodiscard]] static u32 getParallelism(const Task &task, size_t count);
+        // The task the calling thread is working on as part of a job or parallelFor, nullptr otherwise. For code that doesn't get passed the task it runs on
+        [[nodiscard]] static Task* getCurrentTask();
+
+    private:
+        struct Entry {
+            TaskHandle task;
+            Job job;
+            Callback onFinished;
+        };
+
+        static void startWorkers();
+        static bool runParallel(Task &task, size_t count, u32 threadCount, const std::function<void(size_t index, u32 thread)> &function);
+        // Expects the lock to be held
+        [[nodiscard]] static u32 getConfiguredWorkerCount(bool background);
+        static void workerLoop(u32 index, bool background, u64 generation);
+        [[nodiscard]] static bool hasQueuedJob(bool background);
+
+        static std::mutex s_mutex;
+        static std::condition_variable s_jobAvailable;
+        static std::condition_variable s_jobDone;
+        static std::vector<std::thread> s_workers;
+        // Workers replaced by a new configuration, they exit on their own and get joined when the manager stops
+        static std::vector<std::thread> s_retiredWorkers;
+        static PoolSettings s_settings;
+        static u64 s_generation;
+        static std::array<std::deque<Entry>, 3> s_queuedJobs;
+        // Threads helping out with a parallelFor, they're picked up before the jobs of the same priority
+        static std::array<std::deque<std::function<void()>>, 3> s_queuedHelpers;
+        static std::vector<Entry> s_finishedJobs;
+        static std::vector<TaskHandle> s_runningTasks;
+        static bool s_stopping;
+    };
+
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <memory>
+#include <variant>
+#include <vector>
+
 namespace hex::dp {
 
     class Node;
@@ -16,6 +20,10 @@ namespace hex::dp {
             In, Out
         };
 
+        // Buffers are immutable and shared between every node reading them, nodes that change the data build a new one
+        using Buffer = std::shared_ptr<const std::vector<u8>>;
+        using Data = std::variant<std::monostate, u64, float, Buffer>;
+
         Attribute(IOType ioType, Type type, std::string_view name) : m_id(SharedData::dataProcessorNodeIdCounter++), m_ioType(ioType), m_type(type), m_name(name) {
 
         }
@@ -36,7 +44,8 @@ namespace hex::dp {
 
         [[nodiscard]] Node* getParentNode() { return this->m_parentNode; }
 
-        [[nodiscard]] std::vector<u8>& getOutputData() { return this->m_outputData; }
+        [[nodiscard]] const Data& getOutputData() const { return this->m_outputData; }
+        [[nodiscard]] u64 getOutputVersion() const { return this->m_outputVersion; }
     private:
         u32 m_id;
         IOType m_ioType;
@@ -45,10 +54,32 @@ namespace hex::dp {
         std::map<u32, Attribute*> m_connectedAttributes;
         Node *m_parentNode;
 
-        std::vector<u8> m_outputData;
+        Data m_outputData;
+        u64 m_outputVersion = 0;
+
+        // Output attribute and version an input attribute last got processed with
+        u32 m_processedSourceId = 0;
+        u64 m_processedVersion = 0;
 
         friend class Node;
+        friend class Executor;
         void setParentNode(Node *node) { this->m_parentNode = node; }
+
+        void setOutputData(Data data) {
+            // Consumers only need to run again if the value actually changed
+            if (data.index() == this->m_outputData.index()) {
+                if (auto buffer = std::get_if<Buffer>(&data); buffer != nullptr) {
+                    auto &currBuffer = std::get<Buffer>(this->m_outputData);
+
+                    if (*buffer == currBuffer || (*buffer != nullptr && currBuffer != nullptr && **buffer == *currBuffer))
+                        return;
+                } else if (data == this->m_outputData)
+                    return;
+            }
+
+            this->m_outputData = std::move(data);
+            this->m_outputVersion++;
+        }
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <chrono>
+#include <list>
+#include <optional>
+#include <vector>
+
+namespace hex { class Task; }
+namespace hex::prv { class Provider; }
+
+namespace hex::dp {
+
+    class Node;
+
+    /*
+     * Runs the nodes feeding into a set of end nodes in dependency order. The order is only computed again after invalidate() got called.
+     * Every node gets processed at most once per execution and only if it was marked dirty, one of its inputs changed
+     * or it reads from a provider whose data changed since the last execution.
+     * Nodes are grouped into levels that only depend on earlier levels, nodes of the same level are processed in parallel on the TaskManager's workers.
+     * Graphs containing streaming sources are run once per chunk of the stream, spread over as many executions as needed
+     * to stay within StreamTimeBudget each, so regions larger than memory can be processed without blocking the interface.
+     */
+    class Executor {
+    public:
+        // Needs to be called whenever nodes or links got added or removed
+        void invalidate() { this->m_orderValid = false; }
+
+        void execute(const std::list<Node*> &endNodes, prv::Provider *provider);
+        // Runs the whole stream at once instead of spreading it over multiple executions, for running the graph off the main thread.
+        // Returns false if the task got cancelled, the next execution then continues where this one stopped
+        bool executeFully(const std::list<Node*> &endNodes, prv::Provider *provider, Task &task);
+
+        // Whether executing would process anything at all
+        [[nodiscard]] bool isUpToDate(prv::Provider *provider) const;
+
+        // Fraction of the stream processed so far while a stream is being processed
+        [[nodiscard]] std::optional<float> getStreamProgress() const;
+
+    private:
+        std::vector<std::vector<Node*>> m_levels;
+        bool m_orderValid = false;
+
+        prv::Provider *m_provider = nullptr;
+        u64 m_dataGeneration = 0;
+
+        constexpr static auto StreamTimeBudget = std::chrono::milliseconds(10);
+
+        bool m_streaming = false;
+        u64 m_streamOffset = 0;
+        u64 m_streamSize = 0;
+
+        void sortNodes(const std::list<Node*> &endNodes);
+        void updateStreamedNodes();
+        void runPass(bool dataChanged);
+        [[nodiscard]] bool needsProcessing(Node *node, bool dataChanged);
+        static void processNodes(const std::vector<Node*> &nodes);
+    };
+
+}
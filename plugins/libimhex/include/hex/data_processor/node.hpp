@@ -6,6 +6,9 @@ namespace hex::dp {
 
     class Node {
     public:
+        // Streaming sources produce their data in chunks of this size, one per pass through the graph
+        constexpr static u64 StreamChunkSize = 0x10'0000;
+
         Node(std::string_view title, std::vector<Attribute> attributes) : m_id(SharedData::dataProcessorNodeIdCounter++), m_title(title), m_attributes(std::move(attributes)) {
             for (auto &attr : this->m_attributes)
                 attr.setParentNode(this);
@@ -21,6 +24,16 @@ namespace hex::dp {
             this->m_overlay = overlay;
         }
 
+        // Forces the node to be processed again on the next execution, used when its parameters changed
+        void markDirty() { this->m_dirty = true; }
+
+        // Nodes that read from the provider get processed again whenever its data changes
+        [[nodiscard]] virtual bool readsProviderData() const { return false; }
+
+        // Nodes depending on a streaming source get processed once per chunk, the stream ends after the longest source's size
+        [[nodiscard]] virtual bool isStreamSource() const { return false; }
+        [[nodiscard]] virtual u64 getStreamSize() const { return 0; }
+
         virtual void drawNode() { }
         virtual void process() = 0;
     private:
@@ -28,6 +41,13 @@ namespace hex::dp {
         std::string m_title;
         std::vector<Attribute> m_attributes;
         prv::Overlay *m_overlay = nullptr;
+        bool m_dirty = true;
+
+        bool m_streamed = false;
+        u64 m_streamOffset = 0;
+        u64 m_streamSize = 0;
+
+        friend class Executor;
 
         Attribute* getConnectedInputAttribute(u32 index) {
             if (index >= this->getAttributes().size())
@@ -41,19 +61,45 @@ namespace hex::dp {
             return connectedAttribute.begin()->second;
         }
 
+        void setDataOnOutput(u32 index, Attribute::Type type, Attribute::Data data) {
+            if (index >= this->getAttributes().size())
+                throw std::runtime_error("Attribute index out of bounds!");
+
+            auto &attribute = this->getAttributes()[index];
+
+            if (attribute.getIOType() != Attribute::IOType::Out)
+                throw std::runtime_error("Tried to set output data of an input attribute!");
+            if (attribute.getType() != type)
+                throw std::runtime_error("Tried to set output data of the wrong type!");
+
+            attribute.setOutputData(std::move(data));
+        }
+
     protected:
 
-        std::optional<std::vector<u8>> getBufferOnInput(u32 index) {
+        // Offset of the current chunk within the stream, always 0 for nodes that don't depend on a streaming source
+        [[nodiscard]] u64 getStreamOffset() const { return this->m_streamed ? this->m_streamOffset : 0; }
+        // Whether the current chunk is the last one, always true for nodes that don't depend on a streaming source. Only sources
+        // on earlier levels are taken into account, if a later one makes the stream longer the node simply gets empty chunks after it
+        [[nodiscard]] bool isLastStreamChunk() const { return !this->m_streamed || this->m_streamOffset + StreamChunkSize >= this->m_streamSize; }
+
+        [[nodiscard]] bool isInputStreamed(u32 index) {
             auto attribute = this->getConnectedInputAttribute(index);
 
-            if (attribute == nullptr || attribute->getType() != Attribute::Type::Buffer)
-                return { };
+            return attribute != nullptr && attribute->getParentNode()->m_streamed;
+        }
 
-            attribute->getParentNode()->process();
+        // Connected nodes have already been processed by the Executor by the time these get called
+        Attribute::Buffer getBufferOnInput(u32 index) {
+            auto attribute = this->getConnectedInputAttribute(index);
 
-            auto &outputData = attribute->getOutputData();
+            if (attribute == nullptr || attribute->getType() != Attribute::Type::Buffer)
+                return nullptr;
 
-            return outputData;
+            if (auto buffer = std::get_if<Attribute::Buffer>(&attribute->getOutputData()); buffer != nullptr)
+                return *buffer;
+            else
+                return nullptr;
         }
 
         std::optional<u64> getIntegerOnInput(u32 index) {
@@ -62,14 +108,10 @@ namespace hex::dp {
             if (attribute == nullptr || attribute->getType() != Attribute::Type::Integer)
                 return { };
 
-            attribute->getParentNode()->process();
-
-            auto &outputData = attribute->getOutputData();
-
-            if (outputData.empty() || outputData.size() < sizeof(u64))
-                return { };
+            if (auto integer = std::get_if<u64>(&attribute->getOutputData()); integer != nullptr)
+                return *integer;
             else
-                return *reinterpret_cast<u64*>(outputData.data());
+                return { };
         }
 
         std::optional<float> getFloatOnInput(u32 index) {
@@ -78,64 +120,40 @@ namespace hex::dp {
             if (attribute == nullptr || attribute->getType() != Attribute::Type::Float)
                 return { };
 
-            attribute->getParentNode()->process();
-
-            auto &outputData = attribute->getOutputData();
-
-            if (outputData.empty() || outputData.size() < sizeof(float))
-                return { };
+            if (auto floatingPoint = std::get_if<float>(&attribute->getOutputData()); floatingPoint != nullptr)
+                return *floatingPoint;
             else
-                return *reinterpret_cast<float*>(outputData.data());
+                return { };
         }
 
         void setBufferOnOutput(u32 index, std::vector<u8> data) {
-            if (index >= this->getAttributes().size())
-                throw std::runtime_error("Attribute index out of bounds!");
-
-            auto &attribute = this->getAttributes()[index];
-
-            if (attribute.getIOType() != Attribute::IOType::Out)
-                throw std::runtime_error("Tried to set output data of an input attribute!");
+            this->setDataOnOutput(index, Attribute::Type::Buffer, std::make_shared<const std::vector<u8>>(std::move(data)));
+        }
 
-            attribute.getOutputData() = data;
+        // Passes on an existing buffer without copying it
+        void setBufferOnOutput(u32 index, Attribute::Buffer buffer) {
+            this->setDataOnOutput(index, Attribute::Type::Buffer, std::move(buffer));
         }
 
         void setIntegerOnOutput(u32 index, u64 integer) {
-            if (index >= this->getAttributes().size())
-                throw std::runtime_error("Attribute index out of bounds!");
-
-            auto &attribute = this->getAttributes()[index];
-
-            if (attribute.getIOType() != Attribute::IOType::Out)
-                throw std::runtime_error("Tried to set output data of an input attribute!");
-
-            std::vector<u8> buffer(sizeof(u64), 0);
-            std::memcpy(buffer.data(), &integer, sizeof(u64));
-
-            attribute.getOutputData() = buffer;
+            this->setDataOnOutput(index, Attribute::Type::Integer, integer);
         }
 
         void setFloatOnOutput(u32 index, float floatingPoint) {
-            if (index >= this->getAttributes().size())
-                throw std::runtime_error("Attribute index out of bounds!");
-
-            auto &attribute = this->getAttributes()[index];
-
-            if (attribute.getIOType() != Attribute::IOType::Out)
-                throw std::runtime_error("Tried to set output data of an input attribute!");
-
-            std::vector<u8> buffer(sizeof(float), 0);
-            std::memcpy(buffer.data(), &floatingPoint, sizeof(float));
-
-            attribute.getOutputData() = buffer;
+            this->setDataOnOutput(index, Attribute::Type::Float, floatingPoint);
         }
 
         void setOverlayData(u64 address, const std::vector<u8> &data) {
             if (this->m_overlay == nullptr)
                 throw std::runtime_error("Tried setting overlay data on a node that's not the end of a chain!");
 
-            this->m_overlay->setAddress(address);
-            this->m_overlay->getData() = data;
+            // Chunks of a stream get appended to the data written by the first one, decoders may produce more or less data than they got
+            if (this->getStreamOffset() == 0) {
+                this->m_overlay->clear();
+                this->m_overlay->setAddress(address);
+            }
+
+            this->m_overlay->write(this->m_overlay->getSize(), data.data(), data.size());
         }
 
     };
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <list>
+#include <memory>
+#include <string>
+
+namespace hex {
+
+    namespace prv { class Provider; }
+
+    /*
+     * Analysis results of providers that aren't selected right now, so switching back to them doesn't mean redoing all the work.
+     * Views store their results when another provider gets selected and take them back out once theirs is selected again.
+     * All entries share a single memory budget, the ones stored the longest time ago get dropped first once it's exceeded.
+     * They're also the first thing the global memory budget evicts.
+     * Must only be used from the main thread.
+     */
+    class AnalysisCache {
+    public:
+        AnalysisCache() = delete;
+
+        constexpr static size_t DefaultBudget = 0x2000'0000;
+
+        // The size is what the value keeps in memory, values larger than the entire budget aren't kept at all
+        template<typename T>
+        static void store(prv::Provider *provider, const std::string &key, std::shared_ptr<T> value, size_t size) {
+            AnalysisCache::storeEntry(provider, key, std::static_pointer_cast<void>(std::move(value)), size);
+        }
+
+        // Removes the entry from the cache, nullptr if there was none or it had been dropped
+        template<typename T>
+        [[nodiscard]] static std::shared_ptr<T> take(prv::Provider *provider, const std::string &key) {
+            return std::static_pointer_cast<T>(AnalysisCache::takeEntry(provider, key));
+        }
+
+        static void remove(prv::Provider *provider);
+
+        static void setBudget(size_t budget);
+        [[nodiscard]] static size_t getBudget();
+        [[nodiscard]] static size_t getUsedSize();
+        // Drops the entries stored the longest time ago until at least size bytes are freed. Returns how much got freed
+        static size_t trim(size_t size);
+
+    private:
+        struct Entry {
+            prv::Provider *provider;
+            std::string key;
+            std::shared_ptr<void> value;
+            size_t size;
+        };
+
+        static void storeEntry(prv::Provider *provider, const std::string &key, std::shared_ptr<void> value, size_t size);
+        [[nodiscard]] static std::shared_ptr<void> takeEntry(prv::Provider *provider, const std::string &key);
+        static void evict();
+
+        // Most recently stored entries first
+        static std::list<Entry> s_entries;
+        static size_t s_budget;
+        static size_t s_usedSize;
+    };
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/api/imhex_api.hpp>
+
+#include <list>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * All bookmarks in the order they were added, together with an index of their regions sorted by start address.
+     * The index gets rebuilt on the next query after bookmarks were added or removed or markChanged was called.
+     * Entries stay at the same place in memory until they're removed, so pointers and iterators to them can be kept.
+     */
+    class BookmarkStore {
+    public:
+        using Entry = ImHexApi::Bookmarks::Entry;
+        using iterator = std::list<Entry>::iterator;
+        using const_iterator = std::list<Entry>::const_iterator;
+
+        BookmarkStore() = default;
+
+        Entry& add(Entry entry);
+        iterator erase(const_iterator entry);
+        void assign(std::list<Entry> entries);
+        void clear();
+
+        // Has to be called after the region or color of an entry got changed in place
+        void markChanged();
+
+        // Appends all bookmarks containing the address to result, sorted by their start address
+        void findAt(u64 address, std::vector<const Entry*> &result);
+        // All bookmarks sorted by their start address
+        [[nodiscard]] const std::vector<Entry*>& getSortedEntries();
+
+        // Changes whenever bookmarks were added, removed or changed, so anything derived from them knows when to update
+        [[nodiscard]] u64 getGeneration() const { return this->m_generation; }
+
+        [[nodiscard]] const std::list<Entry>& getEntries() const { return this->m_entries; }
+        [[nodiscard]] size_t size() const { return this->m_entries.size(); }
+        [[nodiscard]] bool empty() const { return this->m_entries.empty(); }
+
+        iterator begin() { return this->m_entries.begin(); }
+        iterator end() { return this->m_entries.end(); }
+        [[nodiscard]] const_iterator begin() const { return this->m_entries.begin(); }
+        [[nodiscard]] const_iterator end() const { return this->m_entries.end(); }
+
+    private:
+        void updateIndex();
+        void collect(size_t node, size_t nodeBegin, size_t nodeEnd, size_t count, u64 address, std::vector<const Entry*> &result) const;
+
+        std::list<Entry> m_entries;
+        u64 m_generation = 0;
+
+        // Entries sorted by start address and a tree over them holding the largest end address in each range of entries.
+        // Node 1 covers all entries and node n has the children 2n and 2n + 1, each covering one half of its range
+        std::vector<Entry*> m_sortedEntries;
+        std::vector<u64> m_maxEnds;
+        size_t m_leafCount = 0;
+        u64 m_indexedGeneration = -1;
+    };
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Finds occurrences of a byte pattern in memory. Every pattern byte may come with a mask selecting the bits that have to match,
+     * so whole bytes or single nibbles can be left as wildcards.
+     * Candidate positions are found by comparing the first and last non-wildcard byte against 16 or 32 positions at once,
+     * only those get verified completely. Where no vector extension is available, Boyer-Moore-Horspool is used instead.
+     */
+    class ByteSearcher {
+    public:
+        ByteSearcher() = default;
+        explicit ByteSearcher(std::vector<u8> pattern, std::vector<u8> mask = { });
+
+        // Parses hex strings like "E8 ?? ?? ?? ?? 48 8B" or "4? ?F", where every ? stands for an arbitrary nibble
+        [[nodiscard]] static std::optional<ByteSearcher> parse(std::string_view pattern);
+
+        // Returns the offset of the first occurrence of the pattern in data, or size if there is none
+        [[nodiscard]] size_t find(const u8 *data, size_t size) const;
+
+        [[nodiscard]] const std::vector<u8>& getPattern() const { return this->m_pattern; }
+        [[nodiscard]] size_t getSize() const { return this->m_pattern.size(); }
+        [[nodiscard]] bool empty() const { return this->m_pattern.empty(); }
+        [[nodiscard]] bool isMasked() const { return !this->m_mask.empty(); }
+
+    private:
+        [[nodiscard]] bool matches(const u8 *data) const;
+        [[nodiscard]] size_t findHorspool(const u8 *data, size_t size) const;
+
+        std::vector<u8> m_pattern;
+        std::vector<u8> m_mask;     // Empty if every bit has to match
+
+        // Positions of the bytes the vectorized search compares against, none if the pattern consists of wildcards only
+        std::optional<std::pair<size_t, size_t>> m_anchors;
+
+        std::array<size_t, 256> m_shiftTable = { 0 };
+    };
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace hex {
+
+    namespace {
+
+        template<size_t Size> struct UnsignedOfSize;
+        template<> struct UnsignedOfSize<1> { using Type = u8;  };
+        template<> struct UnsignedOfSize<2> { using Type = u16; };
+        template<> struct UnsignedOfSize<4> { using Type = u32; };
+        template<> struct UnsignedOfSize<8> { using Type = u64; };
+
+        template<typename T, bool Swap>
+        [[gnu::always_inline]] inline void decodeColumnValues(const u8 *data, size_t count, double *values) {
+            using Bits = typename UnsignedOfSize<sizeof(T)>::Type;
+
+            // Plain loads, swaps and conversions without any branches, so the compiler turns the loop into vector code
+            for (size_t i = 0; i < count; i++) {
+                Bits bits;
+                std::memcpy(&bits, data + i * sizeof(T), sizeof(T));
+
+                if constexpr (Swap && sizeof(T) == 2)
+                    bits = __builtin_bswap16(bits);
+                else if constexpr (Swap && sizeof(T) == 4)
+                    bits = __builtin_bswap32(bits);
+                else if constexpr (Swap && sizeof(T) == 8)
+                    bits = __builtin_bswap64(bits);
+
+                values[i] = static_cast<double>(std::bit_cast<T>(bits));
+            }
+        }
+
+    #if defined(__x86_64__) || defined(_M_X64)
+        // Swapping bytes inside of vector registers needs pshufb, which isn't part of the x86_64 baseline
+        template<typename T>
+        __attribute__((target("ssse3"))) void decodeSwappedColumnValuesSSSE3(const u8 *data, size_t count, double *values) {
+            decodeColumnValues<T, true>(data, count, values);
+        }
+    #endif
+
+    }
+
+    /*
+     * Decodes consecutive values of an arithmetic type stored in data with the given endianess and converts them to doubles.
+     * As many values get decoded as fit into both data and values, trailing bytes that don't form a whole value are ignored.
+     */
+    template<typename T> requires std::is_arithmetic_v<T>
+    void decodeColumn(std::span<const u8> data, std::endian endian, std::span<double> values) {
+        auto count = std::min(data.size() / sizeof(T), values.size());
+
+        if (sizeof(T) > 1 && endian != std::endian::native) {
+        #if defined(__x86_64__) || defined(_M_X64)
+            if (__builtin_cpu_supports("ssse3"))
+                return decodeSwappedColumnValuesSSSE3<T>(data.data(), count, values.data());
+        #endif
+
+            decodeColumnValues<T, true>(data.data(), count, values.data());
+        } else
+            decodeColumnValues<T, false>(data.data(), count, values.data());
+    }
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace hex {
+
+    // Base16 and Base32 use the RFC 4648 alphabets, Ascii85 the Adobe variant with its optional <~ ~> delimiters
+    enum class DataEncoding : u8 { Base16, Base32, Base64, Ascii85 };
+
+    /*
+     * Decodes text in one of the encodings incrementally, the input may be split at any position. Whitespace is skipped everywhere,
+     * Base16 and Base32 also accept lowercase letters. Padding is optional, but nothing except more padding may follow it.
+     * Base64 is decoded 16 characters at a time with SSSE3 where available, falling back to one character at a time around whitespace and padding.
+     */
+    class DataDecoder {
+    public:
+        explicit DataDecoder(DataEncoding encoding) : m_encoding(encoding) { }
+
+        // Appends the decoded bytes to output. Returns false once invalid input was found, output then holds everything decoded before it
+        bool update(std::span<const u8> input, std::vector<u8> &output);
+        // Decodes the rest of an incomplete trailing group. Returns false if the input was invalid or stopped in the middle of a byte
+        bool finish(std::vector<u8> &output);
+
+        void reset();
+        [[nodiscard]] bool hasFailed() const { return this->m_failed; }
+
+    private:
+        bool decodeRadix(std::span<const u8> input, std::vector<u8> &output);
+        bool decodeAscii85(std::span<const u8> input, std::vector<u8> &output);
+
+        DataEncoding m_encoding;
+
+        // Base16, Base32 and Base64 collect bits until there's a byte, Ascii85 collects characters until there's a group of five
+        u64 m_value = 0;
+        u8 m_count = 0;
+        bool m_padded = false;
+        bool m_failed = false;
+
+        enum class Delimiter : u8 { None, Opening, Data, Closing, Closed } m_delimiter = Delimiter::None;
+    };
+
+    /*
+     * Encodes data in one of the encodings incrementally. Base16, Base32 and Base64 output is padded, Ascii85 output has no delimiters.
+     * Base64 is encoded 12 bytes at a time with SSSE3 where available.
+     */
+    class DataEncoder {
+    public:
+        explicit DataEncoder(DataEncoding encoding) : m_encoding(encoding) { }
+
+        void update(std::span<const u8> input, std::vector<u8> &output);
+        // Encodes the rest of an incomplete trailing group and adds the padding
+        void finish(std::vector<u8> &output);
+
+        void reset();
+
+    private:
+        DataEncoding m_encoding;
+
+        u64 m_value = 0;
+        u8 m_count = 0;
+        u64 m_written = 0;
+    };
+
+    // Returns nothing if the input isn't valid
+    [[nodiscard]] std::optional<std::vector<u8>> decodeData(DataEncoding encoding, std::span<const u8> input);
+    [[nodiscard]] std::vector<u8> encodeData(DataEncoding encoding, std::span<const u8> input);
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <map>
+#include <optional>
+
+namespace hex {
+
+    /*
+     * Sorted list of non-overlapping highlighted address ranges and their colors.
+     * Regions added earlier take precedence over later ones they overlap with.
+     */
+    class HighlightIndex {
+    public:
+        HighlightIndex() = default;
+
+        void add(u64 address, size_t size, u32 color);
+        void clear() { this->m_runs.clear(); }
+
+        [[nodiscard]] std::optional<u32> get(u64 address) const;
+        [[nodiscard]] bool empty() const { return this->m_runs.empty(); }
+        [[nodiscard]] size_t getRunCount() const { return this->m_runs.size(); }
+
+    private:
+        struct Run {
+            u64 end;
+            u32 color;
+        };
+
+        void insertRun(u64 start, u64 end, u32 color);
+
+        std::map<u64, Run> m_runs;
+    };
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Allocator for many small objects that are freed all at once when the arena gets destroyed.
+     * Memory of objects deleted before that is kept in per size free lists and reused by later allocations.
+     * An arena must only be used by one thread at a time and has to outlive every object placed in it.
+     */
+    class MemoryArena {
+    public:
+        MemoryArena() = default;
+        MemoryArena(const MemoryArena&) = delete;
+        MemoryArena& operator=(const MemoryArena&) = delete;
+
+        [[nodiscard]] void* allocate(size_t size);
+        void deallocate(void *pointer, size_t size);
+
+        // Creates an arena that lives as long as this one, for objects allocated on another thread. Not thread safe either
+        [[nodiscard]] MemoryArena& createChild();
+
+        // The arena objects get allocated in on the current thread, if any
+        [[nodiscard]] static MemoryArena* getCurrent();
+
+        // Makes the arena the one objects get allocated in on the current thread, for as long as the scope lives
+        class Scope {
+        public:
+            explicit Scope(MemoryArena &arena);
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            MemoryArena *m_previous;
+        };
+
+        // Used by classes allocated through their own operator new. Objects created while no arena is active get allocated on the heap
+        [[nodiscard]] static void* allocateObject(size_t size);
+        static void deallocateObject(void *pointer, size_t size);
+
+    private:
+        constexpr static size_t BlockSize = 0x10'0000;
+        constexpr static size_t Alignment = 16;
+        constexpr static size_t MaxPooledSize = 0x400;
+
+        std::vector<std::unique_ptr<u8[]>> m_blocks;
+        u8 *m_blockPosition = nullptr;
+        size_t m_blockRemaining = 0;
+
+        std::array<void*, MaxPooledSize / Alignment> m_freeLists = { };
+
+        std::vector<std::unique_ptr<MemoryArena>> m_children;
+    };
+
+}
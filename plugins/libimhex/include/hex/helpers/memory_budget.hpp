@@ -0,0 +1,74 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Accounting of the memory held by caches, indices and analysis results, which all have to share a single limit.
+     * Subsystems register what they hold and, if some of it can be dropped and recomputed later, how to give memory back.
+     * Once per frame the budget asks evictable consumers to free memory until the total is below the limit again, the ones with the
+     * lowest priority and the most memory first. Results that are in use count towards the total but are never evicted.
+     * Registering and unregistering is thread safe, the callbacks always get called on the main thread.
+     */
+    class MemoryBudget {
+    public:
+        MemoryBudget() = delete;
+
+        constexpr static size_t DefaultLimit = 0x8000'0000;
+
+        // Has to be thread safe if the memory is changed by other threads
+        using UsageFunction = std::function<size_t()>;
+        // Frees about the given number of bytes or as much as possible if there isn't that much to free. Returns how much actually got freed
+        using EvictFunction = std::function<size_t(size_t size)>;
+
+        // Lower priorities are given up first
+        enum class Priority : u8 {
+            InactiveResults,
+            Cache,
+            ReadCache
+        };
+
+        // Accounts for the memory of a consumer as long as it exists. Callbacks run with the budget locked, they must not register or unregister anything
+        class Registration {
+        public:
+            Registration() = default;
+            Registration(std::string_view subsystem, UsageFunction usage, EvictFunction evict = nullptr, Priority priority = Priority::Cache);
+            ~Registration();
+
+            Registration(const Registration&) = delete;
+            Registration& operator=(const Registration&) = delete;
+            Registration(Registration &&other) noexcept;
+            Registration& operator=(Registration &&other) noexcept;
+
+        private:
+            void reset();
+
+            u64 m_id = 0;
+        };
+
+        // Consumers of the same subsystem are added up
+        struct Usage {
+            std::string subsystem;
+            size_t size = 0;
+            size_t evictableSize = 0;
+            size_t consumers = 0;
+        };
+
+        static void setLimit(size_t limit);
+        [[nodiscard]] static size_t getLimit();
+
+        // Main thread only. Evicts until the total is within the limit or there's nothing evictable left
+        static void enforce();
+
+        // Main thread only. Sorted by size, largest first
+        [[nodiscard]] static std::vector<Usage> getUsage();
+        [[nodiscard]] static size_t getTotalUsage();
+    };
+
+}
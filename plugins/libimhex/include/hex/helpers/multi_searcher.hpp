@@ -0,0 +1,50 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Finds every occurrence of any number of byte patterns in a single pass using an Aho-Corasick automaton.
+     * The automaton is compiled into a full transition table, so each byte of input costs a single lookup no matter how many patterns there are.
+     * Searching is stateless apart from the State value passed from one call to the next, so data can be fed block by block
+     * and a single searcher may be shared between threads.
+     */
+    class MultiSearcher {
+    public:
+        using State = u32;
+        using Callback = std::function<void(size_t patternIndex, u64 address)>;
+
+        explicit MultiSearcher(const std::vector<std::vector<u8>> &patterns);
+
+        /*
+         * Searches the block of data located at address, calling callback with the start address of every match.
+         * Returns the state to continue with in the block that follows, matches crossing block boundaries are reported as well.
+         */
+        State search(const u8 *data, size_t size, u64 address, State state, const Callback &callback) const;
+
+        [[nodiscard]] size_t getPatternCount() const { return this->m_patternSizes.size(); }
+        [[nodiscard]] size_t getPatternSize(size_t patternIndex) const { return this->m_patternSizes[patternIndex]; }
+        [[nodiscard]] size_t getStateCount() const { return this->m_outputs.size(); }
+
+        constexpr static State InitialState = 0;
+
+    private:
+        constexpr static State NoState = ~State(0);
+
+        constexpr static State OutputFlag = State(1) << 31;
+        constexpr static u32 LaneCount = 4;
+        constexpr static size_t MinimumLaneSize = 0x1000;
+
+        std::vector<State> m_transitions;               // 256 entries per state, the top bit is set for states where any pattern ends
+        std::vector<std::vector<u32>> m_outputs;        // Patterns ending in each state
+        std::vector<State> m_outputLinks;               // Nearest state on the failure chain with patterns ending in it
+        std::vector<size_t> m_patternSizes;
+        size_t m_maxPatternSize = 0;
+    };
+
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Frame time instrumentation. Scopes add their duration to the current frame's total of their name, endFrame() moves those totals into
+     * a rolling history that the profiler overlay shows averages and spikes of. While a trace is being recorded, every scope also becomes a
+     * Chrome trace event. Collection only happens while the profiler is enabled, so scopes are nearly free otherwise.
+     * Scopes may be used on any thread, every thread collects into its own buffer that only the main thread reads from besides it.
+     * Plugins should use the zones of hex/helpers/trace.hpp, they can be compiled out.
+     *
+     * Builds with IMHEX_TRACK_ALLOCATIONS replace the global operator new, every scope then also counts the allocations made on its thread while it ran,
+     * including the ones of scopes nested in it. The profiler's own bookkeeping isn't counted. Without it all allocation counts stay zero.
+     */
+    class Profiler {
+    public:
+        Profiler() = delete;
+
+        constexpr static size_t HistorySize = 120;
+        constexpr static size_t MaxTraceEvents = 0x10'0000;
+
+        struct Allocations {
+            u64 count = 0;
+            u64 bytes = 0;
+        };
+
+        class Scope {
+        public:
+            // The name has to stay valid until the scope ends
+            explicit Scope(std::string_view name, std::string_view category = "frame");
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            std::string_view m_name, m_category;
+            u64 m_start = 0;
+            Allocations m_startAllocations;
+            bool m_active;
+        };
+
+        // Values of the last HistorySize frames, the newest one is at getLatest()
+        struct History {
+            std::array<double, HistorySize> values = { 0 };
+            size_t next = 0;
+            size_t count = 0;
+
+            void push(double value);
+
+            [[nodiscard]] double getLatest() const;
+            [[nodiscard]] double getAverage() const;
+            [[nodiscard]] double getMaximum() const;
+        };
+
+        struct Statistics {
+            History milliseconds;
+            History calls;
+            History allocations, allocatedBytes;
+        };
+
+        struct ReadStatistics {
+            History count, bytes;
+            History mainThreadCount, mainThreadBytes;
+        };
+
+        // Main thread only
+        static void setEnabled(bool enabled);
+        [[nodiscard]] static bool isEnabled();
+
+        // Name of the calling thread in exported traces
+        static void setThreadName(std::string_view name);
+
+        // Main thread only. Collects the totals of all threads
+        static void endFrame();
+
+        // Thread safe, called by providers for every read of their data
+        static void addRead(size_t size);
+
+        #if defined(IMHEX_TRACK_ALLOCATIONS)
+            constexpr static bool TracksAllocations = true;
+        #else
+            constexpr static bool TracksAllocations = false;
+        #endif
+
+        // Thread safe and allocation free, called by the replaced operator new for every allocation
+        static void addAllocation(size_t size);
+        // Everything the calling thread allocated since it started
+        [[nodiscard]] static Allocations getThreadAllocations();
+
+        [[nodiscard]] static const std::map<std::string, Statistics, std::less<>>& getStatistics();
+        [[nodiscard]] static const ReadStatistics& getReadStatistics();
+        // Same layout as the read statistics, the count and size of all allocations per frame
+        [[nodiscard]] static const ReadStatistics& getAllocationStatistics();
+        static void clear();
+
+        static void startRecording();
+        static void stopRecording();
+        [[nodiscard]] static bool isRecording();
+        [[nodiscard]] static size_t getTraceEventCount();
+
+        // Writes the recorded trace in the Chrome trace event format that chrome://tracing and Perfetto load. Threads become separate tracks
+        static bool exportTrace(const std::string &path);
+
+    private:
+        struct TraceEvent {
+            u32 name;
+            u32 category;
+            u64 start;
+            u64 duration;
+        };
+
+        struct Totals {
+            double milliseconds = 0;
+            u32 calls = 0;
+            Allocations allocations;
+        };
+
+        // Allocations the calling thread makes while it's around don't get counted
+        class BookkeepingScope {
+        public:
+            BookkeepingScope() : m_previous(Profiler::s_inBookkeeping) { Profiler::s_inBookkeeping = true; }
+            ~BookkeepingScope() { Profiler::s_inBookkeeping = this->m_previous; }
+
+        private:
+            bool m_previous;
+        };
+
+        struct ThreadBuffer {
+            std::mutex mutex;
+            u32 id;
+            std::string name;
+
+            std::map<std::string, Totals, std::less<>> totals;
+
+            // Names and categories of trace events are indices into the thread's list of strings
+            std::vector<TraceEvent> events;
+            std::vector<std::string> strings;
+            std::map<std::string, u32, std::less<>> stringIds;
+
+            u32 getStringId(std::string_view string);
+        };
+
+        [[nodiscard]] static u64 getTime();
+        [[nodiscard]] static ThreadBuffer& getThreadBuffer();
+        static void addScope(std::string_view name, std::string_view category, u64 start, u64 end, const Allocations &allocations);
+
+        static std::atomic<bool> s_enabled;
+        static std::thread::id s_mainThread;
+
+        static std::map<std::string, Statistics, std::less<>> s_statistics;
+        static ReadStatistics s_readStatistics;
+        static std::atomic<u64> s_readCount, s_readBytes, s_mainThreadReadCount, s_mainThreadReadBytes;
+
+        static ReadStatistics s_allocationStatistics;
+        static std::atomic<u64> s_allocationCount, s_allocationBytes, s_mainThreadAllocationCount, s_mainThreadAllocationBytes;
+        static thread_local Allocations s_threadAllocations;
+        static thread_local bool s_inBookkeeping;
+
+        static std::atomic<bool> s_recording;
+        static std::atomic<u64> s_recordingStart;
+        static std::atomic<size_t> s_traceEventCount;
+
+        // Buffers outlive their threads so the events of finished threads still get exported
+        static std::mutex s_threadBufferMutex;
+        static std::vector<std::shared_ptr<ThreadBuffer>> s_threadBuffers;
+    };
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <bitset>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Byte oriented regular expression search that runs in time linear to the size of the data.
+     * Patterns get compiled into an NFA which is turned into a DFA lazily: only states that are actually visited are ever built
+     * and the cache of built states is bounded, so no pattern can cause exponential time or memory use.
+     *
+     * Supported are literal bytes, escapes like \x7F \n \0, any byte (.), classes like [^\x00-\x1F] or \d \w \s and their negations,
+     * groups, alternations and the quantifiers * + ? {n} {n,} and {n,m}. Invalid patterns throw std::invalid_argument.
+     *
+     * Matches don't overlap and are found in order. The search stops at the earliest position any non-empty match ends in,
+     * takes the leftmost start of the matches ending there and then extends the match from that start as far as possible.
+     */
+    class RegexSearcher {
+    public:
+        // Reads size bytes at address into buffer, returning false aborts the search
+        using ReadFunction = std::function<bool(u64 address, u8 *buffer, size_t size)>;
+        using Callback = std::function<void(u64 start, u64 end)>;
+
+        explicit RegexSearcher(std::string_view pattern);
+
+        // Searches the data in [0, size). Returns false if the read function aborted the search
+        bool findAll(u64 size, const ReadFunction &read, const Callback &callback);
+
+        // Matches are not extended past this size, which keeps the work per match bounded
+        constexpr static size_t MaxMatchSize = 0x10'0000;
+
+    private:
+        struct NfaState {
+            enum class Type : u8 { Bytes, Split, Match } type;
+            u32 next = 0, alternative = 0;
+            std::bitset<0x100> bytes;
+        };
+
+        using Nfa = std::vector<NfaState>;
+
+        struct Node;
+        class Parser;
+
+        // Adds the states matching node to the NFA, leading to next. Returns the entry state
+        static u32 compile(const Node &node, u32 next, bool reverse, Nfa &nfa);
+
+        class LazyDfa {
+        public:
+            LazyDfa() = default;
+            LazyDfa(std::shared_ptr<const Nfa> nfa, u32 start, bool unanchored);
+
+            [[nodiscard]] u32 getInitialState();
+
+            // States carry their accepting flag in the top bit so the search loop doesn't need a second lookup
+            [[nodiscard]] u32 step(u32 state, u8 byte) {
+                if (auto next = this->m_transitions[(state & ~AcceptingFlag) * 0x100 + byte]; next != UnknownState) [[likely]]
+                    return next;
+
+                return this->computeTransition(state & ~AcceptingFlag, byte);
+            }
+
+            [[nodiscard]] static bool isAccepting(u32 state) { return (state & AcceptingFlag) != 0; }
+            [[nodiscard]] bool isDead(u32 state) const { return !this->m_unanchored && this->m_sets[state & ~AcceptingFlag].empty(); }
+
+        private:
+            constexpr static u32 UnknownState = ~u32(0);
+            constexpr static u32 AcceptingFlag = u32(1) << 31;
+            constexpr static size_t MaxCachedStates = 0x1000;
+
+            u32 computeTransition(u32 state, u8 byte);
+            u32 addState(std::vector<u32> &&set);
+            void addClosure(u32 nfaState, std::vector<u32> &set);
+
+            std::shared_ptr<const Nfa> m_nfa;
+            std::vector<u32> m_startSet;
+            bool m_unanchored = false;
+
+            std::map<std::vector<u32>, u32> m_stateLookup;
+            std::vector<std::vector<u32>> m_sets;
+            std::vector<u32> m_transitions;
+            u32 m_flushCount = 0;
+
+            std::vector<u32> m_visited;
+            u32 m_visitGeneration = 0;
+        };
+
+        [[nodiscard]] std::optional<u64> findStart(u64 lowerBound, u64 end, const ReadFunction &read);
+        [[nodiscard]] std::optional<u64> extendMatch(u64 start, u64 end, u64 size, const ReadFunction &read);
+
+        LazyDfa m_search;       // Unanchored, finds the earliest end of any match
+        LazyDfa m_reverse;      // Anchored reversed pattern, finds where a match ending at a given position starts
+        LazyDfa m_extend;       // Anchored, finds the longest match from a given start
+    };
+
+}
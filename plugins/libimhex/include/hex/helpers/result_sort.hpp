@@ -0,0 +1,39 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace hex {
+
+    /*
+     * Sorting of result table rows by a single column. Rows are sorted by their index, whatever holds them only gets permuted once at the end.
+     * Numeric keys go through a radix sort, one byte per pass and only over the bytes that differ between any of the keys.
+     * String keys get radix sorted by eight bytes at a time, runs that share them are sorted by the next eight bytes and small runs are compared.
+     * Big tables split every pass across the task manager's workers. Sorts are stable, rows with equal keys keep their previous order.
+     */
+    class ResultSort {
+    public:
+        ResultSort() = delete;
+
+        // Indices of the keys in sorted order
+        [[nodiscard]] static std::vector<u32> byNumber(std::span<const u64> keys, bool descending = false);
+        // Strings compare byte by byte like std::string does
+        [[nodiscard]] static std::vector<u32> byString(std::span<const std::string_view> keys, bool descending = false);
+
+        // The i-th value afterwards is the one that was at order[i] before
+        template<typename T>
+        static void apply(std::vector<T> &values, std::span<const u32> order) {
+            std::vector<T> sortedValues;
+            sortedValues.reserve(order.size());
+
+            for (u32 index : order)
+                sortedValues.push_back(std::move(values[index]));
+
+            values = std::move(sortedValues);
+        }
+    };
+
+}
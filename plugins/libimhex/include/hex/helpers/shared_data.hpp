@@ -1,14 +1,21 @@
 #pragma once
 
 #include <any>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <list>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
 #include <vector>
 
 #include <hex/api/content_registry.hpp>
 #include <hex/api/imhex_api.hpp>
 #include <hex/api/event.hpp>
+#include <hex/helpers/bookmark_store.hpp>
 
 #include <imgui.h>
 #include <ImGuiFileBrowser.h>
@@ -29,28 +36,100 @@ namespace hex {
 
     class SharedData {
         SharedData() = default;
+
+        struct Variable {
+            std::any value;
+            mutable std::shared_mutex mutex;
+        };
+
     public:
         SharedData(const SharedData&) = delete;
         SharedData(SharedData&&) = delete;
 
         friend class Window;
 
+        /*
+         * Typed reference to a shared variable that doesn't look it up again on every access. Handles stay valid for the lifetime of ImHex,
+         * as long as nothing replaces the variable with a value of a different type through setVariable.
+         * get and the operators don't lock, they're meant for variables only the main thread uses. Once a background job uses the variable as well,
+         * every access has to go through load, store or update.
+         */
+        template<typename T>
+        class VariableHandle {
+        public:
+            VariableHandle() = default;
+
+            [[nodiscard]] T& get() const { return *this->m_value; }
+            [[nodiscard]] T& operator*() const { return *this->m_value; }
+            [[nodiscard]] T* operator->() const { return this->m_value; }
+
+            [[nodiscard]] T load() const {
+                std::shared_lock lock(*this->m_mutex);
+                return *this->m_value;
+            }
+
+            void store(T value) const {
+                std::unique_lock lock(*this->m_mutex);
+                *this->m_value = std::move(value);
+            }
+
+            // Calls the function with the value while no other thread accesses it, for modifications that depend on the previous value
+            template<typename Function>
+            decltype(auto) update(Function &&function) const {
+                std::unique_lock lock(*this->m_mutex);
+                return function(*this->m_value);
+            }
+
+            [[nodiscard]] bool isValid() const { return this->m_value != nullptr; }
+
+        private:
+            friend class SharedData;
+            VariableHandle(T *value, std::shared_mutex *mutex) : m_value(value), m_mutex(mutex) { }
+
+            T *m_value = nullptr;
+            std::shared_mutex *m_mutex = nullptr;
+        };
+
+        // Looks the variable up once, creating it with the default value if it doesn't exist yet. Throws std::bad_any_cast if it holds a different type
+        template<typename T>
+        static VariableHandle<T> registerVariable(const std::string &variableName, T defaultValue = { }) {
+            std::scoped_lock lock(SharedData::sharedVariablesMutex);
+
+            auto &variable = SharedData::sharedVariables[variableName];
+            if (!variable.value.has_value())
+                variable.value = std::move(defaultValue);
+
+            return { &std::any_cast<T&>(variable.value), &variable.mutex };
+        }
+
         template<typename T>
         static T& getVariable(std::string variableName) {
-            return std::any_cast<T&>(SharedData::sharedVariables[variableName]);
+            std::scoped_lock lock(SharedData::sharedVariablesMutex);
+            return std::any_cast<T&>(SharedData::sharedVariables[variableName].value);
         }
 
         template<typename T>
         static void setVariable(std::string variableName, T value) {
-            SharedData::sharedVariables[variableName] = value;
+            std::scoped_lock lock(SharedData::sharedVariablesMutex);
+
+            // Assigned in place if the type stays the same, so handles to the variable stay valid
+            auto &variable = SharedData::sharedVariables[variableName];
+            std::unique_lock variableLock(variable.mutex);
+            if (auto current = std::any_cast<T>(&variable.value); current != nullptr)
+                *current = std::move(value);
+            else
+                variable.value = std::move(value);
         }
 
     public:
-        static std::vector<EventHandler> eventHandlers;
+        static std::map<Events, std::vector<EventHandler>> eventHandlers;
         static std::vector<std::function<void()>> deferredCalls;
         static prv::Provider *currentProvider;
+        static std::vector<prv::Provider*> providers;
         static std::map<std::string, std::vector<ContentRegistry::Settings::Entry>> settingsEntries;
         static nlohmann::json settingsJson;
+        // When the settings last changed without having been written to disk since
+        static std::optional<std::chrono::steady_clock::time_point> settingsChangeTime;
         static std::map<std::string, Events> customEvents;
         static u32 customEventsLastId;
         static std::vector<ContentRegistry::CommandPaletteCommands::Entry> commandPaletteCommands;
@@ -58,9 +137,8 @@ namespace hex {
         static std::vector<View*> views;
         static std::vector<ContentRegistry::Tools::Entry> toolsEntries;
         static std::vector<ContentRegistry::DataInspector::Entry> dataInspectorEntries;
-        static u32 patternPaletteOffset;
         static std::string errorPopupMessage;
-        static std::list<ImHexApi::Bookmarks::Entry> bookmarkEntries;
+        static BookmarkStore bookmarkEntries;
 
         static imgui_addons::ImGuiFileBrowser fileBrowser;
         static imgui_addons::ImGuiFileBrowser::DialogMode fileBrowserDialogMode;
@@ -71,14 +149,25 @@ namespace hex {
         static std::vector<ContentRegistry::DataProcessorNode::Entry> dataProcessorNodes;
         static u32 dataProcessorNodeIdCounter;
 
+        static std::vector<ContentRegistry::Providers::Entry> providerEntries;
+
         static int mainArgc;
         static char **mainArgv;
 
         static ImVec2 windowPos;
         static ImVec2 windowSize;
 
+        // Set by ImHexApi::Common::requestRedraw(), the wake up function interrupts the main loop if it's waiting for input
+        static std::atomic<bool> redrawRequested;
+        static std::function<void()> wakeUpMainLoop;
+
+        // Index of the next color patterns get assigned. Separate for every thread so evaluations running in parallel don't interfere
+        static u32& getPatternPaletteOffset();
+
     private:
-        static std::map<std::string, std::any> sharedVariables;
+        // Variables never get removed and map nodes don't move, which is what keeps handles valid
+        static std::map<std::string, Variable> sharedVariables;
+        static std::mutex sharedVariablesMutex;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <hex/helpers/profiler.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <string_view>
+
+/*
+ * Scoped trace zones for plugins and background jobs. Zones show up in the profiler overlay and in exported traces, each thread on its own track.
+ * While the profiler is closed a zone costs a single atomic load. Building with IMHEX_DISABLE_TRACING defined compiles them out entirely.
+ *
+ *   void MyView::analyze() {
+ *       IMHEX_TRACE_ZONE("Analyze", "my-plugin");
+ *       ...
+ *   }
+ */
+
+namespace hex::trace {
+
+#if defined(IMHEX_DISABLE_TRACING)
+
+    class Zone {
+    public:
+        explicit Zone(std::string_view, std::string_view = { }) { }
+    };
+
+    inline void setThreadName(std::string_view) { }
+
+#else
+
+    // The name and category have to stay valid until the zone ends, string literals are the usual choice
+    class Zone {
+    public:
+        explicit Zone(std::string_view name, std::string_view category = "plugin") : m_scope(name, category) { }
+
+    private:
+        Profiler::Scope m_scope;
+    };
+
+    inline void setThreadName(std::string_view name) {
+        Profiler::setThreadName(name);
+    }
+
+#endif
+
+}
+
+#if defined(IMHEX_DISABLE_TRACING)
+    #define IMHEX_TRACE_ZONE(...)
+#else
+    #define IMHEX_TRACE_ZONE(...) ::hex::trace::Zone TOKEN_CONCAT(traceZone, __COUNTER__)(__VA_ARGS__)
+#endif
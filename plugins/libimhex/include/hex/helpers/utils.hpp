@@ -7,7 +7,9 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -99,6 +101,28 @@ namespace hex {
         return std::string(buffer.data(), buffer.data() + size);
     }
 
+    // Same as format but writes into an existing string, reusing the memory it already holds
+    template<typename ... Args>
+    inline void formatTo(std::string &result, const char *format, Args ... args) {
+        ssize_t size = snprintf( nullptr, 0, format, args ... );
+
+        if (size <= 0) {
+            result.clear();
+            return;
+        }
+
+        // The terminator snprintf writes ends up in the place std::string keeps for it
+        result.resize(size);
+        snprintf(result.data(), size + 1, format, args ...);
+    }
+
+    // Appends every byte as two upper case hex digits following the prefix, with the separator in between bytes.
+    // Meant for large amounts of data, the result only grows once and the digits come from a table
+    void appendHexBytes(std::string &result, std::span<const u8> bytes, std::string_view prefix = "", std::string_view separator = "");
+
+    // Appends the value as upper case hex number, padded with zeros to at least minDigits digits
+    void appendHexNumber(std::string &result, u64 value, u8 minDigits = 1);
+
     [[nodiscard]] constexpr inline u64 extract(u8 from, u8 to, const hex::unsigned_integral auto &value) {
         using ValueType = std::remove_cvref_t<decltype(value)>;
         ValueType mask = (std::numeric_limits<ValueType>::max() >> (((sizeof(value) * 8) - 1) - (from - to))) << to;
@@ -153,6 +177,16 @@ namespace hex {
             throw std::invalid_argument("Invalid value size!");
     }
 
+    // Reverses the bytes of count consecutive values that are size bytes wide in place. Values of any other size than 2, 4, 8 or 16 bytes are left untouched
+    void swapBytes(void *data, size_t count, size_t size);
+
+    // Same as changeEndianess for single values but converts all of them at once, using vector instructions where the CPU supports them
+    template<typename T>
+    void changeEndianess(std::span<T> values, std::endian endian) {
+        if (endian != std::endian::native)
+            swapBytes(values.data(), values.size(), sizeof(T));
+    }
+
     template< class T >
     constexpr T bit_width(T x) noexcept {
         return std::numeric_limits<T>::digits - std::countl_zero(x);
@@ -2,6 +2,9 @@
 
 #include "token.hpp"
 
+#include <hex/api/content_registry.hpp>
+#include <hex/helpers/memory_arena.hpp>
+
 #include <bit>
 #include <optional>
 #include <unordered_map>
@@ -31,21 +34,58 @@ namespace hex::lang {
 
     class ASTNode {
     public:
+        // Lets the evaluator dispatch on the node type with a switch instead of trying one dynamic_cast after another
+        enum class Kind : u8 {
+            IntegerLiteral,
+            NumericExpression,
+            TernaryExpression,
+            BuiltinType,
+            TypeDecl,
+            VariableDecl,
+            ArrayVariableDecl,
+            PointerVariableDecl,
+            Struct,
+            Union,
+            Enum,
+            Bitfield,
+            RValue,
+            ScopeResolution,
+            ConditionalStatement,
+            FunctionCall,
+            StringLiteral,
+            Attribute
+        };
+
         constexpr ASTNode() = default;
         constexpr virtual ~ASTNode() = default;
         constexpr ASTNode(const ASTNode &) = default;
 
+        static void* operator new(size_t size) { return MemoryArena::allocateObject(size); }
+        static void operator delete(void *pointer, size_t size) { MemoryArena::deallocateObject(pointer, size); }
+
         [[nodiscard]] constexpr u32 getLineNumber() const { return this->m_lineNumber; }
         [[maybe_unused]] constexpr void setLineNumber(u32 lineNumber) { this->m_lineNumber = lineNumber; }
 
         [[nodiscard]] virtual ASTNode* clone() const = 0;
+        [[nodiscard]] virtual Kind getKind() const = 0;
 
     private:
         u32 m_lineNumber = 1;
     };
 
+    // Cheaper replacement for dynamic_cast between node types. Returns nullptr if node is null or of another type
+    template<typename T>
+    [[nodiscard]] T* nodeCast(ASTNode *node) {
+        if (node != nullptr && node->getKind() == T::NodeKind)
+            return static_cast<T*>(node);
+        else
+            return nullptr;
+    }
+
     class ASTNodeIntegerLiteral : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::IntegerLiteral;
+
         explicit ASTNodeIntegerLiteral(Token::IntegerLiteral literal) : ASTNode(), m_literal(std::move(literal)) { }
 
         ASTNodeIntegerLiteral(const ASTNodeIntegerLiteral&) = default;
@@ -54,6 +94,8 @@ namespace hex::lang {
             return new ASTNodeIntegerLiteral(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] const auto& getValue() const {
             return this->m_literal.second;
         }
@@ -68,6 +110,8 @@ namespace hex::lang {
 
     class ASTNodeNumericExpression : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::NumericExpression;
+
         ASTNodeNumericExpression(ASTNode *left, ASTNode *right, Token::Operator op)
                 : ASTNode(), m_left(left), m_right(right), m_operator(op) { }
 
@@ -80,23 +124,33 @@ namespace hex::lang {
             this->m_operator = other.m_operator;
             this->m_left = other.m_left->clone();
             this->m_right = other.m_right->clone();
+            this->m_constantValue = other.m_constantValue;
         }
 
         [[nodiscard]] ASTNode* clone() const override {
             return new ASTNodeNumericExpression(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         ASTNode *getLeftOperand() { return this->m_left; }
         ASTNode *getRightOperand() { return this->m_right; }
         Token::Operator getOperator() { return this->m_operator; }
 
+        // Set by the validator if the expression only consists of literals, it's used instead of evaluating the operands
+        [[nodiscard]] const std::optional<Token::IntegerLiteral>& getConstantValue() const { return this->m_constantValue; }
+        void setConstantValue(const Token::IntegerLiteral &value) { this->m_constantValue = value; }
+
     private:
         ASTNode *m_left, *m_right;
         Token::Operator m_operator;
+        std::optional<Token::IntegerLiteral> m_constantValue;
     };
 
     class ASTNodeTernaryExpression : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::TernaryExpression;
+
         ASTNodeTernaryExpression(ASTNode *first, ASTNode *second, ASTNode *third, Token::Operator op)
                 : ASTNode(), m_first(first), m_second(second), m_third(third), m_operator(op) { }
 
@@ -117,6 +171,8 @@ namespace hex::lang {
             return new ASTNodeTernaryExpression(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         ASTNode *getFirstOperand() { return this->m_first; }
         ASTNode *getSecondOperand() { return this->m_second; }
         ASTNode *getThirdOperand() { return this->m_third; }
@@ -129,6 +185,8 @@ namespace hex::lang {
 
     class ASTNodeBuiltinType : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::BuiltinType;
+
         constexpr explicit ASTNodeBuiltinType(Token::ValueType type)
                 : ASTNode(), m_type(type) { }
 
@@ -138,12 +196,16 @@ namespace hex::lang {
             return new ASTNodeBuiltinType(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
     private:
         const Token::ValueType m_type;
     };
 
     class ASTNodeTypeDecl : public ASTNode, public Attributable {
     public:
+        constexpr static Kind NodeKind = Kind::TypeDecl;
+
         ASTNodeTypeDecl(std::string_view name, ASTNode *type, std::optional<std::endian> endian = { })
                 : ASTNode(), m_name(name), m_type(type), m_endian(endian) { }
 
@@ -151,6 +213,7 @@ namespace hex::lang {
             this->m_name = other.m_name;
             this->m_type = other.m_type->clone();
             this->m_endian = other.m_endian;
+            this->m_staticLayout = other.m_staticLayout;
         }
 
         ~ASTNodeTypeDecl() override {
@@ -161,18 +224,27 @@ namespace hex::lang {
             return new ASTNodeTypeDecl(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] std::string_view getName() const { return this->m_name; }
         [[nodiscard]] ASTNode* getType() { return this->m_type; }
         [[nodiscard]] std::optional<std::endian> getEndian() const { return this->m_endian; }
 
+        // Set by the validator, so the evaluator doesn't have to go through the whole type every time it needs to know
+        [[nodiscard]] std::optional<bool> hasStaticLayout() const { return this->m_staticLayout; }
+        void setStaticLayout(bool staticLayout) { this->m_staticLayout = staticLayout; }
+
     private:
         std::string m_name;
         ASTNode *m_type;
         std::optional<std::endian> m_endian;
+        std::optional<bool> m_staticLayout;
     };
 
     class ASTNodeVariableDecl : public ASTNode, public Attributable {
     public:
+        constexpr static Kind NodeKind = Kind::VariableDecl;
+
         ASTNodeVariableDecl(std::string_view name, ASTNode *type, ASTNode *placementOffset = nullptr)
                 : ASTNode(), m_name(name), m_type(type), m_placementOffset(placementOffset) { }
 
@@ -194,6 +266,8 @@ namespace hex::lang {
             return new ASTNodeVariableDecl(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] std::string_view getName() const { return this->m_name; }
         [[nodiscard]] constexpr ASTNode* getType() const { return this->m_type; }
         [[nodiscard]] constexpr auto getPlacementOffset() const { return this->m_placementOffset; }
@@ -206,6 +280,8 @@ namespace hex::lang {
 
     class ASTNodeArrayVariableDecl : public ASTNode, public Attributable {
     public:
+        constexpr static Kind NodeKind = Kind::ArrayVariableDecl;
+
         ASTNodeArrayVariableDecl(std::string_view name, ASTNode *type, ASTNode *size, ASTNode *placementOffset = nullptr)
                 : ASTNode(), m_name(name), m_type(type), m_size(size), m_placementOffset(placementOffset) { }
 
@@ -232,6 +308,8 @@ namespace hex::lang {
             return new ASTNodeArrayVariableDecl(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] std::string_view getName() const { return this->m_name; }
         [[nodiscard]] constexpr ASTNode* getType() const { return this->m_type; }
         [[nodiscard]] constexpr ASTNode* getSize() const { return this->m_size; }
@@ -246,6 +324,8 @@ namespace hex::lang {
 
     class ASTNodePointerVariableDecl : public ASTNode, public Attributable {
     public:
+        constexpr static Kind NodeKind = Kind::PointerVariableDecl;
+
         ASTNodePointerVariableDecl(std::string_view name, ASTNode *type, ASTNode *sizeType, ASTNode *placementOffset = nullptr)
                 : ASTNode(), m_name(name), m_type(type), m_sizeType(sizeType), m_placementOffset(placementOffset) { }
 
@@ -268,6 +348,8 @@ namespace hex::lang {
             return new ASTNodePointerVariableDecl(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] std::string_view getName() const { return this->m_name; }
         [[nodiscard]] constexpr ASTNode* getType() const { return this->m_type; }
         [[nodiscard]] constexpr ASTNode* getSizeType() const { return this->m_sizeType; }
@@ -282,6 +364,8 @@ namespace hex::lang {
 
     class ASTNodeStruct : public ASTNode, public Attributable {
     public:
+        constexpr static Kind NodeKind = Kind::Struct;
+
         ASTNodeStruct() : ASTNode() { }
 
         ASTNodeStruct(const ASTNodeStruct &other) : ASTNode(other), Attributable(other) {
@@ -298,6 +382,8 @@ namespace hex::lang {
             return new ASTNodeStruct(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] const std::vector<ASTNode*>& getMembers() const { return this->m_members; }
         void addMember(ASTNode *node) { this->m_members.push_back(node); }
 
@@ -307,6 +393,8 @@ namespace hex::lang {
 
     class ASTNodeUnion : public ASTNode, public Attributable {
     public:
+        constexpr static Kind NodeKind = Kind::Union;
+
         ASTNodeUnion() : ASTNode() { }
 
         ASTNodeUnion(const ASTNodeUnion &other) : ASTNode(other), Attributable(other) {
@@ -323,6 +411,8 @@ namespace hex::lang {
             return new ASTNodeUnion(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] const  std::vector<ASTNode*>& getMembers() const { return this->m_members; }
         void addMember(ASTNode *node) { this->m_members.push_back(node); }
 
@@ -332,6 +422,8 @@ namespace hex::lang {
 
     class ASTNodeEnum : public ASTNode, public Attributable {
     public:
+        constexpr static Kind NodeKind = Kind::Enum;
+
         explicit ASTNodeEnum(ASTNode *underlyingType) : ASTNode(), m_underlyingType(underlyingType) { }
 
         ASTNodeEnum(const ASTNodeEnum &other) : ASTNode(other), Attributable(other) {
@@ -350,8 +442,10 @@ namespace hex::lang {
             return new ASTNodeEnum(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] const std::unordered_map<std::string, ASTNode*>& getEntries() const { return this->m_entries; }
-        void addEntry(const std::string &name, ASTNode* expression) { this->m_entries.insert({ name, expression }); }
+        void addEntry(std::string_view name, ASTNode* expression) { this->m_entries.insert({ std::string(name), expression }); }
 
         [[nodiscard]] ASTNode *getUnderlyingType() { return this->m_underlyingType; }
 
@@ -362,6 +456,8 @@ namespace hex::lang {
 
     class ASTNodeBitfield : public ASTNode, public Attributable {
     public:
+        constexpr static Kind NodeKind = Kind::Bitfield;
+
         ASTNodeBitfield() : ASTNode() { }
 
         ASTNodeBitfield(const ASTNodeBitfield &other) : ASTNode(other), Attributable(other) {
@@ -378,8 +474,10 @@ namespace hex::lang {
             return new ASTNodeBitfield(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] const std::vector<std::pair<std::string, ASTNode*>>& getEntries() const { return this->m_entries; }
-        void addEntry(const std::string &name, ASTNode* size) { this->m_entries.emplace_back(name, size); }
+        void addEntry(std::string_view name, ASTNode* size) { this->m_entries.emplace_back(name, size); }
 
     private:
         std::vector<std::pair<std::string, ASTNode*>> m_entries;
@@ -387,6 +485,8 @@ namespace hex::lang {
 
     class ASTNodeRValue : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::RValue;
+
         explicit ASTNodeRValue(std::vector<std::string> path) : ASTNode(), m_path(std::move(path)) { }
 
         ASTNodeRValue(const ASTNodeRValue&) = default;
@@ -395,6 +495,8 @@ namespace hex::lang {
             return new ASTNodeRValue(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         const std::vector<std::string>& getPath() {
             return this->m_path;
         }
@@ -405,6 +507,8 @@ namespace hex::lang {
 
     class ASTNodeScopeResolution : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::ScopeResolution;
+
         explicit ASTNodeScopeResolution(std::vector<std::string> path) : ASTNode(), m_path(std::move(path)) { }
 
         ASTNodeScopeResolution(const ASTNodeScopeResolution&) = default;
@@ -413,6 +517,8 @@ namespace hex::lang {
             return new ASTNodeScopeResolution(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         const std::vector<std::string>& getPath() {
             return this->m_path;
         }
@@ -423,6 +529,8 @@ namespace hex::lang {
 
     class ASTNodeConditionalStatement : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::ConditionalStatement;
+
         explicit ASTNodeConditionalStatement(ASTNode *condition, std::vector<ASTNode*> trueBody, std::vector<ASTNode*> falseBody)
             : ASTNode(), m_condition(condition), m_trueBody(std::move(trueBody)), m_falseBody(std::move(falseBody)) { }
 
@@ -448,6 +556,8 @@ namespace hex::lang {
             return new ASTNodeConditionalStatement(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] ASTNode* getCondition() {
             return this->m_condition;
         }
@@ -467,6 +577,8 @@ namespace hex::lang {
 
     class ASTNodeFunctionCall : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::FunctionCall;
+
         explicit ASTNodeFunctionCall(std::string_view functionName, std::vector<ASTNode*> params)
                 : ASTNode(), m_functionName(functionName), m_params(std::move(params)) { }
 
@@ -477,6 +589,7 @@ namespace hex::lang {
 
         ASTNodeFunctionCall(const ASTNodeFunctionCall &other) : ASTNode(other) {
             this->m_functionName = other.m_functionName;
+            this->m_function = other.m_function;
 
             for (auto &param : other.m_params)
                 this->m_params.push_back(param->clone());
@@ -486,6 +599,8 @@ namespace hex::lang {
             return new ASTNodeFunctionCall(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] std::string_view getFunctionName() {
             return this->m_functionName;
         }
@@ -494,13 +609,25 @@ namespace hex::lang {
             return this->m_params;
         }
 
+        // Registered function the call got bound to by the validator, nullptr if there's none with that name
+        [[nodiscard]] const ContentRegistry::PatternLanguageFunctions::Function* getFunction() const {
+            return this->m_function;
+        }
+
+        void setFunction(const ContentRegistry::PatternLanguageFunctions::Function *function) {
+            this->m_function = function;
+        }
+
     private:
         std::string m_functionName;
         std::vector<ASTNode*> m_params;
+        const ContentRegistry::PatternLanguageFunctions::Function *m_function = nullptr;
     };
 
     class ASTNodeStringLiteral : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::StringLiteral;
+
         explicit ASTNodeStringLiteral(std::string_view string) : ASTNode(), m_string(string) { }
 
         ~ASTNodeStringLiteral() override = default;
@@ -513,6 +640,8 @@ namespace hex::lang {
             return new ASTNodeStringLiteral(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] std::string_view getString() {
             return this->m_string;
         }
@@ -523,6 +652,8 @@ namespace hex::lang {
 
     class ASTNodeAttribute : public ASTNode {
     public:
+        constexpr static Kind NodeKind = Kind::Attribute;
+
         explicit ASTNodeAttribute(std::string_view attribute, std::string_view value = { })
             : ASTNode(), m_attribute(attribute), m_value(value) { }
 
@@ -537,6 +668,8 @@ namespace hex::lang {
             return new ASTNodeAttribute(*this);
         }
 
+        [[nodiscard]] Kind getKind() const override { return NodeKind; }
+
         [[nodiscard]] std::string_view getAttribute() const {
             return this->m_attribute;
         }
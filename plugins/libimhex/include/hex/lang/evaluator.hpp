@@ -9,53 +9,161 @@
 #include <hex/lang/log_console.hpp>
 
 #include <bit>
+#include <chrono>
+#include <functional>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+namespace hex { class Task; }
+
 namespace hex::lang {
 
     class Evaluator {
     public:
+        using PatternCallback = std::function<void(PatternData*)>;
+
+        // State after a top level statement got evaluated. The evaluation of code starting with the same statements can continue from there
+        struct StatementState {
+            size_t patternCount;
+            u64 offset;
+            u32 paletteOffset;
+        };
+
+        // Limits that stop patterns running away on garbage data, set through #pragma directives. Zero disables a limit
+        struct Limits {
+            u64 patternLimit = 0x20'0000;
+            u64 arrayLimit = 0x10'0000;     // Only applies to arrays whose entries all get evaluated
+            u32 recursionLimit = 32;
+            u64 timeLimit = 0;              // In milliseconds
+            bool profile = false;           // Logs the patterns created, bytes read and time spent per type
+
+            bool operator==(const Limits &other) const = default;
+        };
+
         Evaluator() = default;
 
-        std::optional<std::vector<PatternData*>> evaluate(const std::vector<ASTNode*>& ast);
+        /*
+         * The first previousStates.size() statements get skipped, keptPatterns have to be the top level patterns they created.
+         * Kept patterns can be referenced by later statements but aren't handed to the callback, returned or deleted.
+         */
+        std::optional<std::vector<PatternData*>> evaluate(const std::vector<ASTNode*>& ast, const std::vector<StatementState> &previousStates = { }, const std::vector<PatternData*> &keptPatterns = { });
+
+        // States after every statement evaluated so far, including the skipped ones
+        [[nodiscard]] const std::vector<StatementState>& getStatementStates() const { return this->m_statementStates; }
 
         LogConsole& getConsole() { return this->m_console; }
 
         void setDefaultEndian(std::endian endian) { this->m_defaultDataEndian = endian; }
+        void setLimits(const Limits &limits) { this->m_limits = limits; }
         void setProvider(prv::Provider *provider) { this->m_provider = provider; }
+        [[nodiscard]] prv::Provider* getProvider() const { return this->m_provider; }
+        void setTask(Task *task) { this->m_task = task; }
+        void setPatternCallback(PatternCallback callback) { this->m_patternCallback = std::move(callback); }
         [[nodiscard]] std::endian getCurrentEndian() const { return this->m_endianStack.back(); }
 
         PatternData* patternFromName(const std::vector<std::string> &name);
 
+        // Aborts the evaluation if its task got cancelled. Called regularly by everything that may take long
+        void throwIfCancelled();
+
+        // Occurrences of a searched sequence found so far, in ascending order. Kept for the whole evaluation so
+        // repeated searches for the same sequence continue where the last one stopped instead of starting over
+        struct SearchCache {
+            std::vector<u64> occurrences;
+            bool complete = false;
+        };
+
+        SearchCache& getSearchCache(const std::string &key) { return this->m_searchCaches[key]; }
+
+        // Also used by the validator to fold constant expressions, so they give the same results as during evaluation
+        Token::IntegerLiteral evaluateOperator(const Token::IntegerLiteral &left, const Token::IntegerLiteral &right, Token::Operator op);
+
+        // Static types always have the same layout, no matter what data they're placed on
+        static bool isConstantExpression(ASTNode *node);
+        static bool isStaticType(ASTNode *type);
+
         template<typename T>
         T* asType(ASTNode *param) {
-            if (auto evaluatedParam = dynamic_cast<T*>(param); evaluatedParam != nullptr)
+            if (auto evaluatedParam = nodeCast<T>(param); evaluatedParam != nullptr)
                 return evaluatedParam;
             else
                 this->getConsole().abortEvaluation("function got wrong type of parameter");
         }
 
     private:
-        std::map<std::string, ASTNode*> m_types;
+        std::unordered_map<std::string, ASTNode*> m_types;
         prv::Provider* m_provider = nullptr;
+        Task *m_task = nullptr;
+        PatternCallback m_patternCallback;
         std::endian m_defaultDataEndian = std::endian::native;
         u64 m_currOffset = 0;
         std::vector<std::endian> m_endianStack;
         std::vector<PatternData*> m_globalMembers;
         std::vector<std::vector<PatternData*>*> m_currMembers;
+        // Name lookup tables for the members above, so rvalues don't have to search through all of them
+        std::unordered_map<std::string, PatternData*> m_globalMemberLookup;
+        std::vector<std::unordered_map<std::string, PatternData*>> m_currMemberLookup;
         LogConsole m_console;
+        std::vector<StatementState> m_statementStates;
+        std::unordered_map<std::string, SearchCache> m_searchCaches;
+
+        Limits m_limits;
+        u64 m_patternCount = 0;
+        u32 m_recursionDepth = 0;
+        u32 m_timeLimitCheck = 0;
+        std::chrono::steady_clock::time_point m_evaluationStart;
 
+        // Time spent also includes the types nested in a type
+        struct TypeProfile {
+            u64 patternCount = 0;
+            u64 bytesRead = 0;
+            std::chrono::steady_clock::duration time = { };
+        };
 
+        std::unordered_map<std::string, TypeProfile> m_profile;
+        std::vector<TypeProfile*> m_profileStack;
 
-        ASTNodeIntegerLiteral* evaluateScopeResolution(ASTNodeScopeResolution *node);
-        ASTNodeIntegerLiteral* evaluateRValue(ASTNodeRValue *node);
+        void countPatterns(u64 count = 1);
+        void logProfile();
+
+        // Window of the data most small reads are served from
+        constexpr static size_t ReadBufferSize = 0x1'0000;
+        std::vector<u8> m_readBuffer;
+        u64 m_readBufferOffset = 0;
+
+        void readData(u64 offset, void *buffer, size_t size);
+        [[nodiscard]] std::span<const u8> getReadWindow(u64 offset);
+
+
+
+        // Numeric expressions are evaluated into plain values, only function calls still exchange their parameters and results as nodes
+        Token::IntegerLiteral evaluateScopeResolution(ASTNodeScopeResolution *node);
+        Token::IntegerLiteral evaluateRValue(ASTNodeRValue *node);
         ASTNode* evaluateFunctionCall(ASTNodeFunctionCall *node);
-        ASTNodeIntegerLiteral* evaluateOperator(ASTNodeIntegerLiteral *left, ASTNodeIntegerLiteral *right, Token::Operator op);
-        ASTNodeIntegerLiteral* evaluateOperand(ASTNode *node);
-        ASTNodeIntegerLiteral* evaluateTernaryExpression(ASTNodeTernaryExpression *node);
-        ASTNodeIntegerLiteral* evaluateMathematicalExpression(ASTNodeNumericExpression *node);
+        Token::IntegerLiteral evaluateOperand(ASTNode *node);
+        Token::IntegerLiteral evaluateTernaryExpression(ASTNodeTernaryExpression *node);
+        Token::IntegerLiteral evaluateMathematicalExpression(ASTNodeNumericExpression *node);
+
+
+        /*
+         * Whether evaluating a node may look up variables created by earlier top level statements. Names in locals are
+         * members of the struct the node is part of that are known to exist already. Everything that isn't understood counts as a dependency.
+         */
+        static bool expressionDependsOnGlobals(ASTNode *node, const std::unordered_set<std::string_view> &locals);
+        static bool memberDependsOnGlobals(ASTNode *member, std::unordered_set<std::string_view> &locals);
+        static bool typeDependsOnGlobals(ASTNode *type);
+
+        // Placements at a constant offset that don't depend on other variables can be evaluated on their own, in parallel to each other.
+        // Returns the end of the run of such placements starting at statement, or statement itself if evaluating them in parallel isn't worth it
+        size_t findIndependentPlacements(const std::vector<ASTNode*> &ast, size_t statement);
+        void evaluateIndependentPlacements(const std::vector<ASTNode*> &ast, size_t begin, size_t end, const PatternCallback &addGlobalMember);
+
+        void pushMemberScope(std::vector<PatternData*> &members);
+        void popMemberScope();
+        void addMember(std::vector<PatternData*> &members, PatternData *pattern);
 
         PatternData* evaluateAttributes(ASTNode *currNode, PatternData *currPattern);
         PatternData* evaluateBuiltinType(ASTNodeBuiltinType *node);
@@ -68,6 +176,7 @@ namespace hex::lang {
         PatternData* evaluateVariable(ASTNodeVariableDecl *node);
         PatternData* evaluateArray(ASTNodeArrayVariableDecl *node);
         PatternData* evaluatePointer(ASTNodePointerVariableDecl *node);
+        PatternData* evaluatePlacement(ASTNode *node);
     };
 
 }
\ No newline at end of file
@@ -16,6 +16,7 @@ namespace hex::lang {
 
         Lexer();
 
+        // Identifier tokens point into the code, so it has to outlive them
         std::optional<std::vector<Token>> lex(const std::string& code);
         const LexerError& getError() { return this->m_error; }
 
@@ -2,6 +2,7 @@
 
 #include <hex.hpp>
 
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -18,11 +19,18 @@ namespace hex::lang {
             Error
         };
 
-        const auto& getLog() { return this->m_consoleLog; }
+        // Returns a copy since messages may still get logged by an evaluation running on another thread
+        std::vector<std::pair<Level, std::string>> getLog() {
+            std::scoped_lock lock(this->m_mutex);
+
+            return this->m_consoleLog;
+        }
 
         using EvaluateError = std::string;
 
         void log(Level level, std::string_view message) {
+            std::scoped_lock lock(this->m_mutex);
+
             switch (level) {
                 default:
                 case Level::Debug:   this->m_consoleLog.emplace_back(level, "[-] " + std::string(message)); break;
@@ -32,16 +40,26 @@ namespace hex::lang {
             }
         }
 
+        // Adds messages taken from another console with getLog()
+        void append(const std::vector<std::pair<Level, std::string>> &messages) {
+            std::scoped_lock lock(this->m_mutex);
+
+            this->m_consoleLog.insert(this->m_consoleLog.end(), messages.begin(), messages.end());
+        }
+
         [[noreturn]] void abortEvaluation(std::string_view message) {
             throw EvaluateError(message);
         }
 
         void clear() {
+            std::scoped_lock lock(this->m_mutex);
+
             this->m_consoleLog.clear();
         }
 
     private:
         std::vector<std::pair<Level, std::string>> m_consoleLog;
+        std::mutex m_mutex;
     };
 
 }
\ No newline at end of file
@@ -7,7 +7,7 @@
 
 #include <hex/helpers/utils.hpp>
 
-#include <unordered_map>
+#include <map>
 #include <stdexcept>
 #include <utility>
 #include <vector>
@@ -25,12 +25,16 @@ namespace hex::lang {
         std::optional<std::vector<ASTNode*>> parse(const std::vector<Token> &tokens);
         const ParseError& getError() { return this->m_error; }
 
+        // Index of the token following each top level statement of the last parsed program
+        [[nodiscard]] const std::vector<size_t>& getStatementEnds() const { return this->m_statementEnds; }
+
     private:
         ParseError m_error;
+        std::vector<size_t> m_statementEnds;
         TokenIter m_curr;
         TokenIter m_originalPosition;
 
-        std::unordered_map<std::string, ASTNode*> m_types;
+        std::map<std::string, ASTNode*, std::less<>> m_types;
         std::vector<TokenIter> m_matchedOptionals;
 
         u32 getLineNumber(s32 index) const {
@@ -57,17 +61,7 @@ namespace hex::lang {
         ASTNode* parseRValue(std::vector<std::string> &path);
         ASTNode* parseFactor();
         ASTNode* parseUnaryExpression();
-        ASTNode* parseMultiplicativeExpression();
-        ASTNode* parseAdditiveExpression();
-        ASTNode* parseShiftExpression();
-        ASTNode* parseRelationExpression();
-        ASTNode* parseEqualityExpression();
-        ASTNode* parseBinaryAndExpression();
-        ASTNode* parseBinaryXorExpression();
-        ASTNode* parseBinaryOrExpression();
-        ASTNode* parseBooleanAnd();
-        ASTNode* parseBooleanXor();
-        ASTNode* parseBooleanOr();
+        ASTNode* parseBinaryExpression(u8 minPrecedence = 1);
         ASTNode* parseTernaryConditional();
         ASTNode* parseMathematicalExpression();
 
@@ -4,14 +4,22 @@
 
 #include <imgui.h>
 
+#include <hex/api/task.hpp>
 #include <hex/providers/provider.hpp>
 #include <hex/helpers/utils.hpp>
+#include <hex/helpers/highlight_index.hpp>
+#include <hex/helpers/memory_arena.hpp>
+#include <hex/helpers/result_sort.hpp>
 #include <hex/lang/token.hpp>
 #include <hex/views/view.hpp>
 
 #include <cstring>
+#include <limits>
+#include <numeric>
 #include <random>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace hex::lang {
 
@@ -38,23 +46,28 @@ namespace hex::lang {
 
     class PatternData {
     public:
+        constexpr static u32 Palette[] = { 0x70b4771f, 0x700e7fff, 0x702ca02c, 0x702827d6, 0x70bd6794, 0x704b568c, 0x70c277e3, 0x707f7f7f, 0x7022bdbc, 0x70cfbe17 };
+
         PatternData(u64 offset, size_t size, u32 color = 0)
         : m_offset(offset), m_size(size), m_color(color) {
-            constexpr u32 Palette[] = { 0x70b4771f, 0x700e7fff, 0x702ca02c, 0x702827d6, 0x70bd6794, 0x704b568c, 0x70c277e3, 0x707f7f7f, 0x7022bdbc, 0x70cfbe17 };
-
             if (color != 0)
                 return;
 
-            this->m_color = Palette[SharedData::patternPaletteOffset++];
+            auto &paletteOffset = SharedData::getPatternPaletteOffset();
+            this->m_color = Palette[paletteOffset++];
 
-            if (SharedData::patternPaletteOffset >= (sizeof(Palette) / sizeof(u32)))
-                SharedData::patternPaletteOffset = 0;
+            if (paletteOffset >= (sizeof(Palette) / sizeof(u32)))
+                paletteOffset = 0;
         }
         virtual ~PatternData() = default;
 
+        static void* operator new(size_t size) { return MemoryArena::allocateObject(size); }
+        static void operator delete(void *pointer, size_t size) { MemoryArena::deallocateObject(pointer, size); }
+
         virtual PatternData* clone() = 0;
 
         [[nodiscard]] u64 getOffset() const { return this->m_offset; }
+        virtual void setOffset(u64 offset) { this->m_offset = offset; }
         [[nodiscard]] size_t getSize() const { return this->m_size; }
 
         [[nodiscard]] const std::string& getVariableName() const { return this->m_variableName; }
@@ -72,117 +85,128 @@ namespace hex::lang {
         [[nodiscard]] std::endian getEndian() const { return this->m_endian; }
         void setEndian(std::endian endian) { this->m_endian = endian; }
 
-        virtual void createEntry(prv::Provider* &provider) = 0;
         [[nodiscard]] virtual std::string getFormattedName() const = 0;
 
-        virtual std::optional<u32> highlightBytes(size_t offset) {
-            auto currOffset = this->getOffset();
-            if (offset >= currOffset && offset < (currOffset + this->getSize()))
-                return this->getColor();
-            else
-                return { };
+        // Value and type columns of the pattern data view. Composite patterns are drawn without color, their members show theirs
+        [[nodiscard]] virtual std::string formatDisplayValue(prv::Provider *provider) { return ""; }
+        virtual void drawTypeName() const { ImGui::TextColored(ImColor(0xFF9BC64D), "%s", this->getFormattedName().c_str()); }
+        [[nodiscard]] virtual bool showsColor() const { return true; }
+
+        // The formatted value is cached until the provider's data changes or the pattern gets moved
+        [[nodiscard]] const std::string& getDisplayValue(prv::Provider *provider) {
+            const u64 generation = provider->getDataGeneration();
+
+            auto &cache = this->m_displayValue;
+            if (!cache.has_value() || cache->provider != provider || cache->generation != generation || cache->offset != this->getOffset())
+                cache = { provider, generation, this->getOffset(), this->formatDisplayValue(provider) };
+
+            return cache->value;
         }
 
-        virtual std::map<u64, u32> getHighlightedAddresses() {
-            if (this->m_highlightedAddresses.empty()) {
-                for (u64 i = 0; i < this->getSize(); i++)
-                    this->m_highlightedAddresses.insert({ this->getOffset() + i, this->getColor() });
+        void drawCommentTooltip() const {
+            if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem) && this->getComment().has_value()) {
+                ImGui::BeginTooltip();
+                ImGui::TextUnformatted(this->getComment()->c_str());
+                ImGui::EndTooltip();
             }
+        }
 
-            return this->m_highlightedAddresses;
+        // Adds the ranges of bytes the pattern highlights in the hex editor. Composite patterns add those of their members instead,
+        // so the index gets the colors of the innermost patterns and merges neighbouring ranges of the same color
+        virtual void addHighlightedRegions(HighlightIndex &index) {
+            index.add(this->getOffset(), this->getSize(), this->getColor());
         }
 
         virtual void sort(ImGuiTableSortSpecs *sortSpecs, prv::Provider *provider) { }
 
-        static bool sortPatternDataTable(ImGuiTableSortSpecs *sortSpecs, prv::Provider *provider, lang::PatternData* left, lang::PatternData* right) {
-            if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("name")) {
-                if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                    return left->getVariableName() > right->getVariableName();
-                else
-                    return left->getVariableName() < right->getVariableName();
-            }
-            else if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("offset")) {
-                if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                    return left->getOffset() > right->getOffset();
-                else
-                    return left->getOffset() < right->getOffset();
-            }
-            else if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("size")) {
-                if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                    return left->getSize() > right->getSize();
-                else
-                    return left->getSize() < right->getSize();
-            }
-            else if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("value")) {
-                size_t biggerSize = std::max(left->getSize(), right->getSize());
-                std::vector<u8> leftBuffer(biggerSize, 0x00), rightBuffer(biggerSize, 0x00);
+        // Only the start of bigger values is compared, so the sort keys of all patterns can be stored in one buffer
+        constexpr static size_t MaxSortKeySize = 0x100;
 
-                provider->read(left->getOffset(), leftBuffer.data(), left->getSize());
-                provider->read(right->getOffset(), rightBuffer.data(), right->getSize());
+        // Sorts by the table's sort column. Values are read once per pattern up front, instead of twice for every comparison
+        static void sortPatterns(ImGuiTableSortSpecs *sortSpecs, prv::Provider *provider, std::vector<PatternData*> &patterns) {
+            if (patterns.size() < 2 || sortSpecs->SpecsCount == 0)
+                return;
 
-                if (left->m_endian != std::endian::native)
-                    std::reverse(leftBuffer.begin(), leftBuffer.end());
-                if (right->m_endian != std::endian::native)
-                    std::reverse(rightBuffer.begin(), rightBuffer.end());
+            const auto column = sortSpecs->Specs->ColumnUserID;
+            const bool inverted = sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending;
 
-                if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                    return leftBuffer > rightBuffer;
-                else
-                    return leftBuffer < rightBuffer;
-            }
-            else if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("type")) {
-                if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                    return left->getTypeName() > right->getTypeName();
-                else
-                    return left->getTypeName() < right->getTypeName();
-            }
-            else if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("color")) {
-                if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                    return left->getColor() > right->getColor();
-                else
-                    return left->getColor() < right->getColor();
-            }
+            auto sortByNumber = [&](auto getKey) {
+                std::vector<u64> keys;
+                keys.reserve(patterns.size());
+                for (auto &pattern : patterns)
+                    keys.push_back(getKey(pattern));
 
-            return false;
-        }
+                ResultSort::apply(patterns, ResultSort::byNumber(keys, inverted));
+            };
 
-        static void resetPalette() { SharedData::patternPaletteOffset = 0; }
+            // The strings are owned by the patterns, they don't get copied
+            auto sortByString = [&](auto getKey) {
+                std::vector<std::string_view> keys;
+                keys.reserve(patterns.size());
+                for (auto &pattern : patterns)
+                    keys.push_back(getKey(pattern));
 
-    protected:
-        void createDefaultEntry(std::string_view value) const {
-            ImGui::TableNextRow();
-            ImGui::TreeNodeEx(this->getVariableName().c_str(), ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowItemOverlap);
-            ImGui::TableNextColumn();
-            if (ImGui::Selectable(("##PatternDataLine"s + std::to_string(this->getOffset())).c_str(), false, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowItemOverlap)) {
-                Region selectRegion = { this->getOffset(), this->getSize() };
-                View::postEvent(Events::SelectionChangeRequest, selectRegion);
-            }
-            this->drawCommentTooltip();
-            ImGui::SameLine();
-            ImGui::Text("%s", this->getVariableName().c_str());
-            ImGui::TableNextColumn();
-            ImGui::ColorButton("color", ImColor(this->getColor()), ImGuiColorEditFlags_NoTooltip, ImVec2(ImGui::GetColumnWidth(), ImGui::GetTextLineHeight()));
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%08llX : 0x%08llX", this->getOffset(), this->getOffset() + this->getSize() - 1);
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%04llX", this->getSize());
-            ImGui::TableNextColumn();
-            ImGui::TextColored(ImColor(0xFF9BC64D), "%s", this->getFormattedName().c_str());
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", value.data());
+                ResultSort::apply(patterns, ResultSort::byString(keys, inverted));
+            };
+
+            if (column == ImGui::GetID("name"))
+                sortByString([](PatternData *pattern) -> const std::string& { return pattern->getVariableName(); });
+            else if (column == ImGui::GetID("offset"))
+                sortByNumber([](PatternData *pattern) { return pattern->getOffset(); });
+            else if (column == ImGui::GetID("size"))
+                sortByNumber([](PatternData *pattern) { return pattern->getSize(); });
+            else if (column == ImGui::GetID("value"))
+                sortByValue(provider, patterns, inverted);
+            else if (column == ImGui::GetID("type"))
+                sortByString([](PatternData *pattern) -> const std::string& { return pattern->getTypeName(); });
+            else if (column == ImGui::GetID("color"))
+                sortByNumber([](PatternData *pattern) { return pattern->getColor(); });
         }
 
-        void drawCommentTooltip() const {
-            if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem) && this->getComment().has_value()) {
-                ImGui::BeginTooltip();
-                ImGui::TextUnformatted(this->getComment()->c_str());
-                ImGui::EndTooltip();
-            }
+        static void resetPalette() { SharedData::getPatternPaletteOffset() = 0; }
+
+    private:
+        // Values are zero padded to the size of the biggest one and compared byte by byte, the ones not in native endianness reversed
+        static void sortByValue(prv::Provider *provider, std::vector<PatternData*> &patterns, bool inverted) {
+            size_t keySize = 0;
+            for (auto &pattern : patterns)
+                keySize = std::max(keySize, pattern->getSize());
+            keySize = std::min(keySize, MaxSortKeySize);
+
+            if (keySize == 0)
+                return;
+
+            std::vector<u8> keys(patterns.size() * keySize, 0x00);
+
+            auto extractKeys = [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; i++) {
+                    u8 *key = &keys[i * keySize];
+
+                    provider->readAbsolute(patterns[i]->getOffset(), key, std::min(patterns[i]->getSize(), keySize));
+                    if (patterns[i]->m_endian != std::endian::native)
+                        std::reverse(key, key + keySize);
+                }
+            };
+
+            // Reading the values is what takes time with big tables, the provider can be read from multiple threads
+            constexpr static size_t PatternsPerSlice = 0x1000;
+            Task sorting("Sorting patterns", TaskPriority::Interactive);
+
+            TaskManager::parallelFor(sorting, (patterns.size() + PatternsPerSlice - 1) / PatternsPerSlice, [&](size_t slice) {
+                extractKeys(slice * PatternsPerSlice, std::min(patterns.size(), (slice + 1) * PatternsPerSlice));
+            });
+
+            // Keys all have the same size, so comparing them as strings is comparing their bytes
+            std::vector<std::string_view> keyStrings;
+            keyStrings.reserve(patterns.size());
+            for (size_t i = 0; i < patterns.size(); i++)
+                keyStrings.emplace_back(reinterpret_cast<const char*>(&keys[i * keySize]), keySize);
+
+            ResultSort::apply(patterns, ResultSort::byString(keyStrings, inverted));
         }
 
     protected:
         std::endian m_endian = std::endian::native;
-        std::map<u64, u32> m_highlightedAddresses;
 
     private:
         u64 m_offset;
@@ -192,6 +216,14 @@ namespace hex::lang {
         std::string m_variableName;
         std::optional<std::string> m_comment;
         std::string m_typeName;
+
+        struct DisplayValueCache {
+            const prv::Provider *provider;
+            u64 generation;
+            u64 offset;
+            std::string value;
+        };
+        std::optional<DisplayValueCache> m_displayValue;
     };
 
     class PatternDataPadding : public PatternData {
@@ -202,9 +234,6 @@ namespace hex::lang {
             return new PatternDataPadding(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
-        }
-
         [[nodiscard]] std::string getFormattedName() const override {
             return "";
         }
@@ -217,56 +246,31 @@ namespace hex::lang {
             this->m_pointedAt->setVariableName("*" + this->m_pointedAt->getVariableName());
         }
 
+        PatternDataPointer(const PatternDataPointer &other) : PatternData(other), m_pointedAt(other.m_pointedAt->clone()) { }
+
+        ~PatternDataPointer() override {
+            delete this->m_pointedAt;
+        }
+
         PatternData* clone() override {
             return new PatternDataPointer(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
+        std::string formatDisplayValue(prv::Provider *provider) override {
             u64 data = 0;
-            provider->read(this->getOffset(), &data, this->getSize());
+            provider->readAbsolute(this->getOffset(), &data, this->getSize());
             data = hex::changeEndianess(data, this->getSize(), this->getEndian());
 
-            ImGui::TableNextRow();
-            ImGui::TableNextColumn();
-            bool open = ImGui::TreeNodeEx(this->getVariableName().c_str(), ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowItemOverlap);
-            this->drawCommentTooltip();
-            ImGui::TableNextColumn();
-            ImGui::ColorButton("color", ImColor(this->getColor()), ImGuiColorEditFlags_NoTooltip, ImVec2(ImGui::GetColumnWidth(), ImGui::GetTextLineHeight()));
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%08llX : 0x%08llX", this->getOffset(), this->getOffset() + this->getSize() - 1);
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%04llX", this->getSize());
-            ImGui::TableNextColumn();
-            ImGui::TextColored(ImColor(0xFF9BC64D), "%s*", this->m_pointedAt->getFormattedName().c_str());
-            ImGui::TableNextColumn();
-            ImGui::Text("*(0x%llX)", data);
-
-            if (open) {
-                this->m_pointedAt->createEntry(provider);
-
-                ImGui::TreePop();
-            }
+            return hex::format("*(0x%llX)", data);
         }
 
-        std::optional<u32> highlightBytes(size_t offset) override {
-            if (offset >= this->getOffset() && offset < (this->getOffset() + this->getSize()))
-                return this->getColor();
-            else if (auto color = this->m_pointedAt->highlightBytes(offset); color.has_value())
-                return color.value();
-            else
-                return { };
+        void drawTypeName() const override {
+            ImGui::TextColored(ImColor(0xFF9BC64D), "%s*", this->m_pointedAt->getFormattedName().c_str());
         }
 
-        std::map<u64, u32> getHighlightedAddresses() override {
-            if (this->m_highlightedAddresses.empty()) {
-                auto ownAddresses = PatternData::getHighlightedAddresses();
-                auto pointedToAddresses = this->m_pointedAt->getHighlightedAddresses();
-
-                ownAddresses.merge(pointedToAddresses);
-                this->m_highlightedAddresses = ownAddresses;
-            }
-
-            return this->m_highlightedAddresses;
+        void addHighlightedRegions(HighlightIndex &index) override {
+            PatternData::addHighlightedRegions(index);
+            this->m_pointedAt->addHighlightedRegions(index);
         }
         [[nodiscard]] std::string getFormattedName() const override {
             return "Pointer";
@@ -289,12 +293,12 @@ namespace hex::lang {
             return new PatternDataUnsigned(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
+        std::string formatDisplayValue(prv::Provider *provider) override {
             u64 data = 0;
-            provider->read(this->getOffset(), &data, this->getSize());
+            provider->readAbsolute(this->getOffset(), &data, this->getSize());
             data = hex::changeEndianess(data, this->getSize(), this->getEndian());
 
-            this->createDefaultEntry(hex::format("%llu (0x%0*llX)", data, this->getSize() * 2, data));
+            return hex::format("%llu (0x%0*llX)", data, this->getSize() * 2, data);
         }
 
         [[nodiscard]] std::string getFormattedName() const override {
@@ -318,14 +322,14 @@ namespace hex::lang {
             return new PatternDataSigned(*this);
         }
 
-       void createEntry(prv::Provider* &provider) override {
+        std::string formatDisplayValue(prv::Provider *provider) override {
             u64 data = 0;
-            provider->read(this->getOffset(), &data, this->getSize());
+            provider->readAbsolute(this->getOffset(), &data, this->getSize());
             data = hex::changeEndianess(data, this->getSize(), this->getEndian());
 
             s64 signedData = hex::signExtend(data, this->getSize(), 64);
 
-           this->createDefaultEntry(hex::format("%lld (0x%0*llX)", signedData, this->getSize() * 2, data));
+            return hex::format("%lld (0x%0*llX)", signedData, this->getSize() * 2, data);
         }
 
         [[nodiscard]] std::string getFormattedName() const override {
@@ -349,20 +353,22 @@ namespace hex::lang {
             return new PatternDataFloat(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
+        std::string formatDisplayValue(prv::Provider *provider) override {
             if (this->getSize() == 4) {
                 u32 data = 0;
-                provider->read(this->getOffset(), &data, 4);
+                provider->readAbsolute(this->getOffset(), &data, 4);
                 data = hex::changeEndianess(data, 4, this->getEndian());
 
-                this->createDefaultEntry(hex::format("%e (0x%0*lX)", *reinterpret_cast<float*>(&data), this->getSize() * 2, data));
+                return hex::format("%e (0x%0*lX)", *reinterpret_cast<float*>(&data), this->getSize() * 2, data);
             } else if (this->getSize() == 8) {
                 u64 data = 0;
-                provider->read(this->getOffset(), &data, 8);
+                provider->readAbsolute(this->getOffset(), &data, 8);
                 data = hex::changeEndianess(data, 8, this->getEndian());
 
-                this->createDefaultEntry(hex::format("%e (0x%0*llX)", *reinterpret_cast<double*>(&data), this->getSize() * 2, data));
+                return hex::format("%e (0x%0*llX)", *reinterpret_cast<double*>(&data), this->getSize() * 2, data);
             }
+
+            return "";
         }
 
         [[nodiscard]] std::string getFormattedName() const override {
@@ -383,16 +389,16 @@ namespace hex::lang {
             return new PatternDataBoolean(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
+        std::string formatDisplayValue(prv::Provider *provider) override {
             u8 boolean;
-            provider->read(this->getOffset(), &boolean, 1);
+            provider->readAbsolute(this->getOffset(), &boolean, 1);
 
             if (boolean == 0)
-                this->createDefaultEntry("false");
+                return "false";
             else if (boolean == 1)
-                this->createDefaultEntry("true");
+                return "true";
             else
-                this->createDefaultEntry("true*");
+                return "true*";
         }
 
         [[nodiscard]] std::string getFormattedName() const override {
@@ -409,11 +415,11 @@ namespace hex::lang {
             return new PatternDataCharacter(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
+        std::string formatDisplayValue(prv::Provider *provider) override {
             char character;
-            provider->read(this->getOffset(), &character, 1);
+            provider->readAbsolute(this->getOffset(), &character, 1);
 
-            this->createDefaultEntry(hex::format("'%c'", character));
+            return hex::format("'%c'", character);
         }
 
         [[nodiscard]] std::string getFormattedName() const override {
@@ -430,12 +436,12 @@ namespace hex::lang {
             return new PatternDataString(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
+        std::string formatDisplayValue(prv::Provider *provider) override {
             std::vector<u8> buffer(this->getSize() + 1, 0x00);
-            provider->read(this->getOffset(), buffer.data(), this->getSize());
+            provider->readAbsolute(this->getOffset(), buffer.data(), this->getSize());
             buffer[this->getSize()] = '\0';
 
-            this->createDefaultEntry(hex::format("\"%s\"", makeDisplayable(buffer.data(), this->getSize()).c_str()));
+            return hex::format("\"%s\"", makeDisplayable(buffer.data(), this->getSize()).c_str());
         }
 
         [[nodiscard]] std::string getFormattedName() const override {
@@ -453,25 +459,20 @@ namespace hex::lang {
                 this->m_entries.push_back(entry->clone());
         }
 
+        ~PatternDataArray() override {
+            for (auto &entry : this->m_entries)
+                delete entry;
+        }
+
         PatternData* clone() override {
             return new PatternDataArray(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
-            if (this->m_entries.empty())
-                return;
+        std::string formatDisplayValue(prv::Provider *provider) override {
+            return "{ ... }";
+        }
 
-            ImGui::TableNextRow();
-            ImGui::TableNextColumn();
-            bool open = ImGui::TreeNodeEx(this->getVariableName().c_str(), ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowItemOverlap);
-            this->drawCommentTooltip();
-            ImGui::TableNextColumn();
-            ImGui::ColorButton("color", ImColor(this->getColor()), ImGuiColorEditFlags_NoTooltip, ImVec2(ImGui::GetColumnWidth(), ImGui::GetTextLineHeight()));
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%08llX : 0x%08llX", this->getOffset(), this->getOffset() + this->getSize() - 1);
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%04llX", this->getSize());
-            ImGui::TableNextColumn();
+        void drawTypeName() const override {
             ImGui::TextColored(ImColor(0xFF9BC64D), "%s", this->m_entries[0]->getTypeName().c_str());
             ImGui::SameLine(0, 0);
 
@@ -480,40 +481,27 @@ namespace hex::lang {
             ImGui::TextColored(ImColor(0xFF00FF00), "%llu", this->m_entries.size());
             ImGui::SameLine(0, 0);
             ImGui::TextUnformatted("]");
-
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", "{ ... }");
-
-            if (open) {
-                for (auto &member : this->m_entries)
-                    member->createEntry(provider);
-
-                ImGui::TreePop();
-            }
         }
 
-        std::optional<u32> highlightBytes(size_t offset) override{
-            for (auto &entry : this->m_entries) {
-                if (auto color = entry->highlightBytes(offset); color.has_value())
-                    return color.value();
-            }
+        void setOffset(u64 offset) override {
+            for (auto &entry : this->m_entries)
+                entry->setOffset(entry->getOffset() - this->getOffset() + offset);
 
-            return { };
+            PatternData::setOffset(offset);
         }
 
-        std::map<u64, u32> getHighlightedAddresses() override {
-            if (this->m_highlightedAddresses.empty()) {
-                for (auto &entry : this->m_entries) {
-                    this->m_highlightedAddresses.merge(entry->getHighlightedAddresses());
-                }
-            }
-
-            return this->m_highlightedAddresses;
+        void addHighlightedRegions(HighlightIndex &index) override {
+            for (auto &entry : this->m_entries)
+                entry->addHighlightedRegions(index);
         }
         [[nodiscard]] std::string getFormattedName() const override {
             return this->m_entries[0]->getTypeName() + "[" + std::to_string(this->m_entries.size()) + "]";
         }
 
+        const auto& getEntries() const {
+            return this->m_entries;
+        }
+
     private:
         std::vector<PatternData*> m_entries;
     };
@@ -526,61 +514,44 @@ namespace hex::lang {
         PatternDataStruct(const PatternDataStruct &other) : PatternData(other.getOffset(), other.getSize(), other.getColor()) {
             for (const auto &member : other.m_members)
                 this->m_members.push_back(member->clone());
+            this->m_sortedMembers = this->m_members;
+        }
+
+        ~PatternDataStruct() override {
+            for (auto &member : this->m_members)
+                delete member;
         }
 
         PatternData* clone() override {
             return new PatternDataStruct(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
-            ImGui::TableNextRow();
-            ImGui::TableNextColumn();
-            bool open = ImGui::TreeNodeEx(this->getVariableName().c_str(), ImGuiTreeNodeFlags_SpanFullWidth);
-            this->drawCommentTooltip();
-            ImGui::TableNextColumn();
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%08llX : 0x%08llX", this->getOffset(), this->getOffset() + this->getSize() - (this->getSize() == 0 ? 0 : 1));
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%04llX", this->getSize());
-            ImGui::TableNextColumn();
-            ImGui::TextColored(ImColor(0xFFD69C56), "struct"); ImGui::SameLine(); ImGui::Text("%s", this->getTypeName().c_str());
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", "{ ... }");
-
-            if (open) {
-                for (auto &member : this->m_sortedMembers)
-                    member->createEntry(provider);
-
-                ImGui::TreePop();
-            }
+        std::string formatDisplayValue(prv::Provider *provider) override {
+            return "{ ... }";
+        }
 
+        void drawTypeName() const override {
+            ImGui::TextColored(ImColor(0xFFD69C56), "struct"); ImGui::SameLine(); ImGui::Text("%s", this->getTypeName().c_str());
         }
 
-        std::optional<u32> highlightBytes(size_t offset) override{
-            for (auto &member : this->m_members) {
-                if (auto color = member->highlightBytes(offset); color.has_value())
-                    return color.value();
-            }
+        [[nodiscard]] bool showsColor() const override { return false; }
 
-            return { };
-        }
+        void setOffset(u64 offset) override {
+            for (auto &member : this->m_members)
+                member->setOffset(member->getOffset() - this->getOffset() + offset);
 
-        std::map<u64, u32> getHighlightedAddresses() override {
-            if (this->m_highlightedAddresses.empty()) {
-                for (auto &member : this->m_members) {
-                    this->m_highlightedAddresses.merge(member->getHighlightedAddresses());
-                }
-            }
+            PatternData::setOffset(offset);
+        }
 
-            return this->m_highlightedAddresses;
+        void addHighlightedRegions(HighlightIndex &index) override {
+            for (auto &member : this->m_members)
+                member->addHighlightedRegions(index);
         }
 
         void sort(ImGuiTableSortSpecs *sortSpecs, prv::Provider *provider) override {
             this->m_sortedMembers = this->m_members;
 
-            std::sort(this->m_sortedMembers.begin(), this->m_sortedMembers.end(), [&sortSpecs, &provider](PatternData *left, PatternData *right) {
-                return PatternData::sortPatternDataTable(sortSpecs, provider, left, right);
-            });
+            PatternData::sortPatterns(sortSpecs, provider, this->m_sortedMembers);
 
             for (auto &member : this->m_members)
                 member->sort(sortSpecs, provider);
@@ -594,9 +565,28 @@ namespace hex::lang {
             return this->m_members;
         }
 
+        // Members in the order the pattern data view shows them
+        const auto& getSortedMembers() const {
+            return this->m_sortedMembers;
+        }
+
+        // The lookup table is built on first use, members are never renamed once the struct exists
+        [[nodiscard]] PatternData* getMember(const std::string &name) const {
+            if (this->m_memberLookup.empty()) {
+                for (auto &member : this->m_members)
+                    this->m_memberLookup.try_emplace(member->getVariableName(), member);
+            }
+
+            if (auto member = this->m_memberLookup.find(name); member != this->m_memberLookup.end())
+                return member->second;
+            else
+                return nullptr;
+        }
+
     private:
         std::vector<PatternData*> m_members;
         std::vector<PatternData*> m_sortedMembers;
+        mutable std::unordered_map<std::string, PatternData*> m_memberLookup;
     };
 
     class PatternDataUnion : public PatternData {
@@ -607,62 +597,44 @@ namespace hex::lang {
         PatternDataUnion(const PatternDataUnion &other) : PatternData(other.getOffset(), other.getSize(), other.getColor()) {
             for (const auto &member : other.m_members)
                 this->m_members.push_back(member->clone());
+            this->m_sortedMembers = this->m_members;
+        }
+
+        ~PatternDataUnion() override {
+            for (auto &member : this->m_members)
+                delete member;
         }
 
         PatternData* clone() override {
             return new PatternDataUnion(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
-            ImGui::TableNextRow();
-            ImGui::TableNextColumn();
-            bool open = ImGui::TreeNodeEx(this->getVariableName().c_str(), ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowItemOverlap);
-            this->drawCommentTooltip();
-            ImGui::TableNextColumn();
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%08llX : 0x%08llX", this->getOffset(), std::max(this->getOffset() + this->getSize() - (this->getSize() == 0 ? 0 : 1), u64(0)));
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%04llX", this->getSize());
-            ImGui::TableNextColumn();
-            ImGui::TextColored(ImColor(0xFFD69C56), "union"); ImGui::SameLine(); ImGui::Text("%s", PatternData::getTypeName().c_str());
-
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", "{ ... }");
-
-            if (open) {
-                for (auto &member : this->m_sortedMembers)
-                    member->createEntry(provider);
-
-                ImGui::TreePop();
-            }
+        std::string formatDisplayValue(prv::Provider *provider) override {
+            return "{ ... }";
+        }
 
+        void drawTypeName() const override {
+            ImGui::TextColored(ImColor(0xFFD69C56), "union"); ImGui::SameLine(); ImGui::Text("%s", PatternData::getTypeName().c_str());
         }
 
-        std::optional<u32> highlightBytes(size_t offset) override{
-            for (auto &member : this->m_members) {
-                if (auto color = member->highlightBytes(offset); color.has_value())
-                    return color.value();
-            }
+        [[nodiscard]] bool showsColor() const override { return false; }
 
-            return { };
-        }
+        void setOffset(u64 offset) override {
+            for (auto &member : this->m_members)
+                member->setOffset(member->getOffset() - this->getOffset() + offset);
 
-        std::map<u64, u32> getHighlightedAddresses() override {
-            if (this->m_highlightedAddresses.empty()) {
-                for (auto &member : this->m_members) {
-                    this->m_highlightedAddresses.merge(member->getHighlightedAddresses());
-                }
-            }
+            PatternData::setOffset(offset);
+        }
 
-            return this->m_highlightedAddresses;
+        void addHighlightedRegions(HighlightIndex &index) override {
+            for (auto &member : this->m_members)
+                member->addHighlightedRegions(index);
         }
 
         void sort(ImGuiTableSortSpecs *sortSpecs, prv::Provider *provider) override {
             this->m_sortedMembers = this->m_members;
 
-            std::sort(this->m_sortedMembers.begin(), this->m_sortedMembers.end(), [&sortSpecs, &provider](PatternData *left, PatternData *right) {
-                return PatternData::sortPatternDataTable(sortSpecs, provider, left, right);
-            });
+            PatternData::sortPatterns(sortSpecs, provider, this->m_sortedMembers);
 
             for (auto &member : this->m_members)
                 member->sort(sortSpecs, provider);
@@ -676,9 +648,28 @@ namespace hex::lang {
             return this->m_members;
         }
 
+        // Members in the order the pattern data view shows them
+        const auto& getSortedMembers() const {
+            return this->m_sortedMembers;
+        }
+
+        // The lookup table is built on first use, members are never renamed once the union exists
+        [[nodiscard]] PatternData* getMember(const std::string &name) const {
+            if (this->m_memberLookup.empty()) {
+                for (auto &member : this->m_members)
+                    this->m_memberLookup.try_emplace(member->getVariableName(), member);
+            }
+
+            if (auto member = this->m_memberLookup.find(name); member != this->m_memberLookup.end())
+                return member->second;
+            else
+                return nullptr;
+        }
+
     private:
         std::vector<PatternData*> m_members;
         std::vector<PatternData*> m_sortedMembers;
+        mutable std::unordered_map<std::string, PatternData*> m_memberLookup;
     };
 
     class PatternDataEnum : public PatternData {
@@ -690,9 +681,9 @@ namespace hex::lang {
             return new PatternDataEnum(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
+        std::string formatDisplayValue(prv::Provider *provider) override {
             u64 value = 0;
-            provider->read(this->getOffset(), &value, this->getSize());
+            provider->readAbsolute(this->getOffset(), &value, this->getSize());
             value = hex::changeEndianess(value, this->getSize(), this->getEndian());
 
             std::string valueString = PatternData::getTypeName() + "::";
@@ -715,26 +706,11 @@ namespace hex::lang {
             if (!foundValue)
                 valueString += "???";
 
-            ImGui::TableNextRow();
-            ImGui::TreeNodeEx(this->getVariableName().c_str(), ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowItemOverlap);
-            this->drawCommentTooltip();
-            ImGui::TableNextColumn();
-            if (ImGui::Selectable(("##PatternDataLine"s + std::to_string(this->getOffset())).c_str(), false, ImGuiSelectableFlags_SpanAllColumns)) {
-                Region selectRegion = { this->getOffset(), this->getSize() };
-                View::postEvent(Events::SelectionChangeRequest, selectRegion);
-            }
-            ImGui::SameLine();
-            ImGui::Text("%s", this->getVariableName().c_str());
-            ImGui::TableNextColumn();
-            ImGui::ColorButton("color", ImColor(this->getColor()), ImGuiColorEditFlags_NoTooltip, ImVec2(ImGui::GetColumnWidth(), ImGui::GetTextLineHeight()));
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%08llX : 0x%08llX", this->getOffset(), this->getOffset() + this->getSize() - 1);
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%04llX", this->getSize());
-            ImGui::TableNextColumn();
+            return hex::format("%s (0x%0*llX)", valueString.c_str(), this->getSize() * 2, value);
+        }
+
+        void drawTypeName() const override {
             ImGui::TextColored(ImColor(0xFFD69C56), "enum"); ImGui::SameLine(); ImGui::Text("%s", PatternData::getTypeName().c_str());
-            ImGui::TableNextColumn();
-            ImGui::Text("%s", hex::format("%s (0x%0*llX)", valueString.c_str(), this->getSize() * 2, value).c_str());
         }
 
         [[nodiscard]] std::string getFormattedName() const override {
@@ -758,63 +734,43 @@ namespace hex::lang {
             return new PatternDataBitfield(*this);
         }
 
-        void createEntry(prv::Provider* &provider) override {
+        // The field values get formatted together with the value of the whole bitfield
+        std::string formatDisplayValue(prv::Provider *provider) override {
             std::vector<u8> value(this->getSize(), 0);
-            provider->read(this->getOffset(), &value[0], value.size());
+            provider->readAbsolute(this->getOffset(), &value[0], value.size());
 
             if (this->m_endian == std::endian::big)
                 std::reverse(value.begin(), value.end());
 
-            ImGui::TableNextRow();
-            ImGui::TableNextColumn();
-            bool open = ImGui::TreeNodeEx(this->getVariableName().c_str(), ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowItemOverlap);
-            this->drawCommentTooltip();
-            ImGui::TableNextColumn();
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%08llX : 0x%08llX", this->getOffset(), this->getOffset() + this->getSize() - 1);
-            ImGui::TableNextColumn();
-            ImGui::Text("0x%04llX", this->getSize());
-            ImGui::TableNextColumn();
-            ImGui::TextColored(ImColor(0xFFD69C56), "bitfield"); ImGui::SameLine(); ImGui::Text("%s", PatternData::getTypeName().c_str());
-            ImGui::TableNextColumn();
-
             std::string valueString = "{ ";
             for (u64 i = 0; i < value.size(); i++)
                 valueString += hex::format("%02x ", value[i]);
             valueString += "}";
 
-            ImGui::TextUnformatted(valueString.c_str());
-
-            if (open) {
-                u16 bitOffset = 0;
-                for (auto &[entryName, entrySize] : this->m_fields) {
-                    ImGui::TableNextRow();
-                    ImGui::TreeNodeEx(this->getVariableName().c_str(), ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowItemOverlap);
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%s", entryName.c_str());
-                    ImGui::TableNextColumn();
-                    ImGui::ColorButton("color", ImColor(this->getColor()), ImGuiColorEditFlags_NoTooltip, ImVec2(ImGui::GetColumnWidth(), ImGui::GetTextLineHeight()));
-                    ImGui::TableNextColumn();
-                    ImGui::Text("0x%08llX : 0x%08llX", this->getOffset() + (bitOffset >> 3), this->getOffset() + ((bitOffset + entrySize) >> 3));
-                    ImGui::TableNextColumn();
-                    if (entrySize == 1)
-                        ImGui::Text("%llu bit", entrySize);
-                    else
-                        ImGui::Text("%llu bits", entrySize);
-                    ImGui::TableNextColumn();
-                    ImGui::TextColored(ImColor(0xFF9BC64D), "bits");
-                    ImGui::TableNextColumn();
-                    {
-                        u128 fieldValue = 0;
-                        std::memcpy(&fieldValue, value.data() + (bitOffset / 8), (entrySize / 8) + 1);
-                        ImGui::Text("%llX", hex::extract((bitOffset + entrySize) - 1 - ((bitOffset / 8) * 8), bitOffset - ((bitOffset / 8) * 8), fieldValue));
-                    }
-                    bitOffset += entrySize;
-                }
+            this->m_fieldValues.clear();
+
+            u16 bitOffset = 0;
+            for (auto &[entryName, entrySize] : this->m_fields) {
+                u128 fieldValue = 0;
+                std::memcpy(&fieldValue, value.data() + (bitOffset / 8), (entrySize / 8) + 1);
+                this->m_fieldValues.push_back(hex::format("%llX", hex::extract((bitOffset + entrySize) - 1 - ((bitOffset / 8) * 8), bitOffset - ((bitOffset / 8) * 8), fieldValue)));
 
-                ImGui::TreePop();
+                bitOffset += entrySize;
             }
 
+            return valueString;
+        }
+
+        void drawTypeName() const override {
+            ImGui::TextColored(ImColor(0xFFD69C56), "bitfield"); ImGui::SameLine(); ImGui::Text("%s", PatternData::getTypeName().c_str());
+        }
+
+        [[nodiscard]] bool showsColor() const override { return false; }
+
+        [[nodiscard]] const std::string& getDisplayFieldValue(prv::Provider *provider, size_t index) {
+            (void)this->getDisplayValue(provider);
+
+            return this->m_fieldValues[index];
         }
 
         [[nodiscard]] std::string getFormattedName() const override {
@@ -827,6 +783,94 @@ namespace hex::lang {
 
     private:
         std::vector<std::pair<std::string, size_t>> m_fields;
+        std::vector<std::string> m_fieldValues;
+    };
+
+    /*
+     * Array whose entries only differ in their offset. Only the first entry is stored and used as template,
+     * it gets moved to the offset of an entry whenever that entry is displayed or highlighted.
+     */
+    class PatternDataStaticArray : public PatternData {
+    public:
+        PatternDataStaticArray(u64 offset, u64 entryCount, PatternData *templatePattern, u32 color = 0)
+            : PatternData(offset, entryCount * templatePattern->getSize(), color), m_template(templatePattern), m_entryCount(entryCount) { }
+
+        PatternDataStaticArray(const PatternDataStaticArray &other) : PatternData(other), m_template(other.m_template->clone()), m_entryCount(other.m_entryCount) { }
+
+        ~PatternDataStaticArray() override {
+            delete this->m_template;
+        }
+
+        PatternData* clone() override {
+            return new PatternDataStaticArray(*this);
+        }
+
+        void setOffset(u64 offset) override {
+            this->m_template->setOffset(this->m_template->getOffset() - this->getOffset() + offset);
+
+            PatternData::setOffset(offset);
+        }
+
+        std::string formatDisplayValue(prv::Provider *provider) override {
+            return "{ ... }";
+        }
+
+        void drawTypeName() const override {
+            ImGui::TextColored(ImColor(0xFF9BC64D), "%s", this->m_template->getTypeName().c_str());
+            ImGui::SameLine(0, 0);
+
+            ImGui::TextUnformatted("[");
+            ImGui::SameLine(0, 0);
+            ImGui::TextColored(ImColor(0xFF00FF00), "%llu", this->m_entryCount);
+            ImGui::SameLine(0, 0);
+            ImGui::TextUnformatted("]");
+        }
+
+        void addHighlightedRegions(HighlightIndex &index) override {
+            // Entries of plain values all have the array's color. Otherwise every entry adds its own regions, unless there are too many of them
+            if (!this->hasNestedEntries() || this->m_entryCount > MaxHighlightedEntries) {
+                PatternData::addHighlightedRegions(index);
+                return;
+            }
+
+            for (u64 i = 0; i < this->m_entryCount; i++) {
+                this->moveTemplate(i);
+                this->m_template->addHighlightedRegions(index);
+            }
+        }
+
+        [[nodiscard]] std::string getFormattedName() const override {
+            return this->m_template->getTypeName() + "[" + std::to_string(this->m_entryCount) + "]";
+        }
+
+        [[nodiscard]] u64 getEntryCount() const { return this->m_entryCount; }
+
+        // Moves the template to the entry at index and returns it, it only represents that entry until the next call
+        [[nodiscard]] PatternData* getEntry(u64 index) {
+            this->moveTemplate(index);
+            this->m_template->setVariableName(hex::format("[%llu]", index));
+
+            return this->m_template;
+        }
+
+        [[nodiscard]] PatternData* getTemplate() const { return this->m_template; }
+
+        // Entries that contain patterns of their own, as opposed to plain values
+        [[nodiscard]] bool hasNestedEntries() const {
+            return dynamic_cast<PatternDataStruct*>(this->m_template) != nullptr || dynamic_cast<PatternDataUnion*>(this->m_template) != nullptr ||
+                   dynamic_cast<PatternDataBitfield*>(this->m_template) != nullptr || dynamic_cast<PatternDataArray*>(this->m_template) != nullptr ||
+                   dynamic_cast<PatternDataStaticArray*>(this->m_template) != nullptr;
+        }
+
+    private:
+        constexpr static u64 MaxHighlightedEntries = 0x1000;
+
+        void moveTemplate(u64 index) {
+            this->m_template->setOffset(this->getOffset() + index * this->m_template->getSize());
+        }
+
+        PatternData *m_template;
+        u64 m_entryCount;
     };
 
 
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace hex::lang {
+
+    class PatternData;
+
+    /*
+     * Sorted list of non-overlapping address ranges and the innermost pattern covering each of them, so the pattern at an
+     * address can be found without going through all of them. Members take precedence over the pattern they're part of,
+     * patterns added earlier over later ones they overlap with. Entries of static arrays aren't indexed, they're resolved
+     * from the array on lookup by moving its template to them. The index gets rebuilt on the next lookup after invalidate was called.
+     */
+    class PatternIndex {
+    public:
+        explicit PatternIndex(const std::vector<PatternData*> &patterns) : m_patterns(patterns) { }
+
+        // Has to be called whenever patterns were added or removed
+        void invalidate() { this->m_valid = false; }
+
+        // Innermost pattern containing the address or nullptr. Static array entries stay valid until their template gets moved again
+        [[nodiscard]] PatternData* find(u64 address);
+        // Fills path with all patterns containing the address, from the top-level pattern to the innermost one
+        bool findPath(u64 address, std::vector<PatternData*> &path);
+
+        [[nodiscard]] size_t getRunCount() { this->update(); return this->m_runs.size(); }
+
+    private:
+        constexpr static u32 NoParent = std::numeric_limits<u32>::max();
+
+        struct Node {
+            PatternData *pattern;
+            u32 parent;
+        };
+
+        struct Run {
+            u64 end;
+            u32 node;
+        };
+
+        void update();
+        void addPattern(PatternData *pattern, u32 parent);
+        void insertRuns(u64 address, size_t size, u32 node);
+
+        const std::vector<PatternData*> &m_patterns;
+
+        std::vector<Node> m_nodes;
+        std::map<u64, Run> m_runs;
+        bool m_valid = false;
+    };
+
+}
@@ -3,14 +3,21 @@
 #include <hex.hpp>
 
 #include <bit>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include <hex/lang/pattern_data.hpp>
+#include <hex/lang/evaluator.hpp>
 #include <hex/lang/log_console.hpp>
+#include <hex/lang/token.hpp>
 
+namespace hex { class Task; class MemoryArena; }
 namespace hex::prv { class Provider; }
 
 namespace hex::lang {
@@ -19,17 +26,81 @@ namespace hex::lang {
     class Lexer;
     class Parser;
     class Validator;
-    class Evaluator;
+    class ASTNode;
+
+    /*
+     * Preprocessed, parsed and validated pattern. It doesn't depend on any provider, so it can be evaluated
+     * any number of times on different data without going through the other stages again.
+     * The AST lives in an arena of its own so it isn't tied to the memory of any evaluation.
+     */
+    class CompiledPattern {
+    public:
+        // Time spent in each stage of compiling the pattern, logged before evaluating it if profiling is enabled
+        struct StageTimes {
+            std::chrono::steady_clock::duration preprocessing, lexing, parsing, validation;
+        };
+
+        ~CompiledPattern();
+
+        [[nodiscard]] const std::vector<ASTNode*>& getAST() const { return this->m_ast; }
+        [[nodiscard]] std::endian getDefaultEndian() const { return this->m_defaultEndian; }
+        [[nodiscard]] const Evaluator::Limits& getLimits() const { return this->m_limits; }
+        [[nodiscard]] const StageTimes& getStageTimes() const { return this->m_stageTimes; }
+
+        // Files included by the code, with the modification time they had when it got compiled
+        [[nodiscard]] const std::vector<std::pair<std::string, std::filesystem::file_time_type>>& getIncludedFiles() const { return this->m_includedFiles; }
+
+        // Number of leading top level statements made up of the same tokens in both patterns. Stops at the first top level function call,
+        // skipping it would lose its output
+        [[nodiscard]] size_t getCommonStatementCount(const CompiledPattern &other) const;
+
+    private:
+        friend class PatternLanguage;
+        CompiledPattern() = default;
+
+        std::shared_ptr<MemoryArena> m_arena;
+        std::vector<ASTNode*> m_ast;
+        std::endian m_defaultEndian = std::endian::native;
+        Evaluator::Limits m_limits;
+        StageTimes m_stageTimes = { };
+        std::vector<std::pair<std::string, std::filesystem::file_time_type>> m_includedFiles;
+
+        std::string m_code;
+        std::vector<Token> m_tokens;
+        std::vector<size_t> m_statementEnds;
+    };
 
     class PatternLanguage {
     public:
+        using PatternCallback = std::function<void(PatternData*)>;
+
         PatternLanguage();
         ~PatternLanguage();
 
-        std::optional<std::vector<PatternData*>> executeString(prv::Provider *provider, std::string_view string);
-        std::optional<std::vector<PatternData*>> executeFile(prv::Provider *provider, std::string_view path);
+        /*
+         * Evaluation aborts with an error once the task, if any, gets cancelled.
+         * If a callback is given, every top level pattern is passed to it as soon as it's been evaluated. It takes ownership
+         * of them, so they're left out of the result and not deleted if a later error causes the evaluation to fail.
+         */
+        std::optional<std::vector<PatternData*>> executeString(prv::Provider *provider, std::string_view string, Task *task = nullptr, const PatternCallback &onPattern = { });
+        std::optional<std::vector<PatternData*>> executeFile(prv::Provider *provider, std::string_view path, Task *task = nullptr, const PatternCallback &onPattern = { });
+
+        /*
+         * Continues the last evaluation if the pattern starts with the same statements and runs on the same provider.
+         * keptPatterns have to be the first getKeptPatternCount() top level patterns of the last evaluation, they're used instead of
+         * evaluating these statements again. Without them the pattern is evaluated from the start.
+         */
+        std::optional<std::vector<PatternData*>> execute(prv::Provider *provider, const std::shared_ptr<const CompiledPattern> &pattern, Task *task = nullptr,
+                                                         const PatternCallback &onPattern = { }, const std::vector<PatternData*> &keptPatterns = { });
+        [[nodiscard]] size_t getKeptPatternCount(prv::Provider *provider, const CompiledPattern &pattern) const;
+
+        // Returns nullptr and sets the error if the code is invalid
+        std::shared_ptr<const CompiledPattern> compile(std::string_view string);
 
-        const std::vector<std::pair<LogConsole::Level, std::string>>& getConsoleLog();
+        // The most recently compiled code is cached by its hash, it's only compiled again if it or one of its included files changed
+        std::shared_ptr<const CompiledPattern> getCompiledPattern(std::string_view string);
+
+        std::vector<std::pair<LogConsole::Level, std::string>> getConsoleLog();
         const std::optional<std::pair<u32, std::string>>& getError();
 
     private:
@@ -40,9 +111,19 @@ namespace hex::lang {
         Evaluator *m_evaluator;
 
         prv::Provider *m_provider;
-        std::endian m_defaultEndian;
+        std::endian m_defaultEndian = std::endian::native;
+        Evaluator::Limits m_limits;
 
         std::optional<std::pair<u32, std::string>> m_currError;
+
+        std::string m_cachedCode;
+        std::shared_ptr<const CompiledPattern> m_cachedPattern;
+
+        // The statement states of the last evaluation are kept by the evaluator
+        std::shared_ptr<const CompiledPattern> m_lastPattern;
+        prv::Provider *m_lastProvider = nullptr;
+
+        [[nodiscard]] size_t getResumableStatementCount(prv::Provider *provider, const CompiledPattern &pattern) const;
     };
 
 }
\ No newline at end of file
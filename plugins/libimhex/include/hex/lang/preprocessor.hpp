@@ -4,16 +4,23 @@
 
 #include "token.hpp"
 
+#include <filesystem>
 #include <functional>
+#include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace hex::lang {
 
     class Preprocessor {
     public:
+        using IncludedFiles = std::vector<std::pair<std::string, std::filesystem::file_time_type>>;
+
         Preprocessor();
 
         std::optional<std::string> preprocess(const std::string& code, bool initialRun = true);
@@ -21,11 +28,34 @@ namespace hex::lang {
         void addPragmaHandler(const std::string &pragmaType, const std::function<bool(const std::string&)> &function);
         void addDefaultPragmaHandlers();
 
+        // Value of one of the limit pragmas, nothing if it isn't a number or doesn't fit into the limit it sets
+        [[nodiscard]] static std::optional<u64> parseLimit(const std::string &pragmaType, const std::string &value);
+
         const std::pair<u32, std::string>& getError() { return this->m_error; }
 
+        // Every file included by the last run, with the modification time it had when it was read
+        [[nodiscard]] const IncludedFiles& getIncludedFiles() const { return this->m_includedFiles; }
+        [[nodiscard]] static bool areUpToDate(const IncludedFiles &files);
+
     private:
         using PreprocessorError = std::pair<u32, std::string>;
 
+        // Included files are only read and preprocessed again once they or one of the files they include changed.
+        // The content doesn't contain the files included by it, they get inserted at their positions when the include gets used
+        struct CachedInclude {
+            std::filesystem::file_time_type modificationTime;
+            std::string content;
+            std::vector<std::pair<size_t, std::string>> includes;
+            bool once;                                          // Marked with "#pragma once"
+            std::set<std::pair<std::string, std::string>> defines;
+            std::set<std::pair<std::string, std::string>> pragmas;
+            IncludedFiles includedFiles;
+        };
+
+        CachedInclude preprocessInclude(const std::string &path, std::filesystem::file_time_type modificationTime, u32 lineNumber);
+        void appendInclude(std::string &output, const std::string &path);
+        [[nodiscard]] std::string expandDefines(const std::string &code) const;
+
         [[noreturn]] void throwPreprocessorError(std::string_view error, u32 lineNumber) const {
             throw PreprocessorError(lineNumber, "Preprocessor: " + std::string(error));
         }
@@ -34,6 +64,13 @@ namespace hex::lang {
 
         std::set<std::pair<std::string, std::string>> m_defines;
         std::set<std::pair<std::string, std::string>> m_pragmas;
+        IncludedFiles m_includedFiles;
+        std::vector<std::pair<size_t, std::string>> m_includePositions;
+        std::unordered_set<std::string> m_onceIncluded;
+        std::unordered_set<std::string> m_activeIncludes;
+        bool m_pragmaOnce = false;
+
+        std::unordered_map<std::string, CachedInclude> m_includeCache;
 
         std::pair<u32, std::string> m_error;
     };
@@ -6,6 +6,7 @@
 
 #include <utility>
 #include <string>
+#include <string_view>
 #include <variant>
 
 namespace hex::lang {
@@ -103,7 +104,8 @@ namespace hex::lang {
         };
 
         using IntegerLiteral = std::pair<ValueType, std::variant<u8, s8, u16, s16, u32, s32, u64, s64, u128, s128, float, double>>;
-        using ValueTypes = std::variant<Keyword, std::string, Operator, IntegerLiteral, ValueType, Separator>;
+        // Identifiers point into the code they were lexed from, string literals need their escape sequences resolved and own their text
+        using ValueTypes = std::variant<Keyword, std::string, std::string_view, Operator, IntegerLiteral, ValueType, Separator>;
 
         Token(Type type, auto value, u32 lineNumber) : type(type), value(value), lineNumber(lineNumber) {
 
@@ -198,8 +200,8 @@ namespace hex::lang {
 #define KEYWORD_ELSE                        COMPONENT(Keyword, Else)
 
 #define INTEGER                             hex::lang::Token::Type::Integer, hex::lang::Token::IntegerLiteral(hex::lang::Token::ValueType::Any, u64(0))
-#define IDENTIFIER                          hex::lang::Token::Type::Identifier, ""
-#define STRING                              hex::lang::Token::Type::String, ""
+#define IDENTIFIER                          hex::lang::Token::Type::Identifier, std::string_view()
+#define STRING                              hex::lang::Token::Type::String, std::string()
 
 #define OPERATOR_AT                         COMPONENT(Operator, AtDeclaration)
 #define OPERATOR_ASSIGNMENT                 COMPONENT(Operator, Assignment)
@@ -4,7 +4,9 @@
 
 #include "token.hpp"
 #include "ast_node.hpp"
+#include "evaluator.hpp"
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -14,6 +16,7 @@ namespace hex::lang {
     public:
         Validator();
 
+        // Checks for redefinitions, then folds constant expressions and determines which types have a static layout. The results are kept on the AST
         bool validate(const std::vector<ASTNode*>& ast);
         void printAST(const std::vector<ASTNode*>& ast);
 
@@ -21,6 +24,11 @@ namespace hex::lang {
 
     private:
         std::pair<u32, std::string> m_error;
+        Evaluator m_constantEvaluator;
+
+        void checkRedefinitions(const std::vector<ASTNode*>& ast);
+        std::optional<Token::IntegerLiteral> foldConstants(ASTNode *node);
+        void analyzeLayouts(ASTNode *node);
 
         using ValidatorError = std::pair<u32, std::string>;
 
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace hex::prv {
+
+    // How a range of data is about to be read. Providers may tune read-ahead and caching with it, what gets read never depends on it
+    enum class AccessHint {
+        Sequential,     // Read once from front to back, like a scan over all of the data
+        Random,         // Read in small parts all over the place, like browsing it in the hex editor
+        WillNeed,       // Going to be read soon
+        DontNeed        // Done with it, caches may drop it before anything else
+    };
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <hex/helpers/memory_budget.hpp>
+#include <hex/providers/access_hint.hpp>
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace hex::prv {
+
+    /*
+     * Size bounded LRU cache over aligned blocks of provider data.
+     * Misses that continue a sequential access pattern fetch the following blocks as well,
+     * so small sequential reads turn into a few large reads of the underlying data source.
+     * Blocks of ranges hinted to be scanned sequentially go into a small cache of their own, a scan over all of the data would otherwise evict every block
+     * that's read interactively. Cached blocks count towards the memory budget, which drops the least recently used ones first.
+     */
+    class BlockCache {
+    public:
+        using FetchFunction = std::function<void(u64 offset, void *buffer, size_t size)>;
+
+        explicit BlockCache(size_t blockSize = 0x1000, size_t maxBlocks = 0x400, size_t readAheadBlocks = 8);
+
+        void read(u64 offset, void *buffer, size_t size, size_t dataSize, const FetchFunction &fetch);
+
+        void invalidate();
+        void invalidate(u64 offset, size_t size);
+
+        // Sequential ranges stay scanned until they're hinted to be read randomly or not to be needed anymore
+        void hint(u64 offset, size_t size, AccessHint hint);
+
+        [[nodiscard]] size_t getBlockSize() const { return this->m_blockSize; }
+        [[nodiscard]] size_t getMemoryUsage();
+        // Drops least recently used blocks, scanned ones first. Returns how much got freed
+        size_t trim(size_t size);
+        [[nodiscard]] u64 getHits() const { return this->m_hits; }
+        [[nodiscard]] u64 getMisses() const { return this->m_misses; }
+        void resetStatistics();
+
+    private:
+        struct Block {
+            u64 address;
+            std::vector<u8> data;
+        };
+
+        struct BlockList {
+            std::list<Block> blocks;
+            std::unordered_map<u64, std::list<Block>::iterator> lookup;
+            size_t maxBlocks;
+        };
+
+        const std::vector<u8>& getBlock(u64 address, size_t dataSize, const FetchFunction &fetch);
+        [[nodiscard]] bool isScanned(u64 address) const;
+        static void insertBlock(BlockList &list, u64 address, std::vector<u8> &&data);
+        static void removeBlocks(BlockList &list, u64 offset, size_t size, size_t blockSize);
+
+        size_t m_blockSize;
+        size_t m_readAheadBlocks;
+
+        BlockList m_blocks;
+        BlockList m_scanBlocks;
+        std::vector<std::pair<u64, u64>> m_scanRanges;
+
+        u64 m_lastBlockAddress = 0;
+        u64 m_hits = 0, m_misses = 0;
+
+        std::mutex m_mutex;
+
+        // Destroyed first, the budget doesn't get to the cache anymore while it's torn down
+        MemoryBudget::Registration m_memoryRegistration;
+    };
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <hex.hpp>
+
+namespace hex::prv {
+
+    /*
+     * Reads a range front to back in chunks, with the reads of the following chunks already in flight while the caller works on the current one.
+     * Every chunk is as large as requested except for the last one. A chunk's data stays valid until the chunk after the next one gets requested,
+     * so one chunk can be worked on while the next one is being read.
+     */
+    class ChunkReader {
+    public:
+        virtual ~ChunkReader() = default;
+
+        // Returns nullptr once the whole range was read or a read failed
+        [[nodiscard]] virtual u8* next(size_t &size) = 0;
+    };
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <array>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace hex::prv {
+
+    class Provider;
+
+    /*
+     * A range of a provider's data handed out in chunks, with patches and overlays applied the same way readAbsolute does.
+     * Chunks of data the provider keeps in memory and nothing changes are views right into that memory, all others are read into one of two buffers.
+     * A chunk stays valid until the chunk after the next one gets read, so one chunk can be worked on while the next one is being read.
+     * Iterating is single pass and not thread safe. Parallel scans partition the range and iterate every part on a thread of its own.
+     */
+    class DataChunks {
+    public:
+        constexpr static size_t DefaultChunkSize = 0x10'0000;
+
+        DataChunks(Provider *provider, u64 offset, u64 size, size_t chunkSize = DefaultChunkSize);
+
+        class Iterator {
+        public:
+            using value_type = std::span<const u8>;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+            explicit Iterator(DataChunks *chunks) : m_chunks(chunks) { }
+
+            std::span<const u8> operator*() const { return this->m_chunks->m_chunk; }
+            // Offset of the current chunk's first byte in the entire data
+            [[nodiscard]] u64 getOffset() const { return this->m_chunks->m_chunkOffset; }
+
+            Iterator& operator++() { this->m_chunks->advance(); return *this; }
+            void operator++(int) { this->m_chunks->advance(); }
+
+            bool operator==(std::default_sentinel_t) const { return this->m_chunks == nullptr || this->m_chunks->m_chunk.empty(); }
+
+        private:
+            DataChunks *m_chunks = nullptr;
+        };
+
+        // Reads the first chunk
+        [[nodiscard]] Iterator begin();
+        [[nodiscard]] std::default_sentinel_t end() const { return { }; }
+
+        // Splits the range into at most count parts made of whole chunks, which are as large as possible and differ by at most one chunk
+        [[nodiscard]] std::vector<DataChunks> partition(size_t count) const;
+
+        [[nodiscard]] u64 getOffset() const { return this->m_offset; }
+        [[nodiscard]] u64 getSize() const { return this->m_size; }
+        [[nodiscard]] size_t getChunkSize() const { return this->m_chunkSize; }
+
+    private:
+        void read(u64 offset);
+        void advance();
+
+        Provider *m_provider;
+        u64 m_offset, m_size;
+        size_t m_chunkSize;
+
+        std::array<std::vector<u8>, 2> m_buffers;
+        size_t m_bufferIndex = 0;
+
+        u64 m_chunkOffset = 0;
+        std::span<const u8> m_chunk;
+    };
+
+}
@@ -2,23 +2,61 @@
 
 #include <hex.hpp>
 
+#include <atomic>
+#include <cstdio>
+#include <mutex>
 #include <vector>
 
 namespace hex::prv {
 
+    /*
+     * Data displayed on top of a provider's data without modifying it. Small overlays are kept in memory,
+     * once one grows past MaxMemorySize its contents get moved into a temporary file so huge regions don't need to fit into memory.
+     * Every change bumps the generation counter of the provider owning the overlay, so it knows when to update its overlay index.
+     */
     class Overlay {
     public:
-        Overlay() { }
+        constexpr static size_t MaxMemorySize = 0x100'0000;
+
+        explicit Overlay(std::atomic<u64> *generation = nullptr) : m_generation(generation) { }
+        Overlay(const Overlay&) = delete;
+        Overlay& operator=(const Overlay&) = delete;
+        ~Overlay();
+
+        void setAddress(u64 address) {
+            if (this->m_address != address) {
+                this->m_address = address;
+                this->markChanged();
+            }
+        }
 
-        void setAddress(u64 address) { this->m_address = address; }
         [[nodiscard]] u64 getAddress() const { return this->m_address; }
 
-        [[nodiscard]] u64 getSize() const { return this->m_data.size(); }
-        [[nodiscard]] std::vector<u8>& getData() { return this->m_data; }
+        [[nodiscard]] u64 getSize() const { return this->m_size; }
+
+        // Offsets are relative to the overlay's address, writing past the end grows the overlay
+        void write(u64 offset, const u8 *data, size_t size);
+        void read(u64 offset, u8 *buffer, size_t size) const;
+
+        void clear();
+
+        // Exchanges the contents of both overlays at once, so readers only ever see one of them completely
+        void swap(Overlay &other);
 
     private:
         u64 m_address = 0;
+        u64 m_size = 0;
+
         std::vector<u8> m_data;
+        std::FILE *m_file = nullptr;
+
+        mutable std::mutex m_mutex;
+        std::atomic<u64> *m_generation;
+
+        void markChanged() {
+            if (this->m_generation != nullptr)
+                ++*this->m_generation;
+        }
     };
 
-}
\ No newline at end of file
+}
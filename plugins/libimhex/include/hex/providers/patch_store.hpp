@@ -0,0 +1,129 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace hex::prv {
+
+    /*
+     * Stores modified bytes as non-overlapping runs keyed by their start address. Runs never reach beyond a multiple of MaxRunSize
+     * and are only adjacent to each other at one, so no modification ever copies more than a few of them.
+     * Every modification records only the runs it replaced, so undo history grows with the
+     * amount of changed data instead of with the total amount of patched bytes.
+     * The runs are copy-on-write, sharing them is free. The first modification while they're shared copies the map, the bytes of its runs
+     * stay shared until they get modified themselves.
+     */
+    class PatchStore {
+    public:
+        constexpr static u64 MaxRunSize = 0x10000;
+
+        // Bytes of a run. Copies share them until one of them gets modified
+        class Bytes {
+        public:
+            Bytes() : m_bytes(std::make_shared<std::vector<u8>>()) { }
+            Bytes(std::vector<u8> bytes) : m_bytes(std::make_shared<std::vector<u8>>(std::move(bytes))) { }
+            Bytes(std::initializer_list<u8> bytes) : Bytes(std::vector<u8>(bytes)) { }
+            template<typename Iterator>
+            Bytes(Iterator first, Iterator last) : Bytes(std::vector<u8>(first, last)) { }
+
+            [[nodiscard]] size_t size() const { return this->m_bytes->size(); }
+            [[nodiscard]] bool empty() const { return this->m_bytes->empty(); }
+            [[nodiscard]] const u8* data() const { return this->m_bytes->data(); }
+            [[nodiscard]] std::vector<u8>::const_iterator begin() const { return this->m_bytes->begin(); }
+            [[nodiscard]] std::vector<u8>::const_iterator end() const { return this->m_bytes->end(); }
+            [[nodiscard]] u8 operator[](size_t index) const { return (*this->m_bytes)[index]; }
+
+            operator const std::vector<u8>&() const { return *this->m_bytes; }
+            [[nodiscard]] bool operator==(const Bytes &other) const { return *this->m_bytes == *other.m_bytes; }
+
+            // Copies the bytes first if any other copy still holds them
+            std::vector<u8>& modify();
+
+        private:
+            std::shared_ptr<std::vector<u8>> m_bytes;
+        };
+
+        using Run = std::pair<u64, std::vector<u8>>;
+        using Runs = std::map<u64, Bytes>;
+
+        // Told about every modification with the range it replaced and the runs in that range afterwards, undo and redo included.
+        // Clearing or assigning all runs at once replaces the entire address space, its size is the largest u64
+        using ChangeCallback = std::function<void(u64 address, u64 size, const std::vector<Run> &runs)>;
+        constexpr static u64 EntireAddressSpace = std::numeric_limits<u64>::max();
+
+        PatchStore() = default;
+
+        void write(u64 address, const void *buffer, size_t size);
+        // Writes all runs as a single modification, they have to be sorted by address and mustn't overlap
+        void write(const std::vector<Run> &runs);
+        void erase(u64 address, size_t size = 1);
+        void assign(const std::map<u64, u8> &patches);
+        // Adjacent runs get merged, bytes covered by multiple runs are taken from the later one
+        void assign(const Runs &patches);
+        void clear();
+
+        bool undo();
+        bool redo();
+        [[nodiscard]] bool canUndo() const { return !this->m_undoLog.empty(); }
+        [[nodiscard]] bool canRedo() const { return !this->m_redoLog.empty(); }
+        [[nodiscard]] size_t getUndoDepth() const { return this->m_undoLog.size(); }
+        // For edits made somewhere else that the modifications undone so far can't be redone on top of
+        void clearRedo() { this->m_redoLog.clear(); }
+
+        // Address and size of the data the next undo or redo modifies
+        [[nodiscard]] std::optional<std::pair<u64, size_t>> getUndoRange() const;
+        [[nodiscard]] std::optional<std::pair<u64, size_t>> getRedoRange() const;
+
+        [[nodiscard]] std::optional<u8> get(u64 address) const;
+        void apply(u64 address, void *buffer, size_t size) const;
+        static void apply(const Runs &runs, u64 address, void *buffer, size_t size);
+        [[nodiscard]] bool intersects(u64 address, size_t size) const;
+        [[nodiscard]] const Runs& getRuns() const { return *this->m_runs; }
+        // The runs as they are now, unaffected by any later modification
+        [[nodiscard]] std::shared_ptr<const Runs> share() const { return this->m_runs; }
+        [[nodiscard]] std::map<u64, u8> flatten() const;
+
+        [[nodiscard]] bool empty() const { return this->m_runs->empty(); }
+        [[nodiscard]] size_t getPatchedByteCount() const;
+
+        // Changes whenever the patched data changes, so anything derived from it can tell whether it's outdated
+        [[nodiscard]] u64 getGeneration() const { return this->m_generation; }
+
+        // Called on the thread making the modification
+        void setChangeCallback(ChangeCallback callback) { this->m_changeCallback = std::move(callback); }
+
+    private:
+        struct Delta {
+            u64 address;
+            size_t size;
+            std::vector<Run> before;
+            std::vector<Run> after;
+        };
+
+        [[nodiscard]] std::vector<Run> extractRange(u64 address, size_t size) const;
+        // Changes the bytes of the run covering the range in place, false if there's no single run that does
+        bool overwrite(u64 address, const u8 *data, size_t size);
+        void removeRange(u64 address, size_t size);
+        // The range mustn't be patched, the data gets split up at multiples of MaxRunSize
+        void insertRun(u64 address, const u8 *data, size_t size);
+        void replaceRange(u64 address, size_t size, const std::vector<Run> &runs);
+        Runs& getMutableRuns();
+        void notifyChange(u64 address, u64 size, const std::vector<Run> &runs) const;
+
+        std::shared_ptr<Runs> m_runs = std::make_shared<Runs>();
+        std::vector<Delta> m_undoLog;
+        std::vector<Delta> m_redoLog;
+        u64 m_generation = 0;
+
+        ChangeCallback m_changeCallback;
+    };
+
+}
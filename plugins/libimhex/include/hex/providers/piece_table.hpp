@@ -0,0 +1,106 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace hex::prv {
+
+    /*
+     * Maps the data as it's shown after bytes got inserted or removed onto the provider's original data and the inserted bytes.
+     * The data is a sequence of pieces sorted by their address, so finding the piece of an address is a binary search.
+     * As long as nothing got inserted or removed there are no pieces at all and every address maps to itself.
+     * Sharing the pieces with snapshots is free, edits only copy them while they're shared. Overwrites within an inserted piece and insertions
+     * right behind one change its bytes instead of splitting it up, in place as long as nobody else holds them.
+     * The undo history only keeps what every edit changed.
+     */
+    class PieceTable {
+    public:
+        struct Piece {
+            // Address of the piece's first byte in the data as it's shown
+            u64 address;
+            u64 size;
+
+            // Offset into the original data, or into the inserted bytes if there are any
+            u64 source;
+            std::shared_ptr<const std::vector<u8>> inserted;
+
+            [[nodiscard]] bool isOriginal() const { return this->inserted == nullptr; }
+        };
+
+        using Pieces = std::vector<Piece>;
+
+        // Called for every span of the original data backing a range, with the offset the span starts at in the range
+        using OriginalCallback = std::function<void(u64 source, u64 offset, size_t size)>;
+
+        PieceTable() = default;
+
+        // Replaces size bytes at address with data. originalSize is the size of the original data, which gets mapped as a whole before the first edit
+        void replace(u64 originalSize, u64 address, u64 size, std::vector<u8> data);
+        // Overwrites the bytes at every run's address with its data, all of them together are a single edit that's undone and redone as a whole
+        void overwrite(u64 originalSize, const std::vector<std::pair<u64, std::vector<u8>>> &runs);
+        void clear();
+
+        bool undo();
+        bool redo();
+        [[nodiscard]] bool canUndo() const { return !this->m_undoLog.empty(); }
+        [[nodiscard]] bool canRedo() const { return !this->m_redoLog.empty(); }
+
+        // False as long as no bytes got inserted or removed, or all of those edits got undone
+        [[nodiscard]] bool isModified() const { return this->m_pieces != nullptr; }
+        [[nodiscard]] u64 getSize() const;
+
+        // The pieces as they are now, unaffected by any later edit. nullptr if nothing got inserted or removed
+        [[nodiscard]] std::shared_ptr<const Pieces> share() const { return this->m_pieces; }
+
+        // Changes with every edit and every undo or redo
+        [[nodiscard]] u64 getGeneration() const { return this->m_generation; }
+
+        // Copies inserted bytes into the buffer, everything else is left to the callback to read from the original data
+        static void read(const Pieces &pieces, u64 address, u8 *buffer, size_t size, const OriginalCallback &readOriginal);
+        // Calls the callback for all spans of the original data in the range, inserted bytes are skipped
+        static void forEachOriginal(const Pieces &pieces, u64 address, size_t size, const OriginalCallback &callback);
+
+        // True if the range is backed by the original data at the same offset
+        [[nodiscard]] static bool isIdentity(const Pieces &pieces, u64 address, size_t size);
+        // Address the original byte is shown at, nothing if it got removed
+        [[nodiscard]] static std::optional<u64> findOriginal(const Pieces &pieces, u64 source);
+
+    private:
+        // Inserted pieces that would have to be copied before their bytes can be changed get split up instead once they're larger than this
+        constexpr static u64 MaxCopiedPieceSize = 0x10000;
+
+        // Either the pieces starting at the index that got replaced, or the bytes of the inserted piece at the index starting at the offset.
+        // Replacing the added pieces or bytes with the removed ones again undoes the edit
+        struct Delta {
+            enum class Type { Pieces, Bytes } type;
+            u64 originalSize;
+            size_t index;
+
+            Pieces removedPieces, addedPieces;
+
+            u64 offset = 0;
+            std::vector<u8> removedBytes, addedBytes;
+
+            bool joined = false;    // Undone and redone together with the delta before it
+        };
+
+        [[nodiscard]] static Pieces::const_iterator findPiece(const Pieces &pieces, u64 address);
+
+        [[nodiscard]] std::optional<Delta> createBytesDelta(u64 originalSize, u64 address, u64 size, const std::vector<u8> &data) const;
+        [[nodiscard]] Delta createPiecesDelta(u64 originalSize, u64 address, u64 size, std::vector<u8> data) const;
+        void apply(const Delta &delta, bool undo);
+        void record(u64 originalSize, u64 address, u64 size, std::vector<u8> data, bool joined);
+        Pieces& getMutablePieces(u64 originalSize);
+
+        std::shared_ptr<Pieces> m_pieces;
+        std::vector<Delta> m_undoLog;
+        std::vector<Delta> m_redoLog;
+        u64 m_generation = 0;
+    };
+
+}
@@ -2,13 +2,26 @@
 
 #include <hex.hpp>
 
+#include <atomic>
+#include <functional>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
 #include <hex/helpers/shared_data.hpp>
+#include <hex/providers/access_hint.hpp>
+#include <hex/providers/block_cache.hpp>
+#include <hex/providers/chunk_reader.hpp>
+#include <hex/providers/data_chunks.hpp>
 #include <hex/providers/overlay.hpp>
+#include <hex/providers/patch_store.hpp>
+#include <hex/providers/piece_table.hpp>
+#include <hex/providers/snapshot.hpp>
 
 namespace hex::prv {
 
@@ -17,22 +30,75 @@ namespace hex::prv {
         constexpr static size_t PageSize = 0x1000'0000;
 
         Provider();
-        virtual ~Provider() = default;
+        virtual ~Provider();
 
         virtual bool isAvailable() = 0;
         virtual bool isReadable() = 0;
         virtual bool isWritable() = 0;
 
+        // Offsets passed to read and write are relative to the current page
         virtual void read(u64 offset, void *buffer, size_t size);
         virtual void write(u64 offset, const void *buffer, size_t size);
 
+        // Offsets passed to all other read and write functions address the entire data
+        virtual void readAbsolute(u64 offset, void *buffer, size_t size);
+        virtual void writeAbsolute(u64 offset, const void *buffer, size_t size);
+        // Writes all runs as a single undo step. They have to be sorted by address and mustn't overlap
+        void writeRuns(const std::vector<PatchStore::Run> &runs);
+        // Drops the patches of a range of the raw data as a single undo step, the raw data shows through again
+        void erasePatches(u64 offset, size_t size);
+
         virtual void readRaw(u64 offset, void *buffer, size_t size) = 0;
         virtual void writeRaw(u64 offset, const void *buffer, size_t size) = 0;
-        virtual size_t getActualSize() = 0;
-
-        std::map<u64, u8>& getPatches();
+        // Size of the raw data. Differs from getActualSize once bytes got inserted or removed
+        virtual size_t getRawSize() = 0;
+        [[nodiscard]] size_t getActualSize();
+
+        // Tells the provider how a range is about to be read, scans over large parts of the data should hint them as sequential and as not needed
+        // anymore once they're done. Offsets address the entire data, hintRawAccess gets them mapped onto the raw data. Both are safe to call from any thread
+        void hintAccess(u64 offset, size_t size, AccessHint hint);
+        // Tunes the block cache if there is one
+        virtual void hintRawAccess(u64 offset, size_t size, AccessHint hint);
+
+        // Reads of large parts of the raw data that keep several requests in flight at once. Returns nullptr if the provider can't do better
+        // than reading the range one chunk after another, which is the default. Called with the snapshot lock held, the reader must not depend on it
+        [[nodiscard]] virtual std::unique_ptr<ChunkReader> readRawChunks(u64 offset, u64 size, size_t chunkSize);
+
+        // Inserted and removed bytes move all data behind them. They're mapped through a piece table until the data gets saved to a new file,
+        // patches keep addressing the raw data underneath
+        void insert(u64 offset, const void *buffer, size_t size);
+        void remove(u64 offset, size_t size);
+        [[nodiscard]] bool hasStructuralEdits() const;
+        // The current pieces, nullptr if nothing got inserted or removed
+        [[nodiscard]] std::shared_ptr<const PieceTable::Pieces> getPieces() const;
+
+        // Unpatched data that stays in memory for the lifetime of the provider, so it can be used without copying it first.
+        // Returns nullptr if the provider doesn't keep the range in memory
+        [[nodiscard]] virtual const u8* getResidentData(u64 offset, size_t size);
+        // Combination of the ContentRegistry::Providers capabilities. There are none by default, so raw reads of providers that don't declare any get serialized
+        [[nodiscard]] virtual u32 getCapabilities() const;
+        [[nodiscard]] bool hasCapabilities(u32 capabilities) const { return (this->getCapabilities() & capabilities) == capabilities; }
+        // True if patches or overlays change any of the data in the range
+        [[nodiscard]] bool isPatched(u64 offset, size_t size) const;
+        // Scans over a range chunk by chunk, without copying the chunks that are resident and unpatched. Meant for the thread that owns the provider,
+        // workers read snapshots instead
+        [[nodiscard]] DataChunks getChunks(u64 offset, u64 size, size_t chunkSize = DataChunks::DefaultChunkSize) { return { this, offset, size, chunkSize }; }
+
+        // Changes whenever the data read from the provider may have changed. Data processor nodes read the raw data, so they can ignore their own overlays
+        [[nodiscard]] u64 getDataGeneration(bool includeOverlays = true) const;
+
+        // Thread safe, worker threads should read through a snapshot instead of the provider itself
+        [[nodiscard]] Snapshot createSnapshot();
+
+        PatchStore& getPatches();
         void applyPatches();
 
+        bool undo();
+        bool redo();
+        [[nodiscard]] bool canUndo() const;
+        [[nodiscard]] bool canRedo() const;
+
+        // Overlays are applied on top of the patched data by readAbsolute, later overlays cover earlier ones
         [[nodiscard]] Overlay* newOverlay();
         void deleteOverlay(Overlay *overlay);
         [[nodiscard]] const std::list<Overlay*>& getOverlays();
@@ -48,12 +114,63 @@ namespace hex::prv {
 
         virtual std::vector<std::pair<std::string, std::string>> getDataInformation() = 0;
 
+        // Short name shown in the list of open providers
+        [[nodiscard]] virtual std::string getName() const;
+
+        [[nodiscard]] BlockCache* getBlockCache() const;
+
     protected:
+        // Makes all snapshots stale. Has to be called by derived providers before they release their data
+        void closeSnapshots();
+        // Runs the function while no snapshot reads the raw data, for derived providers whose raw data got changed by someone else. All snapshots become stale
+        void replaceRawData(const std::function<void()> &replace);
+
+        void enableBlockCache(size_t blockSize = 0x1000, size_t maxBlocks = 0x400, size_t readAheadBlocks = 8);
+        void invalidateBlockCache(u64 offset, size_t size);
+
         u32 m_currPage = 0;
         u64 m_baseAddress = 0;
 
-        std::vector<std::map<u64, u8>> m_patches;
+        PatchStore m_patches;
+        PieceTable m_pieceTable;
+        mutable std::shared_mutex m_patchMutex;
+
+        // Undo depth of the patches right after every structural edit that can be undone or redone, undo and redo only switch over to
+        // the piece table once the patches are back at the same depth
+        std::vector<size_t> m_structuralUndoDepths;
+        std::vector<size_t> m_structuralRedoDepths;
         std::list<Overlay*> m_overlays;
+        std::atomic<u64> m_dataGeneration = 0;
+
+        // Visible parts of all overlays by start address, rebuilt whenever the overlay generation changed
+        struct OverlaySegment {
+            u64 end;
+            Overlay *overlay;
+        };
+
+        std::map<u64, OverlaySegment> m_overlaySegments;
+        std::atomic<u64> m_overlayGeneration = 0;
+        u64 m_indexedOverlayGeneration = 0;
+        mutable std::shared_mutex m_overlayMutex;
+
+        void updateOverlayIndex();
+        void applyOverlays(u64 offset, u8 *buffer, size_t size) const;
+
+        std::unique_ptr<BlockCache> m_blockCache;
+
+    private:
+        friend class Snapshot;
+
+        // Raw data, through the block cache if there is one
+        void readCached(u64 offset, void *buffer, size_t size);
+        // Raw data mapped through the pieces with the patches applied, but without overlays
+        void readPatched(const PieceTable::Pieces &pieces, const PatchStore::Runs &patches, u64 offset, u8 *buffer, size_t size);
+        void replaceStructure(u64 offset, size_t size, std::vector<u8> data);
+
+        std::shared_ptr<Snapshot::Source> m_snapshotSource;
+
+        // Held around raw reads of providers whose reads aren't thread safe
+        std::mutex m_rawReadMutex;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/api/task.hpp>
+#include <hex/providers/snapshot.hpp>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hex::prv {
+
+    class Provider;
+
+    /*
+     * Passes over a range of data that feed every chunk to all analyses interested in it. Every consumer runs on a thread of its own and works
+     * on the same chunk as the others while the next one is being read, so running more analyses at once costs CPU time but no extra reads.
+     *
+     * Submitted consumers of the same data and range share a pass. Ones that don't care about the order of the chunks may also join a pass
+     * that's already running: they get the chunks from where it currently is to the end, then it wraps around to the start for the ones they missed.
+     */
+    class ScanPipeline {
+    public:
+        ScanPipeline() = delete;
+
+        // Gets all chunks of the range, which are ChunkSize bytes large except for the last one. The data is only valid during the call
+        using Consumer = std::function<void(u64 offset, const u8 *data, size_t size)>;
+
+        constexpr static size_t ChunkSize = 0x10'0000;
+
+        enum class Order : u8 {
+            Sequential, // Chunks arrive front to back
+            Any         // Chunks may start anywhere in the range and wrap around
+        };
+
+        // Feeds all chunks of the range to all consumers on the calling thread's task. Returns false if the task got cancelled or the snapshot went stale
+        static bool run(const Snapshot &snapshot, u64 offset, u64 size, const std::vector<Consumer> &consumers, Task *task = nullptr);
+        // Same as above, but reads through the provider including its overlays. Data it keeps in memory doesn't get copied
+        static bool run(Provider *provider, u64 offset, u64 size, const std::vector<Consumer> &consumers, Task *task = nullptr);
+
+        /*
+         * Queues consumers for a pass over the range of the snapshot that's shared with all other ones of the same data and range.
+         * The returned task only belongs to these consumers, cancelling it drops them without stopping the pass for anyone else.
+         * The callback runs on the main thread once they got all chunks, not if they got cancelled or the snapshot went stale
+         */
+        static TaskHandle submit(std::string name, TaskPriority priority, const Snapshot &snapshot, u64 offset, u64 size, Order order,
+                                 std::vector<Consumer> consumers, TaskManager::Callback onFinished = { });
+
+        // Main thread only, once per frame. Starts passes for everything submitted since the last call and runs the callbacks of finished consumers
+        static void dispatch();
+
+    private:
+        class Pass;
+
+        struct Submission {
+            TaskHandle task;
+            Snapshot snapshot;
+            u64 offset = 0, size = 0;
+            Order order = Order::Sequential;
+            std::vector<Consumer> consumers;
+            TaskManager::Callback onFinished;
+        };
+
+        static void startPass(std::vector<Submission> submissions);
+        static void finishConsumer(Submission &submission, bool completed);
+
+        // Consumer tasks aren't run by the TaskManager, their state is kept up to date by the pass instead
+        static void setRunning(Task &task) { task.m_running = true; }
+        static void setFinished(Task &task) { task.setProgress(1.0F); task.m_finished = true; }
+
+        static std::vector<Submission> s_submissions;
+
+        // Guards the running passes and the finished consumers, passes update both from their workers
+        static std::mutex s_mutex;
+        static std::vector<std::shared_ptr<Pass>> s_runningPasses;
+        static std::vector<std::pair<TaskHandle, TaskManager::Callback>> s_finishedConsumers;
+    };
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <hex/providers/access_hint.hpp>
+#include <hex/providers/chunk_reader.hpp>
+#include <hex/providers/patch_store.hpp>
+#include <hex/providers/piece_table.hpp>
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+namespace hex::prv {
+
+    class Provider;
+
+    /*
+     * Immutable view of a provider's data as it was when the snapshot got created, meant for worker threads that keep reading while the UI edits.
+     * The patches and inserted or removed bytes at that time are part of the snapshot, later edits don't show up in it. Overlays and the current page aren't part of it either.
+     * Once the raw data underneath changes, because patches got applied to it or the provider got closed, the snapshot is stale and all reads fail.
+     * Creating and copying snapshots is cheap, they all share the patches copy-on-write with the provider.
+     */
+    class Snapshot {
+    public:
+        Snapshot() = default;
+
+        // Offsets address the entire data. Returns false and leaves the buffer untouched if the range is invalid or the snapshot is stale
+        bool read(u64 offset, void *buffer, size_t size) const;
+        // Passed on to the provider as long as the snapshot isn't stale, see Provider::hintAccess
+        void hintAccess(u64 offset, size_t size, AccessHint hint) const;
+
+        // Reads the range front to back, through the provider's own chunk reader if it has one. The reader fails like read does once the snapshot is stale
+        [[nodiscard]] std::unique_ptr<ChunkReader> readChunks(u64 offset, u64 size, size_t chunkSize) const;
+
+        [[nodiscard]] bool isValid() const;
+        [[nodiscard]] u64 getSize() const { return this->m_size; }
+
+        // Whether both snapshots read the exact same bytes, which snapshots with and without edits do as long as there aren't any
+        [[nodiscard]] bool hasSameData(const Snapshot &other) const;
+
+        // The patches that are part of the snapshot and the same snapshot of the data without any of them. Inserted and removed bytes stay part of it
+        [[nodiscard]] const PatchStore::Runs& getPatches() const { return *this->m_patches; }
+        [[nodiscard]] Snapshot withoutPatches() const;
+        // The raw data underneath, without patches and without inserted or removed bytes
+        [[nodiscard]] Snapshot withoutEdits() const;
+
+        // nullptr if nothing was inserted or removed, patches then address the same data as the snapshot itself
+        [[nodiscard]] const std::shared_ptr<const PieceTable::Pieces>& getPieces() const { return this->m_pieces; }
+
+        // Same values Provider::getDataGeneration(false) was made of when the snapshot got created
+        [[nodiscard]] u64 getDataGeneration() const { return this->m_dataGeneration; }
+        [[nodiscard]] u64 getPatchGeneration() const { return this->m_patchGeneration; }
+
+    private:
+        friend class Provider;
+
+        // Shared between a provider and all of its snapshots, the provider gets cleared once it's gone
+        struct Source {
+            std::shared_mutex mutex;
+            Provider *provider = nullptr;
+        };
+
+        std::shared_ptr<Source> m_source;
+        std::shared_ptr<const PatchStore::Runs> m_patches;
+        std::shared_ptr<const PieceTable::Pieces> m_pieces;
+        u64 m_size = 0;
+        u64 m_rawSize = 0;
+        u64 m_dataGeneration = 0;
+        u64 m_patchGeneration = 0;
+    };
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <hex/views/view.hpp>
+
+#include <functional>
+#include <string>
+
+namespace hex {
+
+    /*
+        Stands in for a view that isn't needed until it gets opened. The real view is only constructed the first time it has to be drawn,
+        so its setup and event subscriptions don't slow down startup. Until then the default View behaviour is used.
+        The name has to be the same as the one of the real view, it's what the window open state gets stored under.
+    */
+    class DeferredView : public View {
+    public:
+        DeferredView(std::string viewName, std::function<View*()> constructor);
+        ~DeferredView() override;
+
+        void drawContent() override;
+        void drawMenu() override;
+        bool handleShortcut(int key, int mods) override;
+        bool isAvailable() override;
+
+        bool hasViewMenuItemEntry() override;
+        ImVec2 getMinSize() override;
+        ImVec2 getMaxSize() override;
+
+    private:
+        View* getView();
+
+        std::function<View*()> m_constructor;
+        View *m_view = nullptr;
+    };
+
+}
@@ -30,7 +30,7 @@ namespace hex {
         static void doLater(std::function<void()> &&function);
         static std::vector<std::function<void()>>& getDeferedCalls();
 
-        static std::vector<std::any> postEvent(Events eventType, const std::any &userData = { });
+        static void postEvent(Events eventType, const std::any &userData = { });
 
         static void drawCommonInterfaces();
 
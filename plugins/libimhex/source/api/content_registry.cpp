@@ -1,24 +1,91 @@
 #include <hex/api/content_registry.hpp>
 
+#include <hex/api/imhex_api.hpp>
+#include <hex/api/task.hpp>
 #include <hex/helpers/shared_data.hpp>
+#include <hex/views/deferred_view.hpp>
 
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 
 namespace hex {
 
     /* Settings */
 
+    static std::filesystem::path getSettingsPath() {
+        return std::filesystem::path((SharedData::mainArgv)[0]).parent_path() / "settings.json";
+    }
+
+    // Every snapshot gets a generation when it's taken on the main thread, writes of older ones than what's on disk already are dropped
+    static void writeSettings(const std::string &contents, u64 generation) {
+        static std::mutex writeMutex;
+        static u64 writtenGeneration = 0;
+
+        std::scoped_lock lock(writeMutex);
+        if (generation <= writtenGeneration)
+            return;
+
+        // Written next to the settings and renamed once complete, so a crash never leaves half of them behind
+        const auto path = getSettingsPath();
+        auto temporaryPath = path;
+        temporaryPath += ".tmp";
+
+        {
+            std::ofstream settingsFile(temporaryPath, std::ios::trunc);
+            settingsFile << contents;
+
+            if (!settingsFile.good())
+                return;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (!error)
+            writtenGeneration = generation;
+    }
+
+    static u64 s_settingsGeneration = 0;
+
     void ContentRegistry::Settings::load() {
-        std::ifstream settingsFile(std::filesystem::path((SharedData::mainArgv)[0]).parent_path() / "settings.json");
+        std::ifstream settingsFile(getSettingsPath());
 
         if (settingsFile.good())
             settingsFile >> getSettingsData();
     }
 
     void ContentRegistry::Settings::store() {
-        std::ofstream settingsFile(std::filesystem::path((SharedData::mainArgv)[0]).parent_path() / "settings.json", std::ios::trunc);
-        settingsFile << getSettingsData();
+        SharedData::settingsChangeTime.reset();
+        writeSettings(getSettingsData().dump(), ++s_settingsGeneration);
+    }
+
+    void ContentRegistry::Settings::storeLater() {
+        SharedData::settingsChangeTime = std::chrono::steady_clock::now();
+    }
+
+    void ContentRegistry::Settings::processPendingStore() {
+        if (!SharedData::settingsChangeTime.has_value())
+            return;
+
+        // Keeps frames coming until the delay ran out, the main loop would otherwise wait for the next input
+        if (std::chrono::steady_clock::now() - *SharedData::settingsChangeTime < StoreDelay) {
+            ImHexApi::Common::requestRedraw();
+            return;
+        }
+
+        SharedData::settingsChangeTime.reset();
+
+        TaskManager::submit("Storing settings", TaskPriority::Background, [contents = getSettingsData().dump(), generation = ++s_settingsGeneration](Task&) {
+            writeSettings(contents, generation);
+        });
+    }
+
+    bool ContentRegistry::Settings::changed(const std::any &userData, std::string_view category, std::string_view name) {
+        auto key = std::any_cast<Key>(&userData);
+        if (key == nullptr)
+            return true;
+
+        return key->category == category && (name.empty() || key->name == name);
     }
 
     void ContentRegistry::Settings::add(std::string_view category, std::string_view name, s64 defaultValue, const std::function<bool(nlohmann::json&)> &callback) {
@@ -46,6 +113,7 @@ namespace hex {
             json[category.data()] = nlohmann::json::object();
 
         json[category.data()][name.data()] = value;
+        storeLater();
     }
 
     void ContentRegistry::Settings::write(std::string_view category, std::string_view name, std::string_view value) {
@@ -55,6 +123,7 @@ namespace hex {
             json[category.data()] = nlohmann::json::object();
 
         json[category.data()][name.data()] = value;
+        storeLater();
     }
 
     void ContentRegistry::Settings::write(std::string_view category, std::string_view name, const std::vector<std::string>& value) {
@@ -64,6 +133,7 @@ namespace hex {
             json[category.data()] = nlohmann::json::object();
 
         json[category.data()][name.data()] = value;
+        storeLater();
     }
 
 
@@ -138,7 +208,7 @@ namespace hex {
 
     /* Pattern Language Functions */
 
-    void ContentRegistry::PatternLanguageFunctions::add(std::string_view name, u32 parameterCount, const std::function<hex::lang::ASTNode*(hex::lang::Evaluator&, std::vector<hex::lang::ASTNode*>)> &func) {
+    void ContentRegistry::PatternLanguageFunctions::add(std::string_view name, u32 parameterCount, const std::function<hex::lang::ASTNode*(hex::lang::Evaluator&, std::span<hex::lang::ASTNode*>)> &func) {
         getEntries()[name.data()] = Function{ parameterCount, func };
     }
 
@@ -153,6 +223,10 @@ namespace hex {
         return getEntries().emplace_back(view);
     }
 
+    void ContentRegistry::Views::addDeferred(std::string name, const std::function<View*()> &constructor) {
+        getEntries().push_back(new DeferredView(std::move(name), constructor));
+    }
+
     std::vector<View*>& ContentRegistry::Views::getEntries() {
         return SharedData::views;
     }
@@ -171,8 +245,8 @@ namespace hex {
 
     /* Data Inspector */
 
-    void ContentRegistry::DataInspector::add(std::string_view name, size_t requiredSize, ContentRegistry::DataInspector::GeneratorFunction function) {
-        getEntries().push_back({ name.data(), requiredSize, std::move(function) });
+    void ContentRegistry::DataInspector::add(std::string_view name, size_t requiredSize, ContentRegistry::DataInspector::GeneratorFunction generatorFunction, ContentRegistry::DataInspector::DisplayFunction displayFunction, ContentRegistry::DataInspector::ColumnFunction columnFunction) {
+        getEntries().push_back({ name.data(), requiredSize, std::move(generatorFunction), std::move(displayFunction), std::move(columnFunction) });
     }
 
     std::vector<ContentRegistry::DataInspector::Entry>& ContentRegistry::DataInspector::getEntries() {
@@ -192,4 +266,25 @@ namespace hex {
     std::vector<ContentRegistry::DataProcessorNode::Entry>& ContentRegistry::DataProcessorNode::getEntries() {
         return SharedData::dataProcessorNodes;
     }
-}
\ No newline at end of file
+
+    /* Providers */
+
+    void ContentRegistry::Providers::add(std::string_view name, const DetectorFunction &detectorFunction, const CreatorFunction &creatorFunction) {
+        getEntries().push_back({ name.data(), detectorFunction, creatorFunction });
+    }
+
+    prv::Provider* ContentRegistry::Providers::create(const std::string &path) {
+        const auto &entries = getEntries();
+
+        for (auto entry = entries.rbegin(); entry != entries.rend(); entry++) {
+            if (entry->detectorFunction(path))
+                return entry->creatorFunction(path);
+        }
+
+        return nullptr;
+    }
+
+    std::vector<ContentRegistry::Providers::Entry>& ContentRegistry::Providers::getEntries() {
+        return SharedData::providerEntries;
+    }
+}
@@ -1,30 +1,122 @@
 #include <hex/api/event.hpp>
 
 #include <hex/helpers/shared_data.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
 
 namespace hex {
 
+    std::atomic<EventManager::QueuedEvent*> EventManager::s_queuedEvents = nullptr;
+    std::vector<std::pair<Events, std::any>> EventManager::s_coalescedEvents;
+
     std::vector<std::any> EventManager::post(Events eventType, const std::any &userData) {
         std::vector<std::any> results;
-        for (auto &handler : SharedData::eventHandlers)
-            if (eventType == handler.eventType)
-                results.push_back(handler.callback(userData));
+
+        auto it = SharedData::eventHandlers.find(eventType);
+        if (it == SharedData::eventHandlers.end())
+            return results;
+
+        // Indexing instead of iterating so handlers subscribing new ones don't invalidate the loop
+        auto &handlers = it->second;
+        for (size_t i = 0; i < handlers.size(); i++)
+            results.push_back(handlers[i].callback(userData));
 
         return results;
     }
 
+    void EventManager::notify(Events eventType, const std::any &userData) {
+        auto it = SharedData::eventHandlers.find(eventType);
+        if (it == SharedData::eventHandlers.end())
+            return;
+
+        auto &handlers = it->second;
+        for (size_t i = 0; i < handlers.size(); i++)
+            handlers[i].callback(userData);
+    }
+
+    void EventManager::postQueued(Events eventType, std::any userData) {
+        auto event = new QueuedEvent { eventType, std::move(userData), s_queuedEvents.load(std::memory_order_relaxed) };
+
+        while (!s_queuedEvents.compare_exchange_weak(event->next, event, std::memory_order_release, std::memory_order_relaxed));
+
+        ImHexApi::Common::requestRedraw();
+    }
+
+    void EventManager::processQueuedEvents() {
+        auto event = s_queuedEvents.exchange(nullptr, std::memory_order_acquire);
+
+        // The stack holds the newest event first
+        QueuedEvent *ordered = nullptr;
+        while (event != nullptr) {
+            auto next = event->next;
+            event->next = ordered;
+            ordered = event;
+            event = next;
+        }
+
+        while (ordered != nullptr) {
+            auto next = ordered->next;
+
+            notify(ordered->eventType, ordered->userData);
+            delete ordered;
+
+            ordered = next;
+        }
+
+        // Handlers posting coalesced events again get them delivered with the next batch
+        auto coalescedEvents = std::move(s_coalescedEvents);
+        s_coalescedEvents.clear();
+
+        for (const auto &[eventType, userData] : coalescedEvents)
+            notify(eventType, userData);
+    }
+
+    bool EventManager::hasQueuedEvents() {
+        return s_queuedEvents.load(std::memory_order_relaxed) != nullptr || !s_coalescedEvents.empty();
+    }
+
+    void EventManager::postCoalesced(Events eventType, const std::any &userData, const Merger &merge) {
+        auto it = std::find_if(s_coalescedEvents.begin(), s_coalescedEvents.end(), [eventType](const auto &event) { return event.first == eventType; });
+
+        if (it == s_coalescedEvents.end())
+            s_coalescedEvents.emplace_back(eventType, userData);
+        else if (merge)
+            it->second = merge(it->second, userData);
+        else
+            it->second = userData;
+    }
+
+    std::any EventManager::mergeRegions(const std::any &previous, const std::any &next) {
+        auto previousRegion = std::any_cast<Region>(&previous);
+        auto nextRegion = std::any_cast<Region>(&next);
+
+        if (previousRegion == nullptr || nextRegion == nullptr)
+            return { };
+
+        const u64 start = std::min(previousRegion->address, nextRegion->address);
+        const u64 end = std::max(previousRegion->address + previousRegion->size, nextRegion->address + nextRegion->size);
+
+        return Region { start, end - start };
+    }
+
     void EventManager::subscribe(Events eventType, void *owner, std::function<std::any(const std::any&)> callback) {
-        for (auto &handler : SharedData::eventHandlers)
-            if (eventType == handler.eventType && owner == handler.owner)
-                return;
+        auto &handlers = SharedData::eventHandlers[eventType];
+
+        if (std::any_of(handlers.begin(), handlers.end(), [owner](const EventHandler &handler) { return handler.owner == owner; }))
+            return;
 
-        SharedData::eventHandlers.push_back(EventHandler { owner, eventType, callback });
+        handlers.push_back(EventHandler { owner, std::move(callback) });
     }
 
     void EventManager::unsubscribe(Events eventType, void *sender) {
-        std::erase_if(SharedData::eventHandlers, [&eventType, &sender](EventHandler handler) {
-            return eventType == handler.eventType && sender == handler.owner;
+        auto it = SharedData::eventHandlers.find(eventType);
+        if (it == SharedData::eventHandlers.end())
+            return;
+
+        std::erase_if(it->second, [sender](const EventHandler &handler) {
+            return sender == handler.owner;
         });
     }
 
-}
\ No newline at end of file
+}
@@ -1,31 +1,83 @@
 #include <hex/api/imhex_api.hpp>
 
 #include <hex/api/event.hpp>
+#include <hex/api/task.hpp>
+#include <hex/helpers/analysis_cache.hpp>
+#include <hex/helpers/bookmark_store.hpp>
 #include <hex/helpers/shared_data.hpp>
+#include <hex/providers/provider.hpp>
 
-namespace hex {
+#include <algorithm>
 
-    void ImHexApi::Bookmarks::add(Region region, std::string_view name, std::string_view comment, u32 color) {
-        Entry entry;
+namespace hex {
 
-        entry.region = region;
+    void ImHexApi::Common::requestRedraw() {
+        SharedData::redrawRequested = true;
 
-        entry.name.reserve(name.length());
-        entry.comment.reserve(comment.length());
-        std::copy(name.begin(), name.end(), std::back_inserter(entry.name));
-        std::copy(comment.begin(), comment.end(), std::back_inserter(entry.comment));
+        if (SharedData::wakeUpMainLoop)
+            SharedData::wakeUpMainLoop();
+    }
 
-        entry.color = color;
+    void ImHexApi::Bookmarks::add(Region region, std::string_view name, std::string_view comment, u32 color) {
+        Entry entry = { region, std::string(name), std::string(comment), color };
 
-        EventManager::post(Events::AddBookmark, entry);
+        EventManager::notify(Events::AddBookmark, entry);
     }
 
     void ImHexApi::Bookmarks::add(u64 addr, size_t size, std::string_view name, std::string_view comment, u32 color) {
         Bookmarks::add(Region{addr, size}, name, comment, color);
     }
 
-    std::list<ImHexApi::Bookmarks::Entry>& ImHexApi::Bookmarks::getEntries() {
+    BookmarkStore& ImHexApi::Bookmarks::getEntries() {
         return SharedData::bookmarkEntries;
     }
 
+
+    prv::Provider* ImHexApi::Provider::get() {
+        return SharedData::currentProvider;
+    }
+
+    const std::vector<prv::Provider*>& ImHexApi::Provider::getProviders() {
+        return SharedData::providers;
+    }
+
+    void ImHexApi::Provider::add(prv::Provider *provider) {
+        SharedData::providers.push_back(provider);
+
+        Provider::setCurrent(provider);
+    }
+
+    void ImHexApi::Provider::setCurrent(prv::Provider *provider) {
+        auto previous = SharedData::currentProvider;
+        if (previous == provider)
+            return;
+
+        SharedData::currentProvider = provider;
+
+        EventManager::notify(Events::ProviderChanged, previous);
+    }
+
+    void ImHexApi::Provider::remove(prv::Provider *provider) {
+        auto it = std::find(SharedData::providers.begin(), SharedData::providers.end(), provider);
+        if (it == SharedData::providers.end())
+            return;
+
+        // Background tasks may still be reading from the provider that's about to be deleted. Tasks of other providers keep running
+        TaskManager::cancelAndWaitFor(provider);
+
+        it = SharedData::providers.erase(it);
+
+        if (SharedData::currentProvider == provider) {
+            if (it == SharedData::providers.end())
+                SharedData::currentProvider = SharedData::providers.empty() ? nullptr : SharedData::providers.back();
+            else
+                SharedData::currentProvider = *it;
+
+            EventManager::notify(Events::ProviderChanged, static_cast<prv::Provider*>(nullptr));
+        }
+
+        AnalysisCache::remove(provider);
+        delete provider;
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,400 @@
+#include <hex/api/task.hpp>
+
+#include <hex/api/event.hpp>
+#include <hex/api/imhex_api.hpp>
+#include <hex/helpers/trace.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+#if defined(OS_WINDOWS)
+#include <windows.h>
+#elif defined(OS_LINUX)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace hex {
+
+    std::mutex TaskManager::s_mutex;
+    std::condition_variable TaskManager::s_jobAvailable;
+    std::condition_variable TaskManager::s_jobDone;
+    std::vector<std::thread> TaskManager::s_workers;
+    std::vector<std::thread> TaskManager::s_retiredWorkers;
+    TaskManager::PoolSettings TaskManager::s_settings;
+    u64 TaskManager::s_generation = 0;
+    std::array<std::deque<TaskManager::Entry>, 3> TaskManager::s_queuedJobs;
+    std::array<std::deque<std::function<void()>>, 3> TaskManager::s_queuedHelpers;
+    std::vector<TaskManager::Entry> TaskManager::s_finishedJobs;
+    std::vector<TaskHandle> TaskManager::s_runningTasks;
+    bool TaskManager::s_stopping = false;
+
+    static thread_local Task *s_currentTask = nullptr;
+
+    // Makes the task the current one of the calling thread for as long as it exists
+    class CurrentTaskScope {
+    public:
+        explicit CurrentTaskScope(Task *task) : m_previous(std::exchange(s_currentTask, task)) { }
+        ~CurrentTaskScope() { s_currentTask = this->m_previous; }
+
+    private:
+        Task *m_previous;
+    };
+
+    TaskHandle TaskManager::submit(std::string name, Job job, Callback onFinished) {
+        return TaskManager::submit(std::move(name), TaskPriority::Normal, std::move(job), std::move(onFinished));
+    }
+
+    TaskHandle TaskManager::submit(std::string name, TaskPriority priority, Job job, Callback onFinished) {
+        return TaskManager::submit(std::move(name), priority, nullptr, std::move(job), std::move(onFinished));
+    }
+
+    TaskHandle TaskManager::submit(std::string name, prv::Provider *provider, Job job, Callback onFinished) {
+        return TaskManager::submit(std::move(name), TaskPriority::Normal, provider, std::move(job), std::move(onFinished));
+    }
+
+    TaskHandle TaskManager::submit(std::string name, TaskPriority priority, prv::Provider *provider, Job job, Callback onFinished) {
+        auto task = std::make_shared<Task>(std::move(name), priority, provider);
+
+        {
+            std::scoped_lock lock(TaskManager::s_mutex);
+
+            if (TaskManager::s_workers.empty())
+                TaskManager::startWorkers();
+
+            TaskManager::s_queuedJobs[u8(priority)].push_back({ task, std::move(job), std::move(onFinished) });
+            TaskManager::s_runningTasks.push_back(task);
+        }
+
+        // Foreground and background workers wait on the same condition, notifying just one of them might wake the wrong kind
+        TaskManager::s_jobAvailable.notify_all();
+
+        return task;
+    }
+
+    void TaskManager::processFinishedTasks() {
+        std::vector<Entry> finishedJobs;
+
+        {
+            std::scoped_lock lock(TaskManager::s_mutex);
+            std::swap(finishedJobs, TaskManager::s_finishedJobs);
+        }
+
+        for (auto &[task, job, onFinished] : finishedJobs) {
+            if (task->isCancelled())
+                continue;
+
+            if (onFinished)
+                onFinished();
+
+            EventManager::notify(Events::TaskFinished, task);
+        }
+    }
+
+    void TaskManager::cancelAll() {
+        std::scoped_lock lock(TaskManager::s_mutex);
+
+        for (auto &task : TaskManager::s_runningTasks)
+            task->cancel();
+    }
+
+    void TaskManager::waitForAll() {
+        std::unique_lock lock(TaskManager::s_mutex);
+
+        TaskManager::s_jobDone.wait(lock, [] { return TaskManager::s_runningTasks.empty(); });
+    }
+
+    void TaskManager::cancelAndWaitFor(prv::Provider *provider) {
+        std::unique_lock lock(TaskManager::s_mutex);
+
+        auto isBound = [provider](const TaskHandle &task) { return task->getProvider() == provider; };
+
+        for (auto &task : TaskManager::s_runningTasks)
+            if (isBound(task))
+                task->cancel();
+
+        TaskManager::s_jobDone.wait(lock, [&] { return std::none_of(TaskManager::s_runningTasks.begin(), TaskManager::s_runningTasks.end(), isBound); });
+
+        // Tasks that finished before they noticed aren't cancelled yet, their callbacks still have to be skipped
+        for (auto &entry : TaskManager::s_finishedJobs)
+            if (isBound(entry.task))
+                entry.task->cancel();
+    }
+
+    void TaskManager::stop() {
+        TaskManager::cancelAll();
+
+        {
+            std::scoped_lock lock(TaskManager::s_mutex);
+            TaskManager::s_stopping = true;
+        }
+
+        TaskManager::s_jobAvailable.notify_all();
+
+        for (auto &worker : TaskManager::s_workers)
+            worker.join();
+        for (auto &worker : TaskManager::s_retiredWorkers)
+            worker.join();
+
+        TaskManager::s_workers.clear();
+        TaskManager::s_retiredWorkers.clear();
+        TaskManager::s_finishedJobs.clear();
+    }
+
+    std::vector<TaskHandle> TaskManager::getRunningTasks() {
+        std::scoped_lock lock(TaskManager::s_mutex);
+
+        return TaskManager::s_runningTasks;
+    }
+
+
+    void TaskManager::configure(const PoolSettings &settings) {
+        {
+            std::scoped_lock lock(TaskManager::s_mutex);
+
+            if (settings == TaskManager::s_settings)
+                return;
+
+            TaskManager::s_settings = settings;
+
+            // Workers are started lazily, the new settings apply once the first job gets submitted
+            if (TaskManager::s_workers.empty())
+                return;
+
+            TaskManager::s_generation++;
+            std::move(TaskManager::s_workers.begin(), TaskManager::s_workers.end(), std::back_inserter(TaskManager::s_retiredWorkers));
+            TaskManager::s_workers.clear();
+
+            TaskManager::startWorkers();
+        }
+
+        TaskManager::s_jobAvailable.notify_all();
+    }
+
+    u32 TaskManager::getWorkerCount(bool background) {
+        std::scoped_lock lock(TaskManager::s_mutex);
+
+        return TaskManager::getConfiguredWorkerCount(background);
+    }
+
+    u32 TaskManager::getConfiguredWorkerCount(bool background) {
+        const u32 cores = std::thread::hardware_concurrency();
+        if (background)
+            return TaskManager::s_settings.backgroundWorkerCount != 0 ? TaskManager::s_settings.backgroundWorkerCount : std::max(cores / 2, 1U);
+        else
+            return TaskManager::s_settings.workerCount != 0 ? TaskManager::s_settings.workerCount : std::max(cores, 2U);
+    }
+
+    u32 TaskManager::getParallelism(const Task &task, size_t count) {
+        std::scoped_lock lock(TaskManager::s_mutex);
+
+        return std::clamp<size_t>(TaskManager::getConfiguredWorkerCount(task.getPriority() == TaskPriority::Background), 1, std::max<size_t>(count, 1));
+    }
+
+    Task* TaskManager::getCurrentTask() {
+        return s_currentTask;
+    }
+
+    bool TaskManager::parallelFor(Task &task, size_t count, const std::function<void(size_t index)> &function) {
+        return TaskManager::runParallel(task, count, TaskManager::getParallelism(task, count), [&](size_t index, u32) { function(index); });
+    }
+
+    bool TaskManager::runParallel(Task &task, size_t count, u32 threadCount, const std::function<void(size_t index, u32 thread)> &function) {
+        // Helpers that get picked up late may still be queued once the call returned, they only hold on to this
+        struct Run {
+            std::mutex mutex;
+            std::condition_variable helpersDone;
+
+            Task *task;
+            const std::function<void(size_t, u32)> *function;
+            size_t count;
+            std::atomic<size_t> nextIndex = 0;
+
+            u32 nextThread = 1;
+            u32 activeHelpers = 0;
+            bool finished = false;
+            std::exception_ptr exception;
+        };
+
+        threadCount = std::min<size_t>(threadCount, count);
+
+        auto run = std::make_shared<Run>();
+        run->task = &task;
+        run->function = &function;
+        run->count = count;
+
+        auto work = [](Run &run, u32 thread) {
+            CurrentTaskScope taskScope(run.task);
+
+            try {
+                for (size_t index = run.nextIndex++; index < run.count && !run.task->isCancelled(); index = run.nextIndex++)
+                    (*run.function)(index, thread);
+            } catch (...) {
+                std::scoped_lock lock(run.mutex);
+
+                if (run.exception == nullptr)
+                    run.exception = std::current_exception();
+                run.task->cancel();
+            }
+        };
+
+        if (threadCount > 1) {
+            {
+                std::scoped_lock lock(TaskManager::s_mutex);
+
+                if (TaskManager::s_workers.empty() && !TaskManager::s_stopping)
+                    TaskManager::startWorkers();
+
+                if (!TaskManager::s_workers.empty()) {
+                    for (u32 i = 1; i < threadCount; i++) {
+                        TaskManager::s_queuedHelpers[u8(task.getPriority())].push_back([run, work] {
+                            u32 thread;
+                            {
+                                std::scoped_lock lock(run->mutex);
+                                if (run->finished)
+                                    return;
+
+                                thread = run->nextThread++;
+                                run->activeHelpers++;
+                            }
+
+                            work(*run, thread);
+
+                            {
+                                std::scoped_lock lock(run->mutex);
+                                run->activeHelpers--;
+                            }
+
+                            run->helpersDone.notify_all();
+                        });
+                    }
+                }
+            }
+
+            TaskManager::s_jobAvailable.notify_all();
+        }
+
+        work(*run, 0);
+
+        // Every index got handed out, so helpers that are still working are busy with their last one
+        {
+            std::unique_lock lock(run->mutex);
+            run->finished = true;
+            run->helpersDone.wait(lock, [&] { return run->activeHelpers == 0; });
+        }
+
+        if (run->exception != nullptr)
+            std::rethrow_exception(run->exception);
+
+        return !task.isCancelled();
+    }
+
+    void TaskManager::startWorkers() {
+        TaskManager::s_stopping = false;
+
+        for (u32 i = 0; i < TaskManager::getConfiguredWorkerCount(false); i++)
+            TaskManager::s_workers.emplace_back(TaskManager::workerLoop, i, false, TaskManager::s_generation);
+        for (u32 i = 0; i < TaskManager::getConfiguredWorkerCount(true); i++)
+            TaskManager::s_workers.emplace_back(TaskManager::workerLoop, i, true, TaskManager::s_generation);
+    }
+
+    bool TaskManager::hasQueuedJob(bool background) {
+        auto hasQueued = [](TaskPriority priority) {
+            return !TaskManager::s_queuedHelpers[u8(priority)].empty() || !TaskManager::s_queuedJobs[u8(priority)].empty();
+        };
+
+        if (background)
+            return hasQueued(TaskPriority::Background);
+        else
+            return hasQueued(TaskPriority::Interactive) || hasQueued(TaskPriority::Normal);
+    }
+
+    void TaskManager::workerLoop(u32 index, bool background, u64 generation) {
+        trace::setThreadName(hex::format(background ? "Background worker %u" : "Task worker %u", index));
+
+        // Threads the jobs start inherit the priority on Linux, so parallel analyses running in the background stay in the background as well.
+        // Raising it again isn't allowed without privileges, that's why background jobs have workers of their own
+        bool lowerPriority;
+        {
+            std::scoped_lock lock(TaskManager::s_mutex);
+            lowerPriority = background && TaskManager::s_settings.lowerBackgroundPriority;
+        }
+
+        if (lowerPriority) {
+            #if defined(OS_WINDOWS)
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+            #elif defined(OS_LINUX)
+            setpriority(PRIO_PROCESS, syscall(SYS_gettid), 10);
+            #endif
+        }
+
+        while (true) {
+            Entry entry;
+            std::function<void()> helper;
+
+            {
+                std::unique_lock lock(TaskManager::s_mutex);
+                TaskManager::s_jobAvailable.wait(lock, [&] {
+                    return TaskManager::s_stopping || TaskManager::s_generation != generation || TaskManager::hasQueuedJob(background);
+                });
+
+                // Workers of the new configuration take over the queue
+                if (TaskManager::s_generation != generation || !TaskManager::hasQueuedJob(background))
+                    return;
+
+                const auto priority = background ? TaskPriority::Background :
+                                      !TaskManager::s_queuedHelpers[u8(TaskPriority::Interactive)].empty() || !TaskManager::s_queuedJobs[u8(TaskPriority::Interactive)].empty() ? TaskPriority::Interactive :
+                                                                                                                                                                                   TaskPriority::Normal;
+
+                // Helpers speed up a job that's already running
+                if (auto &helpers = TaskManager::s_queuedHelpers[u8(priority)]; !helpers.empty()) {
+                    helper = std::move(helpers.front());
+                    helpers.pop_front();
+                } else {
+                    auto &queue = TaskManager::s_queuedJobs[u8(priority)];
+                    entry = std::move(queue.front());
+                    queue.pop_front();
+                }
+            }
+
+            if (helper) {
+                helper();
+                continue;
+            }
+
+            entry.task->m_running = true;
+
+            // Jobs get skipped entirely if they were cancelled before a worker picked them up
+            if (!entry.task->isCancelled()) {
+                IMHEX_TRACE_ZONE(entry.task->getName(), "task");
+
+                CurrentTaskScope taskScope(entry.task.get());
+
+                try {
+                    entry.job(*entry.task);
+                } catch (...) {
+                    entry.task->cancel();
+                }
+            }
+
+            entry.task->setProgress(1.0F);
+            entry.task->m_finished = true;
+
+            {
+                std::scoped_lock lock(TaskManager::s_mutex);
+
+                std::erase(TaskManager::s_runningTasks, entry.task);
+                TaskManager::s_finishedJobs.push_back(std::move(entry));
+            }
+
+            TaskManager::s_jobDone.notify_all();
+
+            // Completion callbacks run on the main thread, which may be waiting for input
+            ImHexApi::Common::requestRedraw();
+        }
+    }
+
+}
@@ -0,0 +1,227 @@
+#include <hex/data_processor/executor.hpp>
+
+#include <hex/api/task.hpp>
+#include <hex/helpers/shared_data.hpp>
+#include <hex/providers/provider.hpp>
+#include <hex/data_processor/node.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace hex::dp {
+
+    void Executor::sortNodes(const std::list<Node*> &endNodes) {
+        constexpr static size_t Visiting = std::numeric_limits<size_t>::max();
+        std::unordered_map<Node*, size_t> levels;
+
+        this->m_levels.clear();
+
+        // Depth first search along the input links, a node's level is one above the highest level of the nodes it depends on
+        auto visit = [&, this](auto &&visit, Node *node) -> size_t {
+            levels[node] = Visiting;
+
+            size_t level = 0;
+            for (u32 i = 0; i < node->getAttributes().size(); i++) {
+                if (node->getAttributes()[i].getIOType() != Attribute::IOType::In)
+                    continue;
+
+                auto connectedAttribute = node->getConnectedInputAttribute(i);
+                if (connectedAttribute == nullptr)
+                    continue;
+
+                auto parentNode = connectedAttribute->getParentNode();
+                auto parentLevel = levels.find(parentNode);
+
+                // Links closing a cycle are ignored, the node then simply reads the output of the last execution
+                if (parentLevel == levels.end())
+                    level = std::max(level, visit(visit, parentNode) + 1);
+                else if (parentLevel->second != Visiting)
+                    level = std::max(level, parentLevel->second + 1);
+            }
+
+            levels[node] = level;
+
+            if (this->m_levels.size() <= level)
+                this->m_levels.resize(level + 1);
+            this->m_levels[level].push_back(node);
+
+            return level;
+        };
+
+        for (auto endNode : endNodes) {
+            if (!levels.contains(endNode))
+                visit(visit, endNode);
+        }
+
+        this->m_orderValid = true;
+    }
+
+    bool Executor::needsProcessing(Node *node, bool dataChanged) {
+        bool needsProcessing = node->m_dirty || (dataChanged && node->readsProviderData());
+
+        for (u32 i = 0; i < node->getAttributes().size(); i++) {
+            auto &attribute = node->getAttributes()[i];
+            if (attribute.getIOType() != Attribute::IOType::In)
+                continue;
+
+            auto connectedAttribute = node->getConnectedInputAttribute(i);
+            const u32 sourceId = connectedAttribute == nullptr ? 0 : connectedAttribute->getID();
+            const u64 version  = connectedAttribute == nullptr ? 0 : connectedAttribute->getOutputVersion();
+
+            if (attribute.m_processedSourceId != sourceId || attribute.m_processedVersion != version) {
+                attribute.m_processedSourceId = sourceId;
+                attribute.m_processedVersion  = version;
+                needsProcessing = true;
+            }
+        }
+
+        node->m_dirty = false;
+
+        return needsProcessing;
+    }
+
+    void Executor::processNodes(const std::vector<Node*> &nodes) {
+        // Executions on the main thread use the interactive workers. Cancelling the task an execution runs on stops it between levels,
+        // a level that got started is always processed completely
+        const auto currentTask = TaskManager::getCurrentTask();
+        Task batch("Processing data nodes", currentTask != nullptr ? currentTask->getPriority() : TaskPriority::Interactive);
+
+        TaskManager::parallelFor(batch, nodes.size(), [&](size_t index) {
+            nodes[index]->process();
+        });
+    }
+
+    void Executor::updateStreamedNodes() {
+        for (const auto &level : this->m_levels) {
+            for (auto node : level) {
+                node->m_streamed = node->isStreamSource();
+
+                for (u32 i = 0; i < node->getAttributes().size() && !node->m_streamed; i++) {
+                    if (node->getAttributes()[i].getIOType() != Attribute::IOType::In)
+                        continue;
+
+                    auto connectedAttribute = node->getConnectedInputAttribute(i);
+                    if (connectedAttribute != nullptr && connectedAttribute->getParentNode()->m_streamed)
+                        node->m_streamed = true;
+                }
+            }
+        }
+    }
+
+    void Executor::runPass(bool dataChanged) {
+        std::vector<Node*> nodes;
+        for (const auto &level : this->m_levels) {
+            nodes.clear();
+
+            // All inputs of a level come from earlier levels, so their versions are final by now
+            for (auto node : level) {
+                node->m_streamSize = this->m_streamSize;
+
+                if (this->needsProcessing(node, dataChanged))
+                    nodes.push_back(node);
+            }
+
+            if (nodes.size() == 1)
+                nodes.front()->process();
+            else if (nodes.size() > 1)
+                processNodes(nodes);
+
+            // Sources only know their size once they got processed, the levels after them already get to see it
+            for (auto node : level) {
+                if (node->isStreamSource())
+                    this->m_streamSize = std::max(this->m_streamSize, node->getStreamSize());
+            }
+        }
+    }
+
+    void Executor::execute(const std::list<Node*> &endNodes, prv::Provider *provider) {
+        bool restart = !this->m_orderValid;
+
+        if (!this->m_orderValid)
+            this->sortNodes(endNodes);
+
+        const u64 dataGeneration = provider == nullptr ? 0 : provider->getDataGeneration(false);
+        const bool dataChanged = provider != this->m_provider || dataGeneration != this->m_dataGeneration;
+
+        this->m_provider = provider;
+        this->m_dataGeneration = dataGeneration;
+
+        // Dirty nodes got changed by the user, anything the stream produced so far is outdated then
+        for (const auto &level : this->m_levels)
+            restart = restart || std::any_of(level.begin(), level.end(), [](Node *node) { return node->m_dirty; });
+
+        if (restart || dataChanged) {
+            this->updateStreamedNodes();
+
+            this->m_streaming = std::any_of(this->m_levels.begin(), this->m_levels.end(), [](const auto &level) {
+                return std::any_of(level.begin(), level.end(), [](Node *node) { return node->m_streamed; });
+            });
+            this->m_streamOffset = 0;
+            this->m_streamSize = 0;
+        }
+
+        if (!this->m_streaming) {
+            this->runPass(dataChanged);
+            return;
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        bool firstPass = true;
+
+        do {
+            // Every chunk has to reach the end nodes, even if its data happens to match the previous one
+            for (const auto &level : this->m_levels) {
+                for (auto node : level) {
+                    node->m_streamOffset = this->m_streamOffset;
+
+                    if (node->m_streamed)
+                        node->m_dirty = true;
+                }
+            }
+
+            this->runPass(dataChanged && firstPass);
+            firstPass = false;
+
+            this->m_streamOffset += Node::StreamChunkSize;
+            if (this->m_streamOffset >= this->m_streamSize)
+                this->m_streaming = false;
+        } while (this->m_streaming && std::chrono::steady_clock::now() - startTime < StreamTimeBudget);
+    }
+
+    bool Executor::executeFully(const std::list<Node*> &endNodes, prv::Provider *provider, Task &task) {
+        do {
+            if (task.isCancelled())
+                return false;
+
+            this->execute(endNodes, provider);
+
+            if (auto progress = this->getStreamProgress(); progress.has_value())
+                task.setProgress(*progress);
+        } while (this->m_streaming);
+
+        return true;
+    }
+
+    bool Executor::isUpToDate(prv::Provider *provider) const {
+        if (!this->m_orderValid || this->m_streaming)
+            return false;
+
+        const u64 dataGeneration = provider == nullptr ? 0 : provider->getDataGeneration(false);
+        if (provider != this->m_provider || dataGeneration != this->m_dataGeneration)
+            return false;
+
+        // Inputs only change when the nodes they come from get processed, which only happens once something got marked dirty
+        return std::none_of(this->m_levels.begin(), this->m_levels.end(), [](const auto &level) {
+            return std::any_of(level.begin(), level.end(), [](Node *node) { return node->m_dirty; });
+        });
+    }
+
+    std::optional<float> Executor::getStreamProgress() const {
+        if (!this->m_streaming || this->m_streamSize == 0)
+            return { };
+
+        return float(this->m_streamOffset) / this->m_streamSize;
+    }
+
+}
@@ -0,0 +1,88 @@
+#include <hex/helpers/analysis_cache.hpp>
+
+#include <hex/helpers/memory_budget.hpp>
+
+#include <algorithm>
+
+namespace hex {
+
+    std::list<AnalysisCache::Entry> AnalysisCache::s_entries;
+    size_t AnalysisCache::s_budget = AnalysisCache::DefaultBudget;
+    size_t AnalysisCache::s_usedSize = 0;
+
+    void AnalysisCache::storeEntry(prv::Provider *provider, const std::string &key, std::shared_ptr<void> value, size_t size) {
+        (void) AnalysisCache::takeEntry(provider, key);
+
+        if (value == nullptr || size > AnalysisCache::s_budget)
+            return;
+
+        // Registered on first use, the budget is only ever enforced on the main thread like the cache is used
+        static MemoryBudget::Registration registration("Inactive providers",
+            [] { return AnalysisCache::getUsedSize(); },
+            [](size_t size) { return AnalysisCache::trim(size); },
+            MemoryBudget::Priority::InactiveResults);
+
+        AnalysisCache::s_entries.push_front({ provider, key, std::move(value), size });
+        AnalysisCache::s_usedSize += size;
+
+        AnalysisCache::evict();
+    }
+
+    std::shared_ptr<void> AnalysisCache::takeEntry(prv::Provider *provider, const std::string &key) {
+        auto it = std::find_if(AnalysisCache::s_entries.begin(), AnalysisCache::s_entries.end(), [&](const Entry &entry) {
+            return entry.provider == provider && entry.key == key;
+        });
+
+        if (it == AnalysisCache::s_entries.end())
+            return nullptr;
+
+        auto value = std::move(it->value);
+        AnalysisCache::s_usedSize -= it->size;
+        AnalysisCache::s_entries.erase(it);
+
+        return value;
+    }
+
+    void AnalysisCache::remove(prv::Provider *provider) {
+        std::erase_if(AnalysisCache::s_entries, [&](const Entry &entry) {
+            if (entry.provider != provider)
+                return false;
+
+            AnalysisCache::s_usedSize -= entry.size;
+            return true;
+        });
+    }
+
+    void AnalysisCache::evict() {
+        while (AnalysisCache::s_usedSize > AnalysisCache::s_budget && !AnalysisCache::s_entries.empty()) {
+            AnalysisCache::s_usedSize -= AnalysisCache::s_entries.back().size;
+            AnalysisCache::s_entries.pop_back();
+        }
+    }
+
+    size_t AnalysisCache::trim(size_t size) {
+        size_t freed = 0;
+        while (freed < size && !AnalysisCache::s_entries.empty()) {
+            freed += AnalysisCache::s_entries.back().size;
+            AnalysisCache::s_usedSize -= AnalysisCache::s_entries.back().size;
+            AnalysisCache::s_entries.pop_back();
+        }
+
+        return freed;
+    }
+
+    void AnalysisCache::setBudget(size_t budget) {
+        AnalysisCache::s_budget = budget;
+
+        AnalysisCache::evict();
+    }
+
+    size_t AnalysisCache::getBudget() {
+        return AnalysisCache::s_budget;
+    }
+
+    size_t AnalysisCache::getUsedSize() {
+        return AnalysisCache::s_usedSize;
+    }
+
+}
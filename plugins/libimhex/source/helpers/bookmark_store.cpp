@@ -0,0 +1,97 @@
+#include <hex/helpers/bookmark_store.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace hex {
+
+    BookmarkStore::Entry& BookmarkStore::add(Entry entry) {
+        this->m_generation++;
+
+        return this->m_entries.emplace_back(std::move(entry));
+    }
+
+    BookmarkStore::iterator BookmarkStore::erase(const_iterator entry) {
+        this->m_generation++;
+
+        return this->m_entries.erase(entry);
+    }
+
+    void BookmarkStore::assign(std::list<Entry> entries) {
+        this->m_generation++;
+
+        this->m_entries = std::move(entries);
+    }
+
+    void BookmarkStore::clear() {
+        this->m_generation++;
+
+        this->m_entries.clear();
+    }
+
+    void BookmarkStore::markChanged() {
+        this->m_generation++;
+    }
+
+    void BookmarkStore::updateIndex() {
+        if (this->m_indexedGeneration == this->m_generation)
+            return;
+
+        this->m_sortedEntries.clear();
+        this->m_sortedEntries.reserve(this->m_entries.size());
+        for (auto &entry : this->m_entries)
+            this->m_sortedEntries.push_back(&entry);
+
+        std::stable_sort(this->m_sortedEntries.begin(), this->m_sortedEntries.end(), [](const Entry *left, const Entry *right) {
+            return left->region.address < right->region.address;
+        });
+
+        this->m_leafCount = std::bit_ceil(std::max<size_t>(this->m_sortedEntries.size(), 1));
+        this->m_maxEnds.assign(this->m_leafCount * 2, 0);
+
+        for (size_t i = 0; i < this->m_sortedEntries.size(); i++) {
+            const auto &region = this->m_sortedEntries[i]->region;
+
+            this->m_maxEnds[this->m_leafCount + i] = region.address + region.size;
+        }
+
+        for (size_t node = this->m_leafCount - 1; node > 0; node--)
+            this->m_maxEnds[node] = std::max(this->m_maxEnds[node * 2], this->m_maxEnds[node * 2 + 1]);
+
+        this->m_indexedGeneration = this->m_generation;
+    }
+
+    const std::vector<BookmarkStore::Entry*>& BookmarkStore::getSortedEntries() {
+        this->updateIndex();
+
+        return this->m_sortedEntries;
+    }
+
+    void BookmarkStore::collect(size_t node, size_t nodeBegin, size_t nodeEnd, size_t count, u64 address, std::vector<const Entry*> &result) const {
+        if (nodeBegin >= count || this->m_maxEnds[node] <= address)
+            return;
+
+        if (nodeEnd - nodeBegin == 1) {
+            result.push_back(this->m_sortedEntries[nodeBegin]);
+            return;
+        }
+
+        auto middle = nodeBegin + (nodeEnd - nodeBegin) / 2;
+        this->collect(node * 2, nodeBegin, middle, count, address, result);
+        this->collect(node * 2 + 1, middle, nodeEnd, count, address, result);
+    }
+
+    void BookmarkStore::findAt(u64 address, std::vector<const Entry*> &result) {
+        this->updateIndex();
+
+        // Only entries starting at or before the address can contain it. Of those, the tree is only descended into
+        // ranges that reach past the address, so every match costs at most one path down the tree no matter how many
+        // bookmarks come before it
+        auto candidates = std::upper_bound(this->m_sortedEntries.begin(), this->m_sortedEntries.end(), address, [](u64 address, const Entry *entry) {
+            return address < entry->region.address;
+        }) - this->m_sortedEntries.begin();
+
+        this->collect(1, 0, this->m_leafCount, candidates, address, result);
+    }
+
+}
@@ -0,0 +1,227 @@
+#include <hex/helpers/byte_searcher.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+    #define SEARCHER_X86
+    #include <immintrin.h>
+#elif defined(__aarch64__)
+    #define SEARCHER_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace hex {
+
+    // Value and mask of the two bytes every candidate position has to match
+    struct Anchors {
+        size_t firstOffset, lastOffset;
+        u8 firstValue, firstMask;
+        u8 lastValue, lastMask;
+    };
+
+    // Returns bit i for every candidate position i, step bits per position
+    using CandidateFunction = u64(*)(const u8 *data, const Anchors &anchors);
+
+    #if defined(SEARCHER_X86)
+
+    constexpr static size_t VectorSize = sizeof(__m128i);
+
+    static u64 getCandidatesSSE2(const u8 *data, const Anchors &anchors) {
+        auto first = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + anchors.firstOffset)), _mm_set1_epi8(char(anchors.firstMask)));
+        auto last  = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + anchors.lastOffset)), _mm_set1_epi8(char(anchors.lastMask)));
+
+        auto matches = _mm_and_si128(_mm_cmpeq_epi8(first, _mm_set1_epi8(char(anchors.firstValue))), _mm_cmpeq_epi8(last, _mm_set1_epi8(char(anchors.lastValue))));
+
+        return u32(_mm_movemask_epi8(matches));
+    }
+
+    __attribute__((target("avx2"))) static u64 getCandidatesAVX2(const u8 *data, const Anchors &anchors) {
+        auto first = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + anchors.firstOffset)), _mm256_set1_epi8(char(anchors.firstMask)));
+        auto last  = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + anchors.lastOffset)), _mm256_set1_epi8(char(anchors.lastMask)));
+
+        auto matches = _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_set1_epi8(char(anchors.firstValue))), _mm256_cmpeq_epi8(last, _mm256_set1_epi8(char(anchors.lastValue))));
+
+        return u32(_mm256_movemask_epi8(matches));
+    }
+
+    #elif defined(SEARCHER_NEON)
+
+    constexpr static size_t VectorSize = sizeof(uint8x16_t);
+
+    static u64 getCandidatesNEON(const u8 *data, const Anchors &anchors) {
+        auto first = vandq_u8(vld1q_u8(data + anchors.firstOffset), vdupq_n_u8(anchors.firstMask));
+        auto last  = vandq_u8(vld1q_u8(data + anchors.lastOffset), vdupq_n_u8(anchors.lastMask));
+
+        auto matches = vandq_u8(vceqq_u8(first, vdupq_n_u8(anchors.firstValue)), vceqq_u8(last, vdupq_n_u8(anchors.lastValue)));
+
+        // Narrowing every matching lane to a nibble turns the comparison result into a 64 bit mask with 4 bits per byte
+        return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+    }
+
+    #endif
+
+    struct CandidateScanner {
+        CandidateFunction function;
+        size_t positions;   // Positions checked per call
+        size_t step;        // Mask bits per position
+    };
+
+    static std::optional<CandidateScanner> selectCandidateScanner() {
+        #if defined(SEARCHER_X86)
+            #if defined(__GNUC__)
+            if (__builtin_cpu_supports("avx2"))
+                return CandidateScanner { getCandidatesAVX2, sizeof(__m256i), 1 };
+            #endif
+
+            return CandidateScanner { getCandidatesSSE2, VectorSize, 1 };
+        #elif defined(SEARCHER_NEON)
+            return CandidateScanner { getCandidatesNEON, VectorSize, 4 };
+        #else
+            return std::nullopt;
+        #endif
+    }
+
+    static std::optional<u8> parseNibble(char c) {
+        if (c == '?')
+            return std::nullopt;
+
+        return std::isdigit(c) ? c - '0' : std::tolower(c) - 'a' + 10;
+    }
+
+
+    ByteSearcher::ByteSearcher(std::vector<u8> pattern, std::vector<u8> mask) : m_pattern(std::move(pattern)), m_mask(std::move(mask)) {
+        if (std::all_of(this->m_mask.begin(), this->m_mask.end(), [](u8 byte) { return byte == 0xFF; }))
+            this->m_mask.clear();
+
+        this->m_mask.resize(this->m_mask.empty() ? 0 : this->m_pattern.size(), 0xFF);
+
+        for (size_t i = 0; i < this->m_mask.size(); i++)
+            this->m_pattern[i] &= this->m_mask[i];
+
+        const size_t patternSize = this->m_pattern.size();
+        auto getMask = [this](size_t i) -> u8 { return this->m_mask.empty() ? 0xFF : this->m_mask[i]; };
+
+        // Prefer fully known bytes as anchors, they rule out the most positions
+        std::optional<size_t> firstAnchor, lastAnchor;
+        for (u8 requiredMask : { u8(0xFF), u8(0x00) }) {
+            for (size_t i = 0; i < patternSize && !firstAnchor.has_value(); i++)
+                if (getMask(i) != 0x00 && (getMask(i) & requiredMask) == requiredMask)
+                    firstAnchor = i;
+            for (size_t i = patternSize; i > 0 && !lastAnchor.has_value(); i--)
+                if (getMask(i - 1) != 0x00 && (getMask(i - 1) & requiredMask) == requiredMask)
+                    lastAnchor = i - 1;
+        }
+
+        if (firstAnchor.has_value() && lastAnchor.has_value())
+            this->m_anchors = { *firstAnchor, *lastAnchor };
+
+        // Every byte value shifts the pattern to the last position before its end that it could match
+        this->m_shiftTable.fill(patternSize);
+        for (size_t i = 0; i + 1 < patternSize; i++) {
+            if (getMask(i) == 0xFF) {
+                this->m_shiftTable[this->m_pattern[i]] = patternSize - 1 - i;
+            } else {
+                for (u32 value = 0; value < 0x100; value++)
+                    if ((value & getMask(i)) == this->m_pattern[i])
+                        this->m_shiftTable[value] = patternSize - 1 - i;
+            }
+        }
+    }
+
+    std::optional<ByteSearcher> ByteSearcher::parse(std::string_view pattern) {
+        std::vector<u8> bytes, mask;
+
+        std::string digits;
+        for (char c : pattern) {
+            if (std::isspace(c))
+                continue;
+            if (!std::isxdigit(c) && c != '?')
+                return std::nullopt;
+
+            digits += c;
+        }
+
+        if (digits.empty() || digits.size() % 2 != 0)
+            return std::nullopt;
+
+        for (size_t i = 0; i < digits.size(); i += 2) {
+            auto high = parseNibble(digits[i]);
+            auto low  = parseNibble(digits[i + 1]);
+
+            bytes.push_back((high.value_or(0) << 4) | low.value_or(0));
+            mask.push_back((high.has_value() ? 0xF0 : 0x00) | (low.has_value() ? 0x0F : 0x00));
+        }
+
+        return ByteSearcher(std::move(bytes), std::move(mask));
+    }
+
+    size_t ByteSearcher::find(const u8 *data, size_t size) const {
+        static const auto scanner = selectCandidateScanner();
+
+        const size_t patternSize = this->m_pattern.size();
+        if (patternSize == 0 || size < patternSize)
+            return size;
+
+        // A pattern made of wildcards only matches everywhere
+        if (!this->m_anchors.has_value())
+            return 0;
+
+        if (patternSize == 1 && this->m_mask.empty()) {
+            auto match = std::memchr(data, this->m_pattern[0], size);
+            return match == nullptr ? size : reinterpret_cast<const u8*>(match) - data;
+        }
+
+        size_t offset = 0;
+        if (scanner.has_value()) {
+            const auto [firstOffset, lastOffset] = *this->m_anchors;
+            const Anchors anchors = {
+                firstOffset, lastOffset,
+                this->m_pattern[firstOffset], this->m_mask.empty() ? u8(0xFF) : this->m_mask[firstOffset],
+                this->m_pattern[lastOffset],  this->m_mask.empty() ? u8(0xFF) : this->m_mask[lastOffset]
+            };
+
+            for (; offset + patternSize - 1 + scanner->positions <= size; offset += scanner->positions) {
+                u64 candidates = scanner->function(data + offset, anchors);
+
+                while (candidates != 0) {
+                    const size_t position = std::countr_zero(candidates) / scanner->step;
+                    if (this->matches(data + offset + position))
+                        return offset + position;
+
+                    const size_t checkedBits = (position + 1) * scanner->step;
+                    candidates = checkedBits >= 64 ? 0 : candidates & ~((u64(1) << checkedBits) - 1);
+                }
+            }
+        }
+
+        // The remaining bytes are too few for a full vector
+        return offset + this->findHorspool(data + offset, size - offset);
+    }
+
+    bool ByteSearcher::matches(const u8 *data) const {
+        if (this->m_mask.empty())
+            return std::memcmp(data, this->m_pattern.data(), this->m_pattern.size()) == 0;
+
+        for (size_t i = 0; i < this->m_pattern.size(); i++)
+            if ((data[i] & this->m_mask[i]) != this->m_pattern[i])
+                return false;
+
+        return true;
+    }
+
+    size_t ByteSearcher::findHorspool(const u8 *data, size_t size) const {
+        const size_t patternSize = this->m_pattern.size();
+
+        for (size_t i = 0; i + patternSize <= size; i += this->m_shiftTable[data[i + patternSize - 1]]) {
+            if (this->matches(data + i))
+                return i;
+        }
+
+        return size;
+    }
+
+}
@@ -0,0 +1,411 @@
+#include <hex/helpers/data_encoding.hpp>
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+    #define DATA_ENCODING_X86
+    #include <immintrin.h>
+#endif
+
+namespace hex {
+
+    namespace {
+
+        constexpr u8 Invalid = 0xFF, Whitespace = 0xFE, Padding = 0xFD;
+
+        struct Alphabet {
+            std::string_view characters;
+            u8 bits;
+            u8 groupSize;   // Characters per padded group
+            std::array<u8, 256> values;
+        };
+
+        constexpr Alphabet makeAlphabet(std::string_view characters, u8 bits, u8 groupSize, bool caseInsensitive) {
+            Alphabet alphabet = { characters, bits, groupSize, { } };
+
+            alphabet.values.fill(Invalid);
+            for (char c : std::string_view(" \t\r\n\v\f"))
+                alphabet.values[u8(c)] = Whitespace;
+            alphabet.values[u8('=')] = Padding;
+
+            for (u8 i = 0; i < characters.size(); i++) {
+                const char c = characters[i];
+                alphabet.values[u8(c)] = i;
+
+                if (caseInsensitive && c >= 'A' && c <= 'Z')
+                    alphabet.values[u8(c - 'A' + 'a')] = i;
+            }
+
+            return alphabet;
+        }
+
+        constexpr auto Base16 = makeAlphabet("0123456789ABCDEF", 4, 1, true);
+        constexpr auto Base32 = makeAlphabet("ABCDEFGHIJKLMNOPQRSTUVWXYZ234567", 5, 8, true);
+        constexpr auto Base64 = makeAlphabet("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/", 6, 4, false);
+
+        const Alphabet& getAlphabet(DataEncoding encoding) {
+            switch (encoding) {
+                case DataEncoding::Base16: return Base16;
+                case DataEncoding::Base32: return Base32;
+                default:                   return Base64;
+            }
+        }
+
+        constexpr bool isWhitespace(u8 c) {
+            return Base64.values[c] == Whitespace;
+        }
+
+    }
+
+    #if defined(DATA_ENCODING_X86)
+
+    static bool hasSSSE3() {
+        static const bool supported = __builtin_cpu_supports("ssse3");
+        return supported;
+    }
+
+    /*
+     * Base64 decoding and encoding with SSSE3, as described by Wojciech Muła and Daniel Lemire. Characters are mapped to their values
+     * by an offset picked by their high nibble, the values are then packed together with multiply-adds and a shuffle.
+     * Decoding stops at the first block that contains anything but alphabet characters and returns the number of characters consumed.
+     * Both write 16 bytes per block, only the first 12 of them are part of the decoded output.
+     */
+
+    __attribute__((target("ssse3"))) static size_t decodeBase64SSSE3(const u8 *input, size_t size, u8 *output) {
+        const __m128i lowerBounds = _mm_setr_epi8(1, 1, 0x2B, 0x30, 0x41, 0x50, 0x61, 0x70, 1, 1, 1, 1, 1, 1, 1, 1);
+        const __m128i upperBounds = _mm_setr_epi8(0, 0, 0x2B, 0x39, 0x4F, 0x5A, 0x6F, 0x7A, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i offsets     = _mm_setr_epi8(0, 0, 0x3E - 0x2B, 0x34 - 0x30, 0x00 - 0x41, 0x0F - 0x50, 0x1A - 0x61, 0x29 - 0x70, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i pack        = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+        size_t offset = 0;
+        for (; offset + 16 <= size; offset += 16, output += 12) {
+            const __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + offset));
+            const __m128i highNibbles = _mm_and_si128(_mm_srli_epi32(characters, 4), _mm_set1_epi8(0x0F));
+
+            // '/' shares its high nibble with '+', it's the only character that's outside of the range its nibble selects
+            const __m128i slashes = _mm_cmpeq_epi8(characters, _mm_set1_epi8('/'));
+            const __m128i below = _mm_cmplt_epi8(characters, _mm_shuffle_epi8(lowerBounds, highNibbles));
+            const __m128i above = _mm_cmpgt_epi8(characters, _mm_shuffle_epi8(upperBounds, highNibbles));
+            if (_mm_movemask_epi8(_mm_andnot_si128(slashes, _mm_or_si128(below, above))) != 0)
+                break;
+
+            __m128i values = _mm_add_epi8(characters, _mm_shuffle_epi8(offsets, highNibbles));
+            values = _mm_add_epi8(values, _mm_and_si128(slashes, _mm_set1_epi8(-3)));
+
+            const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+            const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_shuffle_epi8(groups, pack));
+        }
+
+        return offset;
+    }
+
+    // Returns the number of bytes consumed, always a multiple of 12. Reads 16 bytes for every 12 it encodes
+    __attribute__((target("ssse3"))) static size_t encodeBase64SSSE3(const u8 *input, size_t size, u8 *output) {
+        const __m128i spread  = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+        const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+        size_t offset = 0;
+        for (; offset + 16 <= size; offset += 12, output += 16) {
+            const __m128i bytes = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + offset)), spread);
+
+            // Moves every 6 bits into a byte of their own
+            const __m128i high = _mm_mulhi_epu16(_mm_and_si128(bytes, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+            const __m128i low = _mm_mullo_epi16(_mm_and_si128(bytes, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+            const __m128i values = _mm_or_si128(high, low);
+
+            // Values below 26 get offset 13 ('A'), the ones from 26 to 51 offset 0, all others one of the offsets after it
+            __m128i ranges = _mm_subs_epu8(values, _mm_set1_epi8(51));
+            ranges = _mm_or_si128(ranges, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), values), _mm_set1_epi8(13)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_add_epi8(values, _mm_shuffle_epi8(offsets, ranges)));
+        }
+
+        return offset;
+    }
+
+    #endif
+
+    bool DataDecoder::update(std::span<const u8> input, std::vector<u8> &output) {
+        if (this->m_failed)
+            return false;
+
+        const bool valid = this->m_encoding == DataEncoding::Ascii85 ? this->decodeAscii85(input, output) : this->decodeRadix(input, output);
+        if (!valid)
+            this->m_failed = true;
+
+        return valid;
+    }
+
+    bool DataDecoder::finish(std::vector<u8> &output) {
+        bool valid = !this->m_failed;
+
+        if (valid && this->m_encoding == DataEncoding::Ascii85) {
+            // Incomplete groups are padded with the highest digit, every character after the first one adds a byte
+            if (this->m_count == 1 || this->m_delimiter == Delimiter::Opening)
+                valid = false;
+            else if (this->m_count > 1) {
+                u64 value = this->m_value;
+                for (u8 i = this->m_count; i < 5; i++)
+                    value = value * 85 + 84;
+
+                if (value > 0xFFFF'FFFF)
+                    valid = false;
+                else {
+                    for (u8 i = 0; i < this->m_count - 1; i++)
+                        output.push_back(u8(value >> (24 - i * 8)));
+                }
+            }
+        } else if (valid) {
+            // Leftover bits are fine as long as they didn't need a character of their own
+            valid = this->m_count < getAlphabet(this->m_encoding).bits;
+        }
+
+        this->reset();
+
+        return valid;
+    }
+
+    void DataDecoder::reset() {
+        this->m_value = 0;
+        this->m_count = 0;
+        this->m_padded = false;
+        this->m_failed = false;
+        this->m_delimiter = Delimiter::None;
+    }
+
+    bool DataDecoder::decodeRadix(std::span<const u8> input, std::vector<u8> &output) {
+        const auto &alphabet = getAlphabet(this->m_encoding);
+
+        // The vectorized decoder writes 4 more bytes than it decodes
+        const size_t start = output.size();
+        output.resize(start + (input.size() * alphabet.bits + 7) / 8 + 16);
+        u8 *out = output.data() + start;
+
+        bool valid = true;
+        size_t i = 0;
+        while (i < input.size() && valid) {
+            #if defined(DATA_ENCODING_X86)
+            if (this->m_encoding == DataEncoding::Base64 && this->m_count == 0 && !this->m_padded && hasSSSE3()) {
+                const size_t consumed = decodeBase64SSSE3(input.data() + i, input.size() - i, out);
+                i += consumed;
+                out += consumed / 4 * 3;
+            }
+            #endif
+
+            // One character at a time over the next block that couldn't be decoded at once, until a group is complete again
+            const size_t blockEnd = std::min(input.size(), i + 16);
+            for (; i < input.size() && (i < blockEnd || this->m_count != 0); i++) {
+                const u8 value = alphabet.values[input[i]];
+
+                if (value == Whitespace)
+                    continue;
+                if (value == Padding) {
+                    this->m_padded = true;
+                    continue;
+                }
+                if (value == Invalid || this->m_padded) {
+                    valid = false;
+                    break;
+                }
+
+                this->m_value = (this->m_value << alphabet.bits) | value;
+                this->m_count += alphabet.bits;
+
+                if (this->m_count >= 8) {
+                    this->m_count -= 8;
+                    *out++ = u8(this->m_value >> this->m_count);
+                    this->m_value &= (1U << this->m_count) - 1;
+                }
+            }
+        }
+
+        output.resize(out - output.data());
+
+        return valid;
+    }
+
+    bool DataDecoder::decodeAscii85(std::span<const u8> input, std::vector<u8> &output) {
+        output.reserve(output.size() + input.size() / 5 * 4 + 4);
+
+        for (const u8 c : input) {
+            if (isWhitespace(c))
+                continue;
+
+            switch (this->m_delimiter) {
+                case Delimiter::Closed:
+                    return false;
+                case Delimiter::Closing:
+                    if (c != '>')
+                        return false;
+                    this->m_delimiter = Delimiter::Closed;
+                    continue;
+                case Delimiter::None:
+                    // A leading < is only the opening delimiter if it's followed by a ~, otherwise it's a regular digit
+                    if (c == '<') {
+                        this->m_delimiter = Delimiter::Opening;
+                        continue;
+                    }
+                    break;
+                case Delimiter::Opening:
+                    this->m_delimiter = Delimiter::Data;
+                    if (c == '~')
+                        continue;
+
+                    this->m_value = '<' - '!';
+                    this->m_count = 1;
+                    break;
+                case Delimiter::Data:
+                    break;
+            }
+
+            this->m_delimiter = Delimiter::Data;
+
+            if (c == '~') {
+                this->m_delimiter = Delimiter::Closing;
+            } else if (c == 'z' && this->m_count == 0) {
+                output.insert(output.end(), 4, 0x00);
+            } else if (c >= '!' && c <= 'u') {
+                this->m_value = this->m_value * 85 + (c - '!');
+                this->m_count++;
+
+                if (this->m_count == 5) {
+                    if (this->m_value > 0xFFFF'FFFF)
+                        return false;
+
+                    for (u8 i = 0; i < 4; i++)
+                        output.push_back(u8(this->m_value >> (24 - i * 8)));
+
+                    this->m_value = 0;
+                    this->m_count = 0;
+                }
+            } else {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void DataEncoder::update(std::span<const u8> input, std::vector<u8> &output) {
+        if (this->m_encoding == DataEncoding::Ascii85) {
+            output.reserve(output.size() + input.size() / 4 * 5 + 5);
+
+            for (const u8 byte : input) {
+                this->m_value = (this->m_value << 8) | byte;
+                this->m_count++;
+
+                if (this->m_count < 4)
+                    continue;
+
+                if (this->m_value == 0)
+                    output.push_back('z');
+                else {
+                    std::array<u8, 5> digits = { };
+                    for (u8 i = 5; i > 0; i--, this->m_value /= 85)
+                        digits[i - 1] = '!' + this->m_value % 85;
+                    output.insert(output.end(), digits.begin(), digits.end());
+                }
+
+                this->m_value = 0;
+                this->m_count = 0;
+            }
+
+            return;
+        }
+
+        const auto &alphabet = getAlphabet(this->m_encoding);
+        const u8 mask = (1U << alphabet.bits) - 1;
+
+        // The vectorized encoder reads past the bytes it encodes, but never writes more than it produces
+        const size_t start = output.size();
+        output.resize(start + (input.size() * 8 + alphabet.bits - 1) / alphabet.bits + 2);
+        u8 *out = output.data() + start;
+
+        // Less than a character's worth of bits is left over after every byte, so 16 bits are enough to hold them and the next byte
+        auto encodeByte = [&, this](u8 byte) {
+            this->m_value = ((this->m_value << 8) | byte) & 0xFFFF;
+            this->m_count += 8;
+
+            while (this->m_count >= alphabet.bits) {
+                this->m_count -= alphabet.bits;
+                *out++ = alphabet.characters[(this->m_value >> this->m_count) & mask];
+            }
+        };
+
+        size_t i = 0;
+
+        #if defined(DATA_ENCODING_X86)
+        if (this->m_encoding == DataEncoding::Base64 && hasSSSE3()) {
+            // Gets back to the start of a group first, so the rest lines up with the blocks
+            for (; i < input.size() && this->m_count != 0; i++)
+                encodeByte(input[i]);
+
+            const size_t consumed = encodeBase64SSSE3(input.data() + i, input.size() - i, out);
+            i += consumed;
+            out += consumed / 3 * 4;
+        }
+        #endif
+
+        for (; i < input.size(); i++)
+            encodeByte(input[i]);
+
+        this->m_written += (out - output.data()) - start;
+        output.resize(out - output.data());
+    }
+
+    void DataEncoder::finish(std::vector<u8> &output) {
+        if (this->m_encoding == DataEncoding::Ascii85) {
+            // Incomplete groups are padded with zeros and only get as many digits as are needed to restore them
+            if (this->m_count > 0) {
+                u64 value = this->m_value << (8 * (4 - this->m_count));
+
+                std::array<u8, 5> digits = { };
+                for (u8 i = 5; i > 0; i--, value /= 85)
+                    digits[i - 1] = '!' + value % 85;
+                output.insert(output.end(), digits.begin(), digits.begin() + this->m_count + 1);
+            }
+        } else {
+            const auto &alphabet = getAlphabet(this->m_encoding);
+
+            if (this->m_count > 0) {
+                output.push_back(alphabet.characters[(this->m_value << (alphabet.bits - this->m_count)) & ((1U << alphabet.bits) - 1)]);
+                this->m_written++;
+            }
+
+            for (; this->m_written % alphabet.groupSize != 0; this->m_written++)
+                output.push_back('=');
+        }
+
+        this->reset();
+    }
+
+    void DataEncoder::reset() {
+        this->m_value = 0;
+        this->m_count = 0;
+        this->m_written = 0;
+    }
+
+    std::optional<std::vector<u8>> decodeData(DataEncoding encoding, std::span<const u8> input) {
+        DataDecoder decoder(encoding);
+
+        std::vector<u8> output;
+        if (!decoder.update(input, output) || !decoder.finish(output))
+            return { };
+
+        return output;
+    }
+
+    std::vector<u8> encodeData(DataEncoding encoding, std::span<const u8> input) {
+        DataEncoder encoder(encoding);
+
+        std::vector<u8> output;
+        encoder.update(input, output);
+        encoder.finish(output);
+
+        return output;
+    }
+
+}
@@ -0,0 +1,68 @@
+#include <hex/helpers/highlight_index.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+namespace hex {
+
+    void HighlightIndex::add(u64 address, size_t size, u32 color) {
+        if (size == 0)
+            return;
+
+        u64 curr = address;
+        const u64 end = address + size;
+
+        // Skip the part that's already covered by a run starting before the new region
+        auto it = this->m_runs.upper_bound(curr);
+        if (it != this->m_runs.begin()) {
+            auto prev = std::prev(it);
+            curr = std::max(curr, prev->second.end);
+        }
+
+        // Fill all gaps between existing runs
+        while (curr < end) {
+            it = this->m_runs.lower_bound(curr);
+
+            const bool covered = it != this->m_runs.end() && it->first < end;
+            const u64 gapEnd = covered ? it->first : end;
+            const u64 next   = covered ? it->second.end : end;
+
+            if (gapEnd > curr)
+                this->insertRun(curr, gapEnd, color);
+
+            curr = next;
+        }
+    }
+
+    std::optional<u32> HighlightIndex::get(u64 address) const {
+        auto it = this->m_runs.upper_bound(address);
+        if (it == this->m_runs.begin())
+            return { };
+
+        it = std::prev(it);
+        if (address >= it->second.end)
+            return { };
+
+        return it->second.color;
+    }
+
+    void HighlightIndex::insertRun(u64 start, u64 end, u32 color) {
+        auto next = this->m_runs.lower_bound(start);
+
+        if (next != this->m_runs.end() && next->first == end && next->second.color == color) {
+            end = next->second.end;
+            next = this->m_runs.erase(next);
+        }
+
+        if (next != this->m_runs.begin()) {
+            auto prev = std::prev(next);
+            if (prev->second.end == start && prev->second.color == color) {
+                prev->second.end = end;
+                return;
+            }
+        }
+
+        this->m_runs.emplace_hint(next, start, Run{ end, color });
+    }
+
+}
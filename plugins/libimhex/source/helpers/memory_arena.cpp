@@ -0,0 +1,92 @@
+#include <hex/helpers/memory_arena.hpp>
+
+#include <new>
+
+namespace hex {
+
+    static thread_local MemoryArena *s_currentArena = nullptr;
+
+    // Placed in front of every object so deleting it finds the arena it came from
+    struct alignas(16) ObjectHeader {
+        MemoryArena *arena;
+    };
+
+    void* MemoryArena::allocate(size_t size) {
+        size = (size + Alignment - 1) & ~(Alignment - 1);
+
+        if (size > MaxPooledSize)
+            return ::operator new(size);
+
+        auto &freeList = this->m_freeLists[size / Alignment - 1];
+        if (freeList != nullptr) {
+            auto pointer = freeList;
+            freeList = *static_cast<void**>(pointer);
+
+            return pointer;
+        }
+
+        if (this->m_blockRemaining < size) {
+            this->m_blocks.push_back(std::unique_ptr<u8[]>(new u8[BlockSize]));
+            this->m_blockPosition = this->m_blocks.back().get();
+            this->m_blockRemaining = BlockSize;
+        }
+
+        auto pointer = this->m_blockPosition;
+        this->m_blockPosition += size;
+        this->m_blockRemaining -= size;
+
+        return pointer;
+    }
+
+    void MemoryArena::deallocate(void *pointer, size_t size) {
+        size = (size + Alignment - 1) & ~(Alignment - 1);
+
+        if (size > MaxPooledSize) {
+            ::operator delete(pointer);
+            return;
+        }
+
+        auto &freeList = this->m_freeLists[size / Alignment - 1];
+        *static_cast<void**>(pointer) = freeList;
+        freeList = pointer;
+    }
+
+    MemoryArena& MemoryArena::createChild() {
+        this->m_children.push_back(std::make_unique<MemoryArena>());
+
+        return *this->m_children.back();
+    }
+
+    MemoryArena* MemoryArena::getCurrent() {
+        return s_currentArena;
+    }
+
+    MemoryArena::Scope::Scope(MemoryArena &arena) : m_previous(s_currentArena) {
+        s_currentArena = &arena;
+    }
+
+    MemoryArena::Scope::~Scope() {
+        s_currentArena = this->m_previous;
+    }
+
+    void* MemoryArena::allocateObject(size_t size) {
+        auto arena = s_currentArena;
+        auto header = static_cast<ObjectHeader*>(arena != nullptr ? arena->allocate(sizeof(ObjectHeader) + size) : ::operator new(sizeof(ObjectHeader) + size));
+        header->arena = arena;
+
+        return header + 1;
+    }
+
+    void MemoryArena::deallocateObject(void *pointer, size_t size) {
+        if (pointer == nullptr)
+            return;
+
+        auto header = static_cast<ObjectHeader*>(pointer) - 1;
+
+        if (header->arena != nullptr)
+            header->arena->deallocate(header, sizeof(ObjectHeader) + size);
+        else
+            ::operator delete(header);
+    }
+
+}
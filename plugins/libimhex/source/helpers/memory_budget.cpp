@@ -0,0 +1,155 @@
+#include <hex/helpers/memory_budget.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace hex {
+
+    namespace {
+
+        struct Consumer {
+            std::string subsystem;
+            MemoryBudget::UsageFunction usage;
+            MemoryBudget::EvictFunction evict;
+            MemoryBudget::Priority priority;
+        };
+
+        // Function local so consumers registered during static initialization of other translation units find it in place
+        struct State {
+            std::mutex mutex;
+            std::map<u64, Consumer> consumers;
+            u64 nextId = 1;
+            std::atomic<size_t> limit = MemoryBudget::DefaultLimit;
+        };
+
+        State& getState() {
+            static State state;
+            return state;
+        }
+
+    }
+
+    MemoryBudget::Registration::Registration(std::string_view subsystem, UsageFunction usage, EvictFunction evict, Priority priority) {
+        auto &state = getState();
+
+        std::scoped_lock lock(state.mutex);
+        this->m_id = state.nextId++;
+        state.consumers.emplace(this->m_id, Consumer { std::string(subsystem), std::move(usage), std::move(evict), priority });
+    }
+
+    MemoryBudget::Registration::~Registration() {
+        this->reset();
+    }
+
+    MemoryBudget::Registration::Registration(Registration &&other) noexcept : m_id(std::exchange(other.m_id, 0)) {
+
+    }
+
+    MemoryBudget::Registration& MemoryBudget::Registration::operator=(Registration &&other) noexcept {
+        if (this != &other) {
+            this->reset();
+            this->m_id = std::exchange(other.m_id, 0);
+        }
+
+        return *this;
+    }
+
+    void MemoryBudget::Registration::reset() {
+        if (this->m_id == 0)
+            return;
+
+        // Waits for callbacks that are running right now, the consumer may be gone right after this returns
+        auto &state = getState();
+
+        std::scoped_lock lock(state.mutex);
+        state.consumers.erase(this->m_id);
+        this->m_id = 0;
+    }
+
+    void MemoryBudget::setLimit(size_t limit) {
+        getState().limit = limit;
+    }
+
+    size_t MemoryBudget::getLimit() {
+        return getState().limit;
+    }
+
+    void MemoryBudget::enforce() {
+        auto &state = getState();
+        std::scoped_lock lock(state.mutex);
+
+        struct Candidate {
+            Consumer *consumer;
+            size_t size;
+        };
+
+        size_t total = 0;
+        std::vector<Candidate> candidates;
+        for (auto &[id, consumer] : state.consumers) {
+            const size_t size = consumer.usage();
+            total += size;
+
+            if (consumer.evict && size > 0)
+                candidates.push_back({ &consumer, size });
+        }
+
+        const size_t limit = state.limit;
+        if (total <= limit)
+            return;
+
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &left, const Candidate &right) {
+            if (left.consumer->priority != right.consumer->priority)
+                return left.consumer->priority < right.consumer->priority;
+
+            return left.size > right.size;
+        });
+
+        for (const auto &[consumer, size] : candidates) {
+            if (total <= limit)
+                break;
+
+            total -= std::min(total, consumer->evict(total - limit));
+        }
+    }
+
+    std::vector<MemoryBudget::Usage> MemoryBudget::getUsage() {
+        auto &state = getState();
+        std::scoped_lock lock(state.mutex);
+
+        std::map<std::string_view, Usage> subsystems;
+        for (auto &[id, consumer] : state.consumers) {
+            auto &usage = subsystems[consumer.subsystem];
+            const size_t size = consumer.usage();
+
+            usage.size += size;
+            if (consumer.evict)
+                usage.evictableSize += size;
+            usage.consumers++;
+        }
+
+        std::vector<Usage> result;
+        for (auto &[subsystem, usage] : subsystems) {
+            usage.subsystem = subsystem;
+            result.push_back(std::move(usage));
+        }
+
+        std::sort(result.begin(), result.end(), [](const Usage &left, const Usage &right) { return left.size > right.size; });
+
+        return result;
+    }
+
+    size_t MemoryBudget::getTotalUsage() {
+        auto &state = getState();
+        std::scoped_lock lock(state.mutex);
+
+        size_t total = 0;
+        for (auto &[id, consumer] : state.consumers)
+            total += consumer.usage();
+
+        return total;
+    }
+
+}
@@ -0,0 +1,137 @@
+#include <hex/helpers/multi_searcher.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+namespace hex {
+
+    MultiSearcher::MultiSearcher(const std::vector<std::vector<u8>> &patterns) {
+        auto addState = [this] {
+            this->m_transitions.resize(this->m_transitions.size() + 0x100, NoState);
+            this->m_outputs.emplace_back();
+
+            return State(this->m_outputs.size() - 1);
+        };
+
+        addState();
+
+        // Build the trie of all patterns
+        for (u32 patternIndex = 0; patternIndex < patterns.size(); patternIndex++) {
+            const auto &pattern = patterns[patternIndex];
+            this->m_patternSizes.push_back(pattern.size());
+            this->m_maxPatternSize = std::max(this->m_maxPatternSize, pattern.size());
+
+            if (pattern.empty())
+                continue;
+
+            State state = InitialState;
+            for (u8 byte : pattern) {
+                if (this->m_transitions[state * 0x100 + byte] == NoState) {
+                    State newState = addState();
+                    this->m_transitions[state * 0x100 + byte] = newState;
+                }
+
+                state = this->m_transitions[state * 0x100 + byte];
+            }
+
+            this->m_outputs[state].push_back(patternIndex);
+        }
+
+        const size_t stateCount = this->m_outputs.size();
+        std::vector<State> failureLinks(stateCount, InitialState);
+        this->m_outputLinks.resize(stateCount, NoState);
+        std::vector<bool> hasOutput(stateCount, false);
+
+        std::deque<State> queue;
+        for (u32 byte = 0; byte < 0x100; byte++) {
+            auto &next = this->m_transitions[byte];
+
+            if (next == NoState) {
+                next = InitialState;
+            } else {
+                queue.push_back(next);
+                hasOutput[next] = !this->m_outputs[next].empty();
+            }
+        }
+
+        // Visit states in breadth-first order so the failure chain of every state is complete before its children get processed
+        while (!queue.empty()) {
+            State state = queue.front();
+            queue.pop_front();
+
+            for (u32 byte = 0; byte < 0x100; byte++) {
+                auto &next = this->m_transitions[state * 0x100 + byte];
+                State fallback = this->m_transitions[failureLinks[state] * 0x100 + byte];
+
+                if (next == NoState) {
+                    // Missing transitions take the one of the longest suffix that has it, which turns the trie into a DFA
+                    next = fallback;
+                } else {
+                    failureLinks[next] = fallback;
+                    this->m_outputLinks[next] = this->m_outputs[fallback].empty() ? this->m_outputLinks[fallback] : fallback;
+                    hasOutput[next] = !this->m_outputs[next].empty() || this->m_outputLinks[next] != NoState;
+
+                    queue.push_back(next);
+                }
+            }
+        }
+
+        for (auto &next : this->m_transitions)
+            next = (next * 0x100) | (hasOutput[next] ? OutputFlag : 0);
+    }
+
+    MultiSearcher::State MultiSearcher::search(const u8 *data, size_t size, u64 address, State state, const Callback &callback) const {
+        // The table holds pre-multiplied row offsets with the output flag in the top bit, so stepping is a single dependent load per byte
+        const State *transitions = this->m_transitions.data();
+        State rows[LaneCount] = { state * 0x100 };
+
+        std::vector<std::pair<u32, u64>> laneMatches[LaneCount];
+        auto step = [&](u32 lane, size_t i) {
+            rows[lane] = transitions[(rows[lane] & ~OutputFlag) + data[i]];
+
+            if (rows[lane] & OutputFlag) [[unlikely]] {
+                for (State output = (rows[lane] & ~OutputFlag) / 0x100; output != NoState; output = this->m_outputLinks[output]) {
+                    for (u32 patternIndex : this->m_outputs[output])
+                        laneMatches[lane].emplace_back(patternIndex, address + i + 1 - this->m_patternSizes[patternIndex]);
+                }
+            }
+        };
+
+        /*
+         * A single walk through the table is bound by load latency. Large blocks are split into lanes walked in lockstep instead.
+         * The automaton's state only depends on the last m_maxPatternSize bytes read, so every lane but the first one
+         * starts that many bytes early without reporting matches and joins in with the exact state the lane before it would have had.
+         */
+        u32 lastLane = 0;
+        if (size >= LaneCount * std::max<size_t>(MinimumLaneSize, this->m_maxPatternSize)) {
+            const size_t laneSize = size / LaneCount;
+
+            for (u32 lane = 1; lane < LaneCount; lane++) {
+                rows[lane] = InitialState;
+                for (size_t i = lane * laneSize - this->m_maxPatternSize; i < lane * laneSize; i++)
+                    rows[lane] = transitions[(rows[lane] & ~OutputFlag) + data[i]];
+            }
+
+            for (size_t i = 0; i < laneSize; i++) {
+                for (u32 lane = 0; lane < LaneCount; lane++)
+                    step(lane, lane * laneSize + i);
+            }
+
+            // The last lane also walks the bytes the division left over
+            lastLane = LaneCount - 1;
+            for (size_t i = LaneCount * laneSize; i < size; i++)
+                step(lastLane, i);
+        } else {
+            for (size_t i = 0; i < size; i++)
+                step(lastLane, i);
+        }
+
+        for (u32 lane = 0; lane <= lastLane; lane++)
+            for (auto [patternIndex, matchAddress] : laneMatches[lane])
+                callback(patternIndex, matchAddress);
+
+        return (rows[lastLane] & ~OutputFlag) / 0x100;
+    }
+
+}
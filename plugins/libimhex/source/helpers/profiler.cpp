@@ -0,0 +1,334 @@
+#include <hex/helpers/profiler.hpp>
+
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+
+namespace hex {
+
+    std::atomic<bool> Profiler::s_enabled = false;
+    std::thread::id Profiler::s_mainThread;
+
+    std::map<std::string, Profiler::Statistics, std::less<>> Profiler::s_statistics;
+    Profiler::ReadStatistics Profiler::s_readStatistics;
+    std::atomic<u64> Profiler::s_readCount = 0, Profiler::s_readBytes = 0, Profiler::s_mainThreadReadCount = 0, Profiler::s_mainThreadReadBytes = 0;
+
+    Profiler::ReadStatistics Profiler::s_allocationStatistics;
+    std::atomic<u64> Profiler::s_allocationCount = 0, Profiler::s_allocationBytes = 0, Profiler::s_mainThreadAllocationCount = 0, Profiler::s_mainThreadAllocationBytes = 0;
+    thread_local Profiler::Allocations Profiler::s_threadAllocations;
+    thread_local bool Profiler::s_inBookkeeping = false;
+
+    std::atomic<bool> Profiler::s_recording = false;
+    std::atomic<u64> Profiler::s_recordingStart = 0;
+    std::atomic<size_t> Profiler::s_traceEventCount = 0;
+
+    std::mutex Profiler::s_threadBufferMutex;
+    std::vector<std::shared_ptr<Profiler::ThreadBuffer>> Profiler::s_threadBuffers;
+
+    Profiler::Scope::Scope(std::string_view name, std::string_view category) : m_name(name), m_category(category), m_active(Profiler::isEnabled()) {
+        if (this->m_active) {
+            this->m_start = Profiler::getTime();
+            this->m_startAllocations = Profiler::s_threadAllocations;
+        }
+    }
+
+    Profiler::Scope::~Scope() {
+        if (!this->m_active)
+            return;
+
+        const auto &allocations = Profiler::s_threadAllocations;
+        Profiler::addScope(this->m_name, this->m_category, this->m_start, Profiler::getTime(),
+                           { allocations.count - this->m_startAllocations.count, allocations.bytes - this->m_startAllocations.bytes });
+    }
+
+
+    void Profiler::History::push(double value) {
+        this->values[this->next] = value;
+        this->next = (this->next + 1) % HistorySize;
+        this->count = std::min(this->count + 1, HistorySize);
+    }
+
+    double Profiler::History::getLatest() const {
+        if (this->count == 0)
+            return 0;
+
+        return this->values[(this->next + HistorySize - 1) % HistorySize];
+    }
+
+    double Profiler::History::getAverage() const {
+        if (this->count == 0)
+            return 0;
+
+        // Entries that weren't written yet are zero
+        return std::accumulate(this->values.begin(), this->values.end(), 0.0) / this->count;
+    }
+
+    double Profiler::History::getMaximum() const {
+        return *std::max_element(this->values.begin(), this->values.end());
+    }
+
+
+    u32 Profiler::ThreadBuffer::getStringId(std::string_view string) {
+        auto it = this->stringIds.find(string);
+        if (it == this->stringIds.end()) {
+            it = this->stringIds.emplace(std::string(string), this->strings.size()).first;
+            this->strings.emplace_back(string);
+        }
+
+        return it->second;
+    }
+
+
+    void Profiler::setEnabled(bool enabled) {
+        if (enabled && !Profiler::s_enabled) {
+            Profiler::s_mainThread = std::this_thread::get_id();
+            Profiler::setThreadName("Main thread");
+        }
+
+        Profiler::s_enabled = enabled;
+    }
+
+    bool Profiler::isEnabled() {
+        return Profiler::s_enabled.load(std::memory_order_relaxed);
+    }
+
+    void Profiler::setThreadName(std::string_view name) {
+        BookkeepingScope bookkeeping;
+        auto &buffer = Profiler::getThreadBuffer();
+
+        std::scoped_lock lock(buffer.mutex);
+        buffer.name = name;
+    }
+
+    u64 Profiler::getTime() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Profiler::ThreadBuffer& Profiler::getThreadBuffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+            auto buffer = std::make_shared<ThreadBuffer>();
+
+            std::scoped_lock lock(Profiler::s_threadBufferMutex);
+            buffer->id = Profiler::s_threadBuffers.size() + 1;
+            buffer->name = hex::format("Thread %u", buffer->id);
+            Profiler::s_threadBuffers.push_back(buffer);
+
+            return buffer;
+        }();
+
+        return *buffer;
+    }
+
+    void Profiler::addScope(std::string_view name, std::string_view category, u64 start, u64 end, const Allocations &allocations) {
+        BookkeepingScope bookkeeping;
+        auto &buffer = Profiler::getThreadBuffer();
+
+        // Only ever contended by the main thread collecting the totals
+        std::scoped_lock lock(buffer.mutex);
+
+        auto it = buffer.totals.find(name);
+        if (it == buffer.totals.end())
+            it = buffer.totals.emplace(std::string(name), Totals()).first;
+
+        it->second.milliseconds += (end - start) / 1'000'000.0;
+        it->second.calls++;
+        it->second.allocations.count += allocations.count;
+        it->second.allocations.bytes += allocations.bytes;
+
+        if (!Profiler::s_recording.load(std::memory_order_relaxed) || Profiler::s_traceEventCount.fetch_add(1, std::memory_order_relaxed) >= MaxTraceEvents)
+            return;
+
+        const u64 recordingStart = Profiler::s_recordingStart.load(std::memory_order_relaxed);
+        if (start < recordingStart)
+            return;
+
+        buffer.events.push_back({ buffer.getStringId(name), buffer.getStringId(category), start - recordingStart, end - start });
+    }
+
+    void Profiler::endFrame() {
+        if (!Profiler::isEnabled())
+            return;
+
+        BookkeepingScope bookkeeping;
+
+        std::map<std::string, Totals, std::less<>> totals;
+        {
+            std::scoped_lock lock(Profiler::s_threadBufferMutex);
+
+            for (auto &buffer : Profiler::s_threadBuffers) {
+                std::scoped_lock bufferLock(buffer->mutex);
+
+                for (auto &[name, bufferTotals] : buffer->totals) {
+                    auto &total = totals[name];
+                    total.milliseconds += bufferTotals.milliseconds;
+                    total.calls += bufferTotals.calls;
+                    total.allocations.count += bufferTotals.allocations.count;
+                    total.allocations.bytes += bufferTotals.allocations.bytes;
+                }
+
+                buffer->totals.clear();
+            }
+        }
+
+        for (const auto &[name, total] : totals)
+            Profiler::s_statistics.try_emplace(name);
+
+        // Scopes that didn't run this frame still get an entry, so the history of all of them covers the same frames
+        for (auto &[name, statistics] : Profiler::s_statistics) {
+            auto total = totals.find(name);
+
+            statistics.milliseconds.push(total != totals.end() ? total->second.milliseconds : 0);
+            statistics.calls.push(total != totals.end() ? total->second.calls : 0);
+            statistics.allocations.push(total != totals.end() ? total->second.allocations.count : 0);
+            statistics.allocatedBytes.push(total != totals.end() ? total->second.allocations.bytes : 0);
+        }
+
+        auto &reads = Profiler::s_readStatistics;
+        reads.count.push(Profiler::s_readCount.exchange(0, std::memory_order_relaxed));
+        reads.bytes.push(Profiler::s_readBytes.exchange(0, std::memory_order_relaxed));
+        reads.mainThreadCount.push(Profiler::s_mainThreadReadCount.exchange(0, std::memory_order_relaxed));
+        reads.mainThreadBytes.push(Profiler::s_mainThreadReadBytes.exchange(0, std::memory_order_relaxed));
+
+        auto &allocations = Profiler::s_allocationStatistics;
+        allocations.count.push(Profiler::s_allocationCount.exchange(0, std::memory_order_relaxed));
+        allocations.bytes.push(Profiler::s_allocationBytes.exchange(0, std::memory_order_relaxed));
+        allocations.mainThreadCount.push(Profiler::s_mainThreadAllocationCount.exchange(0, std::memory_order_relaxed));
+        allocations.mainThreadBytes.push(Profiler::s_mainThreadAllocationBytes.exchange(0, std::memory_order_relaxed));
+    }
+
+    void Profiler::addRead(size_t size) {
+        if (!Profiler::isEnabled())
+            return;
+
+        Profiler::s_readCount.fetch_add(1, std::memory_order_relaxed);
+        Profiler::s_readBytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (std::this_thread::get_id() == Profiler::s_mainThread) {
+            Profiler::s_mainThreadReadCount.fetch_add(1, std::memory_order_relaxed);
+            Profiler::s_mainThreadReadBytes.fetch_add(size, std::memory_order_relaxed);
+        }
+    }
+
+    void Profiler::addAllocation(size_t size) {
+        if (Profiler::s_inBookkeeping)
+            return;
+
+        Profiler::s_threadAllocations.count++;
+        Profiler::s_threadAllocations.bytes += size;
+
+        if (!Profiler::isEnabled())
+            return;
+
+        Profiler::s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        Profiler::s_allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (std::this_thread::get_id() == Profiler::s_mainThread) {
+            Profiler::s_mainThreadAllocationCount.fetch_add(1, std::memory_order_relaxed);
+            Profiler::s_mainThreadAllocationBytes.fetch_add(size, std::memory_order_relaxed);
+        }
+    }
+
+    Profiler::Allocations Profiler::getThreadAllocations() {
+        return Profiler::s_threadAllocations;
+    }
+
+    const std::map<std::string, Profiler::Statistics, std::less<>>& Profiler::getStatistics() {
+        return Profiler::s_statistics;
+    }
+
+    const Profiler::ReadStatistics& Profiler::getReadStatistics() {
+        return Profiler::s_readStatistics;
+    }
+
+    const Profiler::ReadStatistics& Profiler::getAllocationStatistics() {
+        return Profiler::s_allocationStatistics;
+    }
+
+    void Profiler::clear() {
+        Profiler::s_statistics.clear();
+        Profiler::s_readStatistics = { };
+        Profiler::s_allocationStatistics = { };
+    }
+
+
+    void Profiler::startRecording() {
+        {
+            std::scoped_lock lock(Profiler::s_threadBufferMutex);
+
+            for (auto &buffer : Profiler::s_threadBuffers) {
+                std::scoped_lock bufferLock(buffer->mutex);
+                buffer->events.clear();
+                buffer->strings.clear();
+                buffer->stringIds.clear();
+            }
+        }
+
+        Profiler::s_traceEventCount = 0;
+        Profiler::s_recordingStart = Profiler::getTime();
+        Profiler::s_recording = true;
+    }
+
+    void Profiler::stopRecording() {
+        Profiler::s_recording = false;
+    }
+
+    bool Profiler::isRecording() {
+        return Profiler::s_recording;
+    }
+
+    size_t Profiler::getTraceEventCount() {
+        return std::min(Profiler::s_traceEventCount.load(), MaxTraceEvents);
+    }
+
+    static std::string escapeJSON(std::string_view string) {
+        std::string escaped;
+
+        for (char c : string) {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+
+            if (static_cast<u8>(c) >= 0x20)
+                escaped += c;
+        }
+
+        return escaped;
+    }
+
+    bool Profiler::exportTrace(const std::string &path) {
+        FILE *file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+
+        bool first = true;
+        std::scoped_lock lock(Profiler::s_threadBufferMutex);
+        for (auto &buffer : Profiler::s_threadBuffers) {
+            std::scoped_lock bufferLock(buffer->mutex);
+
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", buffer->id, escapeJSON(buffer->name).c_str());
+            first = false;
+
+            // Strings are escaped once, not for every event using them
+            std::vector<std::string> strings;
+            for (const auto &string : buffer->strings)
+                strings.push_back(escapeJSON(string));
+
+            for (const auto &[name, category, start, duration] : buffer->events) {
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                        strings[name].c_str(), strings[category].c_str(), buffer->id, start / 1000.0, duration / 1000.0);
+            }
+        }
+
+        fputs("\n]}\n", file);
+
+        const bool succeeded = ferror(file) == 0;
+        fclose(file);
+
+        return succeeded;
+    }
+
+}
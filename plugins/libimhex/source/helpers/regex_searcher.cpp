@@ -0,0 +1,519 @@
+#include <hex/helpers/regex_searcher.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace hex {
+
+    constexpr static size_t MaxNfaStates = 0x1'0000;
+    constexpr static u32 MaxRepetitions = 1000;
+    constexpr static u32 Unbounded = ~u32(0);
+
+    struct RegexSearcher::Node {
+        enum class Type { Bytes, Concat, Alternate, Repeat } type;
+
+        std::bitset<0x100> bytes;
+        std::vector<Node> children;
+        u32 min = 0, max = 0;
+    };
+
+    class RegexSearcher::Parser {
+    public:
+        explicit Parser(std::string_view pattern) : m_pattern(pattern) { }
+
+        Node parse() {
+            auto node = this->parseAlternation();
+
+            if (this->m_position < this->m_pattern.size())
+                throw std::invalid_argument("Mismatching parenthesis!");
+
+            return node;
+        }
+
+    private:
+        std::string_view m_pattern;
+        size_t m_position = 0;
+
+        [[nodiscard]] bool atEnd() const { return this->m_position >= this->m_pattern.size(); }
+        [[nodiscard]] char peek() const { return this->m_pattern[this->m_position]; }
+
+        bool consume(char c) {
+            if (this->atEnd() || this->peek() != c)
+                return false;
+
+            this->m_position++;
+            return true;
+        }
+
+        static Node makeBytes(const std::bitset<0x100> &bytes) {
+            return Node { Node::Type::Bytes, bytes, { } };
+        }
+
+        Node parseAlternation() {
+            Node node = { Node::Type::Alternate };
+            node.children.push_back(this->parseConcatenation());
+
+            while (this->consume('|'))
+                node.children.push_back(this->parseConcatenation());
+
+            return node.children.size() == 1 ? std::move(node.children.front()) : std::move(node);
+        }
+
+        Node parseConcatenation() {
+            Node node = { Node::Type::Concat };
+
+            while (!this->atEnd() && this->peek() != '|' && this->peek() != ')')
+                node.children.push_back(this->parseRepetition());
+
+            return node;
+        }
+
+        Node parseRepetition() {
+            auto node = this->parseAtom();
+
+            while (!this->atEnd()) {
+                u32 min, max;
+
+                if (this->consume('*'))
+                    min = 0, max = Unbounded;
+                else if (this->consume('+'))
+                    min = 1, max = Unbounded;
+                else if (this->consume('?'))
+                    min = 0, max = 1;
+                else if (this->peek() == '{')
+                    std::tie(min, max) = this->parseCount();
+                else
+                    break;
+
+                if (!this->atEnd() && (this->peek() == '?' || this->peek() == '+'))
+                    throw std::invalid_argument("Lazy and possessive quantifiers aren't supported!");
+
+                node = Node { Node::Type::Repeat, { }, { std::move(node) }, min, max };
+            }
+
+            return node;
+        }
+
+        std::pair<u32, u32> parseCount() {
+            this->consume('{');
+
+            auto parseNumber = [this]() -> std::optional<u32> {
+                if (this->atEnd() || !std::isdigit(this->peek()))
+                    return { };
+
+                u32 value = 0;
+                while (!this->atEnd() && std::isdigit(this->peek())) {
+                    value = value * 10 + (this->peek() - '0');
+                    this->m_position++;
+
+                    if (value > MaxRepetitions)
+                        throw std::invalid_argument("Repetition count too large!");
+                }
+
+                return value;
+            };
+
+            auto min = parseNumber();
+            if (!min.has_value())
+                throw std::invalid_argument("Invalid repetition count!");
+
+            u32 max = *min;
+            if (this->consume(','))
+                max = parseNumber().value_or(Unbounded);
+
+            if (!this->consume('}') || max < *min)
+                throw std::invalid_argument("Invalid repetition count!");
+
+            return { *min, max };
+        }
+
+        Node parseAtom() {
+            if (this->atEnd())
+                throw std::invalid_argument("Unexpected end of pattern!");
+
+            const char c = this->peek();
+            this->m_position++;
+
+            switch (c) {
+                case '(': {
+                    if (this->consume('?') && !this->consume(':'))
+                        throw std::invalid_argument("Unsupported group type!");
+
+                    auto node = this->parseAlternation();
+                    if (!this->consume(')'))
+                        throw std::invalid_argument("Mismatching parenthesis!");
+
+                    return node;
+                }
+                case '[':
+                    return makeBytes(this->parseClass());
+                case '.':
+                    return makeBytes(std::bitset<0x100>().set());
+                case '\\':
+                    return makeBytes(this->parseEscape());
+                case '^':
+                case '$':
+                    throw std::invalid_argument("Anchors aren't supported!");
+                case '*':
+                case '+':
+                case '?':
+                case '{':
+                    throw std::invalid_argument("Nothing to repeat!");
+                default:
+                    return makeBytes(std::bitset<0x100>().set(u8(c)));
+            }
+        }
+
+        std::bitset<0x100> parseClass() {
+            std::bitset<0x100> bytes;
+            const bool negated = this->consume('^');
+
+            bool first = true;
+            while (!this->atEnd() && (this->peek() != ']' || first)) {
+                first = false;
+
+                auto low = this->parseClassMember();
+                if (low.count() == 1 && this->m_position + 1 < this->m_pattern.size() && this->peek() == '-' && this->m_pattern[this->m_position + 1] != ']') {
+                    this->m_position++;
+
+                    auto high = this->parseClassMember();
+                    if (high.count() != 1)
+                        throw std::invalid_argument("Invalid character range!");
+
+                    u32 from = 0, to = 0;
+                    while (!low[from]) from++;
+                    while (!high[to]) to++;
+
+                    if (from > to)
+                        throw std::invalid_argument("Invalid character range!");
+
+                    for (u32 i = from; i <= to; i++)
+                        bytes.set(i);
+                } else {
+                    bytes |= low;
+                }
+            }
+
+            if (!this->consume(']'))
+                throw std::invalid_argument("Unterminated character class!");
+
+            return negated ? ~bytes : bytes;
+        }
+
+        std::bitset<0x100> parseClassMember() {
+            const char c = this->peek();
+            this->m_position++;
+
+            if (c == '\\')
+                return this->parseEscape();
+            else
+                return std::bitset<0x100>().set(u8(c));
+        }
+
+        std::bitset<0x100> parseEscape() {
+            if (this->atEnd())
+                throw std::invalid_argument("Unterminated escape sequence!");
+
+            const char c = this->peek();
+            this->m_position++;
+
+            auto range = [](u8 from, u8 to) {
+                std::bitset<0x100> bytes;
+                for (u32 i = from; i <= to; i++)
+                    bytes.set(i);
+                return bytes;
+            };
+
+            auto digits = range('0', '9');
+            auto word   = range('a', 'z') | range('A', 'Z') | digits | std::bitset<0x100>().set('_');
+            auto spaces = std::bitset<0x100>().set(' ').set('\t').set('\n').set('\r').set('\f').set('\v');
+
+            switch (c) {
+                case 'd': return digits;
+                case 'D': return ~digits;
+                case 'w': return word;
+                case 'W': return ~word;
+                case 's': return spaces;
+                case 'S': return ~spaces;
+                case 'n': return std::bitset<0x100>().set('\n');
+                case 'r': return std::bitset<0x100>().set('\r');
+                case 't': return std::bitset<0x100>().set('\t');
+                case 'f': return std::bitset<0x100>().set('\f');
+                case 'v': return std::bitset<0x100>().set('\v');
+                case 'a': return std::bitset<0x100>().set('\a');
+                case 'e': return std::bitset<0x100>().set(0x1B);
+                case '0': return std::bitset<0x100>().set(0x00);
+                case 'x': {
+                    if (this->m_position + 2 > this->m_pattern.size() || !std::isxdigit(this->m_pattern[this->m_position]) || !std::isxdigit(this->m_pattern[this->m_position + 1]))
+                        throw std::invalid_argument("Invalid hex escape sequence!");
+
+                    auto value = std::stoul(std::string(this->m_pattern.substr(this->m_position, 2)), nullptr, 16);
+                    this->m_position += 2;
+
+                    return std::bitset<0x100>().set(value);
+                }
+                default:
+                    if (std::isalnum(c))
+                        throw std::invalid_argument("Unknown escape sequence!");
+
+                    return std::bitset<0x100>().set(u8(c));
+            }
+        }
+    };
+
+
+    u32 RegexSearcher::compile(const Node &node, u32 next, bool reverse, Nfa &nfa) {
+        auto addState = [&nfa](NfaState state) {
+            if (nfa.size() >= MaxNfaStates)
+                throw std::invalid_argument("Pattern is too complex!");
+
+            nfa.push_back(state);
+            return u32(nfa.size() - 1);
+        };
+
+        switch (node.type) {
+            case Node::Type::Bytes:
+                return addState({ NfaState::Type::Bytes, next, 0, node.bytes });
+            case Node::Type::Concat:
+                // States are built from the end of the pattern towards its start, reversed patterns simply get built the other way around
+                if (reverse) {
+                    for (const auto &child : node.children)
+                        next = compile(child, next, reverse, nfa);
+                } else {
+                    for (auto it = node.children.rbegin(); it != node.children.rend(); it++)
+                        next = compile(*it, next, reverse, nfa);
+                }
+
+                return next;
+            case Node::Type::Alternate: {
+                u32 entry = compile(node.children.back(), next, reverse, nfa);
+                for (auto it = node.children.rbegin() + 1; it != node.children.rend(); it++)
+                    entry = addState({ NfaState::Type::Split, compile(*it, next, reverse, nfa), entry });
+
+                return entry;
+            }
+            case Node::Type::Repeat: {
+                const auto &child = node.children.front();
+                u32 entry = next;
+
+                if (node.max == Unbounded) {
+                    u32 loop = addState({ NfaState::Type::Split, 0, next });
+                    nfa[loop].next = compile(child, loop, reverse, nfa);
+                    entry = loop;
+                } else {
+                    for (u32 i = node.min; i < node.max; i++)
+                        entry = addState({ NfaState::Type::Split, compile(child, entry, reverse, nfa), next });
+                }
+
+                for (u32 i = 0; i < node.min; i++)
+                    entry = compile(child, entry, reverse, nfa);
+
+                return entry;
+            }
+        }
+
+        return next;
+    }
+
+    RegexSearcher::RegexSearcher(std::string_view pattern) {
+        auto root = Parser(pattern).parse();
+
+        auto forward = std::make_shared<Nfa>();
+        forward->push_back({ NfaState::Type::Match });
+        u32 forwardStart = compile(root, 0, false, *forward);
+
+        auto reverse = std::make_shared<Nfa>();
+        reverse->push_back({ NfaState::Type::Match });
+        u32 reverseStart = compile(root, 0, true, *reverse);
+
+        this->m_search  = LazyDfa(forward, forwardStart, true);
+        this->m_extend  = LazyDfa(forward, forwardStart, false);
+        this->m_reverse = LazyDfa(reverse, reverseStart, false);
+    }
+
+    bool RegexSearcher::findAll(u64 size, const ReadFunction &read, const Callback &callback) {
+        std::vector<u8> buffer(0x10'0000, 0x00);
+        u64 bufferAddress = 0;
+        size_t bufferSize = 0;
+
+        u64 address = 0, lastEnd = 0;
+        u32 state = this->m_search.getInitialState();
+
+        while (address < size) {
+            if (address < bufferAddress || address >= bufferAddress + bufferSize) {
+                bufferAddress = address;
+                bufferSize = std::min<u64>(buffer.size(), size - address);
+
+                if (!read(bufferAddress, buffer.data(), bufferSize))
+                    return false;
+            }
+
+            bool found = false;
+            size_t i = address - bufferAddress;
+            for (; i < bufferSize; i++) {
+                state = this->m_search.step(state, buffer[i]);
+
+                if (this->m_search.isAccepting(state)) [[unlikely]] {
+                    found = true;
+                    i++;
+                    break;
+                }
+            }
+
+            address = bufferAddress + i;
+            if (!found)
+                continue;
+
+            auto start = this->findStart(lastEnd, address, read);
+            if (!start.has_value())
+                return false;
+
+            auto end = this->extendMatch(*start, address, size, read);
+            if (!end.has_value())
+                return false;
+
+            callback(*start, *end);
+
+            lastEnd = address = *end;
+            state = this->m_search.getInitialState();
+        }
+
+        return true;
+    }
+
+    std::optional<u64> RegexSearcher::findStart(u64 lowerBound, u64 end, const ReadFunction &read) {
+        std::array<u8, 0x1000> buffer = { 0 };
+
+        u64 start = end;
+        u32 state = this->m_reverse.getInitialState();
+        for (u64 blockEnd = end; blockEnd > lowerBound && !this->m_reverse.isDead(state); ) {
+            const u64 blockStart = std::max<u64>(lowerBound, blockEnd - std::min<u64>(blockEnd, buffer.size()));
+            if (!read(blockStart, buffer.data(), blockEnd - blockStart))
+                return { };
+
+            for (u64 address = blockEnd; address > blockStart; address--) {
+                state = this->m_reverse.step(state, buffer[address - 1 - blockStart]);
+
+                if (this->m_reverse.isDead(state))
+                    break;
+                if (this->m_reverse.isAccepting(state))
+                    start = address - 1;
+            }
+
+            blockEnd = blockStart;
+        }
+
+        return start;
+    }
+
+    std::optional<u64> RegexSearcher::extendMatch(u64 start, u64 end, u64 size, const ReadFunction &read) {
+        std::array<u8, 0x1000> buffer = { 0 };
+
+        const u64 limit = std::min(size, std::max<u64>(end, start + MaxMatchSize));
+        u32 state = this->m_extend.getInitialState();
+        for (u64 blockStart = start; blockStart < limit && !this->m_extend.isDead(state); ) {
+            const u64 blockEnd = std::min<u64>(limit, blockStart + buffer.size());
+            if (!read(blockStart, buffer.data(), blockEnd - blockStart))
+                return { };
+
+            for (u64 address = blockStart; address < blockEnd; address++) {
+                state = this->m_extend.step(state, buffer[address - blockStart]);
+
+                if (this->m_extend.isDead(state))
+                    break;
+                if (this->m_extend.isAccepting(state))
+                    end = std::max(end, address + 1);
+            }
+
+            blockStart = blockEnd;
+        }
+
+        return end;
+    }
+
+
+    RegexSearcher::LazyDfa::LazyDfa(std::shared_ptr<const Nfa> nfa, u32 start, bool unanchored) : m_nfa(std::move(nfa)), m_unanchored(unanchored) {
+        this->m_visited.resize(this->m_nfa->size(), 0);
+        this->m_visitGeneration++;
+        this->addClosure(start, this->m_startSet);
+        std::sort(this->m_startSet.begin(), this->m_startSet.end());
+    }
+
+    u32 RegexSearcher::LazyDfa::getInitialState() {
+        // Unanchored searches add the start states before every step, so they start out with no states at all
+        return this->addState(this->m_unanchored ? std::vector<u32>{ } : std::vector<u32>(this->m_startSet));
+    }
+
+    u32 RegexSearcher::LazyDfa::computeTransition(u32 state, u8 byte) {
+        auto source = this->m_sets[state];
+        if (this->m_unanchored)
+            source.insert(source.end(), this->m_startSet.begin(), this->m_startSet.end());
+
+        std::vector<u32> target;
+        this->m_visitGeneration++;
+        for (u32 nfaState : source) {
+            const auto &current = (*this->m_nfa)[nfaState];
+
+            if (current.type == NfaState::Type::Bytes && current.bytes[byte])
+                this->addClosure(current.next, target);
+        }
+
+        std::sort(target.begin(), target.end());
+
+        // If adding the new state flushed the cache, the old state's id doesn't refer to anything anymore
+        const u32 flushCount = this->m_flushCount;
+        u32 next = this->addState(std::move(target));
+        if (flushCount == this->m_flushCount)
+            this->m_transitions[state * 0x100 + byte] = next;
+
+        return next;
+    }
+
+    u32 RegexSearcher::LazyDfa::addState(std::vector<u32> &&set) {
+        if (auto it = this->m_stateLookup.find(set); it != this->m_stateLookup.end())
+            return it->second;
+
+        // Rather than growing forever, all states get thrown away and rebuilt on demand once too many of them are cached
+        if (this->m_sets.size() >= MaxCachedStates) {
+            this->m_stateLookup.clear();
+            this->m_sets.clear();
+            this->m_transitions.clear();
+            this->m_flushCount++;
+        }
+
+        const bool accepting = std::any_of(set.begin(), set.end(), [this](u32 nfaState) { return (*this->m_nfa)[nfaState].type == NfaState::Type::Match; });
+
+        u32 id = this->m_sets.size() | (accepting ? AcceptingFlag : 0);
+        this->m_stateLookup.emplace(set, id);
+        this->m_sets.push_back(std::move(set));
+        this->m_transitions.resize(this->m_transitions.size() + 0x100, UnknownState);
+
+        return id;
+    }
+
+    void RegexSearcher::LazyDfa::addClosure(u32 nfaState, std::vector<u32> &set) {
+        std::vector<u32> stack = { nfaState };
+
+        while (!stack.empty()) {
+            u32 current = stack.back();
+            stack.pop_back();
+
+            if (this->m_visited[current] == this->m_visitGeneration)
+                continue;
+            this->m_visited[current] = this->m_visitGeneration;
+
+            const auto &state = (*this->m_nfa)[current];
+            if (state.type == NfaState::Type::Split) {
+                stack.push_back(state.alternative);
+                stack.push_back(state.next);
+            } else {
+                set.push_back(current);
+            }
+        }
+    }
+
+}
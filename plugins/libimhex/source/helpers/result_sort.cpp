@@ -0,0 +1,226 @@
+#include <hex/helpers/result_sort.hpp>
+
+#include <hex/api/task.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+
+namespace hex {
+
+    // Handing out chunks costs more than sorting small tables takes
+    constexpr static size_t MinRowsPerThread = 0x10000;
+    // Runs of rows get compared instead once they're this small
+    constexpr static size_t MaxComparedRun = 32;
+
+    // Sorts run on whatever thread needs them, chunks are spread over the workers of the task that thread works on. They're never cancelled as half a sort is no use
+    static Task createSortTask() {
+        const auto currentTask = TaskManager::getCurrentTask();
+
+        return Task("Sorting", currentTask != nullptr ? currentTask->getPriority() : TaskPriority::Interactive);
+    }
+
+    template<typename Function>
+    static void forEachChunk(Task &task, size_t count, size_t chunkCount, const Function &function) {
+        const size_t rowsPerChunk = (count + chunkCount - 1) / chunkCount;
+
+        if (chunkCount == 1) {
+            function(0, 0, count);
+            return;
+        }
+
+        TaskManager::parallelFor(task, chunkCount, [&](size_t chunk) {
+            function(chunk, std::min(chunk * rowsPerChunk, count), std::min((chunk + 1) * rowsPerChunk, count));
+        });
+    }
+
+    using Counts = std::array<size_t, 0x100>;
+
+    // Turns the counts of every chunk into where its first row with each byte goes. Rows with the same byte are laid out in chunk order,
+    // which is what keeps the sort stable
+    static void getPositions(std::vector<Counts> &counts) {
+        size_t position = 0;
+        for (size_t value = 0; value < 0x100; value++) {
+            for (auto &chunkCounts : counts) {
+                const size_t count = chunkCounts[value];
+                chunkCounts[value] = position;
+                position += count;
+            }
+        }
+    }
+
+    // Sorts the indices along with their keys, one byte per pass. How often each byte occurs overall doesn't depend on the order of the rows,
+    // so they're all counted in a single pass up front. Passes over bytes that are the same in every key are skipped.
+    // With several threads every thread scatters its own chunk of the rows, which needs the counts of that chunk in its current order
+    static void radixSort(Task &task, std::vector<u64> &keys, std::vector<u32> &order) {
+        if (keys.size() < 2)
+            return;
+
+        const size_t chunkCount = TaskManager::getParallelism(task, keys.size() / MinRowsPerThread);
+
+        std::vector<std::array<Counts, sizeof(u64)>> chunkHistograms(chunkCount);
+        forEachChunk(task, keys.size(), chunkCount, [&](size_t chunk, size_t from, size_t to) {
+            auto &histograms = chunkHistograms[chunk];
+            for (auto &counts : histograms)
+                counts.fill(0);
+
+            for (size_t i = from; i < to; i++) {
+                for (size_t byte = 0; byte < sizeof(u64); byte++)
+                    histograms[byte][(keys[i] >> (byte * 8)) & 0xFF]++;
+            }
+        });
+
+        std::array<Counts, sizeof(u64)> histograms = { };
+        for (const auto &chunkHistogram : chunkHistograms) {
+            for (size_t byte = 0; byte < sizeof(u64); byte++) {
+                for (size_t value = 0; value < 0x100; value++)
+                    histograms[byte][value] += chunkHistogram[byte][value];
+            }
+        }
+
+        std::vector<u64> sortedKeys(keys.size());
+        std::vector<u32> sortedOrder(order.size());
+        std::vector<Counts> positions(chunkCount);
+
+        for (size_t byte = 0; byte < sizeof(u64); byte++) {
+            const u32 shift = byte * 8;
+
+            if (std::find(histograms[byte].begin(), histograms[byte].end(), keys.size()) != histograms[byte].end())
+                continue;
+
+            const u64 *keyData = keys.data();
+            const u32 *orderData = order.data();
+            u64 *sortedKeyData = sortedKeys.data();
+            u32 *sortedOrderData = sortedOrder.data();
+
+            if (chunkCount == 1) {
+                positions[0] = histograms[byte];
+            } else {
+                forEachChunk(task, keys.size(), chunkCount, [&](size_t chunk, size_t from, size_t to) {
+                    auto &counts = positions[chunk];
+                    counts.fill(0);
+
+                    for (size_t i = from; i < to; i++)
+                        counts[(keyData[i] >> shift) & 0xFF]++;
+                });
+            }
+
+            getPositions(positions);
+
+            forEachChunk(task, keys.size(), chunkCount, [&](size_t chunk, size_t from, size_t to) {
+                auto &chunkPositions = positions[chunk];
+
+                for (size_t i = from; i < to; i++) {
+                    const size_t position = chunkPositions[(keyData[i] >> shift) & 0xFF]++;
+                    sortedKeyData[position] = keyData[i];
+                    sortedOrderData[position] = orderData[i];
+                }
+            });
+
+            std::swap(keys, sortedKeys);
+            std::swap(order, sortedOrder);
+        }
+    }
+
+    std::vector<u32> ResultSort::byNumber(std::span<const u64> keys, bool descending) {
+        std::vector<u32> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        // Members of structs get sorted one struct at a time, counting bytes isn't worth it for that few rows
+        if (keys.size() <= MaxComparedRun) {
+            std::stable_sort(order.begin(), order.end(), [&](u32 left, u32 right) {
+                return descending ? keys[left] > keys[right] : keys[left] < keys[right];
+            });
+
+            return order;
+        }
+
+        // Inverting the keys sorts them the other way around without giving up stability
+        std::vector<u64> sortKeys(keys.begin(), keys.end());
+        if (descending) {
+            for (auto &key : sortKeys)
+                key = ~key;
+        }
+
+        Task task = createSortTask();
+        radixSort(task, sortKeys, order);
+
+        return order;
+    }
+
+    // Eight bytes of the string starting at the given depth, the first one being the most significant. Missing bytes are zero
+    static u64 getPrefix(std::string_view string, size_t depth) {
+        u8 bytes[8] = { };
+        if (depth < string.size())
+            std::memcpy(bytes, string.data() + depth, std::min<size_t>(8, string.size() - depth));
+
+        u64 prefix = 0;
+        for (u8 byte : bytes)
+            prefix = (prefix << 8) | byte;
+
+        return prefix;
+    }
+
+    std::vector<u32> ResultSort::byString(std::span<const std::string_view> keys, bool descending) {
+        std::vector<u32> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        struct Run {
+            size_t begin, end;
+            size_t depth;
+        };
+
+        Task task = createSortTask();
+
+        std::vector<Run> runs = { { 0, order.size(), 0 } };
+        std::vector<u64> prefixes;
+        std::vector<u32> runOrder;
+
+        // Runs only ever get split into smaller ones that are further into their strings, so there's no need to recurse
+        while (!runs.empty()) {
+            const auto [begin, end, depth] = runs.back();
+            runs.pop_back();
+
+            const auto first = order.begin() + begin, last = order.begin() + end;
+            const bool anyLonger = std::any_of(first, last, [&](u32 index) { return keys[index].size() > depth; });
+
+            // Strings of a run are the same up to the depth once padded with zeros, of two that are the same past it as well the shorter one comes first
+            if (size_t(last - first) <= MaxComparedRun || !anyLonger) {
+                std::stable_sort(first, last, [&](u32 left, u32 right) {
+                    const auto &leftKey = keys[left], &rightKey = keys[right];
+
+                    int result = leftKey.substr(std::min(depth, leftKey.size())).compare(rightKey.substr(std::min(depth, rightKey.size())));
+                    if (result == 0)
+                        result = leftKey.size() < rightKey.size() ? -1 : (leftKey.size() > rightKey.size() ? 1 : 0);
+
+                    return descending ? result > 0 : result < 0;
+                });
+
+                continue;
+            }
+
+            prefixes.clear();
+            for (auto it = first; it != last; it++)
+                prefixes.push_back(descending ? ~getPrefix(keys[*it], depth) : getPrefix(keys[*it], depth));
+
+            runOrder.assign(first, last);
+            radixSort(task, prefixes, runOrder);
+            std::copy(runOrder.begin(), runOrder.end(), first);
+
+            for (size_t runBegin = 0; runBegin < prefixes.size();) {
+                size_t runEnd = runBegin + 1;
+                while (runEnd < prefixes.size() && prefixes[runEnd] == prefixes[runBegin])
+                    runEnd++;
+
+                if (runEnd - runBegin > 1)
+                    runs.push_back({ begin + runBegin, begin + runEnd, depth + 8 });
+
+                runBegin = runEnd;
+            }
+        }
+
+        return order;
+    }
+
+}
@@ -2,11 +2,13 @@
 
 namespace hex {
 
-    std::vector<EventHandler> SharedData::eventHandlers;
+    std::map<Events, std::vector<EventHandler>> SharedData::eventHandlers;
     std::vector<std::function<void()>> SharedData::deferredCalls;
     prv::Provider *SharedData::currentProvider;
+    std::vector<prv::Provider*> SharedData::providers;
     std::map<std::string, std::vector<ContentRegistry::Settings::Entry>> SharedData::settingsEntries;
     nlohmann::json SharedData::settingsJson;
+    std::optional<std::chrono::steady_clock::time_point> SharedData::settingsChangeTime;
     std::map<std::string, Events> SharedData::customEvents;
     u32 SharedData::customEventsLastId;
     std::vector<ContentRegistry::CommandPaletteCommands::Entry> SharedData::commandPaletteCommands;
@@ -14,9 +16,8 @@ namespace hex {
     std::vector<View*> SharedData::views;
     std::vector<ContentRegistry::Tools::Entry> SharedData::toolsEntries;
     std::vector<ContentRegistry::DataInspector::Entry> SharedData::dataInspectorEntries;
-    u32 SharedData::patternPaletteOffset;
     std::string SharedData::errorPopupMessage;
-    std::list<ImHexApi::Bookmarks::Entry> SharedData::bookmarkEntries;
+    BookmarkStore SharedData::bookmarkEntries;
 
     imgui_addons::ImGuiFileBrowser SharedData::fileBrowser;
     imgui_addons::ImGuiFileBrowser::DialogMode SharedData::fileBrowserDialogMode;
@@ -27,11 +28,23 @@ namespace hex {
     std::vector<ContentRegistry::DataProcessorNode::Entry> SharedData::dataProcessorNodes;
     u32 SharedData::dataProcessorNodeIdCounter = 1;
 
+    std::vector<ContentRegistry::Providers::Entry> SharedData::providerEntries;
+
     int SharedData::mainArgc;
     char **SharedData::mainArgv;
 
     ImVec2 SharedData::windowPos;
     ImVec2 SharedData::windowSize;
 
-    std::map<std::string, std::any> SharedData::sharedVariables;
+    std::atomic<bool> SharedData::redrawRequested = false;
+    std::function<void()> SharedData::wakeUpMainLoop;
+
+    std::map<std::string, SharedData::Variable> SharedData::sharedVariables;
+    std::mutex SharedData::sharedVariablesMutex;
+
+    u32& SharedData::getPatternPaletteOffset() {
+        static thread_local u32 paletteOffset = 0;
+
+        return paletteOffset;
+    }
 }
\ No newline at end of file
@@ -1,9 +1,18 @@
 #include <hex/helpers/utils.hpp>
 
+#include <algorithm>
 #include <cstdio>
 #include <codecvt>
 #include <locale>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+    #define UTILS_X86
+    #include <immintrin.h>
+#elif defined(__aarch64__)
+    #define UTILS_NEON
+    #include <arm_neon.h>
+#endif
+
 namespace hex {
 
     std::string to_string(u128 value) {
@@ -155,6 +164,181 @@ namespace hex {
         return result;
     }
 
+    constexpr static char HexDigits[] = "0123456789ABCDEF";
+
+    constexpr static auto HexDigitPairs = [] {
+        std::array<std::array<char, 2>, 256> pairs = { };
+        for (size_t i = 0; i < pairs.size(); i++)
+            pairs[i] = { HexDigits[i >> 4], HexDigits[i & 0xF] };
+
+        return pairs;
+    }();
+
+    void appendHexBytes(std::string &result, std::span<const u8> bytes, std::string_view prefix, std::string_view separator) {
+        if (bytes.empty())
+            return;
+
+        const size_t start = result.size();
+        result.resize(start + bytes.size() * (prefix.size() + 2 + separator.size()) - separator.size());
+
+        char *out = result.data() + start;
+        for (size_t i = 0; i < bytes.size(); i++) {
+            if (i != 0) {
+                std::memcpy(out, separator.data(), separator.size());
+                out += separator.size();
+            }
+
+            std::memcpy(out, prefix.data(), prefix.size());
+            std::memcpy(out + prefix.size(), HexDigitPairs[bytes[i]].data(), 2);
+            out += prefix.size() + 2;
+        }
+    }
+
+    void appendHexNumber(std::string &result, u64 value, u8 minDigits) {
+        u8 digits = 1;
+        while (digits < 16 && (value >> (digits * 4)) != 0)
+            digits++;
+        digits = std::max(digits, minDigits);
+
+        const size_t start = result.size();
+        result.resize(start + digits);
+
+        for (size_t i = result.size(); i > start; i--, value >>= 4)
+            result[i - 1] = HexDigits[value & 0xF];
+    }
+
+    /*
+     * The byte swap kernels process size bytes, rounded down to whole vectors, and return how many bytes they processed.
+     */
+
+    #if defined(UTILS_X86)
+
+    // SSE2 has no byte shuffle, swapping the 16 bit words first leaves only the bytes within each word to swap
+    template<size_t ElementSize>
+    static size_t swapBytesKernelSSE2(u8 *data, size_t size) {
+        size_t offset = 0;
+
+        for (; offset + sizeof(__m128i) <= size; offset += sizeof(__m128i)) {
+            auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+
+            if constexpr (ElementSize == 4)
+                value = _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, 0xB1), 0xB1);
+            else if constexpr (ElementSize == 8)
+                value = _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, 0x1B), 0x1B);
+            else if constexpr (ElementSize == 16)
+                value = _mm_shuffle_epi32(_mm_shufflehi_epi16(_mm_shufflelo_epi16(value, 0x1B), 0x1B), 0x4E);
+
+            value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + offset), value);
+        }
+
+        return offset;
+    }
+
+    // Index of the byte every byte of a vector gets moved to, reversing each element
+    template<size_t ElementSize, size_t VectorSize>
+    static void getSwapIndices(u8 (&indices)[VectorSize]) {
+        for (size_t i = 0; i < VectorSize; i++)
+            indices[i] = (i % 16) - (i % ElementSize) + (ElementSize - 1 - i % ElementSize);
+    }
+
+    template<size_t ElementSize>
+    __attribute__((target("ssse3"))) static size_t swapBytesKernelSSSE3(u8 *data, size_t size) {
+        size_t offset = 0;
+
+        u8 indices[sizeof(__m128i)];
+        getSwapIndices<ElementSize>(indices);
+        const auto shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices));
+
+        for (; offset + sizeof(__m128i) <= size; offset += sizeof(__m128i)) {
+            auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + offset), _mm_shuffle_epi8(value, shuffle));
+        }
+
+        return offset;
+    }
+
+    // The AVX2 shuffle only moves bytes within each 128 bit half, which is fine as no element crosses them
+    template<size_t ElementSize>
+    __attribute__((target("avx2"))) static size_t swapBytesKernelAVX2(u8 *data, size_t size) {
+        size_t offset = 0;
+
+        u8 indices[sizeof(__m256i)];
+        getSwapIndices<ElementSize>(indices);
+        const auto shuffle = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices));
+
+        for (; offset + sizeof(__m256i) <= size; offset += sizeof(__m256i)) {
+            auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + offset), _mm256_shuffle_epi8(value, shuffle));
+        }
+
+        return offset;
+    }
+
+    template<size_t ElementSize>
+    static size_t swapBytesKernel(u8 *data, size_t size) {
+        #if defined(__GNUC__)
+            static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+            static const bool hasSSSE3 = __builtin_cpu_supports("ssse3");
+
+            if (hasAVX2)
+                return swapBytesKernelAVX2<ElementSize>(data, size);
+            else if (hasSSSE3)
+                return swapBytesKernelSSSE3<ElementSize>(data, size);
+        #endif
+
+        return swapBytesKernelSSE2<ElementSize>(data, size);
+    }
+
+    #elif defined(UTILS_NEON)
+
+    template<size_t ElementSize>
+    static size_t swapBytesKernel(u8 *data, size_t size) {
+        size_t offset = 0;
+
+        for (; offset + sizeof(uint8x16_t) <= size; offset += sizeof(uint8x16_t)) {
+            auto value = vld1q_u8(data + offset);
+
+            if constexpr (ElementSize == 2)      value = vrev16q_u8(value);
+            else if constexpr (ElementSize == 4) value = vrev32q_u8(value);
+            else if constexpr (ElementSize == 8) value = vrev64q_u8(value);
+            else                                 value = vextq_u8(vrev64q_u8(value), vrev64q_u8(value), 8);
+
+            vst1q_u8(data + offset, value);
+        }
+
+        return offset;
+    }
+
+    #else
+
+    template<size_t ElementSize>
+    static size_t swapBytesKernel(u8 *data, size_t size) {
+        return 0;
+    }
+
+    #endif
+
+    template<size_t ElementSize>
+    static void swapElementBytes(u8 *data, size_t count) {
+        const size_t size = count * ElementSize;
+
+        for (size_t offset = swapBytesKernel<ElementSize>(data, size); offset < size; offset += ElementSize)
+            std::reverse(data + offset, data + offset + ElementSize);
+    }
+
+    void swapBytes(void *data, size_t count, size_t size) {
+        auto bytes = static_cast<u8*>(data);
+
+        switch (size) {
+            case 2:  swapElementBytes<2>(bytes, count);  break;
+            case 4:  swapElementBytes<4>(bytes, count);  break;
+            case 8:  swapElementBytes<8>(bytes, count);  break;
+            case 16: swapElementBytes<16>(bytes, count); break;
+            default: break;
+        }
+    }
+
     void openWebpage(std::string_view url) {
 
         #if defined(OS_WINDOWS)
@@ -3,23 +3,30 @@
 #include <hex/lang/token.hpp>
 #include <hex/helpers/utils.hpp>
 #include <hex/api/content_registry.hpp>
+#include <hex/api/task.hpp>
 
 #include <bit>
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <exception>
+#include <memory_resource>
 
 #include <unistd.h>
 
 namespace hex::lang {
 
-    ASTNodeIntegerLiteral* Evaluator::evaluateScopeResolution(ASTNodeScopeResolution *node) {
+    Token::IntegerLiteral Evaluator::evaluateScopeResolution(ASTNodeScopeResolution *node) {
         ASTNode *currScope = nullptr;
         for (const auto &identifier : node->getPath()) {
             if (currScope == nullptr) {
-                if (!this->m_types.contains(identifier))
+                auto type = this->m_types.find(identifier);
+                if (type == this->m_types.end())
                     break;
 
-                currScope = this->m_types[identifier.data()];
-            } else if (auto enumNode = dynamic_cast<ASTNodeEnum*>(currScope); enumNode != nullptr) {
+                currScope = type->second;
+            } else if (auto enumNode = nodeCast<ASTNodeEnum>(currScope); enumNode != nullptr) {
                 if (!enumNode->getEntries().contains(identifier))
                     break;
                 else
@@ -31,35 +38,35 @@ namespace hex::lang {
     }
 
     PatternData* Evaluator::patternFromName(const std::vector<std::string> &path) {
-        std::vector<PatternData*> currMembers;
-
-        if (!this->m_currMembers.empty())
-            std::copy(this->m_currMembers.back()->begin(), this->m_currMembers.back()->end(), std::back_inserter(currMembers));
-        if (!this->m_globalMembers.empty())
-            std::copy(this->m_globalMembers.begin(), this->m_globalMembers.end(), std::back_inserter(currMembers));
-
         PatternData *currPattern = nullptr;
         for (u32 i = 0; i < path.size(); i++) {
             const auto &identifier = path[i];
 
-            if (auto structPattern = dynamic_cast<PatternDataStruct*>(currPattern); structPattern != nullptr)
-                currMembers = structPattern->getMembers();
+            PatternData *candidate = nullptr;
+            if (currPattern == nullptr) {
+                if (!this->m_currMemberLookup.empty()) {
+                    if (auto member = this->m_currMemberLookup.back().find(identifier); member != this->m_currMemberLookup.back().end())
+                        candidate = member->second;
+                }
+                if (candidate == nullptr) {
+                    if (auto member = this->m_globalMemberLookup.find(identifier); member != this->m_globalMemberLookup.end())
+                        candidate = member->second;
+                }
+            }
+            else if (auto structPattern = dynamic_cast<PatternDataStruct*>(currPattern); structPattern != nullptr)
+                candidate = structPattern->getMember(identifier);
             else if (auto unionPattern = dynamic_cast<PatternDataUnion*>(currPattern); unionPattern != nullptr)
-                currMembers = unionPattern->getMembers();
+                candidate = unionPattern->getMember(identifier);
             else if (auto pointerPattern = dynamic_cast<PatternDataPointer*>(currPattern); pointerPattern != nullptr) {
                 currPattern = pointerPattern->getPointedAtPattern();
                 i--;
                 continue;
             }
-            else if (currPattern != nullptr)
+            else
                 this->getConsole().abortEvaluation("tried to access member of a non-struct/union type");
 
-            auto candidate = std::find_if(currMembers.begin(), currMembers.end(), [&](auto member) {
-                return member->getVariableName() == identifier;
-            });
-
-            if (candidate != currMembers.end())
-                currPattern = *candidate;
+            if (candidate != nullptr)
+                currPattern = candidate;
             else
                 this->getConsole().abortEvaluation(hex::format("could not find identifier '%s'", identifier.c_str()));
         }
@@ -70,49 +77,49 @@ namespace hex::lang {
         return currPattern;
     }
 
-    ASTNodeIntegerLiteral* Evaluator::evaluateRValue(ASTNodeRValue *node) {
+    Token::IntegerLiteral Evaluator::evaluateRValue(ASTNodeRValue *node) {
         if (this->m_currMembers.empty() && this->m_globalMembers.empty())
             this->getConsole().abortEvaluation("no variables available");
 
         if (node->getPath().size() == 1 && node->getPath()[0] == "$")
-            return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit, this->m_currOffset });
+            return { Token::ValueType::Unsigned64Bit, this->m_currOffset };
 
         auto currPattern = this->patternFromName(node->getPath());
 
         if (auto unsignedPattern = dynamic_cast<PatternDataUnsigned*>(currPattern); unsignedPattern != nullptr) {
             u8 value[unsignedPattern->getSize()];
-            this->m_provider->read(unsignedPattern->getOffset(), value, unsignedPattern->getSize());
+            this->readData(unsignedPattern->getOffset(), value, unsignedPattern->getSize());
 
             switch (unsignedPattern->getSize()) {
-                case 1:  return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned8Bit,   hex::changeEndianess(*reinterpret_cast<u8*>(value),   1,  unsignedPattern->getEndian()) });
-                case 2:  return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned16Bit,  hex::changeEndianess(*reinterpret_cast<u16*>(value),  2,  unsignedPattern->getEndian()) });
-                case 4:  return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned32Bit,  hex::changeEndianess(*reinterpret_cast<u32*>(value),  4,  unsignedPattern->getEndian()) });
-                case 8:  return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit,  hex::changeEndianess(*reinterpret_cast<u64*>(value),  8,  unsignedPattern->getEndian()) });
-                case 16: return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned128Bit, hex::changeEndianess(*reinterpret_cast<u128*>(value), 16, unsignedPattern->getEndian()) });
+                case 1:  return { Token::ValueType::Unsigned8Bit,   hex::changeEndianess(*reinterpret_cast<u8*>(value),   1,  unsignedPattern->getEndian()) };
+                case 2:  return { Token::ValueType::Unsigned16Bit,  hex::changeEndianess(*reinterpret_cast<u16*>(value),  2,  unsignedPattern->getEndian()) };
+                case 4:  return { Token::ValueType::Unsigned32Bit,  hex::changeEndianess(*reinterpret_cast<u32*>(value),  4,  unsignedPattern->getEndian()) };
+                case 8:  return { Token::ValueType::Unsigned64Bit,  hex::changeEndianess(*reinterpret_cast<u64*>(value),  8,  unsignedPattern->getEndian()) };
+                case 16: return { Token::ValueType::Unsigned128Bit, hex::changeEndianess(*reinterpret_cast<u128*>(value), 16, unsignedPattern->getEndian()) };
                 default: this->getConsole().abortEvaluation("invalid rvalue size");
             }
         } else if (auto signedPattern = dynamic_cast<PatternDataSigned*>(currPattern); signedPattern != nullptr) {
-            u8 value[unsignedPattern->getSize()];
-            this->m_provider->read(signedPattern->getOffset(), value, signedPattern->getSize());
-
-            switch (unsignedPattern->getSize()) {
-                case 1:  return new ASTNodeIntegerLiteral({ Token::ValueType::Signed8Bit,   hex::changeEndianess(*reinterpret_cast<s8*>(value),   1,  signedPattern->getEndian()) });
-                case 2:  return new ASTNodeIntegerLiteral({ Token::ValueType::Signed16Bit,  hex::changeEndianess(*reinterpret_cast<s16*>(value),  2,  signedPattern->getEndian()) });
-                case 4:  return new ASTNodeIntegerLiteral({ Token::ValueType::Signed32Bit,  hex::changeEndianess(*reinterpret_cast<s32*>(value),  4,  signedPattern->getEndian()) });
-                case 8:  return new ASTNodeIntegerLiteral({ Token::ValueType::Signed64Bit,  hex::changeEndianess(*reinterpret_cast<s64*>(value),  8,  signedPattern->getEndian()) });
-                case 16: return new ASTNodeIntegerLiteral({ Token::ValueType::Signed128Bit, hex::changeEndianess(*reinterpret_cast<s128*>(value), 16, signedPattern->getEndian()) });
+            u8 value[signedPattern->getSize()];
+            this->readData(signedPattern->getOffset(), value, signedPattern->getSize());
+
+            switch (signedPattern->getSize()) {
+                case 1:  return { Token::ValueType::Signed8Bit,   hex::changeEndianess(*reinterpret_cast<s8*>(value),   1,  signedPattern->getEndian()) };
+                case 2:  return { Token::ValueType::Signed16Bit,  hex::changeEndianess(*reinterpret_cast<s16*>(value),  2,  signedPattern->getEndian()) };
+                case 4:  return { Token::ValueType::Signed32Bit,  hex::changeEndianess(*reinterpret_cast<s32*>(value),  4,  signedPattern->getEndian()) };
+                case 8:  return { Token::ValueType::Signed64Bit,  hex::changeEndianess(*reinterpret_cast<s64*>(value),  8,  signedPattern->getEndian()) };
+                case 16: return { Token::ValueType::Signed128Bit, hex::changeEndianess(*reinterpret_cast<s128*>(value), 16, signedPattern->getEndian()) };
                 default: this->getConsole().abortEvaluation("invalid rvalue size");
             }
         } else if (auto enumPattern = dynamic_cast<PatternDataEnum*>(currPattern); enumPattern != nullptr) {
             u8 value[enumPattern->getSize()];
-            this->m_provider->read(enumPattern->getOffset(), value, enumPattern->getSize());
+            this->readData(enumPattern->getOffset(), value, enumPattern->getSize());
 
             switch (enumPattern->getSize()) {
-                case 1:  return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned8Bit,   hex::changeEndianess(*reinterpret_cast<u8*>(value),   1,  enumPattern->getEndian()) });
-                case 2:  return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned16Bit,  hex::changeEndianess(*reinterpret_cast<u16*>(value),  2,  enumPattern->getEndian()) });
-                case 4:  return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned32Bit,  hex::changeEndianess(*reinterpret_cast<u32*>(value),  4,  enumPattern->getEndian()) });
-                case 8:  return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned64Bit,  hex::changeEndianess(*reinterpret_cast<u64*>(value),  8,  enumPattern->getEndian()) });
-                case 16: return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned128Bit, hex::changeEndianess(*reinterpret_cast<u128*>(value), 16, enumPattern->getEndian()) });
+                case 1:  return { Token::ValueType::Unsigned8Bit,   hex::changeEndianess(*reinterpret_cast<u8*>(value),   1,  enumPattern->getEndian()) };
+                case 2:  return { Token::ValueType::Unsigned16Bit,  hex::changeEndianess(*reinterpret_cast<u16*>(value),  2,  enumPattern->getEndian()) };
+                case 4:  return { Token::ValueType::Unsigned32Bit,  hex::changeEndianess(*reinterpret_cast<u32*>(value),  4,  enumPattern->getEndian()) };
+                case 8:  return { Token::ValueType::Unsigned64Bit,  hex::changeEndianess(*reinterpret_cast<u64*>(value),  8,  enumPattern->getEndian()) };
+                case 16: return { Token::ValueType::Unsigned128Bit, hex::changeEndianess(*reinterpret_cast<u128*>(value), 16, enumPattern->getEndian()) };
                 default: this->getConsole().abortEvaluation("invalid rvalue size");
             }
         } else
@@ -120,38 +127,45 @@ namespace hex::lang {
     }
 
     ASTNode* Evaluator::evaluateFunctionCall(ASTNodeFunctionCall *node) {
-        std::vector<ASTNode*> evaluatedParams;
-        ScopeExit paramCleanup([&] {
-           for (auto &param : evaluatedParams)
-               delete param;
-        });
-
-        for (auto &param : node->getParams()) {
-            if (auto numericExpression = dynamic_cast<ASTNodeNumericExpression*>(param); numericExpression != nullptr)
-                evaluatedParams.push_back(this->evaluateMathematicalExpression(numericExpression));
-            else if (auto stringLiteral = dynamic_cast<ASTNodeStringLiteral*>(param); stringLiteral != nullptr)
-                evaluatedParams.push_back(stringLiteral->clone());
+        auto function = node->getFunction();
+        if (function == nullptr) {
+            auto &functions = ContentRegistry::PatternLanguageFunctions::getEntries();
+            auto entry = functions.find(std::string(node->getFunctionName()));
+            if (entry == functions.end())
+                this->getConsole().abortEvaluation(hex::format("no function named '%s' found", node->getFunctionName().data()));
+
+            function = &entry->second;
         }
 
-        if (!ContentRegistry::PatternLanguageFunctions::getEntries().contains(node->getFunctionName().data()))
-            this->getConsole().abortEvaluation(hex::format("no function named '%s' found", node->getFunctionName().data()));
+        // Evaluated parameters live in a buffer on the stack, only very long parameter lists have to allocate
+        std::array<std::byte, 1024> buffer;
+        std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size());
+        std::pmr::vector<ASTNodeIntegerLiteral> values(&resource);
+        std::pmr::vector<ASTNode*> evaluatedParams(&resource);
+        values.reserve(node->getParams().size());
+        evaluatedParams.reserve(node->getParams().size());
 
-        auto &function = ContentRegistry::PatternLanguageFunctions::getEntries()[node->getFunctionName().data()];
+        for (auto &param : node->getParams()) {
+            if (auto numericExpression = nodeCast<ASTNodeNumericExpression>(param); numericExpression != nullptr)
+                evaluatedParams.push_back(&values.emplace_back(this->evaluateMathematicalExpression(numericExpression)));
+            else if (auto stringLiteral = nodeCast<ASTNodeStringLiteral>(param); stringLiteral != nullptr)
+                evaluatedParams.push_back(stringLiteral);
+        }
 
-        if (function.parameterCount == ContentRegistry::PatternLanguageFunctions::UnlimitedParameters) {
+        if (function->parameterCount == ContentRegistry::PatternLanguageFunctions::UnlimitedParameters) {
             ; // Don't check parameter count
         }
-        else if (function.parameterCount & ContentRegistry::PatternLanguageFunctions::LessParametersThan) {
-            if (evaluatedParams.size() >= (function.parameterCount & ~ContentRegistry::PatternLanguageFunctions::LessParametersThan))
-                this->getConsole().abortEvaluation(hex::format("too many parameters for function '%s'. Expected %d", node->getFunctionName().data(), function.parameterCount & ~ContentRegistry::PatternLanguageFunctions::LessParametersThan));
-        } else if (function.parameterCount & ContentRegistry::PatternLanguageFunctions::MoreParametersThan) {
-            if (evaluatedParams.size() <= (function.parameterCount & ~ContentRegistry::PatternLanguageFunctions::MoreParametersThan))
-                this->getConsole().abortEvaluation(hex::format("too few parameters for function '%s'. Expected %d", node->getFunctionName().data(), function.parameterCount & ~ContentRegistry::PatternLanguageFunctions::MoreParametersThan));
-        } else if (function.parameterCount != evaluatedParams.size()) {
-            this->getConsole().abortEvaluation(hex::format("invalid number of parameters for function '%s'. Expected %d", node->getFunctionName().data(), function.parameterCount));
+        else if (function->parameterCount & ContentRegistry::PatternLanguageFunctions::LessParametersThan) {
+            if (evaluatedParams.size() >= (function->parameterCount & ~ContentRegistry::PatternLanguageFunctions::LessParametersThan))
+                this->getConsole().abortEvaluation(hex::format("too many parameters for function '%s'. Expected %d", node->getFunctionName().data(), function->parameterCount & ~ContentRegistry::PatternLanguageFunctions::LessParametersThan));
+        } else if (function->parameterCount & ContentRegistry::PatternLanguageFunctions::MoreParametersThan) {
+            if (evaluatedParams.size() <= (function->parameterCount & ~ContentRegistry::PatternLanguageFunctions::MoreParametersThan))
+                this->getConsole().abortEvaluation(hex::format("too few parameters for function '%s'. Expected %d", node->getFunctionName().data(), function->parameterCount & ~ContentRegistry::PatternLanguageFunctions::MoreParametersThan));
+        } else if (function->parameterCount != evaluatedParams.size()) {
+            this->getConsole().abortEvaluation(hex::format("invalid number of parameters for function '%s'. Expected %d", node->getFunctionName().data(), function->parameterCount));
         }
 
-        return function.func(*this, evaluatedParams);
+        return function->func(*this, evaluatedParams);
     }
 
 #define FLOAT_BIT_OPERATION(name) \
@@ -192,15 +206,15 @@ namespace hex::lang {
 
     }
 
-    ASTNodeIntegerLiteral* Evaluator::evaluateOperator(ASTNodeIntegerLiteral *left, ASTNodeIntegerLiteral *right, Token::Operator op) {
+    Token::IntegerLiteral Evaluator::evaluateOperator(const Token::IntegerLiteral &left, const Token::IntegerLiteral &right, Token::Operator op) {
         auto newType = [&] {
-            #define CHECK_TYPE(type) if (left->getType() == (type) || right->getType() == (type)) return (type)
+            #define CHECK_TYPE(type) if (left.first == (type) || right.first == (type)) return (type)
             #define DEFAULT_TYPE(type) return (type)
 
-            if (left->getType() == Token::ValueType::Any && right->getType() != Token::ValueType::Any)
-                return right->getType();
-            if (left->getType() != Token::ValueType::Any && right->getType() == Token::ValueType::Any)
-                return left->getType();
+            if (left.first == Token::ValueType::Any && right.first != Token::ValueType::Any)
+                return right.first;
+            if (left.first != Token::ValueType::Any && right.first == Token::ValueType::Any)
+                return left.first;
 
             CHECK_TYPE(Token::ValueType::Double);
             CHECK_TYPE(Token::ValueType::Float);
@@ -223,92 +237,96 @@ namespace hex::lang {
         }();
 
         try {
-            return std::visit([&](auto &&leftValue, auto &&rightValue) -> ASTNodeIntegerLiteral * {
+            return std::visit([&](auto &&leftValue, auto &&rightValue) -> Token::IntegerLiteral {
                 switch (op) {
                     case Token::Operator::Plus:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue + rightValue });
+                        return { newType, leftValue + rightValue };
                     case Token::Operator::Minus:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue - rightValue });
+                        return { newType, leftValue - rightValue };
                     case Token::Operator::Star:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue * rightValue });
+                        return { newType, leftValue * rightValue };
                     case Token::Operator::Slash:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue / rightValue });
+                        return { newType, leftValue / rightValue };
                     case Token::Operator::Percent:
-                        return new ASTNodeIntegerLiteral({ newType, modulus(leftValue, rightValue) });
+                        return { newType, modulus(leftValue, rightValue) };
                     case Token::Operator::ShiftLeft:
-                        return new ASTNodeIntegerLiteral({ newType, shiftLeft(leftValue, rightValue) });
+                        return { newType, shiftLeft(leftValue, rightValue) };
                     case Token::Operator::ShiftRight:
-                        return new ASTNodeIntegerLiteral({ newType, shiftRight(leftValue, rightValue) });
+                        return { newType, shiftRight(leftValue, rightValue) };
                     case Token::Operator::BitAnd:
-                        return new ASTNodeIntegerLiteral({ newType, bitAnd(leftValue, rightValue) });
+                        return { newType, bitAnd(leftValue, rightValue) };
                     case Token::Operator::BitXor:
-                        return new ASTNodeIntegerLiteral({ newType, bitXor(leftValue, rightValue) });
+                        return { newType, bitXor(leftValue, rightValue) };
                     case Token::Operator::BitOr:
-                        return new ASTNodeIntegerLiteral({ newType, bitOr(leftValue, rightValue) });
+                        return { newType, bitOr(leftValue, rightValue) };
                     case Token::Operator::BitNot:
-                        return new ASTNodeIntegerLiteral({ newType, bitNot(leftValue, rightValue) });
+                        return { newType, bitNot(leftValue, rightValue) };
                     case Token::Operator::BoolEquals:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue == rightValue });
+                        return { newType, leftValue == rightValue };
                     case Token::Operator::BoolNotEquals:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue != rightValue });
+                        return { newType, leftValue != rightValue };
                     case Token::Operator::BoolGreaterThan:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue > rightValue });
+                        return { newType, leftValue > rightValue };
                     case Token::Operator::BoolLessThan:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue < rightValue });
+                        return { newType, leftValue < rightValue };
                     case Token::Operator::BoolGreaterThanOrEquals:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue >= rightValue });
+                        return { newType, leftValue >= rightValue };
                     case Token::Operator::BoolLessThanOrEquals:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue <= rightValue });
+                        return { newType, leftValue <= rightValue };
                     case Token::Operator::BoolAnd:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue && rightValue });
+                        return { newType, leftValue && rightValue };
                     case Token::Operator::BoolXor:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue && !rightValue || !leftValue && rightValue });
+                        return { newType, leftValue && !rightValue || !leftValue && rightValue };
                     case Token::Operator::BoolOr:
-                        return new ASTNodeIntegerLiteral({ newType, leftValue || rightValue });
+                        return { newType, leftValue || rightValue };
                     case Token::Operator::BoolNot:
-                        return new ASTNodeIntegerLiteral({ newType, !rightValue });
+                        return { newType, !rightValue };
                     default:
                         this->getConsole().abortEvaluation("invalid operator used in mathematical expression");
                 }
 
-            }, left->getValue(), right->getValue());
+            }, left.second, right.second);
         } catch (std::runtime_error &e) {
             this->getConsole().abortEvaluation("bitwise operations on floating point numbers are forbidden");
         }
     }
 
-    ASTNodeIntegerLiteral* Evaluator::evaluateOperand(ASTNode *node) {
-        if (auto exprLiteral = dynamic_cast<ASTNodeIntegerLiteral*>(node); exprLiteral != nullptr)
-            return exprLiteral;
-        else if (auto exprExpression = dynamic_cast<ASTNodeNumericExpression*>(node); exprExpression != nullptr)
-            return evaluateMathematicalExpression(exprExpression);
-        else if (auto exprRvalue = dynamic_cast<ASTNodeRValue*>(node); exprRvalue != nullptr)
-            return evaluateRValue(exprRvalue);
-        else if (auto exprScopeResolution = dynamic_cast<ASTNodeScopeResolution*>(node); exprScopeResolution != nullptr)
-            return evaluateScopeResolution(exprScopeResolution);
-        else if (auto exprTernary = dynamic_cast<ASTNodeTernaryExpression*>(node); exprTernary != nullptr)
-            return evaluateTernaryExpression(exprTernary);
-        else if (auto exprFunctionCall = dynamic_cast<ASTNodeFunctionCall*>(node); exprFunctionCall != nullptr) {
-            auto returnValue = evaluateFunctionCall(exprFunctionCall);
-
-            if (returnValue == nullptr)
-                this->getConsole().abortEvaluation("function returning void used in expression");
-            else if (auto integerNode = dynamic_cast<ASTNodeIntegerLiteral*>(returnValue); integerNode != nullptr)
-                return integerNode;
-            else
-                this->getConsole().abortEvaluation("function not returning a numeric value used in expression");
+    Token::IntegerLiteral Evaluator::evaluateOperand(ASTNode *node) {
+        switch (node->getKind()) {
+            case ASTNode::Kind::IntegerLiteral: {
+                auto exprLiteral = static_cast<ASTNodeIntegerLiteral*>(node);
+                return { exprLiteral->getType(), exprLiteral->getValue() };
+            }
+            case ASTNode::Kind::NumericExpression:
+                return evaluateMathematicalExpression(static_cast<ASTNodeNumericExpression*>(node));
+            case ASTNode::Kind::RValue:
+                return evaluateRValue(static_cast<ASTNodeRValue*>(node));
+            case ASTNode::Kind::ScopeResolution:
+                return evaluateScopeResolution(static_cast<ASTNodeScopeResolution*>(node));
+            case ASTNode::Kind::TernaryExpression:
+                return evaluateTernaryExpression(static_cast<ASTNodeTernaryExpression*>(node));
+            case ASTNode::Kind::FunctionCall: {
+                auto returnValue = evaluateFunctionCall(static_cast<ASTNodeFunctionCall*>(node));
+                SCOPE_EXIT( delete returnValue; );
+
+                if (returnValue == nullptr)
+                    this->getConsole().abortEvaluation("function returning void used in expression");
+                else if (auto integerNode = nodeCast<ASTNodeIntegerLiteral>(returnValue); integerNode != nullptr)
+                    return { integerNode->getType(), integerNode->getValue() };
+                else
+                    this->getConsole().abortEvaluation("function not returning a numeric value used in expression");
+            }
+            default:
+                this->getConsole().abortEvaluation("invalid operand");
         }
-        else
-            this->getConsole().abortEvaluation("invalid operand");
     }
 
-    ASTNodeIntegerLiteral* Evaluator::evaluateTernaryExpression(ASTNodeTernaryExpression *node) {
+    Token::IntegerLiteral Evaluator::evaluateTernaryExpression(ASTNodeTernaryExpression *node) {
         switch (node->getOperator()) {
             case Token::Operator::TernaryConditional: {
                 auto condition = this->evaluateOperand(node->getFirstOperand());
-                SCOPE_EXIT( delete condition; );
 
-                if (std::visit([](auto &&value){ return value != 0; }, condition->getValue()))
+                if (std::visit([](auto &&value){ return value != 0; }, condition.second))
                     return this->evaluateOperand(node->getSecondOperand());
                 else
                     return this->evaluateOperand(node->getThirdOperand());
@@ -318,7 +336,10 @@ namespace hex::lang {
         }
     }
 
-    ASTNodeIntegerLiteral* Evaluator::evaluateMathematicalExpression(ASTNodeNumericExpression *node) {
+    Token::IntegerLiteral Evaluator::evaluateMathematicalExpression(ASTNodeNumericExpression *node) {
+        if (const auto &constantValue = node->getConstantValue(); constantValue.has_value())
+            return *constantValue;
+
         auto leftInteger  = this->evaluateOperand(node->getLeftOperand());
         auto rightInteger = this->evaluateOperand(node->getRightOperand());
 
@@ -348,22 +369,22 @@ namespace hex::lang {
         if (attributes.empty())
             return currPattern;
 
-        if (auto variableDeclNode = dynamic_cast<ASTNodeVariableDecl*>(currNode); variableDeclNode != nullptr) {
+        if (auto variableDeclNode = nodeCast<ASTNodeVariableDecl>(currNode); variableDeclNode != nullptr) {
             for (auto &attribute : attributes)
                 handleVariableAttributes(attribute->getAttribute(), attribute->getValue());
-        } else if (auto arrayDeclNode = dynamic_cast<ASTNodeArrayVariableDecl*>(currNode); arrayDeclNode != nullptr) {
+        } else if (auto arrayDeclNode = nodeCast<ASTNodeArrayVariableDecl>(currNode); arrayDeclNode != nullptr) {
             for (auto &attribute : attributes)
                 handleVariableAttributes(attribute->getAttribute(), attribute->getValue());
-        } else if (auto pointerDeclNode = dynamic_cast<ASTNodePointerVariableDecl*>(currNode); pointerDeclNode != nullptr) {
+        } else if (auto pointerDeclNode = nodeCast<ASTNodePointerVariableDecl>(currNode); pointerDeclNode != nullptr) {
             for (auto &attribute : attributes)
                 handleVariableAttributes(attribute->getAttribute(), attribute->getValue());
-        } else if (auto structNode = dynamic_cast<ASTNodeStruct*>(currNode); structNode != nullptr) {
+        } else if (auto structNode = nodeCast<ASTNodeStruct>(currNode); structNode != nullptr) {
             this->getConsole().abortEvaluation("unknown or invalid attribute");
-        } else if (auto unionNode = dynamic_cast<ASTNodeUnion*>(currNode); unionNode != nullptr) {
+        } else if (auto unionNode = nodeCast<ASTNodeUnion>(currNode); unionNode != nullptr) {
             this->getConsole().abortEvaluation("unknown or invalid attribute");
-        } else if (auto enumNode = dynamic_cast<ASTNodeEnum*>(currNode); enumNode != nullptr) {
+        } else if (auto enumNode = nodeCast<ASTNodeEnum>(currNode); enumNode != nullptr) {
             this->getConsole().abortEvaluation("unknown or invalid attribute");
-        } else if (auto bitfieldNode = dynamic_cast<ASTNodeBitfield*>(currNode); bitfieldNode != nullptr) {
+        } else if (auto bitfieldNode = nodeCast<ASTNodeBitfield>(currNode); bitfieldNode != nullptr) {
             this->getConsole().abortEvaluation("unknown or invalid attribute");
         } else
             this->getConsole().abortEvaluation("attributes applied to invalid expression");
@@ -372,6 +393,8 @@ namespace hex::lang {
     }
 
     PatternData* Evaluator::evaluateBuiltinType(ASTNodeBuiltinType *node) {
+        this->countPatterns();
+
         auto &type = node->getType();
         auto typeSize = Token::getTypeSize(type);
 
@@ -398,45 +421,71 @@ namespace hex::lang {
         return pattern;
     }
 
+    void Evaluator::pushMemberScope(std::vector<PatternData*> &members) {
+        this->m_currMembers.push_back(&members);
+        this->m_currMemberLookup.emplace_back();
+    }
+
+    void Evaluator::popMemberScope() {
+        this->m_currMembers.pop_back();
+        this->m_currMemberLookup.pop_back();
+    }
+
+    void Evaluator::addMember(std::vector<PatternData*> &members, PatternData *pattern) {
+        members.push_back(pattern);
+
+        // Earlier members shadow later ones with the same name
+        if (!this->m_currMemberLookup.empty())
+            this->m_currMemberLookup.back().try_emplace(pattern->getVariableName(), pattern);
+    }
+
     void Evaluator::evaluateMember(ASTNode *node, std::vector<PatternData*> &currMembers, bool increaseOffset) {
         auto startOffset = this->m_currOffset;
 
-        if (auto memberVariableNode = dynamic_cast<ASTNodeVariableDecl*>(node); memberVariableNode != nullptr)
-            currMembers.push_back(this->evaluateVariable(memberVariableNode));
-        else if (auto memberArrayNode = dynamic_cast<ASTNodeArrayVariableDecl*>(node); memberArrayNode != nullptr)
-            currMembers.push_back(this->evaluateArray(memberArrayNode));
-        else if (auto memberPointerNode = dynamic_cast<ASTNodePointerVariableDecl*>(node); memberPointerNode != nullptr)
-            currMembers.push_back(this->evaluatePointer(memberPointerNode));
-        else if (auto conditionalNode = dynamic_cast<ASTNodeConditionalStatement*>(node); conditionalNode != nullptr) {
-            auto condition = this->evaluateMathematicalExpression(static_cast<ASTNodeNumericExpression*>(conditionalNode->getCondition()));
-
-            if (std::visit([](auto &&value) { return value != 0; }, condition->getValue())) {
-                for (auto &statement : conditionalNode->getTrueBody()) {
-                    this->evaluateMember(statement, currMembers, increaseOffset);
-                }
-            } else {
-                for (auto &statement : conditionalNode->getFalseBody()) {
-                    this->evaluateMember(statement, currMembers, increaseOffset);
+        switch (node->getKind()) {
+            case ASTNode::Kind::VariableDecl:
+                this->addMember(currMembers, this->evaluateVariable(static_cast<ASTNodeVariableDecl*>(node)));
+                break;
+            case ASTNode::Kind::ArrayVariableDecl:
+                this->addMember(currMembers, this->evaluateArray(static_cast<ASTNodeArrayVariableDecl*>(node)));
+                break;
+            case ASTNode::Kind::PointerVariableDecl:
+                this->addMember(currMembers, this->evaluatePointer(static_cast<ASTNodePointerVariableDecl*>(node)));
+                break;
+            case ASTNode::Kind::ConditionalStatement: {
+                auto conditionalNode = static_cast<ASTNodeConditionalStatement*>(node);
+                auto condition = this->evaluateMathematicalExpression(static_cast<ASTNodeNumericExpression*>(conditionalNode->getCondition()));
+
+                if (std::visit([](auto &&value) { return value != 0; }, condition.second)) {
+                    for (auto &statement : conditionalNode->getTrueBody()) {
+                        this->evaluateMember(statement, currMembers, increaseOffset);
+                    }
+                } else {
+                    for (auto &statement : conditionalNode->getFalseBody()) {
+                        this->evaluateMember(statement, currMembers, increaseOffset);
+                    }
                 }
+                break;
             }
-
-            delete condition;
+            default:
+                this->getConsole().abortEvaluation("invalid struct member");
         }
-        else
-            this->getConsole().abortEvaluation("invalid struct member");
 
         if (!increaseOffset)
             this->m_currOffset = startOffset;
     }
 
     PatternData* Evaluator::evaluateStruct(ASTNodeStruct *node) {
+        this->countPatterns();
+
         std::vector<PatternData*> memberPatterns;
 
-        this->m_currMembers.push_back(&memberPatterns);
-        SCOPE_EXIT( this->m_currMembers.pop_back(); );
+        this->pushMemberScope(memberPatterns);
+        SCOPE_EXIT( this->popMemberScope(); );
 
         auto startOffset = this->m_currOffset;
         for (auto &member : node->getMembers()) {
+            this->throwIfCancelled();
             this->evaluateMember(member, memberPatterns, true);
         }
 
@@ -444,14 +493,17 @@ namespace hex::lang {
     }
 
     PatternData* Evaluator::evaluateUnion(ASTNodeUnion *node) {
+        this->countPatterns();
+
         std::vector<PatternData*> memberPatterns;
 
-        this->m_currMembers.push_back(&memberPatterns);
-        SCOPE_EXIT( this->m_currMembers.pop_back(); );
+        this->pushMemberScope(memberPatterns);
+        SCOPE_EXIT( this->popMemberScope(); );
 
         auto startOffset = this->m_currOffset;
 
         for (auto &member : node->getMembers()) {
+            this->throwIfCancelled();
             this->evaluateMember(member, memberPatterns, false);
         }
 
@@ -465,26 +517,25 @@ namespace hex::lang {
     }
 
     PatternData* Evaluator::evaluateEnum(ASTNodeEnum *node) {
+        this->countPatterns();
+
         std::vector<std::pair<Token::IntegerLiteral, std::string>> entryPatterns;
 
         auto startOffset = this->m_currOffset;
         for (auto &[name, value] : node->getEntries()) {
-            auto expression = dynamic_cast<ASTNodeNumericExpression*>(value);
+            auto expression = nodeCast<ASTNodeNumericExpression>(value);
             if (expression == nullptr)
                 this->getConsole().abortEvaluation("invalid expression in enum value");
 
-            auto valueNode = evaluateMathematicalExpression(expression);
-            SCOPE_EXIT( delete valueNode; );
-
-            entryPatterns.push_back({{ valueNode->getType(), valueNode->getValue() }, name });
+            entryPatterns.push_back({ this->evaluateMathematicalExpression(expression), name });
         }
 
-        auto underlyingType = dynamic_cast<ASTNodeTypeDecl*>(node->getUnderlyingType());
+        auto underlyingType = nodeCast<ASTNodeTypeDecl>(node->getUnderlyingType());
         if (underlyingType == nullptr)
             this->getConsole().abortEvaluation("enum underlying type was not ASTNodeTypeDecl. This is a bug");
 
         size_t size;
-        if (auto builtinType = dynamic_cast<ASTNodeBuiltinType*>(underlyingType->getType()); builtinType != nullptr)
+        if (auto builtinType = nodeCast<ASTNodeBuiltinType>(underlyingType->getType()); builtinType != nullptr)
             size = Token::getTypeSize(builtinType->getType());
         else
             this->getConsole().abortEvaluation("invalid enum underlying type");
@@ -495,23 +546,23 @@ namespace hex::lang {
     }
 
     PatternData* Evaluator::evaluateBitfield(ASTNodeBitfield *node) {
+        this->countPatterns();
+
         std::vector<std::pair<std::string, size_t>> entryPatterns;
 
         auto startOffset = this->m_currOffset;
         size_t bits = 0;
         for (auto &[name, value] : node->getEntries()) {
-            auto expression = dynamic_cast<ASTNodeNumericExpression*>(value);
+            auto expression = nodeCast<ASTNodeNumericExpression>(value);
             if (expression == nullptr)
                 this->getConsole().abortEvaluation("invalid expression in bitfield field size");
 
-            auto valueNode = evaluateMathematicalExpression(expression);
-            SCOPE_EXIT( delete valueNode; );
-
-            auto fieldBits = std::visit([this, node, type = valueNode->getType()] (auto &&value) {
+            auto literal = this->evaluateMathematicalExpression(expression);
+            auto fieldBits = std::visit([this, node, type = literal.first] (auto &&value) {
                 if (Token::isFloatingPoint(type))
                     this->getConsole().abortEvaluation("bitfield entry size must be an integer value");
                 return static_cast<s128>(value);
-            }, valueNode->getValue());
+            }, literal.second);
 
             if (fieldBits > 64 || fieldBits <= 0)
                 this->getConsole().abortEvaluation("bitfield entry must occupy between 1 and 64 bits");
@@ -530,24 +581,53 @@ namespace hex::lang {
     PatternData* Evaluator::evaluateType(ASTNodeTypeDecl *node) {
         auto type = node->getType();
 
+        this->m_recursionDepth++;
+        SCOPE_EXIT( this->m_recursionDepth--; );
+
+        if (this->m_limits.recursionLimit != 0 && this->m_recursionDepth > this->m_limits.recursionLimit)
+            this->getConsole().abortEvaluation(hex::format("types nested deeper than the recursion limit of %u", this->m_limits.recursionLimit));
+
+        TypeProfile *profile = nullptr;
+        auto profileStart = std::chrono::steady_clock::time_point();
+        if (this->m_limits.profile && !node->getName().empty()) {
+            profile = &this->m_profile[std::string(node->getName())];
+            profileStart = std::chrono::steady_clock::now();
+            this->m_profileStack.push_back(profile);
+        }
+
+        SCOPE_EXIT(
+            if (profile != nullptr) {
+                profile->patternCount++;
+                profile->time += std::chrono::steady_clock::now() - profileStart;
+                this->m_profileStack.pop_back();
+            }
+        );
+
         this->m_endianStack.push_back(node->getEndian().value_or(this->m_defaultDataEndian));
 
         PatternData *pattern;
 
-        if (auto builtinTypeNode = dynamic_cast<ASTNodeBuiltinType*>(type); builtinTypeNode != nullptr)
-            return this->evaluateBuiltinType(builtinTypeNode);
-        else if (auto typeDeclNode = dynamic_cast<ASTNodeTypeDecl*>(type); typeDeclNode != nullptr)
-            pattern = this->evaluateType(typeDeclNode);
-        else if (auto structNode = dynamic_cast<ASTNodeStruct*>(type); structNode != nullptr)
-            pattern = this->evaluateStruct(structNode);
-        else if (auto unionNode = dynamic_cast<ASTNodeUnion*>(type); unionNode != nullptr)
-            pattern = this->evaluateUnion(unionNode);
-        else if (auto enumNode = dynamic_cast<ASTNodeEnum*>(type); enumNode != nullptr)
-            pattern = this->evaluateEnum(enumNode);
-        else if (auto bitfieldNode = dynamic_cast<ASTNodeBitfield*>(type); bitfieldNode != nullptr)
-            pattern = this->evaluateBitfield(bitfieldNode);
-        else
-            this->getConsole().abortEvaluation("type could not be evaluated");
+        switch (type->getKind()) {
+            case ASTNode::Kind::BuiltinType:
+                return this->evaluateBuiltinType(static_cast<ASTNodeBuiltinType*>(type));
+            case ASTNode::Kind::TypeDecl:
+                pattern = this->evaluateType(static_cast<ASTNodeTypeDecl*>(type));
+                break;
+            case ASTNode::Kind::Struct:
+                pattern = this->evaluateStruct(static_cast<ASTNodeStruct*>(type));
+                break;
+            case ASTNode::Kind::Union:
+                pattern = this->evaluateUnion(static_cast<ASTNodeUnion*>(type));
+                break;
+            case ASTNode::Kind::Enum:
+                pattern = this->evaluateEnum(static_cast<ASTNodeEnum*>(type));
+                break;
+            case ASTNode::Kind::Bitfield:
+                pattern = this->evaluateBitfield(static_cast<ASTNodeBitfield*>(type));
+                break;
+            default:
+                this->getConsole().abortEvaluation("type could not be evaluated");
+        }
 
         if (!node->getName().empty())
             pattern->setTypeName(node->getName().data());
@@ -561,23 +641,21 @@ namespace hex::lang {
 
     PatternData* Evaluator::evaluateVariable(ASTNodeVariableDecl *node) {
 
-        if (auto offset = dynamic_cast<ASTNodeNumericExpression*>(node->getPlacementOffset()); offset != nullptr) {
-            auto valueNode = evaluateMathematicalExpression(offset);
-            SCOPE_EXIT( delete valueNode; );
-
-            this->m_currOffset = std::visit([this, node, type = valueNode->getType()] (auto &&value) {
+        if (auto offset = nodeCast<ASTNodeNumericExpression>(node->getPlacementOffset()); offset != nullptr) {
+            auto literal = this->evaluateMathematicalExpression(offset);
+            this->m_currOffset = std::visit([this, node, type = literal.first] (auto &&value) {
                 if (Token::isFloatingPoint(type))
                     this->getConsole().abortEvaluation("placement offset must be an integer value");
                 return static_cast<u64>(value);
-            }, valueNode->getValue());
+            }, literal.second);
         }
         if (this->m_currOffset >= this->m_provider->getActualSize())
             this->getConsole().abortEvaluation("variable placed out of range");
 
         PatternData *pattern;
-        if (auto typeDecl = dynamic_cast<ASTNodeTypeDecl*>(node->getType()); typeDecl != nullptr)
+        if (auto typeDecl = nodeCast<ASTNodeTypeDecl>(node->getType()); typeDecl != nullptr)
             pattern = this->evaluateType(typeDecl);
-        else if (auto builtinTypeDecl = dynamic_cast<ASTNodeBuiltinType*>(node->getType()); builtinTypeDecl != nullptr)
+        else if (auto builtinTypeDecl = nodeCast<ASTNodeBuiltinType>(node->getType()); builtinTypeDecl != nullptr)
             pattern = this->evaluateBuiltinType(builtinTypeDecl);
         else
             this->getConsole().abortEvaluation("ASTNodeVariableDecl had an invalid type. This is a bug!");
@@ -589,38 +667,38 @@ namespace hex::lang {
 
     PatternData* Evaluator::evaluateArray(ASTNodeArrayVariableDecl *node) {
 
-        if (auto offset = dynamic_cast<ASTNodeNumericExpression*>(node->getPlacementOffset()); offset != nullptr) {
-            auto valueNode = evaluateMathematicalExpression(offset);
-            SCOPE_EXIT( delete valueNode; );
-
-            this->m_currOffset = std::visit([this, node, type = valueNode->getType()] (auto &&value) {
+        if (auto offset = nodeCast<ASTNodeNumericExpression>(node->getPlacementOffset()); offset != nullptr) {
+            auto literal = this->evaluateMathematicalExpression(offset);
+            this->m_currOffset = std::visit([this, node, type = literal.first] (auto &&value) {
                 if (Token::isFloatingPoint(type))
                     this->getConsole().abortEvaluation("placement offset must be an integer value");
                 return static_cast<u64>(value);
-            }, valueNode->getValue());
+            }, literal.second);
         }
 
         auto startOffset = this->m_currOffset;
 
-        ASTNodeIntegerLiteral *valueNode;
         u64 arraySize = 0;
 
         if (node->getSize() != nullptr) {
-            if (auto sizeNumericExpression = dynamic_cast<ASTNodeNumericExpression*>(node->getSize()); sizeNumericExpression != nullptr)
-                valueNode = evaluateMathematicalExpression(sizeNumericExpression);
-            else
+            auto sizeNumericExpression = nodeCast<ASTNodeNumericExpression>(node->getSize());
+            if (sizeNumericExpression == nullptr)
                 this->getConsole().abortEvaluation("array size not a numeric expression");
 
-            SCOPE_EXIT( delete valueNode; );
+            auto literal = this->evaluateMathematicalExpression(sizeNumericExpression);
 
-            arraySize = std::visit([this, node, type = valueNode->getType()] (auto &&value) {
+            arraySize = std::visit([this, node, type = literal.first] (auto &&value) {
                 if (Token::isFloatingPoint(type))
                     this->getConsole().abortEvaluation("array size must be an integer value");
                 return static_cast<u64>(value);
-            }, valueNode->getValue());
+            }, literal.second);
+
+            // Arrays of static types only ever evaluate their first entry, no matter how long they are
+            if (this->m_limits.arrayLimit != 0 && arraySize > this->m_limits.arrayLimit && !this->isStaticType(node->getType()))
+                this->getConsole().abortEvaluation(hex::format("array of %llu entries exceeds the array limit of %llu", arraySize, this->m_limits.arrayLimit));
 
-            if (auto typeDecl = dynamic_cast<ASTNodeTypeDecl*>(node->getType()); typeDecl != nullptr) {
-                if (auto builtinType = dynamic_cast<ASTNodeBuiltinType*>(typeDecl->getType()); builtinType != nullptr) {
+            if (auto typeDecl = nodeCast<ASTNodeTypeDecl>(node->getType()); typeDecl != nullptr) {
+                if (auto builtinType = nodeCast<ASTNodeBuiltinType>(typeDecl->getType()); builtinType != nullptr) {
                     if (builtinType->getType() == Token::ValueType::Padding) {
                         this->m_currOffset += arraySize;
                         return new PatternDataPadding(startOffset, arraySize);
@@ -628,27 +706,43 @@ namespace hex::lang {
                 }
             }
         } else {
-            u8 currByte = 0x00;
+            if (startOffset >= this->m_provider->getActualSize())
+                this->getConsole().abortEvaluation("array exceeds size of file");
+
+            // The array ends after the first null byte or at the end of the data
             u64 offset = startOffset;
+            for (auto window = this->getReadWindow(offset); !window.empty(); window = this->getReadWindow(offset)) {
+                this->throwIfCancelled();
 
-            do {
-                this->m_provider->read(offset, &currByte, sizeof(u8));
-                offset += sizeof(u8);
-                arraySize += sizeof(u8);
-            } while (currByte != 0x00 && offset < this->m_provider->getSize());
+                if (auto terminator = static_cast<const u8*>(std::memchr(window.data(), 0x00, window.size())); terminator != nullptr) {
+                    offset += (terminator - window.data()) + 1;
+                    break;
+                }
+
+                offset += window.size();
+            }
+
+            arraySize = offset - startOffset;
         }
 
         std::vector<PatternData*> entries;
         std::optional<u32> color;
+        bool staticArray = false;
+
+        // The entry type is the same for all entries, so it's only resolved once
+        auto entryTypeDecl = nodeCast<ASTNodeTypeDecl>(node->getType());
+        auto entryBuiltinType = nodeCast<ASTNodeBuiltinType>(node->getType());
+        if (entryTypeDecl == nullptr && entryBuiltinType == nullptr)
+            this->getConsole().abortEvaluation("ASTNodeVariableDecl had an invalid type. This is a bug!");
+
         for (s128 i = 0; i < arraySize; i++) {
+            this->throwIfCancelled();
+
             PatternData *entry;
-            if (auto typeDecl = dynamic_cast<ASTNodeTypeDecl*>(node->getType()); typeDecl != nullptr)
-                entry = this->evaluateType(typeDecl);
-            else if (auto builtinTypeDecl = dynamic_cast<ASTNodeBuiltinType*>(node->getType()); builtinTypeDecl != nullptr) {
-                entry = this->evaluateBuiltinType(builtinTypeDecl);
-            }
+            if (entryTypeDecl != nullptr)
+                entry = this->evaluateType(entryTypeDecl);
             else
-                this->getConsole().abortEvaluation("ASTNodeVariableDecl had an invalid type. This is a bug!");
+                entry = this->evaluateBuiltinType(entryBuiltinType);
 
             entry->setVariableName(hex::format("[%llu]", (u64)i));
             entry->setEndian(this->getCurrentEndian());
@@ -661,14 +755,31 @@ namespace hex::lang {
 
             if (this->m_currOffset > this->m_provider->getActualSize())
                 this->getConsole().abortEvaluation("array exceeds size of file");
+
+            // Entries of types with a static layout only differ in their offset, so the first one is enough to represent all of them
+            if (i == 0 && node->getSize() != nullptr && dynamic_cast<PatternDataCharacter*>(entry) == nullptr && entry->getSize() != 0 && this->isStaticType(node->getType())) {
+                if (arraySize > (this->m_provider->getActualSize() - startOffset) / entry->getSize())
+                    this->getConsole().abortEvaluation("array exceeds size of file");
+
+                this->m_currOffset = startOffset + arraySize * entry->getSize();
+                staticArray = true;
+                break;
+            }
         }
 
         PatternData *pattern;
-        if (entries.empty()) {
+        if (staticArray) {
+            pattern = new PatternDataStaticArray(startOffset, arraySize, entries[0], color.value_or(0));
+        }
+        else if (entries.empty()) {
             pattern = new PatternDataPadding(startOffset, 0);
         }
-        else if (dynamic_cast<PatternDataCharacter*>(entries[0]))
+        else if (dynamic_cast<PatternDataCharacter*>(entries[0])) {
             pattern = new PatternDataString(startOffset, (this->m_currOffset - startOffset), color.value_or(0));
+
+            for (auto &entry : entries)
+                delete entry;
+        }
         else {
             if (node->getSize() == nullptr)
                 this->getConsole().abortEvaluation("no bounds provided for array");
@@ -682,15 +793,13 @@ namespace hex::lang {
 
     PatternData* Evaluator::evaluatePointer(ASTNodePointerVariableDecl *node) {
         s128 pointerOffset;
-        if (auto offset = dynamic_cast<ASTNodeNumericExpression*>(node->getPlacementOffset()); offset != nullptr) {
-            auto valueNode = evaluateMathematicalExpression(offset);
-            SCOPE_EXIT( delete valueNode; );
-
-            pointerOffset = std::visit([this, node, type = valueNode->getType()] (auto &&value) {
+        if (auto offset = nodeCast<ASTNodeNumericExpression>(node->getPlacementOffset()); offset != nullptr) {
+            auto literal = this->evaluateMathematicalExpression(offset);
+            pointerOffset = std::visit([this, node, type = literal.first] (auto &&value) {
                 if (Token::isFloatingPoint(type))
                     this->getConsole().abortEvaluation("pointer offset must be an integer value");
                 return static_cast<s128>(value);
-            }, valueNode->getValue());
+            }, literal.second);
             this->m_currOffset = pointerOffset;
         } else {
             pointerOffset = this->m_currOffset;
@@ -698,11 +807,11 @@ namespace hex::lang {
 
         PatternData *sizeType;
 
-        auto underlyingType = dynamic_cast<ASTNodeTypeDecl*>(node->getSizeType());
+        auto underlyingType = nodeCast<ASTNodeTypeDecl>(node->getSizeType());
         if (underlyingType == nullptr)
             this->getConsole().abortEvaluation("underlying type is not ASTNodeTypeDecl. This is a bug");
 
-        if (auto builtinTypeNode = dynamic_cast<ASTNodeBuiltinType*>(underlyingType->getType()); builtinTypeNode != nullptr) {
+        if (auto builtinTypeNode = nodeCast<ASTNodeBuiltinType>(underlyingType->getType()); builtinTypeNode != nullptr) {
             sizeType = evaluateBuiltinType(builtinTypeNode);
         } else
             this->getConsole().abortEvaluation("pointer size is not a builtin type");
@@ -710,7 +819,7 @@ namespace hex::lang {
         size_t pointerSize = sizeType->getSize();
 
         u128 pointedAtOffset = 0;
-        this->m_provider->read(pointerOffset, &pointedAtOffset, pointerSize);
+        this->readData(pointerOffset, &pointedAtOffset, pointerSize);
         this->m_currOffset = hex::changeEndianess(pointedAtOffset, pointerSize, underlyingType->getEndian().value_or(this->m_defaultDataEndian));
 
         delete sizeType;
@@ -720,9 +829,9 @@ namespace hex::lang {
             this->getConsole().abortEvaluation("pointer points past the end of the data");
 
         PatternData *pointedAt;
-        if (auto typeDecl = dynamic_cast<ASTNodeTypeDecl*>(node->getType()); typeDecl != nullptr)
+        if (auto typeDecl = nodeCast<ASTNodeTypeDecl>(node->getType()); typeDecl != nullptr)
             pointedAt = this->evaluateType(typeDecl);
-        else if (auto builtinTypeDecl = dynamic_cast<ASTNodeBuiltinType*>(node->getType()); builtinTypeDecl != nullptr)
+        else if (auto builtinTypeDecl = nodeCast<ASTNodeBuiltinType>(node->getType()); builtinTypeDecl != nullptr)
             pointedAt = this->evaluateBuiltinType(builtinTypeDecl);
         else
             this->getConsole().abortEvaluation("ASTNodeVariableDecl had an invalid type. This is a bug!");
@@ -737,40 +846,489 @@ namespace hex::lang {
         return this->evaluateAttributes(node, pattern);
     }
 
-    std::optional<std::vector<PatternData*>> Evaluator::evaluate(const std::vector<ASTNode *> &ast) {
+    PatternData* Evaluator::evaluatePlacement(ASTNode *node) {
+        this->m_endianStack.push_back(this->m_defaultDataEndian);
+        SCOPE_EXIT( this->m_endianStack.clear(); );
+
+        switch (node->getKind()) {
+            case ASTNode::Kind::VariableDecl:
+                return this->evaluateVariable(static_cast<ASTNodeVariableDecl*>(node));
+            case ASTNode::Kind::ArrayVariableDecl:
+                return this->evaluateArray(static_cast<ASTNodeArrayVariableDecl*>(node));
+            case ASTNode::Kind::PointerVariableDecl:
+                return this->evaluatePointer(static_cast<ASTNodePointerVariableDecl*>(node));
+            default:
+                this->getConsole().abortEvaluation("invalid placement");
+        }
+    }
+
+    bool Evaluator::isConstantExpression(ASTNode *node) {
+        if (nodeCast<ASTNodeIntegerLiteral>(node) != nullptr || nodeCast<ASTNodeScopeResolution>(node) != nullptr)
+            return true;
+        else if (auto numericExpression = nodeCast<ASTNodeNumericExpression>(node); numericExpression != nullptr)
+            return numericExpression->getConstantValue().has_value() || (isConstantExpression(numericExpression->getLeftOperand()) && isConstantExpression(numericExpression->getRightOperand()));
+        else if (auto ternaryExpression = nodeCast<ASTNodeTernaryExpression>(node); ternaryExpression != nullptr)
+            return isConstantExpression(ternaryExpression->getFirstOperand()) && isConstantExpression(ternaryExpression->getSecondOperand()) && isConstantExpression(ternaryExpression->getThirdOperand());
+        else
+            return false;
+    }
+
+    bool Evaluator::isStaticType(ASTNode *type) {
+        auto isStaticMember = [](ASTNode *member) {
+            if (auto variableDeclNode = nodeCast<ASTNodeVariableDecl>(member); variableDeclNode != nullptr)
+                return variableDeclNode->getPlacementOffset() == nullptr && isStaticType(variableDeclNode->getType());
+            else if (auto arrayDeclNode = nodeCast<ASTNodeArrayVariableDecl>(member); arrayDeclNode != nullptr)
+                return arrayDeclNode->getPlacementOffset() == nullptr && arrayDeclNode->getSize() != nullptr && isConstantExpression(arrayDeclNode->getSize()) && isStaticType(arrayDeclNode->getType());
+            else
+                return false;
+        };
+
+        // Empty aggregates don't count, arrays of them have no entry size to be laid out by
+        if (nodeCast<ASTNodeBuiltinType>(type) != nullptr)
+            return true;
+        else if (auto typeDeclNode = nodeCast<ASTNodeTypeDecl>(type); typeDeclNode != nullptr) {
+            if (auto staticLayout = typeDeclNode->hasStaticLayout(); staticLayout.has_value())
+                return *staticLayout;
+            else
+                return isStaticType(typeDeclNode->getType());
+        } else if (auto structNode = nodeCast<ASTNodeStruct>(type); structNode != nullptr)
+            return !structNode->getMembers().empty() && std::all_of(structNode->getMembers().begin(), structNode->getMembers().end(), isStaticMember);
+        else if (auto unionNode = nodeCast<ASTNodeUnion>(type); unionNode != nullptr)
+            return !unionNode->getMembers().empty() && std::all_of(unionNode->getMembers().begin(), unionNode->getMembers().end(), isStaticMember);
+        else if (auto enumNode = nodeCast<ASTNodeEnum>(type); enumNode != nullptr)
+            return std::all_of(enumNode->getEntries().begin(), enumNode->getEntries().end(), [](const auto &entry) { return isConstantExpression(entry.second); });
+        else if (auto bitfieldNode = nodeCast<ASTNodeBitfield>(type); bitfieldNode != nullptr)
+            return !bitfieldNode->getEntries().empty() && std::all_of(bitfieldNode->getEntries().begin(), bitfieldNode->getEntries().end(), [](const auto &entry) { return isConstantExpression(entry.second); });
+        else
+            return false;
+    }
+
+    bool Evaluator::expressionDependsOnGlobals(ASTNode *node, const std::unordered_set<std::string_view> &locals) {
+        // Names passed as strings, like the ones of sizeof("header.size"), get looked up just like rvalues
+        auto isLocalName = [&locals](std::string_view path) {
+            return locals.contains(path.substr(0, path.find('.')));
+        };
+        auto isName = [](std::string_view string) {
+            return !string.empty() && std::all_of(string.begin(), string.end(), [](char c) { return std::isalnum(u8(c)) || c == '_' || c == '.'; });
+        };
+
+        switch (node->getKind()) {
+            case ASTNode::Kind::IntegerLiteral:
+            case ASTNode::Kind::ScopeResolution:
+                return false;
+            case ASTNode::Kind::NumericExpression: {
+                auto numericExpression = static_cast<ASTNodeNumericExpression*>(node);
+                return expressionDependsOnGlobals(numericExpression->getLeftOperand(), locals) || expressionDependsOnGlobals(numericExpression->getRightOperand(), locals);
+            }
+            case ASTNode::Kind::TernaryExpression: {
+                auto ternaryExpression = static_cast<ASTNodeTernaryExpression*>(node);
+                return expressionDependsOnGlobals(ternaryExpression->getFirstOperand(), locals)
+                    || expressionDependsOnGlobals(ternaryExpression->getSecondOperand(), locals)
+                    || expressionDependsOnGlobals(ternaryExpression->getThirdOperand(), locals);
+            }
+            case ASTNode::Kind::RValue: {
+                auto &path = static_cast<ASTNodeRValue*>(node)->getPath();
+                return !path.empty() && path[0] != "$" && !locals.contains(path[0]);
+            }
+            case ASTNode::Kind::FunctionCall:
+                return std::any_of(static_cast<ASTNodeFunctionCall*>(node)->getParams().begin(), static_cast<ASTNodeFunctionCall*>(node)->getParams().end(), [&](ASTNode *param) {
+                    if (auto stringLiteral = nodeCast<ASTNodeStringLiteral>(param); stringLiteral != nullptr)
+                        return isName(stringLiteral->getString()) && !isLocalName(stringLiteral->getString());
+                    else
+                        return expressionDependsOnGlobals(param, locals);
+                });
+            default:
+                return true;
+        }
+    }
+
+    bool Evaluator::memberDependsOnGlobals(ASTNode *member, std::unordered_set<std::string_view> &locals) {
+        // Members are looked up by the name they end up with, which the name attribute may change
+        auto addLocal = [&locals](ASTNode *member, std::string_view name) {
+            for (auto &attribute : dynamic_cast<Attributable*>(member)->getAttributes()) {
+                if (attribute->getAttribute() == "name" && attribute->getValue().has_value())
+                    name = *attribute->getValue();
+            }
+
+            locals.insert(name);
+        };
+
+        auto placementDependsOnGlobals = [&locals](ASTNode *placementOffset) {
+            return placementOffset != nullptr && expressionDependsOnGlobals(placementOffset, locals);
+        };
+
+        switch (member->getKind()) {
+            case ASTNode::Kind::VariableDecl: {
+                auto variableDeclNode = static_cast<ASTNodeVariableDecl*>(member);
+                if (placementDependsOnGlobals(variableDeclNode->getPlacementOffset()) || typeDependsOnGlobals(variableDeclNode->getType()))
+                    return true;
+
+                addLocal(member, variableDeclNode->getName());
+                return false;
+            }
+            case ASTNode::Kind::ArrayVariableDecl: {
+                auto arrayDeclNode = static_cast<ASTNodeArrayVariableDecl*>(member);
+                if (placementDependsOnGlobals(arrayDeclNode->getPlacementOffset()) || typeDependsOnGlobals(arrayDeclNode->getType()))
+                    return true;
+                if (arrayDeclNode->getSize() != nullptr && expressionDependsOnGlobals(arrayDeclNode->getSize(), locals))
+                    return true;
+
+                addLocal(member, arrayDeclNode->getName());
+                return false;
+            }
+            case ASTNode::Kind::PointerVariableDecl: {
+                auto pointerDeclNode = static_cast<ASTNodePointerVariableDecl*>(member);
+                if (placementDependsOnGlobals(pointerDeclNode->getPlacementOffset()) || typeDependsOnGlobals(pointerDeclNode->getType()) || typeDependsOnGlobals(pointerDeclNode->getSizeType()))
+                    return true;
+
+                addLocal(member, pointerDeclNode->getName());
+                return false;
+            }
+            case ASTNode::Kind::ConditionalStatement: {
+                auto conditionalNode = static_cast<ASTNodeConditionalStatement*>(member);
+                if (expressionDependsOnGlobals(conditionalNode->getCondition(), locals))
+                    return true;
+
+                // Members of a branch only exist if it's taken, so they aren't known to exist after the conditional
+                for (auto body : { &conditionalNode->getTrueBody(), &conditionalNode->getFalseBody() }) {
+                    auto bodyLocals = locals;
+                    if (std::any_of(body->begin(), body->end(), [&](ASTNode *statement) { return memberDependsOnGlobals(statement, bodyLocals); }))
+                        return true;
+                }
+
+                return false;
+            }
+            default:
+                return true;
+        }
+    }
+
+    bool Evaluator::typeDependsOnGlobals(ASTNode *type) {
+        // Every struct and union starts a scope of its own. Enum and bitfield entries are evaluated in the scope they're used in, so they can't use any names
+        auto membersDependOnGlobals = [](const std::vector<ASTNode*> &members) {
+            std::unordered_set<std::string_view> locals;
+            return std::any_of(members.begin(), members.end(), [&](ASTNode *member) { return memberDependsOnGlobals(member, locals); });
+        };
+        auto entryDependsOnGlobals = [](const auto &entry) {
+            return expressionDependsOnGlobals(entry.second, { });
+        };
+
+        if (nodeCast<ASTNodeBuiltinType>(type) != nullptr)
+            return false;
+        else if (auto typeDeclNode = nodeCast<ASTNodeTypeDecl>(type); typeDeclNode != nullptr)
+            return typeDependsOnGlobals(typeDeclNode->getType());
+        else if (auto structNode = nodeCast<ASTNodeStruct>(type); structNode != nullptr)
+            return membersDependOnGlobals(structNode->getMembers());
+        else if (auto unionNode = nodeCast<ASTNodeUnion>(type); unionNode != nullptr)
+            return membersDependOnGlobals(unionNode->getMembers());
+        else if (auto enumNode = nodeCast<ASTNodeEnum>(type); enumNode != nullptr)
+            return std::any_of(enumNode->getEntries().begin(), enumNode->getEntries().end(), entryDependsOnGlobals);
+        else if (auto bitfieldNode = nodeCast<ASTNodeBitfield>(type); bitfieldNode != nullptr)
+            return std::any_of(bitfieldNode->getEntries().begin(), bitfieldNode->getEntries().end(), entryDependsOnGlobals);
+        else
+            return true;
+    }
+
+    size_t Evaluator::findIndependentPlacements(const std::vector<ASTNode*> &ast, size_t statement) {
+        auto getPlacement = [](ASTNode *node) -> std::pair<ASTNode*, ASTNode*> {
+            switch (node->getKind()) {
+                case ASTNode::Kind::VariableDecl:
+                    return { static_cast<ASTNodeVariableDecl*>(node)->getPlacementOffset(), static_cast<ASTNodeVariableDecl*>(node)->getType() };
+                case ASTNode::Kind::ArrayVariableDecl:
+                    return { static_cast<ASTNodeArrayVariableDecl*>(node)->getPlacementOffset(), static_cast<ASTNodeArrayVariableDecl*>(node)->getType() };
+                case ASTNode::Kind::PointerVariableDecl:
+                    return { static_cast<ASTNodePointerVariableDecl*>(node)->getPlacementOffset(), static_cast<ASTNodePointerVariableDecl*>(node)->getType() };
+                default:
+                    return { nullptr, nullptr };
+            }
+        };
+
+        // Placements of static types are cheap enough that threads would only slow them down
+        size_t end = statement, expensiveCount = 0;
+        for (; end < ast.size(); end++) {
+            auto [placementOffset, type] = getPlacement(ast[end]);
+            if (placementOffset == nullptr || !isConstantExpression(placementOffset))
+                break;
+
+            std::unordered_set<std::string_view> locals;
+            if (memberDependsOnGlobals(ast[end], locals))
+                break;
+
+            if (!this->isStaticType(type))
+                expensiveCount++;
+        }
+
+        return expensiveCount >= 2 ? end : statement;
+    }
+
+    void Evaluator::evaluateIndependentPlacements(const std::vector<ASTNode*> &ast, size_t begin, size_t end, const PatternCallback &addGlobalMember) {
+        struct Result {
+            PatternData *pattern = nullptr;
+            std::exception_ptr exception;
+            std::vector<std::pair<LogConsole::Level, std::string>> log;
+            u64 endOffset = 0;
+            u32 paletteOffset = 0;
+            u64 patternCount = 0;
+            std::unordered_map<std::string, TypeProfile> profile;
+        };
+
+        const size_t count = end - begin;
+        const u32 paletteOffset = SharedData::getPatternPaletteOffset();
+
+        // Cancellation is up to the evaluators, every placement needs a result
+        const auto currentTask = this->m_task != nullptr ? this->m_task : TaskManager::getCurrentTask();
+        Task placements("Evaluating placements", currentTask != nullptr ? currentTask->getPriority() : TaskPriority::Interactive);
+
+        // Every thread allocates in an arena of its own that lives as long as the one of this evaluation
+        std::vector<MemoryArena*> arenas(TaskManager::getParallelism(placements, count), nullptr);
+        if (auto arena = MemoryArena::getCurrent(); arena != nullptr) {
+            for (auto &threadArena : arenas)
+                threadArena = &arena->createChild();
+        }
+
+        std::vector<Result> results(count);
+
+        TaskManager::parallelFor(placements, count, arenas, [&](size_t placement, MemoryArena *arena) {
+            std::optional<MemoryArena::Scope> arenaScope;
+            if (arena != nullptr)
+                arenaScope.emplace(*arena);
+
+            auto &result = results[placement];
+
+            Evaluator evaluator;
+            evaluator.m_provider = this->m_provider;
+            evaluator.m_task = this->m_task;
+            evaluator.m_defaultDataEndian = this->m_defaultDataEndian;
+            evaluator.m_types = this->m_types;
+            evaluator.m_limits = this->m_limits;
+            evaluator.m_evaluationStart = this->m_evaluationStart;
+            evaluator.m_patternCount = this->m_patternCount;
+
+            // Colors don't depend on how many patterns the placements before created, so they're the same no matter the order threads run in
+            SharedData::getPatternPaletteOffset() = (paletteOffset + placement) % std::size(PatternData::Palette);
+
+            try {
+                evaluator.throwIfCancelled();
+                result.pattern = evaluator.evaluatePlacement(ast[begin + placement]);
+            } catch (...) {
+                result.exception = std::current_exception();
+            }
+
+            result.log = evaluator.getConsole().getLog();
+            result.endOffset = evaluator.m_currOffset;
+            result.paletteOffset = SharedData::getPatternPaletteOffset();
+            result.patternCount = evaluator.m_patternCount - this->m_patternCount;
+            result.profile = std::move(evaluator.m_profile);
+        });
+
+        // The calling thread evaluated placements as well
+        SharedData::getPatternPaletteOffset() = paletteOffset;
+
+        // Results get added in the order of the statements, the first failed one ends the evaluation like it would have without threads
+        for (size_t i = 0; i < count; i++) {
+            auto &result = results[i];
+            this->getConsole().append(result.log);
+
+            for (const auto &[typeName, typeProfile] : result.profile) {
+                auto &profile = this->m_profile[typeName];
+                profile.patternCount += typeProfile.patternCount;
+                profile.bytesRead += typeProfile.bytesRead;
+                profile.time += typeProfile.time;
+            }
+
+            // Every placement was only limited on its own, together they may still exceed the limit
+            if (!result.exception) {
+                try {
+                    this->countPatterns(result.patternCount);
+                } catch (...) {
+                    delete result.pattern;
+                    result.pattern = nullptr;
+                    result.exception = std::current_exception();
+                }
+            }
+
+            if (result.exception) {
+                for (size_t j = i + 1; j < count; j++)
+                    delete results[j].pattern;
+
+                std::rethrow_exception(result.exception);
+            }
+
+            addGlobalMember(result.pattern);
+            this->m_currOffset = result.endOffset;
+            SharedData::getPatternPaletteOffset() = result.paletteOffset;
+
+            this->m_statementStates.push_back({ this->m_globalMembers.size(), this->m_currOffset, SharedData::getPatternPaletteOffset() });
+        }
+    }
+
+    std::span<const u8> Evaluator::getReadWindow(u64 offset) {
+        const auto dataSize = this->m_provider->getActualSize();
+        if (offset >= dataSize)
+            return { };
+
+        if (offset < this->m_readBufferOffset || offset >= this->m_readBufferOffset + this->m_readBuffer.size()) {
+            this->m_readBufferOffset = offset;
+            this->m_readBuffer.resize(std::min<u64>(ReadBufferSize, dataSize - offset));
+            this->m_provider->readAbsolute(offset, this->m_readBuffer.data(), this->m_readBuffer.size());
+        }
+
+        return std::span<const u8>(this->m_readBuffer).subspan(offset - this->m_readBufferOffset);
+    }
+
+    void Evaluator::readData(u64 offset, void *buffer, size_t size) {
+        if (!this->m_profileStack.empty())
+            this->m_profileStack.back()->bytesRead += size;
+
+        // Reads past the end of the data leave the buffer untouched, just like reading from the provider does
+        if (size > ReadBufferSize || offset + size > this->m_provider->getActualSize()) {
+            this->m_provider->readAbsolute(offset, buffer, size);
+            return;
+        }
+
+        auto window = this->getReadWindow(offset);
+        if (window.size() < size) {
+            this->m_readBuffer.clear();
+            window = this->getReadWindow(offset);
+        }
+
+        std::memcpy(buffer, window.data(), size);
+    }
+
+    void Evaluator::throwIfCancelled() {
+        if (this->m_task != nullptr && this->m_task->isCancelled())
+            this->getConsole().abortEvaluation("evaluation cancelled");
+
+        // Reading the clock every time would be noticeable, the time only needs to be roughly right
+        if (this->m_limits.timeLimit != 0 && (this->m_timeLimitCheck++ % 0x100) == 0) {
+            if (std::chrono::steady_clock::now() - this->m_evaluationStart > std::chrono::milliseconds(this->m_limits.timeLimit))
+                this->getConsole().abortEvaluation(hex::format("evaluation took longer than the time limit of %llu ms", this->m_limits.timeLimit));
+        }
+    }
+
+    void Evaluator::countPatterns(u64 count) {
+        this->m_patternCount += count;
+
+        if (this->m_limits.patternLimit != 0 && this->m_patternCount > this->m_limits.patternLimit)
+            this->getConsole().abortEvaluation(hex::format("more patterns created than the pattern limit of %llu", this->m_limits.patternLimit));
+    }
+
+    void Evaluator::logProfile() {
+        if (!this->m_limits.profile)
+            return;
+
+        const double evaluationTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->m_evaluationStart).count();
+        this->getConsole().log(LogConsole::Level::Info, hex::format("profile: evaluation %.3f ms", evaluationTime));
+
+        std::vector<std::pair<std::string, TypeProfile>> profile(this->m_profile.begin(), this->m_profile.end());
+        std::sort(profile.begin(), profile.end(), [](const auto &left, const auto &right) { return left.second.time > right.second.time; });
+
+        for (const auto &[typeName, typeProfile] : profile) {
+            const double milliseconds = std::chrono::duration<double, std::milli>(typeProfile.time).count();
+            this->getConsole().log(LogConsole::Level::Info, hex::format("profile: %s: %llu patterns, %llu bytes read, %.3f ms",
+                                   typeName.c_str(), typeProfile.patternCount, typeProfile.bytesRead, milliseconds));
+        }
+    }
+
+    std::optional<std::vector<PatternData*>> Evaluator::evaluate(const std::vector<ASTNode *> &ast, const std::vector<StatementState> &previousStates, const std::vector<PatternData*> &keptPatterns) {
 
         this->m_globalMembers.clear();
         this->m_currMembers.clear();
+        this->m_globalMemberLookup.clear();
+        this->m_currMemberLookup.clear();
         this->m_types.clear();
         this->m_endianStack.clear();
-        this->m_currOffset = 0;
+        this->m_statementStates = previousStates;
+        this->m_readBuffer.clear();
+        this->m_searchCaches.clear();
+        this->m_patternCount = 0;
+        this->m_recursionDepth = 0;
+        this->m_timeLimitCheck = 0;
+        this->m_evaluationStart = std::chrono::steady_clock::now();
+        this->m_profile.clear();
+        this->m_profileStack.clear();
+        this->m_currOffset = previousStates.empty() ? 0 : previousStates.back().offset;
+        SharedData::getPatternPaletteOffset() = previousStates.empty() ? 0 : previousStates.back().paletteOffset;
+
+        // Patterns handed to the callback belong to it, they're only kept here so later variables can still reference them
+        PatternCallback addGlobalMember = [this](PatternData *pattern) {
+            this->m_globalMembers.push_back(pattern);
+            this->m_globalMemberLookup.try_emplace(pattern->getVariableName(), pattern);
+
+            if (this->m_patternCallback)
+                this->m_patternCallback(pattern);
+        };
+
+        for (auto &pattern : keptPatterns) {
+            this->m_globalMembers.push_back(pattern);
+            this->m_globalMemberLookup.try_emplace(pattern->getVariableName(), pattern);
+        }
 
         try {
-            for (const auto& node : ast) {
+            for (size_t i = 0; i < ast.size(); i++) {
+                auto node = ast[i];
+
+                // Skipped statements only need to declare their types again, the new ones are part of the new AST
+                if (i < previousStates.size()) {
+                    if (auto typeDeclNode = nodeCast<ASTNodeTypeDecl>(node); typeDeclNode != nullptr)
+                        this->m_types[typeDeclNode->getName().data()] = typeDeclNode->getType();
+                    continue;
+                }
+
+                this->throwIfCancelled();
+
+                if (auto end = this->findIndependentPlacements(ast, i); end != i) {
+                    this->evaluateIndependentPlacements(ast, i, end, addGlobalMember);
+                    i = end - 1;
+                    continue;
+                }
+
                 this->m_endianStack.push_back(this->m_defaultDataEndian);
 
-                if (auto variableDeclNode = dynamic_cast<ASTNodeVariableDecl*>(node); variableDeclNode != nullptr) {
-                    this->m_globalMembers.push_back(this->evaluateVariable(variableDeclNode));
-                } else if (auto arrayDeclNode = dynamic_cast<ASTNodeArrayVariableDecl*>(node); arrayDeclNode != nullptr) {
-                    this->m_globalMembers.push_back(this->evaluateArray(arrayDeclNode));
-                } else if (auto pointerDeclNode = dynamic_cast<ASTNodePointerVariableDecl*>(node); pointerDeclNode != nullptr) {
-                    this->m_globalMembers.push_back(this->evaluatePointer(pointerDeclNode));
-                } else if (auto typeDeclNode = dynamic_cast<ASTNodeTypeDecl*>(node); typeDeclNode != nullptr) {
-                    this->m_types[typeDeclNode->getName().data()] = typeDeclNode->getType();
-                } else if (auto functionCallNode = dynamic_cast<ASTNodeFunctionCall*>(node); functionCallNode != nullptr) {
-                    auto result = this->evaluateFunctionCall(functionCallNode);
-                    delete result;
+                switch (node->getKind()) {
+                    case ASTNode::Kind::VariableDecl:
+                    case ASTNode::Kind::ArrayVariableDecl:
+                    case ASTNode::Kind::PointerVariableDecl:
+                        addGlobalMember(this->evaluatePlacement(node));
+                        break;
+                    case ASTNode::Kind::TypeDecl: {
+                        auto typeDeclNode = static_cast<ASTNodeTypeDecl*>(node);
+                        this->m_types[typeDeclNode->getName().data()] = typeDeclNode->getType();
+                        break;
+                    }
+                    case ASTNode::Kind::FunctionCall: {
+                        auto result = this->evaluateFunctionCall(static_cast<ASTNodeFunctionCall*>(node));
+                        delete result;
+                        break;
+                    }
+                    default:
+                        break;
                 }
 
                 this->m_endianStack.clear();
+
+                this->m_statementStates.push_back({ this->m_globalMembers.size(), this->m_currOffset, SharedData::getPatternPaletteOffset() });
             }
         } catch (LogConsole::EvaluateError &e) {
             this->getConsole().log(LogConsole::Level::Error, e);
+            this->logProfile();
+
+            if (!this->m_patternCallback) {
+                for (auto pattern = this->m_globalMembers.begin() + keptPatterns.size(); pattern != this->m_globalMembers.end(); pattern++)
+                    delete *pattern;
+            }
+            this->m_globalMembers.clear();
+            this->m_globalMemberLookup.clear();
 
             return { };
         }
 
-        return this->m_globalMembers;
+        this->logProfile();
+
+        if (this->m_patternCallback)
+            return std::vector<PatternData*>{ };
+
+        return std::vector<PatternData*>(this->m_globalMembers.begin() + keptPatterns.size(), this->m_globalMembers.end());
     }
 
 }
\ No newline at end of file
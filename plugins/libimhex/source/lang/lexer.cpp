@@ -1,6 +1,8 @@
 #include <hex/lang/lexer.hpp>
 
 #include <algorithm>
+#include <array>
+#include <charconv>
 #include <functional>
 #include <optional>
 #include <vector>
@@ -12,49 +14,149 @@ namespace hex::lang {
 
     Lexer::Lexer() { }
 
-    std::string matchTillInvalid(const char* characters, std::function<bool(char)> predicate) {
-        std::string ret;
+    namespace {
 
-        while (*characters != 0x00) {
-            ret += *characters;
-            characters++;
+        enum CharacterClass : u8 {
+            Whitespace      = 1 << 0,
+            IdentifierStart = 1 << 1,
+            IdentifierPart  = 1 << 2,
+            NumberStart     = 1 << 3,
+            NumberPart      = 1 << 4,
+            HexDigit        = 1 << 5
+        };
 
-            if (!predicate(*characters))
-                break;
+        constexpr std::array<u8, 256> CharacterClasses = [] {
+            std::array<u8, 256> classes = { };
+
+            auto add = [&](std::string_view characters, u8 characterClass) {
+                for (char c : characters)
+                    classes[static_cast<u8>(c)] |= characterClass;
+            };
+
+            constexpr std::string_view Letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+            constexpr std::string_view Digits = "0123456789";
+
+            add(" \t\n\v\f\r", Whitespace);
+            add(Letters, IdentifierStart | IdentifierPart);
+            add(Digits, IdentifierPart | NumberStart | NumberPart | HexDigit);
+            add("_", IdentifierPart);
+            add("ABCDEFabcdef.xUL", NumberPart);
+            add("ABCDEFabcdef", HexDigit);
+
+            return classes;
+        }();
+
+        constexpr bool hasClass(char c, u8 characterClass) {
+            return (CharacterClasses[static_cast<u8>(c)] & characterClass) != 0;
+        }
+
+        struct Keyword {
+            std::string_view name;
+            Token::Type type;
+            u32 value;
+        };
+
+        constexpr std::array Keywords = {
+            Keyword{ "struct",   Token::Type::Keyword,   u32(Token::Keyword::Struct) },
+            Keyword{ "union",    Token::Type::Keyword,   u32(Token::Keyword::Union) },
+            Keyword{ "using",    Token::Type::Keyword,   u32(Token::Keyword::Using) },
+            Keyword{ "enum",     Token::Type::Keyword,   u32(Token::Keyword::Enum) },
+            Keyword{ "bitfield", Token::Type::Keyword,   u32(Token::Keyword::Bitfield) },
+            Keyword{ "be",       Token::Type::Keyword,   u32(Token::Keyword::BigEndian) },
+            Keyword{ "le",       Token::Type::Keyword,   u32(Token::Keyword::LittleEndian) },
+            Keyword{ "if",       Token::Type::Keyword,   u32(Token::Keyword::If) },
+            Keyword{ "else",     Token::Type::Keyword,   u32(Token::Keyword::Else) },
+            Keyword{ "false",    Token::Type::Integer,   0 },
+            Keyword{ "true",     Token::Type::Integer,   1 },
+
+            Keyword{ "u8",       Token::Type::ValueType, u32(Token::ValueType::Unsigned8Bit) },
+            Keyword{ "s8",       Token::Type::ValueType, u32(Token::ValueType::Signed8Bit) },
+            Keyword{ "u16",      Token::Type::ValueType, u32(Token::ValueType::Unsigned16Bit) },
+            Keyword{ "s16",      Token::Type::ValueType, u32(Token::ValueType::Signed16Bit) },
+            Keyword{ "u32",      Token::Type::ValueType, u32(Token::ValueType::Unsigned32Bit) },
+            Keyword{ "s32",      Token::Type::ValueType, u32(Token::ValueType::Signed32Bit) },
+            Keyword{ "u64",      Token::Type::ValueType, u32(Token::ValueType::Unsigned64Bit) },
+            Keyword{ "s64",      Token::Type::ValueType, u32(Token::ValueType::Signed64Bit) },
+            Keyword{ "u128",     Token::Type::ValueType, u32(Token::ValueType::Unsigned128Bit) },
+            Keyword{ "s128",     Token::Type::ValueType, u32(Token::ValueType::Signed128Bit) },
+            Keyword{ "float",    Token::Type::ValueType, u32(Token::ValueType::Float) },
+            Keyword{ "double",   Token::Type::ValueType, u32(Token::ValueType::Double) },
+            Keyword{ "char",     Token::Type::ValueType, u32(Token::ValueType::Character) },
+            Keyword{ "bool",     Token::Type::ValueType, u32(Token::ValueType::Boolean) },
+            Keyword{ "padding",  Token::Type::ValueType, u32(Token::ValueType::Padding) },
+        };
+
+        // Perfect hash of the keywords, every keyword gets a slot of its own so identifiers are compared against one keyword at most
+        constexpr size_t keywordHash(std::string_view identifier) {
+            return (identifier.length() + u8(identifier.back()) * 2 + u8(identifier.front()) * 27) % 64;
+        }
+
+        constexpr std::array<s8, 64> KeywordTable = [] {
+            std::array<s8, 64> table = { };
+            table.fill(-1);
+
+            for (size_t i = 0; i < Keywords.size(); i++) {
+                auto &slot = table[keywordHash(Keywords[i].name)];
+
+                if (slot != -1)
+                    throw "keyword hash collision";
+
+                slot = i;
+            }
+
+            return table;
+        }();
+
+        const Keyword* findKeyword(std::string_view identifier) {
+            auto index = KeywordTable[keywordHash(identifier)];
+
+            if (index == -1 || Keywords[index].name != identifier)
+                return nullptr;
+            else
+                return &Keywords[index];
         }
 
-        return ret;
+    }
+
+    std::string_view matchTillInvalid(std::string_view string, u8 characterClass) {
+        size_t length = 1;
+
+        while (length < string.length() && hasClass(string[length], characterClass))
+            length++;
+
+        return string.substr(0, length);
     }
 
     size_t getIntegerLiteralLength(std::string_view string) {
-        return string.find_first_not_of("0123456789ABCDEFabcdef.xUL");
+        return matchTillInvalid(string, NumberPart).length();
     }
 
-    std::optional<Token::IntegerLiteral> parseIntegerLiteral(std::string_view string) {
+    bool containsOnly(std::string_view string, u8 characterClass) {
+        return std::all_of(string.begin(), string.end(), [=](char c) { return hasClass(c, characterClass); });
+    }
+
+    std::optional<Token::IntegerLiteral> parseIntegerLiteral(std::string_view numberData) {
         Token::ValueType type = Token::ValueType::Any;
         Token::IntegerLiteral result;
 
         u8 base;
 
-        auto endPos = getIntegerLiteralLength(string);
-        std::string_view numberData = string.substr(0, endPos);
+        const bool prefixed = numberData.starts_with("0x") || numberData.starts_with("0b");
 
-        if (numberData.ends_with('U')) {
-            type = Token::ValueType::Unsigned32Bit;
+        // Suffixes are U, UL, ULL, L and LL for integers, F and D for decimal floating point numbers
+        size_t longCount = 0;
+        while (longCount < 2 && numberData.ends_with('L')) {
             numberData.remove_suffix(1);
-        } else if (numberData.ends_with("UL")) {
-            type = Token::ValueType::Unsigned64Bit;
-            numberData.remove_suffix(2);
-        } else if (numberData.ends_with("ULL")) {
-            type = Token::ValueType::Unsigned128Bit;
-            numberData.remove_suffix(3);
-        } else if (numberData.ends_with("L")) {
-            type = Token::ValueType::Signed64Bit;
+            longCount++;
+        }
+
+        if (numberData.ends_with('U')) {
             numberData.remove_suffix(1);
-        } else if (numberData.ends_with("LL")) {
-            type = Token::ValueType::Signed128Bit;
-            numberData.remove_suffix(2);
-        } else if (!numberData.starts_with("0x") && !numberData.starts_with("0b")) {
+            constexpr std::array UnsignedTypes = { Token::ValueType::Unsigned32Bit, Token::ValueType::Unsigned64Bit, Token::ValueType::Unsigned128Bit };
+            type = UnsignedTypes[longCount];
+        } else if (longCount > 0) {
+            type = longCount == 1 ? Token::ValueType::Signed64Bit : Token::ValueType::Signed128Bit;
+        } else if (!prefixed) {
             if (numberData.ends_with('F')) {
                 type = Token::ValueType::Float;
                 numberData.remove_suffix(1);
@@ -71,7 +173,7 @@ namespace hex::lang {
             if (Token::isFloatingPoint(type))
                 return { };
 
-            if (numberData.find_first_not_of("0123456789ABCDEFabcdef") != std::string_view::npos)
+            if (!containsOnly(numberData, HexDigit))
                 return { };
         } else if (numberData.starts_with("0b")) {
             numberData = numberData.substr(2);
@@ -92,7 +194,7 @@ namespace hex::lang {
 
             if (numberData.ends_with('.'))
                 return { };
-        } else if (isdigit(numberData[0])) {
+        } else if (!numberData.empty() && hasClass(numberData[0], NumberStart)) {
             base = 10;
 
             if (numberData.find_first_not_of("0123456789") != std::string_view::npos)
@@ -111,7 +213,7 @@ namespace hex::lang {
             for (const char& c : numberData) {
                 integer *= base;
 
-                if (isdigit(c))
+                if (c >= '0' && c <= '9')
                     integer += (c - '0');
                 else if (c >= 'A' && c <= 'F')
                     integer += 10 + (c - 'A');
@@ -130,7 +232,8 @@ namespace hex::lang {
                 default: return { };
             }
         } else if (Token::isFloatingPoint(type)) {
-            double floatingPoint = strtod(numberData.data(), nullptr);
+            double floatingPoint = 0;
+            std::from_chars(numberData.data(), numberData.data() + numberData.length(), floatingPoint);
 
             switch (type) {
                 case Token::ValueType::Float:  return {{ type, float(floatingPoint) }};
@@ -170,7 +273,7 @@ namespace hex::lang {
 
             // Hexadecimal number
             if (string[1] == 'x') {
-                if (string.length() != 4)
+                if (string.length() < 4)
                     return { };
 
                 if (!isxdigit(string[2]) || !isxdigit(string[3]))
@@ -181,7 +284,7 @@ namespace hex::lang {
 
             // Octal number
             if (string[1] == 'o') {
-                if (string.length() != 5)
+                if (string.length() < 5)
                     return { };
 
                 if (string[2] < '0' || string[2] > '7' || string[3] < '0' || string[3] > '7' || string[4] < '0' || string[4] > '7')
@@ -195,7 +298,7 @@ namespace hex::lang {
     }
 
     std::optional<std::pair<std::string, size_t>> getStringLiteral(std::string_view string) {
-        if (!string.starts_with('\"'))
+        if (!string.starts_with('\"') || string.length() < 2)
             return { };
 
         size_t size = 1;
@@ -220,10 +323,7 @@ namespace hex::lang {
     }
 
     std::optional<std::pair<char, size_t>> getCharacterLiteral(std::string_view string) {
-        if (string.empty())
-            return { };
-
-        if (!string[0] != '\'')
+        if (string.empty() || string[0] != '\'')
             return { };
 
 
@@ -234,7 +334,7 @@ namespace hex::lang {
 
         auto &[c, charSize] = character.value();
 
-        if (string.length() >= charSize || string[charSize] != '\'')
+        if (string.length() <= charSize + 1 || string[charSize + 1] != '\'')
             return { };
 
         return {{ c, charSize + 2 }};
@@ -246,223 +346,165 @@ namespace hex::lang {
 
         u32 lineNumber = 1;
 
+        const std::string_view view = code;
+
         try {
 
-            while (offset < code.length()) {
-                const char& c = code[offset];
+            while (offset < view.length()) {
+                const char c = view[offset];
+                const char next = offset + 1 < view.length() ? view[offset + 1] : 0x00;
 
                 if (c == 0x00)
                     break;
 
-                if (std::isblank(c) || std::isspace(c)) {
-                    if (code[offset] == '\n') lineNumber++;
-                    offset += 1;
-                } else if (c == ';') {
-                    tokens.emplace_back(TOKEN(Separator, EndOfExpression));
-                    offset += 1;
-                } else if (c == '(') {
-                    tokens.emplace_back(TOKEN(Separator, RoundBracketOpen));
+                if (hasClass(c, Whitespace)) {
+                    if (c == '\n') lineNumber++;
                     offset += 1;
-                } else if (c == ')') {
-                    tokens.emplace_back(TOKEN(Separator, RoundBracketClose));
-                    offset += 1;
-                } else if (c == '{') {
-                    tokens.emplace_back(TOKEN(Separator, CurlyBracketOpen));
-                    offset += 1;
-                } else if (c == '}') {
-                    tokens.emplace_back(TOKEN(Separator, CurlyBracketClose));
-                    offset += 1;
-                } else if (c == '[') {
-                    tokens.emplace_back(TOKEN(Separator, SquareBracketOpen));
-                    offset += 1;
-                } else if (c == ']') {
-                    tokens.emplace_back(TOKEN(Separator, SquareBracketClose));
-                    offset += 1;
-                } else if (c == ',') {
-                    tokens.emplace_back(TOKEN(Separator, Comma));
-                    offset += 1;
-                } else if (c == '.') {
-                    tokens.emplace_back(TOKEN(Separator, Dot));
-                    offset += 1;
-                } else if (c == '@') {
-                    tokens.emplace_back(TOKEN(Operator, AtDeclaration));
-                    offset += 1;
-                } else if (code.substr(offset, 2) == "==") {
-                    tokens.emplace_back(TOKEN(Operator, BoolEquals));
-                    offset += 2;
-                } else if (code.substr(offset, 2) == "!=") {
-                    tokens.emplace_back(TOKEN(Operator, BoolNotEquals));
-                    offset += 2;
-                } else if (code.substr(offset, 2) == ">=") {
-                    tokens.emplace_back(TOKEN(Operator, BoolGreaterThanOrEquals));
-                    offset += 2;
-                } else if (code.substr(offset, 2) == "<=") {
-                    tokens.emplace_back(TOKEN(Operator, BoolLessThanOrEquals));
-                    offset += 2;
-                } else if (code.substr(offset, 2) == "&&") {
-                    tokens.emplace_back(TOKEN(Operator, BoolAnd));
-                    offset += 2;
-                } else if (code.substr(offset, 2) == "||") {
-                    tokens.emplace_back(TOKEN(Operator, BoolOr));
-                    offset += 2;
-                } else if (code.substr(offset, 2) == "^^") {
-                    tokens.emplace_back(TOKEN(Operator, BoolXor));
-                    offset += 2;
-                } else if (c == '=') {
-                    tokens.emplace_back(TOKEN(Operator, Assignment));
-                    offset += 1;
-                } else if (code.substr(offset, 2) == "::") {
-                    tokens.emplace_back(TOKEN(Separator, ScopeResolution));
-                    offset += 2;
-                } else if (c == ':') {
-                    tokens.emplace_back(TOKEN(Operator, Inherit));
-                    offset += 1;
-                } else if (c == '+') {
-                    tokens.emplace_back(TOKEN(Operator, Plus));
-                    offset += 1;
-                } else if (c == '-') {
-                    tokens.emplace_back(TOKEN(Operator, Minus));
-                    offset += 1;
-                } else if (c == '*') {
-                    tokens.emplace_back(TOKEN(Operator, Star));
-                    offset += 1;
-                } else if (c == '/') {
-                    tokens.emplace_back(TOKEN(Operator, Slash));
-                    offset += 1;
-                } else if (c == '%') {
-                    tokens.emplace_back(TOKEN(Operator, Percent));
-                    offset += 1;
-                } else if (code.substr(offset, 2) == "<<") {
-                    tokens.emplace_back(TOKEN(Operator, ShiftLeft));
-                    offset += 2;
-                } else if (code.substr(offset, 2) == ">>") {
-                    tokens.emplace_back(TOKEN(Operator, ShiftRight));
-                    offset += 2;
-                } else if (c == '>') {
-                    tokens.emplace_back(TOKEN(Operator, BoolGreaterThan));
-                    offset += 1;
-                } else if (c == '<') {
-                    tokens.emplace_back(TOKEN(Operator, BoolLessThan));
-                    offset += 1;
-                } else if (c == '!') {
-                    tokens.emplace_back(TOKEN(Operator, BoolNot));
-                    offset += 1;
-                } else if (c == '|') {
-                    tokens.emplace_back(TOKEN(Operator, BitOr));
-                    offset += 1;
-                } else if (c == '&') {
-                    tokens.emplace_back(TOKEN(Operator, BitAnd));
-                    offset += 1;
-                } else if (c == '^') {
-                    tokens.emplace_back(TOKEN(Operator, BitXor));
-                    offset += 1;
-                } else if (c == '~') {
-                    tokens.emplace_back(TOKEN(Operator, BitNot));
-                    offset += 1;
-                } else if (c == '?') {
-                    tokens.emplace_back(TOKEN(Operator, TernaryConditional));
-                    offset += 1;
-                } else if (c == '$') {
-                    tokens.emplace_back(TOKEN(Operator, Dollar));
-                    offset += 1;
-                } else if (c == '\'') {
-                    auto character = getCharacterLiteral(code.substr(offset));
-
-                    if (!character.has_value())
-                        throwLexerError("invalid character literal", lineNumber);
-
-                    auto [c, charSize] = character.value();
-
-                    tokens.emplace_back(VALUE_TOKEN(Integer, Token::IntegerLiteral(Token::ValueType::Character, c) ));
-                    offset += charSize;
-                } else if (c == '\"') {
-                    auto string = getStringLiteral(code.substr(offset));
-
-                    if (!string.has_value())
-                        throwLexerError("invalid string literal", lineNumber);
-
-                    auto [s, stringSize] = string.value();
-
-                    tokens.emplace_back(VALUE_TOKEN(String, s));
-                    offset += stringSize;
-                } else if (std::isalpha(c)) {
-                    std::string identifier = matchTillInvalid(&code[offset], [](char c) -> bool { return std::isalnum(c) || c == '_'; });
-
-                    // Check for reserved keywords
-
-                    if (identifier == "struct")
-                        tokens.emplace_back(TOKEN(Keyword, Struct));
-                    else if (identifier == "union")
-                        tokens.emplace_back(TOKEN(Keyword, Union));
-                    else if (identifier == "using")
-                        tokens.emplace_back(TOKEN(Keyword, Using));
-                    else if (identifier == "enum")
-                        tokens.emplace_back(TOKEN(Keyword, Enum));
-                    else if (identifier == "bitfield")
-                        tokens.emplace_back(TOKEN(Keyword, Bitfield));
-                    else if (identifier == "be")
-                        tokens.emplace_back(TOKEN(Keyword, BigEndian));
-                    else if (identifier == "le")
-                        tokens.emplace_back(TOKEN(Keyword, LittleEndian));
-                    else if (identifier == "if")
-                        tokens.emplace_back(TOKEN(Keyword, If));
-                    else if (identifier == "else")
-                        tokens.emplace_back(TOKEN(Keyword, Else));
-                    else if (identifier == "false")
-                        tokens.emplace_back(VALUE_TOKEN(Integer, Token::IntegerLiteral(Token::ValueType::Boolean, s32(0))));
-                    else if (identifier == "true")
-                        tokens.emplace_back(VALUE_TOKEN(Integer, Token::IntegerLiteral(Token::ValueType::Boolean, s32(1))));
-
-                        // Check for built-in types
-                    else if (identifier == "u8")
-                        tokens.emplace_back(TOKEN(ValueType, Unsigned8Bit));
-                    else if (identifier == "s8")
-                        tokens.emplace_back(TOKEN(ValueType, Signed8Bit));
-                    else if (identifier == "u16")
-                        tokens.emplace_back(TOKEN(ValueType, Unsigned16Bit));
-                    else if (identifier == "s16")
-                        tokens.emplace_back(TOKEN(ValueType, Signed16Bit));
-                    else if (identifier == "u32")
-                        tokens.emplace_back(TOKEN(ValueType, Unsigned32Bit));
-                    else if (identifier == "s32")
-                        tokens.emplace_back(TOKEN(ValueType, Signed32Bit));
-                    else if (identifier == "u64")
-                        tokens.emplace_back(TOKEN(ValueType, Unsigned64Bit));
-                    else if (identifier == "s64")
-                        tokens.emplace_back(TOKEN(ValueType, Signed64Bit));
-                    else if (identifier == "u128")
-                        tokens.emplace_back(TOKEN(ValueType, Unsigned128Bit));
-                    else if (identifier == "s128")
-                        tokens.emplace_back(TOKEN(ValueType, Signed128Bit));
-                    else if (identifier == "float")
-                        tokens.emplace_back(TOKEN(ValueType, Float));
-                    else if (identifier == "double")
-                        tokens.emplace_back(TOKEN(ValueType, Double));
-                    else if (identifier == "char")
-                        tokens.emplace_back(TOKEN(ValueType, Character));
-                    else if (identifier == "bool")
-                        tokens.emplace_back(TOKEN(ValueType, Boolean));
-                    else if (identifier == "padding")
-                        tokens.emplace_back(TOKEN(ValueType, Padding));
-
-                    // If it's not a keyword and a builtin type, it has to be an identifier
+                    continue;
+                }
 
-                    else
+                if (hasClass(c, IdentifierStart)) {
+                    auto identifier = matchTillInvalid(view.substr(offset), IdentifierPart);
+
+                    // Check for reserved keywords and built-in types, if it's neither it has to be an identifier
+                    if (auto keyword = findKeyword(identifier); keyword == nullptr)
                         tokens.emplace_back(VALUE_TOKEN(Identifier, identifier));
+                    else if (keyword->type == Token::Type::Keyword)
+                        tokens.emplace_back(VALUE_TOKEN(Keyword, Token::Keyword(keyword->value)));
+                    else if (keyword->type == Token::Type::ValueType)
+                        tokens.emplace_back(VALUE_TOKEN(ValueType, Token::ValueType(keyword->value)));
+                    else
+                        tokens.emplace_back(VALUE_TOKEN(Integer, Token::IntegerLiteral(Token::ValueType::Boolean, s32(keyword->value))));
 
                     offset += identifier.length();
-                } else if (std::isdigit(c)) {
-                    auto integer = parseIntegerLiteral(&code[offset]);
+                    continue;
+                }
+
+                if (hasClass(c, NumberStart)) {
+                    const auto length = getIntegerLiteralLength(view.substr(offset));
+                    auto integer = parseIntegerLiteral(view.substr(offset, length));
 
                     if (!integer.has_value())
                         throwLexerError("invalid integer literal", lineNumber);
 
-
                     tokens.emplace_back(VALUE_TOKEN(Integer, integer.value()));
-                    offset += getIntegerLiteralLength(&code[offset]);
-                } else
-                    throwLexerError("unknown token", lineNumber);
-
+                    offset += length;
+                    continue;
+                }
+
+                // Operators made up of two characters take precedence over the one made up of their first character
+                u32 length = 1;
+
+                switch (c) {
+                    case ';': tokens.emplace_back(TOKEN(Separator, EndOfExpression)); break;
+                    case '(': tokens.emplace_back(TOKEN(Separator, RoundBracketOpen)); break;
+                    case ')': tokens.emplace_back(TOKEN(Separator, RoundBracketClose)); break;
+                    case '{': tokens.emplace_back(TOKEN(Separator, CurlyBracketOpen)); break;
+                    case '}': tokens.emplace_back(TOKEN(Separator, CurlyBracketClose)); break;
+                    case '[': tokens.emplace_back(TOKEN(Separator, SquareBracketOpen)); break;
+                    case ']': tokens.emplace_back(TOKEN(Separator, SquareBracketClose)); break;
+                    case ',': tokens.emplace_back(TOKEN(Separator, Comma)); break;
+                    case '.': tokens.emplace_back(TOKEN(Separator, Dot)); break;
+                    case '@': tokens.emplace_back(TOKEN(Operator, AtDeclaration)); break;
+                    case '+': tokens.emplace_back(TOKEN(Operator, Plus)); break;
+                    case '-': tokens.emplace_back(TOKEN(Operator, Minus)); break;
+                    case '*': tokens.emplace_back(TOKEN(Operator, Star)); break;
+                    case '/': tokens.emplace_back(TOKEN(Operator, Slash)); break;
+                    case '%': tokens.emplace_back(TOKEN(Operator, Percent)); break;
+                    case '~': tokens.emplace_back(TOKEN(Operator, BitNot)); break;
+                    case '?': tokens.emplace_back(TOKEN(Operator, TernaryConditional)); break;
+                    case '$': tokens.emplace_back(TOKEN(Operator, Dollar)); break;
+                    case '=':
+                        if (next == '=') {
+                            tokens.emplace_back(TOKEN(Operator, BoolEquals));
+                            length = 2;
+                        } else
+                            tokens.emplace_back(TOKEN(Operator, Assignment));
+                        break;
+                    case '!':
+                        if (next == '=') {
+                            tokens.emplace_back(TOKEN(Operator, BoolNotEquals));
+                            length = 2;
+                        } else
+                            tokens.emplace_back(TOKEN(Operator, BoolNot));
+                        break;
+                    case '>':
+                        if (next == '=') {
+                            tokens.emplace_back(TOKEN(Operator, BoolGreaterThanOrEquals));
+                            length = 2;
+                        } else if (next == '>') {
+                            tokens.emplace_back(TOKEN(Operator, ShiftRight));
+                            length = 2;
+                        } else
+                            tokens.emplace_back(TOKEN(Operator, BoolGreaterThan));
+                        break;
+                    case '<':
+                        if (next == '=') {
+                            tokens.emplace_back(TOKEN(Operator, BoolLessThanOrEquals));
+                            length = 2;
+                        } else if (next == '<') {
+                            tokens.emplace_back(TOKEN(Operator, ShiftLeft));
+                            length = 2;
+                        } else
+                            tokens.emplace_back(TOKEN(Operator, BoolLessThan));
+                        break;
+                    case '&':
+                        if (next == '&') {
+                            tokens.emplace_back(TOKEN(Operator, BoolAnd));
+                            length = 2;
+                        } else
+                            tokens.emplace_back(TOKEN(Operator, BitAnd));
+                        break;
+                    case '|':
+                        if (next == '|') {
+                            tokens.emplace_back(TOKEN(Operator, BoolOr));
+                            length = 2;
+                        } else
+                            tokens.emplace_back(TOKEN(Operator, BitOr));
+                        break;
+                    case '^':
+                        if (next == '^') {
+                            tokens.emplace_back(TOKEN(Operator, BoolXor));
+                            length = 2;
+                        } else
+                            tokens.emplace_back(TOKEN(Operator, BitXor));
+                        break;
+                    case ':':
+                        if (next == ':') {
+                            tokens.emplace_back(TOKEN(Separator, ScopeResolution));
+                            length = 2;
+                        } else
+                            tokens.emplace_back(TOKEN(Operator, Inherit));
+                        break;
+                    case '\'': {
+                        auto character = getCharacterLiteral(view.substr(offset));
+
+                        if (!character.has_value())
+                            throwLexerError("invalid character literal", lineNumber);
+
+                        auto [c, charSize] = character.value();
+
+                        tokens.emplace_back(VALUE_TOKEN(Integer, Token::IntegerLiteral(Token::ValueType::Character, c) ));
+                        length = charSize;
+                        break;
+                    }
+                    case '\"': {
+                        auto string = getStringLiteral(view.substr(offset));
+
+                        if (!string.has_value())
+                            throwLexerError("invalid string literal", lineNumber);
+
+                        auto [s, stringSize] = string.value();
+
+                        tokens.emplace_back(VALUE_TOKEN(String, std::move(s)));
+                        length = stringSize;
+                        break;
+                    }
+                    default:
+                        throwLexerError("unknown token", lineNumber);
+                }
+
+                offset += length;
             }
 
             tokens.emplace_back(TOKEN(Separator, EndOfProgram));
@@ -20,7 +20,7 @@ namespace hex::lang {
 
     // Identifier([(parseMathematicalExpression)|<(parseMathematicalExpression),...>(parseMathematicalExpression)]
     ASTNode* Parser::parseFunctionCall() {
-        auto functionName = getValue<std::string>(-2);
+        auto functionName = getValue<std::string_view>(-2);
         std::vector<ASTNode*> params;
         ScopeExit paramCleanup([&]{
             for (auto &param : params)
@@ -54,7 +54,7 @@ namespace hex::lang {
     // Identifier::<Identifier[::]...>
     ASTNode* Parser::parseScopeResolution(std::vector<std::string> &path) {
         if (peek(IDENTIFIER, -1))
-            path.push_back(getValue<std::string>(-1));
+            path.emplace_back(getValue<std::string_view>(-1));
 
         if (MATCHES(sequence(SEPARATOR_SCOPE_RESOLUTION))) {
             if (MATCHES(sequence(IDENTIFIER)))
@@ -68,7 +68,7 @@ namespace hex::lang {
     // <Identifier[.]...>
     ASTNode* Parser::parseRValue(std::vector<std::string> &path) {
         if (peek(IDENTIFIER, -1))
-            path.push_back(getValue<std::string>(-1));
+            path.emplace_back(getValue<std::string_view>(-1));
 
         if (MATCHES(sequence(SEPARATOR_DOT))) {
             if (MATCHES(sequence(IDENTIFIER)))
@@ -114,143 +114,66 @@ namespace hex::lang {
         return this->parseFactor();
     }
 
-    // (parseUnaryExpression) <*|/|%> (parseUnaryExpression)
-    ASTNode* Parser::parseMultiplicativeExpression() {
-        auto node = this->parseUnaryExpression();
-
-        while (MATCHES(oneOf(OPERATOR_STAR, OPERATOR_SLASH, OPERATOR_PERCENT))) {
-            auto op = getValue<Token::Operator>(-1);
-            node = new ASTNodeNumericExpression(node, this->parseUnaryExpression(), op);
-        }
-
-        return node;
-    }
-
-    // (parseMultiplicativeExpression) <+|-> (parseMultiplicativeExpression)
-    ASTNode* Parser::parseAdditiveExpression() {
-        auto node = this->parseMultiplicativeExpression();
-
-        while (MATCHES(variant(OPERATOR_PLUS, OPERATOR_MINUS))) {
-            auto op = getValue<Token::Operator>(-1);
-            node = new ASTNodeNumericExpression(node, this->parseMultiplicativeExpression(), op);
-        }
-
-        return node;
-    }
-
-    // (parseAdditiveExpression) < >>|<< > (parseAdditiveExpression)
-    ASTNode* Parser::parseShiftExpression() {
-        auto node = this->parseAdditiveExpression();
-
-        while (MATCHES(variant(OPERATOR_SHIFTLEFT, OPERATOR_SHIFTRIGHT))) {
-            auto op = getValue<Token::Operator>(-1);
-            node = new ASTNodeNumericExpression(node, this->parseAdditiveExpression(), op);
-        }
-
-        return node;
-    }
-
-    // (parseAdditiveExpression) < >=|<=|>|< > (parseAdditiveExpression)
-    ASTNode* Parser::parseRelationExpression() {
-        auto node = this->parseShiftExpression();
-
-        while (MATCHES(sequence(OPERATOR_BOOLGREATERTHAN) || sequence(OPERATOR_BOOLLESSTHAN) || sequence(OPERATOR_BOOLGREATERTHANOREQUALS) || sequence(OPERATOR_BOOLLESSTHANOREQUALS))) {
-            auto op = getValue<Token::Operator>(-1);
-            node = new ASTNodeNumericExpression(node, this->parseShiftExpression(), op);
-        }
-
-        return node;
-    }
-
-    // (parseRelationExpression) <==|!=> (parseRelationExpression)
-    ASTNode* Parser::parseEqualityExpression() {
-        auto node = this->parseRelationExpression();
-
-        while (MATCHES(sequence(OPERATOR_BOOLEQUALS) || sequence(OPERATOR_BOOLNOTEQUALS))) {
-            auto op = getValue<Token::Operator>(-1);
-            node = new ASTNodeNumericExpression(node, this->parseRelationExpression(), op);
-        }
-
-        return node;
-    }
-
-    // (parseEqualityExpression) & (parseEqualityExpression)
-    ASTNode* Parser::parseBinaryAndExpression() {
-        auto node = this->parseEqualityExpression();
-
-        while (MATCHES(sequence(OPERATOR_BITAND))) {
-            node = new ASTNodeNumericExpression(node, this->parseEqualityExpression(), Token::Operator::BitAnd);
-        }
-
-        return node;
-    }
-
-    // (parseBinaryAndExpression) ^ (parseBinaryAndExpression)
-    ASTNode* Parser::parseBinaryXorExpression() {
-        auto node = this->parseBinaryAndExpression();
-
-        while (MATCHES(sequence(OPERATOR_BITXOR))) {
-            node = new ASTNodeNumericExpression(node, this->parseBinaryAndExpression(), Token::Operator::BitXor);
-        }
-
-        return node;
-    }
-
-    // (parseBinaryXorExpression) | (parseBinaryXorExpression)
-    ASTNode* Parser::parseBinaryOrExpression() {
-        auto node = this->parseBinaryXorExpression();
-
-        while (MATCHES(sequence(OPERATOR_BITOR))) {
-            node = new ASTNodeNumericExpression(node, this->parseBinaryXorExpression(), Token::Operator::BitOr);
+    // Binding strength of the binary operators, from || up to * / %. Tokens that aren't binary operators have none
+    static u8 getBinaryOperatorPrecedence(const Token &token) {
+        if (token.type != Token::Type::Operator)
+            return 0;
+
+        switch (std::get<Token::Operator>(token.value)) {
+            case Token::Operator::BoolOr:                   return 1;
+            case Token::Operator::BoolXor:                  return 2;
+            case Token::Operator::BoolAnd:                  return 3;
+            case Token::Operator::BitOr:                    return 4;
+            case Token::Operator::BitXor:                   return 5;
+            case Token::Operator::BitAnd:                   return 6;
+            case Token::Operator::BoolEquals:
+            case Token::Operator::BoolNotEquals:            return 7;
+            case Token::Operator::BoolGreaterThan:
+            case Token::Operator::BoolLessThan:
+            case Token::Operator::BoolGreaterThanOrEquals:
+            case Token::Operator::BoolLessThanOrEquals:     return 8;
+            case Token::Operator::ShiftLeft:
+            case Token::Operator::ShiftRight:               return 9;
+            case Token::Operator::Plus:
+            case Token::Operator::Minus:                    return 10;
+            case Token::Operator::Star:
+            case Token::Operator::Slash:
+            case Token::Operator::Percent:                  return 11;
+            default:                                        return 0;
         }
-
-        return node;
     }
 
-    // (parseBinaryOrExpression) && (parseBinaryOrExpression)
-    ASTNode* Parser::parseBooleanAnd() {
-        auto node = this->parseBinaryOrExpression();
-
-        while (MATCHES(sequence(OPERATOR_BOOLAND))) {
-            node = new ASTNodeNumericExpression(node, this->parseBinaryOrExpression(), Token::Operator::BitOr);
-        }
-
-        return node;
-    }
-
-    // (parseBooleanAnd) ^^ (parseBooleanAnd)
-    ASTNode* Parser::parseBooleanXor() {
-        auto node = this->parseBooleanAnd();
-
-        while (MATCHES(sequence(OPERATOR_BOOLXOR))) {
-            node = new ASTNodeNumericExpression(node, this->parseBooleanAnd(), Token::Operator::BitOr);
-        }
+    // (parseUnaryExpression) <Operator (parseUnaryExpression)...>
+    // All binary operators are left associative. The next token decides whether the expression continues, so every token is only looked at once
+    // instead of going through a function per precedence level for every operand
+    ASTNode* Parser::parseBinaryExpression(u8 minPrecedence) {
+        auto node = this->parseUnaryExpression();
 
-        return node;
-    }
+        while (true) {
+            const auto precedence = getBinaryOperatorPrecedence(*this->m_curr);
+            if (precedence == 0 || precedence < minPrecedence)
+                break;
 
-    // (parseBooleanXor) || (parseBooleanXor)
-    ASTNode* Parser::parseBooleanOr() {
-        auto node = this->parseBooleanXor();
+            auto op = getValue<Token::Operator>(0);
+            this->m_curr++;
 
-        while (MATCHES(sequence(OPERATOR_BOOLOR))) {
-            node = new ASTNodeNumericExpression(node, this->parseBooleanXor(), Token::Operator::BitOr);
+            node = new ASTNodeNumericExpression(node, this->parseBinaryExpression(precedence + 1), op);
         }
 
         return node;
     }
 
-    // (parseBooleanOr) ? (parseBooleanOr) : (parseBooleanOr)
+    // (parseBinaryExpression) ? (parseBinaryExpression) : (parseBinaryExpression)
     ASTNode* Parser::parseTernaryConditional() {
-        auto node = this->parseBooleanOr();
+        auto node = this->parseBinaryExpression();
 
         while (MATCHES(sequence(OPERATOR_TERNARYCONDITIONAL))) {
-            auto second = this->parseBooleanOr();
+            auto second = this->parseBinaryExpression();
 
             if (!MATCHES(sequence(OPERATOR_INHERIT)))
                 throwParseError("expected ':' in ternary expression");
 
-            auto third = this->parseBooleanOr();
+            auto third = this->parseBinaryExpression();
             node = new ASTNodeTernaryExpression(node, second, third, Token::Operator::TernaryConditional);
         }
 
@@ -271,7 +194,7 @@ namespace hex::lang {
             if (!MATCHES(sequence(IDENTIFIER)))
                 throwParseError("expected attribute expression");
 
-            auto attribute = this->getValue<std::string>(-1);
+            auto attribute = this->getValue<std::string_view>(-1);
 
             if (MATCHES(sequence(SEPARATOR_ROUNDBRACKETOPEN, STRING, SEPARATOR_ROUNDBRACKETCLOSE))) {
                 auto value = this->getValue<std::string>(-2);
@@ -335,10 +258,11 @@ namespace hex::lang {
             endian = std::endian::big;
 
         if (getType(startIndex) == Token::Type::Identifier) { // Custom type
-            if (!this->m_types.contains(getValue<std::string>(startIndex)))
+            auto customType = this->m_types.find(getValue<std::string_view>(startIndex));
+            if (customType == this->m_types.end())
                 throwParseError("failed to parse type");
 
-            return new ASTNodeTypeDecl({ }, this->m_types[getValue<std::string>(startIndex)]->clone(), endian);
+            return new ASTNodeTypeDecl({ }, customType->second->clone(), endian);
         }
         else { // Builtin type
             return new ASTNodeTypeDecl({ }, new ASTNodeBuiltinType(getValue<Token::ValueType>(startIndex)), endian);
@@ -351,9 +275,9 @@ namespace hex::lang {
         if (type == nullptr) throwParseError("invalid type used in variable declaration", -1);
 
         if (peekOptional(KEYWORD_BE) || peekOptional(KEYWORD_LE))
-            return new ASTNodeTypeDecl(getValue<std::string>(-4), type, type->getEndian());
+            return new ASTNodeTypeDecl(getValue<std::string_view>(-4), type, type->getEndian());
         else
-            return new ASTNodeTypeDecl(getValue<std::string>(-3), type, type->getEndian());
+            return new ASTNodeTypeDecl(getValue<std::string_view>(-3), type, type->getEndian());
     }
 
     // padding[(parseMathematicalExpression)]
@@ -373,7 +297,7 @@ namespace hex::lang {
         auto type = dynamic_cast<ASTNodeTypeDecl *>(parseType(-2));
         if (type == nullptr) throwParseError("invalid type used in variable declaration", -1);
 
-        return new ASTNodeVariableDecl(getValue<std::string>(-1), type);
+        return new ASTNodeVariableDecl(getValue<std::string_view>(-1), type);
     }
 
     // (parseType) Identifier[(parseMathematicalExpression)]
@@ -381,7 +305,7 @@ namespace hex::lang {
         auto type = dynamic_cast<ASTNodeTypeDecl *>(parseType(-3));
         if (type == nullptr) throwParseError("invalid type used in variable declaration", -1);
 
-        auto name = getValue<std::string>(-2);
+        auto name = getValue<std::string_view>(-2);
 
         ASTNode *size = nullptr;
         ScopeExit sizeCleanup([&]{ delete size; });
@@ -400,7 +324,7 @@ namespace hex::lang {
 
     // (parseType) *Identifier : (parseType)
     ASTNode* Parser::parseMemberPointerVariable() {
-        auto name = getValue<std::string>(-2);
+        auto name = getValue<std::string_view>(-2);
 
         auto pointerType = dynamic_cast<ASTNodeTypeDecl *>(parseType(-4));
         if (pointerType == nullptr) throwParseError("invalid type used in variable declaration", -1);
@@ -420,13 +344,22 @@ namespace hex::lang {
 
         if (MATCHES(sequence(VALUETYPE_PADDING, SEPARATOR_SQUAREBRACKETOPEN)))
             member = parsePadding();
-        else if (MATCHES((optional(KEYWORD_BE), optional(KEYWORD_LE)) && variant(IDENTIFIER, VALUETYPE_ANY) && sequence(IDENTIFIER, SEPARATOR_SQUAREBRACKETOPEN) && sequence<Not>(SEPARATOR_SQUAREBRACKETOPEN)))
-            member = parseMemberArrayVariable();
-        else if (MATCHES((optional(KEYWORD_BE), optional(KEYWORD_LE)) && variant(IDENTIFIER, VALUETYPE_ANY) && sequence(IDENTIFIER)))
-            member = parseMemberVariable();
-        else if (MATCHES((optional(KEYWORD_BE), optional(KEYWORD_LE)) && variant(IDENTIFIER, VALUETYPE_ANY) && sequence(OPERATOR_STAR, IDENTIFIER, OPERATOR_INHERIT)))
-            member = parseMemberPointerVariable();
-        else if (MATCHES(sequence(KEYWORD_IF, SEPARATOR_ROUNDBRACKETOPEN)))
+        else if (MATCHES((optional(KEYWORD_BE), optional(KEYWORD_LE)) && variant(IDENTIFIER, VALUETYPE_ANY))) {
+            // The type is only matched once, the tokens following it decide which kind of member it is
+            if (peek(IDENTIFIER) && peek(SEPARATOR_SQUAREBRACKETOPEN, 1) && !peek(SEPARATOR_SQUAREBRACKETOPEN, 2)) {
+                this->m_curr += 2;
+                member = parseMemberArrayVariable();
+            } else if (peek(IDENTIFIER)) {
+                this->m_curr += 1;
+                member = parseMemberVariable();
+            } else if (peek(OPERATOR_STAR) && peek(IDENTIFIER, 1) && peek(OPERATOR_INHERIT, 2)) {
+                this->m_curr += 3;
+                member = parseMemberPointerVariable();
+            } else {
+                this->m_curr = this->m_originalPosition;
+                throwParseError("invalid struct member", 0);
+            }
+        } else if (MATCHES(sequence(KEYWORD_IF, SEPARATOR_ROUNDBRACKETOPEN)))
             return parseConditional();
         else if (MATCHES(sequence(SEPARATOR_ENDOFPROGRAM)))
             throwParseError("unexpected end of program", -2);
@@ -445,7 +378,7 @@ namespace hex::lang {
     // struct Identifier { <(parseMember)...> }
     ASTNode* Parser::parseStruct() {
         const auto structNode = new ASTNodeStruct();
-        const auto &typeName = getValue<std::string>(-2);
+        const auto &typeName = getValue<std::string_view>(-2);
         ScopeExit structGuard([&]{ delete structNode; });
 
         while (!MATCHES(sequence(SEPARATOR_CURLYBRACKETCLOSE))) {
@@ -460,7 +393,7 @@ namespace hex::lang {
     // union Identifier { <(parseMember)...> }
     ASTNode* Parser::parseUnion() {
         const auto unionNode = new ASTNodeUnion();
-        const auto &typeName = getValue<std::string>(-2);
+        const auto &typeName = getValue<std::string_view>(-2);
         ScopeExit unionGuard([&]{ delete unionNode; });
 
         while (!MATCHES(sequence(SEPARATOR_CURLYBRACKETCLOSE))) {
@@ -476,9 +409,9 @@ namespace hex::lang {
     ASTNode* Parser::parseEnum() {
         std::string typeName;
         if (peekOptional(KEYWORD_BE) || peekOptional(KEYWORD_LE))
-            typeName = getValue<std::string>(-5);
+            typeName = getValue<std::string_view>(-5);
         else
-            typeName = getValue<std::string>(-4);
+            typeName = getValue<std::string_view>(-4);
 
         auto underlyingType = dynamic_cast<ASTNodeTypeDecl*>(parseType(-2));
         if (underlyingType == nullptr) throwParseError("failed to parse type", -2);
@@ -490,7 +423,7 @@ namespace hex::lang {
         ASTNode *lastEntry = nullptr;
         while (!MATCHES(sequence(SEPARATOR_CURLYBRACKETCLOSE))) {
             if (MATCHES(sequence(IDENTIFIER, OPERATOR_ASSIGNMENT))) {
-                auto name = getValue<std::string>(-2);
+                auto name = getValue<std::string_view>(-2);
                 auto value = parseMathematicalExpression();
 
                 enumNode->addEntry(name, value);
@@ -498,7 +431,7 @@ namespace hex::lang {
             }
             else if (MATCHES(sequence(IDENTIFIER))) {
                 ASTNode *valueExpr;
-                auto name = getValue<std::string>(-1);
+                auto name = getValue<std::string_view>(-1);
                 if (enumNode->getEntries().empty())
                     valueExpr = lastEntry = TO_NUMERIC_EXPRESSION(new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned8Bit, u8(0) }));
                 else
@@ -526,14 +459,14 @@ namespace hex::lang {
 
     // bitfield Identifier { <Identifier : (parseMathematicalExpression)[;]...> }
     ASTNode* Parser::parseBitfield() {
-        std::string typeName = getValue<std::string>(-2);
+        std::string typeName(getValue<std::string_view>(-2));
 
         const auto bitfieldNode = new ASTNodeBitfield();
         ScopeExit enumGuard([&]{ delete bitfieldNode; });
 
         while (!MATCHES(sequence(SEPARATOR_CURLYBRACKETCLOSE))) {
             if (MATCHES(sequence(IDENTIFIER, OPERATOR_INHERIT))) {
-                auto name = getValue<std::string>(-2);
+                auto name = getValue<std::string_view>(-2);
                 bitfieldNode->addEntry(name, parseMathematicalExpression());
             }
             else if (MATCHES(sequence(SEPARATOR_ENDOFPROGRAM)))
@@ -556,7 +489,10 @@ namespace hex::lang {
         auto type = dynamic_cast<ASTNodeTypeDecl *>(parseType(-3));
         if (type == nullptr) throwParseError("invalid type used in variable declaration", -1);
 
-        return new ASTNodeVariableDecl(getValue<std::string>(-2), type, parseMathematicalExpression());
+        // Arguments are evaluated in an unspecified order, the name has to be read before the offset moves past it
+        auto name = getValue<std::string_view>(-2);
+
+        return new ASTNodeVariableDecl(name, type, parseMathematicalExpression());
     }
 
     // (parseType) Identifier[[(parseMathematicalExpression)]] @ Integer
@@ -564,7 +500,7 @@ namespace hex::lang {
         auto type = dynamic_cast<ASTNodeTypeDecl *>(parseType(-3));
         if (type == nullptr) throwParseError("invalid type used in variable declaration", -1);
 
-        auto name = getValue<std::string>(-2);
+        auto name = getValue<std::string_view>(-2);
 
         ASTNode *size = nullptr;
         ScopeExit sizeCleanup([&]{ delete size; });
@@ -586,7 +522,7 @@ namespace hex::lang {
 
     // (parseType) *Identifier : (parseType) @ Integer
     ASTNode* Parser::parsePointerVariablePlacement() {
-        auto name = getValue<std::string>(-2);
+        auto name = getValue<std::string_view>(-2);
 
         auto temporaryPointerType = dynamic_cast<ASTNodeTypeDecl *>(parseType(-4));
         if (temporaryPointerType == nullptr) throwParseError("invalid type used in variable declaration", -1);
@@ -613,13 +549,26 @@ namespace hex::lang {
 
         if (MATCHES(sequence(KEYWORD_USING, IDENTIFIER, OPERATOR_ASSIGNMENT) && (optional(KEYWORD_BE), optional(KEYWORD_LE)) && variant(IDENTIFIER, VALUETYPE_ANY)))
             statement = dynamic_cast<ASTNodeTypeDecl*>(parseUsingDeclaration());
-        else if (MATCHES((optional(KEYWORD_BE), optional(KEYWORD_LE)) && variant(IDENTIFIER, VALUETYPE_ANY) && sequence(IDENTIFIER, SEPARATOR_SQUAREBRACKETOPEN)))
-            statement = parseArrayVariablePlacement();
-        else if (MATCHES((optional(KEYWORD_BE), optional(KEYWORD_LE)) && variant(IDENTIFIER, VALUETYPE_ANY) && sequence(IDENTIFIER, OPERATOR_AT)))
-            statement = parseVariablePlacement();
-        else if (MATCHES((optional(KEYWORD_BE), optional(KEYWORD_LE)) && variant(IDENTIFIER, VALUETYPE_ANY) && sequence(OPERATOR_STAR, IDENTIFIER, OPERATOR_INHERIT)))
-            statement = parsePointerVariablePlacement();
-        else if (MATCHES(sequence(KEYWORD_STRUCT, IDENTIFIER, SEPARATOR_CURLYBRACKETOPEN)))
+        else if (MATCHES((optional(KEYWORD_BE), optional(KEYWORD_LE)) && variant(IDENTIFIER, VALUETYPE_ANY))) {
+            // The type is only matched once, the tokens following it decide which kind of placement it is.
+            // A function call looks like the start of one, its name got matched as type
+            if (peek(IDENTIFIER) && peek(SEPARATOR_SQUAREBRACKETOPEN, 1)) {
+                this->m_curr += 2;
+                statement = parseArrayVariablePlacement();
+            } else if (peek(IDENTIFIER) && peek(OPERATOR_AT, 1)) {
+                this->m_curr += 2;
+                statement = parseVariablePlacement();
+            } else if (peek(OPERATOR_STAR) && peek(IDENTIFIER, 1) && peek(OPERATOR_INHERIT, 2)) {
+                this->m_curr += 3;
+                statement = parsePointerVariablePlacement();
+            } else if (this->m_matchedOptionals.empty() && getType(-1) == Token::Type::Identifier && peek(SEPARATOR_ROUNDBRACKETOPEN)) {
+                this->m_curr += 1;
+                statement = parseFunctionCall();
+            } else {
+                this->m_curr = this->m_originalPosition;
+                throwParseError("invalid sequence", 0);
+            }
+        } else if (MATCHES(sequence(KEYWORD_STRUCT, IDENTIFIER, SEPARATOR_CURLYBRACKETOPEN)))
             statement = parseStruct();
         else if (MATCHES(sequence(KEYWORD_UNION, IDENTIFIER, SEPARATOR_CURLYBRACKETOPEN)))
             statement = parseUnion();
@@ -627,8 +576,6 @@ namespace hex::lang {
             statement = parseEnum();
         else if (MATCHES(sequence(KEYWORD_BITFIELD, IDENTIFIER, SEPARATOR_CURLYBRACKETOPEN)))
             statement = parseBitfield();
-        else if (MATCHES(sequence(IDENTIFIER, SEPARATOR_ROUNDBRACKETOPEN)))
-            statement = parseFunctionCall();
         else throwParseError("invalid sequence", 0);
 
         if (MATCHES(sequence(SEPARATOR_SQUAREBRACKETOPEN, SEPARATOR_SQUAREBRACKETOPEN)))
@@ -648,13 +595,24 @@ namespace hex::lang {
         this->m_curr = tokens.begin();
 
         this->m_types.clear();
+        this->m_statementEnds.clear();
 
         try {
-            auto program = parseTillToken(SEPARATOR_ENDOFPROGRAM);
+            std::vector<ASTNode*> program;
+            ScopeExit guard([&]{ for (auto &node : program) delete node; });
+
+            while (this->m_curr->type != Token::Type::Separator || (*this->m_curr) != Token::Separator::EndOfProgram) {
+                program.push_back(parseStatement());
+                this->m_statementEnds.push_back(this->m_curr - tokens.begin());
+            }
+
+            this->m_curr++;
 
             if (program.empty() || this->m_curr != tokens.end())
                 throwParseError("program is empty!", -1);
 
+            guard.release();
+
             return program;
         } catch (ParseError &e) {
             this->m_error = e;
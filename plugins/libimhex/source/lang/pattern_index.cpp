@@ -0,0 +1,147 @@
+#include <hex/lang/pattern_index.hpp>
+
+#include <hex/lang/pattern_data.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+namespace hex::lang {
+
+    template<typename Callback>
+    static void forEachMember(PatternData *pattern, Callback &&callback) {
+        auto forEach = [&callback](const std::vector<PatternData*> &members) {
+            for (auto &member : members)
+                callback(member);
+        };
+
+        if (auto pointer = dynamic_cast<PatternDataPointer*>(pattern); pointer != nullptr)
+            callback(pointer->getPointedAtPattern());
+        else if (auto structPattern = dynamic_cast<PatternDataStruct*>(pattern); structPattern != nullptr)
+            forEach(structPattern->getMembers());
+        else if (auto unionPattern = dynamic_cast<PatternDataUnion*>(pattern); unionPattern != nullptr)
+            forEach(unionPattern->getMembers());
+        else if (auto array = dynamic_cast<PatternDataArray*>(pattern); array != nullptr)
+            forEach(array->getEntries());
+    }
+
+    static bool isPadding(PatternData *pattern) {
+        return dynamic_cast<PatternDataPadding*>(pattern) != nullptr;
+    }
+
+    // Moves the templates of static arrays to the entry containing the address and continues with that entry's members
+    static void resolveEntries(u64 address, std::vector<PatternData*> &path) {
+        auto pattern = path.back();
+
+        while (true) {
+            if (auto array = dynamic_cast<PatternDataStaticArray*>(pattern); array != nullptr) {
+                const size_t entrySize = array->getTemplate()->getSize();
+                if (entrySize == 0 || array->getEntryCount() == 0)
+                    return;
+
+                pattern = array->getEntry(std::min((address - array->getOffset()) / entrySize, array->getEntryCount() - 1));
+            } else {
+                PatternData *innerPattern = nullptr;
+                forEachMember(pattern, [&](PatternData *member) {
+                    if (innerPattern == nullptr && !isPadding(member) && address >= member->getOffset() && address < member->getOffset() + member->getSize())
+                        innerPattern = member;
+                });
+
+                if (innerPattern == nullptr)
+                    return;
+
+                pattern = innerPattern;
+            }
+
+            path.push_back(pattern);
+        }
+    }
+
+    PatternData* PatternIndex::find(u64 address) {
+        static std::vector<PatternData*> path;
+
+        if (!this->findPath(address, path))
+            return nullptr;
+
+        return path.back();
+    }
+
+    bool PatternIndex::findPath(u64 address, std::vector<PatternData*> &path) {
+        path.clear();
+        this->update();
+
+        auto it = this->m_runs.upper_bound(address);
+        if (it == this->m_runs.begin())
+            return false;
+
+        it = std::prev(it);
+        if (address >= it->second.end)
+            return false;
+
+        for (u32 node = it->second.node; node != NoParent; node = this->m_nodes[node].parent)
+            path.push_back(this->m_nodes[node].pattern);
+        std::reverse(path.begin(), path.end());
+
+        if (dynamic_cast<PatternDataStaticArray*>(path.back()) != nullptr)
+            resolveEntries(address, path);
+
+        return true;
+    }
+
+    void PatternIndex::update() {
+        if (this->m_valid)
+            return;
+
+        this->m_nodes.clear();
+        this->m_runs.clear();
+
+        for (auto &pattern : this->m_patterns)
+            this->addPattern(pattern, NoParent);
+
+        this->m_valid = true;
+    }
+
+    void PatternIndex::addPattern(PatternData *pattern, u32 parent) {
+        if (isPadding(pattern))
+            return;
+
+        const u32 node = this->m_nodes.size();
+        this->m_nodes.push_back({ pattern, parent });
+
+        // Members get added first so the pattern itself only fills the gaps between them
+        forEachMember(pattern, [&, this](PatternData *member) {
+            this->addPattern(member, node);
+        });
+
+        this->insertRuns(pattern->getOffset(), pattern->getSize(), node);
+    }
+
+    void PatternIndex::insertRuns(u64 address, size_t size, u32 node) {
+        if (size == 0)
+            return;
+
+        u64 curr = address;
+        const u64 end = address + size;
+
+        // Skip the part that's already covered by a run starting before the new range
+        auto it = this->m_runs.upper_bound(curr);
+        if (it != this->m_runs.begin()) {
+            auto prev = std::prev(it);
+            curr = std::max(curr, prev->second.end);
+        }
+
+        // Fill all gaps between existing runs
+        while (curr < end) {
+            it = this->m_runs.lower_bound(curr);
+
+            const bool covered = it != this->m_runs.end() && it->first < end;
+            const u64 gapEnd = covered ? it->first : end;
+            const u64 next   = covered ? it->second.end : end;
+
+            if (gapEnd > curr)
+                this->m_runs.emplace_hint(it, curr, Run{ gapEnd, node });
+
+            curr = next;
+        }
+    }
+
+}
@@ -1,14 +1,18 @@
 #include <hex/lang/pattern_language.hpp>
 
 #include <hex/providers/provider.hpp>
+#include <hex/helpers/memory_arena.hpp>
 
 #include <hex/lang/preprocessor.hpp>
 #include <hex/lang/lexer.hpp>
 #include <hex/lang/parser.hpp>
 #include <hex/lang/validator.hpp>
 #include <hex/lang/evaluator.hpp>
+#include <hex/lang/ast_node.hpp>
 #include <hex/lang/pattern_data.hpp>
 
+#include <algorithm>
+
 #include <unistd.h>
 
 namespace hex::lang {
@@ -33,6 +37,29 @@ namespace hex::lang {
             } else
                 return false;
         });
+
+        auto addLimitHandler = [this](const std::string &pragmaType, auto setLimit) {
+            this->m_preprocessor->addPragmaHandler(pragmaType, [this, pragmaType, setLimit](const std::string &value) {
+                auto limit = Preprocessor::parseLimit(pragmaType, value);
+                if (limit.has_value())
+                    setLimit(this->m_limits, *limit);
+
+                return limit.has_value();
+            });
+        };
+
+        addLimitHandler("pattern_limit",   [](auto &limits, u64 limit) { limits.patternLimit = limit; });
+        addLimitHandler("array_limit",     [](auto &limits, u64 limit) { limits.arrayLimit = limit; });
+        addLimitHandler("recursion_limit", [](auto &limits, u64 limit) { limits.recursionLimit = limit; });
+        addLimitHandler("time_limit",      [](auto &limits, u64 limit) { limits.timeLimit = limit; });
+
+        this->m_preprocessor->addPragmaHandler("profile", [this](const std::string &value) {
+            if (value == "true" || value == "false") {
+                this->m_limits.profile = value == "true";
+                return true;
+            } else
+                return false;
+        });
         this->m_preprocessor->addDefaultPragmaHandlers();
     }
 
@@ -45,45 +72,165 @@ namespace hex::lang {
     }
 
 
-    std::optional<std::vector<PatternData*>> PatternLanguage::executeString(prv::Provider *provider, std::string_view string) {
+    CompiledPattern::~CompiledPattern() {
+        for (auto &node : this->m_ast)
+            delete node;
+    }
+
+    size_t CompiledPattern::getCommonStatementCount(const CompiledPattern &other) const {
+        auto isSameToken = [](const Token &left, const Token &right) {
+            return left.type == right.type && left.value == right.value;
+        };
+
+        size_t statementStart = 0;
+        for (size_t i = 0; i < std::min(this->m_ast.size(), other.m_ast.size()); i++) {
+            const auto statementEnd = this->m_statementEnds[i];
+
+            if (statementEnd != other.m_statementEnds[i] || this->m_ast[i]->getKind() == ASTNode::Kind::FunctionCall)
+                return i;
+            if (!std::equal(this->m_tokens.begin() + statementStart, this->m_tokens.begin() + statementEnd, other.m_tokens.begin() + statementStart, isSameToken))
+                return i;
+
+            statementStart = statementEnd;
+        }
+
+        return std::min(this->m_ast.size(), other.m_ast.size());
+    }
+
+    std::shared_ptr<const CompiledPattern> PatternLanguage::compile(std::string_view string) {
         this->m_currError.reset();
         this->m_evaluator->getConsole().clear();
-        this->m_evaluator->setProvider(provider);
+        this->m_defaultEndian = std::endian::native;
+        this->m_limits = { };
+
+        auto pattern = std::shared_ptr<CompiledPattern>(new CompiledPattern());
+        pattern->m_arena = std::make_shared<MemoryArena>();
+        MemoryArena::Scope arenaScope(*pattern->m_arena);
+
+        auto stageStart = std::chrono::steady_clock::now();
+        auto endStage = [&stageStart](std::chrono::steady_clock::duration &time) {
+            auto now = std::chrono::steady_clock::now();
+            time = now - stageStart;
+            stageStart = now;
+        };
 
         auto preprocessedCode = this->m_preprocessor->preprocess(string.data());
+        endStage(pattern->m_stageTimes.preprocessing);
         if (!preprocessedCode.has_value()) {
             this->m_currError = this->m_preprocessor->getError();
-            return { };
+            return nullptr;
         }
 
-        auto tokens = this->m_lexer->lex(preprocessedCode.value());
+        // Tokens point into the code, so it's kept together with them
+        pattern->m_code = std::move(preprocessedCode.value());
+
+        auto tokens = this->m_lexer->lex(pattern->m_code);
+        endStage(pattern->m_stageTimes.lexing);
         if (!tokens.has_value()) {
             this->m_currError = this->m_lexer->getError();
-            return { };
+            return nullptr;
         }
 
         auto ast = this->m_parser->parse(tokens.value());
+        endStage(pattern->m_stageTimes.parsing);
         if (!ast.has_value()) {
             this->m_currError = this->m_parser->getError();
-            return { };
+            return nullptr;
         }
 
-        SCOPE_EXIT( for(auto &node : ast.value()) delete node; );
+        pattern->m_ast = std::move(ast.value());
+        pattern->m_defaultEndian = this->m_defaultEndian;
+        pattern->m_limits = this->m_limits;
+        pattern->m_includedFiles = this->m_preprocessor->getIncludedFiles();
+        pattern->m_tokens = std::move(tokens.value());
+        pattern->m_statementEnds = this->m_parser->getStatementEnds();
 
-        auto validatorResult = this->m_validator->validate(ast.value());
+        auto validatorResult = this->m_validator->validate(pattern->m_ast);
+        endStage(pattern->m_stageTimes.validation);
         if (!validatorResult) {
             this->m_currError = this->m_validator->getError();
-            return { };
+            return nullptr;
         }
 
-        auto patternData = this->m_evaluator->evaluate(ast.value());
+        return pattern;
+    }
+
+    std::shared_ptr<const CompiledPattern> PatternLanguage::getCompiledPattern(std::string_view string) {
+        if (this->m_cachedPattern == nullptr || this->m_cachedCode != string || !Preprocessor::areUpToDate(this->m_cachedPattern->getIncludedFiles())) {
+            this->m_cachedPattern.reset();
+
+            auto pattern = this->compile(string);
+            if (pattern == nullptr)
+                return nullptr;
+
+            this->m_cachedCode = string;
+            this->m_cachedPattern = std::move(pattern);
+        } else
+            this->m_currError.reset();
+
+        return this->m_cachedPattern;
+    }
+
+    size_t PatternLanguage::getResumableStatementCount(prv::Provider *provider, const CompiledPattern &pattern) const {
+        if (this->m_lastPattern == nullptr || this->m_lastProvider != provider || this->m_lastPattern->getDefaultEndian() != pattern.getDefaultEndian() || this->m_lastPattern->getLimits() != pattern.getLimits())
+            return 0;
+
+        // Statements of the last evaluation that didn't finish have no state to continue from
+        return std::min(pattern.getCommonStatementCount(*this->m_lastPattern), this->m_evaluator->getStatementStates().size());
+    }
+
+    size_t PatternLanguage::getKeptPatternCount(prv::Provider *provider, const CompiledPattern &pattern) const {
+        auto statementCount = this->getResumableStatementCount(provider, pattern);
+
+        if (statementCount == 0)
+            return 0;
+        else
+            return this->m_evaluator->getStatementStates()[statementCount - 1].patternCount;
+    }
+
+    std::optional<std::vector<PatternData*>> PatternLanguage::execute(prv::Provider *provider, const std::shared_ptr<const CompiledPattern> &pattern, Task *task, const PatternCallback &onPattern, const std::vector<PatternData*> &keptPatterns) {
+        std::vector<Evaluator::StatementState> previousStates;
+        if (!keptPatterns.empty()) {
+            const auto &states = this->m_evaluator->getStatementStates();
+            previousStates.assign(states.begin(), states.begin() + this->getResumableStatementCount(provider, *pattern));
+        }
+
+        this->m_currError.reset();
+        this->m_evaluator->getConsole().clear();
+        this->m_evaluator->setProvider(provider);
+        this->m_evaluator->setTask(task);
+        this->m_evaluator->setPatternCallback(onPattern);
+        this->m_evaluator->setDefaultEndian(pattern->getDefaultEndian());
+        this->m_evaluator->setLimits(pattern->getLimits());
+
+        if (pattern->getLimits().profile) {
+            auto milliseconds = [](std::chrono::steady_clock::duration time) { return std::chrono::duration<double, std::milli>(time).count(); };
+
+            const auto &times = pattern->getStageTimes();
+            this->m_evaluator->getConsole().log(LogConsole::Level::Info, hex::format("profile: preprocessing %.3f ms, lexing %.3f ms (%llu tokens), parsing %.3f ms, validation %.3f ms",
+                                                milliseconds(times.preprocessing), milliseconds(times.lexing), u64(pattern->m_tokens.size()), milliseconds(times.parsing), milliseconds(times.validation)));
+        }
+
+        this->m_lastPattern = pattern;
+        this->m_lastProvider = provider;
+
+        auto patternData = this->m_evaluator->evaluate(pattern->getAST(), previousStates, keptPatterns);
         if (!patternData.has_value())
             return { };
 
         return patternData.value();
     }
 
-    std::optional<std::vector<PatternData*>> PatternLanguage::executeFile(prv::Provider *provider, std::string_view path) {
+    std::optional<std::vector<PatternData*>> PatternLanguage::executeString(prv::Provider *provider, std::string_view string, Task *task, const PatternCallback &onPattern) {
+        auto pattern = this->getCompiledPattern(string);
+        if (pattern == nullptr)
+            return { };
+
+        // Evaluation may still fail with a console error, the pattern stays cached since it doesn't depend on the data
+        return this->execute(provider, pattern, task, onPattern);
+    }
+
+    std::optional<std::vector<PatternData*>> PatternLanguage::executeFile(prv::Provider *provider, std::string_view path, Task *task, const PatternCallback &onPattern) {
         FILE *file = fopen(path.data(), "r");
         if (file == nullptr)
             return { };
@@ -97,11 +244,11 @@ namespace hex::lang {
 
         fclose(file);
 
-        return this->executeString(provider, code);
+        return this->executeString(provider, code, task, onPattern);
     }
 
 
-    const std::vector<std::pair<LogConsole::Level, std::string>>& PatternLanguage::getConsoleLog() {
+    std::vector<std::pair<LogConsole::Level, std::string>> PatternLanguage::getConsoleLog() {
         return this->m_evaluator->getConsole().getLog();
     }
 
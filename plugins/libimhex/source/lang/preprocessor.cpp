@@ -1,5 +1,12 @@
 #include <hex/lang/preprocessor.hpp>
 
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <unordered_set>
+
 namespace hex::lang {
 
     Preprocessor::Preprocessor() {
@@ -13,6 +20,9 @@ namespace hex::lang {
         if (initialRun) {
             this->m_defines.clear();
             this->m_pragmas.clear();
+            this->m_includedFiles.clear();
+            this->m_onceIncluded.clear();
+            this->m_includePositions.clear();
         }
 
         std::string output;
@@ -50,32 +60,30 @@ namespace hex::lang {
                         if (includeFile[0] != '/')
                             includeFile = "include/" + includeFile;
 
-                        FILE *file = fopen(includeFile.c_str(), "r");
-                        if (file == nullptr)
+                        std::error_code error;
+                        auto modificationTime = std::filesystem::last_write_time(includeFile, error);
+                        if (error)
                             throwPreprocessorError(hex::format("%s: No such file or directory", includeFile.c_str()), lineNumber);
 
-                        fseek(file, 0, SEEK_END);
-                        size_t size = ftell(file);
-                        char *buffer = new char[size + 1];
-                        rewind(file);
-
-                        fread(buffer, size, 1, file);
-                        buffer[size] = 0x00;
-
-                        auto preprocessedInclude = this->preprocess(buffer, false);
-                        if (!preprocessedInclude.has_value())
-                            throw this->m_error;
-
-                        auto content = preprocessedInclude.value();
-
-                        std::replace(content.begin(), content.end(), '\n', ' ');
-                        std::replace(content.begin(), content.end(), '\r', ' ');
-
-                        output += content;
-
-                        delete[] buffer;
-
-                        fclose(file);
+                        if (this->m_activeIncludes.contains(includeFile))
+                            throwPreprocessorError(hex::format("%s: file includes itself", includeFile.c_str()), lineNumber);
+
+                        auto cachedInclude = this->m_includeCache.find(includeFile);
+                        if (cachedInclude == this->m_includeCache.end() || cachedInclude->second.modificationTime != modificationTime || !areUpToDate(cachedInclude->second.includedFiles))
+                            cachedInclude = this->m_includeCache.insert_or_assign(includeFile, this->preprocessInclude(includeFile, modificationTime, lineNumber)).first;
+
+                        const auto &include = cachedInclude->second;
+                        this->m_defines.insert(include.defines.begin(), include.defines.end());
+                        this->m_pragmas.insert(include.pragmas.begin(), include.pragmas.end());
+                        this->m_includedFiles.emplace_back(includeFile, modificationTime);
+                        this->m_includedFiles.insert(this->m_includedFiles.end(), include.includedFiles.begin(), include.includedFiles.end());
+
+                        // Cached includes only hold their own code, the files they include get inserted where they're used.
+                        // That way a file marked with "#pragma once" ends up in the output only once, no matter which file included it first
+                        if (initialRun)
+                            this->appendInclude(output, includeFile);
+                        else
+                            this->m_includePositions.emplace_back(output.size(), includeFile);
                     } else if (code.substr(offset, 6) == "define") {
                         offset += 6;
 
@@ -117,32 +125,37 @@ namespace hex::lang {
                         while (std::isblank(code[offset]))
                             offset += 1;
 
-                        std::string pragmaKey;
-                        while (!std::isblank(code[offset])) {
-                            pragmaKey += code[offset];
+                        if (code.compare(offset, 4, "once") == 0 && (offset + 4 >= code.length() || std::isspace(code[offset + 4]))) {
+                            offset += 4;
+                            this->m_pragmaOnce = true;
+                        } else {
+                            std::string pragmaKey;
+                            while (!std::isblank(code[offset])) {
+                                pragmaKey += code[offset];
 
-                            if (offset >= code.length() || code[offset] == '\n' || code[offset] == '\r')
-                                throwPreprocessorError("no instruction given in #pragma directive", lineNumber);
+                                if (offset >= code.length() || code[offset] == '\n' || code[offset] == '\r')
+                                    throwPreprocessorError("no instruction given in #pragma directive", lineNumber);
 
-                            offset += 1;
-                        }
+                                offset += 1;
+                            }
 
-                        while (std::isblank(code[offset]))
-                            offset += 1;
+                            while (std::isblank(code[offset]))
+                                offset += 1;
 
-                        std::string pragmaValue;
-                        while (code[offset] != '\n' && code[offset] != '\r') {
-                            if (offset >= code.length())
-                                throwPreprocessorError("missing new line after #pragma directive", lineNumber);
+                            std::string pragmaValue;
+                            while (code[offset] != '\n' && code[offset] != '\r') {
+                                if (offset >= code.length())
+                                    throwPreprocessorError("missing new line after #pragma directive", lineNumber);
 
-                            pragmaValue += code[offset];
-                            offset += 1;
-                        }
+                                pragmaValue += code[offset];
+                                offset += 1;
+                            }
 
-                        if (pragmaValue.empty())
-                            throwPreprocessorError("missing value in #pragma directive", lineNumber);
+                            if (pragmaValue.empty())
+                                throwPreprocessorError("missing value in #pragma directive", lineNumber);
 
-                        this->m_pragmas.emplace(pragmaKey, pragmaValue);
+                            this->m_pragmas.emplace(pragmaKey, pragmaValue);
+                        }
                     } else
                         throwPreprocessorError("unknown preprocessor directive", lineNumber);
                 } else if (code.substr(offset, 2) == "//") {
@@ -171,20 +184,7 @@ namespace hex::lang {
             }
 
             if (initialRun) {
-                // Apply defines
-                std::vector<std::pair<std::string, std::string>> sortedDefines;
-                std::copy(this->m_defines.begin(), this->m_defines.end(), std::back_inserter(sortedDefines));
-                std::sort(sortedDefines.begin(), sortedDefines.end(), [](const auto &left, const auto &right) {
-                   return left.first.size() > right.first.size();
-                });
-
-                for (const auto &[define, value] : sortedDefines) {
-                    s32 index = 0;
-                    while((index = output.find(define, index)) != std::string::npos) {
-                        output.replace(index, define.length(), value);
-                        index += value.length();
-                    }
-                }
+                output = this->expandDefines(output);
 
                 // Handle pragmas
                 for (const auto &[type, value] : this->m_pragmas) {
@@ -203,11 +203,189 @@ namespace hex::lang {
         return output;
     }
 
+    Preprocessor::CachedInclude Preprocessor::preprocessInclude(const std::string &path, std::filesystem::file_time_type modificationTime, u32 lineNumber) {
+        FILE *file = fopen(path.c_str(), "r");
+        if (file == nullptr)
+            throwPreprocessorError(hex::format("%s: No such file or directory", path.c_str()), lineNumber);
+
+        fseek(file, 0, SEEK_END);
+        size_t size = ftell(file);
+        rewind(file);
+
+        std::string buffer(size, 0x00);
+        fread(buffer.data(), size, 1, file);
+
+        fclose(file);
+
+        // The include is preprocessed on its own so the defines, pragmas and files it adds can be cached with it
+        auto defines = std::move(this->m_defines);
+        auto pragmas = std::move(this->m_pragmas);
+        auto includedFiles = std::move(this->m_includedFiles);
+        auto includePositions = std::move(this->m_includePositions);
+        const bool pragmaOnce = this->m_pragmaOnce;
+        this->m_defines.clear();
+        this->m_pragmas.clear();
+        this->m_includedFiles.clear();
+        this->m_includePositions.clear();
+        this->m_pragmaOnce = false;
+
+        this->m_activeIncludes.insert(path);
+        auto preprocessedInclude = this->preprocess(buffer.c_str(), false);
+        this->m_activeIncludes.erase(path);
+
+        if (!preprocessedInclude.has_value())
+            throw this->m_error;
+
+        CachedInclude include = {
+            modificationTime, std::move(preprocessedInclude.value()), std::move(this->m_includePositions), this->m_pragmaOnce,
+            std::move(this->m_defines), std::move(this->m_pragmas), std::move(this->m_includedFiles)
+        };
+
+        std::replace(include.content.begin(), include.content.end(), '\n', ' ');
+        std::replace(include.content.begin(), include.content.end(), '\r', ' ');
+
+        this->m_defines = std::move(defines);
+        this->m_pragmas = std::move(pragmas);
+        this->m_includedFiles = std::move(includedFiles);
+        this->m_includePositions = std::move(includePositions);
+        this->m_pragmaOnce = pragmaOnce;
+
+        return include;
+    }
+
+    void Preprocessor::appendInclude(std::string &output, const std::string &path) {
+        // Every include was brought up to date in the cache when it was encountered
+        const auto &include = this->m_includeCache.at(path);
+
+        if (include.once && !this->m_onceIncluded.insert(path).second)
+            return;
+
+        size_t position = 0;
+        for (const auto &[includePosition, includePath] : include.includes) {
+            output.append(include.content, position, includePosition - position);
+            this->appendInclude(output, includePath);
+            position = includePosition;
+        }
+
+        output.append(include.content, position);
+    }
+
+    static bool isIdentifierCharacter(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    // Replaces every identifier naming a define with its value in a single pass. Nothing inside of string or character literals gets replaced
+    // and neither do parts of longer identifiers or numbers. Values get expanded as well, except for defines used within their own value
+    std::string Preprocessor::expandDefines(const std::string &code) const {
+        if (this->m_defines.empty())
+            return code;
+
+        std::unordered_map<std::string_view, std::string_view> defines;
+        for (const auto &[name, value] : this->m_defines)
+            defines.emplace(name, value);
+
+        std::unordered_map<std::string_view, std::string> expandedValues;
+        std::unordered_set<std::string_view> expanding;
+        bool recursive = false;
+
+        std::function<void(std::string_view, std::string&)> expand = [&](std::string_view text, std::string &result) {
+            size_t offset = 0;
+
+            while (offset < text.length()) {
+                const char c = text[offset];
+                size_t end = offset + 1;
+
+                if (c == '"' || c == '\'') {
+                    while (end < text.length() && text[end] != c)
+                        end += text[end] == '\\' ? 2 : 1;
+
+                    result.append(text.substr(offset, std::min(end + 1, text.length()) - offset));
+                    offset = end + 1;
+                    continue;
+                }
+
+                if (!isIdentifierCharacter(c)) {
+                    result += c;
+                    offset = end;
+                    continue;
+                }
+
+                while (end < text.length() && isIdentifierCharacter(text[end]))
+                    end++;
+
+                const auto word = text.substr(offset, end - offset);
+                offset = end;
+
+                auto define = std::isdigit(static_cast<unsigned char>(word[0])) ? defines.end() : defines.find(word);
+                if (define == defines.end()) {
+                    result.append(word);
+                    continue;
+                }
+
+                if (expanding.contains(word)) {
+                    recursive = true;
+                    result.append(word);
+                    continue;
+                }
+
+                if (auto cached = expandedValues.find(word); cached != expandedValues.end()) {
+                    result.append(cached->second);
+                    continue;
+                }
+
+                // Values depending on a define that's currently being expanded look different elsewhere, they can't be reused
+                const bool outerRecursive = std::exchange(recursive, false);
+
+                std::string value;
+                expanding.insert(word);
+                expand(define->second, value);
+                expanding.erase(word);
+
+                result.append(value);
+                if (!recursive)
+                    expandedValues.emplace(word, std::move(value));
+
+                recursive = recursive || outerRecursive;
+            }
+        };
+
+        std::string result;
+        result.reserve(code.length());
+        expand(code, result);
+
+        return result;
+    }
+
+    bool Preprocessor::areUpToDate(const IncludedFiles &files) {
+        return std::all_of(files.begin(), files.end(), [](const auto &file) {
+            std::error_code error;
+            return std::filesystem::last_write_time(file.first, error) == file.second && !error;
+        });
+    }
+
     void Preprocessor::addPragmaHandler(const std::string &pragmaType, const std::function<bool(const std::string&)> &function) {
         if (!this->m_pragmaHandlers.contains(pragmaType))
             this->m_pragmaHandlers.emplace(pragmaType, function);
     }
 
+    std::optional<u64> Preprocessor::parseLimit(const std::string &pragmaType, const std::string &value) {
+        // The recursion limit is stored in 32 bits, larger values would wrap around and might end up disabling it
+        const u64 maxLimit = pragmaType == "recursion_limit" ? std::numeric_limits<u32>::max() : std::numeric_limits<u64>::max();
+
+        // strtoull accepts a sign and silently negates the value
+        if (value.empty() || !std::isdigit(static_cast<unsigned char>(value.front())))
+            return std::nullopt;
+
+        char *end = nullptr;
+        errno = 0;
+        const u64 limit = std::strtoull(value.c_str(), &end, 0);
+
+        if (*end != '\0' || errno == ERANGE || limit > maxLimit)
+            return std::nullopt;
+
+        return limit;
+    }
+
     void Preprocessor::addDefaultPragmaHandlers() {
         this->addPragmaHandler("MIME", [](const std::string &value) {
             return !std::all_of(value.begin(), value.end(), isspace) && !value.ends_with('\n') && !value.ends_with('\r');
@@ -215,6 +393,14 @@ namespace hex::lang {
         this->addPragmaHandler("endian", [](const std::string &value) {
             return value == "big" || value == "little" || value == "native";
         });
+        for (const std::string pragmaType : { "pattern_limit", "array_limit", "recursion_limit", "time_limit" }) {
+            this->addPragmaHandler(pragmaType, [pragmaType](const std::string &value) {
+                return parseLimit(pragmaType, value).has_value();
+            });
+        }
+        this->addPragmaHandler("profile", [](const std::string &value) {
+            return value == "true" || value == "false";
+        });
     }
 
 }
\ No newline at end of file
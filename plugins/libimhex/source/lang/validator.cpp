@@ -3,6 +3,7 @@
 #include <unordered_set>
 #include <string>
 
+#include <hex/api/content_registry.hpp>
 #include <hex/helpers/utils.hpp>
 
 namespace hex::lang {
@@ -12,37 +13,13 @@ namespace hex::lang {
     }
 
     bool Validator::validate(const std::vector<ASTNode*>& ast) {
-        std::unordered_set<std::string> identifiers;
-
         try {
+            this->checkRedefinitions(ast);
 
             for (const auto &node : ast) {
-                if (node == nullptr)
-                    throwValidateError("nullptr in AST. This is a bug!", 1);
-
-                if (auto variableDeclNode = dynamic_cast<ASTNodeVariableDecl*>(node); variableDeclNode != nullptr) {
-                    if (!identifiers.insert(variableDeclNode->getName().data()).second)
-                        throwValidateError(hex::format("redefinition of identifier '%s'", variableDeclNode->getName().data()), variableDeclNode->getLineNumber());
-
-                    this->validate({ variableDeclNode->getType() });
-                } else if (auto typeDeclNode = dynamic_cast<ASTNodeTypeDecl*>(node); typeDeclNode != nullptr) {
-                    if (!identifiers.insert(typeDeclNode->getName().data()).second)
-                        throwValidateError(hex::format("redefinition of identifier '%s'", typeDeclNode->getName().data()), typeDeclNode->getLineNumber());
-
-                    this->validate({ typeDeclNode->getType() });
-                } else if (auto structNode = dynamic_cast<ASTNodeStruct*>(node); structNode != nullptr) {
-                    this->validate(structNode->getMembers());
-                } else if (auto unionNode = dynamic_cast<ASTNodeUnion*>(node); unionNode != nullptr) {
-                    this->validate(unionNode->getMembers());
-                } else if (auto enumNode = dynamic_cast<ASTNodeEnum*>(node); enumNode != nullptr) {
-                    std::unordered_set<std::string> enumIdentifiers;
-                    for (auto &[name, value] : enumNode->getEntries()) {
-                        if (!enumIdentifiers.insert(name).second)
-                            throwValidateError(hex::format("redefinition of enum constant '%s'", name.c_str()), value->getLineNumber());
-                    }
-                }
+                this->foldConstants(node);
+                this->analyzeLayouts(node);
             }
-
         } catch (ValidatorError &e) {
             this->m_error = e;
             return false;
@@ -51,6 +28,185 @@ namespace hex::lang {
         return true;
     }
 
+    // Only top level names have to be unique, members of a type may shadow each other
+    void Validator::checkRedefinitions(const std::vector<ASTNode*>& ast) {
+        std::unordered_set<std::string> identifiers;
+
+        for (const auto &node : ast) {
+            if (node == nullptr)
+                throwValidateError("nullptr in AST. This is a bug!", 1);
+
+            if (auto variableDeclNode = dynamic_cast<ASTNodeVariableDecl*>(node); variableDeclNode != nullptr) {
+                if (!identifiers.insert(variableDeclNode->getName().data()).second)
+                    throwValidateError(hex::format("redefinition of identifier '%s'", variableDeclNode->getName().data()), variableDeclNode->getLineNumber());
+            } else if (auto typeDeclNode = dynamic_cast<ASTNodeTypeDecl*>(node); typeDeclNode != nullptr) {
+                if (!identifiers.insert(typeDeclNode->getName().data()).second)
+                    throwValidateError(hex::format("redefinition of identifier '%s'", typeDeclNode->getName().data()), typeDeclNode->getLineNumber());
+            }
+        }
+    }
+
+    // Returns the value of the node if it's a constant expression. Every numeric expression below the node that only consists
+    // of literals gets its value set, so the evaluator doesn't have to go through its operands again for every pattern using it.
+    // Function calls get bound to their registered function on the way so they don't have to be looked up by name on every call
+    std::optional<Token::IntegerLiteral> Validator::foldConstants(ASTNode *node) {
+        if (node == nullptr)
+            return { };
+
+        auto foldAll = [this](const auto &nodes) {
+            for (const auto &child : nodes)
+                this->foldConstants(child);
+        };
+
+        switch (node->getKind()) {
+            case ASTNode::Kind::IntegerLiteral: {
+                auto literal = static_cast<ASTNodeIntegerLiteral*>(node);
+                return Token::IntegerLiteral{ literal->getType(), literal->getValue() };
+            }
+            case ASTNode::Kind::NumericExpression: {
+                auto expression = static_cast<ASTNodeNumericExpression*>(node);
+                auto left = this->foldConstants(expression->getLeftOperand());
+                auto right = this->foldConstants(expression->getRightOperand());
+
+                if (!left.has_value() || !right.has_value())
+                    return { };
+
+                // Divisions by zero and other invalid operations are left to the evaluation to report
+                const auto op = expression->getOperator();
+                if ((op == Token::Operator::Slash || op == Token::Operator::Percent) && std::visit([](auto value) { return value == 0; }, right->second))
+                    return { };
+
+                try {
+                    auto value = this->m_constantEvaluator.evaluateOperator(*left, *right, op);
+                    expression->setConstantValue(value);
+                    return value;
+                } catch (LogConsole::EvaluateError &) {
+                    return { };
+                }
+            }
+            case ASTNode::Kind::TernaryExpression: {
+                auto expression = static_cast<ASTNodeTernaryExpression*>(node);
+                auto condition = this->foldConstants(expression->getFirstOperand());
+                auto first = this->foldConstants(expression->getSecondOperand());
+                auto second = this->foldConstants(expression->getThirdOperand());
+
+                if (!condition.has_value() || expression->getOperator() != Token::Operator::TernaryConditional)
+                    return { };
+
+                return std::visit([](auto value) { return value != 0; }, condition->second) ? first : second;
+            }
+            case ASTNode::Kind::TypeDecl:
+                this->foldConstants(static_cast<ASTNodeTypeDecl*>(node)->getType());
+                break;
+            case ASTNode::Kind::VariableDecl: {
+                auto variableDecl = static_cast<ASTNodeVariableDecl*>(node);
+                this->foldConstants(variableDecl->getType());
+                this->foldConstants(variableDecl->getPlacementOffset());
+                break;
+            }
+            case ASTNode::Kind::ArrayVariableDecl: {
+                auto arrayDecl = static_cast<ASTNodeArrayVariableDecl*>(node);
+                this->foldConstants(arrayDecl->getType());
+                this->foldConstants(arrayDecl->getSize());
+                this->foldConstants(arrayDecl->getPlacementOffset());
+                break;
+            }
+            case ASTNode::Kind::PointerVariableDecl: {
+                auto pointerDecl = static_cast<ASTNodePointerVariableDecl*>(node);
+                this->foldConstants(pointerDecl->getType());
+                this->foldConstants(pointerDecl->getSizeType());
+                this->foldConstants(pointerDecl->getPlacementOffset());
+                break;
+            }
+            case ASTNode::Kind::Struct:
+                foldAll(static_cast<ASTNodeStruct*>(node)->getMembers());
+                break;
+            case ASTNode::Kind::Union:
+                foldAll(static_cast<ASTNodeUnion*>(node)->getMembers());
+                break;
+            case ASTNode::Kind::Enum: {
+                auto enumNode = static_cast<ASTNodeEnum*>(node);
+                for (const auto &[name, value] : enumNode->getEntries())
+                    this->foldConstants(value);
+                break;
+            }
+            case ASTNode::Kind::Bitfield:
+                for (const auto &[name, size] : static_cast<ASTNodeBitfield*>(node)->getEntries())
+                    this->foldConstants(size);
+                break;
+            case ASTNode::Kind::ConditionalStatement: {
+                auto conditional = static_cast<ASTNodeConditionalStatement*>(node);
+                this->foldConstants(conditional->getCondition());
+                foldAll(conditional->getTrueBody());
+                foldAll(conditional->getFalseBody());
+                break;
+            }
+            case ASTNode::Kind::FunctionCall: {
+                auto functionCall = static_cast<ASTNodeFunctionCall*>(node);
+                foldAll(functionCall->getParams());
+
+                // Unknown functions are only reported once the call actually gets evaluated
+                auto &functions = ContentRegistry::PatternLanguageFunctions::getEntries();
+                if (auto function = functions.find(std::string(functionCall->getFunctionName())); function != functions.end())
+                    functionCall->setFunction(&function->second);
+                break;
+            }
+            default:
+                break;
+        }
+
+        return { };
+    }
+
+    // Types nested in a type are handled first, so the evaluator's check for a static layout only ever has to look at one level of members
+    void Validator::analyzeLayouts(ASTNode *node) {
+        if (node == nullptr)
+            return;
+
+        auto analyzeAll = [this](const auto &nodes) {
+            for (const auto &child : nodes)
+                this->analyzeLayouts(child);
+        };
+
+        switch (node->getKind()) {
+            case ASTNode::Kind::TypeDecl: {
+                auto typeDecl = static_cast<ASTNodeTypeDecl*>(node);
+                this->analyzeLayouts(typeDecl->getType());
+                typeDecl->setStaticLayout(Evaluator::isStaticType(typeDecl));
+                break;
+            }
+            case ASTNode::Kind::VariableDecl:
+                this->analyzeLayouts(static_cast<ASTNodeVariableDecl*>(node)->getType());
+                break;
+            case ASTNode::Kind::ArrayVariableDecl:
+                this->analyzeLayouts(static_cast<ASTNodeArrayVariableDecl*>(node)->getType());
+                break;
+            case ASTNode::Kind::PointerVariableDecl: {
+                auto pointerDecl = static_cast<ASTNodePointerVariableDecl*>(node);
+                this->analyzeLayouts(pointerDecl->getType());
+                this->analyzeLayouts(pointerDecl->getSizeType());
+                break;
+            }
+            case ASTNode::Kind::Struct:
+                analyzeAll(static_cast<ASTNodeStruct*>(node)->getMembers());
+                break;
+            case ASTNode::Kind::Union:
+                analyzeAll(static_cast<ASTNodeUnion*>(node)->getMembers());
+                break;
+            case ASTNode::Kind::Enum:
+                this->analyzeLayouts(static_cast<ASTNodeEnum*>(node)->getUnderlyingType());
+                break;
+            case ASTNode::Kind::ConditionalStatement: {
+                auto conditional = static_cast<ASTNodeConditionalStatement*>(node);
+                analyzeAll(conditional->getTrueBody());
+                analyzeAll(conditional->getFalseBody());
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
     void Validator::printAST(const std::vector<ASTNode*>& ast){
     #if DEBUG
         #define INDENT_VALUE indent, ' '
@@ -0,0 +1,195 @@
+#include <hex/providers/block_cache.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace hex::prv {
+
+    namespace {
+
+        // Scans never get far ahead of where they're read, so a few read-aheads worth of blocks are all they need
+        constexpr size_t ScanReadAheads = 2;
+        constexpr size_t MaxScanRanges = 16;
+
+    }
+
+    BlockCache::BlockCache(size_t blockSize, size_t maxBlocks, size_t readAheadBlocks)
+        : m_blockSize(std::max<size_t>(blockSize, 1)), m_readAheadBlocks(readAheadBlocks) {
+        this->m_blocks.maxBlocks = std::max<size_t>(maxBlocks, 1);
+        this->m_scanBlocks.maxBlocks = std::min(this->m_blocks.maxBlocks, (readAheadBlocks + 1) * ScanReadAheads);
+
+        this->m_memoryRegistration = MemoryBudget::Registration("Block caches",
+            [this] { return this->getMemoryUsage(); },
+            [this](size_t size) { return this->trim(size); },
+            MemoryBudget::Priority::ReadCache);
+    }
+
+    void BlockCache::read(u64 offset, void *buffer, size_t size, size_t dataSize, const FetchFunction &fetch) {
+        if (buffer == nullptr || size == 0 || offset + size > dataSize)
+            return;
+
+        std::scoped_lock lock(this->m_mutex);
+
+        const u64 end = offset + size;
+        for (u64 blockAddress = offset - (offset % this->m_blockSize); blockAddress < end; blockAddress += this->m_blockSize) {
+            const auto &block = this->getBlock(blockAddress, dataSize, fetch);
+
+            u64 from = std::max(blockAddress, offset);
+            u64 to   = std::min(blockAddress + block.size(), end);
+
+            std::memcpy(reinterpret_cast<u8*>(buffer) + (from - offset), block.data() + (from - blockAddress), to - from);
+        }
+    }
+
+    void BlockCache::invalidate() {
+        std::scoped_lock lock(this->m_mutex);
+
+        for (auto list : { &this->m_blocks, &this->m_scanBlocks }) {
+            list->blocks.clear();
+            list->lookup.clear();
+        }
+    }
+
+    void BlockCache::invalidate(u64 offset, size_t size) {
+        std::scoped_lock lock(this->m_mutex);
+
+        removeBlocks(this->m_blocks, offset, size, this->m_blockSize);
+        removeBlocks(this->m_scanBlocks, offset, size, this->m_blockSize);
+    }
+
+    size_t BlockCache::getMemoryUsage() {
+        std::scoped_lock lock(this->m_mutex);
+
+        return (this->m_blocks.blocks.size() + this->m_scanBlocks.blocks.size()) * this->m_blockSize;
+    }
+
+    size_t BlockCache::trim(size_t size) {
+        std::scoped_lock lock(this->m_mutex);
+
+        size_t freed = 0;
+        for (auto list : { &this->m_scanBlocks, &this->m_blocks }) {
+            while (freed < size && !list->blocks.empty()) {
+                freed += list->blocks.back().data.size();
+
+                list->lookup.erase(list->blocks.back().address);
+                list->blocks.pop_back();
+            }
+        }
+
+        return freed;
+    }
+
+    void BlockCache::hint(u64 offset, size_t size, AccessHint hint) {
+        if (size == 0)
+            return;
+
+        std::scoped_lock lock(this->m_mutex);
+
+        const u64 end = offset + size;
+
+        if (hint == AccessHint::Sequential) {
+            if (this->m_scanRanges.size() >= MaxScanRanges)
+                this->m_scanRanges.erase(this->m_scanRanges.begin());
+
+            this->m_scanRanges.emplace_back(offset, end);
+        } else if (hint == AccessHint::Random || hint == AccessHint::DontNeed) {
+            std::erase_if(this->m_scanRanges, [&](const auto &range) { return range.first < end && offset < range.second; });
+
+            // Blocks read interactively meanwhile are in the regular cache, they're kept
+            if (hint == AccessHint::DontNeed)
+                removeBlocks(this->m_scanBlocks, offset, size, this->m_blockSize);
+        }
+
+        // Prefetching would need a fetch function, blocks that will be needed get read ahead once the first of them gets read
+    }
+
+    void BlockCache::resetStatistics() {
+        this->m_hits = 0;
+        this->m_misses = 0;
+    }
+
+
+    const std::vector<u8>& BlockCache::getBlock(u64 address, size_t dataSize, const FetchFunction &fetch) {
+        const bool sequential = address == this->m_lastBlockAddress + this->m_blockSize;
+        this->m_lastBlockAddress = address;
+
+        for (auto list : { &this->m_blocks, &this->m_scanBlocks }) {
+            if (auto it = list->lookup.find(address); it != list->lookup.end()) {
+                this->m_hits++;
+                list->blocks.splice(list->blocks.begin(), list->blocks, it->second);
+                return it->second->data;
+            }
+        }
+
+        this->m_misses++;
+
+        const bool scanned = this->isScanned(address);
+        auto &list = scanned ? this->m_scanBlocks : this->m_blocks;
+
+        // Fetch the following blocks in the same request when the data is being read sequentially
+        size_t blockCount = 1;
+        if (sequential || scanned)
+            blockCount += std::min(this->m_readAheadBlocks, list.maxBlocks - 1);
+
+        const size_t fetchSize = std::min<u64>(this->m_blockSize * blockCount, dataSize - address);
+
+        std::vector<u8> buffer(fetchSize);
+        fetch(address, buffer.data(), buffer.size());
+
+        // Insert read-ahead blocks first so the requested block ends up least likely to be evicted
+        for (u64 blockOffset = this->m_blockSize * ((fetchSize - 1) / this->m_blockSize); blockOffset > 0; blockOffset -= this->m_blockSize) {
+            if (this->m_blocks.lookup.contains(address + blockOffset) || this->m_scanBlocks.lookup.contains(address + blockOffset))
+                continue;
+
+            const size_t blockSize = std::min<u64>(this->m_blockSize, fetchSize - blockOffset);
+            insertBlock(list, address + blockOffset, std::vector<u8>(buffer.begin() + blockOffset, buffer.begin() + blockOffset + blockSize));
+        }
+
+        buffer.resize(std::min<size_t>(this->m_blockSize, fetchSize));
+        insertBlock(list, address, std::move(buffer));
+
+        return list.blocks.front().data;
+    }
+
+    bool BlockCache::isScanned(u64 address) const {
+        return std::any_of(this->m_scanRanges.begin(), this->m_scanRanges.end(), [address](const auto &range) {
+            return address >= range.first && address < range.second;
+        });
+    }
+
+    void BlockCache::insertBlock(BlockList &list, u64 address, std::vector<u8> &&data) {
+        while (list.blocks.size() >= list.maxBlocks) {
+            list.lookup.erase(list.blocks.back().address);
+            list.blocks.pop_back();
+        }
+
+        list.blocks.push_front({ address, std::move(data) });
+        list.lookup[address] = list.blocks.begin();
+    }
+
+    void BlockCache::removeBlocks(BlockList &list, u64 offset, size_t size, size_t blockSize) {
+        const u64 end = offset + size;
+
+        // Ranges covering more blocks than there are cached, like all of the data after a scan, are cheaper to handle by going through the cached blocks
+        if (size / blockSize > list.blocks.size()) {
+            for (auto it = list.blocks.begin(); it != list.blocks.end(); ) {
+                if (it->address + blockSize > offset && it->address < end) {
+                    list.lookup.erase(it->address);
+                    it = list.blocks.erase(it);
+                } else {
+                    it++;
+                }
+            }
+
+            return;
+        }
+
+        for (u64 blockAddress = offset - (offset % blockSize); blockAddress < end; blockAddress += blockSize) {
+            if (auto it = list.lookup.find(blockAddress); it != list.lookup.end()) {
+                list.blocks.erase(it->second);
+                list.lookup.erase(it);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,66 @@
+#include <hex/providers/data_chunks.hpp>
+
+#include <hex/api/content_registry.hpp>
+#include <hex/providers/provider.hpp>
+
+#include <algorithm>
+
+namespace hex::prv {
+
+    DataChunks::DataChunks(Provider *provider, u64 offset, u64 size, size_t chunkSize)
+        : m_provider(provider), m_offset(offset), m_size(size), m_chunkSize(std::max<size_t>(chunkSize, 1)) {
+
+    }
+
+    DataChunks::Iterator DataChunks::begin() {
+        this->read(this->m_offset);
+
+        return Iterator(this);
+    }
+
+    std::vector<DataChunks> DataChunks::partition(size_t count) const {
+        const u64 chunkCount = (this->m_size + this->m_chunkSize - 1) / this->m_chunkSize;
+        const u64 partCount = std::clamp<u64>(count, 1, std::max<u64>(chunkCount, 1));
+
+        std::vector<DataChunks> parts;
+        for (u64 part = 0; part < partCount; part++) {
+            const u64 start = std::min<u64>(chunkCount * part / partCount * this->m_chunkSize, this->m_size);
+            const u64 end   = std::min<u64>(chunkCount * (part + 1) / partCount * this->m_chunkSize, this->m_size);
+
+            parts.emplace_back(this->m_provider, this->m_offset + start, end - start, this->m_chunkSize);
+        }
+
+        return parts;
+    }
+
+    void DataChunks::advance() {
+        this->read(this->m_chunkOffset + this->m_chunk.size());
+    }
+
+    void DataChunks::read(u64 offset) {
+        const u64 end = this->m_offset + this->m_size;
+        if (this->m_provider == nullptr || offset >= end) {
+            this->m_chunk = { };
+            return;
+        }
+
+        this->m_chunkOffset = offset;
+        const size_t size = std::min<u64>(this->m_chunkSize, end - offset);
+
+        if (this->m_provider->getCapabilities() & (ContentRegistry::Providers::Mappable | ContentRegistry::Providers::ChunkSpans)) {
+            if (auto resident = this->m_provider->getResidentData(offset, size); resident != nullptr && !this->m_provider->isPatched(offset, size)) {
+                this->m_chunk = { resident, size };
+                return;
+            }
+        }
+
+        // Buffers alternate so the previous chunk stays valid, they're only allocated once some chunk actually has to be copied
+        auto &buffer = this->m_buffers[this->m_bufferIndex++ % this->m_buffers.size()];
+        if (buffer.empty())
+            buffer.resize(std::min<u64>(this->m_chunkSize, this->m_size));
+
+        this->m_provider->readAbsolute(offset, buffer.data(), size);
+        this->m_chunk = { buffer.data(), size };
+    }
+
+}
@@ -0,0 +1,92 @@
+#include <hex/providers/overlay.hpp>
+
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace hex::prv {
+
+    Overlay::~Overlay() {
+        if (this->m_file != nullptr)
+            fclose(this->m_file);
+    }
+
+    void Overlay::write(u64 offset, const u8 *data, size_t size) {
+        if (size == 0)
+            return;
+
+        std::scoped_lock lock(this->m_mutex);
+
+        if (this->m_file == nullptr && offset + size > MaxMemorySize) {
+            // Overlays stay in memory if no temporary file can be created
+            this->m_file = std::tmpfile();
+
+            if (this->m_file != nullptr) {
+                fwrite(this->m_data.data(), 1, this->m_data.size(), this->m_file);
+
+                this->m_data.clear();
+                this->m_data.shrink_to_fit();
+            }
+        }
+
+        if (this->m_file != nullptr) {
+            // Gaps get filled with zeros by the file system
+            fseeko64(this->m_file, offset, SEEK_SET);
+            fwrite(data, 1, size, this->m_file);
+        } else {
+            if (this->m_data.size() < offset + size)
+                this->m_data.resize(offset + size, 0x00);
+
+            std::memcpy(this->m_data.data() + offset, data, size);
+        }
+
+        this->m_size = std::max<u64>(this->m_size, offset + size);
+        this->markChanged();
+    }
+
+    void Overlay::read(u64 offset, u8 *buffer, size_t size) const {
+        std::scoped_lock lock(this->m_mutex);
+
+        if (offset >= this->m_size)
+            return;
+
+        size = std::min<u64>(size, this->m_size - offset);
+
+        if (this->m_file != nullptr) {
+            fflush(this->m_file);
+            fseeko64(this->m_file, offset, SEEK_SET);
+            fread(buffer, 1, size, this->m_file);
+        } else
+            std::memcpy(buffer, this->m_data.data() + offset, size);
+    }
+
+    void Overlay::clear() {
+        std::scoped_lock lock(this->m_mutex);
+
+        if (this->m_file != nullptr) {
+            fclose(this->m_file);
+            this->m_file = nullptr;
+        }
+
+        this->m_data.clear();
+        this->m_size = 0;
+        this->markChanged();
+    }
+
+    void Overlay::swap(Overlay &other) {
+        if (&other == this)
+            return;
+
+        std::scoped_lock lock(this->m_mutex, other.m_mutex);
+
+        std::swap(this->m_address, other.m_address);
+        std::swap(this->m_size, other.m_size);
+        std::swap(this->m_data, other.m_data);
+        std::swap(this->m_file, other.m_file);
+
+        this->markChanged();
+        other.markChanged();
+    }
+
+}
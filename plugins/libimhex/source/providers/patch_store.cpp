@@ -0,0 +1,376 @@
+#include <hex/providers/patch_store.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace hex::prv {
+
+    void PatchStore::write(u64 address, const void *buffer, size_t size) {
+        if (buffer == nullptr || size == 0)
+            return;
+
+        auto bytes = reinterpret_cast<const u8*>(buffer);
+
+        Delta delta = { address, size, this->extractRange(address, size), { { address, std::vector<u8>(bytes, bytes + size) } } };
+        this->replaceRange(address, size, delta.after);
+        this->notifyChange(address, size, delta.after);
+
+        this->m_undoLog.push_back(std::move(delta));
+        this->m_redoLog.clear();
+        this->m_generation++;
+    }
+
+    void PatchStore::write(const std::vector<Run> &runs) {
+        if (runs.empty())
+            return;
+
+        // One delta covering everything from the first to the last run, so undoing thousands of runs is a single step as well
+        const u64 address = runs.front().first;
+        const size_t size = runs.back().first + runs.back().second.size() - address;
+
+        Delta delta = { address, size, this->extractRange(address, size), { } };
+        for (const auto &[runAddress, run] : runs) {
+            if (this->overwrite(runAddress, run.data(), run.size()))
+                continue;
+
+            this->removeRange(runAddress, run.size());
+            this->insertRun(runAddress, run.data(), run.size());
+        }
+        delta.after = this->extractRange(address, size);
+        this->notifyChange(address, size, delta.after);
+
+        this->m_undoLog.push_back(std::move(delta));
+        this->m_redoLog.clear();
+        this->m_generation++;
+    }
+
+    void PatchStore::erase(u64 address, size_t size) {
+        if (size == 0)
+            return;
+
+        auto before = this->extractRange(address, size);
+        if (before.empty())
+            return;
+
+        this->removeRange(address, size);
+        this->notifyChange(address, size, { });
+
+        this->m_undoLog.push_back({ address, size, std::move(before), { } });
+        this->m_redoLog.clear();
+        this->m_generation++;
+    }
+
+    void PatchStore::assign(const std::map<u64, u8> &patches) {
+        this->clear();
+
+        for (const auto &[address, value] : patches)
+            this->insertRun(address, &value, 1);
+
+        if (this->m_changeCallback)
+            this->notifyChange(0, EntireAddressSpace, { this->m_runs->begin(), this->m_runs->end() });
+    }
+
+    void PatchStore::assign(const Runs &patches) {
+        this->clear();
+
+        for (const auto &[address, data] : patches) {
+            this->removeRange(address, data.size());
+            this->insertRun(address, data.data(), data.size());
+        }
+
+        if (this->m_changeCallback)
+            this->notifyChange(0, EntireAddressSpace, { this->m_runs->begin(), this->m_runs->end() });
+    }
+
+    void PatchStore::clear() {
+        // Snapshots sharing the old runs keep them
+        this->m_runs = std::make_shared<Runs>();
+        this->m_undoLog.clear();
+        this->m_redoLog.clear();
+        this->m_generation++;
+
+        this->notifyChange(0, EntireAddressSpace, { });
+    }
+
+
+    bool PatchStore::undo() {
+        if (this->m_undoLog.empty())
+            return false;
+
+        auto delta = std::move(this->m_undoLog.back());
+        this->m_undoLog.pop_back();
+
+        this->replaceRange(delta.address, delta.size, delta.before);
+        this->notifyChange(delta.address, delta.size, delta.before);
+        this->m_redoLog.push_back(std::move(delta));
+        this->m_generation++;
+
+        return true;
+    }
+
+    bool PatchStore::redo() {
+        if (this->m_redoLog.empty())
+            return false;
+
+        auto delta = std::move(this->m_redoLog.back());
+        this->m_redoLog.pop_back();
+
+        this->replaceRange(delta.address, delta.size, delta.after);
+        this->notifyChange(delta.address, delta.size, delta.after);
+        this->m_undoLog.push_back(std::move(delta));
+        this->m_generation++;
+
+        return true;
+    }
+
+
+    std::optional<std::pair<u64, size_t>> PatchStore::getUndoRange() const {
+        if (this->m_undoLog.empty())
+            return { };
+
+        return std::pair { this->m_undoLog.back().address, this->m_undoLog.back().size };
+    }
+
+    std::optional<std::pair<u64, size_t>> PatchStore::getRedoRange() const {
+        if (this->m_redoLog.empty())
+            return { };
+
+        return std::pair { this->m_redoLog.back().address, this->m_redoLog.back().size };
+    }
+
+
+    std::optional<u8> PatchStore::get(u64 address) const {
+        const auto &runs = *this->m_runs;
+
+        auto it = runs.upper_bound(address);
+        if (it == runs.begin())
+            return { };
+
+        it = std::prev(it);
+        if (address >= it->first + it->second.size())
+            return { };
+
+        return it->second[address - it->first];
+    }
+
+    void PatchStore::apply(u64 address, void *buffer, size_t size) const {
+        PatchStore::apply(*this->m_runs, address, buffer, size);
+    }
+
+    void PatchStore::apply(const Runs &runs, u64 address, void *buffer, size_t size) {
+        if (runs.empty() || buffer == nullptr || size == 0)
+            return;
+
+        const u64 end = address + size;
+
+        auto it = runs.upper_bound(address);
+        if (it != runs.begin())
+            it = std::prev(it);
+
+        for (; it != runs.end() && it->first < end; it++) {
+            const auto &[runAddress, run] = *it;
+            const u64 runEnd = runAddress + run.size();
+
+            if (runEnd <= address)
+                continue;
+
+            u64 from = std::max(runAddress, address);
+            u64 to   = std::min(runEnd, end);
+
+            std::memcpy(reinterpret_cast<u8*>(buffer) + (from - address), run.data() + (from - runAddress), to - from);
+        }
+    }
+
+    bool PatchStore::intersects(u64 address, size_t size) const {
+        const auto &runs = *this->m_runs;
+
+        if (runs.empty() || size == 0)
+            return false;
+
+        auto it = runs.lower_bound(address + size);
+        if (it == runs.begin())
+            return false;
+
+        it = std::prev(it);
+        return it->first + it->second.size() > address;
+    }
+
+    std::map<u64, u8> PatchStore::flatten() const {
+        const auto &runs = *this->m_runs;
+        std::map<u64, u8> result;
+
+        for (const auto &[address, run] : runs)
+            for (u64 i = 0; i < run.size(); i++)
+                result.emplace_hint(result.end(), address + i, run[i]);
+
+        return result;
+    }
+
+    size_t PatchStore::getPatchedByteCount() const {
+        const auto &runs = *this->m_runs;
+        size_t count = 0;
+
+        for (const auto &[address, run] : runs)
+            count += run.size();
+
+        return count;
+    }
+
+
+    std::vector<PatchStore::Run> PatchStore::extractRange(u64 address, size_t size) const {
+        const auto &runs = *this->m_runs;
+        std::vector<Run> result;
+        const u64 end = address + size;
+
+        auto it = runs.upper_bound(address);
+        if (it != runs.begin())
+            it = std::prev(it);
+
+        for (; it != runs.end() && it->first < end; it++) {
+            const auto &[runAddress, run] = *it;
+            const u64 runEnd = runAddress + run.size();
+
+            if (runEnd <= address)
+                continue;
+
+            u64 from = std::max(runAddress, address);
+            u64 to   = std::min(runEnd, end);
+
+            result.emplace_back(from, std::vector<u8>(run.begin() + (from - runAddress), run.begin() + (to - runAddress)));
+        }
+
+        return result;
+    }
+
+    bool PatchStore::overwrite(u64 address, const u8 *data, size_t size) {
+        auto covers = [address, size](const Runs &runs) {
+            auto it = runs.upper_bound(address);
+            if (it == runs.begin())
+                return runs.end();
+
+            it = std::prev(it);
+            return address + size <= it->first + it->second.size() ? it : runs.end();
+        };
+
+        if (covers(*this->m_runs) == this->m_runs->end())
+            return false;
+
+        // Looked up again, getting the runs to modify may have copied them
+        auto &runs = this->getMutableRuns();
+        auto &[runAddress, run] = *runs.find(covers(runs)->first);
+        std::copy(data, data + size, run.modify().begin() + (address - runAddress));
+
+        return true;
+    }
+
+    void PatchStore::removeRange(u64 address, size_t size) {
+        auto &runs = this->getMutableRuns();
+
+        const u64 end = address + size;
+
+        // Split the run that starts before the range and reaches into it. Runs are short, so that only ever copies a little
+        auto it = runs.upper_bound(address);
+        if (it != runs.begin()) {
+            auto prev = std::prev(it);
+            auto &[prevAddress, prevRun] = *prev;
+            const u64 prevEnd = prevAddress + prevRun.size();
+
+            if (prevEnd > address) {
+                if (prevEnd > end)
+                    runs.emplace_hint(it, end, Bytes(prevRun.begin() + (end - prevAddress), prevRun.end()));
+
+                if (address == prevAddress)
+                    runs.erase(prev);
+                else
+                    prevRun.modify().resize(address - prevAddress);
+            }
+        }
+
+        // Drop all runs that start inside the range, keeping the tail of the last one
+        it = runs.lower_bound(address);
+        while (it != runs.end() && it->first < end) {
+            const u64 runEnd = it->first + it->second.size();
+
+            if (runEnd <= end) {
+                it = runs.erase(it);
+            } else {
+                Bytes tail(it->second.begin() + (end - it->first), it->second.end());
+                it = runs.erase(it);
+                runs.emplace_hint(it, end, std::move(tail));
+                break;
+            }
+        }
+    }
+
+    void PatchStore::insertRun(u64 address, const u8 *data, size_t size) {
+        auto &runs = this->getMutableRuns();
+
+        while (size > 0) {
+            const size_t partSize = std::min<u64>(size, MaxRunSize - address % MaxRunSize);
+            const u64 end = address + partSize;
+
+            auto next = runs.lower_bound(address);
+
+            // Runs are only merged with the ones right next to them as long as they don't reach beyond a multiple of the maximum size that way
+            const bool mergeNext = next != runs.end() && next->first == end && end % MaxRunSize != 0;
+            auto prev = next != runs.begin() ? std::prev(next) : runs.end();
+            const bool mergePrev = prev != runs.end() && prev->first + prev->second.size() == address && address % MaxRunSize != 0;
+
+            if (mergePrev) {
+                auto &bytes = prev->second.modify();
+                bytes.insert(bytes.end(), data, data + partSize);
+
+                if (mergeNext) {
+                    bytes.insert(bytes.end(), next->second.begin(), next->second.end());
+                    runs.erase(next);
+                }
+            } else {
+                std::vector<u8> bytes(data, data + partSize);
+
+                if (mergeNext) {
+                    bytes.insert(bytes.end(), next->second.begin(), next->second.end());
+                    next = runs.erase(next);
+                }
+
+                runs.emplace_hint(next, address, std::move(bytes));
+            }
+
+            address += partSize;
+            data += partSize;
+            size -= partSize;
+        }
+    }
+
+    PatchStore::Runs& PatchStore::getMutableRuns() {
+        // Someone else still holds on to the runs, so they get copied before being modified. The bytes stay shared until they're modified themselves
+        if (this->m_runs.use_count() > 1)
+            this->m_runs = std::make_shared<Runs>(*this->m_runs);
+
+        return *this->m_runs;
+    }
+
+    std::vector<u8>& PatchStore::Bytes::modify() {
+        if (this->m_bytes.use_count() > 1)
+            this->m_bytes = std::make_shared<std::vector<u8>>(*this->m_bytes);
+
+        return *this->m_bytes;
+    }
+
+    void PatchStore::replaceRange(u64 address, size_t size, const std::vector<Run> &runs) {
+        // Bytes that were patched before already are only overwritten
+        if (runs.size() == 1 && runs.front().first == address && runs.front().second.size() == size && this->overwrite(address, runs.front().second.data(), size))
+            return;
+
+        this->removeRange(address, size);
+
+        for (const auto &[runAddress, run] : runs)
+            this->insertRun(runAddress, run.data(), run.size());
+    }
+
+    void PatchStore::notifyChange(u64 address, u64 size, const std::vector<Run> &runs) const {
+        if (this->m_changeCallback)
+            this->m_changeCallback(address, size, runs);
+    }
+
+}
@@ -0,0 +1,303 @@
+#include <hex/providers/piece_table.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace hex::prv {
+
+    void PieceTable::replace(u64 originalSize, u64 address, u64 size, std::vector<u8> data) {
+        this->record(originalSize, address, size, std::move(data), false);
+
+        this->m_redoLog.clear();
+        this->m_generation++;
+    }
+
+    void PieceTable::overwrite(u64 originalSize, const std::vector<std::pair<u64, std::vector<u8>>> &runs) {
+        bool joined = false;
+        for (const auto &[address, data] : runs) {
+            if (data.empty())
+                continue;
+
+            this->record(originalSize, address, data.size(), data, joined);
+            joined = true;
+        }
+
+        if (!joined)
+            return;
+
+        this->m_redoLog.clear();
+        this->m_generation++;
+    }
+
+    void PieceTable::record(u64 originalSize, u64 address, u64 size, std::vector<u8> data, bool joined) {
+        auto delta = this->createBytesDelta(originalSize, address, size, data);
+        if (!delta.has_value())
+            delta = this->createPiecesDelta(originalSize, address, size, std::move(data));
+
+        delta->joined = joined;
+        this->apply(*delta, false);
+
+        this->m_undoLog.push_back(std::move(*delta));
+    }
+
+    void PieceTable::clear() {
+        this->m_pieces = nullptr;
+        this->m_undoLog.clear();
+        this->m_redoLog.clear();
+        this->m_generation++;
+    }
+
+    bool PieceTable::undo() {
+        if (this->m_undoLog.empty())
+            return false;
+
+        // Joined deltas are undone back to the first one of their edit
+        bool joined;
+        do {
+            joined = this->m_undoLog.back().joined;
+
+            this->apply(this->m_undoLog.back(), true);
+            this->m_redoLog.push_back(std::move(this->m_undoLog.back()));
+            this->m_undoLog.pop_back();
+        } while (joined);
+        this->m_generation++;
+
+        return true;
+    }
+
+    bool PieceTable::redo() {
+        if (this->m_redoLog.empty())
+            return false;
+
+        do {
+            this->apply(this->m_redoLog.back(), false);
+            this->m_undoLog.push_back(std::move(this->m_redoLog.back()));
+            this->m_redoLog.pop_back();
+        } while (!this->m_redoLog.empty() && this->m_redoLog.back().joined);
+        this->m_generation++;
+
+        return true;
+    }
+
+    std::optional<PieceTable::Delta> PieceTable::createBytesDelta(u64 originalSize, u64 address, u64 size, const std::vector<u8> &data) const {
+        if (this->m_pieces == nullptr || data.empty() || (size != 0 && size != data.size()))
+            return std::nullopt;
+
+        // Overwrites have to stay within the piece, insertions continue the piece ending where they start
+        const auto &pieces = *this->m_pieces;
+        auto piece = size == 0 ? (address == 0 ? pieces.end() : findPiece(pieces, address - 1)) : findPiece(pieces, address);
+        if (piece == pieces.end() || piece->isOriginal() || address + size > piece->address + piece->size)
+            return std::nullopt;
+        if (size == 0 && address != piece->address + piece->size)
+            return std::nullopt;
+
+        const bool inPlace = this->m_pieces.use_count() == 1 && piece->inserted.use_count() == 1 && (size != 0 || piece->source + piece->size == piece->inserted->size());
+        if (!inPlace && piece->size > MaxCopiedPieceSize)
+            return std::nullopt;
+
+        const u64 offset = address - piece->address;
+        const auto bytes = piece->inserted->begin() + piece->source + offset;
+
+        return Delta { Delta::Type::Bytes, originalSize, size_t(piece - pieces.begin()), { }, { }, offset, { bytes, bytes + size }, data };
+    }
+
+    PieceTable::Delta PieceTable::createPiecesDelta(u64 originalSize, u64 address, u64 size, std::vector<u8> data) const {
+        Pieces original;
+        if (this->m_pieces == nullptr && originalSize > 0)
+            original.push_back({ 0, originalSize, 0, nullptr });
+
+        const Pieces &previous = this->m_pieces != nullptr ? *this->m_pieces : original;
+
+        const u64 end = address + size;
+        const u64 dataSize = data.size();
+
+        // Pieces overlapping the range get replaced, the ones right next to it as well since the new pieces may get merged with them
+        auto first = std::lower_bound(previous.begin(), previous.end(), address, [](const Piece &piece, u64 address) { return piece.address + piece.size < address; });
+        auto last  = std::upper_bound(first, previous.end(), end, [](u64 end, const Piece &piece) { return end < piece.address; });
+
+        Pieces pieces;
+
+        // Pieces that continue where the previous one ended in the same source are merged, so removing and inserting back doesn't fragment the table
+        auto addPiece = [&pieces](Piece piece) {
+            if (!pieces.empty()) {
+                auto &last = pieces.back();
+                if (last.inserted == piece.inserted && last.source + last.size == piece.source && last.address + last.size == piece.address) {
+                    last.size += piece.size;
+                    return;
+                }
+            }
+
+            pieces.push_back(std::move(piece));
+        };
+
+        bool dataAdded = false;
+        auto addData = [&] {
+            if (dataSize > 0)
+                addPiece({ address, dataSize, 0, std::make_shared<std::vector<u8>>(std::move(data)) });
+
+            dataAdded = true;
+        };
+
+        for (auto piece = first; piece != last; piece++) {
+            const u64 pieceEnd = piece->address + piece->size;
+
+            if (pieceEnd <= address) {
+                addPiece(*piece);
+                continue;
+            }
+
+            if (piece->address >= end) {
+                if (!dataAdded)
+                    addData();
+
+                addPiece({ piece->address - size + dataSize, piece->size, piece->source, piece->inserted });
+                continue;
+            }
+
+            // The piece overlaps the replaced range, only the parts in front of and behind it are kept
+            if (piece->address < address)
+                addPiece({ piece->address, address - piece->address, piece->source, piece->inserted });
+
+            if (!dataAdded)
+                addData();
+
+            if (pieceEnd > end)
+                addPiece({ address + dataSize, pieceEnd - end, piece->source + (end - piece->address), piece->inserted });
+        }
+
+        if (!dataAdded)
+            addData();
+
+        return Delta { Delta::Type::Pieces, originalSize, size_t(first - previous.begin()), { first, last }, std::move(pieces) };
+    }
+
+    void PieceTable::apply(const Delta &delta, bool undo) {
+        auto &pieces = this->getMutablePieces(delta.originalSize);
+
+        // Everything behind the changed pieces moves by the difference in size, wrapping around if they shrunk
+        u64 shift = 0;
+
+        if (delta.type == Delta::Type::Pieces) {
+            const auto &removed = undo ? delta.addedPieces : delta.removedPieces;
+            const auto &added   = undo ? delta.removedPieces : delta.addedPieces;
+
+            for (const auto &piece : removed)
+                shift -= piece.size;
+            for (const auto &piece : added)
+                shift += piece.size;
+
+            auto position = pieces.erase(pieces.begin() + delta.index, pieces.begin() + delta.index + removed.size());
+            pieces.insert(position, added.begin(), added.end());
+
+            for (size_t i = delta.index + added.size(); i < pieces.size(); i++)
+                pieces[i].address += shift;
+        } else {
+            const auto &removed = undo ? delta.addedBytes : delta.removedBytes;
+            const auto &added   = undo ? delta.removedBytes : delta.addedBytes;
+            const bool resized = removed.size() != added.size();
+
+            // Bytes that are shared with the undo history, other pieces or the pieces a snapshot holds get copied first
+            auto &piece = pieces[delta.index];
+            if (piece.inserted.use_count() != 1 || (resized && piece.source + piece.size != piece.inserted->size())) {
+                const auto first = piece.inserted->begin() + piece.source;
+
+                piece.inserted = std::make_shared<std::vector<u8>>(first, first + piece.size);
+                piece.source = 0;
+            }
+
+            // Inserted bytes are always allocated mutable, nobody but this piece holds them at this point
+            auto &bytes = const_cast<std::vector<u8>&>(*piece.inserted);
+            const auto position = bytes.begin() + piece.source + delta.offset;
+
+            if (resized) {
+                bytes.insert(bytes.erase(position, position + removed.size()), added.begin(), added.end());
+
+                shift = added.size() - removed.size();
+                piece.size += shift;
+
+                for (size_t i = delta.index + 1; i < pieces.size(); i++)
+                    pieces[i].address += shift;
+            } else {
+                std::copy(added.begin(), added.end(), position);
+            }
+        }
+
+        // Edits that cancel each other out end up mapping the original data one to one again
+        const bool isOriginal = pieces.empty() ? delta.originalSize == 0 : (pieces.size() == 1 && pieces.front().isOriginal() && pieces.front().source == 0 && pieces.front().size == delta.originalSize);
+        if (isOriginal)
+            this->m_pieces = nullptr;
+    }
+
+    PieceTable::Pieces& PieceTable::getMutablePieces(u64 originalSize) {
+        if (this->m_pieces == nullptr) {
+            this->m_pieces = std::make_shared<Pieces>();
+            if (originalSize > 0)
+                this->m_pieces->push_back({ 0, originalSize, 0, nullptr });
+        } else if (this->m_pieces.use_count() > 1) {
+            this->m_pieces = std::make_shared<Pieces>(*this->m_pieces);
+        }
+
+        return *this->m_pieces;
+    }
+
+    u64 PieceTable::getSize() const {
+        if (this->m_pieces == nullptr || this->m_pieces->empty())
+            return 0;
+
+        return this->m_pieces->back().address + this->m_pieces->back().size;
+    }
+
+    PieceTable::Pieces::const_iterator PieceTable::findPiece(const Pieces &pieces, u64 address) {
+        auto piece = std::upper_bound(pieces.begin(), pieces.end(), address, [](u64 address, const Piece &piece) { return address < piece.address; });
+        if (piece == pieces.begin())
+            return pieces.end();
+
+        piece--;
+        return address < piece->address + piece->size ? piece : pieces.end();
+    }
+
+    void PieceTable::read(const Pieces &pieces, u64 address, u8 *buffer, size_t size, const OriginalCallback &readOriginal) {
+        const u64 end = address + size;
+
+        for (auto piece = findPiece(pieces, address); piece != pieces.end() && piece->address < end; piece++) {
+            const u64 from = std::max(piece->address, address);
+            const u64 to   = std::min(piece->address + piece->size, end);
+            const u64 source = piece->source + (from - piece->address);
+
+            if (piece->isOriginal())
+                readOriginal(source, from - address, to - from);
+            else
+                std::memcpy(buffer + (from - address), piece->inserted->data() + source, to - from);
+        }
+    }
+
+    void PieceTable::forEachOriginal(const Pieces &pieces, u64 address, size_t size, const OriginalCallback &callback) {
+        const u64 end = address + size;
+
+        for (auto piece = findPiece(pieces, address); piece != pieces.end() && piece->address < end; piece++) {
+            if (!piece->isOriginal())
+                continue;
+
+            const u64 from = std::max(piece->address, address);
+            const u64 to   = std::min(piece->address + piece->size, end);
+
+            callback(piece->source + (from - piece->address), from - address, to - from);
+        }
+    }
+
+    bool PieceTable::isIdentity(const Pieces &pieces, u64 address, size_t size) {
+        auto piece = findPiece(pieces, address);
+
+        return piece != pieces.end() && piece->isOriginal() && piece->source == piece->address && address + size <= piece->address + piece->size;
+    }
+
+    std::optional<u64> PieceTable::findOriginal(const Pieces &pieces, u64 source) {
+        for (const auto &piece : pieces) {
+            if (piece.isOriginal() && source >= piece.source && source < piece.source + piece.size)
+                return piece.address + (source - piece.source);
+        }
+
+        return std::nullopt;
+    }
+
+}
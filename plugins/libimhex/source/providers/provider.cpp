@@ -1,8 +1,12 @@
 #include <hex/providers/provider.hpp>
 
 #include <hex.hpp>
+#include <hex/api/content_registry.hpp>
+#include <hex/helpers/profiler.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <map>
 #include <optional>
 #include <string>
@@ -10,36 +14,426 @@
 
 namespace hex::prv {
 
-    Provider::Provider() {
-        this->m_patches.emplace_back();
+    Provider::Provider() : m_snapshotSource(std::make_shared<Snapshot::Source>()) {
+        this->m_snapshotSource->provider = this;
+    }
+
+    Provider::~Provider() {
+        this->closeSnapshots();
     }
 
     void Provider::read(u64 offset, void *buffer, size_t size) {
-        this->readRaw(offset, buffer, size);
+        if ((offset + size) > this->getSize() || buffer == nullptr || size == 0)
+            return;
+
+        this->readAbsolute(PageSize * this->m_currPage + offset, buffer, size);
     }
 
     void Provider::write(u64 offset, const void *buffer, size_t size) {
-        this->writeRaw(offset, buffer, size);
+        if ((offset + size) > this->getSize() || buffer == nullptr || size == 0)
+            return;
+
+        this->writeAbsolute(PageSize * this->m_currPage + offset, buffer, size);
     }
 
+    void Provider::readAbsolute(u64 offset, void *buffer, size_t size) {
+        if ((offset + size) > this->getActualSize() || buffer == nullptr || size == 0)
+            return;
+
+        {
+            std::shared_lock lock(this->m_patchMutex);
+
+            if (auto pieces = this->m_pieceTable.share(); pieces != nullptr) {
+                auto patches = this->m_patches.share();
+                lock.unlock();
+
+                this->readPatched(*pieces, *patches, offset, static_cast<u8*>(buffer), size);
+            } else {
+                lock.unlock();
+
+                this->readCached(offset, buffer, size);
+
+                lock.lock();
+                this->m_patches.apply(offset, buffer, size);
+            }
+        }
 
-    std::map<u64, u8>& Provider::getPatches() {
-        return this->m_patches.back();
+        {
+            std::shared_lock lock(this->m_overlayMutex);
+            if (this->m_indexedOverlayGeneration == this->m_overlayGeneration) {
+                this->applyOverlays(offset, static_cast<u8*>(buffer), size);
+                return;
+            }
+        }
+
+        std::unique_lock lock(this->m_overlayMutex);
+        this->updateOverlayIndex();
+        this->applyOverlays(offset, static_cast<u8*>(buffer), size);
+    }
+
+    void Provider::readCached(u64 offset, void *buffer, size_t size) {
+        Profiler::addRead(size);
+
+        std::unique_lock<std::mutex> lock;
+        if (!this->hasCapabilities(ContentRegistry::Providers::ThreadSafeReads))
+            lock = std::unique_lock(this->m_rawReadMutex);
+
+        if (this->m_blockCache != nullptr)
+            this->m_blockCache->read(offset, buffer, size, this->getRawSize(), [this](u64 offset, void *buffer, size_t size) { this->readRaw(offset, buffer, size); });
+        else
+            this->readRaw(offset, buffer, size);
+    }
+
+    void Provider::readPatched(const PieceTable::Pieces &pieces, const PatchStore::Runs &patches, u64 offset, u8 *buffer, size_t size) {
+        PieceTable::read(pieces, offset, buffer, size, [&](u64 source, u64 bufferOffset, size_t size) {
+            this->readCached(source, buffer + bufferOffset, size);
+            PatchStore::apply(patches, source, buffer + bufferOffset, size);
+        });
+    }
+
+    void Provider::writeAbsolute(u64 offset, const void *buffer, size_t size) {
+        if ((offset + size) > this->getActualSize() || buffer == nullptr || size == 0)
+            return;
+
+        std::unique_lock lock(this->m_patchMutex);
+
+        // Writes that stay within a single piece of the original data are patches of the raw data, everything else is up to the piece table
+        if (auto pieces = this->m_pieceTable.share(); pieces != nullptr) {
+            std::optional<u64> source;
+            PieceTable::forEachOriginal(*pieces, offset, size, [&](u64 originalOffset, u64 bufferOffset, size_t originalSize) {
+                if (bufferOffset == 0 && originalSize == size)
+                    source = originalOffset;
+            });
+
+            if (!source.has_value()) {
+                lock.unlock();
+
+                auto data = static_cast<const u8*>(buffer);
+                this->replaceStructure(offset, size, { data, data + size });
+                return;
+            }
+
+            offset = *source;
+        }
+
+        this->m_patches.write(offset, buffer, size);
+        this->m_structuralRedoDepths.clear();
+    }
+
+    void Provider::writeRuns(const std::vector<PatchStore::Run> &runs) {
+        const u64 rawSize = this->getRawSize();
+        const u64 size = this->getActualSize();
+
+        std::vector<PatchStore::Run> patches;
+        bool structural = false;
+
+        std::unique_lock lock(this->m_patchMutex);
+        auto pieces = this->m_pieceTable.share();
+
+        for (const auto &run : runs) {
+            const auto &[address, data] = run;
+            if (data.empty() || address + data.size() > size)
+                continue;
+
+            if (pieces == nullptr) {
+                patches.push_back(run);
+                continue;
+            }
+
+            // Pieces of the original data keep their order, so runs mapped onto it stay sorted
+            std::optional<u64> source;
+            PieceTable::forEachOriginal(*pieces, address, data.size(), [&](u64 originalOffset, u64 bufferOffset, size_t originalSize) {
+                if (bufferOffset == 0 && originalSize == data.size())
+                    source = originalOffset;
+            });
+
+            if (source.has_value())
+                patches.emplace_back(*source, data);
+            else
+                structural = true;
+        }
+
+        // Runs covering inserted bytes have to replace pieces. The whole batch does so then, so it stays a single undo step
+        if (structural) {
+            std::vector<PatchStore::Run> writes;
+            std::copy_if(runs.begin(), runs.end(), std::back_inserter(writes), [size](const auto &run) { return !run.second.empty() && run.first + run.second.size() <= size; });
+
+            this->m_pieceTable.overwrite(rawSize, writes);
+
+            this->m_patches.clearRedo();
+            this->m_structuralRedoDepths.clear();
+            this->m_structuralUndoDepths.push_back(this->m_patches.getUndoDepth());
+            return;
+        }
+
+        this->m_patches.write(patches);
+        this->m_structuralRedoDepths.clear();
+    }
+
+    void Provider::erasePatches(u64 offset, size_t size) {
+        std::unique_lock lock(this->m_patchMutex);
+
+        this->m_patches.erase(offset, size);
+        this->m_structuralRedoDepths.clear();
+    }
+
+    size_t Provider::getActualSize() {
+        {
+            std::shared_lock lock(this->m_patchMutex);
+            if (this->m_pieceTable.isModified())
+                return this->m_pieceTable.getSize();
+        }
+
+        return this->getRawSize();
+    }
+
+    void Provider::insert(u64 offset, const void *buffer, size_t size) {
+        if (offset > this->getActualSize() || buffer == nullptr || size == 0)
+            return;
+
+        auto data = static_cast<const u8*>(buffer);
+        this->replaceStructure(offset, 0, { data, data + size });
+    }
+
+    void Provider::remove(u64 offset, size_t size) {
+        if ((offset + size) > this->getActualSize() || size == 0)
+            return;
+
+        this->replaceStructure(offset, size, { });
+    }
+
+    void Provider::replaceStructure(u64 offset, size_t size, std::vector<u8> data) {
+        const u64 rawSize = this->getRawSize();
+
+        std::unique_lock lock(this->m_patchMutex);
+        this->m_pieceTable.replace(rawSize, offset, size, std::move(data));
+
+        // Undoing the patches made before this edit has to wait until the edit itself got undone
+        this->m_patches.clearRedo();
+        this->m_structuralRedoDepths.clear();
+        this->m_structuralUndoDepths.push_back(this->m_patches.getUndoDepth());
+    }
+
+    void Provider::hintAccess(u64 offset, size_t size, AccessHint hint) {
+        auto pieces = this->getPieces();
+        if (pieces == nullptr) {
+            this->hintRawAccess(offset, size, hint);
+            return;
+        }
+
+        PieceTable::forEachOriginal(*pieces, offset, size, [this, hint](u64 source, u64, size_t size) {
+            this->hintRawAccess(source, size, hint);
+        });
+    }
+
+    void Provider::hintRawAccess(u64 offset, size_t size, AccessHint hint) {
+        if (this->m_blockCache != nullptr)
+            this->m_blockCache->hint(offset, size, hint);
+    }
+
+    std::unique_ptr<ChunkReader> Provider::readRawChunks(u64, u64, size_t) {
+        return nullptr;
+    }
+
+    bool Provider::hasStructuralEdits() const {
+        std::shared_lock lock(this->m_patchMutex);
+        return this->m_pieceTable.isModified();
+    }
+
+    std::shared_ptr<const PieceTable::Pieces> Provider::getPieces() const {
+        std::shared_lock lock(this->m_patchMutex);
+        return this->m_pieceTable.share();
+    }
+
+
+    const u8* Provider::getResidentData(u64, size_t) {
+        return nullptr;
+    }
+
+    u32 Provider::getCapabilities() const {
+        return ContentRegistry::Providers::NoCapabilities;
+    }
+
+    bool Provider::isPatched(u64 offset, size_t size) const {
+        {
+            std::shared_lock lock(this->m_patchMutex);
+            if (auto pieces = this->m_pieceTable.share(); pieces != nullptr && !PieceTable::isIdentity(*pieces, offset, size))
+                return true;
+            if (this->m_patches.intersects(offset, size))
+                return true;
+        }
+
+        // Overlays that got changed since the index was last updated are treated as covering everything, readAbsolute takes care of the rest
+        std::shared_lock lock(this->m_overlayMutex);
+        if (this->m_indexedOverlayGeneration != this->m_overlayGeneration)
+            return !this->m_overlays.empty();
+
+        auto segment = this->m_overlaySegments.upper_bound(offset);
+        if (segment != this->m_overlaySegments.begin() && std::prev(segment)->second.end > offset)
+            return true;
+
+        return segment != this->m_overlaySegments.end() && segment->first < offset + size;
+    }
+
+    u64 Provider::getDataGeneration(bool includeOverlays) const {
+        std::shared_lock lock(this->m_patchMutex);
+        return this->m_dataGeneration + this->m_patches.getGeneration() + this->m_pieceTable.getGeneration() + (includeOverlays ? this->m_overlayGeneration.load() : 0);
+    }
+
+    Snapshot Provider::createSnapshot() {
+        Snapshot snapshot;
+        snapshot.m_source = this->m_snapshotSource;
+        snapshot.m_size = this->getActualSize();
+        snapshot.m_rawSize = this->getRawSize();
+        snapshot.m_dataGeneration = this->m_dataGeneration;
+
+        // Sharing the patches is free, only the next edit has to copy them while the snapshot is still around
+        std::shared_lock lock(this->m_patchMutex);
+        snapshot.m_patches = this->m_patches.share();
+        snapshot.m_pieces = this->m_pieceTable.share();
+        snapshot.m_patchGeneration = this->m_patches.getGeneration() + this->m_pieceTable.getGeneration();
+
+        return snapshot;
+    }
+
+    void Provider::closeSnapshots() {
+        std::unique_lock lock(this->m_snapshotSource->mutex);
+        this->m_snapshotSource->provider = nullptr;
+    }
+
+    void Provider::replaceRawData(const std::function<void()> &replace) {
+        std::unique_lock snapshotLock(this->m_snapshotSource->mutex);
+
+        replace();
+
+        if (this->m_blockCache != nullptr)
+            this->m_blockCache->invalidate();
+
+        this->m_dataGeneration++;
+    }
+
+    PatchStore& Provider::getPatches() {
+        return this->m_patches;
     }
 
     void Provider::applyPatches() {
-        for (auto &[patchAddress, patch] : this->m_patches.back())
-            this->writeRaw(patchAddress, &patch, 1);
+        std::shared_lock lock(this->m_patchMutex);
+
+        // Snapshots mustn't read the raw data while it's only partially patched
+        std::unique_lock snapshotLock(this->m_snapshotSource->mutex);
+
+        for (const auto &[patchAddress, patch] : this->m_patches.getRuns()) {
+            this->writeRaw(patchAddress, patch.data(), patch.size());
+            this->invalidateBlockCache(patchAddress, patch.size());
+        }
+
+        this->m_dataGeneration++;
+    }
+
+    bool Provider::undo() {
+        std::unique_lock lock(this->m_patchMutex);
+
+        auto &depths = this->m_structuralUndoDepths;
+        if (!depths.empty() && depths.back() == this->m_patches.getUndoDepth() && this->m_pieceTable.undo()) {
+            this->m_structuralRedoDepths.push_back(depths.back());
+            depths.pop_back();
+            return true;
+        }
+
+        return this->m_patches.undo();
+    }
+
+    bool Provider::redo() {
+        std::unique_lock lock(this->m_patchMutex);
+
+        auto &depths = this->m_structuralRedoDepths;
+        if (!depths.empty() && depths.back() == this->m_patches.getUndoDepth() && this->m_pieceTable.redo()) {
+            this->m_structuralUndoDepths.push_back(depths.back());
+            depths.pop_back();
+            return true;
+        }
+
+        return this->m_patches.redo();
+    }
+
+    bool Provider::canUndo() const {
+        return this->m_patches.canUndo() || !this->m_structuralUndoDepths.empty();
+    }
+
+    bool Provider::canRedo() const {
+        return this->m_patches.canRedo() || !this->m_structuralRedoDepths.empty();
     }
 
 
     Overlay* Provider::newOverlay() {
-        return this->m_overlays.emplace_back(new Overlay());
+        std::unique_lock lock(this->m_overlayMutex);
+
+        this->m_overlayGeneration++;
+        return this->m_overlays.emplace_back(new Overlay(&this->m_overlayGeneration));
     }
 
     void Provider::deleteOverlay(Overlay *overlay) {
+        std::unique_lock lock(this->m_overlayMutex);
+
         this->m_overlays.erase(std::find(this->m_overlays.begin(), this->m_overlays.end(), overlay));
         delete overlay;
+
+        // The index may still point to the overlay, so it has to be updated before anything else reads through it
+        this->m_overlayGeneration++;
+        this->updateOverlayIndex();
+    }
+
+    void Provider::updateOverlayIndex() {
+        if (this->m_indexedOverlayGeneration == this->m_overlayGeneration)
+            return;
+
+        this->m_indexedOverlayGeneration = this->m_overlayGeneration;
+        auto &segments = this->m_overlaySegments;
+        segments.clear();
+
+        // Overlays get painted over each other in order, cutting whatever parts of earlier ones they cover
+        for (auto overlay : this->m_overlays) {
+            const u64 start = overlay->getAddress();
+            const u64 end   = start + overlay->getSize();
+
+            if (start == end)
+                continue;
+
+            auto segment = segments.lower_bound(start);
+            if (segment != segments.begin()) {
+                auto &[prevStart, prev] = *std::prev(segment);
+
+                if (prev.end > end)
+                    segments[end] = prev;
+                if (prev.end > start)
+                    prev.end = start;
+            }
+
+            while (segment != segments.end() && segment->first < end) {
+                if (segment->second.end > end)
+                    segments[end] = segment->second;
+
+                segment = segments.erase(segment);
+            }
+
+            segments[start] = { end, overlay };
+        }
+    }
+
+    void Provider::applyOverlays(u64 offset, u8 *buffer, size_t size) const {
+        const u64 end = offset + size;
+
+        auto segment = this->m_overlaySegments.upper_bound(offset);
+        if (segment != this->m_overlaySegments.begin())
+            segment--;
+
+        for (; segment != this->m_overlaySegments.end() && segment->first < end; segment++) {
+            const u64 from = std::max(segment->first, offset);
+            const u64 to   = std::min(segment->second.end, end);
+
+            if (from < to)
+                segment->second.overlay->read(from - segment->second.overlay->getAddress(), buffer + (from - offset), to - from);
+        }
     }
 
     const std::list<Overlay*>& Provider::getOverlays() {
@@ -73,6 +467,23 @@ namespace hex::prv {
         return std::min(this->getActualSize() - PageSize * this->m_currPage, PageSize);
     }
 
+    std::string Provider::getName() const {
+        return "Unnamed";
+    }
+
+    BlockCache* Provider::getBlockCache() const {
+        return this->m_blockCache.get();
+    }
+
+    void Provider::enableBlockCache(size_t blockSize, size_t maxBlocks, size_t readAheadBlocks) {
+        this->m_blockCache = std::make_unique<BlockCache>(blockSize, maxBlocks, readAheadBlocks);
+    }
+
+    void Provider::invalidateBlockCache(u64 offset, size_t size) {
+        if (this->m_blockCache != nullptr)
+            this->m_blockCache->invalidate(offset, size);
+    }
+
     std::optional<u32> Provider::getPageOfAddress(u64 address) {
         u32 page = std::floor(address / double(PageSize));
 
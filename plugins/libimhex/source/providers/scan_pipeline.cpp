@@ -0,0 +1,460 @@
+#include <hex/providers/scan_pipeline.hpp>
+
+#include <hex/api/event.hpp>
+#include <hex/api/imhex_api.hpp>
+#include <hex/providers/chunk_reader.hpp>
+#include <hex/providers/data_chunks.hpp>
+#include <hex/providers/provider.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <optional>
+#include <thread>
+
+namespace hex::prv {
+
+    std::vector<ScanPipeline::Submission> ScanPipeline::s_submissions;
+    std::mutex ScanPipeline::s_mutex;
+    std::vector<std::shared_ptr<ScanPipeline::Pass>> ScanPipeline::s_runningPasses;
+    std::vector<std::pair<TaskHandle, TaskManager::Callback>> ScanPipeline::s_finishedConsumers;
+
+    /*
+     * A single pass over a range. The thread running it reads the chunks and waits for all consumers to be done with one before handing out the next,
+     * reading that next one while they're still at it. Consumers only join and leave between two chunks, so every one of their workers sees the same chunks.
+     */
+    class ScanPipeline::Pass {
+    public:
+        // Hands out the chunks of the range front to back, see ChunkReader for how long they stay valid
+        using ChunkSource = std::function<const u8*(size_t &size)>;
+        // Called whenever the pass starts at the beginning of the range again
+        using SourceFactory = std::function<ChunkSource()>;
+
+        Pass(Snapshot snapshot, u64 offset, u64 size)
+            : m_snapshot(std::move(snapshot)), m_offset(offset), m_size(size), m_chunkCount((size + ChunkSize - 1) / ChunkSize) { }
+
+        // Consumers that never got to be part of a pass, because it didn't even start, are done as well
+        ~Pass() {
+            for (auto &submission : this->m_joining)
+                ScanPipeline::finishConsumer(submission, false);
+        }
+
+        [[nodiscard]] bool matches(const Submission &submission) const {
+            return submission.offset == this->m_offset && submission.size == this->m_size && submission.snapshot.hasSameData(this->m_snapshot);
+        }
+
+        void add(Submission submission) {
+            std::scoped_lock lock(this->m_joinMutex);
+            this->m_joining.push_back(std::move(submission));
+        }
+
+        // Takes the submission if it can still be part of the pass. Sequential consumers can only join while the next chunk is the first one
+        bool join(Submission &submission) {
+            std::scoped_lock lock(this->m_joinMutex);
+
+            if (this->m_closed || (submission.order == Order::Sequential && this->m_nextChunk != 0))
+                return false;
+
+            this->m_joining.push_back(std::move(submission));
+            return true;
+        }
+
+        // Returns whether every consumer got all chunks
+        bool run(const SourceFactory &openSource, Task *task) {
+            ChunkSource source;
+            std::optional<Chunk> prefetched;
+            bool completed = true;
+
+            while (true) {
+                std::vector<std::unique_ptr<Member>> leaving;
+                bool closed;
+
+                {
+                    std::scoped_lock lock(this->m_joinMutex);
+
+                    for (auto &submission : this->m_joining)
+                        this->admit(std::move(submission));
+                    this->m_joining.clear();
+
+                    for (auto it = this->m_members.begin(); it != this->m_members.end();) {
+                        if ((*it)->remaining == 0 || (*it)->isDropped()) {
+                            leaving.push_back(std::move(*it));
+                            it = this->m_members.erase(it);
+                        } else {
+                            ++it;
+                        }
+                    }
+
+                    closed = this->m_closed = this->m_members.empty();
+                }
+
+                // Callbacks get queued under the global lock, which joining takes before the join mutex
+                for (auto &member : leaving) {
+                    this->stopWorkers(*member);
+
+                    const bool done = member->remaining == 0 && !member->isDropped();
+                    completed = completed && done;
+                    ScanPipeline::finishConsumer(member->submission, done);
+                }
+
+                if (closed)
+                    break;
+
+                if (task != nullptr && task->isCancelled()) {
+                    this->dropAll();
+                    continue;
+                }
+
+                Chunk chunk;
+                if (prefetched.has_value()) {
+                    chunk = *std::exchange(prefetched, std::nullopt);
+                } else {
+                    // All workers are idle, nothing uses the chunks of the previous source anymore
+                    if (this->m_nextChunk == 0)
+                        source = openSource();
+
+                    chunk = this->readChunk(source, this->m_nextChunk);
+                }
+
+                // The data changed underneath, nobody can get the chunks they're still missing anymore
+                if (chunk.data == nullptr) {
+                    this->dropAll();
+                    continue;
+                }
+
+                this->publish(chunk);
+
+                // The source needs to be replaced when wrapping around, which has to wait for the workers to be done with the current chunk
+                const u64 following = (this->m_nextChunk + 1) % this->m_chunkCount;
+                if (following != 0)
+                    prefetched = this->readChunk(source, following);
+
+                this->waitForWorkers();
+
+                float progress = 1.0F;
+                for (auto &member : this->m_members) {
+                    member->remaining--;
+
+                    const float memberProgress = float(this->m_chunkCount - member->remaining) / this->m_chunkCount;
+                    if (member->submission.task != nullptr)
+                        member->submission.task->setProgress(memberProgress);
+
+                    progress = std::min(progress, memberProgress);
+                }
+
+                if (task != nullptr)
+                    task->setProgress(progress);
+
+                std::scoped_lock lock(this->m_joinMutex);
+                this->m_nextChunk = following;
+            }
+
+            return completed;
+        }
+
+    private:
+        struct Chunk {
+            const u8 *data = nullptr;
+            size_t size = 0;
+            u64 offset = 0;
+        };
+
+        struct Member {
+            Submission submission;
+            u64 remaining = 0;
+
+            // Set by a worker whose consumer threw
+            std::atomic<bool> failed = false;
+            // Guarded by the work mutex
+            bool leaving = false;
+            std::vector<std::thread> workers;
+
+            [[nodiscard]] bool isDropped() const {
+                return this->failed || (this->submission.task != nullptr && this->submission.task->isCancelled());
+            }
+        };
+
+        // Expects the join mutex to be held, workers wait for the chunk after the current one
+        void admit(Submission submission) {
+            auto &member = this->m_members.emplace_back(std::make_unique<Member>());
+            member->submission = std::move(submission);
+            member->remaining = this->m_chunkCount;
+
+            if (member->submission.task != nullptr)
+                ScanPipeline::setRunning(*member->submission.task);
+
+            for (const auto &consumer : member->submission.consumers) {
+                member->workers.emplace_back([this, member = member.get(), &consumer, generation = this->m_generation] {
+                    this->work(*member, consumer, generation);
+                });
+            }
+        }
+
+        void work(Member &member, const Consumer &consumer, u64 generation) {
+            while (true) {
+                Chunk chunk;
+
+                {
+                    std::unique_lock lock(this->m_workMutex);
+                    this->m_chunkReady.wait(lock, [&] { return member.leaving || this->m_generation != generation; });
+
+                    if (member.leaving)
+                        return;
+
+                    generation = this->m_generation;
+                    chunk = this->m_chunk;
+                }
+
+                // Dropped members keep taking part until the next chunk, they just don't do anything anymore
+                if (!member.isDropped()) {
+                    try {
+                        consumer(chunk.offset, chunk.data, chunk.size);
+                    } catch (...) {
+                        member.failed = true;
+                    }
+                }
+
+                std::scoped_lock lock(this->m_workMutex);
+                if (--this->m_busyWorkers == 0)
+                    this->m_chunkDone.notify_one();
+            }
+        }
+
+        void publish(const Chunk &chunk) {
+            {
+                std::scoped_lock lock(this->m_workMutex);
+
+                this->m_chunk = chunk;
+                this->m_busyWorkers = 0;
+                for (const auto &member : this->m_members)
+                    this->m_busyWorkers += member->workers.size();
+
+                this->m_generation++;
+            }
+
+            this->m_chunkReady.notify_all();
+        }
+
+        void waitForWorkers() {
+            std::unique_lock lock(this->m_workMutex);
+            this->m_chunkDone.wait(lock, [this] { return this->m_busyWorkers == 0; });
+        }
+
+        void stopWorkers(Member &member) {
+            {
+                std::scoped_lock lock(this->m_workMutex);
+                member.leaving = true;
+            }
+
+            this->m_chunkReady.notify_all();
+
+            for (auto &worker : member.workers)
+                worker.join();
+        }
+
+        void dropAll() {
+            for (auto &member : this->m_members)
+                member->failed = true;
+        }
+
+        [[nodiscard]] Chunk readChunk(const ChunkSource &source, u64 index) const {
+            const u64 expectedSize = std::min<u64>(ChunkSize, this->m_size - index * ChunkSize);
+
+            size_t size = 0;
+            const u8 *data = source(size);
+            if (data == nullptr || size != expectedSize)
+                return { };
+
+            return { data, size, this->m_offset + index * ChunkSize };
+        }
+
+        Snapshot m_snapshot;
+        u64 m_offset, m_size;
+        u64 m_chunkCount;
+
+        // Only touched by the thread running the pass, except for the workers of the members
+        std::list<std::unique_ptr<Member>> m_members;
+
+        std::mutex m_joinMutex;
+        std::vector<Submission> m_joining;
+        u64 m_nextChunk = 0;
+        bool m_closed = false;
+
+        std::mutex m_workMutex;
+        std::condition_variable m_chunkReady, m_chunkDone;
+        // Changed for every chunk that gets handed out
+        u64 m_generation = 0;
+        Chunk m_chunk;
+        size_t m_busyWorkers = 0;
+    };
+
+    bool ScanPipeline::run(const Snapshot &snapshot, u64 offset, u64 size, const std::vector<Consumer> &consumers, Task *task) {
+        Pass pass(snapshot, offset, size);
+        pass.add({ nullptr, snapshot, offset, size, Order::Sequential, consumers, { } });
+
+        snapshot.hintAccess(offset, size, AccessHint::Sequential);
+
+        const bool completed = pass.run([&]() -> Pass::ChunkSource {
+            std::shared_ptr<ChunkReader> reader = snapshot.readChunks(offset, size, ChunkSize);
+
+            return [reader](size_t &chunkSize) -> const u8* {
+                return reader->next(chunkSize);
+            };
+        }, task);
+
+        snapshot.hintAccess(offset, size, AccessHint::DontNeed);
+
+        return completed;
+    }
+
+    bool ScanPipeline::run(Provider *provider, u64 offset, u64 size, const std::vector<Consumer> &consumers, Task *task) {
+        Pass pass({ }, offset, size);
+        pass.add({ nullptr, { }, offset, size, Order::Sequential, consumers, { } });
+
+        provider->hintAccess(offset, size, AccessHint::Sequential);
+
+        const bool completed = pass.run([&]() -> Pass::ChunkSource {
+            auto chunks = std::make_shared<DataChunks>(provider, offset, size, ChunkSize);
+
+            return [chunks, chunk = DataChunks::Iterator(), first = true](size_t &chunkSize) mutable -> const u8* {
+                if (std::exchange(first, false))
+                    chunk = chunks->begin();
+                else
+                    ++chunk;
+
+                if (chunk == std::default_sentinel)
+                    return nullptr;
+
+                chunkSize = (*chunk).size();
+                return (*chunk).data();
+            };
+        }, task);
+
+        provider->hintAccess(offset, size, AccessHint::DontNeed);
+
+        return completed;
+    }
+
+    TaskHandle ScanPipeline::submit(std::string name, TaskPriority priority, const Snapshot &snapshot, u64 offset, u64 size, Order order,
+                                    std::vector<Consumer> consumers, TaskManager::Callback onFinished) {
+        auto task = std::make_shared<Task>(std::move(name), priority);
+
+        ScanPipeline::s_submissions.push_back({ task, snapshot, offset, size, order, std::move(consumers), std::move(onFinished) });
+
+        return task;
+    }
+
+    void ScanPipeline::dispatch() {
+        std::vector<std::pair<TaskHandle, TaskManager::Callback>> finishedConsumers;
+
+        {
+            std::scoped_lock lock(ScanPipeline::s_mutex);
+            std::swap(finishedConsumers, ScanPipeline::s_finishedConsumers);
+        }
+
+        for (auto &[task, onFinished] : finishedConsumers) {
+            if (task->isCancelled())
+                continue;
+
+            onFinished();
+
+            EventManager::notify(Events::TaskFinished, task);
+        }
+
+        if (ScanPipeline::s_submissions.empty())
+            return;
+
+        std::vector<std::vector<Submission>> newPasses;
+
+        {
+            std::scoped_lock lock(ScanPipeline::s_mutex);
+
+            for (auto &submission : std::exchange(ScanPipeline::s_submissions, { })) {
+                if (submission.task->isCancelled()) {
+                    ScanPipeline::setFinished(*submission.task);
+                    continue;
+                }
+
+                const bool joined = std::any_of(ScanPipeline::s_runningPasses.begin(), ScanPipeline::s_runningPasses.end(), [&submission](const auto &pass) {
+                    return pass->matches(submission) && pass->join(submission);
+                });
+
+                if (joined)
+                    continue;
+
+                auto pass = std::find_if(newPasses.begin(), newPasses.end(), [&submission](const auto &submissions) {
+                    const auto &first = submissions.front();
+                    return first.offset == submission.offset && first.size == submission.size && first.snapshot.hasSameData(submission.snapshot);
+                });
+
+                if (pass != newPasses.end())
+                    pass->push_back(std::move(submission));
+                else
+                    newPasses.emplace_back().push_back(std::move(submission));
+            }
+        }
+
+        for (auto &submissions : newPasses)
+            ScanPipeline::startPass(std::move(submissions));
+    }
+
+    void ScanPipeline::startPass(std::vector<Submission> submissions) {
+        const auto &first = submissions.front();
+
+        TaskPriority priority = first.task->getPriority();
+        for (const auto &submission : submissions)
+            priority = std::min(priority, submission.task->getPriority());
+
+        auto name = submissions.size() == 1 ? first.task->getName() : "Scanning data";
+        auto pass = std::make_shared<Pass>(first.snapshot, first.offset, first.size);
+        auto snapshot = first.snapshot;
+        const u64 offset = first.offset, size = first.size;
+
+        for (auto &submission : submissions)
+            pass->add(std::move(submission));
+
+        TaskManager::submit(std::move(name), priority, [pass, snapshot, offset, size](Task &task) {
+            // Only passes that are actually running take new consumers, one that never gets to run would never feed them
+            {
+                std::scoped_lock lock(ScanPipeline::s_mutex);
+                ScanPipeline::s_runningPasses.push_back(pass);
+            }
+
+            snapshot.hintAccess(offset, size, AccessHint::Sequential);
+
+            pass->run([&snapshot, offset, size]() -> Pass::ChunkSource {
+                std::shared_ptr<ChunkReader> reader = snapshot.readChunks(offset, size, ChunkSize);
+
+                return [reader](size_t &chunkSize) -> const u8* {
+                    return reader->next(chunkSize);
+                };
+            }, &task);
+
+            snapshot.hintAccess(offset, size, AccessHint::DontNeed);
+
+            std::scoped_lock lock(ScanPipeline::s_mutex);
+            std::erase(ScanPipeline::s_runningPasses, pass);
+        });
+    }
+
+    void ScanPipeline::finishConsumer(Submission &submission, bool completed) {
+        if (submission.task == nullptr)
+            return;
+
+        if (!completed)
+            submission.task->cancel();
+
+        ScanPipeline::setFinished(*submission.task);
+
+        if (completed && submission.onFinished) {
+            {
+                std::scoped_lock lock(ScanPipeline::s_mutex);
+                ScanPipeline::s_finishedConsumers.emplace_back(submission.task, std::move(submission.onFinished));
+            }
+
+            ImHexApi::Common::requestRedraw();
+        }
+    }
+
+}
@@ -0,0 +1,154 @@
+#include <hex/providers/snapshot.hpp>
+
+#include <hex/providers/provider.hpp>
+#include <hex/providers/patch_store.hpp>
+
+#include <array>
+#include <vector>
+
+namespace hex::prv {
+
+    namespace {
+
+        // Patches are applied on top of the raw chunks, everything else gets read through the snapshot one chunk after another
+        class SnapshotChunkReader : public ChunkReader {
+        public:
+            SnapshotChunkReader(Snapshot snapshot, std::unique_ptr<ChunkReader> rawReader, u64 offset, u64 size, size_t chunkSize)
+                : m_snapshot(std::move(snapshot)), m_rawReader(std::move(rawReader)), m_position(offset), m_end(offset + size), m_chunkSize(chunkSize) {
+                if (this->m_rawReader == nullptr) {
+                    for (auto &buffer : this->m_buffers)
+                        buffer.resize(std::min<u64>(chunkSize, size));
+                }
+            }
+
+            u8* next(size_t &size) override {
+                if (this->m_position >= this->m_end)
+                    return nullptr;
+
+                size = std::min<u64>(this->m_chunkSize, this->m_end - this->m_position);
+
+                u8 *data;
+                if (this->m_rawReader != nullptr) {
+                    size_t rawSize = 0;
+                    data = this->m_rawReader->next(rawSize);
+                    if (data == nullptr || rawSize != size || !this->m_snapshot.isValid())
+                        return nullptr;
+
+                    PatchStore::apply(this->m_snapshot.getPatches(), this->m_position, data, size);
+                } else {
+                    data = this->m_buffers[this->m_chunkIndex % this->m_buffers.size()].data();
+                    if (!this->m_snapshot.read(this->m_position, data, size))
+                        return nullptr;
+                }
+
+                this->m_position += size;
+                this->m_chunkIndex++;
+
+                return data;
+            }
+
+        private:
+            Snapshot m_snapshot;
+            std::unique_ptr<ChunkReader> m_rawReader;
+            std::array<std::vector<u8>, 2> m_buffers;
+
+            u64 m_position, m_end;
+            size_t m_chunkSize;
+            u64 m_chunkIndex = 0;
+        };
+
+    }
+
+    bool Snapshot::read(u64 offset, void *buffer, size_t size) const {
+        if (this->m_source == nullptr || buffer == nullptr || size == 0 || offset + size > this->m_size)
+            return false;
+
+        {
+            std::shared_lock lock(this->m_source->mutex);
+
+            auto provider = this->m_source->provider;
+            if (provider == nullptr || provider->m_dataGeneration != this->m_dataGeneration)
+                return false;
+
+            if (this->m_pieces != nullptr) {
+                provider->readPatched(*this->m_pieces, *this->m_patches, offset, static_cast<u8*>(buffer), size);
+                return true;
+            }
+
+            provider->readCached(offset, buffer, size);
+        }
+
+        PatchStore::apply(*this->m_patches, offset, buffer, size);
+
+        return true;
+    }
+
+    void Snapshot::hintAccess(u64 offset, size_t size, AccessHint hint) const {
+        if (this->m_source == nullptr || size == 0 || offset + size > this->m_size)
+            return;
+
+        std::shared_lock lock(this->m_source->mutex);
+
+        auto provider = this->m_source->provider;
+        if (provider == nullptr || provider->m_dataGeneration != this->m_dataGeneration)
+            return;
+
+        if (this->m_pieces == nullptr) {
+            provider->hintRawAccess(offset, size, hint);
+            return;
+        }
+
+        PieceTable::forEachOriginal(*this->m_pieces, offset, size, [provider, hint](u64 source, u64, size_t size) {
+            provider->hintRawAccess(source, size, hint);
+        });
+    }
+
+    std::unique_ptr<ChunkReader> Snapshot::readChunks(u64 offset, u64 size, size_t chunkSize) const {
+        std::unique_ptr<ChunkReader> rawReader;
+
+        if (this->m_source != nullptr && chunkSize > 0 && offset + size <= this->m_size && this->m_pieces == nullptr) {
+            std::shared_lock lock(this->m_source->mutex);
+
+            auto provider = this->m_source->provider;
+            if (provider != nullptr && provider->m_dataGeneration == this->m_dataGeneration)
+                rawReader = provider->readRawChunks(offset, size, chunkSize);
+        }
+
+        return std::make_unique<SnapshotChunkReader>(*this, std::move(rawReader), offset, size, std::max<size_t>(chunkSize, 1));
+    }
+
+    Snapshot Snapshot::withoutPatches() const {
+        Snapshot snapshot = *this;
+        snapshot.m_patches = std::make_shared<const PatchStore::Runs>();
+
+        return snapshot;
+    }
+
+    Snapshot Snapshot::withoutEdits() const {
+        Snapshot snapshot = this->withoutPatches();
+        snapshot.m_pieces = nullptr;
+        snapshot.m_size = this->m_rawSize;
+
+        return snapshot;
+    }
+
+    bool Snapshot::hasSameData(const Snapshot &other) const {
+        if (this->m_source == nullptr || this->m_source != other.m_source)
+            return false;
+
+        if (this->m_dataGeneration != other.m_dataGeneration || this->m_size != other.m_size || this->m_pieces != other.m_pieces)
+            return false;
+
+        return this->m_patches == other.m_patches || (this->m_patches->empty() && other.m_patches->empty());
+    }
+
+    bool Snapshot::isValid() const {
+        if (this->m_source == nullptr)
+            return false;
+
+        std::shared_lock lock(this->m_source->mutex);
+
+        return this->m_source->provider != nullptr && this->m_source->provider->m_dataGeneration == this->m_dataGeneration;
+    }
+
+}
@@ -0,0 +1,62 @@
+#include <hex/views/deferred_view.hpp>
+
+namespace hex {
+
+    DeferredView::DeferredView(std::string viewName, std::function<View*()> constructor) : View(std::move(viewName)), m_constructor(std::move(constructor)) { }
+
+    DeferredView::~DeferredView() {
+        delete this->m_view;
+    }
+
+    View* DeferredView::getView() {
+        if (this->m_view == nullptr)
+            this->m_view = this->m_constructor();
+
+        return this->m_view;
+    }
+
+    void DeferredView::drawContent() {
+        auto view = this->getView();
+
+        // The open state is owned by this view since it's the one the window and the settings know about
+        view->getWindowOpenState() = this->getWindowOpenState();
+        if (view->isAvailable())
+            view->drawContent();
+        this->getWindowOpenState() = view->getWindowOpenState();
+    }
+
+    void DeferredView::drawMenu() {
+        if (this->m_view != nullptr)
+            this->m_view->drawMenu();
+    }
+
+    bool DeferredView::handleShortcut(int key, int mods) {
+        if (!this->getWindowOpenState())
+            return false;
+
+        return this->getView()->handleShortcut(key, mods);
+    }
+
+    bool DeferredView::isAvailable() {
+        if (this->m_view == nullptr)
+            return View::isAvailable();
+
+        return this->m_view->isAvailable();
+    }
+
+    bool DeferredView::hasViewMenuItemEntry() {
+        if (this->m_view == nullptr)
+            return View::hasViewMenuItemEntry();
+
+        return this->m_view->hasViewMenuItemEntry();
+    }
+
+    ImVec2 DeferredView::getMinSize() {
+        return this->getView()->getMinSize();
+    }
+
+    ImVec2 DeferredView::getMaxSize() {
+        return this->getView()->getMaxSize();
+    }
+
+}
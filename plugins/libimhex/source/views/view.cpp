@@ -20,8 +20,8 @@ namespace hex {
         return SharedData::deferredCalls;
     }
 
-    std::vector<std::any> View::postEvent(Events eventType, const std::any &userData) {
-        return EventManager::post(eventType, userData);
+    void View::postEvent(Events eventType, const std::any &userData) {
+        EventManager::notify(eventType, userData);
     }
 
     void View::openFileBrowser(std::string title, imgui_addons::ImGuiFileBrowser::DialogMode mode, std::string validExtensions, const std::function<void(std::string)> &callback) {
@@ -0,0 +1,128 @@
+#include <hex/helpers/profiler.hpp>
+
+/*
+ * Replacements of the global operator new and delete for builds with IMHEX_TRACK_ALLOCATIONS, they report every allocation to the profiler.
+ * They're part of the executable, so on Windows allocations made inside of libimhex and the plugins aren't seen. Everywhere else they replace
+ * the operators of the whole process.
+ */
+
+#if defined(IMHEX_TRACK_ALLOCATIONS)
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#if defined(OS_WINDOWS)
+    #include <malloc.h>
+#endif
+
+namespace hex {
+
+    static void* allocate(std::size_t size) {
+        Profiler::addAllocation(size);
+
+        if (size == 0)
+            size = 1;
+
+        while (true) {
+            if (void *pointer = std::malloc(size); pointer != nullptr)
+                return pointer;
+
+            auto handler = std::get_new_handler();
+            if (handler == nullptr)
+                throw std::bad_alloc();
+
+            handler();
+        }
+    }
+
+    static void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+        Profiler::addAllocation(size);
+
+        // aligned_alloc wants the size to be a multiple of the alignment
+        const auto align = static_cast<std::size_t>(alignment);
+        size = std::max(size, align);
+        size = (size + align - 1) / align * align;
+
+        while (true) {
+            #if defined(OS_WINDOWS)
+                void *pointer = _aligned_malloc(size, align);
+            #else
+                void *pointer = std::aligned_alloc(align, size);
+            #endif
+
+            if (pointer != nullptr)
+                return pointer;
+
+            auto handler = std::get_new_handler();
+            if (handler == nullptr)
+                throw std::bad_alloc();
+
+            handler();
+        }
+    }
+
+    static void freeAligned(void *pointer) {
+        #if defined(OS_WINDOWS)
+            _aligned_free(pointer);
+        #else
+            std::free(pointer);
+        #endif
+    }
+
+}
+
+using hex::allocate, hex::allocateAligned, hex::freeAligned;
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocateAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocateAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::align_val_t) noexcept { freeAligned(pointer); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { freeAligned(pointer); }
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept { freeAligned(pointer); }
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept { freeAligned(pointer); }
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(pointer); }
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t&) noexcept { freeAligned(pointer); }
+
+#endif
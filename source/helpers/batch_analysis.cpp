@@ -0,0 +1,179 @@
+#include "helpers/batch_analysis.hpp"
+
+#include "helpers/printable_scanner.hpp"
+#include "providers/file_provider.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/helpers/memory_arena.hpp>
+#include <hex/helpers/utils.hpp>
+#include <hex/lang/pattern_language.hpp>
+#include <hex/lang/pattern_data.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace hex {
+
+    static std::string formatDigest(const std::vector<u8> &digest) {
+        std::string result;
+        result.reserve(digest.size() * 2);
+
+        for (u8 byte : digest)
+            result += hex::format("%02x", byte);
+
+        return result;
+    }
+
+    std::optional<BatchAnalysisResult> analyzeFile(const std::string &path, const BatchAnalysisSettings &settings, Task &task) {
+        const auto startTime = std::chrono::steady_clock::now();
+
+        BatchAnalysisResult result;
+        result.path = path;
+
+        auto finish = [&] {
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            return result;
+        };
+
+        prv::FileProvider provider(path);
+        if (!provider.isAvailable() || !provider.isReadable()) {
+            result.error = "Failed to open file";
+            return finish();
+        }
+
+        result.size = provider.getActualSize();
+
+        if (!settings.hashes.empty() || settings.countStrings) {
+            // Strings may run across chunk boundaries, so the length of the run at the end of a chunk is carried over into the next one
+            u64 stringCount = 0;
+            size_t runLength = 0;
+            bool inRun = false;
+
+            auto endRun = [&] {
+                if (inRun && runLength >= settings.minimumStringLength)
+                    stringCount++;
+
+                inRun = false;
+                runLength = 0;
+            };
+
+            crypt::ChunkCallback countStrings = [&](u64, const u8 *data, size_t size) {
+                size_t i = 0;
+                while (i < size) {
+                    if (inRun) {
+                        const size_t length = findNonPrintable(data + i, size - i);
+                        runLength += length;
+                        i += length;
+
+                        if (i < size)
+                            endRun();
+                    } else {
+                        i += findPrintable(data + i, size - i);
+                        inRun = i < size;
+                    }
+                }
+            };
+
+            auto digests = crypt::hash(&provider, 0, result.size, settings.hashes, &task, settings.countStrings ? countStrings : crypt::ChunkCallback());
+            if (!digests.has_value())
+                return { };
+
+            for (const auto &digest : *digests)
+                result.digests.push_back(formatDigest(digest));
+
+            if (settings.countStrings) {
+                endRun();
+                result.stringCount = stringCount;
+            }
+        }
+
+        if (settings.pattern != nullptr) {
+            // Evaluators aren't thread safe, every file gets a runtime of its own. All patterns of the file are allocated in the arena
+            lang::PatternLanguage runtime;
+            MemoryArena arena;
+            MemoryArena::Scope arenaScope(arena);
+
+            auto patterns = runtime.execute(&provider, settings.pattern, &task);
+            if (task.isCancelled()) {
+                if (patterns.has_value()) {
+                    for (auto &pattern : *patterns)
+                        delete pattern;
+                }
+
+                return { };
+            }
+
+            if (patterns.has_value()) {
+                result.patternCount = patterns->size();
+
+                for (auto &pattern : *patterns)
+                    delete pattern;
+            } else if (auto &error = runtime.getError(); error.has_value()) {
+                result.error = hex::format("Pattern error on line %u: %s", error->first, error->second.c_str());
+            } else {
+                result.error = "Pattern evaluation failed";
+            }
+        }
+
+        return finish();
+    }
+
+    bool exportBatchResults(const std::string &path, PatternExporter::Format format, const std::vector<std::string> &hashNames, const std::vector<BatchAnalysisResult> &results) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        if (format == PatternExporter::Format::JSON) {
+            auto array = nlohmann::json::array();
+
+            for (const auto &result : results) {
+                nlohmann::json entry = {
+                    { "file", result.path },
+                    { "size", result.size },
+                    { "seconds", result.seconds }
+                };
+
+                if (!result.error.empty())
+                    entry["error"] = result.error;
+
+                if (!result.digests.empty()) {
+                    auto &hashes = entry["hashes"] = nlohmann::json::object();
+                    for (size_t i = 0; i < std::min(hashNames.size(), result.digests.size()); i++)
+                        hashes[hashNames[i]] = result.digests[i];
+                }
+
+                if (result.stringCount.has_value())
+                    entry["strings"] = *result.stringCount;
+                if (result.patternCount.has_value())
+                    entry["patterns"] = *result.patternCount;
+
+                array.push_back(std::move(entry));
+            }
+
+            file << array.dump(4, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+        } else {
+            file << "file,size";
+            for (const auto &name : hashNames)
+                file << ',' << PatternExporter::escapeCsv(name);
+            file << ",strings,patterns,seconds,error\n";
+
+            for (const auto &result : results) {
+                file << PatternExporter::escapeCsv(result.path) << ',' << result.size;
+
+                for (size_t i = 0; i < hashNames.size(); i++)
+                    file << ',' << (i < result.digests.size() ? result.digests[i] : "");
+
+                file << ',' << (result.stringCount.has_value() ? std::to_string(*result.stringCount) : "")
+                     << ',' << (result.patternCount.has_value() ? std::to_string(*result.patternCount) : "")
+                     << ',' << hex::format("%.3f", result.seconds)
+                     << ',' << PatternExporter::escapeCsv(result.error) << '\n';
+            }
+        }
+
+        return file.good();
+    }
+
+}
@@ -0,0 +1,678 @@
+#include "helpers/benchmark.hpp"
+
+#include "helpers/crypto.hpp"
+#include "helpers/entropy_pyramid.hpp"
+#include "helpers/plugin_handler.hpp"
+#include "helpers/printable_scanner.hpp"
+#include "providers/file_provider.hpp"
+
+#include <hex/api/content_registry.hpp>
+#include <hex/data_processor/executor.hpp>
+#include <hex/data_processor/link.hpp>
+#include <hex/data_processor/node.hpp>
+#include <hex/helpers/byte_searcher.hpp>
+#include <hex/helpers/memory_arena.hpp>
+#include <hex/helpers/shared_data.hpp>
+#include <hex/lang/ast_node.hpp>
+#include <hex/lang/lexer.hpp>
+#include <hex/lang/parser.hpp>
+#include <hex/lang/pattern_language.hpp>
+#include <hex/lang/preprocessor.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace hex {
+
+    namespace {
+
+        constexpr u64 MiB = 0x10'0000;
+        constexpr auto MinimumTime = std::chrono::milliseconds(500);
+        constexpr u64 MinimumIterations = 3;
+        constexpr size_t ReadSize = MiB;
+
+        // Placed at the very end of the data so every search has to go through all of it
+        constexpr std::string_view HexNeedle = "DE AD ?? EF 13 37";
+        constexpr u8 HexNeedleBytes[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0x13, 0x37 };
+        constexpr std::string_view StringNeedle = "ImHexBenchmarkNeedle";
+
+        // Covers the commonly used language features while evaluating enough patterns to take a measurable amount of time
+        constexpr std::string_view BuiltinPattern = R"(
+            enum Kind : u8 {
+                Empty = 0x00,
+                Data  = 0x01,
+                Text  = 0x02
+            };
+
+            bitfield Flags {
+                compressed : 1;
+                encrypted  : 1;
+                reserved   : 6;
+            };
+
+            struct Header {
+                u32 magic;
+                u16 version;
+                Kind kind;
+                Flags flags;
+                padding[8];
+            };
+
+            struct Entry {
+                u32 offset;
+                u32 size;
+                char name[8];
+
+                if (size > 0x8000)
+                    u8 large;
+                else
+                    u16 small;
+            };
+
+            struct File {
+                Header header;
+                Entry entries[0x4000];
+            };
+
+            File file @ 0x00;
+        )";
+
+        volatile u64 s_sink;
+
+        struct BenchmarkOptions {
+            std::string filter;
+            u64 size = 64 * MiB;
+            u64 iterations = 0;
+            std::vector<std::string> patternPaths;
+            std::string outputPath;
+        };
+
+        struct Benchmark {
+            std::string name;
+            u64 bytesPerIteration;      // 0 if there's no meaningful throughput
+            std::function<bool()> run;  // Returns false if the benchmark failed
+        };
+
+        struct BenchmarkResult {
+            std::string name;
+            u64 iterations;
+            double realTime, cpuTime;   // Nanoseconds per iteration
+            u64 bytesPerIteration;
+        };
+
+        // Inputs and end nodes of the builtin nodes are edited through the UI, the benchmark graph gets its own ones instead
+        class NodeBenchmarkSource : public dp::Node {
+        public:
+            NodeBenchmarkSource(u64 size, std::vector<u8> key) : Node("Benchmark Source", {
+                dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Integer, "Address"),
+                dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Integer, "Size"),
+                dp::Attribute(dp::Attribute::IOType::Out, dp::Attribute::Type::Buffer, "Key")
+            }), m_size(size), m_key(std::move(key)) { }
+
+            void process() override {
+                this->setIntegerOnOutput(0, 0);
+                this->setIntegerOnOutput(1, this->m_size);
+                this->setBufferOnOutput(2, this->m_key);
+            }
+
+        private:
+            u64 m_size;
+            std::vector<u8> m_key;
+        };
+
+        class NodeBenchmarkSink : public dp::Node {
+        public:
+            NodeBenchmarkSink() : Node("Benchmark Sink", { dp::Attribute(dp::Attribute::IOType::In, dp::Attribute::Type::Buffer, "Data") }) { }
+
+            void process() override {
+                auto data = this->getBufferOnInput(0);
+                this->m_size = data == nullptr ? 0 : data->size();
+            }
+
+            [[nodiscard]] u64 getSize() const { return this->m_size; }
+
+        private:
+            u64 m_size = 0;
+        };
+
+    }
+
+    static void printUsage(const char *executable) {
+        std::fprintf(stderr, "Usage: %s --benchmark [--filter <text>] [--size <MiB>] [--iterations <count>] [--pattern <file>]... [--output <file.json>]\n", executable);
+    }
+
+    static std::optional<BenchmarkOptions> parseArguments(int argc, char **argv) {
+        BenchmarkOptions options;
+
+        for (int i = 2; i < argc; i++) {
+            std::string_view argument = argv[i];
+
+            auto getValue = [&]() -> const char* {
+                return i + 1 < argc ? argv[++i] : nullptr;
+            };
+
+            auto getNumber = [&]() -> std::optional<u64> {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                char *end = nullptr;
+                auto number = std::strtoull(value, &end, 10);
+                if (*end != '\0' || number == 0)
+                    return { };
+
+                return number;
+            };
+
+            if (argument == "--filter") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                options.filter = value;
+            } else if (argument == "--size") {
+                auto size = getNumber();
+                if (!size.has_value()) return { };
+
+                options.size = *size * MiB;
+            } else if (argument == "--iterations") {
+                auto iterations = getNumber();
+                if (!iterations.has_value()) return { };
+
+                options.iterations = *iterations;
+            } else if (argument == "--pattern") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                options.patternPaths.emplace_back(value);
+            } else if (argument == "--output") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                options.outputPath = value;
+            } else
+                return { };
+        }
+
+        return options;
+    }
+
+    static void loadPlugins() {
+        try {
+            auto pluginFolderPath = std::filesystem::path(SharedData::mainArgv[0]).parent_path() / "plugins";
+            PluginHandler::load(pluginFolderPath.string());
+        } catch (std::runtime_error &e) {
+            std::fprintf(stderr, "warning: %s, the data processor benchmark won't be available\n", e.what());
+            return;
+        }
+
+        for (const auto &plugin : PluginHandler::getPlugins())
+            plugin.initializePlugin();
+    }
+
+    // Alternates between random data, text, zeros and small records so every kernel has some work to do, the needles end the data
+    static std::vector<u8> generateData(u64 size) {
+        constexpr std::string_view Words[] = { "ImHex ", "pattern ", "provider ", "header ", "0x1234 ", "entry ", "string, ", "data.\n" };
+        constexpr size_t BlockSize = 0x1000;
+
+        std::vector<u8> data(size, 0x00);
+        std::mt19937_64 random(0x496D486578);
+
+        for (u64 offset = 0; offset < size; offset += BlockSize) {
+            auto block = data.data() + offset;
+            auto blockSize = std::min<u64>(BlockSize, size - offset);
+
+            switch ((offset / BlockSize) % 4) {
+                case 0:
+                    for (u64 i = 0; i < blockSize; i++)
+                        block[i] = random();
+                    break;
+                case 1:
+                    for (u64 i = 0; i < blockSize;) {
+                        auto word = Words[random() % std::size(Words)];
+                        auto wordSize = std::min<u64>(word.size(), blockSize - i);
+
+                        std::copy_n(word.begin(), wordSize, block + i);
+                        i += wordSize;
+                    }
+                    break;
+                case 2:
+                    break;
+                case 3:
+                    for (u64 i = 0; i < blockSize; i++)
+                        block[i] = (i % 16) < 4 ? u8(random() % 4) : u8(i);
+                    break;
+            }
+        }
+
+        const u64 needlesSize = sizeof(HexNeedleBytes) + StringNeedle.size();
+        if (size >= needlesSize) {
+            std::copy(std::begin(HexNeedleBytes), std::end(HexNeedleBytes), data.end() - needlesSize);
+            std::copy(StringNeedle.begin(), StringNeedle.end(), data.end() - StringNeedle.size());
+        }
+
+        return data;
+    }
+
+    static bool writeFile(const std::string &path, const std::vector<u8> &data) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+        return file.good();
+    }
+
+    static std::optional<std::string> readFile(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return { };
+
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    static bool readProvider(prv::Provider *provider, std::vector<u8> &buffer) {
+        const u64 size = provider->getSize();
+
+        u64 checksum = 0;
+        for (u64 offset = 0; offset < size; offset += buffer.size()) {
+            auto readSize = std::min<u64>(buffer.size(), size - offset);
+
+            provider->read(offset, buffer.data(), readSize);
+            checksum += buffer[readSize - 1];
+        }
+
+        s_sink = checksum;
+
+        return true;
+    }
+
+    static size_t countStrings(const std::vector<u8> &data, StringEncoding encoding) {
+        constexpr size_t MinimumLength = 5;
+
+        size_t count = 0;
+        for (size_t offset = 0; offset < data.size();) {
+            offset += findPrintable(data.data() + offset, data.size() - offset, encoding);
+            if (offset >= data.size())
+                break;
+
+            auto length = findNonPrintable(data.data() + offset, data.size() - offset, encoding);
+            if (getCharacterCount(data.data() + offset, length, encoding) >= MinimumLength)
+                count++;
+
+            offset += std::max<size_t>(length, 1);
+        }
+
+        return count;
+    }
+
+    static size_t countMatches(const std::vector<u8> &data, const ByteSearcher &searcher) {
+        size_t count = 0;
+        for (size_t offset = 0; offset + searcher.getSize() <= data.size(); offset++) {
+            offset += searcher.find(data.data() + offset, data.size() - offset);
+            if (offset >= data.size())
+                break;
+
+            count++;
+        }
+
+        return count;
+    }
+
+    static std::optional<BenchmarkResult> measure(const Benchmark &benchmark, u64 iterations) {
+        using Clock = std::chrono::steady_clock;
+
+        // The first run warms up caches and makes sure the benchmark works at all before its results count
+        if (!benchmark.run())
+            return { };
+
+        u64 count = 0;
+        auto startTime = Clock::now();
+        auto startCpuTime = std::clock();
+
+        while (true) {
+            if (!benchmark.run())
+                return { };
+            count++;
+
+            if (iterations != 0) {
+                if (count >= iterations)
+                    break;
+            } else if (count >= MinimumIterations && Clock::now() - startTime >= MinimumTime)
+                break;
+        }
+
+        auto realTime = std::chrono::duration<double, std::nano>(Clock::now() - startTime).count();
+        auto cpuTime = double(std::clock() - startCpuTime) * 1'000'000'000.0 / CLOCKS_PER_SEC;
+
+        return BenchmarkResult { benchmark.name, count, realTime / count, cpuTime / count, benchmark.bytesPerIteration };
+    }
+
+    static std::string formatTime(double nanoseconds) {
+        if (nanoseconds >= 1'000'000'000.0)
+            return hex::format("%.2f s", nanoseconds / 1'000'000'000.0);
+        else if (nanoseconds >= 1'000'000.0)
+            return hex::format("%.2f ms", nanoseconds / 1'000'000.0);
+        else if (nanoseconds >= 1'000.0)
+            return hex::format("%.2f us", nanoseconds / 1'000.0);
+        else
+            return hex::format("%.0f ns", nanoseconds);
+    }
+
+    static bool writeResults(const std::string &path, const BenchmarkOptions &options, const std::vector<BenchmarkResult> &results) {
+        auto benchmarks = nlohmann::json::array();
+        for (const auto &result : results) {
+            nlohmann::json entry = {
+                { "name",       result.name         },
+                { "run_name",   result.name         },
+                { "run_type",   "iteration"         },
+                { "iterations", result.iterations   },
+                { "real_time",  result.realTime     },
+                { "cpu_time",   result.cpuTime      },
+                { "time_unit",  "ns"                }
+            };
+
+            if (result.bytesPerIteration != 0)
+                entry["bytes_per_second"] = result.bytesPerIteration * 1'000'000'000.0 / result.realTime;
+
+            benchmarks.push_back(std::move(entry));
+        }
+
+        nlohmann::json json = {
+            { "context", {
+                { "executable",         SharedData::mainArgv[0]                 },
+                { "num_cpus",           std::thread::hardware_concurrency()     },
+                { "data_size",          options.size                            },
+#if defined(NDEBUG)
+                { "library_build_type", "release"                               }
+#else
+                { "library_build_type", "debug"                                 }
+#endif
+            } },
+            { "benchmarks", std::move(benchmarks) }
+        };
+
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        file << json.dump(4) << '\n';
+
+        return file.good();
+    }
+
+    // The input of every stage is prepared up front so each one can also be run on its own. Returns false if the code is invalid
+    static bool addPatternBenchmarks(std::vector<Benchmark> &benchmarks, const std::string &name, const std::string &code, prv::Provider *provider) {
+        auto reportError = [&name](const std::pair<u32, std::string> &error) {
+            std::fprintf(stderr, "%s:%u: error: %s\n", name.c_str(), error.first, error.second.c_str());
+            return false;
+        };
+
+        // Pragmas only change settings of the runtime, they're accepted without doing anything here
+        auto preprocessor = std::make_shared<lang::Preprocessor>();
+        for (auto pragma : { "endian", "pattern_limit", "array_limit", "recursion_limit", "time_limit", "profile" })
+            preprocessor->addPragmaHandler(pragma, [](const std::string&) { return true; });
+        preprocessor->addDefaultPragmaHandlers();
+
+        auto preprocessedCode = preprocessor->preprocess(code);
+        if (!preprocessedCode.has_value())
+            return reportError(preprocessor->getError());
+
+        // Tokens point into the code, so it's shared together with them
+        auto sharedCode = std::make_shared<const std::string>(std::move(*preprocessedCode));
+
+        lang::Lexer lexer;
+        auto tokens = lexer.lex(*sharedCode);
+        if (!tokens.has_value())
+            return reportError(lexer.getError());
+
+        auto sharedTokens = std::make_shared<const std::vector<lang::Token>>(std::move(*tokens));
+
+        auto runtime = std::make_shared<lang::PatternLanguage>();
+        std::shared_ptr<const lang::CompiledPattern> compiledPattern = runtime->compile(code);
+        if (compiledPattern == nullptr)
+            return reportError(*runtime->getError());
+
+        benchmarks.push_back({ "lang/preprocess/" + name, code.size(), [preprocessor, code] {
+            auto result = preprocessor->preprocess(code);
+
+            s_sink = result.has_value() ? result->size() : 0;
+            return result.has_value();
+        } });
+
+        benchmarks.push_back({ "lang/lex/" + name, sharedCode->size(), [sharedCode] {
+            lang::Lexer lexer;
+            auto result = lexer.lex(*sharedCode);
+
+            s_sink = result.has_value() ? result->size() : 0;
+            return result.has_value();
+        } });
+
+        benchmarks.push_back({ "lang/parse/" + name, 0, [sharedTokens] {
+            // The AST gets freed together with the arena, just like the one of a compiled pattern
+            MemoryArena arena;
+            MemoryArena::Scope arenaScope(arena);
+
+            lang::Parser parser;
+            auto ast = parser.parse(*sharedTokens);
+            if (!ast.has_value())
+                return false;
+
+            s_sink = ast->size();
+            for (auto &node : *ast)
+                delete node;
+
+            return true;
+        } });
+
+        benchmarks.push_back({ "lang/evaluate/" + name, 0, [runtime, compiledPattern, provider] {
+            MemoryArena arena;
+            MemoryArena::Scope arenaScope(arena);
+
+            auto patterns = runtime->execute(provider, compiledPattern);
+            if (!patterns.has_value())
+                return false;
+
+            s_sink = patterns->size();
+            for (auto &pattern : *patterns)
+                delete pattern;
+
+            return true;
+        } });
+
+        return true;
+    }
+
+    static dp::Node* createNode(std::string_view category, std::string_view name) {
+        for (const auto &entry : ContentRegistry::DataProcessorNode::getEntries()) {
+            if (entry.category == category && entry.name == name && entry.creatorFunction)
+                return entry.creatorFunction();
+        }
+
+        return nullptr;
+    }
+
+    static void connect(dp::Node *from, u32 output, dp::Node *to, u32 input) {
+        auto &fromAttribute = from->getAttributes()[output];
+        auto &toAttribute = to->getAttributes()[input];
+
+        dp::Link link(fromAttribute.getID(), toAttribute.getID());
+        fromAttribute.addConnectedAttribute(link.getID(), &toAttribute);
+        toAttribute.addConnectedAttribute(link.getID(), &fromAttribute);
+    }
+
+    int runBenchmarks(int argc, char **argv) {
+        SharedData::mainArgc = argc;
+        SharedData::mainArgv = argv;
+
+        auto options = parseArguments(argc, argv);
+        if (!options.has_value()) {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        std::vector<std::pair<std::string, std::string>> patterns = { { "builtin", std::string(BuiltinPattern) } };
+        for (const auto &path : options->patternPaths) {
+            auto code = readFile(path);
+            if (!code.has_value()) {
+                std::fprintf(stderr, "error: failed to read pattern file '%s'\n", path.c_str());
+                return EXIT_FAILURE;
+            }
+
+            patterns.emplace_back(std::filesystem::path(path).filename().string(), std::move(*code));
+        }
+
+        // Builtin functions and data processor nodes get registered by the plugins
+        loadPlugins();
+
+        auto data = generateData(options->size);
+        auto dataPath = (std::filesystem::temp_directory_path() / hex::format("imhex-benchmark-%llu.bin", static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count()))).string();
+        if (!writeFile(dataPath, data)) {
+            std::fprintf(stderr, "error: failed to write benchmark data to '%s'\n", dataPath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        int exitCode = EXIT_SUCCESS;
+        {
+            prv::FileProvider provider(dataPath);
+            prv::FileProvider patchedProvider(dataPath);
+
+            if (!provider.isAvailable() || !patchedProvider.isAvailable()) {
+                std::fprintf(stderr, "error: failed to open benchmark data '%s'\n", dataPath.c_str());
+                std::filesystem::remove(dataPath);
+                return EXIT_FAILURE;
+            }
+
+            // Small scattered changes, like the ones made while editing a file by hand
+            for (u64 offset = 0; offset + 16 <= options->size; offset += 0x1000) {
+                u8 patch[16];
+                std::fill(std::begin(patch), std::end(patch), u8(offset >> 12));
+                patchedProvider.writeAbsolute(offset + 0x100, patch, sizeof(patch));
+            }
+
+            const u64 size = options->size;
+            std::vector<u8> buffer(ReadSize);
+            prv::Provider *providerPointer = &provider;
+
+            std::vector<Benchmark> benchmarks;
+
+            benchmarks.push_back({ "provider/read", size, [&] { return readProvider(&provider, buffer); } });
+            benchmarks.push_back({ "provider/read_patched", size, [&] { return readProvider(&patchedProvider, buffer); } });
+
+            benchmarks.push_back({ "hash/crc32", size, [&] { s_sink = crypt::crc32(providerPointer, 0, size, 0x04C11DB7, 0xFFFFFFFF); return true; } });
+            benchmarks.push_back({ "hash/sha256", size, [&] { s_sink = crypt::sha256(providerPointer, 0, size)[0]; return true; } });
+
+            constexpr static std::pair<const char*, StringEncoding> Encodings[] = { { "ascii", StringEncoding::ASCII }, { "utf8", StringEncoding::UTF8 }, { "utf16le", StringEncoding::UTF16LE } };
+            for (auto [encodingName, encoding] : Encodings) {
+                benchmarks.push_back({ hex::format("strings/%s", encodingName), size, [&data, encoding = encoding] {
+                    s_sink = countStrings(data, encoding);
+                    return true;
+                } });
+            }
+
+            auto hexSearcher = ByteSearcher::parse(HexNeedle).value();
+            auto stringSearcher = ByteSearcher(std::vector<u8>(StringNeedle.begin(), StringNeedle.end()));
+            benchmarks.push_back({ "search/hex", size, [&] { s_sink = countMatches(data, hexSearcher); return s_sink != 0; } });
+            benchmarks.push_back({ "search/string", size, [&] { s_sink = countMatches(data, stringSearcher); return s_sink != 0; } });
+
+            benchmarks.push_back({ "entropy/pyramid", size, [&] {
+                EntropyPyramid pyramid(size);
+                pyramid.buildChunks(&provider, 0, pyramid.getChunkCount() - 1);
+                pyramid.aggregate(0, pyramid.getChunkCount() - 1);
+
+                s_sink = u64(pyramid.getTotalEntropy() * 1000);
+                return true;
+            } });
+
+            for (auto &[name, code] : patterns) {
+                if (!addPatternBenchmarks(benchmarks, name, code, &provider))
+                    exitCode = EXIT_FAILURE;
+            }
+
+            // Source -> Read -> Repeating Key XOR -> Byte Swap -> Sink
+            std::vector<dp::Node*> nodes;
+            auto source = new NodeBenchmarkSource(size, { 0x12, 0x34, 0x56, 0x78, 0x9A });
+            auto sink = new NodeBenchmarkSink();
+            auto read = createNode("Data Access", "Read");
+            auto xorKey = createNode("Buffer Operations", "Repeating Key XOR");
+            auto byteSwap = createNode("Buffer Operations", "Byte Swap");
+
+            nodes = { source, read, xorKey, byteSwap, sink };
+            std::list<dp::Node*> endNodes = { sink };
+            dp::Executor executor;
+
+            if (read != nullptr && xorKey != nullptr && byteSwap != nullptr) {
+                connect(source, 0, read, 0);
+                connect(source, 1, read, 1);
+                connect(read, 2, xorKey, 0);
+                connect(source, 2, xorKey, 1);
+                connect(xorKey, 2, byteSwap, 0);
+                connect(byteSwap, 1, sink, 0);
+
+                benchmarks.push_back({ "data_processor/read_xor_swap", size, [&] {
+                    // Unchanged nodes would otherwise be skipped
+                    for (auto node : nodes)
+                        node->markDirty();
+
+                    executor.execute(endNodes, &provider);
+
+                    return sink->getSize() == size;
+                } });
+            }
+
+            std::vector<BenchmarkResult> results;
+
+            std::printf("%-40s %12s %14s %14s\n", "Benchmark", "Iterations", "Time", "Throughput");
+            for (const auto &benchmark : benchmarks) {
+                if (!options->filter.empty() && benchmark.name.find(options->filter) == std::string::npos)
+                    continue;
+
+                std::optional<BenchmarkResult> result;
+                try {
+                    result = measure(benchmark, options->iterations);
+                } catch (std::exception &e) {
+                    std::fprintf(stderr, "%s: error: %s\n", benchmark.name.c_str(), e.what());
+                }
+
+                if (!result.has_value()) {
+                    std::printf("%-40s %12s\n", benchmark.name.c_str(), "failed");
+                    exitCode = EXIT_FAILURE;
+                    continue;
+                }
+
+                auto throughput = result->bytesPerIteration == 0 ? std::string("-") : hex::format("%.1f MiB/s", result->bytesPerIteration / double(MiB) * 1'000'000'000.0 / result->realTime);
+                std::printf("%-40s %12llu %14s %14s\n", result->name.c_str(), static_cast<unsigned long long>(result->iterations), formatTime(result->realTime).c_str(), throughput.c_str());
+                std::fflush(stdout);
+
+                results.push_back(std::move(*result));
+            }
+
+            if (!options->outputPath.empty() && !writeResults(options->outputPath, *options, results)) {
+                std::fprintf(stderr, "error: failed to write results to '%s'\n", options->outputPath.c_str());
+                exitCode = EXIT_FAILURE;
+            }
+
+            for (auto node : nodes)
+                delete node;
+        }
+
+        std::filesystem::remove(dataPath);
+        PluginHandler::unload();
+
+        return exitCode;
+    }
+
+}
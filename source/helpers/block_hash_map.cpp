@@ -0,0 +1,91 @@
+#include "helpers/block_hash_map.hpp"
+
+#include "helpers/crypto.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/providers/provider.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+namespace hex {
+
+    void BlockHashMap::hashBlocks(prv::Provider *provider, u64 dataSize, u64 firstBlock, u64 lastBlock, u64 *hashes, Task *task) {
+        constexpr static size_t BlocksPerRead = 0x100;
+
+        const u64 start = firstBlock * BlockSize;
+        const u64 end = std::min<u64>(lastBlock * BlockSize, dataSize);
+
+        auto chunks = provider->getChunks(start, end - start, BlocksPerRead * BlockSize);
+        for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+            if (task != nullptr && task->isCancelled())
+                return;
+
+            const auto data = *it;
+            const u64 block = it.getOffset() / BlockSize;
+
+            for (size_t offset = 0; offset < data.size(); offset += BlockSize)
+                hashes[block + offset / BlockSize] = crypt::xxh64(data.data() + offset, std::min(BlockSize, data.size() - offset));
+        }
+    }
+
+    bool BlockHashMap::build(prv::Provider *provider, Task &task) {
+        this->m_dataSize = provider->getActualSize();
+        this->m_hashes.assign((this->m_dataSize + BlockSize - 1) / BlockSize, 0);
+
+        const u64 blockCount = this->m_hashes.size();
+
+        // Progress is only reported once per slice so the threads don't contend on the counter
+        constexpr static u64 SliceBlocks = 0x1000;
+        std::atomic<u64> hashedBlocks = 0;
+
+        return TaskManager::parallelFor(task, (blockCount + SliceBlocks - 1) / SliceBlocks, [&](size_t slice) {
+            const u64 first = slice * SliceBlocks;
+            const u64 last  = std::min(blockCount, first + SliceBlocks);
+
+            hashBlocks(provider, this->m_dataSize, first, last, this->m_hashes.data(), &task);
+
+            task.setProgress(float(hashedBlocks += last - first) / blockCount);
+        });
+    }
+
+    void BlockHashMap::update(prv::Provider *provider, u64 address, size_t size) {
+        if (size == 0 || address >= this->m_dataSize)
+            return;
+
+        const u64 firstBlock = address / BlockSize;
+        const u64 lastBlock  = std::min<u64>((address + size - 1) / BlockSize + 1, this->m_hashes.size());
+
+        hashBlocks(provider, this->m_dataSize, firstBlock, lastBlock, this->m_hashes.data(), nullptr);
+    }
+
+    std::vector<std::pair<u64, u64>> BlockHashMap::getDifferingRanges(const BlockHashMap &left, const BlockHashMap &right) {
+        std::vector<std::pair<u64, u64>> ranges;
+
+        auto addRange = [&ranges](u64 start, u64 end) {
+            if (!ranges.empty() && ranges.back().second == start)
+                ranges.back().second = end;
+            else
+                ranges.emplace_back(start, end);
+        };
+
+        const u64 commonSize = std::min(left.m_dataSize, right.m_dataSize);
+        const u64 commonBlocks = (commonSize + BlockSize - 1) / BlockSize;
+
+        for (u64 block = 0; block < commonBlocks; block++) {
+            const u64 start = block * BlockSize;
+            const u64 end = std::min(start + BlockSize, commonSize);
+
+            // The last common block is partial in at least one of the maps, so its hashes cover different amounts of data
+            const bool partial = end - start < BlockSize && left.m_dataSize != right.m_dataSize;
+            if (partial || left.m_hashes[block] != right.m_hashes[block])
+                addRange(start, end);
+        }
+
+        if (left.m_dataSize != right.m_dataSize)
+            addRange(commonSize, std::max(left.m_dataSize, right.m_dataSize));
+
+        return ranges;
+    }
+
+}
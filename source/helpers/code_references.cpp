@@ -0,0 +1,56 @@
+#include "helpers/code_references.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace hex {
+
+    CodeReferences::CodeReferences(std::vector<CodeReference> references, std::vector<u64> functions)
+        : m_references(std::move(references)), m_functions(std::move(functions)) {
+
+        // Indices of references to the same target stay in the order of their sources
+        this->m_byTarget.resize(this->m_references.size());
+        std::iota(this->m_byTarget.begin(), this->m_byTarget.end(), 0);
+        std::stable_sort(this->m_byTarget.begin(), this->m_byTarget.end(), [this](u32 left, u32 right) {
+            return this->m_references[left].to < this->m_references[right].to;
+        });
+
+        std::sort(this->m_functions.begin(), this->m_functions.end());
+        this->m_functions.erase(std::unique(this->m_functions.begin(), this->m_functions.end()), this->m_functions.end());
+    }
+
+    std::span<const CodeReference> CodeReferences::getReferencesFrom(u64 offset) const {
+        auto first = std::lower_bound(this->m_references.begin(), this->m_references.end(), offset, [](const CodeReference &reference, u64 offset) { return reference.from < offset; });
+        auto last  = std::upper_bound(first, this->m_references.end(), offset, [](u64 offset, const CodeReference &reference) { return offset < reference.from; });
+
+        return { first, last };
+    }
+
+    std::span<const u32> CodeReferences::findTargets(u64 offset) const {
+        auto first = std::partition_point(this->m_byTarget.begin(), this->m_byTarget.end(), [this, offset](u32 index) { return this->m_references[index].to < offset; });
+        auto last  = std::partition_point(first, this->m_byTarget.end(), [this, offset](u32 index) { return this->m_references[index].to == offset; });
+
+        return { first, last };
+    }
+
+    std::vector<CodeReference> CodeReferences::getReferencesTo(u64 offset) const {
+        std::vector<CodeReference> references;
+        for (u32 index : this->findTargets(offset))
+            references.push_back(this->m_references[index]);
+
+        return references;
+    }
+
+    size_t CodeReferences::getReferenceCountTo(u64 offset) const {
+        return this->findTargets(offset).size();
+    }
+
+    bool CodeReferences::isFunction(u64 offset) const {
+        return std::binary_search(this->m_functions.begin(), this->m_functions.end(), offset);
+    }
+
+    size_t CodeReferences::getMemoryUsage() const {
+        return this->m_references.capacity() * sizeof(CodeReference) + this->m_byTarget.capacity() * sizeof(u32) + this->m_functions.capacity() * sizeof(u64);
+    }
+
+}
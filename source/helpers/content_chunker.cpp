@@ -0,0 +1,125 @@
+#include "helpers/content_chunker.hpp"
+
+#include "helpers/crypto.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/providers/provider.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <unordered_map>
+
+namespace hex {
+
+    // Random values for every byte, generated with splitmix64 so the chunk boundaries are the same in every build
+    constexpr static auto GearTable = [] {
+        std::array<u64, 256> table = { 0 };
+
+        u64 state = 0;
+        for (auto &value : table) {
+            state += 0x9E37'79B9'7F4A'7C15;
+
+            u64 z = state;
+            z = (z ^ (z >> 30)) * 0xBF58'476D'1CE4'E5B9;
+            z = (z ^ (z >> 27)) * 0x94D0'49BB'1331'11EB;
+            value = z ^ (z >> 31);
+        }
+
+        return table;
+    }();
+
+    // Bit k of the gear hash depends on the last k + 1 bytes, so the top bits are used to check for boundaries
+    constexpr static u64 BoundaryMask = ~u64(0) << (64 - std::countr_zero(ContentChunker::AverageChunkSize));
+
+    std::optional<std::vector<ContentChunker::Chunk>> ContentChunker::split(prv::Provider *provider, Task *task) {
+        constexpr static size_t ReadSize = 0x10'0000;
+
+        std::vector<Chunk> chunks;
+
+        const u64 dataSize = provider->getActualSize();
+
+        // The unfinished chunk at the end of every read gets moved to the front so all chunks are contiguous in the buffer
+        std::vector<u8> buffer(MaxChunkSize + ReadSize);
+        size_t carried = 0;
+
+        for (u64 address = 0; address < dataSize; ) {
+            if (task != nullptr) {
+                if (task->isCancelled())
+                    return { };
+
+                task->setProgress(float(address) / dataSize);
+            }
+
+            const size_t readSize = std::min<u64>(ReadSize, dataSize - address);
+            provider->readAbsolute(address, buffer.data() + carried, readSize);
+            address += readSize;
+
+            const u64 bufferAddress = address - readSize - carried;
+            const size_t bufferSize = carried + readSize;
+            const bool isLastRead = address == dataSize;
+
+            size_t chunkStart = 0;
+            while (chunkStart < bufferSize) {
+                const size_t available = bufferSize - chunkStart;
+
+                // Chunks that could still end further on have to wait for the next read
+                if (available < MaxChunkSize && !isLastRead)
+                    break;
+
+                size_t chunkSize = std::min(available, MaxChunkSize);
+                u64 hash = 0;
+                for (size_t i = 0; i < chunkSize; i++) {
+                    hash = (hash << 1) + GearTable[buffer[chunkStart + i]];
+
+                    if (i + 1 >= MinChunkSize && (hash & BoundaryMask) == 0) {
+                        chunkSize = i + 1;
+                        break;
+                    }
+                }
+
+                chunks.push_back({ bufferAddress + chunkStart, chunkSize, crypt::xxh64(buffer.data() + chunkStart, chunkSize) });
+                chunkStart += chunkSize;
+            }
+
+            carried = bufferSize - chunkStart;
+            std::memmove(buffer.data(), buffer.data() + chunkStart, carried);
+        }
+
+        return chunks;
+    }
+
+    std::vector<ContentChunker::Match> ContentChunker::match(const std::vector<Chunk> &chunks, const std::vector<Chunk> &otherChunks) {
+        std::unordered_map<u64, size_t> lookup;
+        lookup.reserve(otherChunks.size());
+        for (size_t i = 0; i < otherChunks.size(); i++)
+            lookup.try_emplace(otherChunks[i].hash, i);
+
+        auto isSame = [](const Chunk &left, const Chunk &right) { return left.hash == right.hash && left.size == right.size; };
+
+        std::vector<Match> matches;
+        size_t previousIndex = 0;
+        for (const auto &chunk : chunks) {
+            // Continuing the previous match is preferred, repeated data would otherwise always match its first occurrence
+            if (!matches.empty() && matches.back().address + matches.back().size == chunk.address) {
+                const size_t next = previousIndex + 1;
+                if (next < otherChunks.size() && isSame(otherChunks[next], chunk)) {
+                    matches.back().size += chunk.size;
+                    previousIndex = next;
+                    continue;
+                }
+            }
+
+            auto it = lookup.find(chunk.hash);
+            if (it == lookup.end() || !isSame(otherChunks[it->second], chunk))
+                continue;
+
+            previousIndex = it->second;
+            matches.push_back({ chunk.address, otherChunks[previousIndex].address, chunk.size });
+        }
+
+        return matches;
+    }
+
+}
@@ -1,242 +1,862 @@
 #include "helpers/crypto.hpp"
 
+#include <hex/api/task.hpp>
+#include <hex/helpers/data_encoding.hpp>
+#include <hex/helpers/utils.hpp>
 #include <hex/providers/provider.hpp>
 
-#include <mbedtls/base64.h>
 #include <mbedtls/md5.h>
 #include <mbedtls/sha1.h>
 #include <mbedtls/sha256.h>
 #include <mbedtls/sha512.h>
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <span>
+#include <utility>
 
-namespace hex::crypt {
-
-    u16 crc16(prv::Provider* &data, u64 offset, size_t size, u16 polynomial, u16 init) {
-        const auto table = [polynomial] {
-            std::array<u16, 256> table;
-
-            for (u16 i = 0; i < 256; i++) {
-                u16 crc = 0;
-                u16 c = i;
-
-                for (u16 j = 0; j < 8; j++) {
-                    if (((crc ^ c) & 0x0001U) != 0)
-                        crc = (crc >> 1U) ^ polynomial;
-                    else
-                        crc >>= 1U;
+#if defined(__x86_64__) || defined(_M_X64)
+    #define CRC_X86
+    #include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    #define CRC_ARM
+    #include <arm_acle.h>
+#endif
 
-                    c >>= 1U;
-                }
+namespace hex::crypt {
 
-                table[i] = crc;
-            }
+    class Hasher {
+    public:
+        virtual ~Hasher() = default;
 
-            return table;
-        }();
+        virtual void update(const u8 *data, size_t size) = 0;
+        virtual std::vector<u8> finish() = 0;
+    };
 
-        u16 crc = init;
+    namespace {
 
-        std::array<u8, 512> buffer = { 0 };
+        /*
+         * Reflected CRCs of up to 32 bits share one implementation, a CRC16 register just never has its upper bits set.
+         * Tables are built once per polynomial: the first one is the classic byte wise table, table k holds the CRC
+         * of a byte followed by k zero bytes which lets the loop consume 8 bytes per iteration (slicing-by-8)
+         */
+        using CRCTables = std::array<std::array<u32, 256>, 8>;
 
-        for (u64 bufferOffset = 0; offset < size; offset += buffer.size()) {
-            const u64 readSize = std::min(u64(buffer.size()), size - bufferOffset);
-            data->read(offset + bufferOffset, buffer.data(), readSize);
+        std::shared_ptr<const CRCTables> getCRCTables(u32 polynomial) {
+            static std::mutex mutex;
+            static std::map<u32, std::shared_ptr<const CRCTables>> cache;
 
-            for (size_t i = 0; i < readSize; i++) {
-                crc = (crc >> 8) ^ table[(crc ^ u16(buffer[i])) & 0x00FF];
-            }
-        }
+            std::scoped_lock lock(mutex);
 
-        return crc;
-    }
+            auto &tables = cache[polynomial];
+            if (tables != nullptr)
+                return tables;
 
-    u32 crc32(prv::Provider* &data, u64 offset, size_t size, u32 polynomial, u32 init) {
-        auto table = [polynomial] {
-            std::array<uint32_t, 256> table = {0};
+            auto newTables = std::make_shared<CRCTables>();
+            auto &table = *newTables;
 
-            for (uint32_t i = 0; i < 256; i++) {
-                uint32_t c = i;
+            for (u32 i = 0; i < 256; i++) {
+                u32 c = i;
                 for (size_t j = 0; j < 8; j++) {
                     if (c & 1)
                         c = polynomial ^ (c >> 1);
                     else
                         c >>= 1;
                 }
-                table[i] = c;
+                table[0][i] = c;
             }
 
-            return table;
-        }();
+            for (size_t k = 1; k < table.size(); k++) {
+                for (u32 i = 0; i < 256; i++)
+                    table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+            }
 
-        uint32_t c = init;
-        std::array<u8, 512> buffer = { 0 };
+            tables = std::move(newTables);
+            return tables;
+        }
 
-        for (u64 bufferOffset = 0; offset < size; offset += buffer.size()) {
-            const u64 readSize = std::min(u64(buffer.size()), size - bufferOffset);
-            data->read(offset + bufferOffset, buffer.data(), readSize);
+        u32 updateCRCTables(const CRCTables &table, u32 crc, const u8 *data, size_t size) {
+            for (; size >= 8; data += 8, size -= 8) {
+                const u32 low  = (u32(data[0]) | (u32(data[1]) << 8) | (u32(data[2]) << 16) | (u32(data[3]) << 24)) ^ crc;
+                const u32 high =  u32(data[4]) | (u32(data[5]) << 8) | (u32(data[6]) << 16) | (u32(data[7]) << 24);
 
-            for (size_t i = 0; i < readSize; i++) {
-                c = table[(c ^ buffer[i]) & 0xFF] ^ (c >> 8);
+                crc = table[7][low  & 0xFF] ^ table[6][(low  >> 8) & 0xFF] ^ table[5][(low  >> 16) & 0xFF] ^ table[4][low  >> 24] ^
+                      table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
             }
+
+            for (; size > 0; data++, size--)
+                crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xFF];
+
+            return crc;
         }
 
-        return ~c;
-    }
+        // Reflected polynomials that can be calculated with dedicated instructions
+        constexpr static u32 CRC32Polynomial  = 0xEDB8'8320;
+        constexpr static u32 CRC32CPolynomial = 0x82F6'3B78;
 
-    std::array<u8, 16> md5(prv::Provider* &data, u64 offset, size_t size) {
-        std::array<u8, 16> result = { 0 };
+        using CRCFunction = u32(*)(const CRCTables &table, u32 crc, const u8 *data, size_t size);
 
-        mbedtls_md5_context ctx;
-        mbedtls_md5_init(&ctx);
+        #if defined(CRC_X86)
 
-        mbedtls_md5_starts_ret(&ctx);
+        static __m128i loadBlock(const u8 *data) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        }
 
-        std::array<u8, 512> buffer = { 0 };
-        for (u64 bufferOffset = 0; bufferOffset < size; bufferOffset += buffer.size()) {
-            const u64 readSize = std::min(u64(buffer.size()), size - bufferOffset);
-            data->read(offset + bufferOffset, buffer.data(), readSize);
-            mbedtls_md5_update_ret(&ctx, buffer.data(), readSize);
+        __attribute__((target("pclmul"))) static __m128i foldBlock(__m128i value, __m128i next, __m128i constants) {
+            return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(value, constants, 0x11), _mm_clmulepi64_si128(value, constants, 0x00)), next);
         }
 
-        mbedtls_md5_finish_ret(&ctx, result.data());
+        /*
+         * Folds 64 bytes at a time with carry-less multiplications and reduces the result with a Barrett reduction,
+         * as described in Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+         * The constants are only valid for the standard CRC32 polynomial
+         */
+        __attribute__((target("pclmul,sse4.1"))) static u32 updateCRC32PCLMUL(const CRCTables &table, u32 crc, const u8 *data, size_t size) {
+            if (size < 64)
+                return updateCRCTables(table, crc, data, size);
+
+            const __m128i k1k2 = _mm_set_epi64x(0x1'C6E4'1596, 0x1'5444'2BD4);
+            const __m128i k3k4 = _mm_set_epi64x(0x0'CCAA'009E, 0x1'7519'97D0);
+            const __m128i k5k0 = _mm_set_epi64x(0x0'0000'0000, 0x1'63CD'6124);
+            const __m128i poly = _mm_set_epi64x(0x1'F701'1641, 0x1'DB71'0641);
+            const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+            __m128i x1 = _mm_xor_si128(loadBlock(data + 0x00), _mm_cvtsi32_si128(int(crc)));
+            __m128i x2 = loadBlock(data + 0x10);
+            __m128i x3 = loadBlock(data + 0x20);
+            __m128i x4 = loadBlock(data + 0x30);
+            data += 64;
+            size -= 64;
+
+            for (; size >= 64; data += 64, size -= 64) {
+                x1 = foldBlock(x1, loadBlock(data + 0x00), k1k2);
+                x2 = foldBlock(x2, loadBlock(data + 0x10), k1k2);
+                x3 = foldBlock(x3, loadBlock(data + 0x20), k1k2);
+                x4 = foldBlock(x4, loadBlock(data + 0x30), k1k2);
+            }
+
+            x1 = foldBlock(x1, x2, k3k4);
+            x1 = foldBlock(x1, x3, k3k4);
+            x1 = foldBlock(x1, x4, k3k4);
 
-        mbedtls_md5_free(&ctx);
+            for (; size >= 16; data += 16, size -= 16)
+                x1 = foldBlock(x1, loadBlock(data), k3k4);
 
-        return result;
-    }
+            // 128 to 64 bits
+            x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k3k4, 0x10));
+            x1 = _mm_xor_si128(_mm_srli_si128(x1, 4), _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k5k0, 0x00));
 
-    std::array<u8, 20> sha1(prv::Provider* &data, u64 offset, size_t size) {
-        std::array<u8, 20> result = { 0 };
+            // 64 to 32 bits
+            __m128i reduced = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), poly, 0x10);
+            reduced = _mm_clmulepi64_si128(_mm_and_si128(reduced, mask), poly, 0x00);
+            crc = u32(_mm_extract_epi32(_mm_xor_si128(x1, reduced), 1));
 
-        mbedtls_sha1_context ctx;
-        mbedtls_sha1_init(&ctx);
+            return updateCRCTables(table, crc, data, size);
+        }
+
+        __attribute__((target("sse4.2"))) static u32 updateCRC32CSSE42(const CRCTables &, u32 crc, const u8 *data, size_t size) {
+            u64 crc64 = crc;
+            for (; size >= 8; data += 8, size -= 8) {
+                u64 value;
+                std::memcpy(&value, data, sizeof(value));
+                crc64 = _mm_crc32_u64(crc64, value);
+            }
 
-        mbedtls_sha1_starts_ret(&ctx);
+            crc = u32(crc64);
+            for (; size > 0; data++, size--)
+                crc = _mm_crc32_u8(crc, *data);
 
-        std::array<u8, 512> buffer = { 0 };
-        for (u64 bufferOffset = 0; bufferOffset < size; bufferOffset += buffer.size()) {
-            const u64 readSize = std::min(u64(buffer.size()), size - bufferOffset);
-            data->read(offset + bufferOffset, buffer.data(), readSize);
-            mbedtls_sha1_update_ret(&ctx, buffer.data(), readSize);
+            return crc;
         }
 
-        mbedtls_sha1_finish_ret(&ctx, result.data());
+        #elif defined(CRC_ARM)
 
-        mbedtls_sha1_free(&ctx);
+        static u32 updateCRC32ARM(const CRCTables &, u32 crc, const u8 *data, size_t size) {
+            for (; size >= 8; data += 8, size -= 8) {
+                u64 value;
+                std::memcpy(&value, data, sizeof(value));
+                crc = __crc32d(crc, value);
+            }
 
-        return result;
-    }
+            for (; size > 0; data++, size--)
+                crc = __crc32b(crc, *data);
 
-    std::array<u8, 28> sha224(prv::Provider* &data, u64 offset, size_t size) {
-        std::array<u8, 28> result = { 0 };
+            return crc;
+        }
 
-        mbedtls_sha256_context ctx;
-        mbedtls_sha256_init(&ctx);
+        static u32 updateCRC32CARM(const CRCTables &, u32 crc, const u8 *data, size_t size) {
+            for (; size >= 8; data += 8, size -= 8) {
+                u64 value;
+                std::memcpy(&value, data, sizeof(value));
+                crc = __crc32cd(crc, value);
+            }
 
-        mbedtls_sha256_starts_ret(&ctx, true);
+            for (; size > 0; data++, size--)
+                crc = __crc32cb(crc, *data);
 
-        std::array<u8, 512> buffer = { 0 };
-        for (u64 bufferOffset = 0; bufferOffset < size; bufferOffset += buffer.size()) {
-            const u64 readSize = std::min(u64(buffer.size()), size - bufferOffset);
-            data->read(offset + bufferOffset, buffer.data(), readSize);
-            mbedtls_sha256_update_ret(&ctx, buffer.data(), readSize);
+            return crc;
         }
 
-        mbedtls_sha256_finish_ret(&ctx, result.data());
+        #endif
+
+        CRCFunction selectCRCFunction(u32 polynomial) {
+            #if defined(CRC_X86) && defined(__GNUC__)
+                if (polynomial == CRC32Polynomial && __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+                    return updateCRC32PCLMUL;
+                if (polynomial == CRC32CPolynomial && __builtin_cpu_supports("sse4.2"))
+                    return updateCRC32CSSE42;
+            #elif defined(CRC_ARM)
+                if (polynomial == CRC32Polynomial)
+                    return updateCRC32ARM;
+                if (polynomial == CRC32CPolynomial)
+                    return updateCRC32CARM;
+            #endif
+
+            return updateCRCTables;
+        }
 
-        mbedtls_sha256_free(&ctx);
+        class CRCHasher : public Hasher {
+        public:
+            CRCHasher(u8 width, u32 polynomial, u32 init, u32 finalXor)
+                : m_width(width), m_tables(getCRCTables(polynomial)), m_update(selectCRCFunction(polynomial)), m_crc(init), m_finalXor(finalXor) { }
 
-        return result;
-    }
+            void update(const u8 *data, size_t size) override {
+                this->m_crc = this->m_update(*this->m_tables, this->m_crc, data, size);
+            }
 
-    std::array<u8, 32> sha256(prv::Provider* &data, u64 offset, size_t size) {
-        std::array<u8, 32> result = { 0 };
+            std::vector<u8> finish() override {
+                const u32 crc = this->m_crc ^ this->m_finalXor;
 
-        mbedtls_sha256_context ctx;
-        mbedtls_sha256_init(&ctx);
+                std::vector<u8> result;
+                for (u8 shift = this->m_width; shift > 0; shift -= 8)
+                    result.push_back(u8(crc >> (shift - 8)));
 
-        mbedtls_sha256_starts_ret(&ctx, false);
+                return result;
+            }
 
-        std::array<u8, 512> buffer = { 0 };
-        for (u64 bufferOffset = 0; bufferOffset < size; bufferOffset += buffer.size()) {
-            const u64 readSize = std::min(u64(buffer.size()), size - bufferOffset);
-            data->read(offset + bufferOffset, buffer.data(), readSize);
-            mbedtls_sha256_update_ret(&ctx, buffer.data(), readSize);
-        }
+        private:
+            u8 m_width;
+            std::shared_ptr<const CRCTables> m_tables;
+            CRCFunction m_update;
+            u32 m_crc, m_finalXor;
+        };
+
+        class MD5Hasher : public Hasher {
+        public:
+            MD5Hasher() {
+                mbedtls_md5_init(&this->m_ctx);
+                mbedtls_md5_starts_ret(&this->m_ctx);
+            }
 
-        mbedtls_sha256_finish_ret(&ctx, result.data());
+            ~MD5Hasher() override { mbedtls_md5_free(&this->m_ctx); }
 
-        mbedtls_sha256_free(&ctx);
+            void update(const u8 *data, size_t size) override { mbedtls_md5_update_ret(&this->m_ctx, data, size); }
 
-        return result;
-    }
+            std::vector<u8> finish() override {
+                std::vector<u8> result(16);
+                mbedtls_md5_finish_ret(&this->m_ctx, result.data());
+                return result;
+            }
 
-    std::array<u8, 48> sha384(prv::Provider* &data, u64 offset, size_t size) {
-        std::array<u8, 48> result = { 0 };
+        private:
+            mbedtls_md5_context m_ctx;
+        };
+
+        class SHA1Hasher : public Hasher {
+        public:
+            SHA1Hasher() {
+                mbedtls_sha1_init(&this->m_ctx);
+                mbedtls_sha1_starts_ret(&this->m_ctx);
+            }
+
+            ~SHA1Hasher() override { mbedtls_sha1_free(&this->m_ctx); }
+
+            void update(const u8 *data, size_t size) override { mbedtls_sha1_update_ret(&this->m_ctx, data, size); }
+
+            std::vector<u8> finish() override {
+                std::vector<u8> result(20);
+                mbedtls_sha1_finish_ret(&this->m_ctx, result.data());
+                return result;
+            }
 
-        mbedtls_sha512_context ctx;
-        mbedtls_sha512_init(&ctx);
+        private:
+            mbedtls_sha1_context m_ctx;
+        };
 
-        mbedtls_sha512_starts_ret(&ctx, true);
+        // Also calculates SHA-224, which is a truncated SHA-256 with different initial values
+        class SHA256Hasher : public Hasher {
+        public:
+            explicit SHA256Hasher(bool is224) : m_is224(is224) {
+                mbedtls_sha256_init(&this->m_ctx);
+                mbedtls_sha256_starts_ret(&this->m_ctx, is224);
+            }
+
+            ~SHA256Hasher() override { mbedtls_sha256_free(&this->m_ctx); }
+
+            void update(const u8 *data, size_t size) override { mbedtls_sha256_update_ret(&this->m_ctx, data, size); }
+
+            std::vector<u8> finish() override {
+                std::vector<u8> result(32);
+                mbedtls_sha256_finish_ret(&this->m_ctx, result.data());
+                result.resize(this->m_is224 ? 28 : 32);
+                return result;
+            }
+
+        private:
+            mbedtls_sha256_context m_ctx;
+            bool m_is224;
+        };
+
+        // Also calculates SHA-384, which is a truncated SHA-512 with different initial values
+        class SHA512Hasher : public Hasher {
+        public:
+            explicit SHA512Hasher(bool is384) : m_is384(is384) {
+                mbedtls_sha512_init(&this->m_ctx);
+                mbedtls_sha512_starts_ret(&this->m_ctx, is384);
+            }
+
+            ~SHA512Hasher() override { mbedtls_sha512_free(&this->m_ctx); }
+
+            void update(const u8 *data, size_t size) override { mbedtls_sha512_update_ret(&this->m_ctx, data, size); }
+
+            std::vector<u8> finish() override {
+                std::vector<u8> result(64);
+                mbedtls_sha512_finish_ret(&this->m_ctx, result.data());
+                result.resize(this->m_is384 ? 48 : 64);
+                return result;
+            }
+
+        private:
+            mbedtls_sha512_context m_ctx;
+            bool m_is384;
+        };
+
+        class XXH64Hasher : public Hasher {
+        public:
+            XXH64Hasher() : m_accumulators{ Prime1 + Prime2, Prime2, 0, u64(0) - Prime1 } { }
+
+            void update(const u8 *data, size_t size) override {
+                this->m_totalSize += size;
+
+                if (this->m_bufferSize > 0) {
+                    const size_t take = std::min(size, this->m_buffer.size() - this->m_bufferSize);
+                    std::memcpy(this->m_buffer.data() + this->m_bufferSize, data, take);
+                    this->m_bufferSize += take;
+                    data += take;
+                    size -= take;
+
+                    if (this->m_bufferSize < this->m_buffer.size())
+                        return;
+
+                    this->consumeStripe(this->m_buffer.data());
+                    this->m_bufferSize = 0;
+                }
+
+                for (; size >= StripeSize; data += StripeSize, size -= StripeSize)
+                    this->consumeStripe(data);
+
+                std::memcpy(this->m_buffer.data(), data, size);
+                this->m_bufferSize = size;
+            }
+
+            std::vector<u8> finish() override {
+                const u64 hash = this->getDigest();
+
+                std::vector<u8> result;
+                for (u8 shift = 64; shift > 0; shift -= 8)
+                    result.push_back(u8(hash >> (shift - 8)));
+
+                return result;
+            }
+
+            [[nodiscard]] u64 getDigest() const {
+                const auto &[v1, v2, v3, v4] = this->m_accumulators;
+
+                u64 hash;
+                if (this->m_totalSize >= StripeSize) {
+                    hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+                    for (u64 accumulator : this->m_accumulators)
+                        hash = (hash ^ round(0, accumulator)) * Prime1 + Prime4;
+                } else
+                    hash = Prime5;
+
+                hash += this->m_totalSize;
+
+                const u8 *data = this->m_buffer.data();
+                size_t size = this->m_bufferSize;
+                for (; size >= 8; data += 8, size -= 8)
+                    hash = std::rotl(hash ^ round(0, read<u64>(data)), 27) * Prime1 + Prime4;
+                for (; size >= 4; data += 4, size -= 4)
+                    hash = std::rotl(hash ^ (read<u32>(data) * Prime1), 23) * Prime2 + Prime3;
+                for (; size > 0; data++, size--)
+                    hash = std::rotl(hash ^ (*data * Prime5), 11) * Prime1;
+
+                hash ^= hash >> 33;
+                hash *= Prime2;
+                hash ^= hash >> 29;
+                hash *= Prime3;
+                hash ^= hash >> 32;
+
+                return hash;
+            }
+
+        private:
+            constexpr static u64 Prime1 = 0x9E37'79B1'85EB'CA87;
+            constexpr static u64 Prime2 = 0xC2B2'AE3D'27D4'EB4F;
+            constexpr static u64 Prime3 = 0x1656'67B1'9E37'79F9;
+            constexpr static u64 Prime4 = 0x85EB'CA77'C2B2'AE63;
+            constexpr static u64 Prime5 = 0x27D4'EB2F'1656'67C5;
+            constexpr static size_t StripeSize = 32;
+
+            template<typename T>
+            static u64 read(const u8 *data) {
+                T value;
+                std::memcpy(&value, data, sizeof(value));
+                return hex::changeEndianess(value, std::endian::little);
+            }
+
+            static u64 round(u64 accumulator, u64 input) {
+                return std::rotl(accumulator + input * Prime2, 31) * Prime1;
+            }
+
+            void consumeStripe(const u8 *data) {
+                for (size_t i = 0; i < this->m_accumulators.size(); i++)
+                    this->m_accumulators[i] = round(this->m_accumulators[i], read<u64>(data + i * 8));
+            }
+
+            std::array<u64, 4> m_accumulators;
+            std::array<u8, StripeSize> m_buffer = { 0 };
+            size_t m_bufferSize = 0;
+            u64 m_totalSize = 0;
+        };
+
+        /*
+         * BLAKE3 splits the data into 1 KiB chunks that are the leaves of a binary tree, so every complete subtree
+         * can be hashed independently. Large aligned parts of the input get split into subtrees that are hashed
+         * on the workers of the task's priority, everything else goes through the sequential chunk state and stack of chaining values
+         */
+        class BLAKE3Hasher : public Hasher {
+        public:
+            explicit BLAKE3Hasher(Task &task) : m_task(task) { }
+
+            void update(const u8 *data, size_t size) override {
+                // A partially filled chunk has to be completed first. It's only finished once more data follows as it could be the root
+                if (this->m_chunk.getSize() > 0) {
+                    const size_t take = std::min(size, ChunkSize - this->m_chunk.getSize());
+                    this->m_chunk.update(data, take);
+                    data += take;
+                    size -= take;
+
+                    if (size == 0)
+                        return;
+
+                    this->pushChainingValue(this->m_chunk.getChainingValue(), this->m_chunk.getCounter());
+                    this->m_chunk = ChunkState(this->m_chunk.getCounter() + 1);
+                }
+
+                // The last chunk always stays in the chunk state, it could end up being the root
+                while (size > ChunkSize) {
+                    const u64 counter = this->m_chunk.getCounter();
+
+                    u64 subtreeSize = std::bit_floor(size);
+                    while (((subtreeSize - 1) & (counter * ChunkSize)) != 0)
+                        subtreeSize /= 2;
+
+                    const u64 subtreeChunks = subtreeSize / ChunkSize;
+                    if (subtreeChunks == 1) {
+                        this->pushChainingValue(hashChunk(data, counter), counter);
+                    } else {
+                        // Pushing both children instead of the subtree's root keeps the root flag for the final merge
+                        auto [left, right] = this->hashSubtreeChildren(data, subtreeSize, counter);
+                        this->pushChainingValue(left, counter);
+                        this->pushChainingValue(right, counter + subtreeChunks / 2);
+                    }
+
+                    this->m_chunk = ChunkState(counter + subtreeChunks);
+                    data += subtreeSize;
+                    size -= subtreeSize;
+                }
+
+                if (size > 0) {
+                    this->m_chunk.update(data, size);
+                    this->mergeStack(this->m_chunk.getCounter());
+                }
+            }
+
+            std::vector<u8> finish() override {
+                Output output;
+                size_t remaining = this->m_stack.size();
+
+                if (remaining == 0 || this->m_chunk.getSize() > 0)
+                    output = this->m_chunk.getOutput();
+                else {
+                    // Data ended on a subtree boundary, there are always at least two chaining values left
+                    remaining -= 2;
+                    output = parentOutput(this->m_stack[remaining], this->m_stack[remaining + 1]);
+                }
+
+                while (remaining > 0) {
+                    remaining--;
+                    output = parentOutput(this->m_stack[remaining], output.getChainingValue());
+                }
+
+                const auto words = compress(output.chainingValue, output.block, output.counter, output.blockSize, output.flags | Root);
+
+                std::vector<u8> result;
+                for (size_t i = 0; i < 8; i++) {
+                    for (size_t byte = 0; byte < 4; byte++)
+                        result.push_back(u8(words[i] >> (byte * 8)));
+                }
 
-        std::array<u8, 512> buffer = { 0 };
-        for (u64 bufferOffset = 0; bufferOffset < size; bufferOffset += buffer.size()) {
-            const u64 readSize = std::min(u64(buffer.size()), size - bufferOffset);
-            data->read(offset + bufferOffset, buffer.data(), readSize);
-            mbedtls_sha512_update_ret(&ctx, buffer.data(), readSize);
+                return result;
+            }
+
+        private:
+            constexpr static size_t BlockSize = 64;
+            constexpr static size_t ChunkSize = 0x400;
+            constexpr static size_t MinParallelSize = 0x1'0000;
+            constexpr static size_t MinSubtreeSizePerThread = 0x4000;
+
+            enum Flags : u32 { ChunkStart = 1 << 0, ChunkEnd = 1 << 1, Parent = 1 << 2, Root = 1 << 3 };
+
+            using ChainingValue = std::array<u32, 8>;
+            using Block = std::array<u32, 16>;
+
+            constexpr static ChainingValue IV = { 0x6A09'E667, 0xBB67'AE85, 0x3C6E'F372, 0xA54F'F53A, 0x510E'527F, 0x9B05'688C, 0x1F83'D9AB, 0x5BE0'CD19 };
+
+            static std::array<u32, 16> compress(const ChainingValue &chainingValue, const Block &block, u64 counter, u32 blockSize, u32 flags) {
+                // Message word order of every round, the permutation applied repeatedly
+                constexpr static u8 Schedule[7][16] = {
+                    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+                    { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+                    { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+                    { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+                    { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+                    { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+                    { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+                };
+
+                std::array<u32, 16> state = {
+                    chainingValue[0], chainingValue[1], chainingValue[2], chainingValue[3],
+                    chainingValue[4], chainingValue[5], chainingValue[6], chainingValue[7],
+                    IV[0], IV[1], IV[2], IV[3],
+                    u32(counter), u32(counter >> 32), blockSize, flags
+                };
+
+                auto mix = [&state](size_t a, size_t b, size_t c, size_t d, u32 x, u32 y) {
+                    state[a] = state[a] + state[b] + x;
+                    state[d] = std::rotr(state[d] ^ state[a], 16);
+                    state[c] = state[c] + state[d];
+                    state[b] = std::rotr(state[b] ^ state[c], 12);
+                    state[a] = state[a] + state[b] + y;
+                    state[d] = std::rotr(state[d] ^ state[a], 8);
+                    state[c] = state[c] + state[d];
+                    state[b] = std::rotr(state[b] ^ state[c], 7);
+                };
+
+                for (const auto &order : Schedule) {
+                    mix(0, 4,  8, 12, block[order[0]],  block[order[1]]);
+                    mix(1, 5,  9, 13, block[order[2]],  block[order[3]]);
+                    mix(2, 6, 10, 14, block[order[4]],  block[order[5]]);
+                    mix(3, 7, 11, 15, block[order[6]],  block[order[7]]);
+                    mix(0, 5, 10, 15, block[order[8]],  block[order[9]]);
+                    mix(1, 6, 11, 12, block[order[10]], block[order[11]]);
+                    mix(2, 7,  8, 13, block[order[12]], block[order[13]]);
+                    mix(3, 4,  9, 14, block[order[14]], block[order[15]]);
+                }
+
+                for (size_t i = 0; i < 8; i++) {
+                    state[i] ^= state[i + 8];
+                    state[i + 8] ^= chainingValue[i];
+                }
+
+                return state;
+            }
+
+            static ChainingValue truncate(const std::array<u32, 16> &words) {
+                ChainingValue result;
+                std::copy_n(words.begin(), result.size(), result.begin());
+                return result;
+            }
+
+            static Block loadBlock(const u8 *data, size_t size) {
+                std::array<u8, BlockSize> bytes = { 0 };
+                std::memcpy(bytes.data(), data, size);
+
+                Block block;
+                std::memcpy(block.data(), bytes.data(), bytes.size());
+                for (auto &word : block)
+                    word = hex::changeEndianess(word, std::endian::little);
+
+                return block;
+            }
+
+            // Everything needed to calculate a node's chaining value, kept unevaluated until it's known whether it's the root
+            struct Output {
+                ChainingValue chainingValue;
+                Block block;
+                u64 counter;
+                u32 blockSize;
+                u32 flags;
+
+                [[nodiscard]] ChainingValue getChainingValue() const {
+                    return truncate(compress(this->chainingValue, this->block, this->counter, this->blockSize, this->flags));
+                }
+            };
+
+            static Output parentOutput(const ChainingValue &left, const ChainingValue &right) {
+                Output output = { IV, { }, 0, BlockSize, Parent };
+                std::copy(left.begin(), left.end(), output.block.begin());
+                std::copy(right.begin(), right.end(), output.block.begin() + left.size());
+
+                return output;
+            }
+
+            static ChainingValue parentChainingValue(const ChainingValue &left, const ChainingValue &right) {
+                return parentOutput(left, right).getChainingValue();
+            }
+
+            class ChunkState {
+            public:
+                explicit ChunkState(u64 counter = 0) : m_counter(counter) { }
+
+                void update(const u8 *data, size_t size) {
+                    while (size > 0) {
+                        // Full blocks are only compressed once more data follows since the last one needs the chunk end flag
+                        if (this->m_bufferSize == BlockSize) {
+                            this->m_chainingValue = truncate(compress(this->m_chainingValue, loadBlock(this->m_buffer.data(), BlockSize), this->m_counter, BlockSize, this->getStartFlag()));
+                            this->m_compressedBlocks++;
+                            this->m_bufferSize = 0;
+                        }
+
+                        const size_t take = std::min(size, BlockSize - this->m_bufferSize);
+                        std::memcpy(this->m_buffer.data() + this->m_bufferSize, data, take);
+                        this->m_bufferSize += take;
+                        data += take;
+                        size -= take;
+                    }
+                }
+
+                [[nodiscard]] Output getOutput() const {
+                    return { this->m_chainingValue, loadBlock(this->m_buffer.data(), this->m_bufferSize), this->m_counter, u32(this->m_bufferSize), this->getStartFlag() | ChunkEnd };
+                }
+
+                [[nodiscard]] ChainingValue getChainingValue() const { return this->getOutput().getChainingValue(); }
+                [[nodiscard]] size_t getSize() const { return this->m_compressedBlocks * BlockSize + this->m_bufferSize; }
+                [[nodiscard]] u64 getCounter() const { return this->m_counter; }
+
+            private:
+                [[nodiscard]] u32 getStartFlag() const { return this->m_compressedBlocks == 0 ? ChunkStart : 0; }
+
+                ChainingValue m_chainingValue = IV;
+                u64 m_counter;
+                std::array<u8, BlockSize> m_buffer = { 0 };
+                size_t m_bufferSize = 0;
+                size_t m_compressedBlocks = 0;
+            };
+
+            static ChainingValue hashChunk(const u8 *data, u64 counter) {
+                ChainingValue chainingValue = IV;
+
+                for (size_t block = 0; block < ChunkSize / BlockSize; block++) {
+                    const u32 flags = (block == 0 ? ChunkStart : 0) | (block == ChunkSize / BlockSize - 1 ? ChunkEnd : 0);
+                    chainingValue = truncate(compress(chainingValue, loadBlock(data + block * BlockSize, BlockSize), counter, BlockSize, flags));
+                }
+
+                return chainingValue;
+            }
+
+            // Size has to be a power of two number of chunks
+            static ChainingValue hashSubtree(const u8 *data, size_t size, u64 counter) {
+                if (size == ChunkSize)
+                    return hashChunk(data, counter);
+
+                const size_t half = size / 2;
+                return parentChainingValue(hashSubtree(data, half, counter), hashSubtree(data + half, half, counter + half / ChunkSize));
+            }
+
+            std::pair<ChainingValue, ChainingValue> hashSubtreeChildren(const u8 *data, size_t size, u64 counter) {
+                const size_t half = size / 2;
+
+                const size_t threadCount = TaskManager::getParallelism(this->m_task, size / MinSubtreeSizePerThread);
+                if (size < MinParallelSize || threadCount == 1)
+                    return { hashSubtree(data, half, counter), hashSubtree(data + half, half, counter + half / ChunkSize) };
+
+                // Split into a power of two number of subtrees so they can be merged back into the two children
+                const size_t subtreeCount = std::clamp<size_t>(std::bit_floor(threadCount * 2), 2, size / MinSubtreeSizePerThread);
+                const size_t subtreeSize = size / subtreeCount;
+
+                std::vector<ChainingValue> chainingValues(subtreeCount);
+                TaskManager::parallelFor(this->m_task, subtreeCount, [&](size_t index) {
+                    chainingValues[index] = hashSubtree(data + index * subtreeSize, subtreeSize, counter + index * (subtreeSize / ChunkSize));
+                });
+
+                while (chainingValues.size() > 2) {
+                    for (size_t i = 0; i < chainingValues.size() / 2; i++)
+                        chainingValues[i] = parentChainingValue(chainingValues[i * 2], chainingValues[i * 2 + 1]);
+                    chainingValues.resize(chainingValues.size() / 2);
+                }
+
+                return { chainingValues[0], chainingValues[1] };
+            }
+
+            // Merges completed subtrees, the stack always holds one chaining value per set bit of the number of chunks before the current one
+            void mergeStack(u64 chunkCount) {
+                while (this->m_stack.size() > size_t(std::popcount(chunkCount))) {
+                    const auto right = this->m_stack.back();
+                    this->m_stack.pop_back();
+                    const auto left = this->m_stack.back();
+                    this->m_stack.pop_back();
+
+                    this->m_stack.push_back(parentChainingValue(left, right));
+                }
+            }
+
+            void pushChainingValue(const ChainingValue &chainingValue, u64 chunkCounter) {
+                this->mergeStack(chunkCounter);
+                this->m_stack.push_back(chainingValue);
+            }
+
+            ChunkState m_chunk;
+            std::vector<ChainingValue> m_stack;
+            Task &m_task;
+        };
+
+        std::unique_ptr<Hasher> createHasher(const HashSettings &settings, Task &task) {
+            switch (settings.function) {
+                case HashFunction::CRC16:   return std::make_unique<CRCHasher>(16, u16(settings.polynomial), u16(settings.init), 0x0000);
+                case HashFunction::CRC32:   return std::make_unique<CRCHasher>(32, settings.polynomial, settings.init, 0xFFFF'FFFF);
+                case HashFunction::MD5:     return std::make_unique<MD5Hasher>();
+                case HashFunction::SHA1:    return std::make_unique<SHA1Hasher>();
+                case HashFunction::SHA224:  return std::make_unique<SHA256Hasher>(true);
+                case HashFunction::SHA256:  return std::make_unique<SHA256Hasher>(false);
+                case HashFunction::SHA384:  return std::make_unique<SHA512Hasher>(true);
+                case HashFunction::SHA512:  return std::make_unique<SHA512Hasher>(false);
+                case HashFunction::XXH64:   return std::make_unique<XXH64Hasher>();
+                case HashFunction::BLAKE3:  return std::make_unique<BLAKE3Hasher>(task);
+            }
+
+            return nullptr;
         }
 
-        mbedtls_sha512_finish_ret(&ctx, result.data());
+        template<size_t Size>
+        std::array<u8, Size> hashSingle(prv::Provider *data, u64 offset, size_t size, HashSettings settings) {
+            std::array<u8, Size> result = { 0 };
+
+            if (auto digests = hash(data, offset, size, { settings }); digests.has_value())
+                std::copy_n(digests->front().begin(), Size, result.begin());
 
-        mbedtls_sha512_free(&ctx);
+            return result;
+        }
 
-        return result;
     }
 
-    std::array<u8, 64> sha512(prv::Provider* &data, u64 offset, size_t size) {
-        std::array<u8, 64> result = { 0 };
+    HashPass::HashPass(const std::vector<HashSettings> &hashes, TaskPriority priority) : m_task(std::make_unique<Task>("Hashing", priority)) {
+        for (const auto &settings : hashes)
+            this->m_hashers.push_back(createHasher(settings, *this->m_task));
+    }
 
-        mbedtls_sha512_context ctx;
-        mbedtls_sha512_init(&ctx);
+    HashPass::~HashPass() = default;
 
-        mbedtls_sha512_starts_ret(&ctx, false);
+    std::vector<prv::ScanPipeline::Consumer> HashPass::getConsumers() const {
+        std::vector<prv::ScanPipeline::Consumer> consumers;
 
-        std::array<u8, 512> buffer = { 0 };
-        for (u64 bufferOffset = 0; bufferOffset < size; bufferOffset += buffer.size()) {
-            const u64 readSize = std::min(u64(buffer.size()), size - bufferOffset);
-            data->read(offset + bufferOffset, buffer.data(), readSize);
-            mbedtls_sha512_update_ret(&ctx, buffer.data(), readSize);
+        for (const auto &hasher : this->m_hashers) {
+            consumers.emplace_back([hasher = hasher.get()](u64, const u8 *data, size_t size) {
+                hasher->update(data, size);
+            });
         }
 
-        mbedtls_sha512_finish_ret(&ctx, result.data());
+        return consumers;
+    }
 
-        mbedtls_sha512_free(&ctx);
+    std::vector<std::vector<u8>> HashPass::finish() {
+        std::vector<std::vector<u8>> digests;
+        for (auto &hasher : this->m_hashers)
+            digests.push_back(hasher->finish());
 
-        return result;
+        return digests;
     }
 
-    std::vector<u8> decode64(const std::vector<u8> &input) {
-        size_t outputSize = (3 * input.size()) / 4;
-        std::vector<u8> output(outputSize + 1, 0x00);
+    std::optional<std::vector<std::vector<u8>>> hash(prv::Provider *data, u64 offset, size_t size, const std::vector<HashSettings> &hashes, Task *task, const ChunkCallback &onChunk) {
+        HashPass pass(hashes, task != nullptr ? task->getPriority() : TaskPriority::Normal);
+
+        auto consumers = pass.getConsumers();
+        if (onChunk)
+            consumers.push_back(onChunk);
 
-        size_t written = 0;
-        if (mbedtls_base64_decode(output.data(), output.size(), &written, reinterpret_cast<const unsigned char *>(input.data()), input.size()))
+        if (!prv::ScanPipeline::run(data, offset, size, consumers, task))
             return { };
 
-        return output;
+        return pass.finish();
     }
 
-    std::vector<u8> encode64(const std::vector<u8> &input) {
-        size_t outputSize = 4 * ((input.size() + 2) / 3);
-        std::vector<u8> output(outputSize + 1, 0x00);
+    std::optional<std::vector<std::vector<u8>>> hash(const prv::Snapshot &data, u64 offset, size_t size, const std::vector<HashSettings> &hashes, Task *task, const ChunkCallback &onChunk) {
+        HashPass pass(hashes, task != nullptr ? task->getPriority() : TaskPriority::Normal);
+
+        auto consumers = pass.getConsumers();
+        if (onChunk)
+            consumers.push_back(onChunk);
 
-        size_t written = 0;
-        if (mbedtls_base64_encode(output.data(), output.size(), &written, reinterpret_cast<const unsigned char *>(input.data()), input.size()))
+        if (!prv::ScanPipeline::run(data, offset, size, consumers, task))
             return { };
 
-        return output;
+        return pass.finish();
+    }
+
+    u64 xxh64(const u8 *data, size_t size) {
+        XXH64Hasher hasher;
+        hasher.update(data, size);
+
+        return hasher.getDigest();
+    }
+
+    u16 crc16(prv::Provider* &data, u64 offset, size_t size, u16 polynomial, u16 init) {
+        auto digest = hashSingle<2>(data, offset, size, { HashFunction::CRC16, polynomial, init });
+        return (u16(digest[0]) << 8) | digest[1];
+    }
+
+    u32 crc32(prv::Provider* &data, u64 offset, size_t size, u32 polynomial, u32 init) {
+        auto digest = hashSingle<4>(data, offset, size, { HashFunction::CRC32, polynomial, init });
+        return (u32(digest[0]) << 24) | (u32(digest[1]) << 16) | (u32(digest[2]) << 8) | digest[3];
+    }
+
+    std::array<u8, 16> md5(prv::Provider* &data, u64 offset, size_t size) {
+        return hashSingle<16>(data, offset, size, { HashFunction::MD5 });
+    }
+
+    std::array<u8, 20> sha1(prv::Provider* &data, u64 offset, size_t size) {
+        return hashSingle<20>(data, offset, size, { HashFunction::SHA1 });
+    }
+
+    std::array<u8, 28> sha224(prv::Provider* &data, u64 offset, size_t size) {
+        return hashSingle<28>(data, offset, size, { HashFunction::SHA224 });
+    }
+
+    std::array<u8, 32> sha256(prv::Provider* &data, u64 offset, size_t size) {
+        return hashSingle<32>(data, offset, size, { HashFunction::SHA256 });
+    }
+
+    std::array<u8, 48> sha384(prv::Provider* &data, u64 offset, size_t size) {
+        return hashSingle<48>(data, offset, size, { HashFunction::SHA384 });
+    }
+
+    std::array<u8, 64> sha512(prv::Provider* &data, u64 offset, size_t size) {
+        return hashSingle<64>(data, offset, size, { HashFunction::SHA512 });
+    }
+
+    std::vector<u8> decode64(const std::vector<u8> &input) {
+        return decodeData(DataEncoding::Base64, input).value_or(std::vector<u8>());
+    }
+
+    std::vector<u8> encode64(const std::vector<u8> &input) {
+        return encodeData(DataEncoding::Base64, input);
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,1220 @@
+#include "helpers/delta_patches.hpp"
+
+#include "helpers/block_hash_map.hpp"
+#include "helpers/content_chunker.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/providers/provider.hpp>
+#include <hex/providers/snapshot.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+#include <zlib.h>
+
+namespace hex {
+
+    namespace {
+
+        constexpr size_t ChunkSize = 0x10'0000;
+
+        // Target data is read back by copies, most of them don't reach further back than this
+        constexpr size_t HistorySize = 0x10'0000;
+
+        // Equal ranges inside of differing blocks that are shorter than this aren't worth an extra copy
+        constexpr size_t MinimumCopySize = 32;
+
+        constexpr size_t VCDIFFWindowSize = 0x80'0000;
+        constexpr size_t MaxVCDIFFWindowSize = 0x1000'0000;
+
+        constexpr u8 VCDIFFMagic[4] = { 0xD6, 0xC3, 0xC4, 0x00 };
+
+        // Header and window indicators of RFC 3284. Adler-32 checksums of target windows are an extension by xdelta3
+        constexpr u8 VCD_DECOMPRESS = 0x01, VCD_CODETABLE = 0x02, VCD_APPHEADER = 0x04;
+        constexpr u8 VCD_SOURCE = 0x01, VCD_TARGET = 0x02, VCD_ADLER32 = 0x04;
+
+        u32 updateCRC(u32 crc, const u8 *data, size_t size) {
+            while (size > 0) {
+                const auto part = std::min<size_t>(size, 0x4000'0000);
+                crc = ::crc32(crc, data, part);
+
+                data += part;
+                size -= part;
+            }
+
+            return crc;
+        }
+
+        std::optional<u32> calculateCRC(const prv::Snapshot &snapshot, Task &task, float progressStart, float progressEnd) {
+            std::vector<u8> buffer(ChunkSize);
+            u32 crc = ::crc32(0, nullptr, 0);
+
+            const u64 size = snapshot.getSize();
+            for (u64 offset = 0; offset < size; offset += buffer.size()) {
+                if (task.isCancelled())
+                    return { };
+
+                const size_t readSize = std::min<u64>(buffer.size(), size - offset);
+                if (!snapshot.read(offset, buffer.data(), readSize))
+                    return { };
+
+                crc = updateCRC(crc, buffer.data(), readSize);
+                task.setProgress(progressStart + (progressEnd - progressStart) * float(offset) / size);
+            }
+
+            return crc;
+        }
+
+        u32 readLE32(const u8 *data) {
+            return data[0] | (data[1] << 8) | (data[2] << 16) | (u32(data[3]) << 24);
+        }
+
+        void writeLE32(std::vector<u8> &buffer, u32 value) {
+            for (u32 i = 0; i < 4; i++)
+                buffer.push_back(value >> (i * 8));
+        }
+
+
+        // BPS and UPS numbers: 7 bits per byte, least significant first, the last byte has its top bit set. Every continuation also adds one
+        void writeBeatNumber(std::vector<u8> &buffer, u64 value) {
+            while (true) {
+                const u8 byte = value & 0x7F;
+                value >>= 7;
+
+                if (value == 0) {
+                    buffer.push_back(0x80 | byte);
+                    break;
+                }
+
+                buffer.push_back(byte);
+                value--;
+            }
+        }
+
+        std::optional<u64> readBeatNumber(const std::vector<u8> &buffer, size_t &offset, size_t end) {
+            u64 value = 0, shift = 1;
+
+            for (u32 i = 0; i < 10; i++) {
+                if (offset >= end)
+                    return { };
+
+                const u8 byte = buffer[offset++];
+                value += (byte & 0x7F) * shift;
+
+                if (byte & 0x80)
+                    return value;
+
+                shift <<= 7;
+                value += shift;
+            }
+
+            return { };
+        }
+
+        // VCDIFF numbers: 7 bits per byte, most significant first, every byte but the last has its top bit set
+        void writeVCDIFFNumber(std::vector<u8> &buffer, u64 value) {
+            std::array<u8, 10> bytes = { 0 };
+            size_t count = 0;
+
+            do {
+                bytes[count++] = value & 0x7F;
+                value >>= 7;
+            } while (value != 0);
+
+            while (count > 1)
+                buffer.push_back(0x80 | bytes[--count]);
+            buffer.push_back(bytes[0]);
+        }
+
+        std::optional<u64> readVCDIFFNumber(const std::vector<u8> &buffer, size_t &offset, size_t end) {
+            u64 value = 0;
+
+            for (u32 i = 0; i < 10; i++) {
+                if (offset >= end)
+                    return { };
+
+                const u8 byte = buffer[offset++];
+                value = (value << 7) | (byte & 0x7F);
+
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+
+            return { };
+        }
+
+
+        /*
+         * Receives the target data front to back. Bytes within the size of the source are compared against it so only the ones that differ get stored,
+         * everything past its end is kept as is. The most recently written data stays around so copies of it don't have to reassemble it.
+         */
+        class TargetWriter {
+        public:
+            TargetWriter(const prv::Snapshot &source, u64 targetSize) : m_source(source), m_sourceSize(source.getSize()) {
+                this->m_result.targetSize = targetSize;
+                this->m_sourceBuffer.resize(ChunkSize);
+            }
+
+            [[nodiscard]] u64 getPosition() const { return this->m_position; }
+            [[nodiscard]] u64 getTargetSize() const { return this->m_result.targetSize; }
+            [[nodiscard]] u32 getCRC() const { return this->m_crc; }
+
+            bool write(const u8 *data, size_t size) {
+                if (size > this->m_result.targetSize - this->m_position)
+                    return false;
+
+                this->m_crc = updateCRC(this->m_crc, data, size);
+                this->addHistory(data, size);
+
+                while (size > 0 && this->m_position < this->m_sourceSize) {
+                    const size_t part = std::min<u64>({ size, this->m_sourceBuffer.size(), this->m_sourceSize - this->m_position });
+                    if (!this->m_source.read(this->m_position, this->m_sourceBuffer.data(), part))
+                        return false;
+
+                    this->addDifferences(data, this->m_sourceBuffer.data(), part);
+
+                    this->m_position += part;
+                    data += part;
+                    size -= part;
+                }
+
+                this->m_result.appendedData.insert(this->m_result.appendedData.end(), data, data + size);
+                this->m_position += size;
+
+                return true;
+            }
+
+            // The target continues with the source's data at the same address, past its end with zeros
+            bool writeSource(u64 size) {
+                if (size > this->m_result.targetSize - this->m_position)
+                    return false;
+
+                while (size > 0 && this->m_position < this->m_sourceSize) {
+                    const size_t part = std::min<u64>({ size, this->m_sourceBuffer.size(), this->m_sourceSize - this->m_position });
+                    if (!this->m_source.read(this->m_position, this->m_sourceBuffer.data(), part))
+                        return false;
+
+                    this->m_crc = updateCRC(this->m_crc, this->m_sourceBuffer.data(), part);
+                    this->addHistory(this->m_sourceBuffer.data(), part);
+
+                    this->m_position += part;
+                    size -= part;
+                }
+
+                const std::vector<u8> zeros(std::min<u64>(size, ChunkSize), 0x00);
+                while (size > 0) {
+                    const size_t part = std::min<u64>(size, zeros.size());
+                    if (!this->write(zeros.data(), part))
+                        return false;
+
+                    size -= part;
+                }
+
+                return true;
+            }
+
+            // Reads target data that has already been written
+            bool read(u64 offset, u8 *buffer, size_t size) const {
+                if (offset > this->m_position || size > this->m_position - offset)
+                    return false;
+
+                if (offset >= this->m_historyStart) {
+                    std::memcpy(buffer, this->m_history.data() + (offset - this->m_historyStart), size);
+                    return true;
+                }
+
+                if (offset < this->m_sourceSize) {
+                    const size_t part = std::min<u64>(size, this->m_sourceSize - offset);
+                    if (!this->m_source.read(offset, buffer, part))
+                        return false;
+
+                    prv::PatchStore::apply(this->m_result.differences, offset, buffer, part);
+
+                    offset += part;
+                    buffer += part;
+                    size -= part;
+                }
+
+                if (size > 0)
+                    std::memcpy(buffer, this->m_result.appendedData.data() + (offset - this->m_sourceSize), size);
+
+                return true;
+            }
+
+            // Copies already written target data, the copy may overlap the data it produces
+            bool copy(u64 offset, u64 size) {
+                if (offset >= this->m_position)
+                    return false;
+
+                const u64 distance = this->m_position - offset;
+                std::vector<u8> buffer(std::min<u64>(size, ChunkSize));
+
+                // Overlapping copies repeat the data between their start and the current position
+                if (distance < size) {
+                    std::vector<u8> pattern(distance);
+                    if (!this->read(offset, pattern.data(), pattern.size()))
+                        return false;
+
+                    const size_t patternFits = std::max<size_t>((buffer.size() / distance) * distance, distance);
+                    buffer.resize(std::max(buffer.size(), patternFits));
+                    for (size_t i = 0; i < buffer.size(); i++)
+                        buffer[i] = pattern[i % distance];
+
+                    while (size > 0) {
+                        const size_t part = std::min<u64>(size, patternFits);
+                        if (!this->write(buffer.data(), part))
+                            return false;
+
+                        size -= part;
+                    }
+
+                    return true;
+                }
+
+                while (size > 0) {
+                    const size_t part = std::min<u64>(size, buffer.size());
+                    if (!this->read(offset, buffer.data(), part) || !this->write(buffer.data(), part))
+                        return false;
+
+                    offset += part;
+                    size -= part;
+                }
+
+                return true;
+            }
+
+            DeltaPatchResult finish() {
+                return std::move(this->m_result);
+            }
+
+        private:
+            void addHistory(const u8 *data, size_t size) {
+                this->m_history.insert(this->m_history.end(), data, data + size);
+
+                if (this->m_history.size() > HistorySize * 2) {
+                    const size_t dropped = this->m_history.size() - HistorySize;
+                    this->m_history.erase(this->m_history.begin(), this->m_history.begin() + dropped);
+                    this->m_historyStart += dropped;
+                }
+            }
+
+            void addDifferences(const u8 *data, const u8 *sourceData, size_t size) {
+                auto &differences = this->m_result.differences;
+
+                size_t i = 0;
+                while (i < size) {
+                    while (i < size && data[i] == sourceData[i])
+                        i++;
+
+                    const size_t start = i;
+                    while (i < size && data[i] != sourceData[i])
+                        i++;
+
+                    if (start == i)
+                        break;
+
+                    const u64 address = this->m_position + start;
+                    if (!differences.empty() && differences.rbegin()->first + differences.rbegin()->second.size() == address) {
+                        auto &bytes = differences.rbegin()->second.modify();
+                        bytes.insert(bytes.end(), data + start, data + i);
+                    } else {
+                        differences.emplace_hint(differences.end(), address, std::vector<u8>(data + start, data + i));
+                    }
+                }
+            }
+
+            const prv::Snapshot &m_source;
+            u64 m_sourceSize;
+            u64 m_position = 0;
+            u32 m_crc = ::crc32(0, nullptr, 0);
+
+            DeltaPatchResult m_result;
+            std::vector<u8> m_sourceBuffer;
+
+            std::vector<u8> m_history;
+            u64 m_historyStart = 0;
+        };
+
+
+        std::variant<DeltaPatchResult, std::string> applyBPS(const std::vector<u8> &patch, const prv::Snapshot &source, Task &task) {
+            if (patch.size() < 4 + 3 + 12)
+                return "The patch is too small to be a BPS patch.";
+
+            const size_t end = patch.size() - 12;
+            const u32 sourceCRC = readLE32(&patch[end + 0]);
+            const u32 targetCRC = readLE32(&patch[end + 4]);
+            const u32 patchCRC  = readLE32(&patch[end + 8]);
+
+            if (updateCRC(::crc32(0, nullptr, 0), patch.data(), patch.size() - 4) != patchCRC)
+                return "The patch is corrupted.";
+
+            size_t offset = 4;
+            auto sourceSize   = readBeatNumber(patch, offset, end);
+            auto targetSize   = readBeatNumber(patch, offset, end);
+            auto metadataSize = readBeatNumber(patch, offset, end);
+            if (!sourceSize.has_value() || !targetSize.has_value() || !metadataSize.has_value() || *metadataSize > end - offset)
+                return "The patch is corrupted.";
+
+            offset += *metadataSize;
+
+            if (*sourceSize != source.getSize())
+                return hex::format("The patch was made for a file of 0x%llX bytes, this one has 0x%llX bytes.", *sourceSize, source.getSize());
+
+            auto crc = calculateCRC(source, task, 0.0F, 0.3F);
+            if (!crc.has_value())
+                return "Reading the file failed.";
+            if (*crc != sourceCRC)
+                return "The patch was made for a different file.";
+
+            TargetWriter target(source, *targetSize);
+            std::vector<u8> buffer;
+            u64 sourceRelative = 0, targetRelative = 0;
+
+            auto readRelative = [&](u64 &relative) {
+                auto value = readBeatNumber(patch, offset, end);
+                if (!value.has_value())
+                    return false;
+
+                if (*value & 1)
+                    relative -= *value >> 1;
+                else
+                    relative += *value >> 1;
+
+                return true;
+            };
+
+            while (offset < end) {
+                if (task.isCancelled())
+                    return "Cancelled.";
+
+                auto action = readBeatNumber(patch, offset, end);
+                if (!action.has_value())
+                    return "The patch is corrupted.";
+
+                const u64 length = (*action >> 2) + 1;
+                bool succeeded = false;
+
+                switch (*action & 0b11) {
+                    case 0: // SourceRead
+                        succeeded = target.getPosition() + length <= *sourceSize && target.writeSource(length);
+                        break;
+                    case 1: // TargetRead
+                        succeeded = length <= end - offset && target.write(&patch[offset], length);
+                        offset += succeeded ? length : 0;
+                        break;
+                    case 2: // SourceCopy
+                        if (!readRelative(sourceRelative) || sourceRelative > *sourceSize || length > *sourceSize - sourceRelative)
+                            break;
+
+                        buffer.resize(std::min<u64>(length, ChunkSize));
+                        succeeded = true;
+                        for (u64 part = 0; part < length && succeeded; part += buffer.size()) {
+                            const size_t partSize = std::min<u64>(buffer.size(), length - part);
+                            succeeded = source.read(sourceRelative + part, buffer.data(), partSize) && target.write(buffer.data(), partSize);
+                        }
+
+                        sourceRelative += length;
+                        break;
+                    case 3: // TargetCopy
+                        succeeded = readRelative(targetRelative) && target.copy(targetRelative, length);
+                        targetRelative += length;
+                        break;
+                }
+
+                if (!succeeded)
+                    return "The patch is corrupted.";
+
+                task.setProgress(0.3F + 0.7F * float(target.getPosition()) / std::max<u64>(*targetSize, 1));
+            }
+
+            if (target.getPosition() != *targetSize || target.getCRC() != targetCRC)
+                return "Applying the patch didn't produce the data it was made for.";
+
+            return target.finish();
+        }
+
+        // UPS patches store the XOR of the source and the target, so they can be applied in reverse to undo them as well
+        std::variant<DeltaPatchResult, std::string> applyUPS(const std::vector<u8> &patch, const prv::Snapshot &source, Task &task) {
+            if (patch.size() < 4 + 2 + 12)
+                return "The patch is too small to be a UPS patch.";
+
+            const size_t end = patch.size() - 12;
+            u32 sourceCRC = readLE32(&patch[end + 0]);
+            u32 targetCRC = readLE32(&patch[end + 4]);
+            const u32 patchCRC = readLE32(&patch[end + 8]);
+
+            if (updateCRC(::crc32(0, nullptr, 0), patch.data(), patch.size() - 4) != patchCRC)
+                return "The patch is corrupted.";
+
+            size_t offset = 4;
+            auto sourceSize = readBeatNumber(patch, offset, end);
+            auto targetSize = readBeatNumber(patch, offset, end);
+            if (!sourceSize.has_value() || !targetSize.has_value())
+                return "The patch is corrupted.";
+
+            auto crc = calculateCRC(source, task, 0.0F, 0.3F);
+            if (!crc.has_value())
+                return "Reading the file failed.";
+
+            if (*sourceSize == source.getSize() && *crc == sourceCRC) {
+                // Applied as usual
+            } else if (*targetSize == source.getSize() && *crc == targetCRC) {
+                std::swap(*sourceSize, *targetSize);
+                std::swap(sourceCRC, targetCRC);
+            } else {
+                return "The patch was made for a different file.";
+            }
+
+            TargetWriter target(source, *targetSize);
+            std::vector<u8> buffer;
+
+            while (offset < end) {
+                if (task.isCancelled())
+                    return "Cancelled.";
+
+                auto skip = readBeatNumber(patch, offset, end);
+                if (!skip.has_value() || !target.writeSource(std::min(*skip, *targetSize - target.getPosition())))
+                    return "The patch is corrupted.";
+
+                // Every record ends with a zero, which leaves the byte it's applied to unchanged
+                const size_t recordStart = offset;
+                while (offset < end && patch[offset] != 0x00)
+                    offset++;
+                if (offset == end)
+                    return "The patch is corrupted.";
+
+                u64 recordSize = std::min<u64>(offset - recordStart, *targetSize - target.getPosition());
+                const u64 position = target.getPosition();
+                offset++;
+
+                buffer.resize(recordSize);
+                if (recordSize > 0) {
+                    const u64 sourcePart = position < source.getSize() ? std::min<u64>(recordSize, source.getSize() - position) : 0;
+                    std::fill(buffer.begin(), buffer.end(), 0x00);
+                    if (sourcePart > 0 && !source.read(position, buffer.data(), sourcePart))
+                        return "Reading the file failed.";
+
+                    for (u64 i = 0; i < recordSize; i++)
+                        buffer[i] ^= patch[recordStart + i];
+
+                    if (!target.write(buffer.data(), buffer.size()))
+                        return "The patch is corrupted.";
+                }
+
+                if (target.getPosition() < *targetSize && !target.writeSource(1))
+                    return "The patch is corrupted.";
+
+                task.setProgress(0.3F + 0.7F * float(target.getPosition()) / std::max<u64>(*targetSize, 1));
+            }
+
+            if (!target.writeSource(*targetSize - target.getPosition()) || target.getCRC() != targetCRC)
+                return "Applying the patch didn't produce the data it was made for.";
+
+            return target.finish();
+        }
+
+
+        // Instruction types and the default code table of RFC 3284, section 5.6
+        enum class VCDIFFType : u8 { NoOp, Add, Run, Copy };
+
+        struct VCDIFFInstruction {
+            VCDIFFType type;
+            u8 size;
+            u8 mode;
+        };
+
+        using VCDIFFCodeTable = std::array<std::array<VCDIFFInstruction, 2>, 256>;
+
+        constexpr u8 VCDIFFNearCacheSize = 4;
+        constexpr u8 VCDIFFSameCacheSize = 3;
+
+        // Code table entries the encoder uses, all with their size stored separately
+        constexpr u8 VCDIFFAddInstruction = 1;
+        constexpr u8 VCDIFFCopyInstruction = 19;
+
+        VCDIFFCodeTable createDefaultCodeTable() {
+            VCDIFFCodeTable table = { };
+            constexpr VCDIFFInstruction NoOp = { VCDIFFType::NoOp, 0, 0 };
+
+            size_t index = 0;
+            table[index++] = { VCDIFFInstruction { VCDIFFType::Run, 0, 0 }, NoOp };
+
+            for (u8 size = 0; size <= 17; size++)
+                table[index++] = { VCDIFFInstruction { VCDIFFType::Add, size, 0 }, NoOp };
+
+            for (u8 mode = 0; mode <= 8; mode++) {
+                table[index++] = { VCDIFFInstruction { VCDIFFType::Copy, 0, mode }, NoOp };
+                for (u8 size = 4; size <= 18; size++)
+                    table[index++] = { VCDIFFInstruction { VCDIFFType::Copy, size, mode }, NoOp };
+            }
+
+            for (u8 mode = 0; mode <= 5; mode++)
+                for (u8 addSize = 1; addSize <= 4; addSize++)
+                    for (u8 copySize = 4; copySize <= 6; copySize++)
+                        table[index++] = { VCDIFFInstruction { VCDIFFType::Add, addSize, 0 }, VCDIFFInstruction { VCDIFFType::Copy, copySize, mode } };
+
+            for (u8 mode = 6; mode <= 8; mode++)
+                for (u8 addSize = 1; addSize <= 4; addSize++)
+                    table[index++] = { VCDIFFInstruction { VCDIFFType::Add, addSize, 0 }, VCDIFFInstruction { VCDIFFType::Copy, 4, mode } };
+
+            for (u8 mode = 0; mode <= 8; mode++)
+                table[index++] = { VCDIFFInstruction { VCDIFFType::Copy, 4, mode }, VCDIFFInstruction { VCDIFFType::Add, 1, 0 } };
+
+            return table;
+        }
+
+        std::variant<DeltaPatchResult, std::string> applyVCDIFF(const std::vector<u8> &patch, const prv::Snapshot &source, Task &task) {
+            static const auto codeTable = createDefaultCodeTable();
+
+            size_t offset = sizeof(VCDIFFMagic);
+            if (offset >= patch.size())
+                return "The patch is corrupted.";
+
+            const u8 headerIndicator = patch[offset++];
+            if (headerIndicator & VCD_DECOMPRESS)
+                return "VCDIFF patches with secondary compression aren't supported.";
+            if (headerIndicator & VCD_CODETABLE)
+                return "VCDIFF patches with custom code tables aren't supported.";
+            if (headerIndicator & VCD_APPHEADER) {
+                auto size = readVCDIFFNumber(patch, offset, patch.size());
+                if (!size.has_value() || *size > patch.size() - offset)
+                    return "The patch is corrupted.";
+
+                offset += *size;
+            }
+
+            // The windows only tell their own size, the target size is only known once all of them were read
+            u64 targetSize = 0;
+            {
+                size_t windowOffset = offset;
+                while (windowOffset < patch.size()) {
+                    const u8 windowIndicator = patch[windowOffset++];
+                    if (windowIndicator & (VCD_SOURCE | VCD_TARGET)) {
+                        if (!readVCDIFFNumber(patch, windowOffset, patch.size()).has_value() || !readVCDIFFNumber(patch, windowOffset, patch.size()).has_value())
+                            return "The patch is corrupted.";
+                    }
+
+                    auto deltaSize = readVCDIFFNumber(patch, windowOffset, patch.size());
+                    if (!deltaSize.has_value() || *deltaSize > patch.size() - windowOffset)
+                        return "The patch is corrupted.";
+
+                    size_t deltaOffset = windowOffset;
+                    auto windowSize = readVCDIFFNumber(patch, deltaOffset, patch.size());
+                    if (!windowSize.has_value())
+                        return "The patch is corrupted.";
+
+                    targetSize += *windowSize;
+                    windowOffset += *deltaSize;
+                }
+            }
+
+            TargetWriter target(source, targetSize);
+            std::vector<u8> window, segmentData;
+
+            while (offset < patch.size()) {
+                if (task.isCancelled())
+                    return "Cancelled.";
+
+                const u8 windowIndicator = patch[offset++];
+                if ((windowIndicator & VCD_SOURCE) && (windowIndicator & VCD_TARGET))
+                    return "The patch is corrupted.";
+
+                u64 segmentSize = 0, segmentPosition = 0;
+                if (windowIndicator & (VCD_SOURCE | VCD_TARGET)) {
+                    segmentSize     = *readVCDIFFNumber(patch, offset, patch.size());
+                    segmentPosition = *readVCDIFFNumber(patch, offset, patch.size());
+
+                    const u64 segmentLimit = (windowIndicator & VCD_SOURCE) ? source.getSize() : target.getPosition();
+                    if (segmentPosition > segmentLimit || segmentSize > segmentLimit - segmentPosition)
+                        return "The patch is corrupted.";
+                }
+
+                const u64 deltaSize = *readVCDIFFNumber(patch, offset, patch.size());
+                const size_t deltaEnd = offset + deltaSize;
+
+                auto windowSize     = readVCDIFFNumber(patch, offset, deltaEnd);
+                if (!windowSize.has_value() || offset >= deltaEnd)
+                    return "The patch is corrupted.";
+                if (*windowSize > MaxVCDIFFWindowSize)
+                    return "The patch uses windows that are too large.";
+
+                const u8 deltaIndicator = patch[offset++];
+                if (deltaIndicator != 0x00)
+                    return "VCDIFF patches with secondary compression aren't supported.";
+
+                auto dataSize        = readVCDIFFNumber(patch, offset, deltaEnd);
+                auto instructionSize = readVCDIFFNumber(patch, offset, deltaEnd);
+                auto addressSize     = readVCDIFFNumber(patch, offset, deltaEnd);
+                if (!dataSize.has_value() || !instructionSize.has_value() || !addressSize.has_value())
+                    return "The patch is corrupted.";
+
+                std::optional<u32> checksum;
+                if (windowIndicator & VCD_ADLER32) {
+                    if (offset + 4 > deltaEnd)
+                        return "The patch is corrupted.";
+
+                    checksum = (u32(patch[offset]) << 24) | (patch[offset + 1] << 16) | (patch[offset + 2] << 8) | patch[offset + 3];
+                    offset += 4;
+                }
+
+                if (*dataSize > deltaEnd - offset || *instructionSize > deltaEnd - offset - *dataSize || *addressSize != deltaEnd - offset - *dataSize - *instructionSize)
+                    return "The patch is corrupted.";
+
+                size_t dataOffset = offset;
+                size_t instructionOffset = dataOffset + *dataSize;
+                size_t addressOffset = instructionOffset + *instructionSize;
+                const size_t dataEnd = instructionOffset, instructionEnd = addressOffset;
+
+                std::array<u64, VCDIFFNearCacheSize> nearCache = { 0 };
+                std::array<u64, VCDIFFSameCacheSize * 256> sameCache = { 0 };
+                size_t nextNearSlot = 0;
+
+                window.clear();
+                window.reserve(*windowSize);
+
+                auto decodeAddress = [&](u8 mode) -> std::optional<u64> {
+                    const u64 here = segmentSize + window.size();
+                    u64 address;
+
+                    if (mode == 0) {
+                        auto value = readVCDIFFNumber(patch, addressOffset, deltaEnd);
+                        if (!value.has_value()) return { };
+                        address = *value;
+                    } else if (mode == 1) {
+                        auto value = readVCDIFFNumber(patch, addressOffset, deltaEnd);
+                        if (!value.has_value() || *value > here) return { };
+                        address = here - *value;
+                    } else if (mode < 2 + VCDIFFNearCacheSize) {
+                        auto value = readVCDIFFNumber(patch, addressOffset, deltaEnd);
+                        if (!value.has_value()) return { };
+                        address = nearCache[mode - 2] + *value;
+                    } else {
+                        if (addressOffset >= deltaEnd) return { };
+                        address = sameCache[(mode - (2 + VCDIFFNearCacheSize)) * 256 + patch[addressOffset++]];
+                    }
+
+                    nearCache[nextNearSlot] = address;
+                    nextNearSlot = (nextNearSlot + 1) % VCDIFFNearCacheSize;
+                    sameCache[address % sameCache.size()] = address;
+
+                    if (address >= here)
+                        return { };
+
+                    return address;
+                };
+
+                while (instructionOffset < instructionEnd) {
+                    for (const auto &instruction : codeTable[patch[instructionOffset++]]) {
+                        if (instruction.type == VCDIFFType::NoOp)
+                            continue;
+
+                        u64 size = instruction.size;
+                        if (size == 0) {
+                            auto value = readVCDIFFNumber(patch, instructionOffset, instructionEnd);
+                            if (!value.has_value())
+                                return "The patch is corrupted.";
+                            size = *value;
+                        }
+
+                        if (size > *windowSize - window.size())
+                            return "The patch is corrupted.";
+
+                        switch (instruction.type) {
+                            case VCDIFFType::Add:
+                                if (size > dataEnd - dataOffset)
+                                    return "The patch is corrupted.";
+
+                                window.insert(window.end(), patch.begin() + dataOffset, patch.begin() + dataOffset + size);
+                                dataOffset += size;
+                                break;
+                            case VCDIFFType::Run:
+                                if (dataOffset >= dataEnd)
+                                    return "The patch is corrupted.";
+
+                                window.insert(window.end(), size, patch[dataOffset++]);
+                                break;
+                            case VCDIFFType::Copy: {
+                                auto address = decodeAddress(instruction.mode);
+                                if (!address.has_value())
+                                    return "The patch is corrupted.";
+
+                                // Addresses below the segment size refer to the segment, everything above to the window itself
+                                u64 position = *address;
+                                if (position < segmentSize) {
+                                    const u64 segmentPart = std::min<u64>(size, segmentSize - position);
+                                    segmentData.resize(segmentPart);
+
+                                    const bool read = (windowIndicator & VCD_SOURCE)
+                                        ? source.read(segmentPosition + position, segmentData.data(), segmentPart)
+                                        : target.read(segmentPosition + position, segmentData.data(), segmentPart);
+                                    if (!read)
+                                        return "The patch is corrupted.";
+
+                                    window.insert(window.end(), segmentData.begin(), segmentData.end());
+                                    position += segmentPart;
+                                    size -= segmentPart;
+                                }
+
+                                // May overlap the data it produces, so it's copied byte by byte
+                                for (u64 i = 0; i < size; i++)
+                                    window.push_back(window[position - segmentSize + i]);
+                                break;
+                            }
+                            default:
+                                break;
+                        }
+                    }
+                }
+
+                if (window.size() != *windowSize)
+                    return "The patch is corrupted.";
+                if (checksum.has_value() && adler32(adler32(0, nullptr, 0), window.data(), window.size()) != *checksum)
+                    return "Applying the patch didn't produce the data it was made for.";
+
+                if (!target.write(window.data(), window.size()))
+                    return "The patch is corrupted.";
+
+                offset = deltaEnd;
+                task.setProgress(float(offset) / patch.size());
+            }
+
+            return target.finish();
+        }
+
+
+        // Target ranges in the order they have to be encoded in, either copied from the source or stored in the patch
+        struct Segment {
+            u64 address;
+            u64 size;
+            std::optional<u64> sourceAddress;
+        };
+
+        std::vector<Segment> getSegments(u64 targetSize, const std::vector<DeltaCopy> &copies) {
+            std::vector<Segment> segments;
+
+            u64 position = 0;
+            for (const auto &copy : copies) {
+                if (copy.address > position)
+                    segments.push_back({ position, copy.address - position, std::nullopt });
+
+                segments.push_back({ copy.address, copy.size, copy.sourceAddress });
+                position = copy.address + copy.size;
+            }
+
+            if (position < targetSize)
+                segments.push_back({ position, targetSize - position, std::nullopt });
+
+            return segments;
+        }
+
+        std::optional<std::vector<u8>> createBPS(const prv::Snapshot &source, const prv::Snapshot &target, const std::vector<Segment> &segments, Task &task) {
+            auto sourceCRC = calculateCRC(source, task, 0.0F, 0.3F);
+            auto targetCRC = calculateCRC(target, task, 0.3F, 0.6F);
+            if (!sourceCRC.has_value() || !targetCRC.has_value())
+                return { };
+
+            std::vector<u8> result = { 'B', 'P', 'S', '1' };
+            writeBeatNumber(result, source.getSize());
+            writeBeatNumber(result, target.getSize());
+            writeBeatNumber(result, 0);
+
+            std::vector<u8> buffer;
+            u64 sourceRelative = 0;
+
+            for (const auto &segment : segments) {
+                if (task.isCancelled())
+                    return { };
+
+                if (!segment.sourceAddress.has_value()) {
+                    writeBeatNumber(result, ((segment.size - 1) << 2) | 1);
+
+                    buffer.resize(std::min<u64>(segment.size, ChunkSize));
+                    for (u64 part = 0; part < segment.size; part += buffer.size()) {
+                        const size_t partSize = std::min<u64>(buffer.size(), segment.size - part);
+                        if (!target.read(segment.address + part, buffer.data(), partSize))
+                            return { };
+
+                        result.insert(result.end(), buffer.begin(), buffer.begin() + partSize);
+                    }
+                } else if (*segment.sourceAddress == segment.address) {
+                    writeBeatNumber(result, ((segment.size - 1) << 2) | 0);
+                } else {
+                    writeBeatNumber(result, ((segment.size - 1) << 2) | 2);
+
+                    const u64 sourceAddress = *segment.sourceAddress;
+                    if (sourceAddress >= sourceRelative)
+                        writeBeatNumber(result, (sourceAddress - sourceRelative) << 1);
+                    else
+                        writeBeatNumber(result, ((sourceRelative - sourceAddress) << 1) | 1);
+
+                    sourceRelative = sourceAddress + segment.size;
+                }
+
+                task.setProgress(0.6F + 0.4F * float(segment.address) / std::max<u64>(target.getSize(), 1));
+            }
+
+            writeLE32(result, *sourceCRC);
+            writeLE32(result, *targetCRC);
+            writeLE32(result, updateCRC(::crc32(0, nullptr, 0), result.data(), result.size()));
+
+            return result;
+        }
+
+        std::optional<std::vector<u8>> createUPS(const prv::Snapshot &source, const prv::Snapshot &target, const std::vector<Segment> &segments, Task &task) {
+            auto sourceCRC = calculateCRC(source, task, 0.0F, 0.3F);
+            auto targetCRC = calculateCRC(target, task, 0.3F, 0.6F);
+            if (!sourceCRC.has_value() || !targetCRC.has_value())
+                return { };
+
+            std::vector<u8> result = { 'U', 'P', 'S', '1' };
+            writeBeatNumber(result, source.getSize());
+            writeBeatNumber(result, target.getSize());
+
+            std::vector<u8> targetBuffer(ChunkSize), sourceBuffer(ChunkSize);
+            u64 nextPosition = 0;
+            bool inRecord = false;
+
+            auto endRecord = [&] {
+                result.push_back(0x00);
+                nextPosition++;
+                inRecord = false;
+            };
+
+            // Only the XOR of both files is stored, data that's the same at the same address doesn't need to be looked at.
+            // Data past the end of the target is XORed with zeros so the patch can be applied in reverse as well
+            auto ranges = segments;
+            if (source.getSize() > target.getSize())
+                ranges.push_back({ target.getSize(), source.getSize() - target.getSize(), std::nullopt });
+
+            for (const auto &segment : ranges) {
+                if (task.isCancelled())
+                    return { };
+
+                if (segment.sourceAddress == segment.address)
+                    continue;
+
+                for (u64 part = 0; part < segment.size; part += ChunkSize) {
+                    const u64 address = segment.address + part;
+                    const size_t partSize = std::min<u64>(ChunkSize, segment.size - part);
+                    const size_t sourcePart = address < source.getSize() ? std::min<u64>(partSize, source.getSize() - address) : 0;
+                    const size_t targetPart = address < target.getSize() ? std::min<u64>(partSize, target.getSize() - address) : 0;
+
+                    std::fill(sourceBuffer.begin(), sourceBuffer.begin() + partSize, 0x00);
+                    std::fill(targetBuffer.begin(), targetBuffer.begin() + partSize, 0x00);
+                    if ((targetPart > 0 && !target.read(address, targetBuffer.data(), targetPart)) || (sourcePart > 0 && !source.read(address, sourceBuffer.data(), sourcePart)))
+                        return { };
+
+                    for (size_t i = 0; i < partSize; i++) {
+                        const u8 value = targetBuffer[i] ^ sourceBuffer[i];
+                        const u64 position = address + i;
+
+                        // Records can't continue past a gap, the terminating zero takes up the first byte after them
+                        if (inRecord && position != nextPosition)
+                            endRecord();
+
+                        if (value == 0x00) {
+                            if (inRecord)
+                                endRecord();
+                            continue;
+                        }
+
+                        if (position < nextPosition)
+                            continue;
+
+                        if (!inRecord) {
+                            writeBeatNumber(result, position - nextPosition);
+                            nextPosition = position;
+                            inRecord = true;
+                        }
+
+                        result.push_back(value);
+                        nextPosition++;
+                    }
+                }
+
+                task.setProgress(0.6F + 0.4F * float(segment.address) / std::max<u64>({ source.getSize(), target.getSize(), 1 }));
+            }
+
+            if (inRecord)
+                endRecord();
+
+            writeLE32(result, *sourceCRC);
+            writeLE32(result, *targetCRC);
+            writeLE32(result, updateCRC(::crc32(0, nullptr, 0), result.data(), result.size()));
+
+            return result;
+        }
+
+        std::optional<std::vector<u8>> createVCDIFF(const prv::Snapshot &target, const std::vector<Segment> &segments, Task &task) {
+            std::vector<u8> result(std::begin(VCDIFFMagic), std::end(VCDIFFMagic));
+            result.push_back(0x00);
+
+            std::vector<u8> windowData, data, instructions, addresses, delta;
+            auto segment = segments.begin();
+            u64 segmentOffset = 0;
+
+            for (u64 windowStart = 0; windowStart < target.getSize(); windowStart += VCDIFFWindowSize) {
+                if (task.isCancelled())
+                    return { };
+
+                const u64 windowEnd = std::min<u64>(windowStart + VCDIFFWindowSize, target.getSize());
+
+                windowData.resize(windowEnd - windowStart);
+                if (!target.read(windowStart, windowData.data(), windowData.size()))
+                    return { };
+
+                // Every window refers to the part of the source that spans all of its copies
+                struct Piece { u64 address; u64 size; std::optional<u64> sourceAddress; };
+                std::vector<Piece> pieces;
+                u64 sourceStart = std::numeric_limits<u64>::max(), sourceEnd = 0;
+
+                while (segment != segments.end() && segment->address + segmentOffset < windowEnd) {
+                    const u64 address = segment->address + segmentOffset;
+                    const u64 size = std::min<u64>(segment->size - segmentOffset, windowEnd - address);
+
+                    std::optional<u64> sourceAddress;
+                    if (segment->sourceAddress.has_value()) {
+                        sourceAddress = *segment->sourceAddress + segmentOffset;
+                        sourceStart = std::min(sourceStart, *sourceAddress);
+                        sourceEnd = std::max(sourceEnd, *sourceAddress + size);
+                    }
+
+                    pieces.push_back({ address, size, sourceAddress });
+
+                    segmentOffset += size;
+                    if (segmentOffset == segment->size) {
+                        segment++;
+                        segmentOffset = 0;
+                    }
+                }
+
+                data.clear();
+                instructions.clear();
+                addresses.clear();
+
+                for (const auto &piece : pieces) {
+                    if (piece.sourceAddress.has_value()) {
+                        instructions.push_back(VCDIFFCopyInstruction);
+                        writeVCDIFFNumber(instructions, piece.size);
+                        writeVCDIFFNumber(addresses, *piece.sourceAddress - sourceStart);
+                    } else {
+                        instructions.push_back(VCDIFFAddInstruction);
+                        writeVCDIFFNumber(instructions, piece.size);
+                        data.insert(data.end(), windowData.begin() + (piece.address - windowStart), windowData.begin() + (piece.address - windowStart + piece.size));
+                    }
+                }
+
+                const bool hasSource = sourceEnd > 0;
+                const u32 checksum = adler32(adler32(0, nullptr, 0), windowData.data(), windowData.size());
+
+                delta.clear();
+                writeVCDIFFNumber(delta, windowData.size());
+                delta.push_back(0x00);
+                writeVCDIFFNumber(delta, data.size());
+                writeVCDIFFNumber(delta, instructions.size());
+                writeVCDIFFNumber(delta, addresses.size());
+                for (u32 i = 0; i < 4; i++)
+                    delta.push_back(checksum >> ((3 - i) * 8));
+                delta.insert(delta.end(), data.begin(), data.end());
+                delta.insert(delta.end(), instructions.begin(), instructions.end());
+                delta.insert(delta.end(), addresses.begin(), addresses.end());
+
+                result.push_back((hasSource ? VCD_SOURCE : 0x00) | VCD_ADLER32);
+                if (hasSource) {
+                    writeVCDIFFNumber(result, sourceEnd - sourceStart);
+                    writeVCDIFFNumber(result, sourceStart);
+                }
+                writeVCDIFFNumber(result, delta.size());
+                result.insert(result.end(), delta.begin(), delta.end());
+
+                task.setProgress(float(windowEnd) / target.getSize());
+            }
+
+            return result;
+        }
+
+    }
+
+
+    std::optional<DeltaPatchFormat> detectDeltaPatchFormat(const std::vector<u8> &patch) {
+        if (patch.size() >= 4 && std::memcmp(patch.data(), "BPS1", 4) == 0)
+            return DeltaPatchFormat::BPS;
+        if (patch.size() >= 4 && std::memcmp(patch.data(), "UPS1", 4) == 0)
+            return DeltaPatchFormat::UPS;
+        if (patch.size() >= 4 && std::memcmp(patch.data(), VCDIFFMagic, 3) == 0 && patch[3] == VCDIFFMagic[3])
+            return DeltaPatchFormat::VCDIFF;
+
+        return { };
+    }
+
+    std::variant<DeltaPatchResult, std::string> applyDeltaPatch(const std::vector<u8> &patch, const prv::Snapshot &source, Task &task) {
+        auto format = detectDeltaPatchFormat(patch);
+        if (!format.has_value())
+            return "The file isn't a BPS, UPS or VCDIFF patch.";
+
+        switch (*format) {
+            case DeltaPatchFormat::BPS:     return applyBPS(patch, source, task);
+            case DeltaPatchFormat::UPS:     return applyUPS(patch, source, task);
+            case DeltaPatchFormat::VCDIFF:  return applyVCDIFF(patch, source, task);
+        }
+
+        return "The file isn't a BPS, UPS or VCDIFF patch.";
+    }
+
+    bool saveDeltaPatchResult(const std::string &path, const prv::Snapshot &source, const DeltaPatchResult &result, Task &task) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        std::vector<u8> buffer(ChunkSize);
+
+        const u64 sourcePart = std::min(source.getSize(), result.targetSize);
+        for (u64 offset = 0; offset < sourcePart; offset += buffer.size()) {
+            if (task.isCancelled())
+                return false;
+
+            const size_t size = std::min<u64>(buffer.size(), sourcePart - offset);
+            if (!source.read(offset, buffer.data(), size))
+                return false;
+
+            prv::PatchStore::apply(result.differences, offset, buffer.data(), size);
+            file.write(reinterpret_cast<const char*>(buffer.data()), size);
+
+            task.setProgress(float(offset) / result.targetSize);
+        }
+
+        file.write(reinterpret_cast<const char*>(result.appendedData.data()), result.appendedData.size());
+
+        return file.good();
+    }
+
+    std::optional<std::vector<u8>> createDeltaPatch(DeltaPatchFormat format, const prv::Snapshot &source, const prv::Snapshot &target, const std::vector<DeltaCopy> &copies, Task &task) {
+        const auto segments = getSegments(target.getSize(), copies);
+
+        switch (format) {
+            case DeltaPatchFormat::BPS:     return createBPS(source, target, segments, task);
+            case DeltaPatchFormat::UPS:     return createUPS(source, target, segments, task);
+            case DeltaPatchFormat::VCDIFF:  return createVCDIFF(target, segments, task);
+        }
+
+        return { };
+    }
+
+    std::optional<std::vector<DeltaCopy>> findDeltaCopies(prv::Provider *source, prv::Provider *target, Task &task) {
+        BlockHashMap sourceHashes, targetHashes;
+        if (!sourceHashes.build(source, task) || !targetHashes.build(target, task))
+            return { };
+
+        const u64 sourceSize = source->getActualSize(), targetSize = target->getActualSize();
+        const u64 commonSize = std::min(sourceSize, targetSize);
+
+        std::vector<DeltaCopy> copies;
+        std::vector<std::pair<u64, u64>> remaining;
+
+        auto addCopy = [&copies](u64 address, u64 sourceAddress, u64 size) {
+            if (size == 0)
+                return;
+
+            if (!copies.empty() && copies.back().address + copies.back().size == address && copies.back().sourceAddress + copies.back().size == sourceAddress)
+                copies.back().size += size;
+            else
+                copies.push_back({ address, sourceAddress, size });
+        };
+
+        // Blocks with the same hash are unchanged, differing ones get compared byte by byte to find the parts that actually changed
+        std::vector<u8> sourceBuffer(ChunkSize), targetBuffer(ChunkSize);
+        u64 position = 0;
+        for (auto [start, end] : BlockHashMap::getDifferingRanges(targetHashes, sourceHashes)) {
+            if (task.isCancelled())
+                return { };
+
+            start = std::min(start, commonSize);
+            const u64 commonEnd = std::min(end, commonSize);
+            addCopy(position, position, start - position);
+
+            u64 equalStart = start, differingStart = start;
+            for (u64 offset = start; offset < commonEnd; offset += ChunkSize) {
+                const size_t size = std::min<u64>(ChunkSize, commonEnd - offset);
+                source->readAbsolute(offset, sourceBuffer.data(), size);
+                target->readAbsolute(offset, targetBuffer.data(), size);
+
+                for (size_t i = 0; i < size; i++) {
+                    const u64 address = offset + i;
+                    if (sourceBuffer[i] != targetBuffer[i]) {
+                        if (address - equalStart >= MinimumCopySize) {
+                            if (equalStart > differingStart)
+                                remaining.emplace_back(differingStart, equalStart);
+                            addCopy(equalStart, equalStart, address - equalStart);
+                            differingStart = address;
+                        }
+
+                        equalStart = address + 1;
+                    }
+                }
+            }
+
+            if (commonEnd - equalStart >= MinimumCopySize) {
+                if (equalStart > differingStart)
+                    remaining.emplace_back(differingStart, equalStart);
+                addCopy(equalStart, equalStart, commonEnd - equalStart);
+            } else if (commonEnd > differingStart) {
+                remaining.emplace_back(differingStart, commonEnd);
+            }
+
+            if (end > commonSize && targetSize > commonSize)
+                remaining.emplace_back(commonSize, targetSize);
+
+            position = std::max(commonEnd, start);
+        }
+        addCopy(position, position, commonSize - position);
+
+        if (remaining.empty())
+            return copies;
+
+        // Data that's different at the same address may still exist somewhere else in the source
+        auto sourceChunks = ContentChunker::split(source, &task);
+        auto targetChunks = ContentChunker::split(target, &task);
+        if (!sourceChunks.has_value() || !targetChunks.has_value())
+            return { };
+
+        std::vector<DeltaCopy> movedCopies;
+        auto range = remaining.begin();
+        for (const auto &match : ContentChunker::match(*targetChunks, *sourceChunks)) {
+            if (task.isCancelled())
+                return { };
+
+            while (range != remaining.end() && range->second <= match.address)
+                range++;
+
+            for (auto it = range; it != remaining.end() && it->first < match.address + match.size; it++) {
+                const u64 start = std::max(it->first, match.address);
+                const u64 end   = std::min(it->second, match.address + match.size);
+                const u64 sourceAddress = match.matchAddress + (start - match.address);
+
+                if (end - start < MinimumCopySize || sourceAddress + (end - start) > sourceSize)
+                    continue;
+
+                // Chunks are only matched by their hashes
+                bool equal = true;
+                for (u64 offset = 0; offset < end - start && equal; offset += ChunkSize) {
+                    const size_t size = std::min<u64>(ChunkSize, end - start - offset);
+                    source->readAbsolute(sourceAddress + offset, sourceBuffer.data(), size);
+                    target->readAbsolute(start + offset, targetBuffer.data(), size);
+
+                    equal = std::memcmp(sourceBuffer.data(), targetBuffer.data(), size) == 0;
+                }
+
+                if (equal)
+                    movedCopies.push_back({ start, sourceAddress, end - start });
+            }
+        }
+
+        copies.insert(copies.end(), movedCopies.begin(), movedCopies.end());
+        std::sort(copies.begin(), copies.end(), [](const auto &left, const auto &right) { return left.address < right.address; });
+
+        return copies;
+    }
+
+}
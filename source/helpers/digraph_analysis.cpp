@@ -0,0 +1,108 @@
+#include "helpers/digraph_analysis.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/providers/snapshot.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+namespace hex {
+
+    namespace {
+
+        constexpr size_t SliceSize = 0x40'0000;
+
+        constexpr u32 TrigraphShift = 2;
+        static_assert((256 >> TrigraphShift) == DigraphAnalysis::TrigraphBins);
+
+    }
+
+    std::optional<DigraphAnalysis> analyzeDigraphs(const prv::Snapshot &snapshot, u64 address, u64 size, Task &task) {
+        constexpr u32 Bins = DigraphAnalysis::TrigraphBins;
+
+        DigraphAnalysis result;
+        result.digraphs.resize(256 * 256, 0);
+        result.trigraphs.resize(Bins * Bins * Bins, 0);
+
+        if (size < 2)
+            return result;
+
+        // Every byte is read exactly once, caches are better off keeping what's read interactively
+        snapshot.hintAccess(address, size, prv::AccessHint::Sequential);
+
+        const size_t sliceCount = (size + SliceSize - 1) / SliceSize;
+
+        struct ThreadState {
+            std::vector<u8> buffer;
+            std::vector<u64> digraphs, trigraphs;
+
+            // A slice never counts more than 2^32 of anything, a smaller histogram per slice fits into the cache much better
+            std::vector<u32> sliceDigraphs, sliceTrigraphs;
+        };
+
+        std::atomic<size_t> doneSlices = 0;
+        std::atomic<bool> readFailed = false;
+
+        auto states = TaskManager::parallelFor<ThreadState>(task, sliceCount, [&](size_t slice, ThreadState &state) {
+            if (readFailed)
+                return;
+
+            if (state.buffer.empty()) {
+                state.buffer.resize(SliceSize + 2);
+                state.digraphs.resize(256 * 256, 0);
+                state.trigraphs.resize(Bins * Bins * Bins, 0);
+                state.sliceDigraphs.resize(256 * 256);
+                state.sliceTrigraphs.resize(Bins * Bins * Bins);
+            }
+
+            const u64 start = slice * SliceSize;
+            const size_t readSize = std::min<u64>(SliceSize + 2, size - start);
+
+            if (!snapshot.read(address + start, state.buffer.data(), readSize)) {
+                readFailed = true;
+                return;
+            }
+
+            auto &sliceDigraphs = state.sliceDigraphs;
+            auto &sliceTrigraphs = state.sliceTrigraphs;
+            std::fill(sliceDigraphs.begin(), sliceDigraphs.end(), 0);
+            std::fill(sliceTrigraphs.begin(), sliceTrigraphs.end(), 0);
+
+            // Pairs and triples starting in this slice, the ones starting in the next slice's bytes belong to that one
+            const size_t ownSize = std::min<u64>(SliceSize, size - start);
+            const u8 *data = state.buffer.data();
+
+            const size_t tripleCount = std::min(ownSize, readSize - std::min<size_t>(readSize, 2));
+            for (size_t j = 0; j < tripleCount; j++) {
+                sliceDigraphs[(data[j] << 8) | data[j + 1]]++;
+                sliceTrigraphs[(((data[j] >> TrigraphShift) * Bins) + (data[j + 1] >> TrigraphShift)) * Bins + (data[j + 2] >> TrigraphShift)]++;
+            }
+
+            // The last pair of the region has no third byte, so it isn't part of any triple
+            if (tripleCount < ownSize && tripleCount + 1 < readSize)
+                sliceDigraphs[(data[tripleCount] << 8) | data[tripleCount + 1]]++;
+
+            for (size_t j = 0; j < state.digraphs.size(); j++)
+                state.digraphs[j] += sliceDigraphs[j];
+            for (size_t j = 0; j < state.trigraphs.size(); j++)
+                state.trigraphs[j] += sliceTrigraphs[j];
+
+            task.setProgress(float(++doneSlices) / sliceCount);
+        });
+
+        for (const auto &state : states) {
+            for (size_t j = 0; j < state.digraphs.size(); j++)
+                result.digraphs[j] += state.digraphs[j];
+            for (size_t j = 0; j < state.trigraphs.size(); j++)
+                result.trigraphs[j] += state.trigraphs[j];
+        }
+
+        snapshot.hintAccess(address, size, prv::AccessHint::DontNeed);
+
+        if (readFailed || task.isCancelled())
+            return std::nullopt;
+
+        return result;
+    }
+
+}
@@ -0,0 +1,281 @@
+#include "helpers/entropy_pyramid.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/helpers/utils.hpp>
+#include <hex/providers/provider.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace hex {
+
+    constexpr static u64 LeavesPerChunk = EntropyPyramid::ChunkSize / EntropyPyramid::LeafSize;
+
+    // count * log2(count) for every count a block up to the chunk level can contain
+    static const std::vector<double>& getCountTerms() {
+        static const auto terms = [] {
+            std::vector<double> terms(EntropyPyramid::ChunkSize + 1, 0);
+            for (size_t count = 1; count < terms.size(); count++)
+                terms[count] = count * std::log2(double(count));
+
+            return terms;
+        }();
+
+        return terms;
+    }
+
+    // Entropy in bits per byte, scaled to [0, 1]. Uses -sum(p * log2(p)) = log2(n) - sum(c * log2(c)) / n
+    static float calculateEntropy(const std::array<u64, 256> &valueCounts, u64 numBytes) {
+        if (numBytes == 0)
+            return 0;
+
+        double sum = 0;
+        if (const auto &terms = getCountTerms(); numBytes < terms.size()) {
+            for (u16 i = 0; i < 256; i++)
+                sum += terms[valueCounts[i]];
+        } else {
+            for (u16 i = 0; i < 256; i++) {
+                if (valueCounts[i] != 0)
+                    sum += valueCounts[i] * std::log2(double(valueCounts[i]));
+            }
+        }
+
+        return std::max(0.0, std::log2(double(numBytes)) - sum / numBytes) / 8;
+    }
+
+    static bool isSingleValue(const u8 *data) {
+        constexpr static u64 Broadcast = 0x0101'0101'0101'0101;
+
+        std::array<u64, EntropyPyramid::LeafSize / sizeof(u64)> words;
+        std::memcpy(words.data(), data, EntropyPyramid::LeafSize);
+
+        const u64 run = data[0] * Broadcast;
+        return std::all_of(words.begin(), words.end(), [run](u64 word) { return word == run; });
+    }
+
+    EntropyPyramid::EntropyPyramid(u64 dataSize) : m_dataSize(dataSize) {
+        for (u64 blockSize = LeafSize; ; blockSize *= LevelFactor) {
+            const size_t level = this->m_levels.size();
+            const u64 blockCount = std::max<u64>((dataSize + blockSize - 1) / blockSize, 1);
+
+            auto &newLevel = this->m_levels.emplace_back();
+            newLevel.blockSize = blockSize;
+            newLevel.entropy.resize(blockCount, 0);
+
+            if (level >= ChunkLevel)
+                newLevel.histograms.resize(blockCount, { 0 });
+
+            if (level == ClassLevel)
+                this->m_blockClasses.resize(blockCount, RegionClass::Data);
+
+            if (level >= ChunkLevel && blockCount == 1)
+                break;
+        }
+    }
+
+    size_t EntropyPyramid::getBlockByteCount(size_t level, u64 block) const {
+        const u64 blockSize = this->m_levels[level].blockSize;
+
+        return std::min<u64>(blockSize, this->m_dataSize - std::min(this->m_dataSize, block * blockSize));
+    }
+
+    size_t EntropyPyramid::getLevelForResolution(u64 size, u64 maxBlocks) const {
+        for (size_t level = 0; level < this->m_levels.size(); level++) {
+            if ((size + this->m_levels[level].blockSize - 1) / this->m_levels[level].blockSize <= maxBlocks)
+                return level;
+        }
+
+        return this->m_levels.size() - 1;
+    }
+
+    size_t EntropyPyramid::getMemoryUsage() const {
+        size_t size = 0;
+        for (const auto &level : this->m_levels)
+            size += level.entropy.size() * sizeof(float) + level.histograms.size() * sizeof(std::array<u64, 256>);
+
+        return size + this->m_blockClasses.size() * sizeof(RegionClass);
+    }
+
+    void EntropyPyramid::store(PersistentAnalysisCache::Writer &writer) const {
+        for (const auto &level : this->m_levels)
+            writer.add(level.entropy);
+        for (size_t level = ChunkLevel; level < this->m_levels.size(); level++)
+            writer.add(this->m_levels[level].histograms);
+
+        writer.add(this->m_blockClasses);
+    }
+
+    std::shared_ptr<EntropyPyramid> EntropyPyramid::load(const PersistentAnalysisCache::Entry &entry, size_t firstArray, u64 dataSize) {
+        auto pyramid = std::make_shared<EntropyPyramid>(dataSize);
+
+        const size_t levelCount = pyramid->m_levels.size();
+        if (entry.getArrayCount() != firstArray + levelCount + (levelCount - ChunkLevel) + 1)
+            return nullptr;
+
+        // The layout only depends on the data size, every array has to have exactly the size it was laid out with
+        size_t array = firstArray;
+        for (auto &level : pyramid->m_levels) {
+            auto entropy = entry.get<float>(array++);
+            if (entropy.size() != level.entropy.size())
+                return nullptr;
+
+            std::copy(entropy.begin(), entropy.end(), level.entropy.begin());
+        }
+
+        for (size_t level = ChunkLevel; level < levelCount; level++) {
+            auto &histograms = pyramid->m_levels[level].histograms;
+            auto storedHistograms = entry.get<std::array<u64, 256>>(array++);
+            if (storedHistograms.size() != histograms.size())
+                return nullptr;
+
+            std::copy(storedHistograms.begin(), storedHistograms.end(), histograms.begin());
+        }
+
+        auto blockClasses = entry.get<RegionClass>(array);
+        if (blockClasses.size() != pyramid->m_blockClasses.size())
+            return nullptr;
+
+        std::copy(blockClasses.begin(), blockClasses.end(), pyramid->m_blockClasses.begin());
+
+        return pyramid;
+    }
+
+    void EntropyPyramid::computeChunk(const u8 *data, size_t size, u64 chunk) {
+        const auto &terms = getCountTerms();
+
+        std::array<u16, 256> counts = { 0 };
+
+        // Histogram of the block that's currently being filled on every level above the leaves
+        std::array<std::array<u64, 256>, ChunkLevel> histograms = { };
+
+        const size_t leafCount = (size + LeafSize - 1) / LeafSize;
+        for (size_t leaf = 0; leaf < leafCount; leaf++) {
+            const u8 *leafData = data + leaf * LeafSize;
+            const size_t leafSize = std::min(LeafSize, size - leaf * LeafSize);
+
+            float entropy = 0;
+            if (leafSize == LeafSize && isSingleValue(leafData)) {
+                histograms[0][leafData[0]] += LeafSize;
+            } else {
+                for (size_t i = 0; i < leafSize; i++)
+                    counts[leafData[i]]++;
+
+                // Every value gets added once and its counter is cleared right away, leaving the table empty for the next leaf.
+                // Later occurrences of the same value add a count of zero, which is cheaper than branching on it
+                double sum = 0;
+                for (size_t i = 0; i < leafSize; i++) {
+                    const u8 value = leafData[i];
+                    const u16 count = counts[value];
+
+                    sum += terms[count];
+                    histograms[0][value] += count;
+                    counts[value] = 0;
+                }
+
+                entropy = (std::log2(double(leafSize)) - sum / leafSize) / 8;
+            }
+
+            this->m_levels[0].entropy[chunk * LeavesPerChunk + leaf] = entropy;
+
+            // Blocks are completed once their last leaf is done, the final leaf of the data completes all blocks containing it
+            const bool lastLeaf = leaf + 1 == leafCount;
+            for (size_t level = 1; level <= ChunkLevel; level++) {
+                const u64 leavesPerBlock = this->m_levels[level].blockSize / LeafSize;
+                if ((leaf + 1) % leavesPerBlock != 0 && !lastLeaf)
+                    break;
+
+                const u64 block = chunk * (LeavesPerChunk / leavesPerBlock) + leaf / leavesPerBlock;
+                auto &histogram = histograms[level - 1];
+
+                const size_t blockByteCount = this->getBlockByteCount(level, block);
+                this->m_levels[level].entropy[block] = calculateEntropy(histogram, blockByteCount);
+
+                if (level == ClassLevel)
+                    this->m_blockClasses[block] = classifyBlock(histogram, blockByteCount, this->m_levels[level].entropy[block]);
+                else if (level == ChunkLevel)
+                    this->refineBlockClasses(block, histogram, blockByteCount);
+
+                if (level < ChunkLevel) {
+                    for (u16 value = 0; value < 256; value++)
+                        histograms[level][value] += histogram[value];
+                } else {
+                    this->m_levels[level].histograms[block] = histogram;
+                }
+
+                histogram.fill(0);
+            }
+        }
+    }
+
+    // Compressed data often looks just as uniform as encrypted data in blocks of the class level. Chunks made up of nothing
+    // but high entropy blocks get tested again as a whole, which tells the two apart far more reliably
+    void EntropyPyramid::refineBlockClasses(u64 chunk, const std::array<u64, 256> &valueCounts, size_t numBytes) {
+        const u64 blocksPerChunk = ChunkSize / this->m_levels[ClassLevel].blockSize;
+        const auto first = this->m_blockClasses.begin() + chunk * blocksPerChunk;
+        const auto last  = this->m_blockClasses.begin() + std::min<u64>((chunk + 1) * blocksPerChunk, this->m_blockClasses.size());
+
+        const bool highEntropy = std::all_of(first, last, [](RegionClass type) { return type == RegionClass::Compressed || type == RegionClass::Encrypted; });
+        if (highEntropy)
+            std::fill(first, last, isUniformlyDistributed(valueCounts, numBytes) ? RegionClass::Encrypted : RegionClass::Compressed);
+    }
+
+    void EntropyPyramid::buildChunks(prv::Provider *provider, u64 firstChunk, u64 lastChunk, Task *task) {
+        // Every chunk is read exactly once, caches are better off keeping what's read interactively
+        const u64 start = firstChunk * ChunkSize;
+        const u64 end = std::min<u64>(lastChunk * ChunkSize, this->m_dataSize);
+        provider->hintAccess(start, end - start, prv::AccessHint::Sequential);
+        SCOPE_EXIT( provider->hintAccess(start, end - start, prv::AccessHint::DontNeed); );
+
+        auto chunks = provider->getChunks(start, end - start, ChunkSize);
+        for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+            const u64 chunk = it.getOffset() / ChunkSize;
+
+            if (task != nullptr) {
+                if (task->isCancelled())
+                    return;
+
+                task->setProgress(float(chunk - firstChunk) / (lastChunk - firstChunk));
+            }
+
+            this->computeChunk((*it).data(), (*it).size(), chunk);
+        }
+    }
+
+    void EntropyPyramid::aggregate(u64 firstChunk, u64 lastChunk) {
+        u64 first = firstChunk, last = lastChunk;
+
+        for (size_t level = ChunkLevel + 1; level < this->m_levels.size() && first < last; level++) {
+            const auto &children = this->m_levels[level - 1];
+            auto &parents = this->m_levels[level];
+
+            first = first / LevelFactor;
+            last  = (last - 1) / LevelFactor + 1;
+
+            for (u64 block = first; block < last; block++) {
+                auto &histogram = parents.histograms[block];
+                histogram.fill(0);
+
+                const u64 lastChild = std::min<u64>((block + 1) * LevelFactor, children.histograms.size());
+                for (u64 child = block * LevelFactor; child < lastChild; child++) {
+                    for (u16 value = 0; value < 256; value++)
+                        histogram[value] += children.histograms[child][value];
+                }
+
+                parents.entropy[block] = calculateEntropy(histogram, this->getBlockByteCount(level, block));
+            }
+        }
+    }
+
+    void EntropyPyramid::update(prv::Provider *provider, u64 address, size_t size) {
+        if (size == 0 || address >= this->m_dataSize)
+            return;
+
+        const u64 firstChunk = address / ChunkSize;
+        const u64 lastChunk  = std::min<u64>((address + size - 1) / ChunkSize + 1, this->getChunkCount());
+
+        this->buildChunks(provider, firstChunk, lastChunk);
+        this->aggregate(firstChunk, lastChunk);
+    }
+
+}
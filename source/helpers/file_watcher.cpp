@@ -0,0 +1,190 @@
+#include "helpers/file_watcher.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/providers/snapshot.hpp>
+
+#include "helpers/crypto.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+
+#include <sys/stat.h>
+
+#if defined(OS_LINUX)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace hex {
+
+    namespace {
+
+        constexpr size_t BlocksPerSlice = 0x40;
+
+    }
+
+    FileWatcher::FileWatcher(std::string path) : m_path(std::move(path)) {
+        (void)this->updateStats();
+
+        #if defined(OS_LINUX)
+        this->m_notifications = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        #endif
+
+        this->rewatch();
+    }
+
+    FileWatcher::~FileWatcher() {
+        #if defined(OS_LINUX)
+        if (this->m_notifications != -1)
+            close(this->m_notifications);
+        #elif defined(OS_WINDOWS)
+        if (this->m_notifications != INVALID_HANDLE_VALUE)
+            FindCloseChangeNotification(this->m_notifications);
+        #endif
+    }
+
+    void FileWatcher::rewatch() {
+        #if defined(OS_LINUX)
+        if (this->m_notifications == -1)
+            return;
+
+        if (this->m_watch != -1)
+            inotify_rm_watch(this->m_notifications, this->m_watch);
+
+        // Replacing the file shows up as a change of the old file's link count
+        this->m_watch = inotify_add_watch(this->m_notifications, this->m_path.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+        #elif defined(OS_WINDOWS)
+        if (this->m_notifications != INVALID_HANDLE_VALUE)
+            return;
+
+        // Only directories can be watched, every change of any file in it wakes the watcher up
+        auto directory = std::filesystem::u8path(this->m_path).parent_path().wstring();
+        this->m_notifications = FindFirstChangeNotificationW(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+        #endif
+
+        (void)this->updateStats();
+    }
+
+    bool FileWatcher::updateStats() {
+        struct stat stats = { 0 };
+        if (stat(this->m_path.c_str(), &stats) != 0)
+            return false;
+
+        const bool changed = u64(stats.st_size) != this->m_size || s64(stats.st_mtime) != this->m_modificationTime;
+        this->m_size = stats.st_size;
+        this->m_modificationTime = stats.st_mtime;
+
+        return changed;
+    }
+
+    bool FileWatcher::poll() {
+        #if defined(OS_LINUX)
+        if (this->m_notifications == -1 || this->m_watch == -1)
+            return this->updateStats();
+
+        bool changed = false;
+
+        alignas(inotify_event) char buffer[0x1000];
+        while (true) {
+            auto result = read(this->m_notifications, buffer, sizeof(buffer));
+            if (result <= 0)
+                break;
+
+            changed = true;
+        }
+
+        // Stats still get updated so a change that's ignored later doesn't show up again through them
+        (void)this->updateStats();
+
+        return changed;
+        #elif defined(OS_WINDOWS)
+        if (this->m_notifications == INVALID_HANDLE_VALUE)
+            return this->updateStats();
+
+        if (WaitForSingleObject(this->m_notifications, 0) != WAIT_OBJECT_0)
+            return false;
+
+        FindNextChangeNotification(this->m_notifications);
+
+        return this->updateStats();
+        #else
+        return this->updateStats();
+        #endif
+    }
+
+    void FileWatcher::ignoreChanges() {
+        (void)this->poll();
+    }
+
+    std::optional<FileBlockHashes> FileBlockHashes::compute(const prv::Snapshot &snapshot, Task &task) {
+        FileBlockHashes result(snapshot.getSize());
+
+        const size_t blockCount = result.hashes.size();
+        const size_t sliceCount = (blockCount + BlocksPerSlice - 1) / BlocksPerSlice;
+
+        std::atomic<size_t> doneSlices = 0;
+        std::atomic<bool> readFailed = false;
+
+        snapshot.hintAccess(0, result.dataSize, prv::AccessHint::Sequential);
+
+        TaskManager::parallelFor<std::vector<u8>>(task, sliceCount, [&](size_t slice, std::vector<u8> &buffer) {
+            if (readFailed)
+                return;
+
+            buffer.resize(BlockSize * BlocksPerSlice);
+
+            const u64 start = slice * BlocksPerSlice * BlockSize;
+            const size_t readSize = std::min<u64>(buffer.size(), result.dataSize - start);
+
+            if (!snapshot.read(start, buffer.data(), readSize)) {
+                readFailed = true;
+                return;
+            }
+
+            // Every thread only ever writes the hashes of its own slices
+            result.hashChunk(start, buffer.data(), readSize);
+
+            task.setProgress(float(++doneSlices) / sliceCount);
+        });
+
+        snapshot.hintAccess(0, result.dataSize, prv::AccessHint::DontNeed);
+
+        if (task.isCancelled() || readFailed)
+            return std::nullopt;
+
+        return result;
+    }
+
+    void FileBlockHashes::hashChunk(u64 offset, const u8 *data, size_t size) {
+        for (size_t position = 0; position < size; position += BlockSize)
+            this->hashes[(offset + position) / BlockSize] = crypt::xxh64(data + position, std::min<size_t>(BlockSize, size - position));
+    }
+
+    std::vector<Region> FileBlockHashes::getChangedRanges(const FileBlockHashes &after) const {
+        std::vector<Region> ranges;
+
+        auto addRange = [&ranges](u64 address, u64 size) {
+            if (size == 0)
+                return;
+
+            if (!ranges.empty() && ranges.back().address + ranges.back().size == address)
+                ranges.back().size += size;
+            else
+                ranges.push_back({ address, size });
+        };
+
+        const size_t commonBlocks = std::min(this->hashes.size(), after.hashes.size());
+        for (size_t block = 0; block < commonBlocks; block++) {
+            if (this->hashes[block] != after.hashes[block])
+                addRange(block * BlockSize, std::min<u64>(BlockSize, after.dataSize - block * BlockSize));
+        }
+
+        // A block that was only partially filled before got hashed over more data now and changed above, the rest is appended data
+        const u64 commonSize = std::min<u64>(commonBlocks * BlockSize, after.dataSize);
+        addRange(commonSize, after.dataSize - commonSize);
+
+        return ranges;
+    }
+
+}
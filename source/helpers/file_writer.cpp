@@ -0,0 +1,205 @@
+#include "helpers/file_writer.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/helpers/utils.hpp>
+#include <hex/providers/provider.hpp>
+#include "providers/file_provider.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#if defined(OS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#endif
+
+namespace hex {
+
+    constexpr static size_t ChunkSize = 0x100'0000;
+
+    #if defined(OS_LINUX)
+
+    using OutputFile = int;
+
+    static OutputFile openOutputFile(const std::string &path) {
+        return open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+    static bool isValid(OutputFile file) {
+        return file != -1;
+    }
+
+    static void closeOutputFile(OutputFile file) {
+        close(file);
+    }
+
+    static bool writeToFile(OutputFile file, const u8 *data, size_t size) {
+        for (size_t written = 0; written < size; ) {
+            auto result = write(file, data + written, size - written);
+            if (result <= 0)
+                return false;
+
+            written += result;
+        }
+
+        return true;
+    }
+
+    // Lets the kernel copy an unmodified span without it passing through user space. Returns the number of bytes copied
+    static u64 copyFileRange(int source, OutputFile file, u64 offset, u64 size, Task &task, u64 written, u64 dataSize) {
+        loff_t sourceOffset = offset;
+        u64 copied = 0;
+
+        while (copied < size) {
+            auto result = copy_file_range(source, &sourceOffset, file, nullptr, std::min<u64>(size - copied, ChunkSize), 0);
+            if (result <= 0)
+                break;
+
+            copied += result;
+            task.setProgress(float(written + copied) / dataSize);
+
+            if (task.isCancelled())
+                return copied;
+        }
+
+        // Older kernels refuse to copy between different file systems, sendfile handles that as well
+        while (copied < size) {
+            off_t sendOffset = offset + copied;
+            auto result = sendfile(file, source, &sendOffset, std::min<u64>(size - copied, ChunkSize));
+            if (result <= 0)
+                break;
+
+            copied += result;
+            task.setProgress(float(written + copied) / dataSize);
+
+            if (task.isCancelled())
+                return copied;
+        }
+
+        return copied;
+    }
+
+    #else
+
+    using OutputFile = FILE*;
+
+    static OutputFile openOutputFile(const std::string &path) {
+        return fopen(path.c_str(), "wb");
+    }
+
+    static bool isValid(OutputFile file) {
+        return file != nullptr;
+    }
+
+    static void closeOutputFile(OutputFile file) {
+        fclose(file);
+    }
+
+    static bool writeToFile(OutputFile file, const u8 *data, size_t size) {
+        return fwrite(data, 1, size, file) == size;
+    }
+
+    #endif
+
+    bool writePatchedFile(prv::Provider *provider, const prv::PatchStore::Runs &patches, const prv::PieceTable::Pieces *pieces, const std::string &path, Task &task) {
+        u64 dataSize = provider->getRawSize();
+        if (pieces != nullptr)
+            dataSize = pieces->empty() ? 0 : pieces->back().address + pieces->back().size;
+
+        auto file = openOutputFile(path);
+        if (!isValid(file))
+            return false;
+
+        SCOPE_EXIT(closeOutputFile(file););
+
+        #if defined(OS_LINUX)
+        int source = -1;
+        if (auto fileProvider = dynamic_cast<prv::FileProvider*>(provider); fileProvider != nullptr)
+            source = open(fileProvider->getPath().c_str(), O_RDONLY);
+
+        SCOPE_EXIT(if (source != -1) close(source););
+        #endif
+
+        std::vector<u8> buffer;
+        u64 written = 0;
+
+        auto writeData = [&](const u8 *data, u64 size) -> bool {
+            if (!writeToFile(file, data, size))
+                return false;
+
+            written += size;
+            task.setProgress(float(written) / dataSize);
+
+            return true;
+        };
+
+        // Copies size bytes of unpatched raw data starting at offset to the output file
+        auto copyUnmodified = [&](u64 offset, u64 size) -> bool {
+            const u64 end = offset + size;
+
+            #if defined(OS_LINUX)
+            if (source != -1) {
+                const u64 copied = copyFileRange(source, file, offset, size, task, written, dataSize);
+                offset += copied;
+                written += copied;
+            }
+            #endif
+
+            while (offset < end) {
+                if (task.isCancelled())
+                    return false;
+
+                // Keep chunks aligned to the chunk size so reads of the source line up with its pages and mapping windows
+                const u64 chunkSize = std::min<u64>(end - offset, ChunkSize - (offset % ChunkSize));
+
+                buffer.resize(chunkSize);
+                provider->readRaw(offset, buffer.data(), chunkSize);
+                if (!writeData(buffer.data(), chunkSize))
+                    return false;
+
+                offset += chunkSize;
+            }
+
+            return true;
+        };
+
+        // Copies size bytes of raw data starting at offset with the patches in that range applied
+        auto copyPatched = [&](u64 offset, u64 size) -> bool {
+            const u64 end = offset + size;
+
+            auto run = patches.upper_bound(offset);
+            if (run != patches.begin() && std::prev(run)->first + std::prev(run)->second.size() > offset)
+                run--;
+
+            for (; run != patches.end() && run->first < end; run++) {
+                const auto &[address, data] = *run;
+                const u64 from = std::max(address, offset);
+                const u64 to   = std::min(address + data.size(), end);
+
+                if (!copyUnmodified(offset, from - offset) || !writeData(data.data() + (from - address), to - from))
+                    return false;
+
+                offset = to;
+            }
+
+            return copyUnmodified(offset, end - offset);
+        };
+
+        if (pieces == nullptr)
+            return copyPatched(0, dataSize);
+
+        // Every unchanged span of the original data gets copied exactly once, no matter how far inserting or removing bytes moved it
+        for (const auto &piece : *pieces) {
+            if (task.isCancelled())
+                return false;
+
+            const bool succeeded = piece.isOriginal() ? copyPatched(piece.source, piece.size) : writeData(piece.inserted->data() + piece.source, piece.size);
+            if (!succeeded)
+                return false;
+        }
+
+        return true;
+    }
+
+}
@@ -0,0 +1,239 @@
+#include "helpers/headless.hpp"
+
+#include "helpers/pattern_exporter.hpp"
+#include "helpers/plugin_handler.hpp"
+#include "providers/file_provider.hpp"
+
+#include <hex/helpers/shared_data.hpp>
+#include <hex/helpers/memory_arena.hpp>
+#include <hex/lang/pattern_language.hpp>
+#include <hex/lang/pattern_data.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace hex {
+
+    struct HeadlessOptions {
+        std::string patternPath;
+        PatternExporter::Format format = PatternExporter::Format::JSON;
+        std::string outputFolder;
+        u32 threadCount = 0;
+        std::vector<std::string> files;
+    };
+
+    static void printUsage(const char *executable) {
+        std::fprintf(stderr, "Usage: %s --headless --pattern <file> [--format json|csv] [--output <folder>] [--threads <count>] <files...>\n", executable);
+    }
+
+    static std::optional<HeadlessOptions> parseArguments(int argc, char **argv) {
+        HeadlessOptions options;
+
+        for (int i = 2; i < argc; i++) {
+            std::string_view argument = argv[i];
+
+            auto getValue = [&]() -> const char* {
+                return i + 1 < argc ? argv[++i] : nullptr;
+            };
+
+            if (argument == "--pattern") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                options.patternPath = value;
+            } else if (argument == "--format") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                if (std::string_view(value) == "json")
+                    options.format = PatternExporter::Format::JSON;
+                else if (std::string_view(value) == "csv")
+                    options.format = PatternExporter::Format::CSV;
+                else
+                    return { };
+            } else if (argument == "--output") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                options.outputFolder = value;
+            } else if (argument == "--threads") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                char *end = nullptr;
+                options.threadCount = std::strtoul(value, &end, 10);
+                if (*end != '\0')
+                    return { };
+            } else if (argument.starts_with("--"))
+                return { };
+            else
+                options.files.emplace_back(argument);
+        }
+
+        if (options.patternPath.empty() || options.files.empty())
+            return { };
+
+        return options;
+    }
+
+    static std::optional<std::string> readFile(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return { };
+
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    static void loadPlugins() {
+        try {
+            auto pluginFolderPath = std::filesystem::path(SharedData::mainArgv[0]).parent_path() / "plugins";
+            PluginHandler::load(pluginFolderPath.string());
+        } catch (std::runtime_error &e) {
+            std::fprintf(stderr, "warning: %s, built-in functions won't be available\n", e.what());
+            return;
+        }
+
+        for (const auto &plugin : PluginHandler::getPlugins())
+            plugin.initializePlugin();
+    }
+
+    int runHeadless(int argc, char **argv) {
+        SharedData::mainArgc = argc;
+        SharedData::mainArgv = argv;
+
+        auto options = parseArguments(argc, argv);
+        if (!options.has_value()) {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        auto code = readFile(options->patternPath);
+        if (!code.has_value()) {
+            std::fprintf(stderr, "error: failed to read pattern file '%s'\n", options->patternPath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        if (!options->outputFolder.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(options->outputFolder, error);
+            if (error) {
+                std::fprintf(stderr, "error: failed to create output folder '%s'\n", options->outputFolder.c_str());
+                return EXIT_FAILURE;
+            }
+        }
+
+        // Builtin functions get registered by the plugins, they have to be loaded before any runtime is created
+        loadPlugins();
+
+        // The pattern is only compiled once, evaluating it doesn't modify it so all threads can share it
+        std::shared_ptr<const lang::CompiledPattern> compiledPattern;
+        {
+            lang::PatternLanguage runtime;
+            compiledPattern = runtime.compile(*code);
+
+            if (compiledPattern == nullptr) {
+                auto &[line, message] = *runtime.getError();
+                std::fprintf(stderr, "%s:%u: error: %s\n", options->patternPath.c_str(), line, message.c_str());
+                return EXIT_FAILURE;
+            }
+        }
+
+        std::mutex outputMutex;
+        std::atomic<size_t> nextFile = 0;
+        std::atomic<bool> failed = false;
+        bool csvHeaderWritten = false;
+
+        auto processFile = [&](lang::PatternLanguage &runtime, const std::string &path) {
+            auto reportError = [&](const std::string &message) {
+                std::scoped_lock lock(outputMutex);
+                std::fprintf(stderr, "%s: error: %s\n", path.c_str(), message.c_str());
+                failed = true;
+            };
+
+            prv::FileProvider provider(path);
+            if (!provider.isAvailable() || !provider.isReadable()) {
+                reportError("failed to open file");
+                return;
+            }
+
+            // All patterns of this file get allocated in the arena and freed together with it
+            MemoryArena arena;
+            MemoryArena::Scope arenaScope(arena);
+
+            auto patterns = runtime.execute(&provider, compiledPattern);
+
+            for (auto &[level, message] : runtime.getConsoleLog()) {
+                if (level < lang::LogConsole::Level::Warning)
+                    continue;
+
+                std::scoped_lock lock(outputMutex);
+                std::fprintf(stderr, "%s: %s: %s\n", path.c_str(), level == lang::LogConsole::Level::Error ? "error" : "warning", message.c_str());
+            }
+
+            if (!patterns.has_value()) {
+                failed = true;
+                return;
+            }
+
+            if (options->outputFolder.empty()) {
+                // The output is streamed, so other workers have to wait until the whole file is written
+                std::scoped_lock lock(outputMutex);
+
+                if (options->format == PatternExporter::Format::JSON) {
+                    std::cout << "{\"file\":" << nlohmann::json(path).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << ",\"patterns\":";
+                    PatternExporter::writeJson(std::cout, &provider, *patterns);
+                    std::cout << "}\n";
+                } else {
+                    // All files share one table, so every row gets prefixed with its file and the header is only written once
+                    PatternExporter::writeCsv(std::cout, &provider, *patterns, !csvHeaderWritten, path);
+                    csvHeaderWritten = true;
+                }
+
+                std::cout.flush();
+            } else {
+                auto extension = options->format == PatternExporter::Format::JSON ? ".json" : ".csv";
+                auto outputPath = std::filesystem::path(options->outputFolder) / (std::filesystem::path(path).filename().string() + extension);
+
+                if (!PatternExporter::exportToFile(outputPath.string(), options->format, &provider, *patterns))
+                    reportError("failed to write " + outputPath.string());
+            }
+
+            for (auto &pattern : *patterns)
+                delete pattern;
+        };
+
+        const u32 threadCount = std::clamp<u32>(options->threadCount != 0 ? options->threadCount : std::thread::hardware_concurrency(), 1, options->files.size());
+
+        std::vector<std::thread> workers;
+        for (u32 i = 0; i < threadCount; i++) {
+            workers.emplace_back([&] {
+                // Evaluators aren't thread safe, every worker evaluates its files with a runtime of its own
+                lang::PatternLanguage runtime;
+
+                for (size_t file = nextFile++; file < options->files.size(); file = nextFile++)
+                    processFile(runtime, options->files[file]);
+            });
+        }
+
+        for (auto &worker : workers)
+            worker.join();
+
+        PluginHandler::unload();
+
+        return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+}
@@ -0,0 +1,92 @@
+#include "helpers/lang_hash_functions.hpp"
+
+#include "helpers/crypto.hpp"
+
+#include <hex/api/content_registry.hpp>
+#include <hex/lang/ast_node.hpp>
+#include <hex/lang/evaluator.hpp>
+#include <hex/providers/provider.hpp>
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+namespace hex {
+
+    using namespace hex::lang;
+
+    namespace {
+
+        u64 getValue(Evaluator &ctx, ASTNode *param) {
+            return std::visit([](auto &&value) { return u64(value); }, ctx.asType<ASTNodeIntegerLiteral>(param)->getValue());
+        }
+
+        // Returns the address and size of the hashed region, making sure it lies within the data
+        std::pair<u64, size_t> getRegion(Evaluator &ctx, std::span<ASTNode*> params) {
+            const u64 address = getValue(ctx, params[0]);
+            const u64 size = getValue(ctx, params[1]);
+            const u64 dataSize = ctx.getProvider()->getActualSize();
+
+            if (address > dataSize || size > dataSize - address)
+                ctx.getConsole().abortEvaluation("region out of range");
+
+            return { address, size };
+        }
+
+        template<size_t Size>
+        bool digestMatches(Evaluator &ctx, const std::array<u8, Size> &digest, std::span<ASTNode*> expected) {
+            if (expected.size() != Size)
+                ctx.getConsole().abortEvaluation(hex::format("expected a digest of %d bytes", int(Size)));
+
+            return std::equal(digest.begin(), digest.end(), expected.begin(), [&](u8 byte, ASTNode *param) {
+                const u64 value = getValue(ctx, param);
+                if (value > 0xFF)
+                    ctx.getConsole().abortEvaluation("digest bytes need to fit into 1 byte");
+
+                return byte == value;
+            });
+        }
+
+        ASTNode* makeBoolean(bool value) {
+            return new ASTNodeIntegerLiteral({ Token::ValueType::Boolean, s32(value) });
+        }
+
+    }
+
+    void registerHashPatternLanguageFunctions() {
+        using Functions = ContentRegistry::PatternLanguageFunctions;
+
+        /* crc32(address, size) */
+        Functions::add("crc32", 2, [](auto &ctx, auto params) -> ASTNode* {
+            auto [address, size] = getRegion(ctx, params);
+            auto provider = ctx.getProvider();
+
+            return new ASTNodeIntegerLiteral({ Token::ValueType::Unsigned32Bit, crypt::crc32(provider, address, size, 0xEDB8'8320, 0xFFFF'FFFF) });
+        });
+
+        /* md5(address, size, byte...) */
+        Functions::add("md5", Functions::MoreParametersThan | 2, [](auto &ctx, auto params) -> ASTNode* {
+            auto [address, size] = getRegion(ctx, params);
+            auto provider = ctx.getProvider();
+
+            return makeBoolean(digestMatches(ctx, crypt::md5(provider, address, size), params.subspan(2)));
+        });
+
+        /* sha1(address, size, byte...) */
+        Functions::add("sha1", Functions::MoreParametersThan | 2, [](auto &ctx, auto params) -> ASTNode* {
+            auto [address, size] = getRegion(ctx, params);
+            auto provider = ctx.getProvider();
+
+            return makeBoolean(digestMatches(ctx, crypt::sha1(provider, address, size), params.subspan(2)));
+        });
+
+        /* sha256(address, size, byte...) */
+        Functions::add("sha256", Functions::MoreParametersThan | 2, [](auto &ctx, auto params) -> ASTNode* {
+            auto [address, size] = getRegion(ctx, params);
+            auto provider = ctx.getProvider();
+
+            return makeBoolean(digestMatches(ctx, crypt::sha256(provider, address, size), params.subspan(2)));
+        });
+    }
+
+}
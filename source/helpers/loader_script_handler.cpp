@@ -1,45 +1,184 @@
 #include "helpers/loader_script_handler.hpp"
 
+#include <hex/api/content_registry.hpp>
+#include <hex/api/imhex_api.hpp>
+#include <hex/api/task.hpp>
 #include <hex/views/view.hpp>
 #include <hex/helpers/utils.hpp>
+#include <hex/providers/patch_store.hpp>
 #include <hex/providers/provider.hpp>
+#include <hex/providers/snapshot.hpp>
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include <structmember.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <filesystem>
+#include <thread>
+#include <vector>
 
 using namespace std::literals::string_literals;
 
 namespace hex {
 
+    // Everything a script reads and everything it adds. Only the worker running the script touches it until the script is done
+    struct LoaderScript::Run {
+        std::string filePath;
+        prv::Provider *provider = nullptr;
+        Task *task = nullptr;
+
+        prv::Snapshot snapshot;
+        // Captured on the main thread, nullptr if the data isn't mapped or was already patched
+        const u8 *residentData = nullptr;
+
+        prv::PatchStore patches;
+        std::vector<ImHexApi::Bookmarks::Entry> bookmarks;
+        std::vector<std::string> patternCode;
+
+        std::vector<PyObject*> dataViews;
+    };
+
+    bool LoaderScript::checkCancelled() {
+        if (!LoaderScript::s_run->task->isCancelled())
+            return true;
+
+        PyErr_SetString(PyExc_KeyboardInterrupt, "loader script cancelled");
+        return false;
+    }
+
     PyObject* LoaderScript::Py_getFilePath(PyObject *self, PyObject *args) {
-        return PyUnicode_FromString(LoaderScript::s_filePath.c_str());
+        return PyUnicode_FromString(LoaderScript::s_run->filePath.c_str());
     }
 
-    PyObject* LoaderScript::Py_addPatch(PyObject *self, PyObject *args) {
+    PyObject* LoaderScript::Py_getData(PyObject *self, PyObject *args) {
+        if (!LoaderScript::checkCancelled())
+            return nullptr;
+
+        auto &run = *LoaderScript::s_run;
+
+        // Mapped files are handed out without copying them. The view gets released once the script is done since the provider may go away
+        if (run.residentData != nullptr) {
+            auto view = PyMemoryView_FromMemory(reinterpret_cast<char*>(const_cast<u8*>(run.residentData)), run.snapshot.getSize(), PyBUF_READ);
+            if (view == nullptr)
+                return nullptr;
+
+            Py_INCREF(view);
+            run.dataViews.push_back(view);
+
+            return view;
+        }
+
+        const auto data = run.snapshot.withoutEdits();
+
+        auto bytes = PyBytes_FromStringAndSize(nullptr, data.getSize());
+        if (bytes == nullptr)
+            return nullptr;
+
+        if (!data.read(0x00, PyBytes_AS_STRING(bytes), data.getSize())) {
+            Py_DECREF(bytes);
+            PyErr_SetString(PyExc_RuntimeError, "data changed while the script was running");
+            return nullptr;
+        }
+
+        return bytes;
+    }
+
+    PyObject* LoaderScript::Py_read(PyObject *self, PyObject *args) {
         u64 address;
-        u8 *patches;
-        Py_ssize_t count;
+        Py_ssize_t size;
 
-        if (!PyArg_ParseTuple(args, "K|y#", &address, &patches, &count)) {
-            PyErr_BadArgument();
+        if (!PyArg_ParseTuple(args, "Kn", &address, &size) || !LoaderScript::checkCancelled())
+            return nullptr;
+
+        auto &run = *LoaderScript::s_run;
+
+        if (size < 0 || address > run.snapshot.getSize() || u64(size) > run.snapshot.getSize() - address) {
+            PyErr_SetString(PyExc_IndexError, "address out of range");
             return nullptr;
         }
 
-        if (patches == nullptr || count == 0) {
-            PyErr_SetString(PyExc_TypeError, "Invalid patch provided");
+        auto bytes = PyBytes_FromStringAndSize(nullptr, size);
+        if (bytes == nullptr)
             return nullptr;
+
+        if (!run.snapshot.read(address, PyBytes_AS_STRING(bytes), size)) {
+            Py_DECREF(bytes);
+            PyErr_SetString(PyExc_RuntimeError, "data changed while the script was running");
+            return nullptr;
+        }
+
+        // Patches of the script itself aren't part of the snapshot yet
+        prv::PatchStore::apply(run.patches.getRuns(), address, PyBytes_AS_STRING(bytes), size);
+
+        return bytes;
+    }
+
+    static bool writePatch(prv::PatchStore &patches, u64 dataSize, PyObject *args) {
+        u64 address;
+        Py_buffer patch;
+
+        // Anything that supports the buffer protocol works, so bytearrays and memoryviews don't have to be converted first
+        if (!PyArg_ParseTuple(args, "Ky*", &address, &patch))
+            return false;
+
+        SCOPE_EXIT( PyBuffer_Release(&patch); );
+
+        if (patch.len == 0) {
+            PyErr_SetString(PyExc_TypeError, "Invalid patch provided");
+            return false;
         }
 
-        if (address >= LoaderScript::s_dataProvider->getActualSize()) {
+        if (address > dataSize || u64(patch.len) > dataSize - address) {
             PyErr_SetString(PyExc_IndexError, "address out of range");
+            return false;
+        }
+
+        patches.write(address, patch.buf, patch.len);
+
+        return true;
+    }
+
+    PyObject* LoaderScript::Py_addPatch(PyObject *self, PyObject *args) {
+        if (!LoaderScript::checkCancelled())
+            return nullptr;
+
+        auto &run = *LoaderScript::s_run;
+        if (!writePatch(run.patches, run.snapshot.getSize(), args))
             return nullptr;
+
+        Py_RETURN_NONE;
+    }
+
+    PyObject* LoaderScript::Py_addPatches(PyObject *self, PyObject *args) {
+        PyObject *patches;
+        if (!PyArg_ParseTuple(args, "O", &patches) || !LoaderScript::checkCancelled())
+            return nullptr;
+
+        auto &run = *LoaderScript::s_run;
+
+        auto iterator = PyObject_GetIter(patches);
+        if (iterator == nullptr)
+            return nullptr;
+
+        SCOPE_EXIT( Py_DECREF(iterator); );
+
+        while (auto item = PyIter_Next(iterator)) {
+            bool written = PyTuple_Check(item) && writePatch(run.patches, run.snapshot.getSize(), item);
+            Py_DECREF(item);
+
+            if (!written) {
+                if (!PyErr_Occurred())
+                    PyErr_SetString(PyExc_TypeError, "patches need to be (address, data) tuples");
+                return nullptr;
+            }
         }
 
-        LoaderScript::s_dataProvider->write(address, patches, count);
+        if (PyErr_Occurred())
+            return nullptr;
 
         Py_RETURN_NONE;
     }
@@ -61,12 +200,61 @@ namespace hex {
             return nullptr;
         }
 
-        ImHexApi::Bookmarks::add(address, size, name, comment);
+        if (!LoaderScript::checkCancelled())
+            return nullptr;
+
+        LoaderScript::s_run->bookmarks.push_back({ { address, size }, name, comment, 0x00000000 });
+
+        Py_RETURN_NONE;
+    }
+
+    PyObject* LoaderScript::Py_addBookmarks(PyObject *self, PyObject *args) {
+        PyObject *bookmarks;
+        if (!PyArg_ParseTuple(args, "O", &bookmarks) || !LoaderScript::checkCancelled())
+            return nullptr;
+
+        auto iterator = PyObject_GetIter(bookmarks);
+        if (iterator == nullptr)
+            return nullptr;
+
+        SCOPE_EXIT( Py_DECREF(iterator); );
+
+        while (auto item = PyIter_Next(iterator)) {
+            u64 address;
+            Py_ssize_t size;
+            const char *name, *comment;
+            u32 color = 0x00000000;
+
+            bool parsed = PyTuple_Check(item) && PyArg_ParseTuple(item, "Knss|I", &address, &size, &name, &comment, &color);
+            if (parsed)
+                LoaderScript::s_run->bookmarks.push_back({ { address, size_t(size) }, name, comment, color });
+
+            Py_DECREF(item);
+
+            if (!parsed) {
+                if (!PyErr_Occurred())
+                    PyErr_SetString(PyExc_TypeError, "bookmarks need to be (address, size, name, comment[, color]) tuples");
+                return nullptr;
+            }
+        }
+
+        if (PyErr_Occurred())
+            return nullptr;
+
+        Py_RETURN_NONE;
+    }
+
+    PyObject* LoaderScript::Py_setProgress(PyObject *self, PyObject *args) {
+        double progress;
+        if (!PyArg_ParseTuple(args, "d", &progress) || !LoaderScript::checkCancelled())
+            return nullptr;
+
+        LoaderScript::s_run->task->setProgress(std::clamp(progress, 0.0, 1.0));
 
         Py_RETURN_NONE;
     }
 
-    static PyObject* createStructureType(std::string keyword, PyObject *args) {
+    static PyObject* createStructureType(std::vector<std::string> &patternCode, std::string keyword, PyObject *args) {
         auto type = PyTuple_GetItem(args, 0);
         if (type == nullptr) {
             PyErr_BadArgument();
@@ -163,20 +351,26 @@ namespace hex {
 
         code += "};\n";
 
-        View::postEvent(Events::AppendPatternLanguageCode, code.c_str());
+        patternCode.push_back(std::move(code));
 
         Py_RETURN_NONE;
     }
 
     PyObject* LoaderScript::Py_addStruct(PyObject *self, PyObject *args) {
-        return createStructureType("struct", args);
+        if (!LoaderScript::checkCancelled())
+            return nullptr;
+
+        return createStructureType(LoaderScript::s_run->patternCode, "struct", args);
     }
 
     PyObject* LoaderScript::Py_addUnion(PyObject *self, PyObject *args) {
-        return createStructureType("union", args);
+        if (!LoaderScript::checkCancelled())
+            return nullptr;
+
+        return createStructureType(LoaderScript::s_run->patternCode, "union", args);
     }
 
-    bool LoaderScript::processFile(std::string_view scriptPath) {
+    void LoaderScript::initialize() {
         Py_SetProgramName(Py_DecodeLocale((SharedData::mainArgv)[0], nullptr));
 
         if (std::filesystem::exists(std::filesystem::path((SharedData::mainArgv)[0]).parent_path().string() + "/lib/python" PYTHON_VERSION_MAJOR_MINOR))
@@ -185,11 +379,16 @@ namespace hex {
         PyImport_AppendInittab("_imhex", []() -> PyObject* {
 
             static PyMethodDef ImHexMethods[] = {
-                { "get_file_path",  &LoaderScript::Py_getFilePath,  METH_NOARGS,  "Returns the path of the file being loaded."  },
-                { "patch",          &LoaderScript::Py_addPatch,     METH_VARARGS, "Patches a region of memory"                  },
-                { "add_bookmark",   &LoaderScript::Py_addBookmark,  METH_VARARGS, "Adds a bookmark"                             },
-                { "add_struct",     &LoaderScript::Py_addStruct,    METH_VARARGS, "Adds a struct"                               },
-                { "add_union",      &LoaderScript::Py_addUnion,     METH_VARARGS, "Adds a union"                                },
+                { "get_file_path",  &LoaderScript::Py_getFilePath,  METH_NOARGS,  "Returns the path of the file being loaded."                         },
+                { "get_data",       &LoaderScript::Py_getData,      METH_NOARGS,  "Returns the unpatched data of the file, valid while the script runs" },
+                { "read",           &LoaderScript::Py_read,         METH_VARARGS, "Reads a region of memory including patches"                         },
+                { "patch",          &LoaderScript::Py_addPatch,     METH_VARARGS, "Patches a region of memory"                                         },
+                { "patch_many",     &LoaderScript::Py_addPatches,   METH_VARARGS, "Patches all regions in a list of (address, data) tuples"            },
+                { "add_bookmark",   &LoaderScript::Py_addBookmark,  METH_VARARGS, "Adds a bookmark"                                                    },
+                { "add_bookmarks",  &LoaderScript::Py_addBookmarks, METH_VARARGS, "Adds all bookmarks in a list of (address, size, name, comment) tuples" },
+                { "add_struct",     &LoaderScript::Py_addStruct,    METH_VARARGS, "Adds a struct"                                                      },
+                { "add_union",      &LoaderScript::Py_addUnion,     METH_VARARGS, "Adds a union"                                                       },
+                { "set_progress",   &LoaderScript::Py_setProgress,  METH_VARARGS, "Sets the progress shown for the script, from 0.0 to 1.0"            },
                 { nullptr,          nullptr,               0,     nullptr                                       }
             };
 
@@ -211,16 +410,149 @@ namespace hex {
             auto path = PyUnicode_FromString("lib");
 
             PyList_Insert(sysPath, 0, path);
+            Py_DECREF(path);
         }
 
-        FILE *scriptFile = fopen(scriptPath.data(), "r");
-        PyRun_SimpleFile(scriptFile, scriptPath.data());
+        // Scripts run on workers, which take the lock whenever they need it
+        LoaderScript::s_mainThreadState = PyEval_SaveThread();
+
+        LoaderScript::s_initialized = true;
+    }
 
-        fclose(scriptFile);
+    void LoaderScript::releaseDataViews(Run &run) {
+        for (auto view : run.dataViews) {
+            // Fails if the script still holds an export of the data, the view stays usable in that case
+            auto result = PyObject_CallMethod(view, "release", nullptr);
+            if (result == nullptr)
+                PyErr_Clear();
+            else
+                Py_DECREF(result);
 
-        Py_Finalize();
+            Py_DECREF(view);
+        }
+
+        run.dataViews.clear();
+    }
+
+    bool LoaderScript::processFile(std::string_view scriptPath) {
+        auto provider = LoaderScript::s_dataProvider;
+        if (provider == nullptr || !provider->isAvailable())
+            return false;
+
+        if (LoaderScript::s_task != nullptr && !LoaderScript::s_task->isFinished())
+            return false;
+
+        if (!LoaderScript::s_initialized)
+            LoaderScript::initialize();
+
+        const std::string path(scriptPath);
+
+        // Jobs that get cancelled before they start never run, the file gets closed either way
+        FILE *file = fopen(path.c_str(), "r");
+        if (file == nullptr)
+            return false;
+
+        std::shared_ptr<FILE> scriptFile(file, fclose);
+
+        auto run = std::make_shared<Run>();
+        run->filePath = LoaderScript::s_filePath;
+        run->provider = provider;
+        run->snapshot = provider->createSnapshot();
+
+        const auto size = run->snapshot.getSize();
+        if (provider->hasCapabilities(ContentRegistry::Providers::Mappable) && run->snapshot.hasSameData(run->snapshot.withoutEdits()))
+            run->residentData = provider->getResidentData(0x00, size);
+
+        auto succeeded = std::make_shared<bool>(false);
+
+        LoaderScript::s_task = TaskManager::submit("Running loader script", TaskPriority::Interactive, provider, [run, succeeded, scriptFile, path](Task &task) {
+            run->task = &task;
+
+            auto gil = PyGILState_Ensure();
+            LoaderScript::s_run = run.get();
+            const auto threadId = PyThread_get_thread_ident();
+
+            // Scripts only notice cancellation themselves when they call into the imhex module, anything else gets interrupted from the outside
+            std::atomic<bool> finished = false;
+            std::thread watchdog([&] {
+                while (!finished) {
+                    if (task.isCancelled()) {
+                        auto watchdogGil = PyGILState_Ensure();
+                        if (!finished)
+                            PyThreadState_SetAsyncExc(threadId, PyExc_KeyboardInterrupt);
+                        PyGILState_Release(watchdogGil);
+
+                        break;
+                    }
+
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                }
+            });
+
+            // A fresh main module namespace, so nothing a previous script defined is visible to this one
+            auto globals = PyDict_New();
+            PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+
+            auto name = PyUnicode_FromString("__main__");
+            PyDict_SetItemString(globals, "__name__", name);
+            Py_DECREF(name);
+
+            auto file = PyUnicode_FromString(path.c_str());
+            PyDict_SetItemString(globals, "__file__", file);
+            Py_DECREF(file);
+
+            auto result = PyRun_FileEx(scriptFile.get(), path.c_str(), Py_file_input, globals, globals, 0);
+            if (result == nullptr)
+                PyErr_Print();
+            else
+                Py_DECREF(result);
+
+            // Still holding the lock, so the watchdog either interrupted the script already or won't anymore
+            finished = true;
+            PyThreadState_SetAsyncExc(threadId, nullptr);
+
+            PyDict_Clear(globals);
+            Py_DECREF(globals);
+
+            LoaderScript::releaseDataViews(*run);
+
+            *succeeded = result != nullptr;
+            LoaderScript::s_run = nullptr;
+            PyGILState_Release(gil);
+
+            watchdog.join();
+        }, [run, succeeded] {
+            if (!*succeeded)
+                return;
+
+            const auto &providers = ImHexApi::Provider::getProviders();
+            if (std::find(providers.begin(), providers.end(), run->provider) == providers.end())
+                return;
+
+            // Everything the script added shows up at once, its patches can be undone as a single step
+            const auto &runs = run->patches.getRuns();
+            run->provider->writeRuns(std::vector<prv::PatchStore::Run>(runs.begin(), runs.end()));
+
+            for (const auto &bookmark : run->bookmarks)
+                ImHexApi::Bookmarks::add(bookmark.region, bookmark.name, bookmark.comment, bookmark.color);
+
+            for (const auto &code : run->patternCode)
+                View::postEvent(Events::AppendPatternLanguageCode, code.c_str());
+        });
 
         return true;
     }
 
-}
\ No newline at end of file
+    void LoaderScript::shutdown() {
+        if (!LoaderScript::s_initialized)
+            return;
+
+        PyEval_RestoreThread(LoaderScript::s_mainThreadState);
+        Py_Finalize();
+
+        LoaderScript::s_mainThreadState = nullptr;
+        LoaderScript::s_task = nullptr;
+        LoaderScript::s_initialized = false;
+    }
+
+}
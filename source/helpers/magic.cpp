@@ -0,0 +1,90 @@
+#include "helpers/magic.hpp"
+
+#include <hex/providers/provider.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+#include <magic.h>
+
+namespace hex::magic {
+
+    namespace {
+
+        // A libmagic cookie may only be used by one thread at a time
+        class Session {
+        public:
+            Session() {
+                std::string magicFiles;
+
+                std::error_code error;
+                for (const auto &entry : std::filesystem::directory_iterator("magic", error)) {
+                    if (entry.is_regular_file() && entry.path().extension() == ".mgc")
+                        magicFiles += entry.path().string() + MAGIC_PATH_SEPARATOR;
+                }
+
+                if (error || magicFiles.empty())
+                    return;
+
+                magicFiles.pop_back();
+
+                this->m_cookie = magic_open(MAGIC_NONE);
+                if (this->m_cookie != nullptr && magic_load(this->m_cookie, magicFiles.c_str()) == -1) {
+                    magic_close(this->m_cookie);
+                    this->m_cookie = nullptr;
+                }
+            }
+
+            ~Session() {
+                if (this->m_cookie != nullptr)
+                    magic_close(this->m_cookie);
+            }
+
+            std::string identify(const std::vector<u8> &data, int flags) {
+                std::scoped_lock lock(this->m_mutex);
+
+                if (this->m_cookie == nullptr || magic_setflags(this->m_cookie, flags) == -1)
+                    return "";
+
+                auto result = magic_buffer(this->m_cookie, data.data(), data.size());
+
+                return result != nullptr ? result : "";
+            }
+
+        private:
+            magic_t m_cookie = nullptr;
+            std::mutex m_mutex;
+        };
+
+        Session& getSession() {
+            static Session session;
+
+            return session;
+        }
+
+    }
+
+    std::string identify(prv::Provider *provider, Format format) {
+        if (provider == nullptr)
+            return "";
+
+        int flags = MAGIC_NONE;
+        switch (format) {
+            case Format::Description:   flags = MAGIC_NONE;         break;
+            case Format::MIME:          flags = MAGIC_MIME;         break;
+            case Format::MIMEType:      flags = MAGIC_MIME_TYPE;    break;
+        }
+
+        std::vector<u8> data(std::min<u64>(provider->getActualSize(), MaxInspectedSize), 0x00);
+        provider->readAbsolute(0x00, data.data(), data.size());
+
+        return getSession().identify(data, flags);
+    }
+
+    void preload() {
+        getSession();
+    }
+
+}
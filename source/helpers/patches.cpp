@@ -1,217 +1,164 @@
 #include "helpers/patches.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <string_view>
-#include <type_traits>
 
 #include <hex/helpers/utils.hpp>
 
 namespace hex {
 
-    static void pushBytesBack(std::vector<u8> &buffer, const char* bytes) {
-        std::string_view string(bytes);
-        buffer.resize(buffer.size() + string.length());
-        std::memcpy((&buffer.back() - string.length()) + 1, string.begin(), string.length());
-    }
+    // An RLE record takes up 8 bytes and usually splits a normal record in two, which costs another 5 bytes of header
+    constexpr static size_t MinimumRLESize = 14;
+    constexpr static size_t MaxRecordSize = 0xFFFF;
 
-    template<typename T>
-    static void pushBytesBack(std::vector<u8> &buffer, T bytes) {
-        buffer.resize(buffer.size() + sizeof(T));
-        std::memcpy((&buffer.back() - sizeof(T)) + 1, &bytes, sizeof(T));
+    static void pushBytesBack(std::vector<u8> &buffer, std::string_view bytes) {
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
     }
-    
-    std::vector<u8> generateIPSPatch(const Patches &patches) {
-        std::vector<u8> result;
-
-        pushBytesBack(result, "PATCH");
-
-        std::vector<u64> addresses;
-        std::vector<u8> values;
-
-        for (const auto &[address, value] : patches) {
-            addresses.push_back(address);
-            values.push_back(value);
-        }
-
-        std::optional<u64> startAddress;
-        std::vector<u8> bytes;
-        for (u32 i = 0; i < addresses.size(); i++) {
-            if (!startAddress.has_value())
-                startAddress = addresses[i];
-
-            if (i != addresses.size() - 1 && addresses[i] == (addresses[i + 1] - 1)) {
-                bytes.push_back(values[i]);
-            } else {
-                bytes.push_back(values[i]);
-
-                if (bytes.size() > 0xFFFF || startAddress > 0xFF'FFFF)
-                    return { };
-
-                u32 address = startAddress.value();
-                auto addressBytes = reinterpret_cast<u8*>(&address);
-
-                result.push_back(addressBytes[2]); result.push_back(addressBytes[1]); result.push_back(addressBytes[0]);
-                pushBytesBack<u16>(result, changeEndianess<u16>(bytes.size(), std::endian::big));
-
-                for (auto byte : bytes)
-                    result.push_back(byte);
-
-                bytes.clear();
-                startAddress = { };
-            }
-        }
 
-        pushBytesBack(result, "EOF");
-
-        return result;
+    static void pushBigEndian(std::vector<u8> &buffer, u64 value, size_t size) {
+        for (size_t i = 0; i < size; i++)
+            buffer.push_back(value >> ((size - i - 1) * 8));
     }
 
-    std::vector<u8> generateIPS32Patch(const Patches &patches) {
-        std::vector<u8> result;
+    static u64 readBigEndian(const u8 *data, size_t size) {
+        u64 value = 0;
+        for (size_t i = 0; i < size; i++)
+            value = (value << 8) | data[i];
 
-        pushBytesBack(result, "IPS32");
+        return value;
+    }
 
-        std::vector<u64> addresses;
-        std::vector<u8> values;
+    static std::vector<u8> generatePatch(const prv::PatchStore::Runs &patches, std::string_view header, std::string_view footer, size_t addressSize) {
+        const u64 maxAddress = (u64(1) << (addressSize * 8)) - 1;
 
-        for (const auto &[address, value] : patches) {
-            addresses.push_back(address);
-            values.push_back(value);
-        }
+        // A record starting at the address that's made up of the footer's bytes would be read as the end of the patch
+        const u64 footerAddress = readBigEndian(reinterpret_cast<const u8*>(footer.data()), addressSize);
 
-        std::optional<u64> startAddress;
-        std::vector<u8> bytes;
-        for (u32 i = 0; i < addresses.size(); i++) {
-            if (!startAddress.has_value())
-                startAddress = addresses[i];
+        std::vector<u8> result;
+        pushBytesBack(result, header);
 
-            if (i != addresses.size() - 1 && addresses[i] == (addresses[i + 1] - 1)) {
-                bytes.push_back(values[i]);
-            } else {
-                bytes.push_back(values[i]);
+        for (const auto &[address, data] : patches) {
+            if (address == footerAddress)
+                return { };
 
-                if (bytes.size() > 0xFFFF || startAddress > 0xFFFF'FFFF)
+            size_t offset = 0;
+            while (offset < data.size()) {
+                const u64 recordAddress = address + offset;
+                if (recordAddress > maxAddress)
                     return { };
 
-                u32 address = startAddress.value();
-                auto addressBytes = reinterpret_cast<u8*>(&address);
-
-                result.push_back(addressBytes[3]); result.push_back(addressBytes[2]); result.push_back(addressBytes[1]); result.push_back(addressBytes[0]);
-                pushBytesBack<u16>(result, changeEndianess<u16>(bytes.size(), std::endian::big));
-
-                for (auto byte : bytes)
-                    result.push_back(byte);
-
-                bytes.clear();
-                startAddress = { };
+                const size_t maxSize = std::min(MaxRecordSize, data.size() - offset);
+
+                size_t repeatSize = 1;
+                while (repeatSize < maxSize && data[offset + repeatSize] == data[offset])
+                    repeatSize++;
+
+                const bool rle = repeatSize >= MinimumRLESize;
+                size_t size = repeatSize;
+
+                // Normal records end right before the next sequence that's long enough to be worth its own RLE record
+                if (!rle) {
+                    size_t repeatStart = offset;
+                    for (size = 0; size < maxSize; size++) {
+                        const size_t position = offset + size;
+                        if (data[position] != data[repeatStart])
+                            repeatStart = position;
+
+                        if (position - repeatStart + 1 >= MinimumRLESize) {
+                            size = repeatStart - offset;
+                            break;
+                        }
+                    }
+                }
+
+                if (recordAddress + size == footerAddress && offset + size < data.size()) {
+                    if (size > 1)
+                        size--;
+                    else
+                        size++;
+                }
+
+                pushBigEndian(result, recordAddress, addressSize);
+
+                if (rle) {
+                    pushBigEndian(result, 0x0000, 2);
+                    pushBigEndian(result, size, 2);
+                    result.push_back(data[offset]);
+                } else {
+                    pushBigEndian(result, size, 2);
+                    result.insert(result.end(), data.begin() + offset, data.begin() + offset + size);
+                }
+
+                offset += size;
             }
         }
 
-        pushBytesBack(result, "EEOF");
+        pushBytesBack(result, footer);
 
         return result;
     }
 
-    Patches loadIPSPatch(const std::vector<u8> &ipsPatch) {
-        if (ipsPatch.size() < (5 + 3))
+    static prv::PatchStore::Runs loadPatch(const std::vector<u8> &patch, std::string_view header, std::string_view footer, size_t addressSize) {
+        if (patch.size() < header.size() + footer.size() || std::memcmp(patch.data(), header.data(), header.size()) != 0)
             return { };
 
-        if (std::memcmp(ipsPatch.data(), "PATCH", 5) != 0)
-            return { };
+        prv::PatchStore patches;
+
+        size_t patchOffset = header.size();
+        while (true) {
+            if (patchOffset + footer.size() > patch.size())
+                return { };
 
-        Patches result;
-        bool foundEOF = false;
+            // Anything following the footer is a size to truncate the file to, which isn't supported
+            if (std::memcmp(patch.data() + patchOffset, footer.data(), footer.size()) == 0)
+                break;
 
-        u32 ipsOffset = 5;
-        while (ipsOffset < ipsPatch.size() - (5 + 3)) {
-            u32 offset = ipsPatch[ipsOffset + 2] | (ipsPatch[ipsOffset + 1] << 8) | (ipsPatch[ipsOffset + 0] << 16);
-            u16 size = ipsPatch[ipsOffset + 4] | (ipsPatch[ipsOffset + 3] << 8);
+            if (patchOffset + addressSize + 2 > patch.size())
+                return { };
 
-            ipsOffset += 5;
+            const u64 address = readBigEndian(patch.data() + patchOffset, addressSize);
+            const u16 size    = readBigEndian(patch.data() + patchOffset + addressSize, 2);
+            patchOffset += addressSize + 2;
 
             // Handle normal record
             if (size > 0x0000) {
-                if (ipsOffset + size > ipsPatch.size() - 3)
+                if (patchOffset + size > patch.size())
                     return { };
 
-                for (u16 i = 0; i < size; i++)
-                    result[offset + i] = ipsPatch[ipsOffset + i];
-                ipsOffset += size;
+                patches.write(address, patch.data() + patchOffset, size);
+                patchOffset += size;
             }
             // Handle RLE record
             else {
-                if (ipsOffset + 3 > ipsPatch.size() - 3)
+                if (patchOffset + 3 > patch.size())
                     return { };
 
-                u16 rleSize = ipsPatch[ipsOffset + 0] | (ipsPatch[ipsOffset + 1] << 8);
-
-                ipsOffset += 2;
+                const u16 rleSize = readBigEndian(patch.data() + patchOffset, 2);
+                const std::vector<u8> data(rleSize, patch[patchOffset + 2]);
 
-                for (u16 i = 0; i < rleSize; i++)
-                    result[offset + i] = ipsPatch[ipsOffset + 0];
-
-                ipsOffset += 1;
+                patches.write(address, data.data(), data.size());
+                patchOffset += 3;
             }
-
-            if (std::memcmp(ipsPatch.data(), "EOF", 3))
-                foundEOF = true;
         }
 
-        if (foundEOF)
-            return result;
-        else
-            return { };
+        return patches.getRuns();
     }
 
-    Patches loadIPS32Patch(const std::vector<u8> &ipsPatch) {
-        if (ipsPatch.size() < (5 + 4))
-            return { };
-
-        if (std::memcmp(ipsPatch.data(), "IPS32", 5) != 0)
-            return { };
-
-        Patches result;
-        bool foundEEOF = false;
-
-        u32 ipsOffset = 5;
-        while (ipsOffset < ipsPatch.size() - (5 + 4)) {
-            u32 offset = ipsPatch[ipsOffset + 3] | (ipsPatch[ipsOffset + 2] << 8) | (ipsPatch[ipsOffset + 1] << 16) | (ipsPatch[ipsOffset + 0] << 24);
-            u16 size = ipsPatch[ipsOffset + 5] | (ipsPatch[ipsOffset + 4] << 8);
-
-            ipsOffset += 6;
-
-            // Handle normal record
-            if (size > 0x0000) {
-                if (ipsOffset + size > ipsPatch.size() - 3)
-                    return { };
-
-                for (u16 i = 0; i < size; i++)
-                    result[offset + i] = ipsPatch[ipsOffset + i];
-                ipsOffset += size;
-            }
-            // Handle RLE record
-            else {
-                if (ipsOffset + 3 > ipsPatch.size() - 3)
-                    return { };
-
-                u16 rleSize = ipsPatch[ipsOffset + 0] | (ipsPatch[ipsOffset + 1] << 8);
-
-                ipsOffset += 2;
-
-                for (u16 i = 0; i < rleSize; i++)
-                    result[offset + i] = ipsPatch[ipsOffset + 0];
+    std::vector<u8> generateIPSPatch(const prv::PatchStore::Runs &patches) {
+        return generatePatch(patches, "PATCH", "EOF", 3);
+    }
 
-                ipsOffset += 1;
-            }
+    std::vector<u8> generateIPS32Patch(const prv::PatchStore::Runs &patches) {
+        return generatePatch(patches, "IPS32", "EEOF", 4);
+    }
 
-            if (std::memcmp(ipsPatch.data(), "EEOF", 4))
-                foundEEOF = true;
-        }
+    prv::PatchStore::Runs loadIPSPatch(const std::vector<u8> &ipsPatch) {
+        return loadPatch(ipsPatch, "PATCH", "EOF", 3);
+    }
 
-        if (foundEEOF)
-            return result;
-        else
-            return { };
+    prv::PatchStore::Runs loadIPS32Patch(const std::vector<u8> &ipsPatch) {
+        return loadPatch(ipsPatch, "IPS32", "EEOF", 4);
     }
 
-}
\ No newline at end of file
+}
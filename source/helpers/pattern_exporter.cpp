@@ -0,0 +1,374 @@
+#include "helpers/pattern_exporter.hpp"
+
+#include <hex/providers/provider.hpp>
+#include <hex/lang/pattern_data.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <optional>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace hex {
+
+    using namespace hex::lang;
+
+    namespace {
+
+        // Everything that gets exported about a single pattern, its nested patterns are passed to the writer right after it
+        struct Entry {
+            std::string name, type;
+            u64 offset = 0, size = 0;
+            const std::optional<std::string> *comment = nullptr;
+            json value;                                     // Null if the pattern has no value of its own
+            std::optional<std::string> enumEntry;
+            std::optional<std::pair<size_t, size_t>> bits;  // Bit offset and size of bitfield fields
+            bool hasChildren = false;
+        };
+
+        class Writer {
+        public:
+            virtual ~Writer() = default;
+
+            virtual void begin(const Entry &entry) = 0;
+            virtual void end(const Entry &entry) = 0;
+        };
+
+        std::string toJsonString(const std::string &string) {
+            return json(string).dump(-1, ' ', false, json::error_handler_t::replace);
+        }
+
+        class JsonWriter : public Writer {
+        public:
+            explicit JsonWriter(std::ostream &stream) : m_stream(stream) {
+                this->m_stream << '[';
+                this->m_first.push_back(true);
+            }
+
+            ~JsonWriter() override {
+                this->m_stream << ']';
+            }
+
+            void begin(const Entry &entry) override {
+                if (!this->m_first.back())
+                    this->m_stream << ',';
+                this->m_first.back() = false;
+
+                this->m_stream << "{\"name\":" << toJsonString(entry.name) << ",\"type\":" << toJsonString(entry.type);
+
+                if (entry.bits.has_value())
+                    this->m_stream << ",\"bitOffset\":" << entry.bits->first << ",\"bits\":" << entry.bits->second;
+                else
+                    this->m_stream << ",\"offset\":" << entry.offset << ",\"size\":" << entry.size;
+
+                if (!entry.value.is_null())
+                    this->m_stream << ",\"value\":" << entry.value.dump(-1, ' ', false, json::error_handler_t::replace);
+                if (entry.enumEntry.has_value())
+                    this->m_stream << ",\"entry\":" << toJsonString(*entry.enumEntry);
+                if (entry.comment != nullptr && entry.comment->has_value())
+                    this->m_stream << ",\"comment\":" << toJsonString(**entry.comment);
+
+                if (entry.hasChildren) {
+                    this->m_stream << ",\"children\":[";
+                    this->m_first.push_back(true);
+                }
+            }
+
+            void end(const Entry &entry) override {
+                if (entry.hasChildren) {
+                    this->m_stream << ']';
+                    this->m_first.pop_back();
+                }
+
+                this->m_stream << '}';
+            }
+
+        private:
+            std::ostream &m_stream;
+            std::vector<bool> m_first;
+        };
+
+        class CsvWriter : public Writer {
+        public:
+            CsvWriter(std::ostream &stream, const std::string &file) : m_stream(stream), m_file(file.empty() ? "" : PatternExporter::escapeCsv(file) + ",") { }
+
+            void begin(const Entry &entry) override {
+                const auto &parentPath = this->m_paths.empty() ? std::string() : this->m_paths.back();
+
+                if (parentPath.empty())
+                    this->m_paths.push_back(entry.name);
+                else if (entry.name.starts_with('['))
+                    this->m_paths.push_back(parentPath + entry.name);
+                else
+                    this->m_paths.push_back(parentPath + "." + entry.name);
+
+                std::string value;
+                if (entry.enumEntry.has_value())
+                    value = *entry.enumEntry;
+                else if (!entry.value.is_null())
+                    value = entry.value.is_string() ? entry.value.get<std::string>() : entry.value.dump();
+
+                const u64 offset = entry.bits.has_value() ? entry.offset + entry.bits->first / 8 : entry.offset;
+                const u64 size   = entry.bits.has_value() ? (entry.bits->second + 7) / 8 : entry.size;
+
+                this->m_stream << this->m_file << PatternExporter::escapeCsv(this->m_paths.back()) << ',' << PatternExporter::escapeCsv(entry.type) << ','
+                               << hex::format("0x%llX", offset) << ',' << size << ',' << PatternExporter::escapeCsv(value) << '\n';
+            }
+
+            void end(const Entry &entry) override {
+                this->m_paths.pop_back();
+            }
+
+        private:
+            std::ostream &m_stream;
+            std::string m_file;
+            std::vector<std::string> m_paths;
+        };
+
+        u64 readValue(prv::Provider *provider, const PatternData *pattern) {
+            u64 value = 0;
+            provider->readAbsolute(pattern->getOffset(), &value, std::min<size_t>(pattern->getSize(), sizeof(value)));
+
+            return hex::changeEndianess(value, std::min<size_t>(pattern->getSize(), sizeof(value)), pattern->getEndian());
+        }
+
+        // Values that don't fit into 64 bits are exported as hex strings, most JSON parsers couldn't read them as numbers
+        std::string readWideValue(prv::Provider *provider, const PatternData *pattern) {
+            std::vector<u8> bytes(pattern->getSize(), 0x00);
+            provider->readAbsolute(pattern->getOffset(), bytes.data(), bytes.size());
+
+            if (pattern->getEndian() == std::endian::little)
+                std::reverse(bytes.begin(), bytes.end());
+
+            std::string result = "0x";
+            hex::appendHexBytes(result, bytes);
+
+            return result;
+        }
+
+        void writeBitfieldFields(Writer &writer, prv::Provider *provider, PatternDataBitfield *pattern) {
+            std::vector<u8> value(pattern->getSize(), 0x00);
+            provider->readAbsolute(pattern->getOffset(), value.data(), value.size());
+
+            if (pattern->getEndian() == std::endian::big)
+                std::reverse(value.begin(), value.end());
+
+            size_t bitOffset = 0;
+            for (auto &[fieldName, fieldSize] : pattern->getFields()) {
+                u64 fieldValue = 0;
+                for (size_t bit = 0; bit < fieldSize; bit++) {
+                    const size_t valueBit = bitOffset + bit;
+                    fieldValue |= u64((value[valueBit / 8] >> (valueBit % 8)) & 1) << bit;
+                }
+
+                Entry field;
+                field.name   = fieldName;
+                field.type   = "bits";
+                field.offset = pattern->getOffset();
+                field.value  = fieldValue;
+                field.bits   = { bitOffset, fieldSize };
+
+                writer.begin(field);
+                writer.end(field);
+
+                bitOffset += fieldSize;
+            }
+        }
+
+        // Static arrays of plain numbers are read and converted to the native endianess in blocks instead of one entry at a time.
+        // Returns false if the entries aren't plain numbers and have to be written one by one
+        bool writeNumericEntries(Writer &writer, prv::Provider *provider, PatternDataStaticArray *array) {
+            constexpr static u64 BlockEntryCount = 0x1000;
+
+            auto entryTemplate = array->getTemplate();
+            const size_t size = entryTemplate->getSize();
+
+            const bool isUnsigned = dynamic_cast<PatternDataUnsigned*>(entryTemplate) != nullptr;
+            const bool isSigned   = dynamic_cast<PatternDataSigned*>(entryTemplate) != nullptr;
+            const bool isFloat    = dynamic_cast<PatternDataFloat*>(entryTemplate) != nullptr;
+
+            if (isFloat && size != sizeof(float) && size != sizeof(double))
+                return false;
+            else if (!isUnsigned && !isSigned && !isFloat)
+                return false;
+            else if (size != 1 && size != 2 && size != 4 && size != 8)
+                return false;
+
+            Entry entry;
+            entry.type    = entryTemplate->getFormattedName();
+            entry.size    = size;
+            entry.comment = &entryTemplate->getComment();
+
+            std::vector<u8> buffer(std::min(BlockEntryCount, array->getEntryCount()) * size);
+            for (u64 blockStart = 0; blockStart < array->getEntryCount(); blockStart += BlockEntryCount) {
+                const u64 blockEntryCount = std::min(BlockEntryCount, array->getEntryCount() - blockStart);
+                provider->readAbsolute(array->getOffset() + blockStart * size, buffer.data(), blockEntryCount * size);
+
+                if (entryTemplate->getEndian() != std::endian::native)
+                    hex::swapBytes(buffer.data(), blockEntryCount, size);
+
+                for (u64 i = 0; i < blockEntryCount; i++) {
+                    u64 value = 0;
+                    std::memcpy(&value, buffer.data() + i * size, size);
+
+                    entry.name   = hex::format("[%llu]", blockStart + i);
+                    entry.offset = array->getOffset() + (blockStart + i) * size;
+
+                    if (isUnsigned)
+                        entry.value = value;
+                    else if (isSigned)
+                        entry.value = s64(hex::signExtend(value, size, 64));
+                    else if (size == sizeof(float))
+                        entry.value = std::bit_cast<float>(u32(value));
+                    else
+                        entry.value = std::bit_cast<double>(value);
+
+                    writer.begin(entry);
+                    writer.end(entry);
+                }
+            }
+
+            return true;
+        }
+
+        void writePattern(Writer &writer, prv::Provider *provider, PatternData *pattern) {
+            Entry entry;
+            entry.name    = pattern->getVariableName();
+            entry.type    = pattern->getFormattedName();
+            entry.offset  = pattern->getOffset();
+            entry.size    = pattern->getSize();
+            entry.comment = &pattern->getComment();
+
+            std::vector<PatternData*> children;
+
+            if (dynamic_cast<PatternDataUnsigned*>(pattern) != nullptr) {
+                if (pattern->getSize() <= sizeof(u64))
+                    entry.value = readValue(provider, pattern);
+                else
+                    entry.value = readWideValue(provider, pattern);
+            } else if (dynamic_cast<PatternDataSigned*>(pattern) != nullptr) {
+                if (pattern->getSize() <= sizeof(u64))
+                    entry.value = s64(hex::signExtend(readValue(provider, pattern), pattern->getSize(), 64));
+                else
+                    entry.value = readWideValue(provider, pattern);
+            } else if (dynamic_cast<PatternDataFloat*>(pattern) != nullptr) {
+                auto value = readValue(provider, pattern);
+
+                if (pattern->getSize() == sizeof(float)) {
+                    u32 bits = value;
+                    entry.value = *reinterpret_cast<float*>(&bits);
+                } else if (pattern->getSize() == sizeof(double))
+                    entry.value = *reinterpret_cast<double*>(&value);
+            } else if (dynamic_cast<PatternDataBoolean*>(pattern) != nullptr) {
+                entry.value = readValue(provider, pattern) != 0;
+            } else if (dynamic_cast<PatternDataCharacter*>(pattern) != nullptr || dynamic_cast<PatternDataString*>(pattern) != nullptr) {
+                std::vector<u8> buffer(pattern->getSize() + 1, 0x00);
+                provider->readAbsolute(pattern->getOffset(), buffer.data(), pattern->getSize());
+
+                entry.value = pattern->getSize() == 0 ? "" : makeDisplayable(buffer.data(), pattern->getSize());
+            } else if (auto enumPattern = dynamic_cast<PatternDataEnum*>(pattern); enumPattern != nullptr) {
+                auto value = readValue(provider, pattern);
+                entry.value = value;
+
+                for (auto &[entryValueLiteral, entryName] : enumPattern->getEnumValues()) {
+                    if (std::visit([value](auto &&entryValue) { return value == entryValue; }, entryValueLiteral.second)) {
+                        entry.enumEntry = entryName;
+                        break;
+                    }
+                }
+            } else if (auto bitfieldPattern = dynamic_cast<PatternDataBitfield*>(pattern); bitfieldPattern != nullptr) {
+                entry.hasChildren = true;
+
+                writer.begin(entry);
+                writeBitfieldFields(writer, provider, bitfieldPattern);
+                writer.end(entry);
+
+                return;
+            } else if (auto pointerPattern = dynamic_cast<PatternDataPointer*>(pattern); pointerPattern != nullptr) {
+                entry.value = readValue(provider, pattern);
+                children = { pointerPattern->getPointedAtPattern() };
+            } else if (auto structPattern = dynamic_cast<PatternDataStruct*>(pattern); structPattern != nullptr) {
+                children = structPattern->getMembers();
+            } else if (auto unionPattern = dynamic_cast<PatternDataUnion*>(pattern); unionPattern != nullptr) {
+                children = unionPattern->getMembers();
+            } else if (auto arrayPattern = dynamic_cast<PatternDataArray*>(pattern); arrayPattern != nullptr) {
+                children = arrayPattern->getEntries();
+            } else if (auto staticArrayPattern = dynamic_cast<PatternDataStaticArray*>(pattern); staticArrayPattern != nullptr) {
+                // The template gets moved to every entry in turn, copying out the entries would defeat the point of the lazy array
+                entry.hasChildren = true;
+
+                writer.begin(entry);
+                if (!writeNumericEntries(writer, provider, staticArrayPattern)) {
+                    for (u64 i = 0; i < staticArrayPattern->getEntryCount(); i++)
+                        writePattern(writer, provider, staticArrayPattern->getEntry(i));
+                }
+                writer.end(entry);
+
+                return;
+            }
+
+            entry.hasChildren = !children.empty();
+
+            writer.begin(entry);
+            for (auto child : children)
+                writePattern(writer, provider, child);
+            writer.end(entry);
+        }
+
+    }
+
+    void PatternExporter::writeJson(std::ostream &stream, prv::Provider *provider, const std::vector<PatternData*> &patterns) {
+        JsonWriter writer(stream);
+
+        for (auto pattern : patterns)
+            writePattern(writer, provider, pattern);
+    }
+
+    void PatternExporter::writeCsv(std::ostream &stream, prv::Provider *provider, const std::vector<PatternData*> &patterns, bool writeHeader, const std::string &file) {
+        if (writeHeader)
+            stream << (file.empty() ? "" : "file,") << "path,type,offset,size,value\n";
+
+        CsvWriter writer(stream, file);
+
+        for (auto pattern : patterns)
+            writePattern(writer, provider, pattern);
+    }
+
+    bool PatternExporter::exportToFile(const std::string &path, Format format, prv::Provider *provider, const std::vector<PatternData*> &patterns) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        switch (format) {
+            case Format::JSON:
+                writeJson(file, provider, patterns);
+                break;
+            case Format::CSV:
+                writeCsv(file, provider, patterns);
+                break;
+        }
+
+        return file.good();
+    }
+
+    std::string PatternExporter::escapeCsv(const std::string &field) {
+        if (field.find_first_of(",\"\r\n") == std::string::npos)
+            return field;
+
+        std::string result = "\"";
+        for (char c : field) {
+            if (c == '"')
+                result += '"';
+            result += c;
+        }
+        result += '"';
+
+        return result;
+    }
+
+}
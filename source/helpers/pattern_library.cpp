@@ -0,0 +1,91 @@
+#include "helpers/pattern_library.hpp"
+
+#include <hex/lang/preprocessor.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+
+namespace hex::pattern_library {
+
+    namespace {
+
+        struct PatternFile {
+            std::filesystem::file_time_type modificationTime;
+            std::vector<std::string> mimeTypes;
+        };
+
+        std::mutex s_mutex;
+        std::map<std::string, PatternFile> s_patternFiles;
+
+        std::vector<std::string> readMimeTypes(const std::filesystem::path &path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open())
+                return { };
+
+            std::string code((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            std::vector<std::string> mimeTypes;
+
+            lang::Preprocessor preprocessor;
+            preprocessor.addPragmaHandler("MIME", [&mimeTypes](const std::string &value) {
+                if (std::all_of(value.begin(), value.end(), isspace) || value.ends_with('\n') || value.ends_with('\r'))
+                    return false;
+
+                mimeTypes.push_back(value);
+                return true;
+            });
+            preprocessor.addDefaultPragmaHandlers();
+
+            // Pragma handlers only run once the whole file got preprocessed, files with errors don't declare any types
+            if (!preprocessor.preprocess(code).has_value())
+                return { };
+
+            return mimeTypes;
+        }
+
+    }
+
+    void refresh() {
+        std::scoped_lock lock(s_mutex);
+
+        std::map<std::string, PatternFile> patternFiles;
+
+        std::error_code errorCode;
+        for (auto &entry : std::filesystem::directory_iterator("patterns", errorCode)) {
+            if (!entry.is_regular_file(errorCode))
+                continue;
+
+            const auto modificationTime = entry.last_write_time(errorCode);
+            if (errorCode)
+                continue;
+
+            auto name = entry.path().filename().string();
+            if (auto it = s_patternFiles.find(name); it != s_patternFiles.end() && it->second.modificationTime == modificationTime)
+                patternFiles.insert(s_patternFiles.extract(it));
+            else
+                patternFiles.emplace(std::move(name), PatternFile { modificationTime, readMimeTypes(entry.path()) });
+        }
+
+        // Files that aren't in the folder anymore are left behind
+        s_patternFiles = std::move(patternFiles);
+    }
+
+    std::vector<std::string> findForMimeType(const std::string &mimeType) {
+        refresh();
+
+        std::scoped_lock lock(s_mutex);
+
+        std::vector<std::string> result;
+        for (const auto &[name, patternFile] : s_patternFiles) {
+            if (std::find(patternFile.mimeTypes.begin(), patternFile.mimeTypes.end(), mimeType) != patternFile.mimeTypes.end())
+                result.push_back(name);
+        }
+
+        return result;
+    }
+
+}
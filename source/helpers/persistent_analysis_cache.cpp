@@ -0,0 +1,358 @@
+#include "helpers/persistent_analysis_cache.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/helpers/shared_data.hpp>
+#include <hex/helpers/utils.hpp>
+#include <hex/providers/provider.hpp>
+#include <hex/providers/snapshot.hpp>
+
+#include "helpers/crypto.hpp"
+#include "helpers/file_watcher.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(OS_WINDOWS)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace hex {
+
+    std::map<prv::Provider*, PersistentAnalysisCache::ProviderFingerprint> PersistentAnalysisCache::s_fingerprints;
+    std::atomic<u64> PersistentAnalysisCache::s_budget = PersistentAnalysisCache::DefaultBudget;
+
+    constexpr static char FileMagic[8] = { 'H', 'E', 'X', 'C', 'A', 'C', 'H', 'E' };
+    constexpr static u32 FileVersion = 2;
+    // Arrays start at multiples of this, so values of any type are aligned within the mapped file
+    constexpr static u64 ArrayAlignment = 64;
+
+    // Stored in host byte order, a mismatching byte order simply never matches the key hash
+    struct FileHeader {
+        char magic[8];
+        u32 version;
+        u32 arrayCount;
+        u64 fingerprintHash;
+        u64 dataSize;
+        u64 keyHash;
+        u64 payloadHash;
+    };
+
+    struct ArrayHeader {
+        u64 offset;
+        u64 size;
+        u32 elementSize;
+        u32 reserved;
+    };
+
+    static u64 hashKey(const std::string &key) {
+        return crypt::xxh64(reinterpret_cast<const u8*>(key.data()), key.size());
+    }
+
+    // Covers the array headers and the data of every array, the padding between them doesn't matter
+    static u64 hashPayload(const std::vector<ArrayHeader> &arrays, const std::vector<const u8*> &data) {
+        std::vector<u64> hashes;
+        for (size_t i = 0; i < arrays.size(); i++) {
+            hashes.push_back(crypt::xxh64(reinterpret_cast<const u8*>(&arrays[i]), sizeof(ArrayHeader)));
+            hashes.push_back(crypt::xxh64(data[i], arrays[i].size));
+        }
+
+        return crypt::xxh64(reinterpret_cast<const u8*>(hashes.data()), hashes.size() * sizeof(u64));
+    }
+
+    // Every write gets a file of its own, entries with the same key may be stored by several threads or instances at once
+    static std::string getTemporaryPath(const std::string &path) {
+        static std::atomic<u64> counter = 0;
+
+        #if defined(OS_WINDOWS)
+            const u64 processId = GetCurrentProcessId();
+        #else
+            const u64 processId = getpid();
+        #endif
+
+        return hex::format("%s.%llX-%llX.tmp", path.c_str(), processId, counter++);
+    }
+
+    PersistentAnalysisCache::Fingerprint PersistentAnalysisCache::getFingerprint(const FileBlockHashes &hashes) {
+        return { crypt::xxh64(reinterpret_cast<const u8*>(hashes.hashes.data()), hashes.hashes.size() * sizeof(u64)), hashes.dataSize };
+    }
+
+    std::optional<PersistentAnalysisCache::Fingerprint> PersistentAnalysisCache::getSampledFingerprint(const prv::Snapshot &snapshot, s64 modificationTime, Task &task) {
+        constexpr static u64 SampleCount = 0x400;
+        constexpr static size_t SampleSize = FileBlockHashes::BlockSize;
+
+        const u64 dataSize = snapshot.getSize();
+        const u64 blockCount = (dataSize + SampleSize - 1) / SampleSize;
+        const u64 sampleCount = std::min(SampleCount, blockCount);
+
+        std::vector<u64> hashes = { dataSize, u64(modificationTime) };
+        std::vector<u8> buffer(SampleSize);
+
+        // The first and the last block are always part of the samples, headers and trailers are where files most likely differ
+        for (u64 sample = 0; sample < sampleCount; sample++) {
+            if (task.isCancelled())
+                return std::nullopt;
+
+            const u64 block = sampleCount == 1 ? 0 : (blockCount - 1) * sample / (sampleCount - 1);
+            const size_t size = std::min<u64>(SampleSize, dataSize - block * SampleSize);
+
+            if (!snapshot.read(block * SampleSize, buffer.data(), size))
+                return std::nullopt;
+
+            hashes.push_back(crypt::xxh64(buffer.data(), size));
+            task.setProgress(float(sample + 1) / sampleCount);
+        }
+
+        return Fingerprint { crypt::xxh64(reinterpret_cast<const u8*>(hashes.data()), hashes.size() * sizeof(u64)), dataSize };
+    }
+
+    void PersistentAnalysisCache::setFingerprint(prv::Provider *provider, const Fingerprint &fingerprint, u64 dataGeneration) {
+        PersistentAnalysisCache::s_fingerprints[provider] = { fingerprint, dataGeneration };
+    }
+
+    void PersistentAnalysisCache::removeFingerprint(prv::Provider *provider) {
+        PersistentAnalysisCache::s_fingerprints.erase(provider);
+    }
+
+    std::optional<PersistentAnalysisCache::Fingerprint> PersistentAnalysisCache::getFingerprint(prv::Provider *provider) {
+        auto it = PersistentAnalysisCache::s_fingerprints.find(provider);
+        if (provider == nullptr || it == PersistentAnalysisCache::s_fingerprints.end() || it->second.dataGeneration != provider->getDataGeneration())
+            return std::nullopt;
+
+        return it->second.fingerprint;
+    }
+
+    std::string PersistentAnalysisCache::getDirectory() {
+        return (std::filesystem::path(SharedData::mainArgv[0]).parent_path() / "cache").string();
+    }
+
+    std::string PersistentAnalysisCache::getPath(const Fingerprint &fingerprint, const std::string &key) {
+        // Keys only name the analysis and its parameters, anything that isn't safe in a file name gets replaced
+        std::string fileName = hex::format("%016llX-%llX-", fingerprint.hash, fingerprint.dataSize);
+        for (char character : key)
+            fileName += std::isalnum(static_cast<unsigned char>(character)) || character == '-' ? character : '_';
+
+        return (std::filesystem::path(getDirectory()) / (fileName + ".hexcache")).string();
+    }
+
+    void PersistentAnalysisCache::store(const Fingerprint &fingerprint, const std::string &key, Writer writer) {
+        if (PersistentAnalysisCache::s_budget == 0)
+            return;
+
+        TaskManager::submit("Storing analysis", TaskPriority::Background, [fingerprint, key, writer = std::move(writer)](Task&) {
+            std::error_code error;
+            std::filesystem::create_directories(getDirectory(), error);
+
+            writeFile(getPath(fingerprint, key), fingerprint, key, writer);
+            trim();
+        });
+    }
+
+    bool PersistentAnalysisCache::writeFile(const std::string &path, const Fingerprint &fingerprint, const std::string &key, const Writer &writer) {
+        std::error_code error;
+
+        FileHeader header = { };
+        std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+        header.version          = FileVersion;
+        header.arrayCount       = writer.m_arrays.size();
+        header.fingerprintHash  = fingerprint.hash;
+        header.dataSize         = fingerprint.dataSize;
+        header.keyHash          = hashKey(key);
+
+        std::vector<ArrayHeader> arrays;
+        std::vector<const u8*> arrayData;
+        u64 offset = sizeof(FileHeader) + writer.m_arrays.size() * sizeof(ArrayHeader);
+        for (const auto &array : writer.m_arrays) {
+            offset = (offset + ArrayAlignment - 1) / ArrayAlignment * ArrayAlignment;
+            arrays.push_back({ offset, array.data.size(), array.elementSize, 0 });
+            arrayData.push_back(reinterpret_cast<const u8*>(array.data.data()));
+            offset += array.data.size();
+        }
+        header.payloadHash = hashPayload(arrays, arrayData);
+
+        // Written next to the entry and renamed once complete, so nothing ever maps a half written file
+        const std::string temporaryPath = getTemporaryPath(path);
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                return false;
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(arrays.data()), arrays.size() * sizeof(ArrayHeader));
+
+            for (size_t i = 0; i < arrays.size(); i++) {
+                const std::vector<char> padding(arrays[i].offset - u64(file.tellp()), 0x00);
+                file.write(padding.data(), padding.size());
+                file.write(reinterpret_cast<const char*>(writer.m_arrays[i].data.data()), writer.m_arrays[i].data.size());
+            }
+
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(temporaryPath, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error) {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    void PersistentAnalysisCache::trim() {
+        struct CachedFile {
+            std::filesystem::path path;
+            std::filesystem::file_time_type lastUse;
+            u64 size;
+        };
+
+        std::error_code error;
+        std::vector<CachedFile> files;
+        u64 totalSize = 0;
+
+        for (const auto &entry : std::filesystem::directory_iterator(getDirectory(), error)) {
+            if (!entry.is_regular_file(error) || entry.path().extension() != ".hexcache")
+                continue;
+
+            files.push_back({ entry.path(), entry.last_write_time(error), entry.file_size(error) });
+            totalSize += files.back().size;
+        }
+
+        std::sort(files.begin(), files.end(), [](const CachedFile &left, const CachedFile &right) { return left.lastUse < right.lastUse; });
+
+        const u64 budget = PersistentAnalysisCache::s_budget;
+        for (const auto &file : files) {
+            if (totalSize <= budget)
+                break;
+
+            if (std::filesystem::remove(file.path, error))
+                totalSize -= file.size;
+        }
+    }
+
+    std::unique_ptr<PersistentAnalysisCache::Entry> PersistentAnalysisCache::load(const Fingerprint &fingerprint, const std::string &key) {
+        const auto path = getPath(fingerprint, key);
+
+        auto entry = mapFile(path, key);
+        if (entry == nullptr || entry->getFingerprint() != fingerprint)
+            return nullptr;
+
+        // Entries that get used stay around the longest
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+        return entry;
+    }
+
+    std::unique_ptr<PersistentAnalysisCache::Entry> PersistentAnalysisCache::mapFile(const std::string &path, const std::string &key) {
+        std::unique_ptr<Entry> entry(new Entry());
+
+        #if defined(OS_WINDOWS)
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                return nullptr;
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < LONGLONG(sizeof(FileHeader))) {
+                CloseHandle(file);
+                return nullptr;
+            }
+
+            // The view keeps the mapping alive on its own
+            HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (mapping == nullptr)
+                return nullptr;
+
+            entry->m_data = static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+            if (entry->m_data == nullptr)
+                return nullptr;
+
+            entry->m_size = fileSize.QuadPart;
+        #else
+            int file = open(path.c_str(), O_RDONLY);
+            if (file == -1)
+                return nullptr;
+
+            struct stat fileStats = { };
+            if (fstat(file, &fileStats) != 0 || size_t(fileStats.st_size) < sizeof(FileHeader)) {
+                close(file);
+                return nullptr;
+            }
+
+            // The mapping keeps the file alive on its own
+            void *data = mmap(nullptr, fileStats.st_size, PROT_READ, MAP_SHARED, file, 0);
+            close(file);
+            if (data == MAP_FAILED)
+                return nullptr;
+
+            entry->m_data = static_cast<const u8*>(data);
+            entry->m_size = fileStats.st_size;
+        #endif
+
+        FileHeader header;
+        std::memcpy(&header, entry->m_data, sizeof(header));
+
+        if (std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 || header.version != FileVersion)
+            return nullptr;
+        if (header.keyHash != hashKey(key))
+            return nullptr;
+        if (header.arrayCount > (entry->m_size - sizeof(FileHeader)) / sizeof(ArrayHeader))
+            return nullptr;
+
+        std::vector<ArrayHeader> arrays;
+        std::vector<const u8*> arrayData;
+        for (u32 i = 0; i < header.arrayCount; i++) {
+            ArrayHeader array;
+            std::memcpy(&array, entry->m_data + sizeof(FileHeader) + i * sizeof(ArrayHeader), sizeof(array));
+
+            if (array.offset % ArrayAlignment != 0 || array.offset > entry->m_size || array.size > entry->m_size - array.offset)
+                return nullptr;
+            if (array.elementSize == 0 || array.size % array.elementSize != 0)
+                return nullptr;
+
+            arrays.push_back(array);
+            arrayData.push_back(entry->m_data + array.offset);
+            entry->m_arrays.push_back({ array.offset, array.size, array.elementSize });
+        }
+
+        if (hashPayload(arrays, arrayData) != header.payloadHash)
+            return nullptr;
+
+        entry->m_fingerprint = { header.fingerprintHash, header.dataSize };
+
+        return entry;
+    }
+
+    PersistentAnalysisCache::Entry::~Entry() {
+        if (this->m_data == nullptr)
+            return;
+
+        #if defined(OS_WINDOWS)
+            UnmapViewOfFile(this->m_data);
+        #else
+            munmap(const_cast<u8*>(this->m_data), this->m_size);
+        #endif
+    }
+
+    void PersistentAnalysisCache::setBudget(u64 budget) {
+        PersistentAnalysisCache::s_budget = budget;
+    }
+
+    u64 PersistentAnalysisCache::getBudget() {
+        return PersistentAnalysisCache::s_budget;
+    }
+
+}
@@ -0,0 +1,279 @@
+#include "helpers/pointer_scanner.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/providers/snapshot.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+    #define POINTER_SCANNER_X86
+    #include <immintrin.h>
+#elif defined(__aarch64__)
+    #define POINTER_SCANNER_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace hex {
+
+    namespace {
+
+        constexpr size_t SliceSize = 0x40'0000;
+        constexpr size_t MaxPointers = 0x40'0000;
+
+        /*
+         * The kernels check count values of the array for (value - start) <= range, which wraps around for values below the start.
+         * They append the indices of all values in range to matches and return how many values they checked, the rest is left to the scalar loop
+         */
+
+        #if defined(POINTER_SCANNER_X86)
+
+            bool hasAVX2() {
+                #if defined(__GNUC__)
+                    static const bool supported = __builtin_cpu_supports("avx2");
+                    return supported;
+                #else
+                    return false;
+                #endif
+            }
+
+            __attribute__((target("avx2"))) size_t scanAVX2(const u8 *data, size_t count, bool swap, u32 start, u32 range, std::vector<size_t> &matches) {
+                const auto swapMask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+                const auto startVector = _mm256_set1_epi32(start), rangeVector = _mm256_set1_epi32(range);
+
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    auto values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 4));
+                    if (swap)
+                        values = _mm256_shuffle_epi8(values, swapMask);
+
+                    // Unsigned values are at most the range exactly if the range is their maximum
+                    const auto distance = _mm256_sub_epi32(values, startVector);
+                    const auto inRange = _mm256_cmpeq_epi32(_mm256_max_epu32(distance, rangeVector), rangeVector);
+
+                    for (u32 mask = _mm256_movemask_ps(_mm256_castsi256_ps(inRange)); mask != 0; mask &= mask - 1)
+                        matches.push_back(i + __builtin_ctz(mask));
+                }
+
+                return i;
+            }
+
+            __attribute__((target("avx2"))) size_t scanAVX2(const u8 *data, size_t count, bool swap, u64 start, u64 range, std::vector<size_t> &matches) {
+                const auto swapMask = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+                const auto startVector = _mm256_set1_epi64x(start);
+
+                // There's no unsigned 64 bit comparison, flipping the sign bits of both sides turns a signed one into it
+                const auto signBit = _mm256_set1_epi64x(0x8000'0000'0000'0000ULL);
+                const auto rangeVector = _mm256_xor_si256(_mm256_set1_epi64x(range), signBit);
+
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    auto values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 8));
+                    if (swap)
+                        values = _mm256_shuffle_epi8(values, swapMask);
+
+                    const auto distance = _mm256_xor_si256(_mm256_sub_epi64(values, startVector), signBit);
+                    const auto outOfRange = _mm256_cmpgt_epi64(distance, rangeVector);
+
+                    for (u32 mask = ~_mm256_movemask_pd(_mm256_castsi256_pd(outOfRange)) & 0xF; mask != 0; mask &= mask - 1)
+                        matches.push_back(i + __builtin_ctz(mask));
+                }
+
+                return i;
+            }
+
+            template<typename T>
+            size_t scanVectorized(const u8 *data, size_t count, bool swap, T start, T range, std::vector<size_t> &matches) {
+                return hasAVX2() ? scanAVX2(data, count, swap, start, range, matches) : 0;
+            }
+
+        #elif defined(POINTER_SCANNER_NEON)
+
+            template<typename T>
+            size_t scanVectorized(const u8 *data, size_t count, bool swap, T start, T range, std::vector<size_t> &matches) {
+                constexpr size_t Lanes = 16 / sizeof(T);
+
+                if constexpr (sizeof(T) == 4) {
+                    const auto startVector = vdupq_n_u32(start), rangeVector = vdupq_n_u32(range);
+
+                    size_t i = 0;
+                    for (; i + Lanes <= count; i += Lanes) {
+                        auto bytes = vld1q_u8(data + i * 4);
+                        if (swap)
+                            bytes = vrev32q_u8(bytes);
+
+                        const auto inRange = vcleq_u32(vsubq_u32(vreinterpretq_u32_u8(bytes), startVector), rangeVector);
+                        if (vmaxvq_u32(inRange) == 0)
+                            continue;
+
+                        std::array<u32, Lanes> lanes;
+                        vst1q_u32(lanes.data(), inRange);
+                        for (size_t lane = 0; lane < Lanes; lane++) {
+                            if (lanes[lane] != 0)
+                                matches.push_back(i + lane);
+                        }
+                    }
+
+                    return i;
+                } else {
+                    const auto startVector = vdupq_n_u64(start), rangeVector = vdupq_n_u64(range);
+
+                    size_t i = 0;
+                    for (; i + Lanes <= count; i += Lanes) {
+                        auto bytes = vld1q_u8(data + i * 8);
+                        if (swap)
+                            bytes = vrev64q_u8(bytes);
+
+                        const auto inRange = vcleq_u64(vsubq_u64(vreinterpretq_u64_u8(bytes), startVector), rangeVector);
+                        if (vgetq_lane_u64(inRange, 0) != 0)
+                            matches.push_back(i);
+                        if (vgetq_lane_u64(inRange, 1) != 0)
+                            matches.push_back(i + 1);
+                    }
+
+                    return i;
+                }
+            }
+
+        #else
+
+            template<typename T>
+            size_t scanVectorized(const u8 *, size_t, bool, T, T, std::vector<size_t> &) {
+                return 0;
+            }
+
+        #endif
+
+        template<typename T>
+        void scanValues(const u8 *data, size_t count, bool swap, T start, T range, std::vector<size_t> &matches) {
+            for (size_t i = scanVectorized<T>(data, count, swap, start, range, matches); i < count; i++) {
+                T value;
+                std::memcpy(&value, data + i * sizeof(T), sizeof(T));
+
+                if (swap)
+                    value = sizeof(T) == 4 ? __builtin_bswap32(value) : __builtin_bswap64(value);
+
+                if (T(value - start) <= range)
+                    matches.push_back(i);
+            }
+        }
+
+        template<typename T>
+        T readValue(const u8 *data, bool swap) {
+            T value;
+            std::memcpy(&value, data, sizeof(T));
+
+            if (swap)
+                value = sizeof(T) == 4 ? __builtin_bswap32(value) : __builtin_bswap64(value);
+
+            return value;
+        }
+
+        // Scans the offsets in [begin, end) of a slice whose data starts at sliceStart and reaches at least width - 1 bytes past the end
+        template<typename T>
+        void scanSlice(const u8 *data, u64 sliceStart, u64 begin, u64 end, const PointerScanSettings &settings, std::vector<FoundPointer> &pointers) {
+            const bool swap = settings.endian != std::endian::native;
+            const T start = settings.targetStart, range = settings.targetEnd - settings.targetStart;
+
+            // Every offset into a value that's a multiple of the alignment gets a pass of its own. Larger alignments skip some values of a single pass
+            const u64 stride = std::max<u64>(settings.alignment, sizeof(T));
+            const u64 phaseStep = std::min<u64>(settings.alignment, sizeof(T));
+
+            std::vector<size_t> matches;
+            for (u64 phase = 0; phase < sizeof(T); phase += phaseStep) {
+                // First offset at or after begin that's at this phase within a value and aligned
+                u64 first = begin + (phase + sizeof(T) - begin % sizeof(T)) % sizeof(T);
+                while (first % settings.alignment != 0 && first < end)
+                    first += sizeof(T);
+
+                if (first >= end)
+                    continue;
+
+                matches.clear();
+                const size_t count = (end - first + sizeof(T) - 1) / sizeof(T);
+                scanValues<T>(data + (first - sliceStart), count, swap, start, range, matches);
+
+                for (const size_t index : matches) {
+                    const u64 offset = first + index * sizeof(T);
+                    if (stride != sizeof(T) && (offset - first) % stride != 0)
+                        continue;
+
+                    pointers.push_back({ offset, readValue<T>(data + (offset - sliceStart), swap) });
+                }
+            }
+
+            if (phaseStep < sizeof(T))
+                std::sort(pointers.begin(), pointers.end(), [](const auto &left, const auto &right) { return left.offset < right.offset; });
+        }
+
+    }
+
+    std::optional<PointerScanResult> scanPointers(const prv::Snapshot &snapshot, const PointerScanSettings &settings, Task &task) {
+        PointerScanResult result;
+
+        const u64 width = settings.width;
+        if (settings.size < width || settings.targetEnd < settings.targetStart || (width != 4 && width != 8) || settings.alignment == 0)
+            return result;
+
+        // Offsets values may start at, the ones after can't hold a whole value anymore
+        const u64 endOffset = settings.address + settings.size - width + 1;
+        const size_t sliceCount = (endOffset - settings.address + SliceSize - 1) / SliceSize;
+
+        std::vector<std::vector<FoundPointer>> slicePointers(sliceCount);
+        std::vector<u8> sliceComplete(sliceCount, false);
+
+        std::atomic<size_t> doneSlices = 0, foundPointers = 0;
+        std::atomic<bool> readFailed = false;
+
+        TaskManager::parallelFor<std::vector<u8>>(task, sliceCount, [&](size_t slice, std::vector<u8> &buffer) {
+            if (readFailed || foundPointers >= MaxPointers)
+                return;
+
+            buffer.resize(SliceSize + width - 1);
+
+            const u64 begin = settings.address + slice * SliceSize;
+            const u64 end = std::min(begin + SliceSize, endOffset);
+
+            if (!snapshot.read(begin, buffer.data(), end - begin + width - 1)) {
+                readFailed = true;
+                return;
+            }
+
+            auto &pointers = slicePointers[slice];
+            if (width == 4)
+                scanSlice<u32>(buffer.data(), begin, begin, end, settings, pointers);
+            else
+                scanSlice<u64>(buffer.data(), begin, begin, end, settings, pointers);
+
+            foundPointers += pointers.size();
+            sliceComplete[slice] = true;
+
+            task.setProgress(float(++doneSlices) / sliceCount);
+        });
+
+        if (task.isCancelled() || readFailed)
+            return std::nullopt;
+
+        // Slices after the first one that got skipped are dropped as well, so the list stays complete up to its last pointer
+        result.pointers.reserve(std::min<size_t>(foundPointers, MaxPointers));
+        for (size_t slice = 0; slice < sliceCount; slice++) {
+            if (!sliceComplete[slice]) {
+                result.truncated = true;
+                break;
+            }
+
+            const auto &pointers = slicePointers[slice];
+            const size_t count = std::min(pointers.size(), MaxPointers - result.pointers.size());
+            result.pointers.insert(result.pointers.end(), pointers.begin(), pointers.begin() + count);
+
+            if (count < pointers.size()) {
+                result.truncated = true;
+                break;
+            }
+        }
+
+        return result;
+    }
+
+}
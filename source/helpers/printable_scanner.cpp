@@ -0,0 +1,333 @@
+#include "helpers/printable_scanner.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+    #define SCANNER_X86
+    #include <immintrin.h>
+#elif defined(__aarch64__)
+    #define SCANNER_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace hex {
+
+    constexpr static size_t BlockSize = 64;
+
+    // One bit per byte of a 64 byte block
+    struct ByteMasks {
+        u64 printable;  // 0x20 - 0x7E
+        u64 zero;       // 0x00
+        u64 lead;       // 0xC2 - 0xF4, bytes that may start a multi-byte UTF-8 sequence
+    };
+
+    using ClassifyFunction = ByteMasks(*)(const u8 *data);
+
+    static ByteMasks classifyScalar(const u8 *data) {
+        ByteMasks masks = { 0 };
+
+        for (u32 i = 0; i < BlockSize; i++) {
+            masks.printable |= u64(isPrintable(data[i])) << i;
+            masks.zero      |= u64(data[i] == 0x00) << i;
+            masks.lead      |= u64(data[i] >= 0xC2 && data[i] <= 0xF4) << i;
+        }
+
+        return masks;
+    }
+
+    #if defined(SCANNER_X86)
+
+    // Bytes are in range if clamping them to it doesn't change them
+    static u64 inRangeSSE2(__m128i bytes, u8 low, u8 high) {
+        auto clamped = _mm_min_epu8(_mm_max_epu8(bytes, _mm_set1_epi8(char(low))), _mm_set1_epi8(char(high)));
+        return u32(_mm_movemask_epi8(_mm_cmpeq_epi8(clamped, bytes)));
+    }
+
+    static ByteMasks classifySSE2(const u8 *data) {
+        ByteMasks masks = { 0 };
+
+        for (u32 i = 0; i < BlockSize; i += sizeof(__m128i)) {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+            masks.printable |= inRangeSSE2(bytes, 0x20, 0x7E) << i;
+            masks.zero      |= u64(u32(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128())))) << i;
+            masks.lead      |= inRangeSSE2(bytes, 0xC2, 0xF4) << i;
+        }
+
+        return masks;
+    }
+
+    __attribute__((target("avx2"))) static u64 inRangeAVX2(__m256i bytes, u8 low, u8 high) {
+        auto clamped = _mm256_min_epu8(_mm256_max_epu8(bytes, _mm256_set1_epi8(char(low))), _mm256_set1_epi8(char(high)));
+        return u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(clamped, bytes)));
+    }
+
+    __attribute__((target("avx2"))) static ByteMasks classifyAVX2(const u8 *data) {
+        ByteMasks masks = { 0 };
+
+        for (u32 i = 0; i < BlockSize; i += sizeof(__m256i)) {
+            auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+
+            masks.printable |= inRangeAVX2(bytes, 0x20, 0x7E) << i;
+            masks.zero      |= u64(u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_setzero_si256())))) << i;
+            masks.lead      |= inRangeAVX2(bytes, 0xC2, 0xF4) << i;
+        }
+
+        return masks;
+    }
+
+    #elif defined(SCANNER_NEON)
+
+    // NEON has no movemask, weighting every lane with its bit and adding up the halves gives the same result
+    static u64 toBitMask(uint8x16_t matches) {
+        const uint8x16_t weights = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        auto weighted = vandq_u8(matches, weights);
+
+        return u64(vaddv_u8(vget_low_u8(weighted))) | (u64(vaddv_u8(vget_high_u8(weighted))) << 8);
+    }
+
+    static ByteMasks classifyNEON(const u8 *data) {
+        ByteMasks masks = { 0 };
+
+        for (u32 i = 0; i < BlockSize; i += sizeof(uint8x16_t)) {
+            auto bytes = vld1q_u8(data + i);
+
+            masks.printable |= toBitMask(vandq_u8(vcgeq_u8(bytes, vdupq_n_u8(0x20)), vcleq_u8(bytes, vdupq_n_u8(0x7E)))) << i;
+            masks.zero      |= toBitMask(vceqq_u8(bytes, vdupq_n_u8(0x00))) << i;
+            masks.lead      |= toBitMask(vandq_u8(vcgeq_u8(bytes, vdupq_n_u8(0xC2)), vcleq_u8(bytes, vdupq_n_u8(0xF4)))) << i;
+        }
+
+        return masks;
+    }
+
+    #endif
+
+    static ClassifyFunction selectClassifier() {
+        #if defined(SCANNER_X86)
+            #if defined(__GNUC__)
+            if (__builtin_cpu_supports("avx2"))
+                return classifyAVX2;
+            #endif
+
+            return classifySSE2;
+        #elif defined(SCANNER_NEON)
+            return classifyNEON;
+        #else
+            return classifyScalar;
+        #endif
+    }
+
+    static ByteMasks classifyBlock(const u8 *data, size_t size) {
+        static const auto classify = selectClassifier();
+
+        if (size >= BlockSize)
+            return classify(data);
+
+        // Bytes past the end are padded with zeros, callers mask them out
+        std::array<u8, BlockSize> padded = { 0 };
+        std::memcpy(padded.data(), data, size);
+
+        return classify(padded.data());
+    }
+
+    static u64 lowBits(size_t count) {
+        return count >= 64 ? ~u64(0) : (u64(1) << count) - 1;
+    }
+
+    // Bits are set at the first byte of every printable character
+    static u64 getCharacterMask(const ByteMasks &masks, StringEncoding encoding) {
+        switch (encoding) {
+            case StringEncoding::UTF16LE:
+                return masks.printable & (masks.zero >> 1) & 0x5555'5555'5555'5555;
+            case StringEncoding::UTF16BE:
+                return (masks.printable >> 1) & masks.zero & 0x5555'5555'5555'5555;
+            case StringEncoding::UTF32LE:
+                return masks.printable & (masks.zero >> 1) & (masks.zero >> 2) & (masks.zero >> 3) & 0x1111'1111'1111'1111;
+            case StringEncoding::UTF32BE:
+                return masks.zero & (masks.zero >> 1) & (masks.zero >> 2) & (masks.printable >> 3) & 0x1111'1111'1111'1111;
+            default:
+                return masks.printable;
+        }
+    }
+
+    static u64 getCharacterPositions(StringEncoding encoding) {
+        switch (getCharacterSize(encoding)) {
+            case 2:  return 0x5555'5555'5555'5555;
+            case 4:  return 0x1111'1111'1111'1111;
+            default: return ~u64(0);
+        }
+    }
+
+    // Returns the length of the printable multi-byte UTF-8 sequence at data or zero if there is none
+    static size_t getSequenceLength(const u8 *data, size_t size) {
+        size_t length;
+        u32 codePoint;
+
+        if (data[0] >= 0xC2 && data[0] <= 0xDF) {
+            length = 2;
+            codePoint = data[0] & 0x1F;
+        } else if (data[0] >= 0xE0 && data[0] <= 0xEF) {
+            length = 3;
+            codePoint = data[0] & 0x0F;
+        } else if (data[0] >= 0xF0 && data[0] <= 0xF4) {
+            length = 4;
+            codePoint = data[0] & 0x07;
+        } else
+            return 0;
+
+        if (size < length)
+            return 0;
+
+        for (size_t i = 1; i < length; i++) {
+            if ((data[i] & 0xC0) != 0x80)
+                return 0;
+
+            codePoint = (codePoint << 6) | (data[i] & 0x3F);
+        }
+
+        // Reject overlong encodings, surrogates, code points past U+10FFFF and the C1 control characters
+        if ((length == 3 && codePoint < 0x800) || (length == 4 && (codePoint < 0x10000 || codePoint > 0x10FFFF)))
+            return 0;
+        if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint < 0xA0)
+            return 0;
+
+        return length;
+    }
+
+    static size_t findFixedWidth(const u8 *data, size_t size, StringEncoding encoding, bool printable) {
+        const size_t characterSize = getCharacterSize(encoding);
+
+        for (size_t offset = 0; offset < size; offset += BlockSize) {
+            const size_t remaining = size - offset;
+            auto masks = classifyBlock(data + offset, remaining);
+
+            // Characters cut off by the end of the data are never printable
+            u64 characters = getCharacterMask(masks, encoding) & lowBits(remaining >= characterSize ? remaining - characterSize + 1 : 0);
+            u64 matches = (printable ? characters : ~characters) & getCharacterPositions(encoding) & lowBits(remaining);
+
+            if (matches != 0)
+                return offset + std::countr_zero(matches);
+        }
+
+        return size;
+    }
+
+    size_t getCharacterSize(StringEncoding encoding) {
+        switch (encoding) {
+            case StringEncoding::UTF16LE:
+            case StringEncoding::UTF16BE:
+                return 2;
+            case StringEncoding::UTF32LE:
+            case StringEncoding::UTF32BE:
+                return 4;
+            default:
+                return 1;
+        }
+    }
+
+    size_t getMaxCharacterLength(StringEncoding encoding) {
+        return encoding == StringEncoding::UTF8 ? 4 : getCharacterSize(encoding);
+    }
+
+    size_t findPrintable(const u8 *data, size_t size, StringEncoding encoding) {
+        if (encoding != StringEncoding::UTF8)
+            return findFixedWidth(data, size, encoding, true);
+
+        size_t i = 0;
+        while (i < size) {
+            const size_t remaining = size - i;
+            auto masks = classifyBlock(data + i, remaining);
+
+            u64 candidates = (masks.printable | masks.lead) & lowBits(remaining);
+            if (candidates == 0) {
+                i += BlockSize;
+                continue;
+            }
+
+            i += std::countr_zero(candidates);
+            if (isPrintable(data[i]) || getSequenceLength(data + i, size - i) != 0)
+                return i;
+
+            i++;
+        }
+
+        return size;
+    }
+
+    size_t findNonPrintable(const u8 *data, size_t size, StringEncoding encoding) {
+        if (encoding != StringEncoding::UTF8)
+            return findFixedWidth(data, size, encoding, false);
+
+        size_t i = 0;
+        while (i < size) {
+            const size_t remaining = size - i;
+            auto masks = classifyBlock(data + i, remaining);
+
+            // ASCII gets skipped a block at a time, only multi-byte sequences are validated one by one
+            u64 nonPrintable = ~masks.printable & lowBits(remaining);
+            if (nonPrintable == 0) {
+                i += BlockSize;
+                continue;
+            }
+
+            i += std::countr_zero(nonPrintable);
+
+            size_t length = getSequenceLength(data + i, size - i);
+            if (length == 0)
+                return i;
+
+            i += length;
+        }
+
+        return size;
+    }
+
+    bool endsWithPrintable(const u8 *data, size_t size, StringEncoding encoding) {
+        if (encoding != StringEncoding::UTF8) {
+            const size_t characterSize = getCharacterSize(encoding);
+            return size >= characterSize && findNonPrintable(data + size - characterSize, characterSize, encoding) == characterSize;
+        }
+
+        for (size_t length = 1; length <= std::min<size_t>(size, 4); length++) {
+            const u8 *character = data + size - length;
+
+            if (length == 1 ? isPrintable(character[0]) : getSequenceLength(character, length) == length)
+                return true;
+        }
+
+        return false;
+    }
+
+    size_t getCharacterCount(const u8 *data, size_t size, StringEncoding encoding) {
+        if (encoding != StringEncoding::UTF8)
+            return size / getCharacterSize(encoding);
+
+        size_t count = 0;
+        for (size_t i = 0; i < size; i++) {
+            if ((data[i] & 0xC0) != 0x80)
+                count++;
+        }
+
+        return count;
+    }
+
+    std::string decodeString(const u8 *data, size_t size, StringEncoding encoding) {
+        const size_t characterSize = getCharacterSize(encoding);
+        if (characterSize == 1)
+            return std::string(reinterpret_cast<const char*>(data), size);
+
+        // Wide encodings only ever match ASCII code points, so their low byte is all there is to the character
+        const size_t lowByte = (encoding == StringEncoding::UTF16BE || encoding == StringEncoding::UTF32BE) ? characterSize - 1 : 0;
+
+        std::string result;
+        result.reserve(size / characterSize);
+        for (size_t i = 0; i + characterSize <= size; i += characterSize)
+            result.push_back(char(data[i + lowByte]));
+
+        return result;
+    }
+
+}
@@ -1,26 +1,77 @@
 #include "helpers/project_file_handler.hpp"
 
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <optional>
+#include <vector>
 #include <nlohmann/json.hpp>
 
+#include <zlib.h>
+
 using json = nlohmann::json;
 
 namespace hex {
 
+    constexpr static char PatchFileMagic[8] = { 'H', 'E', 'X', 'P', 'A', 'T', 'C', 'H' };
+    constexpr static u32 PatchFileVersion = 1;
+
+    /*
+     * The header is followed by the run index and the zlib compressed contents of all runs back to back.
+     * Every run is indexed as its distance to the end of the run before it and its size, both LEB128 encoded,
+     * so loading and storing scales with the number of runs rather than with the number of patched bytes.
+     */
+    struct PatchFileHeader {
+        char magic[8];
+        u32 version;
+        u32 reserved;
+        u64 runCount;
+        u64 indexSize;
+        u64 dataSize;
+        u64 compressedSize;
+    };
+
+    static void writeLEB128(std::vector<u8> &buffer, u64 value) {
+        do {
+            u8 byte = value & 0x7F;
+            value >>= 7;
+            if (value != 0)
+                byte |= 0x80;
+
+            buffer.push_back(byte);
+        } while (value != 0);
+    }
+
+    static std::optional<u64> readLEB128(const std::vector<u8> &buffer, size_t &offset) {
+        u64 value = 0;
+
+        for (u32 shift = 0; shift < 64; shift += 7) {
+            if (offset >= buffer.size())
+                return { };
+
+            const u8 byte = buffer[offset++];
+            value |= u64(byte & 0x7F) << shift;
+
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+
+        return { };
+    }
+
+    static std::string getPatchFilePath(const std::string &projectFilePath) {
+        return std::filesystem::path(projectFilePath).replace_extension(".hexpatch").string();
+    }
+
     void to_json(json& j, const ImHexApi::Bookmarks::Entry& b) {
-        j = json{ { "address", b.region.address }, { "size", b.region.size }, { "name", b.name.data() }, { "comment", b.comment.data() } };
+        j = json{ { "address", b.region.address }, { "size", b.region.size }, { "name", b.name }, { "comment", b.comment } };
     }
 
     void from_json(const json& j, ImHexApi::Bookmarks::Entry& b) {
-        std::string name, comment;
-
         j.at("address").get_to(b.region.address);
         j.at("size").get_to(b.region.size);
-        j.at("name").get_to(name);
-        j.at("comment").get_to(comment);
-
-        std::copy(name.begin(), name.end(), std::back_inserter(b.name));
-        std::copy(comment.begin(), comment.end(), std::back_inserter(b.comment));
+        j.at("name").get_to(b.name);
+        j.at("comment").get_to(b.comment);
     }
 
 
@@ -35,7 +86,26 @@ namespace hex {
 
             ProjectFile::s_filePath = projectFileData["filePath"];
             ProjectFile::s_pattern  = projectFileData["pattern"];
-            ProjectFile::s_patches  = projectFileData["patches"].get<Patches>();
+            ProjectFile::s_patches.clear();
+
+            if (projectFileData.contains("patchFile")) {
+                auto patchFilePath = std::filesystem::path(filePath).parent_path() / projectFileData["patchFile"].get<std::string>();
+                if (!ProjectFile::loadPatchFile(patchFilePath.string()))
+                    return false;
+            } else if (projectFileData.contains("patches")) {
+                // Projects stored by older versions keep every patched byte in the JSON itself
+                for (const auto &[address, value] : projectFileData["patches"].get<Patches>()) {
+                    if (!ProjectFile::s_patches.empty()) {
+                        auto &[lastAddress, lastRun] = *ProjectFile::s_patches.rbegin();
+                        if (lastAddress + lastRun.size() == address) {
+                            lastRun.modify().push_back(value);
+                            continue;
+                        }
+                    }
+
+                    ProjectFile::s_patches.emplace_hint(ProjectFile::s_patches.end(), address, std::vector<u8>{ value });
+                }
+            }
 
             for (auto &element : projectFileData["bookmarks"].items()) {
                 ProjectFile::s_bookmarks.push_back(element.value().get<ImHexApi::Bookmarks::Entry>());
@@ -63,7 +133,14 @@ namespace hex {
         try {
             projectFileData["filePath"] = ProjectFile::s_filePath;
             projectFileData["pattern"]  = ProjectFile::s_pattern;
-            projectFileData["patches"]  = ProjectFile::s_patches;
+
+            if (!ProjectFile::s_patches.empty()) {
+                auto patchFilePath = getPatchFilePath(std::string(filePath));
+                if (!ProjectFile::storePatchFile(patchFilePath))
+                    return false;
+
+                projectFileData["patchFile"] = std::filesystem::path(patchFilePath).filename().string();
+            }
 
             for (auto &bookmark : ProjectFile::s_bookmarks) {
                 projectFileData["bookmarks"].push_back(bookmark);
@@ -82,4 +159,93 @@ namespace hex {
         return true;
     }
 
-}
\ No newline at end of file
+
+    bool ProjectFile::loadPatchFile(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        PatchFileHeader header = { };
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file.good() || std::memcmp(header.magic, PatchFileMagic, sizeof(PatchFileMagic)) != 0 || header.version != PatchFileVersion)
+            return false;
+
+        std::error_code error;
+        const u64 fileSize = std::filesystem::file_size(path, error);
+        if (error || header.indexSize > fileSize || header.compressedSize > fileSize - header.indexSize)
+            return false;
+
+        // Deflate can't expand data by more than a factor of 1032, so anything larger is a corrupt header and mustn't be allocated
+        if (header.dataSize > header.compressedSize * 1032)
+            return false;
+
+        std::vector<u8> index(header.indexSize);
+        std::vector<u8> compressed(header.compressedSize);
+        file.read(reinterpret_cast<char*>(index.data()), index.size());
+        file.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+
+        if (!file.good())
+            return false;
+
+        std::vector<u8> data(header.dataSize);
+        uLongf dataSize = data.size();
+        if (uncompress(data.data(), &dataSize, compressed.data(), compressed.size()) != Z_OK || dataSize != data.size())
+            return false;
+
+        size_t indexOffset = 0, dataOffset = 0;
+        u64 address = 0;
+        for (u64 run = 0; run < header.runCount; run++) {
+            auto distance = readLEB128(index, indexOffset);
+            auto size     = readLEB128(index, indexOffset);
+
+            if (!distance.has_value() || !size.has_value() || *size > data.size() - dataOffset)
+                return false;
+
+            address += *distance;
+            ProjectFile::s_patches.emplace_hint(ProjectFile::s_patches.end(), address, std::vector<u8>(data.begin() + dataOffset, data.begin() + dataOffset + *size));
+
+            address += *size;
+            dataOffset += *size;
+        }
+
+        return true;
+    }
+
+    bool ProjectFile::storePatchFile(const std::string &path) {
+        std::vector<u8> index, data;
+
+        u64 previousEnd = 0;
+        for (const auto &[address, run] : ProjectFile::s_patches) {
+            writeLEB128(index, address - previousEnd);
+            writeLEB128(index, run.size());
+            data.insert(data.end(), run.begin(), run.end());
+
+            previousEnd = address + run.size();
+        }
+
+        std::vector<u8> compressed(compressBound(data.size()));
+        uLongf compressedSize = compressed.size();
+        if (compress2(compressed.data(), &compressedSize, data.data(), data.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+            return false;
+
+        PatchFileHeader header = { };
+        std::memcpy(header.magic, PatchFileMagic, sizeof(PatchFileMagic));
+        header.version          = PatchFileVersion;
+        header.runCount         = ProjectFile::s_patches.size();
+        header.indexSize        = index.size();
+        header.dataSize         = data.size();
+        header.compressedSize   = compressedSize;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(index.data()), index.size());
+        file.write(reinterpret_cast<const char*>(compressed.data()), compressedSize);
+
+        return file.good();
+    }
+
+}
@@ -0,0 +1,489 @@
+#include "helpers/project_journal.hpp"
+
+#include <hex/helpers/trace.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include <zlib.h>
+
+#if defined(OS_WINDOWS)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace hex {
+
+    namespace {
+
+        constexpr char JournalMagic[8] = { 'H', 'E', 'X', 'J', 'R', 'N', 'L', 0 };
+        constexpr u32 JournalVersion = 1;
+
+        struct JournalHeader {
+            char magic[8];
+            u32 version;
+            u32 reserved;
+            u64 dataSize;
+        };
+
+        /*
+         * Every record is its type, the size of its payload and a CRC32 of both followed by the payload.
+         * Patch records hold the replaced range and the runs in it afterwards, bookmark records all bookmarks. Numbers are LEB128 encoded
+         */
+        enum class RecordType : u8 {
+            Patches = 1,
+            Bookmarks = 2
+        };
+
+        struct RecordHeader {
+            u8 type;
+            u8 reserved[3];
+            u32 size;
+            u32 checksum;
+        };
+
+        void writeLEB128(std::vector<u8> &buffer, u64 value) {
+            do {
+                u8 byte = value & 0x7F;
+                value >>= 7;
+                if (value != 0)
+                    byte |= 0x80;
+
+                buffer.push_back(byte);
+            } while (value != 0);
+        }
+
+        std::optional<u64> readLEB128(const u8 *buffer, size_t size, size_t &offset) {
+            u64 value = 0;
+
+            for (u32 shift = 0; shift < 64; shift += 7) {
+                if (offset >= size)
+                    return { };
+
+                const u8 byte = buffer[offset++];
+                value |= u64(byte & 0x7F) << shift;
+
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+
+            return { };
+        }
+
+        void writeBytes(std::vector<u8> &buffer, const void *data, size_t size) {
+            auto bytes = reinterpret_cast<const u8*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        }
+
+        u32 getChecksum(const RecordHeader &header, const u8 *payload) {
+            auto checksum = crc32(0, reinterpret_cast<const Bytef*>(&header), offsetof(RecordHeader, checksum));
+            return crc32(checksum, payload, header.size);
+        }
+
+        std::vector<u8> createRecord(RecordType type, const std::vector<u8> &payload) {
+            RecordHeader header = { };
+            header.type = u8(type);
+            header.size = payload.size();
+            header.checksum = getChecksum(header, payload.data());
+
+            std::vector<u8> record;
+            record.reserve(sizeof(header) + payload.size());
+            writeBytes(record, &header, sizeof(header));
+            writeBytes(record, payload.data(), payload.size());
+
+            return record;
+        }
+
+        template<typename Iterator>
+        std::vector<u8> createPatchRecord(u64 address, u64 size, Iterator begin, Iterator end) {
+            std::vector<u8> payload;
+
+            writeLEB128(payload, address);
+            writeLEB128(payload, size);
+            writeLEB128(payload, std::distance(begin, end));
+
+            for (auto it = begin; it != end; it++) {
+                const auto &[runAddress, run] = *it;
+
+                writeLEB128(payload, runAddress - address);
+                writeLEB128(payload, run.size());
+                writeBytes(payload, run.data(), run.size());
+            }
+
+            return createRecord(RecordType::Patches, payload);
+        }
+
+        std::vector<u8> createBookmarkRecord(const ProjectJournal::Bookmarks &bookmarks) {
+            std::vector<u8> payload;
+
+            writeLEB128(payload, bookmarks.size());
+            for (const auto &bookmark : bookmarks) {
+                writeLEB128(payload, bookmark.region.address);
+                writeLEB128(payload, bookmark.region.size);
+                writeLEB128(payload, bookmark.color);
+                writeLEB128(payload, bookmark.name.size());
+                writeBytes(payload, bookmark.name.data(), bookmark.name.size());
+                writeLEB128(payload, bookmark.comment.size());
+                writeBytes(payload, bookmark.comment.data(), bookmark.comment.size());
+            }
+
+            return createRecord(RecordType::Bookmarks, payload);
+        }
+
+        // Applies a patch record to the patches recovered so far, false if it's malformed
+        bool replayPatches(prv::PatchStore &patches, const u8 *payload, size_t size) {
+            size_t offset = 0;
+            auto address  = readLEB128(payload, size, offset);
+            auto range    = readLEB128(payload, size, offset);
+            auto runCount = readLEB128(payload, size, offset);
+            if (!address.has_value() || !range.has_value() || !runCount.has_value())
+                return false;
+
+            std::vector<prv::PatchStore::Run> runs;
+            for (u64 i = 0; i < *runCount; i++) {
+                auto distance = readLEB128(payload, size, offset);
+                auto runSize  = readLEB128(payload, size, offset);
+                if (!distance.has_value() || !runSize.has_value() || *runSize > size - offset)
+                    return false;
+
+                runs.emplace_back(*address + *distance, std::vector<u8>(payload + offset, payload + offset + *runSize));
+                offset += *runSize;
+            }
+
+            if (*range == prv::PatchStore::EntireAddressSpace)
+                patches.clear();
+            else
+                patches.erase(*address, *range);
+
+            patches.write(runs);
+
+            return true;
+        }
+
+        bool replayBookmarks(ProjectJournal::Bookmarks &bookmarks, const u8 *payload, size_t size) {
+            size_t offset = 0;
+
+            auto readString = [&](std::string &string) {
+                auto length = readLEB128(payload, size, offset);
+                if (!length.has_value() || *length > size - offset)
+                    return false;
+
+                string.assign(reinterpret_cast<const char*>(payload + offset), *length);
+                offset += *length;
+
+                return true;
+            };
+
+            auto count = readLEB128(payload, size, offset);
+            if (!count.has_value())
+                return false;
+
+            ProjectJournal::Bookmarks result;
+            for (u64 i = 0; i < *count; i++) {
+                ImHexApi::Bookmarks::Entry bookmark;
+
+                auto address = readLEB128(payload, size, offset);
+                auto length  = readLEB128(payload, size, offset);
+                auto color   = readLEB128(payload, size, offset);
+                if (!address.has_value() || !length.has_value() || !color.has_value())
+                    return false;
+
+                bookmark.region = { *address, *length };
+                bookmark.color  = *color;
+
+                if (!readString(bookmark.name) || !readString(bookmark.comment))
+                    return false;
+
+                result.push_back(std::move(bookmark));
+            }
+
+            bookmarks = std::move(result);
+
+            return true;
+        }
+
+        void syncFile(FILE *file) {
+            #if defined(OS_WINDOWS)
+            _commit(_fileno(file));
+            #else
+            fsync(fileno(file));
+            #endif
+        }
+
+    }
+
+    ProjectJournal::ProjectJournal(std::string path) : m_path(std::move(path)) {
+
+    }
+
+    std::shared_ptr<ProjectJournal> ProjectJournal::create(const std::string &path, u64 dataSize, const prv::PatchStore::Runs &patches, const Bookmarks &bookmarks) {
+        std::shared_ptr<ProjectJournal> journal(new ProjectJournal(path));
+
+        // The initial state is written right away, a journal that can't be written is no journal at all
+        auto contents = createJournal(dataSize, patches, bookmarks);
+
+        journal->m_file = fopen(path.c_str(), "wb");
+        if (journal->m_file == nullptr)
+            return nullptr;
+
+        if (fwrite(contents.data(), 1, contents.size(), journal->m_file) != contents.size() || fflush(journal->m_file) != 0) {
+            fclose(journal->m_file);
+            journal->m_file = nullptr;
+
+            std::error_code error;
+            std::filesystem::remove(path, error);
+
+            return nullptr;
+        }
+
+        syncFile(journal->m_file);
+
+        journal->m_size = contents.size();
+        journal->m_writer = std::thread([journal = journal.get()] { journal->writerLoop(); });
+
+        return journal;
+    }
+
+    ProjectJournal::~ProjectJournal() {
+        {
+            std::scoped_lock lock(this->m_mutex);
+            this->m_stopping = true;
+        }
+
+        this->m_wakeUp.notify_all();
+
+        if (this->m_writer.joinable())
+            this->m_writer.join();
+    }
+
+    std::vector<u8> ProjectJournal::createJournal(u64 dataSize, const prv::PatchStore::Runs &patches, const Bookmarks &bookmarks) {
+        JournalHeader header = { };
+        std::memcpy(header.magic, JournalMagic, sizeof(JournalMagic));
+        header.version = JournalVersion;
+        header.dataSize = dataSize;
+
+        std::vector<u8> contents;
+        writeBytes(contents, &header, sizeof(header));
+
+        auto patchRecord = createPatchRecord(0, prv::PatchStore::EntireAddressSpace, patches.begin(), patches.end());
+        auto bookmarkRecord = createBookmarkRecord(bookmarks);
+        contents.insert(contents.end(), patchRecord.begin(), patchRecord.end());
+        contents.insert(contents.end(), bookmarkRecord.begin(), bookmarkRecord.end());
+
+        return contents;
+    }
+
+    void ProjectJournal::appendPatches(u64 address, u64 size, const std::vector<prv::PatchStore::Run> &runs) {
+        this->append(createPatchRecord(address, size, runs.begin(), runs.end()));
+    }
+
+    void ProjectJournal::appendBookmarks(const Bookmarks &bookmarks) {
+        this->append(createBookmarkRecord(bookmarks));
+    }
+
+    void ProjectJournal::append(std::vector<u8> record) {
+        {
+            std::scoped_lock lock(this->m_mutex);
+            if (this->m_discarded)
+                return;
+
+            this->m_pending.insert(this->m_pending.end(), record.begin(), record.end());
+            this->m_size += record.size();
+        }
+
+        // The writer wakes up on its own once the batch interval passed
+    }
+
+    void ProjectJournal::reset(u64 dataSize, const prv::PatchStore::Runs &patches, const Bookmarks &bookmarks) {
+        auto contents = createJournal(dataSize, patches, bookmarks);
+
+        {
+            std::scoped_lock lock(this->m_mutex);
+            if (this->m_discarded)
+                return;
+
+            // Records that weren't written yet describe changes the new state already contains
+            this->m_pending.clear();
+            this->m_size = contents.size();
+            this->m_restart = std::move(contents);
+        }
+
+        this->m_wakeUp.notify_all();
+    }
+
+    void ProjectJournal::discard() {
+        {
+            std::scoped_lock lock(this->m_mutex);
+
+            this->m_discarded = true;
+            this->m_pending.clear();
+            this->m_restart.reset();
+        }
+
+        this->m_wakeUp.notify_all();
+    }
+
+    u64 ProjectJournal::getSize() const {
+        std::scoped_lock lock(this->m_mutex);
+
+        return this->m_size;
+    }
+
+    void ProjectJournal::writerLoop() {
+        trace::setThreadName("Project journal");
+
+        auto lastSync = std::chrono::steady_clock::now();
+        bool unsynced = false;
+
+        while (true) {
+            std::vector<u8> pending;
+            std::optional<std::vector<u8>> restart;
+            bool stopping, discarded;
+
+            {
+                std::unique_lock lock(this->m_mutex);
+                this->m_wakeUp.wait_for(lock, BatchInterval, [this] { return this->m_stopping || this->m_discarded || this->m_restart.has_value(); });
+
+                std::swap(pending, this->m_pending);
+                std::swap(restart, this->m_restart);
+                stopping = this->m_stopping;
+                discarded = this->m_discarded;
+            }
+
+            if (discarded) {
+                if (this->m_file != nullptr)
+                    fclose(this->m_file);
+                this->m_file = nullptr;
+
+                std::error_code error;
+                std::filesystem::remove(this->m_path, error);
+
+                return;
+            }
+
+            if (restart.has_value() && !this->startOver(*restart)) {
+                // The old journal still describes everything up to the restart, the new state appended to it as records replaces all of that.
+                // Its header may tell a different data size than the new state's, recovering it fails then instead of restoring a wrong state
+                std::fprintf(stderr, "error: failed to start over the project journal '%s', appending to it instead\n", this->m_path.c_str());
+                pending.insert(pending.begin(), restart->begin() + sizeof(JournalHeader), restart->end());
+            }
+
+            if (this->m_file != nullptr && !pending.empty()) {
+                fwrite(pending.data(), 1, pending.size(), this->m_file);
+
+                // Flushed data survives ImHex crashing, syncing it only matters if the whole system goes down, so it's done less often
+                fflush(this->m_file);
+                unsynced = true;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (this->m_file != nullptr && unsynced && (stopping || restart.has_value() || now - lastSync >= SyncInterval)) {
+                syncFile(this->m_file);
+
+                lastSync = now;
+                unsynced = false;
+            }
+
+            if (stopping) {
+                if (this->m_file != nullptr)
+                    fclose(this->m_file);
+                this->m_file = nullptr;
+
+                return;
+            }
+        }
+    }
+
+    bool ProjectJournal::startOver(const std::vector<u8> &contents) {
+        // The new journal only replaces the old one once it's completely on disk, so there's a valid journal no matter when things go down
+        const auto tempPath = this->m_path + ".tmp";
+
+        FILE *file = fopen(tempPath.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size() && fflush(file) == 0;
+        if (written)
+            syncFile(file);
+        written = fclose(file) == 0 && written;
+
+        std::error_code error;
+        if (written) {
+            // Files that are still open can't be replaced everywhere
+            if (this->m_file != nullptr)
+                fclose(this->m_file);
+
+            std::filesystem::rename(tempPath, this->m_path, error);
+            this->m_file = fopen(this->m_path.c_str(), "ab");
+
+            if (!error)
+                return true;
+        }
+
+        std::filesystem::remove(tempPath, error);
+
+        return false;
+    }
+
+    std::optional<ProjectJournal::Recovery> ProjectJournal::recover(const std::string &path, u64 dataSize) {
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return { };
+
+        std::vector<u8> contents;
+        {
+            std::error_code error;
+            const auto fileSize = std::filesystem::file_size(path, error);
+            if (!error) {
+                contents.resize(fileSize);
+                contents.resize(fread(contents.data(), 1, contents.size(), file));
+            }
+
+            fclose(file);
+        }
+
+        JournalHeader header = { };
+        if (contents.size() < sizeof(header))
+            return { };
+
+        std::memcpy(&header, contents.data(), sizeof(header));
+        if (std::memcmp(header.magic, JournalMagic, sizeof(JournalMagic)) != 0 || header.version != JournalVersion || header.dataSize != dataSize)
+            return { };
+
+        Recovery recovery;
+        prv::PatchStore patches;
+
+        size_t offset = sizeof(header);
+        while (contents.size() - offset >= sizeof(RecordHeader)) {
+            RecordHeader record = { };
+            std::memcpy(&record, contents.data() + offset, sizeof(record));
+
+            const u8 *payload = contents.data() + offset + sizeof(record);
+            if (record.size > contents.size() - offset - sizeof(record) || getChecksum(record, payload) != record.checksum)
+                break;
+
+            bool valid = false;
+            switch (RecordType(record.type)) {
+                case RecordType::Patches:
+                    valid = replayPatches(patches, payload, record.size);
+                    break;
+                case RecordType::Bookmarks:
+                    valid = replayBookmarks(recovery.bookmarks, payload, record.size);
+                    break;
+            }
+
+            if (!valid)
+                break;
+
+            recovery.recordCount++;
+            offset += sizeof(record) + record.size;
+        }
+
+        recovery.patches = patches.getRuns();
+
+        return recovery;
+    }
+
+}
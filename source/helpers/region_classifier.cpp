@@ -0,0 +1,99 @@
+#include "helpers/region_classifier.hpp"
+
+#include <algorithm>
+
+namespace hex {
+
+    // Fraction of bytes from which on a block counts as text
+    constexpr static double TextThreshold = 0.95;
+    // Entropy from which on a block is either compressed or encrypted
+    constexpr static float HighEntropyThreshold = 0.9F;
+    // Uniform data stays below this chi-square value for 255 degrees of freedom in all but about one in a thousand blocks
+    constexpr static double UniformChiSquareLimit = 330.0;
+
+    RegionClass classifyBlock(const std::array<u64, 256> &valueCounts, u64 numBytes, float entropy) {
+        if (numBytes == 0)
+            return RegionClass::Data;
+
+        const u64 zeros = valueCounts[0x00];
+        if (zeros == numBytes)
+            return RegionClass::Zero;
+
+        u64 printable = valueCounts['\t'] + valueCounts['\n'] + valueCounts['\r'];
+        for (u16 value = 0x20; value < 0x7F; value++)
+            printable += valueCounts[value];
+
+        // UTF-16 text has a zero byte next to every ASCII character
+        if (printable >= numBytes * TextThreshold || (printable + zeros >= numBytes * TextThreshold && printable >= numBytes * 0.4))
+            return RegionClass::Text;
+
+        if (entropy >= HighEntropyThreshold)
+            return isUniformlyDistributed(valueCounts, numBytes) ? RegionClass::Encrypted : RegionClass::Compressed;
+
+        const double zeroShare = double(zeros) / numBytes;
+        const double printableShare = double(printable) / numBytes;
+        if (entropy >= 0.55F && zeroShare >= 0.02 && zeroShare <= 0.4 && printableShare < 0.8)
+            return RegionClass::Code;
+
+        return RegionClass::Data;
+    }
+
+    bool isUniformlyDistributed(const std::array<u64, 256> &valueCounts, u64 numBytes) {
+        const double expected = double(numBytes) / 256;
+
+        double chiSquare = 0;
+        for (u16 value = 0; value < 256; value++) {
+            const double difference = double(valueCounts[value]) - expected;
+            chiSquare += difference * difference / expected;
+        }
+
+        return chiSquare < UniformChiSquareLimit;
+    }
+
+    std::vector<ClassifiedRegion> segmentRegions(const std::vector<RegionClass> &blockClasses, u64 blockSize, u64 dataSize, u64 minimumBlocks) {
+        std::vector<ClassifiedRegion> regions;
+
+        for (u64 block = 0; block < blockClasses.size(); ) {
+            const RegionClass type = blockClasses[block];
+
+            u64 end = block + 1;
+            while (end < blockClasses.size() && blockClasses[end] == type)
+                end++;
+
+            const u64 address = block * blockSize;
+            const u64 size = std::min(end * blockSize, dataSize) - std::min(address, dataSize);
+
+            if (!regions.empty() && (end - block < minimumBlocks || regions.back().type == type))
+                regions.back().size += size;
+            else if (size > 0)
+                regions.push_back({ address, size, type });
+
+            block = end;
+        }
+
+        return regions;
+    }
+
+    const char* getRegionClassName(RegionClass type) {
+        switch (type) {
+            case RegionClass::Zero:         return "Zero fill";
+            case RegionClass::Text:         return "Text";
+            case RegionClass::Code:         return "Code";
+            case RegionClass::Compressed:   return "Compressed";
+            case RegionClass::Encrypted:    return "Encrypted";
+            default:                        return "Data";
+        }
+    }
+
+    u32 getRegionClassColor(RegionClass type) {
+        switch (type) {
+            case RegionClass::Zero:         return 0xFF808080;
+            case RegionClass::Text:         return 0xFF4DC69B;
+            case RegionClass::Code:         return 0xFFE0A040;
+            case RegionClass::Compressed:   return 0xFF2090E0;
+            case RegionClass::Encrypted:    return 0xFF3030E0;
+            default:                        return 0xFF505050;
+        }
+    }
+
+}
@@ -0,0 +1,200 @@
+#include "helpers/region_operations.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+    #define REGION_OPERATIONS_SSE2
+    #include <emmintrin.h>
+#elif defined(__aarch64__)
+    #define REGION_OPERATIONS_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace hex {
+
+    namespace {
+
+        constexpr size_t VectorSize = 16;
+
+        // Applies the operation to size bytes of data and key, size has to be a multiple of the vector size
+        void combineVectors(u8 *data, const u8 *key, size_t size, KeyOperation operation) {
+            #if defined(REGION_OPERATIONS_SSE2)
+                for (size_t i = 0; i < size; i += VectorSize) {
+                    const auto values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                    const auto keys   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + i));
+
+                    __m128i result;
+                    switch (operation) {
+                        case KeyOperation::Xor:      result = _mm_xor_si128(values, keys); break;
+                        case KeyOperation::Add:      result = _mm_add_epi8(values, keys); break;
+                        case KeyOperation::Subtract: result = _mm_sub_epi8(values, keys); break;
+                    }
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), result);
+                }
+            #elif defined(REGION_OPERATIONS_NEON)
+                for (size_t i = 0; i < size; i += VectorSize) {
+                    const auto values = vld1q_u8(data + i);
+                    const auto keys   = vld1q_u8(key + i);
+
+                    uint8x16_t result;
+                    switch (operation) {
+                        case KeyOperation::Xor:      result = veorq_u8(values, keys); break;
+                        case KeyOperation::Add:      result = vaddq_u8(values, keys); break;
+                        case KeyOperation::Subtract: result = vsubq_u8(values, keys); break;
+                    }
+
+                    vst1q_u8(data + i, result);
+                }
+            #else
+                for (size_t i = 0; i < size; i++) {
+                    switch (operation) {
+                        case KeyOperation::Xor:      data[i] ^= key[i]; break;
+                        case KeyOperation::Add:      data[i] += key[i]; break;
+                        case KeyOperation::Subtract: data[i] -= key[i]; break;
+                    }
+                }
+            #endif
+        }
+
+        bool isSeparator(char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',';
+        }
+
+        std::optional<u8> parseHexDigit(char c) {
+            if (c >= '0' && c <= '9')       return c - '0';
+            else if (c >= 'A' && c <= 'F')  return c - 'A' + 10;
+            else if (c >= 'a' && c <= 'f')  return c - 'a' + 10;
+            else return { };
+        }
+
+    }
+
+    void fillWithPattern(u8 *data, size_t size, const std::vector<u8> &pattern) {
+        if (pattern.empty() || size == 0)
+            return;
+
+        const size_t patternSize = std::min(pattern.size(), size);
+        std::memcpy(data, pattern.data(), patternSize);
+
+        // Everything filled so far is a whole number of patterns, so doubling it keeps the pattern going and every copy is one large memcpy
+        for (size_t filled = patternSize; filled < size; ) {
+            const size_t copySize = std::min(filled, size - filled);
+            std::memcpy(data + filled, data, copySize);
+            filled += copySize;
+        }
+    }
+
+    void combineWithKey(u8 *data, size_t size, const std::vector<u8> &key, KeyOperation operation) {
+        if (key.empty() || size == 0)
+            return;
+
+        // The key repeated until it lines up with the vector size again, so every block starts at the beginning of the key
+        const size_t blockSize = std::lcm(key.size(), VectorSize);
+        std::vector<u8> block(blockSize);
+        fillWithPattern(block.data(), blockSize, key);
+
+        size_t offset = 0;
+        for (; offset + blockSize <= size; offset += blockSize)
+            combineVectors(data + offset, block.data(), blockSize, operation);
+
+        const size_t vectorizedSize = (size - offset) / VectorSize * VectorSize;
+        combineVectors(data + offset, block.data(), vectorizedSize, operation);
+        offset += vectorizedSize;
+
+        for (size_t i = 0; offset + i < size; i++) {
+            u8 &value = data[offset + i];
+            const u8 keyValue = block[vectorizedSize + i];
+
+            switch (operation) {
+                case KeyOperation::Xor:      value ^= keyValue; break;
+                case KeyOperation::Add:      value += keyValue; break;
+                case KeyOperation::Subtract: value -= keyValue; break;
+            }
+        }
+    }
+
+    void reverseBytes(u8 *data, size_t size) {
+        size_t front = 0, back = size;
+
+        // Swaps eight bytes from each end at once, every word gets its bytes reversed on the way to the other end
+        for (; back - front >= 16; front += 8, back -= 8) {
+            u64 frontWord, backWord;
+            std::memcpy(&frontWord, data + front, sizeof(u64));
+            std::memcpy(&backWord, data + back - 8, sizeof(u64));
+
+            frontWord = __builtin_bswap64(frontWord);
+            backWord  = __builtin_bswap64(backWord);
+
+            std::memcpy(data + front, &backWord, sizeof(u64));
+            std::memcpy(data + back - 8, &frontWord, sizeof(u64));
+        }
+
+        std::reverse(data + front, data + back);
+    }
+
+    void swapByteOrder(u8 *data, size_t size, size_t width) {
+        if (width < 2)
+            return;
+
+        const size_t count = size / width;
+
+        auto swapValues = [&]<typename T>(T (*swap)(T)) {
+            for (size_t i = 0; i < count; i++) {
+                T value;
+                std::memcpy(&value, data + i * sizeof(T), sizeof(T));
+                value = swap(value);
+                std::memcpy(data + i * sizeof(T), &value, sizeof(T));
+            }
+        };
+
+        switch (width) {
+            case 2: swapValues(+[](u16 value) -> u16 { return __builtin_bswap16(value); }); break;
+            case 4: swapValues(+[](u32 value) -> u32 { return __builtin_bswap32(value); }); break;
+            case 8: swapValues(+[](u64 value) -> u64 { return __builtin_bswap64(value); }); break;
+            default:
+                for (size_t i = 0; i < count; i++)
+                    std::reverse(data + i * width, data + (i + 1) * width);
+                break;
+        }
+    }
+
+    std::optional<std::vector<u8>> parseHexBytes(std::string_view string) {
+        std::vector<u8> bytes;
+
+        size_t position = 0;
+        while (position < string.size()) {
+            if (isSeparator(string[position])) {
+                position++;
+                continue;
+            }
+
+            // Every token is a run of hex digits, optionally with a 0x in front of it
+            size_t end = position;
+            while (end < string.size() && !isSeparator(string[end]))
+                end++;
+
+            auto token = string.substr(position, end - position);
+            if (token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X'))
+                token.remove_prefix(2);
+
+            if (token.size() % 2 != 0)
+                return { };
+
+            for (size_t i = 0; i < token.size(); i += 2) {
+                auto high = parseHexDigit(token[i]), low = parseHexDigit(token[i + 1]);
+                if (!high.has_value() || !low.has_value())
+                    return { };
+
+                bytes.push_back((*high << 4) | *low);
+            }
+
+            position = end;
+        }
+
+        return bytes;
+    }
+
+}
@@ -0,0 +1,87 @@
+#include "helpers/result_table.hpp"
+
+#include <algorithm>
+
+namespace hex {
+
+    void ResultTable::add(u64 offset, u64 size, u32 label) {
+        if (this->m_entry != nullptr)
+            return;
+
+        // Label indices only get stored once the first result has a label
+        if (label != NoLabel && this->m_labelIndices.empty())
+            this->m_labelIndices.resize(this->m_offsets.size(), NoLabel);
+
+        this->m_offsets.push_back(offset);
+        this->m_sizes.push_back(size);
+
+        if (!this->m_labelIndices.empty())
+            this->m_labelIndices.push_back(label);
+    }
+
+    u32 ResultTable::addLabel(std::string_view label) {
+        if (this->m_entry != nullptr)
+            return NoLabel;
+
+        this->m_labelPool += label;
+        this->m_labelStarts.push_back(this->m_labelPool.size());
+
+        return this->m_labelStarts.size() - 2;
+    }
+
+    std::optional<std::string_view> ResultTable::getLabel(size_t index) const {
+        const auto labelIndices = this->getLabelIndices();
+        if (index >= labelIndices.size() || labelIndices[index] == NoLabel)
+            return std::nullopt;
+
+        const auto labelStarts = this->getLabelStarts();
+        const u32 label = labelIndices[index];
+
+        return this->getLabelPool().substr(labelStarts[label], labelStarts[label + 1] - labelStarts[label]);
+    }
+
+    void ResultTable::store(PersistentAnalysisCache::Writer &writer) const {
+        writer.add(this->getOffsets());
+        writer.add(this->getSizes());
+        writer.add(this->getLabelIndices());
+        writer.add(this->getLabelPool());
+        writer.add(this->getLabelStarts());
+    }
+
+    std::optional<ResultTable> ResultTable::load(std::shared_ptr<const PersistentAnalysisCache::Entry> entry, size_t firstArray) {
+        if (entry == nullptr || entry->getArrayCount() < firstArray + ArrayCount)
+            return std::nullopt;
+
+        ResultTable table;
+        table.m_mappedOffsets       = entry->get<u64>(firstArray);
+        table.m_mappedSizes         = entry->get<u64>(firstArray + 1);
+        table.m_mappedLabelIndices  = entry->get<u32>(firstArray + 2);
+        table.m_mappedLabelPool     = entry->getString(firstArray + 3);
+        table.m_mappedLabelStarts   = entry->get<u32>(firstArray + 4);
+
+        // Files may come from anywhere, nothing in them gets trusted before it was checked
+        const auto &labelStarts = table.m_mappedLabelStarts;
+        if (table.m_mappedSizes.size() != table.m_mappedOffsets.size())
+            return std::nullopt;
+        if (!table.m_mappedLabelIndices.empty() && table.m_mappedLabelIndices.size() != table.m_mappedOffsets.size())
+            return std::nullopt;
+        if (labelStarts.empty() || labelStarts.front() != 0 || labelStarts.back() != table.m_mappedLabelPool.size() || !std::is_sorted(labelStarts.begin(), labelStarts.end()))
+            return std::nullopt;
+
+        const u32 labelCount = labelStarts.size() - 1;
+        if (std::any_of(table.m_mappedLabelIndices.begin(), table.m_mappedLabelIndices.end(), [labelCount](u32 label) { return label != NoLabel && label >= labelCount; }))
+            return std::nullopt;
+
+        table.m_entry = std::move(entry);
+
+        return table;
+    }
+
+    bool ResultTable::exportFile(const std::string &path, const PersistentAnalysisCache::Fingerprint &fingerprint) const {
+        PersistentAnalysisCache::Writer writer;
+        this->store(writer);
+
+        return PersistentAnalysisCache::writeFile(path, fingerprint, FileKey, writer);
+    }
+
+}
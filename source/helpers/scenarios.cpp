@@ -0,0 +1,527 @@
+#include "helpers/scenarios.hpp"
+
+#include "helpers/crypto.hpp"
+#include "helpers/plugin_handler.hpp"
+#include "helpers/printable_scanner.hpp"
+#include "providers/file_provider.hpp"
+
+#include <hex/helpers/memory_arena.hpp>
+#include <hex/helpers/shared_data.hpp>
+#include <hex/lang/pattern_language.hpp>
+#include <hex/lang/pattern_data.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(OS_WINDOWS)
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+namespace {
+
+    // Only counted while a scenario runs, so allocations of everything else cost nothing more than a load
+    std::atomic<bool> s_countAllocations = false;
+    std::atomic<u64> s_allocationCount = 0, s_allocatedBytes = 0;
+
+    void* allocate(size_t size) {
+        if (s_countAllocations.load(std::memory_order_relaxed)) {
+            s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+            s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        }
+
+        if (auto pointer = std::malloc(size == 0 ? 1 : size); pointer != nullptr)
+            return pointer;
+
+        throw std::bad_alloc();
+    }
+
+}
+
+// Replaced for the entire executable. Plugins only get counted on platforms resolving their allocations to it, like Linux
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { std::free(pointer); }
+
+namespace hex {
+
+    namespace {
+
+        constexpr u64 MiB = 0x10'0000;
+        constexpr size_t ReadSize = MiB;
+        constexpr size_t BlockSize = 0x1000;
+
+        struct ScenarioOptions {
+            std::string filter;
+            u64 size = 4096 * MiB;
+            u64 entries = 1'000'000;
+            u64 patches = 100'000;
+            std::string folder;
+            std::string outputPath;
+        };
+
+        struct Scenario {
+            std::string name;
+            std::function<bool()> run;  // Returns false if the scenario failed
+        };
+
+        struct ScenarioResult {
+            std::string name;
+            double wallTime;            // Seconds
+            u64 peakMemory;             // Bytes, 0 if unknown
+            u64 allocations, allocatedBytes;
+        };
+
+        volatile u64 s_sink;
+
+    }
+
+    static void printUsage(const char *executable) {
+        std::fprintf(stderr, "Usage: %s --scenarios [--filter <text>] [--size <MiB>] [--entries <count>] [--patches <count>] [--folder <path>] [--output <file.json>]\n", executable);
+    }
+
+    static std::optional<ScenarioOptions> parseArguments(int argc, char **argv) {
+        ScenarioOptions options;
+
+        for (int i = 2; i < argc; i++) {
+            std::string_view argument = argv[i];
+
+            auto getValue = [&]() -> const char* {
+                return i + 1 < argc ? argv[++i] : nullptr;
+            };
+
+            auto getNumber = [&]() -> std::optional<u64> {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                char *end = nullptr;
+                auto number = std::strtoull(value, &end, 10);
+                if (*end != '\0' || number == 0)
+                    return { };
+
+                return number;
+            };
+
+            if (argument == "--filter") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                options.filter = value;
+            } else if (argument == "--size") {
+                auto size = getNumber();
+                if (!size.has_value()) return { };
+
+                options.size = *size * MiB;
+            } else if (argument == "--entries") {
+                auto entries = getNumber();
+                if (!entries.has_value()) return { };
+
+                options.entries = *entries;
+            } else if (argument == "--patches") {
+                auto patches = getNumber();
+                if (!patches.has_value()) return { };
+
+                options.patches = *patches;
+            } else if (argument == "--folder") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                options.folder = value;
+            } else if (argument == "--output") {
+                auto value = getValue();
+                if (value == nullptr) return { };
+
+                options.outputPath = value;
+            } else
+                return { };
+        }
+
+        return options;
+    }
+
+    static void loadPlugins() {
+        try {
+            auto pluginFolderPath = std::filesystem::path(SharedData::mainArgv[0]).parent_path() / "plugins";
+            PluginHandler::load(pluginFolderPath.string());
+        } catch (std::runtime_error &e) {
+            std::fprintf(stderr, "warning: %s, built-in functions won't be available\n", e.what());
+            return;
+        }
+
+        for (const auto &plugin : PluginHandler::getPlugins())
+            plugin.initializePlugin();
+    }
+
+    // Restarts measuring the peak memory usage where the OS allows it. Returns false if it's the peak of the entire process instead
+    static bool resetPeakMemory() {
+        #if defined(OS_LINUX)
+            std::ofstream clearRefs("/proc/self/clear_refs");
+            clearRefs << "5";
+
+            return clearRefs.good();
+        #else
+            return false;
+        #endif
+    }
+
+    static u64 getPeakMemory() {
+        #if defined(OS_LINUX)
+            std::ifstream status("/proc/self/status");
+
+            std::string line;
+            while (std::getline(status, line)) {
+                if (line.starts_with("VmHWM:"))
+                    return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+            }
+
+            return 0;
+        #elif defined(OS_WINDOWS)
+            PROCESS_MEMORY_COUNTERS counters = { 0 };
+            if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+                return 0;
+
+            return counters.PeakWorkingSetSize;
+        #else
+            struct rusage usage = { };
+            if (getrusage(RUSAGE_SELF, &usage) != 0)
+                return 0;
+
+            // Reported in bytes on macOS
+            return usage.ru_maxrss;
+        #endif
+    }
+
+    // Blocks of random data, text, zeros and small records. Every block only depends on its index, so the file can be generated in pieces
+    static void generateBlock(u8 *block, size_t size, u64 blockIndex) {
+        constexpr std::string_view Words[] = { "ImHex ", "pattern ", "provider ", "header ", "0x1234 ", "entry ", "string, ", "data.\n" };
+
+        std::minstd_rand random(blockIndex + 1);
+
+        switch (blockIndex % 4) {
+            case 0:
+                for (size_t i = 0; i < size; i++)
+                    block[i] = random();
+                break;
+            case 1:
+                for (size_t i = 0; i < size;) {
+                    auto word = Words[random() % std::size(Words)];
+                    auto wordSize = std::min(word.size(), size - i);
+
+                    std::copy_n(word.begin(), wordSize, block + i);
+                    i += wordSize;
+                }
+                break;
+            case 2:
+                std::fill_n(block, size, 0x00);
+                break;
+            case 3:
+                for (size_t i = 0; i < size; i++)
+                    block[i] = (i % 16) < 4 ? u8(random() % 4) : u8(i);
+                break;
+        }
+    }
+
+    static bool generateFile(const std::string &path, u64 size) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        std::vector<u8> buffer(64 * MiB);
+        for (u64 offset = 0; offset < size && file.good(); offset += buffer.size()) {
+            auto bufferSize = std::min<u64>(buffer.size(), size - offset);
+
+            for (u64 block = 0; block < bufferSize; block += BlockSize)
+                generateBlock(buffer.data() + block, std::min<u64>(BlockSize, bufferSize - block), (offset + block) / BlockSize);
+
+            file.write(reinterpret_cast<const char*>(buffer.data()), bufferSize);
+        }
+
+        return file.good();
+    }
+
+    static bool readAll(prv::Provider *provider) {
+        std::vector<u8> buffer(ReadSize);
+        const u64 size = provider->getActualSize();
+
+        u64 checksum = 0;
+        for (u64 offset = 0; offset < size; offset += buffer.size()) {
+            auto readSize = std::min<u64>(buffer.size(), size - offset);
+
+            provider->readAbsolute(offset, buffer.data(), readSize);
+            checksum += buffer[readSize - 1];
+        }
+
+        s_sink = checksum;
+
+        return true;
+    }
+
+    static bool extractStrings(prv::Provider *provider) {
+        constexpr size_t MinimumLength = 5;
+
+        std::vector<u8> buffer(ReadSize);
+        const u64 size = provider->getActualSize();
+
+        // Strings continuing at the start of the next read keep the length they already have
+        u64 count = 0, pendingLength = 0;
+        for (u64 offset = 0; offset < size; offset += buffer.size()) {
+            auto readSize = std::min<u64>(buffer.size(), size - offset);
+            provider->readAbsolute(offset, buffer.data(), readSize);
+
+            for (size_t position = 0; position < readSize;) {
+                if (pendingLength == 0)
+                    position += findPrintable(buffer.data() + position, readSize - position);
+                if (position >= readSize)
+                    break;
+
+                auto length = findNonPrintable(buffer.data() + position, readSize - position);
+                pendingLength += length;
+                position += length;
+
+                if (position < readSize) {
+                    if (pendingLength >= MinimumLength)
+                        count++;
+                    pendingLength = 0;
+                }
+            }
+        }
+
+        if (pendingLength >= MinimumLength)
+            count++;
+
+        s_sink = count;
+
+        return count != 0;
+    }
+
+    int runScenarios(int argc, char **argv) {
+        SharedData::mainArgc = argc;
+        SharedData::mainArgv = argv;
+
+        auto options = parseArguments(argc, argv);
+        if (!options.has_value()) {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        // Builtin functions get registered by the plugins, they have to be loaded before any runtime is created
+        loadPlugins();
+
+        auto folder = options->folder.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(options->folder);
+        auto dataPath = (folder / "imhex-scenario.bin").string();
+
+        std::printf("Generating %llu MiB of data in '%s'...\n", static_cast<unsigned long long>(options->size / MiB), dataPath.c_str());
+        std::fflush(stdout);
+
+        if (!generateFile(dataPath, options->size)) {
+            std::fprintf(stderr, "error: failed to write scenario data to '%s'\n", dataPath.c_str());
+            std::filesystem::remove(dataPath);
+            return EXIT_FAILURE;
+        }
+
+        std::unique_ptr<prv::FileProvider> provider;
+        auto getProvider = [&]() -> prv::FileProvider* {
+            if (provider == nullptr)
+                provider = std::make_unique<prv::FileProvider>(dataPath);
+
+            return provider->isAvailable() ? provider.get() : nullptr;
+        };
+
+        // Entries differ in size, so every one of them has to be evaluated. Each produces up to four patterns, the default limits would stop way earlier
+        const auto patternCode = hex::format(
+            "#pragma pattern_limit %llu\n"
+            "#pragma array_limit %llu\n"
+            "struct Entry { u32 offset; u16 type; if (type > 0x8000) u16 flags; };\n"
+            "Entry entries[%llu] @ 0x00;\n",
+            static_cast<unsigned long long>(options->entries * 4 + 1), static_cast<unsigned long long>(options->entries), static_cast<unsigned long long>(options->entries));
+
+        std::vector<Scenario> scenarios;
+
+        scenarios.push_back({ "open", [&] {
+            provider.reset();
+
+            auto fileProvider = getProvider();
+            if (fileProvider == nullptr)
+                return false;
+
+            // What the hex editor needs to show the first and last rows
+            std::vector<u8> buffer(0x1000);
+            const u64 readSize = std::min<u64>(buffer.size(), fileProvider->getActualSize());
+            fileProvider->readAbsolute(0, buffer.data(), readSize);
+            fileProvider->readAbsolute(fileProvider->getActualSize() - readSize, buffer.data(), readSize);
+
+            return true;
+        } });
+
+        scenarios.push_back({ "read", [&] {
+            auto fileProvider = getProvider();
+            return fileProvider != nullptr && readAll(fileProvider);
+        } });
+
+        scenarios.push_back({ "pattern", [&] {
+            auto fileProvider = getProvider();
+            if (fileProvider == nullptr || options->entries * 8 > fileProvider->getActualSize())
+                return false;
+
+            // Patterns get freed all at once together with the arena, as they are in the pattern data view
+            MemoryArena arena;
+            MemoryArena::Scope arenaScope(arena);
+
+            lang::PatternLanguage runtime;
+            auto patterns = runtime.executeString(fileProvider, patternCode);
+            if (!patterns.has_value()) {
+                if (auto &error = runtime.getError(); error.has_value())
+                    std::fprintf(stderr, "pattern:%u: error: %s\n", error->first, error->second.c_str());
+                return false;
+            }
+
+            s_sink = patterns->size();
+            for (auto &pattern : *patterns)
+                delete pattern;
+
+            return true;
+        } });
+
+        scenarios.push_back({ "strings", [&] {
+            auto fileProvider = getProvider();
+            return fileProvider != nullptr && extractStrings(fileProvider);
+        } });
+
+        scenarios.push_back({ "hash", [&] {
+            auto fileProvider = getProvider();
+            if (fileProvider == nullptr)
+                return false;
+
+            auto digests = crypt::hash(fileProvider, 0, fileProvider->getActualSize(), {
+                { crypt::HashFunction::CRC32, 0x04C11DB7, 0xFFFFFFFF },
+                { crypt::HashFunction::SHA256 }
+            });
+
+            return digests.has_value();
+        } });
+
+        scenarios.push_back({ "save", [&] {
+            auto fileProvider = getProvider();
+            if (fileProvider == nullptr || !fileProvider->isWritable())
+                return false;
+
+            // Scattered edits of up to 16 bytes each, the way they accumulate while editing by hand
+            std::mt19937_64 random(options->patches);
+            const u64 size = fileProvider->getActualSize();
+            for (u64 i = 0; i < options->patches; i++) {
+                u8 patch[16];
+                const size_t patchSize = std::min<u64>(1 + random() % sizeof(patch), size);
+                std::fill_n(patch, patchSize, u8(random()));
+
+                fileProvider->writeAbsolute(random() % (size - patchSize + 1), patch, patchSize);
+            }
+
+            fileProvider->applyPatches();
+
+            return true;
+        } });
+
+        int exitCode = EXIT_SUCCESS;
+        bool peakIsPerScenario = true;
+        std::vector<ScenarioResult> results;
+
+        std::printf("%-20s %12s %14s %14s %16s\n", "Scenario", "Wall time", "Peak memory", "Allocations", "Allocated");
+        for (const auto &scenario : scenarios) {
+            if (!options->filter.empty() && scenario.name.find(options->filter) == std::string::npos)
+                continue;
+
+            peakIsPerScenario = resetPeakMemory();
+            s_allocationCount = 0;
+            s_allocatedBytes = 0;
+            s_countAllocations = true;
+
+            bool success = false;
+            auto startTime = std::chrono::steady_clock::now();
+            try {
+                success = scenario.run();
+            } catch (std::exception &e) {
+                std::fprintf(stderr, "%s: error: %s\n", scenario.name.c_str(), e.what());
+            }
+            auto wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+            s_countAllocations = false;
+
+            if (!success) {
+                std::printf("%-20s %12s\n", scenario.name.c_str(), "failed");
+                exitCode = EXIT_FAILURE;
+                continue;
+            }
+
+            ScenarioResult result = { scenario.name, wallTime, getPeakMemory(), s_allocationCount, s_allocatedBytes };
+
+            std::printf("%-20s %10.3f s %11.1f MiB%s %14llu %12.1f MiB\n", result.name.c_str(), result.wallTime, result.peakMemory / double(MiB), peakIsPerScenario ? "" : "*",
+                        static_cast<unsigned long long>(result.allocations), result.allocatedBytes / double(MiB));
+            std::fflush(stdout);
+
+            results.push_back(std::move(result));
+        }
+
+        if (!peakIsPerScenario)
+            std::printf("* Peak memory of the entire process so far\n");
+
+        provider.reset();
+        std::filesystem::remove(dataPath);
+
+        if (!options->outputPath.empty()) {
+            auto scenarioResults = nlohmann::json::array();
+            for (const auto &result : results) {
+                scenarioResults.push_back({
+                    { "name",            result.name            },
+                    { "wall_time",       result.wallTime        },
+                    { "peak_memory",     result.peakMemory      },
+                    { "allocations",     result.allocations     },
+                    { "allocated_bytes", result.allocatedBytes  }
+                });
+            }
+
+            nlohmann::json json = {
+                { "context", {
+                    { "executable",             SharedData::mainArgv[0]                 },
+                    { "num_cpus",               std::thread::hardware_concurrency()     },
+                    { "data_size",              options->size                           },
+                    { "entries",                options->entries                        },
+                    { "patches",                options->patches                        },
+                    { "time_unit",              "s"                                     },
+                    { "peak_memory_per_scenario", peakIsPerScenario                     }
+                } },
+                { "scenarios", std::move(scenarioResults) }
+            };
+
+            std::ofstream file(options->outputPath, std::ios::trunc);
+            file << json.dump(4) << '\n';
+
+            if (!file.good()) {
+                std::fprintf(stderr, "error: failed to write results to '%s'\n", options->outputPath.c_str());
+                exitCode = EXIT_FAILURE;
+            }
+        }
+
+        PluginHandler::unload();
+
+        return exitCode;
+    }
+
+}
@@ -0,0 +1,236 @@
+#include "helpers/search_index.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/providers/provider.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+namespace hex {
+
+    constexpr static char FileMagic[8] = { 'H', 'E', 'X', 'I', 'D', 'X', 0, 0 };
+    constexpr static u32 FileVersion = 1;
+
+    // Filters are stored in host byte order, the sizes in the header make sure a mismatching index is rejected
+    struct FileHeader {
+        char magic[8];
+        u32 version;
+        u32 blockSize;
+        u32 filterBits;
+        u32 reserved;
+        u64 dataSize;
+        u64 dataVersion;
+    };
+
+    SearchIndex::SearchIndex(u64 dataSize) : m_dataSize(dataSize), m_blockCount((dataSize + BlockSize - 1) / BlockSize) {
+        this->m_filters.resize(this->m_blockCount * FilterWords, 0);
+        this->m_indexed.resize(this->m_blockCount, false);
+        this->m_versions.resize(this->m_blockCount, 0);
+    }
+
+    u32 SearchIndex::hashGram(const u8 *gram) {
+        const u32 value = u32(gram[0]) | (u32(gram[1]) << 8) | (u32(gram[2]) << 16);
+
+        return (value * 0x9E37'79B1) >> (32 - std::countr_zero(FilterBits));
+    }
+
+    bool SearchIndex::containsGram(u64 block, u32 hash) const {
+        return (this->m_filters[block * FilterWords + hash / 64] >> (hash % 64)) & 1;
+    }
+
+    void SearchIndex::build(prv::Provider *provider, Task &task) {
+        constexpr static size_t BlocksPerRead = 0x100;
+
+        // Grams starting at the end of a block extend into the next one
+        std::vector<u8> buffer(BlocksPerRead * BlockSize + GramSize - 1);
+        std::vector<u64> filters(BlocksPerRead * FilterWords);
+        std::vector<u32> versions;
+
+        for (u64 firstBlock = 0; firstBlock < this->m_blockCount && !task.isCancelled(); firstBlock += BlocksPerRead) {
+            const u64 lastBlock = std::min<u64>(firstBlock + BlocksPerRead, this->m_blockCount);
+            task.setProgress(float(lastBlock) / this->m_blockCount);
+
+            {
+                std::shared_lock lock(this->m_mutex);
+
+                if (std::all_of(this->m_indexed.begin() + firstBlock, this->m_indexed.begin() + lastBlock, [](bool indexed) { return indexed; }))
+                    continue;
+
+                versions.assign(this->m_versions.begin() + firstBlock, this->m_versions.begin() + lastBlock);
+            }
+
+            const u64 address = firstBlock * BlockSize;
+            const size_t readSize = std::min<u64>(buffer.size(), this->m_dataSize - address);
+            const size_t gramCount = std::min<size_t>((lastBlock - firstBlock) * BlockSize, readSize - std::min(readSize, GramSize - 1));
+            provider->readRaw(address, buffer.data(), readSize);
+
+            std::fill(filters.begin(), filters.end(), 0);
+            for (size_t i = 0; i < gramCount; i++) {
+                const u32 hash = hashGram(&buffer[i]);
+                filters[(i / BlockSize) * FilterWords + hash / 64] |= u64(1) << (hash % 64);
+            }
+
+            std::unique_lock lock(this->m_mutex);
+            for (u64 block = firstBlock; block < lastBlock; block++) {
+                if (this->m_indexed[block] || this->m_versions[block] != versions[block - firstBlock])
+                    continue;
+
+                std::memcpy(&this->m_filters[block * FilterWords], &filters[(block - firstBlock) * FilterWords], FilterWords * sizeof(u64));
+                this->m_indexed[block] = true;
+            }
+        }
+    }
+
+    void SearchIndex::invalidate(u64 address, size_t size) {
+        if (size == 0 || address >= this->m_dataSize)
+            return;
+
+        // Grams of the previous block reach up to two bytes into this range
+        const u64 firstBlock = (address - std::min<u64>(address, GramSize - 1)) / BlockSize;
+        const u64 lastBlock = std::min<u64>((address + size - 1) / BlockSize, this->m_blockCount - 1);
+
+        std::unique_lock lock(this->m_mutex);
+        for (u64 block = firstBlock; block <= lastBlock; block++) {
+            this->m_indexed[block] = false;
+            this->m_versions[block]++;
+        }
+    }
+
+    bool SearchIndex::isComplete() const {
+        std::shared_lock lock(this->m_mutex);
+
+        return std::all_of(this->m_indexed.begin(), this->m_indexed.end(), [](bool indexed) { return indexed; });
+    }
+
+    size_t SearchIndex::getMemoryUsage() const {
+        std::shared_lock lock(this->m_mutex);
+
+        return this->m_filters.size() * sizeof(u64) + this->m_indexed.size() / 8 + this->m_versions.size() * sizeof(u32);
+    }
+
+    std::vector<std::pair<u64, u64>> SearchIndex::getCandidateRanges(const std::vector<u8> &pattern, u64 from, u64 to) const {
+        std::vector<std::pair<u64, u64>> ranges;
+
+        if (from >= to)
+            return ranges;
+
+        if (!canFilter(pattern.size())) {
+            ranges.emplace_back(from, to);
+            return ranges;
+        }
+
+        std::vector<u32> hashes;
+        for (size_t i = 0; i + GramSize <= pattern.size(); i++)
+            hashes.push_back(hashGram(&pattern[i]));
+
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+        std::shared_lock lock(this->m_mutex);
+
+        auto isIndexed = [this](u64 block) { return block < this->m_blockCount && this->m_indexed[block]; };
+
+        // A match starting in a block has all its grams start in that block or the next one, since it's at most one block long
+        for (u64 block = from / BlockSize; block <= (to - 1) / BlockSize; block++) {
+            const bool hasNext = block + 1 < this->m_blockCount;
+            bool candidate = !isIndexed(block) || (hasNext && !isIndexed(block + 1));
+
+            if (!candidate) {
+                candidate = std::all_of(hashes.begin(), hashes.end(), [&, this](u32 hash) {
+                    return this->containsGram(block, hash) || (hasNext && this->containsGram(block + 1, hash));
+                });
+            }
+
+            if (!candidate)
+                continue;
+
+            const u64 start = std::max(from, block * BlockSize);
+            const u64 end   = std::min(to, (block + 1) * BlockSize + pattern.size() - 1);
+
+            if (!ranges.empty() && start <= ranges.back().second)
+                ranges.back().second = std::max(ranges.back().second, end);
+            else
+                ranges.emplace_back(start, end);
+        }
+
+        return ranges;
+    }
+
+    bool SearchIndex::store(const std::string &path, u64 dataVersion) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        FileHeader header = { };
+        std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+        header.version      = FileVersion;
+        header.blockSize    = BlockSize;
+        header.filterBits   = FilterBits;
+        header.dataSize     = this->m_dataSize;
+        header.dataVersion  = dataVersion;
+
+        std::shared_lock lock(this->m_mutex);
+
+        std::vector<u8> indexed(this->m_indexed.begin(), this->m_indexed.end());
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(indexed.data()), indexed.size());
+        file.write(reinterpret_cast<const char*>(this->m_filters.data()), this->m_filters.size() * sizeof(u64));
+
+        return file.good();
+    }
+
+    std::shared_ptr<SearchIndex> SearchIndex::load(const std::string &path, u64 dataSize, u64 dataVersion) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return nullptr;
+
+        FileHeader header = { };
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file.good() || std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 || header.version != FileVersion)
+            return nullptr;
+        if (header.blockSize != BlockSize || header.filterBits != FilterBits)
+            return nullptr;
+        if (header.dataSize != dataSize || header.dataVersion != dataVersion)
+            return nullptr;
+
+        auto index = std::make_shared<SearchIndex>(dataSize);
+
+        std::vector<u8> indexed(index->m_blockCount);
+        file.read(reinterpret_cast<char*>(indexed.data()), indexed.size());
+        file.read(reinterpret_cast<char*>(index->m_filters.data()), index->m_filters.size() * sizeof(u64));
+
+        if (!file.good())
+            return nullptr;
+
+        index->m_indexed.assign(indexed.begin(), indexed.end());
+
+        return index;
+    }
+
+    void SearchIndex::store(PersistentAnalysisCache::Writer &writer) const {
+        std::shared_lock lock(this->m_mutex);
+
+        writer.add(std::vector<u8>(this->m_indexed.begin(), this->m_indexed.end()));
+        writer.add(this->m_filters);
+    }
+
+    std::shared_ptr<SearchIndex> SearchIndex::load(const PersistentAnalysisCache::Entry &entry, u64 dataSize) {
+        auto index = std::make_shared<SearchIndex>(dataSize);
+
+        auto indexed = entry.get<u8>(0);
+        auto filters = entry.get<u64>(1);
+        if (indexed.size() != index->m_blockCount || filters.size() != index->m_filters.size())
+            return nullptr;
+
+        index->m_indexed.assign(indexed.begin(), indexed.end());
+        std::copy(filters.begin(), filters.end(), index->m_filters.begin());
+
+        return index;
+    }
+
+}
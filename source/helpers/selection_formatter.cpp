@@ -0,0 +1,242 @@
+#include "helpers/selection_formatter.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/helpers/utils.hpp>
+#include <hex/providers/snapshot.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace hex {
+
+    constexpr static u64 ChunkSize = 0x10'0000;
+
+    constexpr static auto HexViewHeader = "Hex View  00 01 02 03 04 05 06 07  08 09 0A 0B 0C 0D 0E 0F\n\n";
+
+    constexpr static auto HTMLHeader =
+R"(
+<div>
+    <style type="text/css">
+        .offsetheader { color:#0000A0; line-height:200% }
+        .offsetcolumn { color:#0000A0 }
+        .hexcolumn { color:#000000 }
+        .textcolumn { color:#000000 }
+    </style>
+
+    <code>
+        <span class="offsetheader">Hex View&nbsp&nbsp00 01 02 03 04 05 06 07&nbsp 08 09 0A 0B 0C 0D 0E 0F</span><br/>
+)";
+
+    constexpr static auto HTMLFooter =
+R"(
+    </code>
+</div>
+)";
+
+    SelectionFormatter::SelectionFormatter(Format format, u64 address, u64 size)
+        : m_format(format), m_start(address), m_end(address + size), m_position(address) {
+
+    }
+
+    void SelectionFormatter::appendHeader(std::string &result) const {
+        const auto size = std::to_string(this->m_end - this->m_start);
+
+        switch (this->m_format) {
+            case Format::Raw:
+            case Format::Bytes:
+                break;
+            case Format::C:
+                result += "const unsigned char data[" + size + "] = { ";
+                break;
+            case Format::Cpp:
+                result += "constexpr std::array<unsigned char, " + size + "> data = { ";
+                break;
+            case Format::Java:
+                result += "final byte[] data = { ";
+                break;
+            case Format::CSharp:
+                result += "const byte[] data = { ";
+                break;
+            case Format::Rust:
+                result += "let data: [u8, " + size + "] = [ ";
+                break;
+            case Format::Python:
+                result += "data = bytes([ ";
+                break;
+            case Format::JavaScript:
+                result += "const data = new Uint8Array([ ";
+                break;
+            case Format::HexView:
+                result += HexViewHeader;
+                break;
+            case Format::HTML:
+                result += HTMLHeader;
+                break;
+        }
+    }
+
+    void SelectionFormatter::appendFooter(std::string &result) const {
+        switch (this->m_format) {
+            case Format::Raw:
+            case Format::Bytes:
+                break;
+            case Format::C:
+            case Format::Cpp:
+            case Format::Java:
+            case Format::CSharp:
+                result += " };";
+                break;
+            case Format::Rust:
+                result += " ];";
+                break;
+            case Format::Python:
+            case Format::JavaScript:
+                result += " ]);";
+                break;
+            case Format::HexView:
+                break;
+            case Format::HTML:
+                result += HTMLFooter;
+                break;
+        }
+    }
+
+    void SelectionFormatter::appendData(std::string &result, std::span<const u8> data) {
+        data = data.first(std::min<u64>(data.size(), this->m_end - this->m_position));
+        if (data.empty())
+            return;
+
+        switch (this->m_format) {
+            case Format::Raw:
+                result.append(reinterpret_cast<const char*>(data.data()), data.size());
+                break;
+            case Format::Bytes:
+                // Separators go between bytes, so the first byte of every chunk but the first one needs one in front of it
+                if (this->m_position != this->m_start)
+                    result += ' ';
+                hex::appendHexBytes(result, data, "", " ");
+                break;
+            case Format::C:
+            case Format::Cpp:
+            case Format::CSharp:
+            case Format::Rust:
+            case Format::Python:
+            case Format::Java:
+            case Format::JavaScript:
+                // All languages write the bytes the same way, only what's around them differs
+                if (this->m_position != this->m_start)
+                    result += ", ";
+                hex::appendHexBytes(result, data, "0x", ", ");
+                break;
+            case Format::HexView:
+            case Format::HTML:
+                while (!data.empty()) {
+                    const u64 rowAddress = this->m_position & ~u64(0xF);
+                    const u64 column = this->m_position & 0xF;
+                    const size_t count = std::min<u64>(data.size(), 0x10 - column);
+
+                    std::memcpy(this->m_row.data() + column, data.data(), count);
+                    data = data.subspan(count);
+                    this->m_position += count;
+
+                    if ((this->m_position & 0xF) == 0 || this->m_position == this->m_end)
+                        this->appendRow(result, rowAddress);
+                }
+                return;
+        }
+
+        this->m_position += data.size();
+    }
+
+    void SelectionFormatter::appendRow(std::string &result, u64 rowAddress) const {
+        const bool html = this->m_format == Format::HTML;
+
+        // Columns outside of the range are padded so the remaining ones stay aligned
+        auto isInRange = [&, this](u64 column) {
+            return rowAddress + column >= this->m_start && rowAddress + column < this->m_end;
+        };
+
+        if (html) result += "        <span class=\"offsetcolumn\">";
+        hex::appendHexNumber(result, rowAddress, 8);
+        result += html ? "</span>&nbsp&nbsp<span class=\"hexcolumn\">" : "  ";
+
+        for (u64 i = 0; i < 0x10; i++) {
+            if (!isInRange(i))
+                result += html ? "&nbsp&nbsp " : "   ";
+            else {
+                hex::appendHexBytes(result, { &this->m_row[i], 1 });
+                result += ' ';
+            }
+
+            if (i == 0x7)
+                result += html ? "&nbsp" : " ";
+        }
+
+        result += html ? "</span>&nbsp&nbsp<span class=\"textcolumn\">" : " ";
+
+        for (u64 i = 0; i < 0x10; i++) {
+            if (!isInRange(i))
+                result += html ? "&nbsp" : " ";
+            else {
+                u8 c = this->m_row[i];
+                result += (c < 32 || c >= 128) ? '.' : char(c);
+            }
+        }
+
+        result += html ? "</span><br/>\n" : "\n";
+    }
+
+    std::string SelectionFormatter::format(Format format, u64 address, std::span<const u8> data) {
+        SelectionFormatter formatter(format, address, data.size());
+
+        std::string result;
+        result.reserve(data.size() * (format == Format::HTML ? 13 : 6) + 0x200);
+
+        formatter.appendHeader(result);
+        formatter.appendData(result, data);
+        formatter.appendFooter(result);
+
+        return result;
+    }
+
+    bool SelectionFormatter::exportToFile(const std::string &path, Format format, const prv::Snapshot &snapshot, u64 offset, u64 size, u64 address, Task &task) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        SelectionFormatter formatter(format, address, size);
+
+        std::vector<u8> buffer;
+        std::string result;
+
+        formatter.appendHeader(result);
+
+        for (u64 done = 0; done < size; ) {
+            if (task.isCancelled())
+                return false;
+
+            const u64 chunkSize = std::min(size - done, ChunkSize);
+
+            buffer.resize(chunkSize);
+            if (!snapshot.read(offset + done, buffer.data(), chunkSize))
+                return false;
+
+            formatter.appendData(result, buffer);
+            file.write(result.data(), result.size());
+            if (!file)
+                return false;
+
+            result.clear();
+            done += chunkSize;
+            task.setProgress(float(done) / size);
+        }
+
+        formatter.appendFooter(result);
+        file.write(result.data(), result.size());
+
+        return bool(file);
+    }
+
+}
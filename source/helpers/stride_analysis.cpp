@@ -0,0 +1,247 @@
+#include "helpers/stride_analysis.hpp"
+
+#include <hex/api/task.hpp>
+#include <hex/providers/snapshot.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <numbers>
+
+namespace hex {
+
+    namespace {
+
+        constexpr size_t MinTransformSize = 0x8000;
+        constexpr size_t ReadChunkSize = 0x10'0000;
+        constexpr size_t MaxCandidates = 8;
+
+        // Share of a stride's score one of its divisors needs to be reported instead
+        constexpr double DivisorThreshold = 0.9;
+
+        // Strides with fewer multiples in range are scored by too few lags, a single lag close to a multiple of the record size would score high
+        constexpr u64 MinMultiples = 3;
+
+        // Radix-2 FFT of a fixed size, the twiddle factors and bit reversal get shared by all transforms of that size
+        class FFT {
+        public:
+            explicit FFT(size_t size) : m_size(size), m_twiddles(size / 2), m_bitReversed(size) {
+                for (size_t i = 0; i < size / 2; i++)
+                    this->m_twiddles[i] = std::polar(1.0, -2.0 * std::numbers::pi * double(i) / double(size));
+
+                const u32 bits = std::countr_zero(size);
+                for (size_t i = 0; i < size; i++) {
+                    size_t reversed = 0;
+                    for (u32 bit = 0; bit < bits; bit++)
+                        reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+
+                    this->m_bitReversed[i] = reversed;
+                }
+            }
+
+            // The inverse transform isn't scaled down by the size
+            void transform(std::vector<std::complex<double>> &data, bool inverse) const {
+                const size_t size = this->m_size;
+                const auto *twiddles = this->m_twiddles.data();
+                auto *values = data.data();
+
+                for (size_t i = 0; i < size; i++) {
+                    if (i < this->m_bitReversed[i])
+                        std::swap(values[i], values[this->m_bitReversed[i]]);
+                }
+
+                // The inverse transform uses the conjugated twiddle factors
+                const double direction = inverse ? -1.0 : 1.0;
+
+                for (size_t length = 2; length <= size; length <<= 1) {
+                    const size_t half = length / 2, step = size / length;
+
+                    for (size_t start = 0; start < size; start += length) {
+                        for (size_t i = 0; i < half; i++) {
+                            const std::complex<double> twiddle = { twiddles[i * step].real(), twiddles[i * step].imag() * direction };
+
+                            const auto even = values[start + i], odd = multiply(values[start + i + half], twiddle);
+                            values[start + i] = even + odd;
+                            values[start + i + half] = even - odd;
+                        }
+                    }
+                }
+            }
+
+            // std::complex's multiplication handles infinities and NaNs through a library call, which is far slower than the multiplication itself
+            [[nodiscard]] static std::complex<double> multiply(std::complex<double> a, std::complex<double> b) {
+                return { a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real() };
+            }
+
+        private:
+            size_t m_size;
+            std::vector<std::complex<double>> m_twiddles;
+            std::vector<size_t> m_bitReversed;
+        };
+
+        std::optional<double> calculateMean(const prv::Snapshot &snapshot, u64 address, u64 size, Task &task) {
+            std::vector<u8> buffer(ReadChunkSize);
+
+            u64 sum = 0;
+            for (u64 offset = 0; offset < size && !task.isCancelled(); offset += buffer.size()) {
+                const size_t readSize = std::min<u64>(buffer.size(), size - offset);
+                if (!snapshot.read(address + offset, buffer.data(), readSize))
+                    return std::nullopt;
+
+                for (size_t i = 0; i < readSize; i++)
+                    sum += buffer[i];
+            }
+
+            return double(sum) / double(size);
+        }
+
+        // Scores every stride and picks the best ones, replacing strides by their smallest divisor that scores almost as high
+        std::vector<StrideCandidate> pickCandidates(const std::vector<double> &autocorrelation) {
+            const u64 maxStride = autocorrelation.size() - 1;
+
+            std::vector<double> scores(maxStride + 1, 0);
+            for (u64 stride = 2; stride <= maxStride; stride++) {
+                double sum = 0;
+                for (u64 lag = stride; lag <= maxStride; lag += stride)
+                    sum += autocorrelation[lag];
+
+                scores[stride] = sum / double(maxStride / stride);
+            }
+
+            std::vector<u64> strides;
+            for (u64 stride = 2; stride <= maxStride / MinMultiples; stride++)
+                strides.push_back(stride);
+
+            std::sort(strides.begin(), strides.end(), [&](u64 left, u64 right) { return scores[left] > scores[right]; });
+
+            std::vector<StrideCandidate> candidates;
+            for (const u64 stride : strides) {
+                if (candidates.size() >= MaxCandidates || scores[stride] <= 0)
+                    break;
+
+                u64 fundamental = stride;
+                for (u64 divisor = 2; divisor < stride; divisor++) {
+                    if (stride % divisor == 0 && scores[divisor] >= scores[stride] * DivisorThreshold) {
+                        fundamental = divisor;
+                        break;
+                    }
+                }
+
+                if (std::none_of(candidates.begin(), candidates.end(), [&](const auto &candidate) { return candidate.stride == fundamental; }))
+                    candidates.push_back({ fundamental, scores[fundamental] });
+            }
+
+            return candidates;
+        }
+
+    }
+
+    std::optional<StrideAnalysis> analyzeStrides(const prv::Snapshot &snapshot, u64 address, u64 size, u64 maxStride, Task &task) {
+        maxStride = std::min(maxStride, size / 2);
+        if (maxStride < 2)
+            return std::nullopt;
+
+        // The region gets read front to back twice and is of no use afterwards, caches are better off keeping what's read interactively
+        snapshot.hintAccess(address, size, prv::AccessHint::Sequential);
+
+        const auto mean = calculateMean(snapshot, address, size, task);
+        if (!mean.has_value() || task.isCancelled()) {
+            snapshot.hintAccess(address, size, prv::AccessHint::DontNeed);
+            return std::nullopt;
+        }
+
+        /*
+         * Every block correlates its bytes with the ones up to the largest stride past its end, so the transforms need room for a block
+         * and the overlap to not wrap around. The block size is picked to fill up the rest of the transform, which is kept small enough
+         * to mostly stay in the cache while the overlap is never more than a quarter of it
+         */
+        const size_t transformSize = std::max(MinTransformSize, std::bit_ceil(size_t(maxStride) * 4));
+        const size_t blockSize = transformSize - maxStride;
+        const size_t blockCount = (size + blockSize - 1) / blockSize;
+
+        const FFT fft(transformSize);
+
+        struct ThreadState {
+            std::vector<u8> buffer;
+            std::vector<std::complex<double>> values, spectrum;
+            std::vector<double> blockProducts;
+        };
+
+        std::atomic<size_t> doneBlocks = 0;
+        std::atomic<bool> readFailed = false;
+
+        auto states = TaskManager::parallelFor<ThreadState>(task, blockCount, [&](size_t block, ThreadState &state) {
+            if (readFailed)
+                return;
+
+            if (state.buffer.empty()) {
+                state.buffer.resize(transformSize);
+                state.values.resize(transformSize);
+                state.spectrum.resize(transformSize);
+                state.blockProducts.resize(maxStride + 1, 0);
+            }
+
+            auto &values = state.values;
+            auto &spectrum = state.spectrum;
+
+            const u64 start = block * blockSize;
+            const size_t ownSize = std::min<u64>(blockSize, size - start);
+            const size_t readSize = std::min<u64>(transformSize, size - start);
+
+            if (!snapshot.read(address + start, state.buffer.data(), readSize)) {
+                readFailed = true;
+                return;
+            }
+
+            // The block's own bytes and the ones it gets correlated with are both real, so they share one transform as its real and imaginary parts
+            for (size_t j = 0; j < transformSize; j++) {
+                const double value = j < readSize ? state.buffer[j] - *mean : 0.0;
+                values[j] = { j < ownSize ? value : 0.0, value };
+            }
+
+            fft.transform(values, false);
+
+            for (size_t j = 0; j < transformSize; j++) {
+                const auto mirrored = std::conj(values[(transformSize - j) % transformSize]);
+                const auto own = (values[j] + mirrored) * 0.5, other = FFT::multiply(values[j] - mirrored, { 0, -0.5 });
+
+                spectrum[j] = FFT::multiply(std::conj(own), other);
+            }
+
+            fft.transform(spectrum, true);
+
+            for (size_t lag = 0; lag <= maxStride; lag++)
+                state.blockProducts[lag] += spectrum[lag].real() / double(transformSize);
+
+            task.setProgress(float(++doneBlocks) / blockCount);
+        });
+
+        std::vector<double> products(maxStride + 1, 0);
+        for (const auto &state : states) {
+            for (size_t lag = 0; lag < state.blockProducts.size(); lag++)
+                products[lag] += state.blockProducts[lag];
+        }
+
+        snapshot.hintAccess(address, size, prv::AccessHint::DontNeed);
+
+        if (readFailed || task.isCancelled())
+            return std::nullopt;
+
+        StrideAnalysis result;
+        result.autocorrelation.resize(maxStride + 1, 0);
+
+        // Larger lags have fewer pairs of bytes to sum up, so the products are averaged before normalizing them. Constant data doesn't correlate at all
+        const double variance = products[0] / double(size);
+        if (variance > 0) {
+            for (size_t lag = 0; lag <= maxStride; lag++)
+                result.autocorrelation[lag] = products[lag] / double(size - lag) / variance;
+        }
+
+        result.candidates = pickCandidates(result.autocorrelation);
+
+        return result;
+    }
+
+}
@@ -1,8 +1,10 @@
 #include "window.hpp"
 
 #include <hex/api/content_registry.hpp>
+#include <hex/api/task.hpp>
 #include <hex/providers/provider.hpp>
 #include <hex/lang/pattern_data.hpp>
+#include <hex/lang/pattern_index.hpp>
 #include <hex/helpers/utils.hpp>
 
 #include "views/view_hexeditor.hpp"
@@ -20,33 +22,79 @@
 #include "views/view_command_palette.hpp"
 #include "views/view_settings.hpp"
 #include "views/view_data_processor.hpp"
+#include "views/view_diff.hpp"
+#include "views/view_stride_analysis.hpp"
+#include "views/view_pointer_scanner.hpp"
+#include "views/view_bitmap.hpp"
+#include "views/view_digraph.hpp"
+#include "views/view_tasks.hpp"
+#include "views/view_batch_analysis.hpp"
 
+#include "providers/file_provider.hpp"
+#include "providers/disk_provider.hpp"
+
+#include "helpers/benchmark.hpp"
+#include "helpers/headless.hpp"
+#include "helpers/lang_hash_functions.hpp"
+#include "helpers/magic.hpp"
+#include "helpers/pattern_library.hpp"
+#include "helpers/scenarios.hpp"
+
+#include <string_view>
 #include <vector>
 
 int main(int argc, char **argv) {
     using namespace hex;
 
+    // Every mode may evaluate patterns, so the functions the plugins can't provide get registered first
+    registerHashPatternLanguageFunctions();
+
+    // Batch evaluation and benchmarks don't need a window, so nothing of the UI gets initialized
+    if (argc > 1 && std::string_view(argv[1]) == "--headless")
+        return runHeadless(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--benchmark")
+        return runBenchmarks(argc, argv);
+    if (argc > 1 && std::string_view(argv[1]) == "--scenarios")
+        return runScenarios(argc, argv);
+
     Window window(argc, argv);
 
+    // Loading the magic databases and indexing the pattern files takes a while, they're usually done by the time the first file gets identified
+    TaskManager::submit("Loading magic databases", [](Task&) { magic::preload(); });
+    TaskManager::submit("Indexing patterns", [](Task&) { pattern_library::refresh(); });
+
     // Shared Data
     std::vector<lang::PatternData*> patternData;
+    lang::PatternIndex patternIndex(patternData);
+
+    // Plugins get initialized afterwards, so providers they register take precedence over these. Block devices report a size of zero to stat
+    // and can't be mapped reliably, they're read sector by sector instead
+    ContentRegistry::Providers::add<prv::FileProvider>("File", [](const std::string&) { return true; });
+    ContentRegistry::Providers::add<prv::DiskProvider>("Disk", prv::DiskProvider::isDiskPath);
 
-    // Create views
-    ContentRegistry::Views::add<ViewHexEditor>(patternData);
+    // Create views. The deferred ones don't add any menu entries and only react to events while they're open, so they get created when first opened
+    ContentRegistry::Views::add<ViewHexEditor>(patternData, patternIndex);
     ContentRegistry::Views::add<ViewPattern>(patternData);
-    ContentRegistry::Views::add<ViewPatternData>(patternData);
+    ContentRegistry::Views::add<ViewPatternData>(patternData, patternIndex);
     ContentRegistry::Views::add<ViewDataInspector>();
     ContentRegistry::Views::add<ViewHashes>();
-    ContentRegistry::Views::add<ViewInformation>();
-    ContentRegistry::Views::add<ViewStrings>();
-    ContentRegistry::Views::add<ViewDisassembler>();
+    ContentRegistry::Views::addDeferred<ViewInformation>("Information");
+    ContentRegistry::Views::addDeferred<ViewStrings>("Strings");
+    ContentRegistry::Views::addDeferred<ViewDisassembler>("Disassembler");
     ContentRegistry::Views::add<ViewBookmarks>();
     ContentRegistry::Views::add<ViewPatches>();
-    ContentRegistry::Views::add<ViewTools>();
+    ContentRegistry::Views::addDeferred<ViewTools>("Tools");
     ContentRegistry::Views::add<ViewCommandPalette>();
     ContentRegistry::Views::add<ViewHelp>();
     ContentRegistry::Views::add<ViewSettings>();
-    ContentRegistry::Views::add<ViewDataProcessor>();
+    ContentRegistry::Views::addDeferred<ViewDataProcessor>("Data Processor");
+    ContentRegistry::Views::addDeferred<ViewDiff>("Diff");
+    ContentRegistry::Views::addDeferred<ViewStrideAnalysis>("Stride Analysis");
+    ContentRegistry::Views::addDeferred<ViewPointerScanner>("Pointer Scanner");
+    ContentRegistry::Views::addDeferred<ViewBitmap>("Bitmap Visualizer");
+    ContentRegistry::Views::addDeferred<ViewDigraph>("Digraph Plot");
+    ContentRegistry::Views::add<ViewTasks>();
+    ContentRegistry::Views::add<ViewBatchAnalysis>();
 
     if (argc > 1)
         View::postEvent(Events::FileDropped, argv[1]);
@@ -0,0 +1,569 @@
+#include "providers/compressed_provider.hpp"
+#include "providers/file_provider.hpp"
+
+#include <hex/api/content_registry.hpp>
+#include <hex/api/task.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include <zlib.h>
+#include <lzma.h>
+
+namespace hex::prv {
+
+    namespace {
+
+        constexpr size_t DeflateWindowSize = 0x8000;
+        constexpr size_t XZStreamHeaderSize = 12;
+
+    }
+
+    // State of the decompression that's currently in progress. Sequential reads keep using it, everything else restarts at a checkpoint
+    struct CompressedProvider::Decoder {
+        size_t checkpoint = 0;
+        u64 position = 0;
+        u64 inputEnd = 0;
+        bool finished = false;
+
+        std::vector<u8> input = std::vector<u8>(InputBufferSize);
+
+        z_stream zlib = { };
+        bool zlibActive = false;
+
+        lzma_stream lzma = LZMA_STREAM_INIT;
+        lzma_block block = { };
+        lzma_filter filters[LZMA_FILTERS_MAX + 1] = { };
+        bool lzmaActive = false;
+
+        ~Decoder() {
+            this->reset();
+        }
+
+        void reset() {
+            if (this->zlibActive)
+                inflateEnd(&this->zlib);
+
+            if (this->lzmaActive) {
+                lzma_end(&this->lzma);
+
+                for (auto &filter : this->filters) {
+                    if (filter.id == LZMA_VLI_UNKNOWN)
+                        break;
+
+                    free(filter.options);
+                }
+            }
+
+            this->zlib = { };
+            this->lzma = LZMA_STREAM_INIT;
+            this->block = { };
+            std::fill(std::begin(this->filters), std::end(this->filters), lzma_filter { LZMA_VLI_UNKNOWN, nullptr });
+            this->zlibActive = this->lzmaActive = false;
+            this->finished = false;
+        }
+    };
+
+    CompressedProvider::CompressedProvider(std::string_view path) : Provider(), m_path(path) {
+        this->m_format = detectFormat(this->m_path);
+        if (this->m_format != Format::GZip && this->m_format != Format::XZ)
+            return;
+
+        this->m_file = std::make_unique<FileProvider>(path);
+        if (!this->m_file->isAvailable()) {
+            this->m_file.reset();
+            return;
+        }
+
+        this->m_decoder = std::make_unique<Decoder>();
+
+        // Decompressing is slow compared to copying, so the cache holds a lot more than for plain files
+        this->enableBlockCache(0x1'0000, 0x400, 4);
+    }
+
+    CompressedProvider::~CompressedProvider() {
+        this->closeSnapshots();
+    }
+
+    CompressedProvider::Format CompressedProvider::detectFormat(const std::string &path) {
+        u8 magic[6] = { 0 };
+
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return Format::Unknown;
+
+        const size_t size = fread(magic, 1, sizeof(magic), file);
+        fclose(file);
+
+        if (size >= 2 && magic[0] == 0x1F && magic[1] == 0x8B)
+            return Format::GZip;
+        if (size >= 6 && std::memcmp(magic, "\xFD" "7zXZ\x00", 6) == 0)
+            return Format::XZ;
+        if (size >= 4 && std::memcmp(magic, "\x28\xB5\x2F\xFD", 4) == 0)
+            return Format::Zstandard;
+
+        return Format::Unknown;
+    }
+
+
+    bool CompressedProvider::isAvailable() {
+        return this->m_file != nullptr;
+    }
+
+    bool CompressedProvider::isReadable() {
+        return isAvailable() && this->m_indexed;
+    }
+
+    bool CompressedProvider::isWritable() {
+        return false;
+    }
+
+
+    size_t CompressedProvider::readCompressed(u64 offset, u8 *buffer, size_t size) {
+        const u64 fileSize = this->m_file->getRawSize();
+        if (offset >= fileSize)
+            return 0;
+
+        size = std::min<u64>(size, fileSize - offset);
+        this->m_file->readRaw(offset, buffer, size);
+
+        return size;
+    }
+
+    bool CompressedProvider::buildIndex(Task &task) {
+        if (!this->isAvailable())
+            return false;
+
+        std::vector<Checkpoint> checkpoints;
+        u64 size = 0;
+
+        bool succeeded = false;
+        switch (this->m_format) {
+            case Format::GZip:
+                succeeded = this->indexGZip(task, checkpoints, size);
+                break;
+            case Format::XZ:
+                succeeded = this->indexXZ(task, checkpoints, size);
+                break;
+            default:
+                break;
+        }
+
+        if (!succeeded || task.isCancelled())
+            return false;
+
+        {
+            std::scoped_lock lock(this->m_decoderMutex);
+
+            this->m_checkpoints = std::move(checkpoints);
+            this->m_decoder->reset();
+            this->m_decoder->position = ~u64(0);
+        }
+
+        if (this->m_blockCache != nullptr)
+            this->m_blockCache->invalidate();
+
+        this->m_size = size;
+        this->m_indexed = true;
+        this->m_dataGeneration++;
+
+        return true;
+    }
+
+    // Follows zran.c from the zlib examples. The deflate state can only be restored at the end of a deflate block, so that's where checkpoints are taken
+    bool CompressedProvider::indexGZip(Task &task, std::vector<Checkpoint> &checkpoints, u64 &size) {
+        const u64 fileSize = this->m_file->getRawSize();
+
+        // Keep the amount of windows in memory reasonable for large files
+        const u64 checkpointSpacing = std::max<u64>(MinCheckpointSpacing, fileSize / 0x800);
+
+        z_stream stream = { };
+        if (inflateInit2(&stream, 15 + 32) != Z_OK)
+            return false;
+
+        SCOPE_EXIT( inflateEnd(&stream); );
+
+        std::vector<u8> input(InputBufferSize), window(DeflateWindowSize);
+        u64 inputEnd = 0, totalIn = 0, totalOut = 0, lastCheckpoint = 0;
+
+        // Moves the input that wasn't consumed yet to the front of the buffer and fills up the rest
+        auto refill = [&] {
+            std::memmove(input.data(), stream.next_in, stream.avail_in);
+
+            const size_t read = this->readCompressed(inputEnd, input.data() + stream.avail_in, input.size() - stream.avail_in);
+            inputEnd += read;
+
+            stream.next_in = input.data();
+            stream.avail_in += read;
+
+            return read > 0;
+        };
+
+        checkpoints.push_back({ 0, 0, true, 0, 0, { } });
+
+        stream.next_in = input.data();
+        stream.avail_in = 0;
+
+        while (!task.isCancelled()) {
+            if (stream.avail_in == 0 && !refill())
+                break;
+
+            if (stream.avail_out == 0) {
+                stream.next_out = window.data();
+                stream.avail_out = window.size();
+            }
+
+            totalIn += stream.avail_in;
+            totalOut += stream.avail_out;
+            int result = inflate(&stream, Z_BLOCK);
+            totalIn -= stream.avail_in;
+            totalOut -= stream.avail_out;
+
+            if (result == Z_NEED_DICT || result == Z_DATA_ERROR || result == Z_MEM_ERROR || result == Z_STREAM_ERROR)
+                return false;
+
+            if (result == Z_STREAM_END) {
+                // gzip files may consist of multiple members, anything else after the end is ignored
+                if (stream.avail_in < 2)
+                    refill();
+
+                if (stream.avail_in < 2 || stream.next_in[0] != 0x1F || stream.next_in[1] != 0x8B)
+                    break;
+
+                if (inflateReset(&stream) != Z_OK)
+                    return false;
+
+                checkpoints.push_back({ totalOut, totalIn, true, 0, 0, { } });
+                lastCheckpoint = totalOut;
+            } else if ((stream.data_type & 128) != 0 && (stream.data_type & 64) == 0 && totalOut - lastCheckpoint >= checkpointSpacing) {
+                Checkpoint checkpoint = { totalOut, totalIn, false, u8(stream.data_type & 7), 0, std::vector<u8>(DeflateWindowSize) };
+
+                // The window is used as a ring buffer, the oldest data starts right where the next output goes
+                const size_t left = stream.avail_out;
+                std::memcpy(checkpoint.window.data(), window.data() + window.size() - left, left);
+                std::memcpy(checkpoint.window.data() + left, window.data(), window.size() - left);
+
+                checkpoints.push_back(std::move(checkpoint));
+                lastCheckpoint = totalOut;
+            }
+
+            task.setProgress(float(totalIn) / fileSize);
+        }
+
+        size = totalOut;
+
+        return true;
+    }
+
+    bool CompressedProvider::indexXZ(Task &task, std::vector<Checkpoint> &checkpoints, u64 &size) {
+        const u64 fileSize = this->m_file->getRawSize();
+
+        std::vector<u8> input(InputBufferSize), output(InputBufferSize);
+        u64 position = 0;
+        size = 0;
+
+        // Feeds the compressed data starting at position to stream until it ends, returns how much of it was consumed
+        auto consume = [&](lzma_stream &stream, u64 position, u64 &produced) -> std::optional<u64> {
+            u64 inputEnd = position;
+            lzma_ret result = LZMA_OK;
+
+            stream.avail_in = 0;
+            while (result == LZMA_OK && !task.isCancelled()) {
+                if (stream.avail_in == 0) {
+                    const size_t read = this->readCompressed(inputEnd, input.data(), input.size());
+                    if (read == 0)
+                        return { };
+
+                    inputEnd += read;
+                    stream.next_in = input.data();
+                    stream.avail_in = read;
+                }
+
+                stream.next_out = output.data();
+                stream.avail_out = output.size();
+
+                result = lzma_code(&stream, LZMA_RUN);
+                produced += output.size() - stream.avail_out;
+
+                task.setProgress(float(inputEnd - stream.avail_in) / fileSize);
+            }
+
+            if (result != LZMA_STREAM_END)
+                return { };
+
+            return (inputEnd - stream.avail_in) - position;
+        };
+
+        while (position + XZStreamHeaderSize <= fileSize && !task.isCancelled()) {
+            u8 header[XZStreamHeaderSize];
+            this->readCompressed(position, header, sizeof(header));
+
+            // Streams may be followed by padding in multiples of four null bytes
+            if (position != 0 && std::all_of(header, header + 4, [](u8 byte) { return byte == 0x00; })) {
+                position += 4;
+                continue;
+            }
+
+            lzma_stream_flags flags;
+            if (lzma_stream_header_decode(&flags, header) != LZMA_OK)
+                return position != 0;
+
+            position += XZStreamHeaderSize;
+
+            while (!task.isCancelled()) {
+                u8 blockHeader[LZMA_BLOCK_HEADER_SIZE_MAX];
+                if (this->readCompressed(position, blockHeader, 1) != 1)
+                    return false;
+
+                // An index indicator instead of a block header ends the stream. The index and the stream footer follow
+                if (blockHeader[0] == 0x00) {
+                    lzma_stream stream = LZMA_STREAM_INIT;
+                    lzma_index *index = nullptr;
+
+                    if (lzma_index_decoder(&stream, &index, UINT64_MAX) != LZMA_OK)
+                        return false;
+
+                    u64 produced = 0;
+                    auto indexSize = consume(stream, position, produced);
+                    lzma_end(&stream);
+                    lzma_index_end(index, nullptr);
+
+                    if (!indexSize.has_value())
+                        return false;
+
+                    position += *indexSize + LZMA_STREAM_HEADER_SIZE;
+                    break;
+                }
+
+                lzma_filter filters[LZMA_FILTERS_MAX + 1];
+                lzma_block block = { };
+                block.version = 0;
+                block.check = flags.check;
+                block.filters = filters;
+                block.header_size = lzma_block_header_size_decode(blockHeader[0]);
+
+                if (this->readCompressed(position, blockHeader, block.header_size) != block.header_size || lzma_block_header_decode(&block, nullptr, blockHeader) != LZMA_OK)
+                    return false;
+
+                SCOPE_EXIT(
+                    for (auto &filter : filters) {
+                        if (filter.id == LZMA_VLI_UNKNOWN)
+                            break;
+
+                        free(filter.options);
+                    }
+                );
+
+                checkpoints.push_back({ size, position, true, 0, u32(flags.check), { } });
+
+                // Multi-threaded xz stores the sizes in the block headers, those blocks don't have to be decompressed at all
+                if (block.compressed_size != LZMA_VLI_UNKNOWN && block.uncompressed_size != LZMA_VLI_UNKNOWN) {
+                    size += block.uncompressed_size;
+                    position += lzma_block_total_size(&block);
+                } else {
+                    lzma_stream stream = LZMA_STREAM_INIT;
+                    if (lzma_block_decoder(&stream, &block) != LZMA_OK)
+                        return false;
+
+                    u64 produced = 0;
+                    auto blockSize = consume(stream, position + block.header_size, produced);
+                    lzma_end(&stream);
+
+                    if (!blockSize.has_value())
+                        return false;
+
+                    size += produced;
+                    position += block.header_size + *blockSize;
+                }
+            }
+        }
+
+        return !task.isCancelled();
+    }
+
+
+    bool CompressedProvider::startDecoder(size_t checkpointIndex) {
+        auto &decoder = *this->m_decoder;
+        const auto &checkpoint = this->m_checkpoints[checkpointIndex];
+
+        decoder.reset();
+        decoder.checkpoint = checkpointIndex;
+        decoder.position = checkpoint.uncompressedOffset;
+        decoder.inputEnd = checkpoint.compressedOffset;
+
+        if (this->m_format == Format::GZip) {
+            decoder.zlibActive = inflateInit2(&decoder.zlib, checkpoint.streamStart ? 15 + 32 : -15) == Z_OK;
+            if (!decoder.zlibActive)
+                return false;
+
+            if (!checkpoint.streamStart) {
+                // The checkpoint may be in the middle of a byte, its remaining bits have to be fed in separately
+                if (checkpoint.bits != 0) {
+                    u8 byte = 0;
+                    this->readCompressed(checkpoint.compressedOffset - 1, &byte, 1);
+                    inflatePrime(&decoder.zlib, checkpoint.bits, byte >> (8 - checkpoint.bits));
+                }
+
+                inflateSetDictionary(&decoder.zlib, checkpoint.window.data(), checkpoint.window.size());
+            }
+        } else if (this->m_format == Format::XZ) {
+            u8 blockHeader[LZMA_BLOCK_HEADER_SIZE_MAX];
+            this->readCompressed(checkpoint.compressedOffset, blockHeader, 1);
+
+            decoder.block.version = 0;
+            decoder.block.check = lzma_check(checkpoint.check);
+            decoder.block.filters = decoder.filters;
+            decoder.block.header_size = lzma_block_header_size_decode(blockHeader[0]);
+
+            if (this->readCompressed(checkpoint.compressedOffset, blockHeader, decoder.block.header_size) != decoder.block.header_size)
+                return false;
+            if (lzma_block_header_decode(&decoder.block, nullptr, blockHeader) != LZMA_OK)
+                return false;
+
+            decoder.lzmaActive = true;
+            if (lzma_block_decoder(&decoder.lzma, &decoder.block) != LZMA_OK)
+                return false;
+
+            decoder.inputEnd += decoder.block.header_size;
+        }
+
+        return true;
+    }
+
+    size_t CompressedProvider::decode(u8 *buffer, size_t size) {
+        auto &decoder = *this->m_decoder;
+        size_t produced = 0;
+
+        while (produced < size && !decoder.finished) {
+            const bool inputEmpty = this->m_format == Format::GZip ? decoder.zlib.avail_in == 0 : decoder.lzma.avail_in == 0;
+
+            if (inputEmpty) {
+                const size_t read = this->readCompressed(decoder.inputEnd, decoder.input.data(), decoder.input.size());
+                if (read == 0) {
+                    decoder.finished = true;
+                    break;
+                }
+
+                decoder.inputEnd += read;
+
+                if (this->m_format == Format::GZip) {
+                    decoder.zlib.next_in = decoder.input.data();
+                    decoder.zlib.avail_in = read;
+                } else {
+                    decoder.lzma.next_in = decoder.input.data();
+                    decoder.lzma.avail_in = read;
+                }
+            }
+
+            bool streamEnd = false;
+            if (this->m_format == Format::GZip) {
+                decoder.zlib.next_out = buffer + produced;
+                decoder.zlib.avail_out = size - produced;
+
+                int result = inflate(&decoder.zlib, Z_NO_FLUSH);
+                produced = size - decoder.zlib.avail_out;
+
+                streamEnd = result == Z_STREAM_END;
+                if (result != Z_OK && result != Z_BUF_ERROR && !streamEnd)
+                    decoder.finished = true;
+            } else {
+                decoder.lzma.next_out = buffer + produced;
+                decoder.lzma.avail_out = size - produced;
+
+                lzma_ret result = lzma_code(&decoder.lzma, LZMA_RUN);
+                produced = size - decoder.lzma.avail_out;
+
+                streamEnd = result == LZMA_STREAM_END;
+                if (result != LZMA_OK && !streamEnd)
+                    decoder.finished = true;
+            }
+
+            // The next gzip member or xz block starts a new stream, all of them have a checkpoint
+            if (streamEnd) {
+                const u64 position = decoder.position + produced;
+
+                auto next = std::find_if(this->m_checkpoints.begin() + decoder.checkpoint + 1, this->m_checkpoints.end(), [](const Checkpoint &checkpoint) { return checkpoint.streamStart; });
+                if (next == this->m_checkpoints.end() || !this->startDecoder(next - this->m_checkpoints.begin()))
+                    decoder.finished = true;
+
+                decoder.position = position - produced;
+            }
+        }
+
+        decoder.position += produced;
+
+        return produced;
+    }
+
+    void CompressedProvider::readRaw(u64 offset, void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0 || !this->isReadable())
+            return;
+
+        std::memset(buffer, 0x00, size);
+
+        std::scoped_lock lock(this->m_decoderMutex);
+        auto &decoder = *this->m_decoder;
+
+        auto checkpoint = std::upper_bound(this->m_checkpoints.begin(), this->m_checkpoints.end(), offset, [](u64 offset, const Checkpoint &checkpoint) {
+            return offset < checkpoint.uncompressedOffset;
+        }) - 1;
+
+        // Continue decompressing where the last read stopped if that's closer than the checkpoint
+        if (decoder.finished || decoder.position > offset || checkpoint->uncompressedOffset > decoder.position) {
+            if (!this->startDecoder(checkpoint - this->m_checkpoints.begin())) {
+                decoder.position = ~u64(0);
+                return;
+            }
+        }
+
+        std::vector<u8> skipBuffer;
+        while (decoder.position < offset && !decoder.finished) {
+            skipBuffer.resize(std::min<u64>(InputBufferSize, offset - decoder.position));
+            this->decode(skipBuffer.data(), skipBuffer.size());
+        }
+
+        if (decoder.position == offset)
+            this->decode(static_cast<u8*>(buffer), size);
+    }
+
+    void CompressedProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
+
+    }
+
+    size_t CompressedProvider::getRawSize() {
+        return this->m_size;
+    }
+
+    std::string CompressedProvider::getName() const {
+        return std::filesystem::path(this->m_path).filename().string();
+    }
+
+    u32 CompressedProvider::getCapabilities() const {
+        return ContentRegistry::Providers::ThreadSafeReads;
+    }
+
+    std::vector<std::pair<std::string, std::string>> CompressedProvider::getDataInformation() {
+        std::vector<std::pair<std::string, std::string>> result;
+
+        result.emplace_back("File path", this->m_path);
+        if (!this->isAvailable())
+            return result;
+
+        result.emplace_back("Format", this->m_format == Format::GZip ? "gzip" : "xz");
+        result.emplace_back("Compressed size", hex::toByteString(this->m_file->getRawSize()));
+
+        if (this->m_indexed) {
+            result.emplace_back("Decompressed size", hex::toByteString(this->getRawSize()));
+            result.emplace_back("Checkpoints", std::to_string(this->m_checkpoints.size()));
+        } else {
+            result.emplace_back("Decompressed size", "Indexing...");
+        }
+
+        return result;
+    }
+
+}
@@ -0,0 +1,350 @@
+#include "providers/disk_provider.hpp"
+
+#include <hex/api/content_registry.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#if defined(OS_WINDOWS)
+#include <winioctl.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(OS_LINUX)
+#include <linux/fs.h>
+#elif defined(OS_MACOS)
+#include <sys/disk.h>
+#endif
+
+namespace hex::prv {
+
+    namespace {
+
+        u8* allocateAligned(size_t size, size_t alignment) {
+            #if defined(OS_WINDOWS)
+            return static_cast<u8*>(_aligned_malloc(size, alignment));
+            #else
+            return static_cast<u8*>(std::aligned_alloc(alignment, size));
+            #endif
+        }
+
+        void freeAligned(u8 *buffer) {
+            #if defined(OS_WINDOWS)
+            _aligned_free(buffer);
+            #else
+            std::free(buffer);
+            #endif
+        }
+
+    }
+
+    DiskProvider::DiskProvider(std::string_view path) : Provider(), m_path(path) {
+        #if defined(OS_WINDOWS)
+        std::wstring widePath;
+        {
+            auto length = path.length() + 1;
+            auto wideLength = MultiByteToWideChar(CP_UTF8, 0, path.data(), length, 0, 0);
+            wchar_t* buffer = new wchar_t[wideLength];
+            MultiByteToWideChar(CP_UTF8, 0, path.data(), length, buffer, wideLength);
+            widePath = buffer;
+            delete[] buffer;
+        }
+
+        // Disks are usually in use by the system as well, so they have to be shared for reading and writing
+        constexpr DWORD ShareMode = FILE_SHARE_READ | FILE_SHARE_WRITE;
+        this->m_writable = true;
+        this->m_disk = CreateFileW(widePath.data(), GENERIC_READ | GENERIC_WRITE, ShareMode, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+        if (this->m_disk == INVALID_HANDLE_VALUE) {
+            this->m_disk = CreateFileW(widePath.data(), GENERIC_READ, ShareMode, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+            this->m_writable = false;
+        }
+
+        if (this->m_disk == INVALID_HANDLE_VALUE) {
+            this->m_writable = false;
+            return;
+        }
+
+        this->m_unbuffered = true;
+
+        DWORD bytesReturned = 0;
+
+        GET_LENGTH_INFORMATION lengthInfo = { 0 };
+        if (DeviceIoControl(this->m_disk, IOCTL_DISK_GET_LENGTH_INFO, nullptr, 0, &lengthInfo, sizeof(lengthInfo), &bytesReturned, nullptr))
+            this->m_diskSize = lengthInfo.Length.QuadPart;
+
+        DISK_GEOMETRY geometry = { 0 };
+        if (DeviceIoControl(this->m_disk, IOCTL_DISK_GET_DRIVE_GEOMETRY, nullptr, 0, &geometry, sizeof(geometry), &bytesReturned, nullptr) && geometry.BytesPerSector != 0)
+            this->m_sectorSize = geometry.BytesPerSector;
+
+        #else
+        auto openDisk = [this](int mode) {
+            #if defined(OS_LINUX)
+            if (int disk = open(this->m_path.c_str(), mode | O_DIRECT); disk != -1) {
+                this->m_unbuffered = true;
+                return disk;
+            }
+            #endif
+
+            return open(this->m_path.c_str(), mode);
+        };
+
+        this->m_writable = true;
+        this->m_disk = openDisk(O_RDWR);
+        if (this->m_disk == -1) {
+            this->m_disk = openDisk(O_RDONLY);
+            this->m_writable = false;
+        }
+
+        if (this->m_disk == -1) {
+            this->m_writable = false;
+            return;
+        }
+
+        #if defined(OS_LINUX)
+        u64 diskSize = 0;
+        if (ioctl(this->m_disk, BLKGETSIZE64, &diskSize) == 0)
+            this->m_diskSize = diskSize;
+
+        int sectorSize = 0;
+        if (ioctl(this->m_disk, BLKSSZGET, &sectorSize) == 0 && sectorSize > 0)
+            this->m_sectorSize = sectorSize;
+        #elif defined(OS_MACOS)
+        u64 blockCount = 0;
+        u32 blockSize = 0;
+        if (ioctl(this->m_disk, DKIOCGETBLOCKCOUNT, &blockCount) == 0 && ioctl(this->m_disk, DKIOCGETBLOCKSIZE, &blockSize) == 0 && blockSize != 0) {
+            this->m_diskSize = blockCount * blockSize;
+            this->m_sectorSize = blockSize;
+        }
+
+        // macOS has no O_DIRECT, this turns off caching for the file descriptor instead. Alignment is only a performance concern there
+        fcntl(this->m_disk, F_NOCACHE, 1);
+        #endif
+
+        // Disk images and devices the ioctls don't know about at least report their size when seeking to their end
+        if (this->m_diskSize == 0) {
+            if (auto end = lseek(this->m_disk, 0, SEEK_END); end > 0)
+                this->m_diskSize = end;
+        }
+        #endif
+
+        if (this->m_diskSize == 0)
+            return;
+
+        this->m_bounceBuffer = allocateAligned(BounceBufferSize, std::max<size_t>(this->m_sectorSize, 0x1000));
+        if (this->m_bounceBuffer == nullptr)
+            return;
+
+        this->m_readable = true;
+
+        // Scans read the disk from start to end, so large blocks and a long read-ahead keep the device busy with big requests
+        this->enableBlockCache(0x1'0000, 0x400, 16);
+    }
+
+    DiskProvider::~DiskProvider() {
+        this->closeSnapshots();
+
+        #if defined(OS_WINDOWS)
+        if (this->m_disk != INVALID_HANDLE_VALUE)
+            CloseHandle(this->m_disk);
+        #else
+        if (this->m_disk != -1)
+            ::close(this->m_disk);
+        #endif
+
+        if (this->m_bounceBuffer != nullptr)
+            freeAligned(this->m_bounceBuffer);
+    }
+
+    bool DiskProvider::isDiskPath(const std::string &path) {
+        #if defined(OS_WINDOWS)
+        return path.starts_with("\\\\.\\") || path.starts_with("//./");
+        #else
+        struct stat fileStats = { 0 };
+        if (stat(path.c_str(), &fileStats) != 0)
+            return false;
+
+        #if defined(OS_MACOS)
+        // Raw disks (/dev/rdiskN) are character devices on macOS
+        if (S_ISCHR(fileStats.st_mode) && path.starts_with("/dev/rdisk"))
+            return true;
+        #endif
+
+        return S_ISBLK(fileStats.st_mode);
+        #endif
+    }
+
+
+    bool DiskProvider::isAvailable() {
+        return this->m_readable;
+    }
+
+    bool DiskProvider::isReadable() {
+        return isAvailable();
+    }
+
+    bool DiskProvider::isWritable() {
+        return isAvailable() && this->m_writable;
+    }
+
+
+    bool DiskProvider::canTransferDirectly(u64 offset, const void *buffer, size_t size) const {
+        if (!this->m_unbuffered)
+            return true;
+
+        return offset % this->m_sectorSize == 0 && size % this->m_sectorSize == 0 && reinterpret_cast<uintptr_t>(buffer) % this->m_sectorSize == 0;
+    }
+
+    bool DiskProvider::readSectors(u64 offset, void *buffer, size_t size) {
+        auto data = static_cast<u8*>(buffer);
+
+        while (size > 0) {
+            #if defined(OS_WINDOWS)
+            OVERLAPPED overlapped = { 0 };
+            overlapped.Offset     = offset & 0xFFFF'FFFF;
+            overlapped.OffsetHigh = offset >> 32;
+
+            DWORD bytesRead = 0;
+            if (!ReadFile(this->m_disk, data, std::min<size_t>(size, 0x4000'0000), &bytesRead, &overlapped))
+                return false;
+            #else
+            ssize_t bytesRead = ::pread(this->m_disk, data, size, offset);
+            if (bytesRead < 0 && errno == EINTR)
+                continue;
+            if (bytesRead < 0)
+                return false;
+            #endif
+
+            // End of the device, only possible in the last sector of devices with an odd size
+            if (bytesRead == 0) {
+                std::memset(data, 0x00, size);
+                break;
+            }
+
+            data   += bytesRead;
+            offset += bytesRead;
+            size   -= bytesRead;
+        }
+
+        return true;
+    }
+
+    bool DiskProvider::writeSectors(u64 offset, const void *buffer, size_t size) {
+        auto data = static_cast<const u8*>(buffer);
+
+        while (size > 0) {
+            #if defined(OS_WINDOWS)
+            OVERLAPPED overlapped = { 0 };
+            overlapped.Offset     = offset & 0xFFFF'FFFF;
+            overlapped.OffsetHigh = offset >> 32;
+
+            DWORD bytesWritten = 0;
+            if (!WriteFile(this->m_disk, data, std::min<size_t>(size, 0x4000'0000), &bytesWritten, &overlapped) || bytesWritten == 0)
+                return false;
+            #else
+            ssize_t bytesWritten = ::pwrite(this->m_disk, data, size, offset);
+            if (bytesWritten < 0 && errno == EINTR)
+                continue;
+            if (bytesWritten <= 0)
+                return false;
+            #endif
+
+            data   += bytesWritten;
+            offset += bytesWritten;
+            size   -= bytesWritten;
+        }
+
+        return true;
+    }
+
+    void DiskProvider::readRaw(u64 offset, void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0 || !this->isReadable())
+            return;
+
+        if (this->canTransferDirectly(offset, buffer, size)) {
+            if (!this->readSectors(offset, buffer, size))
+                std::memset(buffer, 0x00, size);
+            return;
+        }
+
+        std::scoped_lock lock(this->m_bounceBufferMutex);
+
+        const u64 end        = offset + size;
+        const u64 alignedEnd = end + (this->m_sectorSize - end % this->m_sectorSize) % this->m_sectorSize;
+
+        for (u64 chunk = offset - offset % this->m_sectorSize; chunk < end; chunk += BounceBufferSize) {
+            const size_t chunkSize = std::min<u64>(BounceBufferSize, alignedEnd - chunk);
+
+            // Sectors that can't be read are shown as zeros, the rest of the read still goes through
+            if (!this->readSectors(chunk, this->m_bounceBuffer, chunkSize))
+                std::memset(this->m_bounceBuffer, 0x00, chunkSize);
+
+            const u64 from = std::max(chunk, offset);
+            const u64 to   = std::min(chunk + chunkSize, end);
+
+            std::memcpy(static_cast<u8*>(buffer) + (from - offset), this->m_bounceBuffer + (from - chunk), to - from);
+        }
+    }
+
+    void DiskProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0 || !this->isWritable())
+            return;
+
+        if (this->canTransferDirectly(offset, buffer, size)) {
+            this->writeSectors(offset, buffer, size);
+            return;
+        }
+
+        std::scoped_lock lock(this->m_bounceBufferMutex);
+
+        const u64 end        = offset + size;
+        const u64 alignedEnd = end + (this->m_sectorSize - end % this->m_sectorSize) % this->m_sectorSize;
+
+        for (u64 chunk = offset - offset % this->m_sectorSize; chunk < end; chunk += BounceBufferSize) {
+            const size_t chunkSize = std::min<u64>(BounceBufferSize, alignedEnd - chunk);
+
+            const u64 from = std::max(chunk, offset);
+            const u64 to   = std::min(chunk + chunkSize, end);
+
+            // Sectors that are only partially overwritten have to keep the rest of their data
+            if ((from != chunk || to != chunk + chunkSize) && !this->readSectors(chunk, this->m_bounceBuffer, chunkSize))
+                return;
+
+            std::memcpy(this->m_bounceBuffer + (from - chunk), static_cast<const u8*>(buffer) + (from - offset), to - from);
+
+            if (!this->writeSectors(chunk, this->m_bounceBuffer, chunkSize))
+                return;
+        }
+    }
+
+    size_t DiskProvider::getRawSize() {
+        return this->m_diskSize;
+    }
+
+    std::string DiskProvider::getName() const {
+        return std::filesystem::path(this->m_path).filename().string();
+    }
+
+    u32 DiskProvider::getCapabilities() const {
+        return ContentRegistry::Providers::ThreadSafeReads;
+    }
+
+    std::vector<std::pair<std::string, std::string>> DiskProvider::getDataInformation() {
+        std::vector<std::pair<std::string, std::string>> result;
+
+        result.emplace_back("Disk path", this->m_path);
+        result.emplace_back("Size", hex::toByteString(this->getRawSize()));
+        result.emplace_back("Sector size", hex::format("%zu bytes", this->m_sectorSize));
+        result.emplace_back("Page cache", this->m_unbuffered ? "Bypassed" : "Used");
+
+        return result;
+    }
+
+}
@@ -0,0 +1,334 @@
+#include "providers/file_chunk_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if !defined(OS_WINDOWS)
+#include <unistd.h>
+#endif
+
+#if defined(FILE_CHUNK_READER_IO_URING)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace hex::prv {
+
+    FileChunkReader::FileChunkReader(u64 offset, u64 size, size_t chunkSize)
+        : m_offset(offset), m_size(size), m_chunkSize(chunkSize), m_chunkCount((size + chunkSize - 1) / chunkSize) {
+        const size_t depth = std::clamp<size_t>(BufferBudget / chunkSize, MinQueueDepth, MaxQueueDepth);
+
+        this->m_slots.resize(std::min<u64>(depth, std::max<u64>(this->m_chunkCount, 1)));
+        this->m_buffers.resize(this->m_slots.size() * chunkSize);
+    }
+
+    #if defined(OS_WINDOWS)
+    std::unique_ptr<FileChunkReader> FileChunkReader::create(HANDLE file, u64 offset, u64 size, size_t chunkSize) {
+        // Overlapped reads take their size as a DWORD
+        if (file == INVALID_HANDLE_VALUE || chunkSize == 0 || chunkSize > 0xFFFF'FFFF) {
+            if (file != INVALID_HANDLE_VALUE)
+                CloseHandle(file);
+            return nullptr;
+        }
+    #else
+    std::unique_ptr<FileChunkReader> FileChunkReader::create(int file, u64 offset, u64 size, size_t chunkSize) {
+        if (file == -1 || chunkSize == 0 || chunkSize > 0x7FFF'FFFF) {
+            if (file != -1)
+                close(file);
+            return nullptr;
+        }
+    #endif
+
+        std::unique_ptr<FileChunkReader> reader(new FileChunkReader(offset, size, chunkSize));
+        reader->m_file = file;
+
+        if (!reader->setup())
+            return nullptr;
+
+        for (size_t slot = 0; slot < reader->m_slots.size() && slot < reader->m_chunkCount; slot++) {
+            if (!reader->submit(slot, slot))
+                return nullptr;
+        }
+
+        return reader;
+    }
+
+    FileChunkReader::~FileChunkReader() {
+        // The kernel keeps writing into the buffers of queued reads, none of them may be left when the buffers go away
+        this->waitForAll();
+
+        #if defined(OS_WINDOWS)
+        for (auto &slot : this->m_slots) {
+            if (slot.overlapped.hEvent != nullptr)
+                CloseHandle(slot.overlapped.hEvent);
+        }
+
+        if (this->m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(this->m_file);
+        #else
+            #if defined(FILE_CHUNK_READER_IO_URING)
+            if (this->m_submissions != nullptr)
+                munmap(this->m_submissions, this->m_submissionsSize);
+            if (this->m_completionRing != nullptr && this->m_completionRing != this->m_submissionRing)
+                munmap(this->m_completionRing, this->m_completionRingSize);
+            if (this->m_submissionRing != nullptr)
+                munmap(this->m_submissionRing, this->m_submissionRingSize);
+            if (this->m_ring != -1)
+                close(this->m_ring);
+            #endif
+
+        if (this->m_file != -1)
+            close(this->m_file);
+        #endif
+    }
+
+    size_t FileChunkReader::getChunkSize(u64 chunk) const {
+        return std::min<u64>(this->m_chunkSize, this->m_size - chunk * this->m_chunkSize);
+    }
+
+    u8* FileChunkReader::next(size_t &size) {
+        if (this->m_failed || this->m_nextChunk >= this->m_chunkCount)
+            return nullptr;
+
+        // The caller is done with the chunk before the previous one, its slot reads the next chunk that isn't queued yet
+        if (this->m_nextChunk >= 2) {
+            const u64 doneChunk = this->m_nextChunk - 2;
+            const u64 queuedChunk = doneChunk + this->m_slots.size();
+
+            if (queuedChunk < this->m_chunkCount && !this->submit(doneChunk % this->m_slots.size(), queuedChunk)) {
+                this->m_failed = true;
+                return nullptr;
+            }
+        }
+
+        const size_t slot = this->m_nextChunk % this->m_slots.size();
+        if (!this->wait(slot)) {
+            this->m_failed = true;
+            return nullptr;
+        }
+
+        size = this->getChunkSize(this->m_nextChunk);
+        u8 *buffer = this->getBuffer(slot);
+
+        // Reads may return less than requested, the rest is read right away. Running into the end of the file means it got shorter meanwhile
+        for (size_t read = std::max<s64>(this->m_slots[slot].result, 0); read < size; ) {
+            #if defined(OS_WINDOWS)
+            OVERLAPPED overlapped = { 0 };
+            const u64 offset = this->m_offset + this->m_nextChunk * this->m_chunkSize + read;
+            overlapped.Offset = DWORD(offset & 0xFFFF'FFFF);
+            overlapped.OffsetHigh = DWORD(offset >> 32);
+            overlapped.hEvent = this->m_slots[slot].overlapped.hEvent;
+
+            DWORD result = 0;
+            if ((!ReadFile(this->m_file, buffer + read, DWORD(size - read), nullptr, &overlapped) && GetLastError() != ERROR_IO_PENDING) || !GetOverlappedResult(this->m_file, &overlapped, &result, TRUE))
+                result = 0;
+            #else
+            auto result = pread(this->m_file, buffer + read, size - read, this->m_offset + this->m_nextChunk * this->m_chunkSize + read);
+            #endif
+
+            if (result <= 0) {
+                this->m_failed = true;
+                return nullptr;
+            }
+
+            read += result;
+        }
+
+        this->m_nextChunk++;
+
+        return buffer;
+    }
+
+    void FileChunkReader::waitForAll() {
+        #if defined(OS_WINDOWS)
+        if (this->m_file != INVALID_HANDLE_VALUE)
+            CancelIoEx(this->m_file, nullptr);
+        #endif
+
+        for (size_t slot = 0; slot < this->m_slots.size(); slot++) {
+            if (this->m_slots[slot].pending && !this->wait(slot))
+                break;
+        }
+    }
+
+    #if defined(OS_WINDOWS)
+
+    bool FileChunkReader::setup() {
+        for (auto &slot : this->m_slots) {
+            slot.overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+            if (slot.overlapped.hEvent == nullptr)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool FileChunkReader::submit(size_t slot, u64 chunk) {
+        auto &entry = this->m_slots[slot];
+        const u64 offset = this->m_offset + chunk * this->m_chunkSize;
+
+        HANDLE event = entry.overlapped.hEvent;
+        entry.overlapped = { 0 };
+        entry.overlapped.Offset = DWORD(offset & 0xFFFF'FFFF);
+        entry.overlapped.OffsetHigh = DWORD(offset >> 32);
+        entry.overlapped.hEvent = event;
+        ResetEvent(event);
+
+        if (!ReadFile(this->m_file, this->getBuffer(slot), DWORD(this->getChunkSize(chunk)), nullptr, &entry.overlapped) && GetLastError() != ERROR_IO_PENDING)
+            return false;
+
+        entry.chunk = chunk;
+        entry.pending = true;
+
+        return true;
+    }
+
+    bool FileChunkReader::wait(size_t slot) {
+        auto &entry = this->m_slots[slot];
+
+        DWORD read = 0;
+        const bool succeeded = GetOverlappedResult(this->m_file, &entry.overlapped, &read, TRUE);
+
+        entry.pending = false;
+        entry.result = read;
+
+        return succeeded;
+    }
+
+    #elif defined(FILE_CHUNK_READER_IO_URING)
+
+    bool FileChunkReader::setup() {
+        io_uring_params params = { 0 };
+        this->m_ring = syscall(__NR_io_uring_setup, u32(this->m_slots.size()), &params);
+        if (this->m_ring < 0) {
+            this->m_ring = -1;
+            return false;
+        }
+
+        this->m_submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+        this->m_completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        // Newer kernels map both rings at once
+        const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMapping)
+            this->m_submissionRingSize = this->m_completionRingSize = std::max(this->m_submissionRingSize, this->m_completionRingSize);
+
+        auto map = [this](size_t size, u64 offset) -> void* {
+            void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->m_ring, offset);
+            return memory == MAP_FAILED ? nullptr : memory;
+        };
+
+        this->m_submissionRing = map(this->m_submissionRingSize, IORING_OFF_SQ_RING);
+        this->m_completionRing = singleMapping ? this->m_submissionRing : map(this->m_completionRingSize, IORING_OFF_CQ_RING);
+        this->m_submissionsSize = params.sq_entries * sizeof(io_uring_sqe);
+        this->m_submissions = static_cast<io_uring_sqe*>(map(this->m_submissionsSize, IORING_OFF_SQES));
+
+        if (this->m_submissionRing == nullptr || this->m_completionRing == nullptr || this->m_submissions == nullptr)
+            return false;
+
+        auto submissionRing = static_cast<u8*>(this->m_submissionRing);
+        this->m_submissionTail  = reinterpret_cast<u32*>(submissionRing + params.sq_off.tail);
+        this->m_submissionMask  = reinterpret_cast<u32*>(submissionRing + params.sq_off.ring_mask);
+        this->m_submissionArray = reinterpret_cast<u32*>(submissionRing + params.sq_off.array);
+
+        auto completionRing = static_cast<u8*>(this->m_completionRing);
+        this->m_completionHead = reinterpret_cast<u32*>(completionRing + params.cq_off.head);
+        this->m_completionTail = reinterpret_cast<u32*>(completionRing + params.cq_off.tail);
+        this->m_completionMask = reinterpret_cast<u32*>(completionRing + params.cq_off.ring_mask);
+        this->m_completions    = reinterpret_cast<io_uring_cqe*>(completionRing + params.cq_off.cqes);
+
+        // Registered buffers stay mapped in the kernel, so reads into them skip pinning the pages every time. Locked memory limits may not
+        // allow it, plain vectored reads work as well
+        std::vector<iovec> buffers;
+        for (size_t slot = 0; slot < this->m_slots.size(); slot++)
+            buffers.push_back({ this->getBuffer(slot), this->m_chunkSize });
+
+        this->m_fixedBuffers = syscall(__NR_io_uring_register, this->m_ring, IORING_REGISTER_BUFFERS, buffers.data(), u32(buffers.size())) == 0;
+
+        return true;
+    }
+
+    bool FileChunkReader::submit(size_t slot, u64 chunk) {
+        auto &entry = this->m_slots[slot];
+
+        // This is the only thread ever adding to the ring, only the kernel needs to see the new tail after the entry
+        const u32 tail = *this->m_submissionTail;
+        const u32 index = tail & *this->m_submissionMask;
+
+        io_uring_sqe &submission = this->m_submissions[index];
+        std::memset(&submission, 0x00, sizeof(submission));
+        submission.fd = this->m_file;
+        submission.off = this->m_offset + chunk * this->m_chunkSize;
+        submission.user_data = slot;
+
+        if (this->m_fixedBuffers) {
+            submission.opcode = IORING_OP_READ_FIXED;
+            submission.addr = reinterpret_cast<u64>(this->getBuffer(slot));
+            submission.len = this->getChunkSize(chunk);
+            submission.buf_index = slot;
+        } else {
+            entry.vector = { this->getBuffer(slot), this->getChunkSize(chunk) };
+            submission.opcode = IORING_OP_READV;
+            submission.addr = reinterpret_cast<u64>(&entry.vector);
+            submission.len = 1;
+        }
+
+        this->m_submissionArray[index] = index;
+        __atomic_store_n(this->m_submissionTail, tail + 1, __ATOMIC_RELEASE);
+
+        long submitted;
+        do {
+            submitted = syscall(__NR_io_uring_enter, this->m_ring, 1, 0, 0, nullptr, 0);
+        } while (submitted < 0 && errno == EINTR);
+
+        if (submitted != 1)
+            return false;
+
+        entry.chunk = chunk;
+        entry.pending = true;
+
+        return true;
+    }
+
+    bool FileChunkReader::wait(size_t slot) {
+        while (this->m_slots[slot].pending) {
+            u32 head = *this->m_completionHead;
+            const u32 tail = __atomic_load_n(this->m_completionTail, __ATOMIC_ACQUIRE);
+
+            for (; head != tail; head++) {
+                const auto &completion = this->m_completions[head & *this->m_completionMask];
+
+                auto &entry = this->m_slots[completion.user_data];
+                entry.pending = false;
+                entry.result = completion.res;
+            }
+
+            __atomic_store_n(this->m_completionHead, head, __ATOMIC_RELEASE);
+
+            if (this->m_slots[slot].pending) {
+                if (syscall(__NR_io_uring_enter, this->m_ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+                    return false;
+            }
+        }
+
+        return this->m_slots[slot].result >= 0;
+    }
+
+    #else
+
+    bool FileChunkReader::setup() {
+        return false;
+    }
+
+    bool FileChunkReader::submit(size_t, u64) {
+        return false;
+    }
+
+    bool FileChunkReader::wait(size_t) {
+        return false;
+    }
+
+    #endif
+
+}
@@ -1,9 +1,12 @@
 #include "providers/file_provider.hpp"
+#include "providers/file_chunk_reader.hpp"
+
+#include <hex/api/content_registry.hpp>
 
 #include <time.h>
+#include <algorithm>
 #include <cstring>
-
-#include "helpers/project_file_handler.hpp"
+#include <filesystem>
 
 #if defined(OS_WINDOWS)
 #include <locale>
@@ -30,15 +33,15 @@ namespace hex::prv {
         }
 
         LARGE_INTEGER fileSize = { 0 };
-        this->m_file = reinterpret_cast<HANDLE>(CreateFileW(widePath.data(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+        this->m_file = reinterpret_cast<HANDLE>(CreateFileW(widePath.data(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
 
         GetFileSizeEx(this->m_file, &fileSize);
         this->m_fileSize = fileSize.QuadPart;
         CloseHandle(this->m_file);
 
-        this->m_file = reinterpret_cast<HANDLE>(CreateFileW(widePath.data(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+        this->m_file = reinterpret_cast<HANDLE>(CreateFileW(widePath.data(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
         if (this->m_file == nullptr || this->m_file == INVALID_HANDLE_VALUE) {
-            this->m_file = reinterpret_cast<HANDLE>(CreateFileW(widePath.data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+            this->m_file = reinterpret_cast<HANDLE>(CreateFileW(widePath.data(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
             this->m_writable = false;
         }
 
@@ -62,16 +65,16 @@ namespace hex::prv {
             CloseHandle(this->m_mapping);
         });
 
-        this->m_mappedFile = MapViewOfFile(this->m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, this->m_fileSize);
-        if (this->m_mappedFile == nullptr) {
-            this->m_readable = false;
-            return;
-        }
+        // Large files only get mapped in windows on demand
+        if (this->m_fileSize <= FullMappingLimit)
+            this->m_mappedFile = MapViewOfFile(this->m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, this->m_fileSize);
+
+        this->m_windowed = this->m_mappedFile == nullptr;
 
         fileCleanup.release();
         mappingCleanup.release();
 
-        ProjectFile::setFilePath(path);
+        this->m_watcher = std::make_unique<FileWatcher>(this->m_path);
 
         #else
             this->m_file = open(path.data(), O_RDWR);
@@ -87,12 +90,26 @@ namespace hex::prv {
 
             this->m_fileSize = this->m_fileStats.st_size;
 
-            this->m_mappedFile = mmap(nullptr, this->m_fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, this->m_file, 0);
+            // Large files only get mapped in windows on demand
+            if (this->m_fileSize <= FullMappingLimit) {
+                this->m_mappedFile = mmap(nullptr, this->m_fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, this->m_file, 0);
+                if (this->m_mappedFile == MAP_FAILED)
+                    this->m_mappedFile = nullptr;
+            }
+
+            this->m_windowed = this->m_mappedFile == nullptr;
+
+            this->m_watcher = std::make_unique<FileWatcher>(this->m_path);
 
         #endif
     }
 
     FileProvider::~FileProvider() {
+        this->closeSnapshots();
+
+        for (auto &window : this->m_windows)
+            this->unmapWindow(window);
+
         #if defined(OS_WINDOWS)
         if (this->m_mappedFile != nullptr)
             UnmapViewOfFile(this->m_mappedFile);
@@ -101,7 +118,8 @@ namespace hex::prv {
         if (this->m_file != nullptr)
             CloseHandle(this->m_file);
         #else
-        munmap(this->m_mappedFile, this->m_fileSize);
+        if (this->m_mappedFile != nullptr)
+            munmap(this->m_mappedFile, this->m_fileSize);
         close(this->m_file);
         #endif
     }
@@ -109,9 +127,9 @@ namespace hex::prv {
 
     bool FileProvider::isAvailable() {
         #if defined(OS_WINDOWS)
-        return this->m_file != nullptr && this->m_mapping != nullptr && this->m_mappedFile != nullptr;
+        return this->m_file != nullptr && this->m_mapping != nullptr && (this->m_windowed || this->m_mappedFile != nullptr);
         #else
-        return this->m_file != -1 && this->m_mappedFile != nullptr;
+        return this->m_file != -1 && (this->m_windowed || this->m_mappedFile != nullptr);
         #endif
     }
 
@@ -124,49 +142,299 @@ namespace hex::prv {
     }
 
 
-    void FileProvider::read(u64 offset, void *buffer, size_t size) {
-        if ((offset + size) > this->getSize() || buffer == nullptr || size == 0)
+    void FileProvider::readRaw(u64 offset, void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0)
             return;
 
-        std::memcpy(buffer, reinterpret_cast<u8*>(this->m_mappedFile) + PageSize * this->m_currPage + offset, size);
+        if (!this->m_windowed) {
+            std::memcpy(buffer, reinterpret_cast<u8*>(this->m_mappedFile) + offset, size);
+            return;
+        }
+
+        std::scoped_lock lock(this->m_windowMutex);
+
+        for (u64 copied = 0; copied < size; ) {
+            size_t availableSize = 0;
+            auto data = this->getMappedData(offset + copied, availableSize);
+            if (data == nullptr)
+                return;
+
+            size_t copySize = std::min<u64>(size - copied, availableSize);
+            std::memcpy(reinterpret_cast<u8*>(buffer) + copied, data, copySize);
+            copied += copySize;
+        }
+    }
+
+    const u8* FileProvider::getResidentData(u64 offset, size_t size) {
+        // Windows get unmapped while other reads are going on, only a full mapping stays valid
+        if (this->m_windowed || this->m_mappedFile == nullptr || (offset + size) > this->getRawSize())
+            return nullptr;
 
-        for (u64 i = 0; i < size; i++)
-            if (this->m_patches.back().contains(offset + i))
-                reinterpret_cast<u8*>(buffer)[i] = this->m_patches.back()[offset + PageSize * this->m_currPage + i];
+        return reinterpret_cast<const u8*>(this->m_mappedFile) + offset;
     }
 
-    void FileProvider::write(u64 offset, const void *buffer, size_t size) {
-        if ((offset + size) > this->getSize() || buffer == nullptr || size == 0)
+    void FileProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0)
+            return;
+
+        #if defined(OS_WINDOWS)
+        if (!this->m_windowed) {
+            std::memcpy(reinterpret_cast<u8*>(this->m_mappedFile) + offset, buffer, size);
             return;
+        }
 
-        this->m_patches.push_back(this->m_patches.back());
+        std::scoped_lock lock(this->m_windowMutex);
 
-        for (u64 i = 0; i < size; i++)
-            this->m_patches.back()[offset + this->getBaseAddress() + i] = reinterpret_cast<const u8*>(buffer)[i];
-    }
+        // Views of the file mapping are shared, writing through them ends up in the file
+        for (u64 copied = 0; copied < size; ) {
+            size_t availableSize = 0;
+            auto data = this->getMappedData(offset + copied, availableSize);
+            if (data == nullptr)
+                return;
 
-    void FileProvider::readRaw(u64 offset, void *buffer, size_t size) {
-        if ((offset + size) > this->getSize() || buffer == nullptr || size == 0)
+            size_t copySize = std::min<u64>(size - copied, availableSize);
+            std::memcpy(data, reinterpret_cast<const u8*>(buffer) + copied, copySize);
+            copied += copySize;
+        }
+        #else
+        std::scoped_lock lock(this->m_windowMutex);
+
+        // Mappings are private, so write to the file directly and keep the mapped data in sync
+        for (u64 written = 0; written < size; ) {
+            auto result = pwrite(this->m_file, reinterpret_cast<const u8*>(buffer) + written, size - written, offset + written);
+            if (result <= 0)
+                break;
+
+            written += result;
+        }
+
+        // Writing to the file notifies its watcher as well, but the mapped data is already up to date
+        if (this->m_watcher != nullptr)
+            this->m_watcher->ignoreChanges();
+
+        if (!this->m_windowed) {
+            std::memcpy(reinterpret_cast<u8*>(this->m_mappedFile) + offset, buffer, size);
             return;
+        }
 
-        std::memcpy(buffer, reinterpret_cast<u8*>(this->m_mappedFile) + PageSize * this->m_currPage + offset, size);
+        for (auto &window : this->m_windows) {
+            u64 from = std::max<u64>(window.offset, offset);
+            u64 to   = std::min<u64>(window.offset + window.size, offset + size);
+
+            if (from < to)
+                std::memcpy(window.data + (from - window.offset), reinterpret_cast<const u8*>(buffer) + (from - offset), to - from);
+        }
+        #endif
     }
 
-    void FileProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
-        if ((offset + size) > this->getSize() || buffer == nullptr || size == 0)
+    void FileProvider::hintRawAccess(u64 offset, size_t size, AccessHint hint) {
+        if (offset >= this->m_fileSize || size == 0)
             return;
 
-        std::memcpy(reinterpret_cast<u8*>(this->m_mappedFile) + PageSize * this->m_currPage + offset, buffer, size);
+        size = std::min<u64>(size, this->m_fileSize - offset);
+
+        #if defined(OS_WINDOWS)
+            // Prefetching is the only hint Windows takes, and only for mapped memory
+            #if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+            if (hint == AccessHint::WillNeed && !this->m_windowed && this->m_mappedFile != nullptr) {
+                WIN32_MEMORY_RANGE_ENTRY range = { reinterpret_cast<u8*>(this->m_mappedFile) + offset, size };
+                PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+            }
+            #endif
+        #else
+            // Windows of a windowed file come and go, their pages get the hint through the page cache instead
+            #if defined(POSIX_FADV_SEQUENTIAL)
+            int fileAdvice = POSIX_FADV_NORMAL;
+            switch (hint) {
+                case AccessHint::Sequential:  fileAdvice = POSIX_FADV_SEQUENTIAL; break;
+                case AccessHint::Random:      fileAdvice = POSIX_FADV_RANDOM; break;
+                case AccessHint::WillNeed:    fileAdvice = POSIX_FADV_WILLNEED; break;
+                case AccessHint::DontNeed:    fileAdvice = POSIX_FADV_DONTNEED; break;
+            }
+            posix_fadvise(this->m_file, offset, size, fileAdvice);
+            #endif
+
+            if (this->m_windowed || this->m_mappedFile == nullptr)
+                return;
+
+            // Pages the mapping modified only exist in memory, nothing that throws them away may be used on it. Those are only moved to the
+            // front of the line for reclaiming once they aren't needed anymore
+            int memoryAdvice = -1;
+            switch (hint) {
+                case AccessHint::Sequential:  memoryAdvice = MADV_SEQUENTIAL; break;
+                case AccessHint::Random:      memoryAdvice = MADV_RANDOM; break;
+                case AccessHint::WillNeed:    memoryAdvice = MADV_WILLNEED; break;
+                case AccessHint::DontNeed:
+                    #if defined(MADV_COLD)
+                    memoryAdvice = MADV_COLD;
+                    #endif
+                    break;
+            }
+
+            if (memoryAdvice == -1)
+                return;
+
+            const u64 pageSize = sysconf(_SC_PAGESIZE);
+            const u64 start = offset - (offset % pageSize);
+            madvise(reinterpret_cast<u8*>(this->m_mappedFile) + start, size + (offset - start), memoryAdvice);
+        #endif
+    }
+
+    std::unique_ptr<ChunkReader> FileProvider::readRawChunks(u64 offset, u64 size, size_t chunkSize) {
+        // Mapped files that fit into memory as a whole are read just as fast through the mapping, larger ones would keep mapping windows
+        if (!this->m_windowed || offset + size > this->m_fileSize)
+            return nullptr;
+
+        #if defined(OS_WINDOWS)
+        auto widePath = std::filesystem::u8path(this->m_path).wstring();
+        HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        return FileChunkReader::create(file, offset, size, chunkSize);
+        #else
+        return FileChunkReader::create(dup(this->m_file), offset, size, chunkSize);
+        #endif
+    }
+
+    bool FileProvider::pollExternalChanges() {
+        if (this->m_watcher == nullptr || !this->m_watcher->poll())
+            return false;
+
+        this->remap();
+
+        return true;
+    }
+
+    void FileProvider::remap() {
+        // Snapshots can't read while the mapping is replaced, once it's done they're all stale
+        this->replaceRawData([this] {
+            std::scoped_lock lock(this->m_windowMutex);
+
+            for (auto &window : this->m_windows)
+                this->unmapWindow(window);
+            this->m_windows.clear();
+
+            this->m_fileStatsValid = stat(this->m_path.c_str(), &this->m_fileStats) == 0;
+
+            #if defined(OS_WINDOWS)
+            if (this->m_mappedFile != nullptr)
+                UnmapViewOfFile(this->m_mappedFile);
+            if (this->m_mapping != nullptr)
+                CloseHandle(this->m_mapping);
+            this->m_mappedFile = nullptr;
+
+            // The size of a file mapping is fixed, data that got appended is only part of a new one
+            LARGE_INTEGER fileSize = { 0 };
+            GetFileSizeEx(this->m_file, &fileSize);
+            this->m_fileSize = fileSize.QuadPart;
+
+            this->m_mapping = CreateFileMapping(this->m_file, nullptr, PAGE_READWRITE, fileSize.HighPart, fileSize.LowPart, nullptr);
+            if (this->m_mapping == INVALID_HANDLE_VALUE)
+                this->m_mapping = nullptr;
+
+            if (this->m_mapping != nullptr && this->m_fileSize <= FullMappingLimit)
+                this->m_mappedFile = MapViewOfFile(this->m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, this->m_fileSize);
+            #else
+            if (this->m_mappedFile != nullptr)
+                munmap(this->m_mappedFile, this->m_fileSize);
+            this->m_mappedFile = nullptr;
+
+            // Editors that save by replacing the file leave the old one open here, the one that took its place is opened instead
+            struct stat fileStats = { 0 };
+            if (this->m_fileStatsValid && fstat(this->m_file, &fileStats) == 0 && (fileStats.st_ino != this->m_fileStats.st_ino || fileStats.st_dev != this->m_fileStats.st_dev)) {
+                int file = open(this->m_path.c_str(), this->m_writable ? O_RDWR : O_RDONLY);
+                if (file != -1) {
+                    close(this->m_file);
+                    this->m_file = file;
+                    this->m_watcher->rewatch();
+                }
+            }
+
+            if (fstat(this->m_file, &fileStats) == 0)
+                this->m_fileSize = fileStats.st_size;
+
+            if (this->m_fileSize <= FullMappingLimit) {
+                this->m_mappedFile = mmap(nullptr, this->m_fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, this->m_file, 0);
+                if (this->m_mappedFile == MAP_FAILED)
+                    this->m_mappedFile = nullptr;
+            }
+            #endif
+
+            this->m_windowed = this->m_mappedFile == nullptr;
+        });
+    }
+
+    u8* FileProvider::getMappedData(u64 offset, size_t &availableSize) {
+        for (auto &window : this->m_windows) {
+            if (offset >= window.offset && offset < window.offset + window.size) {
+                window.lastUse = ++this->m_windowUseCounter;
+                availableSize = window.offset + window.size - offset;
+                return window.data + (offset - window.offset);
+            }
+        }
+
+        if (this->m_windows.size() >= MaxWindows) {
+            auto leastRecentlyUsed = std::min_element(this->m_windows.begin(), this->m_windows.end(), [](const auto &left, const auto &right) {
+                return left.lastUse < right.lastUse;
+            });
+
+            this->unmapWindow(*leastRecentlyUsed);
+            this->m_windows.erase(leastRecentlyUsed);
+        }
+
+        MappedWindow window = { 0 };
+        window.offset = offset - (offset % WindowSize);
+        window.size = std::min<u64>(WindowSize, this->m_fileSize - window.offset);
+        window.lastUse = ++this->m_windowUseCounter;
+
+        #if defined(OS_WINDOWS)
+        window.data = reinterpret_cast<u8*>(MapViewOfFile(this->m_mapping, FILE_MAP_ALL_ACCESS, DWORD(window.offset >> 32), DWORD(window.offset & 0xFFFF'FFFF), window.size));
+        if (window.data == nullptr)
+            return nullptr;
+        #else
+        void *data = mmap(nullptr, window.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, this->m_file, window.offset);
+        if (data == MAP_FAILED)
+            return nullptr;
+        window.data = reinterpret_cast<u8*>(data);
+        #endif
+
+        this->m_windows.push_back(window);
+
+        availableSize = window.offset + window.size - offset;
+        return window.data + (offset - window.offset);
     }
-    size_t FileProvider::getActualSize() {
+
+    void FileProvider::unmapWindow(MappedWindow &window) {
+        #if defined(OS_WINDOWS)
+        UnmapViewOfFile(window.data);
+        #else
+        munmap(window.data, window.size);
+        #endif
+
+        window.data = nullptr;
+    }
+
+    size_t FileProvider::getRawSize() {
         return this->m_fileSize;
     }
 
+    std::string FileProvider::getName() const {
+        return std::filesystem::path(this->m_path).filename().string();
+    }
+
+    u32 FileProvider::getCapabilities() const {
+        // Large files are only mapped in windows, which may get unmapped while their data is still in use
+        if (this->m_windowed || this->m_mappedFile == nullptr)
+            return ContentRegistry::Providers::ThreadSafeReads;
+
+        return ContentRegistry::Providers::Mappable | ContentRegistry::Providers::ChunkSpans | ContentRegistry::Providers::ThreadSafeReads;
+    }
+
     std::vector<std::pair<std::string, std::string>> FileProvider::getDataInformation() {
         std::vector<std::pair<std::string, std::string>> result;
 
         result.emplace_back("File path", this->m_path);
-        result.emplace_back("Size", hex::toByteString(this->getActualSize()));
+        result.emplace_back("Size", hex::toByteString(this->getRawSize()));
+        result.emplace_back("Mapping", this->m_windowed ? hex::format("%zu windows of %s", MaxWindows, hex::toByteString(WindowSize).c_str()) : "Entire file");
 
         if (this->m_fileStatsValid) {
             result.emplace_back("Creation time", ctime(&this->m_fileStats.st_ctime));
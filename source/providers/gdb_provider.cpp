@@ -0,0 +1,391 @@
+#include "providers/gdb_provider.hpp"
+
+#include <hex/api/content_registry.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#if defined(OS_WINDOWS)
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
+
+namespace hex::prv {
+
+    namespace {
+
+        constexpr const char *HexDigits = "0123456789abcdef";
+
+        u8 calculateChecksum(const std::string &data) {
+            u8 checksum = 0;
+            for (char c : data)
+                checksum += u8(c);
+
+            return checksum;
+        }
+
+        std::optional<u8> parseHexDigit(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+            return { };
+        }
+
+        bool decodeHex(const std::string &hexString, u8 *buffer, size_t size) {
+            if (hexString.size() != size * 2)
+                return false;
+
+            for (size_t i = 0; i < size; i++) {
+                auto high = parseHexDigit(hexString[i * 2]), low = parseHexDigit(hexString[i * 2 + 1]);
+                if (!high.has_value() || !low.has_value())
+                    return false;
+
+                buffer[i] = (*high << 4) | *low;
+            }
+
+            return true;
+        }
+
+        // Packet data may be escaped with '}' and run length encoded with '*' followed by the repeat count + 29
+        std::string decodePacketData(const std::string &data) {
+            std::string result;
+            result.reserve(data.size());
+
+            for (size_t i = 0; i < data.size(); i++) {
+                if (data[i] == '}' && i + 1 < data.size()) {
+                    result += char(data[++i] ^ 0x20);
+                } else if (data[i] == '*' && i + 1 < data.size() && !result.empty()) {
+                    result.append(u8(data[++i]) - 29, result.back());
+                } else {
+                    result += data[i];
+                }
+            }
+
+            return result;
+        }
+
+    }
+
+    GDBProvider::GDBProvider(std::string host, u16 port, u64 size) : Provider(), m_host(std::move(host)), m_port(port), m_size(size) {
+        if (!this->connect())
+            return;
+
+        this->negotiateFeatures();
+
+        // Pages are fetched in large sequential batches, a cache miss costs a round trip no matter how much data it fetches
+        this->enableBlockCache(0x1000, 0x1000, 32);
+    }
+
+    GDBProvider::~GDBProvider() {
+        this->closeSnapshots();
+
+        this->disconnect();
+    }
+
+
+    bool GDBProvider::isAvailable() {
+        return this->m_connected;
+    }
+
+    bool GDBProvider::isReadable() {
+        return isAvailable();
+    }
+
+    bool GDBProvider::isWritable() {
+        return isAvailable();
+    }
+
+
+    bool GDBProvider::connect() {
+        #if defined(OS_WINDOWS)
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+            return false;
+        #endif
+
+        addrinfo hints = { 0 }, *addresses = nullptr;
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        if (getaddrinfo(this->m_host.c_str(), std::to_string(this->m_port).c_str(), &hints, &addresses) != 0)
+            return false;
+
+        for (auto address = addresses; address != nullptr; address = address->ai_next) {
+            this->m_socket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (this->m_socket == InvalidSocket)
+                continue;
+
+            if (::connect(this->m_socket, address->ai_addr, address->ai_addrlen) == 0)
+                break;
+
+            #if defined(OS_WINDOWS)
+            closesocket(this->m_socket);
+            #else
+            ::close(this->m_socket);
+            #endif
+            this->m_socket = InvalidSocket;
+        }
+
+        freeaddrinfo(addresses);
+
+        if (this->m_socket == InvalidSocket)
+            return false;
+
+        // Requests are small and latency is what matters, don't let them sit in the send buffer
+        int noDelay = 1;
+        setsockopt(this->m_socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+        // A server that stopped answering shouldn't freeze the interface forever
+        #if defined(OS_WINDOWS)
+        DWORD timeout = 5000;
+        #else
+        timeval timeout = { 5, 0 };
+        #endif
+        setsockopt(this->m_socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+
+        this->m_connected = true;
+
+        return true;
+    }
+
+    void GDBProvider::disconnect() {
+        if (this->m_socket != InvalidSocket) {
+            // Not detaching on purpose, most probes resume the target when they're told to detach
+            #if defined(OS_WINDOWS)
+            closesocket(this->m_socket);
+            WSACleanup();
+            #else
+            ::close(this->m_socket);
+            #endif
+        }
+
+        this->m_socket = InvalidSocket;
+        this->m_connected = false;
+    }
+
+    void GDBProvider::negotiateFeatures() {
+        auto features = this->transact("qSupported:swbreak+;hwbreak+");
+        if (!features.has_value()) {
+            this->disconnect();
+            return;
+        }
+
+        bool supportsNoAckMode = false;
+        for (const auto &feature : hex::splitString(*features, ";")) {
+            if (feature.starts_with("PacketSize=")) {
+                size_t packetSize = 0;
+                std::from_chars(feature.data() + 11, feature.data() + feature.size(), packetSize, 16);
+
+                if (packetSize >= 0x40)
+                    this->m_packetSize = packetSize;
+            } else if (feature == "QStartNoAckMode+") {
+                supportsNoAckMode = true;
+            }
+        }
+
+        // Without acknowledgements every packet only takes a single trip through the link
+        if (supportsNoAckMode && this->transact("QStartNoAckMode") == "OK")
+            this->m_noAckMode = true;
+    }
+
+
+    bool GDBProvider::sendAll(const char *data, size_t size) {
+        while (size > 0) {
+            auto sent = send(this->m_socket, data, size, 0);
+            if (sent <= 0)
+                return false;
+
+            data += sent;
+            size -= sent;
+        }
+
+        return true;
+    }
+
+    int GDBProvider::receiveByte() {
+        if (this->m_receivePosition >= this->m_receiveBuffer.size()) {
+            this->m_receiveBuffer.resize(0x1'0000);
+            this->m_receivePosition = 0;
+
+            auto received = recv(this->m_socket, this->m_receiveBuffer.data(), this->m_receiveBuffer.size(), 0);
+            if (received <= 0) {
+                this->m_receiveBuffer.clear();
+                this->m_connected = false;
+                return -1;
+            }
+
+            this->m_receiveBuffer.resize(received);
+        }
+
+        return u8(this->m_receiveBuffer[this->m_receivePosition++]);
+    }
+
+    bool GDBProvider::sendPacket(const std::string &data) {
+        if (!this->m_connected)
+            return false;
+
+        auto checksum = calculateChecksum(data);
+
+        std::string packet;
+        packet.reserve(data.size() + 4);
+        packet += '$';
+        packet += data;
+        packet += '#';
+        packet += HexDigits[checksum >> 4];
+        packet += HexDigits[checksum & 0x0F];
+
+        this->m_packets++;
+
+        if (!this->sendAll(packet.data(), packet.size())) {
+            this->m_connected = false;
+            return false;
+        }
+
+        return true;
+    }
+
+    std::optional<std::string> GDBProvider::receivePacket() {
+        int c;
+
+        // Skip over acknowledgements of the packets sent earlier
+        do {
+            c = this->receiveByte();
+            if (c == '-' || c == -1)
+                return { };
+        } while (c != '$');
+
+        std::string data;
+        while ((c = this->receiveByte()) != '#') {
+            if (c == -1)
+                return { };
+
+            data += char(c);
+        }
+
+        int high = this->receiveByte(), low = this->receiveByte();
+        if (high == -1 || low == -1)
+            return { };
+
+        auto checksumHigh = parseHexDigit(high), checksumLow = parseHexDigit(low);
+        const bool valid = checksumHigh.has_value() && checksumLow.has_value() && ((*checksumHigh << 4) | *checksumLow) == calculateChecksum(data);
+
+        if (!this->m_noAckMode)
+            this->sendAll(valid ? "+" : "-", 1);
+
+        if (!valid)
+            return { };
+
+        return decodePacketData(data);
+    }
+
+    std::optional<std::string> GDBProvider::transact(const std::string &data) {
+        if (!this->sendPacket(data))
+            return { };
+
+        return this->receivePacket();
+    }
+
+    void GDBProvider::pipeline(const std::vector<Request> &requests, bool write) {
+        size_t nextRequest = 0, nextReply = 0;
+
+        while (nextReply < requests.size() && this->m_connected) {
+            while (nextRequest < requests.size() && nextRequest - nextReply < MaxPipelinedRequests) {
+                const auto &request = requests[nextRequest];
+
+                std::string packet = hex::format(write ? "M%llx,%zx:" : "m%llx,%zx", request.address, request.size);
+                if (write) {
+                    packet.reserve(packet.size() + request.size * 2);
+                    for (size_t i = 0; i < request.size; i++) {
+                        packet += HexDigits[request.buffer[i] >> 4];
+                        packet += HexDigits[request.buffer[i] & 0x0F];
+                    }
+                }
+
+                if (!this->sendPacket(packet))
+                    return;
+
+                nextRequest++;
+            }
+
+            auto reply = this->receivePacket();
+            if (!reply.has_value())
+                return;
+
+            // Errors are replied to as "Exx", a region the target can't access just stays zeroed
+            const auto &request = requests[nextReply];
+            if (!write && !decodeHex(*reply, request.buffer, request.size))
+                std::memset(request.buffer, 0x00, request.size);
+
+            nextReply++;
+        }
+    }
+
+    void GDBProvider::readRaw(u64 offset, void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0)
+            return;
+
+        std::memset(buffer, 0x00, size);
+
+        std::scoped_lock lock(this->m_connectionMutex);
+
+        // Replies are "$<hex data>#xx", each byte takes up two characters
+        const size_t maxRequestSize = (this->m_packetSize - 4) / 2;
+
+        std::vector<Request> requests;
+        for (u64 part = 0; part < size; part += maxRequestSize)
+            requests.push_back({ offset + part, static_cast<u8*>(buffer) + part, std::min<size_t>(maxRequestSize, size - part) });
+
+        this->pipeline(requests, false);
+    }
+
+    void GDBProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0)
+            return;
+
+        std::scoped_lock lock(this->m_connectionMutex);
+
+        // Leave room for "$M<address>,<size>:" and the checksum
+        const size_t maxRequestSize = (this->m_packetSize - 40) / 2;
+
+        std::vector<Request> requests;
+        for (u64 part = 0; part < size; part += maxRequestSize)
+            requests.push_back({ offset + part, const_cast<u8*>(static_cast<const u8*>(buffer)) + part, std::min<size_t>(maxRequestSize, size - part) });
+
+        this->pipeline(requests, true);
+    }
+
+    size_t GDBProvider::getRawSize() {
+        return this->m_size;
+    }
+
+    std::string GDBProvider::getName() const {
+        return hex::format("%s:%u", this->m_host.c_str(), this->m_port);
+    }
+
+    u32 GDBProvider::getCapabilities() const {
+        // Requests are serialized on the connection already
+        return ContentRegistry::Providers::ThreadSafeReads;
+    }
+
+    std::vector<std::pair<std::string, std::string>> GDBProvider::getDataInformation() {
+        std::vector<std::pair<std::string, std::string>> result;
+
+        result.emplace_back("Server", hex::format("%s:%u", this->m_host.c_str(), this->m_port));
+        result.emplace_back("Address space", hex::toByteString(this->getRawSize()));
+        result.emplace_back("Packet size", hex::format("0x%zX bytes", this->m_packetSize));
+        result.emplace_back("Acknowledgements", this->m_noAckMode ? "Disabled" : "Enabled");
+        result.emplace_back("Packets sent", std::to_string(this->m_packets));
+
+        return result;
+    }
+
+}
@@ -0,0 +1,276 @@
+#include "providers/process_provider.hpp"
+
+#include <hex/api/content_registry.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#if defined(OS_LINUX)
+#include <climits>
+#include <sys/uio.h>
+#endif
+
+namespace hex::prv {
+
+    ProcessProvider::ProcessProvider(u32 processId) : Provider(), m_processId(processId) {
+        #if defined(OS_WINDOWS)
+        this->m_process = OpenProcess(PROCESS_VM_READ | PROCESS_VM_WRITE | PROCESS_VM_OPERATION | PROCESS_QUERY_INFORMATION, FALSE, processId);
+        this->m_writable = this->m_process != nullptr;
+
+        if (this->m_process == nullptr)
+            this->m_process = OpenProcess(PROCESS_VM_READ | PROCESS_QUERY_INFORMATION, FALSE, processId);
+
+        if (this->m_process == nullptr)
+            return;
+        #endif
+
+        this->updateRegions();
+
+        if (this->m_regions.empty())
+            return;
+
+        #if defined(OS_LINUX)
+        // Reading needs the same permissions as attaching a debugger, better to fail now than to show nothing but zeros
+        u8 probe = 0;
+        iovec local = { &probe, 1 }, remote = { reinterpret_cast<void*>(this->m_regions.front().address), 1 };
+        if (process_vm_readv(this->m_processId, &local, 1, &remote, 1, 0) != 1)
+            return;
+
+        this->m_writable = true;
+        #endif
+
+        this->m_available = true;
+
+        // Every cache miss is a system call into another process, so reads are worth batching up a lot more than file reads
+        this->enableBlockCache(RemotePageSize, 0x400, 16);
+    }
+
+    ProcessProvider::~ProcessProvider() {
+        this->closeSnapshots();
+
+        #if defined(OS_WINDOWS)
+        if (this->m_process != nullptr)
+            CloseHandle(this->m_process);
+        #endif
+    }
+
+
+    bool ProcessProvider::isAvailable() {
+        return this->m_available;
+    }
+
+    bool ProcessProvider::isReadable() {
+        return isAvailable();
+    }
+
+    bool ProcessProvider::isWritable() {
+        return isAvailable() && this->m_writable;
+    }
+
+
+    void ProcessProvider::updateRegions() {
+        std::vector<MemoryRegion> regions;
+        u64 offset = 0;
+
+        auto addRegion = [&](u64 address, u64 size, std::string name, bool writable) {
+            // Adjacent mappings of the same thing are shown as one region
+            if (!regions.empty() && regions.back().address + regions.back().size == address && regions.back().name == name && regions.back().writable == writable)
+                regions.back().size += size;
+            else
+                regions.push_back({ address, size, offset, std::move(name), writable });
+
+            offset += size;
+        };
+
+        #if defined(OS_LINUX)
+        std::ifstream maps(hex::format("/proc/%u/maps", this->m_processId));
+
+        for (std::string line; std::getline(maps, line); ) {
+            std::istringstream stream(line);
+
+            std::string range, permissions, fileOffset, device, inode, name;
+            stream >> range >> permissions >> fileOffset >> device >> inode;
+            std::getline(stream >> std::ws, name);
+
+            auto separator = range.find('-');
+            if (separator == std::string::npos || permissions.size() < 2 || permissions[0] != 'r')
+                continue;
+
+            // These are provided by the kernel and can't be read through process_vm_readv
+            if (name == "[vvar]" || name == "[vsyscall]")
+                continue;
+
+            const u64 start = std::stoull(range.substr(0, separator), nullptr, 16);
+            const u64 end   = std::stoull(range.substr(separator + 1), nullptr, 16);
+
+            if (end > start)
+                addRegion(start, end - start, name, permissions[1] == 'w');
+        }
+        #elif defined(OS_WINDOWS)
+        MEMORY_BASIC_INFORMATION info;
+        u64 address = 0;
+        while (VirtualQueryEx(this->m_process, reinterpret_cast<LPCVOID>(address), &info, sizeof(info)) == sizeof(info)) {
+            const DWORD protection = info.Protect & 0xFF;
+            const bool readable = info.State == MEM_COMMIT && protection != PAGE_NOACCESS && (info.Protect & PAGE_GUARD) == 0;
+
+            if (readable) {
+                const bool writable = protection == PAGE_READWRITE || protection == PAGE_WRITECOPY || protection == PAGE_EXECUTE_READWRITE || protection == PAGE_EXECUTE_WRITECOPY;
+                const char *name = info.Type == MEM_IMAGE ? "Image" : info.Type == MEM_MAPPED ? "Mapped" : "Private";
+
+                addRegion(reinterpret_cast<u64>(info.BaseAddress), info.RegionSize, name, writable);
+            }
+
+            const u64 nextAddress = reinterpret_cast<u64>(info.BaseAddress) + info.RegionSize;
+            if (nextAddress <= address)
+                break;
+
+            address = nextAddress;
+        }
+        #endif
+
+        this->m_regions = std::move(regions);
+        this->m_size = offset;
+    }
+
+    void ProcessProvider::refresh() {
+        {
+            std::unique_lock lock(this->m_regionMutex);
+            this->updateRegions();
+        }
+
+        if (this->m_blockCache != nullptr)
+            this->m_blockCache->invalidate();
+
+        // Snapshots of the old memory contents are stale now
+        this->m_dataGeneration++;
+    }
+
+    std::vector<ProcessProvider::MemoryRegion> ProcessProvider::getRegions() const {
+        std::shared_lock lock(this->m_regionMutex);
+
+        return this->m_regions;
+    }
+
+    std::optional<u64> ProcessProvider::getOffsetOfAddress(u64 address) const {
+        std::shared_lock lock(this->m_regionMutex);
+
+        auto region = std::find_if(this->m_regions.begin(), this->m_regions.end(), [address](const MemoryRegion &region) {
+            return address >= region.address && address < region.address + region.size;
+        });
+
+        if (region == this->m_regions.end())
+            return { };
+
+        return region->offset + (address - region->address);
+    }
+
+    std::vector<ProcessProvider::Transfer> ProcessProvider::getTransfers(u64 offset, u8 *buffer, size_t size) const {
+        std::vector<Transfer> transfers;
+        const u64 end = offset + size;
+
+        auto region = std::upper_bound(this->m_regions.begin(), this->m_regions.end(), offset, [](u64 offset, const MemoryRegion &region) { return offset < region.offset; });
+        if (region != this->m_regions.begin())
+            region--;
+
+        for (; region != this->m_regions.end() && region->offset < end; region++) {
+            const u64 from = std::max(region->offset, offset);
+            const u64 to   = std::min(region->offset + region->size, end);
+
+            for (u64 part = from; part < to; ) {
+                const u64 address = region->address + (part - region->offset);
+                const u64 partEnd = std::min<u64>(to, part + (RemotePageSize - address % RemotePageSize));
+
+                transfers.push_back({ address, buffer + (part - offset), size_t(partEnd - part) });
+                part = partEnd;
+            }
+        }
+
+        return transfers;
+    }
+
+    void ProcessProvider::readRaw(u64 offset, void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0)
+            return;
+
+        std::memset(buffer, 0x00, size);
+
+        std::shared_lock lock(this->m_regionMutex);
+        auto transfers = this->getTransfers(offset, static_cast<u8*>(buffer), size);
+
+        #if defined(OS_LINUX)
+        std::vector<iovec> local, remote;
+        for (const auto &transfer : transfers) {
+            local.push_back({ transfer.buffer, transfer.size });
+            remote.push_back({ reinterpret_cast<void*>(transfer.address), transfer.size });
+        }
+
+        // A batch stops at the first page that can't be read, the next one continues right after it
+        for (size_t i = 0; i < local.size(); ) {
+            const size_t batchEnd = i + std::min<size_t>(local.size() - i, IOV_MAX);
+            const ssize_t result = process_vm_readv(this->m_processId, &local[i], batchEnd - i, &remote[i], batchEnd - i, 0);
+
+            size_t transferred = result < 0 ? 0 : result;
+            while (i < batchEnd && transferred >= local[i].iov_len) {
+                transferred -= local[i].iov_len;
+                i++;
+            }
+
+            if (i < batchEnd)
+                i++;
+        }
+        #elif defined(OS_WINDOWS)
+        for (const auto &transfer : transfers)
+            ReadProcessMemory(this->m_process, reinterpret_cast<LPCVOID>(transfer.address), transfer.buffer, transfer.size, nullptr);
+        #endif
+    }
+
+    void ProcessProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0 || !this->isWritable())
+            return;
+
+        std::shared_lock lock(this->m_regionMutex);
+        auto transfers = this->getTransfers(offset, const_cast<u8*>(static_cast<const u8*>(buffer)), size);
+
+        #if defined(OS_LINUX)
+        for (const auto &transfer : transfers) {
+            iovec local = { transfer.buffer, transfer.size }, remote = { reinterpret_cast<void*>(transfer.address), transfer.size };
+            process_vm_writev(this->m_processId, &local, 1, &remote, 1, 0);
+        }
+        #elif defined(OS_WINDOWS)
+        for (const auto &transfer : transfers)
+            WriteProcessMemory(this->m_process, reinterpret_cast<LPVOID>(transfer.address), transfer.buffer, transfer.size, nullptr);
+        #endif
+    }
+
+    size_t ProcessProvider::getRawSize() {
+        return this->m_size;
+    }
+
+    std::string ProcessProvider::getName() const {
+        return hex::format("Process %u", this->m_processId);
+    }
+
+    u32 ProcessProvider::getCapabilities() const {
+        return ContentRegistry::Providers::ThreadSafeReads;
+    }
+
+    std::vector<std::pair<std::string, std::string>> ProcessProvider::getDataInformation() {
+        std::vector<std::pair<std::string, std::string>> result;
+
+        std::shared_lock lock(this->m_regionMutex);
+
+        result.emplace_back("Process ID", std::to_string(this->m_processId));
+        result.emplace_back("Readable regions", std::to_string(this->m_regions.size()));
+        result.emplace_back("Readable memory", hex::toByteString(this->m_size));
+
+        if (!this->m_regions.empty())
+            result.emplace_back("Address range", hex::format("0x%llX - 0x%llX", this->m_regions.front().address, this->m_regions.back().address + this->m_regions.back().size - 1));
+
+        return result;
+    }
+
+}
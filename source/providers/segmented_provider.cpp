@@ -0,0 +1,532 @@
+#include "providers/segmented_provider.hpp"
+#include "providers/file_provider.hpp"
+
+#include <hex/api/content_registry.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <sstream>
+
+namespace hex::prv {
+
+    namespace {
+
+        std::optional<std::vector<u8>> parseHexBytes(std::string_view string) {
+            if (string.size() % 2 != 0)
+                return { };
+
+            std::vector<u8> bytes;
+            bytes.reserve(string.size() / 2);
+
+            for (size_t i = 0; i < string.size(); i += 2) {
+                u8 byte = 0;
+                for (char c : string.substr(i, 2)) {
+                    byte <<= 4;
+
+                    if (c >= '0' && c <= '9')       byte |= c - '0';
+                    else if (c >= 'A' && c <= 'F')  byte |= c - 'A' + 10;
+                    else if (c >= 'a' && c <= 'f')  byte |= c - 'a' + 10;
+                    else return { };
+                }
+
+                bytes.push_back(byte);
+            }
+
+            return bytes;
+        }
+
+        // Records of Intel HEX and SREC files usually follow each other without gaps, those are merged into a single segment
+        void appendRecord(std::vector<SegmentedProvider::Segment> &segments, u64 address, const u8 *data, size_t size) {
+            if (size == 0)
+                return;
+
+            if (!segments.empty() && segments.back().offset + segments.back().size == address) {
+                auto &segment = segments.back();
+                segment.data.insert(segment.data.end(), data, data + size);
+                segment.size += size;
+            } else {
+                segments.push_back({ address, size, hex::format("Records @ 0x%llX", address), 0, 0, std::vector<u8>(data, data + size) });
+            }
+        }
+
+        std::string getSegmentFlags(u32 flags) {
+            std::string result;
+            result += (flags & 4) ? 'R' : '-';
+            result += (flags & 2) ? 'W' : '-';
+            result += (flags & 1) ? 'X' : '-';
+
+            return result;
+        }
+
+    }
+
+    SegmentedProvider::SegmentedProvider(std::string_view path) : Provider(), m_path(path) {
+        this->m_format = detectFormat(this->m_path);
+        if (this->m_format == Format::Unknown)
+            return;
+
+        this->m_file = std::make_unique<FileProvider>(path);
+        if (!this->m_file->isAvailable())
+            return;
+
+        std::vector<Segment> segments;
+
+        bool loaded = false;
+        switch (this->m_format) {
+            case Format::ELF:       loaded = this->loadELF(segments);       break;
+            case Format::PE:        loaded = this->loadPE(segments);        break;
+            case Format::IntelHex:  loaded = this->loadIntelHex(segments);  break;
+            case Format::SRecord:   loaded = this->loadSRecord(segments);   break;
+            default: break;
+        }
+
+        if (!loaded || segments.empty())
+            return;
+
+        // Record data is decoded into memory, the text file itself isn't needed anymore
+        if (this->m_format == Format::IntelHex || this->m_format == Format::SRecord)
+            this->m_file.reset();
+
+        this->buildSegmentTable(std::move(segments));
+
+        this->m_available = !this->m_segments.empty();
+    }
+
+    SegmentedProvider::~SegmentedProvider() {
+        this->closeSnapshots();
+    }
+
+    SegmentedProvider::Format SegmentedProvider::detectFormat(const std::string &path) {
+        u8 magic[4] = { 0 };
+
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return Format::Unknown;
+
+        const size_t size = fread(magic, 1, sizeof(magic), file);
+        fclose(file);
+
+        if (size >= 4 && std::memcmp(magic, "\x7F" "ELF", 4) == 0)
+            return Format::ELF;
+        if (size >= 2 && magic[0] == 'M' && magic[1] == 'Z')
+            return Format::PE;
+        if (size >= 1 && magic[0] == ':')
+            return Format::IntelHex;
+        if (size >= 2 && magic[0] == 'S' && magic[1] >= '0' && magic[1] <= '9')
+            return Format::SRecord;
+
+        return Format::Unknown;
+    }
+
+
+    bool SegmentedProvider::isAvailable() {
+        return this->m_available;
+    }
+
+    bool SegmentedProvider::isReadable() {
+        return isAvailable();
+    }
+
+    bool SegmentedProvider::isWritable() {
+        return false;
+    }
+
+
+    bool SegmentedProvider::loadELF(std::vector<Segment> &segments) {
+        const u64 fileSize = this->m_file->getRawSize();
+
+        u8 ident[16] = { 0 };
+        if (fileSize < 0x34)
+            return false;
+        this->m_file->readRaw(0, ident, sizeof(ident));
+
+        const bool is64Bit = ident[4] == 2;
+        const auto endian = ident[5] == 2 ? std::endian::big : std::endian::little;
+
+        auto read = [&](u64 offset, size_t size) -> u64 {
+            u64 value = 0;
+            if (offset + size <= fileSize)
+                this->m_file->readRaw(offset, &value, size);
+
+            return hex::changeEndianess(value, size, endian);
+        };
+
+        const size_t wordSize = is64Bit ? 8 : 4;
+
+        const u64 programHeaderOffset  = read(is64Bit ? 0x20 : 0x1C, wordSize);
+        const u64 sectionHeaderOffset  = read(is64Bit ? 0x28 : 0x20, wordSize);
+        const u64 programHeaderSize    = read(is64Bit ? 0x36 : 0x2A, 2);
+        const u64 programHeaderCount   = read(is64Bit ? 0x38 : 0x2C, 2);
+        const u64 sectionHeaderSize    = read(is64Bit ? 0x3A : 0x2E, 2);
+        const u64 sectionHeaderCount   = read(is64Bit ? 0x3C : 0x30, 2);
+        const u64 sectionNameTable     = read(is64Bit ? 0x3E : 0x32, 2);
+
+        constexpr u32 PT_LOAD = 1;
+        for (u64 i = 0; i < programHeaderCount; i++) {
+            const u64 header = programHeaderOffset + i * programHeaderSize;
+
+            if (read(header, 4) != PT_LOAD)
+                continue;
+
+            const u64 offset      = read(header + (is64Bit ? 0x08 : 0x04), wordSize);
+            const u64 address     = read(header + (is64Bit ? 0x10 : 0x08), wordSize);
+            const u64 storedSize  = read(header + (is64Bit ? 0x20 : 0x10), wordSize);
+            const u64 memorySize  = read(header + (is64Bit ? 0x28 : 0x14), wordSize);
+            const u32 flags       = read(header + (is64Bit ? 0x04 : 0x18), 4);
+
+            if (memorySize == 0 || offset > fileSize)
+                continue;
+
+            segments.push_back({ address, memorySize, hex::format("LOAD %s", getSegmentFlags(flags).c_str()), offset, std::min({ storedSize, memorySize, fileSize - offset }), { } });
+        }
+
+        if (!segments.empty())
+            return true;
+
+        // Files without program headers like object files only have sections. Only the ones occupying memory get mapped
+        constexpr u32 SHT_NOBITS = 8;
+        constexpr u64 SHF_ALLOC = 2;
+
+        const u64 nameTableOffset = read(sectionHeaderOffset + sectionNameTable * sectionHeaderSize + (is64Bit ? 0x18 : 0x10), wordSize);
+        for (u64 i = 0; i < sectionHeaderCount; i++) {
+            const u64 header = sectionHeaderOffset + i * sectionHeaderSize;
+
+            const u32 nameOffset  = read(header, 4);
+            const u32 type        = read(header + 0x04, 4);
+            const u64 flags       = read(header + 0x08, wordSize);
+            const u64 address     = read(header + (is64Bit ? 0x10 : 0x0C), wordSize);
+            const u64 offset      = read(header + (is64Bit ? 0x18 : 0x10), wordSize);
+            const u64 size        = read(header + (is64Bit ? 0x20 : 0x14), wordSize);
+
+            if ((flags & SHF_ALLOC) == 0 || size == 0 || offset > fileSize)
+                continue;
+
+            std::string name;
+            for (u64 c = nameTableOffset + nameOffset; c < fileSize && name.size() < 0x100; c++) {
+                char character = read(c, 1);
+                if (character == '\x00')
+                    break;
+                name += character;
+            }
+
+            segments.push_back({ address, size, name, offset, type == SHT_NOBITS ? 0 : std::min(size, fileSize - offset), { } });
+        }
+
+        return true;
+    }
+
+    bool SegmentedProvider::loadPE(std::vector<Segment> &segments) {
+        const u64 fileSize = this->m_file->getRawSize();
+
+        auto read = [&](u64 offset, size_t size) -> u64 {
+            u64 value = 0;
+            if (offset + size <= fileSize)
+                this->m_file->readRaw(offset, &value, size);
+
+            return hex::changeEndianess(value, size, std::endian::little);
+        };
+
+        const u64 peHeader = read(0x3C, 4);
+        if (read(peHeader, 4) != 0x0000'4550)
+            return false;
+
+        const u64 sectionCount        = read(peHeader + 0x06, 2);
+        const u64 optionalHeaderSize  = read(peHeader + 0x14, 2);
+        const u64 optionalHeader      = peHeader + 0x18;
+
+        const u16 magic = read(optionalHeader, 2);
+        if (magic != 0x10B && magic != 0x20B)
+            return false;
+
+        const u64 imageBase     = magic == 0x20B ? read(optionalHeader + 0x18, 8) : read(optionalHeader + 0x1C, 4);
+        const u64 headerSize    = read(optionalHeader + 0x3C, 4);
+
+        if (headerSize != 0)
+            segments.push_back({ imageBase, headerSize, "Headers", 0, std::min(headerSize, fileSize), { } });
+
+        const u64 sectionTable = optionalHeader + optionalHeaderSize;
+        for (u64 i = 0; i < sectionCount; i++) {
+            const u64 header = sectionTable + i * 0x28;
+
+            char name[9] = { 0 };
+            if (header + 8 <= fileSize)
+                this->m_file->readRaw(header, name, 8);
+
+            const u64 virtualSize     = read(header + 0x08, 4);
+            const u64 virtualAddress  = read(header + 0x0C, 4);
+            const u64 rawSize         = read(header + 0x10, 4);
+            const u64 rawOffset       = read(header + 0x14, 4);
+
+            const u64 size = virtualSize != 0 ? virtualSize : rawSize;
+            if (size == 0 || rawOffset > fileSize)
+                continue;
+
+            segments.push_back({ imageBase + virtualAddress, size, name, rawOffset, std::min({ rawSize, size, fileSize - rawOffset }), { } });
+        }
+
+        return true;
+    }
+
+    bool SegmentedProvider::loadIntelHex(std::vector<Segment> &segments) {
+        std::string text(this->m_file->getRawSize(), '\x00');
+        this->m_file->readRaw(0, text.data(), text.size());
+
+        u64 addressBase = 0;
+
+        std::istringstream stream(text);
+        for (std::string line; std::getline(stream, line); ) {
+            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))
+                line.pop_back();
+
+            if (line.empty())
+                continue;
+
+            // :LLAAAATT<data>CC, all bytes including the checksum add up to zero
+            if (line[0] != ':')
+                return false;
+
+            auto bytes = parseHexBytes(std::string_view(line).substr(1));
+            if (!bytes.has_value() || bytes->size() < 5 || bytes->size() != size_t((*bytes)[0]) + 5)
+                return false;
+
+            u8 checksum = 0;
+            for (u8 byte : *bytes)
+                checksum += byte;
+            if (checksum != 0)
+                return false;
+
+            const u8 length = (*bytes)[0];
+            const u16 address = ((*bytes)[1] << 8) | (*bytes)[2];
+            const u8 *data = bytes->data() + 4;
+
+            switch ((*bytes)[3]) {
+                case 0x00:  // Data
+                    appendRecord(segments, addressBase + address, data, length);
+                    break;
+                case 0x01:  // End of file
+                    return true;
+                case 0x02:  // Extended segment address
+                    if (length != 2) return false;
+                    addressBase = u64((data[0] << 8) | data[1]) << 4;
+                    break;
+                case 0x04:  // Extended linear address
+                    if (length != 2) return false;
+                    addressBase = u64((data[0] << 8) | data[1]) << 16;
+                    break;
+                default:    // Start addresses don't map any data
+                    break;
+            }
+        }
+
+        return true;
+    }
+
+    bool SegmentedProvider::loadSRecord(std::vector<Segment> &segments) {
+        std::string text(this->m_file->getRawSize(), '\x00');
+        this->m_file->readRaw(0, text.data(), text.size());
+
+        std::istringstream stream(text);
+        for (std::string line; std::getline(stream, line); ) {
+            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))
+                line.pop_back();
+
+            if (line.empty())
+                continue;
+
+            // S<type><count><address><data><checksum>, the checksum is the ones' complement of the sum of all other bytes
+            if (line.size() < 4 || line[0] != 'S')
+                return false;
+
+            auto bytes = parseHexBytes(std::string_view(line).substr(2));
+            if (!bytes.has_value() || bytes->empty() || bytes->size() != size_t((*bytes)[0]) + 1)
+                return false;
+
+            u8 checksum = 0;
+            for (u8 byte : *bytes)
+                checksum += byte;
+            if (checksum != 0xFF)
+                return false;
+
+            size_t addressSize;
+            switch (line[1]) {
+                case '1': addressSize = 2; break;
+                case '2': addressSize = 3; break;
+                case '3': addressSize = 4; break;
+                case '7': case '8': case '9':
+                    return true;
+                default:    // Headers and record counts
+                    continue;
+            }
+
+            if (bytes->size() < 2 + addressSize)
+                return false;
+
+            u64 address = 0;
+            for (size_t i = 0; i < addressSize; i++)
+                address = (address << 8) | (*bytes)[1 + i];
+
+            appendRecord(segments, address, bytes->data() + 1 + addressSize, bytes->size() - 2 - addressSize);
+        }
+
+        return true;
+    }
+
+    void SegmentedProvider::buildSegmentTable(std::vector<Segment> &&segments) {
+        std::stable_sort(segments.begin(), segments.end(), [](const Segment &left, const Segment &right) { return left.offset < right.offset; });
+
+        const u64 baseAddress = segments.front().offset;
+
+        for (auto &segment : segments) {
+            segment.offset -= baseAddress;
+
+            // Later segments that overlap earlier ones lose the overlapping part, binary search needs disjoint segments
+            if (!this->m_segments.empty()) {
+                const u64 previousEnd = this->m_segments.back().offset + this->m_segments.back().size;
+
+                if (segment.offset + segment.size <= previousEnd)
+                    continue;
+
+                if (segment.offset < previousEnd) {
+                    const u64 overlap = previousEnd - segment.offset;
+
+                    segment.offset += overlap;
+                    segment.size -= overlap;
+                    segment.fileOffset += std::min(overlap, segment.fileSize);
+                    segment.fileSize -= std::min(overlap, segment.fileSize);
+                    segment.data.erase(segment.data.begin(), segment.data.begin() + std::min<u64>(overlap, segment.data.size()));
+                }
+            }
+
+            this->m_segments.push_back(std::move(segment));
+        }
+
+        this->m_size = this->m_segments.back().offset + this->m_segments.back().size;
+        this->setBaseAddress(baseAddress);
+    }
+
+    std::vector<SegmentedProvider::Segment>::const_iterator SegmentedProvider::findSegmentAtOrAfter(u64 offset) const {
+        auto segment = std::upper_bound(this->m_segments.begin(), this->m_segments.end(), offset, [](u64 offset, const Segment &segment) {
+            return offset < segment.offset;
+        });
+
+        if (segment != this->m_segments.begin() && offset < std::prev(segment)->offset + std::prev(segment)->size)
+            segment--;
+
+        return segment;
+    }
+
+    const SegmentedProvider::Segment* SegmentedProvider::findSegment(u64 offset) const {
+        auto segment = this->findSegmentAtOrAfter(offset);
+
+        if (segment == this->m_segments.end() || offset < segment->offset)
+            return nullptr;
+
+        return &*segment;
+    }
+
+    void SegmentedProvider::readSegment(const Segment &segment, u64 segmentOffset, u8 *buffer, size_t size) {
+        const u64 storedSize = this->m_file != nullptr ? segment.fileSize : segment.data.size();
+
+        size_t storedPart = 0;
+        if (segmentOffset < storedSize) {
+            storedPart = std::min<u64>(size, storedSize - segmentOffset);
+
+            if (this->m_file != nullptr)
+                this->m_file->readRaw(segment.fileOffset + segmentOffset, buffer, storedPart);
+            else
+                std::memcpy(buffer, segment.data.data() + segmentOffset, storedPart);
+        }
+
+        // Uninitialized data like .bss isn't stored anywhere
+        std::memset(buffer + storedPart, 0x00, size - storedPart);
+    }
+
+    void SegmentedProvider::readRaw(u64 offset, void *buffer, size_t size) {
+        if ((offset + size) > this->getRawSize() || buffer == nullptr || size == 0)
+            return;
+
+        auto data = static_cast<u8*>(buffer);
+        const u64 end = offset + size;
+
+        auto segment = this->findSegmentAtOrAfter(offset);
+        for (u64 position = offset; position < end; ) {
+            if (segment == this->m_segments.end() || position < segment->offset) {
+                // Holes between the segments read as zeros
+                const u64 holeEnd = segment == this->m_segments.end() ? end : std::min(end, segment->offset);
+                std::memset(data + (position - offset), 0x00, holeEnd - position);
+                position = holeEnd;
+            } else {
+                const u64 partEnd = std::min(end, segment->offset + segment->size);
+                this->readSegment(*segment, position - segment->offset, data + (position - offset), partEnd - position);
+                position = partEnd;
+                segment++;
+            }
+        }
+    }
+
+    void SegmentedProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
+
+    }
+
+    size_t SegmentedProvider::getRawSize() {
+        return this->m_size;
+    }
+
+    const u8* SegmentedProvider::getResidentData(u64 offset, size_t size) {
+        auto segment = this->findSegment(offset);
+        if (segment == nullptr)
+            return nullptr;
+
+        const u64 segmentOffset = offset - segment->offset;
+
+        if (this->m_file != nullptr) {
+            if (segmentOffset + size > segment->fileSize)
+                return nullptr;
+
+            return this->m_file->getResidentData(segment->fileOffset + segmentOffset, size);
+        } else {
+            if (segmentOffset + size > segment->data.size())
+                return nullptr;
+
+            return segment->data.data() + segmentOffset;
+        }
+    }
+
+    std::string SegmentedProvider::getName() const {
+        return std::filesystem::path(this->m_path).filename().string();
+    }
+
+    u32 SegmentedProvider::getCapabilities() const {
+        // Segments read from a file are only resident if the file is mapped in full, the ones loaded into memory always are
+        return ContentRegistry::Providers::ChunkSpans | ContentRegistry::Providers::ThreadSafeReads;
+    }
+
+    std::vector<std::pair<std::string, std::string>> SegmentedProvider::getDataInformation() {
+        std::vector<std::pair<std::string, std::string>> result;
+
+        constexpr const char *FormatNames[] = { "Unknown", "ELF", "PE", "Intel HEX", "SREC" };
+
+        result.emplace_back("File path", this->m_path);
+        result.emplace_back("Format", FormatNames[u32(this->m_format)]);
+
+        if (!this->isAvailable())
+            return result;
+
+        u64 mappedSize = 0;
+        for (const auto &segment : this->m_segments)
+            mappedSize += segment.size;
+
+        result.emplace_back("Segments", std::to_string(this->m_segments.size()));
+        result.emplace_back("Mapped size", hex::toByteString(mappedSize));
+        result.emplace_back("Address range", hex::format("0x%llX - 0x%llX", this->m_baseAddress, this->m_baseAddress + this->m_size - 1));
+
+        return result;
+    }
+
+}
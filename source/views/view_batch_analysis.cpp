@@ -0,0 +1,284 @@
+#include "views/view_batch_analysis.hpp"
+
+#include <hex/helpers/utils.hpp>
+#include <hex/lang/pattern_language.hpp>
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+namespace hex {
+
+    using namespace std::literals::string_literals;
+
+    // Column user IDs of the results table, the hash columns follow the fixed ones
+    enum ResultColumn : ImGuiID {
+        FileColumn,
+        SizeColumn,
+        StringsColumn,
+        PatternsColumn,
+        TimeColumn,
+        ErrorColumn,
+        FirstHashColumn
+    };
+
+    ViewBatchAnalysis::ViewBatchAnalysis() : View("Batch Analysis") {
+
+    }
+
+    ViewBatchAnalysis::~ViewBatchAnalysis() {
+        this->cancel();
+    }
+
+    void ViewBatchAnalysis::addFolder(const std::string &path) {
+        std::error_code error;
+        for (const auto &entry : std::filesystem::directory_iterator(path, error)) {
+            if (entry.is_regular_file(error))
+                this->m_files.push_back(entry.path().string());
+        }
+
+        if (error)
+            View::showErrorPopup("Failed to list all files of the folder!");
+    }
+
+    bool ViewBatchAnalysis::isRunning() const {
+        return this->m_finishedTasks != this->m_tasks.size();
+    }
+
+    void ViewBatchAnalysis::cancel() {
+        for (auto &task : this->m_tasks)
+            task->cancel();
+        this->m_tasks.clear();
+        this->m_finishedTasks = 0;
+        this->m_run++;
+    }
+
+    void ViewBatchAnalysis::start() {
+        this->cancel();
+
+        auto settings = std::make_shared<BatchAnalysisSettings>();
+
+        // The pattern is only compiled once, evaluating it doesn't modify it so all files can share it
+        if (!this->m_patternPath.empty()) {
+            std::ifstream patternFile(this->m_patternPath, std::ios::binary);
+            if (!patternFile.is_open()) {
+                View::showErrorPopup("Failed to read the pattern file!");
+                return;
+            }
+
+            const std::string code(std::istreambuf_iterator<char>(patternFile), { });
+
+            lang::PatternLanguage runtime;
+            settings->pattern = runtime.compile(code);
+            if (settings->pattern == nullptr) {
+                auto &[line, message] = *runtime.getError();
+                View::showErrorPopup(hex::format("Failed to compile the pattern! Line %u: %s", line, message.c_str()));
+                return;
+            }
+        }
+
+        this->m_hashNames.clear();
+        for (size_t i = 0; i < HashFunctions.size(); i++) {
+            if (!this->m_selectedHashFunctions[i])
+                continue;
+
+            this->m_hashNames.emplace_back(HashFunctions[i].first);
+            settings->hashes.push_back(HashFunctions[i].second);
+        }
+
+        settings->countStrings = this->m_countStrings;
+        settings->minimumStringLength = std::max(this->m_minimumStringLength, 1);
+
+        this->m_results.clear();
+
+        for (const auto &path : this->m_files) {
+            auto result = std::make_shared<std::optional<BatchAnalysisResult>>();
+
+            this->m_tasks.push_back(TaskManager::submit("Batch analysis", [path, settings, result](Task &task) {
+                *result = analyzeFile(path, *settings, task);
+            }, [this, result, run = this->m_run] {
+                if (run != this->m_run)
+                    return;
+
+                this->m_finishedTasks++;
+
+                if (result->has_value()) {
+                    this->m_results.push_back(std::move(**result));
+                    this->m_sortRequired = true;
+                }
+            }));
+        }
+    }
+
+    void ViewBatchAnalysis::sortResults(ImGuiTableSortSpecs *sortSpecs) {
+        if (sortSpecs->SpecsCount == 0)
+            return;
+
+        const auto column = sortSpecs->Specs->ColumnUserID;
+        const bool ascending = sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending;
+
+        auto sortBy = [&](auto key) {
+            std::stable_sort(this->m_results.begin(), this->m_results.end(), [&](const BatchAnalysisResult &left, const BatchAnalysisResult &right) {
+                return ascending ? key(left) < key(right) : key(right) < key(left);
+            });
+        };
+
+        switch (column) {
+            case FileColumn:        sortBy([](const BatchAnalysisResult &result) -> const std::string& { return result.path; }); break;
+            case SizeColumn:        sortBy([](const BatchAnalysisResult &result) { return result.size; }); break;
+            case StringsColumn:     sortBy([](const BatchAnalysisResult &result) { return result.stringCount; }); break;
+            case PatternsColumn:    sortBy([](const BatchAnalysisResult &result) { return result.patternCount; }); break;
+            case TimeColumn:        sortBy([](const BatchAnalysisResult &result) { return result.seconds; }); break;
+            case ErrorColumn:       sortBy([](const BatchAnalysisResult &result) -> const std::string& { return result.error; }); break;
+            default: {
+                const size_t hash = column - FirstHashColumn;
+                sortBy([hash](const BatchAnalysisResult &result) { return hash < result.digests.size() ? result.digests[hash] : ""s; });
+                break;
+            }
+        }
+    }
+
+    void ViewBatchAnalysis::drawResults() {
+        const int columnCount = 6 + this->m_hashNames.size();
+
+        if (ImGui::BeginTable("##batchResults", columnCount,
+                              ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Sortable |
+                              ImGuiTableFlags_Reorderable | ImGuiTableFlags_Hideable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY)) {
+            ImGui::TableSetupScrollFreeze(1, 1);
+            ImGui::TableSetupColumn("File", ImGuiTableColumnFlags_DefaultSort, 0, FileColumn);
+            ImGui::TableSetupColumn("Size", 0, 0, SizeColumn);
+            for (size_t i = 0; i < this->m_hashNames.size(); i++)
+                ImGui::TableSetupColumn(this->m_hashNames[i].c_str(), 0, 0, FirstHashColumn + i);
+            ImGui::TableSetupColumn("Strings", 0, 0, StringsColumn);
+            ImGui::TableSetupColumn("Patterns", 0, 0, PatternsColumn);
+            ImGui::TableSetupColumn("Time", 0, 0, TimeColumn);
+            ImGui::TableSetupColumn("Error", 0, 0, ErrorColumn);
+
+            auto sortSpecs = ImGui::TableGetSortSpecs();
+            if (sortSpecs->SpecsDirty || this->m_sortRequired)
+                this->sortResults(sortSpecs);
+
+            sortSpecs->SpecsDirty = false;
+            this->m_sortRequired = false;
+
+            ImGui::TableHeadersRow();
+
+            ImGuiListClipper clipper;
+            clipper.Begin(this->m_results.size());
+
+            while (clipper.Step()) {
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    const auto &result = this->m_results[i];
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(std::filesystem::path(result.path).filename().string().c_str());
+                    if (ImGui::IsItemHovered())
+                        ImGui::SetTooltip("%s", result.path.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", result.size);
+
+                    for (size_t hash = 0; hash < this->m_hashNames.size(); hash++) {
+                        ImGui::TableNextColumn();
+                        if (hash < result.digests.size())
+                            ImGui::TextUnformatted(result.digests[hash].c_str());
+                    }
+
+                    ImGui::TableNextColumn();
+                    if (result.stringCount.has_value())
+                        ImGui::Text("%llu", *result.stringCount);
+                    ImGui::TableNextColumn();
+                    if (result.patternCount.has_value())
+                        ImGui::Text("%llu", *result.patternCount);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f s", result.seconds);
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(result.error.c_str());
+                }
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+    void ViewBatchAnalysis::drawContent() {
+        if (ImGui::Begin("Batch Analysis", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
+            const bool running = this->isRunning();
+
+            ImGui::Text("%zu files", this->m_files.size());
+            ImGui::SameLine();
+            if (ImGui::Button("Add file")) {
+                View::openFileBrowser("Batch Analysis: Add file", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, "*.*", [this](auto path) {
+                    this->m_files.push_back(path);
+                });
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Add folder")) {
+                View::openFileBrowser("Batch Analysis: Add folder", imgui_addons::ImGuiFileBrowser::DialogMode::SELECT, "", [this](auto path) {
+                    this->addFolder(path);
+                });
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear files"))
+                this->m_files.clear();
+
+            ImGui::InputText("##patternPath", this->m_patternPath.data(), this->m_patternPath.length(), ImGuiInputTextFlags_ReadOnly);
+            ImGui::SameLine();
+            if (ImGui::Button("Pattern")) {
+                View::openFileBrowser("Batch Analysis: Open pattern", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, ".hexpat", [this](auto path) {
+                    this->m_patternPath = path;
+                });
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("No pattern"))
+                this->m_patternPath.clear();
+
+            for (size_t i = 0; i < HashFunctions.size(); i++) {
+                if (i > 0)
+                    ImGui::SameLine();
+                ImGui::Checkbox(HashFunctions[i].first, &this->m_selectedHashFunctions[i]);
+            }
+
+            ImGui::Checkbox("Count strings", &this->m_countStrings);
+            ImGui::SameLine();
+            ImGui::PushItemWidth(100);
+            ImGui::InputInt("Minimum length", &this->m_minimumStringLength, 1, 0);
+            ImGui::PopItemWidth();
+
+            ImGui::Separator();
+
+            if (running) {
+                if (ImGui::Button("Cancel"))
+                    this->cancel();
+                ImGui::SameLine();
+                ImGui::ProgressBar(float(this->m_finishedTasks) / this->m_tasks.size(), ImVec2(200, 0));
+            } else if (ImGui::Button("Analyze") && !this->m_files.empty()) {
+                this->start();
+            }
+
+            ImGui::SameLine();
+            for (auto [name, format] : { std::pair { "Export JSON", PatternExporter::Format::JSON }, std::pair { "Export CSV", PatternExporter::Format::CSV } }) {
+                if (ImGui::Button(name) && !this->m_results.empty()) {
+                    View::openFileBrowser("Batch Analysis: Export results", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, format == PatternExporter::Format::JSON ? ".json" : ".csv", [this, format](auto path) {
+                        if (!exportBatchResults(path, format, this->m_hashNames, this->m_results))
+                            View::showErrorPopup("Failed to export the results!");
+                    });
+                }
+                ImGui::SameLine();
+            }
+            ImGui::NewLine();
+
+            this->drawResults();
+        }
+        ImGui::End();
+    }
+
+    void ViewBatchAnalysis::drawMenu() {
+
+    }
+
+}
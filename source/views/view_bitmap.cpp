@@ -0,0 +1,333 @@
+#include "views/view_bitmap.hpp"
+
+#include <hex/api/imhex_api.hpp>
+#include <hex/providers/provider.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace hex {
+
+    namespace {
+
+        constexpr std::array Depths = { "1 bit", "2 bit", "4 bit", "8 bit", "16 bit (RGB565)", "24 bit (RGB)", "32 bit (RGBA)" };
+        constexpr std::array DepthBits = { 1, 2, 4, 8, 16, 24, 32 };
+        constexpr std::array Palettes = { "Grayscale", "Byte class", "Heat" };
+
+        constexpr u32 MaxWidth = 4096;
+        constexpr u64 TileRows = 64;
+
+        // Bytes decoded per frame at most, tiles that don't fit anymore get decoded over the next frames
+        constexpr u64 DecodeBudget = 0x40'0000;
+
+        // Textures of tiles that weren't visible for a while get deleted once they take up more than this
+        constexpr u64 MaxTextureMemory = 0x1000'0000;
+
+    }
+
+    ViewBitmap::ViewBitmap() : View("Bitmap Visualizer") {
+        this->updatePalette();
+
+        View::subscribeEvent(Events::DataChanged, [this](auto userData) {
+            if (auto region = std::any_cast<Region>(&userData); region != nullptr)
+                this->markDirty(region->address, region->size);
+            else
+                this->markDirty(0, std::numeric_limits<u64>::max());
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto) {
+            this->clearTiles();
+
+            auto provider = SharedData::currentProvider;
+            this->m_region[0] = 0;
+            this->m_region[1] = provider == nullptr || provider->getActualSize() == 0 ? 0 : provider->getActualSize() - 1;
+        });
+    }
+
+    ViewBitmap::~ViewBitmap() {
+        View::unsubscribeEvent(Events::DataChanged);
+        View::unsubscribeEvent(Events::ProviderChanged);
+    }
+
+    u32 ViewBitmap::getBitsPerPixel() const {
+        return DepthBits[this->m_selectedDepth];
+    }
+
+    u64 ViewBitmap::getRowSize() const {
+        return (u64(this->m_width) * this->getBitsPerPixel() + 7) / 8;
+    }
+
+    u64 ViewBitmap::getRowCount() const {
+        const u64 size = this->m_region[1] - this->m_region[0] + 1;
+        return (size + this->getRowSize() - 1) / this->getRowSize();
+    }
+
+    void ViewBitmap::updatePalette() {
+        for (u32 i = 0; i < this->m_palette.size(); i++) {
+            switch (this->m_selectedPalette) {
+                case 0:
+                    this->m_palette[i] = IM_COL32(i, i, i, 0xFF);
+                    break;
+                case 1:
+                    if (i == 0x00)
+                        this->m_palette[i] = IM_COL32(0x00, 0x00, 0x00, 0xFF);
+                    else if (i == 0xFF)
+                        this->m_palette[i] = IM_COL32(0xFF, 0xFF, 0xFF, 0xFF);
+                    else if (i >= 0x20 && i < 0x7F)
+                        this->m_palette[i] = IM_COL32(0x37, 0x7E, 0xB8, 0xFF);
+                    else if (i < 0x80)
+                        this->m_palette[i] = IM_COL32(0x4D, 0xAF, 0x4A, 0xFF);
+                    else
+                        this->m_palette[i] = IM_COL32(0xE4, 0x1A, 0x1C, 0xFF);
+                    break;
+                case 2:
+                    this->m_palette[i] = ImGui::ColorConvertFloat4ToU32(ImColor::HSV(0.66F * (1.0F - i / 255.0F), 1.0F, 1.0F).Value);
+                    break;
+            }
+        }
+    }
+
+    void ViewBitmap::clearTiles() {
+        for (auto &[index, tile] : this->m_tiles) {
+            if (tile.texture != 0)
+                glDeleteTextures(1, &tile.texture);
+        }
+
+        this->m_tiles.clear();
+    }
+
+    void ViewBitmap::markDirty(u64 address, u64 size) {
+        if (this->m_tiles.empty() || address > this->m_region[1] || size == 0 || address + (size - 1) < this->m_region[0])
+            return;
+
+        const u64 tileSize = this->getRowSize() * TileRows;
+        const u64 first = (std::max(address, this->m_region[0]) - this->m_region[0]) / tileSize;
+        const u64 last  = (std::min(address + (size - 1), this->m_region[1]) - this->m_region[0]) / tileSize;
+
+        for (auto tile = this->m_tiles.lower_bound(first); tile != this->m_tiles.end() && tile->first <= last; tile++)
+            tile->second.dirty = true;
+    }
+
+    void ViewBitmap::decodeRow(const u8 *data, u64 validBytes, u32 *pixels) const {
+        const u32 bits = this->getBitsPerPixel();
+
+        // Pixels with any of their bytes past the end of the region stay transparent
+        const u64 validPixels = std::min<u64>(this->m_width, validBytes * 8 / bits);
+        std::fill(pixels + validPixels, pixels + this->m_width, 0x00);
+
+        switch (bits) {
+            case 1:
+            case 2:
+            case 4: {
+                // The first pixel of a byte is in its most significant bits, indices get spread over the whole palette
+                const u32 mask = (1U << bits) - 1;
+                for (u64 x = 0; x < validPixels; x++) {
+                    const u64 bit = x * bits;
+                    const u32 index = (data[bit / 8] >> (8 - bits - bit % 8)) & mask;
+                    pixels[x] = this->m_palette[index * 0xFF / mask];
+                }
+                break;
+            }
+            case 8:
+                for (u64 x = 0; x < validPixels; x++)
+                    pixels[x] = this->m_palette[data[x]];
+                break;
+            case 16:
+                for (u64 x = 0; x < validPixels; x++) {
+                    const u16 value = data[x * 2] | (data[x * 2 + 1] << 8);
+                    const u8 r = (value >> 11) & 0x1F, g = (value >> 5) & 0x3F, b = value & 0x1F;
+                    pixels[x] = IM_COL32((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 0xFF);
+                }
+                break;
+            case 24:
+                for (u64 x = 0; x < validPixels; x++)
+                    pixels[x] = IM_COL32(data[x * 3], data[x * 3 + 1], data[x * 3 + 2], 0xFF);
+                break;
+            case 32:
+                // Alpha is often unused and zero, so it's ignored to not end up with an invisible image
+                for (u64 x = 0; x < validPixels; x++)
+                    pixels[x] = IM_COL32(data[x * 4], data[x * 4 + 1], data[x * 4 + 2], 0xFF);
+                break;
+        }
+    }
+
+    void ViewBitmap::uploadTile(u64 index, Tile &tile) {
+        auto provider = SharedData::currentProvider;
+
+        const u64 rowSize = this->getRowSize();
+        const u64 firstRow = index * TileRows;
+        const u64 rows = std::min(TileRows, this->getRowCount() - firstRow);
+
+        const u64 offset = firstRow * rowSize;
+        const u64 readSize = std::min(rows * rowSize, this->m_region[1] - this->m_region[0] + 1 - offset);
+
+        std::vector<u8> buffer(rows * rowSize, 0x00);
+        provider->readAbsolute(this->m_region[0] + offset, buffer.data(), readSize);
+
+        std::vector<u32> pixels(this->m_width * rows);
+        for (u64 row = 0; row < rows; row++) {
+            const u64 rowOffset = row * rowSize;
+            const u64 validBytes = rowOffset < readSize ? std::min(rowSize, readSize - rowOffset) : 0;
+            this->decodeRow(buffer.data() + rowOffset, validBytes, pixels.data() + row * this->m_width);
+        }
+
+        // Dirty tiles keep their texture, it only gets new contents
+        if (tile.texture == 0)
+            glGenTextures(1, &tile.texture);
+
+        glBindTexture(GL_TEXTURE_2D, tile.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, this->m_width, rows, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        tile.dirty = false;
+    }
+
+    void ViewBitmap::evictTiles(u64 maxTiles) {
+        if (this->m_tiles.size() <= maxTiles)
+            return;
+
+        std::vector<std::pair<u64, u64>> tilesByAge;
+        for (const auto &[index, tile] : this->m_tiles)
+            tilesByAge.emplace_back(tile.lastUsedFrame, index);
+
+        std::sort(tilesByAge.begin(), tilesByAge.end());
+
+        for (size_t i = 0; i < tilesByAge.size() - maxTiles; i++) {
+            auto &tile = this->m_tiles[tilesByAge[i].second];
+            if (tile.texture != 0)
+                glDeleteTextures(1, &tile.texture);
+
+            this->m_tiles.erase(tilesByAge[i].second);
+        }
+    }
+
+    void ViewBitmap::drawContent() {
+        if (ImGui::Begin("Bitmap Visualizer", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
+            auto provider = SharedData::currentProvider;
+            if (provider != nullptr && provider->isReadable() && provider->getActualSize() > 0) {
+                const u64 dataSize = provider->getActualSize();
+
+                // Views get created after the first provider may have been opened already
+                if (this->m_region[0] == 0 && this->m_region[1] == 0)
+                    this->m_region[1] = dataSize - 1;
+
+                bool settingsChanged = false;
+
+                settingsChanged |= ImGui::InputScalarN("Region", ImGuiDataType_U64, this->m_region, 2, nullptr, nullptr, "%08llX", ImGuiInputTextFlags_CharsHexadecimal);
+                ImGui::SameLine();
+                if (ImGui::Button("Whole file")) {
+                    this->m_region[0] = 0;
+                    this->m_region[1] = dataSize - 1;
+                    settingsChanged = true;
+                }
+
+                this->m_region[1] = std::min(this->m_region[1], dataSize - 1);
+                this->m_region[0] = std::min(this->m_region[0], this->m_region[1]);
+
+                ImGui::PushItemWidth(150);
+
+                const u32 step = 1, fastStep = 16;
+                settingsChanged |= ImGui::InputScalar("Width", ImGuiDataType_U32, &this->m_width, &step, &fastStep);
+                this->m_width = std::clamp<u32>(this->m_width, 1, MaxWidth);
+
+                ImGui::SameLine();
+                settingsChanged |= ImGui::Combo("Depth", &this->m_selectedDepth, Depths.data(), Depths.size());
+
+                if (this->getBitsPerPixel() <= 8) {
+                    ImGui::SameLine();
+                    if (ImGui::Combo("Palette", &this->m_selectedPalette, Palettes.data(), Palettes.size())) {
+                        this->updatePalette();
+                        settingsChanged = true;
+                    }
+                }
+
+                ImGui::SameLine();
+                ImGui::SliderInt("Scale", &this->m_scale, 1, 16);
+
+                ImGui::PopItemWidth();
+
+                if (settingsChanged)
+                    this->clearTiles();
+
+                ImGui::BeginChild("##bitmap", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_NoMove);
+
+                const float scale = this->m_scale;
+                const u64 rowCount = this->getRowCount();
+                const u64 tileCount = (rowCount + TileRows - 1) / TileRows;
+                const ImVec2 origin = ImGui::GetCursorScreenPos();
+
+                ImGui::InvisibleButton("##image", ImVec2(this->m_width * scale, rowCount * scale));
+
+                // Tiles overlapping the visible rows, plus one more on each side so they're ready before scrolling to them
+                const u64 firstVisibleRow = ImGui::GetScrollY() / scale;
+                const u64 lastVisibleRow = (ImGui::GetScrollY() + ImGui::GetWindowHeight()) / scale;
+                const u64 firstTile = std::min(firstVisibleRow / TileRows, tileCount - 1) - (firstVisibleRow >= TileRows ? 1 : 0);
+                const u64 lastTile = std::min(lastVisibleRow / TileRows + 1, tileCount - 1);
+
+                auto drawList = ImGui::GetWindowDrawList();
+                const u64 frame = ImGui::GetFrameCount();
+                const u64 tileBytes = this->getRowSize() * TileRows;
+
+                u64 decodedBytes = 0;
+                bool tilesPending = false;
+                for (u64 index = firstTile; index <= lastTile; index++) {
+                    auto &tile = this->m_tiles[index];
+                    tile.lastUsedFrame = frame;
+
+                    if (tile.texture == 0 || tile.dirty) {
+                        if (decodedBytes < DecodeBudget) {
+                            this->uploadTile(index, tile);
+                            decodedBytes += tileBytes;
+                        } else {
+                            tilesPending = true;
+                        }
+                    }
+
+                    const u64 rows = std::min(TileRows, rowCount - index * TileRows);
+                    const ImVec2 tileStart = ImVec2(origin.x, origin.y + index * TileRows * scale);
+                    const ImVec2 tileEnd = ImVec2(origin.x + this->m_width * scale, tileStart.y + rows * scale);
+
+                    if (tile.texture != 0)
+                        drawList->AddImage(reinterpret_cast<ImTextureID>(intptr_t(tile.texture)), tileStart, tileEnd);
+                    else
+                        drawList->AddRectFilled(tileStart, tileEnd, ImGui::GetColorU32(ImGuiCol_FrameBg));
+                }
+
+                if (tilesPending)
+                    ImHexApi::Common::requestRedraw();
+
+                // Tiles visible on a full screen always stay around, no matter how large they are
+                const u64 textureSize = u64(this->m_width) * TileRows * sizeof(u32);
+                this->evictTiles(std::max<u64>(MaxTextureMemory / textureSize, (lastTile - firstTile + 1) * 2));
+
+                if (ImGui::IsItemHovered()) {
+                    const auto mousePos = ImGui::GetIO().MousePos;
+                    const u64 x = std::max(0.0F, mousePos.x - origin.x) / scale;
+                    const u64 y = std::max(0.0F, mousePos.y - origin.y) / scale;
+
+                    const u64 address = this->m_region[0] + y * this->getRowSize() + x * this->getBitsPerPixel() / 8;
+                    if (x < this->m_width && address <= this->m_region[1]) {
+                        ImGui::SetTooltip("0x%08llX", provider->getBaseAddress() + address);
+
+                        if (ImGui::IsItemClicked())
+                            View::postEvent(Events::SelectionChangeRequest, Region { address, std::max<u64>(this->getBitsPerPixel() / 8, 1) });
+                    }
+                }
+
+                ImGui::EndChild();
+            }
+        }
+        ImGui::End();
+    }
+
+    void ViewBitmap::drawMenu() {
+
+    }
+
+}
@@ -1,39 +1,42 @@
 #include "views/view_bookmarks.hpp"
 
 #include <hex/providers/provider.hpp>
+#include <hex/helpers/bookmark_store.hpp>
 #include "helpers/project_file_handler.hpp"
 
+#include <imgui_imhex_extensions.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
+#include <limits>
 
 namespace hex {
 
     ViewBookmarks::ViewBookmarks() : View("Bookmarks") {
         View::subscribeEvent(Events::AddBookmark, [](auto userData) {
             auto bookmark = std::any_cast<ImHexApi::Bookmarks::Entry>(userData);
-            bookmark.comment.resize(0xF'FFFF);
 
             if (bookmark.name.empty()) {
-                bookmark.name.resize(64);
-                std::memset(bookmark.name.data(), 0x00, 64);
-                std::strcpy(bookmark.name.data(), hex::format("Bookmark [0x%lX - 0x%lX]",
-                                                              bookmark.region.address,
-                                                              bookmark.region.address + bookmark.region.size - 1).c_str());
+                bookmark.name = hex::format("Bookmark [0x%lX - 0x%lX]",
+                                            bookmark.region.address,
+                                            bookmark.region.address + bookmark.region.size - 1);
             }
 
-            if (bookmark.comment.empty())
-                std::memset(bookmark.comment.data(), 0x00, 0xF'FFFF);
-
-            bookmark.color = ImGui::GetColorU32(ImGuiCol_Header);
+            if (bookmark.color == 0x00000000)
+                bookmark.color = ImGui::GetColorU32(ImGuiCol_Header);
 
-            SharedData::bookmarkEntries.push_back(bookmark);
+            SharedData::bookmarkEntries.add(std::move(bookmark));
             ProjectFile::markDirty();
         });
 
-        View::subscribeEvent(Events::ProjectFileLoad, [](auto) {
-            SharedData::bookmarkEntries = ProjectFile::getBookmarks();
+        View::subscribeEvent(Events::ProjectFileLoad, [this](auto) {
+            this->m_selectedBookmark = nullptr;
+            SharedData::bookmarkEntries.assign(ProjectFile::getBookmarks());
         });
         View::subscribeEvent(Events::ProjectFileStore, [](auto) {
-            ProjectFile::setBookmarks(SharedData::bookmarkEntries);
+            ProjectFile::setBookmarks(SharedData::bookmarkEntries.getEntries());
         });
     }
 
@@ -43,84 +46,177 @@ namespace hex {
         View::unsubscribeEvent(Events::ProjectFileStore);
     }
 
-    void ViewBookmarks::drawContent() {
-        if (ImGui::Begin("Bookmarks", &this->getWindowOpenState())) {
-            if (ImGui::BeginChild("##scrolling")) {
+    static bool containsIgnoringCase(const std::string &string, const std::string &search) {
+        return std::search(string.begin(), string.end(), search.begin(), search.end(), [](char left, char right) {
+            return std::tolower(u8(left)) == std::tolower(u8(right));
+        }) != string.end();
+    }
 
-                auto &bookmarks = ImHexApi::Bookmarks::getEntries();
+    void ViewBookmarks::updateFilter() {
+        auto &bookmarks = ImHexApi::Bookmarks::getEntries();
 
-                if (bookmarks.empty()) {
-                    ImGui::NewLine();
-                    ImGui::Indent(30);
-                    ImGui::TextWrapped("No bookmarks created yet. Add one with Edit -> Add Bookmark");
-                }
+        this->m_shouldUpdateFilter = false;
+        this->m_filteredGeneration = bookmarks.getGeneration();
+        this->m_filteredBookmarks.clear();
 
-                u32 id = 1;
-                auto bookmarkToRemove = bookmarks.end();
-                for (auto iter = bookmarks.begin(); iter != bookmarks.end(); iter++) {
-                    auto &[region, name, comment, color] = *iter;
-
-                    auto headerColor = ImColor(color);
-                    auto hoverColor = ImColor(color);
-                    hoverColor.Value.w *= 1.3F;
-
-                    ImGui::PushID(id);
-                    ImGui::PushStyleColor(ImGuiCol_Header, color);
-                    ImGui::PushStyleColor(ImGuiCol_HeaderActive, color);
-                    ImGui::PushStyleColor(ImGuiCol_HeaderHovered, u32(hoverColor));
-                    if (ImGui::CollapsingHeader((std::string(name.data()) + "###" + std::to_string((u64)comment.data())).c_str())) {
-                        ImGui::TextUnformatted("Information");
-                        ImGui::Separator();
-                        ImGui::Text("0x%08lx : 0x%08lx (%lu bytes)", region.address, region.address + region.size - 1, region.size);
-
-                        {
-                            u8 bytes[10] = { 0 };
-                            (SharedData::currentProvider)->read(region.address, bytes, std::min(region.size, size_t(10)));
-
-                            std::string bytesString;
-                            for (u8 i = 0; i < std::min(region.size, size_t(10)); i++) {
-                                bytesString += hex::format("%02X ", bytes[i]);
-                            }
-
-                            if (region.size > 10) {
-                                bytesString.pop_back();
-                                bytesString += "...";
-                            }
-
-                            ImGui::TextColored(ImColor(0xFF9BC64D), bytesString.c_str());
-                        }
-                        if (ImGui::Button("Jump to"))
-                            View::postEvent(Events::SelectionChangeRequest, region);
-                        ImGui::SameLine(0, 15);
-
-                        if (ImGui::Button("Remove"))
-                            bookmarkToRemove = iter;
-
-                        ImGui::NewLine();
-                        ImGui::TextUnformatted("Name");
-                        ImGui::Separator();
-                        ImGui::InputText("##nameInput", std::string(name.data()).data(), 64);
-                        ImGui::SameLine();
-                        ImGui::ColorEdit4("Color", (float*)&headerColor.Value, ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoLabel | ImGuiColorEditFlags_NoAlpha);
-                        color = headerColor;
-                        ImGui::NewLine();
-                        ImGui::TextUnformatted("Comment");
-                        ImGui::Separator();
-                        ImGui::InputTextMultiline("##colorInput", std::string(comment.data()).data(), 0xF'FFFF);
-                        ImGui::NewLine();
+        u64 startAddress = std::strtoull(this->m_filterStartAddress, nullptr, 16);
+        u64 endAddress = this->m_filterEndAddress[0] == 0x00 ? std::numeric_limits<u64>::max() : std::strtoull(this->m_filterEndAddress, nullptr, 16);
+
+        // Bookmarks are sorted by their start address, everything starting after the end of the range can be skipped right away
+        const auto &sortedBookmarks = bookmarks.getSortedEntries();
+        auto last = std::upper_bound(sortedBookmarks.begin(), sortedBookmarks.end(), endAddress, [](u64 address, const auto bookmark) {
+            return address < bookmark->region.address;
+        });
+
+        for (auto it = sortedBookmarks.begin(); it != last; it++) {
+            auto bookmark = *it;
+
+            if (bookmark->region.address + bookmark->region.size <= startAddress)
+                continue;
 
+            if (!this->m_filterText.empty() && !containsIgnoringCase(bookmark->name, this->m_filterText) && !containsIgnoringCase(bookmark->comment, this->m_filterText))
+                continue;
+
+            this->m_filteredBookmarks.push_back(bookmark);
+        }
+    }
+
+    void ViewBookmarks::drawBookmarkDetails(ImHexApi::Bookmarks::Entry &bookmark) {
+        auto &[region, name, comment, color] = bookmark;
+
+        ImGui::TextUnformatted("Information");
+        ImGui::Separator();
+        ImGui::Text("0x%08lx : 0x%08lx (%lu bytes)", region.address, region.address + region.size - 1, region.size);
+
+        {
+            u8 bytes[10] = { 0 };
+            (SharedData::currentProvider)->readAbsolute(region.address, bytes, std::min(region.size, size_t(10)));
+
+            std::string bytesString;
+            for (u8 i = 0; i < std::min(region.size, size_t(10)); i++) {
+                bytesString += hex::format("%02X ", bytes[i]);
+            }
+
+            if (region.size > 10) {
+                bytesString.pop_back();
+                bytesString += "...";
+            }
+
+            ImGui::TextColored(ImColor(0xFF9BC64D), "%s", bytesString.c_str());
+        }
+        if (ImGui::Button("Jump to"))
+            View::postEvent(Events::SelectionChangeRequest, region);
+        ImGui::SameLine(0, 15);
+
+        if (ImGui::Button("Remove")) {
+            auto &bookmarks = ImHexApi::Bookmarks::getEntries();
+            auto entry = std::find_if(bookmarks.begin(), bookmarks.end(), [&bookmark](const auto &entry) { return &entry == &bookmark; });
+
+            this->m_selectedBookmark = nullptr;
+            bookmarks.erase(entry);
+            ProjectFile::markDirty();
+            return;
+        }
+
+        ImGui::NewLine();
+        ImGui::TextUnformatted("Name");
+        ImGui::Separator();
+        if (ImGui::InputText("##nameInput", name)) {
+            ProjectFile::markDirty();
+            this->m_shouldUpdateFilter = true;
+        }
+        // Names and comments don't affect the index, but the journal has to pick up that they changed
+        if (ImGui::IsItemDeactivatedAfterEdit())
+            ImHexApi::Bookmarks::getEntries().markChanged();
+        ImGui::SameLine();
+
+        auto headerColor = ImColor(color);
+        ImGui::ColorEdit4("Color", (float*)&headerColor.Value, ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoLabel | ImGuiColorEditFlags_NoAlpha);
+        if (u32(headerColor) != color) {
+            color = headerColor;
+            ImHexApi::Bookmarks::getEntries().markChanged();
+        }
+
+        ImGui::NewLine();
+        ImGui::TextUnformatted("Comment");
+        ImGui::Separator();
+        if (ImGui::InputTextMultiline("##commentInput", comment)) {
+            ProjectFile::markDirty();
+            this->m_shouldUpdateFilter = true;
+        }
+        if (ImGui::IsItemDeactivatedAfterEdit())
+            ImHexApi::Bookmarks::getEntries().markChanged();
+    }
+
+    void ViewBookmarks::drawContent() {
+        if (ImGui::Begin("Bookmarks", &this->getWindowOpenState())) {
+            auto &bookmarks = ImHexApi::Bookmarks::getEntries();
+
+            if (bookmarks.empty()) {
+                ImGui::NewLine();
+                ImGui::Indent(30);
+                ImGui::TextWrapped("No bookmarks created yet. Add one with Edit -> Add Bookmark");
+            } else {
+                ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x * 0.5F);
+                if (ImGui::InputText("Filter", this->m_filterText))
+                    this->m_shouldUpdateFilter = true;
+                ImGui::PopItemWidth();
+
+                ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x * 0.2F);
+                if (ImGui::InputText("##filterStart", this->m_filterStartAddress, sizeof(this->m_filterStartAddress), ImGuiInputTextFlags_CharsHexadecimal))
+                    this->m_shouldUpdateFilter = true;
+                ImGui::SameLine();
+                if (ImGui::InputText("Address range", this->m_filterEndAddress, sizeof(this->m_filterEndAddress), ImGuiInputTextFlags_CharsHexadecimal))
+                    this->m_shouldUpdateFilter = true;
+                ImGui::PopItemWidth();
+
+                if (this->m_shouldUpdateFilter || this->m_filteredGeneration != bookmarks.getGeneration())
+                    this->updateFilter();
+
+                const auto &filteredBookmarks = this->m_filteredBookmarks;
+
+                if (ImGui::BeginTable("##bookmarks", 3, ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg,
+                                      ImVec2(0, ImGui::GetTextLineHeightWithSpacing() * 12))) {
+                    ImGui::TableSetupScrollFreeze(0, 1);
+                    ImGui::TableSetupColumn("Name");
+                    ImGui::TableSetupColumn("Address");
+                    ImGui::TableSetupColumn("Size");
+
+                    ImGui::TableHeadersRow();
+
+                    // Only the visible rows get drawn, so even loader scripts adding thousands of bookmarks don't slow this down
+                    ImGuiListClipper clipper;
+                    clipper.Begin(filteredBookmarks.size());
+
+                    while (clipper.Step()) {
+                        for (s64 i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                            auto bookmark = filteredBookmarks[i];
+
+                            ImGui::PushID(i);
+                            ImGui::TableNextRow();
+                            ImGui::TableNextColumn();
+                            ImGui::ColorButton("##color", ImColor(bookmark->color).Value, ImGuiColorEditFlags_NoTooltip);
+                            ImGui::SameLine();
+                            if (ImGui::Selectable(bookmark->name.c_str(), bookmark == this->m_selectedBookmark, ImGuiSelectableFlags_SpanAllColumns))
+                                this->m_selectedBookmark = bookmark;
+                            if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+                                View::postEvent(Events::SelectionChangeRequest, bookmark->region);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("0x%08lx : 0x%08lx", bookmark->region.address, bookmark->region.address + bookmark->region.size - 1);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%lu", bookmark->region.size);
+                            ImGui::PopID();
+                        }
                     }
-                    ImGui::PopID();
-                    ImGui::PopStyleColor(3);
-                    id++;
-                }
+                    clipper.End();
 
-                if (bookmarkToRemove != bookmarks.end()) {
-                    bookmarks.erase(bookmarkToRemove);
-                    ProjectFile::markDirty();
+                    ImGui::EndTable();
                 }
 
-                ImGui::EndChild();
+                ImGui::NewLine();
+
+                if (this->m_selectedBookmark != nullptr)
+                    this->drawBookmarkDetails(*this->m_selectedBookmark);
             }
         }
         ImGui::End();
@@ -130,4 +226,4 @@ namespace hex {
 
     }
 
-}
\ No newline at end of file
+}
@@ -1,22 +1,32 @@
 #include "views/view_command_palette.hpp"
 
+#include <hex/api/imhex_api.hpp>
+
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <cctype>
+
 namespace hex {
 
+    using CommandType = ContentRegistry::CommandPaletteCommands::Type;
+
     ViewCommandPalette::ViewCommandPalette() : View("Command Palette") {
         this->m_commandBuffer.resize(1024, 0x00);
         this->m_lastResults = this->getCommandResults("");
     }
 
     ViewCommandPalette::~ViewCommandPalette() {
-
+        if (this->m_commandTask != nullptr)
+            this->m_commandTask->cancel();
     }
 
     void ViewCommandPalette::drawContent() {
 
         if (!this->getWindowOpenState()) return;
 
+        this->runPendingCommand();
+
         auto windowPos = SharedData::windowPos;
         auto windowSize = SharedData::windowSize;
         auto paletteSize = this->getMinSize();
@@ -44,6 +54,9 @@ namespace hex {
 
             ImGui::Separator();
 
+            if (this->m_matchedCommand.has_value())
+                ImGui::TextUnformatted(this->m_exactResult.c_str());
+
             for (const auto &result : this->m_lastResults) {
                 ImGui::TextUnformatted(result.c_str());
             }
@@ -72,55 +85,145 @@ namespace hex {
         return false;
     }
 
-    enum class MatchType {
-        NoMatch,
-        InfoMatch,
-        PartialMatch,
-        PerfectMatch
-    };
+    void ViewCommandPalette::updateCommandIndex() {
+        const auto &entries = ContentRegistry::CommandPaletteCommands::getEntries();
+        if (this->m_indexedCommandCount == entries.size())
+            return;
 
-    std::vector<std::string> ViewCommandPalette::getCommandResults(std::string_view input) {
-        constexpr auto matchCommand = [](std::string_view currCommand, std::string_view commandToMatch) -> std::pair<MatchType, std::string_view> {
-            if (currCommand.empty()) {
-                return { MatchType::InfoMatch, "" };
-            }
-            else if (currCommand.size() <= commandToMatch.size()) {
-                if (commandToMatch.starts_with(currCommand))
-                    return { MatchType::PartialMatch, currCommand };
-                else
-                    return { MatchType::NoMatch, { } };
-            }
-            else {
-                if (currCommand.starts_with(commandToMatch))
-                    return { MatchType::PerfectMatch, currCommand.substr(commandToMatch.length()) };
-                else
-                    return { MatchType::NoMatch, { } };
-            }
-        };
+        this->m_commandIndex.clear();
+        this->m_commandLengths.clear();
 
-        std::vector<std::string> results;
+        // Keyword commands are only complete once they're followed by a space, so that's part of what gets matched
+        for (size_t i = 0; i < entries.size(); i++) {
+            auto command = entries[i].type == CommandType::KeywordCommand ? entries[i].command + " " : entries[i].command;
 
-        for (const auto &[type, command, description, callback] : ContentRegistry::CommandPaletteCommands::getEntries()) {
+            this->m_commandLengths.insert(command.length());
+            this->m_commandIndex.emplace(std::move(command), i);
+        }
 
-            if (type == ContentRegistry::CommandPaletteCommands::Type::SymbolCommand) {
-                if (auto [match, value] = matchCommand(input, command); match != MatchType::NoMatch) {
-                    if (match != MatchType::PerfectMatch)
-                        results.emplace_back(command + " (" + description + ")");
-                    else
-                        results.emplace_back(callback(input.substr(command.length()).data()));
-                }
-            } else if (type == ContentRegistry::CommandPaletteCommands::Type::KeywordCommand) {
-                if (auto [match, value] = matchCommand(input, command + " "); match != MatchType::NoMatch) {
-                    if (match != MatchType::PerfectMatch)
-                        results.emplace_back(command + " (" + description + ")");
-                    else
-                        results.emplace_back(callback(input.substr(command.length() + 1).data()));
+        this->m_indexedCommandCount = entries.size();
+    }
+
+    // Scores how well the characters of the input appear in order in the text. Consecutive characters and ones at the start
+    // of words count more. Returns nothing if not all characters of the input could be found
+    static std::optional<u32> getFuzzyScore(std::string_view input, std::string_view text) {
+        u32 score = 0;
+        u32 consecutive = 0;
+
+        size_t position = 0;
+        for (char c : input) {
+            auto lower = std::tolower(u8(c));
+
+            bool found = false;
+            for (; position < text.size(); position++) {
+                if (std::tolower(u8(text[position])) != lower) {
+                    consecutive = 0;
+                    continue;
                 }
+
+                score += 1 + consecutive * 2;
+                if (position == 0 || text[position - 1] == ' ')
+                    score += 3;
+
+                consecutive++;
+                position++;
+                found = true;
+                break;
+            }
+
+            if (!found)
+                return std::nullopt;
+        }
+
+        return score;
+    }
+
+    std::vector<std::string> ViewCommandPalette::getCommandResults(std::string_view input) {
+        this->updateCommandIndex();
+
+        const auto &entries = ContentRegistry::CommandPaletteCommands::getEntries();
+        std::vector<std::string> results;
+
+        // A complete command followed by its input gets run, the longest one that matches wins
+        std::optional<size_t> matchedCommand;
+        size_t matchedLength = 0;
+        for (auto it = this->m_commandLengths.rbegin(); it != this->m_commandLengths.rend(); it++) {
+            if (*it > input.length())
+                continue;
+
+            if (auto entry = this->m_commandIndex.find(std::string(input.substr(0, *it))); entry != this->m_commandIndex.end()) {
+                matchedCommand = entry->second;
+                matchedLength = *it;
+                break;
             }
+        }
+
+        if (matchedCommand.has_value()) {
+            // Evaluating the command may take a while, it's done in the background once the input stopped changing
+            if (this->m_matchedCommand != matchedCommand)
+                this->m_exactResult = input;
 
+            this->m_matchedCommand = matchedCommand;
+            this->m_commandArgument = input.substr(matchedLength);
+            this->m_lastInputTime = std::chrono::steady_clock::now();
+            this->m_shouldRunCommand = true;
+
+            return results;
+        }
+
+        this->m_matchedCommand.reset();
+        this->m_shouldRunCommand = false;
+
+        // Commands the input is the start of, found through the index
+        for (auto it = this->m_commandIndex.lower_bound(std::string(input)); it != this->m_commandIndex.end() && it->first.starts_with(input); it++) {
+            const auto &entry = entries[it->second];
+            results.emplace_back(entry.command + " (" + entry.description + ")");
         }
 
+        if (!results.empty() || input.empty())
+            return results;
+
+        // Nothing starts with the input, so commands get ranked by how well it fuzzily matches their name and description
+        std::vector<std::pair<u32, size_t>> rankedEntries;
+        for (size_t i = 0; i < entries.size(); i++) {
+            auto score = std::max(getFuzzyScore(input, entries[i].command).value_or(0) * 2, getFuzzyScore(input, entries[i].description).value_or(0));
+            if (score > 0)
+                rankedEntries.emplace_back(score, i);
+        }
+
+        std::stable_sort(rankedEntries.begin(), rankedEntries.end(), [](const auto &left, const auto &right) { return left.first > right.first; });
+        if (rankedEntries.size() > MaxFuzzyResults)
+            rankedEntries.resize(MaxFuzzyResults);
+
+        for (const auto &[score, index] : rankedEntries)
+            results.emplace_back(entries[index].command + " (" + entries[index].description + ")");
+
         return results;
     }
 
-}
\ No newline at end of file
+    void ViewCommandPalette::runPendingCommand() {
+        if (!this->m_shouldRunCommand || !this->m_matchedCommand.has_value())
+            return;
+
+        // Keeps frames coming until the debounce time ran out, the main loop would otherwise wait for the next input
+        if (std::chrono::steady_clock::now() - this->m_lastInputTime < CommandDebounceTime) {
+            ImHexApi::Common::requestRedraw();
+            return;
+        }
+
+        this->m_shouldRunCommand = false;
+
+        if (this->m_commandTask != nullptr)
+            this->m_commandTask->cancel();
+
+        auto callback = ContentRegistry::CommandPaletteCommands::getEntries()[*this->m_matchedCommand].callback;
+        auto result = std::make_shared<std::string>();
+
+        this->m_commandTask = TaskManager::submit("Running command", TaskPriority::Interactive, [callback, argument = this->m_commandArgument, result](Task &) {
+            *result = callback(argument);
+        }, [this, result] {
+            this->m_exactResult = std::move(*result);
+        });
+    }
+
+}
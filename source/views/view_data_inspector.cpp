@@ -2,7 +2,11 @@
 
 #include <hex/providers/provider.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <limits>
+#include <span>
 
 extern int ImTextCharFromUtf8(unsigned int* out_char, const char* in_text, const char* in_text_end);
 
@@ -28,28 +32,163 @@ namespace hex {
 
             this->m_validBytes = u64(provider->getSize() - region.address);
             this->m_startAddress = region.address;
+            this->m_selectionSize = std::min<u64>(region.size, this->m_validBytes);
 
             this->m_shouldInvalidate = true;
         });
+
+        View::subscribeEvent(Events::DataChanged, [this](auto) {
+            this->m_shouldInvalidate = true;
+        });
     }
 
     ViewDataInspector::~ViewDataInspector() {
         View::unsubscribeEvent(Events::RegionSelected);
+        View::unsubscribeEvent(Events::DataChanged);
+    }
+
+    void ViewDataInspector::updateColumn() {
+        this->m_shouldUpdateColumn = false;
+        this->m_columnStatistics.reset();
+
+        auto &entries = ContentRegistry::DataInspector::getEntries();
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || this->m_columnEntry >= entries.size()) {
+            this->m_columnData.clear();
+            return;
+        }
+
+        const auto &entry = entries[this->m_columnEntry];
+
+        // Only whole values are decoded, a trailing partial one is left out
+        auto size = std::min(this->m_selectionSize, MaxColumnSize);
+        size -= size % entry.requiredSize;
+
+        this->m_columnData.resize(size);
+        if (size > 0)
+            provider->read(this->m_startAddress, this->m_columnData.data(), size);
+
+        if (!entry.columnFunction || size == 0)
+            return;
+
+        this->m_columnValues.resize(size / entry.requiredSize);
+        entry.columnFunction(this->m_columnData, this->m_endian, this->m_columnValues);
+
+        ColumnStatistics statistics = { 0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), 0 };
+        double sum = 0;
+        for (auto value : this->m_columnValues) {
+            if (std::isnan(value))
+                continue;
+
+            statistics.min = std::min(statistics.min, value);
+            statistics.max = std::max(statistics.max, value);
+            sum += value;
+            statistics.count++;
+        }
+
+        if (statistics.count > 0) {
+            statistics.mean = sum / statistics.count;
+            this->m_columnStatistics = statistics;
+        }
+    }
+
+    void ViewDataInspector::drawColumn() {
+        auto &entries = ContentRegistry::DataInspector::getEntries();
+        if (entries.empty())
+            return;
+
+        if (this->m_columnEntry >= entries.size())
+            this->m_columnEntry = 0;
+
+        if (ImGui::BeginCombo("Type", entries[this->m_columnEntry].name.c_str())) {
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (ImGui::Selectable(entries[i].name.c_str(), i == this->m_columnEntry)) {
+                    this->m_columnEntry = i;
+                    this->m_shouldUpdateColumn = true;
+                }
+            }
+            ImGui::EndCombo();
+        }
+
+        if (this->m_shouldUpdateColumn)
+            this->updateColumn();
+
+        const auto &entry = entries[this->m_columnEntry];
+        const size_t count = this->m_columnData.size() / entry.requiredSize;
+
+        if (this->m_selectionSize > MaxColumnSize)
+            ImGui::TextUnformatted(hex::format("%zu values, only the first %s of the selection are shown", count, hex::toByteString(MaxColumnSize).c_str()).c_str());
+        else
+            ImGui::TextUnformatted(hex::format("%zu values", count).c_str());
+
+        if (this->m_columnStatistics.has_value()) {
+            const auto &[valueCount, min, max, mean] = *this->m_columnStatistics;
+            ImGui::TextUnformatted(hex::format("Min: %g  Max: %g  Mean: %g", min, max, mean).c_str());
+        }
+
+        if (ImGui::BeginTable("##inspectorcolumn", 2, ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Address");
+            ImGui::TableSetupColumn("Value");
+
+            ImGui::TableHeadersRow();
+
+            // Values are only formatted for the rows that are visible
+            ImGuiListClipper clipper;
+            clipper.Begin(count);
+
+            while (clipper.Step()) {
+                for (s64 i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    auto buffer = std::span<const u8>(this->m_columnData).subspan(i * entry.requiredSize, entry.requiredSize);
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("0x%08llX", this->m_startAddress + i * entry.requiredSize);
+                    ImGui::TableNextColumn();
+
+                    entry.generatorFunction(buffer, this->m_endian, this->m_numberDisplayStyle, this->m_columnValue);
+                    if (entry.displayFunction) {
+                        ImGui::PushID(i);
+                        entry.displayFunction(buffer, this->m_endian, this->m_columnValue);
+                        ImGui::PopID();
+                    } else
+                        ImGui::TextUnformatted(this->m_columnValue.c_str(), this->m_columnValue.c_str() + this->m_columnValue.size());
+                }
+            }
+            clipper.End();
+
+            ImGui::EndTable();
+        }
     }
 
     void ViewDataInspector::drawContent() {
-        if (this->m_shouldInvalidate) {
+        auto &entries = ContentRegistry::DataInspector::getEntries();
+
+        if (this->m_shouldInvalidate || this->m_cachedValues.size() != entries.size()) {
             this->m_shouldInvalidate = false;
+            this->m_shouldUpdateColumn = true;
+
+            size_t requiredSize = 0;
+            for (const auto &entry : entries)
+                requiredSize = std::max(requiredSize, entry.requiredSize);
+
+            this->m_buffer.resize(requiredSize);
+            this->m_cachedValues.resize(entries.size());
 
-            this->m_cachedData.clear();
             auto provider = SharedData::currentProvider;
-            for (auto &entry : ContentRegistry::DataInspector::getEntries()) {
-                if (this->m_validBytes < entry.requiredSize)
+            this->m_readSize = std::min<size_t>(requiredSize, provider != nullptr ? this->m_validBytes : 0);
+
+            std::fill(this->m_buffer.begin() + this->m_readSize, this->m_buffer.end(), 0x00);
+            if (this->m_readSize > 0)
+                provider->read(this->m_startAddress, this->m_buffer.data(), this->m_readSize);
+
+            this->m_validEntryCount = 0;
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (this->m_readSize < entries[i].requiredSize)
                     continue;
 
-                std::vector<u8> buffer(entry.requiredSize);
-                provider->read(this->m_startAddress, buffer.data(), buffer.size());
-                this->m_cachedData.emplace_back(entry.name, entry.generatorFunction(buffer, this->m_endian, this->m_numberDisplayStyle));
+                entries[i].generatorFunction(std::span(this->m_buffer.data(), entries[i].requiredSize), this->m_endian, this->m_numberDisplayStyle, this->m_cachedValues[i]);
+                this->m_validEntryCount++;
             }
         }
 
@@ -60,19 +199,28 @@ namespace hex {
             if (provider != nullptr && provider->isReadable()) {
                 if (ImGui::BeginTable("##datainspector", 2,
                     ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg,
-                    ImVec2(0, ImGui::GetTextLineHeightWithSpacing() * (this->m_cachedData.size() + 1)))) {
+                    ImVec2(0, ImGui::GetTextLineHeightWithSpacing() * (this->m_validEntryCount + 1)))) {
                     ImGui::TableSetupScrollFreeze(0, 1);
                     ImGui::TableSetupColumn("Name");
                     ImGui::TableSetupColumn("Value");
 
                     ImGui::TableHeadersRow();
 
-                    for (const auto &[name, function] : this->m_cachedData) {
+                    for (size_t i = 0; i < entries.size(); i++) {
+                        const auto &entry = entries[i];
+                        if (this->m_readSize < entry.requiredSize)
+                            continue;
+
                         ImGui::TableNextRow();
                         ImGui::TableNextColumn();
-                        ImGui::TextUnformatted(name.c_str());
+                        ImGui::TextUnformatted(entry.name.c_str());
                         ImGui::TableNextColumn();
-                        function();
+
+                        const auto &value = this->m_cachedValues[i];
+                        if (entry.displayFunction)
+                            entry.displayFunction(std::span(this->m_buffer.data(), entry.requiredSize), this->m_endian, value);
+                        else
+                            ImGui::TextUnformatted(value.c_str(), value.c_str() + value.size());
                     }
 
                     ImGui::EndTable();
@@ -104,6 +252,11 @@ namespace hex {
                     this->m_numberDisplayStyle = NumberDisplayStyle::Octal;
                     this->m_shouldInvalidate = true;
                 }
+
+                ImGui::NewLine();
+
+                if (ImGui::CollapsingHeader("Selection as column"))
+                    this->drawColumn();
             }
         }
         ImGui::End();
@@ -3,6 +3,9 @@
 #include <hex/providers/provider.hpp>
 
 #include <imnodes.h>
+#include <imgui_internal.h>
+
+#include <thread>
 
 namespace hex {
 
@@ -17,27 +20,42 @@ namespace hex {
             io.link_detach_with_modifier_click.modifier = &always;
         }
 
-        View::subscribeEvent(Events::SettingsChanged, [](auto) {
-            int theme = ContentRegistry::Settings::getSettingsData()["Interface"]["Color theme"];
-
-            switch (theme) {
-                default:
-                case 0: /* Dark theme */
-                    imnodes::StyleColorsDark();
-                    break;
-                case 1: /* Light theme */
-                    imnodes::StyleColorsLight();
-                    break;
-                case 2: /* Classic theme */
-                    imnodes::StyleColorsClassic();
-                    break;
-            }
-
-            imnodes::GetStyle().flags = imnodes::StyleFlags(imnodes::StyleFlags_NodeOutline | imnodes::StyleFlags_GridLines);
+        // The view may get created after the settings have been loaded, so the current theme is applied right away as well
+        applyTheme();
+        View::subscribeEvent(Events::SettingsChanged, [](auto userData) {
+            if (ContentRegistry::Settings::changed(userData, "Interface", "Color theme"))
+                applyTheme();
         });
     }
 
+    void ViewDataProcessor::applyTheme() {
+        int theme = ContentRegistry::Settings::getSettingsData()["Interface"]["Color theme"];
+
+        switch (theme) {
+            default:
+            case 0: /* Dark theme */
+                imnodes::StyleColorsDark();
+                break;
+            case 1: /* Light theme */
+                imnodes::StyleColorsLight();
+                break;
+            case 2: /* Classic theme */
+                imnodes::StyleColorsClassic();
+                break;
+        }
+
+        imnodes::GetStyle().flags = imnodes::StyleFlags(imnodes::StyleFlags_NodeOutline | imnodes::StyleFlags_GridLines);
+    }
+
     ViewDataProcessor::~ViewDataProcessor() {
+        // The nodes are in use until the cancellation got noticed between two chunks
+        if (this->m_processingTask != nullptr) {
+            this->m_processingTask->cancel();
+
+            while (!this->m_processingTask->isFinished())
+                std::this_thread::yield();
+        }
+
         for (auto &node : this->m_nodes)
             delete node;
 
@@ -60,6 +78,7 @@ namespace hex {
         }
 
         this->m_links.erase(link);
+        this->m_executor.invalidate();
     }
 
     void ViewDataProcessor::eraseNodes(const std::vector<int> &ids) {
@@ -81,39 +100,104 @@ namespace hex {
 
             std::erase_if(this->m_endNodes, [&id](auto node){ return node->getID() == id; });
 
+            this->m_nodeContentSizes.erase(id);
             delete *node;
 
             this->m_nodes.erase(node);
         }
+
+        this->m_executor.invalidate();
     }
 
     void ViewDataProcessor::processNodes() {
+        if (this->isProcessing())
+            return;
+
         if (this->m_dataOverlays.size() != this->m_endNodes.size()) {
             for (auto overlay : this->m_dataOverlays)
                 SharedData::currentProvider->deleteOverlay(overlay);
             this->m_dataOverlays.clear();
+            this->m_stagedOverlays.clear();
 
-            for (u32 i = 0; i < this->m_endNodes.size(); i++)
+            for (u32 i = 0; i < this->m_endNodes.size(); i++) {
                 this->m_dataOverlays.push_back(SharedData::currentProvider->newOverlay());
-
-            u32 overlayIndex = 0;
-            for (auto endNode : this->m_endNodes) {
-                endNode->setCurrentOverlay(this->m_dataOverlays[overlayIndex]);
-                overlayIndex++;
+                this->m_stagedOverlays.push_back(std::make_unique<StagedOverlay>());
             }
+
+            for (auto endNode : this->m_endNodes)
+                endNode->markDirty();
+        }
+
+        // A stream that's halfway through would continue in the other overlays, so it starts over
+        if (this->m_overlaysStaged != this->m_processInBackground) {
+            this->m_overlaysStaged = this->m_processInBackground;
+
+            for (auto endNode : this->m_endNodes)
+                endNode->markDirty();
+        }
+
+        if (this->m_processInBackground) {
+            this->processNodesInBackground();
+            return;
         }
 
         u32 overlayIndex = 0;
-        for (auto &endNode : this->m_endNodes) {
-            (void)endNode->process();
-            overlayIndex++;
+        for (auto endNode : this->m_endNodes)
+            endNode->setCurrentOverlay(this->m_dataOverlays[overlayIndex++]);
+
+        this->m_executor.execute(this->m_endNodes, SharedData::currentProvider);
+    }
+
+    bool ViewDataProcessor::isProcessing() const {
+        return this->m_processingTask != nullptr && !this->m_processingTask->isFinished();
+    }
+
+    void ViewDataProcessor::processNodesInBackground() {
+        auto provider = SharedData::currentProvider;
+        if (this->m_executor.isUpToDate(provider))
+            return;
+
+        std::vector<u64> generations;
+        u32 overlayIndex = 0;
+        for (auto endNode : this->m_endNodes) {
+            auto &staged = *this->m_stagedOverlays[overlayIndex++];
+
+            endNode->setCurrentOverlay(&staged.overlay);
+            generations.push_back(staged.generation);
         }
+
+        auto completed = std::make_shared<bool>(false);
+
+        this->m_processingTask = TaskManager::submit("Processing data", provider, [this, provider, completed](Task &task) {
+            *completed = this->m_executor.executeFully(this->m_endNodes, provider, task);
+        }, [this, provider, completed, generations = std::move(generations)] {
+            if (!*completed || provider != SharedData::currentProvider || generations.size() != this->m_stagedOverlays.size())
+                return;
+
+            // Only overlays of end nodes that got processed are new, all others still hold what got replaced the last time
+            for (size_t i = 0; i < generations.size(); i++) {
+                auto &staged = *this->m_stagedOverlays[i];
+
+                if (staged.generation != generations[i])
+                    this->m_dataOverlays[i]->swap(staged.overlay);
+            }
+        });
     }
 
     void ViewDataProcessor::drawContent() {
         if (ImGui::Begin("Data Processor", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
 
-            if (ImGui::IsMouseReleased(ImGuiMouseButton_Right) && ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows)) {
+            const bool processing = this->isProcessing();
+
+            if (ImGui::Checkbox("Process in background", &this->m_processInBackground) && !this->m_processInBackground && this->m_processingTask != nullptr)
+                this->m_processingTask->cancel();
+
+            if (processing) {
+                ImGui::SameLine();
+                ImGui::ProgressBar(this->m_processingTask->getProgress(), ImVec2(-1, 0), "Processing...");
+            }
+
+            if (!processing && ImGui::IsMouseReleased(ImGuiMouseButton_Right) && ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows)) {
                 this->m_rightClickedCoords = ImGui::GetMousePos();
 
                 if (imnodes::IsNodeHovered(&this->m_rightClickedId))
@@ -175,6 +259,7 @@ namespace hex {
                         this->m_endNodes.push_back(node);
 
                     imnodes::SetNodeScreenSpacePos(node->getID(), this->m_rightClickedCoords);
+                    this->m_executor.invalidate();
                 }
 
                 ImGui::EndPopup();
@@ -194,8 +279,17 @@ namespace hex {
                 ImGui::EndPopup();
             }
 
+            if (auto progress = this->m_executor.getStreamProgress(); !processing && progress.has_value())
+                ImGui::ProgressBar(progress.value(), ImVec2(-1, 0), "Streaming...");
+
             imnodes::BeginNodeEditor();
 
+            // Nodes read their parameters and write their displayed values while they're being processed, so they can't be edited until that's done
+            if (processing) {
+                ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+                ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5F);
+            }
+
             for (auto& node : this->m_nodes) {
                 imnodes::BeginNode(node->getID());
 
@@ -203,7 +297,19 @@ namespace hex {
                 ImGui::TextUnformatted(node->getTitle().data());
                 imnodes::EndNodeTitleBar();
 
-                node->drawNode();
+                // Edits of any of the node's widgets get forwarded to the group. Its contents aren't even drawn while they're in use by the processing task
+                ImGui::BeginGroup();
+                if (processing)
+                    ImGui::Dummy(this->m_nodeContentSizes[node->getID()]);
+                else
+                    node->drawNode();
+                ImGui::EndGroup();
+
+                if (!processing)
+                    this->m_nodeContentSizes[node->getID()] = ImGui::GetItemRectSize();
+
+                if (ImGui::IsItemEdited())
+                    node->markDirty();
 
                 for (auto& attribute : node->getAttributes()) {
                     imnodes::PinShape pinShape;
@@ -228,11 +334,22 @@ namespace hex {
                 imnodes::EndNode();
             }
 
+            if (processing) {
+                ImGui::PopStyleVar();
+                ImGui::PopItemFlag();
+            }
+
             for (const auto &link : this->m_links)
                 imnodes::Link(link.getID(), link.getFromID(), link.getToID());
 
             imnodes::EndNodeEditor();
 
+            // Links detached or created in the editor meanwhile simply don't take effect
+            if (processing) {
+                ImGui::End();
+                return;
+            }
+
             {
                 int linkId;
                 if (imnodes::IsLinkDestroyed(&linkId)) {
@@ -271,6 +388,8 @@ namespace hex {
 
                         fromAttr->addConnectedAttribute(newLink.getID(), toAttr);
                         toAttr->addConnectedAttribute(newLink.getID(), fromAttr);
+
+                        this->m_executor.invalidate();
                     } while (false);
 
                 }
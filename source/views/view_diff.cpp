@@ -0,0 +1,482 @@
+#include "views/view_diff.hpp"
+
+#include <hex/providers/provider.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include "providers/file_provider.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+using namespace std::literals::string_literals;
+
+namespace hex {
+
+    ViewDiff::ViewDiff() : View("Diff") {
+        View::subscribeEvent(Events::DataChanged, [this](auto userData) {
+            if (this->m_compareProvider == nullptr)
+                return;
+
+            auto provider = SharedData::currentProvider;
+            auto region = std::any_cast<Region>(&userData);
+
+            // Small edits only need their blocks rehashed, that's not possible while a task is still using the maps
+            if (region != nullptr && this->m_currentHashesValid && !this->isComparing() && provider != nullptr)
+                this->m_currentHashes->update(provider, region->address, region->size);
+            else
+                this->m_currentHashesValid = false;
+
+            this->m_shouldCompare = true;
+            this->m_movedRegionsOutdated = !this->m_movedRegions.empty();
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto) {
+            this->m_currentHashesValid = false;
+            this->m_shouldCompare = true;
+            this->m_movedRegionsOutdated = !this->m_movedRegions.empty();
+        });
+    }
+
+    ViewDiff::~ViewDiff() {
+        if (this->m_diffTask != nullptr)
+            this->m_diffTask->cancel();
+        if (this->m_movedDataTask != nullptr)
+            this->m_movedDataTask->cancel();
+        if (this->m_patchTask != nullptr)
+            this->m_patchTask->cancel();
+
+        View::unsubscribeEvent(Events::DataChanged);
+        View::unsubscribeEvent(Events::ProviderChanged);
+    }
+
+    bool ViewDiff::isComparing() const {
+        return this->m_diffTask != nullptr && !this->m_diffTask->isFinished();
+    }
+
+    void ViewDiff::openCompareFile(const std::string &path) {
+        this->closeCompareFile();
+
+        auto provider = std::make_shared<prv::FileProvider>(path);
+        if (!provider->isAvailable()) {
+            View::showErrorPopup("Failed to open file!");
+            return;
+        }
+
+        this->m_comparePath = path;
+        this->m_compareProvider = std::move(provider);
+        this->m_shouldCompare = true;
+    }
+
+    void ViewDiff::closeCompareFile() {
+        if (this->m_diffTask != nullptr)
+            this->m_diffTask->cancel();
+
+        this->m_diffTask = nullptr;
+        this->m_comparePath.clear();
+        this->m_compareProvider = nullptr;
+        this->m_compareHashesValid = false;
+        this->m_differences.clear();
+        this->m_differingBytes = 0;
+        this->m_differencesTruncated = false;
+
+        if (this->m_movedDataTask != nullptr)
+            this->m_movedDataTask->cancel();
+
+        this->m_movedDataTask = nullptr;
+        this->m_compareChunks = nullptr;
+        this->m_movedRegions.clear();
+        this->m_movedRegionsOutdated = false;
+        this->updateShownMovedRegions();
+
+        if (this->m_patchTask != nullptr)
+            this->m_patchTask->cancel();
+
+        this->m_patchTask = nullptr;
+    }
+
+    void ViewDiff::compare() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isAvailable() || this->m_compareProvider == nullptr)
+            return;
+
+        if (this->m_diffTask != nullptr) {
+            this->m_diffTask->cancel();
+
+            // The cancelled task may have left its maps half built
+            if (!this->m_diffTask->isFinished()) {
+                this->m_currentHashesValid = false;
+                this->m_compareHashesValid = false;
+            }
+        }
+
+        const bool rebuildCurrent = !this->m_currentHashesValid;
+        const bool rebuildCompare = !this->m_compareHashesValid;
+
+        if (rebuildCurrent)
+            this->m_currentHashes = std::make_shared<BlockHashMap>();
+        if (rebuildCompare)
+            this->m_compareHashes = std::make_shared<BlockHashMap>();
+
+        struct Result {
+            std::vector<Difference> differences;
+            u64 differingBytes = 0;
+            bool truncated = false;
+        };
+
+        auto result = std::make_shared<Result>();
+
+        this->m_diffTask = TaskManager::submit("Comparing files", provider, [provider, compareProvider = this->m_compareProvider, currentHashes = this->m_currentHashes, compareHashes = this->m_compareHashes, rebuildCurrent, rebuildCompare, result](Task &task) {
+            if (rebuildCompare && !compareHashes->build(compareProvider.get(), task))
+                return;
+            if (rebuildCurrent && !currentHashes->build(provider, task))
+                return;
+
+            auto addDifference = [&result](u64 address, size_t size) {
+                result->differingBytes += size;
+
+                auto &differences = result->differences;
+                if (!differences.empty() && differences.back().address + differences.back().size == address)
+                    differences.back().size += size;
+                else if (differences.size() < MaxDifferences)
+                    differences.push_back({ address, size });
+                else
+                    result->truncated = true;
+            };
+
+            const u64 commonSize = std::min(currentHashes->getDataSize(), compareHashes->getDataSize());
+            const auto ranges = BlockHashMap::getDifferingRanges(*currentHashes, *compareHashes);
+
+            // Only the blocks whose hashes differ get compared byte by byte
+            constexpr static size_t ReadSize = 0x1'0000;
+            std::vector<u8> currentBuffer(ReadSize), compareBuffer(ReadSize);
+
+            for (size_t i = 0; i < ranges.size() && !task.isCancelled(); i++) {
+                const auto [start, end] = ranges[i];
+                task.setProgress(float(i) / ranges.size());
+
+                for (u64 address = start; address < std::min(end, commonSize); address += ReadSize) {
+                    const size_t size = std::min<u64>(ReadSize, std::min(end, commonSize) - address);
+                    provider->readAbsolute(address, currentBuffer.data(), size);
+                    compareProvider->readAbsolute(address, compareBuffer.data(), size);
+
+                    for (size_t offset = 0; offset < size; ) {
+                        auto mismatch = std::mismatch(currentBuffer.begin() + offset, currentBuffer.begin() + size, compareBuffer.begin() + offset);
+                        offset = mismatch.first - currentBuffer.begin();
+                        if (offset == size)
+                            break;
+
+                        size_t differenceEnd = offset;
+                        while (differenceEnd < size && currentBuffer[differenceEnd] != compareBuffer[differenceEnd])
+                            differenceEnd++;
+
+                        addDifference(address + offset, differenceEnd - offset);
+                        offset = differenceEnd;
+                    }
+                }
+
+                // Data past the end of the smaller file only exists on one side
+                if (end > commonSize)
+                    addDifference(std::max(start, commonSize), end - std::max(start, commonSize));
+            }
+        }, [this, result] {
+            this->m_currentHashesValid = true;
+            this->m_compareHashesValid = true;
+
+            this->m_differences = std::move(result->differences);
+            this->m_differingBytes = result->differingBytes;
+            this->m_differencesTruncated = result->truncated;
+        });
+    }
+
+    void ViewDiff::findMovedData() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isAvailable() || this->m_compareProvider == nullptr)
+            return;
+
+        if (this->m_movedDataTask != nullptr)
+            this->m_movedDataTask->cancel();
+
+        auto compareChunks = std::make_shared<std::shared_ptr<const std::vector<ContentChunker::Chunk>>>(this->m_compareChunks);
+        auto matches = std::make_shared<std::vector<ContentChunker::Match>>();
+
+        this->m_movedDataTask = TaskManager::submit("Finding moved data", provider, [provider, compareProvider = this->m_compareProvider, compareChunks, matches](Task &task) {
+            if (*compareChunks == nullptr) {
+                auto chunks = ContentChunker::split(compareProvider.get(), &task);
+                if (!chunks.has_value())
+                    return;
+
+                *compareChunks = std::make_shared<const std::vector<ContentChunker::Chunk>>(std::move(*chunks));
+            }
+
+            auto chunks = ContentChunker::split(provider, &task);
+            if (!chunks.has_value())
+                return;
+
+            *matches = ContentChunker::match(*chunks, **compareChunks);
+        }, [this, compareChunks, matches] {
+            this->m_compareChunks = *compareChunks;
+            this->m_movedRegions = std::move(*matches);
+            this->m_movedRegionsOutdated = false;
+            this->updateShownMovedRegions();
+        });
+    }
+
+    void ViewDiff::updateShownMovedRegions() {
+        this->m_shownMovedRegions.clear();
+
+        for (size_t i = 0; i < this->m_movedRegions.size(); i++) {
+            const auto &region = this->m_movedRegions[i];
+            if (!this->m_onlyShowShifted || region.address != region.matchAddress)
+                this->m_shownMovedRegions.push_back(i);
+        }
+    }
+
+    void ViewDiff::createPatch(const std::string &path) {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isAvailable() || this->m_compareProvider == nullptr)
+            return;
+
+        if (this->m_patchTask != nullptr)
+            this->m_patchTask->cancel();
+
+        auto snapshot = provider->createSnapshot();
+        auto succeeded = std::make_shared<bool>(false);
+
+        this->m_patchTask = TaskManager::submit("Creating patch", provider, [provider, snapshot, compareProvider = this->m_compareProvider, format = this->m_patchFormat, path, succeeded](Task &task) {
+            auto copies = findDeltaCopies(compareProvider.get(), provider, task);
+            if (!copies.has_value())
+                return;
+
+            auto patch = createDeltaPatch(format, compareProvider->createSnapshot(), snapshot, *copies, task);
+            if (!patch.has_value())
+                return;
+
+            // The copies were found in the live data, they only fit the snapshot if nothing changed in the meantime
+            if (provider->getDataGeneration(false) != snapshot.getDataGeneration() + snapshot.getPatchGeneration())
+                return;
+
+            FILE *file = fopen(path.c_str(), "wb");
+            if (file == nullptr)
+                return;
+
+            *succeeded = fwrite(patch->data(), 1, patch->size(), file) == patch->size();
+            fclose(file);
+        }, [succeeded] {
+            if (!*succeeded)
+                View::showErrorPopup("Failed to create patch!");
+        });
+    }
+
+    void ViewDiff::drawDifferences(prv::Provider *provider) {
+        if (this->isComparing()) {
+            ImGui::TextUnformatted("Comparing...");
+            ImGui::ProgressBar(this->m_diffTask->getProgress());
+        } else {
+            if (provider->getActualSize() != this->m_compareProvider->getActualSize())
+                ImGui::Text("Sizes differ: 0x%lX / 0x%lX bytes", u64(provider->getActualSize()), u64(this->m_compareProvider->getActualSize()));
+
+            if (this->m_differences.empty())
+                ImGui::TextUnformatted("Files are identical");
+            else
+                ImGui::Text("%zu differing regions, 0x%lX bytes%s", this->m_differences.size(), this->m_differingBytes, this->m_differencesTruncated ? " (only the first regions are listed)" : "");
+        }
+
+        if (ImGui::BeginTable("##diffTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Offset");
+            ImGui::TableSetupColumn("Size");
+            ImGui::TableSetupColumn("Current");
+            ImGui::TableSetupColumn("Compared");
+
+            ImGui::TableHeadersRow();
+
+            auto formatBytes = [](prv::Provider *provider, u64 address, size_t size) {
+                constexpr static size_t PreviewSize = 8;
+
+                if (address >= provider->getActualSize())
+                    return "-"s;
+
+                std::array<u8, PreviewSize> bytes = { 0 };
+                const size_t readSize = std::min<u64>({ PreviewSize, size, provider->getActualSize() - address });
+                provider->readAbsolute(address, bytes.data(), readSize);
+
+                std::string result;
+                for (size_t i = 0; i < readSize; i++)
+                    result += hex::format("%02X ", bytes[i]);
+                if (size > PreviewSize)
+                    result += "...";
+
+                return result;
+            };
+
+            ImGuiListClipper clipper;
+            clipper.Begin(this->m_differences.size());
+
+            while (clipper.Step()) {
+                for (u64 i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    const auto &difference = this->m_differences[i];
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    if (ImGui::Selectable(("##diffLine"s + std::to_string(i)).c_str(), false, ImGuiSelectableFlags_SpanAllColumns)) {
+                        if (difference.address < provider->getActualSize()) {
+                            Region selectRegion = { difference.address, std::min<u64>(difference.size, provider->getActualSize() - difference.address) };
+                            View::postEvent(Events::SelectionChangeRequest, selectRegion);
+                        }
+                    }
+                    ImGui::SameLine();
+                    ImGui::Text("0x%08lX", difference.address);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("0x%lX", u64(difference.size));
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(formatBytes(provider, difference.address, difference.size).c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(formatBytes(this->m_compareProvider.get(), difference.address, difference.size).c_str());
+                }
+            }
+            clipper.End();
+
+            ImGui::EndTable();
+        }
+    }
+
+    void ViewDiff::drawMovedData() {
+        const bool isSearching = this->m_movedDataTask != nullptr && !this->m_movedDataTask->isFinished();
+
+        if (isSearching) {
+            ImGui::TextUnformatted("Searching...");
+            ImGui::ProgressBar(this->m_movedDataTask->getProgress());
+        } else {
+            if (ImGui::Button("Find moved data"))
+                this->findMovedData();
+
+            ImGui::SameLine();
+            if (ImGui::Checkbox("Only show shifted data", &this->m_onlyShowShifted))
+                this->updateShownMovedRegions();
+
+            if (this->m_movedRegionsOutdated)
+                ImGui::TextUnformatted("Data changed since the last search");
+        }
+
+        ImGui::NewLine();
+        ImGui::TextWrapped("Data that exists in both files. It's found in whole chunks, so regions can be slightly smaller than the data that actually moved.");
+
+        if (ImGui::BeginTable("##movedDataTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Offset");
+            ImGui::TableSetupColumn("Compared Offset");
+            ImGui::TableSetupColumn("Size");
+            ImGui::TableSetupColumn("Shift");
+
+            ImGui::TableHeadersRow();
+
+            ImGuiListClipper clipper;
+            clipper.Begin(this->m_shownMovedRegions.size());
+
+            while (clipper.Step()) {
+                for (u64 i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    const auto &region = this->m_movedRegions[this->m_shownMovedRegions[i]];
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    if (ImGui::Selectable(("##movedLine"s + std::to_string(i)).c_str(), false, ImGuiSelectableFlags_SpanAllColumns)) {
+                        Region selectRegion = { region.address, region.size };
+                        View::postEvent(Events::SelectionChangeRequest, selectRegion);
+                    }
+                    ImGui::SameLine();
+                    ImGui::Text("0x%08lX", region.address);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("0x%08lX", region.matchAddress);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("0x%lX", u64(region.size));
+                    ImGui::TableNextColumn();
+                    if (region.matchAddress >= region.address)
+                        ImGui::Text("+0x%lX", region.matchAddress - region.address);
+                    else
+                        ImGui::Text("-0x%lX", region.address - region.matchAddress);
+                }
+            }
+            clipper.End();
+
+            ImGui::EndTable();
+        }
+    }
+
+    void ViewDiff::drawCreatePatch() {
+        constexpr static std::array FormatNames = { "BPS", "UPS", "VCDIFF" };
+
+        ImGui::TextWrapped("Creates a patch that turns the compared file into the current data. Unchanged and moved data is referenced instead of being stored in the patch.");
+        ImGui::NewLine();
+
+        if (this->m_patchTask != nullptr && !this->m_patchTask->isFinished()) {
+            ImGui::TextUnformatted("Creating patch...");
+            ImGui::ProgressBar(this->m_patchTask->getProgress());
+
+            if (ImGui::Button("Cancel"))
+                this->m_patchTask->cancel();
+        } else {
+            auto format = static_cast<int>(this->m_patchFormat);
+            if (ImGui::Combo("Format", &format, FormatNames.data(), FormatNames.size()))
+                this->m_patchFormat = static_cast<DeltaPatchFormat>(format);
+
+            if (ImGui::Button("Create patch"))
+                View::openFileBrowser("Diff: Save Patch", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [this](auto path) {
+                    this->createPatch(path);
+                });
+        }
+    }
+
+    void ViewDiff::drawContent() {
+        if (ImGui::Begin("Diff", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
+            auto provider = SharedData::currentProvider;
+
+            if (provider != nullptr && provider->isReadable()) {
+                if (ImGui::Button("Open file to compare"))
+                    View::openFileBrowser("Diff: Open File", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, "*.*", [this](auto path) {
+                        this->openCompareFile(path);
+                    });
+
+                if (this->m_compareProvider != nullptr) {
+                    ImGui::SameLine();
+                    if (ImGui::Button("Close"))
+                        this->closeCompareFile();
+                }
+
+                if (this->m_compareProvider != nullptr) {
+                    if (this->m_shouldCompare) {
+                        this->compare();
+                        this->m_shouldCompare = false;
+                    }
+
+                    ImGui::TextUnformatted(this->m_comparePath.c_str());
+                    ImGui::Separator();
+
+                    if (ImGui::BeginTabBar("##diffTabs")) {
+                        if (ImGui::BeginTabItem("Differences")) {
+                            this->drawDifferences(provider);
+                            ImGui::EndTabItem();
+                        }
+                        if (ImGui::BeginTabItem("Moved data")) {
+                            this->drawMovedData();
+                            ImGui::EndTabItem();
+                        }
+                        if (ImGui::BeginTabItem("Create patch")) {
+                            this->drawCreatePatch();
+                            ImGui::EndTabItem();
+                        }
+
+                        ImGui::EndTabBar();
+                    }
+                }
+            }
+        }
+        ImGui::End();
+    }
+
+    void ViewDiff::drawMenu() {
+
+    }
+
+}
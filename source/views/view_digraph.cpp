@@ -0,0 +1,265 @@
+#include "views/view_digraph.hpp"
+
+#include <hex/providers/provider.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace hex {
+
+    namespace {
+
+        constexpr u32 PlotSize = 512;
+        constexpr u32 TrigraphImageSize = 512;
+
+        // Counts span many orders of magnitude, a few pairs like 00 00 would outshine everything else on a linear scale
+        float getBrightness(u64 count, double maxLog) {
+            return maxLog > 0 ? float(std::log1p(double(count)) / maxLog) : 0.0F;
+        }
+
+        u32 getHeatColor(float brightness) {
+            return ImGui::ColorConvertFloat4ToU32(ImColor::HSV(0.66F * (1.0F - brightness), 1.0F, 1.0F).Value);
+        }
+
+        void uploadTexture(u32 &texture, u32 width, u32 height, const std::vector<u32> &pixels) {
+            // Textures are reused for every upload and go away together with the GL context
+            if (texture == 0)
+                glGenTextures(1, &texture);
+
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        }
+
+    }
+
+    ViewDigraph::ViewDigraph() : View("Digraph Plot") {
+        View::subscribeEvent(Events::RegionSelected, [this](auto userData) {
+            auto region = std::any_cast<const Region>(userData);
+
+            if (this->m_shouldMatchSelection && region.size > 2) {
+                // Selections are relative to the page shown in the hex editor
+                u64 pageOffset = prv::Provider::PageSize * SharedData::currentProvider->getCurrentPage();
+                this->m_region[0] = pageOffset + region.address;
+                this->m_region[1] = pageOffset + region.address + region.size - 1;
+            }
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto) {
+            if (this->m_analysisTask != nullptr)
+                this->m_analysisTask->cancel();
+
+            this->m_analysis = nullptr;
+            this->m_error.clear();
+        });
+    }
+
+    ViewDigraph::~ViewDigraph() {
+        if (this->m_analysisTask != nullptr)
+            this->m_analysisTask->cancel();
+
+        View::unsubscribeEvent(Events::RegionSelected);
+        View::unsubscribeEvent(Events::ProviderChanged);
+    }
+
+    bool ViewDigraph::isAnalyzing() const {
+        return this->m_analysisTask != nullptr && !this->m_analysisTask->isFinished();
+    }
+
+    void ViewDigraph::analyze() {
+        auto provider = SharedData::currentProvider;
+
+        const u64 address = this->m_region[0];
+        const u64 size = this->m_region[1] - this->m_region[0] + 1;
+
+        this->m_error.clear();
+
+        auto analysis = std::make_shared<DigraphAnalysis>();
+        auto succeeded = std::make_shared<bool>(false);
+
+        this->m_analysisTask = TaskManager::submit("Counting digraphs", [snapshot = provider->createSnapshot(), address, size, analysis, succeeded](Task &task) {
+            if (auto result = analyzeDigraphs(snapshot, address, size, task); result.has_value()) {
+                *analysis = std::move(*result);
+                *succeeded = true;
+            }
+        }, [this, analysis, succeeded] {
+            if (!*succeeded) {
+                this->m_error = "Failed to read the region";
+                return;
+            }
+
+            this->m_analysis = analysis;
+            this->renderDigraphs();
+            this->renderTrigraphs();
+        });
+    }
+
+    void ViewDigraph::renderDigraphs() {
+        const auto &digraphs = this->m_analysis->digraphs;
+        const double maxLog = std::log1p(double(*std::max_element(digraphs.begin(), digraphs.end())));
+
+        // The first byte of a pair goes along the horizontal axis, the second one along the vertical axis
+        std::vector<u32> pixels(256 * 256);
+        for (u32 first = 0; first < 256; first++) {
+            for (u32 second = 0; second < 256; second++) {
+                const u64 count = digraphs[first * 256 + second];
+                pixels[second * 256 + first] = count == 0 ? IM_COL32(0x00, 0x00, 0x00, 0xFF) : getHeatColor(getBrightness(count, maxLog));
+            }
+        }
+
+        uploadTexture(this->m_digraphTexture, 256, 256, pixels);
+    }
+
+    void ViewDigraph::renderTrigraphs() {
+        this->m_trigraphOutdated = false;
+
+        constexpr u32 Bins = DigraphAnalysis::TrigraphBins;
+        const auto &trigraphs = this->m_analysis->trigraphs;
+        const double maxLog = std::log1p(double(*std::max_element(trigraphs.begin(), trigraphs.end())));
+
+        const float sinYaw = std::sin(this->m_yaw), cosYaw = std::cos(this->m_yaw);
+        const float sinPitch = std::sin(this->m_pitch), cosPitch = std::cos(this->m_pitch);
+
+        // Every pixel shows the most common bin projected onto it, the rotated cube's corners always stay inside the image
+        std::vector<float> brightness(TrigraphImageSize * TrigraphImageSize, 0.0F);
+        std::vector<u32> pixels(TrigraphImageSize * TrigraphImageSize, IM_COL32(0x00, 0x00, 0x00, 0xFF));
+        const float projectionScale = TrigraphImageSize / 2 / std::sqrt(3.0F);
+
+        for (u32 bin = 0; bin < trigraphs.size(); bin++) {
+            if (trigraphs[bin] == 0)
+                continue;
+
+            const u32 first = bin / (Bins * Bins), second = (bin / Bins) % Bins, third = bin % Bins;
+
+            // Bytes of the triple along the x, y and z axis of a cube centered around the origin
+            const float x = float(first) / (Bins - 1) * 2 - 1, y = float(second) / (Bins - 1) * 2 - 1, z = float(third) / (Bins - 1) * 2 - 1;
+
+            const float rotatedX = x * cosYaw + z * sinYaw;
+            const float rotatedZ = z * cosYaw - x * sinYaw;
+            const float rotatedY = y * cosPitch - rotatedZ * sinPitch;
+
+            const u32 pixelX = std::clamp<s32>(TrigraphImageSize / 2 + rotatedX * projectionScale, 0, TrigraphImageSize - 1);
+            const u32 pixelY = std::clamp<s32>(TrigraphImageSize / 2 - rotatedY * projectionScale, 0, TrigraphImageSize - 1);
+            const u32 pixel = pixelY * TrigraphImageSize + pixelX;
+
+            const float value = getBrightness(trigraphs[bin], maxLog);
+            if (value <= brightness[pixel])
+                continue;
+
+            // Colored by position so the same bins keep their color while the cube rotates, dimmed by how rare the triple is. Nothing gets fully black
+            const float dim = 0.25F + 0.75F * value;
+            brightness[pixel] = value;
+            auto channel = [&](u32 value) { return u8(dim * (0x40 + 0xBF * value / (Bins - 1))); };
+            pixels[pixel] = IM_COL32(channel(first), channel(second), channel(third), 0xFF);
+        }
+
+        uploadTexture(this->m_trigraphTexture, TrigraphImageSize, TrigraphImageSize, pixels);
+    }
+
+    void ViewDigraph::drawDigraphPlot() {
+        const ImVec2 start = ImGui::GetCursorScreenPos();
+        ImGui::Image(reinterpret_cast<ImTextureID>(intptr_t(this->m_digraphTexture)), ImVec2(PlotSize, PlotSize));
+
+        if (ImGui::IsItemHovered()) {
+            const auto mousePos = ImGui::GetIO().MousePos;
+            const u32 first = std::clamp<s32>((mousePos.x - start.x) * 256 / PlotSize, 0, 0xFF);
+            const u32 second = std::clamp<s32>((mousePos.y - start.y) * 256 / PlotSize, 0, 0xFF);
+
+            ImGui::SetTooltip("%02X %02X: %llu", first, second, this->m_analysis->digraphs[first * 256 + second]);
+        }
+
+        ImGui::TextDisabled("First byte from left to right, second byte from top to bottom");
+    }
+
+    void ViewDigraph::drawTrigraphPlot() {
+        const ImVec2 start = ImGui::GetCursorScreenPos();
+        ImGui::InvisibleButton("##trigraphs", ImVec2(PlotSize, PlotSize));
+        ImGui::GetWindowDrawList()->AddImage(reinterpret_cast<ImTextureID>(intptr_t(this->m_trigraphTexture)), start, ImVec2(start.x + PlotSize, start.y + PlotSize));
+
+        if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+            const auto delta = ImGui::GetMouseDragDelta(ImGuiMouseButton_Left);
+            ImGui::ResetMouseDragDelta(ImGuiMouseButton_Left);
+
+            this->m_yaw += delta.x * 0.01F;
+            this->m_pitch = std::clamp(this->m_pitch + delta.y * 0.01F, -1.5F, 1.5F);
+            this->m_trigraphOutdated = true;
+        }
+
+        // Only projected again after the rotation changed, drawing it is a single textured quad
+        if (this->m_trigraphOutdated)
+            this->renderTrigraphs();
+
+        ImGui::TextDisabled("First, second and third byte as red, green and blue. Drag to rotate");
+    }
+
+    void ViewDigraph::drawContent() {
+        if (ImGui::Begin("Digraph Plot", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
+            ImGui::BeginChild("##scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
+
+            auto provider = SharedData::currentProvider;
+            if (provider != nullptr && provider->isReadable()) {
+                ImGui::TextUnformatted("Region");
+                ImGui::Separator();
+
+                ImGui::InputScalarN("##nolabel", ImGuiDataType_U64, this->m_region, 2, nullptr, nullptr, "%08llX", ImGuiInputTextFlags_CharsHexadecimal);
+                ImGui::Checkbox("Match selection", &this->m_shouldMatchSelection);
+                ImGui::SameLine();
+                if (ImGui::Button("Whole file") && provider->getActualSize() > 0) {
+                    this->m_region[0] = 0;
+                    this->m_region[1] = provider->getActualSize() - 1;
+                }
+
+                const u64 dataSize = provider->getActualSize();
+                if (dataSize > 0 && this->m_region[1] >= dataSize)
+                    this->m_region[1] = dataSize - 1;
+
+                const bool validRegion = this->m_region[1] > this->m_region[0];
+
+                if (this->isAnalyzing()) {
+                    ImGui::ProgressBar(this->m_analysisTask->getProgress(), ImVec2(300, 0));
+                    ImGui::SameLine();
+                    if (ImGui::Button("Cancel"))
+                        this->m_analysisTask->cancel();
+                } else if (ImGui::Button("Analyze") && validRegion) {
+                    this->analyze();
+                }
+
+                if (!this->m_error.empty())
+                    ImGui::TextUnformatted(this->m_error.c_str());
+
+                if (this->m_analysis != nullptr) {
+                    ImGui::NewLine();
+
+                    if (ImGui::BeginTabBar("##plots")) {
+                        if (ImGui::BeginTabItem("Digraphs")) {
+                            this->drawDigraphPlot();
+                            ImGui::EndTabItem();
+                        }
+
+                        if (ImGui::BeginTabItem("Trigraphs")) {
+                            this->drawTrigraphPlot();
+                            ImGui::EndTabItem();
+                        }
+
+                        ImGui::EndTabBar();
+                    }
+                }
+            }
+
+            ImGui::EndChild();
+        }
+        ImGui::End();
+    }
+
+    void ViewDigraph::drawMenu() {
+
+    }
+
+}
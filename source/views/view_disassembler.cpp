@@ -1,16 +1,53 @@
 #include "views/view_disassembler.hpp"
 
+#include <hex/api/task.hpp>
 #include <hex/providers/provider.hpp>
 #include <hex/helpers/utils.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <unordered_set>
 
 using namespace std::literals::string_literals;
 
 namespace hex {
 
     ViewDisassembler::ViewDisassembler() : View("Disassembler") {
-        View::subscribeEvent(Events::DataChanged, [this](auto){
+        this->m_disassemblyMemory = MemoryBudget::Registration("Disassembly", [this] {
+            return this->m_disassembly.capacity() * sizeof(Disassembly) + (this->m_references != nullptr ? this->m_references->getMemoryUsage() : 0);
+        });
+
+        this->m_disassemblyCacheMemory = MemoryBudget::Registration("Disassembly", [this] {
+            size_t size = 0;
+            for (const auto &cached : this->m_disassemblyCache)
+                size += this->getMemoryUsage(cached);
+
+            return size;
+        }, [this](size_t size) {
+            size_t freed = 0;
+            while (freed < size && !this->m_disassemblyCache.empty()) {
+                freed += this->getMemoryUsage(this->m_disassemblyCache.back());
+                this->m_disassemblyCache.pop_back();
+            }
+
+            return freed;
+        });
+
+        View::subscribeEvent(Events::DataChanged, [this](auto userData) {
+            if (auto region = std::any_cast<Region>(&userData); region != nullptr && this->m_disassemblyTask != nullptr && this->m_disassemblyTask->isFinished())
+                this->updateDisassembly(*region);
+            else
+                this->m_shouldInvalidate = true;
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto) {
+            this->m_disassemblyCache.clear();
             this->m_shouldInvalidate = true;
         });
 
@@ -25,71 +62,875 @@ namespace hex {
     }
 
     ViewDisassembler::~ViewDisassembler() {
+        if (this->m_disassemblyTask != nullptr)
+            this->m_disassemblyTask->cancel();
+        if (this->m_referenceTask != nullptr)
+            this->m_referenceTask->cancel();
+
+        if (this->m_capstoneHandleOpen)
+            cs_close(&this->m_capstoneHandle);
+
         View::unsubscribeEvent(Events::DataChanged);
+        View::unsubscribeEvent(Events::ProviderChanged);
         View::unsubscribeEvent(Events::RegionSelected);
     }
 
-    void ViewDisassembler::drawContent() {
-        if (this->m_shouldInvalidate) {
-            this->m_disassembly.clear();
+    constexpr static size_t MaxInstructionSize = 16;
+
+    // Instruction sets whose instructions all have the same size can be split on that size without ever losing synchronization,
+    // undecodable bytes get skipped in steps of it as well
+    static u32 getInstructionAlignment(const DisassemblySettings &settings) {
+        switch (settings.architecture) {
+            case Architecture::ARM:
+                return (settings.mode & CS_MODE_THUMB) ? 2 : 4;
+            case Architecture::MIPS:
+                return (settings.mode & CS_MODE_MICRO) ? 2 : 4;
+            case Architecture::ARM64:
+            case Architecture::PPC:
+            case Architecture::SPARC:
+                return 4;
+            default:
+                return 1;
+        }
+    }
+
+    // Disassembles the code region from offset on until the end of it or until the callback returns false. Bytes that don't decode
+    // to a valid instruction are passed on as data entries and disassembly continues right after them
+    // Returns false if disassembly couldn't be started or the task got cancelled
+    // Offsets passed to the read function are relative to the page the code region is on
+    using ReadFunction = std::function<void(u64 offset, void *buffer, size_t size)>;
+
+    static bool disassembleCode(const ReadFunction &read, const DisassemblySettings &settings, u64 offset, Task *task, const std::function<bool(const Disassembly &)> &callback) {
+        constexpr static size_t ChunkSize = 0x10000;
+
+        csh capstoneHandle;
+        if (cs_open(Disassembler::toCapstoneArchictecture(settings.architecture), settings.mode, &capstoneHandle) != CS_ERR_OK)
+            return false;
+
+        // A single instruction gets reused for the whole region instead of allocating a new array for every chunk
+        cs_insn *instruction = cs_malloc(capstoneHandle);
+
+        const u64 codeSize = settings.codeEnd - settings.codeStart + 1;
+        const u32 skipSize = getInstructionAlignment(settings);
+
+        std::vector<u8> buffer(ChunkSize, 0x00);
+        bool stop = false;
+        u64 address = offset - settings.codeStart;
+        for (; address < codeSize && !stop;) {
+            if (task != nullptr) {
+                if (task->isCancelled())
+                    break;
+
+                task->setProgress(float(address) / codeSize);
+            }
+
+            const size_t bufferSize = std::min<u64>(ChunkSize, codeSize - address);
+            read(settings.codeStart + address, buffer.data(), bufferSize);
+
+            const bool lastChunk = address + bufferSize >= codeSize;
+            const u8 *code = buffer.data();
+            size_t remaining = bufferSize;
+            u64 instructionAddress = settings.baseAddress + address;
+
+            // Instructions cut off at the end of the chunk get decoded again at the start of the next one
+            while (!stop && remaining > 0 && (lastChunk || remaining >= MaxInstructionSize)) {
+                const u64 instructionOffset = settings.codeStart + address + (code - buffer.data());
+
+                size_t size;
+                if (cs_disasm_iter(capstoneHandle, &code, &remaining, &instructionAddress, instruction))
+                    size = instruction->size;
+                else {
+                    size = std::min<size_t>(skipSize, remaining);
+                    code += size;
+                    remaining -= size;
+                    instructionAddress += size;
+                }
+
+                stop = !callback(Disassembly { instructionOffset, u32(size) });
+            }
+
+            const size_t usedBytes = bufferSize - remaining;
+            if (usedBytes == 0)
+                break;
+
+            address += usedBytes;
+        }
+
+        cs_free(instruction, 1);
+        cs_close(&capstoneHandle);
+
+        return stop || address >= codeSize;
+    }
+
+    // Runs the function for every index on the workers of the task's priority, updating the task's progress on the way
+    static void processParallel(size_t count, Task &task, const std::function<void(size_t index)> &process) {
+        std::atomic<size_t> finishedCount = 0;
+
+        TaskManager::parallelFor(task, count, [&](size_t index) {
+            process(index);
+            task.setProgress(float(++finishedCount) / count);
+        });
+    }
+
+    /*
+     * Splits the code region into partitions that get disassembled on all workers at once, each with its own capstone handle.
+     * Partitions of variable width instruction sets may start in the middle of an instruction. That gets fixed while joining them,
+     * the instructions following the previous partition get decoded again until they start at an offset the speculative pass found too.
+     * From there on both decode the exact same bytes, so the rest of the partition can be taken as is.
+     */
+    static std::vector<Disassembly> disassembleParallel(const ReadFunction &read, const DisassemblySettings &settings, Task &task) {
+        constexpr static u64 MinPartitionSize = 0x40000;
+
+        struct Partition {
+            u64 start, end;
+            std::vector<Disassembly> instructions;
+            bool complete = false;
+        };
+
+        const u64 codeSize = settings.codeEnd - settings.codeStart + 1;
+        const u32 alignment = getInstructionAlignment(settings);
+
+        std::vector<Partition> partitions(std::clamp<u64>(codeSize / MinPartitionSize, 1, TaskManager::getParallelism(task, codeSize / MinPartitionSize) * 4));
+
+        const u64 partitionCount = partitions.size();
+        for (u64 i = 0; i < partitionCount; i++) {
+            partitions[i].start = settings.codeStart + (codeSize / partitionCount * i) / alignment * alignment;
+            if (i > 0)
+                partitions[i - 1].end = partitions[i].start;
+        }
+        partitions.back().end = settings.codeEnd + 1;
+
+        processParallel(partitionCount, task, [&](size_t index) {
+            auto &partition = partitions[index];
+
+            partition.complete = disassembleCode(read, settings, partition.start, nullptr, [&partition, &task](const Disassembly &instruction) {
+                if (instruction.offset >= partition.end || task.isCancelled())
+                    return false;
+
+                partition.instructions.push_back(instruction);
+                return true;
+            });
+        });
+
+        std::vector<Disassembly> disassembly;
+        u64 nextOffset = settings.codeStart;
+
+        for (auto &partition : partitions) {
+            if (task.isCancelled())
+                break;
+
+            const auto &instructions = partition.instructions;
+            auto findInstruction = [&instructions](u64 offset) {
+                auto it = std::lower_bound(instructions.begin(), instructions.end(), offset, [](const Disassembly &instruction, u64 offset) { return instruction.offset < offset; });
+
+                return it != instructions.end() && it->offset == offset ? it : instructions.end();
+            };
+
+            auto synchronized = findInstruction(nextOffset);
+
+            if (synchronized == instructions.end()) {
+                const bool valid = disassembleCode(read, settings, nextOffset, nullptr, [&](const Disassembly &instruction) {
+                    if (instruction.offset >= partition.end)
+                        return false;
+
+                    synchronized = findInstruction(instruction.offset);
+                    if (synchronized != instructions.end())
+                        return false;
+
+                    disassembly.push_back(instruction);
+                    return true;
+                });
 
-            csh capstoneHandle;
-            cs_insn *instructions = nullptr;
+                if (!valid)
+                    break;
 
-            cs_mode mode = cs_mode(this->m_modeBasicARM | this->m_modeExtraARM | this->m_modeBasicMIPS | this->m_modeBasicX86 | this->m_modeBasicPPC);
+                if (!disassembly.empty())
+                    nextOffset = disassembly.back().offset + disassembly.back().size;
+
+                // Decoding reached the end of the partition without ever meeting the speculative pass
+                if (synchronized == instructions.end())
+                    continue;
+            }
+
+            disassembly.insert(disassembly.end(), synchronized, instructions.end());
+
+            if (!disassembly.empty())
+                nextOffset = disassembly.back().offset + disassembly.back().size;
+
+            // The speculative pass got cancelled or couldn't be started
+            if (!partition.complete)
+                break;
+        }
+
+        return disassembly;
+    }
 
-            if (this->m_littleEndianMode)
-                mode = cs_mode(mode | CS_MODE_LITTLE_ENDIAN);
+    // Control flow an instruction may cause. Targets are offsets in the code region, branches out of it or through registers have none
+    struct Branch {
+        enum class Type : u8 {
+            None,
+            Call,
+            Jump,
+            ConditionalJump,
+            Return
+        };
+
+        Type type = Type::None;
+        std::optional<u64> target;
+    };
+
+    /*
+     * Decodes single instructions anywhere in the code region with capstone's detail mode enabled, which is what tells where branches go.
+     * A window of the region around the last instruction is kept, following the control flow rarely needs to read anything else.
+     */
+    class BranchDecoder {
+    public:
+        BranchDecoder(const ReadFunction &read, const DisassemblySettings &settings) : m_read(read), m_settings(settings) {
+            if (cs_open(Disassembler::toCapstoneArchictecture(settings.architecture), settings.mode, &this->m_handle) != CS_ERR_OK)
+                return;
+
+            cs_option(this->m_handle, CS_OPT_DETAIL, CS_OPT_ON);
+            this->m_instruction = cs_malloc(this->m_handle);
+            this->m_valid = true;
+        }
+
+        ~BranchDecoder() {
+            if (!this->m_valid)
+                return;
+
+            cs_free(this->m_instruction, 1);
+            cs_close(&this->m_handle);
+        }
+
+        BranchDecoder(const BranchDecoder&) = delete;
+        BranchDecoder& operator=(const BranchDecoder&) = delete;
+
+        [[nodiscard]] bool isValid() const { return this->m_valid; }
+
+        // Size of the instruction at the offset, zero if there's no valid one
+        u32 decode(u64 offset, Branch &branch) {
+            constexpr static size_t WindowSize = 0x10000;
+
+            const u64 codeEnd = this->m_settings.codeEnd + 1;
+            if (!this->m_valid || offset < this->m_settings.codeStart || offset >= codeEnd)
+                return 0;
+
+            const u64 windowEnd = this->m_windowStart + this->m_window.size();
+            if (offset < this->m_windowStart || offset >= windowEnd || (windowEnd - offset < MaxInstructionSize && windowEnd < codeEnd)) {
+                this->m_windowStart = offset;
+                this->m_window.resize(std::min<u64>(WindowSize, codeEnd - offset));
+                this->m_read(offset, this->m_window.data(), this->m_window.size());
+            }
+
+            const u8 *code = this->m_window.data() + (offset - this->m_windowStart);
+            size_t size = this->m_window.size() - (offset - this->m_windowStart);
+            u64 address = this->m_settings.baseAddress + (offset - this->m_settings.codeStart);
+
+            if (!cs_disasm_iter(this->m_handle, &code, &size, &address, this->m_instruction))
+                return 0;
+
+            branch = this->getBranch();
+            return this->m_instruction->size;
+        }
+
+    private:
+        [[nodiscard]] Branch getBranch() const {
+            Branch branch;
+
+            if (cs_insn_group(this->m_handle, this->m_instruction, CS_GRP_RET) || cs_insn_group(this->m_handle, this->m_instruction, CS_GRP_IRET))
+                branch.type = Branch::Type::Return;
+            else if (cs_insn_group(this->m_handle, this->m_instruction, CS_GRP_CALL))
+                branch.type = Branch::Type::Call;
+            else if (cs_insn_group(this->m_handle, this->m_instruction, CS_GRP_JUMP))
+                branch.type = this->isConditional() ? Branch::Type::ConditionalJump : Branch::Type::Jump;
             else
-                mode = cs_mode(mode | CS_MODE_BIG_ENDIAN);
+                return branch;
 
-            if (this->m_micoMode)
-                mode = cs_mode(mode | CS_MODE_MICRO);
+            const auto &settings = this->m_settings;
+            if (auto target = this->getImmediateTarget(); target.has_value() && *target >= settings.baseAddress && *target - settings.baseAddress <= settings.codeEnd - settings.codeStart)
+                branch.target = settings.codeStart + (*target - settings.baseAddress);
 
-            if (this->m_sparcV9Mode)
-                mode = cs_mode(mode | CS_MODE_V9);
+            return branch;
+        }
 
-            if (cs_open(Disassembler::toCapstoneArchictecture(this->m_architecture), mode, &capstoneHandle) == CS_ERR_OK) {
+        // Capstone turns relative branch targets into absolute addresses, the last immediate operand is where the branch goes
+        [[nodiscard]] std::optional<u64> getImmediateTarget() const {
+            const auto &detail = *this->m_instruction->detail;
+            std::optional<u64> target;
+
+            switch (this->m_settings.architecture) {
+                case Architecture::X86:
+                    for (u8 i = 0; i < detail.x86.op_count; i++) {
+                        if (detail.x86.operands[i].type == X86_OP_IMM)
+                            target = detail.x86.operands[i].imm;
+                    }
+                    break;
+                case Architecture::ARM:
+                    for (u8 i = 0; i < detail.arm.op_count; i++) {
+                        if (detail.arm.operands[i].type == ARM_OP_IMM)
+                            target = u32(detail.arm.operands[i].imm);
+                    }
+                    break;
+                case Architecture::ARM64:
+                    for (u8 i = 0; i < detail.arm64.op_count; i++) {
+                        if (detail.arm64.operands[i].type == ARM64_OP_IMM)
+                            target = detail.arm64.operands[i].imm;
+                    }
+                    break;
+                case Architecture::MIPS:
+                    for (u8 i = 0; i < detail.mips.op_count; i++) {
+                        if (detail.mips.operands[i].type == MIPS_OP_IMM)
+                            target = detail.mips.operands[i].imm;
+                    }
+                    break;
+                case Architecture::PPC:
+                    for (u8 i = 0; i < detail.ppc.op_count; i++) {
+                        if (detail.ppc.operands[i].type == PPC_OP_IMM)
+                            target = detail.ppc.operands[i].imm;
+                    }
+                    break;
+                case Architecture::SPARC:
+                    for (u8 i = 0; i < detail.sparc.op_count; i++) {
+                        if (detail.sparc.operands[i].type == SPARC_OP_IMM)
+                            target = detail.sparc.operands[i].imm;
+                    }
+                    break;
+                default:
+                    break;
+            }
+
+            return target;
+        }
+
+        // Jumps of instruction sets without a way to tell count as conditional, which at worst follows them into data that doesn't decode
+        [[nodiscard]] bool isConditional() const {
+            const auto &detail = *this->m_instruction->detail;
+            const auto id = this->m_instruction->id;
+
+            switch (this->m_settings.architecture) {
+                case Architecture::X86:
+                    return id != X86_INS_JMP && id != X86_INS_LJMP;
+                case Architecture::ARM:
+                    return (detail.arm.cc != ARM_CC_AL && detail.arm.cc != ARM_CC_INVALID) || id == ARM_INS_CBZ || id == ARM_INS_CBNZ;
+                case Architecture::ARM64:
+                    return (detail.arm64.cc != ARM64_CC_AL && detail.arm64.cc != ARM64_CC_NV && detail.arm64.cc != ARM64_CC_INVALID) ||
+                           id == ARM64_INS_CBZ || id == ARM64_INS_CBNZ || id == ARM64_INS_TBZ || id == ARM64_INS_TBNZ;
+                case Architecture::MIPS:
+                    return id != MIPS_INS_J && id != MIPS_INS_JR && id != MIPS_INS_B;
+                case Architecture::PPC:
+                    return detail.ppc.bc != PPC_BC_INVALID;
+                default:
+                    return true;
+            }
+        }
 
-                auto provider = SharedData::currentProvider;
-                std::vector<u8> buffer(2048, 0x00);
-                for (u64 address = 0; address < (this->m_codeRegion[1] - this->m_codeRegion[0] + 1); address += 2048) {
-                    size_t bufferSize = std::min(u64(2048), (this->m_codeRegion[1] - this->m_codeRegion[0] + 1) - address);
-                    provider->read(this->m_codeRegion[0] + address, buffer.data(), bufferSize);
+        ReadFunction m_read;
+        DisassemblySettings m_settings;
 
-                    size_t instructionCount = cs_disasm(capstoneHandle, buffer.data(), bufferSize, this->m_baseAddress + address, 0, &instructions);
+        csh m_handle = 0;
+        cs_insn *m_instruction = nullptr;
+        bool m_valid = false;
 
-                    if (instructionCount == 0)
+        std::vector<u8> m_window;
+        u64 m_windowStart = 0;
+    };
+
+    // Branches of every instruction of the disassembly, decoded on all workers at once. Sorted by where they come from
+    static std::vector<CodeReference> findReferences(const ReadFunction &read, const DisassemblySettings &settings, const std::vector<Disassembly> &disassembly, Task &task) {
+        constexpr static size_t InstructionsPerPartition = 0x4000;
+
+        std::vector<std::vector<CodeReference>> partitions((disassembly.size() + InstructionsPerPartition - 1) / InstructionsPerPartition);
+
+        processParallel(partitions.size(), task, [&](size_t index) {
+            BranchDecoder decoder(read, settings);
+
+            const size_t last = std::min(disassembly.size(), (index + 1) * InstructionsPerPartition);
+            for (size_t i = index * InstructionsPerPartition; i < last && !task.isCancelled(); i++) {
+                Branch branch;
+                if (decoder.decode(disassembly[i].offset, branch) == 0 || !branch.target.has_value())
+                    continue;
+
+                partitions[index].push_back({ disassembly[i].offset, *branch.target, branch.type == Branch::Type::Call ? ReferenceType::Call : ReferenceType::Jump });
+            }
+        });
+
+        std::vector<CodeReference> references;
+        for (const auto &partition : partitions)
+            references.insert(references.end(), partition.begin(), partition.end());
+
+        return references;
+    }
+
+    /*
+     * Finds function starts by following the control flow from the entry points on, on all workers at once. Every worker takes a function from
+     * the shared queue and walks all of its blocks. Calls it finds queue the functions they go to unless they're already known, so functions reached
+     * from code the linear disassembly got out of sync with are found too. Done once the queue is empty and no worker is walking a function anymore.
+     */
+    static std::vector<u64> discoverFunctions(const ReadFunction &read, const DisassemblySettings &settings, const std::vector<u64> &entryPoints, Task &task) {
+        // Walks that got into data that happens to decode stop eventually, but shouldn't take forever to do so
+        constexpr static size_t MaxFunctionInstructions = 0x10000;
+
+        struct Discovery {
+            std::mutex mutex;
+            std::condition_variable changed;
+
+            std::vector<u64> queue;
+            std::set<u64> functions;
+            size_t walkingWorkers = 0;
+            size_t walkedFunctions = 0;
+
+            // Set once everything was found, threads getting to their index after that return right away
+            bool done = false;
+        };
+
+        if (!BranchDecoder(read, settings).isValid())
+            return { };
+
+        auto discovery = std::make_shared<Discovery>();
+        for (u64 entryPoint : entryPoints) {
+            if (discovery->functions.insert(entryPoint).second)
+                discovery->queue.push_back(entryPoint);
+        }
+
+        auto walkFunction = [](BranchDecoder &decoder, u64 start, std::vector<u64> &calls) {
+            std::vector<u64> blocks = { start };
+            std::unordered_set<u64> visited;
+
+            while (!blocks.empty() && visited.size() < MaxFunctionInstructions) {
+                u64 offset = blocks.back();
+                blocks.pop_back();
+
+                while (visited.size() < MaxFunctionInstructions && visited.insert(offset).second) {
+                    Branch branch;
+                    const u32 size = decoder.decode(offset, branch);
+                    if (size == 0)
                         break;
 
-                    u64 usedBytes = 0;
-                    for (u32 instr = 0; instr < instructionCount; instr++) {
-                        Disassembly disassembly = { 0 };
-                        disassembly.address = instructions[instr].address;
-                        disassembly.offset = this->m_codeRegion[0] + address + usedBytes;
-                        disassembly.size = instructions[instr].size;
-                        disassembly.mnemonic = instructions[instr].mnemonic;
-                        disassembly.operators = instructions[instr].op_str;
+                    if (branch.type == Branch::Type::Call && branch.target.has_value())
+                        calls.push_back(*branch.target);
+                    else if ((branch.type == Branch::Type::Jump || branch.type == Branch::Type::ConditionalJump) && branch.target.has_value())
+                        blocks.push_back(*branch.target);
+
+                    if (branch.type == Branch::Type::Jump || branch.type == Branch::Type::Return)
+                        break;
 
-                        for (u8 i = 0; i < instructions[instr].size; i++)
-                            disassembly.bytes += hex::format("%02X ", instructions[instr].bytes[i]);
-                        disassembly.bytes.pop_back();
+                    offset += size;
+                }
+            }
+        };
 
-                        this->m_disassembly.push_back(disassembly);
+        auto work = [discovery, read, settings, walkFunction, taskPointer = &task] {
+            std::unique_lock lock(discovery->mutex);
+            if (discovery->done)
+                return;
 
-                        usedBytes += instructions[instr].size;
-                    }
+            BranchDecoder decoder(read, settings);
+            if (!decoder.isValid())
+                return;
+
+            while (true) {
+                discovery->changed.wait(lock, [&discovery] { return discovery->done || !discovery->queue.empty() || discovery->walkingWorkers == 0; });
+
+                if (discovery->done)
+                    return;
+
+                if (taskPointer->isCancelled())
+                    discovery->queue.clear();
+
+                if (discovery->queue.empty()) {
+                    discovery->done = true;
+                    discovery->changed.notify_all();
+                    return;
+                }
+
+                const u64 start = discovery->queue.back();
+                discovery->queue.pop_back();
+                discovery->walkingWorkers++;
+
+                lock.unlock();
+
+                std::vector<u64> calls;
+                walkFunction(decoder, start, calls);
 
-                    if (instructionCount < bufferSize)
-                        address -= (bufferSize - usedBytes);
+                lock.lock();
 
-                    cs_free(instructions, instructionCount);
+                for (u64 call : calls) {
+                    if (discovery->functions.insert(call).second)
+                        discovery->queue.push_back(call);
                 }
 
-                cs_close(&capstoneHandle);
+                discovery->walkingWorkers--;
+                discovery->walkedFunctions++;
+                taskPointer->setProgress(float(discovery->walkedFunctions) / discovery->functions.size());
+
+                discovery->changed.notify_all();
+            }
+        };
+
+        // Every index is one more thread walking functions, there's no telling how many of them there will be to walk
+        TaskManager::parallelFor(task, TaskManager::getParallelism(task, std::numeric_limits<size_t>::max()), [&work](size_t) { work(); });
+
+        if (task.isCancelled())
+            return { };
+
+        return { discovery->functions.begin(), discovery->functions.end() };
+    }
+
+    void ViewDisassembler::disassemble() {
+        if (this->m_disassemblyTask != nullptr)
+            this->m_disassemblyTask->cancel();
+
+        cs_mode mode = cs_mode(this->m_modeBasicARM | this->m_modeExtraARM | this->m_modeBasicMIPS | this->m_modeBasicX86 | this->m_modeBasicPPC);
+
+        if (this->m_littleEndianMode)
+            mode = cs_mode(mode | CS_MODE_LITTLE_ENDIAN);
+        else
+            mode = cs_mode(mode | CS_MODE_BIG_ENDIAN);
+
+        if (this->m_micoMode)
+            mode = cs_mode(mode | CS_MODE_MICRO);
+
+        if (this->m_sparcV9Mode)
+            mode = cs_mode(mode | CS_MODE_V9);
+
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr)
+            return;
+
+        auto disassemblies = std::make_shared<std::vector<Disassembly>>();
+        DisassemblySettings settings = { this->m_architecture, mode, this->m_baseAddress, this->m_codeRegion[0], this->m_codeRegion[1], prv::Provider::PageSize * provider->getCurrentPage() };
+
+        const u64 dataGeneration = provider->getDataGeneration();
+        auto cached = std::find_if(this->m_disassemblyCache.begin(), this->m_disassemblyCache.end(), [&](const CachedDisassembly &cached) {
+            return cached.settings == settings && cached.dataGeneration == dataGeneration;
+        });
+
+        if (cached != this->m_disassemblyCache.end()) {
+            this->setDisassembly(cached->disassembly, settings, cached->references);
+            this->m_disassemblyCache.splice(this->m_disassemblyCache.begin(), this->m_disassemblyCache, cached);
+            return;
+        }
+
+        if (this->loadDisassembly(provider, settings))
+            return;
+
+        // The job reads from a snapshot, so neither edits nor switching pages while it's running can mix up the data it sees
+        auto read = [snapshot = provider->createSnapshot(), pageAddress = settings.pageAddress](u64 offset, void *buffer, size_t size) {
+            if (!snapshot.read(pageAddress + offset, buffer, size))
+                std::memset(buffer, 0x00, size);
+        };
+
+        this->m_disassemblyTask = TaskManager::submit("Disassembling", provider, [read, disassemblies, settings](Task &task) {
+            *disassemblies = disassembleParallel(read, settings, task);
+        }, [this, provider, disassemblies, settings, dataGeneration] {
+            if (provider != SharedData::currentProvider)
+                return;
+
+            // Data modified while the task was running gets disassembled again through the DataChanged event
+            this->m_disassemblyCache.push_front({ settings, dataGeneration, *disassemblies, nullptr });
+            if (this->m_disassemblyCache.size() > MaxCachedDisassemblies)
+                this->m_disassemblyCache.pop_back();
+
+            this->setDisassembly(std::move(*disassemblies), settings);
+        });
+    }
+
+    void ViewDisassembler::setDisassembly(std::vector<Disassembly> disassembly, const DisassemblySettings &settings, std::shared_ptr<const CodeReferences> references) {
+        this->m_disassembly = std::move(disassembly);
+        this->m_disassemblySettings = settings;
+        this->m_textCache.clear();
+
+        if (this->m_capstoneHandleOpen)
+            cs_close(&this->m_capstoneHandle);
+        this->m_capstoneHandleOpen = cs_open(Disassembler::toCapstoneArchictecture(settings.architecture), settings.mode, &this->m_capstoneHandle) == CS_ERR_OK;
+
+        if (references == nullptr) {
+            this->analyzeReferences();
+            return;
+        }
+
+        if (this->m_referenceTask != nullptr)
+            this->m_referenceTask->cancel();
+
+        this->m_references = std::move(references);
+        this->m_referenceGeneration++;
+    }
+
+    size_t ViewDisassembler::getMemoryUsage(const CachedDisassembly &cached) const {
+        const bool ownReferences = cached.references != nullptr && cached.references != this->m_references;
+
+        return cached.disassembly.capacity() * sizeof(Disassembly) + (ownReferences ? cached.references->getMemoryUsage() : 0);
+    }
+
+    void ViewDisassembler::updateDisassembly(const Region &region) {
+        // Giving up on resynchronizing after this many instructions, the rest gets disassembled in the background instead
+        constexpr static size_t MaxUpdatedInstructions = 0x1000;
+
+        auto provider = SharedData::currentProvider;
+        const auto &settings = this->m_disassemblySettings;
+        if (provider == nullptr || region.size == 0)
+            return;
+
+        // The code region addresses the page it was disassembled on while the modified region is absolute
+        const u64 pageAddress = settings.pageAddress;
+        if (region.address + region.size <= pageAddress + settings.codeStart || region.address > pageAddress + settings.codeEnd)
+            return;
+
+        const u64 modifiedStart = std::max(region.address - std::min(region.address, pageAddress), settings.codeStart);
+        const u64 modifiedEnd   = region.address + region.size - pageAddress;
+
+        auto &disassembly = this->m_disassembly;
+
+        // Disassembly restarts at the instruction containing the first modified byte, or where it previously stopped
+        auto first = std::find_if(disassembly.begin(), disassembly.end(), [modifiedStart](const Disassembly &instruction) {
+            return instruction.offset + instruction.size > modifiedStart;
+        });
+
+        const u64 restartOffset = first != disassembly.end() ? first->offset : (disassembly.empty() ? settings.codeStart : disassembly.back().offset + disassembly.back().size);
+        if (first == disassembly.end() && modifiedStart >= restartOffset + MaxInstructionSize)
+            return;
+
+        // Once an instruction unaffected by the modification starts where an old one did, everything after it stays the same as well
+        std::vector<Disassembly> instructions;
+        auto synchronized = disassembly.end();
+        bool tooLong = false;
+
+        disassembleCode([provider, pageAddress](u64 offset, void *buffer, size_t size) { provider->readAbsolute(pageAddress + offset, buffer, size); }, settings, restartOffset, nullptr, [&](const Disassembly &instruction) {
+            if (instruction.offset >= modifiedEnd) {
+                auto it = std::lower_bound(first, disassembly.end(), instruction.offset, [](const Disassembly &old, u64 offset) { return old.offset < offset; });
+
+                if (it != disassembly.end() && it->offset == instruction.offset) {
+                    synchronized = it;
+                    return false;
+                }
+            }
+
+            if (instructions.size() >= MaxUpdatedInstructions) {
+                tooLong = true;
+                return false;
+            }
+
+            instructions.push_back(instruction);
+            return true;
+        });
+
+        if (tooLong) {
+            this->m_shouldInvalidate = true;
+            return;
+        }
+
+        auto insertPosition = disassembly.erase(first, synchronized);
+        disassembly.insert(insertPosition, instructions.begin(), instructions.end());
+
+        this->m_textCache.clear();
+
+        // Modified branches can go anywhere, so everything gets analyzed again
+        this->analyzeReferences();
+    }
+
+    void ViewDisassembler::analyzeReferences() {
+        if (this->m_referenceTask != nullptr)
+            this->m_referenceTask->cancel();
+
+        this->m_references = nullptr;
+        this->m_referenceGeneration++;
+
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || this->m_disassembly.empty())
+            return;
+
+        const auto settings = this->m_disassemblySettings;
+        const u64 dataGeneration = provider->getDataGeneration();
+        auto read = [snapshot = provider->createSnapshot(), pageAddress = settings.pageAddress](u64 offset, void *buffer, size_t size) {
+            if (!snapshot.read(pageAddress + offset, buffer, size))
+                std::memset(buffer, 0x00, size);
+        };
+
+        // The job works on a copy, edits keep updating the disassembly while it's running
+        auto disassembly = std::make_shared<const std::vector<Disassembly>>(this->m_disassembly);
+        auto references = std::make_shared<std::shared_ptr<const CodeReferences>>();
+
+        this->m_referenceTask = TaskManager::submit("Finding references", TaskPriority::Background, provider, [read, settings, disassembly, references](Task &task) {
+            auto found = findReferences(read, settings, *disassembly, task);
+            if (task.isCancelled())
+                return;
+
+            // Everything that gets called starts a function, and so does the start of the code region
+            std::vector<u64> entryPoints = { settings.codeStart };
+            for (const auto &reference : found) {
+                if (reference.type == ReferenceType::Call)
+                    entryPoints.push_back(reference.to);
             }
 
+            auto functions = discoverFunctions(read, settings, entryPoints, task);
+
+            *references = std::make_shared<const CodeReferences>(std::move(found), std::move(functions));
+        }, [this, provider, settings, dataGeneration, references, generation = this->m_referenceGeneration] {
+            if (provider != SharedData::currentProvider || generation != this->m_referenceGeneration || settings != this->m_disassemblySettings)
+                return;
+
+            this->m_references = std::move(*references);
+
+            // Switching back to this disassembly later restores them together with it
+            auto cached = std::find_if(this->m_disassemblyCache.begin(), this->m_disassemblyCache.end(), [&](const CachedDisassembly &cached) {
+                return cached.settings == settings && cached.dataGeneration == dataGeneration;
+            });
+
+            if (cached != this->m_disassemblyCache.end())
+                cached->references = this->m_references;
+
+            if (auto fingerprint = PersistentAnalysisCache::getFingerprint(provider); fingerprint.has_value() && provider->getDataGeneration() == dataGeneration)
+                this->storeDisassembly(*fingerprint);
+        });
+    }
+
+    static std::string getDisassemblyCacheKey(const DisassemblySettings &settings) {
+        return hex::format("Disassembly-%d-%X-%llX-%llX-%llX-%llX", int(settings.architecture), u32(settings.mode), settings.baseAddress, settings.codeStart, settings.codeEnd, settings.pageAddress);
+    }
+
+    bool ViewDisassembler::loadDisassembly(prv::Provider *provider, const DisassemblySettings &settings) {
+        auto fingerprint = PersistentAnalysisCache::getFingerprint(provider);
+        if (!fingerprint.has_value())
+            return false;
+
+        // Stored as the instructions, their references and the function starts
+        auto entry = PersistentAnalysisCache::load(*fingerprint, getDisassemblyCacheKey(settings));
+        if (entry == nullptr || entry->getArrayCount() != 3)
+            return false;
+
+        auto instructions = entry->get<Disassembly>(0);
+        auto references = entry->get<CodeReference>(1);
+        auto functions = entry->get<u64>(2);
+
+        std::vector<Disassembly> disassembly(instructions.begin(), instructions.end());
+        auto codeReferences = std::make_shared<const CodeReferences>(std::vector<CodeReference>(references.begin(), references.end()), std::vector<u64>(functions.begin(), functions.end()));
+
+        this->m_disassemblyCache.push_front({ settings, provider->getDataGeneration(), disassembly, codeReferences });
+        if (this->m_disassemblyCache.size() > MaxCachedDisassemblies)
+            this->m_disassemblyCache.pop_back();
+
+        this->setDisassembly(std::move(disassembly), settings, std::move(codeReferences));
+
+        return true;
+    }
+
+    void ViewDisassembler::storeDisassembly(const PersistentAnalysisCache::Fingerprint &fingerprint) const {
+        PersistentAnalysisCache::Writer writer;
+        writer.add(this->m_disassembly);
+        writer.add(this->m_references->getReferences());
+        writer.add(this->m_references->getFunctions());
+
+        PersistentAnalysisCache::store(fingerprint, getDisassemblyCacheKey(this->m_disassemblySettings), std::move(writer));
+    }
+
+    void ViewDisassembler::jumpTo(u64 offset) {
+        auto it = std::lower_bound(this->m_disassembly.begin(), this->m_disassembly.end(), offset, [](const Disassembly &instruction, u64 offset) { return instruction.offset < offset; });
+        if (it == this->m_disassembly.end() || it->offset != offset)
+            return;
+
+        this->m_scrollToRow = it - this->m_disassembly.begin();
+
+        Region selectRegion = { this->m_disassemblySettings.pageAddress + it->offset, it->size };
+        View::postEvent(Events::SelectionChangeRequest, selectRegion);
+    }
+
+    void ViewDisassembler::drawReferencesPopup(const Disassembly &instruction) {
+        const auto &settings = this->m_disassemblySettings;
+        auto toAddress = [&settings](u64 offset) { return settings.baseAddress + (offset - settings.codeStart); };
+
+        if (this->m_references == nullptr) {
+            ImGui::TextUnformatted("Still looking for references...");
+            return;
+        }
+
+        auto from = this->m_references->getReferencesFrom(instruction.offset);
+        for (const auto &reference : from) {
+            if (ImGui::MenuItem(hex::format("Go to 0x%llx", toAddress(reference.to)).c_str()))
+                this->jumpTo(reference.to);
+        }
+
+        auto to = this->m_references->getReferencesTo(instruction.offset);
+        if (!from.empty() && !to.empty())
+            ImGui::Separator();
+
+        if (to.empty() && from.empty())
+            ImGui::TextUnformatted("No references");
+
+        for (const auto &reference : to) {
+            const char *type = reference.type == ReferenceType::Call ? "Called" : "Jumped to";
+            if (ImGui::MenuItem(hex::format("%s from 0x%llx", type, toAddress(reference.from)).c_str()))
+                this->jumpTo(reference.from);
+        }
+    }
+
+    void ViewDisassembler::drawFunctions() {
+        if (this->m_references == nullptr) {
+            if (this->m_referenceTask != nullptr && !this->m_referenceTask->isFinished())
+                ImGui::ProgressBar(this->m_referenceTask->getProgress(), ImVec2(300, 0));
+            return;
+        }
+
+        const auto &settings = this->m_disassemblySettings;
+        const auto &functions = this->m_references->getFunctions();
+
+        ImGui::Text("%zu functions", functions.size());
+        if (ImGui::BeginChild("##functions", ImVec2(0, 150), true)) {
+            ImGuiListClipper clipper;
+            clipper.Begin(functions.size());
+
+            while (clipper.Step()) {
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    const u64 offset = functions[i];
+                    const auto label = hex::format("sub_%llx (%zu callers)##function%d", settings.baseAddress + (offset - settings.codeStart), this->m_references->getReferenceCountTo(offset), i);
+
+                    if (ImGui::Selectable(label.c_str()))
+                        this->jumpTo(offset);
+                }
+            }
+
+            clipper.End();
+        }
+        ImGui::EndChild();
+    }
+
+    const DisassemblyText& ViewDisassembler::getText(const Disassembly &instruction) {
+        // Scrolling through a long listing only ever needs a few screens worth of rows
+        constexpr static size_t MaxCachedRows = 0x400;
+
+        if (auto it = this->m_textCache.find(instruction.offset); it != this->m_textCache.end())
+            return it->second;
+
+        if (this->m_textCache.size() >= MaxCachedRows)
+            this->m_textCache.clear();
+
+        const auto &settings = this->m_disassemblySettings;
+
+        DisassemblyText text = { };
+        text.address = settings.baseAddress + (instruction.offset - settings.codeStart);
+
+        std::vector<u8> bytes(instruction.size, 0x00);
+        if (auto provider = SharedData::currentProvider; provider != nullptr)
+            provider->readAbsolute(settings.pageAddress + instruction.offset, bytes.data(), bytes.size());
+
+        hex::appendHexBytes(text.bytes, bytes, "", " ");
+
+        cs_insn *decoded = nullptr;
+        if (this->m_capstoneHandleOpen && cs_disasm(this->m_capstoneHandle, bytes.data(), bytes.size(), text.address, 1, &decoded) == 1) {
+            text.mnemonic = decoded->mnemonic;
+            text.operators = decoded->op_str;
+            cs_free(decoded, 1);
+        } else {
+            text.mnemonic = ".byte";
+            hex::appendHexBytes(text.operators, bytes, "0x", ", ");
+        }
+
+        return this->m_textCache.emplace(instruction.offset, std::move(text)).first->second;
+    }
+
+    void ViewDisassembler::drawContent() {
+        if (this->m_shouldInvalidate) {
             this->m_shouldInvalidate = false;
+            this->disassemble();
         }
 
 
@@ -238,17 +1079,27 @@ namespace hex {
                 ImGui::SetCursorPosX((ImGui::GetContentRegionAvail().x - 300) / 2);
                 if (ImGui::Button("Disassemble", ImVec2(300, 20)))
                     this->m_shouldInvalidate = true;
+
+                if (this->m_disassemblyTask != nullptr && !this->m_disassemblyTask->isFinished()) {
+                    ImGui::SetCursorPosX((ImGui::GetContentRegionAvail().x - 300) / 2);
+                    ImGui::ProgressBar(this->m_disassemblyTask->getProgress(), ImVec2(300, 0));
+                }
+
                 ImGui::NewLine();
 
+                if (ImGui::CollapsingHeader("Functions"))
+                    this->drawFunctions();
+
                 ImGui::TextUnformatted("Disassembly");
                 ImGui::Separator();
 
-                if (ImGui::BeginTable("##disassembly", 4, ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Reorderable)) {
+                if (ImGui::BeginTable("##disassembly", 5, ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Reorderable)) {
                     ImGui::TableSetupScrollFreeze(0, 1);
                     ImGui::TableSetupColumn("Address");
                     ImGui::TableSetupColumn("Offset");
                     ImGui::TableSetupColumn("Bytes");
                     ImGui::TableSetupColumn("Disassembly");
+                    ImGui::TableSetupColumn("References");
 
                     ImGuiListClipper clipper;
                     clipper.Begin(this->m_disassembly.size());
@@ -256,25 +1107,50 @@ namespace hex {
                     ImGui::TableHeadersRow();
                     while (clipper.Step()) {
                         for (u64 i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                            const auto &instruction = this->m_disassembly[i];
+                            const auto &text = this->getText(instruction);
+
                             ImGui::TableNextRow();
                             ImGui::TableNextColumn();
                             if (ImGui::Selectable(("##DisassemblyLine"s + std::to_string(i)).c_str(), false, ImGuiSelectableFlags_SpanAllColumns)) {
-                                Region selectRegion = { this->m_disassembly[i].offset, this->m_disassembly[i].size };
+                                Region selectRegion = { this->m_disassemblySettings.pageAddress + instruction.offset, instruction.size };
                                 View::postEvent(Events::SelectionChangeRequest, selectRegion);
                             }
+                            if (ImGui::BeginPopupContextItem(("##DisassemblyReferences"s + std::to_string(i)).c_str())) {
+                                this->drawReferencesPopup(instruction);
+                                ImGui::EndPopup();
+                            }
                             ImGui::SameLine();
-                            ImGui::Text("0x%llx", this->m_disassembly[i].address);
+                            ImGui::Text("0x%llx", text.address);
                             ImGui::TableNextColumn();
-                            ImGui::Text("0x%llx", this->m_disassembly[i].offset);
+                            ImGui::Text("0x%llx", this->m_disassemblySettings.pageAddress + instruction.offset);
                             ImGui::TableNextColumn();
-                            ImGui::TextUnformatted(this->m_disassembly[i].bytes.c_str());
+                            ImGui::TextUnformatted(text.bytes.c_str());
                             ImGui::TableNextColumn();
-                            ImGui::TextColored(ImColor(0xFFD69C56), "%s", this->m_disassembly[i].mnemonic.c_str());
+                            ImGui::TextColored(ImColor(0xFFD69C56), "%s", text.mnemonic.c_str());
                             ImGui::SameLine();
-                            ImGui::TextUnformatted(this->m_disassembly[i].operators.c_str());
+                            ImGui::TextUnformatted(text.operators.c_str());
+                            ImGui::TableNextColumn();
+                            if (this->m_references != nullptr) {
+                                const bool function = this->m_references->isFunction(instruction.offset);
+                                const size_t referenceCount = this->m_references->getReferenceCountTo(instruction.offset);
+
+                                if (function)
+                                    ImGui::TextColored(ImColor(0xFF9BC64D), "function");
+                                if (function && referenceCount > 0)
+                                    ImGui::SameLine();
+                                if (referenceCount > 0)
+                                    ImGui::Text("%zu refs", referenceCount);
+                            }
                         }
                     }
 
+                    // Row heights are only known once the clipper measured one
+                    if (this->m_scrollToRow.has_value() && clipper.ItemsHeight > 0) {
+                        ImGui::SetScrollY(clipper.StartPosY - ImGui::GetWindowPos().y + ImGui::GetScrollY() + *this->m_scrollToRow * clipper.ItemsHeight - ImGui::GetWindowHeight() / 3);
+                        this->m_scrollToRow.reset();
+                    }
+
                     clipper.End();
 
                     ImGui::EndTable();
@@ -1,17 +1,42 @@
 #include "views/view_hashes.hpp"
 
+#include <hex/api/task.hpp>
 #include <hex/providers/provider.hpp>
+#include <hex/providers/scan_pipeline.hpp>
 #include <hex/helpers/utils.hpp>
 
 #include "helpers/crypto.hpp"
 
+#include <memory>
 #include <vector>
 
 
 namespace hex {
 
     ViewHashes::ViewHashes() : View("Hashes") {
-        View::subscribeEvent(Events::DataChanged, [this](auto) {
+        View::subscribeEvent(Events::DataChanged, [this](auto userData) {
+            auto intersects = [](const Region &region, u64 address, size_t size) {
+                return address < region.address + region.size && region.address < address + size;
+            };
+
+            if (auto region = std::any_cast<Region>(&userData); region != nullptr) {
+                std::erase_if(this->m_hashCache, [&](const auto &entry) {
+                    return intersects(*region, entry.first.address, entry.first.size);
+                });
+
+                // Edits outside of the hashed region don't change the result
+                if (!intersects(*region, this->m_hashRegion[0], this->m_hashRegion[1] - this->m_hashRegion[0] + 1))
+                    return;
+            } else
+                this->m_hashCache.clear();
+
+            this->m_dataGeneration++;
+            this->m_shouldInvalidate = true;
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto) {
+            this->m_hashCache.clear();
+            this->m_dataGeneration++;
             this->m_shouldInvalidate = true;
         });
 
@@ -19,204 +44,176 @@ namespace hex {
             auto region = std::any_cast<const Region>(userData);
 
             if (this->m_shouldMatchSelection) {
-                this->m_hashRegion[0] = region.address;
-                this->m_hashRegion[1] = region.address + region.size - 1;
+                // Selections are relative to the page shown in the hex editor
+                u64 pageOffset = prv::Provider::PageSize * SharedData::currentProvider->getCurrentPage();
+                this->m_hashRegion[0] = pageOffset + region.address;
+                this->m_hashRegion[1] = pageOffset + region.address + region.size - 1;
                 this->m_shouldInvalidate = true;
             }
         });
     }
 
     ViewHashes::~ViewHashes() {
+        if (this->m_hashTask != nullptr)
+            this->m_hashTask->cancel();
+
         View::unsubscribeEvent(Events::DataChanged);
+        View::unsubscribeEvent(Events::ProviderChanged);
         View::unsubscribeEvent(Events::RegionSelected);
     }
 
 
-    template<size_t Size>
-    static void formatBigHexInt(std::array<u8, Size> dataArray, char *buffer, size_t bufferSize) {
-        for (int i = 0; i < dataArray.size(); i++)
-            snprintf(buffer + 2 * i, bufferSize - 2 * i, "%02X", dataArray[i]);
-    }
-
-    void ViewHashes::drawContent() {
-        if (ImGui::Begin("Hashing", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
-            ImGui::BeginChild("##scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
-
-            auto provider = SharedData::currentProvider;
-            if (provider != nullptr && provider->isAvailable()) {
-
-                ImGui::TextUnformatted("Region");
-                ImGui::Separator();
-
-                ImGui::InputScalarN("##nolabel", ImGuiDataType_U64, this->m_hashRegion, 2, nullptr, nullptr, "%08X", ImGuiInputTextFlags_CharsHexadecimal);
-                if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
-
-                ImGui::Checkbox("Match selection", &this->m_shouldMatchSelection);
-                if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
-
-                ImGui::NewLine();
-                ImGui::TextUnformatted("Settings");
-                ImGui::Separator();
-
-                if (ImGui::Combo("Hash Function", &this->m_currHashFunction, HashFunctionNames,sizeof(HashFunctionNames) / sizeof(const char *)))
-                    this->m_shouldInvalidate = true;
-
-                size_t dataSize = provider->getSize();
-                if (this->m_hashRegion[1] >= dataSize)
-                    this->m_hashRegion[1] = dataSize - 1;
-
-
-                if (this->m_hashRegion[1] >= this->m_hashRegion[0]) {
-
-                    switch (this->m_currHashFunction) {
-                        case 0: // CRC16
-                        {
-                            static int polynomial = 0, init = 0;
-
-                            ImGui::InputInt("Initial Value", &init, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
-                            if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
+    static std::string formatBigHexInt(const std::vector<u8> &data) {
+        std::string result;
+        hex::appendHexBytes(result, data);
 
-                            ImGui::InputInt("Polynomial", &polynomial, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
-                            if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
+        return result;
+    }
 
-                            ImGui::NewLine();
+    void ViewHashes::calculate(prv::Provider *provider, u64 address, size_t size) {
+        if (this->m_hashTask != nullptr)
+            this->m_hashTask->cancel();
+
+        std::vector<CacheKey> keys;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < HashFunctionCount; i++) {
+            if (!this->m_selectedHashFunctions[i])
+                continue;
+
+            CacheKey key = { static_cast<crypt::HashFunction>(i), 0, 0, address, size };
+            if (key.function == crypt::HashFunction::CRC16) {
+                key.polynomial = u16(this->m_crc16Polynomial);
+                key.init = u16(this->m_crc16Init);
+            } else if (key.function == crypt::HashFunction::CRC32) {
+                key.polynomial = u32(this->m_crc32Polynomial);
+                key.init = u32(this->m_crc32Init);
+            }
 
-                            static u16 result = 0;
+            keys.push_back(key);
+            names.emplace_back(HashFunctionNames[i]);
+        }
 
-                            if (this->m_shouldInvalidate)
-                                result = crypt::crc16(provider, this->m_hashRegion[0], this->m_hashRegion[1] - this->m_hashRegion[0] + 1, polynomial, init);
+        // Only hashes that aren't cached yet need another pass over the data
+        std::vector<crypt::HashSettings> missingHashes;
+        std::vector<CacheKey> missingKeys;
+        for (const auto &key : keys) {
+            if (this->m_hashCache.contains(key))
+                continue;
 
-                            char buffer[sizeof(result) * 2 + 1];
-                            snprintf(buffer, sizeof(buffer), "%04X", result);
+            missingHashes.push_back({ key.function, key.polynomial, key.init });
+            missingKeys.push_back(key);
+        }
 
-                            ImGui::TextUnformatted("Result");
-                            ImGui::Separator();
-                            ImGui::InputText("##nolabel", buffer, ImGuiInputTextFlags_ReadOnly);
-                        }
-                            break;
-                        case 1: // CRC32
-                        {
-                            static int polynomial = 0, init = 0;
+        auto showResults = [this, keys, names] {
+            this->m_hashResults.clear();
 
-                            ImGui::InputInt("Initial Value", &init, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
-                            if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (auto it = this->m_hashCache.find(keys[i]); it != this->m_hashCache.end())
+                    this->m_hashResults.emplace_back(names[i], formatBigHexInt(it->second));
+            }
+        };
 
-                            ImGui::InputInt("Polynomial", &polynomial, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
-                            if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
+        if (missingHashes.empty()) {
+            this->m_hashTask = nullptr;
+            showResults();
+            return;
+        }
 
-                            ImGui::NewLine();
+        this->m_hashResults.clear();
 
-                            static u32 result = 0;
+        auto hashPass = std::make_shared<crypt::HashPass>(missingHashes);
+        const u64 generation = this->m_dataGeneration;
 
-                            if (this->m_shouldInvalidate)
-                                result = crypt::crc32(provider, this->m_hashRegion[0], this->m_hashRegion[1] - this->m_hashRegion[0] + 1, polynomial, init);
+        // Other analyses of the same range, like hashing the file after it got opened, get to share the pass
+        this->m_hashTask = prv::ScanPipeline::submit("Hashing", TaskPriority::Normal, provider->createSnapshot(), address, size, prv::ScanPipeline::Order::Sequential,
+                                                     hashPass->getConsumers(), [this, missingKeys, hashPass, generation, showResults] {
+            // Results of data that changed while it was being hashed are outdated, a new calculation is already queued
+            if (generation != this->m_dataGeneration)
+                return;
 
-                            char buffer[sizeof(result) * 2 + 1];
-                            snprintf(buffer, sizeof(buffer), "%08X", result);
+            auto digests = hashPass->finish();
 
-                            ImGui::TextUnformatted("Result");
-                            ImGui::Separator();
-                            ImGui::InputText("##nolabel", buffer, ImGuiInputTextFlags_ReadOnly);
-                        }
-                            break;
-                        case 2: // MD5
-                        {
-                            static std::array<u8, 16> result = { 0 };
+            while (this->m_hashCache.size() + missingKeys.size() > MaxCachedHashes && !this->m_hashCache.empty())
+                this->m_hashCache.erase(this->m_hashCache.begin());
 
-                            if (this->m_shouldInvalidate)
-                                result = crypt::md5(provider, this->m_hashRegion[0], this->m_hashRegion[1] - this->m_hashRegion[0] + 1);
+            for (size_t i = 0; i < missingKeys.size(); i++)
+                this->m_hashCache[missingKeys[i]] = std::move(digests[i]);
 
-                            char buffer[sizeof(result) * 2 + 1];
-                            formatBigHexInt(result, buffer, sizeof(buffer));
+            showResults();
+        });
+    }
 
-                            ImGui::NewLine();
-                            ImGui::TextUnformatted("Result");
-                            ImGui::Separator();
-                            ImGui::InputText("##nolabel", buffer, ImGuiInputTextFlags_ReadOnly);
-                        }
-                            break;
-                        case 3: // SHA-1
-                        {
-                            static std::array<u8, 20> result = { 0 };
+    void ViewHashes::drawContent() {
+        if (ImGui::Begin("Hashing", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
+            ImGui::BeginChild("##scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
 
-                            if (this->m_shouldInvalidate)
-                                result = crypt::sha1(provider, this->m_hashRegion[0], this->m_hashRegion[1] - this->m_hashRegion[0] + 1);
+            auto provider = SharedData::currentProvider;
+            if (provider != nullptr && provider->isAvailable()) {
 
-                            char buffer[sizeof(result) * 2 + 1];
-                            formatBigHexInt(result, buffer, sizeof(buffer));
+                ImGui::TextUnformatted("Region");
+                ImGui::Separator();
 
-                            ImGui::NewLine();
-                            ImGui::TextUnformatted("Result");
-                            ImGui::Separator();
-                            ImGui::InputText("##nolabel", buffer, ImGuiInputTextFlags_ReadOnly);
-                        }
-                            break;
-                        case 4: // SHA-224
-                        {
-                            static std::array<u8, 28> result = { 0 };
+                ImGui::InputScalarN("##nolabel", ImGuiDataType_U64, this->m_hashRegion, 2, nullptr, nullptr, "%08X", ImGuiInputTextFlags_CharsHexadecimal);
+                if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
 
-                            if (this->m_shouldInvalidate)
-                                result = crypt::sha224(provider, this->m_hashRegion[0], this->m_hashRegion[1] - this->m_hashRegion[0] + 1);
+                ImGui::Checkbox("Match selection", &this->m_shouldMatchSelection);
+                if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
 
-                            char buffer[sizeof(result) * 2 + 1];
-                            formatBigHexInt(result, buffer, sizeof(buffer));
+                ImGui::NewLine();
+                ImGui::TextUnformatted("Settings");
+                ImGui::Separator();
 
-                            ImGui::NewLine();
-                            ImGui::TextUnformatted("Result");
-                            ImGui::Separator();
-                            ImGui::InputText("##nolabel", buffer, ImGuiInputTextFlags_ReadOnly);
-                        }
-                            break;
-                        case 5: // SHA-256
-                        {
-                            static std::array<u8, 32> result;
+                for (size_t i = 0; i < HashFunctionCount; i++) {
+                    if (ImGui::Checkbox(HashFunctionNames[i], &this->m_selectedHashFunctions[i]))
+                        this->m_shouldInvalidate = true;
 
-                            if (this->m_shouldInvalidate)
-                                result = crypt::sha256(provider, this->m_hashRegion[0], this->m_hashRegion[1] - this->m_hashRegion[0] + 1);
+                    if (i % 4 != 3 && i != HashFunctionCount - 1)
+                        ImGui::SameLine(0, 15);
+                }
 
-                            char buffer[sizeof(result) * 2 + 1];
-                            formatBigHexInt(result, buffer, sizeof(buffer));
+                auto drawCrcSettings = [this](const char *name, int &polynomial, int &init) {
+                    ImGui::PushID(name);
 
-                            ImGui::NewLine();
-                            ImGui::TextUnformatted("Result");
-                            ImGui::Separator();
-                            ImGui::InputText("##nolabel", buffer, ImGuiInputTextFlags_ReadOnly);
-                        }
-                            break;
-                        case 6: // SHA-384
-                        {
-                            static std::array<u8, 48> result;
+                    ImGui::InputInt(hex::format("%s Initial Value", name).c_str(), &init, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
+                    if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
 
-                            if (this->m_shouldInvalidate)
-                                result = crypt::sha384(provider, this->m_hashRegion[0], this->m_hashRegion[1] - this->m_hashRegion[0] + 1);
+                    ImGui::InputInt(hex::format("%s Polynomial", name).c_str(), &polynomial, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
+                    if (ImGui::IsItemEdited()) this->m_shouldInvalidate = true;
 
-                            char buffer[sizeof(result) * 2 + 1];
-                            formatBigHexInt(result, buffer, sizeof(buffer));
+                    ImGui::PopID();
+                };
 
-                            ImGui::NewLine();
-                            ImGui::TextUnformatted("Result");
-                            ImGui::Separator();
-                            ImGui::InputText("##nolabel", buffer, ImGuiInputTextFlags_ReadOnly);
-                        }
-                            break;
-                        case 7: // SHA-512
-                        {
-                            static std::array<u8, 64> result;
+                if (this->m_selectedHashFunctions[size_t(crypt::HashFunction::CRC16)])
+                    drawCrcSettings("CRC16", this->m_crc16Polynomial, this->m_crc16Init);
+                if (this->m_selectedHashFunctions[size_t(crypt::HashFunction::CRC32)])
+                    drawCrcSettings("CRC32", this->m_crc32Polynomial, this->m_crc32Init);
 
-                            if (this->m_shouldInvalidate)
-                                result = crypt::sha512(provider, this->m_hashRegion[0], this->m_hashRegion[1] - this->m_hashRegion[0] + 1);
+                size_t dataSize = provider->getActualSize();
+                if (this->m_hashRegion[1] >= dataSize)
+                    this->m_hashRegion[1] = dataSize - 1;
 
-                            char buffer[sizeof(result) * 2 + 1];
-                            formatBigHexInt(result, buffer, sizeof(buffer));
 
-                            ImGui::NewLine();
-                            ImGui::TextUnformatted("Result");
-                            ImGui::Separator();
-                            ImGui::InputText("##nolabel", buffer, ImGuiInputTextFlags_ReadOnly);
+                if (this->m_hashRegion[1] >= this->m_hashRegion[0]) {
+                    const u64 address = this->m_hashRegion[0];
+                    const size_t size = this->m_hashRegion[1] - this->m_hashRegion[0] + 1;
+
+                    if (this->m_shouldInvalidate)
+                        this->calculate(provider, address, size);
+
+                    ImGui::NewLine();
+                    ImGui::TextUnformatted("Result");
+                    ImGui::Separator();
+
+                    if (this->m_hashTask != nullptr && !this->m_hashTask->isFinished()) {
+                        ImGui::TextUnformatted("Calculating...");
+                        ImGui::ProgressBar(this->m_hashTask->getProgress());
+                    } else {
+                        for (auto &[name, result] : this->m_hashResults) {
+                            ImGui::PushID(name.c_str());
+                            ImGui::InputText(name.c_str(), result.data(), result.size() + 1, ImGuiInputTextFlags_ReadOnly);
+                            ImGui::PopID();
                         }
-                            break;
                     }
-
                 }
 
                 this->m_shouldInvalidate = false;
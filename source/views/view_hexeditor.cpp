@@ -1,23 +1,49 @@
 #include "views/view_hexeditor.hpp"
 
+#include <hex/api/task.hpp>
 #include <hex/providers/provider.hpp>
+#include <hex/providers/scan_pipeline.hpp>
+#include <hex/api/content_registry.hpp>
 #include <hex/api/imhex_api.hpp>
+#include <hex/helpers/analysis_cache.hpp>
+#include <hex/helpers/bookmark_store.hpp>
+#include <hex/helpers/byte_searcher.hpp>
+#include <hex/helpers/multi_searcher.hpp>
+#include <hex/helpers/regex_searcher.hpp>
 #include "providers/file_provider.hpp"
+#include "providers/process_provider.hpp"
+#include "providers/gdb_provider.hpp"
+#include "providers/compressed_provider.hpp"
+#include "providers/segmented_provider.hpp"
 
+#include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "helpers/crypto.hpp"
+#include "helpers/delta_patches.hpp"
+#include "helpers/file_writer.hpp"
 #include "helpers/patches.hpp"
+#include "helpers/region_operations.hpp"
+#include "helpers/selection_formatter.hpp"
 #include "helpers/project_file_handler.hpp"
 #include "helpers/loader_script_handler.hpp"
 
 #undef __STRICT_ANSI__
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <filesystem>
+#include <optional>
 
 namespace hex {
 
-    ViewHexEditor::ViewHexEditor(std::vector<lang::PatternData*> &patternData)
-            : View("Hex Editor"), m_patternData(patternData) {
+    ViewHexEditor::ViewHexEditor(std::vector<lang::PatternData*> &patternData, lang::PatternIndex &patternIndex)
+            : View("Hex Editor"), m_patternData(patternData), m_patternIndex(patternIndex) {
+
+        this->m_searchIndexMemory = MemoryBudget::Registration("Search index", [this] {
+            return this->m_searchIndex != nullptr ? this->m_searchIndex->getMemoryUsage() : 0;
+        });
 
         this->m_memoryEditor.ReadFn = [](const ImU8 *data, size_t off) -> ImU8 {
             auto provider = SharedData::currentProvider;
@@ -27,13 +53,17 @@ namespace hex {
             ImU8 byte;
             provider->read(off, &byte, sizeof(ImU8));
 
-            for (auto &overlay : SharedData::currentProvider->getOverlays()) {
-                auto overlayAddress = overlay->getAddress();
-                if (off >= overlayAddress && off < overlayAddress + overlay->getSize())
-                    byte = overlay->getData()[off - overlayAddress];
+            return byte;
+        };
+
+        this->m_memoryEditor.FetchFn = [](const ImU8 *data, size_t off, ImU8 *buffer, size_t size) {
+            auto provider = SharedData::currentProvider;
+            if (!provider->isAvailable() || !provider->isReadable()) {
+                std::memset(buffer, 0x00, size);
+                return;
             }
 
-            return byte;
+            provider->read(off, buffer, size);
         };
 
         this->m_memoryEditor.WriteFn = [](ImU8 *data, size_t off, ImU8 d) -> void {
@@ -42,28 +72,29 @@ namespace hex {
                 return;
 
             provider->write(off, &d, sizeof(ImU8));
-            View::postEvent(Events::DataChanged);
+            EventManager::postCoalesced(Events::DataChanged, Region { prv::Provider::PageSize * provider->getCurrentPage() + off, sizeof(ImU8) }, EventManager::mergeRegions);
             ProjectFile::markDirty();
         };
 
         this->m_memoryEditor.HighlightFn = [](const ImU8 *data, size_t off, bool next) -> bool {
             ViewHexEditor *_this = (ViewHexEditor *) data;
 
+            // Patterns and bookmarks use absolute offsets, the editor only shows the current page
+            off += prv::Provider::PageSize * SharedData::currentProvider->getCurrentPage();
+
             std::optional<u32> currColor, prevColor;
 
-            for (const auto &[region, name, comment, color] : ImHexApi::Bookmarks::getEntries()) {
-                if (off >= region.address && off < (region.address + region.size))
-                    currColor = (color & 0x00FFFFFF) | 0x80000000;
-                if ((off - 1) >= region.address && (off - 1) < (region.address + region.size))
-                    prevColor = (color & 0x00FFFFFF) | 0x80000000;
-            }
+            if (auto color = _this->m_bookmarkHighlights.get(off); color.has_value())
+                currColor = (color.value() & 0x00FFFFFF) | 0x80000000;
+            if (auto color = _this->m_bookmarkHighlights.get(off - 1); color.has_value())
+                prevColor = (color.value() & 0x00FFFFFF) | 0x80000000;
 
-            if (_this->m_highlightedBytes.contains(off)) {
-                auto color = (_this->m_highlightedBytes[off] & 0x00FFFFFF) | 0x80000000;
+            if (auto highlight = _this->m_patternHighlights.get(off); highlight.has_value()) {
+                auto color = (highlight.value() & 0x00FFFFFF) | 0x80000000;
                 currColor = currColor.has_value() ? ImAlphaBlendColors(color, currColor.value()) : color;
             }
-            if (_this->m_highlightedBytes.contains(off - 1)) {
-                auto color = (_this->m_highlightedBytes[off - 1] & 0x00FFFFFF) | 0x80000000;
+            if (auto highlight = _this->m_patternHighlights.get(off - 1); highlight.has_value()) {
+                auto color = (highlight.value() & 0x00FFFFFF) | 0x80000000;
                 prevColor = prevColor.has_value() ? ImAlphaBlendColors(color, prevColor.value()) : color;
             }
 
@@ -81,24 +112,67 @@ namespace hex {
         };
 
         this->m_memoryEditor.HoverFn = [](const ImU8 *data, size_t addr) {
+            ViewHexEditor *_this = (ViewHexEditor *) data;
             bool tooltipShown = false;
 
-            for (const auto &[region, name, comment, color] : ImHexApi::Bookmarks::getEntries()) {
-                if (addr >= region.address && addr < (region.address + region.size)) {
-                    if (!tooltipShown) {
-                        ImGui::BeginTooltip();
-                        tooltipShown = true;
-                    }
-                    ImGui::ColorButton(name.data(), ImColor(color).Value);
-                    ImGui::SameLine(0, 10);
-                    ImGui::TextUnformatted(name.data());
+            addr += prv::Provider::PageSize * SharedData::currentProvider->getCurrentPage();
+
+            static std::vector<const ImHexApi::Bookmarks::Entry*> bookmarks;
+            bookmarks.clear();
+            ImHexApi::Bookmarks::getEntries().findAt(addr, bookmarks);
+
+            for (const auto bookmark : bookmarks) {
+                if (!tooltipShown) {
+                    ImGui::BeginTooltip();
+                    tooltipShown = true;
+                }
+                ImGui::ColorButton(bookmark->name.c_str(), ImColor(bookmark->color).Value);
+                ImGui::SameLine(0, 10);
+                ImGui::TextUnformatted(bookmark->name.c_str());
+            }
+
+            static std::vector<lang::PatternData*> patternPath;
+            if (_this->m_patternIndex.findPath(addr, patternPath)) {
+                if (!tooltipShown) {
+                    ImGui::BeginTooltip();
+                    tooltipShown = true;
+                } else
+                    ImGui::Separator();
+
+                // Entries are only named by their index, so the names of all patterns containing the byte are shown
+                std::string path;
+                for (const auto pattern : patternPath) {
+                    if (!path.empty() && !pattern->getVariableName().starts_with('['))
+                        path += '.';
+                    path += pattern->getVariableName();
                 }
+
+                auto pattern = patternPath.back();
+                ImGui::ColorButton(path.c_str(), ImColor(pattern->getColor()).Value);
+                ImGui::SameLine(0, 10);
+                ImGui::TextUnformatted(path.c_str());
+                ImGui::SameLine();
+                pattern->drawTypeName();
+
+                if (const auto &value = pattern->getDisplayValue(SharedData::currentProvider); !value.empty())
+                    ImGui::TextUnformatted(value.c_str());
             }
 
             if (tooltipShown)
                 ImGui::EndTooltip();
         };
 
+        this->m_memoryEditor.SideColumnWidth = 24;
+        this->m_memoryEditor.SideColumnFn = [](const ImU8 *data, ImVec2 size) {
+            ViewHexEditor *_this = (ViewHexEditor *) data;
+            _this->drawMinimap(size);
+        };
+
+        View::subscribeEvent(Events::EntropyAnalysisChanged, [this](auto userData) {
+            this->m_minimapEntropy = std::any_cast<std::shared_ptr<const EntropyPyramid>>(userData);
+            this->m_minimapOutdated = true;
+        });
+
         View::subscribeEvent(Events::FileDropped, [this](auto userData) {
             auto filePath = std::any_cast<const char*>(userData);
 
@@ -115,14 +189,18 @@ namespace hex {
                 return;
 
             provider->setCurrentPage(page.value());
-            this->m_memoryEditor.GotoAddr = region.address;
-            this->m_memoryEditor.DataPreviewAddr = region.address;
-            this->m_memoryEditor.DataPreviewAddrEnd = region.address + region.size - 1;
-            View::postEvent(Events::RegionSelected, region);
+
+            // Requested regions use absolute offsets while the editor only displays the current page
+            u64 pageAddress = region.address - prv::Provider::PageSize * page.value();
+            this->m_memoryEditor.GotoAddr = pageAddress;
+            this->m_memoryEditor.DataPreviewAddr = pageAddress;
+            this->m_memoryEditor.DataPreviewAddrEnd = pageAddress + region.size - 1;
+            View::postEvent(Events::RegionSelected, Region { pageAddress, region.size });
         });
 
         View::subscribeEvent(Events::ProjectFileLoad, [this](auto) {
             this->openFile(ProjectFile::getFilePath());
+            this->loadSearchIndex();
         });
 
         View::subscribeEvent(Events::WindowClosing, [this](auto userData) {
@@ -135,10 +213,55 @@ namespace hex {
         });
 
         View::subscribeEvent(Events::PatternChanged, [this](auto) {
-            this->m_highlightedBytes.clear();
+            this->m_patternIndex.invalidate();
+            this->m_patternHighlights.clear();
 
             for (const auto &pattern : this->m_patternData)
-                this->m_highlightedBytes.merge(pattern->getHighlightedAddresses());
+                pattern->addHighlightedRegions(this->m_patternHighlights);
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto userData) {
+            auto previous = std::any_cast<prv::Provider*>(userData);
+            auto provider = SharedData::currentProvider;
+
+            // Results of the previous search are only valid for the data they were found in
+            if (this->m_searchTask != nullptr)
+                this->m_searchTask->cancel();
+            this->m_lastStringSearch = std::make_shared<SearchResults>();
+            this->m_lastHexSearch = std::make_shared<SearchResults>();
+            this->m_lastPatternSearch = std::make_shared<SearchResults>();
+            this->m_lastSignatureSearch = std::make_shared<SearchResults>();
+            this->m_lastRegexSearch = std::make_shared<SearchResults>();
+            this->m_lastSearchBuffer = &this->m_lastStringSearch;
+            this->m_lastSearchIndex = 0;
+            this->m_pendingSearchJump.reset();
+
+            // A partially built index continues where it stopped once its provider gets selected again
+            if (this->m_searchIndexTask != nullptr)
+                this->m_searchIndexTask->cancel();
+            if (previous != nullptr && this->m_searchIndex != nullptr)
+                AnalysisCache::store(previous, "SearchIndex", this->m_searchIndex, this->m_searchIndex->getMemoryUsage());
+
+            this->m_searchIndex = nullptr;
+            if (provider != nullptr) {
+                this->m_searchIndex = AnalysisCache::take<SearchIndex>(provider, "SearchIndex");
+                if (this->m_searchIndex != nullptr && !this->m_searchIndex->isComplete())
+                    this->buildSearchIndex();
+            }
+
+            // Indexing gets cancelled together with all other tasks when a different file is closed
+            if (auto compressedProvider = dynamic_cast<prv::CompressedProvider*>(provider); compressedProvider != nullptr && !compressedProvider->isIndexed()) {
+                auto task = this->m_compressedIndexTasks.find(compressedProvider);
+                if (task == this->m_compressedIndexTasks.end() || task->second->isCancelled())
+                    this->indexCompressedFile(compressedProvider);
+            }
+
+            this->m_memoryEditor.ReadOnly = provider == nullptr || !provider->isWritable();
+            this->m_memoryEditor.DataPreviewAddr = 0;
+            this->m_memoryEditor.DataPreviewAddrEnd = 0;
+            this->m_providerTabsOutdated = true;
+
+            View::postEvent(Events::PatternChanged);
         });
 
         View::subscribeEvent(Events::OpenWindow, [this](auto name) {
@@ -158,14 +281,185 @@ namespace hex {
     }
 
     ViewHexEditor::~ViewHexEditor() {
+        if (this->m_searchTask != nullptr)
+            this->m_searchTask->cancel();
+        if (this->m_searchIndexTask != nullptr)
+            this->m_searchIndexTask->cancel();
+        for (auto &[provider, task] : this->m_compressedIndexTasks)
+            task->cancel();
+        if (this->m_fileHashTask != nullptr)
+            this->m_fileHashTask->cancel();
+
+        // Everything got saved or deliberately thrown away by the time ImHex closes normally
+        while (!this->m_journals.empty())
+            this->stopJournal(this->m_journals.begin()->first);
+    }
+
+    // The minimap texture is never taller than this, each row covers an equally sized part of the data
+    constexpr static u64 MinimapRows = 1024;
+
+    void ViewHexEditor::updateMinimapTexture() {
+        this->m_minimapOutdated = false;
+
+        const auto &entropyPyramid = *this->m_minimapEntropy;
+        const u64 dataSize = entropyPyramid.getDataSize();
+
+        const auto &classes = entropyPyramid.getBlockClasses();
+        const u64 classBlockSize = entropyPyramid.getBlockSize(EntropyPyramid::ClassLevel);
+        const u64 rows = std::clamp<u64>((dataSize + classBlockSize - 1) / classBlockSize, 1, MinimapRows);
+
+        // A level with a few blocks per row so every row gets averaged over at least one whole block
+        const size_t level = entropyPyramid.getLevelForResolution(dataSize, rows * EntropyPyramid::LevelFactor);
+        const u64 entropyBlockSize = entropyPyramid.getBlockSize(level);
+        const auto &entropy = entropyPyramid.getEntropy(level);
+
+        // Two pixels per row, the most common byte class on the left and the entropy on the right
+        std::vector<u32> pixels(rows * 2);
+        for (u64 row = 0; row < rows; row++) {
+            const u64 start = dataSize * row / rows;
+            const u64 end = std::max(dataSize * (row + 1) / rows, start + 1);
+
+            std::array<u64, u8(RegionClass::Encrypted) + 1> classCounts = { 0 };
+            for (u64 block = start / classBlockSize; block < std::min<u64>((end + classBlockSize - 1) / classBlockSize, classes.size()); block++)
+                classCounts[u8(classes[block])]++;
+
+            const auto rowClass = RegionClass(std::max_element(classCounts.begin(), classCounts.end()) - classCounts.begin());
+
+            float entropySum = 0;
+            u64 entropyBlocks = 0;
+            for (u64 block = start / entropyBlockSize; block < std::min<u64>((end + entropyBlockSize - 1) / entropyBlockSize, entropy.size()); block++) {
+                entropySum += entropy[block];
+                entropyBlocks++;
+            }
+
+            const u8 brightness = entropyBlocks == 0 ? 0 : u8(std::clamp(entropySum / entropyBlocks, 0.0F, 1.0F) * 0xFF);
+
+            pixels[row * 2] = getRegionClassColor(rowClass) | 0xFF000000;
+            pixels[row * 2 + 1] = IM_COL32(brightness, brightness, brightness, 0xFF);
+        }
+
+        // The texture is reused for every upload and goes away together with the GL context
+        if (this->m_minimapTexture == 0)
+            glGenTextures(1, &this->m_minimapTexture);
+
+        glBindTexture(GL_TEXTURE_2D, this->m_minimapTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, rows, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    }
+
+    void ViewHexEditor::drawMinimap(ImVec2 size) {
+        auto provider = SharedData::currentProvider;
+        auto drawList = ImGui::GetWindowDrawList();
+
+        const ImVec2 start = ImGui::GetCursorScreenPos();
+        const ImVec2 end = ImVec2(start.x + size.x, start.y + size.y);
+        ImGui::InvisibleButton("##minimap", size);
+
+        if (this->m_minimapEntropy == nullptr || provider == nullptr || this->m_minimapEntropy->getDataSize() != provider->getActualSize() || size.y <= 0) {
+            drawList->AddRectFilled(start, end, ImGui::GetColorU32(ImGuiCol_FrameBg));
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("Analyze the data in the Information view to show an overview of it here");
+
+            return;
+        }
+
+        // Only rebuilt when the analysis changed, drawing it is a single textured quad
+        if (this->m_minimapOutdated)
+            this->updateMinimapTexture();
+
+        drawList->AddImage(reinterpret_cast<ImTextureID>(intptr_t(this->m_minimapTexture)), start, end);
+
+        const u64 dataSize = this->m_minimapEntropy->getDataSize();
+        auto getY = [&](u64 address) { return start.y + float(double(address) / dataSize * size.y); };
 
+        // Marks the bytes currently shown in the editor, the editor's addresses are relative to the current page
+        const u64 visibleStart = prv::Provider::PageSize * provider->getCurrentPage() + this->m_memoryEditor.VisibleDataAddr;
+        const float visibleTop = getY(visibleStart);
+        const float visibleBottom = std::max(getY(visibleStart + this->m_memoryEditor.VisibleData.Size), visibleTop + 2);
+        drawList->AddRect(ImVec2(start.x, visibleTop), ImVec2(end.x, visibleBottom), 0xFFFFFFFF);
+
+        const double position = std::clamp((ImGui::GetIO().MousePos.y - start.y) / size.y, 0.0F, 1.0F);
+        const u64 address = std::min<u64>(position * dataSize, dataSize - 1);
+
+        // Clicking jumps to the address, dragging keeps following the mouse
+        if (ImGui::IsItemActive() && (ImGui::IsItemClicked() || ImGui::GetIO().MouseDelta.y != 0))
+            View::postEvent(Events::SelectionChangeRequest, Region { address, 1 });
+
+        if (ImGui::IsItemHovered()) {
+            const auto &classes = this->m_minimapEntropy->getBlockClasses();
+            const u64 classBlock = address / this->m_minimapEntropy->getBlockSize(EntropyPyramid::ClassLevel);
+
+            ImGui::BeginTooltip();
+            ImGui::Text("0x%08llX", provider->getBaseAddress() + address);
+            if (classBlock < classes.size())
+                ImGui::TextUnformatted(getRegionClassName(classes[classBlock]));
+            ImGui::EndTooltip();
+        }
+    }
+
+    void ViewHexEditor::drawProviderTabs() {
+        const auto &providers = ImHexApi::Provider::getProviders();
+        if (providers.empty())
+            return;
+
+        prv::Provider *closedProvider = nullptr;
+
+        if (ImGui::BeginTabBar("##providers", ImGuiTabBarFlags_AutoSelectNewTabs | ImGuiTabBarFlags_FittingPolicyScroll)) {
+            for (auto provider : providers) {
+                bool open = true;
+
+                // The tab bar only has to be told about selections it didn't make itself
+                ImGuiTabItemFlags flags = ImGuiTabItemFlags_None;
+                if (this->m_providerTabsOutdated && provider == SharedData::currentProvider)
+                    flags |= ImGuiTabItemFlags_SetSelected;
+
+                if (ImGui::BeginTabItem(hex::format("%s##%p", provider->getName().c_str(), provider).c_str(), &open, flags)) {
+                    if (provider != SharedData::currentProvider && !this->m_providerTabsOutdated && !this->isSaving())
+                        ImHexApi::Provider::setCurrent(provider);
+
+                    ImGui::EndTabItem();
+                }
+
+                if (!open)
+                    closedProvider = provider;
+            }
+
+            this->m_providerTabsOutdated = false;
+
+            ImGui::EndTabBar();
+        }
+
+        if (closedProvider != nullptr)
+            this->closeProvider(closedProvider);
     }
 
     void ViewHexEditor::drawContent() {
+        // Drawn into the hex editor window before the editor itself so the tabs end up above the data
+        if (ImGui::Begin("Hex Editor", &this->getWindowOpenState(), ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoNavInputs))
+            this->drawProviderTabs();
+        ImGui::End();
+
+        this->checkForExternalChanges();
+
         auto provider = SharedData::currentProvider;
 
         size_t dataSize = (provider == nullptr || !provider->isReadable()) ? 0x00 : provider->getSize();
 
+        // The highlights only get rebuilt after bookmarks were added, removed or recolored
+        const auto &bookmarks = ImHexApi::Bookmarks::getEntries();
+        if (this->m_bookmarkGeneration != bookmarks.getGeneration()) {
+            this->m_bookmarkGeneration = bookmarks.getGeneration();
+
+            this->m_bookmarkHighlights.clear();
+            for (auto it = bookmarks.getEntries().rbegin(); it != bookmarks.getEntries().rend(); it++)
+                this->m_bookmarkHighlights.add(it->region.address, it->region.size, it->color);
+        }
+
+        this->updateJournals();
+
         this->m_memoryEditor.DrawWindow("Hex Editor", &this->getWindowOpenState(), this, dataSize, dataSize == 0 ? 0x00 : provider->getBaseAddress());
 
         if (dataSize != 0x00) {
@@ -207,6 +501,13 @@ namespace hex {
             this->drawGotoPopup();
         }
 
+        this->drawSavePopup();
+        this->drawPatchPopup();
+        this->drawExportSelectionPopup();
+        this->drawModifySelectionPopup();
+        this->drawOpenProcessPopup();
+        this->drawConnectGDBPopup();
+        this->drawRecoveryPopup();
 
         if (ImGui::BeginPopupModal("Save Changes", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
             constexpr auto Message = "You have unsaved changes made to your Project.\nAre you sure you want to exit?";
@@ -248,11 +549,11 @@ namespace hex {
             ImGui::NewLine();
 
             confirmButtons("Load", "Cancel",
-                [this, &provider] {
+                [this] {
                     if (!this->m_loaderScriptScriptPath.empty() && !this->m_loaderScriptFilePath.empty()) {
                         this->openFile(this->m_loaderScriptFilePath);
                         LoaderScript::setFilePath(this->m_loaderScriptFilePath);
-                        LoaderScript::setDataProvider(provider);
+                        LoaderScript::setDataProvider(ImHexApi::Provider::get());
                         LoaderScript::processFile(this->m_loaderScriptScriptPath);
                         ImGui::CloseCurrentPopup();
                     }
@@ -266,6 +567,37 @@ namespace hex {
 
         }
 
+        if (ImGui::BeginPopupModal("Insert bytes", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+            ImGui::InputText("Size", this->m_insertSizeBuffer, 16, ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::Checkbox("Behind the selection", &this->m_insertBehindSelection);
+            ImGui::NewLine();
+
+            confirmButtons("Insert", "Cancel",
+            [this, &provider]{
+                const u64 size = strtoull(this->m_insertSizeBuffer, nullptr, 16);
+                const u64 start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+                const u64 end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+                const u64 address = prv::Provider::PageSize * provider->getCurrentPage() + (this->m_insertBehindSelection ? end + 1 : start);
+
+                if (size > 0) {
+                    std::vector<u8> bytes(size, 0x00);
+                    provider->insert(address, bytes.data(), bytes.size());
+
+                    View::postEvent(Events::DataChanged);
+                    ProjectFile::markDirty();
+                }
+
+                ImGui::CloseCurrentPopup();
+            }, []{
+                ImGui::CloseCurrentPopup();
+            });
+
+            if (ImGui::IsKeyDown(ImGui::GetKeyIndex(ImGuiKey_Escape)))
+                ImGui::CloseCurrentPopup();
+
+            ImGui::EndPopup();
+        }
+
         if (ImGui::BeginPopupModal("Set base address", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
             ImGui::InputText("Address", this->m_baseAddressBuffer, 16, ImGuiInputTextFlags_CharsHexadecimal);
             ImGui::NewLine();
@@ -285,35 +617,264 @@ namespace hex {
         }
     }
 
-    static void save() {
+    void ViewHexEditor::save() {
+        if (this->isSaving())
+            return;
+
         auto provider = SharedData::currentProvider;
-        for (const auto &[address, value] : provider->getPatches())
-            provider->writeRaw(address, &value, sizeof(u8));
+
+        if (provider->hasStructuralEdits()) {
+            this->saveStructuralEdits();
+            return;
+        }
+
+        // The index only covers the unpatched data, so everything that's about to be written has to be indexed again
+        if (this->m_searchIndex != nullptr) {
+            for (const auto &[address, patch] : provider->getPatches().getRuns())
+                this->m_searchIndex->invalidate(address, patch.size());
+        }
+
+        provider->applyPatches();
+
+        if (auto journal = this->m_journals.find(provider); journal != this->m_journals.end())
+            journal->second->reset(provider->getRawSize(), { }, ImHexApi::Bookmarks::getEntries().getEntries());
+
+        if (this->m_searchIndex != nullptr)
+            this->buildSearchIndex();
+
+        // Saved data isn't an external change, it's what the file is compared against from now on
+        if (auto fileProvider = dynamic_cast<prv::FileProvider*>(provider); fileProvider != nullptr)
+            this->hashFileBlocks(fileProvider);
     }
 
-    static void saveAs() {
-        View::openFileBrowser("Save As", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [](auto path) {
-            FILE *file = fopen(path.c_str(), "wb");
+    void ViewHexEditor::saveStructuralEdits() {
+        auto provider = SharedData::currentProvider;
 
-            if (file != nullptr) {
-                std::vector<u8> buffer(0xFF'FFFF, 0x00);
-                size_t bufferSize = buffer.size();
+        // Moving data around in place would overwrite parts of it before they got copied, the file gets rewritten next to the original instead
+        auto fileProvider = dynamic_cast<prv::FileProvider*>(provider);
+        if (fileProvider == nullptr) {
+            View::showErrorPopup("Inserted or removed bytes can only be saved to a new file. Use Save As instead.");
+            return;
+        }
 
-                fseek(file, 0, SEEK_SET);
+        const std::string path = fileProvider->getPath();
+        const std::string temporaryPath = path + ".tmp";
 
-                auto provider = SharedData::currentProvider;
-                for (u64 offset = 0; offset < provider->getActualSize(); offset += bufferSize) {
-                    if (bufferSize > provider->getActualSize() - offset)
-                        bufferSize = provider->getActualSize() - offset;
+        this->m_readOnlyBeforeSave = this->m_memoryEditor.ReadOnly;
+        this->m_memoryEditor.ReadOnly = true;
 
-                    provider->read(offset, buffer.data(), bufferSize);
-                    fwrite(buffer.data(), 1, bufferSize, file);
-                }
+        auto succeeded = std::make_shared<bool>(false);
+
+        this->m_saveTask = TaskManager::submit("Saving", provider, [provider, temporaryPath, patches = provider->getPatches().share(), pieces = provider->getPieces(), succeeded](Task &task) {
+            *succeeded = writePatchedFile(provider, *patches, pieces.get(), temporaryPath, task);
+        }, [this, provider, path, temporaryPath, succeeded] {
+            this->m_memoryEditor.ReadOnly = this->m_readOnlyBeforeSave;
+
+            std::error_code error;
+            if (!*succeeded) {
+                std::filesystem::remove(temporaryPath, error);
+                View::showErrorPopup("Failed to save file!");
+                return;
+            }
 
-                fclose(file);
+            // The provider still maps the old file, it's closed before the new one takes its place and then opened again
+            this->closeProvider(provider);
+
+            std::filesystem::rename(temporaryPath, path, error);
+            if (error) {
+                View::showErrorPopup("Failed to replace the file! The saved data was left at " + temporaryPath);
+                this->openFile(temporaryPath);
+                return;
+            }
+
+            this->openFile(path);
+        });
+
+        View::doLater([]{ ImGui::OpenPopup("Saving"); });
+    }
+
+    void ViewHexEditor::saveAs() {
+        if (this->isSaving())
+            return;
+
+        View::openFileBrowser("Save As", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [this](auto path) {
+            auto provider = SharedData::currentProvider;
+
+            // Truncating the file that's currently open would destroy the data that's about to be copied
+            std::error_code error;
+            if (auto fileProvider = dynamic_cast<prv::FileProvider*>(provider); fileProvider != nullptr && std::filesystem::equivalent(path, fileProvider->getPath(), error)) {
+                this->save();
+                return;
+            }
+
+            // Nothing may modify the data while it's being written on the worker thread
+            this->m_readOnlyBeforeSave = this->m_memoryEditor.ReadOnly;
+            this->m_memoryEditor.ReadOnly = true;
+
+            auto succeeded = std::make_shared<bool>(false);
+
+            this->m_saveTask = TaskManager::submit("Saving", provider, [provider, path, patches = provider->getPatches().share(), pieces = provider->getPieces(), succeeded](Task &task) {
+                *succeeded = writePatchedFile(provider, *patches, pieces.get(), path, task);
+            }, [this, succeeded] {
+                this->m_memoryEditor.ReadOnly = this->m_readOnlyBeforeSave;
+
+                if (!*succeeded)
+                    View::showErrorPopup("Failed to save file!");
+            });
+
+            View::doLater([]{ ImGui::OpenPopup("Saving"); });
+        });
+    }
+
+    void ViewHexEditor::drawSavePopup() {
+        if (ImGui::BeginPopupModal("Saving", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+            ImGui::TextUnformatted("Saving file...");
+            ImGui::ProgressBar(this->m_saveTask != nullptr ? this->m_saveTask->getProgress() : 1.0F, ImVec2(300, 0));
+
+            if (!this->isSaving())
+                ImGui::CloseCurrentPopup();
+
+            ImGui::EndPopup();
+        }
+    }
+
+    bool ViewHexEditor::isSaving() const {
+        return this->m_saveTask != nullptr && !this->m_saveTask->isFinished();
+    }
+
+    // IPS patches end with a marker that's read like the address of a record. A run starting at that address gets the byte before it
+    // prepended, so its record starts one byte earlier
+    static prv::PatchStore::Runs getExportableRuns(prv::Provider *provider, u64 footerAddress) {
+        auto runs = provider->getPatches().getRuns();
+
+        if (auto run = runs.find(footerAddress); run != runs.end()) {
+            u8 value = 0;
+            provider->readAbsolute(footerAddress - 1, &value, sizeof(u8));
+
+            std::vector<u8> data = run->second;
+            data.insert(data.begin(), value);
+
+            runs.erase(run);
+            runs.emplace(footerAddress - 1, std::move(data));
+        }
+
+        return runs;
+    }
+
+    void ViewHexEditor::applyDeltaPatch(const std::string &path) {
+        if (this->isPatching())
+            return;
+
+        auto patch = hex::readFile(path);
+        if (patch.empty()) {
+            View::showErrorPopup("Failed to open patch!");
+            return;
+        }
+
+        auto provider = SharedData::currentProvider;
+        auto snapshot = provider->createSnapshot();
+        auto result = std::make_shared<std::variant<DeltaPatchResult, std::string>>();
+
+        this->m_patchTask = TaskManager::submit("Applying patch", provider, [patch = std::move(patch), snapshot, result](Task &task) {
+            *result = hex::applyDeltaPatch(patch, snapshot, task);
+        }, [this, provider, snapshot, result] {
+            if (auto error = std::get_if<std::string>(result.get()); error != nullptr) {
+                View::showErrorPopup(*error);
+                return;
+            }
+
+            auto patched = std::make_shared<DeltaPatchResult>(std::move(std::get<DeltaPatchResult>(*result)));
+
+            // Patches that change the size can't be applied in place, the result gets saved to a new file and opened instead
+            if (patched->targetSize != snapshot.getSize()) {
+                View::openFileBrowser("Save Patched File", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [this, snapshot, patched](auto path) {
+                    auto succeeded = std::make_shared<bool>(false);
+
+                    this->m_patchTask = TaskManager::submit("Saving", [path, snapshot, patched, succeeded](Task &task) {
+                        *succeeded = saveDeltaPatchResult(path, snapshot, *patched, task);
+                    }, [this, path, succeeded] {
+                        if (*succeeded)
+                            this->openFile(path);
+                        else
+                            View::showErrorPopup("Failed to save patched file!");
+                    });
+
+                    View::doLater([]{ ImGui::OpenPopup("Applying Patch"); });
+                });
+
+                return;
+            }
+
+            // The differences are relative to the data the patch got applied to
+            if (provider->getDataGeneration(false) != snapshot.getDataGeneration() + snapshot.getPatchGeneration()) {
+                View::showErrorPopup("The data changed while the patch was being applied!");
+                return;
+            }
+
+            for (const auto &[address, data] : patched->differences)
+                provider->writeAbsolute(address, data.data(), data.size());
+
+            if (provider == SharedData::currentProvider)
+                View::postEvent(Events::DataChanged);
+        });
+
+        View::doLater([]{ ImGui::OpenPopup("Applying Patch"); });
+    }
+
+    void ViewHexEditor::exportDeltaPatch(DeltaPatchFormat format) {
+        if (this->isPatching())
+            return;
+
+        auto snapshot = SharedData::currentProvider->createSnapshot();
+
+        // Everything between the patches is the same as the original data at the same address
+        std::vector<DeltaCopy> copies;
+        u64 position = 0;
+        for (const auto &[address, data] : snapshot.getPatches()) {
+            if (address > position)
+                copies.push_back({ position, position, address - position });
+            position = address + data.size();
+        }
+        if (position < snapshot.getSize())
+            copies.push_back({ position, position, snapshot.getSize() - position });
+
+        auto result = std::make_shared<std::optional<std::vector<u8>>>();
+
+        this->m_patchTask = TaskManager::submit("Creating patch", [format, snapshot, copies = std::move(copies), result](Task &task) {
+            *result = createDeltaPatch(format, snapshot.withoutPatches(), snapshot, copies, task);
+        }, [this, result] {
+            if (!result->has_value()) {
+                View::showErrorPopup("Failed to create patch!");
+                return;
             }
+
+            this->m_dataToSave = std::move(**result);
+            View::openFileBrowser("Export File", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [this](auto path) {
+                this->saveToFile(path, this->m_dataToSave);
+            });
         });
-    };
+
+        View::doLater([]{ ImGui::OpenPopup("Applying Patch"); });
+    }
+
+    void ViewHexEditor::drawPatchPopup() {
+        if (ImGui::BeginPopupModal("Applying Patch", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+            ImGui::TextUnformatted(this->m_patchTask != nullptr ? this->m_patchTask->getName().c_str() : "");
+            ImGui::ProgressBar(this->m_patchTask != nullptr ? this->m_patchTask->getProgress() : 1.0F, ImVec2(300, 0));
+
+            if (ImGui::Button("Cancel") && this->m_patchTask != nullptr)
+                this->m_patchTask->cancel();
+
+            if (!this->isPatching())
+                ImGui::CloseCurrentPopup();
+
+            ImGui::EndPopup();
+        }
+    }
+
+    bool ViewHexEditor::isPatching() const {
+        return this->m_patchTask != nullptr && !this->m_patchTask->isFinished();
+    }
 
     void ViewHexEditor::drawMenu() {
         auto provider = SharedData::currentProvider;
@@ -327,12 +888,48 @@ namespace hex {
                 });
             }
 
-            if (ImGui::MenuItem("Save", "CTRL + S", false, provider != nullptr && provider->isWritable())) {
-                save();
+            if (ImGui::MenuItem("Open Compressed File...")) {
+                View::openFileBrowser("Open Compressed File", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, ".gz,.xz,*.*", [this](auto path) {
+                    this->openCompressedFile(path);
+                });
+            }
+
+            if (ImGui::MenuItem("Open Mapped Image...")) {
+                View::openFileBrowser("Open Mapped Image", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, ".elf,.exe,.dll,.hex,.ihex,.srec,.s19,.s28,.s37,*.*", [this](auto path) {
+                    this->openMappedImage(path);
+                });
+            }
+
+            if (ImGui::MenuItem("Open Process...")) {
+                View::doLater([]{ ImGui::OpenPopup("Open Process"); });
+            }
+
+            if (ImGui::MenuItem("Connect to GDB Server...")) {
+                View::doLater([]{ ImGui::OpenPopup("Connect to GDB Server"); });
+            }
+
+            if (auto processProvider = dynamic_cast<prv::ProcessProvider*>(provider); processProvider != nullptr) {
+                if (ImGui::MenuItem("Refresh Process Memory", "", false, !this->isSaving())) {
+                    // Nothing may still be reading the old memory layout
+                    TaskManager::cancelAll();
+                    TaskManager::waitForAll();
+
+                    processProvider->refresh();
+                    View::postEvent(Events::DataChanged);
+                }
+            }
+
+            if (ImGui::MenuItem("Close File", "", false, provider != nullptr && !this->isSaving())) {
+                this->closeProvider(provider);
+                provider = SharedData::currentProvider;
+            }
+
+            if (ImGui::MenuItem("Save", "CTRL + S", false, provider != nullptr && provider->isWritable() && !this->isSaving())) {
+                this->save();
             }
 
-            if (ImGui::MenuItem("Save As...", "CTRL + SHIFT + S", false, provider != nullptr && provider->isWritable())) {
-                saveAs();
+            if (ImGui::MenuItem("Save As...", "CTRL + SHIFT + S", false, provider != nullptr && provider->isWritable() && !this->isSaving())) {
+                this->saveAs();
             }
 
             ImGui::Separator();
@@ -349,12 +946,15 @@ namespace hex {
                 View::postEvent(Events::ProjectFileStore);
 
                 if (ProjectFile::getProjectFilePath() == "") {
-                    View::openFileBrowser("Save Project", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, ".hexproj", [](auto path) {
+                    View::openFileBrowser("Save Project", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, ".hexproj", [this](auto path) {
                         ProjectFile::store(path);
+                        this->storeSearchIndex();
                     });
                 }
-                else
+                else {
                     ProjectFile::store();
+                    this->storeSearchIndex();
+                }
             }
 
             ImGui::Separator();
@@ -385,10 +985,15 @@ namespace hex {
                    View::openFileBrowser("Apply IPS Patch", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, "*.*", [this](auto path) {
                         auto patchData = hex::readFile(path);
                         auto patch = hex::loadIPSPatch(patchData);
-
-                        for (auto &[address, value] : patch) {
-                            SharedData::currentProvider->write(address, &value, 1);
+                        if (patch.empty()) {
+                            View::showErrorPopup("Failed to load IPS patch!");
+                            return;
                         }
+
+                        for (const auto &[address, data] : patch)
+                            SharedData::currentProvider->writeAbsolute(address, data.data(), data.size());
+                        View::postEvent(Events::DataChanged);
+
                        this->getWindowOpenState() = true;
                    });
 
@@ -399,10 +1004,22 @@ namespace hex {
                     View::openFileBrowser("Apply IPS32 Patch", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, "*.*", [this](auto path) {
                         auto patchData = hex::readFile(path);
                         auto patch = hex::loadIPS32Patch(patchData);
-
-                        for (auto &[address, value] : patch) {
-                            SharedData::currentProvider->write(address, &value, 1);
+                        if (patch.empty()) {
+                            View::showErrorPopup("Failed to load IPS32 patch!");
+                            return;
                         }
+
+                        for (const auto &[address, data] : patch)
+                            SharedData::currentProvider->writeAbsolute(address, data.data(), data.size());
+                        View::postEvent(Events::DataChanged);
+
+                        this->getWindowOpenState() = true;
+                    });
+                }
+
+                if (ImGui::MenuItem("Delta Patch (BPS, UPS, VCDIFF)", "", false, provider != nullptr && provider->isReadable() && !this->isPatching())) {
+                    View::openFileBrowser("Apply Delta Patch", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, "*.*", [this](auto path) {
+                        this->applyDeltaPatch(path);
                         this->getWindowOpenState() = true;
                     });
                 }
@@ -416,34 +1033,40 @@ namespace hex {
                 ImGui::EndMenu();
             }
 
-            if (ImGui::BeginMenu("Export...", provider != nullptr && provider->isWritable())) {
+            // Patch formats only describe changed bytes, inserted and removed ones have to be saved to a file first
+            if (ImGui::BeginMenu("Export...", provider != nullptr && provider->isWritable() && !provider->hasStructuralEdits())) {
                 if (ImGui::MenuItem("IPS Patch")) {
-                    Patches patches = provider->getPatches();
-                    if (!patches.contains(0x00454F45) && patches.contains(0x00454F46)) {
-                        u8 value = 0;
-                        provider->read(0x00454F45, &value, sizeof(u8));
-                        patches[0x00454F45] = value;
+                    this->m_dataToSave = generateIPSPatch(getExportableRuns(provider, 0x00454F46));
+
+                    if (this->m_dataToSave.empty()) {
+                        View::showErrorPopup("Patches can't be exported as IPS patch! They have to be within the first 16 MiB.");
+                    } else {
+                        View::openFileBrowser("Export File", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [this](auto path) {
+                            this->saveToFile(path, this->m_dataToSave);
+                        });
                     }
-
-                    this->m_dataToSave = generateIPSPatch(patches);
-                    View::openFileBrowser("Export File", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [this](auto path) {
-                        this->saveToFile(path, this->m_dataToSave);
-                    });
                 }
                 if (ImGui::MenuItem("IPS32 Patch")) {
-                    Patches patches = provider->getPatches();
-                    if (!patches.contains(0x00454F45) && patches.contains(0x45454F46)) {
-                        u8 value = 0;
-                        provider->read(0x45454F45, &value, sizeof(u8));
-                        patches[0x45454F45] = value;
+                    this->m_dataToSave = generateIPS32Patch(getExportableRuns(provider, 0x45454F46));
+
+                    if (this->m_dataToSave.empty()) {
+                        View::showErrorPopup("Patches can't be exported as IPS32 patch! They have to be within the first 4 GiB.");
+                    } else {
+                        View::openFileBrowser("Export File", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [this](auto path) {
+                            this->saveToFile(path, this->m_dataToSave);
+                        });
                     }
-
-                    this->m_dataToSave = generateIPS32Patch(patches);
-                    View::openFileBrowser("Export File", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [this](auto path) {
-                        this->saveToFile(path, this->m_dataToSave);
-                    });
                 }
 
+                ImGui::Separator();
+
+                if (ImGui::MenuItem("BPS Patch", "", false, !this->isPatching()))
+                    this->exportDeltaPatch(DeltaPatchFormat::BPS);
+                if (ImGui::MenuItem("UPS Patch", "", false, !this->isPatching()))
+                    this->exportDeltaPatch(DeltaPatchFormat::UPS);
+                if (ImGui::MenuItem("VCDIFF Patch", "", false, !this->isPatching()))
+                    this->exportDeltaPatch(DeltaPatchFormat::VCDIFF);
+
                 ImGui::EndMenu();
             }
 
@@ -461,6 +1084,10 @@ namespace hex {
                 View::doLater([]{ ImGui::OpenPopup("Goto"); });
             }
 
+            if (ImGui::MenuItem("Build Search Index", "", false, provider != nullptr && provider->isReadable() && !this->isBuildingSearchIndex())) {
+                this->buildSearchIndex();
+            }
+
             ImGui::EndMenu();
         }
 
@@ -472,10 +1099,10 @@ namespace hex {
 
     bool ViewHexEditor::handleShortcut(int key, int mods) {
         if (mods == GLFW_MOD_CONTROL && key == GLFW_KEY_S) {
-            save();
+            this->save();
             return true;
         } else if (mods == (GLFW_MOD_CONTROL | GLFW_MOD_SHIFT) && key == GLFW_KEY_S) {
-            saveAs();
+            this->saveAs();
             return true;
         } else if (mods == GLFW_MOD_CONTROL && key == GLFW_KEY_F) {
             View::doLater([]{ ImGui::OpenPopup("Search"); });
@@ -486,11 +1113,20 @@ namespace hex {
         } else if (mods == GLFW_MOD_CONTROL && key == GLFW_KEY_O) {
             View::doLater([]{ ImGui::OpenPopup("Open File"); });
             return true;
+        } else if (mods == GLFW_MOD_CONTROL && key == GLFW_KEY_Z) {
+            this->undo();
+            return true;
+        } else if (mods == GLFW_MOD_CONTROL && key == GLFW_KEY_Y) {
+            this->redo();
+            return true;
         } else if (mods == (GLFW_MOD_CONTROL | GLFW_MOD_ALT) && key == GLFW_KEY_C) {
-            this->copyBytes();
+            this->copySelection(SelectionFormatter::Format::Bytes);
             return true;
         } else if (mods == (GLFW_MOD_CONTROL | GLFW_MOD_SHIFT) && key == GLFW_KEY_C) {
-            this->copyString();
+            this->copySelection(SelectionFormatter::Format::Raw);
+            return true;
+        } else if (mods == GLFW_MOD_CONTROL && key == GLFW_KEY_V) {
+            this->pasteClipboard();
             return true;
         }
 
@@ -498,25 +1134,69 @@ namespace hex {
     }
 
 
-    void ViewHexEditor::openFile(std::string path) {
-        auto& provider = SharedData::currentProvider;
+    bool ViewHexEditor::canChangeProvider() const {
+        if (this->isSaving()) {
+            View::showErrorPopup("Can't open or close files while a file is being saved.");
+            return false;
+        }
 
-        if (provider != nullptr)
-            delete provider;
+        return true;
+    }
 
-        provider = new prv::FileProvider(path);
-        if (!provider->isWritable()) {
-            this->m_memoryEditor.ReadOnly = true;
-            View::showErrorPopup("Couldn't get write access. File opened in read-only mode.");
-        } else {
-            this->m_memoryEditor.ReadOnly = false;
+    void ViewHexEditor::closeProvider(prv::Provider *provider) {
+        if (!this->canChangeProvider())
+            return;
+
+        this->m_compressedIndexTasks.erase(provider);
+
+        if (this->m_fileHashTask != nullptr)
+            this->m_fileHashTask->cancel();
+        this->m_fileBlockHashes.erase(provider);
+        PersistentAnalysisCache::removeFingerprint(provider);
+
+        this->stopJournal(provider);
+        if (this->m_pendingRecovery.has_value() && this->m_pendingRecovery->provider == provider)
+            this->m_pendingRecovery.reset();
+
+        ImHexApi::Provider::remove(provider);
+    }
+
+    void ViewHexEditor::openFile(std::string path) {
+        if (!this->canChangeProvider())
+            return;
+
+        auto provider = ContentRegistry::Providers::create(path);
+        if (provider == nullptr) {
+            View::showErrorPopup("Failed to open file! No provider is able to open it.");
+            return;
         }
 
         if (!provider->isAvailable()) {
             View::showErrorPopup("Failed to open file!");
+            delete provider;
             return;
         }
 
+        if (!provider->isWritable())
+            View::showErrorPopup("Couldn't get write access. File opened in read-only mode.");
+
+        ImHexApi::Provider::add(provider);
+
+        if (auto fileProvider = dynamic_cast<prv::FileProvider*>(provider); fileProvider != nullptr)
+            this->hashFileBlocks(fileProvider);
+
+        // Changes to files that can't be written can't be saved either, so there's nothing to journal
+        if (provider->isWritable()) {
+            auto recovery = ProjectJournal::recover(ProjectJournal::getPath(path), provider->getRawSize());
+
+            if (recovery.has_value() && (!recovery->patches.empty() || !recovery->bookmarks.empty())) {
+                this->m_pendingRecovery = PendingRecovery { provider, path, std::move(*recovery) };
+                View::doLater([]{ ImGui::OpenPopup("Recover Changes"); });
+            } else {
+                this->startJournal(provider, path);
+            }
+        }
+
         ProjectFile::setFilePath(path);
 
         this->getWindowOpenState() = true;
@@ -526,6 +1206,368 @@ namespace hex {
         View::postEvent(Events::PatternChanged);
     }
 
+    void ViewHexEditor::openCompressedFile(std::string path) {
+        if (prv::CompressedProvider::detectFormat(path) == prv::CompressedProvider::Format::Zstandard) {
+            View::showErrorPopup("Zstandard compressed files aren't supported. Only gzip and xz files can be opened directly.");
+            return;
+        }
+
+        if (!this->canChangeProvider())
+            return;
+
+        auto provider = new prv::CompressedProvider(path);
+        if (!provider->isAvailable()) {
+            View::showErrorPopup("Failed to open file! Only gzip and xz files can be opened directly.");
+            delete provider;
+            return;
+        }
+
+        // Selecting the provider starts indexing it
+        ImHexApi::Provider::add(provider);
+
+        this->getWindowOpenState() = true;
+    }
+
+    void ViewHexEditor::indexCompressedFile(prv::CompressedProvider *provider) {
+        // The decompressed data is only available once the whole file was decompressed once
+        auto succeeded = std::make_shared<bool>(false);
+        this->m_compressedIndexTasks[provider] = TaskManager::submit("Indexing compressed file", TaskPriority::Background, provider, [provider, succeeded](Task &task) {
+            *succeeded = provider->buildIndex(task);
+        }, [provider, succeeded] {
+            if (!*succeeded) {
+                View::showErrorPopup("Failed to decompress file!");
+                return;
+            }
+
+            // Views only show the selected provider, the others pick up the data once they get selected
+            if (SharedData::currentProvider != provider)
+                return;
+
+            View::postEvent(Events::DataChanged);
+            View::postEvent(Events::PatternChanged);
+        });
+    }
+
+    // Hashing files larger than this only to find the parts that changed takes about as long as analyzing all of them again
+    constexpr static u64 MaxHashedFileSize = 0x1'0000'0000;
+    constexpr static auto ExternalChangeCheckInterval = std::chrono::milliseconds(500);
+
+    void ViewHexEditor::hashFileBlocks(prv::FileProvider *provider) {
+        this->m_fileBlockHashes.erase(provider);
+        PersistentAnalysisCache::removeFingerprint(provider);
+
+        if (this->m_fileHashTask != nullptr)
+            this->m_fileHashTask->cancel();
+
+        // Analyses can only be shared with the file's earlier ones as long as its data wasn't edited
+        const bool unedited = !provider->hasStructuralEdits() && !provider->isPatched(0, provider->getActualSize());
+        const u64 dataGeneration = provider->getDataGeneration();
+
+        // Large files only get a fingerprint, reading all of them would take about as long as analyzing them again
+        if (provider->getRawSize() > MaxHashedFileSize) {
+            std::error_code error;
+            const auto modificationTime = std::filesystem::last_write_time(provider->getPath(), error).time_since_epoch().count();
+            if (error || !unedited)
+                return;
+
+            auto fingerprint = std::make_shared<std::optional<PersistentAnalysisCache::Fingerprint>>();
+            this->m_fileHashTask = TaskManager::submit("Fingerprinting file", TaskPriority::Background, provider, [snapshot = provider->createSnapshot().withoutEdits(), modificationTime, fingerprint](Task &task) {
+                *fingerprint = PersistentAnalysisCache::getSampledFingerprint(snapshot, modificationTime, task);
+            }, [this, provider, fingerprint, dataGeneration] {
+                if (fingerprint->has_value())
+                    this->setFingerprint(provider, **fingerprint, dataGeneration);
+            });
+
+            return;
+        }
+
+        // Shares the pass over the file with everything else analyzing it right after it got opened
+        auto snapshot = provider->createSnapshot().withoutEdits();
+        auto hashes = std::make_shared<FileBlockHashes>(snapshot.getSize());
+        this->m_fileHashTask = prv::ScanPipeline::submit("Hashing file", TaskPriority::Background, snapshot, 0, snapshot.getSize(), prv::ScanPipeline::Order::Any, {
+            [hashes](u64 offset, const u8 *data, size_t size) { hashes->hashChunk(offset, data, size); }
+        }, [this, provider, hashes, unedited, dataGeneration] {
+            this->m_fileBlockHashes[provider] = hashes;
+
+            if (unedited)
+                this->setFingerprint(provider, PersistentAnalysisCache::getFingerprint(*hashes), dataGeneration);
+        });
+    }
+
+    void ViewHexEditor::setFingerprint(prv::Provider *provider, const PersistentAnalysisCache::Fingerprint &fingerprint, u64 dataGeneration) {
+        // Edited meanwhile, the data doesn't match the fingerprint anymore
+        if (provider->getDataGeneration() != dataGeneration)
+            return;
+
+        PersistentAnalysisCache::setFingerprint(provider, fingerprint, dataGeneration);
+        View::postEvent(Events::DataFingerprinted, provider);
+    }
+
+    void ViewHexEditor::checkForExternalChanges() {
+        const auto now = std::chrono::steady_clock::now();
+        if (now - this->m_lastExternalChangeCheck < ExternalChangeCheckInterval)
+            return;
+        this->m_lastExternalChangeCheck = now;
+
+        // The file gets mapped again, so nothing may be reading from the provider directly. Changes simply wait for a later check
+        auto provider = dynamic_cast<prv::FileProvider*>(SharedData::currentProvider);
+        if (provider == nullptr || this->isSaving() || this->isBuildingSearchIndex() || (this->m_fileHashTask != nullptr && !this->m_fileHashTask->isFinished()))
+            return;
+
+        if (!provider->pollExternalChanges())
+            return;
+
+        auto previous = this->m_fileBlockHashes.find(provider);
+
+        // Without the hashes from before there's no telling what changed and inserted or removed bytes may not line up with the new data anymore
+        if (previous == this->m_fileBlockHashes.end() || provider->hasStructuralEdits() || provider->getRawSize() > MaxHashedFileSize) {
+            if (provider->hasStructuralEdits())
+                View::showErrorPopup("The file was modified by another program! Inserted or removed bytes may no longer line up with its data.");
+
+            if (this->m_searchIndex != nullptr) {
+                this->m_searchIndex->invalidate(0, this->m_searchIndex->getDataSize());
+                this->buildSearchIndex();
+            }
+
+            this->hashFileBlocks(provider);
+            View::postEvent(Events::DataChanged);
+            return;
+        }
+
+        PersistentAnalysisCache::removeFingerprint(provider);
+
+        const bool unedited = !provider->isPatched(0, provider->getActualSize());
+        const u64 dataGeneration = provider->getDataGeneration();
+
+        auto hashes = std::make_shared<std::optional<FileBlockHashes>>();
+        this->m_fileHashTask = TaskManager::submit("Finding external changes", provider, [snapshot = provider->createSnapshot().withoutEdits(), hashes](Task &task) {
+            *hashes = FileBlockHashes::compute(snapshot, task);
+        }, [this, provider, before = previous->second, hashes, unedited, dataGeneration] {
+            if (!hashes->has_value()) {
+                this->m_fileBlockHashes.erase(provider);
+                if (SharedData::currentProvider == provider)
+                    View::postEvent(Events::DataChanged);
+                return;
+            }
+
+            auto after = std::make_shared<const FileBlockHashes>(std::move(**hashes));
+            this->m_fileBlockHashes[provider] = after;
+
+            if (unedited)
+                this->setFingerprint(provider, PersistentAnalysisCache::getFingerprint(*after), dataGeneration);
+
+            // Views pick up the new data once the provider gets selected again
+            if (SharedData::currentProvider != provider)
+                return;
+
+            // Nothing is left where the data behind the new end used to be, so everything has to start over
+            if (after->dataSize < before->dataSize) {
+                if (this->m_searchIndex != nullptr)
+                    this->buildSearchIndex();
+
+                View::postEvent(Events::DataChanged);
+                return;
+            }
+
+            const auto changedRanges = before->getChangedRanges(*after);
+            if (changedRanges.empty())
+                return;
+
+            // A different size gets the index rebuilt from scratch anyway
+            if (this->m_searchIndex != nullptr) {
+                for (const auto &range : changedRanges)
+                    this->m_searchIndex->invalidate(range.address, range.size);
+                this->buildSearchIndex();
+            }
+
+            for (const auto &range : changedRanges)
+                View::postEvent(Events::DataChanged, range);
+        });
+    }
+
+    void ViewHexEditor::startJournal(prv::Provider *provider, const std::string &path) {
+        auto journal = ProjectJournal::create(ProjectJournal::getPath(path), provider->getRawSize(), provider->getPatches().getRuns(), ImHexApi::Bookmarks::getEntries().getEntries());
+        if (journal == nullptr)
+            return;
+
+        // The callback keeps the journal alive until it's replaced, so modifications made by tasks that are still running can't outlive it
+        provider->getPatches().setChangeCallback([journal](u64 address, u64 size, const std::vector<prv::PatchStore::Run> &runs) {
+            journal->appendPatches(address, size, runs);
+        });
+
+        this->m_journals[provider] = std::move(journal);
+    }
+
+    void ViewHexEditor::stopJournal(prv::Provider *provider) {
+        auto journal = this->m_journals.find(provider);
+        if (journal == this->m_journals.end())
+            return;
+
+        provider->getPatches().setChangeCallback(nullptr);
+        journal->second->discard();
+
+        this->m_journals.erase(journal);
+    }
+
+    // Journals are compacted once they're this much larger than the patches they hold
+    constexpr static u64 JournalCompactionFactor = 4;
+    constexpr static u64 MinJournalCompactionSize = 0x400'0000;
+
+    void ViewHexEditor::updateJournals() {
+        const auto &bookmarks = ImHexApi::Bookmarks::getEntries();
+
+        // Bookmarks aren't tied to a file, they end up in the journal of the file that's selected while they're changed
+        if (this->m_journaledBookmarkGeneration != bookmarks.getGeneration()) {
+            this->m_journaledBookmarkGeneration = bookmarks.getGeneration();
+
+            if (auto journal = this->m_journals.find(SharedData::currentProvider); journal != this->m_journals.end())
+                journal->second->appendBookmarks(bookmarks.getEntries());
+        }
+
+        for (auto &[provider, journal] : this->m_journals) {
+            const u64 patchedBytes = provider->getPatches().getPatchedByteCount();
+
+            if (journal->getSize() > std::max(MinJournalCompactionSize, patchedBytes * JournalCompactionFactor))
+                journal->reset(provider->getRawSize(), provider->getPatches().getRuns(), bookmarks.getEntries());
+        }
+    }
+
+    void ViewHexEditor::drawRecoveryPopup() {
+        if (ImGui::BeginPopupModal("Recover Changes", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+            if (!this->m_pendingRecovery.has_value()) {
+                ImGui::CloseCurrentPopup();
+                ImGui::EndPopup();
+                return;
+            }
+
+            const auto &recovery = this->m_pendingRecovery->recovery;
+
+            size_t patchedBytes = 0;
+            for (const auto &[address, run] : recovery.patches)
+                patchedBytes += run.size();
+
+            ImGui::NewLine();
+            ImGui::TextUnformatted("ImHex didn't close properly the last time this file was open.\nDo you want to restore the changes that weren't saved?");
+            ImGui::NewLine();
+            ImGui::TextUnformatted(hex::format("%zu patched bytes, %zu bookmarks", patchedBytes, recovery.bookmarks.size()).c_str());
+            ImGui::NewLine();
+
+            confirmButtons("Restore", "Discard",
+                [this] {
+                    auto &[provider, path, recovery] = *this->m_pendingRecovery;
+
+                    provider->getPatches().assign(recovery.patches);
+                    if (!recovery.bookmarks.empty())
+                        SharedData::bookmarkEntries.assign(std::move(recovery.bookmarks));
+
+                    this->startJournal(provider, path);
+                    this->m_pendingRecovery.reset();
+
+                    View::postEvent(Events::DataChanged);
+                    ProjectFile::markDirty();
+
+                    ImGui::CloseCurrentPopup();
+                },
+                [this] {
+                    auto &[provider, path, recovery] = *this->m_pendingRecovery;
+
+                    this->startJournal(provider, path);
+                    this->m_pendingRecovery.reset();
+
+                    ImGui::CloseCurrentPopup();
+                }
+            );
+
+            ImGui::EndPopup();
+        }
+    }
+
+    void ViewHexEditor::openMappedImage(std::string path) {
+        if (!this->canChangeProvider())
+            return;
+
+        auto provider = new prv::SegmentedProvider(path);
+        if (!provider->isAvailable()) {
+            View::showErrorPopup("Failed to open file! Only ELF, PE, Intel HEX and SREC files can be mapped to their addresses.");
+            delete provider;
+            return;
+        }
+
+        ImHexApi::Provider::add(provider);
+
+        this->getWindowOpenState() = true;
+
+        View::postEvent(Events::DataChanged);
+        View::postEvent(Events::PatternChanged);
+    }
+
+    void ViewHexEditor::openProcess(u32 processId) {
+        if (!this->canChangeProvider())
+            return;
+
+        auto provider = new prv::ProcessProvider(processId);
+        if (!provider->isAvailable()) {
+            View::showErrorPopup("Failed to open process! Reading another process' memory requires the same permissions as debugging it.");
+            delete provider;
+            return;
+        }
+
+        ImHexApi::Provider::add(provider);
+
+        this->getWindowOpenState() = true;
+
+        View::postEvent(Events::DataChanged);
+        View::postEvent(Events::PatternChanged);
+    }
+
+    void ViewHexEditor::drawOpenProcessPopup() {
+        if (ImGui::BeginPopup("Open Process")) {
+            ImGui::TextUnformatted("Process ID");
+            ImGui::InputScalar("##nolabel", ImGuiDataType_U32, &this->m_processId);
+
+            if (ImGui::Button("Open") || ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Enter))) {
+                ImGui::CloseCurrentPopup();
+                this->openProcess(this->m_processId);
+            }
+
+            ImGui::EndPopup();
+        }
+    }
+
+    void ViewHexEditor::connectGDB(const std::string &host, u16 port, u64 size) {
+        if (!this->canChangeProvider())
+            return;
+
+        auto provider = new prv::GDBProvider(host, port, size);
+        if (!provider->isAvailable()) {
+            View::showErrorPopup("Failed to connect to GDB server!");
+            delete provider;
+            return;
+        }
+
+        ImHexApi::Provider::add(provider);
+
+        this->getWindowOpenState() = true;
+
+        View::postEvent(Events::DataChanged);
+        View::postEvent(Events::PatternChanged);
+    }
+
+    void ViewHexEditor::drawConnectGDBPopup() {
+        if (ImGui::BeginPopup("Connect to GDB Server")) {
+            ImGui::InputText("Host", this->m_gdbHostBuffer, sizeof(this->m_gdbHostBuffer));
+            ImGui::InputScalar("Port", ImGuiDataType_U16, &this->m_gdbPort);
+            ImGui::InputScalar("Size", ImGuiDataType_U64, &this->m_gdbAddressSpaceSize, nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+
+            if (ImGui::Button("Connect") || ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Enter))) {
+                ImGui::CloseCurrentPopup();
+                this->connectGDB(this->m_gdbHostBuffer, this->m_gdbPort, this->m_gdbAddressSpaceSize);
+            }
+
+            ImGui::EndPopup();
+        }
+    }
+
     bool ViewHexEditor::saveToFile(std::string path, const std::vector<u8>& data) {
         FILE *file = fopen(path.c_str(), "wb");
 
@@ -552,405 +1594,845 @@ namespace hex {
         fread(data.data(), 1, data.size(), file);
         fclose(file);
 
-        return true;
-    }
+        return true;
+    }
+
+    void ViewHexEditor::copySelection(SelectionFormatter::Format format) {
+        auto provider = SharedData::currentProvider;
+
+        size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+        size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+
+        size_t copySize = (end - start) + 1;
+
+        std::vector<u8> buffer(copySize, 0x00);
+        provider->read(start, buffer.data(), buffer.size());
+
+        auto str = SelectionFormatter::format(format, start, buffer);
+
+        ImGui::SetClipboardText(str.c_str());
+    }
+
+    void ViewHexEditor::modifySelection(const std::function<void(u8 *data, size_t size)> &operation) {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isWritable() || this->m_memoryEditor.ReadOnly)
+            return;
+
+        if (this->m_memoryEditor.DataPreviewAddr == -1 || this->m_memoryEditor.DataPreviewAddrEnd == -1)
+            return;
+
+        size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+        size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+
+        std::vector<u8> buffer(end - start + 1, 0x00);
+        provider->read(start, buffer.data(), buffer.size());
+
+        operation(buffer.data(), buffer.size());
+
+        // Written back as one patch, so the whole operation is a single undo step and a single event
+        provider->write(start, buffer.data(), buffer.size());
+
+        View::postEvent(Events::DataChanged, Region { prv::Provider::PageSize * provider->getCurrentPage() + start, buffer.size() });
+        ProjectFile::markDirty();
+    }
+
+    void ViewHexEditor::pasteClipboard() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isWritable() || this->m_memoryEditor.ReadOnly)
+            return;
+
+        if (this->m_memoryEditor.DataPreviewAddr == -1 || this->m_memoryEditor.DataPreviewAddrEnd == -1)
+            return;
+
+        auto clipboard = ImGui::GetClipboardText();
+        auto bytes = parseHexBytes(clipboard == nullptr ? "" : clipboard);
+        if (!bytes.has_value() || bytes->empty()) {
+            View::showErrorPopup("The clipboard doesn't contain any hex bytes to paste!");
+            return;
+        }
+
+        // A single selected byte is only where pasting starts, larger selections limit how much gets pasted
+        size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+        size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+        if (start == end)
+            end = provider->getSize() - 1;
+
+        bytes->resize(std::min<size_t>(bytes->size(), end - start + 1));
+
+        provider->write(start, bytes->data(), bytes->size());
+
+        View::postEvent(Events::DataChanged, Region { prv::Provider::PageSize * provider->getCurrentPage() + start, bytes->size() });
+        ProjectFile::markDirty();
+    }
+
+    void ViewHexEditor::drawModifySelectionPopup() {
+        constexpr static std::array Operations = { "Fill with pattern", "XOR with key", "Add key", "Subtract key" };
+
+        if (ImGui::BeginPopupModal("Modify selection", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+            ImGui::Combo("Operation", &this->m_selectionOperation, Operations.data(), Operations.size());
+            ImGui::InputText(this->m_selectionOperation == 0 ? "Pattern" : "Key", this->m_selectionOperationBuffer, sizeof(this->m_selectionOperationBuffer));
+            ImGui::TextDisabled("Hex bytes, repeated over the whole selection");
+            ImGui::NewLine();
+
+            confirmButtons("Apply", "Cancel",
+            [this]{
+                auto bytes = parseHexBytes(this->m_selectionOperationBuffer);
+                if (!bytes.has_value() || bytes->empty()) {
+                    View::showErrorPopup("Invalid hex bytes!");
+                    return;
+                }
+
+                switch (this->m_selectionOperation) {
+                    case 0: this->modifySelection([&](u8 *data, size_t size) { fillWithPattern(data, size, *bytes); }); break;
+                    case 1: this->modifySelection([&](u8 *data, size_t size) { combineWithKey(data, size, *bytes, KeyOperation::Xor); }); break;
+                    case 2: this->modifySelection([&](u8 *data, size_t size) { combineWithKey(data, size, *bytes, KeyOperation::Add); }); break;
+                    case 3: this->modifySelection([&](u8 *data, size_t size) { combineWithKey(data, size, *bytes, KeyOperation::Subtract); }); break;
+                }
+
+                ImGui::CloseCurrentPopup();
+            }, []{
+                ImGui::CloseCurrentPopup();
+            });
+
+            if (ImGui::IsKeyDown(ImGui::GetKeyIndex(ImGuiKey_Escape)))
+                ImGui::CloseCurrentPopup();
+
+            ImGui::EndPopup();
+        }
+    }
+
+    void ViewHexEditor::exportSelection(SelectionFormatter::Format format) {
+        if (this->isExportingSelection())
+            return;
+
+        auto provider = SharedData::currentProvider;
+
+        size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+        size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+
+        // The selection is exported as it was when it got chosen, edits made while the file dialog is open or the export is running don't show up
+        const u64 offset = prv::Provider::PageSize * provider->getCurrentPage() + start;
+        const u64 size = (end - start) + 1;
+
+        View::openFileBrowser("Export Selection", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, "*.*", [this, format, snapshot = provider->createSnapshot(), offset, size, start](auto path) {
+            auto succeeded = std::make_shared<bool>(false);
+
+            this->m_exportTask = TaskManager::submit("Exporting selection", [format, snapshot, offset, size, start, path, succeeded](Task &task) {
+                *succeeded = SelectionFormatter::exportToFile(path, format, snapshot, offset, size, start, task);
+            }, [this, succeeded] {
+                if (!*succeeded && !this->m_exportTask->isCancelled())
+                    View::showErrorPopup("Failed to export selection!");
+            });
+
+            View::doLater([]{ ImGui::OpenPopup("Exporting Selection"); });
+        });
+    }
+
+    void ViewHexEditor::drawExportSelectionPopup() {
+        if (ImGui::BeginPopupModal("Exporting Selection", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+            ImGui::TextUnformatted("Exporting selection...");
+            ImGui::ProgressBar(this->m_exportTask != nullptr ? this->m_exportTask->getProgress() : 1.0F, ImVec2(300, 0));
+
+            if (ImGui::Button("Cancel") && this->m_exportTask != nullptr)
+                this->m_exportTask->cancel();
+
+            if (!this->isExportingSelection())
+                ImGui::CloseCurrentPopup();
+
+            ImGui::EndPopup();
+        }
+    }
+
+    bool ViewHexEditor::isExportingSelection() const {
+        return this->m_exportTask != nullptr && !this->m_exportTask->isFinished();
+    }
+
+    constexpr static size_t SearchBufferSize = 0x100'0000;
+
+    // Finds all occurrences of the pattern, including overlapping ones, inside the given sorted page relative ranges. Matches are handed out one read at a time
+    static void findBytes(prv::Provider *provider, const ByteSearcher &searcher, const std::vector<std::pair<u64, u64>> &ranges, Task &task, const std::function<void(std::vector<std::pair<u64, u64>>&&)> &onMatches) {
+        if (searcher.empty())
+            return;
+
+        const size_t patternSize = searcher.getSize();
+
+        u64 totalSize = 0, searchedSize = 0;
+        for (const auto &[start, end] : ranges)
+            totalSize += end - start;
+
+        // Consecutive reads overlap by one byte less than the pattern so matches crossing a read boundary are found exactly once
+        std::vector<u8> buffer(std::max<size_t>(SearchBufferSize, patternSize), 0x00);
+        const u64 pageOffset = prv::Provider::PageSize * provider->getCurrentPage();
+        for (const auto &[start, end] : ranges) {
+            // Candidate ranges found by the search index are small, only scans over larger ranges are worth keeping out of the caches
+            const bool scan = end - start >= SearchBufferSize;
+            if (scan)
+                provider->hintAccess(pageOffset + start, end - start, prv::AccessHint::Sequential);
+
+            for (u64 offset = start; offset + patternSize <= end && !task.isCancelled(); offset += buffer.size() - (patternSize - 1)) {
+                size_t usedBufferSize = std::min(u64(buffer.size()), end - offset);
+                provider->read(offset, buffer.data(), usedBufferSize);
+
+                std::vector<std::pair<u64, u64>> matches;
+                for (size_t i = searcher.find(buffer.data(), usedBufferSize); i < usedBufferSize; ) {
+                    matches.emplace_back(offset + i, offset + i + patternSize);
+
+                    i++;
+                    i += searcher.find(buffer.data() + i, usedBufferSize - i);
+                }
+
+                if (!matches.empty())
+                    onMatches(std::move(matches));
+
+                task.setProgress(float(searchedSize + (offset - start) + usedBufferSize) / totalSize);
+
+                if (usedBufferSize < buffer.size())
+                    break;
+            }
+
+            if (scan)
+                provider->hintAccess(pageOffset + start, end - start, prv::AccessHint::DontNeed);
+
+            searchedSize += end - start;
+        }
+    }
+
+    // Finds the start of every occurrence of the pattern that lies within [start, end) of the snapshot, sorted by address. Slices are searched on all workers
+    // and overlap by one byte less than the pattern, matches are only taken from the slice they start in. Returns nothing if the task got cancelled or a read failed
+    static std::optional<std::vector<u64>> findAllBytes(const prv::Snapshot &snapshot, const ByteSearcher &searcher, u64 start, u64 end, Task &task) {
+        const size_t patternSize = searcher.getSize();
+        if (searcher.empty() || end - start < patternSize)
+            return std::vector<u64>();
+
+        const size_t sliceCount = (end - start + SearchBufferSize - 1) / SearchBufferSize;
+
+        std::vector<std::vector<u64>> sliceMatches(sliceCount);
+        std::atomic<size_t> doneSlices = 0;
+        std::atomic<bool> readFailed = false;
+
+        snapshot.hintAccess(start, end - start, prv::AccessHint::Sequential);
+
+        TaskManager::parallelFor<std::vector<u8>>(task, sliceCount, [&](size_t slice, std::vector<u8> &buffer) {
+            if (readFailed)
+                return;
 
-    void ViewHexEditor::copyBytes() {
-        auto provider = SharedData::currentProvider;
+            buffer.resize(SearchBufferSize + patternSize - 1);
 
-        size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
-        size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+            const u64 sliceStart = start + slice * SearchBufferSize;
+            const size_t readSize = std::min<u64>(buffer.size(), end - sliceStart);
 
-        size_t copySize = (end - start) + 1;
+            if (readSize < patternSize)
+                return;
 
-        std::vector<u8> buffer(copySize, 0x00);
-        provider->read(start, buffer.data(), buffer.size());
+            if (!snapshot.read(sliceStart, buffer.data(), readSize)) {
+                readFailed = true;
+                return;
+            }
 
-        std::string str;
-        for (const auto &byte : buffer)
-            str += hex::format("%02X ", byte);
-        str.pop_back();
+            const size_t ownSize = std::min<u64>(SearchBufferSize, end - sliceStart);
+            auto &matches = sliceMatches[slice];
+            for (size_t j = searcher.find(buffer.data(), readSize); j < ownSize; ) {
+                matches.push_back(sliceStart + j);
 
-        ImGui::SetClipboardText(str.c_str());
-    }
+                j++;
+                j += searcher.find(buffer.data() + j, readSize - j);
+            }
 
-    void ViewHexEditor::copyString() {
-        auto provider = SharedData::currentProvider;
+            task.setProgress(float(++doneSlices) / sliceCount);
+        });
 
-        size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
-        size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+        snapshot.hintAccess(start, end - start, prv::AccessHint::DontNeed);
 
-        size_t copySize = (end - start) + 1;
+        if (readFailed || task.isCancelled())
+            return std::nullopt;
 
-        std::string buffer(copySize, 0x00);
-        buffer.reserve(copySize + 1);
-        provider->read(start, buffer.data(), copySize);
+        std::vector<u64> result;
+        for (const auto &matches : sliceMatches)
+            result.insert(result.end(), matches.begin(), matches.end());
 
-        ImGui::SetClipboardText(buffer.c_str());
+        return result;
     }
 
-    void ViewHexEditor::copyLanguageArray(Language language) {
-        auto provider = SharedData::currentProvider;
+    // Returns the page relative ranges that need to be searched. Without a usable index that's the entire page
+    static std::vector<std::pair<u64, u64>> getSearchRanges(prv::Provider *provider, const ByteSearcher &searcher, const std::shared_ptr<SearchIndex> &index, const std::vector<std::pair<u64, u64>> &patchedRanges) {
+        const u64 pageAddress = prv::Provider::PageSize * provider->getCurrentPage();
+        const u64 pageSize = provider->getSize();
 
-        size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
-        size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+        if (index == nullptr || index->getDataSize() != provider->getActualSize() || searcher.isMasked() || !SearchIndex::canFilter(searcher.getSize()))
+            return { { 0, pageSize } };
 
-        size_t copySize = (end - start) + 1;
+        auto ranges = index->getCandidateRanges(searcher.getPattern(), pageAddress, pageAddress + pageSize);
 
-        std::vector<u8> buffer(copySize, 0x00);
-        provider->read(start, buffer.data(), buffer.size());
+        // Patched bytes aren't indexed, so everything a match touching them could cover gets searched as well
+        const u64 margin = searcher.getSize() - 1;
+        for (const auto &[address, size] : patchedRanges) {
+            const u64 start = std::max(pageAddress, address - std::min(address, margin));
+            const u64 end   = std::min(pageAddress + pageSize, address + size + margin);
+
+            if (start < end)
+                ranges.emplace_back(start, end);
+        }
 
-        std::string str;
-        switch (language) {
-            case Language::C:
-                str += "const unsigned char data[" + std::to_string(buffer.size()) + "] = { ";
+        std::sort(ranges.begin(), ranges.end());
 
-                for (const auto &byte : buffer)
-                    str += hex::format("0x%02X, ", byte);
+        std::vector<std::pair<u64, u64>> result;
+        for (const auto &[start, end] : ranges) {
+            if (!result.empty() && start <= result.back().second)
+                result.back().second = std::max(result.back().second, end);
+            else
+                result.emplace_back(start, end);
+        }
+
+        for (auto &[start, end] : result) {
+            start -= pageAddress;
+            end   -= pageAddress;
+        }
 
-                // Remove trailing comma
-                str.pop_back();
-                str.pop_back();
+        return result;
+    }
 
-                str += " };";
-                break;
-            case Language::Cpp:
-                str += "constexpr std::array<unsigned char, " + std::to_string(buffer.size()) + "> data = { ";
+    static ByteSearcher parseString(std::string string) {
+        return ByteSearcher(std::vector<u8>(string.begin(), string.end()));
+    }
 
-                for (const auto &byte : buffer)
-                    str += hex::format("0x%02X, ", byte);
+    static ByteSearcher parseHex(std::string string) {
+        if ((string.size() % 2) == 1)
+            string = "0" + string;
 
-                // Remove trailing comma
-                str.pop_back();
-                str.pop_back();
+        std::vector<u8> hex;
+        hex.reserve(string.size() / 2);
 
-                str += " };";
-                break;
-            case Language::Java:
-                str += "final byte[] data = { ";
+        for (u32 i = 0; i < string.size(); i += 2) {
+            char byte[3] = { string[i], string[i + 1], 0 };
+            hex.push_back(strtoul(byte, nullptr, 16));
+        }
 
-                for (const auto &byte : buffer)
-                    str += hex::format("0x%02X, ", byte);
+        return ByteSearcher(std::move(hex));
+    }
 
-                // Remove trailing comma
-                str.pop_back();
-                str.pop_back();
+    static ByteSearcher parsePattern(std::string string) {
+        return ByteSearcher::parse(string).value_or(ByteSearcher());
+    }
 
-                str += " };";
-                break;
-            case Language::CSharp:
-                str += "const byte[] data = { ";
 
-                for (const auto &byte : buffer)
-                    str += hex::format("0x%02X, ", byte);
+    void ViewHexEditor::startSearch(const char *input) {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || this->m_searchFunction == nullptr || !provider->isReadable())
+            return;
 
-                // Remove trailing comma
-                str.pop_back();
-                str.pop_back();
+        if (this->m_searchTask != nullptr)
+            this->m_searchTask->cancel();
 
-                str += " };";
-                break;
-            case Language::Rust:
-                str += "let data: [u8, " + std::to_string(buffer.size()) + "] = [ ";
+        // The previous search keeps writing into its own results until it notices the cancellation
+        auto results = std::make_shared<SearchResults>();
+        *this->m_lastSearchBuffer = results;
+        this->m_lastSearchIndex = 0;
+        this->m_pendingSearchJump = results;
 
-                for (const auto &byte : buffer)
-                    str += hex::format("0x%02X, ", byte);
+        // The index covers the raw data, once bytes got inserted or removed it doesn't line up with the data that's searched anymore
+        auto index = provider->hasStructuralEdits() ? nullptr : this->m_searchIndex;
 
-                // Remove trailing comma
-                str.pop_back();
-                str.pop_back();
+        // The patch store may only be accessed from here, the search task gets a snapshot of the patched ranges
+        std::vector<std::pair<u64, u64>> patchedRanges;
+        if (index != nullptr) {
+            for (const auto &[address, patch] : provider->getPatches().getRuns())
+                patchedRanges.emplace_back(address, patch.size());
+        }
 
-                str += " ];";
-                break;
-            case Language::Python:
-                str += "data = bytes([ ";
+        this->m_searchTask = TaskManager::submit("Searching", TaskPriority::Interactive, provider, [provider, results, searcher = this->m_searchFunction(input), index, patchedRanges = std::move(patchedRanges)](Task &task) {
+            findBytes(provider, searcher, getSearchRanges(provider, searcher, index, patchedRanges), task, [&results](std::vector<std::pair<u64, u64>> &&matches) {
+                std::scoped_lock lock(results->mutex);
+                results->matches.insert(results->matches.end(), matches.begin(), matches.end());
+            });
+        });
+    }
 
-                for (const auto &byte : buffer)
-                    str += hex::format("0x%02X, ", byte);
+    // Signature lists contain one hex pattern per line, optionally preceded by a name and a colon. Lines starting with # are comments
+    static std::optional<std::pair<std::vector<std::string>, std::vector<std::vector<u8>>>> parseSignatures(const std::string &list, std::string &error) {
+        std::vector<std::string> names;
+        std::vector<std::vector<u8>> patterns;
 
-                // Remove trailing comma
-                str.pop_back();
-                str.pop_back();
+        u32 lineNumber = 0;
+        for (auto &line : hex::splitString(list, "\n")) {
+            lineNumber++;
 
-                str += " ]);";
-                break;
-            case Language::JavaScript:
-                str += "const data = new Uint8Array([ ";
+            auto firstCharacter = line.find_first_not_of(" \t\r");
+            if (firstCharacter == std::string::npos || line[firstCharacter] == '#')
+                continue;
 
-                for (const auto &byte : buffer)
-                    str += hex::format("0x%02X, ", byte);
+            std::string name, bytes = line;
+            if (auto separator = line.find(':'); separator != std::string::npos) {
+                name  = line.substr(firstCharacter, separator - firstCharacter);
+                bytes = line.substr(separator + 1);
+            }
 
-                // Remove trailing comma
-                str.pop_back();
-                str.pop_back();
+            auto searcher = ByteSearcher::parse(bytes);
+            if (bytes.find('?') != std::string::npos || !searcher.has_value()) {
+                error = hex::format("Invalid signature on line %u!", lineNumber);
+                return { };
+            }
 
-                str += " ]);";
-                break;
+            names.push_back(name.empty() ? bytes.substr(bytes.find_first_not_of(' ')) : name);
+            patterns.push_back(searcher->getPattern());
         }
 
-        ImGui::SetClipboardText(str.c_str());
+        return std::make_pair(std::move(names), std::move(patterns));
     }
 
-    void ViewHexEditor::copyHexView() {
+    void ViewHexEditor::startReplaceAll(const char *input, const char *replacement) {
         auto provider = SharedData::currentProvider;
+        if (provider == nullptr || this->m_searchFunction == nullptr || !provider->isWritable() || this->m_memoryEditor.ReadOnly)
+            return;
 
-        size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
-        size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+        auto searcher = this->m_searchFunction(input);
+        auto replacementBytes = this->m_searchFunction(replacement).getPattern();
 
-        size_t copySize = (end - start) + 1;
+        if (searcher.empty())
+            return;
 
-        std::vector<u8> buffer(copySize, 0x00);
-        provider->read(start, buffer.data(), buffer.size());
+        if (replacementBytes.size() != searcher.getSize()) {
+            View::showErrorPopup("The replacement has to be exactly as long as what's searched for!");
+            return;
+        }
 
-        std::string str = "Hex View  00 01 02 03 04 05 06 07  08 09 0A 0B 0C 0D 0E 0F\n\n";
+        if (this->m_searchTask != nullptr)
+            this->m_searchTask->cancel();
 
+        const u64 pageAddress = prv::Provider::PageSize * provider->getCurrentPage();
+        const u64 pageSize = provider->getSize();
 
-        for (u32 col = start >> 4; col <= (end >> 4); col++) {
-            str += hex::format("%08lX  ", col << 4);
-            for (u64 i = 0 ; i < 16; i++) {
+        auto snapshot = provider->createSnapshot();
+        auto matches = std::make_shared<std::optional<std::vector<u64>>>();
 
-                if (col == (start >> 4) && i < (start & 0xF) || col == (end >> 4) && i > (end & 0xF))
-                    str += "   ";
-                else
-                    str += hex::format("%02lX ", buffer[((col << 4) - start) + i]);
+        this->m_searchTask = TaskManager::submit("Replacing", TaskPriority::Interactive, provider, [snapshot, searcher, pageAddress, pageSize, matches](Task &task) {
+            *matches = findAllBytes(snapshot, searcher, pageAddress, pageAddress + pageSize, task);
+        }, [this, provider, snapshot, matches, replacement = std::move(replacementBytes)] {
+            if (!matches->has_value())
+                return;
 
-                if ((i & 0xF) == 0x7)
-                    str += " ";
+            // The matches are only valid for the data they were found in
+            if (provider != SharedData::currentProvider || provider->getDataGeneration(false) != snapshot.getDataGeneration() + snapshot.getPatchGeneration()) {
+                View::showErrorPopup("The data changed while searching, nothing was replaced!");
+                return;
             }
 
-            str += " ";
+            // Overlapping matches can't all be replaced, the earlier one wins. Back to back matches end up in the same run
+            std::vector<prv::PatchStore::Run> runs;
+            u64 lastEnd = 0;
+            for (u64 address : **matches) {
+                if (!runs.empty() && address < lastEnd)
+                    continue;
 
-            for (u64 i = 0 ; i < 16; i++) {
+                if (!runs.empty() && address == lastEnd)
+                    runs.back().second.insert(runs.back().second.end(), replacement.begin(), replacement.end());
+                else
+                    runs.emplace_back(address, replacement);
 
-                if (col == (start >> 4) && i < (start & 0xF) || col == (end >> 4) && i > (end & 0xF))
-                    str += " ";
-                else {
-                    u8 c = buffer[((col << 4) - start) + i];
-                    char displayChar = (c < 32 || c >= 128) ? '.' : c;
-                    str += hex::format("%c", displayChar);
-                }
+                lastEnd = address + replacement.size();
+            }
+
+            if (runs.empty()) {
+                View::showErrorPopup("No matches found, nothing was replaced.");
+                return;
             }
 
-            str += "\n";
+            const u64 start = runs.front().first;
+            provider->writeRuns(runs);
+
+            View::postEvent(Events::DataChanged, Region { start, lastEnd - start });
+            ProjectFile::markDirty();
+        });
+    }
+
+    void ViewHexEditor::startSignatureSearch() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isReadable())
+            return;
+
+        std::string error;
+        auto signatures = parseSignatures(this->m_searchSignaturesBuffer, error);
+        if (!signatures.has_value()) {
+            View::showErrorPopup(error);
+            return;
         }
 
+        if (this->m_searchTask != nullptr)
+            this->m_searchTask->cancel();
+
+        auto results = std::make_shared<SearchResults>();
+        results->patternNames = std::move(signatures->first);
+        this->m_lastSignatureSearch = results;
+        this->m_lastSearchIndex = 0;
+        this->m_pendingSearchJump = results;
+
+        // All signatures get matched in one pass over the data, the automaton carries partial matches over from one read to the next
+        this->m_searchTask = TaskManager::submit("Searching signatures", TaskPriority::Interactive, provider, [provider, results, searcher = std::make_shared<MultiSearcher>(signatures->second)](Task &task) {
+            std::vector<u8> buffer(SearchBufferSize, 0x00);
+            auto state = MultiSearcher::InitialState;
+
+            const size_t dataSize = provider->getSize();
+            for (u64 offset = 0; offset < dataSize && !task.isCancelled(); offset += buffer.size()) {
+                size_t usedBufferSize = std::min(u64(buffer.size()), dataSize - offset);
+                provider->read(offset, buffer.data(), usedBufferSize);
+
+                std::vector<std::pair<u64, u64>> matches;
+                std::vector<u32> patternIndices;
+                state = searcher->search(buffer.data(), usedBufferSize, offset, state, [&](size_t patternIndex, u64 address) {
+                    matches.emplace_back(address, address + searcher->getPatternSize(patternIndex));
+                    patternIndices.push_back(patternIndex);
+                });
+
+                if (!matches.empty()) {
+                    std::scoped_lock lock(results->mutex);
+                    results->matches.insert(results->matches.end(), matches.begin(), matches.end());
+                    results->patternIndices.insert(results->patternIndices.end(), patternIndices.begin(), patternIndices.end());
+                }
 
-        ImGui::SetClipboardText(str.c_str());
+                task.setProgress(float(offset + usedBufferSize) / dataSize);
+            }
+        });
     }
 
-    void ViewHexEditor::copyHexViewHTML() {
+    void ViewHexEditor::startRegexSearch() {
         auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isReadable())
+            return;
 
-        size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
-        size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+        std::optional<RegexSearcher> searcher;
+        try {
+            searcher.emplace(this->m_searchRegexBuffer);
+        } catch (std::invalid_argument &e) {
+            View::showErrorPopup(hex::format("Invalid regex: %s", e.what()));
+            return;
+        }
 
-        size_t copySize = (end - start) + 1;
+        if (this->m_searchTask != nullptr)
+            this->m_searchTask->cancel();
 
-        std::vector<u8> buffer(copySize, 0x00);
-        provider->read(start, buffer.data(), buffer.size());
+        auto results = std::make_shared<SearchResults>();
+        this->m_lastRegexSearch = results;
+        this->m_lastSearchIndex = 0;
+        this->m_pendingSearchJump = results;
+
+        this->m_searchTask = TaskManager::submit("Searching regex", TaskPriority::Interactive, provider, [provider, results, searcher = std::move(*searcher)](Task &task) mutable {
+            const size_t dataSize = provider->getSize();
 
-        std::string str =
-R"(
-<div>
-    <style type="text/css">
-        .offsetheader { color:#0000A0; line-height:200% }
-        .offsetcolumn { color:#0000A0 }
-        .hexcolumn { color:#000000 }
-        .textcolumn { color:#000000 }
-    </style>
+            searcher.findAll(dataSize, [&](u64 address, u8 *buffer, size_t size) {
+                provider->read(address, buffer, size);
+                task.setProgress(float(address + size) / dataSize);
+
+                return !task.isCancelled();
+            }, [&results](u64 start, u64 end) {
+                std::scoped_lock lock(results->mutex);
+                results->matches.emplace_back(start, end);
+            });
+        });
+    }
 
-    <code>
-        <span class="offsetheader">Hex View&nbsp&nbsp00 01 02 03 04 05 06 07&nbsp 08 09 0A 0B 0C 0D 0E 0F</span><br/>
-)";
+    bool ViewHexEditor::isSearching() const {
+        return this->m_searchTask != nullptr && !this->m_searchTask->isFinished();
+    }
 
+    // Identifies the data an index was built from, indexes of files that were modified since then can't be used anymore
+    static std::optional<u64> getIndexedDataVersion(prv::Provider *provider) {
+        auto fileProvider = dynamic_cast<prv::FileProvider*>(provider);
+        if (fileProvider == nullptr)
+            return std::nullopt;
 
-        for (u32 col = start >> 4; col <= (end >> 4); col++) {
-            str += hex::format("        <span class=\"offsetcolumn\">%08lX</span>&nbsp&nbsp<span class=\"hexcolumn\">", col << 4);
-            for (u64 i = 0 ; i < 16; i++) {
+        std::error_code error;
+        auto lastWriteTime = std::filesystem::last_write_time(fileProvider->getPath(), error);
+        if (error)
+            return std::nullopt;
 
-                if (col == (start >> 4) && i < (start & 0xF) || col == (end >> 4) && i > (end & 0xF))
-                    str += "&nbsp&nbsp ";
-                else
-                    str += hex::format("%02lX ", buffer[((col << 4) - start) + i]);
+        return u64(lastWriteTime.time_since_epoch().count());
+    }
 
-                if ((i & 0xF) == 0x7)
-                    str += "&nbsp";
-            }
+    static std::string getSearchIndexPath(const std::string &projectFilePath) {
+        return std::filesystem::path(projectFilePath).replace_extension(".hexidx").string();
+    }
 
-            str += "</span>&nbsp&nbsp<span class=\"textcolumn\">";
+    // The index doesn't depend on any parameters, its sizes are checked when loading it
+    constexpr static auto SearchIndexCacheKey = "SearchIndex";
 
-            for (u64 i = 0 ; i < 16; i++) {
+    void ViewHexEditor::buildSearchIndex() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isReadable())
+            return;
 
-                if (col == (start >> 4) && i < (start & 0xF) || col == (end >> 4) && i > (end & 0xF))
-                    str += "&nbsp";
-                else {
-                    u8 c = buffer[((col << 4) - start) + i];
-                    char displayChar = (c < 32 || c >= 128) ? '.' : c;
-                    str += hex::format("%c", displayChar);
-                }
-            }
+        // Indexes take up a quarter of the data's size, so they're only restored once one is asked for
+        const auto fingerprint = PersistentAnalysisCache::getFingerprint(provider);
+        if (this->m_searchIndex == nullptr && fingerprint.has_value()) {
+            if (auto entry = PersistentAnalysisCache::load(*fingerprint, SearchIndexCacheKey); entry != nullptr)
+                this->m_searchIndex = SearchIndex::load(*entry, provider->getRawSize());
 
-            str += "</span><br/>\n";
+            if (this->m_searchIndex != nullptr && this->m_searchIndex->isComplete())
+                return;
         }
 
-        str +=
-R"(
-    </code>
-</div>
-)";
+        if (this->m_searchIndex == nullptr || this->m_searchIndex->getDataSize() != provider->getRawSize())
+            this->m_searchIndex = std::make_shared<SearchIndex>(provider->getRawSize());
 
+        // A running build doesn't revisit blocks it already passed, so it gets restarted to pick up newly invalidated ones
+        if (this->m_searchIndexTask != nullptr)
+            this->m_searchIndexTask->cancel();
 
-        ImGui::SetClipboardText(str.c_str());
+        // Only the unpatched data gets indexed, so edits don't change what the index belongs to
+        this->m_searchIndexTask = TaskManager::submit("Building search index", TaskPriority::Background, provider, [provider, index = this->m_searchIndex, fingerprint](Task &task) {
+            index->build(provider, task);
+
+            if (!fingerprint.has_value() || !index->isComplete())
+                return;
+
+            PersistentAnalysisCache::Writer writer;
+            index->store(writer);
+            PersistentAnalysisCache::store(*fingerprint, SearchIndexCacheKey, std::move(writer));
+        });
     }
 
-    static std::vector<std::pair<u64, u64>> findString(prv::Provider* &provider, std::string string) {
-        std::vector<std::pair<u64, u64>> results;
+    void ViewHexEditor::storeSearchIndex() {
+        if (this->m_searchIndex == nullptr || ProjectFile::getProjectFilePath().empty())
+            return;
 
-        u32 foundCharacters = 0;
+        auto dataVersion = getIndexedDataVersion(SharedData::currentProvider);
+        if (!dataVersion.has_value())
+            return;
 
-        std::vector<u8> buffer(1024, 0x00);
-        size_t dataSize = provider->getSize();
-        for (u64 offset = 0; offset < dataSize; offset += 1024) {
-            size_t usedBufferSize = std::min(u64(buffer.size()), dataSize - offset);
-            provider->read(offset, buffer.data(), usedBufferSize);
+        if (!this->m_searchIndex->store(getSearchIndexPath(ProjectFile::getProjectFilePath()), *dataVersion))
+            View::showErrorPopup("Failed to store search index!");
+    }
 
-            for (u64 i = 0; i < usedBufferSize; i++) {
-                if (buffer[i] == string[foundCharacters])
-                    foundCharacters++;
-                else
-                    foundCharacters = 0;
+    void ViewHexEditor::loadSearchIndex() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isAvailable() || ProjectFile::getProjectFilePath().empty())
+            return;
 
-                if (foundCharacters == string.size()) {
-                    results.emplace_back(offset + i - foundCharacters + 1, offset + i + 1);
-                    foundCharacters = 0;
-                }
-            }
-        }
+        auto dataVersion = getIndexedDataVersion(provider);
+        if (!dataVersion.has_value())
+            return;
 
-        return results;
+        // Indexes that don't match the file anymore are silently ignored, a new one can be built from the menu
+        this->m_searchIndex = SearchIndex::load(getSearchIndexPath(ProjectFile::getProjectFilePath()), provider->getRawSize(), *dataVersion);
+
+        if (this->m_searchIndex != nullptr && !this->m_searchIndex->isComplete())
+            this->buildSearchIndex();
     }
 
-    static std::vector<std::pair<u64, u64>> findHex(prv::Provider* &provider, std::string string) {
-        std::vector<std::pair<u64, u64>> results;
+    bool ViewHexEditor::isBuildingSearchIndex() const {
+        return this->m_searchIndexTask != nullptr && !this->m_searchIndexTask->isFinished();
+    }
 
-        if ((string.size() % 2) == 1)
-            string = "0" + string;
+    void ViewHexEditor::gotoSearchResult(s64 index) {
+        auto &results = *this->m_lastSearchBuffer;
+        std::scoped_lock lock(results->mutex);
 
-        std::vector<u8> hex;
-        hex.reserve(string.size() / 2);
+        // Matches are only ever appended, so indices stay valid while the search is still running
+        const s64 matchCount = results->matches.size();
+        if (matchCount == 0)
+            return;
 
-        for (u32 i = 0; i < string.size(); i += 2) {
-            char byte[3] = { string[i], string[i + 1], 0 };
-            hex.push_back(strtoul(byte, nullptr, 16));
+        this->m_lastSearchIndex = ((index % matchCount) + matchCount) % matchCount;
+
+        auto [start, end] = results->matches[this->m_lastSearchIndex];
+        this->m_memoryEditor.GotoAddrAndHighlight(start, end);
+    }
+
+    // Matches end at their last byte. Signature matches are labeled with the name of their signature
+    ResultTable ViewHexEditor::getResultTable(SearchResults &results) {
+        std::scoped_lock lock(results.mutex);
+
+        ResultTable table;
+        for (const auto &name : results.patternNames)
+            table.addLabel(name);
+
+        for (size_t i = 0; i < results.matches.size(); i++) {
+            auto [start, end] = results.matches[i];
+            table.add(start, end - start + 1, i < results.patternIndices.size() ? results.patternIndices[i] : ResultTable::NoLabel);
         }
 
-        u32 foundCharacters = 0;
+        return table;
+    }
+
+    void ViewHexEditor::drawSignatureMatches() {
+        auto &results = *this->m_lastSearchBuffer;
+        std::scoped_lock lock(results->mutex);
 
-        std::vector<u8> buffer(1024, 0x00);
-        size_t dataSize = provider->getSize();
-        for (u64 offset = 0; offset < dataSize; offset += 1024) {
-            size_t usedBufferSize = std::min(u64(buffer.size()), dataSize - offset);
-            provider->read(offset, buffer.data(), usedBufferSize);
+        if (ImGui::BeginChild("##signatureMatches", ImVec2(400, ImGui::GetTextLineHeightWithSpacing() * 10), true)) {
+            ImGuiListClipper clipper;
+            clipper.Begin(results->matches.size());
 
-            for (u64 i = 0; i < usedBufferSize; i++) {
-                if (buffer[i] == hex[foundCharacters])
-                    foundCharacters++;
-                else
-                    foundCharacters = 0;
+            while (clipper.Step()) {
+                for (s64 i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    auto [start, end] = results->matches[i];
+                    auto label = hex::format("0x%08llx : %s##%lld", start, results->patternNames[results->patternIndices[i]].c_str(), i);
 
-                if (foundCharacters == hex.size()) {
-                    results.emplace_back(offset + i - foundCharacters + 1, offset + i + 1);
-                    foundCharacters = 0;
+                    if (ImGui::Selectable(label.c_str(), i == this->m_lastSearchIndex)) {
+                        this->m_lastSearchIndex = i;
+                        this->m_memoryEditor.GotoAddrAndHighlight(start, end);
+                    }
                 }
             }
+            clipper.End();
         }
-
-        return results;
+        ImGui::EndChild();
     }
 
-
     void ViewHexEditor::drawSearchPopup() {
         static auto InputCallback = [](ImGuiInputTextCallbackData* data) -> int {
             auto _this = static_cast<ViewHexEditor*>(data->UserData);
-            auto provider = SharedData::currentProvider;
 
-            *_this->m_lastSearchBuffer = _this->m_searchFunction(provider, data->Buf);
-            _this->m_lastSearchIndex = 0;
-
-            if (_this->m_lastSearchBuffer->size() > 0)
-                _this->m_memoryEditor.GotoAddrAndHighlight((*_this->m_lastSearchBuffer)[0].first, (*_this->m_lastSearchBuffer)[0].second);
+            _this->startSearch(data->Buf);
 
             return 0;
         };
 
-        static auto Find = [this](char *buffer) {
-            auto provider = SharedData::currentProvider;
-
-            *this->m_lastSearchBuffer = this->m_searchFunction(provider, buffer);
-            this->m_lastSearchIndex = 0;
-
-            if (this->m_lastSearchBuffer->size() > 0)
-                this->m_memoryEditor.GotoAddrAndHighlight((*this->m_lastSearchBuffer)[0].first, (*this->m_lastSearchBuffer)[0].second);
-        };
+        // Jump to the first match as soon as the search found it
+        if (auto results = this->m_pendingSearchJump; results != nullptr) {
+            std::scoped_lock lock(results->mutex);
 
-        static auto FindNext = [this]() {
-            if (this->m_lastSearchBuffer->size() > 0) {
-                ++this->m_lastSearchIndex %= this->m_lastSearchBuffer->size();
-                this->m_memoryEditor.GotoAddrAndHighlight((*this->m_lastSearchBuffer)[this->m_lastSearchIndex].first,
-                                                          (*this->m_lastSearchBuffer)[this->m_lastSearchIndex].second);
+            if (!results->matches.empty()) {
+                auto [start, end] = results->matches.front();
+                this->m_memoryEditor.GotoAddrAndHighlight(start, end);
             }
-        };
-
-        static auto FindPrevious = [this]() {
-            if (this->m_lastSearchBuffer->size() > 0) {
-                this->m_lastSearchIndex--;
-
-                if (this->m_lastSearchIndex < 0)
-                    this->m_lastSearchIndex = this->m_lastSearchBuffer->size() - 1;
-
-                this->m_lastSearchIndex %= this->m_lastSearchBuffer->size();
 
-                this->m_memoryEditor.GotoAddrAndHighlight((*this->m_lastSearchBuffer)[this->m_lastSearchIndex].first,
-                                                          (*this->m_lastSearchBuffer)[this->m_lastSearchIndex].second);
-            }
-        };
+            if (!results->matches.empty() || !this->isSearching())
+                this->m_pendingSearchJump.reset();
+        }
 
         if (ImGui::BeginPopupContextVoid("Search")) {
             ImGui::TextUnformatted("Search");
             if (ImGui::BeginTabBar("searchTabs")) {
                 char *currBuffer;
+                char *replaceBuffer = nullptr;
                 if (ImGui::BeginTabItem("String")) {
-                    this->m_searchFunction = findString;
+                    this->m_searchFunction = parseString;
                     this->m_lastSearchBuffer = &this->m_lastStringSearch;
                     currBuffer = this->m_searchStringBuffer;
+                    replaceBuffer = this->m_replaceStringBuffer;
 
                     ImGui::InputText("##nolabel", currBuffer, 0xFFFF, ImGuiInputTextFlags_CallbackCompletion,
                                      InputCallback, this);
+                    ImGui::InputText("Replace##string", replaceBuffer, 0xFFFF);
                     ImGui::EndTabItem();
                 }
 
                 if (ImGui::BeginTabItem("Hex")) {
-                    this->m_searchFunction = findHex;
+                    this->m_searchFunction = parseHex;
                     this->m_lastSearchBuffer = &this->m_lastHexSearch;
                     currBuffer = this->m_searchHexBuffer;
+                    replaceBuffer = this->m_replaceHexBuffer;
 
                     ImGui::InputText("##nolabel", currBuffer, 0xFFFF,
                                      ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_CallbackCompletion,
                                      InputCallback, this);
+                    ImGui::InputText("Replace##hex", replaceBuffer, 0xFFFF, ImGuiInputTextFlags_CharsHexadecimal);
+                    ImGui::EndTabItem();
+                }
+
+                if (ImGui::BeginTabItem("Pattern")) {
+                    this->m_searchFunction = parsePattern;
+                    this->m_lastSearchBuffer = &this->m_lastPatternSearch;
+                    currBuffer = this->m_searchPatternBuffer;
+
+                    ImGui::InputText("##nolabel", currBuffer, 0xFFFF, ImGuiInputTextFlags_CallbackCompletion,
+                                     InputCallback, this);
+                    if (ImGui::IsItemHovered())
+                        ImGui::SetTooltip("Hex bytes, ? matches any nibble. E.g. E8 ?? ?? ?? ?? 48 8B");
+                    ImGui::EndTabItem();
+                }
+
+                bool signatureSearch = false, regexSearch = false;
+                if (ImGui::BeginTabItem("Regex")) {
+                    regexSearch = true;
+                    this->m_lastSearchBuffer = &this->m_lastRegexSearch;
+
+                    ImGui::InputText("##nolabel", this->m_searchRegexBuffer, sizeof(this->m_searchRegexBuffer));
+                    if (ImGui::IsItemHovered())
+                        ImGui::SetTooltip("Byte oriented regex, e.g. MZ.{58}PE\\x00\\x00");
+                    ImGui::EndTabItem();
+                }
+
+                if (ImGui::BeginTabItem("Signatures")) {
+                    signatureSearch = true;
+                    this->m_lastSearchBuffer = &this->m_lastSignatureSearch;
+
+                    ImGui::InputTextMultiline("##nolabel", this->m_searchSignaturesBuffer, sizeof(this->m_searchSignaturesBuffer), ImVec2(0, ImGui::GetTextLineHeight() * 8));
+                    if (ImGui::IsItemHovered())
+                        ImGui::SetTooltip("One signature per line, e.g. \"PNG: 89 50 4E 47 0D 0A 1A 0A\"");
+
+                    if (ImGui::Button("Load")) {
+                        View::openFileBrowser("Load Signatures", imgui_addons::ImGuiFileBrowser::DialogMode::OPEN, "*.*", [this](auto path) {
+                            auto list = hex::readFile(path);
+                            if (list.empty()) {
+                                View::showErrorPopup("Failed to open file!");
+                                return;
+                            }
+
+                            list.resize(std::min(list.size(), sizeof(this->m_searchSignaturesBuffer) - 1));
+                            std::memcpy(this->m_searchSignaturesBuffer, list.data(), list.size());
+                            this->m_searchSignaturesBuffer[list.size()] = 0x00;
+                        });
+                    }
+                    ImGui::SameLine();
+
                     ImGui::EndTabItem();
                 }
 
-                if (ImGui::Button("Find"))
-                    Find(currBuffer);
+                if (ImGui::Button("Find")) {
+                    if (signatureSearch)
+                        this->startSignatureSearch();
+                    else if (regexSearch)
+                        this->startRegexSearch();
+                    else
+                        this->startSearch(currBuffer);
+                }
+
+                if (replaceBuffer != nullptr) {
+                    ImGui::SameLine();
+                    if (ImGui::Button("Replace all") && !this->isSearching())
+                        this->startReplaceAll(currBuffer, replaceBuffer);
+                }
+
+                if (this->isSearching()) {
+                    ImGui::SameLine();
+                    if (ImGui::Button("Cancel"))
+                        this->m_searchTask->cancel();
+
+                    ImGui::SameLine();
+                    ImGui::ProgressBar(this->m_searchTask->getProgress(), ImVec2(100, 0));
+                }
+
+                size_t matchCount;
+                {
+                    std::scoped_lock lock((*this->m_lastSearchBuffer)->mutex);
+                    matchCount = (*this->m_lastSearchBuffer)->matches.size();
+                }
 
-                if (this->m_lastSearchBuffer->size() > 0) {
+                if (matchCount > 0) {
                     if ((ImGui::Button("Find Next")))
-                        FindNext();
+                        this->gotoSearchResult(this->m_lastSearchIndex + 1);
 
                     ImGui::SameLine();
 
                     if ((ImGui::Button("Find Prev")))
-                        FindPrevious();
+                        this->gotoSearchResult(this->m_lastSearchIndex - 1);
+
+                    ImGui::SameLine();
+                    ImGui::Text("%lld / %zu", this->m_lastSearchIndex + 1, matchCount);
+
+                    ImGui::SameLine();
+                    if (ImGui::Button("Export")) {
+                        View::openFileBrowser("Search: Export results", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, ".hexresults", [provider = SharedData::currentProvider, results = *this->m_lastSearchBuffer](auto path) {
+                            if (provider != SharedData::currentProvider)
+                                return;
+
+                            const auto fingerprint = PersistentAnalysisCache::getFingerprint(provider).value_or(PersistentAnalysisCache::Fingerprint { 0, provider->getActualSize() });
+                            if (!getResultTable(*results).exportFile(path, fingerprint))
+                                View::showErrorPopup("Failed to export the search results!");
+                        });
+                    }
+
+                    if (signatureSearch)
+                        this->drawSignatureMatches();
                 }
 
                 ImGui::EndTabBar();
@@ -1012,9 +2494,11 @@ R"(
 
                 if (ImGui::Button("Goto")) {
                     provider->setCurrentPage(std::floor(newOffset / double(prv::Provider::PageSize)));
-                    this->m_memoryEditor.GotoAddr = newOffset;
-                    this->m_memoryEditor.DataPreviewAddr = newOffset;
-                    this->m_memoryEditor.DataPreviewAddrEnd = newOffset;
+
+                    u64 pageAddress = newOffset - prv::Provider::PageSize * provider->getCurrentPage();
+                    this->m_memoryEditor.GotoAddr = pageAddress;
+                    this->m_memoryEditor.DataPreviewAddr = pageAddress;
+                    this->m_memoryEditor.DataPreviewAddrEnd = pageAddress;
                 }
 
                 ImGui::EndTabBar();
@@ -1024,36 +2508,116 @@ R"(
         }
     }
 
+    void ViewHexEditor::undo() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr)
+            return;
+
+        const bool hadStructuralEdits = provider->hasStructuralEdits();
+        auto range = provider->getPatches().getUndoRange();
+        if (!provider->undo())
+            return;
+
+        // Patch ranges address the raw data, which only lines up with the shown data as long as nothing got inserted or removed
+        if (range.has_value() && !hadStructuralEdits && !provider->hasStructuralEdits())
+            View::postEvent(Events::DataChanged, Region { range->first, range->second });
+        else
+            View::postEvent(Events::DataChanged);
+
+        ProjectFile::markDirty();
+    }
+
+    void ViewHexEditor::redo() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr)
+            return;
+
+        const bool hadStructuralEdits = provider->hasStructuralEdits();
+        auto range = provider->getPatches().getRedoRange();
+        if (!provider->redo())
+            return;
+
+        if (range.has_value() && !hadStructuralEdits && !provider->hasStructuralEdits())
+            View::postEvent(Events::DataChanged, Region { range->first, range->second });
+        else
+            View::postEvent(Events::DataChanged);
+
+        ProjectFile::markDirty();
+    }
+
     void ViewHexEditor::drawEditPopup() {
+        auto provider = SharedData::currentProvider;
+
+        if (ImGui::MenuItem("Undo", "CTRL + Z", false, provider != nullptr && provider->canUndo()))
+            this->undo();
+        if (ImGui::MenuItem("Redo", "CTRL + Y", false, provider != nullptr && provider->canRedo()))
+            this->redo();
+
+        ImGui::Separator();
+
         if (ImGui::BeginMenu("Copy as...", this->m_memoryEditor.DataPreviewAddr != -1 && this->m_memoryEditor.DataPreviewAddrEnd != -1)) {
             if (ImGui::MenuItem("Bytes", "CTRL + ALT + C"))
-                this->copyBytes();
+                this->copySelection(SelectionFormatter::Format::Bytes);
             if (ImGui::MenuItem("Hex String", "CTRL + SHIFT + C"))
-                this->copyString();
+                this->copySelection(SelectionFormatter::Format::Raw);
+
+            ImGui::Separator();
+
+            if (ImGui::MenuItem("C Array"))
+                this->copySelection(SelectionFormatter::Format::C);
+            if (ImGui::MenuItem("C++ Array"))
+                this->copySelection(SelectionFormatter::Format::Cpp);
+            if (ImGui::MenuItem("C# Array"))
+                this->copySelection(SelectionFormatter::Format::CSharp);
+            if (ImGui::MenuItem("Rust Array"))
+                this->copySelection(SelectionFormatter::Format::Rust);
+            if (ImGui::MenuItem("Python Array"))
+                this->copySelection(SelectionFormatter::Format::Python);
+            if (ImGui::MenuItem("Java Array"))
+                this->copySelection(SelectionFormatter::Format::Java);
+            if (ImGui::MenuItem("JavaScript Array"))
+                this->copySelection(SelectionFormatter::Format::JavaScript);
+
+            ImGui::Separator();
+
+            if (ImGui::MenuItem("Editor View"))
+                this->copySelection(SelectionFormatter::Format::HexView);
+            if (ImGui::MenuItem("HTML"))
+                this->copySelection(SelectionFormatter::Format::HTML);
+
+            ImGui::EndMenu();
+        }
+
+        // Large selections are written to a file in chunks on a worker thread instead of being built up as one string
+        if (ImGui::BeginMenu("Export as...", this->m_memoryEditor.DataPreviewAddr != -1 && this->m_memoryEditor.DataPreviewAddrEnd != -1 && !this->isExportingSelection())) {
+            if (ImGui::MenuItem("Raw"))
+                this->exportSelection(SelectionFormatter::Format::Raw);
+            if (ImGui::MenuItem("Bytes"))
+                this->exportSelection(SelectionFormatter::Format::Bytes);
 
             ImGui::Separator();
 
             if (ImGui::MenuItem("C Array"))
-                this->copyLanguageArray(Language::C);
+                this->exportSelection(SelectionFormatter::Format::C);
             if (ImGui::MenuItem("C++ Array"))
-                this->copyLanguageArray(Language::Cpp);
+                this->exportSelection(SelectionFormatter::Format::Cpp);
             if (ImGui::MenuItem("C# Array"))
-                this->copyLanguageArray(Language::CSharp);
+                this->exportSelection(SelectionFormatter::Format::CSharp);
             if (ImGui::MenuItem("Rust Array"))
-                this->copyLanguageArray(Language::Rust);
+                this->exportSelection(SelectionFormatter::Format::Rust);
             if (ImGui::MenuItem("Python Array"))
-                this->copyLanguageArray(Language::Python);
+                this->exportSelection(SelectionFormatter::Format::Python);
             if (ImGui::MenuItem("Java Array"))
-                this->copyLanguageArray(Language::Java);
+                this->exportSelection(SelectionFormatter::Format::Java);
             if (ImGui::MenuItem("JavaScript Array"))
-                this->copyLanguageArray(Language::JavaScript);
+                this->exportSelection(SelectionFormatter::Format::JavaScript);
 
             ImGui::Separator();
 
             if (ImGui::MenuItem("Editor View"))
-                this->copyHexView();
+                this->exportSelection(SelectionFormatter::Format::HexView);
             if (ImGui::MenuItem("HTML"))
-                this->copyHexViewHTML();
+                this->exportSelection(SelectionFormatter::Format::HTML);
 
             ImGui::EndMenu();
         }
@@ -1062,10 +2626,53 @@ R"(
             size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
             size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
 
-            ImHexApi::Bookmarks::add(start, end - start + 1, { }, { });
+            ImHexApi::Bookmarks::add(prv::Provider::PageSize * provider->getCurrentPage() + start, end - start + 1, { }, { });
+        }
+
+        const bool hasSelection = this->m_memoryEditor.DataPreviewAddr != -1 && this->m_memoryEditor.DataPreviewAddrEnd != -1;
+        const bool canModify = provider != nullptr && provider->isWritable() && !this->m_memoryEditor.ReadOnly && hasSelection;
+
+        if (ImGui::MenuItem("Paste", "CTRL + V", false, canModify))
+            this->pasteClipboard();
+
+        if (ImGui::BeginMenu("Modify selection", canModify)) {
+            if (ImGui::MenuItem("Fill, XOR or add...")) {
+                std::memset(this->m_selectionOperationBuffer, 0x00, sizeof(this->m_selectionOperationBuffer));
+                View::doLater([]{ ImGui::OpenPopup("Modify selection"); });
+            }
+
+            ImGui::Separator();
+
+            if (ImGui::MenuItem("Reverse"))
+                this->modifySelection([](u8 *data, size_t size) { reverseBytes(data, size); });
+            if (ImGui::MenuItem("Swap 16 bit byte order"))
+                this->modifySelection([](u8 *data, size_t size) { swapByteOrder(data, size, 2); });
+            if (ImGui::MenuItem("Swap 32 bit byte order"))
+                this->modifySelection([](u8 *data, size_t size) { swapByteOrder(data, size, 4); });
+            if (ImGui::MenuItem("Swap 64 bit byte order"))
+                this->modifySelection([](u8 *data, size_t size) { swapByteOrder(data, size, 8); });
+
+            ImGui::EndMenu();
+        }
+
+        // Removed and inserted bytes are kept in memory until the file gets saved
+
+        if (ImGui::MenuItem("Insert bytes...", nullptr, false, canModify)) {
+            std::memset(this->m_insertSizeBuffer, 0x00, sizeof(this->m_insertSizeBuffer));
+            View::doLater([]{ ImGui::OpenPopup("Insert bytes"); });
+        }
+
+        if (ImGui::MenuItem("Remove selection", nullptr, false, canModify)) {
+            size_t start = std::min(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+            size_t end = std::max(this->m_memoryEditor.DataPreviewAddr, this->m_memoryEditor.DataPreviewAddrEnd);
+
+            provider->remove(prv::Provider::PageSize * provider->getCurrentPage() + start, end - start + 1);
+            this->m_memoryEditor.DataPreviewAddr = this->m_memoryEditor.DataPreviewAddrEnd = -1;
+
+            View::postEvent(Events::DataChanged);
+            ProjectFile::markDirty();
         }
 
-        auto provider = SharedData::currentProvider;
         if (ImGui::MenuItem("Set base address", nullptr, false, provider != nullptr && provider->isReadable())) {
             std::memset(this->m_baseAddressBuffer, 0x00, sizeof(this->m_baseAddressBuffer));
             View::doLater([]{ ImGui::OpenPopup("Set base address"); });
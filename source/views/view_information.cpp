@@ -1,133 +1,424 @@
 #include "views/view_information.hpp"
 
+#include <hex/api/imhex_api.hpp>
+#include <hex/api/task.hpp>
 #include <hex/providers/provider.hpp>
+#include <hex/helpers/analysis_cache.hpp>
 #include <hex/helpers/utils.hpp>
 
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include <filesystem>
-#include <span>
 #include <vector>
 
-#include <magic.h>
+#include "helpers/magic.hpp"
 
 namespace hex {
 
     ViewInformation::ViewInformation() : View("Information") {
-        View::subscribeEvent(Events::DataChanged, [this](auto) {
+        this->m_entropyMemory = MemoryBudget::Registration("Entropy analysis", [this] {
+            return this->m_entropy != nullptr ? this->m_entropy->getMemoryUsage() : 0;
+        });
+
+        View::subscribeEvent(Events::DataChanged, [this](auto userData) {
+            // Modifications of a known region only need the parts of the analysis covering it to be redone
+            if (auto region = std::any_cast<Region>(&userData); region != nullptr) {
+                if (this->isAnalyzing())
+                    this->m_pendingUpdates.push_back(*region);
+                else if (this->m_dataValid)
+                    this->updateAnalysis(*region);
+
+                return;
+            }
+
             this->m_dataValid = false;
             this->m_highestBlockEntropy = 0;
-            this->m_blockEntropy.clear();
+            this->m_entropy = nullptr;
             this->m_averageEntropy = 0;
-            this->m_blockSize = 0;
             this->m_valueCounts.fill(0x00);
             this->m_mimeType = "";
             this->m_fileDescription = "";
             this->m_analyzedRegion = { 0, 0 };
+            this->m_regions.clear();
+            this->m_pendingUpdates.clear();
+
+            View::postEvent(Events::EntropyAnalysisChanged, std::shared_ptr<const EntropyPyramid>());
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto userData) {
+            auto previous = std::any_cast<prv::Provider*>(userData);
+
+            if (previous != nullptr && this->m_dataValid && !this->isAnalyzing()) {
+                auto cached = std::make_shared<CachedAnalysis>();
+                cached->entropy = this->m_entropy;
+                cached->analyzedRegion = this->m_analyzedRegion;
+                cached->fileDescription = std::move(this->m_fileDescription);
+                cached->mimeType = std::move(this->m_mimeType);
+
+                AnalysisCache::store(previous, "Information", cached, cached->entropy->getMemoryUsage());
+            }
+
+            for (auto &task : this->m_analysisTasks)
+                task->cancel();
+            this->m_analysisTasks.clear();
+
+            this->m_dataValid = false;
+            this->m_highestBlockEntropy = 0;
+            this->m_entropy = nullptr;
+            this->m_averageEntropy = 0;
+            this->m_valueCounts.fill(0x00);
+            this->m_mimeType = "";
+            this->m_fileDescription = "";
+            this->m_analyzedRegion = { 0, 0 };
+            this->m_regions.clear();
+            this->m_pendingUpdates.clear();
+
+            View::postEvent(Events::EntropyAnalysisChanged, std::shared_ptr<const EntropyPyramid>());
+
+            auto provider = SharedData::currentProvider;
+            if (provider == nullptr)
+                return;
+
+            if (auto cached = AnalysisCache::take<CachedAnalysis>(provider, "Information"); cached != nullptr) {
+                this->m_entropy = std::move(cached->entropy);
+                this->m_entropyViewStart = 0;
+                this->m_entropyViewEnd = this->m_entropy->getDataSize();
+                this->m_analyzedRegion = cached->analyzedRegion;
+                this->m_fileDescription = std::move(cached->fileDescription);
+                this->m_mimeType = std::move(cached->mimeType);
+
+                this->updateStatistics();
+                this->m_dataValid = true;
+            } else {
+                this->loadAnalysis(provider);
+            }
+        });
+
+        View::subscribeEvent(Events::DataFingerprinted, [this](auto userData) {
+            auto provider = std::any_cast<prv::Provider*>(userData);
+
+            if (provider == SharedData::currentProvider && !this->m_dataValid && !this->isAnalyzing())
+                this->loadAnalysis(provider);
         });
     }
 
     ViewInformation::~ViewInformation() {
+        for (auto &task : this->m_analysisTasks)
+            task->cancel();
+
         View::unsubscribeEvent(Events::DataChanged);
+        View::unsubscribeEvent(Events::ProviderChanged);
+        View::unsubscribeEvent(Events::DataFingerprinted);
     }
 
-    static float calculateEntropy(std::array<float, 256> &valueCounts, size_t numBytes) {
-        float entropy = 0;
+    // The plot never shows more blocks than this, the pyramid level is picked accordingly
+    constexpr static u64 PlotResolution = 2048;
+    constexpr static u64 MinimumViewSize = EntropyPyramid::LeafSize * 64;
+    // Regions are made of classified blocks, shorter runs of a different class are considered part of the region around them
+    constexpr static u64 MinimumRegionBlocks = 4;
 
-        for (u16 i = 0; i < 256; i++) {
-            valueCounts[i] /= numBytes;
+    constexpr static auto AnalysisCacheKey = "Information";
 
-            if (valueCounts[i] > 0)
-                entropy -= (valueCounts[i] * std::log2(valueCounts[i]));
-        }
+    // Restores the analysis of the same data from disk. It's stored as the file description, the MIME type and the entropy pyramid
+    bool ViewInformation::loadAnalysis(prv::Provider *provider) {
+        auto fingerprint = PersistentAnalysisCache::getFingerprint(provider);
+        if (!fingerprint.has_value())
+            return false;
 
-        return entropy / 8;
+        auto entry = PersistentAnalysisCache::load(*fingerprint, AnalysisCacheKey);
+        if (entry == nullptr)
+            return false;
+
+        auto entropy = EntropyPyramid::load(*entry, 2, fingerprint->dataSize);
+        if (entropy == nullptr)
+            return false;
+
+        this->m_entropy = std::move(entropy);
+        this->m_entropyViewStart = 0;
+        this->m_entropyViewEnd = this->m_entropy->getDataSize();
+        this->m_analyzedRegion = { 0, this->m_entropy->getDataSize() };
+        this->m_fileDescription = entry->getString(0);
+        this->m_mimeType = entry->getString(1);
+
+        this->updateStatistics();
+        this->m_dataValid = true;
+
+        return true;
     }
 
-    void ViewInformation::drawContent() {
-        if (ImGui::Begin("Data Information", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
-            ImGui::BeginChild("##scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
+    void ViewInformation::storeAnalysis(const PersistentAnalysisCache::Fingerprint &fingerprint) const {
+        PersistentAnalysisCache::Writer writer;
+        writer.add(this->m_fileDescription);
+        writer.add(this->m_mimeType);
+        this->m_entropy->store(writer);
 
-            auto provider = SharedData::currentProvider;
+        PersistentAnalysisCache::store(fingerprint, AnalysisCacheKey, std::move(writer));
+    }
 
-            if (provider != nullptr && provider->isReadable()) {
-                if (this->m_shouldInvalidate) {
+    void ViewInformation::analyze() {
+        auto provider = SharedData::currentProvider;
+
+        for (auto &task : this->m_analysisTasks)
+            task->cancel();
+        this->m_analysisTasks.clear();
+        this->m_pendingUpdates.clear();
+
+        const u64 dataSize = provider->getActualSize();
+        if (dataSize == 0)
+            return;
+
+        struct Analysis {
+            std::shared_ptr<EntropyPyramid> entropy;
+            std::string fileDescription;
+            std::string mimeType;
+            size_t pendingParts = 0;
+        };
+
+        auto analysis = std::make_shared<Analysis>();
+        analysis->entropy = std::make_shared<EntropyPyramid>(dataSize);
+
+        // Only runs once the pyramid and the file type are done, both finish on the main thread so no synchronization is needed
+        auto finishPart = [this, provider, analysis, fingerprint = PersistentAnalysisCache::getFingerprint(provider)] {
+            if (--analysis->pendingParts > 0)
+                return;
+
+            analysis->entropy->aggregate(0, analysis->entropy->getChunkCount());
+
+            // Data modified while the parts were running may have been read before the modification
+            for (const auto &region : this->m_pendingUpdates)
+                analysis->entropy->update(provider, region.address, region.size);
+            this->m_pendingUpdates.clear();
+
+            this->m_analyzedRegion = { 0, provider->getActualSize() };
+
+            this->m_entropy = analysis->entropy;
+            this->m_entropyViewStart = 0;
+            this->m_entropyViewEnd = this->m_entropy->getDataSize();
+            this->m_fileDescription = std::move(analysis->fileDescription);
+            this->m_mimeType = std::move(analysis->mimeType);
+
+            this->updateStatistics();
+            this->m_dataValid = true;
+
+            // Results of data that changed while analyzing don't belong to the fingerprint anymore
+            if (fingerprint.has_value() && PersistentAnalysisCache::getFingerprint(provider) == fingerprint)
+                this->storeAnalysis(*fingerprint);
+        };
+
+        // Every part builds a contiguous range of chunks of the pyramid, the levels above them get aggregated once all are done.
+        // Parts run at about the same rate, so whichever of them set the progress last tells it well enough
+        analysis->pendingParts = 2;
+
+        this->m_analysisTasks.push_back(TaskManager::submit("Analyzing file", provider, [provider, analysis](Task &task) {
+            const u64 chunkCount = analysis->entropy->getChunkCount();
+            const u64 partCount = TaskManager::getParallelism(task, chunkCount);
+
+            TaskManager::parallelFor(task, partCount, [&](size_t part) {
+                analysis->entropy->buildChunks(provider, chunkCount * part / partCount, chunkCount * (part + 1) / partCount, &task);
+            });
+        }, finishPart));
+
+        auto fileType = std::make_shared<std::pair<std::string, std::string>>();
+        this->m_analysisTasks.push_back(TaskManager::submit("Analyzing file type", provider, [provider, fileType](Task &task) {
+            fileType->first  = magic::identify(provider, magic::Format::Description);
+            fileType->second = magic::identify(provider, magic::Format::MIME);
+        }, [analysis, fileType, finishPart] {
+            analysis->fileDescription = std::move(fileType->first);
+            analysis->mimeType = std::move(fileType->second);
+
+            finishPart();
+        }));
+    }
 
-                    this->m_analyzedRegion = { provider->getBaseAddress(), provider->getBaseAddress() + provider->getSize() };
+    void ViewInformation::updateAnalysis(const Region &region) {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || this->m_entropy == nullptr || this->m_entropy->getDataSize() != provider->getActualSize())
+            return;
 
-                    {
-                        this->m_blockSize = std::ceil(provider->getSize() / 2048.0F);
-                        std::vector<u8> buffer(this->m_blockSize, 0x00);
-                        std::memset(this->m_valueCounts.data(), 0x00, this->m_valueCounts.size() * sizeof(u32));
-                        this->m_blockEntropy.clear();
+        this->m_entropy->update(provider, region.address, region.size);
+        this->updateStatistics();
+    }
 
-                        for (u64 i = 0; i < provider->getSize(); i += this->m_blockSize) {
-                            std::array<float, 256> blockValueCounts = { 0 };
-                            provider->read(i, buffer.data(), std::min(u64(this->m_blockSize), provider->getSize() - i));
+    void ViewInformation::updateStatistics() {
+        const u64 dataSize = this->m_entropy->getDataSize();
 
-                            for (size_t j = 0; j < this->m_blockSize; j++) {
-                                blockValueCounts[buffer[j]]++;
-                                this->m_valueCounts[buffer[j]]++;
-                            }
-                            this->m_blockEntropy.push_back(calculateEntropy(blockValueCounts, this->m_blockSize));
-                        }
+        const auto &valueCounts = this->m_entropy->getValueCounts();
+        for (u16 i = 0; i < 256; i++)
+            this->m_valueCounts[i] = float(valueCounts[i]) / dataSize;
 
-                        this->m_averageEntropy = calculateEntropy(this->m_valueCounts, provider->getSize());
-                        this->m_highestBlockEntropy = *std::max_element(this->m_blockEntropy.begin(), this->m_blockEntropy.end());
-                    }
+        const auto &blockEntropy = this->m_entropy->getEntropy(this->m_entropy->getLevelForResolution(dataSize, PlotResolution));
+        this->m_averageEntropy = this->m_entropy->getTotalEntropy();
+        this->m_highestBlockEntropy = *std::max_element(blockEntropy.begin(), blockEntropy.end());
+
+        this->m_regions = segmentRegions(this->m_entropy->getBlockClasses(), this->m_entropy->getBlockSize(EntropyPyramid::ClassLevel), dataSize, MinimumRegionBlocks);
+
+        View::postEvent(Events::EntropyAnalysisChanged, std::shared_ptr<const EntropyPyramid>(this->m_entropy));
+    }
 
-                    {
-                        std::vector<u8> buffer(provider->getSize(), 0x00);
-                        provider->read(0x00, buffer.data(), buffer.size());
+    void ViewInformation::drawEntropyPlot() {
+        const u64 dataSize = this->m_entropy->getDataSize();
+        const u64 viewSize = this->m_entropyViewEnd - this->m_entropyViewStart;
 
-                        this->m_fileDescription.clear();
-                        this->m_mimeType.clear();
+        const size_t level = this->m_entropy->getLevelForResolution(viewSize, PlotResolution);
+        const u64 blockSize = this->m_entropy->getBlockSize(level);
+        const auto &entropy = this->m_entropy->getEntropy(level);
 
-                        std::string magicFiles;
+        const u64 firstBlock = this->m_entropyViewStart / blockSize;
+        const u64 lastBlock  = std::min<u64>((this->m_entropyViewEnd + blockSize - 1) / blockSize, entropy.size());
 
-                        std::error_code error;
-                        for (const auto &entry : std::filesystem::directory_iterator("magic", error)) {
-                            if (entry.is_regular_file() && entry.path().extension() == ".mgc")
-                                magicFiles += entry.path().string() + MAGIC_PATH_SEPARATOR;
-                        }
+        ImGui::PlotLines("##entropy", entropy.data() + firstBlock, lastBlock - firstBlock, 0, nullptr, 0.0F, 1.0F, ImVec2(0, 100));
 
-                        if (!error) {
-                            magicFiles.pop_back();
+        if (ImGui::IsItemHovered()) {
+            auto &io = ImGui::GetIO();
+            const float width = ImGui::GetItemRectSize().x;
 
-                            {
-                                magic_t cookie = magic_open(MAGIC_NONE);
-                                if (magic_load(cookie, magicFiles.c_str()) != -1)
-                                    this->m_fileDescription = magic_buffer(cookie, buffer.data(), buffer.size());
-                                else
-                                    this->m_fileDescription = "";
+            // Zoom in and out around the hovered position
+            if (io.MouseWheel != 0) {
+                const double position = std::clamp((io.MousePos.x - ImGui::GetItemRectMin().x) / width, 0.0F, 1.0F);
+                const u64 anchor = this->m_entropyViewStart + u64(position * viewSize);
 
-                                magic_close(cookie);
-                            }
+                u64 newSize = io.MouseWheel > 0 ? viewSize / 2 : viewSize * 2;
+                newSize = std::clamp<u64>(newSize, std::min(MinimumViewSize, dataSize), dataSize);
 
+                const u64 newStart = std::min(anchor - std::min<u64>(anchor, position * newSize), dataSize - newSize);
+                this->m_entropyViewStart = newStart;
+                this->m_entropyViewEnd = newStart + newSize;
+            }
 
-                            {
-                                magic_t cookie = magic_open(MAGIC_MIME);
-                                if (magic_load(cookie, magicFiles.c_str()) != -1)
-                                    this->m_mimeType = magic_buffer(cookie, buffer.data(), buffer.size());
-                                else
-                                    this->m_mimeType = "";
+            if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+                const s64 offset = -ImGui::GetMouseDragDelta(ImGuiMouseButton_Left).x / width * viewSize;
+                ImGui::ResetMouseDragDelta(ImGuiMouseButton_Left);
 
-                                magic_close(cookie);
-                            }
+                const u64 newStart = std::clamp<s64>(s64(this->m_entropyViewStart) + offset, 0, dataSize - viewSize);
+                this->m_entropyViewStart = newStart;
+                this->m_entropyViewEnd = newStart + viewSize;
+            }
 
-                        }
+            if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+                this->m_entropyViewStart = 0;
+                this->m_entropyViewEnd = dataSize;
+            }
+        }
 
+        ImGui::LabelText("Shown region", "0x%llx - 0x%llx", this->m_entropyViewStart, this->m_entropyViewEnd);
+        ImGui::LabelText("Block size", "%llu bytes", blockSize);
+        ImGui::TextDisabled("Scroll to zoom, drag to move and double click to show everything");
+    }
 
-                        this->m_shouldInvalidate = false;
-                        this->m_dataValid = true;
-                    }
+    void ViewInformation::drawRegions() {
+        const u64 dataSize = this->m_entropy->getDataSize();
+
+        auto selectRegion = [](const ClassifiedRegion &region) {
+            View::postEvent(Events::SelectionChangeRequest, Region { region.address, region.size });
+        };
+
+        // Map of all regions across the whole data, regions smaller than a pixel are still drawn one pixel wide
+        const ImVec2 mapStart = ImGui::GetCursorScreenPos();
+        const ImVec2 mapSize = ImVec2(ImGui::GetContentRegionAvail().x, 30);
+        ImGui::InvisibleButton("##regionmap", mapSize);
+
+        auto drawList = ImGui::GetWindowDrawList();
+        for (const auto &region : this->m_regions) {
+            const float start = mapStart.x + float(double(region.address) / dataSize * mapSize.x);
+            const float end   = mapStart.x + float(double(region.address + region.size) / dataSize * mapSize.x);
+
+            drawList->AddRectFilled(ImVec2(start, mapStart.y), ImVec2(std::max(end, start + 1), mapStart.y + mapSize.y), getRegionClassColor(region.type));
+        }
+
+        if (ImGui::IsItemHovered() && !this->m_regions.empty()) {
+            const double position = std::clamp((ImGui::GetIO().MousePos.x - mapStart.x) / mapSize.x, 0.0F, 1.0F);
+            const u64 address = std::min<u64>(position * dataSize, dataSize - 1);
+
+            auto region = std::upper_bound(this->m_regions.begin(), this->m_regions.end(), address, [](u64 address, const ClassifiedRegion &region) { return address < region.address; }) - 1;
+
+            ImGui::BeginTooltip();
+            ImGui::Text("%s", getRegionClassName(region->type));
+            ImGui::Text("0x%llx - 0x%llx", region->address, region->address + region->size - 1);
+            ImGui::EndTooltip();
+
+            if (ImGui::IsItemClicked())
+                selectRegion(*region);
+        }
+
+        for (auto type : { RegionClass::Zero, RegionClass::Text, RegionClass::Code, RegionClass::Compressed, RegionClass::Encrypted, RegionClass::Data }) {
+            ImGui::ColorButton(getRegionClassName(type), ImColor(getRegionClassColor(type)), ImGuiColorEditFlags_NoTooltip);
+            ImGui::SameLine();
+            ImGui::TextUnformatted(getRegionClassName(type));
+            ImGui::SameLine(0, 20);
+        }
+        ImGui::NewLine();
+
+        if (ImGui::Button("Add as bookmarks")) {
+            for (const auto &region : this->m_regions) {
+                if (region.type != RegionClass::Data)
+                    ImHexApi::Bookmarks::add(region.address, region.size, getRegionClassName(region.type), "Detected by the region classification", getRegionClassColor(region.type));
+            }
+        }
+
+        if (ImGui::BeginTable("##regions", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 200))) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Region");
+            ImGui::TableSetupColumn("Size");
+            ImGui::TableSetupColumn("Class");
+            ImGui::TableHeadersRow();
+
+            ImGuiListClipper clipper;
+            clipper.Begin(this->m_regions.size());
+
+            while (clipper.Step()) {
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    const auto &region = this->m_regions[i];
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::PushID(i);
+                    if (ImGui::Selectable("##region", false, ImGuiSelectableFlags_SpanAllColumns))
+                        selectRegion(region);
+                    ImGui::PopID();
+                    ImGui::SameLine();
+                    ImGui::Text("0x%08llx : 0x%08llx", region.address, region.address + region.size - 1);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("0x%llx", region.size);
+                    ImGui::TableNextColumn();
+                    ImGui::TextColored(ImColor(getRegionClassColor(region.type)), "%s", getRegionClassName(region.type));
+                }
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+    bool ViewInformation::isAnalyzing() const {
+        return std::any_of(this->m_analysisTasks.begin(), this->m_analysisTasks.end(), [](const auto &task) { return !task->isFinished(); });
+    }
+
+    void ViewInformation::drawContent() {
+        if (ImGui::Begin("Data Information", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
+            ImGui::BeginChild("##scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
+
+            auto provider = SharedData::currentProvider;
+
+            if (provider != nullptr && provider->isReadable()) {
+                if (this->m_shouldInvalidate) {
+                    this->m_shouldInvalidate = false;
+                    this->analyze();
                 }
 
                 ImGui::NewLine();
 
-                if (ImGui::Button("Analyze current page"))
+                if (ImGui::Button("Analyze file"))
                     this->m_shouldInvalidate = true;
 
+                if (this->isAnalyzing()) {
+                    float progress = 0;
+                    for (const auto &task : this->m_analysisTasks)
+                        progress += task->isFinished() ? 1.0F : task->getProgress();
+
+                    ImGui::SameLine();
+                    ImGui::ProgressBar(progress / this->m_analysisTasks.size(), ImVec2(200, 0));
+                }
+
                 ImGui::NewLine();
                 ImGui::Separator();
                 ImGui::NewLine();
@@ -167,11 +458,10 @@ namespace hex {
                     ImGui::NewLine();
 
                     ImGui::Text("Entropy");
-                    ImGui::PlotLines("##nolabel", this->m_blockEntropy.data(), this->m_blockEntropy.size(), 0, nullptr, FLT_MAX, FLT_MAX, ImVec2(0, 100));
+                    this->drawEntropyPlot();
 
                     ImGui::NewLine();
 
-                    ImGui::LabelText("Block size", "2048 blocks of %lu bytes", this->m_blockSize);
                     ImGui::LabelText("Average entropy", "%.8f", this->m_averageEntropy);
                     ImGui::LabelText("Highest entropy block", "%.8f", this->m_highestBlockEntropy);
 
@@ -180,6 +470,13 @@ namespace hex {
                         ImGui::TextColored(ImVec4(0.92F, 0.25F, 0.2F, 1.0F),"This data is most likely encrypted or compressed!");
                     }
 
+                    ImGui::NewLine();
+                    ImGui::Separator();
+                    ImGui::NewLine();
+
+                    ImGui::Text("Regions");
+                    this->drawRegions();
+
                 }
             }
 
@@ -5,23 +5,39 @@
 #include <hex/helpers/utils.hpp>
 #include "helpers/project_file_handler.hpp"
 
+#include <algorithm>
+#include <array>
 #include <string>
 
 using namespace std::literals::string_literals;
 
 namespace hex {
 
+    // The first bytes of a run, followed by an ellipsis if there are more
+    static std::string formatPreview(const u8 *data, size_t previewSize, size_t size) {
+        std::string preview;
+        for (size_t i = 0; i < previewSize; i++)
+            preview += hex::format("%02X ", data[i]);
+
+        if (size > previewSize)
+            preview += "...";
+        else if (!preview.empty())
+            preview.pop_back();
+
+        return preview;
+    }
+
     ViewPatches::ViewPatches() : View("Patches") {
         View::subscribeEvent(Events::ProjectFileStore, [](auto) {
             auto provider = SharedData::currentProvider;
             if (provider != nullptr)
-                ProjectFile::setPatches(provider->getPatches());
+                ProjectFile::setPatches(provider->getPatches().getRuns());
         });
 
         View::subscribeEvent(Events::ProjectFileLoad, [](auto) {
             auto provider = SharedData::currentProvider;
             if (provider != nullptr)
-                provider->getPatches() = ProjectFile::getPatches();
+                provider->getPatches().assign(ProjectFile::getPatches());
         });
     }
 
@@ -36,45 +52,81 @@ namespace hex {
 
             if (provider != nullptr && provider->isReadable()) {
 
-                if (ImGui::BeginTable("##patchesTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Sortable |
+                if (ImGui::BeginTable("##patchesTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Sortable |
                                                         ImGuiTableFlags_Reorderable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
                     ImGui::TableSetupScrollFreeze(0, 1);
                     ImGui::TableSetupColumn("Offset");
+                    ImGui::TableSetupColumn("Size");
                     ImGui::TableSetupColumn("Previous Value");
                     ImGui::TableSetupColumn("Patched Value");
 
                     ImGui::TableHeadersRow();
 
-                    auto& patches = provider->getPatches();
-                    u32 index = 0;
-                    for (const auto &[address, patch] : patches) {
+                    // Patches address the raw data, the bytes they changed may have moved or got removed since
+                    auto pieces = provider->getPieces();
+                    const auto &patches = provider->getPatches();
 
-                        ImGui::TableNextRow();
-                        ImGui::TableNextColumn();
-                        if (ImGui::Selectable(("##patchLine" + std::to_string(index)).c_str(), false, ImGuiSelectableFlags_SpanAllColumns)) {
-                            Region selectRegion = { address, 1 };
-                            View::postEvent(Events::SelectionChangeRequest, selectRegion);
-                        }
-                        if (ImGui::IsMouseReleased(1) && ImGui::IsItemHovered()) {
-                            ImGui::OpenPopup("PatchContextMenu");
-                            this->m_selectedPatch = address;
-                        }
-                        ImGui::SameLine();
-                        ImGui::Text("0x%08lX", address);
+                    // Rows are indexed by the run addresses, so the clipper can jump straight to the visible ones
+                    if (this->m_indexedProvider != provider || this->m_indexedGeneration != patches.getGeneration()) {
+                        this->m_runAddresses.clear();
+                        this->m_runAddresses.reserve(patches.getRuns().size());
+                        for (const auto &[runAddress, run] : patches.getRuns())
+                            this->m_runAddresses.push_back(runAddress);
 
-                        ImGui::TableNextColumn();
-                        u8 previousValue = 0x00;
-                        provider->readRaw(address, &previousValue, sizeof(u8));
-                        ImGui::Text("0x%02X", previousValue);
+                        this->m_indexedProvider = provider;
+                        this->m_indexedGeneration = patches.getGeneration();
+                    }
 
-                        ImGui::TableNextColumn();
-                        ImGui::Text("0x%02X", patch);
-                        index += 1;
+                    ImGuiListClipper clipper;
+                    clipper.Begin(this->m_runAddresses.size());
+
+                    while (clipper.Step()) {
+                        for (s64 i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                            const u64 address = this->m_runAddresses[i];
+                            const auto &run = patches.getRuns().at(address);
+
+                            ImGui::PushID(i);
+                            ImGui::TableNextRow();
+                            ImGui::TableNextColumn();
+                            if (ImGui::Selectable("##patchLine", false, ImGuiSelectableFlags_SpanAllColumns)) {
+                                // Runs covering bytes that moved may have been split apart, only their first byte's address is known then
+                                auto shownAddress = pieces == nullptr ? std::optional<u64>(address) : prv::PieceTable::findOriginal(*pieces, address);
+                                if (shownAddress.has_value()) {
+                                    Region selectRegion = { *shownAddress, pieces == nullptr ? run.size() : 1 };
+                                    View::postEvent(Events::SelectionChangeRequest, selectRegion);
+                                }
+                            }
+                            if (ImGui::IsMouseReleased(1) && ImGui::IsItemHovered()) {
+                                ImGui::OpenPopup("PatchContextMenu");
+                                this->m_selectedPatch = { address, run.size() };
+                            }
+                            ImGui::SameLine();
+                            ImGui::Text("0x%08lX", address);
+
+                            ImGui::TableNextColumn();
+                            ImGui::Text("0x%lX", run.size());
+
+                            const size_t previewSize = std::min(run.size(), PreviewSize);
+
+                            ImGui::TableNextColumn();
+                            std::array<u8, PreviewSize> previousValues = { 0 };
+                            provider->readRaw(address, previousValues.data(), previewSize);
+                            ImGui::TextUnformatted(formatPreview(previousValues.data(), previewSize, run.size()).c_str());
+
+                            ImGui::TableNextColumn();
+                            ImGui::TextUnformatted(formatPreview(run.data(), previewSize, run.size()).c_str());
+                            ImGui::PopID();
+                        }
                     }
+                    clipper.End();
 
                     if (ImGui::BeginPopup("PatchContextMenu")) {
                         if (ImGui::MenuItem("Remove")) {
-                            patches.erase(this->m_selectedPatch);
+                            provider->erasePatches(this->m_selectedPatch.address, this->m_selectedPatch.size);
+                            if (pieces == nullptr)
+                                View::postEvent(Events::DataChanged, this->m_selectedPatch);
+                            else
+                                View::postEvent(Events::DataChanged);
                             ProjectFile::markDirty();
                         }
                         ImGui::EndPopup();
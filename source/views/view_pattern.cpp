@@ -4,7 +4,8 @@
 #include <hex/helpers/utils.hpp>
 #include <hex/lang/preprocessor.hpp>
 
-#include <magic.h>
+#include "helpers/magic.hpp"
+#include "helpers/pattern_library.hpp"
 
 namespace hex {
 
@@ -96,20 +97,17 @@ namespace hex {
              this->m_textEditor.InsertText(code);
         });
 
-        View::subscribeEvent(Events::FileLoaded, [this](auto) {
-            if (this->m_textEditor.GetText().find_first_not_of(" \f\n\r\t\v") != std::string::npos)
-                return;
+        View::subscribeEvent(Events::ProviderChanged, [this](auto) {
+            this->m_resumableGeneration.reset();
+        });
 
-            lang::Preprocessor preprocessor;
-            std::string magicFiles;
+        View::subscribeEvent(Events::FileLoaded, [this](auto) {
+            this->m_resumableGeneration.reset();
 
-            std::error_code error;
-            for (const auto &entry : std::filesystem::directory_iterator("magic", error)) {
-                if (entry.is_regular_file() && entry.path().extension() == ".mgc")
-                    magicFiles += entry.path().string() + MAGIC_PATH_SEPARATOR;
-            }
+            if (this->m_detectionTask != nullptr)
+                this->m_detectionTask->cancel();
 
-            if (error)
+            if (this->m_textEditor.GetText().find_first_not_of(" \f\n\r\t\v") != std::string::npos)
                 return;
 
             auto provider = SharedData::currentProvider;
@@ -117,62 +115,35 @@ namespace hex {
             if (provider == nullptr)
                 return;
 
-            std::vector<u8> buffer(std::min(provider->getSize(), size_t(0xFFFF)), 0x00);
-            provider->read(0, buffer.data(), buffer.size());
-
-            std::string mimeType;
+            // Identifying the data and looking up the patterns for it happens in the background, opening the file doesn't have to wait for it
+            auto patternFiles = std::make_shared<std::vector<std::string>>();
+            this->m_detectionTask = TaskManager::submit("Detecting pattern", provider, [provider, patternFiles](Task &task) {
+                std::string mimeType = magic::identify(provider, magic::Format::MIMEType);
+                if (mimeType.empty() || task.isCancelled())
+                    return;
 
-            magic_t cookie = magic_open(MAGIC_MIME_TYPE);
-            if (magic_load(cookie, magicFiles.c_str()) != -1)
-                mimeType = magic_buffer(cookie, buffer.data(), buffer.size());
+                *patternFiles = pattern_library::findForMimeType(mimeType);
+            }, [this, provider, patternFiles] {
+                // Code typed in the meantime isn't replaced
+                if (provider != SharedData::currentProvider || this->m_textEditor.GetText().find_first_not_of(" \f\n\r\t\v") != std::string::npos)
+                    return;
 
-            magic_close(cookie);
+                this->m_possiblePatternFiles = std::move(*patternFiles);
 
-            bool foundCorrectType = false;
-            preprocessor.addPragmaHandler("MIME", [&mimeType, &foundCorrectType](std::string value) {
-                if (value == mimeType) {
-                    foundCorrectType = true;
-                    return true;
+                if (!this->m_possiblePatternFiles.empty()) {
+                    this->m_selectedPatternFile = 0;
+                    View::doLater([] { ImGui::OpenPopup("Accept Pattern"); });
                 }
-                return !std::all_of(value.begin(), value.end(), isspace) && !value.ends_with('\n') && !value.ends_with('\r');
             });
-            preprocessor.addDefaultPragmaHandlers();
-
-
-            std::error_code errorCode;
-            for (auto &entry : std::filesystem::directory_iterator("patterns", errorCode)) {
-                if (!entry.is_regular_file())
-                    continue;
-
-                FILE *file = fopen(entry.path().string().c_str(), "r");
-
-                if (file == nullptr)
-                    continue;
-
-                fseek(file, 0, SEEK_END);
-                size_t size = ftell(file);
-                rewind(file);
-
-                std::vector<char> buffer( size + 1, 0x00);
-                fread(buffer.data(), 1, size, file);
-                fclose(file);
-
-                preprocessor.preprocess(buffer.data());
-
-                if (foundCorrectType)
-                    this->m_possiblePatternFiles.push_back(entry.path().filename().string());
-            }
-
-            if (!this->m_possiblePatternFiles.empty()) {
-                this->m_selectedPatternFile = 0;
-                View::doLater([] { ImGui::OpenPopup("Accept Pattern"); });
-            }
         });
 
         /* Settings */
         {
 
-            View::subscribeEvent(Events::SettingsChanged, [this](auto) {
+            View::subscribeEvent(Events::SettingsChanged, [this](auto userData) {
+                if (!ContentRegistry::Settings::changed(userData, "Interface", "Color theme"))
+                    return;
+
                 int theme = ContentRegistry::Settings::getSettingsData()["Interface"]["Color theme"];
 
                 switch (theme) {
@@ -193,10 +164,25 @@ namespace hex {
     }
 
     ViewPattern::~ViewPattern() {
+        if (this->m_detectionTask != nullptr)
+            this->m_detectionTask->cancel();
+
+        // The runtime is in use until the evaluation noticed the cancellation
+        if (this->m_parseTask != nullptr) {
+            this->m_parseTask->cancel();
+
+            while (!this->m_parseTask->isFinished())
+                std::this_thread::yield();
+        }
+
+        this->clearPatternData();
+
         delete this->m_patternLanguageRuntime;
 
         View::unsubscribeEvent(Events::ProjectFileStore);
         View::unsubscribeEvent(Events::ProjectFileLoad);
+        View::unsubscribeEvent(Events::DataChanged);
+        View::unsubscribeEvent(Events::ProviderChanged);
     }
 
     void ViewPattern::drawMenu() {
@@ -211,6 +197,8 @@ namespace hex {
     }
 
     void ViewPattern::drawContent() {
+        this->processEvaluation();
+
         if (ImGui::Begin("Pattern", &this->getWindowOpenState(), ImGuiWindowFlags_None | ImGuiWindowFlags_NoCollapse)) {
             auto provider = SharedData::currentProvider;
 
@@ -219,6 +207,16 @@ namespace hex {
                 textEditorSize.y *= 4.0/5.0;
                 this->m_textEditor.Render("Pattern", textEditorSize, true);
 
+                if (this->m_evaluation != nullptr) {
+                    if (ImGui::Button("Stop"))
+                        this->m_parseTask->cancel();
+                    ImGui::SameLine();
+                    ImGui::TextUnformatted(this->m_parseTask->isCancelled() ? "Stopping..." : "Evaluating...");
+                } else {
+                    ImGui::AlignTextToFramePadding();
+                    ImGui::Text("%zu patterns", this->m_patternData.size());
+                }
+
                 auto consoleSize = ImGui::GetContentRegionAvail();
                 ImGui::PushStyleColor(ImGuiCol_ChildBg, this->m_textEditor.GetPalette()[u32(TextEditor::PaletteIndex::Background)]);
 
@@ -249,7 +247,11 @@ namespace hex {
 
                 ImGui::PopStyleColor(1);
 
-                if (this->m_textEditor.IsTextChanged()) {
+                if (this->m_textEditor.IsTextChanged())
+                    this->m_textChangeTime = ImGui::GetTime();
+
+                if (this->m_textChangeTime.has_value() && ImGui::GetTime() - *this->m_textChangeTime >= TextChangeDelay) {
+                    this->m_textChangeTime.reset();
                     this->parsePattern(this->m_textEditor.GetText().data());
                 }
             }
@@ -318,28 +320,116 @@ namespace hex {
             delete data;
 
         this->m_patternData.clear();
+        this->m_patternArenas.clear();
+        this->m_resumableGeneration.reset();
         lang::PatternData::resetPalette();
     }
 
     void ViewPattern::parsePattern(char *buffer) {
-        this->clearPatternData();
-        this->m_textEditor.SetErrorMarkers({ });
+        // The runtime can only evaluate one pattern at a time, so the current run gets cancelled and the newest code evaluated once it stopped
+        if (this->m_evaluation != nullptr) {
+            this->m_pendingPattern = buffer;
+            this->m_parseTask->cancel();
+            return;
+        }
+
+        this->m_pendingPattern.reset();
+        this->m_textChangeTime.reset();
+
+        auto provider = SharedData::currentProvider;
+        const u64 dataGeneration = provider != nullptr ? provider->getDataGeneration() : 0;
+
+        // Patterns of unchanged leading statements are only kept if they were evaluated on the same data. Edits made while they were evaluated changed the generation as well
+        const bool resume = this->m_resumableGeneration == dataGeneration;
+        if (!resume) {
+            this->clearPatternData();
+            this->postEvent(Events::PatternChanged);
+        }
+
         this->m_console.clear();
-        this->postEvent(Events::PatternChanged);
 
-        auto result = this->m_patternLanguageRuntime->executeString(SharedData::currentProvider, buffer);
+        auto evaluation = std::make_shared<Evaluation>();
+        evaluation->dataGeneration = dataGeneration;
+        this->m_evaluation = evaluation;
+
+        std::vector<lang::PatternData*> previousPatterns;
+        if (resume)
+            previousPatterns = this->m_patternData;
+
+        this->m_parseTask = TaskManager::submit("Evaluating pattern", provider, [runtime = this->m_patternLanguageRuntime, provider, code = std::string(buffer), evaluation, resume, previousPatterns](Task &task) mutable {
+            // Patterns all end up in the arena, so everything is freed at once when the patterns get cleared
+            MemoryArena::Scope arenaScope(*evaluation->arena);
+
+            // The current patterns stay as they are if the code doesn't compile
+            auto compiledPattern = runtime->getCompiledPattern(code);
+            if (compiledPattern != nullptr) {
+                previousPatterns.resize(resume ? runtime->getKeptPatternCount(provider, *compiledPattern) : 0);
+
+                {
+                    std::scoped_lock lock(evaluation->mutex);
+                    evaluation->keptPatterns = previousPatterns.size();
+                }
+
+                runtime->execute(provider, compiledPattern, &task, [&evaluation](lang::PatternData *pattern) {
+                    std::scoped_lock lock(evaluation->mutex);
+                    evaluation->newPatterns.push_back(pattern);
+                }, previousPatterns);
+            }
+
+            evaluation->error = runtime->getError();
+        });
+    }
+
+    void ViewPattern::processEvaluation() {
+        if (this->m_evaluation == nullptr)
+            return;
+
+        // Checked first so patterns handed over right before the task finished are still picked up below
+        const bool finished = this->m_parseTask->isFinished();
+
+        {
+            std::scoped_lock lock(this->m_evaluation->mutex);
+
+            // The evaluation only references the kept patterns, the others can be deleted while it's still running
+            if (auto keptPatterns = this->m_evaluation->keptPatterns; keptPatterns.has_value()) {
+                for (auto i = *keptPatterns; i < this->m_patternData.size(); i++)
+                    delete this->m_patternData[i];
+                this->m_patternData.resize(*keptPatterns);
+
+                std::erase_if(this->m_patternArenas, [&](const auto &arena) { return arena.first >= *keptPatterns; });
 
-        auto error = this->m_patternLanguageRuntime->getError();
-        if (error.has_value()) {
-            this->m_textEditor.SetErrorMarkers({ error.value() });
+                this->m_evaluation->keptPatterns.reset();
+                this->m_resumableGeneration = this->m_evaluation->dataGeneration;
+                View::postEvent(Events::PatternChanged);
+            }
+
+            if (!this->m_evaluation->newPatterns.empty()) {
+                if (this->m_patternArenas.empty() || this->m_patternArenas.back().second != this->m_evaluation->arena)
+                    this->m_patternArenas.emplace_back(this->m_patternData.size(), this->m_evaluation->arena);
+
+                this->m_patternData.insert(this->m_patternData.end(), this->m_evaluation->newPatterns.begin(), this->m_evaluation->newPatterns.end());
+                this->m_evaluation->newPatterns.clear();
+                View::postEvent(Events::PatternChanged);
+            }
         }
 
         this->m_console = this->m_patternLanguageRuntime->getConsoleLog();
 
-        if (result.has_value()) {
-            this->m_patternData = std::move(result.value());
-            View::postEvent(Events::PatternChanged);
+        if (!finished)
+            return;
+
+        // Markers of the previous evaluation stay around until now, moving along with the lines they're on while the pattern is edited
+        if (this->m_evaluation->error.has_value())
+            this->m_textEditor.SetErrorMarkers({ this->m_evaluation->error.value() });
+        else
+            this->m_textEditor.SetErrorMarkers({ });
+
+        this->m_evaluation.reset();
+
+        if (this->m_pendingPattern.has_value()) {
+            auto code = std::move(*this->m_pendingPattern);
+            this->parsePattern(code.data());
         }
     }
 
-}
\ No newline at end of file
+}
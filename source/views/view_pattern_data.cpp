@@ -1,23 +1,42 @@
 #include "views/view_pattern_data.hpp"
 
 #include <hex/providers/provider.hpp>
+#include <hex/helpers/memory_arena.hpp>
 #include <hex/lang/pattern_data.hpp>
 
+#include "helpers/pattern_exporter.hpp"
+
 namespace hex {
 
-    ViewPatternData::ViewPatternData(std::vector<lang::PatternData*> &patternData)
-        : View("Pattern Data"), m_patternData(patternData) {
+    ViewPatternData::ViewPatternData(std::vector<lang::PatternData*> &patternData, lang::PatternIndex &patternIndex)
+        : View("Pattern Data"), m_patternData(patternData), m_patternIndex(patternIndex) {
 
         this->subscribeEvent(Events::PatternChanged, [this](auto data) {
+            this->m_patternIndex.invalidate();
             this->m_sortedPatternData.clear();
+            this->m_rowsDirty = true;
+            this->m_selectedId.reset();
+            this->m_selectedAddress = -1;
+        });
+
+        this->subscribeEvent(Events::RegionSelected, [this](auto userData) {
+            auto region = std::any_cast<Region>(userData);
+            auto provider = SharedData::currentProvider;
+
+            if (provider == nullptr || region.address == (size_t)-1)
+                return;
+
+            // Selections are relative to the page shown in the hex editor
+            this->selectPatternAt(prv::Provider::PageSize * provider->getCurrentPage() + region.address);
         });
     }
 
     ViewPatternData::~ViewPatternData() {
         this->unsubscribeEvent(Events::PatternChanged);
+        this->unsubscribeEvent(Events::RegionSelected);
     }
 
-    static bool beginPatternDataTable(prv::Provider* &provider, const std::vector<lang::PatternData*> &patterns, std::vector<lang::PatternData*> &sortedPatterns) {
+    static bool beginPatternDataTable(prv::Provider* &provider, const std::vector<lang::PatternData*> &patterns, std::vector<lang::PatternData*> &sortedPatterns, bool &sorted) {
         if (ImGui::BeginTable("##patterndatatable", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Sortable | ImGuiTableFlags_Reorderable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
             ImGui::TableSetupScrollFreeze(0, 1);
             ImGui::TableSetupColumn("Name", 0, -1, ImGui::GetID("name"));
@@ -32,14 +51,13 @@ namespace hex {
             if (sortSpecs->SpecsDirty || sortedPatterns.empty()) {
                 sortedPatterns = patterns;
 
-                std::sort(sortedPatterns.begin(), sortedPatterns.end(), [&sortSpecs, &provider](lang::PatternData* left, lang::PatternData* right) -> bool {
-                    return lang::PatternData::sortPatternDataTable(sortSpecs, provider, left, right);
-                });
+                lang::PatternData::sortPatterns(sortSpecs, provider, sortedPatterns);
 
                 for (auto &pattern : sortedPatterns)
                     pattern->sort(sortSpecs, provider);
 
                 sortSpecs->SpecsDirty = false;
+                sorted = true;
             }
 
             return true;
@@ -48,18 +66,366 @@ namespace hex {
         return false;
     }
 
+    static u64 getRowId(u64 parentId, std::string_view key) {
+        return std::hash<std::string_view>{}(key) ^ (parentId + 0x9E37'79B9'7F4A'7C15 + (parentId << 6) + (parentId >> 2));
+    }
+
+    static bool isExpandable(lang::PatternData *pattern) {
+        return dynamic_cast<lang::PatternDataStruct*>(pattern) != nullptr || dynamic_cast<lang::PatternDataUnion*>(pattern) != nullptr ||
+               dynamic_cast<lang::PatternDataBitfield*>(pattern) != nullptr || dynamic_cast<lang::PatternDataArray*>(pattern) != nullptr ||
+               dynamic_cast<lang::PatternDataStaticArray*>(pattern) != nullptr || dynamic_cast<lang::PatternDataPointer*>(pattern) != nullptr;
+    }
+
+    void ViewPatternData::buildRows() {
+        this->m_rows.clear();
+        this->m_rowLines.clear();
+        this->m_lineCount = 0;
+
+        for (auto &pattern : this->m_sortedPatternData)
+            this->addPatternRows(pattern, NoParent, 0, getRowId(0, pattern->getVariableName()), false, 0);
+
+        for (auto &row : this->m_rows) {
+            this->m_rowLines.push_back(this->m_lineCount);
+            this->m_lineCount += row.type == Row::Type::Entries ? row.count : 1;
+        }
+
+        this->updateSelectedLine();
+    }
+
+    void ViewPatternData::addPatternRows(lang::PatternData *pattern, u32 parent, u32 depth, u64 id, bool isEntry, u64 index) {
+        if (dynamic_cast<lang::PatternDataPadding*>(pattern) != nullptr)
+            return;
+        if (auto array = dynamic_cast<lang::PatternDataArray*>(pattern); array != nullptr && array->getEntries().empty())
+            return;
+        if (auto array = dynamic_cast<lang::PatternDataStaticArray*>(pattern); array != nullptr && array->getEntryCount() == 0)
+            return;
+
+        const u32 rowIndex = this->m_rows.size();
+        this->m_rows.push_back({ Row::Type::Pattern, pattern, parent, depth, id, isEntry, index, 1 });
+
+        if (!isExpandable(pattern) || !this->m_openRows.contains(id))
+            return;
+
+        auto addChildren = [&, this](const std::vector<lang::PatternData*> &children) {
+            for (auto &child : children)
+                this->addPatternRows(child, rowIndex, depth + 1, getRowId(id, child->getVariableName()), false, 0);
+        };
+
+        if (auto bitfield = dynamic_cast<lang::PatternDataBitfield*>(pattern); bitfield != nullptr) {
+            for (u64 field = 0; field < bitfield->getFields().size(); field++)
+                this->m_rows.push_back({ Row::Type::Field, bitfield, rowIndex, depth + 1, 0, false, field, 1 });
+        } else if (auto pointer = dynamic_cast<lang::PatternDataPointer*>(pattern); pointer != nullptr)
+            addChildren({ pointer->getPointedAtPattern() });
+        else if (auto structPattern = dynamic_cast<lang::PatternDataStruct*>(pattern); structPattern != nullptr)
+            addChildren(structPattern->getSortedMembers());
+        else if (auto unionPattern = dynamic_cast<lang::PatternDataUnion*>(pattern); unionPattern != nullptr)
+            addChildren(unionPattern->getSortedMembers());
+        else if (auto array = dynamic_cast<lang::PatternDataArray*>(pattern); array != nullptr)
+            addChildren(array->getEntries());
+        else if (auto staticArray = dynamic_cast<lang::PatternDataStaticArray*>(pattern); staticArray != nullptr)
+            this->addEntryRows(staticArray, rowIndex, depth + 1, id, 0, staticArray->getEntryCount());
+    }
+
+    void ViewPatternData::addEntryRows(lang::PatternDataStaticArray *array, u32 parent, u32 depth, u64 id, u64 firstEntry, u64 entryCount) {
+        // Plain entries all have the same height, they can be clipped like any other line
+        if (!isExpandable(array->getTemplate())) {
+            this->m_rows.push_back({ Row::Type::Entries, array, parent, depth, id, false, firstEntry, entryCount });
+            return;
+        }
+
+        if (entryCount <= PageSize) {
+            for (u64 i = firstEntry; i < firstEntry + entryCount; i++)
+                this->addPatternRows(array->getTemplate(), parent, depth, getRowId(id, hex::format("[%llu]", i)), true, i);
+            return;
+        }
+
+        u64 entriesPerPage = PageSize;
+        while (entriesPerPage * PageSize < entryCount)
+            entriesPerPage *= PageSize;
+
+        for (u64 page = firstEntry; page < firstEntry + entryCount; page += entriesPerPage) {
+            const u64 pageEntries = std::min(entriesPerPage, firstEntry + entryCount - page);
+            const u64 pageId = getRowId(id, hex::format("[%llu ... %llu]", page, page + pageEntries - 1));
+
+            const u32 rowIndex = this->m_rows.size();
+            this->m_rows.push_back({ Row::Type::Page, array, parent, depth, pageId, false, page, pageEntries });
+
+            if (this->m_openRows.contains(pageId))
+                this->addEntryRows(array, rowIndex, depth + 1, id, page, pageEntries);
+        }
+    }
+
+    // Opens all rows down to the innermost pattern containing the address and scrolls to it
+    void ViewPatternData::selectPatternAt(u64 address) {
+        // Selecting a pattern in the tree selects its bytes as well, it's already the one that should be shown
+        if (address == this->m_selectedAddress)
+            return;
+        this->m_selectedAddress = address;
+
+        static std::vector<lang::PatternData*> path;
+        if (!this->m_patternIndex.findPath(address, path)) {
+            this->m_selectedId.reset();
+            this->m_selectedLine = NoLine;
+            return;
+        }
+
+        // Row ids are built from the names along the path, they have to be computed now as entries get renamed when their template moves
+        u64 id = 0;
+        std::optional<u64> entry;
+        for (size_t i = 0; i < path.size(); i++) {
+            auto array = i == 0 ? nullptr : dynamic_cast<lang::PatternDataStaticArray*>(path[i - 1]);
+
+            if (i > 0)
+                this->m_openRows.insert(id);
+
+            if (array == nullptr)
+                id = getRowId(id, path[i]->getVariableName());
+            else {
+                const u64 index = (path[i]->getOffset() - array->getOffset()) / array->getTemplate()->getSize();
+
+                if (!isExpandable(array->getTemplate())) {
+                    entry = index;
+                    break;
+                }
+
+                this->openEntryPages(array, id, index);
+                id = getRowId(id, hex::format("[%llu]", index));
+            }
+        }
+
+        this->m_selectedId = id;
+        this->m_selectedEntry = entry;
+        this->m_rowsDirty = true;
+        this->m_scrollToSelection = true;
+    }
+
+    // Opens the pages of an array with expandable entries that lead to the entry, the same way addEntryRows splits them up
+    void ViewPatternData::openEntryPages(lang::PatternDataStaticArray *array, u64 id, u64 entry) {
+        u64 firstEntry = 0;
+        u64 entryCount = array->getEntryCount();
+
+        while (entryCount > PageSize) {
+            u64 entriesPerPage = PageSize;
+            while (entriesPerPage * PageSize < entryCount)
+                entriesPerPage *= PageSize;
+
+            const u64 page = firstEntry + (entry - firstEntry) / entriesPerPage * entriesPerPage;
+            const u64 pageEntries = std::min(entriesPerPage, firstEntry + entryCount - page);
+            this->m_openRows.insert(getRowId(id, hex::format("[%llu ... %llu]", page, page + pageEntries - 1)));
+
+            firstEntry = page;
+            entryCount = pageEntries;
+        }
+    }
+
+    void ViewPatternData::updateSelectedLine() {
+        this->m_selectedLine = NoLine;
+
+        if (!this->m_selectedId.has_value())
+            return;
+
+        for (u32 row = 0; row < this->m_rows.size(); row++) {
+            const auto &currRow = this->m_rows[row];
+            if (currRow.id != *this->m_selectedId)
+                continue;
+
+            if (currRow.type == Row::Type::Pattern && !this->m_selectedEntry.has_value()) {
+                this->m_selectedLine = this->m_rowLines[row];
+                return;
+            }
+
+            if (currRow.type == Row::Type::Entries && this->m_selectedEntry.has_value()) {
+                const u64 entry = *this->m_selectedEntry;
+                if (entry >= currRow.index && entry < currRow.index + currRow.count) {
+                    this->m_selectedLine = this->m_rowLines[row] + entry - currRow.index;
+                    return;
+                }
+            }
+        }
+    }
+
+    // Static array templates are shared by all their entries, they have to be moved to the entries the row is part of before drawing it
+    void ViewPatternData::prepareRow(u32 row) {
+        const auto &currRow = this->m_rows[row];
+
+        if (currRow.parent == NoParent)
+            return;
+
+        this->prepareRow(currRow.parent);
+
+        if (currRow.isEntry)
+            (void)static_cast<lang::PatternDataStaticArray*>(this->m_rows[currRow.parent].pattern)->getEntry(currRow.index);
+    }
+
+    bool ViewPatternData::drawTreeNode(const char *label, u64 id, bool selected) {
+        const bool open = this->m_openRows.contains(id);
+
+        ImGui::SetNextItemOpen(open);
+        ImGui::TreeNodeEx(label, ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowItemOverlap | ImGuiTreeNodeFlags_NoTreePushOnOpen | (selected ? ImGuiTreeNodeFlags_Selected : 0));
+
+        // The rows below only change with the next rebuild, so they're drawn as they were for the rest of this frame
+        if (ImGui::IsItemToggledOpen()) {
+            if (open)
+                this->m_openRows.erase(id);
+            else
+                this->m_openRows.insert(id);
+
+            this->m_rowsDirty = true;
+        }
+
+        return open;
+    }
+
+    void ViewPatternData::drawPatternRow(prv::Provider *provider, lang::PatternData *pattern, const Row &row, u64 line, std::optional<u64> entry) {
+        ImGui::TableNextColumn();
+
+        const bool selected = line == this->m_selectedLine;
+        if (isExpandable(pattern))
+            this->drawTreeNode(pattern->getVariableName().c_str(), row.id, selected);
+        else {
+            ImGui::TreeAdvanceToLabelPos();
+            if (ImGui::Selectable(pattern->getVariableName().c_str(), selected, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowItemOverlap)) {
+                this->m_selectedId = row.id;
+                this->m_selectedEntry = entry;
+                this->m_selectedLine = line;
+                this->m_selectedAddress = pattern->getOffset();
+
+                Region selectRegion = { pattern->getOffset(), pattern->getSize() };
+                View::postEvent(Events::SelectionChangeRequest, selectRegion);
+            }
+        }
+        pattern->drawCommentTooltip();
+
+        ImGui::TableNextColumn();
+        if (pattern->showsColor())
+            ImGui::ColorButton("color", ImColor(pattern->getColor()), ImGuiColorEditFlags_NoTooltip, ImVec2(ImGui::GetColumnWidth(), ImGui::GetTextLineHeight()));
+        ImGui::TableNextColumn();
+        ImGui::Text("0x%08llX : 0x%08llX", pattern->getOffset(), pattern->getOffset() + pattern->getSize() - (pattern->getSize() == 0 ? 0 : 1));
+        ImGui::TableNextColumn();
+        ImGui::Text("0x%04llX", pattern->getSize());
+        ImGui::TableNextColumn();
+        pattern->drawTypeName();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(pattern->getDisplayValue(provider).c_str());
+    }
+
+    void ViewPatternData::drawFieldRow(prv::Provider *provider, const Row &row) {
+        auto bitfield = static_cast<lang::PatternDataBitfield*>(row.pattern);
+        const auto &fields = bitfield->getFields();
+
+        u64 bitOffset = 0;
+        for (u64 field = 0; field < row.index; field++)
+            bitOffset += fields[field].second;
+
+        const auto &[fieldName, fieldSize] = fields[row.index];
+
+        ImGui::TableNextColumn();
+        ImGui::TreeAdvanceToLabelPos();
+        ImGui::TextUnformatted(fieldName.c_str());
+        ImGui::TableNextColumn();
+        ImGui::ColorButton("color", ImColor(bitfield->getColor()), ImGuiColorEditFlags_NoTooltip, ImVec2(ImGui::GetColumnWidth(), ImGui::GetTextLineHeight()));
+        ImGui::TableNextColumn();
+        ImGui::Text("0x%08llX : 0x%08llX", bitfield->getOffset() + (bitOffset >> 3), bitfield->getOffset() + ((bitOffset + fieldSize) >> 3));
+        ImGui::TableNextColumn();
+        if (fieldSize == 1)
+            ImGui::Text("%llu bit", fieldSize);
+        else
+            ImGui::Text("%llu bits", fieldSize);
+        ImGui::TableNextColumn();
+        ImGui::TextColored(ImColor(0xFF9BC64D), "bits");
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(bitfield->getDisplayFieldValue(provider, row.index).c_str());
+    }
+
+    void ViewPatternData::drawPageRow(const Row &row) {
+        auto array = static_cast<lang::PatternDataStaticArray*>(row.pattern);
+
+        const u64 pageOffset = array->getOffset() + row.index * array->getTemplate()->getSize();
+        const u64 pageSize = row.count * array->getTemplate()->getSize();
+
+        ImGui::TableNextColumn();
+        this->drawTreeNode(hex::format("[%llu ... %llu]", row.index, row.index + row.count - 1).c_str(), row.id, false);
+        ImGui::TableNextColumn();
+        ImGui::TableNextColumn();
+        ImGui::Text("0x%08llX : 0x%08llX", pageOffset, pageOffset + pageSize - 1);
+        ImGui::TableNextColumn();
+        ImGui::Text("0x%04llX", pageSize);
+        ImGui::TableNextColumn();
+        ImGui::TableNextColumn();
+    }
+
+    void ViewPatternData::drawLine(prv::Provider *provider, u32 row, u64 line) {
+        const auto &currRow = this->m_rows[row];
+
+        this->prepareRow(row);
+
+        // Rows aren't drawn between TreeNode and TreePop anymore, so their indentation has to be added manually. Tables lock it in per row
+        const float indent = currRow.depth * ImGui::GetStyle().IndentSpacing;
+        if (indent > 0)
+            ImGui::Indent(indent);
+
+        ImGui::TableNextRow();
+        ImGui::PushID(int(line));
+
+        switch (currRow.type) {
+            case Row::Type::Pattern:
+                this->drawPatternRow(provider, currRow.pattern, currRow, line, { });
+                break;
+            case Row::Type::Entries: {
+                const u64 entry = currRow.index + line - this->m_rowLines[row];
+                this->drawPatternRow(provider, static_cast<lang::PatternDataStaticArray*>(currRow.pattern)->getEntry(entry), currRow, line, entry);
+                break;
+            }
+            case Row::Type::Field:
+                this->drawFieldRow(provider, currRow);
+                break;
+            case Row::Type::Page:
+                this->drawPageRow(currRow);
+                break;
+        }
+
+        ImGui::PopID();
+
+        if (indent > 0)
+            ImGui::Unindent(indent);
+    }
+
     void ViewPatternData::drawContent() {
         if (ImGui::Begin("Pattern Data", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
             auto provider = SharedData::currentProvider;
             if (provider != nullptr && provider->isReadable()) {
 
-                if (beginPatternDataTable(provider, this->m_patternData, this->m_sortedPatternData)) {
+                bool sorted = false;
+                if (beginPatternDataTable(provider, this->m_patternData, this->m_sortedPatternData, sorted)) {
                     ImGui::TableHeadersRow();
-                    if (this->m_sortedPatternData.size() > 0) {
 
-                        for (auto &patternData : this->m_sortedPatternData)
-                            patternData->createEntry(provider);
+                    if (sorted || this->m_rowsDirty) {
+                        this->buildRows();
+                        this->m_rowsDirty = false;
+                    }
+
+                    // The clipper counts in ints, lines past that can't be displayed
+                    ImGuiListClipper clipper;
+                    clipper.Begin(std::min<u64>(this->m_lineCount, std::numeric_limits<int>::max()));
 
+                    while (clipper.Step()) {
+                        if (clipper.DisplayStart >= clipper.DisplayEnd)
+                            continue;
+
+                        u32 row = std::upper_bound(this->m_rowLines.begin(), this->m_rowLines.end(), u64(clipper.DisplayStart)) - this->m_rowLines.begin() - 1;
+                        for (u64 line = clipper.DisplayStart; line < u64(clipper.DisplayEnd); line++) {
+                            while (row + 1 < this->m_rows.size() && this->m_rowLines[row + 1] <= line)
+                                row++;
+
+                            this->drawLine(provider, row, line);
+                        }
+                    }
+
+                    // All lines have the height the clipper measured, the selected one gets centered once its rows were built
+                    if (this->m_scrollToSelection) {
+                        if (this->m_selectedLine < this->m_lineCount && clipper.ItemsHeight > 0)
+                            ImGui::SetScrollFromPosY(clipper.StartPosY - ImGui::GetWindowPos().y + this->m_selectedLine * clipper.ItemsHeight);
+                        this->m_scrollToSelection = false;
                     }
 
                     ImGui::EndTable();
@@ -71,7 +437,50 @@ namespace hex {
     }
 
     void ViewPatternData::drawMenu() {
+        auto provider = SharedData::currentProvider;
+
+        if (ImGui::BeginMenu("File")) {
+            const bool exporting = this->m_exportTask != nullptr && !this->m_exportTask->isFinished();
+
+            if (ImGui::BeginMenu("Export Pattern Data...", !exporting && provider != nullptr && provider->isReadable() && !this->m_patternData.empty())) {
+                auto exportPatternData = [this](const char *title, const char *extension, PatternExporter::Format format) {
+                    View::openFileBrowser(title, imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, extension, [this, format](auto path) {
+                        // The next evaluation may replace the patterns while they're being exported, so the task gets copies of them.
+                        // Copying only duplicates the tree, reading and formatting the values is left to the task
+                        auto arena = std::make_shared<MemoryArena>();
+                        auto patterns = std::make_shared<std::vector<lang::PatternData*>>();
+                        {
+                            MemoryArena::Scope arenaScope(*arena);
+                            for (auto &pattern : this->m_patternData)
+                                patterns->push_back(pattern->clone());
+                        }
+
+                        auto provider = SharedData::currentProvider;
+                        auto succeeded = std::make_shared<bool>(false);
 
+                        this->m_exportTask = TaskManager::submit("Exporting pattern data", provider, [path, format, provider, arena, patterns, succeeded](Task&) {
+                            *succeeded = PatternExporter::exportToFile(path, format, provider, *patterns);
+
+                            for (auto &pattern : *patterns)
+                                delete pattern;
+                        }, [succeeded] {
+                            if (!*succeeded)
+                                View::showErrorPopup("Failed to export pattern data!");
+                        });
+                    });
+                };
+
+                if (ImGui::MenuItem("JSON"))
+                    exportPatternData("Export Pattern Data as JSON", ".json", PatternExporter::Format::JSON);
+
+                if (ImGui::MenuItem("CSV"))
+                    exportPatternData("Export Pattern Data as CSV", ".csv", PatternExporter::Format::CSV);
+
+                ImGui::EndMenu();
+            }
+
+            ImGui::EndMenu();
+        }
     }
 
 }
\ No newline at end of file
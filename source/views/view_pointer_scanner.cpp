@@ -0,0 +1,266 @@
+#include "views/view_pointer_scanner.hpp"
+
+#include <hex/providers/provider.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <array>
+
+namespace hex {
+
+    namespace {
+
+        constexpr std::array Widths = { "32 bit", "64 bit" };
+        constexpr std::array WidthSizes = { 4, 8 };
+        constexpr std::array Endians = { "Little", "Big" };
+        constexpr std::array Alignments = { "1", "2", "4", "8" };
+        constexpr std::array AlignmentSizes = { 1, 2, 4, 8 };
+
+    }
+
+    ViewPointerScanner::ViewPointerScanner() : View("Pointer Scanner") {
+        View::subscribeEvent(Events::RegionSelected, [this](auto userData) {
+            auto region = std::any_cast<const Region>(userData);
+
+            // Selections are relative to the page shown in the hex editor
+            u64 pageOffset = prv::Provider::PageSize * SharedData::currentProvider->getCurrentPage();
+
+            if (this->m_shouldMatchSelection && region.size > 1) {
+                this->m_region[0] = pageOffset + region.address;
+                this->m_region[1] = pageOffset + region.address + region.size - 1;
+            }
+
+            this->m_selection = { pageOffset + region.address, region.size };
+            if (this->m_onlyIntoSelection)
+                this->updateFilter();
+        });
+
+        View::subscribeEvent(Events::DataChanged, [this](auto) {
+            if (this->m_result != nullptr)
+                this->m_outdated = true;
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto) {
+            if (this->m_scanTask != nullptr)
+                this->m_scanTask->cancel();
+
+            this->m_result = nullptr;
+            this->m_filtered.clear();
+            this->m_outdated = false;
+            this->m_error.clear();
+            this->resetTargetRange();
+        });
+    }
+
+    ViewPointerScanner::~ViewPointerScanner() {
+        if (this->m_scanTask != nullptr)
+            this->m_scanTask->cancel();
+
+        View::unsubscribeEvent(Events::RegionSelected);
+        View::unsubscribeEvent(Events::DataChanged);
+        View::unsubscribeEvent(Events::ProviderChanged);
+    }
+
+    bool ViewPointerScanner::isScanning() const {
+        return this->m_scanTask != nullptr && !this->m_scanTask->isFinished();
+    }
+
+    void ViewPointerScanner::resetTargetRange() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || provider->getActualSize() == 0)
+            return;
+
+        this->m_target[0] = provider->getBaseAddress();
+        this->m_target[1] = provider->getBaseAddress() + provider->getActualSize() - 1;
+    }
+
+    std::optional<u64> ViewPointerScanner::getTargetOffset(const FoundPointer &pointer) const {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || pointer.value < this->m_scannedBaseAddress)
+            return std::nullopt;
+
+        const u64 offset = pointer.value - this->m_scannedBaseAddress;
+        if (offset >= provider->getActualSize())
+            return std::nullopt;
+
+        return offset;
+    }
+
+    void ViewPointerScanner::updateFilter() {
+        this->m_filtered.clear();
+        if (this->m_result == nullptr)
+            return;
+
+        const auto &pointers = this->m_result->pointers;
+        for (size_t i = 0; i < pointers.size(); i++) {
+            const auto target = this->getTargetOffset(pointers[i]);
+            if (target.has_value() && *target >= this->m_selection.address && *target < this->m_selection.address + this->m_selection.size)
+                this->m_filtered.push_back(i);
+        }
+    }
+
+    void ViewPointerScanner::scan() {
+        auto provider = SharedData::currentProvider;
+
+        PointerScanSettings settings = {
+            .address = this->m_region[0],
+            .size = this->m_region[1] - this->m_region[0] + 1,
+            .width = u8(WidthSizes[this->m_selectedWidth]),
+            .endian = this->m_selectedEndian == 0 ? std::endian::little : std::endian::big,
+            .alignment = u8(AlignmentSizes[this->m_selectedAlignment]),
+            .targetStart = this->m_target[0],
+            .targetEnd = this->m_target[1]
+        };
+
+        this->m_error.clear();
+
+        auto result = std::make_shared<PointerScanResult>();
+        auto succeeded = std::make_shared<bool>(false);
+
+        this->m_scanTask = TaskManager::submit("Scanning for pointers", [snapshot = provider->createSnapshot(), settings, result, succeeded](Task &task) {
+            if (auto pointers = scanPointers(snapshot, settings, task); pointers.has_value()) {
+                *result = std::move(*pointers);
+                *succeeded = true;
+            }
+        }, [this, result, succeeded, baseAddress = provider->getBaseAddress(), width = settings.width] {
+            if (!*succeeded) {
+                this->m_error = "Failed to read the region";
+                return;
+            }
+
+            this->m_result = result;
+            this->m_scannedBaseAddress = baseAddress;
+            this->m_scannedWidth = width;
+            this->m_outdated = false;
+            this->updateFilter();
+        });
+    }
+
+    void ViewPointerScanner::drawContent() {
+        if (ImGui::Begin("Pointer Scanner", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
+            ImGui::BeginChild("##scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
+
+            auto provider = SharedData::currentProvider;
+            if (provider != nullptr && provider->isReadable()) {
+                const u64 dataSize = provider->getActualSize();
+
+                if (this->m_target[0] == 0 && this->m_target[1] == 0)
+                    this->resetTargetRange();
+
+                ImGui::TextUnformatted("Region");
+                ImGui::Separator();
+
+                ImGui::InputScalarN("##region", ImGuiDataType_U64, this->m_region, 2, nullptr, nullptr, "%08llX", ImGuiInputTextFlags_CharsHexadecimal);
+                ImGui::Checkbox("Match selection", &this->m_shouldMatchSelection);
+                ImGui::SameLine();
+                if (ImGui::Button("Whole file") && dataSize > 0) {
+                    this->m_region[0] = 0;
+                    this->m_region[1] = dataSize - 1;
+                }
+
+                if (dataSize > 0 && this->m_region[1] >= dataSize)
+                    this->m_region[1] = dataSize - 1;
+
+                ImGui::NewLine();
+                ImGui::TextUnformatted("Pointers");
+                ImGui::Separator();
+
+                ImGui::Combo("Width", &this->m_selectedWidth, Widths.data(), Widths.size());
+                ImGui::Combo("Endian", &this->m_selectedEndian, Endians.data(), Endians.size());
+                ImGui::Combo("Alignment", &this->m_selectedAlignment, Alignments.data(), Alignments.size());
+
+                ImGui::InputScalarN("Target range", ImGuiDataType_U64, this->m_target, 2, nullptr, nullptr, "%08llX", ImGuiInputTextFlags_CharsHexadecimal);
+                ImGui::SameLine();
+                if (ImGui::Button("Use image range"))
+                    this->resetTargetRange();
+
+                const u64 width = WidthSizes[this->m_selectedWidth];
+                const bool validSettings = this->m_region[1] >= this->m_region[0] && this->m_region[1] - this->m_region[0] + 1 >= width && this->m_target[1] >= this->m_target[0];
+
+                if (this->isScanning()) {
+                    ImGui::ProgressBar(this->m_scanTask->getProgress(), ImVec2(300, 0));
+                    ImGui::SameLine();
+                    if (ImGui::Button("Cancel"))
+                        this->m_scanTask->cancel();
+                } else if (ImGui::Button("Scan") && validSettings) {
+                    this->scan();
+                }
+
+                if (!this->m_error.empty())
+                    ImGui::TextUnformatted(this->m_error.c_str());
+
+                if (this->m_result != nullptr) {
+                    ImGui::NewLine();
+                    ImGui::TextUnformatted("Results");
+                    ImGui::Separator();
+
+                    if (this->m_outdated)
+                        ImGui::TextUnformatted("The data changed since the scan, results may be outdated");
+                    if (this->m_result->truncated)
+                        ImGui::TextUnformatted("Too many pointers found, only the first ones are shown");
+
+                    if (ImGui::Checkbox("Only pointers into selection", &this->m_onlyIntoSelection) && this->m_onlyIntoSelection)
+                        this->updateFilter();
+
+                    const auto &pointers = this->m_result->pointers;
+                    const size_t count = this->m_onlyIntoSelection ? this->m_filtered.size() : pointers.size();
+                    ImGui::Text("%llu pointers", u64(count));
+
+                    const u64 scannedWidth = this->m_scannedWidth;
+                    if (ImGui::BeginTable("##pointers", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, ImGui::GetContentRegionAvail().y))) {
+                        ImGui::TableSetupScrollFreeze(0, 1);
+                        ImGui::TableSetupColumn("Offset");
+                        ImGui::TableSetupColumn("Value");
+                        ImGui::TableSetupColumn("Target offset");
+                        ImGui::TableSetupColumn("");
+                        ImGui::TableHeadersRow();
+
+                        ImGuiListClipper clipper;
+                        clipper.Begin(count);
+
+                        while (clipper.Step()) {
+                            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                                const auto &pointer = pointers[this->m_onlyIntoSelection ? this->m_filtered[i] : i];
+                                const auto target = this->getTargetOffset(pointer);
+
+                                ImGui::PushID(i);
+
+                                ImGui::TableNextRow();
+                                ImGui::TableNextColumn();
+                                if (ImGui::Selectable("##pointer", false, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowItemOverlap))
+                                    View::postEvent(Events::SelectionChangeRequest, Region { pointer.offset, scannedWidth });
+                                ImGui::SameLine();
+                                ImGui::Text("0x%08llX", this->m_scannedBaseAddress + pointer.offset);
+
+                                ImGui::TableNextColumn();
+                                ImGui::Text("0x%0*llX", int(scannedWidth * 2), pointer.value);
+
+                                ImGui::TableNextColumn();
+                                if (target.has_value()) {
+                                    ImGui::Text("0x%08llX", *target);
+                                    ImGui::TableNextColumn();
+                                    if (ImGui::SmallButton("Go to target"))
+                                        View::postEvent(Events::SelectionChangeRequest, Region { *target, 1 });
+                                } else {
+                                    ImGui::TextUnformatted("Outside of the data");
+                                    ImGui::TableNextColumn();
+                                }
+
+                                ImGui::PopID();
+                            }
+                        }
+
+                        ImGui::EndTable();
+                    }
+                }
+            }
+
+            ImGui::EndChild();
+        }
+        ImGui::End();
+    }
+
+    void ViewPointerScanner::drawMenu() {
+
+    }
+
+}
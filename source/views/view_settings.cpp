@@ -28,8 +28,10 @@ namespace hex {
                 for (auto &[name, callback] : entries) {
                     ImGui::TextUnformatted(name.c_str());
                     ImGui::SameLine();
-                    if (callback(ContentRegistry::Settings::getSettingsData()[category][name]))
-                        View::postEvent(Events::SettingsChanged);
+                    if (callback(ContentRegistry::Settings::getSettingsData()[category][name])) {
+                        View::postEvent(Events::SettingsChanged, ContentRegistry::Settings::Key { category, name });
+                        ContentRegistry::Settings::storeLater();
+                    }
                     ImGui::NewLine();
                 }
                 ImGui::NewLine();
@@ -0,0 +1,169 @@
+#include "views/view_stride_analysis.hpp"
+
+#include <hex/providers/provider.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <cfloat>
+
+namespace hex {
+
+    ViewStrideAnalysis::ViewStrideAnalysis() : View("Stride Analysis") {
+        View::subscribeEvent(Events::RegionSelected, [this](auto userData) {
+            auto region = std::any_cast<const Region>(userData);
+
+            if (this->m_shouldMatchSelection && region.size > 1) {
+                // Selections are relative to the page shown in the hex editor
+                u64 pageOffset = prv::Provider::PageSize * SharedData::currentProvider->getCurrentPage();
+                this->m_region[0] = pageOffset + region.address;
+                this->m_region[1] = pageOffset + region.address + region.size - 1;
+            }
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto) {
+            if (this->m_analysisTask != nullptr)
+                this->m_analysisTask->cancel();
+
+            this->m_analysis = nullptr;
+            this->m_plot.clear();
+            this->m_error.clear();
+        });
+    }
+
+    ViewStrideAnalysis::~ViewStrideAnalysis() {
+        if (this->m_analysisTask != nullptr)
+            this->m_analysisTask->cancel();
+
+        View::unsubscribeEvent(Events::RegionSelected);
+        View::unsubscribeEvent(Events::ProviderChanged);
+    }
+
+    bool ViewStrideAnalysis::isAnalyzing() const {
+        return this->m_analysisTask != nullptr && !this->m_analysisTask->isFinished();
+    }
+
+    void ViewStrideAnalysis::analyze() {
+        auto provider = SharedData::currentProvider;
+
+        const u64 address = this->m_region[0];
+        const u64 size = this->m_region[1] - this->m_region[0] + 1;
+        const u64 maxStride = this->m_maxStride;
+
+        this->m_error.clear();
+
+        auto analysis = std::make_shared<StrideAnalysis>();
+        auto succeeded = std::make_shared<bool>(false);
+
+        this->m_analysisTask = TaskManager::submit("Analyzing strides", [snapshot = provider->createSnapshot(), address, size, maxStride, analysis, succeeded](Task &task) {
+            if (auto result = analyzeStrides(snapshot, address, size, maxStride, task); result.has_value()) {
+                *analysis = std::move(*result);
+                *succeeded = true;
+            }
+        }, [this, analysis, succeeded, address, size] {
+            if (!*succeeded) {
+                this->m_error = "Failed to read the region";
+                return;
+            }
+
+            this->m_analysis = analysis;
+            this->m_analyzedAddress = address;
+            this->m_analyzedSize = size;
+            this->m_plot.assign(analysis->autocorrelation.begin(), analysis->autocorrelation.end());
+        });
+    }
+
+    void ViewStrideAnalysis::createPatternSkeleton(u64 stride) const {
+        const auto typeName = hex::format("Record_%llX", stride);
+
+        std::string code = "struct " + typeName + " {\n";
+        if (stride % 4 == 0) {
+            for (u64 offset = 0; offset < stride; offset += 4)
+                code += hex::format("    u32 field_%llX;\n", offset);
+        } else {
+            code += hex::format("    u8 data[0x%llX];\n", stride);
+        }
+        code += "};\n\n";
+        code += hex::format("%s records[%llu] @ 0x%llX;\n", typeName.c_str(), this->m_analyzedSize / stride, this->m_analyzedAddress);
+
+        View::postEvent(Events::AppendPatternLanguageCode, code.c_str());
+    }
+
+    void ViewStrideAnalysis::drawContent() {
+        if (ImGui::Begin("Stride Analysis", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
+            ImGui::BeginChild("##scrolling", ImVec2(0, 0), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav);
+
+            auto provider = SharedData::currentProvider;
+            if (provider != nullptr && provider->isReadable()) {
+                ImGui::TextUnformatted("Region");
+                ImGui::Separator();
+
+                ImGui::InputScalarN("##nolabel", ImGuiDataType_U64, this->m_region, 2, nullptr, nullptr, "%08llX", ImGuiInputTextFlags_CharsHexadecimal);
+                ImGui::Checkbox("Match selection", &this->m_shouldMatchSelection);
+                ImGui::InputScalar("Largest stride", ImGuiDataType_U64, &this->m_maxStride, nullptr, nullptr, "0x%llX", ImGuiInputTextFlags_CharsHexadecimal);
+
+                const u64 dataSize = provider->getActualSize();
+                if (dataSize > 0 && this->m_region[1] >= dataSize)
+                    this->m_region[1] = dataSize - 1;
+
+                const bool validRegion = this->m_region[1] > this->m_region[0];
+
+                if (this->isAnalyzing()) {
+                    ImGui::ProgressBar(this->m_analysisTask->getProgress(), ImVec2(300, 0));
+                    ImGui::SameLine();
+                    if (ImGui::Button("Cancel"))
+                        this->m_analysisTask->cancel();
+                } else if (ImGui::Button("Analyze") && validRegion) {
+                    this->analyze();
+                }
+
+                if (!this->m_error.empty())
+                    ImGui::TextUnformatted(this->m_error.c_str());
+
+                if (this->m_analysis != nullptr) {
+                    ImGui::NewLine();
+                    ImGui::TextUnformatted("Autocorrelation");
+                    ImGui::Separator();
+
+                    ImGui::PlotHistogram("##autocorrelation", this->m_plot.data(), this->m_plot.size(), 0, nullptr, -1.0F, 1.0F, ImVec2(0, 150));
+
+                    ImGui::NewLine();
+                    ImGui::TextUnformatted("Likely strides");
+                    ImGui::Separator();
+
+                    if (this->m_analysis->candidates.empty())
+                        ImGui::TextUnformatted("The region doesn't seem to consist of records");
+                    else if (ImGui::BeginTable("##strides", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                        ImGui::TableSetupColumn("Stride");
+                        ImGui::TableSetupColumn("Score");
+                        ImGui::TableSetupColumn("");
+                        ImGui::TableHeadersRow();
+
+                        for (const auto &candidate : this->m_analysis->candidates) {
+                            ImGui::PushID(candidate.stride);
+
+                            ImGui::TableNextRow();
+                            ImGui::TableNextColumn();
+                            ImGui::Text("0x%llX (%llu)", candidate.stride, candidate.stride);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%.3f", candidate.score);
+                            ImGui::TableNextColumn();
+                            if (ImGui::SmallButton("Create pattern"))
+                                this->createPatternSkeleton(candidate.stride);
+
+                            ImGui::PopID();
+                        }
+
+                        ImGui::EndTable();
+                    }
+                }
+            }
+
+            ImGui::EndChild();
+        }
+        ImGui::End();
+    }
+
+    void ViewStrideAnalysis::drawMenu() {
+
+    }
+
+}
@@ -1,9 +1,18 @@
 #include "views/view_strings.hpp"
 
+#include <hex/api/task.hpp>
 #include <hex/providers/provider.hpp>
+#include <hex/helpers/analysis_cache.hpp>
+#include <hex/helpers/result_sort.hpp>
 #include <hex/helpers/utils.hpp>
 
+#include "helpers/printable_scanner.hpp"
+
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <string_view>
+#include <utility>
 
 #include <llvm/Demangle/Demangle.h>
 
@@ -11,9 +20,127 @@ using namespace std::literals::string_literals;
 
 namespace hex {
 
+    void DemangledNames::add(u64 offset, std::string_view name) {
+        this->m_entries.push_back({ offset, u32(this->m_names.size()), u32(name.size()) });
+        this->m_names += name;
+    }
+
+    void DemangledNames::append(const DemangledNames &other) {
+        const u32 nameOffset = this->m_names.size();
+
+        for (const auto &entry : other.m_entries)
+            this->m_entries.push_back({ entry.offset, entry.nameOffset + nameOffset, entry.nameSize });
+        this->m_names += other.m_names;
+    }
+
+    void DemangledNames::sort() {
+        std::sort(this->m_entries.begin(), this->m_entries.end(), [](const Entry &left, const Entry &right) { return left.offset < right.offset; });
+    }
+
+    std::optional<std::string_view> DemangledNames::find(u64 offset) const {
+        auto it = std::lower_bound(this->m_entries.begin(), this->m_entries.end(), offset, [](const Entry &entry, u64 offset) { return entry.offset < offset; });
+        if (it == this->m_entries.end() || it->offset != offset)
+            return { };
+
+        return std::string_view(this->m_names).substr(it->nameOffset, it->nameSize);
+    }
+
+    DemangledNames DemangledNames::copyOutside(u64 start, u64 end) const {
+        DemangledNames result;
+
+        for (const auto &entry : this->m_entries) {
+            if (entry.offset < start || entry.offset >= end)
+                result.add(entry.offset, std::string_view(this->m_names).substr(entry.nameOffset, entry.nameSize));
+        }
+
+        return result;
+    }
+
     ViewStrings::ViewStrings() : View("Strings") {
-        View::subscribeEvent(Events::DataChanged, [this](auto){
+        this->m_stringsMemory = MemoryBudget::Registration("Strings", [this] {
+            size_t size = (this->m_foundStrings.capacity() + this->m_filteredStrings.capacity()) * sizeof(FoundString);
+            if (this->m_demangledNames != nullptr)
+                size += this->m_demangledNames->getMemoryUsage();
+
+            return size;
+        });
+
+        View::subscribeEvent(Events::DataChanged, [this](auto userData) {
+            // Only strings close to a known modified region need to be searched again
+            if (auto region = std::any_cast<Region>(&userData); region != nullptr) {
+                if (this->m_finishedExtractionTasks != this->m_extractionTasks.size())
+                    this->m_pendingUpdates.push_back(*region);
+                else
+                    this->updateStrings(*region);
+
+                return;
+            }
+
+            this->m_foundStrings.clear();
+            this->m_pendingUpdates.clear();
+            this->cancelFiltering();
+            this->m_filteredStrings.clear();
+            this->cancelDemangling();
+            this->m_demangledNames.reset();
+        });
+
+        View::subscribeEvent(Events::ProviderChanged, [this](auto userData) {
+            auto previous = std::any_cast<prv::Provider*>(userData);
+
+            // Only complete extractions are kept, partial ones would be missing strings without any indication
+            const bool extractionDone = this->m_extracted && this->m_finishedExtractionTasks == this->m_extractionTasks.size() && this->m_pendingUpdates.empty();
+            if (previous != nullptr && extractionDone) {
+                auto cached = std::make_shared<CachedStrings>();
+                cached->strings = std::move(this->m_foundStrings);
+                cached->encoding = this->m_foundStringsEncoding;
+                cached->minimumLength = this->m_foundStringsMinimumLength;
+                cached->demangledNames = this->m_demangledNames;
+
+                const size_t demangledSize = cached->demangledNames != nullptr ? cached->demangledNames->getMemoryUsage() : 0;
+                AnalysisCache::store(previous, "Strings", cached, cached->strings.size() * sizeof(FoundString) + demangledSize);
+            }
+
+            for (auto &task : this->m_extractionTasks)
+                task->cancel();
+            this->m_extractionTasks.clear();
+            this->m_finishedExtractionTasks = 0;
+            this->m_extracted = false;
             this->m_foundStrings.clear();
+            this->m_pendingUpdates.clear();
+            this->cancelFiltering();
+            this->m_filteredStrings.clear();
+            this->m_currentFilter.clear();
+            this->cancelDemangling();
+            this->m_demangledNames.reset();
+
+            if (auto provider = SharedData::currentProvider; provider != nullptr) {
+                if (auto cached = AnalysisCache::take<CachedStrings>(provider, "Strings"); cached != nullptr) {
+                    this->m_foundStrings = std::move(cached->strings);
+                    this->m_foundStringsEncoding = cached->encoding;
+                    this->m_foundStringsMinimumLength = cached->minimumLength;
+                    this->m_demangledNames = cached->demangledNames;
+                    this->m_sortRequired = true;
+                    this->m_extracted = true;
+
+                    if (this->m_demangledNames == nullptr)
+                        this->demangleStrings();
+                } else {
+                    this->loadStrings(provider);
+                }
+            }
+
+            this->updateFilter();
+        });
+
+        View::subscribeEvent(Events::DataFingerprinted, [this](auto userData) {
+            auto provider = std::any_cast<prv::Provider*>(userData);
+
+            // Strings the user already extracted are never replaced
+            if (provider != SharedData::currentProvider || this->m_extracted)
+                return;
+
+            if (this->loadStrings(provider))
+                this->updateFilter();
         });
 
         this->m_filter = new char[0xFFFF];
@@ -21,7 +148,14 @@ namespace hex {
     }
 
     ViewStrings::~ViewStrings() {
+        for (auto &task : this->m_extractionTasks)
+            task->cancel();
+        this->cancelFiltering();
+        this->cancelDemangling();
+
         View::unsubscribeEvent(Events::DataChanged);
+        View::unsubscribeEvent(Events::ProviderChanged);
+        View::unsubscribeEvent(Events::DataFingerprinted);
         delete[] this->m_filter;
     }
 
@@ -29,7 +163,7 @@ namespace hex {
     void ViewStrings::createStringContextMenu(const FoundString &foundString) {
         if (ImGui::TableGetColumnFlags(2) == ImGuiTableColumnFlags_IsHovered && ImGui::IsMouseReleased(1) && ImGui::IsItemHovered()) {
             ImGui::OpenPopup("StringContextMenu");
-            this->m_selectedString = foundString.string;
+            this->m_selectedString = this->readString(foundString);
         }
         if (ImGui::BeginPopup("StringContextMenu")) {
             if (ImGui::MenuItem("Copy string")) {
@@ -46,104 +180,562 @@ namespace hex {
     }
 
 
-    void ViewStrings::drawContent() {
-        auto provider = SharedData::currentProvider;
+    // Returns the data of the string continuing at offset until its first non-printable character
+    static std::vector<u8> followString(const prv::Snapshot &snapshot, u64 offset, StringEncoding encoding) {
+        std::vector<u8> result;
+        const u64 dataSize = snapshot.getSize();
+        const size_t maxCharacterLength = getMaxCharacterLength(encoding);
 
-        if (this->m_shouldInvalidate) {
-            this->m_shouldInvalidate = false;
+        std::array<u8, 0x100> buffer = { 0 };
+        while (offset < dataSize) {
+            size_t readSize = std::min<u64>(buffer.size(), dataSize - offset);
+            snapshot.read(offset, buffer.data(), readSize);
 
-            this->m_foundStrings.clear();
+            size_t length = findNonPrintable(buffer.data(), readSize, encoding);
+            result.insert(result.end(), buffer.begin(), buffer.begin() + length);
+            offset += length;
+
+            // Continue if the string may go on past the read data, possibly with a character that got cut in half
+            if (length == 0 || length + maxCharacterLength - 1 < readSize)
+                break;
+        }
+
+        return result;
+    }
 
-            std::vector<u8> buffer(1024, 0x00);
-            u32 foundCharacters = 0;
+    // Finds all strings starting inside [start, end). Strings that reach past the end of the range are followed into the next one
+    static std::vector<FoundString> searchChunk(const prv::Snapshot &snapshot, u64 start, u64 end, u32 minimumLength, StringEncoding encoding) {
+        std::vector<FoundString> result;
+        const u64 dataSize = snapshot.getSize();
+        const size_t characterSize = getCharacterSize(encoding);
+        const size_t maxCharacterLength = getMaxCharacterLength(encoding);
+
+        std::vector<u8> buffer(end - start, 0x00);
+        snapshot.hintAccess(start, buffer.size(), prv::AccessHint::Sequential);
+        snapshot.read(start, buffer.data(), buffer.size());
+        snapshot.hintAccess(start, buffer.size(), prv::AccessHint::DontNeed);
+
+        auto addString = [&](size_t offset, std::vector<u8> &&data) {
+            if (getCharacterCount(data.data(), data.size(), encoding) >= minimumLength)
+                result.push_back({ start + offset, data.size() });
+        };
+
+        // Wide characters may start at any alignment, every one of them is searched separately
+        for (size_t alignment = 0; alignment < characterSize; alignment++) {
+            size_t i = alignment;
+
+            // UTF-8 characters cut in half by the chunk start belong to the chunk before
+            if (encoding == StringEncoding::UTF8) {
+                while (i < std::min<size_t>(buffer.size(), maxCharacterLength - 1) && (buffer[i] & 0xC0) == 0x80)
+                    i++;
+            }
 
-            for (u64 offset = 0; offset < provider->getSize(); offset += buffer.size()) {
-                size_t readSize = std::min(u64(buffer.size()), provider->getSize() - offset);
-                provider->read(offset,  buffer.data(), readSize);
+            // A string running into this chunk was already found by the one before it
+            if (size_t previousSize = std::min<u64>(start + i, maxCharacterLength); previousSize > 0 && start > 0) {
+                std::array<u8, 4> previous = { 0 };
+                snapshot.read(start + i - previousSize, previous.data(), previousSize);
 
-                for (u32 i = 0; i < readSize; i++) {
-                    if (buffer[i] >= 0x20 && buffer[i] <= 0x7E)
-                        foundCharacters++;
-                    else {
-                        if (foundCharacters >= this->m_minimumLength) {
-                            FoundString foundString;
+                if (endsWithPrintable(previous.data(), previousSize, encoding)) {
+                    i += findNonPrintable(buffer.data() + i, buffer.size() - i, encoding);
 
-                            foundString.offset = offset + i - foundCharacters;
-                            foundString.size = foundCharacters;
-                            foundString.string.reserve(foundCharacters);
-                            foundString.string.resize(foundCharacters);
-                            provider->read(foundString.offset, foundString.string.data(), foundCharacters);
+                    // The string may run through this entire chunk
+                    if (i + maxCharacterLength - 1 >= buffer.size() && end < dataSize && !followString(snapshot, start + i, encoding).empty())
+                        continue;
+                }
+            }
 
-                            this->m_foundStrings.push_back(foundString);
+            while (i < buffer.size()) {
+                size_t runStart = i + findPrintable(buffer.data() + i, buffer.size() - i, encoding);
+                if (runStart >= buffer.size()) {
+                    // A character cut in half by the end of the chunk may still start a string
+                    size_t tailStart = i;
+                    if (buffer.size() > i + maxCharacterLength - 1)
+                        tailStart += ((buffer.size() - (maxCharacterLength - 1) - i + characterSize - 1) / characterSize) * characterSize;
+
+                    for (; tailStart < buffer.size() && end < dataSize; tailStart += characterSize) {
+                        if (auto string = followString(snapshot, start + tailStart, encoding); !string.empty()) {
+                            addString(tailStart, std::move(string));
+                            break;
                         }
+                    }
+
+                    break;
+                }
 
-                        foundCharacters = 0;
+                size_t runEnd = runStart + findNonPrintable(buffer.data() + runStart, buffer.size() - runStart, encoding);
+
+                // Characters that didn't fit into the chunk anymore continue the string in the next one
+                if (runEnd + maxCharacterLength - 1 >= buffer.size() && end < dataSize) {
+                    if (auto tail = followString(snapshot, start + runEnd, encoding); !tail.empty()) {
+                        std::vector<u8> string(buffer.begin() + runStart, buffer.begin() + runEnd);
+                        string.insert(string.end(), tail.begin(), tail.end());
+
+                        addString(runStart, std::move(string));
+                        break;
                     }
                 }
+
+                addString(runStart, std::vector<u8>(buffer.begin() + runStart, buffer.begin() + runEnd));
+
+                i = runEnd;
+            }
+        }
+
+        return result;
+    }
+
+    void ViewStrings::extractStrings() {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || !provider->isReadable())
+            return;
+
+        for (auto &task : this->m_extractionTasks)
+            task->cancel();
+        this->m_extractionTasks.clear();
+        this->m_finishedExtractionTasks = 0;
+        this->m_pendingUpdates.clear();
+        this->m_extractionFingerprint = PersistentAnalysisCache::getFingerprint(provider);
+
+        this->m_extracted = true;
+        this->m_foundStrings.clear();
+        this->m_foundStringsEncoding = this->m_encoding;
+        this->m_foundStringsMinimumLength = std::max(this->m_minimumLength, 1);
+
+        this->cancelFiltering();
+        this->m_filteredStrings.clear();
+        this->cancelDemangling();
+        this->m_demangledNames.reset();
+
+        // Every chunk gets searched by its own task and its strings show up as soon as it's done. All of them read the data as it is now,
+        // edits made in the meantime get applied once every chunk is in
+        const auto snapshot = provider->createSnapshot();
+        const u64 dataSize = snapshot.getSize();
+        for (u64 start = 0; start < dataSize; start += ChunkSize) {
+            const u64 end = std::min<u64>(start + ChunkSize, dataSize);
+            auto foundStrings = std::make_shared<std::vector<FoundString>>();
+
+            this->m_extractionTasks.push_back(TaskManager::submit("Extracting strings", [snapshot, foundStrings, start, end, minimumLength = this->m_foundStringsMinimumLength, encoding = this->m_encoding](Task &task) {
+                *foundStrings = searchChunk(snapshot, start, end, minimumLength, encoding);
+            }, [this, foundStrings] {
+                this->m_foundStrings.insert(this->m_foundStrings.end(), foundStrings->begin(), foundStrings->end());
+                this->m_sortRequired = true;
+
+                if (!this->m_currentFilter.empty())
+                    this->filterStrings(*foundStrings);
+
+                if (++this->m_finishedExtractionTasks == this->m_extractionTasks.size()) {
+                    for (const auto &region : this->m_pendingUpdates)
+                        this->updateStrings(region);
+                    this->m_pendingUpdates.clear();
+
+                    if (auto fingerprint = PersistentAnalysisCache::getFingerprint(SharedData::currentProvider); fingerprint.has_value() && fingerprint == this->m_extractionFingerprint)
+                        this->storeStrings(*fingerprint);
+
+                    this->demangleStrings();
+                }
+            }));
+        }
+    }
+
+    static std::string getStringsCacheKey(StringEncoding encoding, u32 minimumLength) {
+        return hex::format("Strings-%d-%u", int(encoding), minimumLength);
+    }
+
+    // Restores the strings of the currently selected settings that were extracted from the same data before
+    bool ViewStrings::loadStrings(prv::Provider *provider) {
+        auto fingerprint = PersistentAnalysisCache::getFingerprint(provider);
+        if (!fingerprint.has_value())
+            return false;
+
+        const u32 minimumLength = std::max(this->m_minimumLength, 1);
+        auto strings = ResultTable::load(PersistentAnalysisCache::load(*fingerprint, getStringsCacheKey(this->m_encoding, minimumLength)));
+        if (!strings.has_value())
+            return false;
+
+        // Strings get sorted and updated in place, so they can't stay in the mapped file
+        const auto offsets = strings->getOffsets();
+        const auto sizes = strings->getSizes();
+
+        this->m_foundStrings.resize(strings->size());
+        for (size_t i = 0; i < strings->size(); i++)
+            this->m_foundStrings[i] = { offsets[i], size_t(sizes[i]) };
+        this->m_foundStringsEncoding = this->m_encoding;
+        this->m_foundStringsMinimumLength = minimumLength;
+        this->m_sortRequired = true;
+        this->m_extracted = true;
+
+        this->demangleStrings();
+
+        return true;
+    }
+
+    void ViewStrings::storeStrings(const PersistentAnalysisCache::Fingerprint &fingerprint) const {
+        ResultTable strings;
+        for (const auto &foundString : this->m_foundStrings)
+            strings.add(foundString.offset, foundString.size);
+
+        PersistentAnalysisCache::Writer writer;
+        strings.store(writer);
+
+        PersistentAnalysisCache::store(fingerprint, getStringsCacheKey(this->m_foundStringsEncoding, this->m_foundStringsMinimumLength), std::move(writer));
+    }
+
+    ResultTable ViewStrings::getResultTable() const {
+        ResultTable table;
+
+        for (const auto &foundString : this->m_currentFilter.empty() ? this->m_foundStrings : this->m_filteredStrings) {
+            u32 label = ResultTable::NoLabel;
+            if (this->m_demangledNames != nullptr) {
+                if (auto demangledName = this->m_demangledNames->find(foundString.offset); demangledName.has_value())
+                    label = table.addLabel(*demangledName);
+            }
+
+            table.add(foundString.offset, foundString.size, label);
+        }
+
+        return table;
+    }
+
+    void ViewStrings::updateStrings(const Region &region) {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || region.size == 0 || !this->m_extracted)
+            return;
+
+        const u64 dataSize = provider->getActualSize();
+        if (region.address >= dataSize)
+            return;
+
+        // Modified bytes can join, split, shorten or lengthen the strings around them, including ones that were too short before
+        const u64 margin = u64(this->m_foundStringsMinimumLength + 1) * getMaxCharacterLength(this->m_foundStringsEncoding);
+        u64 start = region.address - std::min<u64>(region.address, margin);
+        u64 end   = std::min<u64>(region.address + region.size + margin, dataSize);
+
+        // Strings reaching into the range get searched again as a whole
+        for (bool extended = true; extended; ) {
+            extended = false;
+
+            for (const auto &foundString : this->m_foundStrings) {
+                const u64 stringEnd = std::min<u64>(foundString.offset + foundString.size, dataSize);
+
+                if (foundString.offset < end && stringEnd > start && (foundString.offset < start || stringEnd > end)) {
+                    start = std::min(start, foundString.offset);
+                    end   = std::max(end, stringEnd);
+                    extended = true;
+                }
             }
         }
 
+        auto isInRange = [start, end](const FoundString &foundString) { return foundString.offset >= start && foundString.offset < end; };
+
+        auto strings = searchChunk(provider->createSnapshot(), start, end, this->m_foundStringsMinimumLength, this->m_foundStringsEncoding);
+
+        std::erase_if(this->m_foundStrings, isInRange);
+        this->m_foundStrings.insert(this->m_foundStrings.end(), strings.begin(), strings.end());
+        this->m_sortRequired = true;
+
+        this->updateDemangledNames(start, end, strings);
+
+        if (this->m_currentFilter.empty())
+            return;
+
+        // Running filter tasks may still deliver the replaced strings, so everything gets filtered again in that case
+        if (this->m_finishedFilterTasks != this->m_filterTasks.size()) {
+            this->m_currentFilter.clear();
+            this->updateFilter();
+        } else {
+            std::erase_if(this->m_filteredStrings, isInRange);
+            this->filterStrings(strings);
+        }
+    }
+
+    static std::string readFoundString(const prv::Snapshot &snapshot, const FoundString &foundString, StringEncoding encoding) {
+        std::vector<u8> data(foundString.size, 0x00);
+        if (!snapshot.read(foundString.offset, data.data(), data.size()))
+            return "";
+
+        return decodeString(data.data(), data.size(), encoding);
+    }
+
+    std::string ViewStrings::readString(const FoundString &foundString) const {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr || foundString.offset + foundString.size > provider->getActualSize())
+            return "";
+
+        std::vector<u8> data(foundString.size, 0x00);
+        provider->readAbsolute(foundString.offset, data.data(), data.size());
+
+        return decodeString(data.data(), data.size(), this->m_foundStringsEncoding);
+    }
+
+    // Strings that aren't symbols come back from the demangler unchanged, only the other ones get stored
+    static void demangleFoundStrings(const prv::Snapshot &snapshot, const std::vector<FoundString> &strings, StringEncoding encoding, DemangledNames &result, const Task *task) {
+        for (const auto &foundString : strings) {
+            if (task != nullptr && task->isCancelled())
+                return;
+
+            auto string = readFoundString(snapshot, foundString, encoding);
+            if (string.empty())
+                continue;
+
+            if (auto demangledName = llvm::demangle(string); demangledName != string)
+                result.add(foundString.offset, demangledName);
+        }
+
+        result.sort();
+    }
+
+    void ViewStrings::demangleStrings() {
+        this->cancelDemangling();
+        this->m_demangledNames.reset();
+
+        auto provider = SharedData::currentProvider;
+        if (!this->m_demangle || provider == nullptr)
+            return;
+
+        if (this->m_foundStrings.empty()) {
+            this->m_demangledNames = std::make_shared<const DemangledNames>();
+            return;
+        }
+
+        const auto snapshot = provider->createSnapshot();
+        for (size_t start = 0; start < this->m_foundStrings.size(); start += DemangleChunkSize) {
+            auto strings = std::make_shared<std::vector<FoundString>>(this->m_foundStrings.begin() + start, this->m_foundStrings.begin() + std::min(start + DemangleChunkSize, this->m_foundStrings.size()));
+            auto names = std::make_shared<DemangledNames>();
+
+            this->m_demangleTasks.push_back(TaskManager::submit("Demangling strings", [snapshot, strings, names, encoding = this->m_foundStringsEncoding](Task &task) {
+                demangleFoundStrings(snapshot, *strings, encoding, *names, &task);
+            }, [this, names] {
+                this->m_pendingDemangledNames.append(*names);
+
+                if (++this->m_finishedDemangleTasks == this->m_demangleTasks.size()) {
+                    this->m_pendingDemangledNames.sort();
+                    this->m_demangledNames = std::make_shared<const DemangledNames>(std::exchange(this->m_pendingDemangledNames, { }));
+
+                    // Strings that only match by their demangled name weren't found by the current filter yet
+                    if (!this->m_currentFilter.empty()) {
+                        this->m_currentFilter.clear();
+                        this->updateFilter();
+                    }
+                }
+            }));
+        }
+    }
+
+    void ViewStrings::cancelDemangling() {
+        for (auto &task : this->m_demangleTasks)
+            task->cancel();
+
+        this->m_demangleTasks.clear();
+        this->m_finishedDemangleTasks = 0;
+        this->m_pendingDemangledNames = { };
+    }
+
+    // Strings found again in [start, end) replace the names of the ones that were there before
+    void ViewStrings::updateDemangledNames(u64 start, u64 end, const std::vector<FoundString> &strings) {
+        auto provider = SharedData::currentProvider;
+        if (!this->m_demangle || provider == nullptr)
+            return;
+
+        // A running pass may have already demangled the replaced strings
+        if (this->m_finishedDemangleTasks != this->m_demangleTasks.size()) {
+            this->demangleStrings();
+            return;
+        }
+
+        if (this->m_demangledNames == nullptr)
+            return;
+
+        auto names = this->m_demangledNames->copyOutside(start, end);
+
+        DemangledNames updatedNames;
+        demangleFoundStrings(provider->createSnapshot(), strings, this->m_foundStringsEncoding, updatedNames, nullptr);
+
+        names.append(updatedNames);
+        names.sort();
+        this->m_demangledNames = std::make_shared<const DemangledNames>(std::move(names));
+    }
+
+    void ViewStrings::updateFilter() {
+        std::string filter = this->m_filter;
+        if (filter == this->m_currentFilter)
+            return;
+
+        // Every string matching a longer filter also matches the one it contains, so only the previous hits need to be searched again
+        const bool refine = !this->m_currentFilter.empty() && filter.find(this->m_currentFilter) != std::string::npos && this->m_finishedFilterTasks == this->m_filterTasks.size();
+
+        this->cancelFiltering();
+
+        auto strings = refine ? std::move(this->m_filteredStrings) : this->m_foundStrings;
+        this->m_filteredStrings.clear();
+        this->m_currentFilter = std::move(filter);
+
+        if (!this->m_currentFilter.empty())
+            this->filterStrings(strings);
+    }
+
+    void ViewStrings::filterStrings(const std::vector<FoundString> &strings) {
+        auto provider = SharedData::currentProvider;
+        if (provider == nullptr)
+            return;
+
+        for (size_t start = 0; start < strings.size(); start += FilterChunkSize) {
+            auto candidates = std::make_shared<std::vector<FoundString>>(strings.begin() + start, strings.begin() + std::min(start + FilterChunkSize, strings.size()));
+
+            this->m_filterTasks.push_back(TaskManager::submit("Filtering strings", TaskPriority::Interactive, [snapshot = provider->createSnapshot(), candidates, filter = this->m_currentFilter, encoding = this->m_foundStringsEncoding, demangledNames = this->m_demangledNames](Task &task) {
+                auto matches = [&](const FoundString &foundString) {
+                    if (readFoundString(snapshot, foundString, encoding).find(filter) != std::string::npos)
+                        return true;
+
+                    if (demangledNames == nullptr)
+                        return false;
+
+                    auto demangledName = demangledNames->find(foundString.offset);
+                    return demangledName.has_value() && demangledName->find(filter) != std::string_view::npos;
+                };
+
+                std::erase_if(*candidates, [&](const FoundString &foundString) {
+                    return task.isCancelled() || !matches(foundString);
+                });
+            }, [this, candidates] {
+                this->m_filteredStrings.insert(this->m_filteredStrings.end(), candidates->begin(), candidates->end());
+                this->m_filteredSortRequired = true;
+                this->m_finishedFilterTasks++;
+            }));
+        }
+    }
+
+    void ViewStrings::cancelFiltering() {
+        for (auto &task : this->m_filterTasks)
+            task->cancel();
+
+        this->m_filterTasks.clear();
+        this->m_finishedFilterTasks = 0;
+    }
+
+    void ViewStrings::sortStrings(ImGuiTableSortSpecs *sortSpecs, std::vector<FoundString> &strings) const {
+        const bool ascending = sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending;
+
+        if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("offset") || sortSpecs->Specs->ColumnUserID == ImGui::GetID("size")) {
+            const bool byOffset = sortSpecs->Specs->ColumnUserID == ImGui::GetID("offset");
+
+            std::vector<u64> keys;
+            keys.reserve(strings.size());
+            for (const auto &foundString : strings)
+                keys.push_back(byOffset ? foundString.offset : foundString.size);
+
+            ResultSort::apply(strings, ResultSort::byNumber(keys, ascending));
+        } else if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("string")) {
+            // The text only gets decoded for as long as the sort takes
+            std::vector<std::string> decodedStrings(strings.size());
+
+            // Reading the strings is what takes time with big tables, the provider can be read from multiple threads
+            constexpr static size_t StringsPerSlice = 0x1000;
+            Task sorting("Sorting strings", TaskPriority::Interactive);
+
+            TaskManager::parallelFor(sorting, (strings.size() + StringsPerSlice - 1) / StringsPerSlice, [&](size_t slice) {
+                for (size_t i = slice * StringsPerSlice; i < std::min(strings.size(), (slice + 1) * StringsPerSlice); i++)
+                    decodedStrings[i] = this->readString(strings[i]);
+            });
+
+            std::vector<std::string_view> keys(decodedStrings.begin(), decodedStrings.end());
+            ResultSort::apply(strings, ResultSort::byString(keys, ascending));
+        }
+    }
+
+    void ViewStrings::drawContent() {
+        auto provider = SharedData::currentProvider;
+
+        if (this->m_shouldInvalidate) {
+            this->m_shouldInvalidate = false;
+            this->extractStrings();
+        }
+
 
         if (ImGui::Begin("Strings", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
             if (provider != nullptr && provider->isReadable()) {
                 if (ImGui::InputInt("Minimum length", &this->m_minimumLength, 1, 0))
                     this->m_shouldInvalidate = true;
 
-                ImGui::InputText("Filter", this->m_filter, 0xFFFF);
+                if (int encoding = int(this->m_encoding); ImGui::Combo("Encoding", &encoding, "ASCII\0UTF-8\0UTF-16LE\0UTF-16BE\0UTF-32LE\0UTF-32BE\0")) {
+                    this->m_encoding = StringEncoding(encoding);
+                    this->m_shouldInvalidate = true;
+                }
+
+                if (ImGui::InputText("Filter", this->m_filter, 0xFFFF))
+                    this->updateFilter();
                 if (ImGui::Button("Extract"))
                     this->m_shouldInvalidate = true;
+                ImGui::SameLine();
+                if (ImGui::Button("Export") && this->m_extracted) {
+                    View::openFileBrowser("Strings: Export results", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, ".hexresults", [this, provider](auto path) {
+                        if (provider != SharedData::currentProvider)
+                            return;
+
+                        const auto fingerprint = PersistentAnalysisCache::getFingerprint(provider).value_or(PersistentAnalysisCache::Fingerprint { 0, provider->getActualSize() });
+                        if (!this->getResultTable().exportFile(path, fingerprint))
+                            View::showErrorPopup("Failed to export the strings!");
+                    });
+                }
+                ImGui::SameLine();
+                if (ImGui::Checkbox("Demangle symbols", &this->m_demangle)) {
+                    const bool extractionDone = this->m_extracted && this->m_finishedExtractionTasks == this->m_extractionTasks.size();
+
+                    if (this->m_demangle && extractionDone)
+                        this->demangleStrings();
+                    else if (!this->m_demangle) {
+                        this->cancelDemangling();
+                        this->m_demangledNames.reset();
+                    }
+
+                    if (!this->m_currentFilter.empty()) {
+                        this->m_currentFilter.clear();
+                        this->updateFilter();
+                    }
+                }
+
+                if (auto finishedTasks = std::count_if(this->m_extractionTasks.begin(), this->m_extractionTasks.end(), [](const auto &task) { return task->isFinished(); }); finishedTasks != this->m_extractionTasks.size()) {
+                    ImGui::SameLine();
+                    ImGui::ProgressBar(float(finishedTasks) / this->m_extractionTasks.size(), ImVec2(200, 0));
+                } else if (this->m_finishedDemangleTasks != this->m_demangleTasks.size()) {
+                    ImGui::SameLine();
+                    ImGui::ProgressBar(float(this->m_finishedDemangleTasks) / this->m_demangleTasks.size(), ImVec2(200, 0), "Demangling...");
+                }
 
                 ImGui::Separator();
                 ImGui::NewLine();
 
-                if (ImGui::BeginTable("##strings", 3,
+                if (ImGui::BeginTable("##strings", this->m_demangle ? 4 : 3,
                                       ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Sortable |
                                       ImGuiTableFlags_Reorderable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
                     ImGui::TableSetupScrollFreeze(0, 1);
                     ImGui::TableSetupColumn("Offset", 0, -1, ImGui::GetID("offset"));
                     ImGui::TableSetupColumn("Size", 0, -1, ImGui::GetID("size"));
                     ImGui::TableSetupColumn("String", 0, -1, ImGui::GetID("string"));
+                    if (this->m_demangle)
+                        ImGui::TableSetupColumn("Demangled", 0, -1, ImGui::GetID("demangled"));
 
                     auto sortSpecs = ImGui::TableGetSortSpecs();
 
-                    if (sortSpecs->SpecsDirty) {
-                        std::sort(this->m_foundStrings.begin(), this->m_foundStrings.end(),
-                                  [&sortSpecs](FoundString &left, FoundString &right) -> bool {
-                                      if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("offset")) {
-                                          if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                                              return left.offset > right.offset;
-                                          else
-                                              return left.offset < right.offset;
-                                      } else if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("size")) {
-                                          if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                                              return left.size > right.size;
-                                          else
-                                              return left.size < right.size;
-                                      } else if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("string")) {
-                                          if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                                              return left.string > right.string;
-                                          else
-                                              return left.string < right.string;
-                                      }
-
-                                      return false;
-                                  });
-
-                        sortSpecs->SpecsDirty = false;
-                    }
+                    if (sortSpecs->SpecsDirty || this->m_sortRequired)
+                        this->sortStrings(sortSpecs, this->m_foundStrings);
+                    if (sortSpecs->SpecsDirty || this->m_filteredSortRequired)
+                        this->sortStrings(sortSpecs, this->m_filteredStrings);
+
+                    sortSpecs->SpecsDirty = false;
+                    this->m_sortRequired = false;
+                    this->m_filteredSortRequired = false;
 
                     ImGui::TableHeadersRow();
 
+                    auto &strings = this->m_currentFilter.empty() ? this->m_foundStrings : this->m_filteredStrings;
+
                     ImGuiListClipper clipper;
-                    clipper.Begin(this->m_foundStrings.size());
+                    clipper.Begin(strings.size());
 
                     while (clipper.Step()) {
                         for (u64 i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
-                            auto &foundString = this->m_foundStrings[i];
-
-                            if (strlen(this->m_filter) != 0 &&
-                                foundString.string.find(this->m_filter) == std::string::npos)
-                                continue;
+                            auto &foundString = strings[i];
+                            auto string = this->readString(foundString);
 
                             ImGui::TableNextRow();
                             ImGui::TableNextColumn();
@@ -159,7 +751,15 @@ namespace hex {
                             ImGui::TableNextColumn();
                             ImGui::Text("0x%04lx", foundString.size);
                             ImGui::TableNextColumn();
-                            ImGui::Text("%s", foundString.string.c_str());
+                            ImGui::Text("%s", string.c_str());
+
+                            if (this->m_demangle) {
+                                ImGui::TableNextColumn();
+                                if (this->m_demangledNames != nullptr) {
+                                    if (auto demangledName = this->m_demangledNames->find(foundString.offset); demangledName.has_value())
+                                        ImGui::TextUnformatted(demangledName->data(), demangledName->data() + demangledName->size());
+                                }
+                            }
                         }
                     }
                     clipper.End();
@@ -0,0 +1,72 @@
+#include "views/view_tasks.hpp"
+
+#include <hex/api/task.hpp>
+
+#include <imgui.h>
+
+#include <string>
+
+namespace hex {
+
+    ViewTasks::ViewTasks() : View("Tasks") {
+
+    }
+
+    static const char* getPriorityName(TaskPriority priority) {
+        switch (priority) {
+            case TaskPriority::Interactive: return "Interactive";
+            case TaskPriority::Normal:      return "Normal";
+            case TaskPriority::Background:  return "Background";
+        }
+
+        return "";
+    }
+
+    void ViewTasks::drawContent() {
+        if (ImGui::Begin("Tasks", &this->getWindowOpenState(), ImGuiWindowFlags_NoCollapse)) {
+            ImGui::Text("%u workers, %u background workers", TaskManager::getWorkerCount(), TaskManager::getWorkerCount(true));
+
+            if (ImGui::BeginTable("##tasksTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Name");
+                ImGui::TableSetupColumn("Priority");
+                ImGui::TableSetupColumn("State");
+                ImGui::TableSetupColumn("Progress");
+                ImGui::TableSetupColumn("##cancel", ImGuiTableColumnFlags_WidthFixed);
+
+                ImGui::TableHeadersRow();
+
+                u32 index = 0;
+                for (const auto &task : TaskManager::getRunningTasks()) {
+                    ImGui::PushID(index++);
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(task->getName().c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(getPriorityName(task->getPriority()));
+                    ImGui::TableNextColumn();
+                    if (task->isCancelled())
+                        ImGui::TextUnformatted("Cancelling");
+                    else
+                        ImGui::TextUnformatted(task->isRunning() ? "Running" : "Queued");
+                    ImGui::TableNextColumn();
+                    ImGui::ProgressBar(task->getProgress(), ImVec2(-1, 0));
+                    ImGui::TableNextColumn();
+                    if (!task->isCancelled() && ImGui::SmallButton("Cancel"))
+                        task->cancel();
+
+                    ImGui::PopID();
+                }
+
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+    }
+
+    void ViewTasks::drawMenu() {
+
+    }
+
+}
@@ -2,9 +2,18 @@
 
 #include <hex.hpp>
 #include <hex/api/content_registry.hpp>
-
+#include <hex/api/task.hpp>
+#include <hex/helpers/memory_budget.hpp>
+#include <hex/helpers/profiler.hpp>
+#include <hex/providers/scan_pipeline.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <numeric>
+#include <thread>
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -13,6 +22,9 @@
 #include <imgui_freetype.h>
 #include <imgui_imhex_extensions.h>
 
+#include "helpers/crypto.hpp"
+#include "helpers/loader_script_handler.hpp"
+#include "helpers/persistent_analysis_cache.hpp"
 #include "helpers/plugin_handler.hpp"
 
 #include <glad/glad.h>
@@ -62,22 +74,85 @@ namespace hex {
             return false;
         });
 
+        ContentRegistry::Settings::add("Interface", "Redraw only when needed", 1, [](nlohmann::json &setting) {
+            static bool enabled = static_cast<int>(setting);
+            if (ImGui::Checkbox("##nolabel", &enabled)) {
+                setting = static_cast<int>(enabled);
+                return true;
+            }
+
+            return false;
+        });
+
+        ContentRegistry::Settings::add("Interface", "Frame rate limit", 60, [](nlohmann::json &setting) {
+            static int limit = setting;
+            if (ImGui::SliderInt("##nolabel", &limit, 15, 240, "%d FPS")) {
+                setting = limit;
+                return true;
+            }
+
+            return false;
+        });
+
+        ContentRegistry::Settings::add("Memory", "Cache memory limit", MemoryBudget::DefaultLimit >> 20, [](nlohmann::json &setting) {
+            static int limit = setting;
+            if (ImGui::SliderInt("##nolabel", &limit, 256, 65536, "%d MiB", ImGuiSliderFlags_Logarithmic)) {
+                setting = limit;
+                return true;
+            }
+
+            return false;
+        });
+
+        // Nothing gets stored on disk at all with a limit of zero
+        ContentRegistry::Settings::add("Memory", "Analysis cache on disk", PersistentAnalysisCache::DefaultBudget >> 20, [](nlohmann::json &setting) {
+            static int limit = setting;
+            if (ImGui::SliderInt("##nolabel", &limit, 0, 65536, "%d MiB", ImGuiSliderFlags_Logarithmic)) {
+                setting = limit;
+                return true;
+            }
+
+            return false;
+        });
+
         ImGui::GetStyle().Colors[ImGuiCol_DockingEmptyBg] = ImGui::GetStyle().Colors[ImGuiCol_WindowBg];
-        EventManager::subscribe(Events::SettingsChanged, this, [](auto) -> std::any {
-            int theme = ContentRegistry::Settings::getSettingsData()["Interface"]["Color theme"];
-            switch (theme) {
-                default:
-                case 0: /* Dark theme */
-                    ImGui::StyleColorsDark();
-                    break;
-                case 1: /* Light theme */
-                    ImGui::StyleColorsLight();
-                    break;
-                case 2: /* Classic theme */
-                    ImGui::StyleColorsClassic();
-                    break;
+        // Only what the changed setting affects gets applied again, sliders post a change every frame they're being dragged
+        EventManager::subscribe(Events::SettingsChanged, this, [this](auto userData) -> std::any {
+            using Settings = ContentRegistry::Settings;
+
+            if (Settings::changed(userData, "Interface", "Color theme")) {
+                int theme = Settings::getSettingsData()["Interface"]["Color theme"];
+                switch (theme) {
+                    default:
+                    case 0: /* Dark theme */
+                        ImGui::StyleColorsDark();
+                        break;
+                    case 1: /* Light theme */
+                        ImGui::StyleColorsLight();
+                        break;
+                    case 2: /* Classic theme */
+                        ImGui::StyleColorsClassic();
+                        break;
+                }
+                ImGui::GetStyle().Colors[ImGuiCol_DockingEmptyBg] = ImGui::GetStyle().Colors[ImGuiCol_WindowBg];
+            }
+
+            if (Settings::changed(userData, "Interface", "Redraw only when needed"))
+                this->m_redrawOnDemand = Settings::read("Interface", "Redraw only when needed", 1) != 0;
+            if (Settings::changed(userData, "Interface", "Frame rate limit"))
+                this->m_frameRateLimit = std::clamp<s64>(Settings::read("Interface", "Frame rate limit", 60), 15, 240);
+            if (Settings::changed(userData, "Memory", "Cache memory limit"))
+                MemoryBudget::setLimit(size_t(std::clamp<s64>(Settings::read("Memory", "Cache memory limit", MemoryBudget::DefaultLimit >> 20), 256, 65536)) << 20);
+            if (Settings::changed(userData, "Memory", "Analysis cache on disk"))
+                PersistentAnalysisCache::setBudget(u64(std::clamp<s64>(Settings::read("Memory", "Analysis cache on disk", PersistentAnalysisCache::DefaultBudget >> 20), 0, 65536)) << 20);
+
+            if (Settings::changed(userData, "Tasks")) {
+                TaskManager::PoolSettings poolSettings;
+                poolSettings.workerCount = std::clamp<s64>(Settings::read("Tasks", "Worker threads", 0), 0, 64);
+                poolSettings.backgroundWorkerCount = std::clamp<s64>(Settings::read("Tasks", "Background worker threads", 0), 0, 64);
+                poolSettings.lowerBackgroundPriority = Settings::read("Tasks", "Run background jobs at lower priority", 1) != 0;
+                TaskManager::configure(poolSettings);
             }
-            ImGui::GetStyle().Colors[ImGuiCol_DockingEmptyBg] = ImGui::GetStyle().Colors[ImGuiCol_WindowBg];
 
             return { };
         });
@@ -125,11 +200,20 @@ namespace hex {
         ContentRegistry::Settings::load();
         View::postEvent(Events::SettingsChanged);
 
+        if (this->m_unstoredFontAtlas.has_value()) {
+            auto &[fingerprint, key, writer] = *this->m_unstoredFontAtlas;
+            PersistentAnalysisCache::store(fingerprint, key, std::move(writer));
+            this->m_unstoredFontAtlas.reset();
+        }
+
         for (const auto &path : ContentRegistry::Settings::read("ImHex", "RecentFiles"))
             this->m_recentFiles.push_back(path);
     }
 
     Window::~Window() {
+        TaskManager::stop();
+        SharedData::wakeUpMainLoop = nullptr;
+
         this->deinitImGui();
         this->deinitGLFW();
         ContentRegistry::Settings::store();
@@ -139,39 +223,340 @@ namespace hex {
         ContentRegistry::Views::getEntries().clear();
 
         this->deinitPlugins();
+        LoaderScript::shutdown();
 
         EventManager::unsubscribe(Events::SettingsChanged, this);
     }
 
     void Window::loop() {
         while (!glfwWindowShouldClose(this->m_window)) {
-            this->frameBegin();
+            this->waitForFrame();
+
+            Profiler::setEnabled(this->m_profilerVisible || Profiler::isRecording());
+
+            {
+                Profiler::Scope frameScope("Frame");
+
+                {
+                    Profiler::Scope scope("Menu bar");
+                    this->frameBegin();
+                }
+
+                {
+                    Profiler::Scope scope("Deferred calls");
+                    for (const auto &call : View::getDeferedCalls())
+                        call();
+                    View::getDeferedCalls().clear();
+                }
+
+                {
+                    Profiler::Scope scope("Task callbacks");
+                    prv::ScanPipeline::dispatch();
+                    TaskManager::processFinishedTasks();
+                }
+
+                {
+                    Profiler::Scope scope("Queued events");
+                    EventManager::processQueuedEvents();
+                }
+
+                {
+                    Profiler::Scope scope("Memory budget");
+                    MemoryBudget::enforce();
+                }
+
+                ContentRegistry::Settings::processPendingStore();
+
+                for (auto &view : ContentRegistry::Views::getEntries()) {
+                    if (!view->isAvailable() || !view->getWindowOpenState())
+                        continue;
+
+                    auto minSize = view->getMinSize();
+                    minSize.x *= this->m_globalScale;
+                    minSize.y *= this->m_globalScale;
+
+                    Profiler::Scope scope(view->getName());
+                    ImGui::SetNextWindowSizeConstraints(minSize, view->getMaxSize());
+                    view->drawContent();
+                }
+
+                {
+                    Profiler::Scope scope("Common interfaces");
+                    View::drawCommonInterfaces();
+                }
+
+                #ifdef DEBUG
+                    if (this->m_demoWindowOpen)
+                        ImGui::ShowDemoWindow(&this->m_demoWindowOpen);
+                #endif
+
+                if (this->m_profilerVisible)
+                    this->drawProfiler();
+
+                {
+                    Profiler::Scope scope("Render");
+                    this->frameEnd();
+                }
+            }
+
+            Profiler::endFrame();
+        }
+    }
+
+    void Window::drawProfiler() {
+        ImGui::SetNextWindowSize(ImVec2(600 * this->m_globalScale, 400 * this->m_globalScale), ImGuiCond_FirstUseEver);
+        if (ImGui::Begin("Profiler", &this->m_profilerVisible)) {
+            const auto &statistics = Profiler::getStatistics();
 
-            for (const auto &call : View::getDeferedCalls())
-                call();
-            View::getDeferedCalls().clear();
+            if (auto frame = statistics.find("Frame"); frame != statistics.end()) {
+                const auto &history = frame->second.milliseconds;
 
-            for (auto &view : ContentRegistry::Views::getEntries()) {
-                if (!view->isAvailable() || !view->getWindowOpenState())
-                    continue;
+                // The plot expects the oldest value first
+                std::array<float, Profiler::HistorySize> values = { 0 };
+                for (size_t i = 0; i < Profiler::HistorySize; i++)
+                    values[i] = history.values[(history.next + i) % Profiler::HistorySize];
 
-                auto minSize = view->getMinSize();
-                minSize.x *= this->m_globalScale;
-                minSize.y *= this->m_globalScale;
+                ImGui::PlotLines("##frameTimes", values.data(), values.size(), 0, hex::format("Frame time: %.2f ms average, %.2f ms maximum", history.getAverage(), history.getMaximum()).c_str(),
+                                 0.0F, std::max<float>(history.getMaximum(), 1000.0F / this->m_frameRateLimit), ImVec2(ImGui::GetContentRegionAvail().x, 60 * this->m_globalScale));
+            }
+
+            const auto &reads = Profiler::getReadStatistics();
+            ImGui::Text("Provider reads per frame: %.1f (%.0f bytes), on the main thread: %.1f (%.0f bytes)",
+                        reads.count.getAverage(), reads.bytes.getAverage(), reads.mainThreadCount.getAverage(), reads.mainThreadBytes.getAverage());
+
+            if constexpr (Profiler::TracksAllocations) {
+                const auto &allocations = Profiler::getAllocationStatistics();
+                ImGui::Text("Allocations per frame: %.1f (%.0f bytes), on the main thread: %.1f (%.0f bytes)",
+                            allocations.count.getAverage(), allocations.bytes.getAverage(), allocations.mainThreadCount.getAverage(), allocations.mainThreadBytes.getAverage());
+            }
+
+            if (ImGui::Button("Clear"))
+                Profiler::clear();
+
+            ImGui::SameLine();
+            if (Profiler::isRecording()) {
+                if (ImGui::Button("Stop recording"))
+                    Profiler::stopRecording();
+
+                ImGui::SameLine();
+                ImGui::Text("%zu events", Profiler::getTraceEventCount());
+            } else {
+                if (ImGui::Button("Record trace"))
+                    Profiler::startRecording();
+
+                ImGui::SameLine();
+                if (ImGui::Button("Export trace") && Profiler::getTraceEventCount() > 0) {
+                    View::openFileBrowser("Export Trace", imgui_addons::ImGuiFileBrowser::DialogMode::SAVE, ".json", [](auto path) {
+                        if (!Profiler::exportTrace(path))
+                            View::showErrorPopup("Failed to export trace!");
+                    });
+                }
+            }
+
+            if (ImGui::CollapsingHeader("Memory")) {
+                const auto usage = MemoryBudget::getUsage();
+                const size_t total = std::accumulate(usage.begin(), usage.end(), size_t(0), [](size_t sum, const auto &entry) { return sum + entry.size; });
+
+                ImGui::Text("%s of %s used", hex::toByteString(total).c_str(), hex::toByteString(MemoryBudget::getLimit()).c_str());
+
+                if (ImGui::BeginTable("##memoryTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                    ImGui::TableSetupColumn("Subsystem");
+                    ImGui::TableSetupColumn("Used");
+                    ImGui::TableSetupColumn("Evictable");
+                    ImGui::TableSetupColumn("Consumers");
+
+                    ImGui::TableHeadersRow();
+
+                    for (const auto &entry : usage) {
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(entry.subsystem.c_str());
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(hex::toByteString(entry.size).c_str());
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(hex::toByteString(entry.evictableSize).c_str());
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%zu", entry.consumers);
+                    }
 
-                ImGui::SetNextWindowSizeConstraints(minSize, view->getMaxSize());
-                view->drawContent();
+                    ImGui::EndTable();
+                }
             }
 
-            View::drawCommonInterfaces();
+            // Slowest first
+            std::vector<std::pair<std::string_view, const Profiler::Statistics*>> entries;
+            for (const auto &[name, entry] : statistics)
+                entries.emplace_back(name, &entry);
+
+            std::sort(entries.begin(), entries.end(), [](const auto &left, const auto &right) {
+                return left.second->milliseconds.getAverage() > right.second->milliseconds.getAverage();
+            });
+
+            // Zones of jobs are named after their task, so allocations per job show up next to the ones per frame
+            if (ImGui::BeginTable("##profilerTable", Profiler::TracksAllocations ? 7 : 5, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Name");
+                ImGui::TableSetupColumn("Average");
+                ImGui::TableSetupColumn("Maximum");
+                ImGui::TableSetupColumn("Latest");
+                ImGui::TableSetupColumn("Calls");
+                if constexpr (Profiler::TracksAllocations) {
+                    ImGui::TableSetupColumn("Allocations");
+                    ImGui::TableSetupColumn("Allocated");
+                }
 
-            #ifdef DEBUG
-                if (this->m_demoWindowOpen)
-                    ImGui::ShowDemoWindow(&this->m_demoWindowOpen);
-            #endif
+                ImGui::TableHeadersRow();
+
+                // Spikes are frames that took far longer than usual
+                const double frameBudget = 1000.0 / this->m_frameRateLimit;
+                for (const auto &[name, entry] : entries) {
+                    const auto &history = entry->milliseconds;
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(name.data(), name.data() + name.size());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f ms", history.getAverage());
+                    ImGui::TableNextColumn();
+                    if (history.getMaximum() > std::max(history.getAverage() * 4, frameBudget))
+                        ImGui::TextColored(ImVec4(1.0F, 0.3F, 0.3F, 1.0F), "%.3f ms", history.getMaximum());
+                    else
+                        ImGui::Text("%.3f ms", history.getMaximum());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f ms", history.getLatest());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", entry->calls.getAverage());
+
+                    // Zones that hardly ever allocate stand out once they do
+                    if constexpr (Profiler::TracksAllocations) {
+                        const auto &allocations = entry->allocations;
+
+                        ImGui::TableNextColumn();
+                        if (allocations.getMaximum() > 0 && allocations.getAverage() < 1)
+                            ImGui::TextColored(ImVec4(1.0F, 0.3F, 0.3F, 1.0F), "%.1f", allocations.getAverage());
+                        else
+                            ImGui::Text("%.1f", allocations.getAverage());
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(hex::toByteString(entry->allocatedBytes.getAverage()).c_str());
+                    }
+                }
 
-            this->frameEnd();
+                ImGui::EndTable();
+            }
         }
+        ImGui::End();
+    }
+
+    // Everything about an atlas with a single font that isn't glyphs or pixels
+    struct FontAtlasInfo {
+        s32 texWidth, texHeight;
+        s32 packIdMouseCursors, packIdLines;
+        ImVec2 texUvScale, texUvWhitePixel;
+        ImVec4 texUvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+
+        float fontSize, ascent, descent;
+        s32 metricsTotalSurface;
+        u32 fallbackChar, ellipsisChar;
+    };
+
+    static std::optional<PersistentAnalysisCache::Fingerprint> getFontFingerprint(const std::filesystem::path &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return std::nullopt;
+
+        std::vector<u8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (file.bad())
+            return std::nullopt;
+
+        return PersistentAnalysisCache::Fingerprint { crypt::xxh64(data.data(), data.size()), data.size() };
+    }
+
+    static std::optional<PersistentAnalysisCache::Writer> storeFontAtlas(const ImFontAtlas &atlas) {
+        if (atlas.Fonts.Size != 1 || atlas.TexPixelsAlpha8 == nullptr)
+            return std::nullopt;
+
+        const ImFont *font = atlas.Fonts[0];
+
+        FontAtlasInfo info = { };
+        info.texWidth               = atlas.TexWidth;
+        info.texHeight              = atlas.TexHeight;
+        info.packIdMouseCursors     = atlas.PackIdMouseCursors;
+        info.packIdLines            = atlas.PackIdLines;
+        info.texUvScale             = atlas.TexUvScale;
+        info.texUvWhitePixel        = atlas.TexUvWhitePixel;
+        std::copy(std::begin(atlas.TexUvLines), std::end(atlas.TexUvLines), info.texUvLines);
+        info.fontSize               = font->FontSize;
+        info.ascent                 = font->Ascent;
+        info.descent                = font->Descent;
+        info.metricsTotalSurface    = font->MetricsTotalSurface;
+        info.fallbackChar           = font->FallbackChar;
+        info.ellipsisChar           = font->EllipsisChar;
+
+        // Rectangles of custom glyphs point at their font, those can't be stored
+        std::vector<ImFontAtlasCustomRect> customRects(atlas.CustomRects.begin(), atlas.CustomRects.end());
+        if (std::any_of(customRects.begin(), customRects.end(), [](const auto &rect) { return rect.Font != nullptr; }))
+            return std::nullopt;
+
+        PersistentAnalysisCache::Writer writer;
+        writer.add(std::span<const FontAtlasInfo>(&info, 1));
+        writer.add(std::span<const u8>(atlas.TexPixelsAlpha8, size_t(atlas.TexWidth) * atlas.TexHeight));
+        writer.add(std::span<const ImFontGlyph>(font->Glyphs.begin(), font->Glyphs.end()));
+        writer.add(customRects);
+
+        return writer;
+    }
+
+    // Leaves the atlas alone unless the entry holds a valid one
+    static bool loadFontAtlas(ImFontAtlas &atlas, const PersistentAnalysisCache::Entry &entry) {
+        const auto infos        = entry.get<FontAtlasInfo>(0);
+        const auto pixels       = entry.get<u8>(1);
+        const auto glyphs       = entry.get<ImFontGlyph>(2);
+        const auto customRects  = entry.get<ImFontAtlasCustomRect>(3);
+
+        if (infos.size() != 1 || glyphs.empty() || glyphs.size() >= 0xFFFF)
+            return false;
+
+        const auto &info = infos.front();
+        if (info.texWidth <= 0 || info.texHeight <= 0 || pixels.size() != size_t(info.texWidth) * info.texHeight)
+            return false;
+        if (info.packIdMouseCursors >= s64(customRects.size()) || info.packIdLines >= s64(customRects.size()))
+            return false;
+        if (std::any_of(glyphs.begin(), glyphs.end(), [](const auto &glyph) { return glyph.Codepoint > IM_UNICODE_CODEPOINT_MAX; }))
+            return false;
+
+        atlas.Clear();
+
+        atlas.TexWidth              = info.texWidth;
+        atlas.TexHeight             = info.texHeight;
+        atlas.PackIdMouseCursors    = info.packIdMouseCursors;
+        atlas.PackIdLines           = info.packIdLines;
+        atlas.TexUvScale            = info.texUvScale;
+        atlas.TexUvWhitePixel       = info.texUvWhitePixel;
+        std::copy(std::begin(info.texUvLines), std::end(info.texUvLines), atlas.TexUvLines);
+
+        atlas.CustomRects.resize(customRects.size());
+        std::copy(customRects.begin(), customRects.end(), atlas.CustomRects.begin());
+
+        // Freed by the atlas just like pixels it rasterized itself
+        atlas.TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(pixels.size()));
+        std::copy(pixels.begin(), pixels.end(), atlas.TexPixelsAlpha8);
+
+        ImFont *font = IM_NEW(ImFont);
+        font->ContainerAtlas        = &atlas;
+        font->FontSize              = info.fontSize;
+        font->Ascent                = info.ascent;
+        font->Descent               = info.descent;
+        font->MetricsTotalSurface   = info.metricsTotalSurface;
+        font->FallbackChar          = info.fallbackChar;
+        font->EllipsisChar          = info.ellipsisChar;
+
+        font->Glyphs.resize(glyphs.size());
+        std::copy(glyphs.begin(), glyphs.end(), font->Glyphs.begin());
+        font->BuildLookupTable();
+
+        atlas.Fonts.push_back(font);
+
+        return true;
     }
 
     bool Window::setFont(const std::filesystem::path &path) {
@@ -183,11 +568,28 @@ namespace hex {
         // If we have a custom font, then rescaling is unnecessary and will make it blurry
         io.FontGlobalScale = 1.0f;
 
+        // Rasterizing large fonts takes seconds, so atlases built before get restored from the analysis cache instead.
+        // The size already accounts for the scale of the monitor
+        const float fontSize = std::floor(14.0f * this->m_fontScale);
+        const auto fingerprint = getFontFingerprint(path);
+        const auto key = hex::format("FontAtlas-%d-%d-%X", IMGUI_VERSION_NUM, int(fontSize), u32(ImGuiFreeType::Monochrome));
+
+        std::unique_ptr<PersistentAnalysisCache::Entry> entry;
+        if (fingerprint.has_value())
+            entry = PersistentAnalysisCache::load(*fingerprint, key);
+
         // Load font data & build atlas
+        if (entry == nullptr || !loadFontAtlas(*io.Fonts, *entry)) {
+            io.Fonts->AddFontFromFileTTF(path.string().c_str(), fontSize); // Needs conversion to char for Windows
+            ImGuiFreeType::BuildFontAtlas(io.Fonts, ImGuiFreeType::Monochrome);
+
+            // Settings aren't loaded yet, storing waits until it's known whether there's a cache on disk at all
+            if (auto writer = storeFontAtlas(*io.Fonts); fingerprint.has_value() && writer.has_value())
+                this->m_unstoredFontAtlas = { *fingerprint, key, std::move(*writer) };
+        }
+
         std::uint8_t *px;
         int w, h;
-        io.Fonts->AddFontFromFileTTF(path.string().c_str(), std::floor(14.0f * this->m_fontScale)); // Needs conversion to char for Windows
-        ImGuiFreeType::BuildFontAtlas(io.Fonts, ImGuiFreeType::Monochrome);
         io.Fonts->GetTexDataAsRGBA32(&px, &w, &h);
 
         // Create new font atlas
@@ -202,9 +604,53 @@ namespace hex {
         return true;
     }
 
-    void Window::frameBegin() {
-        glfwPollEvents();
+    void Window::waitForFrame() {
+        // Popups and windows that size themselves need a few frames to settle after whatever changed them
+        constexpr u32 SettleFrames = 3;
+
+        // Without any input the interface still gets redrawn regularly, so progress bars move and the text cursor blinks
+        constexpr double TaskProgressInterval = 0.1;
+        constexpr double TextCursorInterval = 0.5;
+        constexpr double IdleInterval = 1.0;
+
+        const bool redrawRequested = SharedData::redrawRequested.exchange(false);
+        const bool iconified = glfwGetWindowAttrib(this->m_window, GLFW_ICONIFIED) != 0;
 
+        bool needsFrame = !this->m_redrawOnDemand || redrawRequested || this->m_remainingFrames > 0
+                       || !View::getDeferedCalls().empty() || EventManager::hasQueuedEvents() || ImGui::IsAnyMouseDown();
+
+        if (iconified && !redrawRequested)
+            needsFrame = false;
+
+        if (needsFrame) {
+            const double frameTime = 1.0 / this->m_frameRateLimit;
+            const double remaining = this->m_lastFrameTime + frameTime - glfwGetTime();
+            if (remaining > 0)
+                std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+
+            glfwPollEvents();
+
+            if (this->m_remainingFrames > 0)
+                this->m_remainingFrames--;
+        } else {
+            double timeout = IdleInterval;
+            if (!iconified && !TaskManager::getRunningTasks().empty())
+                timeout = TaskProgressInterval;
+            else if (!iconified && ImGui::GetIO().WantTextInput)
+                timeout = TextCursorInterval;
+
+            const double waitStart = glfwGetTime();
+            glfwWaitEventsTimeout(timeout);
+
+            // Waking up early means there was input
+            if (glfwGetTime() - waitStart < timeout)
+                this->m_remainingFrames = SettleFrames;
+        }
+
+        this->m_lastFrameTime = glfwGetTime();
+    }
+
+    void Window::frameBegin() {
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -247,12 +693,26 @@ namespace hex {
                 if (ImGui::BeginMenu("View")) {
                     ImGui::Separator();
                     ImGui::MenuItem("Display FPS", "", &this->m_fpsVisible);
+                    ImGui::MenuItem("Profiler", "", &this->m_profilerVisible);
                     #ifdef DEBUG
                         ImGui::MenuItem("Demo View", "", &this->m_demoWindowOpen);
                     #endif
                     ImGui::EndMenu();
                 }
 
+                if (auto tasks = TaskManager::getRunningTasks(); !tasks.empty()) {
+                    const auto &task = tasks.front();
+
+                    ImGui::SameLine(ImGui::GetWindowWidth() - 450 * this->m_globalScale);
+                    if (tasks.size() > 1)
+                        ImGui::Text("%s (+%zu)", task->getName().c_str(), tasks.size() - 1);
+                    else
+                        ImGui::TextUnformatted(task->getName().c_str());
+
+                    ImGui::SameLine();
+                    ImGui::ProgressBar(task->getProgress(), ImVec2(150 * this->m_globalScale, 0));
+                }
+
                 if (this->m_fpsVisible) {
                     char buffer[0x20];
                     snprintf(buffer, 0x20, "%.1f FPS", ImGui::GetIO().Framerate);
@@ -329,9 +789,9 @@ namespace hex {
             ImGui::Text("Start");
             {
                 if (ImGui::BulletHyperlink("Open File"))
-                    EventManager::post(Events::OpenWindow, "Open File");
+                    EventManager::notify(Events::OpenWindow, "Open File");
                 if (ImGui::BulletHyperlink("Open Project"))
-                    EventManager::post(Events::OpenWindow, "Open Project");
+                    EventManager::notify(Events::OpenWindow, "Open Project");
             }
             ImGui::TableNextRow(ImGuiTableRowFlags_None, 100);
             ImGui::TableNextColumn();
@@ -340,7 +800,7 @@ namespace hex {
                 if (!this->m_recentFiles.empty()) {
                     for (auto &path : this->m_recentFiles) {
                         if (ImGui::BulletHyperlink(std::filesystem::path(path).filename().string().c_str())) {
-                            EventManager::post(Events::FileDropped, path.c_str());
+                            EventManager::notify(Events::FileDropped, path.c_str());
                             break;
                         }
                     }
@@ -363,7 +823,7 @@ namespace hex {
             ImGui::Text("Customize");
             {
                 if (ImGui::DescriptionButton("Settings", "Change preferences of ImHex", ImVec2(ImGui::GetContentRegionAvail().x * 0.8f, 0)))
-                    EventManager::post(Events::OpenWindow, "Preferences");
+                    EventManager::notify(Events::OpenWindow, "Preferences");
             }
             ImGui::TableNextRow(ImGuiTableRowFlags_None, 100);
             ImGui::TableNextColumn();
@@ -415,6 +875,9 @@ namespace hex {
         glfwMakeContextCurrent(this->m_window);
         glfwSwapInterval(1);
 
+        // Task workers and other threads wake up the main loop through this, glfwPostEmptyEvent() may be called from any thread
+        SharedData::wakeUpMainLoop = []{ glfwPostEmptyEvent(); };
+
          {
              int x = 0, y = 0;
              glfwGetWindowPos(this->m_window, &x, &y);